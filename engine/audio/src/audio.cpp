@@ -19,32 +19,22 @@
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
-#include <QCoreApplication>
 #include <QDebug>
 #include <QFile>
 
 #include "audiodecoder.h"
 #include "audiorenderer.h"
 #include "audioplugincache.h"
-
-#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-
- #if defined(__APPLE__) || defined(Q_OS_MAC)
-   #include "audiorenderer_portaudio.h"
- #elif defined(WIN32) || defined(Q_OS_WIN)
-   #include "audiorenderer_waveout.h"
- #else
-   #include "audiorenderer_alsa.h"
- #endif
-#else
- #include "audiorenderer_qt.h"
-#endif
+#include "audioclipdecoder.h"
+#include "audiomixer.h"
+#include "qlcfile.h"
 
 #include "audio.h"
 #include "doc.h"
 
 #define KXMLQLCAudioSource "Source"
 #define KXMLQLCAudioDevice "Device"
+#define KXMLQLCAudioPreload "Preload"
 
 /*****************************************************************************
  * Initialization
@@ -55,9 +45,14 @@ Audio::Audio(Doc* doc)
   , m_doc(doc)
   , m_decoder(NULL)
   , m_audio_out(NULL)
+  , m_mixer(NULL)
+  , m_stream(NULL)
   , m_audioDevice(QString())
   , m_sourceFileName("")
   , m_audioDuration(0)
+  , m_preload(false)
+  , m_clip(NULL)
+  , m_playbackOffset(0)
 {
     setName(tr("New Audio"));
     setRunOrder(Audio::SingleShot);
@@ -69,11 +64,18 @@ Audio::Audio(Doc* doc)
 
 Audio::~Audio()
 {
+    if (m_stream != NULL)
+    {
+        m_mixer->removeStream(m_stream);
+        m_stream = NULL;
+    }
     if (m_audio_out != NULL)
     {
         m_audio_out->stop();
         delete m_audio_out;
+        m_audio_out = NULL;
     }
+    unloadClip();
     if (m_decoder != NULL)
         delete m_decoder;
 }
@@ -114,6 +116,7 @@ bool Audio::copyFrom(const Function* function)
 
     setSourceFileName(aud->m_sourceFileName);
     m_audioDuration = aud->m_audioDuration;
+    setPreload(aud->m_preload);
 
     return Function::copyFrom(function);
 }
@@ -144,6 +147,7 @@ bool Audio::setSourceFileName(QString filename)
     if (m_sourceFileName.isEmpty() == false)
     {
         // unload previous source
+        unloadClip();
         if (m_decoder != NULL)
         {
             delete m_decoder;
@@ -174,6 +178,9 @@ bool Audio::setSourceFileName(QString filename)
 
     setTotalDuration(m_decoder->totalTime());
 
+    if (m_preload)
+        loadClip();
+
     emit changed(id());
 
     return true;
@@ -191,7 +198,17 @@ AudioDecoder *Audio::getAudioDecoder()
 
 void Audio::setAudioDevice(QString dev)
 {
+    if (dev == m_audioDevice)
+        return;
+
     m_audioDevice = dev;
+
+    // a preloaded renderer is bound to the previous device
+    if (m_clip != NULL && m_audio_out != NULL && isRunning() == false)
+    {
+        delete m_audio_out;
+        m_audio_out = createRenderer();
+    }
 }
 
 QString Audio::audioDevice()
@@ -199,23 +216,133 @@ QString Audio::audioDevice()
     return m_audioDevice;
 }
 
+void Audio::setPreload(bool enable)
+{
+    if (enable == m_preload)
+        return;
+
+    m_preload = enable;
+
+    if (m_preload)
+        loadClip();
+    else
+        unloadClip();
+
+    emit changed(id());
+}
+
+bool Audio::preload() const
+{
+    return m_preload;
+}
+
+bool Audio::isPreloaded() const
+{
+    return m_clip != NULL;
+}
+
+qint64 Audio::playbackTime() const
+{
+    AudioMixerStream *stream = m_stream;
+    if (stream != NULL)
+    {
+        qint64 played = stream->playbackTime();
+        return played < 0 ? -1 : m_playbackOffset + played;
+    }
+
+    AudioRenderer *renderer = m_audio_out;
+    if (renderer == NULL)
+        return -1;
+
+    qint64 played = renderer->playbackTime();
+    if (played < 0)
+        return -1;
+
+    return m_playbackOffset + played;
+}
+
+void Audio::loadClip()
+{
+    if (m_clip != NULL || m_decoder == NULL || isRunning())
+        return;
+
+    AudioPluginCache *cache = m_doc->audioPluginCache();
+    m_clip = AudioClipDecoder::load(m_decoder, cache->preloadBytesAvailable());
+    if (m_clip == NULL)
+    {
+        qWarning() << "[Audio]" << m_sourceFileName << "doesn't fit in the preload budget";
+        return;
+    }
+
+    cache->adjustPreloadBytes(m_clip->size());
+
+    // keep a renderer ready for an immediate start
+    if (m_audio_out == NULL)
+        m_audio_out = createRenderer();
+}
+
+void Audio::unloadClip()
+{
+    if (m_clip == NULL)
+        return;
+
+    if (m_audio_out != NULL && isRunning() == false)
+    {
+        m_audio_out->stop();
+        delete m_audio_out;
+        m_audio_out = NULL;
+    }
+
+    m_doc->audioPluginCache()->adjustPreloadBytes(-m_clip->size());
+    delete m_clip;
+    m_clip = NULL;
+}
+
+AudioRenderer *Audio::createRenderer()
+{
+    AudioDecoder *decoder = m_clip != NULL ? m_clip : m_decoder;
+    AudioParameters ap = decoder->audioParameters();
+    AudioRenderer *renderer = m_doc->audioPluginCache()->createRenderer(m_audioDevice);
+
+    renderer->initialize(ap.sampleRate(), ap.channels(), ap.format());
+    connect(renderer, SIGNAL(endOfStreamReached()),
+            this, SLOT(slotEndOfStream()));
+
+    return renderer;
+}
+
 int Audio::adjustAttribute(qreal fraction, int attributeId)
 {
     int attrIndex = Function::adjustAttribute(fraction, attributeId);
 
-    if (m_audio_out != NULL && attrIndex == Intensity)
-        m_audio_out->adjustIntensity(getAttributeValue(Function::Intensity));
+    if (attrIndex == Intensity)
+    {
+        if (m_stream != NULL)
+            m_stream->adjustIntensity(getAttributeValue(Function::Intensity));
+        else if (m_audio_out != NULL)
+            m_audio_out->adjustIntensity(getAttributeValue(Function::Intensity));
+    }
 
     return attrIndex;
 }
 
 void Audio::slotEndOfStream()
 {
+    if (m_stream != NULL)
+    {
+        m_mixer->removeStream(m_stream);
+        m_stream = NULL;
+        m_decoder->seek(0);
+    }
     if (m_audio_out != NULL)
     {
         m_audio_out->stop();
-        m_audio_out->deleteLater();
-        m_audio_out = NULL;
+        // a preloaded clip keeps its renderer for the next start
+        if (m_clip == NULL)
+        {
+            m_audio_out->deleteLater();
+            m_audio_out = NULL;
+        }
         m_decoder->seek(0);
     }
     if (!stopped())
@@ -252,6 +379,9 @@ bool Audio::saveXML(QXmlStreamWriter *doc)
     if (m_audioDevice.isEmpty() == false)
         doc->writeAttribute(KXMLQLCAudioDevice, m_audioDevice);
 
+    if (m_preload)
+        doc->writeAttribute(KXMLQLCAudioPreload, KXMLQLCTrue);
+
     doc->writeCharacters(m_doc->normalizeComponentPath(m_sourceFileName));
 
     doc->writeEndElement();
@@ -288,6 +418,10 @@ bool Audio::loadXML(QXmlStreamReader &root)
             if (attrs.hasAttribute(KXMLQLCAudioDevice))
                 setAudioDevice(attrs.value(KXMLQLCAudioDevice).toString());
 
+            // the clip is then decoded when the source is set
+            if (attrs.value(KXMLQLCAudioPreload).toString() == KXMLQLCTrue)
+                m_preload = true;
+
             setSourceFileName(m_doc->denormalizeComponentPath(root.readElementText()));
         }
         else if (root.name() == KXMLQLCFunctionSpeed)
@@ -321,29 +455,32 @@ void Audio::preRun(MasterTimer* timer)
 {
     if (m_decoder != NULL)
     {
-        m_decoder->seek(elapsed());
-        AudioParameters ap = m_decoder->audioParameters();
-#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
- #if defined(__APPLE__) || defined(Q_OS_MAC)
-        //m_audio_out = new AudioRendererCoreAudio();
-        m_audio_out = new AudioRendererPortAudio(m_audioDevice);
- #elif defined(WIN32) || defined(Q_OS_WIN)
-        m_audio_out = new AudioRendererWaveOut(m_audioDevice);
- #else
-        m_audio_out = new AudioRendererAlsa(m_audioDevice);
- #endif
-        m_audio_out->moveToThread(QCoreApplication::instance()->thread());
-#else
-        m_audio_out = new AudioRendererQt(m_audioDevice, doc());
-#endif
-        m_audio_out->setDecoder(m_decoder);
-        m_audio_out->initialize(ap.sampleRate(), ap.channels(), ap.format());
-        m_audio_out->adjustIntensity(getAttributeValue(Intensity));
-        m_audio_out->setFadeIn(fadeInSpeed());
-        m_audio_out->setLooped(runOrder() == Audio::Loop);
-        m_audio_out->start();
-        connect(m_audio_out, SIGNAL(endOfStreamReached()),
-                this, SLOT(slotEndOfStream()));
+        AudioDecoder *decoder = m_clip != NULL ? m_clip : m_decoder;
+        m_playbackOffset = elapsed();
+        decoder->seek(m_playbackOffset);
+
+        // concurrent Audio functions share the mixer of their device
+        AudioMixer *mixer = m_doc->audioPluginCache()->mixer(m_audioDevice);
+        if (mixer != NULL && mixer->accepts(decoder->audioParameters()))
+        {
+            m_mixer = mixer;
+            m_stream = m_mixer->addStream(decoder, runOrder() == Audio::Loop);
+            m_stream->adjustIntensity(getAttributeValue(Intensity));
+            m_stream->setFadeIn(fadeInSpeed());
+            connect(m_stream, SIGNAL(endOfStreamReached()),
+                    this, SLOT(slotEndOfStream()));
+        }
+        else
+        {
+            if (m_audio_out == NULL)
+                m_audio_out = createRenderer();
+
+            m_audio_out->setDecoder(decoder);
+            m_audio_out->adjustIntensity(getAttributeValue(Intensity));
+            m_audio_out->setFadeIn(fadeInSpeed());
+            m_audio_out->setLooped(runOrder() == Audio::Loop);
+            m_audio_out->start();
+        }
     }
 
     Function::preRun(timer);
@@ -353,7 +490,11 @@ void Audio::setPause(bool enable)
 {
     if (isRunning())
     {
-        if (m_audio_out != NULL)
+        if (m_stream != NULL)
+        {
+            m_stream->setPaused(enable);
+        }
+        else if (m_audio_out != NULL)
         {
             if (enable)
                 m_audio_out->suspend();
@@ -377,8 +518,13 @@ void Audio::write(MasterTimer* timer, QList<Universe *> universes)
 
     if (fadeOutSpeed() != 0)
     {
-        if (m_audio_out != NULL && totalDuration() - elapsed() <= fadeOutSpeed())
-            m_audio_out->setFadeOut(fadeOutSpeed());
+        if (totalDuration() - elapsed() <= fadeOutSpeed())
+        {
+            if (m_stream != NULL)
+                m_stream->setFadeOut(fadeOutSpeed());
+            else if (m_audio_out != NULL)
+                m_audio_out->setFadeOut(fadeOutSpeed());
+        }
     }
 }
 
@@ -27,6 +27,9 @@
 #include "function.h"
 
 class QXmlStreamReader;
+class AudioClipDecoder;
+class AudioMixerStream;
+class AudioMixer;
 
 /** @addtogroup engine_functions Functions
  * @{
@@ -114,6 +117,26 @@ public:
      */
     QString audioDevice();
 
+    /**
+     * Enable/disable the preloading of the whole decoded audio in memory,
+     * together with the renderer, so that the playback can start right away.
+     * The clip is preloaded only if it fits in the global preload budget
+     */
+    void setPreload(bool enable);
+
+    /** Returns true if the audio file should be preloaded */
+    bool preload() const;
+
+    /** Returns true if the audio file is actually preloaded in memory */
+    bool isPreloaded() const;
+
+    /**
+     * Returns the position in milliseconds of the audio actually heard,
+     * which lags behind elapsed() by the output latency, or -1 if
+     * the audio is not playing
+     */
+    qint64 playbackTime() const;
+
     int adjustAttribute(qreal fraction, int attributeId);
 
 signals:
@@ -122,11 +145,26 @@ signals:
 protected slots:
     void slotEndOfStream();
 
+private:
+    /** Decode the whole source file in memory, if the budget allows it */
+    void loadClip();
+
+    /** Release the decoded clip and its renderer */
+    void unloadClip();
+
+    /** Create a renderer for the configured audio device */
+    AudioRenderer *createRenderer();
+
 private:
     /** Instance of an AudioDecoder to perform actual audio decoding */
     AudioDecoder *m_decoder;
     /** output interface to render audio data got from m_decoder */
     AudioRenderer *m_audio_out;
+    /** The mixer of the device rendering m_stream */
+    AudioMixer *m_mixer;
+    /** The stream of the decoder in m_mixer, used instead of m_audio_out
+     *  when the audio can be mixed with the other Audio functions */
+    AudioMixerStream *m_stream;
     /** Audio device to use for rendering */
     QString m_audioDevice;
     /** Absolute start time of Audio over a timeline (in milliseconds) */
@@ -139,6 +177,12 @@ private:
     QString m_sourceFileName;
     /** Duration of the media object */
     qint64 m_audioDuration;
+    /** Flag to indicate if the audio file should be preloaded */
+    bool m_preload;
+    /** The whole audio file decoded in memory, when preloaded */
+    AudioClipDecoder *m_clip;
+    /** The position of the file where the playback has started */
+    qint64 m_playbackOffset;
 
     /*********************************************************************
      * Save & Load
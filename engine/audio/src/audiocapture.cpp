@@ -21,6 +21,8 @@
 #include <QSettings>
 #include <QDebug>
 #include <qmath.h>
+#include <cstdlib>
+#include <cstring>
 
 #include "audiocapture.h"
 
@@ -32,6 +34,70 @@
 #define CLEAR_FFT_NOISE
 #define M_2PI       6.28318530718           /* 2*pi */
 
+/****************************************************************************
+ * AudioSpectrum
+ ****************************************************************************/
+
+AudioSpectrum::AudioSpectrum(int bandsNumber)
+    : m_bandsNumber(qBound(0, bandsNumber, FREQ_SUBBANDS_MAX_NUMBER))
+    , m_latest(-1)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        m_slots[i].m_maxMagnitude = 0;
+        m_slots[i].m_power = 0;
+    }
+}
+
+int AudioSpectrum::bandsNumber() const
+{
+    return m_bandsNumber;
+}
+
+void AudioSpectrum::publish(const double *bands, double maxMagnitude, quint32 power)
+{
+    int index = (m_latest.loadAcquire() + 1) % 3;
+    Slot &slot = m_slots[index];
+
+    slot.m_sequence.fetchAndAddOrdered(1);
+    memcpy(slot.m_bands, bands, m_bandsNumber * sizeof(double));
+    slot.m_maxMagnitude = maxMagnitude;
+    slot.m_power = power;
+    slot.m_sequence.fetchAndAddOrdered(1);
+
+    m_latest.storeRelease(index);
+}
+
+bool AudioSpectrum::read(QVector<double> &bands, double &maxMagnitude, quint32 &power) const
+{
+    bands.resize(m_bandsNumber);
+
+    forever
+    {
+        int index = m_latest.loadAcquire();
+        if (index < 0)
+            return false;
+
+        Slot &slot = const_cast<Slot &>(m_slots[index]);
+        int sequence = slot.m_sequence.loadAcquire();
+        if (sequence & 1)
+            continue;
+
+        memcpy(bands.data(), slot.m_bands, m_bandsNumber * sizeof(double));
+        maxMagnitude = slot.m_maxMagnitude;
+        power = slot.m_power;
+
+        // An ordered read-modify-write, so that the copy above
+        // cannot be reordered after the sequence check
+        if (slot.m_sequence.fetchAndAddOrdered(0) == sequence)
+            return true;
+    }
+}
+
+/****************************************************************************
+ * AudioCapture
+ ****************************************************************************/
+
 AudioCapture::AudioCapture (QObject* parent)
     : QThread (parent)
     , m_userStop(true)
@@ -40,9 +106,9 @@ AudioCapture::AudioCapture (QObject* parent)
     , m_sampleRate(0)
     , m_channels(0)
     , m_audioBuffer(NULL)
-    , m_audioMixdown(NULL)
     , m_fftInputBuffer(NULL)
     , m_fftOutputBuffer(NULL)
+    , m_fftPlan(NULL)
 {
     bufferSize = AUDIO_DEFAULT_BUFFER_SIZE;
     m_sampleRate = AUDIO_DEFAULT_SAMPLE_RATE;
@@ -64,10 +130,45 @@ AudioCapture::AudioCapture (QObject* parent)
     m_captureSize = bufferSize * m_channels;
 
     m_audioBuffer = new int16_t[m_captureSize];
-    m_audioMixdown = new int16_t[bufferSize];
     m_fftInputBuffer = new double[bufferSize];
+
+    m_fftWindow.resize(bufferSize);
+    for (unsigned int i = 0; i < bufferSize; i++)
+    {
+#ifdef USE_BLACKMAN
+        double a0 = (1-0.16)/2;
+        double a1 = 0.5;
+        double a2 = 0.16/2;
+        m_fftWindow[i] = (a0 - a1 * qCos((M_2PI * i) / (bufferSize - 1)) +
+                          a2 * qCos((2 * M_2PI * i) / (bufferSize - 1))) / 32768.;
+#endif
+#ifdef USE_HANNING
+        m_fftWindow[i] = (0.5 * (1.00 - qCos((M_2PI * i) / (bufferSize - 1)))) / 32768.;
+#endif
+#ifdef USE_NO_WINDOW
+        m_fftWindow[i] = 1. / 32768.;
+#endif
+    }
+
 #ifdef HAS_FFTW3
     m_fftOutputBuffer = fftw_malloc(sizeof(fftw_complex) * bufferSize);
+
+    // Measuring the best plan takes a while, so the result
+    // is kept in the settings for the next captures
+    QByteArray wisdom = settings.value(SETTINGS_AUDIO_FFT_WISDOM).toByteArray();
+    if (wisdom.isEmpty() == false)
+        fftw_import_wisdom_from_string(wisdom.constData());
+
+    m_fftPlan = fftw_plan_dft_r2c_1d(bufferSize, m_fftInputBuffer,
+                                     (fftw_complex*)m_fftOutputBuffer, FFTW_MEASURE);
+
+    char *newWisdom = fftw_export_wisdom_to_string();
+    if (newWisdom != NULL)
+    {
+        if (wisdom != newWisdom)
+            settings.setValue(SETTINGS_AUDIO_FFT_WISDOM, QByteArray(newWisdom));
+        free(newWisdom);
+    }
 #endif
 }
 
@@ -77,9 +178,10 @@ AudioCapture::~AudioCapture()
     Q_ASSERT(!this->isRunning());
 
     delete[] m_audioBuffer;
-    delete[] m_audioMixdown;
     delete[] m_fftInputBuffer;
 #ifdef HAS_FFTW3
+    if (m_fftPlan)
+        fftw_destroy_plan((fftw_plan)m_fftPlan);
     if (m_fftOutputBuffer)
         fftw_free(m_fftOutputBuffer);
 #endif
@@ -90,12 +192,13 @@ int AudioCapture::defaultBarsNumber()
     return FREQ_SUBBANDS_DEFAULT_NUMBER;
 }
 
-void AudioCapture::registerBandsNumber(int number)
+QSharedPointer<AudioSpectrum> AudioCapture::registerBandsNumber(int number)
 {
     qDebug() << "[AudioCapture] registering" << number << "bands";
 
     QMutexLocker locker(&m_mutex);
 
+    QSharedPointer<AudioSpectrum> spectrum;
     bool firstBand = m_fftMagnitudeMap.isEmpty();
     if (number > 0 && number <= FREQ_SUBBANDS_MAX_NUMBER)
     {
@@ -104,17 +207,22 @@ void AudioCapture::registerBandsNumber(int number)
             BandsData newBands;
             newBands.m_registerCounter = 1;
             newBands.m_fftMagnitudeBuffer = QVector<double>(number);
+            newBands.m_spectrum = QSharedPointer<AudioSpectrum>(new AudioSpectrum(number));
             m_fftMagnitudeMap[number] = newBands;
         }
         else
             m_fftMagnitudeMap[number].m_registerCounter++;
 
+        spectrum = m_fftMagnitudeMap[number].m_spectrum;
+
         if (firstBand)
         {
             locker.unlock();
             start();
         }
     }
+
+    return spectrum;
 }
 
 void AudioCapture::unregisterBandsNumber(int number)
@@ -137,6 +245,24 @@ void AudioCapture::unregisterBandsNumber(int number)
     }
 }
 
+void AudioCapture::setBeatDetection(bool enable)
+{
+    qDebug() << "[AudioCapture] beat detection" << enable;
+
+    if (enable)
+        m_beatDetectorReset.storeRelease(1);
+    m_beatDetection.storeRelease(enable ? 1 : 0);
+}
+
+void AudioCapture::setTimecodeDecoding(bool enable)
+{
+    qDebug() << "[AudioCapture] timecode decoding" << enable;
+
+    if (enable)
+        m_timecodeDecoderReset.storeRelease(1);
+    m_timecodeDecoding.storeRelease(enable ? 1 : 0);
+}
+
 void AudioCapture::stop()
 {
     qDebug() << "[AudioCapture] stop capture";
@@ -155,21 +281,20 @@ double AudioCapture::fillBandsData(int number)
     // for the number of desired bands.
     double maxMagnitude = 0.;
 #ifdef HAS_FFTW3
-    unsigned int i = 1; // skip DC bin
+    int i = 1; // skip DC bin
     int subBandWidth = ((bufferSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate) / number;
+    const double *magnitudes = m_fftMagnitudes.constData();
+    double *bands = m_fftMagnitudeMap[number].m_fftMagnitudeBuffer.data();
 
     for (int b = 0; b < number; b++)
     {
+        int end = qMin(i + subBandWidth, m_fftMagnitudes.size());
         double magnitudeSum = 0.;
-        for (int s = 0; s < subBandWidth; s++, i++)
-        {
-            if (i == bufferSize)
-                break;
-            magnitudeSum += qSqrt((((fftw_complex*)m_fftOutputBuffer)[i][0] * ((fftw_complex*)m_fftOutputBuffer)[i][0]) +
-                                  (((fftw_complex*)m_fftOutputBuffer)[i][1] * ((fftw_complex*)m_fftOutputBuffer)[i][1]));
-        }
+        for (; i < end; i++)
+            magnitudeSum += magnitudes[i];
+
         double bandMagnitude = (magnitudeSum / (subBandWidth * M_2PI));
-        m_fftMagnitudeMap[number].m_fftMagnitudeBuffer[b] = bandMagnitude;
+        bands[b] = bandMagnitude;
         if (maxMagnitude < bandMagnitude)
             maxMagnitude = bandMagnitude;
     }
@@ -186,45 +311,32 @@ void AudioCapture::processData()
     double pwrSum = 0.;
     double maxMagnitude = 0.;
 
-    // 1 ********* Initialize FFTW
-    fftw_plan plan_forward;
-    plan_forward = fftw_plan_dft_r2c_1d(bufferSize, m_fftInputBuffer, (fftw_complex*)m_fftOutputBuffer , 0);
-
-    // 2 ********* Apply a window to audio data
-    // *********** and convert it to doubles
+    // 1 ********* Mix down the channels to mono, apply
+    // *********** the window and convert the samples to doubles
+    const double *window = m_fftWindow.constData();
 
-    // Mix down the channels to mono
-    for (i = 0; i < bufferSize; i++)
+    if (m_channels == 1)
     {
-        m_audioMixdown[i] = 0;
-        for (j = 0; j < m_channels; j++)
-        {
-            m_audioMixdown[i] += m_audioBuffer[i*m_channels + j] / m_channels;
-        }
+        for (i = 0; i < bufferSize; i++)
+            m_fftInputBuffer[i] = m_audioBuffer[i] * window[i];
     }
-
-    for (i = 0; i < bufferSize; i++)
+    else
     {
-#ifdef USE_BLACKMAN
-        double a0 = (1-0.16)/2;
-        double a1 = 0.5;
-        double a2 = 0.16/2;
-        m_fftInputBuffer[i] = m_audioMixdown[i] * (a0 - a1 * qCos((M_2PI * i) / (bufferSize - 1)) +
-                              a2 * qCos((2 * M_2PI * i) / (bufferSize - 1))) / 32768.;
-#endif
-#ifdef USE_HANNING
-        m_fftInputBuffer[i] = m_audioMixdown[i] * (0.5 * (1.00 - qCos((M_2PI * i) / (bufferSize - 1)))) / 32768.;
-#endif
-#ifdef USE_NO_WINDOW
-        m_fftInputBuffer[i] = (double)m_audioMixdown[i] / 32768.;
-#endif
+        double channelScale = 1. / m_channels;
+        for (i = 0; i < bufferSize; i++)
+        {
+            int mixdown = 0;
+            const int16_t *frame = m_audioBuffer + i * m_channels;
+            for (j = 0; j < m_channels; j++)
+                mixdown += frame[j];
+            m_fftInputBuffer[i] = mixdown * channelScale * window[i];
+        }
     }
 
-    // 3 ********* Perform FFT
-    fftw_execute(plan_forward);
-    fftw_destroy_plan(plan_forward);
+    // 2 ********* Perform FFT
+    fftw_execute((fftw_plan)m_fftPlan);
 
-    // 4 ********* Clear FFT noise
+    // 3 ********* Clear FFT noise
 #ifdef CLEAR_FFT_NOISE
     //We delete some values since these will ruin our output
     for (int n = 0; n < 5; n++)
@@ -234,6 +346,27 @@ void AudioCapture::processData()
     }
 #endif
 
+    // 4 ********* Compute the magnitude of the bins used by the bands
+    unsigned int binsCount = qMin(bufferSize, (bufferSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate + 1);
+    m_fftMagnitudes.resize(binsCount);
+    double *magnitudes = m_fftMagnitudes.data();
+    const fftw_complex *spectrum = (const fftw_complex*)m_fftOutputBuffer;
+    for (i = 0; i < binsCount; i++)
+        magnitudes[i] = qSqrt(spectrum[i][0] * spectrum[i][0] + spectrum[i][1] * spectrum[i][1]);
+
+    // Look for beats as soon as the spectrum is known, to keep the latency low
+    if (m_beatDetection.loadAcquire())
+    {
+        if (m_beatDetectorReset.fetchAndStoreOrdered(0))
+            m_beatDetector.reset();
+
+        if (m_beatDetector.process(magnitudes, binsCount, m_beatClock.elapsed()))
+        {
+            int delay = int(latency()) + (bufferSize * 1000) / m_sampleRate;
+            emit beatDetected(m_beatDetector.bpm(), delay);
+        }
+    }
+
     // 5 ********* Calculate the average signal power
     foreach(int barsNumber, m_fftMagnitudeMap.keys())
     {
@@ -244,6 +377,8 @@ void AudioCapture::processData()
             pwrSum += m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer[n];
         }
         m_signalPower = 32768 * pwrSum * qSqrt(M_2PI) / (double)barsNumber;
+        m_fftMagnitudeMap[barsNumber].m_spectrum->publish(m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.constData(),
+                                                          maxMagnitude, m_signalPower);
         emit dataProcessed(m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.data(),
                            m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.size(),
                            maxMagnitude, m_signalPower);
@@ -251,11 +386,28 @@ void AudioCapture::processData()
 #endif
 }
 
+void AudioCapture::decodeTimecode()
+{
+    if (m_timecodeDecoding.loadAcquire() == 0)
+        return;
+
+    if (m_timecodeDecoderReset.fetchAndStoreOrdered(0))
+        m_timecodeDecoder.setSampleRate(m_sampleRate);
+
+    // the timecode is read from the first channel only
+    if (m_timecodeDecoder.process(m_audioBuffer, bufferSize, m_channels))
+    {
+        int delay = int(latency()) + (m_timecodeDecoder.samplesAfterFrame() * 1000) / m_sampleRate;
+        emit timecodeDecoded(m_timecodeDecoder.position(), delay);
+    }
+}
+
 void AudioCapture::run()
 {
     qDebug() << "[AudioCapture] start capture";
 
     m_userStop = false;
+    m_beatClock.start();
 
     if (!initialize())
     {
@@ -269,6 +421,8 @@ void AudioCapture::run()
         {
             if (readAudio(m_captureSize) == true)
             {
+                decodeTimecode();
+
                 QMutexLocker locker(&m_mutex);
                 processData();
             }
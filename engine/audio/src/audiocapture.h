@@ -22,14 +22,21 @@
 #define AUDIOCAPTURE_H
 
 #include <stdint.h>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QAtomicInt>
 #include <QThread>
 #include <QVector>
 #include <QMutex>
 #include <QMap>
 
+#include "beatdetector.h"
+#include "ltcdecoder.h"
+
 #define SETTINGS_AUDIO_INPUT_DEVICE   "audio/input"
 #define SETTINGS_AUDIO_INPUT_SRATE    "audio/samplerate"
 #define SETTINGS_AUDIO_INPUT_CHANNELS "audio/channels"
+#define SETTINGS_AUDIO_FFT_WISDOM     "audio/fftwisdom"
 
 #define AUDIO_DEFAULT_SAMPLE_RATE     44100
 #define AUDIO_DEFAULT_CHANNELS        1
@@ -43,10 +50,49 @@
  * @{
  */
 
+/**
+ * The latest spectrum computed by AudioCapture for a number of bands.
+ * It is written by the capture thread only and can be read at any
+ * time by any thread, without locks: the capture thread rotates
+ * three slots, so that it never writes the slot last published,
+ * and readers retry in the unlikely case a slot got reused while
+ * they were copying it.
+ */
+class AudioSpectrum
+{
+public:
+    AudioSpectrum(int bandsNumber);
+
+    int bandsNumber() const;
+
+    /** Publish a new spectrum. To be called by the capture thread only */
+    void publish(const double *bands, double maxMagnitude, quint32 power);
+
+    /** Copy the latest published spectrum. Returns false if
+     *  no spectrum has been published yet */
+    bool read(QVector<double> &bands, double &maxMagnitude, quint32 &power) const;
+
+private:
+    struct Slot
+    {
+        /** Odd while the capture thread is writing the slot */
+        QAtomicInt m_sequence;
+        double m_bands[FREQ_SUBBANDS_MAX_NUMBER];
+        double m_maxMagnitude;
+        quint32 m_power;
+    };
+
+    int m_bandsNumber;
+    Slot m_slots[3];
+    /** The index of the last published slot, -1 if none */
+    QAtomicInt m_latest;
+};
+
 struct BandsData
 {
     int m_registerCounter;
     QVector<double> m_fftMagnitudeBuffer;
+    QSharedPointer<AudioSpectrum> m_spectrum;
 };
 
 class AudioCapture : public QThread
@@ -65,9 +111,10 @@ public:
 
     /**
      * Request the given number of frequency bands to the
-     * audiocapture engine
+     * audiocapture engine. The returned spectrum can be read
+     * at any time to get the latest values of the bands.
      */
-    void registerBandsNumber(int number);
+    QSharedPointer<AudioSpectrum> registerBandsNumber(int number);
 
     /**
      * Cancel a previous request of bars
@@ -77,6 +124,21 @@ public:
 
     static int maxFrequency() { return SPECTRUM_MAX_FREQUENCY; }
 
+    /**
+     * Enable or disable the detection of beats on the captured audio.
+     * Beats are detected only while some bands are registered, and
+     * reported by the beatDetected() signal, emitted by the capture thread
+     */
+    void setBeatDetection(bool enable);
+
+    /**
+     * Enable or disable the decoding of the LTC timecode carried by the
+     * first channel of the captured audio. Timecode is decoded only while
+     * some bands are registered, and reported by the timecodeDecoded()
+     * signal, emitted by the capture thread
+     */
+    void setTimecodeDecoding(bool enable);
+
     protected:
     /*!
      * Prepares object for usage and setups required audio parameters.
@@ -130,11 +192,25 @@ private:
      */
     void processData();
 
+    /** Look for LTC frames in the captured audio data */
+    void decodeTimecode();
+
     bool m_userStop, m_pause;
 
 signals:
     void dataProcessed(double *spectrumBands, int size, double maxMagnitude, quint32 power);
 
+    /** Emitted from the capture thread when a beat is detected. $bpm is the
+     *  estimated tempo (0 if still unknown) and $delay is the time in ms
+     *  elapsed since the beat was played, as measured from the input latency
+     *  and the duration of the capture buffer */
+    void beatDetected(int bpm, int delay);
+
+    /** Emitted from the capture thread when a LTC frame is decoded. $position
+     *  is the timecode in ms at the end of the frame and $delay is the time
+     *  in ms elapsed since then, as for beatDetected() */
+    void timecodeDecoded(qint64 position, int delay);
+
 protected:
     /*!
      * Reads up to \b maxSize uint16 from \b the input interface device.
@@ -149,7 +225,6 @@ protected:
 
     /** Data buffer for audio data coming from the sound card */
     int16_t *m_audioBuffer;
-    int16_t *m_audioMixdown;
 
     quint32 m_signalPower;
 
@@ -157,8 +232,33 @@ protected:
     double *m_fftInputBuffer;
     void *m_fftOutputBuffer;
 
+    /** The FFTW plan transforming m_fftInputBuffer into m_fftOutputBuffer,
+     *  created once for the lifetime of the capture */
+    void *m_fftPlan;
+
+    /** The window applied to the mixed down samples, including
+     *  the conversion of 16 bit samples to the [-1.0, 1.0] range */
+    QVector<double> m_fftWindow;
+
+    /** The magnitude of the spectrum bins up to SPECTRUM_MAX_FREQUENCY,
+     *  computed once per buffer and shared by all the registered bands */
+    QVector<double> m_fftMagnitudes;
+
     /** Map of the registered clients (key is the number of bands) */
     QMap <int, BandsData> m_fftMagnitudeMap;
+
+    /** **************** Beat detection ********************** */
+    QAtomicInt m_beatDetection;
+    /** Raised by setBeatDetection() to reset m_beatDetector from the capture thread */
+    QAtomicInt m_beatDetectorReset;
+    BeatDetector m_beatDetector;
+    QElapsedTimer m_beatClock;
+
+    /** **************** Timecode decoding ********************** */
+    QAtomicInt m_timecodeDecoding;
+    /** Raised by setTimecodeDecoding() to reset m_timecodeDecoder from the capture thread */
+    QAtomicInt m_timecodeDecoderReset;
+    LTCDecoder m_timecodeDecoder;
 };
 
 /** @} */
@@ -20,11 +20,13 @@
 #include <QDebug>
 #include <QSettings>
 
+#include "audiorenderer_alsa.h"
 #include "audiocapture_alsa.h"
 
 AudioCaptureAlsa::AudioCaptureAlsa(QObject * parent)
     : AudioCapture(parent)
     , m_captureHandle(NULL)
+    , m_useMmap(false)
 {
 }
 
@@ -47,6 +49,17 @@ bool AudioCaptureAlsa::initialize()
 
     pcm_name = strdup(dev_name.toLatin1().data());
 
+    m_useMmap = settings.value(SETTINGS_AUDIO_ALSA_INPUT_MMAP, false).toBool();
+    snd_pcm_uframes_t bufferFrames = settings.value(SETTINGS_AUDIO_ALSA_INPUT_BUFFER, 0).toUInt();
+    snd_pcm_uframes_t periodFrames = settings.value(SETTINGS_AUDIO_ALSA_INPUT_PERIOD, 0).toUInt();
+    if (periodFrames == 0)
+        periodFrames = bufferSize;
+
+    // initialize() runs in the capture thread
+    int priority = settings.value(SETTINGS_AUDIO_ALSA_INPUT_PRIORITY, 0).toInt();
+    if (priority > 0)
+        AudioRendererAlsa::setRealtimePriority(priority);
+
     qDebug() << "AudioCaptureAlsa: initializing device " << pcm_name;
 
     Q_ASSERT(m_captureHandle == NULL);
@@ -57,7 +70,7 @@ bool AudioCaptureAlsa::initialize()
         qWarning("cannot allocate hardware parameter structure (%s)\n", snd_strerror (err));
     else if ((err = snd_pcm_hw_params_any (m_captureHandle, hw_params)) < 0)
         qWarning("cannot initialize hardware parameter structure (%s)\n", snd_strerror (err));
-    else if ((err = snd_pcm_hw_params_set_access (m_captureHandle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0)
+    else if ((err = setAccess (hw_params)) < 0)
         qWarning("cannot set access type (%s)\n", snd_strerror (err));
     else if ((err = snd_pcm_hw_params_set_format (m_captureHandle, hw_params, SND_PCM_FORMAT_S16_LE)) < 0)
         qWarning("cannot set sample format (%s)\n", snd_strerror (err));
@@ -65,11 +78,25 @@ bool AudioCaptureAlsa::initialize()
         qWarning("cannot set sample rate (%s)\n", snd_strerror (err));
     else if ((err = snd_pcm_hw_params_set_channels (m_captureHandle, hw_params, m_channels)) < 0)
         qWarning("cannot set channel count to %d (%s)\n", m_channels, snd_strerror (err));
+    else if ((err = snd_pcm_hw_params_set_period_size_near (m_captureHandle, hw_params, &periodFrames, 0)) < 0)
+        qWarning("cannot set period size (%s)\n", snd_strerror (err));
+    else if (bufferFrames > 0 &&
+             (err = snd_pcm_hw_params_set_buffer_size_near (m_captureHandle, hw_params, &bufferFrames)) < 0)
+        qWarning("cannot set buffer size (%s)\n", snd_strerror (err));
     else if ((err = snd_pcm_hw_params (m_captureHandle, hw_params)) < 0)
         qWarning("cannot set parameters (%s)\n", snd_strerror (err));
     else if ((err = snd_pcm_prepare (m_captureHandle)) < 0)
         qWarning("cannot prepare audio interface for use (%s)\n", snd_strerror (err));
 
+    if (err >= 0)
+    {
+        snd_pcm_hw_params_get_buffer_size(hw_params, &bufferFrames);
+        snd_pcm_hw_params_get_period_size(hw_params, &periodFrames, 0);
+        qDebug("AudioCaptureAlsa: buffer %lu frames, period %lu frames, %s access, %lu ms latency",
+               bufferFrames, periodFrames, m_useMmap ? "mmap" : "read/write",
+               m_sampleRate ? periodFrames * 1000 / m_sampleRate : 0);
+    }
+
     if (hw_params)
         snd_pcm_hw_params_free (hw_params);
 
@@ -86,6 +113,21 @@ bool AudioCaptureAlsa::initialize()
     return true;
 }
 
+int AudioCaptureAlsa::setAccess(snd_pcm_hw_params_t *hw_params)
+{
+    if (m_useMmap)
+    {
+        int err = snd_pcm_hw_params_set_access(m_captureHandle, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+        if (err >= 0)
+            return err;
+
+        qWarning("cannot set mmap access (%s), using read/write\n", snd_strerror (err));
+        m_useMmap = false;
+    }
+
+    return snd_pcm_hw_params_set_access(m_captureHandle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+}
+
 void AudioCaptureAlsa::uninitialize()
 {
     Q_ASSERT(m_captureHandle != NULL);
@@ -95,7 +137,15 @@ void AudioCaptureAlsa::uninitialize()
 
 qint64 AudioCaptureAlsa::latency()
 {
-    return 0; // TODO
+    if (m_captureHandle == NULL || m_sampleRate == 0)
+        return 0;
+
+    // the frames already captured by the device but not read yet
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(m_captureHandle, &delay) < 0 || delay < 0)
+        return 0;
+
+    return qint64(delay) * 1000 / m_sampleRate;
 }
 
 void AudioCaptureAlsa::suspend()
@@ -110,15 +160,25 @@ bool AudioCaptureAlsa::readAudio(int maxSize)
 {
     Q_ASSERT(m_captureHandle != NULL);
 
-    int read;
-    if ((read = snd_pcm_readi (m_captureHandle, m_audioBuffer, maxSize)) != maxSize)
+    // maxSize is in samples, ALSA reads frames
+    snd_pcm_uframes_t frames = maxSize / m_channels;
+    snd_pcm_sframes_t read;
+
+    if (m_useMmap)
+        read = snd_pcm_mmap_readi (m_captureHandle, m_audioBuffer, frames);
+    else
+        read = snd_pcm_readi (m_captureHandle, m_audioBuffer, frames);
+
+    if (read != snd_pcm_sframes_t(frames))
     {
         qWarning() << "[ALSA readAudio] read from audio interface failed (" << snd_strerror(read) << ")";
+        // recover from overruns and suspends, so the next read can succeed
+        if (read < 0)
+            snd_pcm_recover(m_captureHandle, read, 1);
         return false;
     }
 
     //qDebug() << "Audio sample #0:" << m_audioBuffer[0] << ", #max:" << m_audioBuffer[m_captureSize - 1];
-    qDebug() << "[ALSA readAudio] " << maxSize << "bytes read";
 
     return true;
 }
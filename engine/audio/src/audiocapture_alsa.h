@@ -31,6 +31,15 @@ extern "C"
  * @{
  */
 
+/** Requested device buffer and period, in frames. When the period is 0,
+ *  it is set to the capture buffer size, so each read takes one period */
+#define SETTINGS_AUDIO_ALSA_INPUT_BUFFER   "audio/alsainputbuffer"
+#define SETTINGS_AUDIO_ALSA_INPUT_PERIOD   "audio/alsainputperiod"
+/** Read the samples through mmap access instead of read/write */
+#define SETTINGS_AUDIO_ALSA_INPUT_MMAP     "audio/alsainputmmap"
+/** SCHED_FIFO priority of the capture thread. 0 leaves it unchanged */
+#define SETTINGS_AUDIO_ALSA_INPUT_PRIORITY "audio/alsainputpriority"
+
 class AudioCaptureAlsa : public AudioCapture
 {
     Q_OBJECT
@@ -57,9 +66,14 @@ protected:
     /** @reimpl */
     bool readAudio(int maxSize);
 
+private:
+    /** Set the mmap access if requested, falling back to read/write */
+    int setAccess(snd_pcm_hw_params_t *hw_params);
+
 private:
     snd_pcm_t *m_captureHandle;
     char *pcm_name;
+    bool m_useMmap;
 };
 
 /** @} */
@@ -0,0 +1,139 @@
+/*
+  Q Light Controller Plus
+  audioclipdecoder.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QStringList>
+#include <QDebug>
+#include <cstring>
+
+#include "audioclipdecoder.h"
+
+AudioClipDecoder::AudioClipDecoder(const QByteArray &data, const AudioParameters &params)
+    : AudioDecoder()
+    , m_data(data)
+    , m_position(0)
+{
+    configure(params.sampleRate(), params.channels(), params.format());
+
+    m_frameSize = qMax(1, params.channels() * params.sampleSize());
+    m_bytesPerSecond = qint64(params.sampleRate()) * m_frameSize;
+}
+
+AudioClipDecoder::~AudioClipDecoder()
+{
+}
+
+AudioClipDecoder *AudioClipDecoder::load(AudioDecoder *source, qint64 maxSize)
+{
+    if (source == NULL)
+        return NULL;
+
+    AudioParameters ap = source->audioParameters();
+    int frameSize = qMax(1, ap.channels() * ap.sampleSize());
+    qint64 expected = source->totalTime() * ap.sampleRate() / 1000 * frameSize;
+
+    if (expected > maxSize)
+        return NULL;
+
+    QByteArray data;
+    // reserve a little more, since the total time is not always exact
+    data.reserve(int(qMin(maxSize, expected + expected / 16)));
+
+    char chunk[8 * 1024];
+    source->seek(0);
+
+    while (true)
+    {
+        qint64 read = source->read(chunk, sizeof(chunk));
+        if (read <= 0)
+            break;
+
+        if (data.size() + read > maxSize)
+        {
+            source->seek(0);
+            return NULL;
+        }
+
+        data.append(chunk, int(read));
+    }
+
+    source->seek(0);
+
+    qDebug() << "[AudioClipDecoder] decoded" << data.size() << "bytes";
+
+    return new AudioClipDecoder(data, ap);
+}
+
+qint64 AudioClipDecoder::size() const
+{
+    return m_data.size();
+}
+
+AudioDecoder *AudioClipDecoder::createCopy()
+{
+    return new AudioClipDecoder(m_data, audioParameters());
+}
+
+int AudioClipDecoder::priority() const
+{
+    return 0;
+}
+
+QStringList AudioClipDecoder::supportedFormats()
+{
+    return QStringList();
+}
+
+bool AudioClipDecoder::initialize(const QString &path)
+{
+    Q_UNUSED(path)
+    m_position = 0;
+    return true;
+}
+
+qint64 AudioClipDecoder::totalTime()
+{
+    if (m_bytesPerSecond == 0)
+        return 0;
+
+    return qint64(m_data.size()) * 1000 / m_bytesPerSecond;
+}
+
+void AudioClipDecoder::seek(qint64 time)
+{
+    qint64 pos = time * m_bytesPerSecond / 1000;
+    pos -= pos % m_frameSize;
+    m_position = qBound(qint64(0), pos, qint64(m_data.size()));
+}
+
+qint64 AudioClipDecoder::read(char *data, qint64 maxSize)
+{
+    qint64 size = qMin(maxSize, qint64(m_data.size()) - m_position);
+    if (size <= 0)
+        return 0;
+
+    memcpy(data, m_data.constData() + m_position, size);
+    m_position += size;
+
+    return size;
+}
+
+int AudioClipDecoder::bitrate()
+{
+    return int(m_bytesPerSecond * 8 / 1000);
+}
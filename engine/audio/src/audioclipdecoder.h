@@ -0,0 +1,86 @@
+/*
+  Q Light Controller Plus
+  audioclipdecoder.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOCLIPDECODER_H
+#define AUDIOCLIPDECODER_H
+
+#include <QByteArray>
+
+#include "audiodecoder.h"
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+/**
+ * Decoder playing back a clip entirely decoded in memory.
+ * The PCM data is implicitly shared between the copies.
+ */
+class AudioClipDecoder : public AudioDecoder
+{
+public:
+    AudioClipDecoder(const QByteArray &data, const AudioParameters &params);
+    ~AudioClipDecoder();
+
+    /**
+     * Decode the whole stream of $source in memory.
+     * Returns NULL if the decoded data would exceed $maxSize bytes.
+     * The position of $source is reset to the beginning.
+     */
+    static AudioClipDecoder *load(AudioDecoder *source, qint64 maxSize);
+
+    /** Returns the size in bytes of the decoded clip */
+    qint64 size() const;
+
+    /** @reimp */
+    AudioDecoder *createCopy();
+
+    /** @reimp */
+    int priority() const;
+
+    /** @reimp */
+    QStringList supportedFormats();
+
+    /** @reimp */
+    bool initialize(const QString &path);
+
+    /** @reimp */
+    qint64 totalTime();
+
+    /** @reimp */
+    void seek(qint64 time);
+
+    /** @reimp */
+    qint64 read(char *data, qint64 maxSize);
+
+    /** @reimp */
+    int bitrate();
+
+private:
+    QByteArray m_data;
+    qint64 m_position;
+    /** The size in bytes of one second of audio */
+    qint64 m_bytesPerSecond;
+    /** The size in bytes of a frame (one sample for all channels) */
+    int m_frameSize;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,162 @@
+/*
+  Q Light Controller Plus
+  audiodecodebuffer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QSettings>
+#include <QDebug>
+#include <cstring>
+
+#include "audiodecodebuffer.h"
+#include "audiodecoder.h"
+
+/** The maximum amount of data decoded at once */
+#define DECODE_CHUNK_SIZE   (8 * 1024)
+
+AudioDecodeBuffer::AudioDecodeBuffer(AudioDecoder *adec, QObject *parent)
+    : QThread(parent)
+    , m_adec(adec)
+    , m_writePos(0)
+    , m_readPos(0)
+    , m_filled(0)
+    , m_prerollSize(0)
+    , m_frameSize(1)
+    , m_looped(0)
+    , m_endOfStream(0)
+    , m_stop(0)
+    , m_underruns(0)
+{
+    Q_ASSERT(adec != NULL);
+
+    int bufferMs = AUDIO_DECODE_BUFFER_DEFAULT;
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_AUDIO_DECODE_BUFFER);
+    if (var.isValid() == true && var.toInt() > 0)
+        bufferMs = var.toInt();
+
+    AudioParameters ap = m_adec->audioParameters();
+    m_frameSize = qMax(1, ap.channels() * ap.sampleSize());
+
+    qint64 bytesPerSec = qint64(ap.sampleRate()) * m_frameSize;
+    qint64 size = bytesPerSec * bufferMs / 1000;
+    // round to whole frames, and keep room for a few decoded chunks
+    size = qMax(size - (size % m_frameSize), qint64(4 * DECODE_CHUNK_SIZE));
+
+    m_data.resize(int(size));
+    m_prerollSize = qMin(int(size / 4), int(bytesPerSec / 4));
+
+    qDebug() << "[AudioDecodeBuffer] size:" << size << "bytes, preroll:" << m_prerollSize;
+}
+
+AudioDecodeBuffer::~AudioDecodeBuffer()
+{
+    stop();
+}
+
+void AudioDecodeBuffer::setLooped(bool looped)
+{
+    m_looped.storeRelease(looped ? 1 : 0);
+}
+
+void AudioDecodeBuffer::stop()
+{
+    m_stop.storeRelease(1);
+    wait();
+}
+
+bool AudioDecodeBuffer::isReady() const
+{
+    return m_endOfStream.loadAcquire() || m_filled.loadAcquire() >= m_prerollSize;
+}
+
+bool AudioDecodeBuffer::atEnd() const
+{
+    return m_endOfStream.loadAcquire() && m_filled.loadAcquire() == 0;
+}
+
+qint64 AudioDecodeBuffer::read(char *data, qint64 maxSize)
+{
+    // the end of stream flag must be checked before the filled size
+    // to be sure that a trailing partial frame is complete
+    bool endOfStream = m_endOfStream.loadAcquire();
+    int available = qMin(qint64(m_filled.loadAcquire()), maxSize);
+
+    if (endOfStream == false)
+        available -= available % m_frameSize;
+
+    if (available <= 0)
+        return 0;
+
+    int size = m_data.size();
+    int first = qMin(available, size - m_readPos);
+    memcpy(data, m_data.constData() + m_readPos, first);
+    if (first < available)
+        memcpy(data + first, m_data.constData(), available - first);
+
+    m_readPos = (m_readPos + available) % size;
+    m_filled.fetchAndAddOrdered(-available);
+
+    return available;
+}
+
+void AudioDecodeBuffer::countUnderrun()
+{
+    int count = m_underruns.fetchAndAddOrdered(1) + 1;
+    qWarning() << "[AudioDecodeBuffer] underrun #" << count;
+}
+
+int AudioDecodeBuffer::underrunCount() const
+{
+    return m_underruns.loadAcquire();
+}
+
+void AudioDecodeBuffer::run()
+{
+    char chunk[DECODE_CHUNK_SIZE];
+    int size = m_data.size();
+
+    while (m_stop.loadAcquire() == 0)
+    {
+        int space = size - m_filled.loadAcquire();
+        if (space < DECODE_CHUNK_SIZE)
+        {
+            usleep(5000);
+            continue;
+        }
+
+        qint64 read = m_adec->read(chunk, DECODE_CHUNK_SIZE);
+        if (read <= 0)
+        {
+            if (m_looped.loadAcquire())
+            {
+                m_adec->seek(0);
+                continue;
+            }
+            break;
+        }
+
+        int first = qMin(int(read), size - m_writePos);
+        memcpy(m_data.data() + m_writePos, chunk, first);
+        if (first < read)
+            memcpy(m_data.data(), chunk + first, read - first);
+
+        m_writePos = (m_writePos + int(read)) % size;
+        m_filled.fetchAndAddOrdered(int(read));
+    }
+
+    m_endOfStream.storeRelease(1);
+}
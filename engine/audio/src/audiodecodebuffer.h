@@ -0,0 +1,113 @@
+/*
+  Q Light Controller Plus
+  audiodecodebuffer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIODECODEBUFFER_H
+#define AUDIODECODEBUFFER_H
+
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QThread>
+
+class AudioDecoder;
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+#define SETTINGS_AUDIO_DECODE_BUFFER "audio/decodebuffer"
+
+/** Default length of the decoded audio kept ahead, in milliseconds */
+#define AUDIO_DECODE_BUFFER_DEFAULT  2000
+
+/**
+ * Thread decoding audio ahead of an AudioRenderer.
+ * The decoded PCM data is stored in a single producer/single consumer
+ * ring buffer; the decoder thread is the only writer and the renderer
+ * thread the only reader, so neither side ever locks or waits for the
+ * other. When the renderer finds no data available, an underrun is
+ * counted instead of decoding inline.
+ */
+class AudioDecodeBuffer : public QThread
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Create a buffer decoding from $adec, which must be already
+     * initialized and positioned where the playback starts.
+     * The buffer length is read from the application settings.
+     */
+    AudioDecodeBuffer(AudioDecoder *adec, QObject *parent = 0);
+    ~AudioDecodeBuffer();
+
+    /** Restart the decoding from the beginning when the end is reached */
+    void setLooped(bool looped);
+
+    /** Stop the decoder thread and wait for it to finish */
+    void stop();
+
+    /** Returns true once enough data has been decoded to start the
+     *  playback, or when the whole stream has been decoded */
+    bool isReady() const;
+
+    /** Returns true when the stream has been completely decoded and read */
+    bool atEnd() const;
+
+    /**
+     * Copy up to $maxSize bytes of decoded audio to $data.
+     * To be called by the renderer thread only. It never blocks and
+     * returns only whole audio frames, or 0 when no data is available.
+     */
+    qint64 read(char *data, qint64 maxSize);
+
+    /** Register an underrun, when no data was available to the renderer */
+    void countUnderrun();
+
+    /** Returns the number of underruns since the buffer creation */
+    int underrunCount() const;
+
+protected:
+    /** @reimpl */
+    void run();
+
+private:
+    AudioDecoder *m_adec;
+
+    /** The ring buffer and its positions, owned respectively
+     *  by the decoder and the renderer threads */
+    QByteArray m_data;
+    int m_writePos;
+    int m_readPos;
+
+    /** The number of decoded bytes not read yet */
+    QAtomicInt m_filled;
+    /** The amount of data to decode before starting the playback */
+    int m_prerollSize;
+    /** The size in bytes of a frame (one sample for all channels) */
+    int m_frameSize;
+
+    QAtomicInt m_looped;
+    QAtomicInt m_endOfStream;
+    QAtomicInt m_stop;
+    QAtomicInt m_underruns;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,334 @@
+/*
+  Q Light Controller Plus
+  audiomixer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QtEndian>
+#include <QDebug>
+
+#include "audiodecodebuffer.h"
+#include "audioplugincache.h"
+#include "audiorenderer.h"
+#include "audiodecoder.h"
+#include "audiomixer.h"
+#include "qlcmacros.h"
+
+#define GAIN_ONE 65536
+
+/*****************************************************************************
+ * AudioMixerStream
+ *****************************************************************************/
+
+AudioMixerStream::AudioMixerStream(AudioDecoder *decoder, AudioMixer *mixer)
+    : QObject(NULL)
+    , m_mixer(mixer)
+    , m_buffer(new AudioDecodeBuffer(decoder))
+    , m_intensity(GAIN_ONE)
+    , m_fadeInRequest(0)
+    , m_fadeOutRequest(0)
+    , m_paused(0)
+    , m_fadingOut(0)
+    , m_mixedTime(0)
+    , m_mixedFrames(0)
+    , m_started(false)
+    , m_finished(false)
+    , m_fadeGain(1.0)
+    , m_fadeTarget(1.0)
+    , m_fadeStep(0)
+{
+    m_buffer->start();
+}
+
+AudioMixerStream::~AudioMixerStream()
+{
+    m_buffer->stop();
+    if (m_buffer->underrunCount())
+        qWarning() << "[AudioMixer] decoding underruns:" << m_buffer->underrunCount();
+    delete m_buffer;
+}
+
+void AudioMixerStream::adjustIntensity(qreal fraction)
+{
+    m_intensity.storeRelease(int(CLAMP(fraction, 0.0, 1.0) * GAIN_ONE));
+}
+
+void AudioMixerStream::setFadeIn(uint fadeTime)
+{
+    if (fadeTime == 0)
+        return;
+
+    m_fadeInRequest.storeRelease(int(fadeTime) + 1);
+}
+
+void AudioMixerStream::setFadeOut(uint fadeTime)
+{
+    // Audio asks for the fade out on every tick of its last fadeTime ms
+    if (fadeTime == 0 || m_fadingOut.testAndSetOrdered(0, 1) == false)
+        return;
+
+    m_fadeOutRequest.storeRelease(int(fadeTime) + 1);
+}
+
+void AudioMixerStream::setLooped(bool looped)
+{
+    m_buffer->setLooped(looped);
+}
+
+void AudioMixerStream::setPaused(bool paused)
+{
+    m_paused.storeRelease(paused ? 1 : 0);
+}
+
+qint64 AudioMixerStream::playbackTime() const
+{
+    int mixed = m_mixedTime.loadAcquire();
+    if (mixed == 0)
+        return -1;
+
+    // what the mixer holds ahead of the device hasn't been heard yet
+    return qMax(qint64(0), mixed - m_mixer->latency());
+}
+
+int AudioMixerStream::underrunCount() const
+{
+    return m_buffer->underrunCount();
+}
+
+void AudioMixerStream::startFade(qreal target, uint fadeTime)
+{
+    qint64 frames = qint64(fadeTime) * m_mixer->audioParameters().sampleRate() / 1000;
+
+    m_fadeTarget = target;
+    if (frames == 0)
+    {
+        m_fadeGain = target;
+        m_fadeStep = 0;
+    }
+    else
+    {
+        m_fadeStep = (target - m_fadeGain) / frames;
+    }
+}
+
+void AudioMixerStream::mixInto(qint32 *mix, qint16 *buffer, int samples)
+{
+    if (m_finished || m_paused.loadAcquire())
+        return;
+
+    // the stream starts once enough data is decoded
+    if (m_started == false)
+    {
+        if (m_buffer->isReady() == false)
+            return;
+        m_started = true;
+    }
+
+    int request = m_fadeInRequest.fetchAndStoreOrdered(0);
+    if (request)
+    {
+        m_fadeGain = 0;
+        startFade(1.0, uint(request - 1));
+    }
+    request = m_fadeOutRequest.fetchAndStoreOrdered(0);
+    if (request)
+        startFade(0.0, uint(request - 1));
+
+    int channels = m_mixer->audioParameters().channels();
+    int count = int(m_buffer->read(reinterpret_cast<char *>(buffer), qint64(samples) * 2) / 2);
+
+    if (count < samples)
+    {
+        if (m_buffer->atEnd())
+        {
+            m_finished = true;
+            emit endOfStreamReached();
+        }
+        else
+        {
+            // the rest of the chunk is silence for this stream only
+            m_buffer->countUnderrun();
+        }
+    }
+
+    int intensity = m_intensity.loadAcquire();
+
+    for (int i = 0; i < count; i += channels)
+    {
+        int gain = intensity;
+        if (m_fadeGain != 1.0 || m_fadeStep != 0)
+        {
+            gain = int(intensity * m_fadeGain);
+            if (m_fadeStep != 0)
+            {
+                m_fadeGain += m_fadeStep;
+                if ((m_fadeStep > 0 && m_fadeGain >= m_fadeTarget) ||
+                    (m_fadeStep < 0 && m_fadeGain <= m_fadeTarget))
+                {
+                    m_fadeGain = m_fadeTarget;
+                    m_fadeStep = 0;
+                }
+            }
+        }
+
+        for (int c = 0; c < channels && i + c < count; c++)
+        {
+            qint32 sample = qFromLittleEndian<qint16>(reinterpret_cast<const uchar *>(buffer + i + c));
+            mix[i + c] += qint32((qint64(sample) * gain) >> 16);
+        }
+    }
+
+    m_mixedFrames += count / channels;
+    m_mixedTime.storeRelease(int(m_mixedFrames * 1000 / m_mixer->audioParameters().sampleRate()));
+}
+
+/*****************************************************************************
+ * AudioMixer
+ *****************************************************************************/
+
+AudioMixer::AudioMixer(const QString &device, AudioPluginCache *cache)
+    : QObject(NULL)
+    , m_device(device)
+    , m_cache(cache)
+    , m_renderer(NULL)
+    , m_mixedTime(0)
+    , m_mixedFrames(0)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+    if (m_renderer != NULL)
+    {
+        m_renderer->stop();
+        delete m_renderer;
+    }
+    qDeleteAll(m_streams);
+}
+
+QString AudioMixer::device() const
+{
+    return m_device;
+}
+
+bool AudioMixer::accepts(const AudioParameters &ap) const
+{
+    if (ap.format() != PCM_S16LE || ap.channels() <= 0)
+        return false;
+
+    // the parameters are chosen by the first stream
+    if (m_renderer == NULL)
+        return true;
+
+    return ap.sampleRate() == m_parameters.sampleRate() &&
+           ap.channels() == m_parameters.channels();
+}
+
+AudioMixerStream *AudioMixer::addStream(AudioDecoder *decoder, bool looped)
+{
+    if (m_renderer == NULL)
+    {
+        AudioParameters ap = decoder->audioParameters();
+        m_parameters = AudioParameters(ap.sampleRate(), ap.channels(), PCM_S16LE);
+        m_mixedFrames = 0;
+        m_mixedTime.storeRelease(0);
+
+        m_renderer = m_cache->createRenderer(m_device);
+        m_renderer->initialize(m_parameters.sampleRate(), m_parameters.channels(), PCM_S16LE);
+        m_renderer->setMixer(this);
+
+        qDebug() << "[AudioMixer] Open device" << (m_device.isEmpty() ? QString("default") : m_device)
+                 << m_parameters.sampleRate() << "Hz," << m_parameters.channels() << "channels";
+    }
+
+    AudioMixerStream *stream = new AudioMixerStream(decoder, this);
+    stream->setLooped(looped);
+
+    m_mutex.lock();
+    m_streams.append(stream);
+    m_mutex.unlock();
+
+    if (m_renderer->isRunning() == false)
+        m_renderer->start();
+
+    return stream;
+}
+
+void AudioMixer::removeStream(AudioMixerStream *stream)
+{
+    m_mutex.lock();
+    bool removed = m_streams.removeOne(stream);
+    bool empty = m_streams.isEmpty();
+    m_mutex.unlock();
+
+    if (removed == false)
+        return;
+
+    delete stream;
+
+    // the renderer thread mixes under the lock, so it is stopped without it
+    if (empty && m_renderer != NULL)
+    {
+        m_renderer->stop();
+        delete m_renderer;
+        m_renderer = NULL;
+    }
+}
+
+int AudioMixer::streamCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_streams.count();
+}
+
+AudioParameters AudioMixer::audioParameters() const
+{
+    return m_parameters;
+}
+
+qint64 AudioMixer::mix(unsigned char *data, qint64 maxSize)
+{
+    int channels = m_parameters.channels();
+    int samples = int(qMin(maxSize, qint64(AUDIOMIXER_CHUNK_SIZE)) / (channels * 2)) * channels;
+
+    m_mixBuffer.fill(0, samples);
+    m_streamBuffer.resize(samples);
+
+    m_mutex.lock();
+    foreach (AudioMixerStream *stream, m_streams)
+        stream->mixInto(m_mixBuffer.data(), m_streamBuffer.data(), samples);
+    m_mutex.unlock();
+
+    const qint32 *mixed = m_mixBuffer.constData();
+    for (int i = 0; i < samples; i++)
+        qToLittleEndian<qint16>(qint16(qBound(-32768, mixed[i], 32767)), data + i * 2);
+
+    m_mixedFrames += samples / channels;
+    m_mixedTime.storeRelease(int(m_mixedFrames * 1000 / m_parameters.sampleRate()));
+
+    return qint64(samples) * 2;
+}
+
+qint64 AudioMixer::latency() const
+{
+    AudioRenderer *renderer = m_renderer;
+    qint64 played = renderer == NULL ? -1 : renderer->playbackTime();
+    if (played < 0)
+        return 0;
+
+    return qMax(qint64(0), m_mixedTime.loadAcquire() - played);
+}
@@ -0,0 +1,202 @@
+/*
+  Q Light Controller Plus
+  audiomixer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QList>
+
+#include "audioparameters.h"
+
+class AudioPluginCache;
+class AudioDecodeBuffer;
+class AudioRenderer;
+class AudioDecoder;
+class AudioMixer;
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+#define SETTINGS_AUDIO_MIXER "audio/mixer"
+
+/** The amount of audio mixed at once, in bytes */
+#define AUDIOMIXER_CHUNK_SIZE 4096
+
+/**
+ * A stream played by an AudioMixer, created by AudioMixer::addStream().
+ * Its setters can be called from any thread, and take effect at the next
+ * chunk mixed by the renderer thread.
+ */
+class AudioMixerStream : public QObject
+{
+    Q_OBJECT
+
+    friend class AudioMixer;
+
+private:
+    AudioMixerStream(AudioDecoder *decoder, AudioMixer *mixer);
+    ~AudioMixerStream();
+
+public:
+    /** Set the volume of the stream, between 0.0 and 1.0 */
+    void adjustIntensity(qreal fraction);
+
+    /** Start fading the stream in from silence over $fadeTime ms */
+    void setFadeIn(uint fadeTime);
+
+    /** Start fading the stream out over $fadeTime ms */
+    void setFadeOut(uint fadeTime);
+
+    void setLooped(bool looped);
+
+    void setPaused(bool paused);
+
+    /**
+     * Returns the duration in milliseconds of the stream actually played
+     * by the device, or -1 if it hasn't started yet. Paused time is not
+     * counted, and every stream of a mixer is timed by the same device.
+     */
+    qint64 playbackTime() const;
+
+    /** Returns the number of times the decoded data was not ready in time */
+    int underrunCount() const;
+
+signals:
+    /** Emitted by the renderer thread once the whole stream has been mixed */
+    void endOfStreamReached();
+
+private:
+    /**
+     * Add $samples samples of the stream to $mix, using $buffer to read
+     * them. Called by the renderer thread only.
+     */
+    void mixInto(qint32 *mix, qint16 *buffer, int samples);
+
+    /** Start a fade from the current gain to $target over $fadeTime ms */
+    void startFade(qreal target, uint fadeTime);
+
+private:
+    AudioMixer *m_mixer;
+    AudioDecodeBuffer *m_buffer;
+
+    /** The volume, as a fixed point value on 16 bits */
+    QAtomicInt m_intensity;
+    /** Fades requested and not started yet, in ms + 1 so that 0 means none */
+    QAtomicInt m_fadeInRequest;
+    QAtomicInt m_fadeOutRequest;
+    QAtomicInt m_paused;
+
+    /** Set once a fade out has been requested */
+    QAtomicInt m_fadingOut;
+
+    /** The time mixed since the stream start, in ms */
+    QAtomicInt m_mixedTime;
+    qint64 m_mixedFrames;
+    bool m_started;
+    bool m_finished;
+
+    /** State of the current fade. Accessed by the renderer thread only */
+    qreal m_fadeGain;
+    qreal m_fadeTarget;
+    qreal m_fadeStep;
+};
+
+/**
+ * AudioMixer plays every Audio function sent to the same output device
+ * through a single AudioRenderer.
+ *
+ * The renderer thread mixes the active streams chunk by chunk, applying
+ * the volume and the fades of each stream, so that layered clips share
+ * one device stream and one clock instead of opening a stream each. The
+ * streams keep their own decoding thread ahead of the playback.
+ *
+ * Only 16 bit streams with the sample rate and the channels of the first
+ * stream can be mixed: there's no resampling, and Audio functions using
+ * another format are played with a renderer of their own. The renderer
+ * is stopped when the last stream is removed.
+ */
+class AudioMixer : public QObject
+{
+    Q_OBJECT
+
+public:
+    AudioMixer(const QString &device, AudioPluginCache *cache);
+    ~AudioMixer();
+
+    /** Return the name of the output device, empty for the default one */
+    QString device() const;
+
+    /** Return true if a stream with $ap can be added to the mixer */
+    bool accepts(const AudioParameters &ap) const;
+
+    /**
+     * Add a stream playing $decoder, which must be positioned where the
+     * playback starts, and return it. The stream is played as soon as
+     * enough data is decoded.
+     */
+    AudioMixerStream *addStream(AudioDecoder *decoder, bool looped);
+
+    /** Stop and delete $stream */
+    void removeStream(AudioMixerStream *stream);
+
+    /** Return the number of streams being played */
+    int streamCount() const;
+
+    /** Return the parameters of the mixed audio */
+    AudioParameters audioParameters() const;
+
+    /**
+     * Mix up to $maxSize bytes of the streams into $data, filling with
+     * silence what the streams don't provide, so that the device clock
+     * keeps running. Called by the renderer thread only.
+     *
+     * @return The number of bytes written to $data
+     */
+    qint64 mix(unsigned char *data, qint64 maxSize);
+
+    /** Return the time, in ms, the device is behind the mixed audio */
+    qint64 latency() const;
+
+private:
+    QString m_device;
+    AudioPluginCache *m_cache;
+    AudioParameters m_parameters;
+    AudioRenderer *m_renderer;
+
+    /** Protects the streams list, read by the renderer thread */
+    mutable QMutex m_mutex;
+    QList<AudioMixerStream *> m_streams;
+
+    /** The time mixed since the renderer start, in ms */
+    QAtomicInt m_mixedTime;
+    qint64 m_mixedFrames;
+
+    /** The mixing buffers, used by the renderer thread */
+    QVector<qint32> m_mixBuffer;
+    QVector<qint16> m_streamBuffer;
+};
+
+/** @} */
+
+#endif
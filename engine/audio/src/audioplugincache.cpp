@@ -17,11 +17,14 @@
   limitations under the License.
 */
 
+#include <QCoreApplication>
 #include <QPluginLoader>
+#include <QSettings>
 #include <QDebug>
 
 #include "audioplugincache.h"
 #include "audiodecoder.h"
+#include "audiomixer.h"
 #include "qlcfile.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
@@ -38,7 +41,19 @@
 
 AudioPluginCache::AudioPluginCache(QObject *parent)
     : QObject(parent)
+    , m_preloadBudget(qint64(AUDIO_PRELOAD_BUDGET_DEFAULT) * 1024 * 1024)
+    , m_preloadUsed(0)
+    , m_mixing(true)
 {
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_AUDIO_PRELOAD_BUDGET);
+    if (var.isValid() == true)
+        m_preloadBudget = qint64(var.toInt()) * 1024 * 1024;
+
+    var = settings.value(SETTINGS_AUDIO_MIXER);
+    if (var.isValid() == true)
+        m_mixing = var.toBool();
+
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
  #if defined( __APPLE__) || defined(Q_OS_MAC)
     m_audioDevicesList = AudioRendererPortAudio::getDevicesInfo();
@@ -55,6 +70,7 @@ AudioPluginCache::AudioPluginCache(QObject *parent)
 
 AudioPluginCache::~AudioPluginCache()
 {
+    qDeleteAll(m_mixers);
 }
 
 void AudioPluginCache::load(const QDir &dir)
@@ -139,6 +155,52 @@ QList<AudioDeviceInfo> AudioPluginCache::audioDevicesList() const
     return m_audioDevicesList;
 }
 
+AudioRenderer *AudioPluginCache::createRenderer(const QString &device)
+{
+    AudioRenderer *renderer = NULL;
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+ #if defined(__APPLE__) || defined(Q_OS_MAC)
+    renderer = new AudioRendererPortAudio(device);
+ #elif defined(WIN32) || defined(Q_OS_WIN)
+    renderer = new AudioRendererWaveOut(device);
+ #else
+    renderer = new AudioRendererAlsa(device);
+ #endif
+    renderer->moveToThread(QCoreApplication::instance()->thread());
+#else
+    // the Qt renderer looks up the device through the Doc
+    renderer = new AudioRendererQt(device, parent());
+#endif
+
+    return renderer;
+}
+
+AudioMixer *AudioPluginCache::mixer(const QString &device)
+{
+    if (m_mixing == false)
+        return NULL;
+
+    AudioMixer *mixer = m_mixers.value(device, NULL);
+    if (mixer == NULL)
+    {
+        mixer = new AudioMixer(device, this);
+        m_mixers[device] = mixer;
+    }
+
+    return mixer;
+}
+
+qint64 AudioPluginCache::preloadBytesAvailable() const
+{
+    return qMax(qint64(0), m_preloadBudget - m_preloadUsed);
+}
+
+void AudioPluginCache::adjustPreloadBytes(qint64 bytes)
+{
+    m_preloadUsed = qMax(qint64(0), m_preloadUsed + bytes);
+}
+
 QAudioDeviceInfo AudioPluginCache::getOutputDeviceInfo(QString devName) const
 {
     foreach (const QAudioDeviceInfo &deviceInfo, m_outputDevicesList)
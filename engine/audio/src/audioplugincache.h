@@ -32,6 +32,12 @@
  */
 
 class AudioDecoder;
+class AudioMixer;
+
+#define SETTINGS_AUDIO_PRELOAD_BUDGET "audio/preloadbudget"
+
+/** Default memory available to preloaded audio clips, in MB */
+#define AUDIO_PRELOAD_BUDGET_DEFAULT  256
 
 class AudioPluginCache : public QObject
 {
@@ -58,6 +64,21 @@ public:
     /** Return a Qt output device info match based on $devName */
     QAudioDeviceInfo getOutputDeviceInfo(QString devName) const;
 
+    /** Create a renderer of the platform for $device, empty for the
+     *  default one. The renderer still has to be initialized */
+    AudioRenderer *createRenderer(const QString &device);
+
+    /** Get the mixer playing the Audio functions sent to $device,
+     *  creating it if needed. Returns NULL if mixing is disabled */
+    AudioMixer *mixer(const QString &device);
+
+    /** Get the memory in bytes still available to preloaded clips */
+    qint64 preloadBytesAvailable() const;
+
+    /** Account $bytes to (or release them from, when negative)
+     *  the memory used by preloaded clips */
+    void adjustPreloadBytes(qint64 bytes);
+
 private:
     /** a map of the vailable plugins ordered by priority */
     QMap<int, QString> m_pluginsMap;
@@ -68,6 +89,14 @@ private:
 
     /** a list of output audio device for faster lookup */
     QList<QAudioDeviceInfo> m_outputDevicesList;
+
+    /** the memory in bytes allowed and used by preloaded clips */
+    qint64 m_preloadBudget;
+    qint64 m_preloadUsed;
+
+    /** the mixer of each output device */
+    bool m_mixing;
+    QMap<QString, AudioMixer *> m_mixers;
 };
 
 /** @} */
@@ -20,7 +20,9 @@
 #include <QDebug>
 #include <QMutexLocker>
 
+#include "audiodecodebuffer.h"
 #include "audiorenderer.h"
+#include "audiomixer.h"
 #include "qlcmacros.h"
 
 AudioRenderer::AudioRenderer (QObject* parent)
@@ -30,15 +32,49 @@ AudioRenderer::AudioRenderer (QObject* parent)
     , m_pause(false)
     , m_intensity(1.0)
     , m_adec(NULL)
+    , m_mixer(NULL)
+    , m_decodeBuffer(NULL)
     , audioDataRead(0)
     , pendingAudioBytes(0)
     , m_looped(false)
+    , m_bytesPerSecond(0)
+    , m_bytesWritten(0)
+    , m_playbackTime(-1)
 {
 }
 
+AudioRenderer::~AudioRenderer()
+{
+    delete m_decodeBuffer;
+}
+
 void AudioRenderer::setDecoder(AudioDecoder *adec)
 {
+    delete m_decodeBuffer;
+    m_decodeBuffer = NULL;
+
     m_adec = adec;
+    if (m_adec == NULL)
+        return;
+
+    AudioParameters ap = m_adec->audioParameters();
+    m_bytesPerSecond = qint64(ap.sampleRate()) * ap.channels() * ap.sampleSize();
+
+    m_decodeBuffer = new AudioDecodeBuffer(m_adec);
+    m_decodeBuffer->setLooped(m_looped);
+    m_decodeBuffer->start();
+}
+
+void AudioRenderer::setMixer(AudioMixer *mixer)
+{
+    setDecoder(NULL);
+
+    m_mixer = mixer;
+    if (m_mixer == NULL)
+        return;
+
+    AudioParameters ap = m_mixer->audioParameters();
+    m_bytesPerSecond = qint64(ap.sampleRate()) * ap.channels() * ap.sampleSize();
 }
 
 void AudioRenderer::adjustIntensity(qreal fraction)
@@ -81,16 +117,33 @@ void AudioRenderer::stop()
     while (this->isRunning())
         usleep(10000);
     m_intensity = 1.0;
+    m_fadeStep = 0;
+    m_playbackTime.storeRelease(-1);
+
+    // the decoder must be idle when this returns
+    if (m_decodeBuffer != NULL)
+    {
+        m_decodeBuffer->stop();
+        if (m_decodeBuffer->underrunCount())
+            qWarning() << "[AudioRenderer] decoding underruns:" << m_decodeBuffer->underrunCount();
+    }
 }
 
 void AudioRenderer::run()
 {
     m_userStop = false;
     audioDataRead = 0;
-    int sampleSize = m_adec->audioParameters().sampleSize();
+    pendingAudioBytes = 0;
+    m_bytesWritten = 0;
+    m_playbackTime.storeRelease(0);
+    int sampleSize = m_mixer != NULL ? 2 : m_adec->audioParameters().sampleSize();
     if (sampleSize > 2)
         sampleSize = 2;
 
+    // wait for the initial data to be decoded
+    while (!m_userStop && m_mixer == NULL && !m_decodeBuffer->isReady())
+        usleep(5000);
+
     while (!m_userStop)
     {
         QMutexLocker locker(&m_mutex);
@@ -100,19 +153,23 @@ void AudioRenderer::run()
           //qDebug() << "Pending audio bytes: " << pendingAudioBytes;
           if (pendingAudioBytes == 0)
           {
-            audioDataRead = m_adec->read((char *)audioData, 8192);
+            // a mixer always provides a chunk, and applies the volumes itself
+            if (m_mixer != NULL)
+                audioDataRead = m_mixer->mix(audioData, AUDIOMIXER_CHUNK_SIZE);
+            else
+                audioDataRead = m_decodeBuffer->read((char *)audioData, 8192);
             if (audioDataRead == 0)
             {
-                if (m_looped)
-                {
-                    m_adec->seek(0);
-                    continue;
-                }
-                else
+                // looping is handled by the decoding thread
+                if (m_decodeBuffer->atEnd())
                 {
                     emit endOfStreamReached();
                     return;
                 }
+
+                m_decodeBuffer->countUnderrun();
+                usleep(5000);
+                continue;
             }
             if (m_intensity != 1.0 || m_fadeStep != 0)
             {
@@ -159,6 +216,7 @@ void AudioRenderer::run()
                 }
             }
             audioDataWritten = writeAudio(audioData, audioDataRead);
+            updatePlaybackTime(audioDataWritten);
             if (audioDataWritten < audioDataRead)
             {
                 pendingAudioBytes = audioDataRead - audioDataWritten;
@@ -168,6 +226,7 @@ void AudioRenderer::run()
           else
           {
             audioDataWritten = writeAudio(audioData + (audioDataRead - pendingAudioBytes), pendingAudioBytes);
+            updatePlaybackTime(audioDataWritten);
             pendingAudioBytes -= audioDataWritten;
             if (audioDataWritten == 0)
                 usleep(15000);
@@ -184,4 +243,34 @@ void AudioRenderer::run()
 void AudioRenderer::setLooped(bool looped)
 {
     m_looped = looped;
+    if (m_decodeBuffer != NULL)
+        m_decodeBuffer->setLooped(looped);
+}
+
+qint64 AudioRenderer::playbackTime() const
+{
+    return m_playbackTime.loadAcquire();
+}
+
+qint64 AudioRenderer::bytesToTime(qint64 bytes) const
+{
+    if (m_bytesPerSecond == 0)
+        return 0;
+
+    return bytes * 1000 / m_bytesPerSecond;
+}
+
+void AudioRenderer::updatePlaybackTime(qint64 written)
+{
+    if (written > 0)
+        m_bytesWritten += written;
+
+    // what is still buffered by the device has not been heard yet
+    qint64 played = bytesToTime(m_bytesWritten) - latency();
+    m_playbackTime.storeRelease(int(qMax(qint64(0), played)));
+}
+
+int AudioRenderer::underrunCount() const
+{
+    return m_decodeBuffer == NULL ? 0 : m_decodeBuffer->underrunCount();
 }
@@ -20,11 +20,15 @@
 #ifndef AUDIORENDERER_H
 #define AUDIORENDERER_H
 
+#include <QAtomicInt>
 #include <QThread>
 #include <QMutex>
 
 #include "audiodecoder.h"
 
+class AudioDecodeBuffer;
+class AudioMixer;
+
 /** @addtogroup engine_audio Audio
  * @{
  */
@@ -51,9 +55,20 @@ public:
      */
     AudioRenderer(QObject * parent = 0);
 
-    ~AudioRenderer() { }
+    ~AudioRenderer();
 
+    /*!
+     * Set the decoder to be used as data source. The decoding starts
+     * right away in a dedicated thread, ahead of the playback.
+     */
     void setDecoder(AudioDecoder *adec);
+
+    /*!
+     * Play the audio mixed by $mixer instead of a decoder. The renderer
+     * must be initialized with the mixer parameters, and it plays until
+     * stopped, since the mixer fills the gaps with silence.
+     */
+    void setMixer(AudioMixer *mixer);
     /*!
      * Prepares object for usage and setups required audio parameters.
      * Subclass should reimplement this function.
@@ -65,10 +80,19 @@ public:
     virtual bool initialize(quint32 freq, int chan, AudioFormat format) = 0;
 
     /*!
-     * Returns output interface latency in milliseconds.
+     * Returns output interface latency in milliseconds, that is the
+     * duration of the data written but not played yet by the device.
+     * Called by the renderer thread only.
      */
     virtual qint64 latency() = 0;
 
+    /*!
+     * Returns the duration in milliseconds of the audio actually
+     * played by the device since the renderer start, or -1 if
+     * the renderer is not running. Can be called from any thread.
+     */
+    qint64 playbackTime() const;
+
     /*!
      * Writes all remaining plugin's internal data to audio output device.
      * Subclass should reimplement this function.
@@ -95,6 +119,11 @@ public:
 
     void setLooped(bool looped);
 
+    /*!
+     * Returns the number of times the decoded data was not ready in time
+     */
+    int underrunCount() const;
+
 
     /*********************************************************************
      * Fade sequences
@@ -133,12 +162,25 @@ protected:
      */
     virtual qint64 writeAudio(unsigned char *data, qint64 maxSize) = 0;
 
+    /*!
+     * Converts an amount of bytes of the current stream in milliseconds
+     */
+    qint64 bytesToTime(qint64 bytes) const;
+
+private:
+    /** Update the played time after writing $written bytes to the device */
+    void updatePlaybackTime(qint64 written);
+
 signals:
     void endOfStreamReached();
 
 private:
     /** Reference to the decoder to be used as data source */
     AudioDecoder *m_adec;
+    /** The mixer used as data source instead of a decoder */
+    AudioMixer *m_mixer;
+    /** Decoded data ahead of the playback */
+    AudioDecodeBuffer *m_decodeBuffer;
     QMutex m_mutex;
 
     /** Data buffer for audio */
@@ -146,6 +188,13 @@ private:
     qint64 audioDataRead;
     qint64 pendingAudioBytes;
     bool m_looped;
+
+    /** Byte rate of the current stream */
+    qint64 m_bytesPerSecond;
+    /** The bytes written to the device since the start */
+    qint64 m_bytesWritten;
+    /** The time played by the device, -1 when not running */
+    QAtomicInt m_playbackTime;
 };
 
 /** @} */
@@ -28,6 +28,9 @@
 #include <QString>
 #include <QSettings>
 
+#include <pthread.h>
+#include <sched.h>
+
 #include "audiorenderer_alsa.h"
 
 AudioRendererAlsa::AudioRendererAlsa(QString device, QObject * parent)
@@ -44,8 +47,13 @@ AudioRendererAlsa::AudioRendererAlsa(QString device, QObject * parent)
     else
         dev_name = device;
 
+    QSettings settings;
     m_inited = false;
-    m_use_mmap = false;
+    m_use_mmap = settings.value(SETTINGS_AUDIO_ALSA_OUTPUT_MMAP, false).toBool();
+    m_bufferFrames = settings.value(SETTINGS_AUDIO_ALSA_OUTPUT_BUFFER, 0).toUInt();
+    m_periodFrames = settings.value(SETTINGS_AUDIO_ALSA_OUTPUT_PERIOD, 0).toUInt();
+    m_priority = settings.value(SETTINGS_AUDIO_ALSA_OUTPUT_PRIORITY, 0).toInt();
+    m_prioritySet = false;
     pcm_name = strdup(dev_name.toLatin1().data());
     pcm_handle = NULL;
     m_prebuf = NULL;
@@ -155,12 +163,30 @@ bool AudioRendererAlsa::initialize(quint32 freq, int chan, AudioFormat format)
         qWarning("OutputALSA: Error setting channels: %s", snd_strerror(err));
         return false;
     }
-    if ((err = snd_pcm_hw_params_set_period_time_near(pcm_handle, hwparams, &period_time ,0)) < 0)
+    if (m_periodFrames > 0)
+    {
+        snd_pcm_uframes_t frames = m_periodFrames;
+        if ((err = snd_pcm_hw_params_set_period_size_near(pcm_handle, hwparams, &frames, 0)) < 0)
+        {
+            qWarning("OutputALSA: Error setting period size: %s", snd_strerror(err));
+            return false;
+        }
+    }
+    else if ((err = snd_pcm_hw_params_set_period_time_near(pcm_handle, hwparams, &period_time ,0)) < 0)
     {
         qWarning("OutputALSA: Error setting period time: %s", snd_strerror(err));
         return false;
     }
-    if ((err = snd_pcm_hw_params_set_buffer_time_near(pcm_handle, hwparams, &buffer_time ,0)) < 0)
+    if (m_bufferFrames > 0)
+    {
+        snd_pcm_uframes_t frames = m_bufferFrames;
+        if ((err = snd_pcm_hw_params_set_buffer_size_near(pcm_handle, hwparams, &frames)) < 0)
+        {
+            qWarning("OutputALSA: Error setting buffer size: %s", snd_strerror(err));
+            return false;
+        }
+    }
+    else if ((err = snd_pcm_hw_params_set_buffer_time_near(pcm_handle, hwparams, &buffer_time ,0)) < 0)
     {
         qWarning("OutputALSA: Error setting buffer time: %s", snd_strerror(err));
         return false;
@@ -200,19 +226,31 @@ bool AudioRendererAlsa::initialize(quint32 freq, int chan, AudioFormat format)
     m_can_pause = snd_pcm_hw_params_can_pause(hwparams);
 
     qDebug("OutputALSA: can pause: %d", m_can_pause);
+    qDebug("OutputALSA: buffer %lu frames, period %lu frames, %s access, %lu ms latency",
+           buffer_size, period_size, m_use_mmap ? "mmap" : "read/write",
+           exact_rate ? buffer_size * 1000 / exact_rate : 0);
 
     //create alsa prebuffer;
     m_prebuf_size = m_bits_per_frame * m_chunk_size / 8;
     m_prebuf = (uchar *)malloc(m_prebuf_size);
 
+    m_prioritySet = false;
     m_inited = true;
     return true;
 }
 
 qint64 AudioRendererAlsa::latency()
 {
-    //return m_prebuf_fill * 1000 / sampleRate() / channels() / sampleSize();
-    return 0;
+    if (pcm_handle == NULL)
+        return 0;
+
+    // the frames queued in the device plus the ones not written yet
+    qint64 pending = m_prebuf_fill;
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(pcm_handle, &delay) == 0 && delay > 0)
+        pending += snd_pcm_frames_to_bytes(pcm_handle, delay);
+
+    return bytesToTime(pending);
 }
 
 QList<AudioDeviceInfo> AudioRendererAlsa::getDevicesInfo()
@@ -292,11 +330,35 @@ QList<AudioDeviceInfo> AudioRendererAlsa::getDevicesInfo()
     return devList;
 }
 
+bool AudioRendererAlsa::setRealtimePriority(int priority)
+{
+    struct sched_param param;
+    param.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO), priority,
+                                  sched_get_priority_max(SCHED_FIFO));
+
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+    {
+        qWarning("ALSA: Cannot set real-time priority %d: %s", param.sched_priority, strerror(err));
+        return false;
+    }
+
+    qDebug("ALSA: real-time priority set to %d", param.sched_priority);
+    return true;
+}
+
 qint64 AudioRendererAlsa::writeAudio(unsigned char *data, qint64 maxSize)
 {
     if (pcm_handle == NULL || m_prebuf == NULL)
         return 0;
 
+    // initialize() runs in the caller thread, the writes in the renderer one
+    if (m_priority > 0 && m_prioritySet == false)
+    {
+        setRealtimePriority(m_priority);
+        m_prioritySet = true;
+    }
+
     if((maxSize = qMin(maxSize, m_prebuf_size - m_prebuf_fill)) > 0)
     {
         memmove(m_prebuf + m_prebuf_fill, data, maxSize);
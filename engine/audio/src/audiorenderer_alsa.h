@@ -39,6 +39,14 @@ extern "C"
  * @{
  */
 
+/** Requested device buffer and period, in frames. 0 uses the defaults */
+#define SETTINGS_AUDIO_ALSA_OUTPUT_BUFFER   "audio/alsaoutputbuffer"
+#define SETTINGS_AUDIO_ALSA_OUTPUT_PERIOD   "audio/alsaoutputperiod"
+/** Write the samples through mmap access instead of read/write */
+#define SETTINGS_AUDIO_ALSA_OUTPUT_MMAP     "audio/alsaoutputmmap"
+/** SCHED_FIFO priority of the renderer thread. 0 leaves it unchanged */
+#define SETTINGS_AUDIO_ALSA_OUTPUT_PRIORITY "audio/alsaoutputpriority"
+
 class AudioRendererAlsa : public AudioRenderer
 {
     Q_OBJECT
@@ -54,6 +62,12 @@ public:
 
     static QList<AudioDeviceInfo> getDevicesInfo();
 
+    /**
+     * Give the calling thread the SCHED_FIFO real-time $priority.
+     * This needs the rtprio limit or the CAP_SYS_NICE capability
+     */
+    static bool setRealtimePriority(int priority);
+
 protected:
     /** @reimpl */
     qint64 writeAudio(unsigned char *data, qint64 maxSize);
@@ -79,6 +93,14 @@ private:
     bool m_inited;
     bool m_use_mmap;
 
+    /** The buffer and period requested in the settings, in frames */
+    snd_pcm_uframes_t m_bufferFrames;
+    snd_pcm_uframes_t m_periodFrames;
+
+    /** The real-time priority, applied by the first write of the thread */
+    int m_priority;
+    bool m_prioritySet;
+
     // ALSA specific
     snd_pcm_t *pcm_handle;
     char *pcm_name;
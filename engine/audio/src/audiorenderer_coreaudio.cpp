@@ -101,7 +101,7 @@ bool AudioRendererCoreAudio::initialize(quint32 freq, int chan, AudioFormat form
 
 qint64 AudioRendererCoreAudio::latency()
 {
-    return 0;
+    return bytesToTime(qint64(m_buffersFilled) * AUDIO_BUFFER_SIZE);
 }
 
 qint64 AudioRendererCoreAudio::writeAudio(unsigned char *data, qint64 maxSize)
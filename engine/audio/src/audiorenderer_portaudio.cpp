@@ -147,7 +147,16 @@ bool AudioRendererPortAudio::initialize(quint32 freq, int chan, AudioFormat form
 
 qint64 AudioRendererPortAudio::latency()
 {
-    return 0;
+    if (m_paStream == NULL)
+        return 0;
+
+    qint64 deviceLatency = 0;
+    const PaStreamInfo *info = Pa_GetStreamInfo(m_paStream);
+    if (info != NULL)
+        deviceLatency = qint64(info->outputLatency * 1000);
+
+    QMutexLocker locker(&m_paMutex);
+    return deviceLatency + bytesToTime(m_buffer.size());
 }
 
 QList<AudioDeviceInfo> AudioRendererPortAudio::getDevicesInfo()
@@ -102,7 +102,10 @@ bool AudioRendererQt::initialize(quint32 freq, int chan, AudioFormat format)
 
 qint64 AudioRendererQt::latency()
 {
-    return 0;
+    if (m_audioOutput == NULL)
+        return 0;
+
+    return bytesToTime(m_audioOutput->bufferSize() - m_audioOutput->bytesFree());
 }
 
 QList<AudioDeviceInfo> AudioRendererQt::getDevicesInfo()
@@ -204,5 +207,11 @@ void AudioRendererQt::run()
         }
     }
     AudioRenderer::run();
+
+    // the output is bound to this thread, so release it here
+    // to allow the renderer to be started again
     m_audioOutput->stop();
+    delete m_audioOutput;
+    m_audioOutput = NULL;
+    m_output = NULL;
 }
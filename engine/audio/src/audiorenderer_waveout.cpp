@@ -38,6 +38,7 @@
 static CRITICAL_SECTION  cs;
 static HWAVEOUT          dev                    = NULL;
 static unsigned int      ScheduledBlocks        = 0;
+static qint64            ScheduledBytes         = 0;
 static int               PlayedWaveHeadersCount = 0;          // free index
 static WAVEHDR*          PlayedWaveHeaders [MAX_WAVEBLOCKS];
 
@@ -65,6 +66,7 @@ free_memory (void)
     EnterCriticalSection (&cs);
     wh = PlayedWaveHeaders [--PlayedWaveHeadersCount];
     ScheduledBlocks--;                        // decrease the number of USED blocks
+    ScheduledBytes -= wh->dwBufferLength;
     LeaveCriticalSection (&cs);
 
     waveOutUnprepareHeader (dev, wh, sizeof (WAVEHDR));
@@ -152,7 +154,11 @@ bool AudioRendererWaveOut::initialize(quint32 freq, int chan, AudioFormat format
 
 qint64 AudioRendererWaveOut::latency()
 {
-    return 0;
+    EnterCriticalSection (&cs);
+    qint64 scheduled = ScheduledBytes;
+    LeaveCriticalSection (&cs);
+
+    return bytesToTime(scheduled);
 }
 
 QList<AudioDeviceInfo> AudioRendererWaveOut::getDevicesInfo()
@@ -254,6 +260,7 @@ qint64 AudioRendererWaveOut::writeAudio(unsigned char *data, qint64 len)
 
     EnterCriticalSection (&cs);
     ScheduledBlocks++;
+    ScheduledBytes += len;
     LeaveCriticalSection (&cs);
 
     return len;
@@ -304,5 +311,6 @@ void AudioRendererWaveOut::uninitialize()
 
     DeleteCriticalSection (&cs);
     ScheduledBlocks = 0;
+    ScheduledBytes = 0;
     return;
 }
@@ -0,0 +1,139 @@
+/*
+  Q Light Controller Plus
+  beatdetector.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <qmath.h>
+
+#include "beatdetector.h"
+
+/** Number of flux values the threshold is computed on (about 1.5s
+ *  with the default capture buffer size and sample rate) */
+#define BEAT_FLUX_HISTORY       32
+/** Number of deviations above the mean flux to detect an onset */
+#define BEAT_THRESHOLD_DEVIATIONS   1.5
+/** Minimum flux to detect an onset, to ignore noise during silence */
+#define BEAT_MIN_FLUX           0.05
+/** Onsets closer than this (in ms) are ignored: 240 BPM at most */
+#define BEAT_MIN_INTERVAL       250
+/** Intervals longer than this (in ms) don't count for the tempo: 40 BPM at least */
+#define BEAT_MAX_INTERVAL       1500
+/** Number of intervals the tempo is estimated on */
+#define BEAT_INTERVALS_HISTORY  8
+
+BeatDetector::BeatDetector()
+    : m_fluxHistory(BEAT_FLUX_HISTORY)
+    , m_intervals(BEAT_INTERVALS_HISTORY)
+{
+    reset();
+}
+
+void BeatDetector::reset()
+{
+    m_previous.clear();
+    m_fluxIndex = 0;
+    m_fluxCount = 0;
+    m_aboveThreshold = false;
+    m_lastOnset = -1;
+    m_intervalIndex = 0;
+    m_intervalCount = 0;
+    m_bpm = 0;
+}
+
+bool BeatDetector::process(const double *magnitudes, int count, qint64 timestamp)
+{
+    if (m_previous.size() != count)
+    {
+        // First spectrum, or a spectrum of a different size: nothing to compare with
+        m_previous.resize(count);
+        for (int i = 0; i < count; i++)
+            m_previous[i] = log1p(magnitudes[i]);
+        return false;
+    }
+
+    double flux = 0;
+    double *previous = m_previous.data();
+    for (int i = 0; i < count; i++)
+    {
+        double magnitude = log1p(magnitudes[i]);
+        double diff = magnitude - previous[i];
+        if (diff > 0)
+            flux += diff;
+        previous[i] = magnitude;
+    }
+
+    bool onset = false;
+
+    // Wait for a full history before detecting anything
+    if (m_fluxCount == BEAT_FLUX_HISTORY)
+    {
+        double mean = 0, variance = 0;
+        for (int i = 0; i < BEAT_FLUX_HISTORY; i++)
+            mean += m_fluxHistory[i];
+        mean /= BEAT_FLUX_HISTORY;
+        for (int i = 0; i < BEAT_FLUX_HISTORY; i++)
+            variance += (m_fluxHistory[i] - mean) * (m_fluxHistory[i] - mean);
+        variance /= BEAT_FLUX_HISTORY;
+
+        double threshold = qMax(mean + BEAT_THRESHOLD_DEVIATIONS * qSqrt(variance), BEAT_MIN_FLUX);
+
+        // Report the onset as soon as the flux rises above
+        // the threshold, rather than waiting for its peak
+        bool above = flux > threshold;
+        if (above && m_aboveThreshold == false &&
+            (m_lastOnset < 0 || timestamp - m_lastOnset >= BEAT_MIN_INTERVAL))
+        {
+            if (m_lastOnset >= 0 && timestamp - m_lastOnset <= BEAT_MAX_INTERVAL)
+            {
+                m_intervals[m_intervalIndex] = int(timestamp - m_lastOnset);
+                m_intervalIndex = (m_intervalIndex + 1) % BEAT_INTERVALS_HISTORY;
+                if (m_intervalCount < BEAT_INTERVALS_HISTORY)
+                    m_intervalCount++;
+                updateBpm();
+            }
+            m_lastOnset = timestamp;
+            onset = true;
+        }
+        m_aboveThreshold = above;
+    }
+    else
+    {
+        m_fluxCount++;
+    }
+
+    m_fluxHistory[m_fluxIndex] = flux;
+    m_fluxIndex = (m_fluxIndex + 1) % BEAT_FLUX_HISTORY;
+
+    return onset;
+}
+
+int BeatDetector::bpm() const
+{
+    return m_bpm;
+}
+
+void BeatDetector::updateBpm()
+{
+    // The median is not fooled by a missed or an extra onset
+    QVector<int> intervals = m_intervals.mid(0, m_intervalCount);
+    std::sort(intervals.begin(), intervals.end());
+    int median = intervals.at(intervals.count() / 2);
+
+    m_bpm = qRound(60000.0 / median);
+}
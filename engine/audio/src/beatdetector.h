@@ -0,0 +1,81 @@
+/*
+  Q Light Controller Plus
+  beatdetector.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BEATDETECTOR_H
+#define BEATDETECTOR_H
+
+#include <QVector>
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+/**
+ * Onset detector working on consecutive magnitude spectra.
+ * It computes the spectral flux (the sum of the magnitude increases
+ * between two spectra) and reports an onset when the flux rises
+ * above an adaptive threshold, based on the mean and deviation
+ * of the recent flux values. The tempo is estimated from the
+ * intervals between the last onsets.
+ */
+class BeatDetector
+{
+public:
+    BeatDetector();
+
+    /** Forget the spectra, onsets and tempo processed so far */
+    void reset();
+
+    /** Process the $count bins of a new magnitude spectrum, captured
+     *  at $timestamp milliseconds. Returns true if an onset is detected */
+    bool process(const double *magnitudes, int count, qint64 timestamp);
+
+    /** The tempo estimated from the recent onsets, 0 if not known yet */
+    int bpm() const;
+
+private:
+    /** Compute the tempo from m_intervals */
+    void updateBpm();
+
+private:
+    /** The log compressed magnitudes of the previous spectrum */
+    QVector<double> m_previous;
+
+    /** The recent flux values, used as a circular buffer */
+    QVector<double> m_fluxHistory;
+    int m_fluxIndex;
+    int m_fluxCount;
+
+    /** True while the flux is above the threshold */
+    bool m_aboveThreshold;
+
+    /** The time of the last onset, -1 if none */
+    qint64 m_lastOnset;
+
+    /** The recent intervals between onsets, used as a circular buffer */
+    QVector<int> m_intervals;
+    int m_intervalIndex;
+    int m_intervalCount;
+
+    int m_bpm;
+};
+
+/** @} */
+
+#endif
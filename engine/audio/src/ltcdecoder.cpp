@@ -0,0 +1,192 @@
+/*
+  Q Light Controller Plus
+  ltcdecoder.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <qmath.h>
+
+#include "ltcdecoder.h"
+#include "timecodetracker.h"
+
+/** The number of bits of a frame */
+#define LTC_FRAME_BITS      80
+/** The sync word ending a frame, as received from its first bit (0011111111111101) */
+#define LTC_SYNC_WORD       0xBFFC
+/** The sample level a zero crossing must reach, to ignore the noise */
+#define LTC_HYSTERESIS      512
+/** The loop gain applied to each measured bit period */
+#define LTC_PERIOD_GAIN     0.1
+
+/** Return the $count bits of $bits starting from $first */
+static int bitField(quint64 bits, int first, int count)
+{
+    return int((bits >> first) & ((1 << count) - 1));
+}
+
+LTCDecoder::LTCDecoder()
+    : m_sampleRate(0)
+{
+    setSampleRate(44100);
+}
+
+void LTCDecoder::reset()
+{
+    // start from the middle of the 24-30 fps range
+    m_period = (m_minPeriod + m_maxPeriod) / 2;
+    m_level = false;
+    m_interval = 0;
+    m_halfBit = false;
+    m_frameBits = 0;
+    m_syncBits = 0;
+    m_bitCount = 0;
+    m_position = 0;
+    m_samplesAfterFrame = 0;
+}
+
+void LTCDecoder::setSampleRate(unsigned int sampleRate)
+{
+    m_sampleRate = qMax(sampleRate, 1U);
+    m_minPeriod = double(m_sampleRate) / (LTC_FRAME_BITS * 30) * 0.9;
+    m_maxPeriod = double(m_sampleRate) / (LTC_FRAME_BITS * 24) * 1.1;
+    reset();
+}
+
+bool LTCDecoder::process(const int16_t *samples, int count, int stride)
+{
+    bool decoded = false;
+    // beyond this, the signal is lost anyway
+    int maxInterval = int(m_maxPeriod * 4);
+
+    for (int i = 0; i < count; i++)
+    {
+        int sample = samples[i * stride];
+
+        if (m_interval < maxInterval)
+            m_interval++;
+
+        if ((m_level && sample < -LTC_HYSTERESIS) || (m_level == false && sample > LTC_HYSTERESIS))
+        {
+            m_level = !m_level;
+            if (transition(m_interval))
+            {
+                decoded = true;
+                m_samplesAfterFrame = count - 1 - i;
+            }
+            m_interval = 0;
+        }
+    }
+
+    if (decoded == false)
+        m_samplesAfterFrame += count;
+
+    return decoded;
+}
+
+qint64 LTCDecoder::position() const
+{
+    return m_position;
+}
+
+int LTCDecoder::samplesAfterFrame() const
+{
+    return m_samplesAfterFrame;
+}
+
+bool LTCDecoder::transition(int interval)
+{
+    if (interval > m_period * 1.5)
+    {
+        // too long for a bit: the signal has been lost, or the timecode is
+        // slower than expected. Try the interval as the new bit period
+        m_halfBit = false;
+        m_bitCount = 0;
+        if (interval <= m_maxPeriod * 1.5)
+            m_period = qBound(m_minPeriod, double(interval), m_maxPeriod);
+        return false;
+    }
+
+    if (interval > m_period * 0.75)
+    {
+        // a full bit is a 0, unless it breaks a 1 in half
+        if (m_halfBit)
+        {
+            m_halfBit = false;
+            m_bitCount = 0;
+            return false;
+        }
+        adaptPeriod(interval);
+        return pushBit(false);
+    }
+
+    if (m_halfBit == false)
+    {
+        m_halfBit = true;
+        return false;
+    }
+
+    m_halfBit = false;
+    adaptPeriod(interval * 2);
+    return pushBit(true);
+}
+
+bool LTCDecoder::pushBit(bool bit)
+{
+    m_frameBits = (m_frameBits >> 1) | (quint64(m_syncBits & 0x01) << 63);
+    m_syncBits = quint16((m_syncBits >> 1) | (bit ? 0x8000 : 0));
+
+    if (m_bitCount < LTC_FRAME_BITS)
+        m_bitCount++;
+
+    if (m_bitCount < LTC_FRAME_BITS || m_syncBits != LTC_SYNC_WORD)
+        return false;
+
+    // the bits of the next frame follow the sync word
+    m_bitCount = 0;
+
+    return decodeFrame();
+}
+
+bool LTCDecoder::decodeFrame()
+{
+    int frames = bitField(m_frameBits, 0, 4) + 10 * bitField(m_frameBits, 8, 2);
+    bool dropFrame = bitField(m_frameBits, 10, 1) != 0;
+    int seconds = bitField(m_frameBits, 16, 4) + 10 * bitField(m_frameBits, 24, 3);
+    int minutes = bitField(m_frameBits, 32, 4) + 10 * bitField(m_frameBits, 40, 3);
+    int hours = bitField(m_frameBits, 48, 4) + 10 * bitField(m_frameBits, 56, 2);
+
+    if (frames >= 30 || seconds >= 60 || minutes >= 60 || hours >= 24)
+        return false;
+
+    // the frame rate is not transmitted, but told by the bit rate
+    double fps = double(m_sampleRate) / (m_period * LTC_FRAME_BITS);
+    int rate = fps < 24.5 ? 24 : fps < 27.5 ? 25 : 30;
+    if (frames >= rate)
+        rate = 30;
+
+    // the position is the one at the end of the frame, which is now
+    qint64 frameDuration = dropFrame ? 1001 / 30 : 1000 / rate;
+    m_position = TimecodeTracker::timecodeToMsecs(hours, minutes, seconds, frames,
+                                                  rate, dropFrame && rate == 30) + frameDuration;
+
+    return true;
+}
+
+void LTCDecoder::adaptPeriod(double measured)
+{
+    m_period += (measured - m_period) * LTC_PERIOD_GAIN;
+    m_period = qBound(m_minPeriod, m_period, m_maxPeriod);
+}
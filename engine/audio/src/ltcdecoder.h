@@ -0,0 +1,103 @@
+/*
+  Q Light Controller Plus
+  ltcdecoder.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef LTCDECODER_H
+#define LTCDECODER_H
+
+#include <stdint.h>
+#include <QtGlobal>
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+/**
+ * Decoder of the Linear Timecode (SMPTE LTC) carried by an audio signal.
+ *
+ * LTC is a biphase mark code: the signal changes level at the start of
+ * every bit, and once more in the middle of the bits set to 1. The
+ * decoder measures the intervals between the zero crossings, following
+ * the bit period as it is received, so 24, 25 and 30 fps timecodes are
+ * decoded without being told. Each 80 bit frame ends with a sync word,
+ * which is used to find the frames in the bit stream. Only timecode
+ * played forward is decoded.
+ */
+class LTCDecoder
+{
+public:
+    LTCDecoder();
+
+    /** Forget the signal processed so far */
+    void reset();
+
+    /** Set the sample rate of the processed signal */
+    void setSampleRate(unsigned int sampleRate);
+
+    /** Process the $count samples of a signal, taken one every $stride
+     *  values of $samples. Returns true if a frame has been decoded */
+    bool process(const int16_t *samples, int count, int stride);
+
+    /** The position in ms at the end of the last decoded frame */
+    qint64 position() const;
+
+    /** The number of samples processed after the end of the last decoded frame */
+    int samplesAfterFrame() const;
+
+private:
+    /** Process a level change, $interval samples after the previous one.
+     *  Returns true if it completes a frame */
+    bool transition(int interval);
+
+    /** Append a bit to the received ones. Returns true if it completes a frame */
+    bool pushBit(bool bit);
+
+    /** Decode the frame held by the received bits */
+    bool decodeFrame();
+
+    /** Move the bit period toward $measured */
+    void adaptPeriod(double measured);
+
+private:
+    unsigned int m_sampleRate;
+    /** The shortest and longest accepted bit periods, in samples */
+    double m_minPeriod;
+    double m_maxPeriod;
+    /** The estimated bit period, in samples */
+    double m_period;
+
+    /** The current level of the signal */
+    bool m_level;
+    /** The samples elapsed since the last level change */
+    int m_interval;
+    /** True when the first half of a bit set to 1 has been received */
+    bool m_halfBit;
+
+    /** The last 80 received bits: bits 0-63 and the sync word */
+    quint64 m_frameBits;
+    quint16 m_syncBits;
+    /** The number of valid bits received since the last frame */
+    int m_bitCount;
+
+    qint64 m_position;
+    int m_samplesAfterFrame;
+};
+
+/** @} */
+
+#endif
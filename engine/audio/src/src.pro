@@ -18,10 +18,15 @@ INCLUDEPATH += ../../src ../../../plugins/interfaces
 
 HEADERS += audio.h \
            audiodecoder.h \
+           audiodecodebuffer.h \
+           audioclipdecoder.h \
+           audiomixer.h \
            audiorenderer.h \
            audioparameters.h \
            audiocapture.h \
-           audioplugincache.h
+           audioplugincache.h \
+           beatdetector.h \
+           ltcdecoder.h
 
 lessThan(QT_MAJOR_VERSION, 5) {
   unix:!macx:HEADERS += audiorenderer_alsa.h audiocapture_alsa.h
@@ -33,10 +38,15 @@ else {
 
 SOURCES += audio.cpp \
            audiodecoder.cpp \
+           audiodecodebuffer.cpp \
+           audioclipdecoder.cpp \
+           audiomixer.cpp \
            audiorenderer.cpp \
            audioparameters.cpp \
            audiocapture.cpp \
-           audioplugincache.cpp
+           audioplugincache.cpp \
+           beatdetector.cpp \
+           ltcdecoder.cpp
 
 lessThan(QT_MAJOR_VERSION, 5) {
   unix:!macx:SOURCES += audiorenderer_alsa.cpp audiocapture_alsa.cpp
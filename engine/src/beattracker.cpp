@@ -0,0 +1,158 @@
+/*
+  Q Light Controller Plus
+  beattracker.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <qmath.h>
+
+#include "beattracker.h"
+
+/** The maximum error of a beat, as a fraction of the period */
+#define BEAT_TOLERANCE 0.25
+/** The number of consecutive dropped beats that make the tracker lock again */
+#define BEAT_RELOCK_OUTLIERS 3
+/** The maximum number of missing beats before the tracking starts over */
+#define BEAT_MAX_MISSED 4
+/** The loop gains applied to the error of each beat */
+#define BEAT_PHASE_GAIN 0.25
+#define BEAT_PERIOD_GAIN 0.05
+
+BeatTracker::BeatTracker()
+    : m_latency(0)
+{
+    reset();
+}
+
+BeatTracker::~BeatTracker()
+{
+}
+
+void BeatTracker::reset()
+{
+    m_beats = 0;
+    m_lastBeat = 0;
+    m_phase = 0;
+    m_period = 0;
+    m_outliers = 0;
+}
+
+void BeatTracker::setLatency(int latency)
+{
+    m_latency = latency;
+}
+
+int BeatTracker::latency() const
+{
+    return m_latency;
+}
+
+bool BeatTracker::addBeat(qint64 timestamp)
+{
+    qint64 time = timestamp - m_latency;
+
+    if (m_beats == 0)
+    {
+        m_beats++;
+        m_lastBeat = time;
+        m_phase = time;
+        return true;
+    }
+
+    qint64 interval = time - m_lastBeat;
+
+    // not locked yet: the first valid interval is the period
+    if (m_period == 0)
+    {
+        // a duplicate of the previous beat
+        if (interval < BEAT_MIN_PERIOD)
+            return false;
+
+        m_beats++;
+        m_lastBeat = time;
+        m_phase = time;
+        if (interval <= BEAT_MAX_PERIOD)
+            m_period = interval;
+        return true;
+    }
+
+    // after a long pause, start over from this beat
+    if (time - m_phase > BEAT_MAX_MISSED * m_period)
+    {
+        reset();
+        return addBeat(timestamp);
+    }
+
+    int beats = qMax(1, qRound((time - m_phase) / m_period));
+    double predicted = m_phase + beats * m_period;
+    double error = time - predicted;
+
+    if (qAbs(error) > m_period * BEAT_TOLERANCE)
+    {
+        m_lastBeat = time;
+        if (++m_outliers < BEAT_RELOCK_OUTLIERS)
+            return false;
+
+        // the tempo has really changed: lock again on the new beats
+        m_beats++;
+        m_outliers = 0;
+        m_phase = time;
+        m_period = (interval >= BEAT_MIN_PERIOD && interval <= BEAT_MAX_PERIOD) ? interval : 0;
+        return true;
+    }
+
+    m_beats++;
+    m_outliers = 0;
+    m_lastBeat = time;
+    m_phase = predicted + BEAT_PHASE_GAIN * error;
+    m_period = qBound(double(BEAT_MIN_PERIOD), m_period + BEAT_PERIOD_GAIN * error / beats,
+                      double(BEAT_MAX_PERIOD));
+
+    return true;
+}
+
+bool BeatTracker::isLocked() const
+{
+    return m_period > 0;
+}
+
+double BeatTracker::period() const
+{
+    return m_period;
+}
+
+double BeatTracker::bpm() const
+{
+    if (m_period == 0)
+        return 0;
+
+    return 60000.0 / m_period;
+}
+
+int BeatTracker::beatDelay(qint64 timestamp) const
+{
+    if (m_beats == 0)
+        return 0;
+
+    double delay = timestamp - m_phase;
+
+    // with a long latency, the latest beat may be
+    // a predicted one, not yet received
+    if (m_period > 0 && delay >= m_period)
+        delay = fmod(delay, m_period);
+
+    return qRound(delay);
+}
@@ -0,0 +1,93 @@
+/*
+  Q Light Controller Plus
+  beattracker.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BEATTRACKER_H
+#define BEATTRACKER_H
+
+#include <QtGlobal>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** The shortest and longest beat periods tracked, in milliseconds (300 and 30 BPM) */
+#define BEAT_MIN_PERIOD 200
+#define BEAT_MAX_PERIOD 2000
+
+/**
+ * BeatTracker follows the tempo and the phase of beats received from an
+ * external source whose delivery time is jittery, like a network client.
+ *
+ * Every received beat is compared with the time predicted from the previous
+ * ones. Small errors only nudge the estimated phase and period (a second
+ * order phase-locked loop), so the jitter of the transport is filtered out.
+ * Beats too far from the prediction are dropped, unless several of them
+ * in a row tell that the tempo has really changed, in which case the
+ * tracker locks again on the new beats.
+ *
+ * Timestamps are in milliseconds of any monotonic clock. The latency is
+ * the time elapsed between a beat and its reception, and is subtracted
+ * from every timestamp.
+ */
+class BeatTracker
+{
+public:
+    BeatTracker();
+    ~BeatTracker();
+
+    /** Forget every beat received so far */
+    void reset();
+
+    /** Get/Set the latency of the beats delivery, in milliseconds */
+    void setLatency(int latency);
+    int latency() const;
+
+    /** Process a beat received at $timestamp. Return true if the beat
+     *  has been accepted, or false if it has been dropped as jitter */
+    bool addBeat(qint64 timestamp);
+
+    /** Return true when the tracker has a tempo estimation */
+    bool isLocked() const;
+
+    /** The estimated beat period in milliseconds, or 0 when not locked */
+    double period() const;
+
+    /** The estimated beats per minute, or 0 when not locked */
+    double bpm() const;
+
+    /** Return the milliseconds elapsed at $timestamp since the
+     *  latest estimated beat, latency included */
+    int beatDelay(qint64 timestamp) const;
+
+private:
+    int m_latency;
+    /** The number of beats received since the last reset */
+    quint32 m_beats;
+    /** The latency compensated time of the last received beat */
+    qint64 m_lastBeat;
+    /** The estimated time of the last beat and the estimated period */
+    double m_phase;
+    double m_period;
+    /** The number of consecutive beats dropped */
+    int m_outliers;
+};
+
+/** @} */
+
+#endif
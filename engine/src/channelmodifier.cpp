@@ -135,6 +135,35 @@ QFile::FileError ChannelModifier::saveXML(const QString &fileName)
     return error;
 }
 
+QString ChannelModifier::loadName(const QString &fileName)
+{
+    QXmlStreamReader *doc = QLCFile::getXMLReader(fileName);
+    if (doc == NULL || doc->device() == NULL || doc->hasError())
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to read from" << fileName;
+        return QString();
+    }
+
+    QString name;
+
+    if (doc->readNextStartElement() && doc->name() == KXMLQLCChannelModifierDocument)
+    {
+        while (doc->readNextStartElement())
+        {
+            if (doc->name() == KXMLQLCChannelModName)
+            {
+                name = doc->readElementText();
+                break;
+            }
+            doc->skipCurrentElement();
+        }
+    }
+
+    QLCFile::releaseXMLReader(doc);
+
+    return name;
+}
+
 QFile::FileError ChannelModifier::loadXML(const QString &fileName, Type type)
 {
     QFile::FileError error = QFile::NoError;
@@ -71,6 +71,10 @@ public:
     /** Load this modifier's content from the given file */
     QFile::FileError loadXML(const QString& fileName, Type type);
 
+    /** Read only the name of the modifier in the given file, without
+        building its map. Returns an empty string on failure. */
+    static QString loadName(const QString& fileName);
+
 private:
     QString m_name;
     Type m_type;
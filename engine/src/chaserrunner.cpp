@@ -497,6 +497,7 @@ void ChaserRunner::startNewStep(int index, MasterTimer *timer, qreal mIntensity,
 
     ChaserRunnerStep *newStep = new ChaserRunnerStep();
     newStep->m_index = index;
+    newStep->m_prefetched = false;
 
     // check if blending between Scenes is needed
     if (m_lastFunctionID != Function::invalidId() &&
@@ -543,10 +544,17 @@ void ChaserRunner::startNewStep(int index, MasterTimer *timer, qreal mIntensity,
 
     newStep->m_duration = stepDuration(index);
 
+    // the sub-tick phase the step starts with, when it continues a previous step
+    quint32 phase = 0;
     if (m_startOffset != 0)
+    {
         newStep->m_elapsed = m_startOffset + MasterTimer::tick();
+    }
     else
+    {
         newStep->m_elapsed = MasterTimer::tick() + elapsed;
+        phase = elapsed;
+    }
     newStep->m_elapsedBeats = 0; //(newStep->m_elapsed / timer->beatTimeDuration()) * 1000;
 
     m_startOffset = 0;
@@ -580,8 +588,8 @@ void ChaserRunner::startNewStep(int index, MasterTimer *timer, qreal mIntensity,
         newStep->m_intensityOverrideId = func->requestAttributeOverride(Function::Intensity, mIntensity * sIntensity);
     }
 
-    // Start the fire up !
-    func->start(timer, functionParent(), 0, newStep->m_fadeIn, newStep->m_fadeOut,
+    // Start the fire up ! The function runs from the same phase as the step
+    func->start(timer, functionParent(), phase, newStep->m_fadeIn, newStep->m_fadeOut,
                 func->defaultSpeed(), m_chaser->tempoType());
     m_runnerSteps.append(newStep);
     m_roundTime->restart();
@@ -697,6 +705,50 @@ int ChaserRunner::getNextStepIndex()
     return currentStepIndex;
 }
 
+int ChaserRunner::peekNextStepIndex()
+{
+    // getNextStepIndex() might reverse the direction or shuffle
+    // a new random order at the end of the steps: undo its changes
+    Function::Direction direction = m_direction;
+    QVector<int> order = m_order;
+
+    int index = getNextStepIndex();
+
+    m_direction = direction;
+    m_order = order;
+
+    return index;
+}
+
+void ChaserRunner::prefetchNextStep()
+{
+    // Sequence steps share the same Scene, which cannot be prepared
+    // while it is still running the current step
+    if (m_runnerSteps.isEmpty() || m_chaser->type() == Function::SequenceType)
+        return;
+
+    ChaserRunnerStep *step = m_runnerSteps.last();
+    if (step->m_duration == Function::infiniteSpeed() || step->m_prefetched)
+        return;
+
+    // prefetch on the tick before the step is due to end
+    if ((m_chaser->tempoType() == Function::Time &&
+         step->m_elapsed + MasterTimer::tick() < step->m_duration) ||
+        (m_chaser->tempoType() == Function::Beats &&
+         step->m_elapsedBeats + 1000 < step->m_duration))
+        return;
+
+    step->m_prefetched = true;
+
+    int index = peekNextStepIndex();
+    if (index < 0 || index >= m_chaser->stepsCount())
+        return;
+
+    Function *func = m_doc->function(m_chaser->steps().at(index).fid);
+    if (func != NULL && func != step->m_function)
+        func->prepareRun();
+}
+
 void ChaserRunner::setPause(bool enable)
 {
     // Nothing to do
@@ -756,7 +808,12 @@ bool ChaserRunner::write(MasterTimer *timer, QList<Universe *> universes)
             ((m_chaser->tempoType() == Function::Time && step->m_elapsed >= step->m_duration) ||
              (m_chaser->tempoType() == Function::Beats && step->m_elapsedBeats >= step->m_duration)))
         {
-            if (step->m_duration != 0)
+            // carry the time the next step is already late by, so the
+            // steps don't drift: the overshoot of the step duration, or
+            // the time since the beat that ended the step
+            if (m_chaser->tempoType() == Function::Beats)
+                prevStepRoundElapsed = timer->isBeat() ? quint32(timer->beatPhase()) : 0;
+            else if (step->m_duration != 0)
                 prevStepRoundElapsed = step->m_elapsed % step->m_duration;
 
             m_lastFunctionID = step->m_function->type() == Function::SceneType ? step->m_function->id() : Function::invalidId();
@@ -803,6 +860,7 @@ bool ChaserRunner::write(MasterTimer *timer, QList<Universe *> universes)
     }
 
     m_pendingAction.m_action = ChaserNoAction;
+    prefetchNextStep();
     return true;
 }
 
@@ -52,6 +52,7 @@ typedef struct
     Universe::BlendMode m_blendMode;    //! The original Function blend mode
     int m_intensityOverrideId;          //! An ID to control the step intensity
     int m_pIntensityOverrideId;         //! An ID to control the step parent intensity
+    bool m_prefetched;                  //! The next step Function has been prepared
 } ChaserRunnerStep;
 
 class ChaserRunner : public QObject
@@ -195,6 +196,14 @@ private:
      */
     int getNextStepIndex();
 
+    /** Predict the index of the step that will follow the current one,
+     *  without changing the runner state. Returns -1 if unknown */
+    int peekNextStepIndex();
+
+    /** Prepare the Function of the next step when the current one
+     *  is about to end, so that the step change is cheaper */
+    void prefetchNextStep();
+
 private:
     FunctionParent functionParent() const;
 
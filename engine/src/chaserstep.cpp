@@ -167,6 +167,28 @@ ChaserStep ChaserStep::fromVariant(const QVariant& var)
     return cs;
 }
 
+/**
+ * Read the next unsigned number of a step values string from $p, moving $p
+ * past the number and its separator, which is returned in $separator (a null
+ * QChar at the end of the string). Returns false when there's no number left.
+ */
+static bool nextStepNumber(const QChar *&p, const QChar *end, quint32 &number, QChar &separator)
+{
+    if (p >= end)
+        return false;
+
+    number = 0;
+    while (p < end && p->isDigit())
+    {
+        number = number * 10 + p->digitValue();
+        p++;
+    }
+
+    separator = (p < end) ? *p++ : QChar();
+
+    return true;
+}
+
 bool ChaserStep::loadXML(QXmlStreamReader &root, int& stepNumber, Doc *doc)
 {
     bool holdFound = false;
@@ -202,40 +224,45 @@ bool ChaserStep::loadXML(QXmlStreamReader &root, int& stepNumber, Doc *doc)
 
             // step values are saved as a string with the following syntax:
             // fixtureID:channel,value,channel,value:fixtureID:channel,value ... etc
-
-            // split the string by Fixture chunks
-            QStringList fxArray = stepValues.split(":");
-
-            for (int f = 0; f < fxArray.count(); f+=2)
+            // The string is scanned in place, without splitting it into
+            // temporary string lists.
+            const QChar *p = stepValues.constData();
+            const QChar *end = p + stepValues.length();
+            quint32 fxID, chIndex, value;
+            QChar sep;
+
+            while (nextStepNumber(p, end, fxID, sep) && sep == ':')
             {
-                if (f + 1 >= fxArray.count())
-                    break;
-
-                quint32 fxID = QString(fxArray.at(f)).toUInt();
-                if (doc != NULL && doc->fixture(fxID) == NULL)
-                    continue;
+                bool fixtureExists = (doc == NULL || doc->fixture(fxID) != NULL);
 
-                // now split the chunk into channel/values
-                QStringList varray = fxArray.at(f + 1).split(",");
-                for (int i = 0; i < varray.count(); i+=2)
+                do
                 {
-                    quint32 chIndex = QString(varray.at(i)).toUInt();
-                    SceneValue scv = SceneValue(fxID, chIndex, uchar(QString(varray.at(i + 1)).toInt()));
+                    if (nextStepNumber(p, end, chIndex, sep) == false || sep != ',' ||
+                        nextStepNumber(p, end, value, sep) == false)
+                        break;
+
+                    if (fixtureExists == false)
+                        continue;
 
                     while (sIdx < values.count())
                     {
-                        if (values.at(sIdx).fxi == scv.fxi && values.at(sIdx).channel == scv.channel)
+                        if (values.at(sIdx).fxi == fxID && values.at(sIdx).channel == chIndex)
                             break;
                         sIdx++;
                     }
 
+                    // values prefilled from the bound Scene are shared with it
+                    // and with the other steps, so they're detached only
+                    // when this step actually sets a different value
                     if (sIdx < values.count())
-                        values.replace(sIdx, scv);
+                    {
+                        if (values.at(sIdx).value != uchar(value))
+                            values[sIdx].value = uchar(value);
+                    }
                     else
-                        values.append(scv);
-                }
+                        values.append(SceneValue(fxID, chIndex, uchar(value)));
+                } while (sep == ',');
             }
-            //qSort(values.begin(), values.end());
         }
     }
     else
@@ -283,8 +310,9 @@ bool ChaserStep::saveXML(QXmlStreamWriter *doc, int stepNumber, bool isSequence)
         /* it's a sequence step. Save values accordingly */
         doc->writeAttribute(KXMLQLCSequenceSceneValues, QString::number(values.count()));
         QString stepValues;
+        stepValues.reserve(values.count() * 8);
         quint32 fixtureID = Fixture::invalidId();
-        foreach(SceneValue scv, values)
+        foreach(const SceneValue &scv, values)
         {
             // step values are saved as a string with the following syntax:
             // fixtureID:channel,value,channel,value:fixtureID:channel,value ... etc
@@ -295,14 +323,17 @@ bool ChaserStep::saveXML(QXmlStreamWriter *doc, int stepNumber, bool isSequence)
                 if (scv.fxi != fixtureID)
                 {
                     if (stepValues.isEmpty() == false)
-                        stepValues.append(QString(":"));
-                    stepValues.append(QString("%1:").arg(scv.fxi));
+                        stepValues.append(QChar(':'));
+                    stepValues.append(QString::number(scv.fxi));
+                    stepValues.append(QChar(':'));
                     fixtureID = scv.fxi;
                 }
                 else
-                    stepValues.append(QString(","));
+                    stepValues.append(QChar(','));
 
-                stepValues.append(QString("%1,%2").arg(scv.channel).arg(scv.value));
+                stepValues.append(QString::number(scv.channel));
+                stepValues.append(QChar(','));
+                stepValues.append(QString::number(scv.value));
             }
         }
         if (stepValues.isEmpty() == false)
@@ -284,40 +284,82 @@ FunctionParent Collection::functionParent() const
     return FunctionParent(FunctionParent::Function, id());
 }
 
+void Collection::flattenFunction(Doc *doc, quint32 fid, qreal intensity, QSet<quint32> &visited)
+{
+    if (visited.contains(fid))
+        return;
+
+    visited << fid;
+
+    Function *function = doc->function(fid);
+    Q_ASSERT(function != NULL);
+
+    Collection *collection = qobject_cast<Collection *>(function);
+    if (collection != NULL)
+    {
+        qreal nestedIntensity = intensity * collection->getAttributeValue(Function::Intensity);
+        foreach (quint32 childId, collection->functions())
+            flattenFunction(doc, childId, nestedIntensity, visited);
+        return;
+    }
+
+    LeafFunction leaf;
+    leaf.m_function = function;
+    leaf.m_intensity = intensity;
+    leaf.m_intensityOverrideId = -1;
+    m_leaves.append(leaf);
+}
+
 void Collection::preRun(MasterTimer *timer)
 {
     Doc *doc = this->doc();
     Q_ASSERT(doc != NULL);
+
+    m_leaves.clear();
     {
         QMutexLocker locker(&m_functionListMutex);
-        m_runningChildren.clear();
+        QSet<quint32> visited;
+        visited << id();
         foreach (quint32 fid, m_functions)
-        {
-            Function *function = doc->function(fid);
-            Q_ASSERT(function != NULL);
+            flattenFunction(doc, fid, 1.0, visited);
+    }
 
-            m_intensityOverrideIds << function->requestAttributeOverride(Function::Intensity, getAttributeValue(Function::Intensity));
+    {
+        QMutexLocker locker(&m_runningChildrenMutex);
+        m_runningChildren.clear();
 
-            // Append the IDs of all functions started by this collection
-            // to a set so that we can track which of them are still controlled
-            // by this collection which are not.
-            m_runningChildren << function->id();
+        // Append the IDs of all functions started by this collection
+        // to a set so that we can track which of them are still controlled
+        // by this collection which are not.
+        for (int i = 0; i < m_leaves.count(); i++)
+            m_runningChildren << m_leaves.at(i).m_function->id();
 
-            // Listen to the children's stopped signals so that this Collection
-            // can give up its rights to stop the function later.
-            connect(function, SIGNAL(stopped(quint32)),
-                    this, SLOT(slotChildStopped(quint32)));
+        m_runningChildrenCount.storeRelease(m_runningChildren.count());
+    }
 
-            // Listen to the children's stopped signals so that this collection
-            // can give up its rights to stop the function later.
-            connect(function, SIGNAL(running(quint32)),
-                    this, SLOT(slotChildStarted(quint32)));
+    for (int i = 0; i < m_leaves.count(); i++)
+    {
+        LeafFunction &leaf = m_leaves[i];
+        Function *function = leaf.m_function;
 
-            //function->adjustAttribute(getAttributeValue(Function::Intensity), Function::Intensity);
-            function->start(timer, functionParent(), 0, overrideFadeInSpeed(), overrideFadeOutSpeed(), overrideDuration());
-        }
-        m_tick = 1;
+        leaf.m_intensityOverrideId = function->requestAttributeOverride(Function::Intensity,
+                                            getAttributeValue(Function::Intensity) * leaf.m_intensity);
+
+        // Listen to the children's stopped signals so that this Collection
+        // can give up its rights to stop the function later.
+        connect(function, SIGNAL(stopped(quint32)),
+                this, SLOT(slotChildStopped(quint32)));
+
+        // Listen to the children's stopped signals so that this collection
+        // can give up its rights to stop the function later.
+        connect(function, SIGNAL(running(quint32)),
+                this, SLOT(slotChildStarted(quint32)));
+
+        //function->adjustAttribute(getAttributeValue(Function::Intensity), Function::Intensity);
+        function->start(timer, functionParent(), 0, overrideFadeInSpeed(), overrideFadeOutSpeed(), overrideDuration());
     }
+    m_tick = 1;
+
     Function::preRun(timer);
 }
 
@@ -325,7 +367,14 @@ void Collection::setPause(bool enable)
 {
     Doc *doc = this->doc();
     Q_ASSERT(doc != NULL);
-    foreach (quint32 fid, m_runningChildren)
+
+    QSet <quint32> children;
+    {
+        QMutexLocker locker(&m_runningChildrenMutex);
+        children = m_runningChildren;
+    }
+
+    foreach (quint32 fid, children)
     {
         Function *function = doc->function(fid);
         Q_ASSERT(function != NULL);
@@ -348,29 +397,20 @@ void Collection::write(MasterTimer *timer, QList<Universe *> universes)
     else if (m_tick == 2)
     {
         m_tick = 0;
-        Doc *doc = this->doc();
-        Q_ASSERT(doc != NULL);
 
-        QMutexLocker locker(&m_functionListMutex);
-        foreach (quint32 fid, m_runningChildren)
+        for (int i = 0; i < m_leaves.count(); i++)
         {
-            Function *function = doc->function(fid);
-            Q_ASSERT(function != NULL);
-
             // First tick may correspond to this collection starting the function
             // Now that first tick is over, stop listening to running signal
-            disconnect(function, SIGNAL(running(quint32)),
+            disconnect(m_leaves.at(i).m_function, SIGNAL(running(quint32)),
                     this, SLOT(slotChildStarted(quint32)));
         }
     }
 
     incrementElapsed();
 
-    {
-        QMutexLocker locker(&m_functionListMutex);
-        if (m_runningChildren.size() > 0)
-            return;
-    }
+    if (m_runningChildrenCount.loadAcquire() > 0)
+        return;
 
     stop(functionParent());
 }
@@ -380,50 +420,53 @@ void Collection::postRun(MasterTimer* timer, QList<Universe *> universes)
     Doc* doc = qobject_cast <Doc*> (parent());
     Q_ASSERT(doc != NULL);
 
+    QSet <quint32> children;
     {
-        QMutexLocker locker(&m_functionListMutex);
-        /** Stop the member functions only if they have been started by this
-            collection. */
-        QSetIterator <quint32> it(m_runningChildren);
-        while (it.hasNext() == true)
-        {
-            Function* function = doc->function(it.next());
-            Q_ASSERT(function != NULL);
-            function->stop(functionParent());
-        }
-
+        QMutexLocker locker(&m_runningChildrenMutex);
+        children = m_runningChildren;
         m_runningChildren.clear();
+        m_runningChildrenCount.storeRelease(0);
+    }
 
-        for (int i = 0; i < m_functions.count(); i++)
+    /** Stop the member functions only if they have been started by this
+        collection. */
+    foreach (quint32 fid, children)
+    {
+        Function* function = doc->function(fid);
+        Q_ASSERT(function != NULL);
+        function->stop(functionParent());
+    }
+
+    for (int i = 0; i < m_leaves.count(); i++)
+    {
+        Function* function = m_leaves.at(i).m_function;
+
+        disconnect(function, SIGNAL(stopped(quint32)),
+                this, SLOT(slotChildStopped(quint32)));
+        if (m_tick == 2)
         {
-            Function* function = doc->function(m_functions.at(i));
-            Q_ASSERT(function != NULL);
-
-            disconnect(function, SIGNAL(stopped(quint32)),
-                    this, SLOT(slotChildStopped(quint32)));
-            if (m_tick == 2)
-            {
-                disconnect(function, SIGNAL(running(quint32)),
-                        this, SLOT(slotChildStarted(quint32)));
-            }
+            disconnect(function, SIGNAL(running(quint32)),
+                    this, SLOT(slotChildStarted(quint32)));
         }
-
-        m_intensityOverrideIds.clear();
     }
 
+    m_leaves.clear();
+
     Function::postRun(timer, universes);
 }
 
 void Collection::slotChildStopped(quint32 fid)
 {
-    QMutexLocker locker(&m_functionListMutex);
+    QMutexLocker locker(&m_runningChildrenMutex);
     m_runningChildren.remove(fid);
+    m_runningChildrenCount.storeRelease(m_runningChildren.count());
 }
 
 void Collection::slotChildStarted(quint32 fid)
 {
-    QMutexLocker locker(&m_functionListMutex);
+    QMutexLocker locker(&m_runningChildrenMutex);
     m_runningChildren << fid;
+    m_runningChildrenCount.storeRelease(m_runningChildren.count());
 }
 
 int Collection::adjustAttribute(qreal fraction, int attributeId)
@@ -432,16 +475,11 @@ int Collection::adjustAttribute(qreal fraction, int attributeId)
 
     if (isRunning() && attrIndex == Intensity)
     {
-        Doc* document = doc();
-        Q_ASSERT(document != NULL);
-
-        QMutexLocker locker(&m_functionListMutex);
-
-        for (int i = 0; i < m_functions.count(); i++)
+        for (int i = 0; i < m_leaves.count(); i++)
         {
-            Function* function = document->function(m_functions.at(i));
-            Q_ASSERT(function != NULL);
-            function->adjustAttribute(getAttributeValue(Function::Intensity), m_intensityOverrideIds.at(i));
+            const LeafFunction &leaf = m_leaves.at(i);
+            leaf.m_function->adjustAttribute(getAttributeValue(Function::Intensity) * leaf.m_intensity,
+                                             leaf.m_intensityOverrideId);
         }
     }
 
@@ -457,12 +495,8 @@ void Collection::setBlendMode(Universe::BlendMode mode)
 
     if (isRunning())
     {
-        for (int i = 0; i < m_functions.count(); i++)
-        {
-            Function* function = doc()->function(m_functions.at(i));
-            Q_ASSERT(function != NULL);
-            function->setBlendMode(mode);
-        }
+        for (int i = 0; i < m_leaves.count(); i++)
+            m_leaves.at(i).m_function->setBlendMode(mode);
     }
 
     Function::setBlendMode(mode);
@@ -21,6 +21,8 @@
 #ifndef COLLECTION_H
 #define COLLECTION_H
 
+#include <QAtomicInt>
+#include <QVector>
 #include <QMutex>
 #include <QList>
 #include <QSet>
@@ -105,9 +107,6 @@ public slots:
 protected:
     /** The list of Function IDs added to this Collection */
     QList <quint32> m_functions;
-    /** A list of intesity attribute override IDs populated when this Collection is
-     *  started and cleaned when it's stopped */
-    QList <int> m_intensityOverrideIds;
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
     mutable QMutex m_functionListMutex;
@@ -141,6 +140,15 @@ public:
 private:
     FunctionParent functionParent() const;
 
+    /** Append the Functions to be started for $fid to m_leaves. Nested
+     *  Collections are replaced by their members, recursively, so that
+     *  they are all started and controlled by this Collection.
+     *
+     *  @param intensity the product of the intensities of the nested
+     *                   Collections walked to reach $fid
+     *  @param visited the Functions already appended or expanded */
+    void flattenFunction(Doc *doc, quint32 fid, qreal intensity, QSet<quint32> &visited);
+
 public:
     /** @reimpl */
     void preRun(MasterTimer* timer);
@@ -162,8 +170,27 @@ protected slots:
     void slotChildStarted(quint32 fid);
 
 protected:
+    /** A Function started by this Collection */
+    struct LeafFunction
+    {
+        Function *m_function;
+        /** Intensity of the nested Collections containing the Function */
+        qreal m_intensity;
+        /** The intensity attribute override ID requested at start */
+        int m_intensityOverrideId;
+    };
+
+    /** The Functions started by this Collection, with nested Collections
+     *  flattened. Built when this Collection starts and left untouched
+     *  until it stops, so that it can be walked without locking */
+    QVector <LeafFunction> m_leaves;
+
     /** Number of currently running children */
     QSet <quint32> m_runningChildren;
+    /** Protects m_runningChildren, updated by the children signals */
+    QMutex m_runningChildrenMutex;
+    /** The size of m_runningChildren, checked at every write */
+    QAtomicInt m_runningChildrenCount;
     unsigned int m_tick;
 
     /*************************************************************************
@@ -42,6 +42,8 @@ CueStack::CueStack(Doc* doc)
     , m_fadeInSpeed(0)
     , m_fadeOutSpeed(0)
     , m_duration(UINT_MAX)
+    , m_cues(new QList <Cue>())
+    , m_readerCues(NULL)
     , m_running(false)
     , m_intensity(1.0)
     , m_currentIndex(-1)
@@ -59,7 +61,8 @@ CueStack::~CueStack()
     //qDebug() << Q_FUNC_INFO << (void*) this;
     Q_ASSERT(isStarted() == false);
     Q_ASSERT(isFlashing() == false);
-    m_cues.clear(); // Crashes without this, WTF?!
+    qDeleteAll(m_retiredCues);
+    delete m_cues.loadAcquire();
 }
 
 Doc* CueStack::doc() const
@@ -74,9 +77,16 @@ Doc* CueStack::doc() const
 void CueStack::setName(const QString& name, int index)
 {
     if (index < 0)
+    {
         m_name = name;
+    }
     else
-        m_cues[index].setName(name);
+    {
+        QMutexLocker locker(&m_mutex);
+        QList <Cue> cues(*m_cues.loadAcquire());
+        cues[index].setName(name);
+        publishCues(cues);
+    }
     emit changed(index);
 }
 
@@ -85,7 +95,7 @@ QString CueStack::name(int index) const
     if (index < 0)
         return m_name;
     else
-        return m_cues[index].name();
+        return cues()[index].name();
 }
 
 /****************************************************************************
@@ -95,9 +105,16 @@ QString CueStack::name(int index) const
 void CueStack::setFadeInSpeed(uint ms, int index)
 {
     if (index < 0)
+    {
         m_fadeInSpeed = ms;
+    }
     else
-        m_cues[index].setFadeInSpeed(ms);
+    {
+        QMutexLocker locker(&m_mutex);
+        QList <Cue> cues(*m_cues.loadAcquire());
+        cues[index].setFadeInSpeed(ms);
+        publishCues(cues);
+    }
     emit changed(index);
 }
 
@@ -106,15 +123,22 @@ uint CueStack::fadeInSpeed(int index) const
     if (index < 0)
         return m_fadeInSpeed;
     else
-        return m_cues[index].fadeInSpeed();
+        return cues()[index].fadeInSpeed();
 }
 
 void CueStack::setFadeOutSpeed(uint ms, int index)
 {
     if (index < 0)
+    {
         m_fadeOutSpeed = ms;
+    }
     else
-        m_cues[index].setFadeOutSpeed(ms);
+    {
+        QMutexLocker locker(&m_mutex);
+        QList <Cue> cues(*m_cues.loadAcquire());
+        cues[index].setFadeOutSpeed(ms);
+        publishCues(cues);
+    }
     emit changed(index);
 }
 
@@ -123,15 +147,22 @@ uint CueStack::fadeOutSpeed(int index) const
     if (index < 0)
         return m_fadeOutSpeed;
     else
-        return m_cues[index].fadeOutSpeed();
+        return cues()[index].fadeOutSpeed();
 }
 
 void CueStack::setDuration(uint ms, int index)
 {
     if (index < 0)
+    {
         m_duration = ms;
+    }
     else
-        m_cues[index].setDuration(ms);
+    {
+        QMutexLocker locker(&m_mutex);
+        QList <Cue> cues(*m_cues.loadAcquire());
+        cues[index].setDuration(ms);
+        publishCues(cues);
+    }
     emit changed(index);
 }
 
@@ -140,7 +171,7 @@ uint CueStack::duration(int index) const
     if (index < 0)
         return m_duration;
     else
-        return m_cues[index].duration();
+        return cues()[index].duration();
 }
 
 /****************************************************************************
@@ -154,8 +185,10 @@ void CueStack::appendCue(const Cue& cue)
     int index = 0;
     {
         QMutexLocker locker(&m_mutex);
-        m_cues.append(cue);
-        index = m_cues.size() - 1;
+        QList <Cue> cues(*m_cues.loadAcquire());
+        cues.append(cue);
+        index = cues.size() - 1;
+        publishCues(cues);
     }
 
     emit added(index);
@@ -169,18 +202,17 @@ void CueStack::insertCue(int index, const Cue& cue)
 
     {
         QMutexLocker locker(&m_mutex);
+        QList <Cue> cues(*m_cues.loadAcquire());
 
-        if (index >= 0 && index < m_cues.size())
+        if (index >= 0 && index < cues.size())
         {
-            m_cues.insert(index, cue);
+            cues.insert(index, cue);
+            publishCues(cues);
             cueAdded = true;
             emit added(index);
 
-            if (m_currentIndex >= index)
-            {
-                m_currentIndex++;
-                emit currentCueChanged(m_currentIndex);
-            }
+            if (shiftCurrentIndex(index, 1))
+                emit currentCueChanged(currentIndex());
         }
     }
 
@@ -195,10 +227,12 @@ void CueStack::replaceCue(int index, const Cue& cue)
     bool cueChanged = false;
     {
         QMutexLocker locker(&m_mutex);
+        QList <Cue> cues(*m_cues.loadAcquire());
 
-        if (index >= 0 && index < m_cues.size())
+        if (index >= 0 && index < cues.size())
         {
-           m_cues[index] = cue;
+           cues[index] = cue;
+           publishCues(cues);
            cueChanged = true;
         }
     }
@@ -218,16 +252,15 @@ void CueStack::removeCue(int index)
     qDebug() << Q_FUNC_INFO;
 
     QMutexLocker locker(&m_mutex);
-    if (index >= 0 && index < m_cues.size())
+    QList <Cue> cues(*m_cues.loadAcquire());
+    if (index >= 0 && index < cues.size())
     {
-        m_cues.removeAt(index);
+        cues.removeAt(index);
+        publishCues(cues);
         emit removed(index);
 
-        if (index < m_currentIndex)
-        {
-            m_currentIndex--;
-            emit currentCueChanged(m_currentIndex);
-        }
+        if (shiftCurrentIndex(index + 1, -1))
+            emit currentCueChanged(currentIndex());
     }
 }
 
@@ -244,27 +277,86 @@ void CueStack::removeCues(const QList <int>& indexes)
     it.toBack();
 
     QMutexLocker locker(&m_mutex);
+    QList <Cue> cues(*m_cues.loadAcquire());
+    QList <int> removedIndexes;
 
     while (it.hasPrevious() == true)
     {
         int index(it.previous());
-        if (index >= 0 && index < m_cues.size())
+        if (index >= 0 && index < cues.size())
         {
-            m_cues.removeAt(index);
-            emit removed(index);
-
-            if (index < m_currentIndex)
-            {
-                m_currentIndex--;
-                emit currentCueChanged(m_currentIndex);
-            }
+            cues.removeAt(index);
+            removedIndexes.append(index);
         }
     }
+
+    // publish a single new version for the whole removal
+    if (removedIndexes.isEmpty())
+        return;
+
+    publishCues(cues);
+
+    foreach (int index, removedIndexes)
+    {
+        emit removed(index);
+
+        if (shiftCurrentIndex(index + 1, -1))
+            emit currentCueChanged(currentIndex());
+    }
 }
 
 QList <Cue> CueStack::cues() const
 {
-    return m_cues;
+    QMutexLocker locker(&m_mutex);
+    return *m_cues.loadAcquire();
+}
+
+const QList <Cue> &CueStack::acquireCues()
+{
+    QList <Cue> *cues;
+
+    // announce the snapshot being read before using it, and check that
+    // it has not been replaced meanwhile, so that writers won't delete it
+    do
+    {
+        cues = m_cues.loadAcquire();
+        m_readerCues.fetchAndStoreOrdered(cues);
+    } while (cues != m_cues.loadAcquire());
+
+    return *cues;
+}
+
+void CueStack::publishCues(const QList <Cue> &cues)
+{
+    QList <Cue> *previous = m_cues.fetchAndStoreOrdered(new QList <Cue>(cues));
+    m_retiredCues.append(previous);
+
+    // delete the old snapshots, except the one the MasterTimer thread
+    // might still be reading
+    QList <Cue> *reading = m_readerCues.loadAcquire();
+    QMutableListIterator <QList <Cue> *> it(m_retiredCues);
+    while (it.hasNext() == true)
+    {
+        QList <Cue> *snapshot = it.next();
+        if (snapshot != reading)
+        {
+            delete snapshot;
+            it.remove();
+        }
+    }
+}
+
+bool CueStack::shiftCurrentIndex(int from, int offset)
+{
+    int index;
+    do
+    {
+        index = m_currentIndex.loadAcquire();
+        if (index < from)
+            return false;
+    } while (m_currentIndex.testAndSetOrdered(index, index + offset) == false);
+
+    return true;
 }
 
 void CueStack::setCurrentIndex(int index)
@@ -272,12 +364,12 @@ void CueStack::setCurrentIndex(int index)
     qDebug() << Q_FUNC_INFO;
 
     QMutexLocker locker(&m_mutex);
-    m_currentIndex = CLAMP(index, -1, m_cues.size() - 1);
+    m_currentIndex.storeRelease(CLAMP(index, -1, m_cues.loadAcquire()->size() - 1));
 }
 
 int CueStack::currentIndex() const
 {
-    return m_currentIndex;
+    return m_currentIndex.loadAcquire();
 }
 
 void CueStack::previousCue()
@@ -322,7 +414,10 @@ bool CueStack::loadXML(QXmlStreamReader &root)
 {
     qDebug() << Q_FUNC_INFO;
 
-    m_cues.clear();
+    {
+        QMutexLocker locker(&m_mutex);
+        publishCues(QList <Cue>());
+    }
 
     if (root.name() != KXMLQLCCueStack)
     {
@@ -422,7 +517,7 @@ qreal CueStack::intensity() const
 void CueStack::setFlashing(bool enable)
 {
     qDebug() << Q_FUNC_INFO;
-    if (m_flashing == enable || m_cues.isEmpty())
+    if (m_flashing == enable || cues().isEmpty())
         return;
 
     m_flashing = enable;
@@ -438,14 +533,15 @@ bool CueStack::isFlashing() const
 void CueStack::writeDMX(MasterTimer *timer, QList<Universe*> ua)
 {
     Q_UNUSED(timer);
-    if (m_cues.isEmpty())
+    const QList <Cue> &cues = acquireCues();
+    if (cues.isEmpty())
         return;
 
     if (isFlashing())
     {
         if (m_fadersMap.isEmpty())
         {
-            QHashIterator <uint,uchar> it(m_cues.first().values());
+            QHashIterator <uint,uchar> it(cues.first().values());
             while (it.hasNext() == true)
             {
                 it.next();
@@ -503,28 +599,29 @@ void CueStack::preRun()
 
 void CueStack::write(QList<Universe*> ua)
 {
-    if (m_cues.size() == 0 || isRunning() == false)
+    const QList <Cue> &cues = acquireCues();
+    if (cues.size() == 0 || isRunning() == false)
         return;
 
     if (m_previous == true)
     {
         // previousCue() was requested by user
         m_elapsed = 0;
-        int from = m_currentIndex;
-        int to = previous();
-        switchCue(from, to, ua);
+        int from = currentIndex();
+        int to = previous(cues);
+        switchCue(cues, from, to, ua);
         m_previous = false;
-        emit currentCueChanged(m_currentIndex);
+        emit currentCueChanged(to);
     }
     else if (m_next == true)
     {
         // nextCue() was requested by user
         m_elapsed = 0;
-        int from = m_currentIndex;
-        int to = next();
-        switchCue(from, to, ua);
+        int from = currentIndex();
+        int to = next(cues);
+        switchCue(cues, from, to, ua);
         m_next = false;
-        emit currentCueChanged(m_currentIndex);
+        emit currentCueChanged(to);
     }
 /*
     else if (m_elapsed >= duration())
@@ -572,26 +669,35 @@ void CueStack::postRun(MasterTimer* timer, QList<Universe *> ua)
 
     m_fadersMap.clear();
 
-    m_currentIndex = -1;
+    m_currentIndex.storeRelease(-1);
 
-    emit currentCueChanged(m_currentIndex);
+    emit currentCueChanged(-1);
     emit stopped();
 }
 
 int CueStack::previous()
+{
+    return previous(acquireCues());
+}
+
+int CueStack::previous(const QList <Cue> &cues)
 {
     qDebug() << Q_FUNC_INFO;
 
-    if (m_cues.size() == 0)
+    if (cues.size() == 0)
         return -1;
 
-    QMutexLocker locker(&m_mutex);
-
-    m_currentIndex--;
-    if (m_currentIndex < 0)
-        m_currentIndex = m_cues.size() - 1;
+    int index;
+    int previous;
+    do
+    {
+        index = m_currentIndex.loadAcquire();
+        previous = index - 1;
+        if (previous < 0 || previous >= cues.size())
+            previous = cues.size() - 1;
+    } while (m_currentIndex.testAndSetOrdered(index, previous) == false);
 
-    return m_currentIndex;
+    return previous;
 }
 
 FadeChannel *CueStack::getFader(QList<Universe *> universes, quint32 universeID, quint32 fixtureID, quint32 channel)
@@ -618,35 +724,46 @@ void CueStack::updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime)
 }
 
 int CueStack::next()
+{
+    return next(acquireCues());
+}
+
+int CueStack::next(const QList <Cue> &cues)
 {
     qDebug() << Q_FUNC_INFO;
 
-    if (m_cues.size() == 0)
+    if (cues.size() == 0)
         return -1;
 
-    QMutexLocker locker(&m_mutex);
-    m_currentIndex++;
-    if (m_currentIndex >= m_cues.size())
-        m_currentIndex = 0;
+    int index;
+    int next;
+    do
+    {
+        index = m_currentIndex.loadAcquire();
+        next = index + 1;
+        if (next < 0 || next >= cues.size())
+            next = 0;
+    } while (m_currentIndex.testAndSetOrdered(index, next) == false);
 
-    return m_currentIndex;
+    return next;
 }
 
 void CueStack::switchCue(int from, int to, const QList<Universe *> ua)
+{
+    switchCue(acquireCues(), from, to, ua);
+}
+
+void CueStack::switchCue(const QList <Cue> &cues, int from, int to, const QList<Universe *> ua)
 {
     qDebug() << Q_FUNC_INFO;
 
     Cue newCue;
     Cue oldCue;
 
-    {
-        QMutexLocker locker(&m_mutex);
-
-        if (to >= 0 && to < m_cues.size())
-            newCue = m_cues[to];
-        if (from >= 0 && from < m_cues.size())
-            oldCue = m_cues[from];
-    }
+    if (to >= 0 && to < cues.size())
+        newCue = cues[to];
+    if (from >= 0 && from < cues.size())
+        oldCue = cues[from];
 
     // Fade out the HTP channels of the previous cue
     QHashIterator <uint,uchar> oldit(oldCue.values());
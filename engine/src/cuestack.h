@@ -21,6 +21,8 @@
 #ifndef CUESTACK_H
 #define CUESTACK_H
 
+#include <QAtomicPointer>
+#include <QAtomicInt>
 #include <QObject>
 #include <QMutex>
 #include <QList>
@@ -187,8 +189,33 @@ signals:
     void changed(int index);
 
 private:
-    QList <Cue> m_cues;
-    QMutex m_mutex;
+    /** Get the current cue list from the MasterTimer thread, without
+     *  locking. The returned list stays valid until the next call */
+    const QList <Cue> &acquireCues();
+
+    /** Replace the cue list with a copy of $cues.
+     *  Must be called with m_mutex locked */
+    void publishCues(const QList <Cue> &cues);
+
+    /** Move m_currentIndex by $offset, if it is not lower than $from
+     *
+     *  @return true if the current index has been changed */
+    bool shiftCurrentIndex(int from, int offset);
+
+private:
+    /** The current cue list. It is never modified once published:
+     *  editing a cue publishes a new list, so that the MasterTimer
+     *  thread can read it without contending with the editors */
+    QAtomicPointer <QList <Cue> > m_cues;
+
+    /** The cue list the MasterTimer thread is reading */
+    QAtomicPointer <QList <Cue> > m_readerCues;
+
+    /** Replaced cue lists, deleted once no longer read */
+    QList <QList <Cue> *> m_retiredCues;
+
+    /** Serializes the cue list editors */
+    mutable QMutex m_mutex;
 
     /************************************************************************
      * Load & Save
@@ -223,7 +250,7 @@ signals:
 private:
     bool m_running;
     qreal m_intensity;
-    int m_currentIndex;
+    QAtomicInt m_currentIndex;
 
     /************************************************************************
      * Flashing
@@ -249,10 +276,13 @@ public:
 
 private:
     int next();
+    int next(const QList <Cue> &cues);
     int previous();
+    int previous(const QList <Cue> &cues);
     FadeChannel *getFader(QList<Universe *> universes, quint32 universeID, quint32 fixtureID, quint32 channel);
     void updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime);
     void switchCue(int from, int to, const QList<Universe *> ua);
+    void switchCue(const QList <Cue> &cues, int from, int to, const QList<Universe *> ua);
 
 private:
     /** Map used to lookup a GenericFader instance for a Universe ID */
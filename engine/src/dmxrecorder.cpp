@@ -0,0 +1,193 @@
+/*
+  Q Light Controller Plus
+  dmxrecorder.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QTimer>
+#include <QDebug>
+
+#include "dmxrecordingfile.h"
+#include "inputoutputmap.h"
+#include "dmxrecorder.h"
+#include "universe.h"
+#include "doc.h"
+
+#define FLUSH_INTERVAL 1000
+
+DMXRecorder::DMXRecorder(Doc *doc, QObject *parent)
+    : QObject(parent)
+    , m_doc(doc)
+    , m_flushTimer(new QTimer(this))
+    , m_virtualTime(-1)
+{
+    Q_ASSERT(doc != NULL);
+
+    m_flushTimer->setInterval(FLUSH_INTERVAL);
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(slotFlush()));
+}
+
+DMXRecorder::~DMXRecorder()
+{
+    stop();
+}
+
+bool DMXRecorder::start(const QString &fileName, const QList<quint32> &universes)
+{
+    stop();
+
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to create" << fileName;
+        return false;
+    }
+
+    m_file.write(DMXRecordingFile::header());
+
+    InputOutputMap *ioMap = m_doc->inputOutputMap();
+
+    QMutexLocker locker(&m_mutex);
+    m_time.start();
+
+    /* Start from the current state of the universes, since frames
+       arrive only when something changes */
+    foreach (quint32 id, universes)
+    {
+        Universe *universe = ioMap->universe(id);
+        if (universe == NULL)
+            continue;
+
+        QByteArray values = *universe->postGMValues();
+        DMXRecordingFile::appendKeyFrame(m_pending, 0, quint16(id), values);
+        m_frames[id] = values;
+        m_keyFrameTimes[id] = 0;
+        m_universes.append(id);
+
+        connect(universe, SIGNAL(universeWritten(quint32,QByteArray)),
+                this, SLOT(slotUniverseWritten(quint32,QByteArray)), Qt::DirectConnection);
+    }
+    locker.unlock();
+
+    m_flushTimer->start();
+    emit recordingChanged(true);
+
+    return true;
+}
+
+void DMXRecorder::stop()
+{
+    if (m_file.isOpen() == false)
+        return;
+
+    InputOutputMap *ioMap = m_doc->inputOutputMap();
+    foreach (quint32 id, m_universes)
+    {
+        Universe *universe = ioMap->universe(id);
+        if (universe != NULL)
+            disconnect(universe, SIGNAL(universeWritten(quint32,QByteArray)),
+                       this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+    }
+
+    m_flushTimer->stop();
+    slotFlush();
+    m_file.close();
+
+    QMutexLocker locker(&m_mutex);
+    m_pending.clear();
+    m_universes.clear();
+    m_frames.clear();
+    m_keyFrameTimes.clear();
+    locker.unlock();
+
+    emit recordingChanged(false);
+}
+
+bool DMXRecorder::isRecording() const
+{
+    return m_file.isOpen();
+}
+
+QString DMXRecorder::fileName() const
+{
+    return m_file.fileName();
+}
+
+quint32 DMXRecorder::elapsed() const
+{
+    if (isRecording() == false)
+        return 0;
+
+    return currentTime();
+}
+
+void DMXRecorder::setVirtualTime(int time)
+{
+    m_virtualTime.storeRelease(time);
+}
+
+quint32 DMXRecorder::currentTime() const
+{
+    int time = m_virtualTime.loadAcquire();
+    if (time >= 0)
+        return quint32(time);
+
+    return quint32(m_time.elapsed());
+}
+
+void DMXRecorder::slotUniverseWritten(quint32 universe, const QByteArray &values)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<quint32, QByteArray>::iterator frame = m_frames.find(universe);
+    if (frame == m_frames.end())
+        return;
+
+    quint32 time = currentTime();
+
+    if (time - m_keyFrameTimes.value(universe) >= DMXRECORDING_KEYFRAME_INTERVAL)
+    {
+        if (values == frame.value())
+            return;
+
+        DMXRecordingFile::appendKeyFrame(m_pending, time, quint16(universe), values);
+        m_keyFrameTimes[universe] = time;
+    }
+    else if (DMXRecordingFile::appendDelta(m_pending, time, quint16(universe),
+                                           frame.value(), values) == false)
+    {
+        return;
+    }
+
+    frame.value() = values;
+}
+
+void DMXRecorder::slotFlush()
+{
+    QByteArray data;
+
+    m_mutex.lock();
+    data.swap(m_pending);
+    m_mutex.unlock();
+
+    if (data.isEmpty() || m_file.isOpen() == false)
+        return;
+
+    if (m_file.write(data) != data.size())
+        qWarning() << Q_FUNC_INFO << "Error writing" << m_file.fileName();
+    m_file.flush();
+}
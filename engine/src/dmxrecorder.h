@@ -0,0 +1,124 @@
+/*
+  Q Light Controller Plus
+  dmxrecorder.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DMXRECORDER_H
+#define DMXRECORDER_H
+
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QFile>
+
+class QTimer;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * DMXRecorder records the output of a set of universes into a file, to be
+ * played back by a DMXRecording function. See DMXRecordingFile for the
+ * file format.
+ *
+ * Each time a universe publishes a changed frame, the recorder stores the
+ * time and the channels changed since its previous frame, with a full key
+ * frame from time to time to allow seeking. Frames are received on the
+ * universe processing threads, so they are stamped exactly when rendered,
+ * and collected in memory: the file is written once a second from the
+ * recorder thread, never from the engine threads.
+ *
+ * To record an external console, patch its input with passthrough to the
+ * recorded universes.
+ */
+class DMXRecorder : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(DMXRecorder)
+
+public:
+    DMXRecorder(Doc *doc, QObject *parent = NULL);
+    ~DMXRecorder();
+
+    /**
+     * Start recording the universes with the given IDs into a new file
+     * with the given name. A recording in progress is stopped first.
+     */
+    bool start(const QString& fileName, const QList<quint32>& universes);
+
+    /** Stop the recording and close its file */
+    void stop();
+
+    /** Return true if a recording is in progress */
+    bool isRecording() const;
+
+    /** Get the name of the file of the current or last recording */
+    QString fileName() const;
+
+    /** Get the time elapsed since the recording started, in milliseconds */
+    quint32 elapsed() const;
+
+    /**
+     * Stamp the frames with the given time, in milliseconds since the
+     * recording started, instead of the wall clock. Used by offline
+     * renders, that run faster than real time. A negative time goes back
+     * to the wall clock.
+     */
+    void setVirtualTime(int time);
+
+signals:
+    void recordingChanged(bool recording);
+
+public slots:
+    /** Write the records collected so far to the file */
+    void slotFlush();
+
+private slots:
+    /** Store a universe frame. Called by the universe processing threads */
+    void slotUniverseWritten(quint32 universe, const QByteArray& values);
+
+private:
+    /** Get the time of a frame received now */
+    quint32 currentTime() const;
+
+private:
+    Doc *m_doc;
+    QFile m_file;
+    QTimer *m_flushTimer;
+    QElapsedTimer m_time;
+    QAtomicInt m_virtualTime;
+    QList<quint32> m_universes;
+
+    /** Protects the pending records and the frames below */
+    QMutex m_mutex;
+    QByteArray m_pending;
+
+    /** The last recorded frame of each universe */
+    QHash<quint32, QByteArray> m_frames;
+
+    /** Time of the last key frame of each universe */
+    QHash<quint32, quint32> m_keyFrameTimes;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,358 @@
+/*
+  Q Light Controller Plus
+  dmxrecording.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QFileInfo>
+#include <QDebug>
+
+#include "genericfader.h"
+#include "dmxrecording.h"
+#include "fadechannel.h"
+#include "mastertimer.h"
+#include "universe.h"
+#include "fixture.h"
+#include "doc.h"
+
+#define KXMLQLCDMXRecordingSource "Source"
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+DMXRecording::DMXRecording(Doc* doc)
+    : Function(doc, Function::DMXRecordingType)
+    , m_position(0)
+    , m_seekPending(false)
+{
+    setName(tr("New DMX Recording"));
+    setRunOrder(SingleShot);
+
+    registerAttribute(tr("Speed"), Function::LastWins, 0.0, 8.0, 1.0);
+}
+
+DMXRecording::~DMXRecording()
+{
+}
+
+QIcon DMXRecording::getIcon() const
+{
+    return QIcon(":/record.png");
+}
+
+quint32 DMXRecording::totalDuration()
+{
+    return m_recording.duration();
+}
+
+/*****************************************************************************
+ * Copying
+ *****************************************************************************/
+
+Function* DMXRecording::createCopy(Doc* doc, bool addToDoc)
+{
+    Q_ASSERT(doc != NULL);
+
+    Function* copy = new DMXRecording(doc);
+    if (copy->copyFrom(this) == false)
+    {
+        delete copy;
+        copy = NULL;
+    }
+    if (addToDoc == true && doc->addFunction(copy) == false)
+    {
+        delete copy;
+        copy = NULL;
+    }
+
+    return copy;
+}
+
+bool DMXRecording::copyFrom(const Function* function)
+{
+    const DMXRecording* recording = qobject_cast<const DMXRecording*> (function);
+    if (recording == NULL)
+        return false;
+
+    setSourceFileName(recording->m_sourceFileName);
+
+    return Function::copyFrom(function);
+}
+
+/*****************************************************************************
+ * Source file
+ *****************************************************************************/
+
+bool DMXRecording::setSourceFileName(const QString &fileName)
+{
+    if (isRunning())
+        return false;
+
+    m_sourceFileName = fileName;
+    m_frames.clear();
+
+    bool ok = m_recording.open(fileName);
+    if (ok == false)
+        doc()->appendToErrorLog(tr("DMX recording <b>%1</b> not found or damaged").arg(fileName));
+
+    emit sourceFileNameChanged();
+    emit totalDurationChanged();
+    emit changed(id());
+
+    return ok;
+}
+
+QString DMXRecording::sourceFileName() const
+{
+    return m_sourceFileName;
+}
+
+/*****************************************************************************
+ * Load & Save
+ *****************************************************************************/
+
+bool DMXRecording::saveXML(QXmlStreamWriter *doc)
+{
+    Q_ASSERT(doc != NULL);
+
+    /* Function tag */
+    doc->writeStartElement(KXMLQLCFunction);
+
+    /* Common attributes */
+    saveXMLCommon(doc);
+
+    /* Speed */
+    saveXMLSpeed(doc);
+
+    /* Playback mode */
+    saveXMLRunOrder(doc);
+
+    doc->writeTextElement(KXMLQLCDMXRecordingSource, this->doc()->normalizeComponentPath(m_sourceFileName));
+
+    /* End the <Function> tag */
+    doc->writeEndElement();
+
+    return true;
+}
+
+bool DMXRecording::loadXML(QXmlStreamReader &root)
+{
+    if (root.name() != KXMLQLCFunction)
+    {
+        qWarning() << Q_FUNC_INFO << "Function node not found";
+        return false;
+    }
+
+    if (root.attributes().value(KXMLQLCFunctionType).toString() != typeToString(Function::DMXRecordingType))
+    {
+        qWarning() << Q_FUNC_INFO << root.attributes().value(KXMLQLCFunctionType).toString()
+                   << "is not a DMX recording";
+        return false;
+    }
+
+    while (root.readNextStartElement())
+    {
+        if (root.name() == KXMLQLCDMXRecordingSource)
+        {
+            setSourceFileName(doc()->denormalizeComponentPath(root.readElementText()));
+        }
+        else if (root.name() == KXMLQLCFunctionSpeed)
+        {
+            loadXMLSpeed(root);
+        }
+        else if (root.name() == KXMLQLCFunctionRunOrder)
+        {
+            loadXMLRunOrder(root);
+        }
+        else
+        {
+            qWarning() << Q_FUNC_INFO << "Unknown DMX recording tag:" << root.name();
+            root.skipCurrentElement();
+        }
+    }
+
+    return true;
+}
+
+/*****************************************************************************
+ * Running
+ *****************************************************************************/
+
+void DMXRecording::preRun(MasterTimer* timer)
+{
+    if (m_recording.isOpen() == false)
+    {
+        stop(FunctionParent::master());
+        return;
+    }
+
+    /* A start time seeks the recording. The seek happens at the first
+       write(), which has the universes to write the recorded values to */
+    m_position = elapsed();
+    m_seekPending = true;
+
+    Function::preRun(timer);
+}
+
+void DMXRecording::write(MasterTimer* timer, QList<Universe*> universes)
+{
+    Q_UNUSED(timer)
+
+    if (isPaused())
+        return;
+
+    if (m_seekPending)
+    {
+        m_recording.seek(quint32(m_position), m_frames);
+
+        QHashIterator<quint32, QByteArray> it(m_frames);
+        while (it.hasNext())
+        {
+            it.next();
+            writeFrame(universes, it.key(), it.value(), QByteArray());
+        }
+        m_seekPending = false;
+    }
+
+    incrementElapsed();
+    m_position += qreal(MasterTimer::tick()) * getAttributeValue(Speed);
+
+    DMXRecordingFile::Record record;
+    while (m_recording.readNext(quint32(m_position), record))
+    {
+        // deltas need the key frame they are based on
+        if (record.type != DMXRecordingFile::KeyFrame && m_frames.contains(record.universe) == false)
+            continue;
+
+        QByteArray &frame = m_frames[record.universe];
+        QByteArray previous = frame;
+        DMXRecordingFile::apply(record, frame);
+        writeFrame(universes, record.universe, frame, previous);
+    }
+
+    if (m_position >= m_recording.duration())
+    {
+        if (runOrder() == Loop)
+        {
+            m_position = 0;
+            m_seekPending = true;
+        }
+        else
+        {
+            stop(FunctionParent::master());
+        }
+    }
+}
+
+void DMXRecording::postRun(MasterTimer* timer, QList<Universe*> universes)
+{
+    uint fadeout = overrideFadeOutSpeed() == defaultSpeed() ? fadeOutSpeed() : overrideFadeOutSpeed();
+
+    if (fadeout == 0)
+    {
+        dismissAllFaders();
+    }
+    else
+    {
+        if (tempoType() == Beats)
+            fadeout = beatsToTime(fadeout, timer->beatTimeDuration());
+
+        foreach (QSharedPointer<GenericFader> fader, m_fadersMap.values())
+        {
+            if (!fader.isNull())
+                fader->setFadeOut(true, fadeout);
+        }
+    }
+
+    m_fadersMap.clear();
+    m_frames.clear();
+
+    Function::postRun(timer, universes);
+}
+
+int DMXRecording::adjustAttribute(qreal fraction, int attributeId)
+{
+    int attrIndex = Function::adjustAttribute(fraction, attributeId);
+
+    if (attrIndex == Intensity)
+    {
+        foreach (QSharedPointer<GenericFader> fader, m_fadersMap.values())
+        {
+            if (!fader.isNull())
+                fader->adjustIntensity(getAttributeValue(Function::Intensity));
+        }
+    }
+
+    return attrIndex;
+}
+
+void DMXRecording::setBlendMode(Universe::BlendMode mode)
+{
+    if (mode == blendMode())
+        return;
+
+    foreach (QSharedPointer<GenericFader> fader, m_fadersMap.values())
+    {
+        if (!fader.isNull())
+            fader->setBlendMode(mode);
+    }
+
+    Function::setBlendMode(mode);
+    emit changed(id());
+}
+
+FadeChannel *DMXRecording::getFader(QList<Universe *> universes, quint32 universeID, quint32 channel)
+{
+    // get the universe Fader first. If doesn't exist, create it
+    QSharedPointer<GenericFader> fader = m_fadersMap.value(universeID, QSharedPointer<GenericFader>());
+    if (fader.isNull())
+    {
+        fader = universes[universeID]->requestFader();
+        fader->adjustIntensity(getAttributeValue(Intensity));
+        fader->setBlendMode(blendMode());
+        fader->setName(name());
+        fader->setParentFunctionID(id());
+        m_fadersMap[universeID] = fader;
+    }
+
+    return fader->getChannelFader(doc(), universes[universeID], Fixture::invalidId(),
+                                  (universeID * UNIVERSE_SIZE) + channel);
+}
+
+void DMXRecording::writeFrame(QList<Universe *> universes, quint32 universeID,
+                              const QByteArray &frame, const QByteArray &previous)
+{
+    if (universeID >= quint32(universes.count()))
+        return;
+
+    for (int i = 0; i < frame.size() && i < UNIVERSE_SIZE; i++)
+    {
+        uchar value = uchar(frame.at(i));
+        if (i < previous.size() && uchar(previous.at(i)) == value)
+            continue;
+
+        FadeChannel *fc = getFader(universes, universeID, quint32(i));
+        fc->setStart(value);
+        fc->setTarget(value);
+        fc->setCurrent(value);
+        fc->setElapsed(0);
+        fc->setFadeTime(0);
+        fc->setReady(false);
+    }
+}
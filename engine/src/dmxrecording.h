@@ -0,0 +1,151 @@
+/*
+  Q Light Controller Plus
+  dmxrecording.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DMXRECORDING_H
+#define DMXRECORDING_H
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+
+#include "dmxrecordingfile.h"
+#include "function.h"
+
+class GenericFader;
+class FadeChannel;
+class MasterTimer;
+class Universe;
+class Doc;
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+/**
+ * DMXRecording plays back a recording made by DMXRecorder.
+ *
+ * The recording file stays memory mapped while the function exists, and
+ * at each tick the function applies the records up to the current playback
+ * position, writing only the channels that changed. Starting the function
+ * with a start time seeks into the recording, and the Speed attribute sets
+ * the playback rate.
+ */
+class DMXRecording : public Function
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QString sourceFileName READ sourceFileName WRITE setSourceFileName NOTIFY sourceFileNameChanged)
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    DMXRecording(Doc* doc);
+    virtual ~DMXRecording();
+
+    /** @reimp */
+    QIcon getIcon() const;
+
+    /** @reimp */
+    quint32 totalDuration();
+
+    enum DMXRecordingAttr
+    {
+        Intensity = Function::Intensity,
+        Speed
+    };
+
+    /*********************************************************************
+     * Copying
+     *********************************************************************/
+public:
+    /** @reimp */
+    Function* createCopy(Doc* doc, bool addToDoc = true);
+
+    /** @reimp */
+    bool copyFrom(const Function* function);
+
+    /*********************************************************************
+     * Source file
+     *********************************************************************/
+public:
+    /** Set the recording file to play back */
+    bool setSourceFileName(const QString& fileName);
+
+    /** Get the recording file played back */
+    QString sourceFileName() const;
+
+signals:
+    void sourceFileNameChanged();
+
+private:
+    QString m_sourceFileName;
+    DMXRecordingFile m_recording;
+
+    /*********************************************************************
+     * Load & Save
+     *********************************************************************/
+public:
+    /** @reimp */
+    bool saveXML(QXmlStreamWriter *doc);
+
+    /** @reimp */
+    bool loadXML(QXmlStreamReader &root);
+
+    /*********************************************************************
+     * Running
+     *********************************************************************/
+public:
+    /** @reimp */
+    void preRun(MasterTimer* timer);
+
+    /** @reimp */
+    void write(MasterTimer* timer, QList<Universe*> universes);
+
+    /** @reimp */
+    void postRun(MasterTimer* timer, QList<Universe*> universes);
+
+    /** @reimp */
+    int adjustAttribute(qreal fraction, int attributeId);
+
+    /** @reimp */
+    void setBlendMode(Universe::BlendMode mode);
+
+private:
+    /** Get the fader of the given channel of a universe */
+    FadeChannel *getFader(QList<Universe*> universes, quint32 universeID, quint32 channel);
+
+    /** Write the channels of $frame that differ from $previous */
+    void writeFrame(QList<Universe*> universes, quint32 universeID,
+                    const QByteArray& frame, const QByteArray& previous);
+
+private:
+    /** The playback position in milliseconds, running at the Speed rate */
+    qreal m_position;
+
+    /** Set to seek the recording at the next write() */
+    bool m_seekPending;
+
+    /** The values of each universe at the playback position */
+    QHash<quint32, QByteArray> m_frames;
+};
+
+/** @} */
+
+#endif
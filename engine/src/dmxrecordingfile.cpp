@@ -0,0 +1,289 @@
+/*
+  Q Light Controller Plus
+  dmxrecordingfile.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtEndian>
+#include <QDebug>
+
+#include "dmxrecordingfile.h"
+
+#define RECORDING_MAGIC "QLCR"
+#define RECORDING_VERSION 1
+#define RECORDING_HEADER_SIZE 8
+#define RECORD_HEADER_SIZE 12
+#define DELTA_ENTRY_SIZE 3
+
+DMXRecordingFile::DMXRecordingFile()
+    : m_data(NULL)
+    , m_size(0)
+    , m_duration(0)
+    , m_cursor(RECORDING_HEADER_SIZE)
+{
+}
+
+DMXRecordingFile::~DMXRecordingFile()
+{
+    close();
+}
+
+bool DMXRecordingFile::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::ReadOnly) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to open" << fileName;
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_file.map(0, m_size);
+    if (m_data == NULL)
+    {
+        m_buffer = m_file.readAll();
+        m_data = (const uchar *)m_buffer.constData();
+    }
+
+    if (m_size < RECORDING_HEADER_SIZE ||
+        QByteArray::fromRawData((const char *)m_data, 4) != RECORDING_MAGIC ||
+        qFromLittleEndian<quint32>(m_data + 4) != RECORDING_VERSION)
+    {
+        qWarning() << Q_FUNC_INFO << fileName << "is not a DMX recording";
+        close();
+        return false;
+    }
+
+    /* Walk the record headers to index the key frames. A record
+       truncated by an interrupted recording ends the file */
+    qint64 offset = RECORDING_HEADER_SIZE;
+    Record record;
+    while (recordAt(offset, record))
+    {
+        if (record.type == KeyFrame)
+        {
+            KeyFrameIndex index;
+            index.time = record.time;
+            index.offset = offset;
+            m_keyFrames[record.universe].append(index);
+        }
+        m_duration = qMax(m_duration, record.time);
+        offset += RECORD_HEADER_SIZE + record.size;
+    }
+    m_size = offset;
+    m_cursor = RECORDING_HEADER_SIZE;
+
+    return true;
+}
+
+void DMXRecordingFile::close()
+{
+    if (m_file.isOpen())
+    {
+        if (m_buffer.isEmpty() && m_data != NULL)
+            m_file.unmap((uchar *)m_data);
+        m_file.close();
+    }
+
+    m_buffer.clear();
+    m_data = NULL;
+    m_size = 0;
+    m_duration = 0;
+    m_cursor = RECORDING_HEADER_SIZE;
+    m_keyFrames.clear();
+}
+
+bool DMXRecordingFile::isOpen() const
+{
+    return m_data != NULL;
+}
+
+quint32 DMXRecordingFile::duration() const
+{
+    return m_duration;
+}
+
+QList<quint32> DMXRecordingFile::universes() const
+{
+    return m_keyFrames.keys();
+}
+
+void DMXRecordingFile::seek(quint32 time, QHash<quint32, QByteArray> &frames)
+{
+    frames.clear();
+
+    /* Start from the last key frame of each universe before $time */
+    QHash<quint32, qint64> startOffsets;
+    qint64 offset = -1;
+
+    QHashIterator<quint32, QVector<KeyFrameIndex> > it(m_keyFrames);
+    while (it.hasNext())
+    {
+        it.next();
+        const QVector<KeyFrameIndex> &keyFrames = it.value();
+
+        int low = 0, high = keyFrames.count();
+        while (low < high)
+        {
+            int mid = (low + high) / 2;
+            if (keyFrames.at(mid).time <= time)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        // the universe starts after $time
+        if (low == 0)
+            continue;
+
+        qint64 keyOffset = keyFrames.at(low - 1).offset;
+        startOffsets[it.key()] = keyOffset;
+        if (offset == -1 || keyOffset < offset)
+            offset = keyOffset;
+    }
+
+    if (offset == -1)
+    {
+        m_cursor = RECORDING_HEADER_SIZE;
+        return;
+    }
+
+    m_cursor = offset;
+
+    Record record;
+    while (readNext(time, record))
+    {
+        QHash<quint32, qint64>::const_iterator start = startOffsets.constFind(record.universe);
+        if (start == startOffsets.constEnd() ||
+            (const uchar *)record.data - m_data - RECORD_HEADER_SIZE < start.value())
+                continue;
+
+        apply(record, frames[record.universe]);
+    }
+}
+
+bool DMXRecordingFile::readNext(quint32 time, Record &record)
+{
+    if (recordAt(m_cursor, record) == false || record.time > time)
+        return false;
+
+    m_cursor += RECORD_HEADER_SIZE + record.size;
+    return true;
+}
+
+void DMXRecordingFile::apply(const Record &record, QByteArray &frame)
+{
+    if (record.type == KeyFrame)
+    {
+        frame = QByteArray((const char *)record.data, int(record.size));
+        return;
+    }
+
+    uchar *values = (uchar *)frame.data();
+    const uchar *entry = record.data;
+    const uchar *end = record.data + record.size;
+    for (; entry + DELTA_ENTRY_SIZE <= end; entry += DELTA_ENTRY_SIZE)
+    {
+        quint16 channel = qFromLittleEndian<quint16>(entry);
+        if (channel < frame.size())
+            values[channel] = entry[2];
+    }
+}
+
+bool DMXRecordingFile::recordAt(qint64 offset, Record &record) const
+{
+    if (m_data == NULL || offset + RECORD_HEADER_SIZE > m_size)
+        return false;
+
+    const uchar *header = m_data + offset;
+    record.time = qFromLittleEndian<quint32>(header);
+    record.universe = qFromLittleEndian<quint16>(header + 4);
+    record.type = qFromLittleEndian<quint16>(header + 6);
+    record.size = qFromLittleEndian<quint32>(header + 8);
+    record.data = header + RECORD_HEADER_SIZE;
+
+    return offset + RECORD_HEADER_SIZE + record.size <= m_size;
+}
+
+/*****************************************************************************
+ * Writing
+ *****************************************************************************/
+
+QByteArray DMXRecordingFile::header()
+{
+    QByteArray data(RECORDING_MAGIC);
+    uchar version[4];
+    qToLittleEndian<quint32>(RECORDING_VERSION, version);
+    data.append((const char *)version, 4);
+    return data;
+}
+
+static void appendRecordHeader(QByteArray &out, quint32 time, quint16 universe,
+                               quint16 type, quint32 size)
+{
+    uchar header[RECORD_HEADER_SIZE];
+    qToLittleEndian<quint32>(time, header);
+    qToLittleEndian<quint16>(universe, header + 4);
+    qToLittleEndian<quint16>(type, header + 6);
+    qToLittleEndian<quint32>(size, header + 8);
+    out.append((const char *)header, RECORD_HEADER_SIZE);
+}
+
+void DMXRecordingFile::appendKeyFrame(QByteArray &out, quint32 time, quint16 universe,
+                                      const QByteArray &values)
+{
+    appendRecordHeader(out, time, universe, KeyFrame, quint32(values.size()));
+    out.append(values);
+}
+
+bool DMXRecordingFile::appendDelta(QByteArray &out, quint32 time, quint16 universe,
+                                   const QByteArray &previous, const QByteArray &values)
+{
+    if (previous.size() != values.size())
+    {
+        appendKeyFrame(out, time, universe, values);
+        return true;
+    }
+
+    QByteArray entries;
+    const char *prev = previous.constData();
+    const char *curr = values.constData();
+    for (int i = 0; i < values.size(); i++)
+    {
+        if (prev[i] == curr[i])
+            continue;
+
+        uchar entry[DELTA_ENTRY_SIZE];
+        qToLittleEndian<quint16>(quint16(i), entry);
+        entry[2] = uchar(curr[i]);
+        entries.append((const char *)entry, DELTA_ENTRY_SIZE);
+    }
+
+    if (entries.isEmpty())
+        return false;
+
+    if (entries.size() >= values.size())
+    {
+        appendKeyFrame(out, time, universe, values);
+        return true;
+    }
+
+    appendRecordHeader(out, time, universe, Delta, quint32(entries.size()));
+    out.append(entries);
+    return true;
+}
@@ -0,0 +1,156 @@
+/*
+  Q Light Controller Plus
+  dmxrecordingfile.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DMXRECORDINGFILE_H
+#define DMXRECORDINGFILE_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QHash>
+#include <QFile>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+#define KExtDMXRecording ".qxr" // 'Q'LC+ 'X' 'R'ecording
+
+/** A universe gets a key frame at least this often, in milliseconds */
+#define DMXRECORDING_KEYFRAME_INTERVAL 1000
+
+/**
+ * DMXRecordingFile reads the DMX recordings written by DMXRecorder.
+ *
+ * A recording is an append-only sequence of records, after a short header.
+ * Each record holds the values of one universe at a time, in milliseconds
+ * from the start of the recording, either as a key frame with all the
+ * universe values or as a delta with only the channels changed since the
+ * previous record of the same universe. All the numbers are little endian.
+ *
+ * The file is memory mapped, so playing it back costs no parsing: when the
+ * file is opened only the record headers are walked, to find its duration
+ * and the key frames used to seek.
+ */
+class DMXRecordingFile
+{
+public:
+    enum RecordType
+    {
+        KeyFrame = 0,
+        Delta = 1
+    };
+
+    /** A record, pointing into the mapped file */
+    struct Record
+    {
+        quint32 time;
+        quint16 universe;
+        quint16 type;
+        quint32 size;
+        const uchar *data;
+    };
+
+    DMXRecordingFile();
+    ~DMXRecordingFile();
+
+    /** Open the recording with the given file name */
+    bool open(const QString& fileName);
+
+    /** Close the recording */
+    void close();
+
+    /** Return true if a recording is open */
+    bool isOpen() const;
+
+    /** Get the duration of the open recording, in milliseconds */
+    quint32 duration() const;
+
+    /** Get the IDs of the universes in the open recording */
+    QList<quint32> universes() const;
+
+    /**
+     * Move to the given $time of the recording and fill $frames with the
+     * values of each universe at that time. The following calls to
+     * readNext() return the records after $time.
+     */
+    void seek(quint32 time, QHash<quint32, QByteArray>& frames);
+
+    /**
+     * Read the next record, if its time is not after $time.
+     *
+     * @return false if the next record is after $time, or at the end
+     */
+    bool readNext(quint32 time, Record& record);
+
+    /** Apply the values of $record to $frame */
+    static void apply(const Record& record, QByteArray& frame);
+
+    /*********************************************************************
+     * Writing
+     *********************************************************************/
+public:
+    /** Get the header to write at the beginning of a new recording */
+    static QByteArray header();
+
+    /** Append to $out a key frame record with all the given $values */
+    static void appendKeyFrame(QByteArray& out, quint32 time, quint16 universe,
+                               const QByteArray& values);
+
+    /**
+     * Append to $out a delta record with the channels that changed from
+     * $previous to $values. When most channels changed, a key frame is
+     * appended instead, which is smaller.
+     *
+     * @return false if no channel changed and nothing was appended
+     */
+    static bool appendDelta(QByteArray& out, quint32 time, quint16 universe,
+                            const QByteArray& previous, const QByteArray& values);
+
+private:
+    /** Read the record at $offset. Return false if it is incomplete */
+    bool recordAt(qint64 offset, Record& record) const;
+
+private:
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+
+    /** Data read in memory when the file cannot be mapped */
+    QByteArray m_buffer;
+
+    quint32 m_duration;
+
+    /** Position of the next record returned by readNext() */
+    qint64 m_cursor;
+
+    /** Time and offset of a key frame */
+    struct KeyFrameIndex
+    {
+        quint32 time;
+        qint64 offset;
+    };
+
+    /** The key frames of each universe, sorted by time */
+    QHash<quint32, QVector<KeyFrameIndex> > m_keyFrames;
+};
+
+/** @} */
+
+#endif
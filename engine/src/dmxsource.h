@@ -20,6 +20,9 @@
 #ifndef DMXSOURCE_H
 #define DMXSOURCE_H
 
+#include <QAtomicInt>
+#include <QList>
+
 class MasterTimer;
 class Universe;
 
@@ -35,7 +38,7 @@ class Universe;
 class DMXSource
 {
 public:
-    DMXSource() { m_changed = false; }
+    DMXSource() : m_changed(0) { }
     virtual ~DMXSource() {}
 
     /**
@@ -46,12 +49,27 @@ public:
      */
     virtual void writeDMX(MasterTimer* timer, QList<Universe*> universes) = 0;
 
-    /** Get/Set if the DMX source has changed */
-    bool hasChanged() { return m_changed; }
-    void setChanged(bool changed) { m_changed = changed; }
+    /** Get/Set if the DMX source has changed. Safe to call from any thread */
+    bool hasChanged() { return m_changed.loadAcquire() != 0; }
+    void setChanged(bool changed) { m_changed.storeRelease(changed ? 1 : 0); }
+
+    /**
+     * Return true if writeDMX() has something to do only after a
+     * setChanged(true). MasterTimer then skips the source on the ticks
+     * where it is unchanged, and clears the flag before calling writeDMX(),
+     * so that a change made meanwhile is written at the next tick.
+     * A source that needs more ticks can call setChanged(true) again.
+     *
+     * Sources with work to do on every tick keep the default, and are
+     * called on every tick regardless of hasChanged().
+     */
+    virtual bool writeOnChangeOnly() const { return false; }
+
+    /** Clear the changed flag, returning its previous state */
+    bool takeChanged() { return m_changed.fetchAndStoreOrdered(0) != 0; }
 
-protected:
-    bool m_changed;
+private:
+    QAtomicInt m_changed;
 };
 
 /** @} */
@@ -21,6 +21,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QStringList>
+#include <QIODevice>
 #include <QString>
 #include <QDebug>
 #include <QList>
@@ -29,6 +30,11 @@
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
 #include <QRandomGenerator>
 #endif
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QtConcurrent>
+#else
+#include <QtCore>
+#endif
 
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
@@ -39,7 +45,10 @@
 #include "rgbscriptscache.h"
 #include "channelsgroup.h"
 #include "scriptwrapper.h"
+#include "workspacecache.h"
+#include "loadgovernor.h"
 #include "collection.h"
+#include "dmxrecorder.h"
 #include "function.h"
 #include "universe.h"
 #include "sequence.h"
@@ -73,6 +82,8 @@ Doc::Doc(QObject* parent, int universes)
     , m_audioPluginCache(new AudioPluginCache(this))
     , m_masterTimer(new MasterTimer(this))
     , m_ioMap(new InputOutputMap(this, universes))
+    , m_loadGovernor(new LoadGovernor(m_masterTimer))
+    , m_dmxRecorder(NULL)
     , m_monitorProps(NULL)
     , m_mode(Design)
     , m_kiosk(false)
@@ -80,11 +91,17 @@ Doc::Doc(QObject* parent, int universes)
     , m_clipboard(new QLCClipboard(this))
     , m_fixturesListCacheUpToDate(false)
     , m_latestFixtureId(0)
+    , m_fixturesRevision(0)
+    , m_fixtureGroupsListCacheUpToDate(false)
     , m_latestFixtureGroupId(0)
+    , m_channelsGroupsListCacheUpToDate(false)
     , m_latestChannelsGroupId(0)
+    , m_palettesListCacheUpToDate(false)
     , m_latestPaletteId(0)
+    , m_functionsListCacheUpToDate(false)
     , m_latestFunctionId(0)
     , m_startupFunctionId(Function::invalidId())
+    , m_workspaceCache(NULL)
 {
     Bus::init(this);
     resetModified();
@@ -96,6 +113,9 @@ Doc::Doc(QObject* parent, int universes)
 
 Doc::~Doc()
 {
+    delete m_loadGovernor;
+    m_loadGovernor = NULL;
+
     delete m_masterTimer;
     m_masterTimer = NULL;
 
@@ -106,6 +126,11 @@ Doc::~Doc()
         // TODO: is this still needed ??
         //m_ioMap->saveDefaults();
     }
+
+    // the recorder is connected to the universes
+    delete m_dmxRecorder;
+    m_dmxRecorder = NULL;
+
     delete m_ioMap;
     m_ioMap = NULL;
 
@@ -137,15 +162,23 @@ void Doc::clearContents()
         Function* func = m_functions.take(funcit.next());
         if (func == NULL)
             continue;
+        m_functionsByType[func->type()].remove(func->id());
+        m_functionsNameIndex.remove(func->id());
+        m_functionsListCacheUpToDate = false;
+        m_functionsByTypeListCache.remove(func->type());
         emit functionRemoved(func->id());
         delete func;
     }
+    m_functionsByType.clear();
+    m_functionsNameIndex.clear();
+    m_functionsByTypeListCache.clear();
 
     // Delete all palettes
     QListIterator <quint32> palIt(m_palettes.keys());
     while (palIt.hasNext() == true)
     {
         QLCPalette *palette = m_palettes.take(palIt.next());
+        m_palettesListCacheUpToDate = false;
         emit paletteRemoved(palette->id());
         delete palette;
     }
@@ -155,6 +188,8 @@ void Doc::clearContents()
     while (grpchans.hasNext() == true)
     {
         ChannelsGroup* grp = m_channelsGroups.take(grpchans.next());
+        m_orderedGroups.removeAll(grp->id());
+        m_channelsGroupsListCacheUpToDate = false;
         emit channelsGroupRemoved(grp->id());
         delete grp;
     }
@@ -164,6 +199,7 @@ void Doc::clearContents()
     while (grpit.hasNext() == true)
     {
         FixtureGroup* grp = m_fixtureGroups.take(grpit.next());
+        m_fixtureGroupsListCacheUpToDate = false;
         quint32 grpID = grp->id();
         delete grp;
         emit fixtureGroupRemoved(grpID);
@@ -179,6 +215,7 @@ void Doc::clearContents()
         emit fixtureRemoved(fxID);
     }
     m_fixturesListCacheUpToDate = false;
+    m_fixturesRevision.ref();
 
     m_orderedGroups.clear();
 
@@ -187,7 +224,8 @@ void Doc::clearContents()
     m_latestFixtureGroupId = 0;
     m_latestChannelsGroupId = 0;
     m_latestPaletteId = 0;
-    m_addresses.clear();
+    m_addressIndex.clear();
+    m_fixtureAddresses.clear();
     m_loadStatus = Cleared;
 
     emit cleared();
@@ -272,6 +310,11 @@ MasterTimer* Doc::masterTimer() const
     return m_masterTimer;
 }
 
+LoadGovernor *Doc::loadGovernor() const
+{
+    return m_loadGovernor;
+}
+
 QSharedPointer<AudioCapture> Doc::audioInputCapture()
 {
     if (!m_inputCapture)
@@ -303,6 +346,14 @@ void Doc::destroyAudioCapture()
     }
 }
 
+DMXRecorder *Doc::dmxRecorder()
+{
+    if (m_dmxRecorder == NULL)
+        m_dmxRecorder = new DMXRecorder(this, this);
+
+    return m_dmxRecorder;
+}
+
 /*****************************************************************************
  * Modified status
  *****************************************************************************/
@@ -418,14 +469,11 @@ bool Doc::addFixture(Fixture* fixture, quint32 id)
     }
 
     /* Check for overlapping address */
-    for (i = fixture->universeAddress();
-         i < fixture->universeAddress() + fixture->channels(); i++)
+    if (isAddressRangeAvailable(fixture->universeAddress(), fixture->channels()) == false)
     {
-        if (m_addresses.contains(i))
-        {
-            qWarning() << Q_FUNC_INFO << "fixture" << id << "overlapping with fixture" << m_addresses[i] << "@ channel" << i;
-            return false;
-        }
+        qWarning() << Q_FUNC_INFO << "fixture" << id << "overlapping with another fixture @ channel"
+                   << fixture->universeAddress();
+        return false;
     }
 
     fixture->setID(id);
@@ -437,11 +485,7 @@ bool Doc::addFixture(Fixture* fixture, quint32 id)
             this, SLOT(slotFixtureChanged(quint32)));
 
     /* Keep track of fixture addresses */
-    for (i = fixture->universeAddress();
-         i < fixture->universeAddress() + fixture->channels(); i++)
-    {
-        m_addresses[i] = id;
-    }
+    indexFixtureAddress(id, fixture->universeAddress(), fixture->channels());
 
     if (uni >= inputOutputMap()->universesCount())
     {
@@ -478,6 +522,7 @@ bool Doc::addFixture(Fixture* fixture, quint32 id)
     }
     inputOutputMap()->releaseUniverses(true);
 
+    m_fixturesRevision.ref();
     emit fixtureAdded(id);
     setModified();
 
@@ -493,16 +538,12 @@ bool Doc::deleteFixture(quint32 id)
         m_fixturesListCacheUpToDate = false;
 
         /* Keep track of fixture addresses */
-        QMutableHashIterator <uint,uint> it(m_addresses);
-        while (it.hasNext() == true)
-        {
-            it.next();
-            if (it.value() == id)
-                it.remove();
-        }
+        unindexFixtureAddress(id);
+
         if (m_monitorProps != NULL)
             m_monitorProps->removeFixture(id);
 
+        m_fixturesRevision.ref();
         emit fixtureRemoved(id);
         setModified();
         delete fxi;
@@ -532,7 +573,9 @@ bool Doc::replaceFixtures(QList<Fixture*> newFixturesList)
         m_fixturesListCacheUpToDate = false;
     }
     m_latestFixtureId = 0;
-    m_addresses.clear();
+    m_addressIndex.clear();
+    m_fixtureAddresses.clear();
+    m_fixturesRevision.ref();
 
     foreach(Fixture *fixture, newFixturesList)
     {
@@ -583,11 +626,7 @@ bool Doc::replaceFixtures(QList<Fixture*> newFixturesList)
                 this, SLOT(slotFixtureChanged(quint32)));
 
         /* Keep track of fixture addresses */
-        for (uint i = newFixture->universeAddress();
-             i < newFixture->universeAddress() + newFixture->channels(); i++)
-        {
-            m_addresses[i] = id;
-        }
+        indexFixtureAddress(id, newFixture->universeAddress(), newFixture->channels());
         m_latestFixtureId = id;
     }
     return true;
@@ -632,6 +671,7 @@ bool Doc::updateFixtureChannelCapabilities(quint32 id, QList<int> forcedHTP, QLi
     }
 
     inputOutputMap()->releaseUniverses(true);
+    m_fixturesRevision.ref();
 
     return true;
 }
@@ -661,7 +701,48 @@ Fixture* Doc::fixture(quint32 id) const
 
 quint32 Doc::fixtureForAddress(quint32 universeAddress) const
 {
-    return m_addresses.value(universeAddress, Fixture::invalidId());
+    // the last fixture starting at or before the address
+    QMultiMap <quint32, quint32>::const_iterator it = m_addressIndex.upperBound(universeAddress);
+    if (it == m_addressIndex.constBegin())
+        return Fixture::invalidId();
+
+    --it;
+
+    // when more fixtures start at the same address, the most
+    // recently indexed one comes first
+    quint32 start = it.key();
+    for (it = m_addressIndex.constFind(start); it != m_addressIndex.constEnd() && it.key() == start; ++it)
+    {
+        if (universeAddress < start + m_fixtureAddresses.value(it.value()).second)
+            return it.value();
+    }
+
+    return Fixture::invalidId();
+}
+
+bool Doc::isAddressRangeAvailable(quint32 universeAddress, quint32 channels, quint32 ignoreID) const
+{
+    if (channels == 0)
+        return true;
+
+    // walk back from the last fixture starting before the end of the range
+    QMultiMap <quint32, quint32>::const_iterator it = m_addressIndex.lowerBound(universeAddress + channels);
+    while (it != m_addressIndex.constBegin())
+    {
+        --it;
+        if (it.value() == ignoreID)
+            continue;
+
+        // fixtures starting within the range overlap it, the first one
+        // starting before the range overlaps it only if it spans into it
+        if (it.key() + m_fixtureAddresses.value(it.value()).second > universeAddress)
+            return false;
+
+        if (it.key() < universeAddress)
+            break;
+    }
+
+    return true;
 }
 
 int Doc::totalPowerConsumption(int& fuzzy) const
@@ -694,34 +775,45 @@ int Doc::totalPowerConsumption(int& fuzzy) const
     return totalPowerConsumption;
 }
 
+void Doc::indexFixtureAddress(quint32 id, quint32 universeAddress, quint32 channels)
+{
+    if (channels == 0)
+        return;
+
+    m_addressIndex.insert(universeAddress, id);
+    m_fixtureAddresses[id] = QPair<quint32, quint32>(universeAddress, channels);
+}
+
+void Doc::unindexFixtureAddress(quint32 id)
+{
+    QHash <quint32, QPair<quint32, quint32> >::iterator it = m_fixtureAddresses.find(id);
+    if (it == m_fixtureAddresses.end())
+        return;
+
+    m_addressIndex.remove(it.value().first, id);
+    m_fixtureAddresses.erase(it);
+}
+
+int Doc::fixturesRevision() const
+{
+    return m_fixturesRevision.loadAcquire();
+}
+
 void Doc::slotFixtureChanged(quint32 id)
 {
     /* Keep track of fixture addresses */
     Fixture* fxi = fixture(id);
 
-    // remove it
-    QMutableHashIterator <uint,uint> it(m_addresses);
-    while (it.hasNext() == true)
-    {
-        it.next();
-        if (it.value() == id)
-        {
-            qDebug() << Q_FUNC_INFO << " remove: " << it.key() << " val: " << it.value();
-            it.remove();
-        }
-    }
-
-    for (uint i = fxi->universeAddress(); i < fxi->universeAddress() + fxi->channels(); i++)
-    {
-        /*
-         * setting new universe and address calls this twice,
-         * with an tmp wrong address after the first call (old address() + new universe()).
-         * we only add if the channel is free, to prevent messing up things
-         */
-        Q_ASSERT(!m_addresses.contains(i));
-        m_addresses[i] = id;
-    }
+    /*
+     * setting new universe and address calls this twice,
+     * with an tmp wrong address after the first call (old address() + new universe()).
+     * The index allows fixtures to overlap meanwhile, the last indexed
+     * one being returned by fixtureForAddress
+     */
+    unindexFixtureAddress(id);
+    indexFixtureAddress(id, fxi->universeAddress(), fxi->channels());
 
+    m_fixturesRevision.ref();
     setModified();
     emit fixtureChanged(id);
 }
@@ -747,6 +839,7 @@ bool Doc::addFixtureGroup(FixtureGroup* grp, quint32 id)
     {
         grp->setId(id);
         m_fixtureGroups[id] = grp;
+        m_fixtureGroupsListCacheUpToDate = false;
 
         /* Patch fixture group change signals thru Doc */
         connect(grp, SIGNAL(changed(quint32)),
@@ -765,6 +858,7 @@ bool Doc::deleteFixtureGroup(quint32 id)
     {
         FixtureGroup* grp = m_fixtureGroups.take(id);
         Q_ASSERT(grp != NULL);
+        m_fixtureGroupsListCacheUpToDate = false;
 
         emit fixtureGroupRemoved(id);
         setModified();
@@ -787,9 +881,14 @@ FixtureGroup* Doc::fixtureGroup(quint32 id) const
         return NULL;
 }
 
-QList <FixtureGroup*> Doc::fixtureGroups() const
+QList <FixtureGroup*> const& Doc::fixtureGroups() const
 {
-    return m_fixtureGroups.values();
+    if (m_fixtureGroupsListCacheUpToDate == false)
+    {
+        m_fixtureGroupsListCache = m_fixtureGroups.values();
+        m_fixtureGroupsListCacheUpToDate = true;
+    }
+    return m_fixtureGroupsListCache;
 }
 
 quint32 Doc::createFixtureGroupId()
@@ -827,6 +926,7 @@ bool Doc::addChannelsGroup(ChannelsGroup *grp, quint32 id)
      m_channelsGroups[id] = grp;
      if (m_orderedGroups.contains(id) == false)
         m_orderedGroups.append(id);
+     m_channelsGroupsListCacheUpToDate = false;
 
      emit channelsGroupAdded(id);
      setModified();
@@ -848,6 +948,7 @@ bool Doc::deleteChannelsGroup(quint32 id)
         int idx = m_orderedGroups.indexOf(id);
         if (idx != -1)
             m_orderedGroups.takeAt(idx);
+        m_channelsGroupsListCacheUpToDate = false;
 
         return true;
     }
@@ -872,6 +973,7 @@ bool Doc::moveChannelGroup(quint32 id, int direction)
     m_orderedGroups.takeAt(idx);
     m_orderedGroups.insert(idx + direction, id);
     qDebug() << Q_FUNC_INFO << m_orderedGroups;
+    m_channelsGroupsListCacheUpToDate = false;
 
     setModified();
     return true;
@@ -885,15 +987,20 @@ ChannelsGroup* Doc::channelsGroup(quint32 id) const
         return NULL;
 }
 
-QList <ChannelsGroup*> Doc::channelsGroups() const
+QList <ChannelsGroup*> const& Doc::channelsGroups() const
 {
-    QList <ChannelsGroup*> orderedList;
-
-    for (int i = 0; i < m_orderedGroups.count(); i++)
+    if (m_channelsGroupsListCacheUpToDate == false)
     {
-        orderedList.append(m_channelsGroups[m_orderedGroups.at(i)]);
+        m_channelsGroupsListCache.clear();
+        m_channelsGroupsListCache.reserve(m_orderedGroups.count());
+
+        for (int i = 0; i < m_orderedGroups.count(); i++)
+        {
+            m_channelsGroupsListCache.append(m_channelsGroups[m_orderedGroups.at(i)]);
+        }
+        m_channelsGroupsListCacheUpToDate = true;
     }
-    return orderedList;
+    return m_channelsGroupsListCache;
 }
 
 quint32 Doc::createChannelsGroupId()
@@ -928,6 +1035,7 @@ bool Doc::addPalette(QLCPalette *palette, quint32 id)
     {
         palette->setID(id);
         m_palettes[id] = palette;
+        m_palettesListCacheUpToDate = false;
 
         emit paletteAdded(id);
         setModified();
@@ -942,6 +1050,7 @@ bool Doc::deletePalette(quint32 id)
     {
         QLCPalette *palette = m_palettes.take(id);
         Q_ASSERT(palette != NULL);
+        m_palettesListCacheUpToDate = false;
 
         emit paletteRemoved(id);
         setModified();
@@ -964,9 +1073,14 @@ QLCPalette *Doc::palette(quint32 id) const
         return NULL;
 }
 
-QList<QLCPalette *> Doc::palettes() const
+QList<QLCPalette *> const& Doc::palettes() const
 {
-    return m_palettes.values();
+    if (m_palettesListCacheUpToDate == false)
+    {
+        m_palettesListCache = m_palettes.values();
+        m_palettesListCacheUpToDate = true;
+    }
+    return m_palettesListCache;
 }
 
 quint32 Doc::createPaletteId()
@@ -1027,6 +1141,10 @@ bool Doc::addFunction(Function* func, quint32 id)
         // Place the function in the map and assign it the new ID
         m_functions[id] = func;
         func->setID(id);
+        m_functionsByType[func->type()][id] = func;
+        m_functionsNameIndex.setText(id, func->name());
+        m_functionsListCacheUpToDate = false;
+        m_functionsByTypeListCache.remove(func->type());
         emit functionAdded(id);
         setModified();
 
@@ -1034,20 +1152,28 @@ bool Doc::addFunction(Function* func, quint32 id)
     }
 }
 
-QList <Function*> Doc::functions() const
+QList <Function*> const& Doc::functions() const
 {
-    return m_functions.values();
+    if (m_functionsListCacheUpToDate == false)
+    {
+        m_functionsListCache = m_functions.values();
+        m_functionsListCacheUpToDate = true;
+    }
+    return m_functionsListCache;
 }
 
-QList<Function *> Doc::functionsByType(Function::Type type) const
+QList<Function *> const& Doc::functionsByType(Function::Type type) const
 {
-    QList <Function*> list;
-    foreach(Function *f, m_functions)
-    {
-        if (f != NULL && f->type() == type)
-            list.append(f);
-    }
-    return list;
+    QHash <int, QList <Function*> >::iterator it = m_functionsByTypeListCache.find(type);
+    if (it == m_functionsByTypeListCache.end())
+        it = m_functionsByTypeListCache.insert(type, m_functionsByType.value(type).values());
+
+    return it.value();
+}
+
+QSet<quint32> Doc::functionsByName(const QString &text) const
+{
+    return m_functionsNameIndex.match(text);
 }
 
 bool Doc::deleteFunction(quint32 id)
@@ -1056,6 +1182,10 @@ bool Doc::deleteFunction(quint32 id)
     {
         Function* func = m_functions.take(id);
         Q_ASSERT(func != NULL);
+        m_functionsByType[func->type()].remove(id);
+        m_functionsNameIndex.remove(id);
+        m_functionsListCacheUpToDate = false;
+        m_functionsByTypeListCache.remove(func->type());
 
         if (m_startupFunctionId == id)
             m_startupFunctionId = Function::invalidId();
@@ -1196,6 +1326,10 @@ void Doc::slotFunctionChanged(quint32 fid)
 
 void Doc::slotFunctionNameChanged(quint32 fid)
 {
+    Function *func = function(fid);
+    if (func != NULL)
+        m_functionsNameIndex.setText(fid, func->name());
+
     setModified();
     emit functionNameChanged(fid);
 }
@@ -1236,12 +1370,34 @@ bool Doc::loadXML(QXmlStreamReader &doc)
             setStartupFunction(sID);
     }
 
+    bool fixturesCached = false;
+    bool fixturesLoaded = false;
+
+    QIODevice *device = doc.device();
+    qint64 deviceSize = device ? device->size() : 0;
+    int progress = -1;
+
     while (doc.readNextStartElement())
     {
+        if (deviceSize > 0 && int(device->pos() * 100 / deviceSize) != progress)
+        {
+            progress = int(device->pos() * 100 / deviceSize);
+            emit loadProgress(progress);
+        }
+
         //qDebug() << "Doc tag:" << doc.name();
         if (doc.name() == KXMLFixture)
         {
-            Fixture::loader(doc, this);
+            // restore all the fixtures at the first one, right where
+            // the XML would have added them
+            if (fixturesLoaded == false && m_workspaceCache != NULL)
+                fixturesCached = m_workspaceCache->loadFixtures(this);
+            fixturesLoaded = true;
+
+            if (fixturesCached)
+                doc.skipCurrentElement();
+            else
+                Fixture::loader(doc, this);
         }
         else if (doc.name() == KXMLQLCFixtureGroup)
         {
@@ -1289,6 +1445,11 @@ bool Doc::loadXML(QXmlStreamReader &doc)
     return true;
 }
 
+void Doc::setWorkspaceCache(WorkspaceCache *cache)
+{
+    m_workspaceCache = cache;
+}
+
 bool Doc::saveXML(QXmlStreamWriter *doc)
 {
     Q_ASSERT(doc != NULL);
@@ -1374,9 +1535,19 @@ QString Doc::errorLog()
     return m_errorLog;
 }
 
+static void loadFunctionDeferred(Function *function)
+{
+    function->loadDeferred();
+}
+
 void Doc::postLoad()
 {
-    QListIterator <Function*> functionit(functions());
+    // Functions are independent from each other at this stage, so
+    // their deferred content is expanded by all the available cores
+    QList <Function*> functionList = functions();
+    QtConcurrent::blockingMap(functionList, loadFunctionDeferred);
+
+    QListIterator <Function*> functionit(functionList);
     while (functionit.hasNext() == true)
     {
         Function* function(functionit.next());
@@ -35,13 +35,17 @@
 #include "qlcclipboard.h"
 #include "mastertimer.h"
 #include "qlcpalette.h"
+#include "searchindex.h"
 #include "function.h"
 #include "fixture.h"
 
 class AudioCapture;
+class DMXRecorder;
+class LoadGovernor;
 class RGBScriptsCache;
 class AudioPluginCache;
 class MonitorProperties;
+class WorkspaceCache;
 
 /** @addtogroup engine Engine
  * @{
@@ -115,6 +119,10 @@ signals:
     /** Emitted when the document has been completely loaded. */
     void loaded();
 
+    /** Emitted while the document is loaded from a file, with the
+     *  $percent of the file read so far */
+    void loadProgress(int percent);
+
     /*********************************************************************
      * Engine components
      *********************************************************************/
@@ -146,12 +154,19 @@ public:
     /** Get the MasterTimer object that runs the show */
     MasterTimer *masterTimer() const;
 
+    /** Get the governor that slows down previews and monitors
+     *  when the MasterTimer is overloaded */
+    LoadGovernor *loadGovernor() const;
+
     /** Get the audio input capture object */
     QSharedPointer<AudioCapture> audioInputCapture();
 
     /** Destroy a previously created audio capture instance */
     void destroyAudioCapture();
 
+    /** Get the DMX recorder object, creating it when first requested */
+    DMXRecorder *dmxRecorder();
+
 private:
     QLCFixtureDefCache *m_fixtureDefCache;
     QLCModifiersCache *m_modifiersCache;
@@ -160,7 +175,9 @@ private:
     AudioPluginCache *m_audioPluginCache;
     MasterTimer *m_masterTimer;
     InputOutputMap *m_ioMap;
+    LoadGovernor *m_loadGovernor;
     QSharedPointer<AudioCapture> m_inputCapture;
+    DMXRecorder *m_dmxRecorder;
     MonitorProperties *m_monitorProps;
 
     /*********************************************************************
@@ -305,6 +322,18 @@ public:
      */
     quint32 fixtureForAddress(quint32 universeAddress) const;
 
+    /**
+     * Check if a range of DMX addresses is not occupied by any fixture.
+     *
+     * @param universeAddress The universe & address of the first channel
+     * @param channels The number of channels of the range
+     * @param ignoreID A fixture ID not to be considered, for example when
+     *                 checking the new address of an existing fixture
+     * @return true if the range is free, otherwise false
+     */
+    bool isAddressRangeAvailable(quint32 universeAddress, quint32 channels,
+                                 quint32 ignoreID = Fixture::invalidId()) const;
+
     /**
      * Get the total power consumption of all fixtures in the current
      * workspace.
@@ -314,12 +343,25 @@ public:
      */
     int totalPowerConsumption(int& fuzzy) const;
 
+    /**
+     * Get a counter that is incremented every time a fixture is added,
+     * removed or changed. Functions caching fixture-derived data can compare
+     * it with the value they cached with to know when to rebuild it.
+     */
+    int fixturesRevision() const;
+
 protected:
     /**
      * Create a new fixture ID
      */
     quint32 createFixtureId();
 
+    /** Add the address range of fixture $id to the address index */
+    void indexFixtureAddress(quint32 id, quint32 universeAddress, quint32 channels);
+
+    /** Remove the address range of fixture $id from the address index */
+    void unindexFixtureAddress(quint32 id);
+
 signals:
     /** Signal that a fixture has been added */
     void fixtureAdded(quint32 fxi_id);
@@ -342,12 +384,22 @@ protected:
     bool m_fixturesListCacheUpToDate;
     QList<Fixture*> m_fixturesListCache;
 
-    /** Map of the addresses occupied by fixtures */
-    QHash <quint32, quint32> m_addresses;
+    /** Index of the addresses occupied by fixtures: the universe address
+     *  of the first channel of each fixture, mapped to the fixture ID.
+     *  Being sorted by (universe << 9) | address, it holds an ordered
+     *  list of address intervals for each universe */
+    QMultiMap <quint32, quint32> m_addressIndex;
+
+    /** The first universe address and the number of channels
+     *  each fixture has in m_addressIndex */
+    QHash <quint32, QPair<quint32, quint32> > m_fixtureAddresses;
 
     /** Latest assigned fixture ID */
     quint32 m_latestFixtureId;
 
+    /** Fixtures revision counter, read from the MasterTimer thread */
+    QAtomicInt m_fixturesRevision;
+
     /*********************************************************************
      * Fixture groups
      *********************************************************************/
@@ -364,8 +416,12 @@ public:
     /** Get a fixture group by id */
     FixtureGroup* fixtureGroup(quint32 id) const;
 
-    /** Get a list of Doc's fixture groups */
-    QList <FixtureGroup*> fixtureGroups() const;
+    /**
+     * Get a list of Doc's fixture groups, ordered by ID. The list is
+     * cached until a group is added or removed, so iterating over it
+     * doesn't build a new list every time.
+     */
+    QList <FixtureGroup*> const& fixtureGroups() const;
 
 signals:
     void fixtureGroupAdded(quint32 id);
@@ -384,6 +440,10 @@ private:
     /** Fixture Groups */
     QMap <quint32,FixtureGroup*> m_fixtureGroups;
 
+    /** Fixture groups list cache */
+    mutable bool m_fixtureGroupsListCacheUpToDate;
+    mutable QList <FixtureGroup*> m_fixtureGroupsListCache;
+
     /** Latest assigned fixture group ID */
     quint32 m_latestFixtureGroupId;
 
@@ -406,8 +466,11 @@ public:
     /** Get a channels group by id */
     ChannelsGroup* channelsGroup(quint32 id) const;
 
-    /** Get a list of Doc's channels groups */
-    QList <ChannelsGroup*> channelsGroups() const;
+    /**
+     * Get a list of Doc's channels groups, in the order they are displayed.
+     * The list is cached until a group is added, removed or moved.
+     */
+    QList <ChannelsGroup*> const& channelsGroups() const;
 
 private:
     /** Create a new channels group ID */
@@ -428,6 +491,10 @@ private:
      *  in the Fixture Manager panel */
     QList <quint32> m_orderedGroups;
 
+    /** Ordered channels groups list cache */
+    mutable bool m_channelsGroupsListCacheUpToDate;
+    mutable QList <ChannelsGroup*> m_channelsGroupsListCache;
+
     /** Latest assigned channel group ID */
     quint32 m_latestChannelsGroupId;
 
@@ -447,8 +514,11 @@ public:
     /** Get a palette by id */
     QLCPalette *palette(quint32 id) const;
 
-    /** Get a list of Doc's palettes */
-    QList <QLCPalette*> palettes() const;
+    /**
+     * Get a list of Doc's palettes, ordered by ID. The list is cached
+     * until a palette is added or removed.
+     */
+    QList <QLCPalette*> const& palettes() const;
 
 private:
     /** Create a new palette ID */
@@ -465,6 +535,10 @@ private:
     /** Palettes */
     QMap <quint32,QLCPalette*> m_palettes;
 
+    /** Palettes list cache */
+    mutable bool m_palettesListCacheUpToDate;
+    mutable QList <QLCPalette*> m_palettesListCache;
+
     /** Latest assigned palette ID */
     quint32 m_latestPaletteId;
 
@@ -487,18 +561,32 @@ public:
     bool addFunction(Function* function, quint32 id = Function::invalidId());
 
     /**
-     * Get a list of currently available functions
+     * Get a list of currently available functions, ordered by ID.
+     * The list is cached until a function is added or removed, so
+     * iterating over it doesn't build a new list every time.
      *
      * @return List of functions
      */
-    QList <Function*> functions() const;
+    QList <Function*> const& functions() const;
 
     /**
-     * Get a list of currently available functions by type
+     * Get a list of currently available functions by type, ordered by ID.
+     * Each type has its own cached list, rebuilt only when a function
+     * of that type is added or removed.
      *
      * @return List of functions by type
      */
-    QList <Function*> functionsByType(Function::Type type) const;
+    QList <Function*> const& functionsByType(Function::Type type) const;
+
+    /**
+     * Get the IDs of the functions whose name contains the given text,
+     * ignoring case. This uses an index kept up to date with the
+     * functions, so it doesn't compare the text with every name.
+     *
+     * @param text The text to look for
+     * @return The IDs of the matching functions
+     */
+    QSet <quint32> functionsByName(const QString& text) const;
 
     /**
      * Delete the given function
@@ -584,6 +672,21 @@ protected:
     /** Functions */
     QMap <quint32,Function*> m_functions;
 
+    /** Functions indexed by type, to answer functionsByType()
+     *  without walking all the functions */
+    QHash <int, QMap <quint32,Function*> > m_functionsByType;
+
+    /** Index of the function names, to answer functionsByName() */
+    SearchIndex m_functionsNameIndex;
+
+    /** Functions list cache */
+    mutable bool m_functionsListCacheUpToDate;
+    mutable QList <Function*> m_functionsListCache;
+
+    /** Lists of the functions of each type. A type is removed
+     *  when one of its functions is added or removed */
+    mutable QHash <int, QList <Function*> > m_functionsByTypeListCache;
+
     /** Latest assigned function ID */
     quint32 m_latestFunctionId;
 
@@ -618,6 +721,14 @@ public:
      */
     bool saveXML(QXmlStreamWriter *doc);
 
+    /**
+     * Set the binary cache of the workspace about to be loaded. If the
+     * cache is valid, the next loadXML() restores the fixtures from it
+     * and skips their XML. The cache is not owned by Doc and must be
+     * reset to NULL once the workspace has been loaded.
+     */
+    void setWorkspaceCache(WorkspaceCache *cache);
+
     /**
      * Append a message to the Doc error log. This can be used to display
      * errors once a project is loaded.
@@ -642,6 +753,9 @@ private:
     void postLoad();
 
     QString m_errorLog;
+
+    /** The binary cache used by loadXML, if any */
+    WorkspaceCache *m_workspaceCache;
 };
 
 /** @} */
@@ -34,12 +34,16 @@
 #include "qlcfile.h"
 
 #include "mastertimer.h"
+#include "universe.h"
 #include "fixture.h"
 #include "scene.h"
 #include "doc.h"
 #include "efx.h"
 #include "bus.h"
 
+/** Number of pattern samples per cycle in the trajectory cache */
+#define EFX_TRAJECTORY_SAMPLES  4096
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -57,6 +61,7 @@ EFX::EFX(Doc* doc)
     , m_legacyHoldBus(Bus::invalid())
 {
     updateRotationCache();
+    updateTrajectoryCache();
     setName(tr("New EFX"));
     setDuration(20000); // 20s
 
@@ -135,6 +140,16 @@ bool EFX::copyFrom(const Function* function)
 
     m_algorithm = efx->m_algorithm;
 
+    // same pattern parameters, same samples: no need to compute them again
+    {
+        QMutexLocker locker(&efx->m_trajectoryMutex);
+        QVector<float> trajectory = efx->m_trajectory;
+        locker.unlock();
+
+        QMutexLocker myLocker(&m_trajectoryMutex);
+        m_trajectory = trajectory;
+    }
+
     return Function::copyFrom(function);
 }
 
@@ -167,6 +182,8 @@ void EFX::setAlgorithm(EFX::Algorithm algo)
     else
         m_algorithm = EFX::Circle;
 
+    updateTrajectoryCache();
+
     emit changed(this->id());
 }
 
@@ -311,8 +328,38 @@ float EFX::calculateDirection(Function::Direction direction, float iterator) con
     }
 }
 
-// this function should map from 0..M_PI * 2 -> -1..1
 void EFX::calculatePoint(float iterator, float* x, float* y) const
+{
+    QVector<float> trajectory;
+    {
+        QMutexLocker locker(&m_trajectoryMutex);
+        trajectory = m_trajectory;
+    }
+
+    if (trajectory.isEmpty())
+    {
+        calculatePatternPoint(iterator, x, y);
+    }
+    else
+    {
+        // linear interpolation between the two closest samples
+        float pos = iterator * (EFX_TRAJECTORY_SAMPLES / (M_PI * 2.0));
+        float index = floor(pos);
+        float frac = pos - index;
+        int i = int(index) % EFX_TRAJECTORY_SAMPLES;
+        if (i < 0)
+            i += EFX_TRAJECTORY_SAMPLES;
+
+        const float *p = trajectory.constData() + (i * 2);
+        *x = p[0] + (p[2] - p[0]) * frac;
+        *y = p[1] + (p[3] - p[1]) * frac;
+    }
+
+    rotateAndScale(x, y);
+}
+
+// this function should map from 0..M_PI * 2 -> -1..1
+void EFX::calculatePatternPoint(float iterator, float* x, float* y) const
 {
     switch (algorithm())
     {
@@ -404,8 +451,40 @@ void EFX::calculatePoint(float iterator, float* x, float* y) const
         }
         break;
     }
+}
 
-    rotateAndScale(x, y);
+/*****************************************************************************
+ * Trajectory cache
+ *****************************************************************************/
+
+void EFX::updateTrajectoryCache()
+{
+    QVector<float> trajectory;
+
+    switch (algorithm())
+    {
+        case Line2:
+        case Square:
+        case SquareChoppy:
+        break;
+        default:
+        {
+            trajectory.resize((EFX_TRAJECTORY_SAMPLES + 1) * 2);
+            float *p = trajectory.data();
+            for (int i = 0; i < EFX_TRAJECTORY_SAMPLES; i++)
+            {
+                float iterator = (M_PI * 2.0) * i / EFX_TRAJECTORY_SAMPLES;
+                calculatePatternPoint(iterator, p + (i * 2), p + (i * 2) + 1);
+            }
+            // close the cycle for the interpolation of the last sample
+            p[EFX_TRAJECTORY_SAMPLES * 2] = p[0];
+            p[EFX_TRAJECTORY_SAMPLES * 2 + 1] = p[1];
+        }
+        break;
+    }
+
+    QMutexLocker locker(&m_trajectoryMutex);
+    m_trajectory = trajectory;
 }
 
 /*****************************************************************************
@@ -529,6 +608,7 @@ int EFX::yOffset() const
 void EFX::setXFrequency(int freq)
 {
     m_xFrequency = static_cast<float> (CLAMP(freq, 0, 32));
+    updateTrajectoryCache();
     emit changed(this->id());
 }
 
@@ -540,6 +620,7 @@ int EFX::xFrequency() const
 void EFX::setYFrequency(int freq)
 {
     m_yFrequency = static_cast<float> (CLAMP(freq, 0, 32));
+    updateTrajectoryCache();
     emit changed(this->id());
 }
 
@@ -563,6 +644,7 @@ bool EFX::isFrequencyEnabled()
 void EFX::setXPhase(int phase)
 {
     m_xPhase = static_cast<float> (CLAMP(phase, 0, 359)) * M_PI / 180.0;
+    updateTrajectoryCache();
     emit changed(this->id());
 }
 
@@ -574,6 +656,7 @@ int EFX::xPhase() const
 void EFX::setYPhase(int phase)
 {
     m_yPhase = static_cast<float> (CLAMP(phase, 0, 359)) * M_PI / 180.0;
+    updateTrajectoryCache();
     emit changed(this->id());
 }
 
@@ -1066,13 +1149,22 @@ void EFX::write(MasterTimer *timer, QList<Universe*> universes)
     if (isPaused())
         return;
 
+    // fixtures are usually grouped by universe, so the fader
+    // is looked up again only when the universe changes
+    quint32 faderUniverse = Universe::invalid();
+    QSharedPointer<GenericFader> fader;
+
     QListIterator <EFXFixture*> it(m_fixtures);
     while (it.hasNext() == true)
     {
         EFXFixture *ef = it.next();
         if (ef->isReady() == false)
         {
-            QSharedPointer<GenericFader> fader = getFader(universes, ef->universe());
+            if (ef->universe() != faderUniverse)
+            {
+                faderUniverse = ef->universe();
+                fader = getFader(universes, faderUniverse);
+            }
             ef->nextStep(universes, fader);
         }
         else
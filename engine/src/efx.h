@@ -22,6 +22,7 @@
 #define EFX_H
 
 #include <QVector>
+#include <QMutex>
 #include <QPoint>
 #include <QList>
 
@@ -217,10 +218,38 @@ private:
      */
     float calculateDirection(Function::Direction direction, float iterator) const;
 
+    /**
+     * Calculate a single point of the unscaled pattern (-1..1)
+     * with the currently selected algorithm
+     *
+     * @param iterator Step number (input)
+     * @param x Used to store the calculated X coordinate (output)
+     * @param y Used to store the calculated Y coordinate (output)
+     */
+    void calculatePatternPoint(float iterator, float* x, float* y) const;
+
 private:
     /** Current algorithm used by the EFX */
     Algorithm m_algorithm;
 
+    /*********************************************************************
+     * Trajectory cache
+     *********************************************************************/
+private:
+    /**
+     * Sample the unscaled pattern of the current algorithm,
+     * frequencies and phases over a whole cycle. Only the smooth
+     * patterns are sampled; the piecewise linear ones are cheap
+     * to compute and would be smoothed by the interpolation.
+     */
+    void updateTrajectoryCache();
+
+private:
+    /** Interleaved x/y pattern samples (with the first one repeated
+     *  at the end), empty when the pattern is computed directly */
+    QVector<float> m_trajectory;
+    mutable QMutex m_trajectoryMutex;
+
     /*********************************************************************
      * Width
      *********************************************************************/
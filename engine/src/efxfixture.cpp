@@ -54,6 +54,13 @@ EFXFixture::EFXFixture(const EFX* parent)
     , m_started(false)
     , m_elapsed(0)
     , m_currentAngle(0)
+    , m_channelsBound(false)
+    , m_channelsValid(false)
+    , m_panMsbChannel(QLCChannel::invalid())
+    , m_panLsbChannel(QLCChannel::invalid())
+    , m_tiltMsbChannel(QLCChannel::invalid())
+    , m_tiltLsbChannel(QLCChannel::invalid())
+    , m_dimmerChannel(QLCChannel::invalid())
 {
     Q_ASSERT(parent != NULL);
 
@@ -77,6 +84,7 @@ void EFXFixture::copyFrom(const EFXFixture* ef)
     m_started = ef->m_started;
     m_elapsed = ef->m_elapsed;
     m_currentAngle = ef->m_currentAngle;
+    m_channelsBound = false;
 }
 
 EFXFixture::~EFXFixture()
@@ -90,6 +98,7 @@ EFXFixture::~EFXFixture()
 void EFXFixture::setHead(GroupHead const & head)
 {
     m_head = head;
+    m_channelsBound = false;
 
     Fixture *fxi = doc()->fixture(head.fxi);
     if (fxi == NULL)
@@ -146,6 +155,7 @@ int EFXFixture::startOffset() const
 void EFXFixture::setMode(Mode mode)
 {
     m_mode = mode;
+    m_channelsBound = false;
 }
 
 EFXFixture::Mode EFXFixture::mode() const
@@ -359,6 +369,7 @@ void EFXFixture::reset()
     m_started = false;
     m_elapsed = 0;
     m_currentAngle = 0;
+    m_channelsBound = false;
 }
 
 bool EFXFixture::isReady() const
@@ -397,9 +408,12 @@ void EFXFixture::nextStep(QList<Universe *> universes, QSharedPointer<GenericFad
 {
     m_elapsed += MasterTimer::tick();
 
+    if (m_channelsBound == false)
+        bindChannels();
+
     // Bail out without doing anything if this fixture is ready (after single-shot)
     // or it has no pan&tilt channels (not valid).
-    if (m_ready == true || isValid() == false)
+    if (m_ready == true || m_channelsValid == false)
         return;
 
     // Bail out without doing anything if this fixture is waiting for its turn.
@@ -479,47 +493,44 @@ void EFXFixture::updateFaderValues(FadeChannel *fc, uchar value)
 void EFXFixture::setPointPanTilt(QList<Universe *> universes, QSharedPointer<GenericFader> fader,
                                  float pan, float tilt)
 {
-    Fixture* fxi = doc()->fixture(head().fxi);
-    Q_ASSERT(fxi != NULL);
+    if (m_channelsBound == false)
+        bindChannels();
+
+    quint32 fxiID = head().fxi;
     Universe *uni = universes[universe()];
 
     /* Write coarse point data to universes */
-    quint32 panMsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::MSB, head().head);
-    quint32 panLsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::LSB, head().head);
-    quint32 tiltMsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::MSB, head().head);
-    quint32 tiltLsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::LSB, head().head);
-
-    if (panMsbChannel != QLCChannel::invalid() && !fader.isNull())
+    if (m_panMsbChannel != QLCChannel::invalid() && !fader.isNull())
     {
-        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxi->id(), panMsbChannel);
+        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxiID, m_panMsbChannel);
         if (m_parent->isRelative())
             fc->addFlag(FadeChannel::Relative);
         updateFaderValues(fc, static_cast<uchar>(pan));
     }
-    if (tiltMsbChannel != QLCChannel::invalid() && !fader.isNull())
+    if (m_tiltMsbChannel != QLCChannel::invalid() && !fader.isNull())
     {
-        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxi->id(), tiltMsbChannel);
+        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxiID, m_tiltMsbChannel);
         if (m_parent->isRelative())
             fc->addFlag(FadeChannel::Relative);
         updateFaderValues(fc, static_cast<uchar>(tilt));
     }
 
     /* Write fine point data to universes if applicable */
-    if (panLsbChannel != QLCChannel::invalid() && !fader.isNull())
+    if (m_panLsbChannel != QLCChannel::invalid() && !fader.isNull())
     {
         /* Leave only the fraction */
         uchar value = static_cast<uchar> ((pan - floor(pan)) * double(UCHAR_MAX));
-        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxi->id(), panLsbChannel);
+        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxiID, m_panLsbChannel);
         if (m_parent->isRelative())
             fc->addFlag(FadeChannel::Relative);
         updateFaderValues(fc, static_cast<uchar>(value));
     }
 
-    if (tiltLsbChannel != QLCChannel::invalid() && !fader.isNull())
+    if (m_tiltLsbChannel != QLCChannel::invalid() && !fader.isNull())
     {
         /* Leave only the fraction */
         uchar value = static_cast<uchar> ((tilt - floor(tilt)) * double(UCHAR_MAX));
-        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxi->id(), tiltLsbChannel);
+        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxiID, m_tiltLsbChannel);
         if (m_parent->isRelative())
             fc->addFlag(FadeChannel::Relative);
         updateFaderValues(fc, static_cast<uchar>(value));
@@ -528,50 +539,71 @@ void EFXFixture::setPointPanTilt(QList<Universe *> universes, QSharedPointer<Gen
 
 void EFXFixture::setPointDimmer(QList<Universe *> universes, QSharedPointer<GenericFader> fader, float dimmer)
 {
-    Fixture *fxi = doc()->fixture(head().fxi);
-    Q_ASSERT(fxi != NULL);
-    Universe *uni = universes[universe()];
+    if (m_channelsBound == false)
+        bindChannels();
 
-    quint32 intChannel = fxi->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, head().head);
+    Universe *uni = universes[universe()];
 
     /* Don't write dimmer data directly to universes but use FadeChannel to avoid steps at EFX loop restart */
-    if (intChannel != QLCChannel::invalid())
+    if (m_dimmerChannel != QLCChannel::invalid() && !fader.isNull())
     {
-        if (!fader.isNull())
-        {
-            FadeChannel *fc = fader->getChannelFader(doc(), uni, fxi->id(), intChannel);
-            updateFaderValues(fc, dimmer);
-        }
-    }
-    else if (fxi->masterIntensityChannel() != QLCChannel::invalid())
-    {
-        if (!fader.isNull())
-        {
-            FadeChannel *fc = fader->getChannelFader(doc(), uni, fxi->id(), fxi->masterIntensityChannel());
-            updateFaderValues(fc, dimmer);
-        }
+        FadeChannel *fc = fader->getChannelFader(doc(), uni, head().fxi, m_dimmerChannel);
+        updateFaderValues(fc, dimmer);
     }
 }
 
 void EFXFixture::setPointRGB(QList<Universe *> universes, QSharedPointer<GenericFader> fader, float x, float y)
 {
-    Fixture* fxi = doc()->fixture(head().fxi);
-    Q_ASSERT(fxi != NULL);
-    Universe *uni = universes[universe()];
+    if (m_channelsBound == false)
+        bindChannels();
 
-    QVector<quint32> rgbChannels = fxi->rgbChannels(head().head);
+    quint32 fxiID = head().fxi;
+    Universe *uni = universes[universe()];
 
     /* Don't write dimmer data directly to universes but use FadeChannel to avoid steps at EFX loop restart */
-    if (rgbChannels.size() >= 3 && !fader.isNull())
+    if (m_rgbChannels.size() >= 3 && !fader.isNull())
     {
         QColor pixel = m_rgbGradient.pixel(x, y);
 
-        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxi->id(), rgbChannels[0]);
+        FadeChannel *fc = fader->getChannelFader(doc(), uni, fxiID, m_rgbChannels[0]);
         updateFaderValues(fc, pixel.red());
-        fc = fader->getChannelFader(doc(), uni, fxi->id(), rgbChannels[1]);
+        fc = fader->getChannelFader(doc(), uni, fxiID, m_rgbChannels[1]);
         updateFaderValues(fc, pixel.green());
-        fc = fader->getChannelFader(doc(), uni, fxi->id(), rgbChannels[2]);
+        fc = fader->getChannelFader(doc(), uni, fxiID, m_rgbChannels[2]);
         updateFaderValues(fc, pixel.blue());
     }
 }
 
+/*****************************************************************************
+ * Channels
+ *****************************************************************************/
+
+void EFXFixture::bindChannels()
+{
+    m_channelsBound = true;
+    m_channelsValid = isValid();
+
+    m_panMsbChannel = QLCChannel::invalid();
+    m_panLsbChannel = QLCChannel::invalid();
+    m_tiltMsbChannel = QLCChannel::invalid();
+    m_tiltLsbChannel = QLCChannel::invalid();
+    m_dimmerChannel = QLCChannel::invalid();
+    m_rgbChannels.clear();
+
+    Fixture *fxi = doc()->fixture(head().fxi);
+    if (fxi == NULL)
+        return;
+
+    int h = head().head;
+
+    m_panMsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::MSB, h);
+    m_panLsbChannel = fxi->channelNumber(QLCChannel::Pan, QLCChannel::LSB, h);
+    m_tiltMsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::MSB, h);
+    m_tiltLsbChannel = fxi->channelNumber(QLCChannel::Tilt, QLCChannel::LSB, h);
+
+    m_dimmerChannel = fxi->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, h);
+    if (m_dimmerChannel == QLCChannel::invalid())
+        m_dimmerChannel = fxi->masterIntensityChannel();
+
+    m_rgbChannels = fxi->rgbChannels(h);
+}
@@ -21,6 +21,7 @@
 #ifndef EFXFIXTURE_H
 #define EFXFIXTURE_H
 
+#include <QVector>
 #include <QImage>
 #include "function.h"
 #include "grouphead.h"
@@ -184,6 +185,31 @@ private:
     /** 0..M_PI*2, current position, recomputed on each timer tick; depends on elapsed() and parent->duration() */
     float m_currentAngle;
 
+    /*************************************************************************
+     * Channels
+     *************************************************************************/
+private:
+    /** Resolve the channels written by this fixture, once per run,
+     *  instead of looking them up on each timer tick */
+    void bindChannels();
+
+private:
+    /** Flag raised when the channels below have been resolved */
+    bool m_channelsBound;
+
+    /** Result of isValid() when the channels have been resolved */
+    bool m_channelsValid;
+
+    quint32 m_panMsbChannel;
+    quint32 m_panLsbChannel;
+    quint32 m_tiltMsbChannel;
+    quint32 m_tiltLsbChannel;
+
+    /** The intensity channel of the head, or the fixture master intensity */
+    quint32 m_dimmerChannel;
+
+    QVector<quint32> m_rgbChannels;
+
     /*************************************************************************
      * Running
      *************************************************************************/
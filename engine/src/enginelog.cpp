@@ -0,0 +1,209 @@
+/*
+  Q Light Controller Plus
+  enginelog.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCoreApplication>
+#include <QThread>
+#include <string.h>
+
+#include "enginelog.h"
+
+Q_LOGGING_CATEGORY(lcMasterTimer, "qlcplus.engine.mastertimer")
+Q_LOGGING_CATEGORY(lcUniverse, "qlcplus.engine.universe")
+
+#define ENGINELOG_RING_MASK (ENGINELOG_RING_SIZE - 1)
+
+/** A slot of the ring. $sequence tells who owns it: a producer can fill
+ *  it when it equals the write position, the flush thread can take it
+ *  when it equals the read position + 1 */
+struct LogEntry
+{
+    QAtomicInt sequence;
+    QtMsgType type;
+    const char *category;
+    QString message;
+};
+
+static LogEntry s_ring[ENGINELOG_RING_SIZE];
+static QAtomicInt s_writePos(0);
+/* Accessed by the flush thread only */
+static int s_readPos = 0;
+static int s_reportedDropped = 0;
+
+static QAtomicInt s_dropped(0);
+static QtMessageHandler s_sink = NULL;
+static QtMessageHandler s_previous = NULL;
+
+static void deliver(QtMsgType type, const char *category, const QString &message)
+{
+    QMessageLogContext context(NULL, 0, NULL, category);
+
+    if (category != NULL && strcmp(category, "default") != 0)
+        s_sink(type, context, QLatin1Char('[') + QLatin1String(category) + QLatin1String("] ") + message);
+    else
+        s_sink(type, context, message);
+}
+
+static bool enqueue(QtMsgType type, const char *category, const QString &message)
+{
+    int pos = s_writePos.loadAcquire();
+
+    for (;;)
+    {
+        LogEntry &entry = s_ring[pos & ENGINELOG_RING_MASK];
+        int diff = int(uint(entry.sequence.loadAcquire()) - uint(pos));
+
+        if (diff == 0)
+        {
+            if (s_writePos.testAndSetOrdered(pos, pos + 1))
+            {
+                entry.type = type;
+                entry.category = category;
+                entry.message = message;
+                entry.sequence.storeRelease(pos + 1);
+                return true;
+            }
+            pos = s_writePos.loadAcquire();
+        }
+        else if (diff < 0)
+        {
+            // the flush thread hasn't taken this slot yet: the ring is full
+            return false;
+        }
+        else
+        {
+            pos = s_writePos.loadAcquire();
+        }
+    }
+}
+
+/** Deliver the queued messages. Return the number of messages delivered */
+static int flush()
+{
+    int count = 0;
+
+    for (;;)
+    {
+        LogEntry &entry = s_ring[s_readPos & ENGINELOG_RING_MASK];
+        if (int(uint(entry.sequence.loadAcquire()) - uint(s_readPos + 1)) < 0)
+            break;
+
+        QtMsgType type = entry.type;
+        const char *category = entry.category;
+        // the message memory is released here, not by the logging thread
+        QString message;
+        message.swap(entry.message);
+
+        entry.sequence.storeRelease(s_readPos + ENGINELOG_RING_SIZE);
+        s_readPos++;
+
+        deliver(type, category, message);
+        count++;
+    }
+
+    int dropped = s_dropped.loadAcquire();
+    if (dropped != s_reportedDropped)
+    {
+        deliver(QtWarningMsg, NULL, QString("[EngineLog] %1 messages dropped")
+                                    .arg(dropped - s_reportedDropped));
+        s_reportedDropped = dropped;
+    }
+
+    return count;
+}
+
+class LogFlushThread : public QThread
+{
+public:
+    LogFlushThread()
+        : m_running(1)
+    {
+        setObjectName("EngineLog");
+    }
+
+    void stop()
+    {
+        m_running.storeRelease(0);
+        wait();
+    }
+
+protected:
+    void run()
+    {
+        while (m_running.loadAcquire() != 0)
+        {
+            if (flush() == 0)
+                msleep(ENGINELOG_FLUSH_INTERVAL);
+        }
+
+        flush();
+    }
+
+private:
+    QAtomicInt m_running;
+};
+
+static LogFlushThread *s_thread = NULL;
+
+void EngineLog::start(QtMessageHandler handler)
+{
+    if (handler == NULL || s_thread != NULL)
+        return;
+
+    for (int i = 0; i < ENGINELOG_RING_SIZE; i++)
+        s_ring[i].sequence.storeRelease(i);
+    s_writePos.storeRelease(0);
+    s_readPos = 0;
+
+    s_sink = handler;
+    s_thread = new LogFlushThread();
+    s_thread->start(QThread::LowPriority);
+
+    s_previous = qInstallMessageHandler(messageHandler);
+    qAddPostRoutine(EngineLog::stop);
+}
+
+void EngineLog::stop()
+{
+    if (s_thread == NULL)
+        return;
+
+    qInstallMessageHandler(s_previous);
+
+    s_thread->stop();
+    delete s_thread;
+    s_thread = NULL;
+}
+
+int EngineLog::droppedCount()
+{
+    return s_dropped.loadAcquire();
+}
+
+void EngineLog::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    // a fatal message is followed by an abort, so it can't wait
+    if (type == QtFatalMsg)
+    {
+        s_sink(type, context, msg);
+        return;
+    }
+
+    if (enqueue(type, context.category, msg) == false)
+        s_dropped.ref();
+}
@@ -0,0 +1,77 @@
+/*
+  Q Light Controller Plus
+  enginelog.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef ENGINELOG_H
+#define ENGINELOG_H
+
+#include <QLoggingCategory>
+#include <QAtomicInt>
+#include <QString>
+
+#include "qlcloglimiter.h"
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+Q_DECLARE_LOGGING_CATEGORY(lcMasterTimer)
+Q_DECLARE_LOGGING_CATEGORY(lcUniverse)
+
+/** Number of messages the ring can hold. Must be a power of two */
+#define ENGINELOG_RING_SIZE 4096
+
+/** Milliseconds the flush thread sleeps when the ring is empty */
+#define ENGINELOG_FLUSH_INTERVAL 20
+
+/**
+ * EngineLog takes the Qt debug messages off the threads that log them.
+ *
+ * Once started, the message handler only copies each message into a
+ * lock-free ring, and a background thread hands them to the actual
+ * handler of the application, which usually writes them to a file or to
+ * the terminal. A thread logging from a hot path never waits for the
+ * output, and when the ring is full the messages are dropped and counted
+ * instead of blocking.
+ *
+ * The messages of a category other than the default one are prefixed
+ * with the category name, so that they can be told apart and enabled or
+ * disabled with the QT_LOGGING_RULES rules.
+ */
+class EngineLog
+{
+public:
+    /**
+     * Install the asynchronous message handler, forwarding the messages
+     * to $handler. The handler is stopped with QCoreApplication.
+     */
+    static void start(QtMessageHandler handler);
+
+    /** Write the pending messages and restore the previous handler */
+    static void stop();
+
+    /** Return the number of messages dropped because the ring was full */
+    static int droppedCount();
+
+private:
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+};
+
+/** @} */
+
+#endif
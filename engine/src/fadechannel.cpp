@@ -28,10 +28,12 @@
 
 FadeChannel::FadeChannel()
     : m_flags(0)
+    , m_ownerRevision(NULL)
     , m_fixture(Fixture::invalidId())
     , m_universe(Universe::invalid())
     , m_channel(QLCChannel::invalid())
     , m_address(QLCChannel::invalid())
+    , m_primaryChannel(QLCChannel::invalid())
     , m_start(0)
     , m_target(0)
     , m_current(0)
@@ -43,10 +45,12 @@ FadeChannel::FadeChannel()
 
 FadeChannel::FadeChannel(const FadeChannel& ch)
     : m_flags(ch.m_flags)
+    , m_ownerRevision(NULL)
     , m_fixture(ch.m_fixture)
     , m_universe(ch.m_universe)
     , m_channel(ch.m_channel)
     , m_address(ch.m_address)
+    , m_primaryChannel(ch.m_primaryChannel)
     , m_start(ch.m_start)
     , m_target(ch.m_target)
     , m_current(ch.m_current)
@@ -59,8 +63,10 @@ FadeChannel::FadeChannel(const FadeChannel& ch)
 
 FadeChannel::FadeChannel(const Doc *doc, quint32 fxi, quint32 channel)
     : m_flags(0)
+    , m_ownerRevision(NULL)
     , m_fixture(fxi)
     , m_channel(channel)
+    , m_primaryChannel(QLCChannel::invalid())
     , m_start(0)
     , m_target(0)
     , m_current(0)
@@ -84,12 +90,14 @@ FadeChannel &FadeChannel::operator=(const FadeChannel &fc)
         m_universe = fc.m_universe;
         m_channel = fc.m_channel;
         m_address = fc.m_address;
+        m_primaryChannel = fc.m_primaryChannel;
         m_start = fc.m_start;
         m_target = fc.m_target;
         m_current = fc.m_current;
         m_ready = fc.m_ready;
         m_fadeTime = fc.m_fadeTime;
         m_elapsed = fc.m_elapsed;
+        touch();
     }
 
     return *this;
@@ -107,17 +115,21 @@ int FadeChannel::flags() const
 
 void FadeChannel::setFlags(int flags)
 {
+    if (m_flags == flags)
+        return;
+
     m_flags = flags;
+    touch();
 }
 
 void FadeChannel::addFlag(int flag)
 {
-    m_flags |= flag;
+    setFlags(m_flags | flag);
 }
 
 void FadeChannel::removeFlag(int flag)
 {
-    m_flags &= (~flag);
+    setFlags(m_flags & (~flag));
 }
 
 void FadeChannel::autoDetect(const Doc *doc)
@@ -125,6 +137,7 @@ void FadeChannel::autoDetect(const Doc *doc)
     bool fixtureWasInvalid = false;
     // reset before autodetecting
     setFlags(0);
+    m_primaryChannel = QLCChannel::invalid();
 
     /* on invalid fixture, channel number is most likely
      * absolute (SimpleDesk/CueStack do it this way), so attempt
@@ -180,6 +193,24 @@ void FadeChannel::autoDetect(const Doc *doc)
             removeFlag(FadeChannel::HTP);
             addFlag(FadeChannel::LTP);
         }
+
+        // look for the MSB channel of a fine channel
+        if (channel->controlByte() == QLCChannel::LSB)
+        {
+            int type = channel->group() == QLCChannel::Intensity &&
+                       channel->colour() != QLCChannel::NoColour ? int(channel->colour()) : int(channel->group());
+
+            for (int i = 0; i < fixture->heads(); i++)
+            {
+                if (fixture->channelNumber(type, QLCChannel::LSB, i) != m_channel)
+                    continue;
+
+                m_primaryChannel = fixture->channelNumber(type, QLCChannel::MSB, i);
+                if (m_primaryChannel != QLCChannel::invalid())
+                    addFlag(FadeChannel::Fine);
+                break;
+            }
+        }
     }
 }
 
@@ -187,6 +218,7 @@ void FadeChannel::setFixture(const Doc *doc, quint32 id)
 {
     m_fixture = id;
     autoDetect(doc);
+    touch();
 }
 
 quint32 FadeChannel::fixture() const
@@ -205,6 +237,7 @@ void FadeChannel::setChannel(const Doc *doc, quint32 num)
 {
     m_channel = num;
     autoDetect(doc);
+    touch();
 }
 
 quint32 FadeChannel::channel() const
@@ -212,6 +245,11 @@ quint32 FadeChannel::channel() const
     return m_channel;
 }
 
+quint32 FadeChannel::primaryChannel() const
+{
+    return m_primaryChannel;
+}
+
 quint32 FadeChannel::address() const
 {
     if (m_address == QLCChannel::invalid())
@@ -227,7 +265,11 @@ quint32 FadeChannel::addressInUniverse() const
 
 void FadeChannel::setStart(uchar value)
 {
+    if (m_start == value)
+        return;
+
     m_start = value;
+    touch();
 }
 
 uchar FadeChannel::start() const
@@ -237,7 +279,11 @@ uchar FadeChannel::start() const
 
 void FadeChannel::setTarget(uchar value)
 {
+    if (m_target == value)
+        return;
+
     m_target = value;
+    touch();
 }
 
 uchar FadeChannel::target() const
@@ -247,7 +293,11 @@ uchar FadeChannel::target() const
 
 void FadeChannel::setCurrent(uchar value)
 {
+    if (m_current == value)
+        return;
+
     m_current = value;
+    touch();
 }
 
 uchar FadeChannel::current() const
@@ -262,7 +312,11 @@ uchar FadeChannel::current(qreal intensity) const
 
 void FadeChannel::setReady(bool rdy)
 {
+    if (m_ready == rdy)
+        return;
+
     m_ready = rdy;
+    touch();
 }
 
 bool FadeChannel::isReady() const
@@ -277,7 +331,11 @@ bool FadeChannel::canFade() const
 
 void FadeChannel::setFadeTime(uint ms)
 {
+    if (m_fadeTime == ms)
+        return;
+
     m_fadeTime = ms;
+    touch();
 }
 
 uint FadeChannel::fadeTime() const
@@ -287,7 +345,11 @@ uint FadeChannel::fadeTime() const
 
 void FadeChannel::setElapsed(uint time)
 {
+    if (m_elapsed == time)
+        return;
+
     m_elapsed = time;
+    touch();
 }
 
 uint FadeChannel::elapsed() const
@@ -295,33 +357,79 @@ uint FadeChannel::elapsed() const
     return m_elapsed;
 }
 
-uchar FadeChannel::nextStep(uint ms)
+uchar FadeChannel::nextStep(uint ms, FadeCurve::Type curve)
 {
-    if (elapsed() < UINT_MAX)
-        setElapsed(elapsed() + ms);
-    return calculateCurrent(fadeTime(), elapsed());
+    // stepping is done by the owning fader itself, so it doesn't touch()
+    if (m_elapsed < UINT_MAX)
+        m_elapsed += ms;
+    return calculateCurrent(fadeTime(), elapsed(), curve);
 }
 
-uchar FadeChannel::calculateCurrent(uint fadeTime, uint elapsedTime)
+uchar FadeChannel::calculateCurrent(uint fadeTime, uint elapsedTime, FadeCurve::Type curve)
 {
     if (elapsedTime >= fadeTime || m_ready == true)
     {
         // Return the target value if all time has been consumed
         // or if the channel has been marked ready.
         m_current = m_target;
-        setReady(true);
+        m_ready = true;
     }
     else if (elapsedTime == 0)
     {
         m_current = m_start;
     }
+    else if (curve == FadeCurve::Linear)
+    {
+        // fixed point interpolation: the truncated result is exact
+        m_current = m_start + int((qint64(m_target - m_start) * elapsedTime) / fadeTime);
+    }
     else
     {
-        m_current  = m_target - m_start;
-        m_current  = m_current * (qreal(elapsedTime) / qreal(fadeTime));
-        m_current += m_start;
+        int fraction = FadeCurve::fraction(curve, elapsedTime, fadeTime, m_target < m_start);
+        m_current = m_start + int((qint64(m_target - m_start) * fraction) / FADECURVE_ONE);
     }
 
     return uchar(m_current);
 }
 
+quint16 FadeChannel::nextStep16(FadeChannel &fine, uint ms, FadeCurve::Type curve)
+{
+    if (m_elapsed < UINT_MAX)
+        m_elapsed += ms;
+    fine.m_elapsed = m_elapsed;
+    return calculateCurrent16(fine, fadeTime(), elapsed(), curve);
+}
+
+quint16 FadeChannel::calculateCurrent16(FadeChannel &fine, uint fadeTime, uint elapsedTime,
+                                        FadeCurve::Type curve)
+{
+    int start = (m_start << 8) | fine.m_start;
+    int target = (m_target << 8) | fine.m_target;
+    int current;
+
+    if (elapsedTime >= fadeTime || m_ready == true)
+    {
+        current = target;
+        m_ready = true;
+        fine.m_ready = true;
+    }
+    else if (elapsedTime == 0)
+    {
+        current = start;
+    }
+    else if (curve == FadeCurve::Linear)
+    {
+        current = start + int((qint64(target - start) * elapsedTime) / fadeTime);
+    }
+    else
+    {
+        int fraction = FadeCurve::fraction(curve, elapsedTime, fadeTime, target < start);
+        current = start + int((qint64(target - start) * fraction) / FADECURVE_ONE);
+    }
+
+    m_current = current >> 8;
+    fine.m_current = current & 0xFF;
+
+    return quint16(current);
+}
+
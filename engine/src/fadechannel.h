@@ -20,9 +20,11 @@
 #ifndef FADECHANNEL_H
 #define FADECHANNEL_H
 
+#include <QAtomicInt>
 #include <QtGlobal>
 
 #include "qlcchannel.h"
+#include "fadecurve.h"
 #include "fixture.h"
 #include "doc.h"
 
@@ -38,6 +40,8 @@
  */
 class FadeChannel
 {
+    friend class GenericFader;
+
     /************************************************************************
      * Initialization
      ************************************************************************/
@@ -52,7 +56,9 @@ public:
         Relative    = (1 << 5),     /** Relative position */
         Override    = (1 << 6),     /** Override the current universe value */
         Autoremove  = (1 << 7),     /** Automatically remove the channel once value is written */
-        CrossFade   = (1 << 8)      /** Channel subject to crossfade */
+        CrossFade   = (1 << 8),     /** Channel subject to crossfade */
+        Fine        = (1 << 9),     /** LSB of a 16 bit channel, see primaryChannel() */
+        HandedOver  = (1 << 10)     /** Written by the fader crossfading from this one */
     };
 
     /** Create a new FadeChannel with empty/invalid values */
@@ -67,6 +73,8 @@ public:
     /** Destructor */
     virtual ~FadeChannel();
 
+    /** Copy the values of $fc. The fader owning this channel, if any,
+     *  is not changed, and is told that the channel has been modified */
     FadeChannel& operator=(const FadeChannel& fc);
 
     /** Comparison operator (true if fixture & channel match) */
@@ -88,6 +96,23 @@ private:
      *  and, if needed, more flags */
     int m_flags;
 
+    /************************************************************************
+     * Owner
+     ************************************************************************/
+private:
+    /** Tell the owning fader that this channel has been modified */
+    inline void touch()
+    {
+        if (m_ownerRevision != NULL)
+            m_ownerRevision->ref();
+    }
+
+    /** The revision counter of the GenericFader holding this channel,
+     *  incremented by every setter that modifies the channel, so that an
+     *  idle fader knows when it has to write again. Copies of a channel
+     *  have no owner */
+    QAtomicInt *m_ownerRevision;
+
     /************************************************************************
      * Values
      ************************************************************************/
@@ -107,6 +132,10 @@ public:
     /** Get channel within the Fixture. */
     quint32 channel() const;
 
+    /** Get the MSB channel within the Fixture when this is the LSB
+     *  (Fine flag) of a 16 bit channel, otherwise QLCChannel::invalid() */
+    quint32 primaryChannel() const;
+
     /** Get the absolute address for this channel. */
     quint32 address() const;
 
@@ -157,9 +186,9 @@ public:
 
     /**
      * Increment elapsed() by $ms milliseconds, calculate the next step and
-     * return the new current() value.
+     * return the new current() value, following $curve.
      */
-    uchar nextStep(uint ms);
+    uchar nextStep(uint ms, FadeCurve::Type curve = FadeCurve::Linear);
 
     /**
      * Calculate current value based on fadeTime and elapsedTime. Basically:
@@ -171,15 +200,32 @@ public:
      *
      * @param fadeTime Number of ms to fade from start to target
      * @param elapsedTime Number of ms already spent
+     * @param curve The shape of the fade
      * @return New current value
      */
-    uchar calculateCurrent(uint fadeTime, uint elapsedTime);
+    uchar calculateCurrent(uint fadeTime, uint elapsedTime,
+                           FadeCurve::Type curve = FadeCurve::Linear);
+
+    /**
+     * Same as nextStep(), but fades this channel and its $fine channel
+     * as a single 16 bit value, using the timings of this channel.
+     * The current values of both channels are updated accordingly.
+     *
+     * @return The new 16 bit current value
+     */
+    quint16 nextStep16(FadeChannel &fine, uint ms,
+                       FadeCurve::Type curve = FadeCurve::Linear);
+
+    /** Same as calculateCurrent() for a 16 bit pair of channels */
+    quint16 calculateCurrent16(FadeChannel &fine, uint fadeTime, uint elapsedTime,
+                               FadeCurve::Type curve = FadeCurve::Linear);
 
 private:
     quint32 m_fixture;
     quint32 m_universe;
     quint32 m_channel;
     quint32 m_address;
+    quint32 m_primaryChannel;
 
     int m_start;
     int m_target;
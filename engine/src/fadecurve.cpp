@@ -0,0 +1,82 @@
+/*
+  Q Light Controller Plus
+  fadecurve.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <qmath.h>
+
+#include "fadecurve.h"
+
+#define KXMLQLCFadeCurveLinear      QString("Linear")
+#define KXMLQLCFadeCurveSCurve      QString("SCurve")
+#define KXMLQLCFadeCurveExponential QString("Exponential")
+#define KXMLQLCFadeCurveGamma       QString("Gamma")
+
+/** The gamma of the LED dimmer curve */
+#define FADECURVE_GAMMA 2.2
+
+static int s_linear[FADECURVE_SEGMENTS + 1];
+static int s_sCurve[FADECURVE_SEGMENTS + 1];
+static int s_exponential[FADECURVE_SEGMENTS + 1];
+static int s_gamma[FADECURVE_SEGMENTS + 1];
+
+const int *FadeCurve::s_tables[] = { s_linear, s_sCurve, s_exponential, s_gamma };
+
+/** Fills the tables once, when the engine library is loaded */
+static struct FadeCurveTables
+{
+    FadeCurveTables()
+    {
+        for (int i = 0; i <= FADECURVE_SEGMENTS; i++)
+        {
+            qreal x = qreal(i) / FADECURVE_SEGMENTS;
+
+            s_linear[i] = toFixed(x);
+            s_sCurve[i] = toFixed(x * x * (3.0 - 2.0 * x));
+            s_exponential[i] = toFixed((qPow(2.0, 10.0 * x) - 1.0) / 1023.0);
+            s_gamma[i] = toFixed(qPow(x, FADECURVE_GAMMA));
+        }
+    }
+
+    static int toFixed(qreal value)
+    {
+        return qBound(0, qRound(value * FADECURVE_ONE), FADECURVE_ONE);
+    }
+} s_fadeCurveTables;
+
+QString FadeCurve::typeToString(FadeCurve::Type type)
+{
+    switch (type)
+    {
+        case SCurve: return KXMLQLCFadeCurveSCurve;
+        case Exponential: return KXMLQLCFadeCurveExponential;
+        case Gamma: return KXMLQLCFadeCurveGamma;
+        default: return KXMLQLCFadeCurveLinear;
+    }
+}
+
+FadeCurve::Type FadeCurve::stringToType(const QString &str)
+{
+    if (str == KXMLQLCFadeCurveSCurve)
+        return SCurve;
+    else if (str == KXMLQLCFadeCurveExponential)
+        return Exponential;
+    else if (str == KXMLQLCFadeCurveGamma)
+        return Gamma;
+    else
+        return Linear;
+}
@@ -0,0 +1,92 @@
+/*
+  Q Light Controller Plus
+  fadecurve.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef FADECURVE_H
+#define FADECURVE_H
+
+#include <QString>
+#include <QtGlobal>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Number of segments of a curve table. Must be a power of two */
+#define FADECURVE_SEGMENTS 256
+
+/** The fixed point value of a complete fade */
+#define FADECURVE_ONE 65536
+
+/**
+ * FadeCurve provides the shapes a fade can follow between its start and
+ * target values.
+ *
+ * Non-linear curves are precomputed once into fixed point tables, mapping
+ * the fade progress to the fraction of the value change, and evaluated with
+ * a lookup and a linear interpolation between two entries, so a curved fade
+ * costs about the same as a linear one on every tick.
+ *
+ * Curves are described for a rising value. A falling fade follows the curve
+ * mirrored, so that it always changes slowly where the value is low: for a
+ * fade to or from zero, Gamma keeps the perceived brightness of an LED
+ * changing at a constant rate.
+ */
+class FadeCurve
+{
+public:
+    enum Type
+    {
+        Linear = 0,
+        SCurve,
+        Exponential,
+        Gamma
+    };
+
+    static QString typeToString(Type type);
+    static Type stringToType(const QString &str);
+
+    /**
+     * Return the fraction of the value change done by a fade of $type after
+     * $elapsed ms out of $fadeTime, as a fixed point value between 0 and
+     * FADECURVE_ONE. $elapsed must be lower than $fadeTime.
+     */
+    static inline int fraction(Type type, uint elapsed, uint fadeTime, bool falling)
+    {
+        // the progress on FADECURVE_SEGMENTS * 256 steps
+        uint progress = uint((quint64(elapsed) * (FADECURVE_SEGMENTS << 8)) / fadeTime);
+        if (falling)
+            progress = (FADECURVE_SEGMENTS << 8) - progress;
+
+        const int *table = s_tables[type];
+        int index = int(progress >> 8);
+        int value = table[index];
+        if (index < FADECURVE_SEGMENTS)
+            value += ((table[index + 1] - value) * int(progress & 0xFF)) >> 8;
+
+        return falling ? FADECURVE_ONE - value : value;
+    }
+
+private:
+    /** The table of each type, with FADECURVE_SEGMENTS + 1 entries */
+    static const int *s_tables[Gamma + 1];
+};
+
+/** @} */
+
+#endif
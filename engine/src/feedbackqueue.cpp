@@ -0,0 +1,148 @@
+/*
+  Q Light Controller Plus
+  feedbackqueue.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QHash>
+
+#include "inputoutputmap.h"
+#include "feedbackqueue.h"
+#include "outputpatch.h"
+#include "qlcioplugin.h"
+
+FeedbackQueue::FeedbackQueue(InputOutputMap *ioMap)
+    : QObject(ioMap)
+    , m_ioMap(ioMap)
+    , m_pendingCount(0)
+    , m_batchDepth(0)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(slotFlush()));
+}
+
+FeedbackQueue::~FeedbackQueue()
+{
+}
+
+void FeedbackQueue::enqueue(quint32 universe, quint32 channel, uchar value, const QString &key)
+{
+    QMap<quint32, FeedbackValue> &values = m_pending[universe];
+    QMap<quint32, FeedbackValue>::iterator it = values.find(channel);
+
+    if (it == values.end())
+    {
+        it = values.insert(channel, FeedbackValue());
+        m_pendingCount++;
+    }
+
+    it.value().value = value;
+    it.value().key = key;
+
+    schedule();
+}
+
+void FeedbackQueue::beginBatch()
+{
+    m_batchDepth++;
+}
+
+void FeedbackQueue::endBatch()
+{
+    if (m_batchDepth == 0)
+        return;
+
+    m_batchDepth--;
+    schedule();
+}
+
+int FeedbackQueue::pendingCount() const
+{
+    return m_pendingCount;
+}
+
+void FeedbackQueue::clear(quint32 universe)
+{
+    m_pendingCount -= m_pending.take(universe).count();
+}
+
+void FeedbackQueue::schedule()
+{
+    if (m_batchDepth > 0 || m_pendingCount == 0 || m_timer.isActive())
+        return;
+
+    /* The first values after a pause go out right away. The following
+     * ones wait for the next flush, which paces the burst */
+    m_timer.start(0);
+}
+
+void FeedbackQueue::slotFlush()
+{
+    if (m_batchDepth > 0)
+        return;
+
+    int sent = flush();
+
+    /* Keep flushing until a whole interval goes by with nothing to send */
+    if (sent > 0 || m_pendingCount > 0)
+        m_timer.start(FEEDBACK_FLUSH_INTERVAL);
+}
+
+int FeedbackQueue::flush()
+{
+    QHash<QLCIOPlugin *, int> sent;
+    int total = 0;
+
+    QMutableMapIterator<quint32, QMap<quint32, FeedbackValue> > uIt(m_pending);
+    while (uIt.hasNext())
+    {
+        uIt.next();
+        quint32 universe = uIt.key();
+        QMap<quint32, FeedbackValue> &values = uIt.value();
+
+        OutputPatch *patch = NULL;
+        if (universe < m_ioMap->universesCount())
+            patch = m_ioMap->feedbackPatch(universe);
+
+        /* Feedback for a universe without a feedback line has nowhere to go */
+        if (patch == NULL || patch->isPatched() == false)
+        {
+            m_pendingCount -= values.count();
+            uIt.remove();
+            continue;
+        }
+
+        QLCIOPlugin *plugin = patch->plugin();
+        int &count = sent[plugin];
+
+        QMutableMapIterator<quint32, FeedbackValue> it(values);
+        while (it.hasNext() && count < FEEDBACK_MAX_PER_FLUSH)
+        {
+            it.next();
+            plugin->sendFeedBack(universe, patch->output(), it.key(),
+                                 it.value().value, it.value().key);
+            it.remove();
+            m_pendingCount--;
+            count++;
+            total++;
+        }
+
+        if (values.isEmpty())
+            uIt.remove();
+    }
+
+    return total;
+}
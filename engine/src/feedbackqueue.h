@@ -0,0 +1,112 @@
+/*
+  Q Light Controller Plus
+  feedbackqueue.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef FEEDBACKQUEUE_H
+#define FEEDBACKQUEUE_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QMap>
+
+class InputOutputMap;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Milliseconds between two flushes of the feedback queue */
+#define FEEDBACK_FLUSH_INTERVAL 20
+
+/** Maximum number of feedback messages sent to a plugin on each flush */
+#define FEEDBACK_MAX_PER_FLUSH 32
+
+/**
+ * FeedbackQueue coalesces the feedback sent to the input controllers.
+ *
+ * Instead of reaching the plugins right away, each value is queued per
+ * universe and channel, replacing any value of the same channel that has
+ * not been sent yet. The queue is flushed every FEEDBACK_FLUSH_INTERVAL
+ * milliseconds, sending at most FEEDBACK_MAX_PER_FLUSH messages to each
+ * plugin, so that a burst (a page flip, a big cue list starting) doesn't
+ * overflow motorized or LED controllers and only the final state of each
+ * channel goes out.
+ *
+ * Between beginBatch() and endBatch() nothing is flushed: the values of a
+ * batch are sent together when the outermost batch ends.
+ *
+ * The queue must be used from the thread it lives in (the main thread).
+ */
+class FeedbackQueue : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(FeedbackQueue)
+
+public:
+    FeedbackQueue(InputOutputMap *ioMap);
+    ~FeedbackQueue();
+
+    /** Queue $value for $channel of $universe, replacing a pending one */
+    void enqueue(quint32 universe, quint32 channel, uchar value, const QString& key);
+
+    /** Hold the queued values until the matching endBatch() */
+    void beginBatch();
+
+    /** End a batch, flushing the queue when the outermost batch ends */
+    void endBatch();
+
+    /** Get the number of values waiting to be sent */
+    int pendingCount() const;
+
+    /** Drop the values queued for $universe */
+    void clear(quint32 universe);
+
+    /** Send the pending values, within the per-plugin budget.
+     *  Return the number of values sent */
+    int flush();
+
+private slots:
+    void slotFlush();
+
+private:
+    /** Make sure a flush is scheduled when there are values to send */
+    void schedule();
+
+private:
+    struct FeedbackValue
+    {
+        uchar value;
+        QString key;
+    };
+
+    InputOutputMap *m_ioMap;
+
+    /** Pending values, by universe and channel */
+    QMap<quint32, QMap<quint32, FeedbackValue> > m_pending;
+    int m_pendingCount;
+
+    /** Nesting level of beginBatch() */
+    int m_batchDepth;
+
+    QTimer m_timer;
+};
+
+/** @} */
+
+#endif
@@ -20,10 +20,14 @@
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <QDataStream>
 #include <QString>
+#include <QVarLengthArray>
 #include <QtMath>
 #include <QDebug>
 
+#include <atomic>
+
 #include "qlcfixturedefcache.h"
 #include "channelmodifier.h"
 #include "qlcfixturemode.h"
@@ -213,6 +217,43 @@ quint32 Fixture::channelAddress(quint32 channel) const
         return QLCChannel::invalid();
 }
 
+/* The channel types indexed per head by cacheChannelRoles() */
+static const int s_roleTypes[] = {
+    QLCChannel::Intensity, QLCChannel::Pan, QLCChannel::Tilt,
+    QLCChannel::Shutter, QLCChannel::Gobo,
+    QLCChannel::Red, QLCChannel::Green, QLCChannel::Blue,
+    QLCChannel::Cyan, QLCChannel::Magenta, QLCChannel::Yellow,
+    QLCChannel::Amber, QLCChannel::White, QLCChannel::UV,
+    QLCChannel::Lime, QLCChannel::Indigo
+};
+
+#define ROLE_COUNT int(sizeof(s_roleTypes) / sizeof(s_roleTypes[0]))
+
+/* Return the index of $type in s_roleTypes, or -1 */
+static int roleSlot(int type)
+{
+    switch (type)
+    {
+        case QLCChannel::Intensity: return 0;
+        case QLCChannel::Pan: return 1;
+        case QLCChannel::Tilt: return 2;
+        case QLCChannel::Shutter: return 3;
+        case QLCChannel::Gobo: return 4;
+        case QLCChannel::Red: return 5;
+        case QLCChannel::Green: return 6;
+        case QLCChannel::Blue: return 7;
+        case QLCChannel::Cyan: return 8;
+        case QLCChannel::Magenta: return 9;
+        case QLCChannel::Yellow: return 10;
+        case QLCChannel::Amber: return 11;
+        case QLCChannel::White: return 12;
+        case QLCChannel::UV: return 13;
+        case QLCChannel::Lime: return 14;
+        case QLCChannel::Indigo: return 15;
+        default: return -1;
+    }
+}
+
 quint32 Fixture::channel(QLCChannel::Group group,
     QLCChannel::PrimaryColour color) const
 {
@@ -227,6 +268,18 @@ quint32 Fixture::channel(QLCChannel::Group group,
     }
     else
     {
+        /* Most lookups are answered by the index */
+        if (group == QLCChannel::Intensity)
+        {
+            int slot = roleSlot(color);
+            if (slot >= 0 && slot < m_colorChannels.size())
+                return m_colorChannels.at(slot);
+        }
+        else if (group >= 0 && group < m_groupChannels.size())
+        {
+            return m_groupChannels.at(group);
+        }
+
         /* Search for the channel name (and group) from our list */
         for (quint32 i = 0; i < quint32(m_fixtureMode->channels().size()); i++)
         {
@@ -279,10 +332,15 @@ QSet <quint32> Fixture::channels(QLCChannel::Group group, QLCChannel::PrimaryCol
 
 quint32 Fixture::channelNumber(int type, int controlByte, int head) const
 {
-    if (m_fixtureMode == NULL || head < 0 || head >= m_fixtureMode->heads().size())
+    int slot = roleSlot(type);
+    if (slot < 0 || head < 0)
         return QLCChannel::invalid();
 
-    return m_fixtureMode->heads().at(head).channelNumber(type, controlByte);
+    int index = (head * ROLE_COUNT + slot) * 2 + (controlByte == QLCChannel::LSB ? 1 : 0);
+    if (index >= m_roleChannels.size())
+        return QLCChannel::invalid();
+
+    return m_roleChannels.at(index);
 }
 
 quint32 Fixture::masterIntensityChannel() const
@@ -295,18 +353,106 @@ quint32 Fixture::masterIntensityChannel() const
 
 QVector <quint32> Fixture::rgbChannels(int head) const
 {
-    if (m_fixtureMode == NULL || head < 0 || head >= m_fixtureMode->heads().size())
-        return QVector <quint32> ();
+    QVector <quint32> vector;
+    quint32 r = channelNumber(QLCChannel::Red, QLCChannel::MSB, head);
+    quint32 g = channelNumber(QLCChannel::Green, QLCChannel::MSB, head);
+    quint32 b = channelNumber(QLCChannel::Blue, QLCChannel::MSB, head);
+
+    if (r != QLCChannel::invalid() && g != QLCChannel::invalid() && b != QLCChannel::invalid())
+        vector << r << g << b;
 
-    return m_fixtureMode->heads().at(head).rgbChannels();
+    return vector;
 }
 
 QVector <quint32> Fixture::cmyChannels(int head) const
 {
-    if (m_fixtureMode == NULL || head < 0 || head >= m_fixtureMode->heads().size())
-        return QVector <quint32> ();
+    QVector <quint32> vector;
+    quint32 c = channelNumber(QLCChannel::Cyan, QLCChannel::MSB, head);
+    quint32 m = channelNumber(QLCChannel::Magenta, QLCChannel::MSB, head);
+    quint32 y = channelNumber(QLCChannel::Yellow, QLCChannel::MSB, head);
+
+    if (c != QLCChannel::invalid() && m != QLCChannel::invalid() && y != QLCChannel::invalid())
+        vector << c << m << y;
+
+    return vector;
+}
+
+void Fixture::cacheChannelRoles()
+{
+    m_roleChannels.clear();
+    if (m_fixtureMode == NULL)
+        return;
+
+    QVector <QLCFixtureHead> heads = m_fixtureMode->heads();
+    m_roleChannels.fill(QLCChannel::invalid(), heads.size() * ROLE_COUNT * 2);
+
+    for (int h = 0; h < heads.size(); h++)
+    {
+        const QLCFixtureHead &head = heads.at(h);
+        quint32 *roles = m_roleChannels.data() + h * ROLE_COUNT * 2;
+
+        /* The head cache resolves pan/tilt, intensity and colors,
+           including the pan/tilt channels shared by the whole mode */
+        for (int r = 0; r < ROLE_COUNT; r++)
+        {
+            roles[r * 2] = head.channelNumber(s_roleTypes[r], QLCChannel::MSB);
+            roles[r * 2 + 1] = head.channelNumber(s_roleTypes[r], QLCChannel::LSB);
+        }
+
+        /* Shutter and gobo are not part of the head channel map:
+           index the first coarse channel of the head */
+        QVector <quint32> shutters = head.shutterChannels();
+        if (shutters.isEmpty() == false)
+            roles[roleSlot(QLCChannel::Shutter) * 2] = shutters.first();
+
+        quint32 gobo = QLCChannel::invalid();
+        foreach (quint32 i, head.channels())
+        {
+            const QLCChannel *ch = m_fixtureMode->channel(i);
+            if (ch != NULL && ch->group() == QLCChannel::Gobo &&
+                ch->controlByte() == QLCChannel::MSB && i < gobo)
+                gobo = i;
+        }
+        roles[roleSlot(QLCChannel::Gobo) * 2] = gobo;
+    }
+}
+
+void Fixture::cacheChannelGroups()
+{
+    if (m_fixtureMode == NULL)
+    {
+        m_groupChannels.clear();
+        m_colorChannels.clear();
+        return;
+    }
 
-    return m_fixtureMode->heads().at(head).cmyChannels();
+    /* Filled in place, so that concurrent readers never see
+       the vectors reallocated when an alias changes */
+    if (m_groupChannels.size() != QLCChannel::Nothing + 1)
+        m_groupChannels.resize(QLCChannel::Nothing + 1);
+    m_groupChannels.fill(QLCChannel::invalid());
+
+    if (m_colorChannels.size() != ROLE_COUNT)
+        m_colorChannels.resize(ROLE_COUNT);
+    m_colorChannels.fill(QLCChannel::invalid());
+
+    for (int i = m_fixtureMode->channels().size() - 1; i >= 0; i--)
+    {
+        const QLCChannel *ch = m_fixtureMode->channel(i);
+        if (ch == NULL)
+            continue;
+
+        int group = ch->group();
+        if (group >= 0 && group < m_groupChannels.size())
+            m_groupChannels[group] = i;
+
+        if (group == QLCChannel::Intensity)
+        {
+            int slot = roleSlot(ch->colour());
+            if (slot >= 0)
+                m_colorChannels[slot] = i;
+        }
+    }
 }
 
 QList<SceneValue> Fixture::positionToValues(int type, int degrees) const
@@ -484,40 +630,79 @@ bool Fixture::setChannelValues(const QByteArray &values)
     if (addr >= values.size())
         return false;
 
-    const int chNum = qMin(values.size() - addr, (int)channels());
+    const int chNum = qMin(qMin(values.size() - addr, (int)channels()), m_values.size());
+    QVarLengthArray<int, 16> aliasChannels;
     bool changed = false;
 
-    // Most of the times there are no changes,
-    // so the lock is inside the cycle
+    // Most of the times there are no changes, so the sequence
+    // is moved only when the first changed value is found
     for (int i = 0; i < chNum; i++)
     {
         if (m_values.at(i) != values.at(i + addr))
         {
-            changed = true;
-            QMutexLocker locker(&m_channelsInfoMutex);
-            m_values[i] = values.at(i + addr);
-            checkAlias(i, m_values[i]);
+            if (changed == false)
+            {
+                changed = true;
+                m_valuesSequence.fetchAndAddOrdered(1);
+            }
+            m_values.data()[i] = values.at(i + addr);
+
+            if (i < m_aliasInfo.count() && m_aliasInfo.at(i).m_hasAlias)
+                aliasChannels.append(i);
         }
     }
 
-    if (changed == true)
-        emit valuesChanged();
+    if (changed == false)
+        return false;
+
+    m_valuesSequence.fetchAndAddRelease(1);
+
+    // aliases are checked once the values are readable again,
+    // since aliasChanged() receivers may read them
+    for (int i = 0; i < aliasChannels.count(); i++)
+        checkAlias(aliasChannels.at(i), uchar(m_values.at(aliasChannels.at(i))));
 
-    return changed;
+    emit valuesChanged();
+
+    return true;
 }
 
 QByteArray Fixture::channelValues()
 {
-    QMutexLocker locker(&m_channelsInfoMutex);
-    return m_values;
+    QByteArray values;
+    int sequence;
+
+    do
+    {
+        sequence = m_valuesSequence.loadAcquire();
+        if (sequence & 1)
+            continue;
+
+        values = QByteArray(m_values.constData(), m_values.size());
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || m_valuesSequence.loadAcquire() != sequence);
+
+    return values;
 }
 
 uchar Fixture::channelValueAt(int idx)
 {
-    QMutexLocker locker(&m_channelsInfoMutex);
-    if (idx >= 0 && idx < m_values.length())
-        return (uchar)m_values.at(idx);
-    return 0;
+    uchar value;
+    int sequence;
+
+    do
+    {
+        sequence = m_valuesSequence.loadAcquire();
+        if (sequence & 1)
+            continue;
+
+        value = 0;
+        if (idx >= 0 && idx < m_values.length())
+            value = uchar(m_values.at(idx));
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || m_valuesSequence.loadAcquire() != sequence);
+
+    return value;
 }
 
 void Fixture::checkAlias(int chIndex, uchar value)
@@ -528,12 +713,14 @@ void Fixture::checkAlias(int chIndex, uchar value)
 
     // If the channel @chIndex has aliases, check
     // if replacements are to be done
-    QLCCapability *cap = m_fixtureMode->channel(chIndex)->searchCapability(value);
-    if (cap == m_aliasInfo[chIndex].m_currCap)
+    QLCCapability *cap = m_aliasInfo[chIndex].m_capTable.at(value);
+    QLCCapability *currCap = m_aliasInfo[chIndex].m_currCap;
+    if (cap == currCap)
         return;
 
     // first, revert any channel replaced to the original channel set
-    foreach (AliasInfo alias, m_aliasInfo[chIndex].m_currCap->aliasList())
+    const QList<AliasInfo> currAliases = currCap ? currCap->aliasList() : QList<AliasInfo>();
+    foreach (AliasInfo alias, currAliases)
     {
         QLCFixtureMode *mode = m_fixtureDef->mode(alias.targetMode);
         if (mode != m_fixtureMode)
@@ -546,7 +733,8 @@ void Fixture::checkAlias(int chIndex, uchar value)
     }
 
     // now, apply the current alias changes
-    foreach (AliasInfo alias, cap->aliasList())
+    const QList<AliasInfo> aliases = cap ? cap->aliasList() : QList<AliasInfo>();
+    foreach (AliasInfo alias, aliases)
     {
         QLCFixtureMode *mode = m_fixtureDef->mode(alias.targetMode);
         if (mode != m_fixtureMode)
@@ -558,10 +746,13 @@ void Fixture::checkAlias(int chIndex, uchar value)
         m_fixtureMode->replaceChannel(currChannel, newChannel);
     }
 
+    // the replaced channels may belong to other groups
+    if (currAliases.isEmpty() == false || aliases.isEmpty() == false)
+        cacheChannelGroups();
+
     emit aliasChanged();
 
     m_aliasInfo[chIndex].m_currCap = cap;
-
 }
 
 /*****************************************************************************
@@ -600,6 +791,9 @@ void Fixture::setFixtureDefinition(QLCFixtureDef* fixtureDef,
 
         m_aliasInfo.resize(chNum);
 
+        // the values array is reallocated, so readers must retry
+        m_valuesSequence.fetchAndAddOrdered(1);
+
         for (i = 0; i < chNum; i++)
         {
             QLCChannel *channel = fixtureMode->channel(i);
@@ -611,14 +805,26 @@ void Fixture::setFixtureDefinition(QLCFixtureDef* fixtureDef,
             // look for aliases
             m_aliasInfo[i].m_hasAlias = false;
             m_aliasInfo[i].m_currCap = capsList.count() ? capsList.at(0) : NULL;
+            m_aliasInfo[i].m_capTable.clear();
 
             foreach (QLCCapability *cap, capsList)
             {
                 if (cap->preset() == QLCCapability::Alias)
                     m_aliasInfo[i].m_hasAlias = true;
             }
+
+            // resolve every value to its capability once, so that
+            // checkAlias doesn't have to search for it on each change
+            if (m_aliasInfo[i].m_hasAlias)
+            {
+                m_aliasInfo[i].m_capTable.resize(256);
+                for (int v = 0; v < 256; v++)
+                    m_aliasInfo[i].m_capTable[v] = channel->searchCapability(uchar(v));
+            }
         }
 
+        m_valuesSequence.fetchAndAddRelease(1);
+
         // Cache all head channels
         fixtureMode->cacheHeads();
     }
@@ -628,6 +834,9 @@ void Fixture::setFixtureDefinition(QLCFixtureDef* fixtureDef,
         m_fixtureMode = NULL;
     }
 
+    cacheChannelRoles();
+    cacheChannelGroups();
+
     emit changed(m_id);
 }
 
@@ -890,6 +1099,16 @@ QLCFixtureMode *Fixture::genericRGBPanelMode(QLCFixtureDef *def, Components comp
  * Load & Save
  *****************************************************************************/
 
+Fixture::LoadInfo::LoadInfo()
+    : m_id(Fixture::invalidId())
+    , m_universe(0)
+    , m_address(0)
+    , m_channels(0)
+    , m_width(0)
+    , m_height(0)
+{
+}
+
 bool Fixture::loader(QXmlStreamReader &root, Doc* doc)
 {
     bool result = false;
@@ -924,22 +1143,7 @@ bool Fixture::loader(QXmlStreamReader &root, Doc* doc)
 bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
                       const QLCFixtureDefCache* fixtureDefCache)
 {
-    QLCFixtureDef* fixtureDef = NULL;
-    QLCFixtureMode* fixtureMode = NULL;
-    QString manufacturer;
-    QString model;
-    QString modeName;
-    QString name;
-    quint32 id = Fixture::invalidId();
-    quint32 universe = 0;
-    quint32 address = 0;
-    quint32 channels = 0;
-    quint32 width = 0, height = 0;
-    QList<int> excludeList;
-    QList<int> forcedHTP;
-    QList<int> forcedLTP;
-    QList<quint32>modifierIndices;
-    QList<ChannelModifier *>modifierPointers;
+    LoadInfo info;
 
     if (xmlDoc.name() != KXMLFixture)
     {
@@ -951,43 +1155,43 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
     {
         if (xmlDoc.name() == KXMLQLCFixtureDefManufacturer)
         {
-            manufacturer = xmlDoc.readElementText();
+            info.m_manufacturer = xmlDoc.readElementText();
         }
         else if (xmlDoc.name() == KXMLQLCFixtureDefModel)
         {
-            model = xmlDoc.readElementText();
+            info.m_model = xmlDoc.readElementText();
         }
         else if (xmlDoc.name() == KXMLQLCFixtureMode)
         {
-            modeName = xmlDoc.readElementText();
+            info.m_modeName = xmlDoc.readElementText();
         }
         else if (xmlDoc.name() == KXMLQLCPhysicalDimensionsWeight)
         {
-            width = xmlDoc.readElementText().toUInt();
+            info.m_width = xmlDoc.readElementText().toUInt();
         }
         else if (xmlDoc.name() == KXMLQLCPhysicalDimensionsHeight)
         {
-            height = xmlDoc.readElementText().toUInt();
+            info.m_height = xmlDoc.readElementText().toUInt();
         }
         else if (xmlDoc.name() == KXMLFixtureID)
         {
-            id = xmlDoc.readElementText().toUInt();
+            info.m_id = xmlDoc.readElementText().toUInt();
         }
         else if (xmlDoc.name() == KXMLFixtureName)
         {
-            name = xmlDoc.readElementText();
+            info.m_name = xmlDoc.readElementText();
         }
         else if (xmlDoc.name() == KXMLFixtureUniverse)
         {
-            universe = xmlDoc.readElementText().toInt();
+            info.m_universe = xmlDoc.readElementText().toInt();
         }
         else if (xmlDoc.name() == KXMLFixtureAddress)
         {
-            address = xmlDoc.readElementText().toInt();
+            info.m_address = xmlDoc.readElementText().toInt();
         }
         else if (xmlDoc.name() == KXMLFixtureChannels)
         {
-            channels = xmlDoc.readElementText().toInt();
+            info.m_channels = xmlDoc.readElementText().toInt();
         }
         else if (xmlDoc.name() == KXMLFixtureExcludeFade)
         {
@@ -995,7 +1199,7 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
             QStringList values = list.split(",");
 
             for (int i = 0; i < values.count(); i++)
-                excludeList.append(values.at(i).toInt());
+                info.m_excludeList.append(values.at(i).toInt());
         }
         else if (xmlDoc.name() == KXMLFixtureForcedHTP)
         {
@@ -1003,7 +1207,7 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
             QStringList values = list.split(",");
 
             for (int i = 0; i < values.count(); i++)
-                forcedHTP.append(values.at(i).toInt());
+                info.m_forcedHTP.append(values.at(i).toInt());
         }
         else if (xmlDoc.name() == KXMLFixtureForcedLTP)
         {
@@ -1011,7 +1215,7 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
             QStringList values = list.split(",");
 
             for (int i = 0; i < values.count(); i++)
-                forcedLTP.append(values.at(i).toInt());
+                info.m_forcedLTP.append(values.at(i).toInt());
         }
         else if (xmlDoc.name() == KXMLFixtureChannelModifier)
         {
@@ -1024,8 +1228,8 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
                 ChannelModifier *chMod = doc->modifiersCache()->modifier(modName);
                 if (chMod != NULL)
                 {
-                    modifierIndices.append(chIdx);
-                    modifierPointers.append(chMod);
+                    info.m_modifierIndices.append(chIdx);
+                    info.m_modifierPointers.append(chMod);
                 }
                 xmlDoc.skipCurrentElement();
             }
@@ -1037,24 +1241,33 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
         }
     }
 
+    return applyLoadInfo(info, doc, fixtureDefCache);
+}
+
+bool Fixture::applyLoadInfo(LoadInfo &info, Doc* doc,
+                            const QLCFixtureDefCache* fixtureDefCache)
+{
+    QLCFixtureDef* fixtureDef = NULL;
+    QLCFixtureMode* fixtureMode = NULL;
+
     /* Find the given fixture definition, unless its a generic dimmer */
-    if (model != KXMLFixtureGeneric && model != KXMLFixtureRGBPanel)
+    if (info.m_model != KXMLFixtureGeneric && info.m_model != KXMLFixtureRGBPanel)
     {
-        fixtureDef = fixtureDefCache->fixtureDef(manufacturer, model);
+        fixtureDef = fixtureDefCache->fixtureDef(info.m_manufacturer, info.m_model);
         if (fixtureDef == NULL)
         {
             doc->appendToErrorLog(QString("No fixture definition found for <b>%1</b> <b>%2</b>")
-                                  .arg(manufacturer)
-                                  .arg(model));
+                                  .arg(info.m_manufacturer)
+                                  .arg(info.m_model));
         }
         else
         {
             /* Find the given fixture mode */
-            fixtureMode = fixtureDef->mode(modeName);
+            fixtureMode = fixtureDef->mode(info.m_modeName);
             if (fixtureMode == NULL)
             {
                 doc->appendToErrorLog(QString("Fixture mode <b>%1</b> not found for <b>%2</b> <b>%3</b>")
-                                      .arg(modeName).arg(manufacturer).arg(model));
+                                      .arg(info.m_modeName).arg(info.m_manufacturer).arg(info.m_model));
 
                 /* Set this also NULL so that a generic dimmer will be
                    created instead as a backup. */
@@ -1064,52 +1277,52 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
     }
 
     /* Number of channels */
-    if (channels <= 0)
+    if (info.m_channels <= 0)
     {
         doc->appendToErrorLog(QString("%1 channels of fixture <b>%2</b> are our of bounds")
-                              .arg(QString::number(channels))
-                              .arg(name));
-        channels = 1;
+                              .arg(QString::number(info.m_channels))
+                              .arg(info.m_name));
+        info.m_channels = 1;
     }
 
     /* Make sure that address is something sensible */
-    if (address > 511 || address + (channels - 1) > 511)
+    if (info.m_address > 511 || info.m_address + (info.m_channels - 1) > 511)
     {
         doc->appendToErrorLog(QString("Fixture address range %1-%2 is out of DMX bounds")
-                              .arg(QString::number(address))
-                              .arg(QString::number(address + channels - 1)));
-        address = 0;
+                              .arg(QString::number(info.m_address))
+                              .arg(QString::number(info.m_address + info.m_channels - 1)));
+        info.m_address = 0;
     }
 
     /* Check that the invalid ID is not used */
-    if (id == Fixture::invalidId())
+    if (info.m_id == Fixture::invalidId())
     {
-        qWarning() << Q_FUNC_INFO << "Fixture ID" << id << "is not allowed.";
+        qWarning() << Q_FUNC_INFO << "Fixture ID" << info.m_id << "is not allowed.";
         return false;
     }
 
-    if (model == KXMLFixtureGeneric)
+    if (info.m_model == KXMLFixtureGeneric)
     {
-        fixtureDef = genericDimmerDef(channels);
-        fixtureMode = genericDimmerMode(fixtureDef, channels);
+        fixtureDef = genericDimmerDef(info.m_channels);
+        fixtureMode = genericDimmerMode(fixtureDef, info.m_channels);
     }
-    else if (model == KXMLFixtureRGBPanel)
+    else if (info.m_model == KXMLFixtureRGBPanel)
     {
         Components components = RGB;
         int compNum = 3;
-        if (modeName == "BGR") components = BGR;
-        else if (modeName == "BRG") components = BRG;
-        else if (modeName == "GBR") components = GBR;
-        else if (modeName == "GRB") components = GRB;
-        else if (modeName == "RBG") components = RBG;
-        else if (modeName == "RGBW")
+        if (info.m_modeName == "BGR") components = BGR;
+        else if (info.m_modeName == "BRG") components = BRG;
+        else if (info.m_modeName == "GBR") components = GBR;
+        else if (info.m_modeName == "GRB") components = GRB;
+        else if (info.m_modeName == "RBG") components = RBG;
+        else if (info.m_modeName == "RGBW")
         {
             components = RGBW;
             compNum = 4;
         }
 
-        fixtureDef = genericRGBPanelDef(channels / compNum, components);
-        fixtureMode = genericRGBPanelMode(fixtureDef, components, width, height);
+        fixtureDef = genericRGBPanelDef(info.m_channels / compNum, components);
+        fixtureMode = genericRGBPanelMode(fixtureDef, components, info.m_width, info.m_height);
     }
 
     if (fixtureDef != NULL && fixtureMode != NULL)
@@ -1120,18 +1333,18 @@ bool Fixture::loadXML(QXmlStreamReader &xmlDoc, Doc *doc,
     else
     {
         /* Otherwise set just the channel count */
-        setChannels(channels);
+        setChannels(info.m_channels);
     }
 
-    setAddress(address);
-    setUniverse(universe);
-    setName(name);
-    setExcludeFadeChannels(excludeList);
-    setForcedHTPChannels(forcedHTP);
-    setForcedLTPChannels(forcedLTP);
-    for (int i = 0; i < modifierIndices.count(); i++)
-        setChannelModifier(modifierIndices.at(i), modifierPointers.at(i));
-    setID(id);
+    setAddress(info.m_address);
+    setUniverse(info.m_universe);
+    setName(info.m_name);
+    setExcludeFadeChannels(info.m_excludeList);
+    setForcedHTPChannels(info.m_forcedHTP);
+    setForcedLTPChannels(info.m_forcedLTP);
+    for (int i = 0; i < info.m_modifierIndices.count(); i++)
+        setChannelModifier(info.m_modifierIndices.at(i), info.m_modifierPointers.at(i));
+    setID(info.m_id);
 
     return true;
 }
@@ -1242,6 +1455,62 @@ bool Fixture::saveXML(QXmlStreamWriter *doc) const
     return true;
 }
 
+bool Fixture::loadBinary(QDataStream &stream, Doc *doc,
+                         const QLCFixtureDefCache* fixtureDefCache)
+{
+    LoadInfo info;
+    QList<QPair<quint32, QString> > modifiers;
+
+    stream >> info.m_manufacturer >> info.m_model >> info.m_modeName
+           >> info.m_width >> info.m_height
+           >> info.m_id >> info.m_name
+           >> info.m_universe >> info.m_address >> info.m_channels
+           >> info.m_excludeList >> info.m_forcedHTP >> info.m_forcedLTP
+           >> modifiers;
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        qWarning() << Q_FUNC_INFO << "Truncated fixture data";
+        return false;
+    }
+
+    for (int i = 0; i < modifiers.count(); i++)
+    {
+        ChannelModifier *chMod = doc->modifiersCache()->modifier(modifiers.at(i).second);
+        if (chMod != NULL)
+        {
+            info.m_modifierIndices.append(modifiers.at(i).first);
+            info.m_modifierPointers.append(chMod);
+        }
+    }
+
+    return applyLoadInfo(info, doc, fixtureDefCache);
+}
+
+void Fixture::saveBinary(QDataStream &stream) const
+{
+    bool isPanel = m_fixtureDef != NULL && m_fixtureDef->model() == KXMLFixtureRGBPanel && m_fixtureMode != NULL;
+    QList<QPair<quint32, QString> > modifiers;
+
+    QHashIterator<quint32, ChannelModifier *> it(m_channelModifiers);
+    while (it.hasNext())
+    {
+        it.next();
+        if (it.value() != NULL)
+            modifiers.append(QPair<quint32, QString>(it.key(), it.value()->name()));
+    }
+
+    stream << (m_fixtureDef != NULL ? m_fixtureDef->manufacturer() : QString(KXMLFixtureGeneric))
+           << (m_fixtureDef != NULL ? m_fixtureDef->model() : QString(KXMLFixtureGeneric))
+           << (m_fixtureMode != NULL ? m_fixtureMode->name() : QString(KXMLFixtureGeneric))
+           << quint32(isPanel ? m_fixtureMode->physical().width() : 0)
+           << quint32(isPanel ? m_fixtureMode->physical().height() : 0)
+           << id() << m_name
+           << universe() << address() << channels()
+           << m_excludeFadeIndices << m_forcedHTPIndices << m_forcedLTPIndices
+           << modifiers;
+}
+
 /*****************************************************************************
  * Status
  *****************************************************************************/
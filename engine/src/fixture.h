@@ -21,6 +21,7 @@
 #ifndef FIXTURE_H
 #define FIXTURE_H
 
+#include <QAtomicInt>
 #include <QObject>
 #include <QMutex>
 #include <QList>
@@ -33,6 +34,7 @@
 class QString;
 
 class QLCFixtureDefCache;
+class QDataStream;
 class ChannelModifier;
 class QLCFixtureMode;
 class QLCFixtureHead;
@@ -65,6 +67,7 @@ typedef struct
 {
     bool m_hasAlias;        /** Flag to enable/disable aliases check */
     QLCCapability *m_currCap; /** The current capability in use */
+    QVector<QLCCapability *> m_capTable; /** The capability of each DMX value, if m_hasAlias */
 } ChannelAlias;
 
 class Fixture : public QObject
@@ -263,7 +266,14 @@ public:
                     QLCChannel::Group group,
                     QLCChannel::PrimaryColour color = QLCChannel::NoColour) const;
 
-    /** @see QLCFixtureHead */
+    /**
+     * Get the channel number of a head by channel $type (a QLCChannel::Group
+     * like Pan, Tilt, Intensity, Shutter or Gobo, or a QLCChannel::PrimaryColour)
+     * and $controlByte. The lookup is an array read in the index built
+     * when the fixture mode is set.
+     *
+     * @see QLCFixtureHead
+     */
     quint32 channelNumber(int type, int controlByte, int head = 0) const;
 
     /** @see QLCFixtureMode */
@@ -314,6 +324,24 @@ protected:
     /** Find and store channel numbers (pan, tilt, intensity) */
     void findChannels();
 
+    /** Build the channel role index of each head */
+    void cacheChannelRoles();
+
+    /** Build the index of the first channel of each group and color */
+    void cacheChannelGroups();
+
+protected:
+    /** The channels of each head by role, as (head * role count + role) * 2
+     *  + 0 for MSB, 1 for LSB. Sized once per fixture mode, so readers
+     *  never see it reallocated by an alias change */
+    QVector<quint32> m_roleChannels;
+
+    /** The first channel of each QLCChannel::Group */
+    QVector<quint32> m_groupChannels;
+
+    /** The first intensity channel of each color role */
+    QVector<quint32> m_colorChannels;
+
 protected:
     /** DMX address & universe */
     quint32 m_address;
@@ -343,10 +371,12 @@ public:
      * it returns true, otherwise false */
     bool setChannelValues(const QByteArray &values);
 
-    /** Return the current DMX values of this fixture */
+    /** Return the current DMX values of this fixture.
+     *  This never waits for setChannelValues() to complete */
     QByteArray channelValues();
 
-    /** Retrieve the DMX value of the given channel index */
+    /** Retrieve the DMX value of the given channel index.
+     *  This never waits for setChannelValues() to complete */
     uchar channelValueAt(int idx);
 
     /** Check if some alias has changed on channel $chIndex for $value */
@@ -361,7 +391,10 @@ protected:
     QByteArray m_values;
     /** Runtime array to check for alias changes */
     QVector<ChannelAlias> m_aliasInfo;
-    QMutex m_channelsInfoMutex;
+
+    /** Sequence counter of m_values, odd while it is being written.
+     *  Readers copy m_values and retry if the counter has changed meanwhile */
+    QAtomicInt m_valuesSequence;
 
     /*********************************************************************
      * Fixture definition
@@ -489,6 +522,48 @@ public:
      */
     bool saveXML(QXmlStreamWriter *doc) const;
 
+    /**
+     * Load a fixture's contents from a binary workspace cache.
+     *
+     * @param stream A stream positioned at a fixture written by saveBinary()
+     * @return true if the fixture was loaded successfully, otherwise false
+     */
+    bool loadBinary(QDataStream &stream, Doc* doc,
+                    const QLCFixtureDefCache* fixtureDefCache);
+
+    /**
+     * Save the fixture instance into a binary workspace cache.
+     * The stored content is the same saveXML() writes.
+     */
+    void saveBinary(QDataStream &stream) const;
+
+private:
+    /** The properties of a fixture read by loadXML or loadBinary */
+    struct LoadInfo
+    {
+        LoadInfo();
+
+        QString m_manufacturer;
+        QString m_model;
+        QString m_modeName;
+        QString m_name;
+        quint32 m_id;
+        quint32 m_universe;
+        quint32 m_address;
+        quint32 m_channels;
+        quint32 m_width, m_height;
+        QList<int> m_excludeList;
+        QList<int> m_forcedHTP;
+        QList<int> m_forcedLTP;
+        QList<quint32> m_modifierIndices;
+        QList<ChannelModifier *> m_modifierPointers;
+    };
+
+    /** Find the definition and mode described by $info and apply
+     *  them, together with the other properties of $info */
+    bool applyLoadInfo(LoadInfo &info, Doc* doc,
+                       const QLCFixtureDefCache* fixtureDefCache);
+
     /*********************************************************************
      * Status
      *********************************************************************/
@@ -56,6 +56,7 @@ void FixtureGroup::copyFrom(const FixtureGroup* grp)
     m_name = grp->name();
     m_size = grp->size();
     m_heads = grp->headsMap();
+    m_headGrid = grp->headGrid();
 }
 
 Doc* FixtureGroup::doc() const
@@ -147,6 +148,7 @@ bool FixtureGroup::assignHead(const QLCPoint& pt, const GroupHead& head)
     if (pt.isNull() == false)
     {
         m_heads[pt] = head;
+        updateHeadGrid(pt);
     }
     else
     {
@@ -165,6 +167,7 @@ bool FixtureGroup::assignHead(const QLCPoint& pt, const GroupHead& head)
                     if (m_heads.contains(tmp) == false)
                     {
                         m_heads[tmp] = head;
+                        updateHeadGrid(tmp);
                         emit changed(this->id());
                         return true;
                     }
@@ -184,7 +187,10 @@ void FixtureGroup::resignFixture(quint32 id)
     foreach (QLCPoint pt, m_heads.keys())
     {
         if (m_heads[pt].fxi == id)
+        {
             m_heads.remove(pt);
+            updateHeadGrid(pt);
+        }
     }
 
     emit changed(this->id());
@@ -195,6 +201,7 @@ bool FixtureGroup::resignHead(const QLCPoint& pt)
     if (m_heads.contains(pt) == true)
     {
         m_heads.remove(pt);
+        updateHeadGrid(pt);
         emit changed(this->id());
         return true;
     }
@@ -219,12 +226,16 @@ void FixtureGroup::swap(const QLCPoint& a, const QLCPoint& b)
     else
         m_heads.remove(a);
 
+    updateHeadGrid(a);
+    updateHeadGrid(b);
+
     emit changed(this->id());
 }
 
 void FixtureGroup::reset()
 {
     m_heads.clear();
+    rebuildHeadGrid();
     emit changed(this->id());
 }
 
@@ -243,6 +254,35 @@ QMap<QLCPoint, GroupHead> FixtureGroup::headsMap() const
     return m_heads;
 }
 
+const QVector<GroupHead> &FixtureGroup::headGrid() const
+{
+    return m_headGrid;
+}
+
+void FixtureGroup::updateHeadGrid(const QLCPoint& pt)
+{
+    if (pt.x() < 0 || pt.x() >= m_size.width() ||
+        pt.y() < 0 || pt.y() >= m_size.height())
+        return;
+
+    m_headGrid[pt.y() * m_size.width() + pt.x()] = m_heads.value(pt);
+}
+
+void FixtureGroup::rebuildHeadGrid()
+{
+    int width = qMax(0, m_size.width());
+    int height = qMax(0, m_size.height());
+
+    m_headGrid.fill(GroupHead(), width * height);
+
+    QMapIterator<QLCPoint, GroupHead> it(m_heads);
+    while (it.hasNext())
+    {
+        it.next();
+        updateHeadGrid(it.key());
+    }
+}
+
 QList <quint32> FixtureGroup::fixtureList() const
 {
     QList <quint32> list;
@@ -267,6 +307,7 @@ void FixtureGroup::slotFixtureRemoved(quint32 id)
 void FixtureGroup::setSize(const QSize& sz)
 {
     m_size = sz;
+    rebuildHeadGrid();
     emit changed(this->id());
 }
 
@@ -356,6 +397,8 @@ bool FixtureGroup::loadXML(QXmlStreamReader &xmlDoc)
         }
     }
 
+    rebuildHeadGrid();
+
     return true;
 }
 
@@ -22,6 +22,7 @@
 #define FIXTUREGROUP_H
 
 #include <QObject>
+#include <QVector>
 #include <QList>
 #include <QSize>
 #include <QMap>
@@ -167,6 +168,14 @@ public:
     /** Get the fixture head hash */
     QMap <QLCPoint,GroupHead> headsMap() const;
 
+    /**
+     * Get the fixture heads as a dense grid of size() cells, in row-major
+     * order: the head at (x, y) is at index y * size().width() + x. Cells
+     * with no head hold an invalid GroupHead. Heads placed outside size()
+     * are only found in headsMap().
+     */
+    const QVector <GroupHead>& headGrid() const;
+
     /** Get a list of fixture IDs assigned to the group */
     QList <quint32> fixtureList() const;
 
@@ -174,8 +183,16 @@ private slots:
     /** Listens to Doc fixture removals */
     void slotFixtureRemoved(quint32 id);
 
+private:
+    /** Copy the head at $pt from m_heads to m_headGrid */
+    void updateHeadGrid(const QLCPoint& pt);
+
+    /** Fill m_headGrid again from m_heads, e.g. when the size changes */
+    void rebuildHeadGrid();
+
 private:
     QMap <QLCPoint,GroupHead> m_heads;
+    QVector <GroupHead> m_headGrid;
 
     /************************************************************************
      * Size
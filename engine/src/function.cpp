@@ -29,6 +29,7 @@
 #include "qlcfile.h"
 
 #include "scriptwrapper.h"
+#include "dmxrecording.h"
 #include "mastertimer.h"
 #include "collection.h"
 #include "rgbmatrix.h"
@@ -58,6 +59,7 @@ const QString KAudioString      (      "Audio" );
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 const QString KVideoString      (      "Video" );
 #endif
+const QString KDMXRecordingString ( "DMXRecording" );
 const QString KUndefinedString  (  "Undefined" );
 
 const QString KLoopString       (       "Loop" );
@@ -89,6 +91,7 @@ Function::Function(QObject *parent)
     , m_fadeInSpeed(0)
     , m_fadeOutSpeed(0)
     , m_duration(0)
+    , m_fadeCurve(FadeCurve::Linear)
     , m_overrideFadeInSpeed(defaultSpeed())
     , m_overrideFadeOutSpeed(defaultSpeed())
     , m_overrideDuration(defaultSpeed())
@@ -100,6 +103,7 @@ Function::Function(QObject *parent)
     , m_paused(false)
     , m_lastOverrideAttributeId(OVERRIDE_ATTRIBUTE_START_ID)
     , m_preserveAttributes(false)
+    , m_attributeValues(new AttributeValues())
     , m_blendMode(Universe::NormalBlend)
 {
 
@@ -119,6 +123,7 @@ Function::Function(Doc* doc, Type t)
     , m_fadeInSpeed(0)
     , m_fadeOutSpeed(0)
     , m_duration(0)
+    , m_fadeCurve(FadeCurve::Linear)
     , m_overrideFadeInSpeed(defaultSpeed())
     , m_overrideFadeOutSpeed(defaultSpeed())
     , m_overrideDuration(defaultSpeed())
@@ -130,6 +135,7 @@ Function::Function(Doc* doc, Type t)
     , m_paused(false)
     , m_lastOverrideAttributeId(OVERRIDE_ATTRIBUTE_START_ID)
     , m_preserveAttributes(false)
+    , m_attributeValues(new AttributeValues())
     , m_blendMode(Universe::NormalBlend)
 {
     Q_ASSERT(doc != NULL);
@@ -138,6 +144,11 @@ Function::Function(Doc* doc, Type t)
 
 Function::~Function()
 {
+    AttributeValues *values = m_attributeValues.loadAcquire();
+    qDeleteAll(*values);
+    delete values;
+    qDeleteAll(m_retiredValues);
+    qDeleteAll(m_retiredValueLists);
 }
 
 Doc* Function::doc() const
@@ -179,6 +190,7 @@ bool Function::copyFrom(const Function* function)
     m_fadeInSpeed = function->fadeInSpeed();
     m_fadeOutSpeed = function->fadeOutSpeed();
     m_duration = function->duration();
+    m_fadeCurve = function->fadeCurve();
     m_path = function->path(true);
     m_visible = function->isVisible();
     m_blendMode = function->blendMode();
@@ -259,6 +271,7 @@ QString Function::typeToString(Type type)
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
         case VideoType:      return KVideoString;
 #endif
+        case DMXRecordingType: return KDMXRecordingString;
         case Undefined:
         default:
             return KUndefinedString;
@@ -289,6 +302,8 @@ Function::Type Function::stringToType(const QString& string)
     else if (string == KVideoString)
         return VideoType;
 #endif
+    else if (string == KDMXRecordingString)
+        return DMXRecordingType;
     else
         return Undefined;
 }
@@ -632,6 +647,20 @@ uint Function::duration() const
     return m_duration;
 }
 
+void Function::setFadeCurve(FadeCurve::Type curve)
+{
+    if (curve == m_fadeCurve)
+        return;
+
+    m_fadeCurve = curve;
+    emit changed(m_id);
+}
+
+FadeCurve::Type Function::fadeCurve() const
+{
+    return m_fadeCurve;
+}
+
 quint32 Function::totalDuration()
 {
     // fall back to duration in case a
@@ -793,6 +822,7 @@ bool Function::loadXMLSpeed(QXmlStreamReader &speedRoot)
     m_fadeInSpeed = attrs.value(KXMLQLCFunctionSpeedFadeIn).toString().toUInt();
     m_fadeOutSpeed = attrs.value(KXMLQLCFunctionSpeedFadeOut).toString().toUInt();
     m_duration = attrs.value(KXMLQLCFunctionSpeedDuration).toString().toUInt();
+    m_fadeCurve = FadeCurve::stringToType(attrs.value(KXMLQLCFunctionSpeedFadeCurve).toString());
 
     speedRoot.skipCurrentElement();
 
@@ -805,6 +835,8 @@ bool Function::saveXMLSpeed(QXmlStreamWriter *doc) const
     doc->writeAttribute(KXMLQLCFunctionSpeedFadeIn, QString::number(fadeInSpeed()));
     doc->writeAttribute(KXMLQLCFunctionSpeedFadeOut, QString::number(fadeOutSpeed()));
     doc->writeAttribute(KXMLQLCFunctionSpeedDuration, QString::number(duration()));
+    if (fadeCurve() != FadeCurve::Linear)
+        doc->writeAttribute(KXMLQLCFunctionSpeedFadeCurve, FadeCurve::typeToString(fadeCurve()));
     doc->writeEndElement();
 
     return true;
@@ -919,6 +951,8 @@ bool Function::loader(QXmlStreamReader &root, Doc* doc)
     else if (type == Function::VideoType)
         function = new class Video(doc);
 #endif
+    else if (type == Function::DMXRecordingType)
+        function = new class DMXRecording(doc);
     else
         return false;
 
@@ -953,6 +987,11 @@ void Function::postLoad()
     /* NOP */
 }
 
+void Function::loadDeferred()
+{
+    /* NOP */
+}
+
 bool Function::contains(quint32 functionId)
 {
     Q_UNUSED(functionId);
@@ -1007,6 +1046,10 @@ void Function::preRun(MasterTimer *timer)
     emit running(m_id);
 }
 
+void Function::prepareRun()
+{
+}
+
 void Function::write(MasterTimer *timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer);
@@ -1034,6 +1077,11 @@ void Function::postRun(MasterTimer *timer, QList<Universe *> universes)
     emit stopped(m_id);
 }
 
+QList<quint32> Function::faderUniverses() const
+{
+    return m_fadersMap.keys();
+}
+
 void Function::dismissAllFaders()
 {
     QMapIterator <quint32, QSharedPointer<GenericFader> > it(m_fadersMap);
@@ -1072,10 +1120,10 @@ quint32 Function::elapsedBeats() const
     return m_elapsedBeats;
 }
 
-void Function::resetElapsed()
+void Function::resetElapsed(quint32 phase)
 {
-    qDebug() << Q_FUNC_INFO;
-    m_elapsed = 0;
+    qDebug() << Q_FUNC_INFO << phase;
+    m_elapsed = phase;
     m_elapsedBeats = 0;
 }
 
@@ -1222,6 +1270,8 @@ bool Function::stopAndWait()
 
 int Function::registerAttribute(QString name, int flags, qreal min, qreal max, qreal value)
 {
+    QMutexLocker locker(&m_attributesMutex);
+
     for (int i = 0; i < m_attributes.count(); i++)
     {
         if (m_attributes[i].m_name == name)
@@ -1232,6 +1282,7 @@ int Function::registerAttribute(QString name, int flags, qreal min, qreal max, q
             m_attributes[i].m_flags = flags;
             m_attributes[i].m_isOverridden = false;
             m_attributes[i].m_overrideValue = 0.0;
+            publishAttributeValue(i);
             return i;
         }
     }
@@ -1245,46 +1296,55 @@ int Function::registerAttribute(QString name, int flags, qreal min, qreal max, q
     newAttr.m_overrideValue = 0.0;
     m_attributes.append(newAttr);
 
+    AttributeValues *values = new AttributeValues(*m_attributeValues.loadAcquire());
+    values->append(new AttributeValue());
+    publishAttributeValues(values);
+    publishAttributeValue(m_attributes.count() - 1);
+
     return m_attributes.count() - 1;
 }
 
 int Function::requestAttributeOverride(int attributeIndex, qreal value)
 {
-    if (attributeIndex < 0 || attributeIndex >= m_attributes.count())
-        return -1;
-
     int attributeID = invalidAttributeId();
 
-    if (m_attributes.at(attributeIndex).m_flags & Single)
     {
-        foreach (int id, m_overrideMap.keys())
+        QMutexLocker locker(&m_attributesMutex);
+
+        if (attributeIndex < 0 || attributeIndex >= m_attributes.count())
+            return -1;
+
+        if (m_attributes.at(attributeIndex).m_flags & Single)
         {
-            if (m_overrideMap[id].m_attrIndex == attributeIndex)
+            foreach (int id, m_overrideMap.keys())
             {
-                attributeID = id;
-                break;
+                if (m_overrideMap[id].m_attrIndex == attributeIndex)
+                {
+                    attributeID = id;
+                    break;
+                }
             }
         }
-    }
 
-    if (attributeID == invalidAttributeId())
-    {
-        AttributeOverride override;
-        override.m_attrIndex = attributeIndex;
-        override.m_value = 0.0;
+        if (attributeID == invalidAttributeId())
+        {
+            AttributeOverride override;
+            override.m_attrIndex = attributeIndex;
+            override.m_value = 0.0;
 
-        attributeID = m_lastOverrideAttributeId;
-        m_overrideMap[attributeID] = override;
+            attributeID = m_lastOverrideAttributeId;
+            m_overrideMap[attributeID] = override;
 
-        qDebug() << name() << "Override requested for attribute" << attributeIndex << "value" << value << "new ID" << attributeID;
+            qDebug() << name() << "Override requested for attribute" << attributeIndex << "value" << value << "new ID" << attributeID;
 
-        calculateOverrideValue(attributeIndex);
+            calculateOverrideValue(attributeIndex);
 
-        m_lastOverrideAttributeId++;
-    }
-    else
-    {
-        qDebug() << name() << "Override requested for attribute" << attributeIndex << "value" << value << "single ID" << attributeID;
+            m_lastOverrideAttributeId++;
+        }
+        else
+        {
+            qDebug() << name() << "Override requested for attribute" << attributeIndex << "value" << value << "single ID" << attributeID;
+        }
     }
 
     // actually apply the new override value
@@ -1295,6 +1355,8 @@ int Function::requestAttributeOverride(int attributeIndex, qreal value)
 
 void Function::releaseAttributeOverride(int attributeId)
 {
+    QMutexLocker locker(&m_attributesMutex);
+
     if (m_overrideMap.contains(attributeId) == false)
         return;
 
@@ -1309,11 +1371,18 @@ void Function::releaseAttributeOverride(int attributeId)
 
 bool Function::unregisterAttribute(QString name)
 {
+    QMutexLocker locker(&m_attributesMutex);
+
     for (int i = 0; i < m_attributes.count(); i++)
     {
         if (m_attributes[i].m_name == name)
         {
             m_attributes.removeAt(i);
+
+            AttributeValues *values = new AttributeValues(*m_attributeValues.loadAcquire());
+            m_retiredValues.append(values->at(i));
+            values->remove(i);
+            publishAttributeValues(values);
             return true;
         }
     }
@@ -1322,6 +1391,8 @@ bool Function::unregisterAttribute(QString name)
 
 bool Function::renameAttribute(int idx, QString newName)
 {
+    QMutexLocker locker(&m_attributesMutex);
+
     if (idx < 0 || idx >= m_attributes.count())
         return false;
     m_attributes[idx].m_name = newName;
@@ -1335,42 +1406,54 @@ int Function::adjustAttribute(qreal value, int attributeId)
         return -1;
 
     int attrIndex;
+    qreal finalValue;
 
     //qDebug() << name() << "Attribute ID:" << attributeId << ", val:" << value;
 
-    if (attributeId < OVERRIDE_ATTRIBUTE_START_ID)
     {
-        if (attributeId >= m_attributes.count() || m_attributes[attributeId].m_value == value)
-            return -1;
+        QMutexLocker locker(&m_attributesMutex);
 
-        // Adjust the original value of an attribute. Only Function editors should do this !
-        m_attributes[attributeId].m_value = CLAMP(value, m_attributes[attributeId].m_min, m_attributes[attributeId].m_max);
-        attrIndex = attributeId;
-    }
-    else
-    {
-        if (m_overrideMap.contains(attributeId) == false || m_overrideMap[attributeId].m_value == value)
-            return -1;
+        if (attributeId < OVERRIDE_ATTRIBUTE_START_ID)
+        {
+            if (attributeId >= m_attributes.count() || m_attributes[attributeId].m_value == value)
+                return -1;
+
+            // Adjust the original value of an attribute. Only Function editors should do this !
+            m_attributes[attributeId].m_value = CLAMP(value, m_attributes[attributeId].m_min, m_attributes[attributeId].m_max);
+            attrIndex = attributeId;
+            publishAttributeValue(attrIndex);
+        }
+        else
+        {
+            if (m_overrideMap.contains(attributeId) == false || m_overrideMap[attributeId].m_value == value)
+                return -1;
 
-        // Adjust an attribute override value and recalculate the final overridden value
-        m_overrideMap[attributeId].m_value = value;
-        attrIndex = m_overrideMap[attributeId].m_attrIndex;
-        calculateOverrideValue(attrIndex);
+            // Adjust an attribute override value and recalculate the final overridden value
+            m_overrideMap[attributeId].m_value = value;
+            attrIndex = m_overrideMap[attributeId].m_attrIndex;
+            calculateOverrideValue(attrIndex);
+        }
+
+        finalValue = m_attributes[attrIndex].m_isOverridden ?
+                     m_attributes[attrIndex].m_overrideValue :
+                     m_attributes[attrIndex].m_value;
     }
 
-    emit attributeChanged(attrIndex, m_attributes[attrIndex].m_isOverridden ?
-                                     m_attributes[attrIndex].m_overrideValue :
-                                     m_attributes[attrIndex].m_value);
+    // The listeners might adjust attributes in turn, so don't hold the lock
+    emit attributeChanged(attrIndex, finalValue);
 
     return attrIndex;
 }
 
 void Function::resetAttributes()
 {
+    QMutexLocker locker(&m_attributesMutex);
+
     for (int i = 0; i < m_attributes.count(); i++)
     {
         m_attributes[i].m_isOverridden = false;
         m_attributes[i].m_overrideValue = 0.0;
+        publishAttributeValue(i);
     }
     m_overrideMap.clear();
     m_lastOverrideAttributeId = OVERRIDE_ATTRIBUTE_START_ID;
@@ -1378,16 +1461,29 @@ void Function::resetAttributes()
 
 qreal Function::getAttributeValue(int attributeIndex) const
 {
-    if (attributeIndex >= m_attributes.count())
+    const AttributeValues *values = m_attributeValues.loadAcquire();
+    if (attributeIndex < 0 || attributeIndex >= values->count())
         return 0.0;
 
-    return m_attributes[attributeIndex].m_isOverridden ?
-                m_attributes[attributeIndex].m_overrideValue :
-                m_attributes[attributeIndex].m_value;
+    AttributeValue *attrValue = values->at(attributeIndex);
+    int sequence;
+    qreal value;
+
+    // Read the copy that is not being written, again if a write went on meanwhile
+    do
+    {
+        sequence = attrValue->m_sequence.loadAcquire();
+        value = attrValue->m_value[sequence & 1];
+    }
+    while (attrValue->m_sequence.testAndSetOrdered(sequence, sequence) == false);
+
+    return value;
 }
 
 int Function::getAttributeIndex(QString name) const
 {
+    QMutexLocker locker(&m_attributesMutex);
+
     for (int i = 0; i < m_attributes.count(); i++)
     {
         Attribute attr = m_attributes.at(i);
@@ -1399,6 +1495,8 @@ int Function::getAttributeIndex(QString name) const
 
 QList<Attribute> Function::attributes() const
 {
+    QMutexLocker locker(&m_attributesMutex);
+
     return m_attributes;
 }
 
@@ -1429,6 +1527,26 @@ void Function::calculateOverrideValue(int attributeIndex)
 
     m_attributes[attributeIndex].m_overrideValue = finalValue;
     m_attributes[attributeIndex].m_isOverridden = found;
+    publishAttributeValue(attributeIndex);
+}
+
+void Function::publishAttributeValue(int attributeIndex)
+{
+    const Attribute &attr = m_attributes.at(attributeIndex);
+    qreal value = attr.m_isOverridden ? attr.m_overrideValue : attr.m_value;
+    AttributeValue *attrValue = m_attributeValues.loadAcquire()->at(attributeIndex);
+
+    // Point the readers to the second copy while the first one is
+    // written, then back to the first one while the second is written
+    attrValue->m_sequence.fetchAndAddOrdered(1);
+    attrValue->m_value[0] = value;
+    attrValue->m_sequence.fetchAndAddOrdered(1);
+    attrValue->m_value[1] = value;
+}
+
+void Function::publishAttributeValues(AttributeValues *values)
+{
+    m_retiredValueLists.append(m_attributeValues.fetchAndStoreOrdered(values));
 }
 
 /*************************************************************************
@@ -22,14 +22,18 @@
 #define FUNCTION_H
 
 #include <QWaitCondition>
+#include <QAtomicPointer>
+#include <QAtomicInt>
 #include <QObject>
 #include <QString>
+#include <QVector>
 #include <QMutex>
 #include <QList>
 #include <QIcon>
 #include <QMap>
 
 #include "universe.h"
+#include "fadecurve.h"
 #include "functionparent.h"
 
 class QXmlStreamReader;
@@ -71,6 +75,7 @@ class FunctionUiState;
 #define KXMLQLCFunctionSpeedHold     "Hold"
 #define KXMLQLCFunctionSpeedFadeOut  "FadeOut"
 #define KXMLQLCFunctionSpeedDuration "Duration"
+#define KXMLQLCFunctionSpeedFadeCurve "FadeCurve"
 
 typedef struct
 {
@@ -119,6 +124,7 @@ public:
 #if QT_VERSION >= 0x050000
         , VideoType    = 1 << 9
 #endif
+        , DMXRecordingType = 1 << 10
     };
 #if QT_VERSION >= 0x050500
     Q_ENUM(Type)
@@ -483,6 +489,12 @@ public:
     /** Get the duration in milliseconds */
     uint duration() const;
 
+    /** Set the curve followed by the fades of this function */
+    void setFadeCurve(FadeCurve::Type curve);
+
+    /** Get the curve followed by the fades of this function */
+    FadeCurve::Type fadeCurve() const;
+
     /** Get the total duration in milliseconds.
      *  This differs from duration as it considers
      *  the steps or the specific Function parameters */
@@ -542,6 +554,7 @@ private:
     uint m_fadeInSpeed;
     uint m_fadeOutSpeed;
     uint m_duration;
+    FadeCurve::Type m_fadeCurve;
 
     uint m_overrideFadeInSpeed;
     uint m_overrideFadeOutSpeed;
@@ -607,6 +620,15 @@ public:
      */
     virtual void postLoad();
 
+    /**
+     * Expand the content that loadXML() has kept in its raw form to save
+     * loading time. Doc calls this for all the Functions on worker threads
+     * right before postLoad(), so implementations must touch only their own
+     * data and must tolerate being called more than once.
+     * Default implementation does nothing.
+     */
+    virtual void loadDeferred();
+
     /**
      * Check if a Function ID is included/controlled by this Function.
      * Subclasses should reimplement this.
@@ -661,6 +683,15 @@ public:
      */
     virtual void preRun(MasterTimer* timer);
 
+    /**
+     * Called by runners (e.g. a Chaser) shortly before the function is
+     * started, to resolve ahead of time what the first write() would
+     * otherwise compute. This is only a hint: the function must still
+     * work properly when started without it. Called by the MasterTimer
+     * thread, the default implementation does nothing.
+     */
+    virtual void prepareRun();
+
     /**
      * Write next values to universes. This method is called periodically
      * by the MasterTimer instance that the
@@ -693,6 +724,10 @@ public:
      */
     virtual void postRun(MasterTimer* timer, QList<Universe*> universes);
 
+    /** Return the IDs of the Universes where this Function
+     *  currently holds a GenericFader */
+    QList<quint32> faderUniverses() const;
+
 protected:
     /** Helper method to dismiss all the faders previously added to
      *  m_fadersMap. This is usually called on Function postRun when
@@ -735,8 +770,9 @@ public:
     quint32 elapsedBeats() const;
 
 protected:
-    /** Reset elapsed timer ticks to zero */
-    void resetElapsed();
+    /** Reset elapsed timer ticks to $phase milliseconds, and the
+     *  elapsed beats to zero */
+    void resetElapsed(quint32 phase = 0);
 
     /** Increment the elapsed timer ticks by one */
     void incrementElapsed();
@@ -924,7 +960,9 @@ public:
     void resetAttributes();
 
     /**
-     * Get a specific function attribute by index
+     * Get a specific function attribute by index.
+     * This never locks, so it is safe to call from the tick while
+     * other threads adjust the attributes.
      *
      * @param attributeIndex the attribute index
      * @return the requested attribute value (on error return 0.0)
@@ -949,12 +987,41 @@ public:
 protected:
     /**
      * Mark an attribute with the given $attributeIndex as overridden, and
-     * calculates the final override value according to the registered attribute flags
+     * calculates the final override value according to the registered attribute flags.
+     * m_attributesMutex must be locked.
      *
      * @param attributeIndex the attribute index
      */
     void calculateOverrideValue(int attributeIndex);
 
+private:
+    /**
+     * The final value of an attribute, as returned by getAttributeValue().
+     * Two copies are kept and the readers are pointed to the one that is
+     * not being written, so reading never waits for a writer.
+     */
+    struct AttributeValue
+    {
+        AttributeValue()
+            : m_sequence(0)
+        {
+            m_value[0] = m_value[1] = 0.0;
+        }
+
+        QAtomicInt m_sequence;
+        qreal m_value[2];
+    };
+
+    typedef QVector<AttributeValue *> AttributeValues;
+
+    /** Publish the final value of the attribute at $attributeIndex.
+     *  m_attributesMutex must be locked */
+    void publishAttributeValue(int attributeIndex);
+
+    /** Replace the published list of values when an attribute is
+     *  (un)registered. The old list is kept, as readers might still use it */
+    void publishAttributeValues(AttributeValues *values);
+
 signals:
     /** Notify the listeners that an attribute has changed */
     void attributeChanged(int index, qreal fraction);
@@ -972,6 +1039,18 @@ private:
     /** Flag to preserve or discard attributes on stop calls */
     bool m_preserveAttributes;
 
+    /** Protects the attributes and the override map. Only the threads
+     *  adjusting the attributes take it, never the readers of their values */
+    mutable QMutex m_attributesMutex;
+
+    /** The final attribute values, by attribute index */
+    QAtomicPointer<AttributeValues> m_attributeValues;
+
+    /** The value lists replaced so far, and the values of the
+     *  unregistered attributes, deleted with the Function */
+    QList<AttributeValues *> m_retiredValueLists;
+    QList<AttributeValue *> m_retiredValues;
+
     /*************************************************************************
      * Blend mode
      *************************************************************************/
@@ -29,7 +29,6 @@ GenericDMXSource::GenericDMXSource(Doc* doc)
     : m_doc(doc)
     , m_outputEnabled(false)
     , m_clearRequest(false)
-    , m_changed(false)
 {
     Q_ASSERT(m_doc != NULL);
     m_doc->masterTimer()->registerDMXSource(this);
@@ -51,14 +50,14 @@ void GenericDMXSource::set(quint32 fxi, quint32 ch, uchar value)
 {
     QMutexLocker locker(&m_mutex);
     m_values[QPair<quint32,quint32>(fxi, ch)] = value;
-    m_changed = true;
+    setChanged(true);
 }
 
 void GenericDMXSource::unset(quint32 fxi, quint32 ch)
 {
     QMutexLocker locker(&m_mutex);
     m_values.remove(QPair<quint32,quint32>(fxi, ch));
-    m_changed = true;
+    setChanged(true);
 }
 
 void GenericDMXSource::unsetAll()
@@ -66,12 +65,15 @@ void GenericDMXSource::unsetAll()
     QMutexLocker locker(&m_mutex);
     // will be processed at the next writeDMX
     m_clearRequest = true;
-    m_changed = true;
+    setChanged(true);
 }
 
 void GenericDMXSource::setOutputEnabled(bool enable)
 {
     m_outputEnabled = enable;
+    // write the values set while the output was disabled
+    if (enable)
+        setChanged(true);
 }
 
 bool GenericDMXSource::isOutputEnabled() const
@@ -106,28 +108,42 @@ void GenericDMXSource::writeDMX(MasterTimer* timer, QList<Universe *> ua)
 
     QMutexLocker locker(&m_mutex);
 
-    if (m_outputEnabled && m_changed)
+    if (m_outputEnabled)
     {
+        // Gather the values by universe, to set them in one batch per fader
+        QMap <quint32, QList<SceneValue> > universeValues;
+        quint32 lastFixtureID = Fixture::invalidId();
+        quint32 universe = Universe::invalid();
 
-        QMutableMapIterator <QPair<quint32,quint32>,uchar> it(m_values);
+        QMapIterator <QPair<quint32,quint32>,uchar> it(m_values);
         while (it.hasNext())
         {
             it.next();
-            Fixture *fixture = m_doc->fixture(it.key().first);
-            if (fixture == NULL)
+            // the values are sorted by fixture, so resolve each fixture once
+            if (it.key().first != lastFixtureID)
+            {
+                Fixture *fixture = m_doc->fixture(it.key().first);
+                lastFixtureID = it.key().first;
+                universe = fixture == NULL ? Universe::invalid() : fixture->universe();
+            }
+            if (universe == Universe::invalid())
                 continue;
 
-            quint32 universe = fixture->universe();
-            QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
+            universeValues[universe].append(SceneValue(it.key().first, it.key().second, it.value()));
+        }
+
+        QMapIterator <quint32, QList<SceneValue> > uit(universeValues);
+        while (uit.hasNext())
+        {
+            uit.next();
+            QSharedPointer<GenericFader> fader = m_fadersMap.value(uit.key(), QSharedPointer<GenericFader>());
             if (fader.isNull())
             {
-                fader = ua[universe]->requestFader();
-                m_fadersMap[universe] = fader;
+                fader = ua[uit.key()]->requestFader();
+                m_fadersMap[uit.key()] = fader;
             }
 
-            FadeChannel *fc = fader->getChannelFader(m_doc, ua[universe], fixture->id(), it.key().second);
-            fc->setCurrent(it.value());
-            fc->setTarget(it.value());
+            fader->setChannelValues(m_doc, ua[uit.key()], uit.value());
         }
     }
     if (m_clearRequest)
@@ -146,3 +162,8 @@ void GenericDMXSource::writeDMX(MasterTimer* timer, QList<Universe *> ua)
         m_fadersMap.clear();
     }
 }
+
+bool GenericDMXSource::writeOnChangeOnly() const
+{
+    return true;
+}
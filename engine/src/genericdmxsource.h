@@ -36,9 +36,9 @@ class GenericFader;
 
 /**
  * This is a generic DMX source, that registers itself to doc->masterTimer() when
- * started and unregisters when deleted. Values set with set() are written to
- * UniverseArray on each writeDMX() call (called by MasterTimer); HTP values continuously
- * and LTP values only once (after which they will be removed from m_values).
+ * started and unregisters when deleted. Values set with set() are pushed to the
+ * source faders by the writeDMX() call (called by MasterTimer) that follows the
+ * change, and the faders keep writing them on each tick.
  */
 class GenericDMXSource : public DMXSource
 {
@@ -70,13 +70,15 @@ public:
     /** @reimp */
     void writeDMX(MasterTimer* timer, QList<Universe*> ua);
 
+    /** @reimp */
+    bool writeOnChangeOnly() const;
+
 private:
     Doc *m_doc;
     QMutex m_mutex;
     QMap <QPair<quint32,quint32>,uchar> m_values;
     bool m_outputEnabled;
     bool m_clearRequest;
-    bool m_changed;
     /** Map used to lookup a GenericFader instance for a Universe ID */
     QMap<quint32, QSharedPointer<GenericFader> > m_fadersMap;
 };
@@ -17,17 +17,31 @@
   limitations under the License.
 */
 
+#include <algorithm>
 #include <cmath>
+#include <QVarLengthArray>
+#include <QMutexLocker>
 #include <QDebug>
 
 #include "genericfader.h"
 #include "fadechannel.h"
 #include "doc.h"
 
+/** The state of an address in the direct layer */
+enum LayerFlag
+{
+    LayerChannel = (1 << 0),
+    LayerIntensity = (1 << 1)
+};
+
 GenericFader::GenericFader(QObject *parent)
     : QObject(parent)
     , m_fid(Function::invalidId())
     , m_priority(Universe::Auto)
+    , m_channelsChanged(false)
+    , m_handedOverCount(0)
+    , m_layerChannelsCount(0)
+    , m_layerChanged(false)
     , m_intensity(1.0)
     , m_parentIntensity(1.0)
     , m_paused(false)
@@ -35,7 +49,11 @@ GenericFader::GenericFader(QObject *parent)
     , m_fadeOut(false)
     , m_deleteRequest(false)
     , m_blendMode(Universe::NormalBlend)
+    , m_fadeCurve(FadeCurve::Linear)
     , m_monitoring(false)
+    , m_revision(0)
+    , m_writtenRevision(-1)
+    , m_settled(false)
 {
 }
 
@@ -81,6 +99,7 @@ quint32 GenericFader::channelHash(quint32 fixtureID, quint32 channel)
 void GenericFader::add(const FadeChannel& ch)
 {
     quint32 hash = channelHash(ch.fixture(), ch.channel());
+    m_revision.ref();
 
     QHash<quint32,FadeChannel>::iterator channelIterator = m_channels.find(hash);
     if (channelIterator != m_channels.end())
@@ -92,6 +111,7 @@ void GenericFader::add(const FadeChannel& ch)
     else
     {
         m_channels.insert(hash, ch);
+        m_channelsChanged = true;
         qDebug() << "Added new fader with hash" << hash;
     }
 }
@@ -100,6 +120,8 @@ void GenericFader::replace(const FadeChannel &ch)
 {
     quint32 hash = channelHash(ch.fixture(), ch.channel());
     m_channels.insert(hash, ch);
+    m_channelsChanged = true;
+    m_revision.ref();
 }
 
 void GenericFader::remove(FadeChannel *ch)
@@ -109,12 +131,53 @@ void GenericFader::remove(FadeChannel *ch)
 
     quint32 hash = channelHash(ch->fixture(), ch->channel());
     if (m_channels.remove(hash) == 0)
+    {
         qDebug() << "No FadeChannel found with hash" << hash;
+    }
+    else
+    {
+        m_channelsChanged = true;
+        m_revision.ref();
+    }
 }
 
 void GenericFader::removeAll()
 {
     m_channels.clear();
+    m_packedChannels.clear();
+    m_channelsChanged = false;
+    m_handedOverCount = 0;
+
+    m_layerValues.clear();
+    m_layerFlags.clear();
+    m_layerRuns.clear();
+    m_layerChannelsCount = 0;
+    m_layerChanged = false;
+    m_revision.ref();
+}
+
+void GenericFader::reset()
+{
+    // drop any monitoring connection made by the previous owner
+    disconnect();
+
+    removeAll();
+    m_packedValues.clear();
+    m_packedPairs.clear();
+
+    m_name.clear();
+    m_fid = Function::invalidId();
+    m_priority = Universe::Auto;
+    m_intensity = 1.0;
+    m_parentIntensity = 1.0;
+    m_paused = false;
+    m_enabled = true;
+    m_fadeOut = false;
+    m_deleteRequest = false;
+    m_blendMode = Universe::NormalBlend;
+    m_fadeCurve = FadeCurve::Linear;
+    m_monitoring = false;
+    m_settled = false;
 }
 
 bool GenericFader::deleteRequested()
@@ -125,23 +188,50 @@ bool GenericFader::deleteRequested()
 void GenericFader::requestDelete()
 {
     m_deleteRequest = true;
+    m_revision.ref();
 }
 
 FadeChannel *GenericFader::getChannelFader(const Doc *doc, Universe *universe, quint32 fixtureID, quint32 channel)
 {
-    FadeChannel fc(doc, fixtureID, channel);
-    quint32 hash = channelHash(fc.fixture(), fc.channel());
+    // look for an existing channel first, to avoid the fixture
+    // lookup performed by the FadeChannel constructor
+    QHash<quint32,FadeChannel>::iterator channelIterator = m_channels.find(channelHash(fixtureID, channel));
+    if (channelIterator != m_channels.end())
+        return &channelIterator.value();
+
+    return getChannelFader(FadeChannel(doc, fixtureID, channel), universe);
+}
+
+FadeChannel *GenericFader::getChannelFader(const FadeChannel &channel, Universe *universe)
+{
+    quint32 hash = channelHash(channel.fixture(), channel.channel());
     QHash<quint32,FadeChannel>::iterator channelIterator = m_channels.find(hash);
     if (channelIterator != m_channels.end())
         return &channelIterator.value();
 
+    FadeChannel fc(channel);
     fc.setCurrent(universe->preGMValue(fc.address()));
 
     m_channels[hash] = fc;
+    m_channelsChanged = true;
+    m_revision.ref();
     //qDebug() << "Added new fader with hash" << hash;
     return &m_channels[hash];
 }
 
+void GenericFader::setChannelValues(const Doc *doc, Universe *universe,
+                                    const QList<SceneValue> &values, int flags)
+{
+    foreach (const SceneValue &value, values)
+    {
+        FadeChannel *fc = getChannelFader(doc, universe, value.fxi, value.channel);
+        if (flags)
+            fc->addFlag(flags);
+        fc->setCurrent(value.value);
+        fc->setTarget(value.value);
+    }
+}
+
 const QHash<quint32, FadeChannel> &GenericFader::channels() const
 {
     return m_channels;
@@ -152,54 +242,176 @@ int GenericFader::channelsCount() const
     return m_channels.count();
 }
 
+static bool addressLessThan(const FadeChannel *a, const FadeChannel *b)
+{
+    return a->addressInUniverse() < b->addressInUniverse();
+}
+
+void GenericFader::updatePackedChannels()
+{
+    m_packedChannels.resize(m_channels.count());
+    m_handedOverCount = 0;
+
+    // (re)attach the channels to this fader, since channels moved
+    // or copied by the hash don't keep their owner
+    int i = 0;
+    QMutableHashIterator <quint32,FadeChannel> it(m_channels);
+    while (it.hasNext() == true)
+    {
+        FadeChannel *fc = &it.next().value();
+        fc->m_ownerRevision = &m_revision;
+
+        // written by the crossfade target fader
+        if (fc->flags() & FadeChannel::HandedOver)
+        {
+            m_handedOverCount++;
+            continue;
+        }
+        m_packedChannels[i++] = fc;
+    }
+    m_packedChannels.resize(i);
+
+    std::stable_sort(m_packedChannels.begin(), m_packedChannels.end(), addressLessThan);
+    m_packedValues.resize(m_packedChannels.count());
+
+    // pair fine channels with their primary channel, when both can fade
+    m_packedPairs.fill(-1, m_packedChannels.count());
+    QHash<quint32, int> indices;
+    for (i = 0; i < m_packedChannels.count(); i++)
+    {
+        FadeChannel *fc = m_packedChannels.at(i);
+        indices[channelHash(fc->fixture(), fc->channel())] = i;
+    }
+
+    for (i = 0; i < m_packedChannels.count(); i++)
+    {
+        FadeChannel *fc = m_packedChannels.at(i);
+        if ((fc->flags() & FadeChannel::Fine) == 0 || fc->canFade() == false)
+            continue;
+
+        int primary = indices.value(channelHash(fc->fixture(), fc->primaryChannel()), -1);
+        if (primary == -1 || m_packedChannels.at(primary)->canFade() == false ||
+            m_packedPairs.at(primary) != -1)
+            continue;
+
+        m_packedPairs[primary] = i;
+        m_packedPairs[i] = -2;
+    }
+
+    m_channelsChanged = false;
+}
+
 void GenericFader::write(Universe *universe)
 {
+    // changes made from now on are for the next write
+    int revision = m_revision.loadAcquire();
+    bool settled = true;
+
+    if (m_channelsChanged || m_packedChannels.count() + m_handedOverCount != m_channels.count())
+        updatePackedChannels();
+
     if (m_monitoring)
-        emit preWriteData(universe->id(), universe->preGMValues());
+        universe->updateMonitorValues(m_packedChannels);
 
     qreal compIntensity = intensity() * parentIntensity();
 
-    QMutableHashIterator <quint32,FadeChannel> it(m_channels);
-    while (it.hasNext() == true)
+    if (m_layerChannelsCount)
+        writeLayer(universe, compIntensity);
+
+    int count = m_packedChannels.count();
+    FadeChannel **channels = m_packedChannels.data();
+    uchar *values = m_packedValues.data();
+    const int *pairs = m_packedPairs.constData();
+
+    // First pass: calculate the next step of every channel
+    for (int i = 0; i < count; i++)
     {
-        FadeChannel& fc(it.next().value());
-        int flags = fc.flags();
-        int address = int(fc.addressInUniverse());
-        uchar value;
-
-        // Calculate the next step
-        if (m_paused)
-            value = fc.current();
-        else
-            value = fc.nextStep(MasterTimer::tick());
-
-        // Apply intensity to channels that can fade
-        if (fc.canFade())
+        FadeChannel *fc = channels[i];
+        int pair = pairs[i];
+
+        // fine channels are calculated along with their primary channel
+        if (pair == -2)
+            continue;
+
+        if (pair >= 0)
         {
-            if ((flags & FadeChannel::CrossFade) && fc.fadeTime() == 0)
-            {
-                // morph start <-> target depending on intensities
-                value = uchar(((qreal(fc.target() - fc.start()) * intensity()) + fc.start()) * parentIntensity());
-            }
-            else if (flags & FadeChannel::Intensity)
+            FadeChannel *fine = channels[pair];
+
+            // crossfades are morphed per channel
+            if ((fc->flags() & FadeChannel::CrossFade) && fc->fadeTime() == 0)
             {
-                value = fc.current(compIntensity);
+                values[i] = stepChannel(fc, compIntensity);
+                values[pair] = stepChannel(fine, compIntensity);
+                continue;
             }
+
+            // fade the pair as a single 16 bit value
+            quint32 value16;
+            if (m_paused)
+                value16 = (quint32(fc->current()) << 8) | fine->current();
+            else
+                value16 = fc->nextStep16(*fine, MasterTimer::tick(), m_fadeCurve);
+
+            if (m_paused == false && fc->isReady() == false)
+                settled = false;
+
+            if (fc->flags() & FadeChannel::Intensity)
+                value16 = quint32(floor((qreal(value16) * compIntensity) + 0.5));
+
+            values[i] = uchar(value16 >> 8);
+            values[pair] = uchar(value16 & 0xFF);
+            continue;
         }
 
+        values[i] = stepChannel(fc, compIntensity);
+
+        if (m_paused == false && fc->isReady() == false)
+            settled = false;
+    }
+
+    // Second pass: write the values to the universe, in address order.
+    // Contiguous runs of plain channels are written with a single call
+    QList<quint32> removeList;
+    QVarLengthArray<int, 32> overrideChannels;
+    QVarLengthArray<uchar, 32> overrideValues;
+    int runStart = -1;
+
+    for (int i = 0; i <= count; i++)
+    {
+        FadeChannel *fc = i < count ? channels[i] : NULL;
+        bool plain = fc != NULL && (fc->flags() & (FadeChannel::Override | FadeChannel::Relative)) == 0;
+
+        // flush the current run, if this channel can't extend it
+        if (runStart >= 0 &&
+            (plain == false ||
+             fc->addressInUniverse() != channels[i - 1]->addressInUniverse() + 1))
+        {
+            universe->writeBlendedRange(int(channels[runStart]->addressInUniverse()),
+                                        values + runStart, i - runStart, m_blendMode);
+            runStart = -1;
+        }
+
+        if (fc == NULL)
+            break;
+
+        int flags = fc->flags();
+        int address = int(fc->addressInUniverse());
+        uchar value = values[i];
+
         //qDebug() << "[GenericFader] >>> uni:" << universe->id() << ", address:" << address << ", value:" << value << "int:" << compIntensity;
         if (flags & FadeChannel::Override)
         {
-            universe->write(address, value, true);
+            overrideChannels.append(address);
+            overrideValues.append(value);
             continue;
         }
         else if (flags & FadeChannel::Relative)
         {
             universe->writeRelative(address, value);
         }
-        else
+        else if (runStart < 0)
         {
-            universe->writeBlended(address, value, m_blendMode);
+            runStart = i;
         }
 
         if (((flags & FadeChannel::Intensity) &&
@@ -208,12 +420,28 @@ void GenericFader::write(Universe *universe)
         {
             // Remove all channels that reach their target _zero_ value.
             // They have no effect either way so removing them saves a bit of CPU.
-            if (fc.current() == 0 && fc.target() == 0 && fc.isReady())
-                it.remove();
+            if (fc->current() == 0 && fc->target() == 0 && fc->isReady())
+            {
+                removeList.append(channelHash(fc->fixture(), fc->channel()));
+                continue;
+            }
         }
 
         if (flags & FadeChannel::Autoremove)
-            it.remove();
+            removeList.append(channelHash(fc->fixture(), fc->channel()));
+    }
+
+    // overriding channels are written all at once
+    if (overrideChannels.isEmpty() == false)
+        universe->writeMultiple(overrideChannels.constData(), overrideValues.constData(),
+                                overrideChannels.count(), true);
+
+    if (removeList.isEmpty() == false)
+    {
+        foreach (quint32 hash, removeList)
+            m_channels.remove(hash);
+        m_channelsChanged = true;
+        settled = false;
     }
 
     // self-request deletion when fadeout is complete
@@ -222,6 +450,36 @@ void GenericFader::write(Universe *universe)
         m_fadeOut = false;
         requestDelete();
     }
+
+    m_settled = settled && m_fadeOut == false;
+    m_writtenRevision = revision;
+}
+
+uchar GenericFader::stepChannel(FadeChannel *fc, qreal compIntensity)
+{
+    int flags = fc->flags();
+    uchar value;
+
+    if (m_paused)
+        value = fc->current();
+    else
+        value = fc->nextStep(MasterTimer::tick(), m_fadeCurve);
+
+    // Apply intensity to channels that can fade
+    if (flags & FadeChannel::CanFade)
+    {
+        if ((flags & FadeChannel::CrossFade) && fc->fadeTime() == 0)
+        {
+            // morph start <-> target depending on intensities
+            value = uchar(((qreal(fc->target() - fc->start()) * intensity()) + fc->start()) * parentIntensity());
+        }
+        else if (flags & FadeChannel::Intensity)
+        {
+            value = fc->current(compIntensity);
+        }
+    }
+
+    return value;
 }
 
 qreal GenericFader::intensity() const
@@ -232,7 +490,11 @@ qreal GenericFader::intensity() const
 void GenericFader::adjustIntensity(qreal fraction)
 {
     //qDebug() << name() << "I FADER intensity" << fraction << ", PARENT:" << m_parentIntensity;
+    if (m_intensity == fraction)
+        return;
+
     m_intensity = fraction;
+    m_revision.ref();
 }
 
 qreal GenericFader::parentIntensity() const
@@ -243,7 +505,11 @@ qreal GenericFader::parentIntensity() const
 void GenericFader::setParentIntensity(qreal fraction)
 {
     //qDebug() << name() << "P FADER intensity" << m_intensity << ", PARENT:" << fraction;
+    if (m_parentIntensity == fraction)
+        return;
+
     m_parentIntensity = fraction;
+    m_revision.ref();
 }
 
 bool GenericFader::isPaused() const
@@ -254,6 +520,7 @@ bool GenericFader::isPaused() const
 void GenericFader::setPaused(bool paused)
 {
     m_paused = paused;
+    m_revision.ref();
 }
 
 bool GenericFader::isEnabled() const
@@ -264,6 +531,13 @@ bool GenericFader::isEnabled() const
 void GenericFader::setEnabled(bool enable)
 {
     m_enabled = enable;
+    m_revision.ref();
+}
+
+bool GenericFader::isIdle() const
+{
+    return m_settled && m_enabled && m_monitoring == false && m_deleteRequest == false &&
+           m_revision.loadAcquire() == m_writtenRevision;
 }
 
 bool GenericFader::isFadingOut() const
@@ -274,6 +548,11 @@ bool GenericFader::isFadingOut() const
 void GenericFader::setFadeOut(bool enable, uint fadeTime)
 {
     m_fadeOut = enable;
+    m_revision.ref();
+
+    // a fading out fader must go through all of its channels to be deleted
+    if (enable)
+        resetHandover();
 
     if (fadeTime)
     {
@@ -300,11 +579,107 @@ void GenericFader::setFadeOut(bool enable, uint fadeTime)
 void GenericFader::setBlendMode(Universe::BlendMode mode)
 {
     m_blendMode = mode;
+    m_revision.ref();
+}
+
+FadeCurve::Type GenericFader::fadeCurve() const
+{
+    return m_fadeCurve;
+}
+
+void GenericFader::setFadeCurve(FadeCurve::Type curve)
+{
+    m_fadeCurve = curve;
+    m_revision.ref();
 }
 
 void GenericFader::setMonitoring(bool enable)
 {
     m_monitoring = enable;
+    m_revision.ref();
+}
+
+void GenericFader::addLayerChannel(quint32 address, bool intensity)
+{
+    if (address >= UNIVERSE_SIZE)
+        return;
+
+    if (m_layerFlags.isEmpty())
+    {
+        m_layerValues.fill(0, UNIVERSE_SIZE);
+        m_layerFlags.fill(0, UNIVERSE_SIZE);
+    }
+
+    char flags = LayerChannel | (intensity ? LayerIntensity : 0);
+    if (m_layerFlags.at(int(address)) == 0)
+        m_layerChannelsCount++;
+
+    m_layerFlags[int(address)] = flags;
+    m_layerChanged = true;
+    m_revision.ref();
+}
+
+int GenericFader::layerChannelsCount() const
+{
+    return m_layerChannelsCount;
+}
+
+void GenericFader::updateLayerRuns()
+{
+    m_layerRuns.clear();
+
+    const char *flags = m_layerFlags.constData();
+    int start = -1;
+
+    for (int i = 0; i <= UNIVERSE_SIZE; i++)
+    {
+        bool used = i < UNIVERSE_SIZE && flags[i] != 0;
+
+        if (used && start < 0)
+        {
+            start = i;
+        }
+        else if (used == false && start >= 0)
+        {
+            m_layerRuns << start << i - start;
+            start = -1;
+        }
+    }
+
+    m_layerChanged = false;
+}
+
+void GenericFader::writeLayer(Universe *universe, qreal compIntensity)
+{
+    if (m_layerChanged)
+        updateLayerRuns();
+
+    const uchar *values = reinterpret_cast<const uchar *>(m_layerValues.constData());
+    const char *flags = m_layerFlags.constData();
+    bool scale = (compIntensity != 1.0);
+    uchar scaled[UNIVERSE_SIZE];
+
+    for (int r = 0; r < m_layerRuns.count(); r += 2)
+    {
+        int start = m_layerRuns.at(r);
+        int count = m_layerRuns.at(r + 1);
+        const uchar *run = values + start;
+
+        // same rounding as FadeChannel::current(intensity)
+        if (scale)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                if (flags[start + i] & LayerIntensity)
+                    scaled[i] = uchar(floor((qreal(run[i]) * compIntensity) + 0.5));
+                else
+                    scaled[i] = run[i];
+            }
+            run = scaled;
+        }
+
+        universe->writeBlendedRange(start, run, count, m_blendMode);
+    }
 }
 
 void GenericFader::resetCrossfade()
@@ -317,3 +692,84 @@ void GenericFader::resetCrossfade()
         fc.removeFlag(FadeChannel::CrossFade);
     }
 }
+
+void GenericFader::handOverChannel(quint32 fixtureID, quint32 channel)
+{
+    QHash<quint32,FadeChannel>::iterator it = m_channels.find(channelHash(fixtureID, channel));
+    if (it == m_channels.end() || (it.value().flags() & FadeChannel::HandedOver))
+        return;
+
+    it.value().addFlag(FadeChannel::HandedOver);
+    m_channelsChanged = true;
+    m_revision.ref();
+}
+
+void GenericFader::resetHandover()
+{
+    if (m_handedOverCount == 0 && m_channelsChanged == false)
+        return;
+
+    QMutableHashIterator <quint32,FadeChannel> it(m_channels);
+    while (it.hasNext() == true)
+    {
+        FadeChannel& fc(it.next().value());
+        if (fc.flags() & FadeChannel::HandedOver)
+        {
+            fc.removeFlag(FadeChannel::HandedOver);
+            m_channelsChanged = true;
+        }
+    }
+    m_revision.ref();
+}
+
+/*************************************************************************
+ * GenericFaderPool
+ *************************************************************************/
+
+GenericFaderPool::GenericFaderPool(int maxSize)
+    : m_maxSize(maxSize)
+{
+    m_faders.reserve(maxSize);
+}
+
+GenericFaderPool::~GenericFaderPool()
+{
+    qDeleteAll(m_faders);
+}
+
+QSharedPointer<GenericFader> GenericFaderPool::acquire(const QSharedPointer<GenericFaderPool> &pool)
+{
+    GenericFader *fader = NULL;
+
+    pool->m_mutex.lock();
+    if (pool->m_faders.isEmpty() == false)
+    {
+        fader = pool->m_faders.last();
+        pool->m_faders.removeLast();
+    }
+    pool->m_mutex.unlock();
+
+    if (fader == NULL)
+        fader = new GenericFader();
+
+    Recycler recycler;
+    recycler.m_pool = pool;
+    return QSharedPointer<GenericFader>(fader, recycler);
+}
+
+int GenericFaderPool::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_faders.count();
+}
+
+void GenericFaderPool::release(GenericFader *fader)
+{
+    fader->reset();
+
+    QMutexLocker locker(&m_mutex);
+    if (m_faders.count() < m_maxSize)
+        m_faders.append(fader);
+    else
+        delete fader;
+}
@@ -20,10 +20,16 @@
 #ifndef GENERICFADER
 #define GENERICFADER
 
+#include <QSharedPointer>
+#include <QAtomicInt>
 #include <QObject>
+#include <QVector>
+#include <QMutex>
 #include <QList>
 #include <QHash>
 
+#include "scenevalue.h"
+#include "fadecurve.h"
 #include "universe.h"
 
 class FadeChannel;
@@ -78,9 +84,13 @@ public:
     /** Remove a channel whose fixture & channel match with $fc's */
     void remove(FadeChannel *ch);
 
-    /** Remove all channels */
+    /** Remove all channels, including the direct layer ones */
     void removeAll();
 
+    /** Remove all channels and restore every property to its default
+     *  value, so that the fader can be recycled by a GenericFaderPool */
+    void reset();
+
     /** Get/Set a request of deletion of this fader */
     bool deleteRequested();
     void requestDelete();
@@ -90,6 +100,19 @@ public:
      *  Also, new channels will have a start value set depending on their type */
     FadeChannel *getChannelFader(const Doc *doc, Universe *universe, quint32 fixtureID, quint32 channel);
 
+    /** Same as above, but using an already detected $channel as a template
+     *  for a new FadeChannel, so that no fixture lookup is performed */
+    FadeChannel *getChannelFader(const FadeChannel &channel, Universe *universe);
+
+    /**
+     * Set a batch of fixture channels of $universe to the given values in
+     * one operation, as sources that don't fade do on every change. Each
+     * channel jumps to its value and gets $flags added. Missing channels
+     * are created as getChannelFader() does.
+     */
+    void setChannelValues(const Doc *doc, Universe *universe,
+                          const QList<SceneValue>& values, int flags = 0);
+
     /** Get all channels in a non-modifiable hashmap */
     const QHash <quint32,FadeChannel>& channels() const;
 
@@ -123,6 +146,15 @@ public:
     /** Get the fade out status of this fader */
     bool isFadingOut() const;
 
+    /**
+     * Return true if the next write() would write exactly what the last one
+     * did: every channel had reached its target and nothing has been changed
+     * since then, either through this fader or through the FadeChannels it
+     * handed out. Universe skips the frames in which all of its faders are
+     * idle.
+     */
+    bool isIdle() const;
+
     /** Set this fader to fade out. If $fadeTime is non-zero,
       * all the intensity channels will be updated */
     void setFadeOut(bool enable, uint fadeTime);
@@ -134,21 +166,95 @@ public:
      */
     void setBlendMode(Universe::BlendMode mode);
 
-    /** Enable/disable universe monitoring before writing new data */
+    /** Get/Set the curve followed by the fades of all the channels */
+    FadeCurve::Type fadeCurve() const;
+    void setFadeCurve(FadeCurve::Type curve);
+
+    /** Enable/disable universe monitoring before writing new data.
+     *  A monitored fader publishes the values found on its channels
+     *  with Universe::updateMonitorValues() */
     void setMonitoring(bool enable);
 
     void resetCrossfade();
 
-signals:
-    /** Signal emitted when monitoring is enabled.
-     *  Data is preGM and includes the whole universe */
-    void preWriteData(quint32 index, const QByteArray& universeData);
+    /**
+     * Stop writing the channel of $fixtureID at $channel, because the
+     * fader of a crossfade target morphs it from this fader's value to
+     * its own. A crossfade between two cues then computes and writes
+     * their shared channels once, in a single fader.
+     */
+    void handOverChannel(quint32 fixtureID, quint32 channel);
+
+    /** Write again all the channels handed over with handOverChannel() */
+    void resetHandover();
+
+    /**
+     * Add the channel at $address of the universe to the direct layer of
+     * this fader. Direct layer channels have no FadeChannel: their value,
+     * set with setLayerValue(), is written as it is by write(), in a single
+     * pass blended with the fader blend mode. If $intensity is true, the
+     * value is scaled by the fader intensities.
+     * Meant for Functions that never fade their channels.
+     */
+    void addLayerChannel(quint32 address, bool intensity);
+
+    /** Set the value of a channel added with addLayerChannel() */
+    inline void setLayerValue(quint32 address, uchar value)
+    {
+        if (m_layerValues.at(int(address)) == char(value))
+            return;
+
+        m_layerValues[int(address)] = char(value);
+        m_revision.ref();
+    }
+
+    /** Return the number of channels of the direct layer */
+    int layerChannelsCount() const;
+
+private:
+    /** Rebuild m_packedChannels from m_channels, sorted by address */
+    void updatePackedChannels();
+
+    /** Calculate the next value of $fc, applying the fader intensities */
+    uchar stepChannel(FadeChannel *fc, qreal compIntensity);
+
+    /** Rebuild m_layerRuns from m_layerFlags */
+    void updateLayerRuns();
+
+    /** Write the direct layer to $universe */
+    void writeLayer(Universe *universe, qreal compIntensity);
 
 private:
     QString m_name;
     quint32 m_fid;
     int m_priority;
     QHash <quint32,FadeChannel> m_channels;
+
+    /** Packed view of m_channels, sorted by address in universe.
+     *  This is what write() iterates on, so that channels are
+     *  processed in a single linear pass instead of walking the hash */
+    QVector<FadeChannel *> m_packedChannels;
+    /** Values computed for m_packedChannels in the current write() */
+    QVector<uchar> m_packedValues;
+    /** For each item of m_packedChannels, the index of its fine channel
+     *  when they are faded as a 16 bit pair, -2 for a fine channel
+     *  handled with its primary channel, -1 otherwise */
+    QVector<int> m_packedPairs;
+    /** Flag raised when m_channels has been structurally modified
+     *  and m_packedChannels needs to be rebuilt */
+    bool m_channelsChanged;
+    /** Number of HandedOver channels, left out of m_packedChannels */
+    int m_handedOverCount;
+
+    /** Values of the direct layer channels, indexed by address */
+    QByteArray m_layerValues;
+    /** LayerFlag of each address of the universe */
+    QByteArray m_layerFlags;
+    /** Contiguous runs of direct layer channels, as start/count pairs */
+    QVector<int> m_layerRuns;
+    int m_layerChannelsCount;
+    /** Flag raised when a channel has been added to the direct layer */
+    bool m_layerChanged;
     qreal m_intensity;
     qreal m_parentIntensity;
     bool m_paused;
@@ -156,7 +262,56 @@ private:
     bool m_fadeOut;
     bool m_deleteRequest;
     Universe::BlendMode m_blendMode;
+    FadeCurve::Type m_fadeCurve;
     bool m_monitoring;
+
+    /** Incremented by every change that can modify what write() writes,
+     *  including the changes made to the channels of m_channels */
+    QAtomicInt m_revision;
+    /** The value of m_revision when the last write() started */
+    int m_writtenRevision;
+    /** Flag raised when all the channels had reached their target
+     *  at the end of the last write() */
+    bool m_settled;
+};
+
+/**
+ * A pool of GenericFader instances, so that Functions starting and stopping
+ * continuously (e.g. fast Chasers) don't allocate a new fader every time.
+ *
+ * Faders returned by acquire() are wrapped in a QSharedPointer whose deleter
+ * gives them back to the pool once the last reference is dropped.
+ * The pool itself is reference counted by the same deleters, so recycled
+ * faders can safely outlive the Universe that requested them.
+ */
+class GenericFaderPool
+{
+public:
+    GenericFaderPool(int maxSize);
+    ~GenericFaderPool();
+
+    /** Get a fader from $pool, or a new one if the pool is empty */
+    static QSharedPointer<GenericFader> acquire(const QSharedPointer<GenericFaderPool> &pool);
+
+    /** Return the number of faders available for recycling */
+    int count() const;
+
+private:
+    /** Reset $fader and keep it for the next acquire(), or delete it
+     *  when the pool is full */
+    void release(GenericFader *fader);
+
+    /** The QSharedPointer deleter that returns faders to a pool */
+    struct Recycler
+    {
+        QSharedPointer<GenericFaderPool> m_pool;
+        void operator()(GenericFader *fader) const { m_pool->release(fader); }
+    };
+
+private:
+    mutable QMutex m_mutex;
+    QVector<GenericFader *> m_faders;
+    int m_maxSize;
 };
 
 /** @} */
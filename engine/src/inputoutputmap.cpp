@@ -31,8 +31,14 @@
 #include <qmath.h>
 
 #include "inputoutputmap.h"
+#include "timecodetracker.h"
+#include "audiocapture.h"
+#include "beattracker.h"
+#include "feedbackqueue.h"
 #include "qlcinputchannel.h"
 #include "qlcinputsource.h"
+#include "latencytracer.h"
+#include "universepool.h"
 #include "qlcioplugin.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
@@ -42,14 +48,44 @@
 #include "doc.h"
 
 #include "../../plugins/midi/src/common/midiprotocol.h"
+#include "../../plugins/os2l/os2lplugin.h"
+
+#define SETTINGS_UNIVERSE_POOL "inputoutputmap/universepool"
 
 InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
   : QObject(doc)
   , m_blackout(false)
   , m_universeChanged(false)
+  , m_latencyTracer(new LatencyTracer())
+  , m_universePool(NULL)
+  , m_universeLock(QReadWriteLock::Recursive)
+  , m_frameUniverses(0)
+  , m_frameDumps(0)
+  , m_feedbackQueue(NULL)
+  , m_beatGeneratorType(Disabled)
+  , m_currentBPM(0)
   , m_beatTime(new QElapsedTimer())
+  , m_beatCapture(NULL)
+  , m_beatTracker(new BeatTracker())
+  , m_timecodeSource(NoTimecode)
+  , m_timecodeTime(new QElapsedTimer())
+  , m_timecodeTracker(new TimecodeTracker())
+  , m_timecodeCapture(NULL)
 {
+    m_timecodeTime->start();
+    m_mtcFields[0] = m_mtcFields[1] = m_mtcFields[2] = 0;
+
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_UNIVERSE_POOL);
+    if (var.isValid() && var.toBool() == true)
+    {
+        m_universePool = new UniversePool();
+        connect(doc->masterTimer(), SIGNAL(tickReady()),
+                m_universePool, SLOT(tick()), Qt::DirectConnection);
+    }
+
     m_grandMaster = new GrandMaster(this);
+    m_feedbackQueue = new FeedbackQueue(this);
     for (quint32 i = 0; i < universes; i++)
         addUniverse();
 
@@ -61,8 +97,13 @@ InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
 InputOutputMap::~InputOutputMap()
 {
     removeAllUniverses();
+    delete m_universePool;
+    delete m_latencyTracer;
     delete m_grandMaster;
     delete m_beatTime;
+    delete m_beatTracker;
+    delete m_timecodeTime;
+    delete m_timecodeTracker;
 }
 
 Doc* InputOutputMap::doc() const
@@ -132,7 +173,7 @@ quint32 InputOutputMap::invalidUniverse()
 bool InputOutputMap::addUniverse(quint32 id)
 {
     {
-        QMutexLocker locker(&m_universeMutex);
+        QWriteLocker locker(&m_universeLock);
         Universe *uni = NULL;
 
         if (id == InputOutputMap::invalidUniverse())
@@ -154,16 +195,26 @@ bool InputOutputMap::addUniverse(quint32 id)
             while (id > universesCount())
             {
                 uni = new Universe(universesCount(), m_grandMaster);
-                connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
+                uni->setLatencyTracer(m_latencyTracer);
+                if (m_universePool == NULL)
+                    connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
                 connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
+                connect(uni, SIGNAL(frameDumped()), this, SLOT(slotUniverseFrameDumped()), Qt::DirectConnection);
                 m_universeArray.append(uni);
             }
         }
 
         uni = new Universe(id, m_grandMaster);
-        connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
+        uni->setLatencyTracer(m_latencyTracer);
+        if (m_universePool == NULL)
+            connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
         connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
+        connect(uni, SIGNAL(frameDumped()), this, SLOT(slotUniverseFrameDumped()), Qt::DirectConnection);
         m_universeArray.append(uni);
+        updateFrameUniverses();
+
+        if (m_universePool != NULL)
+            m_universePool->setUniverses(m_universeArray);
     }
 
     emit universeAdded(id);
@@ -173,7 +224,7 @@ bool InputOutputMap::addUniverse(quint32 id)
 bool InputOutputMap::removeUniverse(int index)
 {
     {
-        QMutexLocker locker(&m_universeMutex);
+        QWriteLocker locker(&m_universeLock);
 
         if (index < 0 || index >= m_universeArray.count())
             return false;
@@ -185,27 +236,53 @@ bool InputOutputMap::removeUniverse(int index)
             return false;
         }
 
-        delete  m_universeArray.takeAt(index);
+        Universe *uni = m_universeArray.takeAt(index);
+        updateFrameUniverses();
+
+        // make sure the pool is done with the universe before deleting it
+        if (m_universePool != NULL)
+            m_universePool->setUniverses(m_universeArray);
+
+        delete uni;
     }
 
+    // a universe added later would get the feedback left over
+    m_feedbackQueue->clear(index);
+
     emit universeRemoved(index);
     return true;
 }
 
 bool InputOutputMap::removeAllUniverses()
 {
-    QMutexLocker locker(&m_universeMutex);
+    QWriteLocker locker(&m_universeLock);
+    if (m_universePool != NULL)
+        m_universePool->setUniverses(QList<Universe *>());
+    for (int i = 0; i < m_universeArray.count(); i++)
+        m_feedbackQueue->clear(i);
     qDeleteAll(m_universeArray);
     m_universeArray.clear();
+    updateFrameUniverses();
     return true;
 }
 
 void InputOutputMap::startUniverses()
 {
+    if (m_universePool != NULL)
+    {
+        m_universePool->start();
+        return;
+    }
+
     foreach (Universe *uni, m_universeArray)
         uni->start();
 }
 
+bool InputOutputMap::universePool() const
+{
+    return m_universePool != NULL;
+}
+
 quint32 InputOutputMap::getUniverseID(int index)
 {
     if (index >= 0 && index < m_universeArray.count())
@@ -248,6 +325,20 @@ bool InputOutputMap::getUniversePassthrough(int index)
     return m_universeArray.at(index)->passthrough();
 }
 
+void InputOutputMap::setUniversePassthroughMerge(int index, int merge)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return;
+    m_universeArray.at(index)->setPassthroughMerge(Universe::PassthroughMerge(merge));
+}
+
+int InputOutputMap::getUniversePassthroughMerge(int index)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return Universe::HTPMerge;
+    return m_universeArray.at(index)->passthroughMerge();
+}
+
 void InputOutputMap::setUniverseMonitor(int index, bool enable)
 {
     if (index < 0 || index >= m_universeArray.count())
@@ -270,6 +361,77 @@ bool InputOutputMap::isUniversePatched(int index)
     return m_universeArray.at(index)->isPatched();
 }
 
+QVariantMap InputOutputMap::universeStatistics(int index)
+{
+    QVariantMap stats;
+
+    if (index < 0 || index >= m_universeArray.count())
+        return stats;
+
+    Universe::Statistics uniStats = m_universeArray.at(index)->statistics();
+    stats.insert("writes", uniStats.writes);
+    stats.insert("htpRejects", uniStats.htpRejects);
+    stats.insert("faders", uniStats.faders);
+    stats.insert("fadeChannels", uniStats.fadeChannels);
+    stats.insert("processTime", uniStats.processTime);
+
+    return stats;
+}
+
+QVariantList InputOutputMap::latencyStatistics() const
+{
+    QVariantList list;
+
+    foreach (LatencyTracer::PairStatistics pairStats, m_latencyTracer->statistics())
+    {
+        QVariantMap stats;
+        stats.insert("input", pairStats.input);
+        stats.insert("output", pairStats.output);
+        stats.insert("samples", pairStats.samples);
+        stats.insert("p50", pairStats.p50);
+        stats.insert("p90", pairStats.p90);
+        stats.insert("p99", pairStats.p99);
+        stats.insert("max", pairStats.max);
+        list.append(stats);
+    }
+
+    return list;
+}
+
+void InputOutputMap::resetLatencyStatistics()
+{
+    m_latencyTracer->reset();
+}
+
+void InputOutputMap::updateFrameUniverses()
+{
+    m_frameUniverses.storeRelease(m_universeArray.count());
+    m_frameDumps.storeRelease(0);
+}
+
+void InputOutputMap::slotUniverseFrameDumped()
+{
+    int universes = m_frameUniverses.loadAcquire();
+    if (universes == 0)
+        return;
+
+    // the counter always stays below the number of universes, so a
+    // universe already dumping the next frame is counted for that one
+    int dumps, next;
+    do
+    {
+        dumps = m_frameDumps.loadAcquire();
+        next = dumps + 1 >= universes ? 0 : dumps + 1;
+    } while (m_frameDumps.testAndSetOrdered(dumps, next) == false);
+
+    if (next != 0)
+        return;
+
+    // deferred plugins have nothing patched, so they are left alone
+    foreach (QLCIOPlugin *plugin, doc()->ioPluginCache()->initializedPlugins())
+        plugin->frameComplete();
+}
+
 quint32 InputOutputMap::universesCount() const
 {
     return (quint32)m_universeArray.count();
@@ -291,20 +453,20 @@ Universe *InputOutputMap::universe(quint32 id)
 
 QList<Universe*> InputOutputMap::claimUniverses()
 {
-    m_universeMutex.lock();
+    m_universeLock.lockForRead();
     return m_universeArray;
 }
 
 void InputOutputMap::releaseUniverses(bool changed)
 {
     m_universeChanged = changed;
-    m_universeMutex.unlock();
+    m_universeLock.unlock();
 }
 
 void InputOutputMap::resetUniverses()
 {
     {
-        QMutexLocker locker(&m_universeMutex);
+        QReadLocker locker(&m_universeLock);
         for (int i = 0; i < m_universeArray.size(); i++)
             m_universeArray.at(i)->reset();
     }
@@ -384,7 +546,7 @@ uchar InputOutputMap::grandMasterValue()
 
 void InputOutputMap::flushInputs()
 {
-    QMutexLocker locker(&m_universeMutex);
+    QReadLocker locker(&m_universeLock);
     foreach (Universe *universe, m_universeArray)
         universe->flushInput();
 }
@@ -399,7 +561,7 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
         return false;
     }
 
-    QMutexLocker locker(&m_universeMutex);
+    QReadLocker locker(&m_universeLock);
     InputPatch *currInPatch = m_universeArray.at(universe)->inputPatch();
     QLCInputProfile *currProfile = NULL;
     if (currInPatch != NULL)
@@ -411,12 +573,23 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
         {
             disconnect(currInPatch, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                        this, SLOT(slotMIDIBeat(quint32,quint32,uchar)));
+            disconnect(currInPatch->plugin(), SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
+                       this, SLOT(slotMIDITimecode(quint32,quint32,quint32,uchar,QString)));
+        }
+        else if (currInPatch->pluginName() == "OS2L")
+        {
+            disconnect(currInPatch->plugin(), SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
+                       this, SLOT(slotOS2LValueChanged(quint32,quint32,quint32,uchar,QString)));
         }
     }
     InputPatch *ip = NULL;
+    QLCIOPlugin *plugin = doc()->ioPluginCache()->plugin(pluginName);
+
+    if (plugin != NULL)
+        doc()->ioPluginCache()->setPluginUsed(pluginName);
 
     if (m_universeArray.at(universe)->setInputPatch(
-                doc()->ioPluginCache()->plugin(pluginName), input,
+                plugin, input,
                 profile(profileName)) == true)
     {
         ip = m_universeArray.at(universe)->inputPatch();
@@ -428,6 +601,15 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
             {
                 connect(ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                         this, SLOT(slotMIDIBeat(quint32,quint32,uchar)));
+                connect(plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
+                        this, SLOT(slotMIDITimecode(quint32,quint32,quint32,uchar,QString)),
+                        Qt::UniqueConnection);
+            }
+            else if (ip->pluginName() == "OS2L")
+            {
+                connect(plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
+                        this, SLOT(slotOS2LValueChanged(quint32,quint32,quint32,uchar,QString)),
+                        Qt::UniqueConnection);
             }
         }
     }
@@ -470,13 +652,17 @@ bool InputOutputMap::setOutputPatch(quint32 universe, const QString &pluginName,
         return false;
     }
 
-    QMutexLocker locker(&m_universeMutex);
+    QLCIOPlugin *plugin = doc()->ioPluginCache()->plugin(pluginName);
+    if (plugin != NULL)
+        doc()->ioPluginCache()->setPluginUsed(pluginName);
+
+    QReadLocker locker(&m_universeLock);
     if (isFeedback == false)
         return m_universeArray.at(universe)->setOutputPatch(
-                    doc()->ioPluginCache()->plugin(pluginName), output, index);
+                    plugin, output, index);
     else
         return m_universeArray.at(universe)->setFeedbackPatch(
-                    doc()->ioPluginCache()->plugin(pluginName), output);
+                    plugin, output);
 
     return false;
 }
@@ -692,7 +878,7 @@ bool InputOutputMap::sendFeedBack(quint32 universe, quint32 channel, uchar value
 
     if (patch != NULL && patch->isPatched())
     {
-        patch->plugin()->sendFeedBack(universe, patch->output(), channel, value, key);
+        m_feedbackQueue->enqueue(universe, channel, value, key);
         return true;
     }
     else
@@ -701,9 +887,19 @@ bool InputOutputMap::sendFeedBack(quint32 universe, quint32 channel, uchar value
     }
 }
 
+void InputOutputMap::beginFeedbackBatch()
+{
+    m_feedbackQueue->beginBatch();
+}
+
+void InputOutputMap::endFeedbackBatch()
+{
+    m_feedbackQueue->endBatch();
+}
+
 void InputOutputMap::slotPluginConfigurationChanged(QLCIOPlugin* plugin)
 {
-    QMutexLocker locker(&m_universeMutex);
+    QReadLocker locker(&m_universeLock);
     bool success = true;
     for (quint32 i = 0; i < universesCount(); i++)
     {
@@ -741,27 +937,24 @@ void InputOutputMap::loadProfiles(const QDir& dir)
     if (dir.exists() == false || dir.isReadable() == false)
         return;
 
-    /* Go thru all found file entries and attempt to load an input
-       profile from each of them. */
+    /* Go thru all found file entries and index the input profile
+       of each of them. The channels are parsed on first access. */
     QStringListIterator it(dir.entryList());
     while (it.hasNext() == true)
     {
-        QLCInputProfile* prof;
-        QString path;
+        ProfileFile file;
+        QString name;
 
-        path = dir.absoluteFilePath(it.next());
-        prof = QLCInputProfile::loader(path);
-        if (prof != NULL)
+        file.m_path = dir.absoluteFilePath(it.next());
+        if (QLCInputProfile::loadHeader(file.m_path, name, file.m_type) == true)
         {
             /* Check for duplicates */
-            if (profile(prof->name()) == NULL)
-                addProfile(prof);
-            else
-                delete prof;
+            if (m_profileFiles.contains(name) == false && loadedProfile(name) == NULL)
+                m_profileFiles.insert(name, file);
         }
         else
         {
-            qWarning() << Q_FUNC_INFO << "Unable to find an input profile from" << path;
+            qWarning() << Q_FUNC_INFO << "Unable to find an input profile from" << file.m_path;
         }
     }
 }
@@ -772,10 +965,46 @@ QStringList InputOutputMap::profileNames()
     QListIterator <QLCInputProfile*> it(m_profiles);
     while (it.hasNext() == true)
         list << it.next()->name();
+    list << m_profileFiles.keys();
     return list;
 }
 
 QLCInputProfile* InputOutputMap::profile(const QString& name)
+{
+    QLCInputProfile* prof = loadedProfile(name);
+    if (prof != NULL || m_profileFiles.contains(name) == false)
+        return prof;
+
+    QString path = m_profileFiles.take(name).m_path;
+    prof = QLCInputProfile::loader(path);
+    if (prof == NULL)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to load an input profile from" << path;
+        return NULL;
+    }
+
+    /* The file might have changed since it was indexed */
+    if (loadedProfile(prof->name()) == NULL)
+        addProfile(prof);
+    else
+        delete prof;
+
+    return loadedProfile(name);
+}
+
+QLCInputProfile::Type InputOutputMap::profileType(const QString& name)
+{
+    if (m_profileFiles.contains(name))
+        return m_profileFiles[name].m_type;
+
+    QLCInputProfile* prof = loadedProfile(name);
+    if (prof != NULL)
+        return prof->type();
+
+    return QLCInputProfile::MIDI;
+}
+
+QLCInputProfile* InputOutputMap::loadedProfile(const QString& name) const
 {
     QListIterator <QLCInputProfile*> it(m_profiles);
     while (it.hasNext() == true)
@@ -795,6 +1024,8 @@ bool InputOutputMap::addProfile(QLCInputProfile* profile)
     /* Don't add the same profile twice */
     if (m_profiles.contains(profile) == false)
     {
+        /* The added profile replaces an indexed file with the same name */
+        m_profileFiles.remove(profile->name());
         m_profiles.append(profile);
         return true;
     }
@@ -806,6 +1037,9 @@ bool InputOutputMap::addProfile(QLCInputProfile* profile)
 
 bool InputOutputMap::removeProfile(const QString& name)
 {
+    if (m_profileFiles.remove(name) > 0)
+        return true;
+
     QMutableListIterator <QLCInputProfile*> it(m_profiles);
     while (it.hasNext() == true)
     {
@@ -876,7 +1110,7 @@ bool InputOutputMap::inputSourceNames(const QLCInputSource *src,
         ushort page = src->page();
         ushort channel = (src->channel() & 0x0000FFFF);
 
-        ich = profile->channel(channel);
+        ich = pat->profileChannel(channel);
         if (ich != NULL)
             name = ich->name();
         else
@@ -918,6 +1152,9 @@ void InputOutputMap::setBeatGeneratorType(InputOutputMap::BeatGeneratorType type
     if (type == m_beatGeneratorType)
         return;
 
+    if (m_beatGeneratorType == Audio)
+        stopAudioBeatDetection();
+
     m_beatGeneratorType = type;
     qDebug() << "[InputOutputMap] setting beat type:" << m_beatGeneratorType;
 
@@ -938,6 +1175,19 @@ void InputOutputMap::setBeatGeneratorType(InputOutputMap::BeatGeneratorType type
             // reset the current BPM number and detect it from the audio input
             setBpmNumber(0);
             m_beatTime->restart();
+            startAudioBeatDetection();
+        break;
+        case OS2L:
+        {
+            // the OS2L beats only keep the internal generator in phase,
+            // so that beats are predicted instead of following the network
+            doc()->masterTimer()->setBeatSourceType(MasterTimer::Internal);
+            setBpmNumber(0);
+            QSettings settings;
+            m_beatTracker->reset();
+            m_beatTracker->setLatency(settings.value(OS2L_SETTINGS_BEAT_LATENCY, 0).toInt());
+            m_beatTime->restart();
+        }
         break;
         case Disabled:
         default:
@@ -978,7 +1228,7 @@ int InputOutputMap::bpmNumber() const
 
 void InputOutputMap::slotMasterTimerBeat()
 {
-    if (m_beatGeneratorType != Internal)
+    if (m_beatGeneratorType != Internal && m_beatGeneratorType != OS2L)
         return;
 
     emit beat();
@@ -989,7 +1239,8 @@ void InputOutputMap::slotMIDIBeat(quint32 universe, quint32 channel, uchar value
     Q_UNUSED(universe)
 
     // not interested in synthetic release event or non-MBC ones
-    if (m_beatGeneratorType != MIDI || value == 0 || channel < CHANNEL_OFFSET_MBC_PLAYBACK)
+    if (m_beatGeneratorType != MIDI || value == 0 ||
+        channel < CHANNEL_OFFSET_MBC_PLAYBACK || channel > CHANNEL_OFFSET_MBC_STOP)
         return;
 
     qDebug() << "MIDI MBC:" << channel << m_beatTime->elapsed();
@@ -1015,12 +1266,199 @@ void InputOutputMap::slotMIDIBeat(quint32 universe, quint32 channel, uchar value
     }
 }
 
-void InputOutputMap::slotAudioSpectrum(double *spectrumBands, int size, double maxMagnitude, quint32 power)
+void InputOutputMap::startAudioBeatDetection()
+{
+    QSharedPointer<AudioCapture> capture(doc()->audioInputCapture());
+    m_beatCapture = capture.data();
+
+    // the request is handled right away on the capture thread,
+    // the tempo changes are then followed on the main thread
+    connect(m_beatCapture, SIGNAL(beatDetected(int,int)),
+            this, SLOT(slotAudioBeatDetected(int,int)), Qt::DirectConnection);
+    connect(m_beatCapture, SIGNAL(beatDetected(int,int)),
+            this, SLOT(slotAudioBeat(int,int)), Qt::QueuedConnection);
+
+    m_beatCapture->setBeatDetection(true);
+    // the spectrum is processed only while some bands are registered
+    m_beatCapture->registerBandsNumber(FREQ_SUBBANDS_DEFAULT_NUMBER);
+}
+
+void InputOutputMap::stopAudioBeatDetection()
+{
+    QSharedPointer<AudioCapture> capture(doc()->audioInputCapture());
+    if (capture.data() == m_beatCapture)
+    {
+        disconnect(m_beatCapture, SIGNAL(beatDetected(int,int)), this, NULL);
+        m_beatCapture->setBeatDetection(false);
+        m_beatCapture->unregisterBandsNumber(FREQ_SUBBANDS_DEFAULT_NUMBER);
+    }
+    m_beatCapture = NULL;
+}
+
+void InputOutputMap::slotAudioBeatDetected(int bpm, int delay)
+{
+    Q_UNUSED(bpm)
+
+    doc()->masterTimer()->requestBeat(delay);
+}
+
+void InputOutputMap::slotAudioBeat(int bpm, int delay)
+{
+    Q_UNUSED(delay)
+
+    if (m_beatGeneratorType != Audio)
+        return;
+
+    // follow the tempo only when it really changed,
+    // not on the small jitter of the detected onsets
+    if (bpm != 0 && qAbs(bpm - m_currentBPM) > 1)
+        setBpmNumber(bpm);
+
+    emit beat();
+}
+
+void InputOutputMap::slotOS2LValueChanged(quint32 universe, quint32 input, quint32 channel,
+                                          uchar value, const QString &key)
+{
+    Q_UNUSED(universe)
+    Q_UNUSED(input)
+    Q_UNUSED(key)
+
+    if (m_beatGeneratorType != OS2L || channel != OS2L_BEAT_CHANNEL || value == 0)
+        return;
+
+    qint64 timestamp = m_beatTime->elapsed();
+
+    if (m_beatTracker->addBeat(timestamp) == false)
+    {
+        qDebug() << "[InputOutputMap] OS2L beat dropped as jitter";
+        return;
+    }
+
+    if (m_beatTracker->isLocked() == false)
+        return;
+
+    // follow the tempo only when it really changed
+    int bpm = qRound(m_beatTracker->bpm());
+    if (qAbs(bpm - m_currentBPM) > 1)
+        setBpmNumber(bpm);
+
+    doc()->masterTimer()->alignBeat(m_beatTracker->beatDelay(timestamp));
+}
+
+/*********************************************************************
+ * Timecode
+ *********************************************************************/
+
+void InputOutputMap::setTimecodeSource(InputOutputMap::TimecodeSourceType type)
+{
+    if (type == m_timecodeSource)
+        return;
+
+    if (m_timecodeSource == LTCTimecode)
+        stopLTCDecoding();
+
+    {
+        QMutexLocker locker(&m_timecodeMutex);
+        m_timecodeSource = type;
+        m_timecodeTracker->reset();
+    }
+
+    qDebug() << "[InputOutputMap] setting timecode source:" << m_timecodeSource;
+
+    if (m_timecodeSource == LTCTimecode)
+        startLTCDecoding();
+
+    emit timecodeSourceChanged();
+}
+
+InputOutputMap::TimecodeSourceType InputOutputMap::timecodeSource() const
+{
+    return m_timecodeSource;
+}
+
+qint64 InputOutputMap::timecodePosition(quint32 *relocations)
+{
+    QMutexLocker locker(&m_timecodeMutex);
+
+    if (relocations != NULL)
+        *relocations = m_timecodeTracker->relocations();
+
+    if (m_timecodeSource == NoTimecode)
+        return -1;
+
+    return m_timecodeTracker->position(m_timecodeTime->elapsed());
+}
+
+void InputOutputMap::addTimecode(qint64 position, int delay)
+{
+    QMutexLocker locker(&m_timecodeMutex);
+
+    // the timecode ran on while the frame was on its way
+    if (m_timecodeTracker->addTimecode(position + delay, m_timecodeTime->elapsed()) == false)
+        qDebug() << "[InputOutputMap] timecode relocated to" << position + delay;
+}
+
+void InputOutputMap::startLTCDecoding()
 {
-    Q_UNUSED(spectrumBands)
-    Q_UNUSED(size)
-    Q_UNUSED(maxMagnitude)
-    Q_UNUSED(power)
+    QSharedPointer<AudioCapture> capture(doc()->audioInputCapture());
+    m_timecodeCapture = capture.data();
+
+    connect(m_timecodeCapture, SIGNAL(timecodeDecoded(qint64,int)),
+            this, SLOT(slotLTCTimecode(qint64,int)), Qt::DirectConnection);
+
+    m_timecodeCapture->setTimecodeDecoding(true);
+    // the audio is captured only while some bands are registered
+    m_timecodeCapture->registerBandsNumber(FREQ_SUBBANDS_DEFAULT_NUMBER);
+}
+
+void InputOutputMap::stopLTCDecoding()
+{
+    QSharedPointer<AudioCapture> capture(doc()->audioInputCapture());
+    if (capture.data() == m_timecodeCapture)
+    {
+        disconnect(m_timecodeCapture, SIGNAL(timecodeDecoded(qint64,int)), this, NULL);
+        m_timecodeCapture->setTimecodeDecoding(false);
+        m_timecodeCapture->unregisterBandsNumber(FREQ_SUBBANDS_DEFAULT_NUMBER);
+    }
+    m_timecodeCapture = NULL;
+}
+
+void InputOutputMap::slotMIDITimecode(quint32 universe, quint32 input, quint32 channel,
+                                      uchar value, const QString &key)
+{
+    Q_UNUSED(universe)
+    Q_UNUSED(input)
+    Q_UNUSED(key)
+
+    if (m_timecodeSource != MIDITimecode ||
+        channel < CHANNEL_OFFSET_MTC_FRAMES || channel > CHANNEL_OFFSET_MTC_HOURS)
+        return;
+
+    // the hours come last and complete the frame
+    if (channel != CHANNEL_OFFSET_MTC_HOURS)
+    {
+        m_mtcFields[channel - CHANNEL_OFFSET_MTC_FRAMES] = value;
+        return;
+    }
+
+    static const int rates[] = { 24, 25, 30, 30 };
+    int rateCode = (value >> 5) & 0x03;
+    int fps = rates[rateCode];
+
+    qint64 position = TimecodeTracker::timecodeToMsecs(value & 0x1F, m_mtcFields[2], m_mtcFields[1],
+                                                       m_mtcFields[0], fps, rateCode == 2);
+
+    // the frame is complete with its last quarter frame, 1.75 frames after its time
+    addTimecode(position, (7 * 1000) / (4 * fps));
+}
+
+void InputOutputMap::slotLTCTimecode(qint64 position, int delay)
+{
+    if (m_timecodeSource != LTCTimecode)
+        return;
+
+    addTimecode(position, delay);
 }
 
 /*********************************************************************
@@ -1057,6 +1495,11 @@ void InputOutputMap::loadDefaults()
         if (passthrough == true)
             m_universeArray.at(i)->setPassthrough(passthrough);
 
+        key = QString("/inputmap/universe%1/passthroughmerge/").arg(i);
+        if (settings.contains(key))
+            m_universeArray.at(i)->setPassthroughMerge(
+                        Universe::stringToPassthroughMerge(settings.value(key).toString()));
+
         /* Do the mapping */
         if (plugin != KInputNone && input != KInputNone)
             setInputPatch(i, plugin, input.toUInt(), profileName);
@@ -1131,6 +1574,13 @@ void InputOutputMap::saveDefaults()
             settings.setValue(key, passthrough);
         else
             settings.remove(key);
+
+        key = QString("/inputmap/universe%1/passthroughmerge/").arg(i);
+        Universe::PassthroughMerge merge = m_universeArray.at(i)->passthroughMerge();
+        if (passthrough == true && merge != Universe::HTPMerge)
+            settings.setValue(key, Universe::passthroughMergeToString(merge));
+        else
+            settings.remove(key);
     }
 
     /* ************************ OUTPUT *********************************** */
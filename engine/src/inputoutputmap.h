@@ -20,9 +20,12 @@
 #ifndef INPUTOUTPUTMAP_H
 #define INPUTOUTPUTMAP_H
 
+#include <QReadWriteLock>
 #include <QSharedPointer>
+#include <QAtomicInt>
 #include <QObject>
 #include <QMutex>
+#include <QMap>
 #include <QDir>
 
 #include "qlcinputprofile.h"
@@ -32,7 +35,13 @@ class QXmlStreamReader;
 class QXmlStreamWriter;
 class QLCInputSource;
 class QElapsedTimer;
+class AudioCapture;
 class QLCIOPlugin;
+class TimecodeTracker;
+class LatencyTracer;
+class BeatTracker;
+class FeedbackQueue;
+class UniversePool;
 class OutputPatch;
 class InputPatch;
 class Universe;
@@ -163,10 +172,18 @@ public:
     bool removeAllUniverses();
 
     /**
-     * Start all the Universe threads
+     * Start all the Universe threads, or the universe pool
+     * workers if the universes are processed by a pool
      */
     void startUniverses();
 
+    /**
+     * Return true if the universes are processed by a pool of worker
+     * threads instead of a thread each. This is decided at construction,
+     * from the "inputoutputmap/universepool" setting.
+     */
+    bool universePool() const;
+
     /**
      * Get the unique ID of the universe at the given index
      * @param index The universe index
@@ -209,6 +226,21 @@ public:
      */
     bool getUniversePassthrough(int index);
 
+    /**
+     * Set how the input is merged with the output of the universe at the
+     * given index, in passthrough mode
+     * @param index The universe index
+     * @param merge A Universe::PassthroughMerge
+     */
+    void setUniversePassthroughMerge(int index, int merge);
+
+    /**
+     * Retrieve how the input is merged in the universe at the given index
+     * @param index The universe index
+     * @return A Universe::PassthroughMerge
+     */
+    int getUniversePassthroughMerge(int index);
+
     /**
      * Enable/disable the monitor mode for the universe with the given index
      * @param index The universe index
@@ -231,6 +263,27 @@ public:
      */
     bool isUniversePatched(int index);
 
+    /**
+     * Retrieve the engine counters of the universe at the given index,
+     * referring to the last processed tick. The returned map contains
+     * the "writes", "htpRejects", "faders", "fadeChannels" and
+     * "processTime" (in microseconds) keys.
+     * @param index The universe index
+     * @return A map of counters, or an empty map if index is invalid
+     */
+    QVariantMap universeStatistics(int index);
+
+    /**
+     * Retrieve the latencies measured between the input universes and
+     * the changes of the output universes, in milliseconds. Each item
+     * is a map with the "input" and "output" universe indices, the number
+     * of "samples" and the "p50", "p90", "p99" and "max" latencies.
+     */
+    QVariantList latencyStatistics() const;
+
+    /** Discard all the measured input/output latencies */
+    void resetLatencyStatistics();
+
     /**
      * Retrieve the number of universes in the input/output map
      */
@@ -250,6 +303,10 @@ public:
     /**
      * Claim access to a universe. This is declared virtual to make
      * unit testing a bit easier.
+     *
+     * Access is shared: several threads can claim the universes at the
+     * same time (e.g. the MasterTimer tick and an editor), and only the
+     * addition or removal of a universe waits for all of them to release.
      */
     virtual QList<Universe*> claimUniverses();
 
@@ -278,8 +335,30 @@ private:
     /** When true, universes are dumped. Otherwise not. */
     bool m_universeChanged;
 
-    /** Mutex guarding m_universeArray */
-    QMutex m_universeMutex;
+    /** The latency tracer shared by all universes */
+    LatencyTracer *m_latencyTracer;
+
+    /** The workers processing the universes, or NULL if each
+     *  universe runs its own thread */
+    UniversePool *m_universePool;
+
+    /** Lock guarding m_universeArray. Read access is taken to use the
+     *  universes, write access to add or remove them */
+    QReadWriteLock m_universeLock;
+
+    /** The number of universes dumping a frame at each tick, and how
+     *  many of them did it for the current frame */
+    QAtomicInt m_frameUniverses;
+    QAtomicInt m_frameDumps;
+
+    /** Update m_frameUniverses after the universe list has changed.
+     *  Must be called with m_universeLock locked for writing */
+    void updateFrameUniverses();
+
+private slots:
+    /** Count the universes dumping their frame, and notify the plugins
+     *  with frameComplete() when all of them did it */
+    void slotUniverseFrameDumped();
 
     /*********************************************************************
      * Grand Master
@@ -501,9 +580,26 @@ public:
     /**
      * Send feedback value to the input profile e.g. to move a motorized
      * sliders & knobs, set indicator leds etc.
+     * The value is queued and coalesced with the other pending values
+     * of the same channel, see FeedbackQueue.
+     *
+     * @return true if the universe has a feedback line to send the value to
      */
     bool sendFeedBack(quint32 universe, quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Hold the feedback sent from now on until the matching
+     * endFeedbackBatch(), so that it goes out as a single batch
+     * (e.g. when a VC frame page changes)
+     */
+    void beginFeedbackBatch();
+
+    /** Release the feedback held since beginFeedbackBatch() */
+    void endFeedbackBatch();
+
+private:
+    FeedbackQueue *m_feedbackQueue;
+
 private slots:
    /** Slot that catches plugin configuration change notifications from UIPluginCache */
     void slotPluginConfigurationChanged(QLCIOPlugin* plugin);
@@ -522,15 +618,20 @@ signals:
      * Input profiles
      *************************************************************************/
 public:
-    /** Load all input profiles from the given directory using QDir filters */
+    /** Index all input profiles in the given directory using QDir filters.
+        Only their names and types are read: each profile is fully parsed
+        the first time it is requested with profile() */
     void loadProfiles(const QDir& dir);
 
     /** Get a list of available profile names */
     QStringList profileNames();
 
-    /** Get a profile by its name */
+    /** Get a profile by its name, parsing it if it was only indexed so far */
     QLCInputProfile* profile(const QString& name);
 
+    /** Get the type of a profile by its name, without parsing it */
+    QLCInputProfile::Type profileType(const QString& name);
+
     /** Add a new profile */
     bool addProfile(QLCInputProfile* profile);
 
@@ -568,9 +669,23 @@ public:
     static QDir userProfileDirectory();
 
 private:
-    /** List that contains all available profiles */
+    /** Get a profile that has already been parsed, by its name */
+    QLCInputProfile* loadedProfile(const QString& name) const;
+
+private:
+    /** List that contains all the parsed profiles */
     QList <QLCInputProfile*> m_profiles;
 
+    /** A profile file that has been indexed but not parsed yet */
+    struct ProfileFile
+    {
+        QString m_path;
+        QLCInputProfile::Type m_type;
+    };
+
+    /** The indexed profile files, by profile name */
+    QMap <QString, ProfileFile> m_profileFiles;
+
     /*********************************************************************
      * Beats
      *********************************************************************/
@@ -580,7 +695,8 @@ public:
         Disabled,   //! No one is generating beats
         Internal,   //! MasterTimer is the beat generator
         MIDI,       //! A MIDI plugin is the beat generator
-        Audio       //! An audio input device is the beat generator
+        Audio,      //! An audio input device is the beat generator
+        OS2L        //! An OS2L client (DJ software) is the beat generator
     };
 
     void setBeatGeneratorType(BeatGeneratorType type);
@@ -589,10 +705,26 @@ public:
     void setBpmNumber(int bpm);
     int bpmNumber() const;
 
+private:
+    /** Start/stop detecting beats on the audio input capture */
+    void startAudioBeatDetection();
+    void stopAudioBeatDetection();
+
 protected slots:
     void slotMasterTimerBeat();
     void slotMIDIBeat(quint32 universe, quint32 channel, uchar value);
-    void slotAudioSpectrum(double *spectrumBands, int size, double maxMagnitude, quint32 power);
+
+    /** Called directly from the audio capture thread, to request
+     *  the beat to MasterTimer with the lowest latency */
+    void slotAudioBeatDetected(int bpm, int delay);
+
+    /** Called in the main thread to follow the audio tempo */
+    void slotAudioBeat(int bpm, int delay);
+
+    /** Called directly by the OS2L plugin, to timestamp the
+     *  beats before they are buffered by the input patch */
+    void slotOS2LValueChanged(quint32 universe, quint32 input, quint32 channel,
+                              uchar value, const QString& key);
 
 signals:
     void beatGeneratorTypeChanged();
@@ -603,6 +735,65 @@ private:
     BeatGeneratorType m_beatGeneratorType;
     int m_currentBPM;
     QElapsedTimer *m_beatTime;
+    /** The audio capture detecting beats when m_beatGeneratorType is Audio */
+    AudioCapture *m_beatCapture;
+    /** The filter of the beats received when m_beatGeneratorType is OS2L */
+    BeatTracker *m_beatTracker;
+
+    /*********************************************************************
+     * Timecode
+     *********************************************************************/
+public:
+    enum TimecodeSourceType
+    {
+        NoTimecode,     //! No external timecode is followed
+        MIDITimecode,   //! MIDI Timecode received by the MIDI plugin
+        LTCTimecode     //! LTC decoded from the audio input
+    };
+
+    void setTimecodeSource(TimecodeSourceType type);
+    TimecodeSourceType timecodeSource() const;
+
+    /**
+     * Get the position of the external timecode in milliseconds, or -1
+     * when no timecode is being received. If $relocations is not NULL,
+     * it is set to the number of times the timecode has been relocated,
+     * so that the callers can tell a jump of the position from its
+     * normal run. Can be called from any thread.
+     */
+    qint64 timecodePosition(quint32 *relocations = NULL);
+
+private:
+    /** Feed the tracker with a frame at $position, received $delay ms late */
+    void addTimecode(qint64 position, int delay);
+
+    /** Start/stop decoding LTC on the audio input capture */
+    void startLTCDecoding();
+    void stopLTCDecoding();
+
+protected slots:
+    /** Called directly by the MIDI plugin, to timestamp the timecode
+     *  frames before they are buffered by the input patch */
+    void slotMIDITimecode(quint32 universe, quint32 input, quint32 channel,
+                          uchar value, const QString& key);
+
+    /** Called directly from the audio capture thread when a LTC frame is decoded */
+    void slotLTCTimecode(qint64 position, int delay);
+
+signals:
+    void timecodeSourceChanged();
+
+private:
+    TimecodeSourceType m_timecodeSource;
+    /** The clock the timecode frames are timestamped with */
+    QElapsedTimer *m_timecodeTime;
+    /** The filter of the received timecode, protected by m_timecodeMutex */
+    TimecodeTracker *m_timecodeTracker;
+    QMutex m_timecodeMutex;
+    /** The frames, seconds and minutes of the MIDI Timecode frame being received */
+    uchar m_mtcFields[3];
+    /** The audio capture decoding LTC when m_timecodeSource is LTCTimecode */
+    AudioCapture *m_timecodeCapture;
 
     /*********************************************************************
      * Defaults
@@ -26,6 +26,7 @@
 #include <QDebug>
 
 #include "qlcinputchannel.h"
+#include "latencytracer.h"
 #include "qlcioplugin.h"
 #include "inputpatch.h"
 
@@ -40,6 +41,7 @@ InputPatch::InputPatch(QObject *parent)
     , m_universe(UINT_MAX)
     , m_plugin(NULL)
     , m_pluginLine(QLCIOPlugin::invalidLine())
+    , m_synchronous(false)
     , m_profile(NULL)
     , m_nextPageCh(USHRT_MAX)
     , m_prevPageCh(USHRT_MAX)
@@ -53,6 +55,7 @@ InputPatch::InputPatch(quint32 inputUniverse, QObject* parent)
     , m_universe(inputUniverse)
     , m_plugin(NULL)
     , m_pluginLine(QLCIOPlugin::invalidLine())
+    , m_synchronous(false)
     , m_profile(NULL)
     , m_nextPageCh(USHRT_MAX)
     , m_prevPageCh(USHRT_MAX)
@@ -83,12 +86,16 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         disconnect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
                    this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+        disconnect(m_plugin, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                   this, SLOT(slotUniverseChanged(quint32,quint32,QByteArray,QByteArray)));
         m_plugin->closeInput(m_pluginLine, m_universe);
     }
 
     m_plugin = plugin;
     m_pluginLine = input;
     m_profile = profile;
+    m_synchronous = m_plugin != NULL && (m_plugin->capabilities() & QLCIOPlugin::Synchronous);
+    compileProfile();
 
     if (m_plugin != NULL)
     {
@@ -102,8 +109,14 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     /* Open the assigned plugin input */
     if (m_plugin != NULL && m_pluginLine != QLCIOPlugin::invalidLine())
     {
+        // the input buffers are thread safe, so the values are stored
+        // right away in the thread of the plugin that received them
         connect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
-                this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+                this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)),
+                Qt::DirectConnection);
+        connect(m_plugin, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                this, SLOT(slotUniverseChanged(quint32,quint32,QByteArray,QByteArray)),
+                Qt::DirectConnection);
         result = m_plugin->openInput(m_pluginLine, m_universe);
 
         if (m_profile != NULL)
@@ -118,6 +131,7 @@ bool InputPatch::set(QLCInputProfile *profile)
         return false;
 
     m_profile = profile;
+    compileProfile();
 
     if (m_profile != NULL)
         setProfilePageControls();
@@ -221,6 +235,16 @@ void InputPatch::slotValueChanged(quint32 universe, quint32 input, quint32 chann
     {
         if (universe == UINT_MAX || universe == m_universe)
         {
+            if (m_inputTime.loadAcquire() == 0)
+                m_inputTime.testAndSetOrdered(0, LatencyTracer::now());
+
+            // most of the values are plain DMX channels
+            if (channel < INPUT_TABLE_SIZE && key.isEmpty())
+            {
+                storeTableValue(channel, value);
+                return;
+            }
+
             QMutexLocker inputBufferLocker(&m_inputBufferMutex);
             InputValue val(value, key);
             if (m_inputBuffer.contains(channel))
@@ -244,45 +268,159 @@ void InputPatch::slotValueChanged(quint32 universe, quint32 input, quint32 chann
     }
 }
 
-void InputPatch::setProfilePageControls()
+void InputPatch::slotUniverseChanged(quint32 universe, quint32 input,
+                                     const QByteArray &data, const QByteArray &changed)
 {
-    if (m_profile != NULL)
+    if (input != m_pluginLine || (universe != UINT_MAX && universe != m_universe))
+        return;
+
+    int count = qMin(data.size(), changed.size() * 8);
+    const uchar *values = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *mask = reinterpret_cast<const uchar *>(changed.constData());
+    bool received = false;
+
+    for (int i = 0; i < count; i += 8)
     {
-        if (m_plugin != NULL)
+        uchar bits = mask[i / 8];
+        for (int channel = i; bits != 0 && channel < count; channel++, bits >>= 1)
         {
-            QMap<QString, QVariant> settings = m_profile->globalSettings();
-            if (settings.isEmpty() == false)
+            if ((bits & 1) == 0)
+                continue;
+
+            if (received == false)
             {
-                QMapIterator <QString,QVariant> it(settings);
-                while (it.hasNext() == true)
-                {
-                    it.next();
-                    m_plugin->setParameter(m_universe, m_pluginLine, QLCIOPlugin::Input, it.key(), it.value());
-                }
+                if (m_inputTime.loadAcquire() == 0)
+                    m_inputTime.testAndSetOrdered(0, LatencyTracer::now());
+                received = true;
+            }
+
+            if (channel < INPUT_TABLE_SIZE)
+            {
+                storeTableValue(quint32(channel), values[channel]);
+                continue;
             }
+
+            QMutexLocker inputBufferLocker(&m_inputBufferMutex);
+            InputValue const& curVal = m_inputBuffer.value(channel, InputValue(0, QString()));
+            // Every ON/OFF changes must pass through
+            if (m_inputBuffer.contains(channel) && curVal.value != values[channel] &&
+                (curVal.value == 0 || values[channel] == 0))
+                    emit inputValueChanged(m_universe, channel, curVal.value, curVal.key);
+            m_inputBuffer.insert(channel, InputValue(values[channel], QString()));
         }
-        QMapIterator <quint32,QLCInputChannel*> it(m_profile->channels());
-        while (it.hasNext() == true)
+    }
+
+    if (received && m_synchronous)
+        emit inputFrameReceived();
+}
+
+void InputPatch::storeTableValue(quint32 channel, uchar value)
+{
+    // keep the latest value and mark it as pending
+    uchar prevValue = uchar(m_inputTable[channel].fetchAndStoreOrdered(value));
+    int bit = 1 << (channel % 32);
+    bool pending = m_inputDirty[channel / 32].fetchAndOrOrdered(bit) & bit;
+
+    // Every ON/OFF changes must pass through
+    if (pending && prevValue != value && (prevValue == 0 || value == 0))
+        emit inputValueChanged(m_universe, channel, prevValue, QString());
+}
+
+void InputPatch::setProfilePageControls()
+{
+    if (m_profile != NULL && m_plugin != NULL)
+    {
+        QMap<QString, QVariant> settings = m_profile->globalSettings();
+        if (settings.isEmpty() == false)
         {
-            it.next();
-            QLCInputChannel *ch = it.value();
-            if (ch != NULL)
+            QMapIterator <QString,QVariant> it(settings);
+            while (it.hasNext() == true)
             {
-                if (m_nextPageCh == USHRT_MAX && ch->type() == QLCInputChannel::NextPage)
-                    m_nextPageCh = m_profile->channelNumber(ch);
-                else if (m_prevPageCh == USHRT_MAX && ch->type() == QLCInputChannel::PrevPage)
-                    m_prevPageCh = m_profile->channelNumber(ch);
-                else if (m_pageSetCh == USHRT_MAX && ch->type() == QLCInputChannel::PageSet)
-                    m_pageSetCh = m_profile->channelNumber(ch);
+                it.next();
+                m_plugin->setParameter(m_universe, m_pluginLine, QLCIOPlugin::Input, it.key(), it.value());
             }
         }
     }
 }
 
+/*****************************************************************************
+ * Profile channels
+ *****************************************************************************/
+
+QLCInputChannel *InputPatch::profileChannel(quint32 channel) const
+{
+    if (channel < quint32(m_profileChannels.size()))
+        return m_profileChannels.at(channel);
+
+    // channels past the table, if any, are looked up in the profile
+    if (m_profile != NULL && channel >= PROFILE_TABLE_SIZE)
+        return m_profile->channel(channel);
+
+    return NULL;
+}
+
+void InputPatch::compileProfile()
+{
+    m_profileChannels.clear();
+    m_nextPageCh = m_prevPageCh = m_pageSetCh = USHRT_MAX;
+
+    if (m_profile == NULL)
+        return;
+
+    QMap <quint32,QLCInputChannel*> channels = m_profile->channels();
+
+    // the map is sorted, so the table size comes from the highest
+    // channel number that fits in it
+    QMap <quint32,QLCInputChannel*>::const_iterator last = channels.lowerBound(PROFILE_TABLE_SIZE);
+    if (last != channels.constBegin())
+        m_profileChannels.fill(NULL, int((last - 1).key()) + 1);
+
+    QMapIterator <quint32,QLCInputChannel*> it(channels);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        QLCInputChannel *ch = it.value();
+        if (ch == NULL)
+            continue;
+
+        if (it.key() < quint32(m_profileChannels.size()))
+            m_profileChannels[it.key()] = ch;
+
+        if (m_nextPageCh == USHRT_MAX && ch->type() == QLCInputChannel::NextPage)
+            m_nextPageCh = it.key();
+        else if (m_prevPageCh == USHRT_MAX && ch->type() == QLCInputChannel::PrevPage)
+            m_prevPageCh = it.key();
+        else if (m_pageSetCh == USHRT_MAX && ch->type() == QLCInputChannel::PageSet)
+            m_pageSetCh = it.key();
+    }
+}
+
+int InputPatch::takeInputTime()
+{
+    return m_inputTime.fetchAndStoreOrdered(0);
+}
+
 void InputPatch::flush(quint32 universe)
 {
     if (universe == UINT_MAX || universe == m_universe)
     {
+        for (int i = 0; i < INPUT_TABLE_SIZE / 32; i++)
+        {
+            if (m_inputDirty[i].loadAcquire() == 0)
+                continue;
+
+            quint32 bits = quint32(m_inputDirty[i].fetchAndStoreOrdered(0));
+            for (int bit = 0; bits != 0; bit++, bits >>= 1)
+            {
+                if ((bits & 1) == 0)
+                    continue;
+
+                quint32 channel = quint32(i * 32 + bit);
+                emit inputValueChanged(m_universe, channel,
+                                       uchar(m_inputTable[channel].loadAcquire()), QString());
+            }
+        }
+
         QMutexLocker inputBufferLocker(&m_inputBufferMutex);
         for (QHash<quint32, InputValue>::const_iterator it = m_inputBuffer.begin(); it != m_inputBuffer.end(); ++it)
         {
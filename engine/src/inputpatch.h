@@ -20,14 +20,22 @@
 #ifndef INPUTPATCH_H
 #define INPUTPATCH_H
 
+#include <QAtomicInt>
 #include <QObject>
 #include <QMap>
 #include <QMutex>
+#include <QVector>
 
 #include "qlcinputprofile.h"
 
 class QLCIOPlugin;
 
+/** Number of channels buffered without locking, one whole DMX universe */
+#define INPUT_TABLE_SIZE 512
+
+/** Profile channels up to this number are looked up in a dense table */
+#define PROFILE_TABLE_SIZE 65536
+
 /** @addtogroup engine Engine
  * @{
  */
@@ -131,15 +139,24 @@ signals:
     void pluginNameChanged();
     void profileNameChanged();
 
+    /** Emitted right after a whole frame has been received from a plugin
+     *  with the Synchronous capability, in the thread that wrote it */
+    void inputFrameReceived();
+
 private slots:
     void slotValueChanged(quint32 universe, quint32 input,
                           quint32 channel, uchar value, const QString& key = 0);
+    void slotUniverseChanged(quint32 universe, quint32 input,
+                             const QByteArray& data, const QByteArray& changed);
 
 private:
     /** The reference of the plugin associated by this Input patch */
     QLCIOPlugin* m_plugin;
     /** The plugin line open by this Input patch */
     quint32 m_pluginLine;
+
+    /** Flag raised when the plugin has the Synchronous capability */
+    bool m_synchronous;
     /** The reference of an input profile if activated by the user (otherwise NULL) */
     QLCInputProfile* m_profile;
     /** The patch parameters cache */
@@ -154,9 +171,31 @@ private:
 private:
     ushort m_nextPageCh, m_prevPageCh, m_pageSetCh;
 
+    /************************************************************************
+     * Profile channels
+     ************************************************************************/
+public:
+    /** Return the profile channel with the given number, or NULL if there's no
+     *  profile or the profile doesn't define it. This is meant to be used on
+     *  every input or feedback value, so it's a table lookup */
+    QLCInputChannel *profileChannel(quint32 channel) const;
+
+private:
+    /** Build m_profileChannels and the page controls from the current profile */
+    void compileProfile();
+
+private:
+    /** The profile channels indexed by channel number, up to the highest
+     *  channel of the profile below PROFILE_TABLE_SIZE */
+    QVector<QLCInputChannel *> m_profileChannels;
+
 public:
     void flush(quint32 universe);
 
+    /** Return the LatencyTracer::now() time of the earliest value
+     *  received since the last call, or 0 if none has been received */
+    int takeInputTime();
+
     struct InputValue
     {
         InputValue() {}
@@ -168,6 +207,21 @@ public:
         QString key;
     };
 
+private:
+    /** Store the latest $value of a channel below INPUT_TABLE_SIZE and
+     *  mark it as pending, without blocking the plugin */
+    void storeTableValue(quint32 channel, uchar value);
+
+private:
+    /** Latest value of the channels below INPUT_TABLE_SIZE and the bitmap of
+     *  the ones not flushed yet. These are written without locking */
+    QAtomicInt m_inputTable[INPUT_TABLE_SIZE];
+    QAtomicInt m_inputDirty[INPUT_TABLE_SIZE / 32];
+
+    /** The arrival time of the earliest value not taken yet, or 0 */
+    QAtomicInt m_inputTime;
+
+    /** Values of the other channels and of the ones with a key */
     QMutex m_inputBufferMutex;
     QHash<quint32, InputValue> m_inputBuffer;
 };
@@ -19,7 +19,9 @@
 
 #include <QCoreApplication>
 #include <QPluginLoader>
+#include <QElapsedTimer>
 #include <QSettings>
+#include <QThread>
 #include <QDebug>
 
 #if defined(WIN32) || defined(Q_OS_WIN)
@@ -34,6 +36,33 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
+/**
+ * Thread running the init() of a single plugin. The plugin is moved to the
+ * thread before it starts, so that the objects created by init() with the
+ * plugin as parent get the right thread affinity, and then moved back to
+ * $target, together with them, once init() is done.
+ */
+class IOPluginInitThread : public QThread
+{
+public:
+    IOPluginInitThread(QLCIOPlugin *plugin, QThread *target)
+        : m_plugin(plugin)
+        , m_target(target)
+    {
+    }
+
+protected:
+    void run()
+    {
+        m_plugin->init();
+        m_plugin->moveToThread(m_target);
+    }
+
+private:
+    QLCIOPlugin *m_plugin;
+    QThread *m_target;
+};
+
 IOPluginCache::IOPluginCache(QObject* parent)
     : QObject(parent)
 {
@@ -41,6 +70,12 @@ IOPluginCache::IOPluginCache(QObject* parent)
 
 IOPluginCache::~IOPluginCache()
 {
+    if (m_usedPlugins.isEmpty() == false)
+    {
+        QSettings settings;
+        settings.setValue(SETTINGS_STARTUP_PLUGINS, m_usedPlugins);
+    }
+
     while (m_plugins.isEmpty() == false)
         delete m_plugins.takeFirst();
 }
@@ -54,7 +89,7 @@ void IOPluginCache::load(const QDir& dir)
         return;
 
     QSettings settings;
-    QVariant hotplug = settings.value(SETTINGS_HOTPLUG);
+    QStringList startup = settings.value(SETTINGS_STARTUP_PLUGINS).toStringList();
 
     /* Loop through all files in the directory */
     QStringListIterator it(dir.entryList());
@@ -73,19 +108,15 @@ void IOPluginCache::load(const QDir& dir)
         if (ptr != NULL)
         {
             /* Check for duplicates */
-            if (plugin(ptr->name()) == NULL)
+            if (findPlugin(ptr->name()) == NULL)
             {
-                /* New plugin. Append and init. */
+                /* New plugin. Append, init() is deferred. */
                 qDebug() << "Loaded I/O plugin" << ptr->name() << "from" << fileName;
                 emit pluginLoaded(ptr->name());
-                ptr->init();
                 m_plugins << ptr;
+                m_deferred << ptr;
                 connect(ptr, SIGNAL(configurationChanged()),
                         this, SLOT(slotConfigurationChanged()));
-#if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
-                if (hotplug.isValid() && hotplug.toBool() == true)
-                    HotPlugMonitor::connectListener(ptr);
-#endif
                 // QLCi18n::loadTranslation(p->name().replace(" ", "_"));
             }
             else
@@ -103,14 +134,94 @@ void IOPluginCache::load(const QDir& dir)
             loader.unload();
         }
     }
+
+    /* Bring up the plugins needed by the last session right away */
+    initPlugins(startup);
 }
 
-QList <QLCIOPlugin*> IOPluginCache::plugins() const
+QList <QLCIOPlugin*> IOPluginCache::plugins()
 {
+    if (m_deferred.isEmpty() == false)
+    {
+        QStringList names;
+        foreach (QLCIOPlugin *ptr, m_deferred)
+            names << ptr->name();
+        initPlugins(names);
+    }
+
     return m_plugins;
 }
 
-QLCIOPlugin* IOPluginCache::plugin(const QString& name) const
+QList <QLCIOPlugin*> IOPluginCache::initializedPlugins() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_initialized;
+}
+
+QLCIOPlugin* IOPluginCache::plugin(const QString& name)
+{
+    QLCIOPlugin* ptr = findPlugin(name);
+
+    if (ptr != NULL && m_deferred.contains(ptr))
+        initPlugins(QStringList() << name);
+
+    return ptr;
+}
+
+void IOPluginCache::initPlugins(const QStringList& names)
+{
+    QList <IOPluginInitThread*> threads;
+    QList <QLCIOPlugin*> plugins;
+    QElapsedTimer timer;
+    timer.start();
+
+    foreach (QString name, names)
+    {
+        QLCIOPlugin* ptr = findPlugin(name);
+        if (ptr == NULL || m_deferred.contains(ptr) == false)
+            continue;
+
+        m_deferred.remove(ptr);
+        plugins << ptr;
+
+        IOPluginInitThread *initThread = new IOPluginInitThread(ptr, thread());
+        ptr->moveToThread(initThread);
+        initThread->start();
+        threads << initThread;
+    }
+
+    if (plugins.isEmpty())
+        return;
+
+    foreach (IOPluginInitThread *thread, threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+
+    QSettings settings;
+    QVariant hotplug = settings.value(SETTINGS_HOTPLUG);
+
+    foreach (QLCIOPlugin *ptr, plugins)
+    {
+#if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
+        if (hotplug.isValid() && hotplug.toBool() == true)
+            HotPlugMonitor::connectListener(ptr);
+#endif
+        QMutexLocker locker(&m_mutex);
+        m_initialized << ptr;
+    }
+
+    qDebug() << "Initialized" << plugins.count() << "I/O plugins in" << timer.elapsed() << "ms";
+}
+
+void IOPluginCache::setPluginUsed(const QString& name)
+{
+    if (name.isEmpty() == false && m_usedPlugins.contains(name) == false)
+        m_usedPlugins << name;
+}
+
+QLCIOPlugin* IOPluginCache::findPlugin(const QString& name) const
 {
     QListIterator <QLCIOPlugin*> it(m_plugins);
     while (it.hasNext() == true)
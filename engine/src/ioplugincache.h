@@ -20,17 +20,30 @@
 #ifndef IOPLUGINCACHE_H
 #define IOPLUGINCACHE_H
 
+#include <QStringList>
 #include <QObject>
+#include <QMutex>
 #include <QDir>
+#include <QSet>
 
 class QLCIOPlugin;
 
 #define SETTINGS_HOTPLUG "inputmanager/hotplug"
+#define SETTINGS_STARTUP_PLUGINS "inputmanager/startupplugins"
 
 /** @addtogroup engine Engine
  * @{
  */
 
+/**
+ * IOPluginCache loads the I/O plugins and initializes them lazily, since
+ * QLCIOPlugin::init() often enumerates hardware or network interfaces.
+ *
+ * The plugins patched during the previous session are initialized when
+ * they are loaded, concurrently. The others are initialized the first time
+ * they are looked up by name (e.g. when a workspace patches them) or when
+ * the whole list is requested, typically by the I/O manager UI.
+ */
 class IOPluginCache : public QObject
 {
     Q_OBJECT
@@ -42,11 +55,22 @@ public:
     /** Load plugins from the given directory. */
     void load(const QDir& dir);
 
-    /** Get a list of available I/O plugins. */
-    QList <QLCIOPlugin*> plugins() const;
+    /** Get a list of available I/O plugins, initializing them all. */
+    QList <QLCIOPlugin*> plugins();
+
+    /** Get the list of the plugins initialized so far, without
+     *  initializing the others. This is safe to call from any thread */
+    QList <QLCIOPlugin*> initializedPlugins() const;
+
+    /** Get an I/O plugin by its name, initializing it if needed. */
+    QLCIOPlugin* plugin(const QString& name);
 
-    /** Get an I/O plugin by its name. */
-    QLCIOPlugin* plugin(const QString& name) const;
+    /** Initialize the loaded plugins named in $names, concurrently */
+    void initPlugins(const QStringList& names);
+
+    /** Record that the plugin $name is patched, so that it is
+     *  initialized at load time on the next startup */
+    void setPluginUsed(const QString& name);
 
     /** Get the system plugin directory. */
     static QDir systemPluginDirectory();
@@ -59,7 +83,22 @@ private slots:
     void slotConfigurationChanged();
 
 private:
+    /** Get a loaded plugin by name, initialized or not */
+    QLCIOPlugin* findPlugin(const QString& name) const;
+
+private:
+    /** All the loaded plugins */
     QList <QLCIOPlugin*> m_plugins;
+
+    /** The plugins not initialized yet */
+    QSet <QLCIOPlugin*> m_deferred;
+
+    /** The plugins initialized so far, guarded by m_mutex */
+    QList <QLCIOPlugin*> m_initialized;
+    mutable QMutex m_mutex;
+
+    /** The plugins patched during this session */
+    QStringList m_usedPlugins;
 };
 
 /** @} */
@@ -0,0 +1,144 @@
+/*
+  Q Light Controller Plus
+  latencytracer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include "latencytracer.h"
+
+LatencyTracer::LatencyTracer()
+{
+}
+
+LatencyTracer::~LatencyTracer()
+{
+}
+
+static QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+int LatencyTracer::now()
+{
+    static const QElapsedTimer clock = startedClock();
+
+    return int(clock.elapsed()) + 1;
+}
+
+quint64 LatencyTracer::pairKey(quint32 input, quint32 output)
+{
+    return (quint64(input) << 32) | output;
+}
+
+void LatencyTracer::inputFlushed(quint32 input, int timestamp)
+{
+    if (timestamp == 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    m_inputs.insert(input);
+
+    // keep the earliest time for the outputs that didn't change yet
+    foreach (quint32 output, m_outputs)
+    {
+        Pair &pair = m_pairs[pairKey(input, output)];
+        if (pair.pending == 0)
+            pair.pending = timestamp;
+    }
+}
+
+void LatencyTracer::outputChanged(quint32 output)
+{
+    int time = now();
+
+    QMutexLocker locker(&m_mutex);
+
+    m_outputs.insert(output);
+
+    foreach (quint32 input, m_inputs)
+    {
+        Pair &pair = m_pairs[pairKey(input, output)];
+        if (pair.pending == 0)
+            continue;
+
+        int latency = qMax(0, time - pair.pending);
+        pair.pending = 0;
+
+        if (pair.histogram.isEmpty())
+            pair.histogram.fill(0, LATENCY_HISTOGRAM_BINS);
+
+        pair.histogram[qMin(latency, LATENCY_HISTOGRAM_BINS - 1)]++;
+        pair.samples++;
+        pair.max = qMax(pair.max, latency);
+    }
+}
+
+int LatencyTracer::percentile(const LatencyTracer::Pair &pair, int percent)
+{
+    quint64 target = (quint64(pair.samples) * percent + 99) / 100;
+    quint64 count = 0;
+
+    for (int i = 0; i < pair.histogram.count(); i++)
+    {
+        count += pair.histogram.at(i);
+        if (count >= target)
+            return qMin(i, pair.max);
+    }
+
+    return pair.max;
+}
+
+QList<LatencyTracer::PairStatistics> LatencyTracer::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<PairStatistics> list;
+
+    QHashIterator<quint64, Pair> it(m_pairs);
+    while (it.hasNext())
+    {
+        it.next();
+        const Pair &pair = it.value();
+        if (pair.samples == 0)
+            continue;
+
+        PairStatistics stats;
+        stats.input = quint32(it.key() >> 32);
+        stats.output = quint32(it.key() & 0xFFFFFFFF);
+        stats.samples = pair.samples;
+        stats.p50 = percentile(pair, 50);
+        stats.p90 = percentile(pair, 90);
+        stats.p99 = percentile(pair, 99);
+        stats.max = pair.max;
+        list.append(stats);
+    }
+
+    return list;
+}
+
+void LatencyTracer::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pairs.clear();
+    m_inputs.clear();
+    m_outputs.clear();
+}
@@ -0,0 +1,111 @@
+/*
+  Q Light Controller Plus
+  latencytracer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Number of 1ms bins of a latency histogram. The last bin collects
+ *  everything exceeding the histogram range */
+#define LATENCY_HISTOGRAM_BINS 1000
+
+/**
+ * LatencyTracer measures the time between a value entering from an input
+ * universe and the next change of an output universe, for every pair of them.
+ *
+ * Input patches remember when the earliest value not flushed yet arrived.
+ * When a universe flushes its input, that time is reported with inputFlushed.
+ * When a universe sends a changed frame to its output patches, outputChanged
+ * records, for every input with values pending for that output, the time
+ * elapsed since the earliest of them. Times are in milliseconds of a clock
+ * shared by the whole process, see now().
+ */
+class LatencyTracer
+{
+public:
+    LatencyTracer();
+    ~LatencyTracer();
+
+    /** Return the milliseconds elapsed on the tracing clock.
+     *  The returned value is never 0, which stands for "no time" */
+    static int now();
+
+    /** Values of $input, the earliest of which arrived at $timestamp,
+     *  have been handed to the engine */
+    void inputFlushed(quint32 input, int timestamp);
+
+    /** A changed frame of $output has been sent to its output patches */
+    void outputChanged(quint32 output);
+
+    /** The latencies recorded for an input/output pair, in milliseconds */
+    struct PairStatistics
+    {
+        quint32 input;
+        quint32 output;
+        /** The number of latencies recorded */
+        quint32 samples;
+        int p50;
+        int p90;
+        int p99;
+        int max;
+    };
+
+    /** Get the statistics of every pair with at least one sample */
+    QList<PairStatistics> statistics() const;
+
+    /** Discard all the recorded latencies */
+    void reset();
+
+private:
+    struct Pair
+    {
+        Pair() : pending(0), samples(0), max(0) {}
+
+        /** The time of the earliest input not yet seen by the output, or 0 */
+        int pending;
+        quint32 samples;
+        int max;
+        QVector<quint32> histogram;
+    };
+
+    static quint64 pairKey(quint32 input, quint32 output);
+
+    /** Return the $percent percentile of $pair */
+    static int percentile(const Pair &pair, int percent);
+
+private:
+    mutable QMutex m_mutex;
+
+    QSet<quint32> m_inputs;
+    QSet<quint32> m_outputs;
+    QHash<quint64, Pair> m_pairs;
+};
+
+/** @} */
+
+#endif
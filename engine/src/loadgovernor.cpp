@@ -0,0 +1,138 @@
+/*
+  Q Light Controller Plus
+  loadgovernor.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDebug>
+
+#include "loadgovernor.h"
+#include "mastertimer.h"
+
+LoadGovernor::LoadGovernor(MasterTimer *timer, QObject *parent)
+    : QObject(parent)
+    , m_masterTimer(timer)
+    , m_level(Normal)
+    , m_headroomPolls(0)
+    , m_lastTicks(0)
+    , m_lastLateTicks(0)
+    , m_lastDuration(0)
+{
+    Q_ASSERT(timer != NULL);
+
+    m_pollTimer.setInterval(GOVERNOR_POLL_INTERVAL);
+    connect(&m_pollTimer, SIGNAL(timeout()), this, SLOT(slotPoll()));
+}
+
+LoadGovernor::~LoadGovernor()
+{
+}
+
+void LoadGovernor::start()
+{
+    if (m_pollTimer.isActive())
+        return;
+
+    m_masterTimer->timingCounters(&m_lastTicks, &m_lastLateTicks, &m_lastDuration);
+    m_headroomPolls = 0;
+    m_pollTimer.start();
+}
+
+void LoadGovernor::stop()
+{
+    m_pollTimer.stop();
+    setLevel(Normal);
+}
+
+LoadGovernor::Level LoadGovernor::level() const
+{
+    return m_level;
+}
+
+int LoadGovernor::scaledInterval(int interval) const
+{
+    return interval << int(m_level);
+}
+
+int LoadGovernor::scaledRate(int rate) const
+{
+    return qMax(1, rate >> int(m_level));
+}
+
+void LoadGovernor::update(int busyPercent, int latePercent)
+{
+    if (busyPercent >= GOVERNOR_OVERLOAD_PERCENT || latePercent >= GOVERNOR_LATE_PERCENT)
+    {
+        m_headroomPolls = 0;
+        if (m_level < Minimal)
+            setLevel(Level(m_level + 1));
+    }
+    else if (busyPercent < GOVERNOR_HEADROOM_PERCENT && latePercent == 0)
+    {
+        if (m_level == Normal)
+            return;
+
+        if (++m_headroomPolls >= GOVERNOR_RECOVERY_POLLS)
+        {
+            m_headroomPolls = 0;
+            setLevel(Level(m_level - 1));
+        }
+    }
+    else
+    {
+        m_headroomPolls = 0;
+    }
+}
+
+void LoadGovernor::setLevel(Level level)
+{
+    if (level == m_level)
+        return;
+
+    qDebug() << "[LoadGovernor] level changed from" << m_level << "to" << level;
+
+    m_level = level;
+    emit levelChanged(m_level);
+}
+
+void LoadGovernor::slotPoll()
+{
+    quint64 ticks, lateTicks, duration;
+    m_masterTimer->timingCounters(&ticks, &lateTicks, &duration);
+
+    /* The statistics have been reset: start over from the new counters */
+    if (ticks < m_lastTicks || lateTicks < m_lastLateTicks || duration < m_lastDuration)
+    {
+        m_lastTicks = ticks;
+        m_lastLateTicks = lateTicks;
+        m_lastDuration = duration;
+        return;
+    }
+
+    quint64 elapsedTicks = ticks - m_lastTicks;
+    if (elapsedTicks == 0)
+        return;
+
+    quint64 budget = elapsedTicks * MasterTimer::tick() * 1000;
+    int busyPercent = int(((duration - m_lastDuration) * 100) / budget);
+    int latePercent = int(((lateTicks - m_lastLateTicks) * 100) / elapsedTicks);
+
+    m_lastTicks = ticks;
+    m_lastLateTicks = lateTicks;
+    m_lastDuration = duration;
+
+    update(busyPercent, latePercent);
+}
@@ -0,0 +1,128 @@
+/*
+  Q Light Controller Plus
+  loadgovernor.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef LOADGOVERNOR_H
+#define LOADGOVERNOR_H
+
+#include <QObject>
+#include <QTimer>
+
+class MasterTimer;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Milliseconds between two checks of the MasterTimer load */
+#define GOVERNOR_POLL_INTERVAL 500
+
+/** Percentage of the tick time spent in timerTick() considered an overload */
+#define GOVERNOR_OVERLOAD_PERCENT 80
+
+/** Percentage of late ticks considered an overload */
+#define GOVERNOR_LATE_PERCENT 5
+
+/** Percentage of the tick time below which there is headroom again */
+#define GOVERNOR_HEADROOM_PERCENT 50
+
+/** Number of consecutive checks with headroom before relaxing one level */
+#define GOVERNOR_RECOVERY_POLLS 4
+
+/**
+ * LoadGovernor watches the MasterTimer timing statistics and tells the
+ * non-critical parts of the application (previews, monitors, web updates)
+ * to slow down when the engine can't keep up with its tick budget.
+ *
+ * Every GOVERNOR_POLL_INTERVAL milliseconds the governor computes the
+ * share of the tick time spent processing and the share of late ticks
+ * since the previous check. An overload raises the level by one step at
+ * once, while the level is lowered by one step only after
+ * GOVERNOR_RECOVERY_POLLS checks in a row with headroom, so the consumers
+ * don't oscillate.
+ *
+ * Consumers stretch their refresh intervals with scaledInterval() (or
+ * lower their rates with scaledRate()) and listen to levelChanged to
+ * re-apply them.
+ */
+class LoadGovernor : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(LoadGovernor)
+
+public:
+    enum Level
+    {
+        /** The engine has headroom: full refresh rates */
+        Normal = 0,
+        /** Refresh at half rate */
+        Reduced,
+        /** Refresh at a quarter of the rate, with the least detail */
+        Minimal
+    };
+
+    LoadGovernor(MasterTimer *timer, QObject *parent = 0);
+    ~LoadGovernor();
+
+    /** Start checking the MasterTimer load. Must be called from the
+     *  thread the governor lives in */
+    void start();
+
+    /** Stop checking the load and go back to the Normal level */
+    void stop();
+
+    /** Get the current level */
+    Level level() const;
+
+    /** Return $interval (in ms) stretched according to the current level */
+    int scaledInterval(int interval) const;
+
+    /** Return $rate (e.g. frames per second) lowered according to the
+     *  current level, never below 1 */
+    int scaledRate(int rate) const;
+
+signals:
+    void levelChanged(int level);
+
+protected:
+    /** Update the level with the load measured by the last check */
+    void update(int busyPercent, int latePercent);
+
+    /** Change the level, emitting levelChanged when needed */
+    void setLevel(Level level);
+
+private slots:
+    void slotPoll();
+
+private:
+    MasterTimer *m_masterTimer;
+    QTimer m_pollTimer;
+    Level m_level;
+
+    /** Number of consecutive checks with headroom */
+    int m_headroomPolls;
+
+    /** The MasterTimer counters at the previous check */
+    quint64 m_lastTicks;
+    quint64 m_lastLateTicks;
+    quint64 m_lastDuration;
+};
+
+/** @} */
+
+#endif
@@ -20,6 +20,7 @@
 */
 
 #include <sys/time.h>
+#include <time.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -30,6 +31,7 @@
 
 #include "mastertimer-unix.h"
 #include "mastertimer.h"
+#include "enginelog.h"
 
 /****************************************************************************
  * MasterTimerPrivate
@@ -62,16 +64,23 @@ int MasterTimerPrivate::compareTime(mach_timespec_t *time1, mach_timespec_t *tim
 int MasterTimerPrivate::compareTime(struct timespec *time1, struct timespec *time2)
 #endif
 {
+    static QLCLogLimiter lateLimiter(1);
+    int suppressed;
+
     if (time1->tv_sec < time2->tv_sec)
     {
-        qDebug() << "Time is late by" << (time2->tv_sec - time1->tv_sec) << "seconds";
+        if (lcMasterTimer().isDebugEnabled() && lateLimiter.allow(&suppressed))
+            qCDebug(lcMasterTimer) << "Time is late by" << (time2->tv_sec - time1->tv_sec)
+                                   << "seconds, suppressed:" << suppressed;
         return -1;
     }
     else if (time1->tv_sec > time2->tv_sec)
         return 1;
     else if (time1->tv_nsec < time2->tv_nsec)
     {
-        qDebug() << "Time is late by" << (time2->tv_nsec - time1->tv_nsec) << "nanoseconds";
+        if (lcMasterTimer().isDebugEnabled() && lateLimiter.allow(&suppressed))
+            qCDebug(lcMasterTimer) << "Time is late by" << (time2->tv_nsec - time1->tv_nsec)
+                                   << "nanoseconds, suppressed:" << suppressed;
         return -1;
     }
     else if (time1->tv_nsec > time2->tv_nsec)
@@ -92,6 +101,16 @@ void MasterTimerPrivate::run()
     /* How long to wait each loop, in nanoseconds */
     int nsTickTime = 1000000000L / mt->frequency();
 
+    /* In real-time mode, wake up at absolute deadlines from a
+     * SCHED_FIFO thread, so that sleep inaccuracies don't accumulate */
+    bool realTime = MasterTimer::realTimeEnabled();
+    if (realTime)
+    {
+        MasterTimer::lockMemory();
+        MasterTimer::setupRealTimeThread();
+        qDebug() << "MasterTimer running in real-time mode";
+    }
+
     /* Allocate this from stack here so that GCC doesn't have
        to do it everytime implicitly when gettimeofday() is called */
     int ret = 0;
@@ -149,7 +168,10 @@ void MasterTimerPrivate::run()
          * to process all the running Functions :'( */
         if (compareTime(finish, current) <= 0)
         {
-            qDebug() << Q_FUNC_INFO << "MasterTimer is running late!";
+            static QLCLogLimiter runningLateLimiter(1);
+            int suppressed;
+            if (lcMasterTimer().isDebugEnabled() && runningLateLimiter.allow(&suppressed))
+                qCDebug(lcMasterTimer) << "MasterTimer is running late! Suppressed:" << suppressed;
             /* No need to sleep. Immediately process the next tick */
             mt->timerTick();
             /* Now the finish time needs to be recalibrated */
@@ -161,6 +183,19 @@ void MasterTimerPrivate::run()
             continue;
         }
 
+#if defined(Q_OS_LINUX)
+        if (realTime)
+        {
+            do
+            {
+                ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, finish, NULL);
+            } while (ret == EINTR);
+
+            mt->timerTick();
+            continue;
+        }
+#endif
+
         /* Do a rough sleep using the kernel to return control.
            We know that this will never be seconds as we are dealing
            with jumps of under a second every time. */
@@ -23,12 +23,32 @@
 #define _WIN32_WINDOWS 0x05000000
 #define WINVER 0x05000000
 
+#include <QSettings>
+#include <QThread>
 #include <QDebug>
 
 #include "mastertimer-win32.h"
 #include "mastertimer.h"
+#include "enginelog.h"
 #include "qlcmacros.h"
 
+/** Setting that selects the high resolution backend */
+#define MASTERTIMER_HIGH_RESOLUTION "mastertimer/highresolution"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+#ifndef TIMER_ALL_ACCESS
+#define TIMER_ALL_ACCESS 0x1F0003
+#endif
+
+/* Resolved at runtime, since they are not available on every Windows
+   version targeted by this file */
+typedef HANDLE (WINAPI *CreateWaitableTimerExWFunc)(LPSECURITY_ATTRIBUTES, LPCWSTR, DWORD, DWORD);
+typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsWFunc)(LPCWSTR, LPDWORD);
+typedef BOOL (WINAPI *AvRevertMmThreadCharacteristicsFunc)(HANDLE);
+
 /****************************************************************************
  * Timer callback
  ****************************************************************************/
@@ -44,6 +64,26 @@ extern "C"
     }
 }
 
+/** The thread that runs the loop of the high resolution backend */
+class MasterTimerWin32Thread : public QThread
+{
+public:
+    MasterTimerWin32Thread(MasterTimerPrivate* mtp)
+        : m_mtp(mtp)
+    {
+        setObjectName("MasterTimer");
+    }
+
+protected:
+    void run()
+    {
+        m_mtp->runWaitableTimer();
+    }
+
+private:
+    MasterTimerPrivate* m_mtp;
+};
+
 /****************************************************************************
  * MasterTimerPrivate
  ****************************************************************************/
@@ -52,6 +92,8 @@ MasterTimerPrivate::MasterTimerPrivate(MasterTimer* masterTimer)
     : m_masterTimer(masterTimer)
     , m_systemTimerResolution(0)
     , m_phTimer(NULL)
+    , m_thread(NULL)
+    , m_threadRun(0)
     , m_run(false)
 {
     Q_ASSERT(masterTimer != NULL);
@@ -67,13 +109,22 @@ void MasterTimerPrivate::start()
     if (m_run == true)
         return;
 
+    QSettings settings;
+    if (settings.value(MASTERTIMER_HIGH_RESOLUTION, false).toBool() == true)
+        m_run = startWaitableTimer();
+    else
+        m_run = startQueueTimer();
+}
+
+bool MasterTimerPrivate::startQueueTimer()
+{
     /* Find out the smallest possible timer tick in milliseconds */
     TIMECAPS ptc;
     MMRESULT result = timeGetDevCaps(&ptc, sizeof(TIMECAPS));
     if (result != TIMERR_NOERROR)
     {
         qWarning() << Q_FUNC_INFO << "Unable to query system timer resolution.";
-        return;
+        return false;
     }
 
     /* Adjust system timer to operate on its minimum tick period */
@@ -82,7 +133,7 @@ void MasterTimerPrivate::start()
     if (result != TIMERR_NOERROR)
     {
         qWarning() << Q_FUNC_INFO << "Unable to adjust system timer resolution.";
-        return;
+        return false;
     }
 
     BOOL ok = CreateTimerQueueTimer(&m_phTimer,
@@ -97,10 +148,131 @@ void MasterTimerPrivate::start()
         qWarning() << Q_FUNC_INFO << "Unable to create a timer:" << GetLastError();
         timeEndPeriod(m_systemTimerResolution);
         m_systemTimerResolution = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool MasterTimerPrivate::startWaitableTimer()
+{
+    m_threadRun.storeRelease(1);
+    m_thread = new MasterTimerWin32Thread(this);
+    m_thread->start(QThread::TimeCriticalPriority);
+
+    return true;
+}
+
+void MasterTimerPrivate::runWaitableTimer()
+{
+    HANDLE timer = NULL;
+    bool highResolution = false;
+
+    CreateWaitableTimerExWFunc createWaitableTimerEx = (CreateWaitableTimerExWFunc)
+        GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "CreateWaitableTimerExW");
+    if (createWaitableTimerEx != NULL)
+    {
+        timer = createWaitableTimerEx(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                      TIMER_ALL_ACCESS);
+        highResolution = (timer != NULL);
+    }
+
+    /* Before Windows 10 1803 a waitable timer follows the system timer
+       resolution, so raise it as the timer queue backend does */
+    UINT systemTimerResolution = 0;
+    if (timer == NULL)
+    {
+        TIMECAPS ptc;
+        if (timeGetDevCaps(&ptc, sizeof(TIMECAPS)) == TIMERR_NOERROR &&
+            timeBeginPeriod(ptc.wPeriodMin) == TIMERR_NOERROR)
+                systemTimerResolution = ptc.wPeriodMin;
+
+        timer = CreateWaitableTimerW(NULL, FALSE, NULL);
+    }
+
+    if (timer == NULL)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to create a waitable timer:" << GetLastError();
+        if (systemTimerResolution != 0)
+            timeEndPeriod(systemTimerResolution);
+        m_threadRun.storeRelease(0);
         return;
     }
 
-    m_run = true;
+    /* Let the multimedia class scheduler service keep this thread on time */
+    HANDLE mmcssTask = NULL;
+    HMODULE avrt = LoadLibraryW(L"avrt.dll");
+    AvRevertMmThreadCharacteristicsFunc revertMmThreadCharacteristics = NULL;
+    if (avrt != NULL)
+    {
+        AvSetMmThreadCharacteristicsWFunc setMmThreadCharacteristics = (AvSetMmThreadCharacteristicsWFunc)
+            GetProcAddress(avrt, "AvSetMmThreadCharacteristicsW");
+        revertMmThreadCharacteristics = (AvRevertMmThreadCharacteristicsFunc)
+            GetProcAddress(avrt, "AvRevertMmThreadCharacteristics");
+
+        DWORD taskIndex = 0;
+        if (setMmThreadCharacteristics != NULL)
+            mmcssTask = setMmThreadCharacteristics(L"Pro Audio", &taskIndex);
+    }
+    if (mmcssTask == NULL)
+        qWarning() << Q_FUNC_INFO << "Unable to set the MMCSS Pro Audio priority";
+
+    qDebug() << "MasterTimer running on a" << (highResolution ? "high resolution" : "standard")
+             << "waitable timer";
+
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    LONGLONG tickTime = frequency.QuadPart / m_masterTimer->frequency();
+
+    QueryPerformanceCounter(&now);
+    LONGLONG deadline = now.QuadPart;
+
+    while (m_threadRun.loadAcquire() == 1)
+    {
+        /* The deadlines are absolute, so a late wake up is not carried
+           over to the following ticks */
+        deadline += tickTime;
+
+        QueryPerformanceCounter(&now);
+        LONGLONG remaining = deadline - now.QuadPart;
+
+        /* Check if we're running late. This means that a tick is not enough
+         * to process all the running Functions */
+        if (remaining <= 0)
+        {
+            static QLCLogLimiter runningLateLimiter(1);
+            int suppressed;
+            if (lcMasterTimer().isDebugEnabled() && runningLateLimiter.allow(&suppressed))
+                qCDebug(lcMasterTimer) << "MasterTimer is running late! Suppressed:" << suppressed;
+            /* No need to wait. Immediately process the next tick */
+            m_masterTimer->timerTick();
+            /* Now the deadline needs to be recalibrated */
+            QueryPerformanceCounter(&now);
+            deadline = now.QuadPart;
+            continue;
+        }
+
+        /* A negative due time is relative, in 100 nanoseconds units */
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -qMax(LONGLONG(1), remaining * 10000000 / frequency.QuadPart);
+
+        if (SetWaitableTimer(timer, &dueTime, 0, NULL, NULL, FALSE))
+            WaitForSingleObject(timer, INFINITE);
+        else
+            Sleep(DWORD(remaining * 1000 / frequency.QuadPart));
+
+        /* Execute the next timer event */
+        m_masterTimer->timerTick();
+    }
+
+    if (mmcssTask != NULL && revertMmThreadCharacteristics != NULL)
+        revertMmThreadCharacteristics(mmcssTask);
+    if (avrt != NULL)
+        FreeLibrary(avrt);
+
+    CloseHandle(timer);
+    if (systemTimerResolution != 0)
+        timeEndPeriod(systemTimerResolution);
 }
 
 void MasterTimerPrivate::stop()
@@ -108,6 +280,16 @@ void MasterTimerPrivate::stop()
     if (m_run == false)
         return;
 
+    if (m_thread != NULL)
+    {
+        m_threadRun.storeRelease(0);
+        m_thread->wait();
+        delete m_thread;
+        m_thread = NULL;
+        m_run = false;
+        return;
+    }
+
     // Destroy the timer and wait for it to complete its last firing (if applicable)
     if (DeleteTimerQueueTimer(NULL, m_phTimer, INVALID_HANDLE_VALUE))
         timeEndPeriod(m_systemTimerResolution);
@@ -22,8 +22,10 @@
 #define MASTERTIMER_PRIVATE_H
 
 #include <Windows.h>
+#include <QAtomicInt>
 
 class MasterTimer;
+class QThread;
 
 /** @addtogroup engine Engine
  * @{
@@ -41,10 +43,32 @@ public:
 
     void timerTick();
 
+    /**
+     * The tick loop of the high resolution backend, run by its own thread.
+     * It waits on a high resolution waitable timer for absolute deadlines
+     * taken on the performance counter, so that the wake up latencies don't
+     * accumulate, and runs with the MMCSS "Pro Audio" priority.
+     */
+    void runWaitableTimer();
+
+private:
+    /** Start the ticks with a timer queue timer, run by the thread pool */
+    bool startQueueTimer();
+
+    /** Start the ticks with the high resolution backend */
+    bool startWaitableTimer();
+
 private:
     MasterTimer* m_masterTimer;
     UINT m_systemTimerResolution;
     HANDLE m_phTimer;
+
+    /** The thread of the high resolution backend, NULL when not used */
+    QThread* m_thread;
+
+    /** 1 while the thread of the high resolution backend has to run */
+    QAtomicInt m_threadRun;
+
     bool m_run;
 };
 
@@ -20,6 +20,9 @@
 
 #include <QDebug>
 #include <QSettings>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
 #include <QElapsedTimer>
 #include <QMutexLocker>
 
@@ -30,29 +33,106 @@
 #   include "mastertimer-unix.h"
 #endif
 
+#if defined(Q_OS_LINUX)
+#   include <pthread.h>
+#   include <sys/mman.h>
+#   include <string.h>
+#   include <errno.h>
+#   include <sched.h>
+#endif
+
 #include "inputoutputmap.h"
 #include "genericfader.h"
 #include "fadechannel.h"
 #include "mastertimer.h"
 #include "dmxsource.h"
 #include "qlcmacros.h"
+#include "ticktrace.h"
 #include "function.h"
 #include "universe.h"
 #include "doc.h"
 
 #define MASTERTIMER_FREQUENCY "mastertimer/frequency"
+#define MASTERTIMER_PARALLEL "mastertimer/parallel"
+#define MASTERTIMER_REALTIME "mastertimer/realtime"
+#define MASTERTIMER_REALTIME_PRIORITY "mastertimer/realtimepriority"
+#define MASTERTIMER_REALTIME_CPU "mastertimer/realtimecpu"
 #define LATE_TO_BEAT_THRESHOLD 25
 
+/** Timing statistics histograms layout */
+#define TIMING_HISTOGRAM_BINS   64
+#define TIMING_INTERVAL_BIN_US  1000
+#define TIMING_DURATION_BIN_US  250
+/** Number of minutes kept in the worst case history */
+#define TIMING_MINUTES_HISTORY  60
+/** Number of calls followed by the function timing rolling average */
+#define FUNCTION_TIMING_AVERAGE_CALLS 50
+
 /** The timer tick frequency in Hertz */
 uint MasterTimer::s_frequency = 50;
 uint MasterTimer::s_tick = 20;
 
+bool MasterTimer::s_realTime = false;
+int MasterTimer::s_realTimePriority = 80;
+int MasterTimer::s_realTimeCPU = -1;
+
 //#define DEBUG_MASTERTIMER
 
 #ifdef DEBUG_MASTERTIMER
 quint64 ticksCount = 0;
 #endif
 
+/** The name of the trace events of the write() of a function type */
+static const char *writeTraceName(Function::Type type)
+{
+    switch (type)
+    {
+        case Function::SceneType: return "Scene::write";
+        case Function::ChaserType: return "Chaser::write";
+        case Function::EFXType: return "EFX::write";
+        case Function::CollectionType: return "Collection::write";
+        case Function::ScriptType: return "Script::write";
+        case Function::RGBMatrixType: return "RGBMatrix::write";
+        case Function::ShowType: return "Show::write";
+        case Function::SequenceType: return "Sequence::write";
+        case Function::AudioType: return "Audio::write";
+        case Function::DMXRecordingType: return "DMXRecording::write";
+        default: return "Function::write";
+    }
+}
+
+/**
+ * Job executed by the MasterTimer thread pool when the parallel
+ * tick mode is enabled. It runs the write() method of a group of
+ * functions sharing the same Universes, in their original order.
+ */
+class FunctionsTickJob : public QRunnable
+{
+public:
+    FunctionsTickJob(MasterTimer *timer, const QList<Function *> &functions,
+                     const QList<Universe *> &universes, QSemaphore *done)
+        : m_timer(timer)
+        , m_functions(functions)
+        , m_universes(universes)
+        , m_done(done)
+    {
+    }
+
+    void run()
+    {
+        foreach (Function *function, m_functions)
+            m_timer->writeFunction(function, m_universes);
+
+        m_done->release();
+    }
+
+private:
+    MasterTimer *m_timer;
+    QList<Function *> m_functions;
+    QList<Universe *> m_universes;
+    QSemaphore *m_done;
+};
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -60,16 +140,27 @@ quint64 ticksCount = 0;
 MasterTimer::MasterTimer(Doc* doc)
     : QObject(doc)
     , d_ptr(new MasterTimerPrivate(this))
+    , m_startQueue(NULL)
     , m_stopAllFunctions(false)
+    , m_parallelTick(false)
+    , m_tickPool(new QThreadPool(this))
+    , m_timingClock(new QElapsedTimer())
+    , m_lastTickStart(-1)
+    , m_minuteStart(0)
+    , m_functionTimingEnabled(0)
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
     , m_dmxSourceListMutex(QMutex::Recursive)
 #endif
     , m_beatSourceType(None)
     , m_currentBPM(120)
     , m_beatTimeDuration(500)
+    , m_beatRemainder(0)
+    , m_beatFraction(0)
     , m_beatRequested(false)
     , m_beatTimer(new QElapsedTimer())
     , m_lastBeatOffset(0)
+    , m_virtualTime(-1)
+    , m_virtualBeatStart(0)
 {
     Q_ASSERT(doc != NULL);
     Q_ASSERT(d_ptr != NULL);
@@ -77,9 +168,33 @@ MasterTimer::MasterTimer(Doc* doc)
     QSettings settings;
     QVariant var = settings.value(MASTERTIMER_FREQUENCY);
     if (var.isValid() == true)
-        s_frequency = var.toUInt();
+    {
+        s_frequency = supportedFrequency(var.toUInt());
+        if (s_frequency != var.toUInt())
+            qWarning() << "[MasterTimer] Frequency" << var.toUInt() << "Hz not supported, using"
+                       << s_frequency << "Hz";
+    }
+
+    s_tick = 1000 / s_frequency;
+
+    m_timingClock->start();
+    resetTimingStatistics();
+
+    var = settings.value(MASTERTIMER_PARALLEL);
+    if (var.isValid() == true)
+        m_parallelTick = var.toBool();
 
-    s_tick = uint(double(1000) / double(s_frequency));
+    var = settings.value(MASTERTIMER_REALTIME);
+    if (var.isValid() == true)
+        s_realTime = var.toBool();
+
+    var = settings.value(MASTERTIMER_REALTIME_PRIORITY);
+    if (var.isValid() == true)
+        s_realTimePriority = var.toInt();
+
+    var = settings.value(MASTERTIMER_REALTIME_CPU);
+    if (var.isValid() == true)
+        s_realTimeCPU = var.toInt();
 }
 
 MasterTimer::~MasterTimer()
@@ -90,6 +205,12 @@ MasterTimer::~MasterTimer()
     delete d_ptr;
     d_ptr = NULL;
 
+    m_tickPool->waitForDone();
+
+    /* Discard the start requests not processed */
+    takeStartQueue();
+
+    delete m_timingClock;
     delete m_beatTimer;
 }
 
@@ -111,6 +232,9 @@ void MasterTimer::timerTick()
     Doc *doc = qobject_cast<Doc*> (parent());
     Q_ASSERT(doc != NULL);
 
+    TICK_TRACE("MasterTimer::timerTick");
+    qint64 tickStart = m_timingClock->nsecsElapsed();
+
 #ifdef DEBUG_MASTERTIMER
     qDebug() << "[MasterTimer] *********** tick:" << ticksCount++ << "**********";
 #endif
@@ -119,9 +243,22 @@ void MasterTimer::timerTick()
     {
         case Internal:
         {
-            int elapsedTime = qRound((double)m_beatTimer->nsecsElapsed() / 1000000) + m_lastBeatOffset;
+            int elapsedTime = beatElapsed() + m_lastBeatOffset;
             //qDebug() << "Elapsed beat:" << elapsedTime;
-            if (elapsedTime >= m_beatTimeDuration)
+            if (m_beatAlignRequested.fetchAndStoreOrdered(0))
+            {
+                // past the middle of a beat, the aligned beat
+                // has not been fired yet
+                if (elapsedTime >= m_beatTimeDuration / 2)
+                {
+                    m_beatRequested = true;
+                    emit beat();
+                }
+
+                m_lastBeatOffset = m_requestedBeatAlign.loadAcquire();
+                restartBeatTimer();
+            }
+            else if (elapsedTime >= m_beatTimeDuration)
             {
                 // it's time to fire a beat
                 m_beatRequested = true;
@@ -130,7 +267,16 @@ void MasterTimer::timerTick()
                 // milliseconds, otherwise it will generate an unpleasant drift
                 //qDebug() << "Elapsed:" << elapsedTime << ", delta:" << elapsedTime - m_beatTimeDuration;
                 m_lastBeatOffset = elapsedTime - m_beatTimeDuration;
-                m_beatTimer->restart();
+
+                // once the sub-millisecond parts add up, the exact beat
+                // happens one millisecond later than m_beatTimeDuration
+                m_beatFraction += m_beatRemainder;
+                if (m_beatFraction >= m_currentBPM)
+                {
+                    m_beatFraction -= m_currentBPM;
+                    m_lastBeatOffset--;
+                }
+                restartBeatTimer();
 
                 // inform the listening classes that a beat is happening
                 emit beat();
@@ -138,6 +284,12 @@ void MasterTimer::timerTick()
         }
         break;
         case External:
+            if (m_beatRequested)
+            {
+                // align the beat timer to the moment the beat actually happened
+                m_lastBeatOffset = m_requestedBeatDelay.fetchAndStoreOrdered(0);
+                restartBeatTimer();
+            }
         break;
 
         case None:
@@ -155,6 +307,8 @@ void MasterTimer::timerTick()
 
     m_beatRequested = false;
 
+    recordTickTiming(tickStart, m_timingClock->nsecsElapsed() - tickStart);
+
     //qDebug() << ">>>>>>>> MASTERTIMER TICK";
     emit tickReady();
 }
@@ -169,6 +323,89 @@ uint MasterTimer::tick()
     return s_tick;
 }
 
+uint MasterTimer::supportedFrequency(uint frequency)
+{
+    frequency = CLAMP(frequency, uint(MASTERTIMER_MIN_FREQUENCY), uint(MASTERTIMER_MAX_FREQUENCY));
+
+    /* Round the tick to the closest longer one that divides a second */
+    uint tick = qRound(double(1000) / double(frequency));
+    while (1000 % tick != 0)
+        tick++;
+
+    return 1000 / tick;
+}
+
+/*****************************************************************************
+ * Real-time scheduling
+ *****************************************************************************/
+
+bool MasterTimer::realTimeEnabled()
+{
+#if defined(Q_OS_LINUX)
+    return s_realTime;
+#else
+    return false;
+#endif
+}
+
+bool MasterTimer::setupRealTimeThread(int priorityOffset)
+{
+    if (realTimeEnabled() == false)
+        return true;
+
+#if defined(Q_OS_LINUX)
+    bool result = true;
+    int minPriority = sched_get_priority_min(SCHED_FIFO);
+    int maxPriority = sched_get_priority_max(SCHED_FIFO);
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = CLAMP(s_realTimePriority - priorityOffset, minPriority, maxPriority);
+
+    int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to set real-time priority"
+                   << param.sched_priority << ":" << strerror(ret);
+        result = false;
+    }
+
+    if (s_realTimeCPU >= 0)
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(s_realTimeCPU, &cpuSet);
+
+        ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+        if (ret != 0)
+        {
+            qWarning() << Q_FUNC_INFO << "Unable to pin thread to CPU"
+                       << s_realTimeCPU << ":" << strerror(ret);
+            result = false;
+        }
+    }
+
+    return result;
+#else
+    Q_UNUSED(priorityOffset)
+    return false;
+#endif
+}
+
+bool MasterTimer::lockMemory()
+{
+#if defined(Q_OS_LINUX)
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to lock memory:" << strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
 /*****************************************************************************
  * Functions
  *****************************************************************************/
@@ -178,9 +415,33 @@ void MasterTimer::startFunction(Function* function)
     if (function == NULL)
         return;
 
-    QMutexLocker locker(&m_functionListMutex);
-    if (m_startQueue.contains(function) == false)
-        m_startQueue.append(function);
+    StartRequest *request = new StartRequest;
+    request->m_function = function;
+
+    StartRequest *head;
+    do
+    {
+        head = m_startQueue.loadAcquire();
+        request->m_next = head;
+    } while (m_startQueue.testAndSetRelease(head, request) == false);
+}
+
+QList<Function *> MasterTimer::takeStartQueue()
+{
+    QList<Function *> startQueue;
+    StartRequest *request = m_startQueue.fetchAndStoreAcquire(NULL);
+
+    /* The stack holds the most recent request first */
+    while (request != NULL)
+    {
+        StartRequest *next = request->m_next;
+        startQueue.removeOne(request->m_function);
+        startQueue.prepend(request->m_function);
+        delete request;
+        request = next;
+    }
+
+    return startQueue;
 }
 
 void MasterTimer::stopAllFunctions()
@@ -234,6 +495,10 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
     // function. The functions at the indices have been stopped.
     QList<int> removeList;
 
+    // In parallel tick mode, the write() calls of the first iteration
+    // are collected here and dispatched all at once
+    QList<Function*> writeList;
+
     bool functionListHasChanged = false;
     bool stoppedAFunction = true;
     bool firstIteration = true;
@@ -253,7 +518,12 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
                 if (function->stopped() == false && m_stopAllFunctions == false)
                 {
                     if (firstIteration)
-                        function->write(this, universes);
+                    {
+                        if (m_parallelTick)
+                            writeList.append(function);
+                        else
+                            writeFunction(function, universes);
+                    }
                 }
                 else
                 {
@@ -261,7 +531,7 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
                     if (m_stopAllFunctions)
                         function->stop(FunctionParent::master());
                     /* Function should be stopped instead */
-                    function->postRun(this, universes);
+                    postRunFunction(function, universes);
                     //qDebug() << "[MasterTimer] Add function (ID: " << function->id() << ") to remove list ";
                     removeList << i; // Don't remove the item from the list just yet.
                     functionListHasChanged = true;
@@ -282,41 +552,329 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
         while (it.hasPrevious() == true)
             m_functionList.removeAt(it.previous());
 
+        if (firstIteration && writeList.isEmpty() == false)
+            writeFunctions(writeList, universes);
+
         firstIteration = false;
     }
 
+    /* Functions started by the write() calls below are run in this tick too */
+    QList<Function*> startQueue = takeStartQueue();
+    while (startQueue.isEmpty() == false)
     {
-        QMutexLocker locker(&m_functionListMutex);
-        while (m_startQueue.size() > 0)
+        foreach (Function* f, startQueue)
         {
-            QList<Function*> startQueue(m_startQueue);
-            m_startQueue.clear();
-            locker.unlock();
-
-            foreach (Function* f, startQueue)
+            if (m_functionList.contains(f))
             {
-                if (m_functionList.contains(f))
-                {
-                    f->postRun(this, universes);
-                }
-                else
-                {
-                    m_functionList.append(f);
-                    functionListHasChanged = true;
-                }
-                f->preRun(this);
-                f->write(this, universes);
-                emit functionStarted(f->id());
+                postRunFunction(f, universes);
             }
-
-            locker.relock();
+            else
+            {
+                m_functionList.append(f);
+                functionListHasChanged = true;
+            }
+            preRunFunction(f);
+            writeFunction(f, universes);
+            emit functionStarted(f->id());
         }
+
+        startQueue = takeStartQueue();
     }
 
     if (functionListHasChanged)
         emit functionListChanged();
 }
 
+void MasterTimer::writeFunction(Function *function, const QList<Universe *> &universes)
+{
+    TICK_TRACE_ARG(writeTraceName(function->type()), function->id());
+
+    if (functionTimingEnabled() == false)
+    {
+        function->write(this, universes);
+        return;
+    }
+
+    qint64 start = m_timingClock->nsecsElapsed();
+    function->write(this, universes);
+    recordFunctionTiming(function->id(), WriteCall, m_timingClock->nsecsElapsed() - start);
+}
+
+void MasterTimer::preRunFunction(Function *function)
+{
+    if (functionTimingEnabled() == false)
+    {
+        function->preRun(this);
+        return;
+    }
+
+    qint64 start = m_timingClock->nsecsElapsed();
+    function->preRun(this);
+    recordFunctionTiming(function->id(), PreRunCall, m_timingClock->nsecsElapsed() - start);
+}
+
+void MasterTimer::postRunFunction(Function *function, const QList<Universe *> &universes)
+{
+    if (functionTimingEnabled() == false)
+    {
+        function->postRun(this, universes);
+        return;
+    }
+
+    qint64 start = m_timingClock->nsecsElapsed();
+    function->postRun(this, universes);
+    recordFunctionTiming(function->id(), PostRunCall, m_timingClock->nsecsElapsed() - start);
+}
+
+void MasterTimer::writeFunctions(const QList<Function *> &functions, QList<Universe *> universes)
+{
+    QList<Function *> serial;
+    QList<QList<Function *> > groups = groupFunctionsByUniverse(functions, serial);
+
+    /* Functions that might start/stop other functions are
+     * run first, on the MasterTimer thread */
+    foreach (Function *function, serial)
+        writeFunction(function, universes);
+
+    if (groups.isEmpty())
+        return;
+
+    /* Not worth involving the pool for a single group */
+    if (groups.count() == 1)
+    {
+        foreach (Function *function, groups.first())
+            writeFunction(function, universes);
+        return;
+    }
+
+    QSemaphore done;
+
+    for (int i = 1; i < groups.count(); i++)
+        m_tickPool->start(new FunctionsTickJob(this, groups.at(i), universes, &done));
+
+    /* The MasterTimer thread takes care of the first group too */
+    foreach (Function *function, groups.first())
+        writeFunction(function, universes);
+
+    done.acquire(groups.count() - 1);
+}
+
+QList<QList<Function *> > MasterTimer::groupFunctionsByUniverse(const QList<Function *> &functions,
+                                                               QList<Function *> &serial) const
+{
+    QList<QList<Function *> > groups;
+    QHash<quint32, int> universeGroup;
+
+    foreach (Function *function, functions)
+    {
+        QList<quint32> universeIDs = function->faderUniverses();
+
+        /* Only functions that write exclusively through their own faders
+         * can be evaluated in parallel. Composite functions (Chaser, Collection,
+         * Show...) start and stop other functions, so they are run serially,
+         * as well as functions that haven't requested any fader yet */
+        if (universeIDs.isEmpty() ||
+            (function->type() != Function::SceneType &&
+             function->type() != Function::EFXType &&
+             function->type() != Function::RGBMatrixType))
+        {
+            serial.append(function);
+            continue;
+        }
+
+        int groupIndex = -1;
+
+        foreach (quint32 universeID, universeIDs)
+        {
+            int index = universeGroup.value(universeID, -1);
+            if (index == -1 || index == groupIndex)
+                continue;
+
+            if (groupIndex == -1)
+            {
+                groupIndex = index;
+                continue;
+            }
+
+            /* The function bridges two groups: merge them, preserving
+             * the original order of each group */
+            groups[groupIndex].append(groups.at(index));
+            groups[index].clear();
+
+            QMutableHashIterator<quint32, int> it(universeGroup);
+            while (it.hasNext())
+            {
+                it.next();
+                if (it.value() == index)
+                    it.setValue(groupIndex);
+            }
+        }
+
+        if (groupIndex == -1)
+        {
+            groupIndex = groups.count();
+            groups.append(QList<Function *>());
+        }
+
+        groups[groupIndex].append(function);
+        foreach (quint32 universeID, universeIDs)
+            universeGroup[universeID] = groupIndex;
+    }
+
+    groups.removeAll(QList<Function *>());
+
+    return groups;
+}
+
+/****************************************************************************
+ * Parallel tick
+ ****************************************************************************/
+
+void MasterTimer::setParallelTickEnabled(bool enable)
+{
+    m_parallelTick = enable;
+}
+
+bool MasterTimer::parallelTickEnabled() const
+{
+    return m_parallelTick;
+}
+
+/****************************************************************************
+ * Timing statistics
+ ****************************************************************************/
+
+MasterTimer::TimingStatistics MasterTimer::timingStatistics() const
+{
+    QMutexLocker locker(&m_timingMutex);
+    return m_timingStats;
+}
+
+void MasterTimer::resetTimingStatistics()
+{
+    QMutexLocker locker(&m_timingMutex);
+
+    m_timingStats.ticks = 0;
+    m_timingStats.lateTicks = 0;
+    m_timingStats.missedTicks = 0;
+    m_timingStats.totalDuration = 0;
+    m_timingStats.intervalBinSize = TIMING_INTERVAL_BIN_US;
+    m_timingStats.durationBinSize = TIMING_DURATION_BIN_US;
+    m_timingStats.intervalHistogram.fill(0, TIMING_HISTOGRAM_BINS);
+    m_timingStats.durationHistogram.fill(0, TIMING_HISTOGRAM_BINS);
+    m_timingStats.worstIntervalPerMinute.clear();
+    m_timingStats.worstDurationPerMinute.clear();
+
+    m_lastTickStart = -1;
+    m_minuteStart = m_timingClock->nsecsElapsed();
+}
+
+void MasterTimer::timingCounters(quint64 *ticks, quint64 *lateTicks, quint64 *totalDuration) const
+{
+    QMutexLocker locker(&m_timingMutex);
+
+    *ticks = m_timingStats.ticks;
+    *lateTicks = m_timingStats.lateTicks;
+    *totalDuration = m_timingStats.totalDuration;
+}
+
+void MasterTimer::recordTickTiming(qint64 start, qint64 duration)
+{
+    QMutexLocker locker(&m_timingMutex);
+
+    int durationUs = int(duration / 1000);
+    int intervalUs = -1;
+
+    if (m_lastTickStart >= 0)
+        intervalUs = int((start - m_lastTickStart) / 1000);
+    m_lastTickStart = start;
+
+    /* Open a new minute in the worst case history when needed */
+    bool minuteElapsed = (start - m_minuteStart >= Q_INT64_C(60000000000));
+    if (minuteElapsed || m_timingStats.worstDurationPerMinute.isEmpty())
+    {
+        if (m_timingStats.worstDurationPerMinute.count() == TIMING_MINUTES_HISTORY)
+        {
+            m_timingStats.worstIntervalPerMinute.remove(0);
+            m_timingStats.worstDurationPerMinute.remove(0);
+        }
+        m_timingStats.worstIntervalPerMinute.append(0);
+        m_timingStats.worstDurationPerMinute.append(0);
+        if (minuteElapsed)
+            m_minuteStart = start;
+    }
+
+    m_timingStats.ticks++;
+    m_timingStats.totalDuration += durationUs;
+    m_timingStats.durationHistogram[qMin(durationUs / TIMING_DURATION_BIN_US,
+                                         TIMING_HISTOGRAM_BINS - 1)]++;
+    int &worstDuration = m_timingStats.worstDurationPerMinute.last();
+    worstDuration = qMax(worstDuration, durationUs);
+
+    if (intervalUs < 0)
+        return;
+
+    m_timingStats.intervalHistogram[qMin(intervalUs / TIMING_INTERVAL_BIN_US,
+                                         TIMING_HISTOGRAM_BINS - 1)]++;
+    int &worstInterval = m_timingStats.worstIntervalPerMinute.last();
+    worstInterval = qMax(worstInterval, intervalUs);
+
+    /* A tick starting more than half a tick after its due time is late.
+     * The tick periods elapsed in the meantime are counted as missed */
+    int tickUs = int(s_tick) * 1000;
+    if (intervalUs > tickUs + tickUs / 2)
+    {
+        m_timingStats.lateTicks++;
+        m_timingStats.missedTicks += (intervalUs + tickUs / 2) / tickUs - 1;
+    }
+}
+
+/*****************************************************************************
+ * Function timing
+ *****************************************************************************/
+
+void MasterTimer::setFunctionTimingEnabled(bool enable)
+{
+    if (enable && functionTimingEnabled() == false)
+        resetFunctionTimings();
+
+    m_functionTimingEnabled.storeRelease(enable ? 1 : 0);
+}
+
+bool MasterTimer::functionTimingEnabled() const
+{
+    return m_functionTimingEnabled.loadAcquire() != 0;
+}
+
+QHash<quint32, MasterTimer::FunctionTiming> MasterTimer::functionTimings() const
+{
+    QMutexLocker locker(&m_functionTimingMutex);
+    return m_functionTimings;
+}
+
+void MasterTimer::resetFunctionTimings()
+{
+    QMutexLocker locker(&m_functionTimingMutex);
+    m_functionTimings.clear();
+}
+
+void MasterTimer::recordFunctionTiming(quint32 id, FunctionCall call, qint64 duration)
+{
+    int durationUs = int(duration / 1000);
+
+    QMutexLocker locker(&m_functionTimingMutex);
+
+    FunctionTiming &timing = m_functionTimings[id];
+    CallTiming &callTiming = (call == WriteCall) ? timing.write :
+                             (call == PreRunCall) ? timing.preRun : timing.postRun;
+
+    /* A plain average of the first calls, then an exponential one */
+    callTiming.calls++;
+    callTiming.average += (double(durationUs) - callTiming.average) /
+                          double(qMin(callTiming.calls, quint64(FUNCTION_TIMING_AVERAGE_CALLS)));
+    callTiming.maximum = qMax(callTiming.maximum, durationUs);
+}
+
 /****************************************************************************
  * DMX Sources
  ****************************************************************************/
@@ -347,11 +905,16 @@ void MasterTimer::timerTickDMXSources(QList<Universe *> universes)
     {
         Q_ASSERT(source != NULL);
 
+        /* Skip the sources that have nothing new to write */
+        if (source->writeOnChangeOnly() && source->takeChanged() == false)
+            continue;
+
 #ifdef DEBUG_MASTERTIMER
         qDebug() << "[MasterTimer] ticking DMX source" << i;
 #endif
 
         /* Get DMX data from the source */
+        TICK_TRACE("DMXSource::writeDMX");
         source->writeDMX(this, universes);
     }
 }
@@ -365,10 +928,10 @@ void MasterTimer::setBeatSourceType(MasterTimer::BeatsSourceType type)
     if (type == m_beatSourceType)
         return;
 
-    // alright, this causes a time drift of maximum 1ms per beat
-    // but at the moment I am not looking for a better solution
     m_beatTimeDuration = 60000 / m_currentBPM;
-    m_beatTimer->restart();
+    m_beatRemainder = 60000 % m_currentBPM;
+    m_beatFraction = 0;
+    restartBeatTimer();
 
     m_beatSourceType = type;
 }
@@ -385,7 +948,9 @@ void MasterTimer::requestBpmNumber(int bpm)
 
     m_currentBPM = bpm;
     m_beatTimeDuration = 60000 / m_currentBPM;
-    m_beatTimer->restart();
+    m_beatRemainder = 60000 % m_currentBPM;
+    m_beatFraction = 0;
+    restartBeatTimer();
 
     emit bpmNumberChanged(bpm);
 }
@@ -402,7 +967,7 @@ int MasterTimer::beatTimeDuration() const
 
 int MasterTimer::timeToNextBeat() const
 {
-    return m_beatTimeDuration - m_beatTimer->elapsed();
+    return m_beatTimeDuration - beatElapsed() - m_lastBeatOffset;
 }
 
 int MasterTimer::nextBeatTimeOffset() const
@@ -428,9 +993,49 @@ bool MasterTimer::isBeat() const
     return m_beatRequested;
 }
 
-void MasterTimer::requestBeat()
+int MasterTimer::beatPhase() const
+{
+    return qMax(0, m_lastBeatOffset);
+}
+
+void MasterTimer::requestBeat(int delay)
 {
     // forceful request of a beat, processed at
     // the next timerTick call
+    m_requestedBeatDelay.storeRelease(delay);
     m_beatRequested = true;
 }
+
+void MasterTimer::alignBeat(int delay)
+{
+    m_requestedBeatAlign.storeRelease(delay);
+    m_beatAlignRequested.storeRelease(1);
+}
+
+int MasterTimer::beatElapsed() const
+{
+    if (m_virtualTime >= 0)
+        return m_virtualTime - m_virtualBeatStart;
+
+    return qRound((double)m_beatTimer->nsecsElapsed() / 1000000);
+}
+
+void MasterTimer::restartBeatTimer()
+{
+    m_beatTimer->restart();
+    m_virtualBeatStart = m_virtualTime;
+}
+
+void MasterTimer::setVirtualTime(int time)
+{
+    bool restart = (time < 0) != (m_virtualTime < 0);
+
+    m_virtualTime = time;
+
+    /* Switching clock, the beats start over from now */
+    if (restart)
+    {
+        m_lastBeatOffset = 0;
+        restartBeatTimer();
+    }
+}
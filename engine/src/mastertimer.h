@@ -21,13 +21,17 @@
 #ifndef MASTERTIMER_H
 #define MASTERTIMER_H
 
+#include <QAtomicPointer>
+#include <QAtomicInt>
 #include <QHash>
 #include <QObject>
+#include <QVector>
 #include <QMutex>
 #include <QList>
 
 class MasterTimerPrivate;
 class QElapsedTimer;
+class QThreadPool;
 class GenericFader;
 class FadeChannel;
 class DMXSource;
@@ -35,6 +39,10 @@ class Function;
 class Universe;
 class Doc;
 
+/** The range of the supported timer tick frequencies, in Hertz */
+#define MASTERTIMER_MIN_FREQUENCY 1
+#define MASTERTIMER_MAX_FREQUENCY 250
+
 /** @addtogroup engine Engine
  * @{
  */
@@ -45,6 +53,8 @@ class MasterTimer : public QObject
     Q_DISABLE_COPY(MasterTimer)
 
     friend class MasterTimerPrivate;
+    friend class FunctionsTickJob;
+    friend class OfflineRenderer;
 
     /*************************************************************************
      * Initialization
@@ -73,6 +83,14 @@ public:
     /** Get the length of one timer tick in milliseconds */
     static uint tick();
 
+    /**
+     * Return the frequency closest to $frequency at which the engine can
+     * run: between MASTERTIMER_MIN_FREQUENCY and MASTERTIMER_MAX_FREQUENCY,
+     * with a tick of a whole number of milliseconds, so that the timing of
+     * the functions, counted in ticks, doesn't drift.
+     */
+    static uint supportedFrequency(uint frequency);
+
 signals:
     void tickReady();
 
@@ -90,12 +108,45 @@ private:
     /** The private reference to a MasterTimer platform dependent implementation */
     MasterTimerPrivate* d_ptr;
 
+    /*************************************************************************
+     * Real-time scheduling
+     *************************************************************************/
+public:
+    /** Return true if the real-time mode has been enabled in the
+     *  application settings. Currently supported on Linux only */
+    static bool realTimeEnabled();
+
+    /**
+     * Apply the real-time settings to the calling thread: SCHED_FIFO
+     * scheduling with the configured priority lowered by $priorityOffset,
+     * and CPU pinning if a CPU has been configured.
+     * Does nothing when the real-time mode is disabled.
+     *
+     * @param priorityOffset Offset subtracted from the configured priority
+     * @return true on success, false if the settings could not be applied
+     */
+    static bool setupRealTimeThread(int priorityOffset = 0);
+
+    /** Lock the process memory to prevent page faults in the timing threads */
+    static bool lockMemory();
+
+private:
+    /** Flag that enables the real-time mode */
+    static bool s_realTime;
+
+    /** The SCHED_FIFO priority of the timer thread */
+    static int s_realTimePriority;
+
+    /** The CPU where timing threads are pinned, or -1 for no pinning */
+    static int s_realTimeCPU;
+
     /*********************************************************************
      * Functions
      *********************************************************************/
 public:
     /** Start the given function */
-    /** This should be called by the function itself */
+    /** This should be called by the function itself. It is safe to call it
+     *  from any thread, as it never blocks waiting for the timer tick */
     virtual void startFunction(Function* function);
 
     /** Stop all functions. Doesn't affect registered DMX sources. */
@@ -118,17 +169,172 @@ private:
     /** Execute one timer tick for each registered Function */
     void timerTickFunctions(QList<Universe *> universes);
 
+    /** Run the write(), preRun() or postRun() method of $function,
+     *  traced and timed when enabled */
+    void writeFunction(Function *function, const QList<Universe *> &universes);
+    void preRunFunction(Function *function);
+    void postRunFunction(Function *function, const QList<Universe *> &universes);
+
+    /** Run the write() method of the given functions, either serially
+     *  or splitting them across m_tickPool, depending on m_parallelTick */
+    void writeFunctions(const QList<Function *> &functions, QList<Universe *> universes);
+
+    /** Split a list of functions into groups sharing no Universe.
+     *  Functions that cannot be run in parallel are returned in $serial */
+    QList<QList<Function *> > groupFunctionsByUniverse(const QList<Function *> &functions,
+                                                      QList<Function *> &serial) const;
+
+    /** Atomically take all the pending start requests, in the order
+     *  they have been made and without duplicates */
+    QList<Function *> takeStartQueue();
+
 private:
     /** List of currently running functions */
     QList <Function*> m_functionList;
-    QList <Function*> m_startQueue;
 
-    /** Mutex that guards access to m_startQueue */
-    QMutex m_functionListMutex;
+    /** A start request, pushed by startFunction() on m_startQueue */
+    struct StartRequest
+    {
+        Function *m_function;
+        StartRequest *m_next;
+    };
+
+    /** Lock-free stack of the start requests made since the last tick.
+     *  Any thread can push requests, while only the timer thread takes them */
+    QAtomicPointer<StartRequest> m_startQueue;
 
     /** Flag for stopping all functions */
     bool m_stopAllFunctions;
 
+    /*************************************************************************
+     * Parallel tick
+     *************************************************************************/
+public:
+    /** Enable/disable the evaluation of independent functions
+     *  on a pool of worker threads. Disabled by default. */
+    void setParallelTickEnabled(bool enable);
+
+    /** Return true if the parallel tick mode is enabled */
+    bool parallelTickEnabled() const;
+
+private:
+    /** Flag that enables the parallel evaluation of functions */
+    bool m_parallelTick;
+
+    /** The pool of worker threads used in parallel tick mode */
+    QThreadPool *m_tickPool;
+
+    /*************************************************************************
+     * Timing statistics
+     *************************************************************************/
+public:
+    /** A snapshot of the timing recorded since the last reset.
+     *  Times are expressed in microseconds */
+    struct TimingStatistics
+    {
+        /** The number of ticks recorded */
+        quint64 ticks;
+        /** The number of ticks started more than half a tick late */
+        quint64 lateTicks;
+        /** The number of whole ticks skipped because of lateness */
+        quint64 missedTicks;
+        /** The time spent in timerTick() by all the recorded ticks */
+        quint64 totalDuration;
+        /** Width of a bin of intervalHistogram and durationHistogram */
+        int intervalBinSize;
+        int durationBinSize;
+        /** Histogram of the time between the start of two consecutive ticks.
+         *  The last bin collects everything exceeding the histogram range */
+        QVector<quint32> intervalHistogram;
+        /** Histogram of the time spent in timerTick() */
+        QVector<quint32> durationHistogram;
+        /** Worst interval and duration of the last minutes, oldest first.
+         *  The last item refers to the current (incomplete) minute */
+        QVector<int> worstIntervalPerMinute;
+        QVector<int> worstDurationPerMinute;
+    };
+
+    /** Get a copy of the timing statistics recorded so far */
+    TimingStatistics timingStatistics() const;
+
+    /** Clear all the recorded timing statistics */
+    void resetTimingStatistics();
+
+    /** Get only the counters of the timing statistics, which is
+     *  cheap enough to be polled often (see LoadGovernor) */
+    void timingCounters(quint64 *ticks, quint64 *lateTicks, quint64 *totalDuration) const;
+
+private:
+    /** Update the timing statistics with a tick that started at $start
+     *  nanoseconds and lasted $duration nanoseconds */
+    void recordTickTiming(qint64 start, qint64 duration);
+
+private:
+    /** The clock used to measure ticks */
+    QElapsedTimer *m_timingClock;
+
+    /** The start time of the previous tick in nanoseconds,
+     *  or -1 when the first tick has not been recorded yet */
+    qint64 m_lastTickStart;
+
+    /** The start time of the current minute in nanoseconds */
+    qint64 m_minuteStart;
+
+    /** Mutex that guards access to m_timingStats */
+    mutable QMutex m_timingMutex;
+
+    TimingStatistics m_timingStats;
+
+    /*************************************************************************
+     * Function timing
+     *************************************************************************/
+public:
+    /** The time spent in one kind of call of a Function, in microseconds.
+     *  The average is a rolling one, following the last calls */
+    struct CallTiming
+    {
+        quint64 calls;
+        double average;
+        int maximum;
+    };
+
+    /** The time spent in each call of a Function */
+    struct FunctionTiming
+    {
+        CallTiming write;
+        CallTiming preRun;
+        CallTiming postRun;
+    };
+
+    /** Enable/disable the measurement of the time spent in each Function.
+     *  Disabled by default. Enabling it clears the previous measurements */
+    void setFunctionTimingEnabled(bool enable);
+
+    /** Return true if the time spent in each Function is measured */
+    bool functionTimingEnabled() const;
+
+    /** Get a copy of the time spent so far in each Function, by ID */
+    QHash<quint32, FunctionTiming> functionTimings() const;
+
+    /** Clear the time spent in each Function */
+    void resetFunctionTimings();
+
+private:
+    enum FunctionCall { WriteCall, PreRunCall, PostRunCall };
+
+    /** Add a $call of the Function with the given $id that
+     *  lasted $duration nanoseconds */
+    void recordFunctionTiming(quint32 id, FunctionCall call, qint64 duration);
+
+private:
+    /** Flag that enables the function timing. Read by the pool threads too */
+    QAtomicInt m_functionTimingEnabled;
+
+    /** Mutex that guards access to m_functionTimings */
+    mutable QMutex m_functionTimingMutex;
+
+    QHash<quint32, FunctionTiming> m_functionTimings;
+
     /*************************************************************************
      * DMX Sources
      *************************************************************************/
@@ -158,11 +364,7 @@ private:
     /** List of currently registered DMX sources */
     QList <DMXSource*> m_dmxSourceList;
 
-    /** Mutex that guards access to m_dmxSourceList
-     *
-     * In case both m_functionListMutex and m_dmxSourceListMutex are needed,
-     * always lock m_functionListMutex first!
-     */
+    /** Mutex that guards access to m_dmxSourceList */
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
     QMutex m_dmxSourceListMutex;
 #else
@@ -214,18 +416,46 @@ public:
     /** Return true if the current tick is also a beat, otherwise false */
     bool isBeat() const;
 
+    /** Return how many milliseconds before the current tick the last beat
+     *  actually happened, since beats are fired only at tick boundaries.
+     *  When isBeat() is true, this is the phase a step synced to the beat
+     *  should start with */
+    int beatPhase() const;
+
     /** Request MasterTimer to generate a beat. This is typically used by
      *  external beat detectors/generators. Note that this is a request, and
      *  not an immediate beat generation, since MasterTimer still works with ticks
      *  so the requested beat will happen in the worst case after a s_tick time, so typically 20ms
      *  unless otherwise specified by MASTERTIMER_FREQUENCY.
-     *  This is quite safe cause even 300bpm should happen every 200ms. */
-    void requestBeat();
+     *  This is quite safe cause even 300bpm should happen every 200ms.
+     *  $delay is the time in milliseconds already elapsed since the beat
+     *  happened (e.g. the latency of an audio input), used to align
+     *  timeToNextBeat() to the actual beat. Can be called from any thread. */
+    void requestBeat(int delay = 0);
+
+    /** Align the beats generated when m_beatSourceType is "Internal" to an
+     *  external beat that happened $delay milliseconds ago, without waiting
+     *  for the external source to trigger every beat. If the generator was
+     *  late on that beat, the beat is fired at the next tick.
+     *  Can be called from any thread. */
+    void alignBeat(int delay);
 
 signals:
     void bpmNumberChanged(int bpm);
     void beat();
 
+private:
+    /** Get the milliseconds elapsed since the last restartBeatTimer() */
+    int beatElapsed() const;
+
+    /** Restart the measure of the time elapsed since the last beat */
+    void restartBeatTimer();
+
+    /** Measure the beats on a virtual clock, set to $time milliseconds,
+     *  instead of the wall clock. -1 goes back to the wall clock.
+     *  Used to render functions faster than real time (see OfflineRenderer) */
+    void setVirtualTime(int time);
+
 private:
     /** The current type of beat source */
     BeatsSourceType m_beatSourceType;
@@ -233,12 +463,25 @@ private:
     int m_currentBPM;
     /** The duration of a beat in milliseconds according to m_currentBPM */
     int m_beatTimeDuration;
+    /** The part of the beat duration below a millisecond, carried from a
+     *  beat to the next to avoid drifting, in 1/m_currentBPM milliseconds */
+    int m_beatRemainder;
+    int m_beatFraction;
     /** Flag to request a beat generation at the next MasterTimer tick */
     bool m_beatRequested;
     /** The reference of a platform dependent timer to measure precise elapsed time */
     QElapsedTimer *m_beatTimer;
     /** Time offset in milliseconds when the last beat occured */
     int m_lastBeatOffset;
+    /** The delay of the last beat requested with requestBeat() */
+    QAtomicInt m_requestedBeatDelay;
+    /** Flag raised by alignBeat(), and the delay it was called with */
+    QAtomicInt m_beatAlignRequested;
+    QAtomicInt m_requestedBeatAlign;
+    /** The virtual time in milliseconds, or -1 to use m_beatTimer */
+    int m_virtualTime;
+    /** The virtual time of the last restartBeatTimer() */
+    int m_virtualBeatStart;
 };
 
 /** @} */
@@ -0,0 +1,345 @@
+/*
+  Q Light Controller Plus
+  offlinerenderer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFileInfo>
+#include <QDebug>
+#include <QFile>
+
+#include "offlinerenderer.h"
+#include "inputoutputmap.h"
+#include "dmxrecorder.h"
+#include "mastertimer.h"
+#include "universe.h"
+#include "function.h"
+#include "qlcfile.h"
+#include "doc.h"
+
+#define KXMLQLCWorkspace "Workspace"
+
+/** Number of ticks between two writes of the recording file */
+#define FLUSH_TICKS 1000
+
+/** The first line of a checksums file */
+#define CHECKSUMS_HEADER "# QLC+ frame checksums"
+
+OfflineRenderer::OfflineRenderer(Doc *doc, QObject *parent)
+    : QObject(parent)
+    , m_doc(doc)
+    , m_ticks(0)
+    , m_frames(0)
+    , m_elapsed(0)
+    , m_checksumsEnabled(false)
+{
+    Q_ASSERT(doc != NULL);
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+}
+
+bool OfflineRenderer::loadWorkspace(const QString &fileName)
+{
+    QXmlStreamReader *doc = QLCFile::getXMLReader(fileName);
+    if (doc == NULL || doc->device() == NULL || doc->hasError())
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to read from" << fileName;
+        return false;
+    }
+
+    while (!doc->atEnd())
+    {
+        if (doc->readNext() == QXmlStreamReader::DTD)
+            break;
+    }
+
+    if (doc->hasError() || doc->dtdName() != KXMLQLCWorkspace ||
+        doc->readNextStartElement() == false || doc->name() != KXMLQLCWorkspace)
+    {
+        qWarning() << Q_FUNC_INFO << fileName << "is not a workspace file";
+        QLCFile::releaseXMLReader(doc);
+        return false;
+    }
+
+    m_doc->setWorkspacePath(QFileInfo(fileName).absolutePath());
+
+    bool loaded = false;
+    while (doc->readNextStartElement())
+    {
+        /* The Virtual Console and the Simple Desk are not rendered */
+        if (doc->name() == KXMLQLCEngine)
+            loaded = m_doc->loadXML(*doc);
+        else
+            doc->skipCurrentElement();
+    }
+
+    QLCFile::releaseXMLReader(doc);
+
+    if (loaded == false)
+        qWarning() << Q_FUNC_INFO << "No engine found in" << fileName;
+
+    return loaded;
+}
+
+bool OfflineRenderer::render(quint32 functionID, quint32 duration, const QString &fileName)
+{
+    m_ticks = 0;
+    m_frames = 0;
+    m_elapsed = 0;
+    m_checksums.clear();
+
+    Function *function = m_doc->function(functionID);
+    if (function == NULL)
+    {
+        qWarning() << Q_FUNC_INFO << "Function" << functionID << "not found";
+        return false;
+    }
+
+    MasterTimer *timer = m_doc->masterTimer();
+    InputOutputMap *ioMap = m_doc->inputOutputMap();
+    DMXRecorder *recorder = m_doc->dmxRecorder();
+
+    if (fileName.isEmpty() == false)
+    {
+        QList<quint32> universeIDs;
+        foreach (Universe *universe, ioMap->universes())
+            universeIDs.append(universe->id());
+
+        recorder->setVirtualTime(0);
+        if (recorder->start(fileName, universeIDs) == false)
+        {
+            recorder->setVirtualTime(-1);
+            return false;
+        }
+    }
+
+    foreach (Universe *universe, ioMap->universes())
+    {
+        connect(universe, SIGNAL(universeWritten(quint32,QByteArray)),
+                this, SLOT(slotUniverseWritten()), Qt::DirectConnection);
+    }
+
+    /* Nothing runs the event loop in the meantime, so the queued wake ups
+       of the universe threads would just pile up */
+    bool blocked = timer->blockSignals(true);
+
+    /* Beats follow the virtual time too */
+    timer->setVirtualTime(0);
+
+    quint32 limit = duration > 0 ? duration : OFFLINE_RENDER_MAX_DURATION;
+    quint32 time = 0;
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    function->start(timer, FunctionParent::master());
+
+    while (time < limit)
+    {
+        timer->timerTick();
+        m_ticks++;
+        time += MasterTimer::tick();
+        recorder->setVirtualTime(int(time));
+        timer->setVirtualTime(int(time));
+
+        QList<Universe *> universes = ioMap->claimUniverses();
+        foreach (Universe *universe, universes)
+            universe->processFaders();
+        if (m_checksumsEnabled)
+            recordChecksums(universes);
+        ioMap->releaseUniverses(false);
+
+        if (m_ticks % FLUSH_TICKS == 0 && recorder->isRecording())
+            recorder->slotFlush();
+
+        if (duration == 0 && function->isRunning() == false)
+            break;
+    }
+
+    /* A last tick to let the MasterTimer dismiss the function */
+    if (function->isRunning())
+    {
+        function->stop(FunctionParent::master());
+        timer->timerTick();
+    }
+
+    m_elapsed = wallClock.nsecsElapsed();
+
+    timer->setVirtualTime(-1);
+    timer->blockSignals(blocked);
+
+    if (recorder->isRecording())
+        recorder->stop();
+    recorder->setVirtualTime(-1);
+
+    foreach (Universe *universe, ioMap->universes())
+    {
+        disconnect(universe, SIGNAL(universeWritten(quint32,QByteArray)),
+                   this, SLOT(slotUniverseWritten()));
+    }
+
+    return true;
+}
+
+quint32 OfflineRenderer::ticks() const
+{
+    return m_ticks;
+}
+
+quint32 OfflineRenderer::frames() const
+{
+    return m_frames;
+}
+
+quint32 OfflineRenderer::renderedTime() const
+{
+    return m_ticks * MasterTimer::tick();
+}
+
+qint64 OfflineRenderer::elapsed() const
+{
+    return m_elapsed / 1000000;
+}
+
+double OfflineRenderer::ticksPerSecond() const
+{
+    if (m_elapsed <= 0)
+        return 0;
+
+    return double(m_ticks) * 1000000000.0 / double(m_elapsed);
+}
+
+/*****************************************************************************
+ * Frame checksums
+ *****************************************************************************/
+
+void OfflineRenderer::setChecksumsEnabled(bool enable)
+{
+    m_checksumsEnabled = enable;
+}
+
+bool OfflineRenderer::checksumsEnabled() const
+{
+    return m_checksumsEnabled;
+}
+
+QList<QVector<quint32> > OfflineRenderer::checksums() const
+{
+    return m_checksums;
+}
+
+/** 32 bit FNV-1a hash of $data */
+static quint32 frameChecksum(const QByteArray& data)
+{
+    quint32 hash = 2166136261U;
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+
+    for (int i = 0; i < data.size(); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+void OfflineRenderer::recordChecksums(const QList<Universe *> &universes)
+{
+    QVector<quint32> tick(universes.count());
+
+    for (int i = 0; i < universes.count(); i++)
+        tick[i] = frameChecksum(universes.at(i)->lastFrame());
+
+    m_checksums.append(tick);
+}
+
+/** Format the checksums of a tick as a line of a checksums file */
+static QString checksumsLine(uint index, const QVector<quint32>& tick)
+{
+    QString line = QString::number(index);
+
+    foreach (quint32 checksum, tick)
+        line.append(QString(" %1").arg(checksum, 8, 16, QChar('0')));
+
+    return line;
+}
+
+bool OfflineRenderer::saveChecksums(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to write" << fileName;
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << CHECKSUMS_HEADER << "\n";
+    stream << "# " << m_checksums.count() << " ticks of " << MasterTimer::tick() << " ms\n";
+
+    for (int i = 0; i < m_checksums.count(); i++)
+        stream << checksumsLine(i, m_checksums.at(i)) << "\n";
+
+    stream.flush();
+
+    return file.error() == QFile::NoError;
+}
+
+int OfflineRenderer::compareChecksums(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to read" << fileName;
+        return 0;
+    }
+
+    QTextStream stream(&file);
+    if (stream.readLine() != CHECKSUMS_HEADER)
+    {
+        qWarning() << Q_FUNC_INFO << fileName << "is not a checksums file";
+        return 0;
+    }
+
+    int index = 0;
+    while (stream.atEnd() == false)
+    {
+        QString line = stream.readLine();
+        if (line.startsWith("#"))
+            continue;
+
+        if (index >= m_checksums.count() || line != checksumsLine(index, m_checksums.at(index)))
+            return index;
+
+        index++;
+    }
+
+    /* The golden file is shorter than the render */
+    if (index < m_checksums.count())
+        return index;
+
+    return -1;
+}
+
+void OfflineRenderer::slotUniverseWritten()
+{
+    m_frames++;
+}
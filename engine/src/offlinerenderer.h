@@ -0,0 +1,148 @@
+/*
+  Q Light Controller Plus
+  offlinerenderer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QList>
+
+class Universe;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** The longest render of a function that never stops by itself, in ms */
+#define OFFLINE_RENDER_MAX_DURATION (60 * 60 * 1000)
+
+/**
+ * OfflineRenderer runs a function of a Doc in virtual time, as fast as the
+ * CPU allows, without the MasterTimer and universe threads. Each step runs
+ * one MasterTimer tick and the faders of every universe, advancing the
+ * virtual time by MasterTimer::tick() milliseconds, so two renders of the
+ * same workspace produce the same frames.
+ *
+ * The output of all the universes is written to a DMX recording file (see
+ * DMXRecorder), or just discarded when no file is given, to measure the
+ * engine throughput.
+ *
+ * The beats of the internal beat generator are measured in virtual time
+ * too, and no input plugin is involved, so the output depends only on the
+ * workspace. To prove it, a render can record a checksum of each universe
+ * at each tick and compare the stream against a golden file saved by a
+ * previous render (see saveChecksums() and compareChecksums()).
+ *
+ * The Doc MasterTimer must not be running during a render.
+ */
+class OfflineRenderer : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(OfflineRenderer)
+
+public:
+    OfflineRenderer(Doc *doc, QObject *parent = NULL);
+    ~OfflineRenderer();
+
+    /**
+     * Load the Engine part of a workspace file into the Doc, skipping the
+     * user interface parts.
+     */
+    bool loadWorkspace(const QString& fileName);
+
+    /**
+     * Render the function with the given ID for the given time, in
+     * milliseconds. With a zero duration, the render ends when the
+     * function stops, or after OFFLINE_RENDER_MAX_DURATION.
+     *
+     * @param functionID The function to start
+     * @param duration The time to render in milliseconds, or 0
+     * @param fileName The DMX recording to write, or empty for none
+     * @return false if the function or the recording cannot be started
+     */
+    bool render(quint32 functionID, quint32 duration,
+                const QString& fileName = QString());
+
+    /** Get the number of ticks run by the last render */
+    quint32 ticks() const;
+
+    /** Get the number of frames written by the universes in the last render */
+    quint32 frames() const;
+
+    /** Get the virtual time rendered by the last render, in milliseconds */
+    quint32 renderedTime() const;
+
+    /** Get the wall clock time taken by the last render, in milliseconds */
+    qint64 elapsed() const;
+
+    /** Get the ticks run per second of wall clock time by the last render */
+    double ticksPerSecond() const;
+
+    /*********************************************************************
+     * Frame checksums
+     *********************************************************************/
+public:
+    /** Enable/disable the recording of the frame checksums of the next
+     *  renders. Disabled by default */
+    void setChecksumsEnabled(bool enable);
+
+    /** Return true if the frame checksums are recorded */
+    bool checksumsEnabled() const;
+
+    /** Get the checksums of each universe at each tick of the last render */
+    QList<QVector<quint32> > checksums() const;
+
+    /** Write the checksums of the last render to $fileName, as text with one
+     *  line per tick, to be used as a golden file by compareChecksums() */
+    bool saveChecksums(const QString& fileName) const;
+
+    /**
+     * Compare the checksums of the last render with the ones in $fileName,
+     * saved by saveChecksums().
+     *
+     * @return the index of the first tick that differs, or -1 if all the
+     *         ticks match. A file that cannot be read differs at tick 0
+     */
+    int compareChecksums(const QString& fileName) const;
+
+private:
+    /** Checksum the output of $universes after a tick */
+    void recordChecksums(const QList<Universe *>& universes);
+
+private slots:
+    void slotUniverseWritten();
+
+private:
+    Doc *m_doc;
+    quint32 m_ticks;
+    quint32 m_frames;
+
+    /** Wall clock time of the last render, in nanoseconds */
+    qint64 m_elapsed;
+
+    bool m_checksumsEnabled;
+    QList<QVector<quint32> > m_checksums;
+};
+
+/** @} */
+
+#endif
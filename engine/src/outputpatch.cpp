@@ -24,11 +24,37 @@
 #   include <unistd.h>
 #endif
 
+#include <QSettings>
+#include <QThread>
+
 #include "qlcioplugin.h"
 #include "outputpatch.h"
+#include "ticktrace.h"
 
 #define GRACE_MS 1
 
+#define SETTINGS_OUTPUT_ASYNC "outputpatch/async"
+
+/** The thread sending the frames of an OutputPatch in async mode */
+class OutputPatchSender : public QThread
+{
+public:
+    OutputPatchSender(OutputPatch *patch)
+        : QThread()
+        , m_patch(patch)
+    {
+    }
+
+protected:
+    void run()
+    {
+        m_patch->sendFrames();
+    }
+
+private:
+    OutputPatch *m_patch;
+};
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -40,7 +66,25 @@ OutputPatch::OutputPatch(QObject* parent)
     , m_universe(UINT_MAX)
     , m_paused(false)
     , m_blackout(false)
+    , m_fullFrame(true)
+    , m_sender(NULL)
+    , m_mailboxUniverse(UINT_MAX)
+    , m_mailboxStart(0)
+    , m_mailboxCount(0)
+    , m_mailboxPending(false)
+    , m_senderRunning(false)
+    , m_refreshRate(0)
+    , m_skipDuplicates(false)
+    , m_keepaliveInterval(0)
+    , m_lastSendTime(-1)
+    , m_skippedStart(0)
+    , m_skippedCount(0)
+    , m_skippedPending(false)
 {
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_OUTPUT_ASYNC);
+    if (var.isValid() == true && var.toBool() == true)
+        setAsync(true);
 }
 
 OutputPatch::OutputPatch(quint32 universe, QObject* parent)
@@ -50,11 +94,31 @@ OutputPatch::OutputPatch(quint32 universe, QObject* parent)
     , m_universe(universe)
     , m_paused(false)
     , m_blackout(false)
+    , m_fullFrame(true)
+    , m_sender(NULL)
+    , m_mailboxUniverse(UINT_MAX)
+    , m_mailboxStart(0)
+    , m_mailboxCount(0)
+    , m_mailboxPending(false)
+    , m_senderRunning(false)
+    , m_refreshRate(0)
+    , m_skipDuplicates(false)
+    , m_keepaliveInterval(0)
+    , m_lastSendTime(-1)
+    , m_skippedStart(0)
+    , m_skippedCount(0)
+    , m_skippedPending(false)
 {
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_OUTPUT_ASYNC);
+    if (var.isValid() == true && var.toBool() == true)
+        setAsync(true);
 }
 
 OutputPatch::~OutputPatch()
 {
+    setAsync(false);
+
     if (m_plugin != NULL)
         m_plugin->closeOutput(m_pluginLine, m_universe);
 }
@@ -70,6 +134,7 @@ bool OutputPatch::set(QLCIOPlugin* plugin, quint32 output)
 
     m_plugin = plugin;
     m_pluginLine = output;
+    m_fullFrame = true;
 
     if (m_plugin != NULL)
     {
@@ -95,6 +160,7 @@ bool OutputPatch::reconnect()
         usleep(GRACE_MS * 1000);
 #endif
         bool ret = m_plugin->openOutput(m_pluginLine, m_universe);
+        m_fullFrame = true;
         if (ret == true)
         {
             foreach(QString par, m_parametersCache.keys())
@@ -170,6 +236,7 @@ void OutputPatch::setPaused(bool paused)
         return;
 
     m_paused = paused;
+    m_fullFrame = true;
 
     if (m_pauseBuffer.length())
         m_pauseBuffer.clear();
@@ -188,11 +255,65 @@ void OutputPatch::setBlackout(bool blackout)
         return;
 
     m_blackout = blackout;
+    m_fullFrame = true;
     emit blackoutChanged(m_blackout);
 }
 
-void OutputPatch::dump(quint32 universe, const QByteArray& data)
+void OutputPatch::dump(quint32 universe, const QByteArray& data,
+                       int changedStart, int changedCount)
 {
+    TICK_TRACE_ARG("OutputPatch::dump", universe);
+
+    if (frameDue(changedStart, changedCount) == false)
+        return;
+
+    if (m_sender == NULL)
+    {
+        write(universe, data, changedStart, changedCount);
+        return;
+    }
+
+    QMutexLocker locker(&m_mailboxMutex);
+
+    if (m_mailboxPending)
+    {
+        /* The previous frame has not been sent: replace it, but keep
+         * what it changed, since the plugin has never received it */
+        m_droppedFrames.fetchAndAddRelaxed(1);
+
+        if (m_mailboxCount < 0 || changedCount < 0)
+        {
+            m_mailboxCount = -1;
+        }
+        else if (m_mailboxCount == 0)
+        {
+            m_mailboxStart = changedStart;
+            m_mailboxCount = changedCount;
+        }
+        else if (changedCount > 0)
+        {
+            int end = qMax(m_mailboxStart + m_mailboxCount, changedStart + changedCount);
+            m_mailboxStart = qMin(m_mailboxStart, changedStart);
+            m_mailboxCount = end - m_mailboxStart;
+        }
+    }
+    else
+    {
+        m_mailboxStart = changedStart;
+        m_mailboxCount = changedCount;
+    }
+
+    m_mailboxData = data;
+    m_mailboxUniverse = universe;
+    m_mailboxPending = true;
+    m_mailboxCondition.wakeOne();
+}
+
+void OutputPatch::write(quint32 universe, const QByteArray &data,
+                        int changedStart, int changedCount)
+{
+    TICK_TRACE_ARG("OutputPatch::write", universe);
+
     /* Don't do anything if there is no plugin and/or output line. */
     if (m_plugin != NULL && m_pluginLine != QLCIOPlugin::invalidLine())
     {
@@ -201,11 +322,209 @@ void OutputPatch::dump(quint32 universe, const QByteArray& data)
             if (m_pauseBuffer.isNull())
                 m_pauseBuffer.append(data);
 
-            m_plugin->writeUniverse(universe, m_pluginLine, m_pauseBuffer);
+            /* The paused buffer never changes once it has been sent */
+            m_plugin->writeUniverseDelta(universe, m_pluginLine, m_pauseBuffer,
+                                         0, m_fullFrame ? m_pauseBuffer.size() : 0);
         }
         else
         {
-            m_plugin->writeUniverse(universe, m_pluginLine, data);
+            if (changedCount < 0 || m_fullFrame)
+            {
+                changedStart = 0;
+                changedCount = data.size();
+            }
+
+            m_plugin->writeUniverseDelta(universe, m_pluginLine, data,
+                                         changedStart, changedCount);
+        }
+        m_fullFrame = false;
+        m_sentFrames.fetchAndAddRelaxed(1);
+    }
+}
+
+/*****************************************************************************
+ * Asynchronous sending
+ *****************************************************************************/
+
+void OutputPatch::setAsync(bool enable)
+{
+    if (enable == (m_sender != NULL))
+        return;
+
+    if (enable)
+    {
+        m_senderRunning = true;
+        m_sender = new OutputPatchSender(this);
+        m_sender->start();
+        return;
+    }
+
+    m_mailboxMutex.lock();
+    m_senderRunning = false;
+    m_mailboxCondition.wakeOne();
+    m_mailboxMutex.unlock();
+
+    m_sender->wait();
+    delete m_sender;
+    m_sender = NULL;
+
+    /* Don't lose the last frame stored */
+    if (m_mailboxPending)
+    {
+        m_mailboxPending = false;
+        write(m_mailboxUniverse, m_mailboxData, m_mailboxStart, m_mailboxCount);
+        m_mailboxData.clear();
+    }
+}
+
+bool OutputPatch::async() const
+{
+    return m_sender != NULL;
+}
+
+quint32 OutputPatch::droppedFrames() const
+{
+    return quint32(m_droppedFrames.loadAcquire());
+}
+
+void OutputPatch::sendFrames()
+{
+    QMutexLocker locker(&m_mailboxMutex);
+
+    while (m_senderRunning)
+    {
+        if (m_mailboxPending == false)
+        {
+            m_mailboxCondition.wait(&m_mailboxMutex);
+            continue;
         }
+
+        QByteArray data = m_mailboxData;
+        quint32 universe = m_mailboxUniverse;
+        int changedStart = m_mailboxStart;
+        int changedCount = m_mailboxCount;
+
+        /* Release the universe frame, so that it is not detached */
+        m_mailboxData.clear();
+        m_mailboxPending = false;
+
+        locker.unlock();
+        write(universe, data, changedStart, changedCount);
+        locker.relock();
     }
 }
+
+/*****************************************************************************
+ * Frame rate
+ *****************************************************************************/
+
+int OutputPatch::refreshRate() const
+{
+    return m_refreshRate;
+}
+
+void OutputPatch::setRefreshRate(int rate)
+{
+    m_refreshRate = qMax(0, rate);
+}
+
+bool OutputPatch::skipDuplicates() const
+{
+    return m_skipDuplicates;
+}
+
+void OutputPatch::setSkipDuplicates(bool enable)
+{
+    m_skipDuplicates = enable;
+}
+
+int OutputPatch::keepaliveInterval() const
+{
+    return m_keepaliveInterval;
+}
+
+void OutputPatch::setKeepaliveInterval(int msec)
+{
+    m_keepaliveInterval = qMax(0, msec);
+}
+
+quint32 OutputPatch::skippedFrames() const
+{
+    return quint32(m_skippedFrames.loadAcquire());
+}
+
+bool OutputPatch::frameDue(int &changedStart, int &changedCount)
+{
+    if (m_refreshRate == 0 && m_skipDuplicates == false && m_skippedPending == false)
+        return true;
+
+    if (m_rateTimer.isValid() == false)
+        m_rateTimer.start();
+
+    qint64 now = m_rateTimer.nsecsElapsed() / 1000;
+
+    /* Add what the skipped frames changed */
+    if (m_skippedPending)
+    {
+        if (m_skippedCount < 0 || changedCount < 0)
+        {
+            changedCount = -1;
+        }
+        else if (changedCount == 0)
+        {
+            changedStart = m_skippedStart;
+            changedCount = m_skippedCount;
+        }
+        else if (m_skippedCount > 0)
+        {
+            int end = qMax(m_skippedStart + m_skippedCount, changedStart + changedCount);
+            changedStart = qMin(m_skippedStart, changedStart);
+            changedCount = end - changedStart;
+        }
+    }
+
+    bool due = true;
+
+    if (m_lastSendTime >= 0)
+    {
+        qint64 elapsed = now - m_lastSendTime;
+        bool duplicate = changedCount == 0 && m_fullFrame == false && m_paused == false;
+
+        if (m_refreshRate > 0 && elapsed < 1000000 / m_refreshRate)
+            due = false;
+        else if (duplicate && m_skipDuplicates &&
+                 (m_keepaliveInterval == 0 || elapsed < qint64(m_keepaliveInterval) * 1000))
+            due = false;
+    }
+
+    if (due == false)
+    {
+        m_skippedStart = changedStart;
+        m_skippedCount = changedCount;
+        m_skippedPending = true;
+        m_skippedFrames.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    m_skippedPending = false;
+    m_lastSendTime = now;
+
+    return true;
+}
+
+/*****************************************************************************
+ * Statistics
+ *****************************************************************************/
+
+quint32 OutputPatch::sentFrames() const
+{
+    return quint32(m_sentFrames.loadAcquire());
+}
+
+quint32 OutputPatch::outputErrors() const
+{
+    if (m_plugin == NULL || m_pluginLine == QLCIOPlugin::invalidLine())
+        return 0;
+
+    return m_plugin->outputErrors(m_pluginLine);
+}
@@ -20,9 +20,14 @@
 #ifndef OUTPUTPATCH_H
 #define OUTPUTPATCH_H
 
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QAtomicInt>
 #include <QObject>
+#include <QMutex>
 #include <QMap>
 
+class OutputPatchSender;
 class QLCIOPlugin;
 
 /** @addtogroup engine Engine
@@ -117,18 +122,125 @@ public:
     void setBlackout(bool blackout);
 
     /** Write the contents of a 512 channel value buffer to the plugin.
+      * $changedStart and $changedCount describe the channel range that
+      * changed since the previous frame (a count of -1 means the whole
+      * buffer, 0 means nothing changed).
       * Called periodically by OutputMap. No need to call manually. */
-    void dump(quint32 universe, const QByteArray &data);
+    void dump(quint32 universe, const QByteArray &data,
+              int changedStart = 0, int changedCount = -1);
 
 signals:
     void pausedChanged(bool paused);
     void blackoutChanged(bool blackout);
 
+private:
+    /** Send a frame to the plugin, in the calling thread */
+    void write(quint32 universe, const QByteArray &data,
+               int changedStart, int changedCount);
+
 private:
     /** A buffer used when this output patch is paused */
     QByteArray m_pauseBuffer;
     bool m_paused;
     bool m_blackout;
+    /** Flag to send the next frame as fully changed, since the plugin
+     *  last received something different from the universe data */
+    bool m_fullFrame;
+
+    /********************************************************************
+     * Asynchronous sending
+     ********************************************************************/
+public:
+    /** Enable/disable sending frames from a thread owned by this patch.
+     *  When enabled, dump() only stores the frame and returns at once:
+     *  frames arriving while the plugin is still busy replace the
+     *  stored one, so a slow plugin skips frames instead of delaying
+     *  the universe. The default is taken from the application settings */
+    void setAsync(bool enable);
+    bool async() const;
+
+    /** Return the number of frames replaced before being sent */
+    quint32 droppedFrames() const;
+
+    /********************************************************************
+     * Frame rate
+     ********************************************************************/
+public:
+    /** Get/Set the maximum number of frames sent per second.
+     *  0 means every frame of the universe is sent */
+    int refreshRate() const;
+    void setRefreshRate(int rate);
+
+    /** Get/Set if frames identical to the last one sent are skipped */
+    bool skipDuplicates() const;
+    void setSkipDuplicates(bool enable);
+
+    /** Get/Set the maximum time in milliseconds between two frames
+     *  sent, even if they are identical. 0 means no keepalive */
+    int keepaliveInterval() const;
+    void setKeepaliveInterval(int msec);
+
+    /** Return the number of frames not sent because of the refresh
+     *  rate or because they were identical to the previous one */
+    quint32 skippedFrames() const;
+
+private:
+    /** Check if a frame has to be sent, according to the refresh rate,
+     *  duplicates and keepalive settings. The range of a skipped frame
+     *  is kept and merged into the range of the next frame sent */
+    bool frameDue(int &changedStart, int &changedCount);
+
+private:
+    int m_refreshRate;
+    bool m_skipDuplicates;
+    int m_keepaliveInterval;
+
+    QElapsedTimer m_rateTimer;
+    /** The time of the last frame sent, in microseconds */
+    qint64 m_lastSendTime;
+    /** The range changed by the frames skipped since the last sent */
+    int m_skippedStart;
+    int m_skippedCount;
+    bool m_skippedPending;
+
+    QAtomicInt m_skippedFrames;
+
+private:
+    /** Wait for a frame to be stored by dump() and send it,
+     *  until async mode is disabled. Run by the sender thread */
+    void sendFrames();
+
+private:
+    friend class OutputPatchSender;
+
+    OutputPatchSender *m_sender;
+
+    /** The latest frame stored by dump(), waiting to be sent */
+    QMutex m_mailboxMutex;
+    QWaitCondition m_mailboxCondition;
+    QByteArray m_mailboxData;
+    quint32 m_mailboxUniverse;
+    /** Union of the ranges changed since the last frame sent */
+    int m_mailboxStart;
+    int m_mailboxCount;
+    bool m_mailboxPending;
+    bool m_senderRunning;
+
+    QAtomicInt m_droppedFrames;
+
+    /********************************************************************
+     * Statistics
+     ********************************************************************/
+public:
+    /** Return the number of frames handed to the plugin */
+    quint32 sentFrames() const;
+
+    /** Return the number of frames the plugin failed to transmit
+     *  on the patched line, as reported by the plugin */
+    quint32 outputErrors() const;
+
+private:
+    QAtomicInt m_sentFrames;
 };
 
 /** @} */
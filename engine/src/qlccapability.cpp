@@ -26,6 +26,7 @@
 #include <QFile>
 
 #include "qlccapability.h"
+#include "qlcstringpool.h"
 #include "qlcmacros.h"
 #include "qlcconfig.h"
 #include "qlcfile.h"
@@ -402,7 +403,7 @@ bool QLCCapability::loadXML(QXmlStreamReader &doc)
                 QDir dir = QLCFile::systemDirectory(GOBODIR);
                 path = dir.path() + QDir::separator() + path;
             }
-            setResource(0, path);
+            setResource(0, QLCStringPool::intern(path));
         }
         break;
         case SingleColor:
@@ -452,7 +453,7 @@ bool QLCCapability::loadXML(QXmlStreamReader &doc)
         }
         else
             setPreset(GenericPicture);
-        setResource(0, path);
+        setResource(0, QLCStringPool::intern(path));
     }
 
     /* Get (optional) color resource for color presets */
@@ -482,7 +483,7 @@ bool QLCCapability::loadXML(QXmlStreamReader &doc)
     if (min <= max)
     {
         doc.readNext();
-        setName(doc.text().toString().simplified());
+        setName(QLCStringPool::intern(doc.text().toString().simplified()));
         setMin(min);
         setMax(max);
         if (name().isEmpty())
@@ -506,9 +507,9 @@ bool QLCCapability::loadXML(QXmlStreamReader &doc)
             AliasInfo alias;
             QXmlStreamAttributes attrs = doc.attributes();
 
-            alias.targetMode = attrs.value(KXMLQLCCapabilityAliasMode).toString();
-            alias.sourceChannel = attrs.value(KXMLQLCCapabilityAliasSourceName).toString();
-            alias.targetChannel = attrs.value(KXMLQLCCapabilityAliasTargetName).toString();
+            alias.targetMode = QLCStringPool::intern(attrs.value(KXMLQLCCapabilityAliasMode).toString());
+            alias.sourceChannel = QLCStringPool::intern(attrs.value(KXMLQLCCapabilityAliasSourceName).toString());
+            alias.targetChannel = QLCStringPool::intern(attrs.value(KXMLQLCCapabilityAliasTargetName).toString());
             addAlias(alias);
 
             //qDebug() << "Alias found for mode" << alias.targetMode;
@@ -29,6 +29,7 @@
 
 #include "qlcchannel.h"
 #include "qlccapability.h"
+#include "qlcstringpool.h"
 
 #define KXMLQLCChannelGroupIntensity   QString("Intensity")
 #define KXMLQLCChannelGroupColour      QString("Colour")
@@ -63,6 +64,7 @@ QLCChannel::QLCChannel(QObject *parent)
     , m_defaultValue(0)
     , m_controlByte(MSB)
     , m_colour(NoColour)
+    , m_capabilityTable(NULL)
 {
 }
 
@@ -93,6 +95,8 @@ QLCChannel *QLCChannel::createCopy()
 
 QLCChannel::~QLCChannel()
 {
+    invalidateCapabilityTable();
+
     while (m_capabilities.isEmpty() == false)
         delete m_capabilities.takeFirst();
 }
@@ -111,6 +115,7 @@ QLCChannel& QLCChannel::operator=(const QLCChannel& channel)
         m_colour = channel.m_colour;
 
         /* Clear old capabilities */
+        invalidateCapabilityTable();
         while (m_capabilities.isEmpty() == false)
             delete m_capabilities.takeFirst();
 
@@ -969,15 +974,41 @@ const QList <QLCCapability*> QLCChannel::capabilities() const
 
 QLCCapability* QLCChannel::searchCapability(uchar value) const
 {
+    QLCCapability **table = m_capabilityTable.loadAcquire();
+    if (table == NULL)
+        table = capabilityTable();
+
+    return table[value];
+}
+
+QLCCapability **QLCChannel::capabilityTable() const
+{
+    QLCCapability **table = new QLCCapability*[UCHAR_MAX + 1];
+    for (int i = 0; i <= UCHAR_MAX; i++)
+        table[i] = NULL;
+
+    /* Capabilities don't overlap, so each value has one owner at most */
     QListIterator <QLCCapability*> it(m_capabilities);
     while (it.hasNext() == true)
     {
         QLCCapability* capability = it.next();
-        if (capability->min() <= value && capability->max() >= value)
-            return capability;
+        for (int i = capability->min(); i <= capability->max(); i++)
+            table[i] = capability;
     }
 
-    return NULL;
+    /* Another thread may have built the same table in the meantime */
+    if (m_capabilityTable.testAndSetOrdered(NULL, table) == false)
+    {
+        delete[] table;
+        table = m_capabilityTable.loadAcquire();
+    }
+
+    return table;
+}
+
+void QLCChannel::invalidateCapabilityTable()
+{
+    delete[] m_capabilityTable.fetchAndStoreOrdered(NULL);
 }
 
 QLCCapability* QLCChannel::searchCapability(const QString& name,
@@ -1009,6 +1040,7 @@ bool QLCChannel::addCapability(QLCCapability* cap)
     }
 
     m_capabilities.append(cap);
+    invalidateCapabilityTable();
     return true;
 }
 
@@ -1035,6 +1067,7 @@ bool QLCChannel::setCapabilityRange(QLCCapability* cap, uchar min, uchar max)
         }
     }
 
+    invalidateCapabilityTable();
     return true;
 }
 
@@ -1049,6 +1082,7 @@ bool QLCChannel::removeCapability(QLCCapability* cap)
         {
             it.remove();
             delete cap;
+            invalidateCapabilityTable();
             return true;
         }
     }
@@ -1123,7 +1157,7 @@ bool QLCChannel::loadXML(QXmlStreamReader &doc)
     QString str = attrs.value(KXMLQLCChannelName).toString();
     if (str.isEmpty() == true)
         return false;
-    setName(str);
+    setName(QLCStringPool::intern(str));
 
     if (attrs.hasAttribute(KXMLQLCChannelDefault))
     {
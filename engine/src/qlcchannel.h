@@ -21,6 +21,7 @@
 #ifndef QLCCHANNEL_H
 #define QLCCHANNEL_H
 
+#include <QAtomicPointer>
 #include <climits>
 #include <QString>
 #include <QList>
@@ -344,7 +345,11 @@ public:
     /** Get a list of channel's capabilities */
     const QList <QLCCapability*> capabilities() const;
 
-    /** Search for a particular capability by its channel value */
+    /**
+     * Search for a particular capability by its channel value. The lookup
+     * table is built by the first search after a change to the capabilities,
+     * so the following searches are a single indexed load.
+     */
     QLCCapability* searchCapability(uchar value) const;
 
     /**
@@ -373,10 +378,20 @@ public:
     /** Sort capabilities to ascending order by their values */
     void sortCapabilities();
 
+protected:
+    /** Build the value-to-capability lookup table of searchCapability() */
+    QLCCapability **capabilityTable() const;
+
+    /** Discard the lookup table, after the capabilities have changed */
+    void invalidateCapabilityTable();
+
 protected:
     /** List of channel's capabilities */
     QList <QLCCapability*> m_capabilities;
 
+    /** 256 capability pointers indexed by value, NULL until needed */
+    mutable QAtomicPointer<QLCCapability *> m_capabilityTable;
+
     /*********************************************************************
      * File operations
      *********************************************************************/
@@ -37,14 +37,14 @@ void QLCClipboard::resetContents()
     m_copyFunction = NULL;
 }
 
-void QLCClipboard::copyContent(quint32 sourceID, QList<ChaserStep> steps)
+void QLCClipboard::copyContent(quint32 sourceID, const QList<ChaserStep> &steps)
 {
     Q_UNUSED(sourceID)
 
     m_copySteps = steps;
 }
 
-void QLCClipboard::copyContent(quint32 sourceID, QList<SceneValue> values)
+void QLCClipboard::copyContent(quint32 sourceID, const QList<SceneValue> &values)
 {
     Q_UNUSED(sourceID)
 
@@ -62,7 +62,8 @@ void QLCClipboard::copyContent(quint32 sourceID, Function *function)
         delete m_copyFunction;
     m_copyFunction = NULL;
 
-    /* Attempt to create a copy of the function to Doc */
+    /* Attempt to create a copy of the function, out of Doc. Its steps and
+     * values are implicitly shared with the source, so this is cheap */
     Function* copy = function->createCopy(m_doc, false);
     if (copy != NULL)
     {
@@ -71,7 +72,7 @@ void QLCClipboard::copyContent(quint32 sourceID, Function *function)
     }
 }
 
-bool QLCClipboard::hasChaserSteps()
+bool QLCClipboard::hasChaserSteps() const
 {
     if (m_copySteps.count() > 0)
         return true;
@@ -79,7 +80,7 @@ bool QLCClipboard::hasChaserSteps()
     return false;
 }
 
-bool QLCClipboard::hasSceneValues()
+bool QLCClipboard::hasSceneValues() const
 {
     if (m_copySceneValues.count() > 0)
         return true;
@@ -87,7 +88,7 @@ bool QLCClipboard::hasSceneValues()
     return false;
 }
 
-bool QLCClipboard::hasFunction()
+bool QLCClipboard::hasFunction() const
 {
     if (m_copyFunction != NULL)
         return true;
@@ -95,17 +96,17 @@ bool QLCClipboard::hasFunction()
     return false;
 }
 
-QList<ChaserStep> QLCClipboard::getChaserSteps()
+QList<ChaserStep> QLCClipboard::getChaserSteps() const
 {
     return m_copySteps;
 }
 
-QList<SceneValue> QLCClipboard::getSceneValues()
+QList<SceneValue> QLCClipboard::getSceneValues() const
 {
     return m_copySceneValues;
 }
 
-Function *QLCClipboard::getFunction()
+Function *QLCClipboard::getFunction() const
 {
     return m_copyFunction;
 }
@@ -33,6 +33,16 @@ class Doc;
  * @{
  */
 
+/**
+ * QLCClipboard keeps what has been copied until it is pasted.
+ *
+ * Its contents are never deep-copied: steps and values lists are implicitly
+ * shared with the lists they have been copied from, and a copied Function
+ * is a copy whose steps and values are shared with the source in the same
+ * way. The data is duplicated only when either the source or the pasted
+ * object is modified, so copying and pasting a big Sequence costs the same
+ * as a small one.
+ */
 class QLCClipboard: public QObject
 {
     Q_OBJECT
@@ -51,17 +61,27 @@ private:
      ********************************************************************/
 
 public:
-    void copyContent(quint32 sourceID, QList <ChaserStep> steps);
-    void copyContent(quint32 sourceID, QList <SceneValue> values);
+    void copyContent(quint32 sourceID, const QList <ChaserStep> &steps);
+    void copyContent(quint32 sourceID, const QList <SceneValue> &values);
+
+    /** Keep a copy of $function, sharing its contents with the source */
     void copyContent(quint32 sourceID, Function *function);
 
-    bool hasChaserSteps();
-    bool hasSceneValues();
-    bool hasFunction();
+    bool hasChaserSteps() const;
+    bool hasSceneValues() const;
+    bool hasFunction() const;
+
+    /** Return the copied steps. The list is shared with the clipboard
+     *  until it is modified */
+    QList <ChaserStep> getChaserSteps() const;
+
+    /** Return the copied values. The list is shared with the clipboard
+     *  until it is modified */
+    QList <SceneValue> getSceneValues() const;
 
-    QList <ChaserStep> getChaserSteps();
-    QList <SceneValue> getSceneValues();
-    Function *getFunction();
+    /** Return the copied Function. It belongs to the clipboard and must
+     *  not be modified: paste a createCopy() of it instead */
+    Function *getFunction() const;
 
 private:
     QList <ChaserStep> m_copySteps;
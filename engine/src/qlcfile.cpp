@@ -21,6 +21,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QCoreApplication>
+#include <QBuffer>
 #include <QFile>
 
 #ifdef QT_XML_LIB
@@ -55,6 +56,23 @@ QXmlStreamReader *QLCFile::getXMLReader(const QString &path)
     }
 
     QFile *file = new QFile(path);
+
+    /* Compressed files are uncompressed in memory. They are binary,
+       so check for them before opening the file in text mode */
+    if (file->open(QIODevice::ReadOnly) == true &&
+        isCompressedXML(file->peek(int(qstrlen(KCompressedXMLMagic)))))
+    {
+        QByteArray data = file->readAll();
+        file->close();
+        delete file;
+
+        reader = getXMLReader(data);
+        if (reader == NULL)
+            qWarning() << Q_FUNC_INFO << "Damaged compressed file:" << path;
+        return reader;
+    }
+    file->close();
+
     if (file->open(QIODevice::ReadOnly | QFile::Text) == true)
     {
         reader = new QXmlStreamReader(file);
@@ -62,11 +80,53 @@ QXmlStreamReader *QLCFile::getXMLReader(const QString &path)
     else
     {
         qWarning() << Q_FUNC_INFO << "Unable to open file:" << path;
+        delete file;
     }
 
     return reader;
 }
 
+QXmlStreamReader *QLCFile::getXMLReader(const QByteArray &data)
+{
+    QBuffer *buffer = new QBuffer();
+
+    if (isCompressedXML(data))
+    {
+        QByteArray xml = qUncompress(data.mid(int(qstrlen(KCompressedXMLMagic))));
+        if (xml.isEmpty())
+        {
+            delete buffer;
+            return NULL;
+        }
+        buffer->setData(xml);
+    }
+    else
+    {
+        buffer->setData(data);
+    }
+
+    buffer->open(QIODevice::ReadOnly | QIODevice::Text);
+
+    return new QXmlStreamReader(buffer);
+}
+
+QByteArray QLCFile::compressXML(const QByteArray &xml)
+{
+    QByteArray data(KCompressedXMLMagic);
+    data.append(qCompress(xml));
+    return data;
+}
+
+bool QLCFile::isCompressedXML(const QByteArray &data)
+{
+    return data.startsWith(KCompressedXMLMagic);
+}
+
+bool QLCFile::isCompressedWorkspace(const QString &fileName)
+{
+    return fileName.endsWith(KExtCompressedWorkspace, Qt::CaseInsensitive);
+}
+
 void QLCFile::releaseXMLReader(QXmlStreamReader *reader)
 {
     if (reader == NULL)
@@ -42,6 +42,7 @@ class QString;
 #define KExtFixture          ".qxf"  // 'Q'LC+ 'X'ml 'F'ixture
 #define KExtFixtureList      ".qxfl" // 'Q'LC+ 'X'ml 'F'ixture 'L'ist
 #define KExtWorkspace        ".qxw"  // 'Q'LC+ 'X'ml 'W'orkspace
+#define KExtCompressedWorkspace ".qxwz" // 'Q'LC+ 'X'ml 'W'orkspace, 'Z'ipped
 #define KExtInputProfile     ".qxi"  // 'Q'LC+ 'X'ml 'I'nput profile
 #define KExtModifierTemplate ".qxmt" // 'Q'LC+ 'X'ml 'M'odifier 'T'emplate
 
@@ -63,6 +64,10 @@ class QString;
 #define KXMLQLCCreatorVersion "Version"
 #define KXMLQLCCreatorAuthor "Author"
 
+/** The first bytes of a compressed XML file, followed by the XML
+ *  compressed with qCompress() */
+#define KCompressedXMLMagic "QLCZ"
+
 // True and false
 #define KXMLQLCTrue "True"
 #define KXMLQLCFalse "False"
@@ -78,6 +83,31 @@ public:
      */
     static QXmlStreamReader *getXMLReader(const QString& path);
 
+    /**
+     * Request a QXmlStreamReader for the XML data in $data.
+     * Compressed data, as produced by compressXML(), is uncompressed first.
+     * The reader owns the data buffer, which is freed by releaseXMLReader().
+     *
+     * @param data The XML data to read
+     * @return QXmlStreamReader, or NULL if compressed data is damaged
+     */
+    static QXmlStreamReader *getXMLReader(const QByteArray& data);
+
+    /**
+     * Compress XML data. getXMLReader() recognizes the compressed data
+     * and reads it like a plain XML file.
+     *
+     * @param xml The XML data to compress
+     * @return The compressed data, beginning with KCompressedXMLMagic
+     */
+    static QByteArray compressXML(const QByteArray& xml);
+
+    /** Return true if $data is compressed XML, as produced by compressXML() */
+    static bool isCompressedXML(const QByteArray& data);
+
+    /** Return true if $fileName has the compressed workspace extension */
+    static bool isCompressedWorkspace(const QString& fileName);
+
     /**
      * Release an existing instance of an XML reader, by closing
      * the device file, and freeing the resources
@@ -25,6 +25,7 @@
 #include <QDebug>
 #include <QFile>
 
+#include "avolitesd4parser.h"
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
 #include "qlccapability.h"
@@ -210,9 +211,23 @@ void QLCFixtureDef::checkLoaded(QString mapPath)
         return;
     }
 
-    QString absPath = QString("%1%2%3").arg(mapPath).arg(QDir::separator()).arg(m_fileAbsolutePath);
+    // definitions of the user folder are indexed with their absolute path
+    QString absPath = m_fileAbsolutePath;
+    if (QDir::isAbsolutePath(absPath) == false)
+        absPath = QString("%1%2%3").arg(mapPath).arg(QDir::separator()).arg(m_fileAbsolutePath);
+
     qDebug() << "Loading fixture definition now... " << absPath;
-    bool error = loadXML(absPath);
+    bool error;
+    if (absPath.toLower().endsWith(KExtAvolitesFixture))
+    {
+        AvolitesD4Parser parser;
+        error = (parser.loadXML(absPath, this) == false);
+    }
+    else
+    {
+        error = loadXML(absPath);
+    }
+
     if (error == false)
     {
         m_isLoaded = true;
@@ -19,9 +19,16 @@
 
 #include <QCoreApplication>
 #include <QXmlStreamReader>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QDebug>
 #include <QList>
-#include <QSet>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QStandardPaths>
+#endif
+
+#include <algorithm>
 
 #if defined(WIN32) || defined(Q_OS_WIN)
 #   include <windows.h>
@@ -38,7 +45,20 @@
 #define FIXTURES_MAP_NAME "FixturesMap.xml"
 #define KXMLQLCFixtureMap "FixturesMap"
 
+#define FIXTURES_INDEX_NAME "FixturesIndex.dat"
+/** "QLCI" */
+#define FIXTURES_INDEX_MAGIC 0x514C4349
+#define FIXTURES_INDEX_VERSION 1
+
+/** Insert $str in the sorted $list, keeping it sorted */
+static void insertSorted(QStringList &list, const QString &str)
+{
+    list.insert(std::lower_bound(list.begin(), list.end(), str), str);
+}
+
 QLCFixtureDefCache::QLCFixtureDefCache()
+    : m_fileIndexLoaded(false)
+    , m_fileIndexChanged(false)
 {
 }
 
@@ -50,54 +70,26 @@ QLCFixtureDefCache::~QLCFixtureDefCache()
 QLCFixtureDef* QLCFixtureDefCache::fixtureDef(
     const QString& manufacturer, const QString& model) const
 {
-    QListIterator <QLCFixtureDef*> it(m_defs);
-    while (it.hasNext() == true)
-    {
-        QLCFixtureDef* def = it.next();
-        if (def->manufacturer() == manufacturer && def->model() == model)
-        {
-            def->checkLoaded(m_mapAbsolutePath);
-            return def;
-        }
-    }
+    QHash <QString, QHash <QString, QLCFixtureDef*> >::const_iterator it =
+        m_index.constFind(manufacturer);
+    if (it == m_index.constEnd())
+        return NULL;
 
-    return NULL;
+    QLCFixtureDef* def = it.value().value(model, NULL);
+    if (def != NULL)
+        def->checkLoaded(m_mapAbsolutePath);
+
+    return def;
 }
 
 QStringList QLCFixtureDefCache::manufacturers() const
 {
-    QSet <QString> makers;
-
-    // Gather a list of manufacturers
-    QListIterator <QLCFixtureDef*> it(m_defs);
-    while (it.hasNext() == true)
-        makers << it.next()->manufacturer();
-
-    // Bounce the QSet into a QStringList
-    QStringList list;
-    foreach (QString manuf, makers)
-        list << manuf;
-
-    return list;
+    return m_manufacturers;
 }
 
 QStringList QLCFixtureDefCache::models(const QString& manufacturer) const
 {
-    QSet <QString> models;
-    QListIterator <QLCFixtureDef*> it(m_defs);
-    while (it.hasNext() == true)
-    {
-        QLCFixtureDef* def = it.next();
-        if (def->manufacturer() == manufacturer)
-            models << def->model();
-    }
-
-    // Bounce the QSet into a QStringList
-    QStringList list;
-    foreach (QString model, models)
-        list << model;
-
-    return list;
+    return m_models.value(manufacturer);
 }
 
 QMap<QString, QMap<QString, bool> > QLCFixtureDefCache::fixtureCache() const
@@ -119,17 +111,25 @@ bool QLCFixtureDefCache::addFixtureDef(QLCFixtureDef* fixtureDef)
     if (fixtureDef == NULL)
         return false;
 
-    if (models(fixtureDef->manufacturer()).contains(fixtureDef->model()) == false)
-    {
-        m_defs << fixtureDef;
-        return true;
-    }
-    else
+    QString manufacturer = fixtureDef->manufacturer();
+    QString model = fixtureDef->model();
+
+    QHash <QString, QLCFixtureDef*> &models = m_index[manufacturer];
+    if (models.contains(model) == true)
     {
         qWarning() << Q_FUNC_INFO << "Cache already contains"
                    << fixtureDef->name();
         return false;
     }
+
+    models.insert(model, fixtureDef);
+    m_defs << fixtureDef;
+
+    if (models.count() == 1)
+        insertSorted(m_manufacturers, manufacturer);
+    insertSorted(m_models[manufacturer], model);
+
+    return true;
 }
 
 bool QLCFixtureDefCache::storeFixtureDef(QString filename, QString data)
@@ -156,20 +156,39 @@ bool QLCFixtureDefCache::load(const QDir& dir)
     if (dir.exists() == false || dir.isReadable() == false)
         return false;
 
+    loadIndex();
+
     /* Attempt to read all specified files from the given directory */
+    QStringList paths;
     QStringListIterator it(dir.entryList());
     while (it.hasNext() == true)
     {
         QString path(dir.absoluteFilePath(it.next()));
+        paths << path;
+
+        /* Unchanged files are loaded when first requested */
+        if (addIndexedDefs(path, true) == true)
+            continue;
+
+        int firstDef = m_defs.count();
 
         if (path.toLower().endsWith(KExtFixture) == true)
-            loadQXF(path, true);
+        {
+            if (loadQXF(path, true) == true)
+                indexDefs(path, firstDef, true);
+        }
         else if (path.toLower().endsWith(KExtAvolitesFixture) == true)
-            loadD4(path);
+        {
+            if (loadD4(path) == true)
+                indexDefs(path, firstDef, true);
+        }
         else
             qWarning() << Q_FUNC_INFO << "Unrecognized fixture extension:" << path;
     }
 
+    pruneIndex(dir, paths);
+    saveIndex();
+
     return true;
 }
 
@@ -241,6 +260,12 @@ bool QLCFixtureDefCache::loadMap(const QDir &dir)
     // definition absolute path
     m_mapAbsolutePath = dir.absolutePath();
 
+    loadIndex();
+    if (addIndexedDefs(mapPath, false) == true)
+        return true;
+
+    int firstDef = m_defs.count();
+
     QXmlStreamReader *doc = QLCFile::getXMLReader(mapPath);
     if (doc == NULL || doc->device() == NULL || doc->hasError())
     {
@@ -303,6 +328,11 @@ bool QLCFixtureDefCache::loadMap(const QDir &dir)
     }
     qDebug() << fxCount << "fixtures found in map";
 
+    QLCFile::releaseXMLReader(doc);
+
+    indexDefs(mapPath, firstDef, false);
+    saveIndex();
+
 #if 0
     /* Attempt to read all files not in FixtureMap */
     QStringList definitionPaths;
@@ -336,6 +366,10 @@ void QLCFixtureDefCache::clear()
 {
     while (m_defs.isEmpty() == false)
         delete m_defs.takeFirst();
+
+    m_index.clear();
+    m_manufacturers.clear();
+    m_models.clear();
 }
 
 QDir QLCFixtureDefCache::systemDefinitionDirectory()
@@ -352,6 +386,186 @@ QDir QLCFixtureDefCache::userDefinitionDirectory()
     return QLCFile::userDirectory(QString(USERFIXTUREDIR), QString(FIXTUREDIR), filters);
 }
 
+/****************************************************************************
+ * Index
+ ****************************************************************************/
+
+void QLCFixtureDefCache::setIndexFile(const QString& path)
+{
+    m_indexFile = path;
+    m_fileIndex.clear();
+    m_fileIndexLoaded = false;
+    m_fileIndexChanged = false;
+}
+
+QString QLCFixtureDefCache::indexFile() const
+{
+    return m_indexFile;
+}
+
+QString QLCFixtureDefCache::defaultIndexFile()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    if (dir.exists() == false)
+        dir.mkpath(".");
+
+    return dir.absoluteFilePath(FIXTURES_INDEX_NAME);
+#else
+    return QString();
+#endif
+}
+
+void QLCFixtureDefCache::loadIndex()
+{
+    if (m_indexFile.isEmpty() || m_fileIndexLoaded == true)
+        return;
+
+    m_fileIndexLoaded = true;
+
+    QFile file(m_indexFile);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    quint32 magic = 0, version = 0, count = 0;
+    stream >> magic >> version;
+    if (magic != FIXTURES_INDEX_MAGIC || version != FIXTURES_INDEX_VERSION)
+    {
+        qDebug() << Q_FUNC_INFO << "Discarding outdated index" << m_indexFile;
+        return;
+    }
+
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString path;
+        IndexedFile entry;
+        quint32 defCount = 0;
+
+        stream >> path >> entry.m_modified >> entry.m_size >> defCount;
+        for (quint32 d = 0; d < defCount && stream.status() == QDataStream::Ok; d++)
+        {
+            IndexedDef def;
+            stream >> def.m_manufacturer >> def.m_model >> def.m_sourceFile;
+            entry.m_defs.append(def);
+        }
+
+        m_fileIndex.insert(path, entry);
+    }
+
+    // never trust a damaged index
+    if (stream.status() != QDataStream::Ok)
+    {
+        qWarning() << Q_FUNC_INFO << "Damaged index" << m_indexFile;
+        m_fileIndex.clear();
+    }
+}
+
+void QLCFixtureDefCache::saveIndex()
+{
+    if (m_indexFile.isEmpty() || m_fileIndexChanged == false)
+        return;
+
+    QFile file(m_indexFile);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to write" << m_indexFile;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    stream << quint32(FIXTURES_INDEX_MAGIC) << quint32(FIXTURES_INDEX_VERSION);
+    stream << quint32(m_fileIndex.count());
+
+    QHashIterator <QString, IndexedFile> it(m_fileIndex);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        const IndexedFile &entry = it.value();
+
+        stream << it.key() << entry.m_modified << entry.m_size << quint32(entry.m_defs.count());
+        foreach (const IndexedDef &def, entry.m_defs)
+            stream << def.m_manufacturer << def.m_model << def.m_sourceFile;
+    }
+
+    m_fileIndexChanged = false;
+}
+
+bool QLCFixtureDefCache::addIndexedDefs(const QString& path, bool isUser)
+{
+    QHash <QString, IndexedFile>::const_iterator it = m_fileIndex.constFind(path);
+    if (it == m_fileIndex.constEnd())
+        return false;
+
+    QFileInfo info(path);
+    if (info.lastModified().toMSecsSinceEpoch() != it.value().m_modified ||
+        info.size() != it.value().m_size)
+        return false;
+
+    foreach (const IndexedDef &indexed, it.value().m_defs)
+    {
+        QLCFixtureDef *def = new QLCFixtureDef();
+        def->setDefinitionSourceFile(indexed.m_sourceFile);
+        def->setManufacturer(indexed.m_manufacturer);
+        def->setModel(indexed.m_model);
+        def->setIsUser(isUser);
+
+        /* Delete the def if it's a duplicate. */
+        if (addFixtureDef(def) == false)
+            delete def;
+    }
+
+    return true;
+}
+
+void QLCFixtureDefCache::indexDefs(const QString& path, int firstDef, bool useFilePath)
+{
+    if (m_indexFile.isEmpty())
+        return;
+
+    QFileInfo info(path);
+    IndexedFile entry;
+    entry.m_modified = info.lastModified().toMSecsSinceEpoch();
+    entry.m_size = info.size();
+
+    for (int i = firstDef; i < m_defs.count(); i++)
+    {
+        IndexedDef indexed;
+        indexed.m_manufacturer = m_defs.at(i)->manufacturer();
+        indexed.m_model = m_defs.at(i)->model();
+        indexed.m_sourceFile = useFilePath ? path : m_defs.at(i)->definitionSourceFile();
+        entry.m_defs.append(indexed);
+    }
+
+    m_fileIndex.insert(path, entry);
+    m_fileIndexChanged = true;
+}
+
+void QLCFixtureDefCache::pruneIndex(const QDir& dir, const QStringList& existing)
+{
+    QString prefix = dir.absolutePath() + QString("/");
+
+    QMutableHashIterator <QString, IndexedFile> it(m_fileIndex);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        QString path = it.key().toLower();
+        if (path.endsWith(KExtFixture) == false && path.endsWith(KExtAvolitesFixture) == false)
+            continue;
+
+        if (it.key().startsWith(prefix) && existing.contains(it.key()) == false)
+        {
+            it.remove();
+            m_fileIndexChanged = true;
+        }
+    }
+}
+
 bool QLCFixtureDefCache::loadQXF(const QString& path, bool isUser)
 {
     QLCFixtureDef *fxi = new QLCFixtureDef();
@@ -22,6 +22,7 @@
 
 #include <QStringList>
 #include <QString>
+#include <QHash>
 #include <QMap>
 #include <QDir>
 
@@ -38,14 +39,21 @@ class QLCFixtureDef;
  * manufacturer names with QLCFixturedefCache::manufacturers() and subsequently
  * all models for a particular manufacturer with QLCFixtureDefCache::models().
  *
- * The internal structure is a two-tier map (m_models), with the first tier
- * containing manufacturer names as the keys for the first map. The value of
- * each key is another map (the second-tier) whose keys are model names. The
- * value for each model name entry in the second-tier map is the actual
- * QLCFixtureDef instance.
+ * The internal structure is a two-tier hash (m_index), with the first tier
+ * containing manufacturer names as the keys for the first hash. The value of
+ * each key is another hash (the second-tier) whose keys are model names. The
+ * value for each model name entry in the second-tier hash is the actual
+ * QLCFixtureDef instance. The sorted lists of manufacturer and model names
+ * are kept up to date along with it, so that they can be returned as they are.
  *
  * Multiple manufacturer & model combinations are discarded.
  *
+ * When an index file is set with setIndexFile(), the manufacturer, model and
+ * source file of the definitions found by load() and loadMap() are stored in
+ * it, along with the modification time of the files they come from. The next
+ * time, unchanged files are not read at all: their definitions are created
+ * from the index and loaded only when they are first requested.
+ *
  * Because this component is meant to be used only on the application side,
  * the returned fixture definitions are const, preventing any modifications to
  * the definitions. Modifying the definitions would also screw up the mapping
@@ -77,12 +85,12 @@ public:
                               const QString& model) const;
 
     /**
-     * Get a list of available manufacturer names.
+     * Get a sorted list of available manufacturer names.
      */
     QStringList manufacturers() const;
 
     /**
-     * Get a list of available model names for the given manufacturer.
+     * Get a sorted list of available model names for the given manufacturer.
      */
     QStringList models(const QString& manufacturer) const;
 
@@ -162,6 +170,69 @@ public:
      */
     static QDir userDefinitionDirectory();
 
+    /*********************************************************************
+     * Index
+     *********************************************************************/
+public:
+    /**
+     * Set the file where the index of the definitions is kept between
+     * sessions. An empty path disables the index, which is the default.
+     */
+    void setIndexFile(const QString& path);
+
+    /** Get the file where the index of the definitions is kept */
+    QString indexFile() const;
+
+    /** Get the default index file, in the user cache directory */
+    static QString defaultIndexFile();
+
+private:
+    /** Read the index file, the first time it is needed */
+    void loadIndex();
+
+    /** Write the index file, if it has changed */
+    void saveIndex();
+
+    /**
+     * Add the definitions indexed for $path, if the file
+     * has not changed since it was indexed.
+     *
+     * @return true if the definitions have been added from the index
+     */
+    bool addIndexedDefs(const QString& path, bool isUser);
+
+    /**
+     * Index the definitions read from $path, which have been added at
+     * $firstDef in m_defs. If $useFilePath is true, they will be loaded
+     * from $path itself, otherwise from their definition source file.
+     */
+    void indexDefs(const QString& path, int firstDef, bool useFilePath);
+
+    /** Remove the files of $dir that do not exist anymore from the index */
+    void pruneIndex(const QDir& dir, const QStringList& existing);
+
+private:
+    /** A definition as it is stored in the index */
+    struct IndexedDef
+    {
+        QString m_manufacturer;
+        QString m_model;
+        QString m_sourceFile;
+    };
+
+    /** An indexed file, with the definitions it contains */
+    struct IndexedFile
+    {
+        qint64 m_modified;
+        qint64 m_size;
+        QList <IndexedDef> m_defs;
+    };
+
+    QString m_indexFile;
+    QHash <QString, IndexedFile> m_fileIndex;
+    bool m_fileIndexLoaded;
+    bool m_fileIndexChanged;
+
 private:
     /** Load a QLC native fixture definition from the file specified in $path */
     bool loadQXF(const QString& path, bool isUser = false);
@@ -171,7 +242,18 @@ private:
 
 private:
     QString m_mapAbsolutePath;
+
+    /** All the definitions, in the order they have been added */
     QList <QLCFixtureDef*> m_defs;
+
+    /** The definitions indexed by manufacturer and model */
+    QHash <QString, QHash <QString, QLCFixtureDef*> > m_index;
+
+    /** The sorted manufacturer names */
+    QStringList m_manufacturers;
+
+    /** The sorted model names of each manufacturer */
+    QHash <QString, QStringList> m_models;
 };
 
 /** @} */
@@ -28,6 +28,7 @@
 #include "qlcfixturehead.h"
 #include "qlcfixturedef.h"
 #include "qlcchannel.h"
+#include "qlcstringpool.h"
 #include "qlcphysical.h"
 
 QLCFixtureMode::QLCFixtureMode(QLCFixtureDef* fixtureDef)
@@ -366,7 +367,7 @@ bool QLCFixtureMode::loadXML(QXmlStreamReader &doc)
     }
     else
     {
-        setName(str);
+        setName(QLCStringPool::intern(str));
     }
 
     /* Temporary list with mode's channels pointer and acts on indexes. */
@@ -0,0 +1,152 @@
+/*
+  Q Light Controller Plus
+  qlcimagecache.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QImageReader>
+#include <QPixmapCache>
+#include <QPixmap>
+#include <QCache>
+#include <QMutex>
+#include <QDebug>
+
+#include "qlcimagecache.h"
+
+/* Images can be requested from any thread */
+static QMutex s_cacheMutex;
+static QCache<QString, QImage> s_cache(QLCIMAGECACHE_DEFAULT_BUDGET);
+
+static QString cacheKey(const QString& path, int extent)
+{
+    return QString("%1@%2").arg(path).arg(extent);
+}
+
+static int imageCost(const QImage& image)
+{
+    return qMax(1, image.bytesPerLine() * image.height() / 1024);
+}
+
+static QImage readImage(const QString& path, int extent)
+{
+    QImageReader reader(path);
+
+    if (extent > 0)
+    {
+        QSize size = reader.size();
+        if (size.isValid())
+        {
+            size.scale(extent, extent, Qt::KeepAspectRatio);
+            /* SVG is rendered straight at the bucket size,
+             * and JPEG can be decoded at a lower resolution */
+            if (reader.supportsOption(QImageIOHandler::ScaledSize))
+                reader.setScaledSize(size);
+        }
+    }
+
+    QImage image = reader.read();
+    if (image.isNull())
+    {
+        qWarning() << "[QLCImageCache] Unable to read" << path << reader.errorString();
+        return image;
+    }
+
+    if (extent > 0 && (image.width() > extent || image.height() > extent))
+        image = image.scaled(extent, extent, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    return image;
+}
+
+QImage QLCImageCache::image(const QString& path, const QSize& size)
+{
+    if (path.isEmpty())
+        return QImage();
+
+    int extent = bucket(size);
+    QString key = cacheKey(path, extent);
+
+    {
+        QMutexLocker locker(&s_cacheMutex);
+        QImage *cached = s_cache.object(key);
+        if (cached != NULL)
+            return *cached;
+    }
+
+    /* Decode without holding the lock. If two threads miss the
+     * same image at once, the second copy simply replaces the first */
+    QImage image = readImage(path, extent);
+    if (image.isNull())
+        return image;
+
+    QMutexLocker locker(&s_cacheMutex);
+    s_cache.insert(key, new QImage(image), imageCost(image));
+
+    return image;
+}
+
+QIcon QLCImageCache::icon(const QString& path, int extent)
+{
+    QString key = cacheKey(path, bucket(QSize(extent, extent)));
+    QPixmap pixmap;
+
+    if (QPixmapCache::find(key, &pixmap) == false)
+    {
+        pixmap = QPixmap::fromImage(image(path, QSize(extent, extent)));
+        if (pixmap.isNull())
+            return QIcon();
+        QPixmapCache::insert(key, pixmap);
+    }
+
+    return QIcon(pixmap);
+}
+
+int QLCImageCache::bucket(const QSize& size)
+{
+    if (size.isValid() == false || size.isEmpty())
+        return 0;
+
+    int side = qMax(size.width(), size.height());
+    int extent = QLCIMAGECACHE_MIN_EXTENT;
+    while (extent < side && extent < QLCIMAGECACHE_MAX_EXTENT)
+        extent *= 2;
+
+    return extent;
+}
+
+void QLCImageCache::setBudget(int kilobytes)
+{
+    QMutexLocker locker(&s_cacheMutex);
+    s_cache.setMaxCost(kilobytes);
+}
+
+int QLCImageCache::count()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    return s_cache.count();
+}
+
+int QLCImageCache::cost()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    return s_cache.totalCost();
+}
+
+void QLCImageCache::clear()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    s_cache.clear();
+}
@@ -0,0 +1,84 @@
+/*
+  Q Light Controller Plus
+  qlcimagecache.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef QLCIMAGECACHE_H
+#define QLCIMAGECACHE_H
+
+#include <QString>
+#include <QImage>
+#include <QSize>
+#include <QIcon>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Smallest and largest size bucket, in pixels */
+#define QLCIMAGECACHE_MIN_EXTENT 16
+#define QLCIMAGECACHE_MAX_EXTENT 1024
+
+/** Default budget of the cache, in kilobytes */
+#define QLCIMAGECACHE_DEFAULT_BUDGET (32 * 1024)
+
+/**
+ * QLCImageCache holds a single decoded copy of the gobo pictures, icons
+ * and other capability resources, shared by every console, tree, preview
+ * and editor showing them.
+ *
+ * Images are cached by path and size bucket: the requested size is rounded
+ * up to the next power of two, so widgets asking for 28 or 32 pixels share
+ * the same 32 pixels image, and an SVG is rendered once per bucket instead
+ * of once per widget. The least recently used images are dropped when the
+ * cache exceeds its budget.
+ *
+ * image() can be called from any thread. icon() uses QPixmap, so it must be
+ * called from the GUI thread only.
+ */
+class QLCImageCache
+{
+public:
+    /**
+     * Get the image at $path, scaled to fit a $size bucket and keeping its
+     * aspect ratio. With an invalid $size the image keeps its own size.
+     * Return a null image if $path cannot be read.
+     */
+    static QImage image(const QString& path, const QSize& size = QSize());
+
+    /** Get an icon of $path, $extent pixels wide and high */
+    static QIcon icon(const QString& path, int extent = 32);
+
+    /** Return the side of the bucket a $size falls into, or 0 if $size is invalid */
+    static int bucket(const QSize& size);
+
+    /** Set the budget of the cache, in kilobytes */
+    static void setBudget(int kilobytes);
+
+    /** Get the number of images in the cache */
+    static int count();
+
+    /** Get the kilobytes used by the images in the cache */
+    static int cost();
+
+    /** Drop all the cached images */
+    static void clear();
+};
+
+/** @} */
+
+#endif
@@ -325,6 +325,48 @@ QLCInputProfile* QLCInputProfile::loader(const QString& path)
     return profile;
 }
 
+bool QLCInputProfile::loadHeader(const QString& path, QString& name, Type& type)
+{
+    QXmlStreamReader *doc = QLCFile::getXMLReader(path);
+    if (doc == NULL || doc->device() == NULL || doc->hasError())
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to load input profile from" << path;
+        return false;
+    }
+
+    QString manufacturer, model;
+    bool found = false;
+    type = MIDI;
+
+    if (doc->readNextStartElement() && doc->name() == KXMLQLCInputProfile)
+    {
+        found = true;
+
+        /* The header comes before the channels */
+        while (doc->readNextStartElement() && doc->name() != KXMLQLCInputChannel)
+        {
+            if (doc->name() == KXMLQLCInputProfileManufacturer)
+                manufacturer = doc->readElementText();
+            else if (doc->name() == KXMLQLCInputProfileModel)
+                model = doc->readElementText();
+            else if (doc->name() == KXMLQLCInputProfileType)
+                type = stringToType(doc->readElementText());
+            else
+                doc->skipCurrentElement();
+        }
+    }
+    else
+    {
+        qWarning() << Q_FUNC_INFO << "Input profile not found in" << path;
+    }
+
+    QLCFile::releaseXMLReader(doc);
+
+    name = QString("%1 %2").arg(manufacturer).arg(model);
+
+    return found;
+}
+
 bool QLCInputProfile::loadXML(QXmlStreamReader& doc)
 {
     if (doc.readNextStartElement() == false)
@@ -190,6 +190,10 @@ public:
     /** Load an input profile from the given path */
     static QLCInputProfile* loader(const QString& path);
 
+    /** Read only the name and the type of the input profile in the given
+        path, stopping before its channels. Returns false on failure. */
+    static bool loadHeader(const QString& path, QString& name, Type& type);
+
     /** Save an input profile into a given file name */
     bool saveXML(const QString& fileName);
 
@@ -33,6 +33,9 @@ bool QLCModifiersCache::addModifier(ChannelModifier *modifier)
     if (m_modifiers.contains(modifier->name()))
         return false;
 
+    /* The added modifier replaces an indexed file with the same name */
+    m_templateFiles.remove(modifier->name());
+
     //qDebug() << "[QLCModifiersCache] added modifier" << modifier->name();
     m_modifiers[modifier->name()] = modifier;
     return true;
@@ -40,7 +43,7 @@ bool QLCModifiersCache::addModifier(ChannelModifier *modifier)
 
 QList<QString> QLCModifiersCache::templateNames()
 {
-    return m_modifiers.keys();
+    return m_modifiers.keys() + m_templateFiles.keys();
 }
 
 ChannelModifier *QLCModifiersCache::modifier(QString name)
@@ -48,7 +51,26 @@ ChannelModifier *QLCModifiersCache::modifier(QString name)
     if (m_modifiers.contains(name))
         return m_modifiers[name];
 
-    return NULL;
+    if (m_templateFiles.contains(name) == false)
+        return NULL;
+
+    TemplateFile file = m_templateFiles.take(name);
+    ChannelModifier* chMod = new ChannelModifier();
+
+    QFile::FileError error = chMod->loadXML(file.m_path, file.m_type);
+    if (error != QFile::NoError)
+    {
+        qWarning() << Q_FUNC_INFO << "Channel modifier template loading from"
+                   << file.m_path << "failed:" << QLCFile::errorString(error);
+        delete chMod;
+        return NULL;
+    }
+
+    /* The file might have changed since it was indexed */
+    if (addModifier(chMod) == false)
+        delete chMod;
+
+    return m_modifiers.value(name, NULL);
 }
 
 QDir QLCModifiersCache::systemTemplateDirectory()
@@ -83,25 +105,22 @@ bool QLCModifiersCache::load(const QDir& dir, bool systemTemplates)
 
         if (path.toLower().endsWith(KExtModifierTemplate) == true)
         {
-            ChannelModifier* chMod = new ChannelModifier();
-            Q_ASSERT(chMod != NULL);
-
-            QFile::FileError error = chMod->loadXML(path, type);
-            if (error == QFile::NoError)
+            QString name = ChannelModifier::loadName(path);
+            if (name.isEmpty() == false)
             {
-                /* Delete the modifier if it's a duplicate. */
-                if (addModifier(chMod) == false)
+                /* Ignore the template if it's a duplicate. */
+                if (m_modifiers.contains(name) == false && m_templateFiles.contains(name) == false)
                 {
-                    delete chMod;
-                    chMod = NULL;
+                    TemplateFile file;
+                    file.m_path = path;
+                    file.m_type = type;
+                    m_templateFiles.insert(name, file);
                 }
             }
             else
             {
                 qWarning() << Q_FUNC_INFO << "Channel modifier template loading from"
-                           << path << "failed:" << QLCFile::errorString(error);
-                delete chMod;
-                chMod = NULL;
+                           << path << "failed: no template name";
             }
         }
         else
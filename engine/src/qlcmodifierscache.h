@@ -23,7 +23,7 @@
 #include <QHash>
 #include <QDir>
 
-class ChannelModifier;
+#include "channelmodifier.h"
 
 /** @addtogroup engine Engine
  * @{
@@ -49,7 +49,8 @@ public:
     QList<QString> templateNames();
 
     /**
-     * Get a modifier instance by name
+     * Get a modifier instance by name. A template that has only been
+     * indexed by load() is parsed on the first request.
      * @param name The modifier name
      * @return a pointer to the requested modifier or NULL if not found
      */
@@ -78,6 +79,9 @@ public:
      * Returns true even if $dir doesn't contain any template,
      * if it is still accessible (and exists).
      *
+     * Only the template names are read here: the templates are
+     * indexed by name and parsed when first requested with modifier().
+     *
      * @param dir The directory to load templates from.
      * @return true, if the path could be accessed, otherwise false.
      */
@@ -85,6 +89,16 @@ public:
 
 private:
     QHash <QString, ChannelModifier*> m_modifiers;
+
+    /** A template file that has been indexed but not parsed yet */
+    struct TemplateFile
+    {
+        QString m_path;
+        ChannelModifier::Type m_type;
+    };
+
+    /** The indexed template files, by template name */
+    QHash <QString, TemplateFile> m_templateFiles;
 };
 
 /** @} */
@@ -35,10 +35,14 @@
 #define KXMLQLCPaletteFanAmount "Amount"
 #define KXMLQLCPaletteFanValue  "FanValue"
 
+/** Maximum number of fixture lists cached by a single Palette */
+#define PALETTE_CACHE_SIZE      256
+
 QLCPalette::QLCPalette(QLCPalette::PaletteType type, QObject *parent)
     : QObject(parent)
     , m_id(QLCPalette::invalidId())
     , m_type(type)
+    , m_valuesCacheRevision(-1)
     , m_fanningType(Flat)
     , m_fanningLayout(LeftToRight)
     , m_fanningAmount(100)
@@ -214,6 +218,7 @@ void QLCPalette::setValue(QVariant val)
 {
     m_values.clear();
     m_values.append(val);
+    invalidateCache();
 }
 
 void QLCPalette::setValue(QVariant val1, QVariant val2)
@@ -221,6 +226,7 @@ void QLCPalette::setValue(QVariant val1, QVariant val2)
     m_values.clear();
     m_values.append(val1);
     m_values.append(val2);
+    invalidateCache();
 }
 
 QVariantList QLCPalette::values() const
@@ -231,14 +237,45 @@ QVariantList QLCPalette::values() const
 void QLCPalette::setValues(QVariantList values)
 {
     m_values = values;
+    invalidateCache();
 }
 
 void QLCPalette::resetValues()
 {
     m_values.clear();
+    invalidateCache();
 }
 
 QList<SceneValue> QLCPalette::valuesFromFixtures(Doc *doc, QList<quint32> fixtures)
+{
+    QMutexLocker locker(&m_valuesCacheMutex);
+
+    if (m_valuesCacheRevision != doc->fixturesRevision())
+    {
+        m_valuesCache.clear();
+        m_valuesCacheRevision = doc->fixturesRevision();
+    }
+
+    QHash<QList<quint32>, QList<SceneValue> >::const_iterator it = m_valuesCache.constFind(fixtures);
+    if (it != m_valuesCache.constEnd())
+        return it.value();
+
+    if (m_valuesCache.count() >= PALETTE_CACHE_SIZE)
+        m_valuesCache.clear();
+
+    QList<SceneValue> list = resolveValues(doc, fixtures);
+    m_valuesCache.insert(fixtures, list);
+
+    return list;
+}
+
+void QLCPalette::invalidateCache()
+{
+    QMutexLocker locker(&m_valuesCacheMutex);
+    m_valuesCache.clear();
+}
+
+QList<SceneValue> QLCPalette::resolveValues(Doc *doc, const QList<quint32> &fixtures)
 {
     QList<SceneValue> list;
 
@@ -447,6 +484,7 @@ void QLCPalette::setFanningType(QLCPalette::FanningType type)
         return;
 
     m_fanningType = type;
+    invalidateCache();
 
     emit fanningTypeChanged();
 }
@@ -492,6 +530,7 @@ void QLCPalette::setFanningLayout(QLCPalette::FanningLayout layout)
         return;
 
     m_fanningLayout = layout;
+    invalidateCache();
 
     emit fanningLayoutChanged();
 }
@@ -537,6 +576,7 @@ void QLCPalette::setFanningAmount(int amount)
         return;
 
     m_fanningAmount = amount;
+    invalidateCache();
 
     emit fanningAmountChanged();
 }
@@ -552,6 +592,7 @@ void QLCPalette::setFanningValue(QVariant value)
         return;
 
     m_fanningValue = value;
+    invalidateCache();
 
     emit fanningValueChanged();
 }
@@ -633,6 +674,7 @@ bool QLCPalette::loadXML(QXmlStreamReader &doc)
     }
 
     m_type = stringToType(attrs.value(KXMLQLCPaletteType).toString());
+    invalidateCache();
 
     if (attrs.hasAttribute(KXMLQLCPaletteName))
         setName(attrs.value(KXMLQLCPaletteName).toString());
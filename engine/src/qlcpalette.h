@@ -23,6 +23,8 @@
 #include <QColor>
 #include <QObject>
 #include <QVariant>
+#include <QMutex>
+#include <QHash>
 
 class QXmlStreamReader;
 class QXmlStreamWriter;
@@ -126,10 +128,20 @@ public:
     void setValues(QVariantList values);
     void resetValues();
 
+    /** Get the values this Palette produces on the given fixtures or
+     *  fixture groups. Results are cached per fixture list and shared
+     *  by every caller, until the Palette or the Doc fixtures change */
     QList<SceneValue> valuesFromFixtures(Doc *doc, QList<quint32>fixtures);
     QList<SceneValue> valuesFromFixtureGroups(Doc *doc, QList<quint32>groups);
 
 protected:
+    /** Compute the values for $fixtures, bypassing the cache */
+    QList<SceneValue> resolveValues(Doc *doc, const QList<quint32> &fixtures);
+
+    /** Drop every cached value list. Called whenever a property
+     *  affecting the resolved values changes */
+    void invalidateCache();
+
     /** This method returns a normalized factor between 0.0 and 1.0
      *  which will then be multiplied by a value to obtain the final
      *  DMX value.
@@ -146,6 +158,13 @@ private:
     QString m_name;
     QVariantList m_values;
 
+    /** Resolved values cache: < fixture list, values > */
+    QHash<QList<quint32>, QList<SceneValue> > m_valuesCache;
+    /** Doc fixtures revision the cache has been filled with */
+    int m_valuesCacheRevision;
+    /** Palettes are resolved both by the UI and the MasterTimer thread */
+    QMutex m_valuesCacheMutex;
+
     /************************************************************************
      * Fanning
      ************************************************************************/
@@ -0,0 +1,55 @@
+/*
+  Q Light Controller Plus
+  qlcstringpool.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QMutex>
+#include <QSet>
+
+#include "qlcstringpool.h"
+
+/* Definitions can be loaded from any thread */
+static QMutex s_poolMutex;
+static QSet<QString> s_pool;
+
+QString QLCStringPool::intern(const QString& str)
+{
+    if (str.isEmpty())
+        return QString();
+
+    QMutexLocker locker(&s_poolMutex);
+
+    QSet<QString>::const_iterator it = s_pool.constFind(str);
+    if (it != s_pool.constEnd())
+        return *it;
+
+    s_pool.insert(str);
+    return str;
+}
+
+int QLCStringPool::count()
+{
+    QMutexLocker locker(&s_poolMutex);
+    return s_pool.count();
+}
+
+void QLCStringPool::clear()
+{
+    QMutexLocker locker(&s_poolMutex);
+    s_pool.clear();
+}
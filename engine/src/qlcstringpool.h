@@ -0,0 +1,55 @@
+/*
+  Q Light Controller Plus
+  qlcstringpool.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef QLCSTRINGPOOL_H
+#define QLCSTRINGPOOL_H
+
+#include <QString>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * QLCStringPool holds a single copy of the strings that are repeated many
+ * times across fixture definitions, like channel names, capability
+ * descriptions and gobo paths. Interned strings share their data with the
+ * pooled copy, thanks to QString implicit sharing, so every further
+ * occurrence costs only a reference.
+ */
+class QLCStringPool
+{
+public:
+    /**
+     * Get a string equal to $str that shares its data with all the
+     * other equal strings interned so far
+     */
+    static QString intern(const QString& str);
+
+    /** Get the number of distinct strings in the pool */
+    static int count();
+
+    /** Release all the pooled copies. Strings interned so far are
+     *  still valid, but they won't be shared with the next ones */
+    static void clear();
+};
+
+/** @} */
+
+#endif
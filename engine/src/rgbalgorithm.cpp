@@ -29,6 +29,9 @@
 #include "rgbimage.h"
 #include "rgbplain.h"
 #include "rgbtext.h"
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+  #include "rgbvideo.h"
+#endif
 #include "doc.h"
 
 #ifdef QT_QML_LIB
@@ -65,6 +68,10 @@ QStringList RGBAlgorithm::algorithms(Doc * doc)
     list << text.name();
     list << image.name();
     list << audio.name();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    RGBVideo video(doc);
+    list << video.name();
+#endif
     list << doc->rgbScriptsCache()->names();
     return list;
 }
@@ -75,6 +82,9 @@ RGBAlgorithm* RGBAlgorithm::algorithm(Doc * doc, const QString& name)
     RGBImage image(doc);
     RGBAudio audio(doc);
     RGBPlain plain(doc);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    RGBVideo video(doc);
+#endif
     if (name == text.name())
         return text.clone();
     else if (name == image.name())
@@ -83,6 +93,10 @@ RGBAlgorithm* RGBAlgorithm::algorithm(Doc * doc, const QString& name)
         return audio.clone();
     else if (name == plain.name())
         return plain.clone();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    else if (name == video.name())
+        return video.clone();
+#endif
     else
         return doc->rgbScriptsCache()->script(name).clone();
 }
@@ -132,6 +146,14 @@ RGBAlgorithm* RGBAlgorithm::loader(Doc * doc, QXmlStreamReader &root)
         if (plain.loadXML(root) == true)
             algo = plain.clone();
     }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    else if (type == KXMLQLCRGBVideo)
+    {
+        RGBVideo video(doc);
+        if (video.loadXML(root) == true)
+            algo = video.clone();
+    }
+#endif
     else
     {
         qWarning() << "Unrecognized RGB algorithm type:" << type;
@@ -35,7 +35,65 @@ class Doc;
  * @{
  */
 
-typedef QVector<QVector<uint> > RGBMap;
+/**
+ * RGBMap holds the pixels of an RGB Matrix step in a single, row-major
+ * buffer. Rows are addressed with operator[] or scanLine() like QImage,
+ * and the buffer is kept between steps as long as the size allows it.
+ */
+class RGBMap
+{
+public:
+    RGBMap() : m_width(0), m_height(0) { }
+    RGBMap(const QSize& size) : m_width(0), m_height(0) { resize(size); }
+
+    /** Resize the map to $size. Pixels are preserved when the size doesn't
+     *  change, otherwise the map is cleared to black */
+    void resize(const QSize& size)
+    {
+        int width = qMax(0, size.width());
+        int height = qMax(0, size.height());
+        if (width == m_width && height == m_height)
+            return;
+
+        m_width = width;
+        m_height = height;
+        m_data.resize(m_width * m_height);
+        m_data.fill(0);
+    }
+
+    QSize size() const { return QSize(m_width, m_height); }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    /** Distance, in pixels, between the start of two consecutive rows */
+    int stride() const { return m_width; }
+
+    bool isEmpty() const { return m_data.isEmpty(); }
+
+    /** Fill the whole map with the $rgb color */
+    void fill(uint rgb) { m_data.fill(rgb); }
+
+    /** Access to the raw buffer, stride() pixels per row */
+    uint *data() { return m_data.data(); }
+    const uint *constData() const { return m_data.constData(); }
+
+    uint *scanLine(int y) { return m_data.data() + y * m_width; }
+    const uint *constScanLine(int y) const { return m_data.constData() + y * m_width; }
+
+    uint *operator[](int y) { return scanLine(y); }
+    const uint *operator[](int y) const { return constScanLine(y); }
+
+    bool operator==(const RGBMap& map) const
+    {
+        return m_width == map.m_width && m_height == map.m_height && m_data == map.m_data;
+    }
+    bool operator!=(const RGBMap& map) const { return !(*this == map); }
+
+private:
+    int m_width;
+    int m_height;
+    QVector<uint> m_data;
+};
 
 #define KXMLQLCRGBAlgorithm "Algorithm"
 #define KXMLQLCRGBAlgorithmType "Type"
@@ -52,7 +110,8 @@ public:
         Script,
         Image,
         Audio,
-        Plain
+        Plain,
+        Video
     };
 
     /** Create a clone of the algorithm. Caller takes ownership of the pointer. */
@@ -97,6 +156,10 @@ public:
      */
     virtual int acceptColors() const = 0;
 
+    /** Return true if rgbMap() always produces the same map for the same
+     *  size, color, step and properties, so that its maps can be cached */
+    virtual bool deterministic() const { return false; }
+
     /************************************************************************
      * RGB Colors
      ************************************************************************/
@@ -62,26 +62,10 @@ void RGBAudio::setAudioCapture(AudioCapture* cap)
     qDebug() << Q_FUNC_INFO << "Audio capture set";
 
     m_audioInput = cap;
-    connect(m_audioInput, SIGNAL(dataProcessed(double*,int,double,quint32)),
-            this, SLOT(slotAudioBarsChanged(double*,int,double,quint32)));
+    m_spectrum.clear();
     m_bandsNumber = -1;
 }
 
-void RGBAudio::slotAudioBarsChanged(double *spectrumBands, int size,
-                                    double maxMagnitude, quint32 power)
-{
-    if (size != m_bandsNumber)
-        return;
-
-    QMutexLocker locker(&m_mutex);
-
-    m_spectrumValues.clear();
-    for (int i = 0; i < m_bandsNumber; i++)
-        m_spectrumValues.append(spectrumBands[i]);
-    m_maxMagnitude = maxMagnitude;
-    m_volumePower = power;
-}
-
 void RGBAudio::calculateColors(int barsHeight)
 {
     if (barsHeight > 0)
@@ -131,12 +115,8 @@ void RGBAudio::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
     if (capture.data() != m_audioInput)
         setAudioCapture(capture.data());
 
-    map.resize(size.height());
-    for (int y = 0; y < size.height(); y++)
-    {
-        map[y].resize(size.width());
-        map[y].fill(0);
-    }
+    map.resize(size);
+    map.fill(0);
 
     // on the first round, just set the proper number of
     // spectrum bands to receive
@@ -144,9 +124,12 @@ void RGBAudio::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
     {
         m_bandsNumber = size.width();
         qDebug() << "[RGBAudio] set" << m_bandsNumber << "bars";
-        m_audioInput->registerBandsNumber(m_bandsNumber);
+        m_spectrum = m_audioInput->registerBandsNumber(m_bandsNumber);
         return;
     }
+
+    if (m_spectrum.isNull() == false)
+        m_spectrum->read(m_spectrumValues, m_maxMagnitude, m_volumePower);
     if (m_barColors.count() == 0)
         calculateColors(size.height());
 
@@ -179,12 +162,11 @@ void RGBAudio::postRun()
     QSharedPointer<AudioCapture> capture = doc()->audioInputCapture();
     if (capture.data() == m_audioInput)
     {
-        disconnect(m_audioInput, SIGNAL(dataProcessed(double*,int,double,quint32)),
-                   this, SLOT(slotAudioBarsChanged(double*,int,double,quint32)));
         if (m_bandsNumber > 0)
             m_audioInput->unregisterBandsNumber(m_bandsNumber);
     }
     m_audioInput = NULL;
+    m_spectrum.clear();
     m_bandsNumber = -1;
 }
 
@@ -20,6 +20,7 @@
 #ifndef RGBAUDIO_H
 #define RGBAUDIO_H
 
+#include <QSharedPointer>
 #include <QObject>
 #include <QMutex>
 
@@ -32,6 +33,7 @@
 #define KXMLQLCRGBAudio "Audio"
 
 class AudioCapture;
+class AudioSpectrum;
 
 class RGBAudio : public QObject, public RGBAlgorithm
 {
@@ -48,15 +50,14 @@ public:
 private:
     void setAudioCapture(AudioCapture* cap);
 
-protected slots:
-    void slotAudioBarsChanged(double *spectrumBands, int size, double maxMagnitude, quint32 power);
-
 private:
     void calculateColors(int barsHeight = 0);
 
 protected:
     AudioCapture *m_audioInput;
     int m_bandsNumber;
+    /** The latest spectrum of m_bandsNumber bands, read without locking the capture */
+    QSharedPointer<AudioSpectrum> m_spectrum;
     QMutex m_mutex;
     QVector<double>m_spectrumValues;
     double m_maxMagnitude;
@@ -34,10 +34,14 @@
 #define KXMLQLCRGBImageOffsetX        "X"
 #define KXMLQLCRGBImageOffsetY        "Y"
 
+#define RGBIMAGE_FRAME_CACHE_BYTES    (32 * 1024 * 1024)
+
 RGBImage::RGBImage(Doc * doc)
     : RGBAlgorithm(doc)
     , m_filename("")
     , m_animatedSource(false)
+    , m_framesCount(0)
+    , m_currentFrame(-1)
     , m_animationStyle(Static)
     , m_xOffset(0)
     , m_yOffset(0)
@@ -48,6 +52,8 @@ RGBImage::RGBImage(const RGBImage& i)
     : RGBAlgorithm( i.doc())
     , m_filename(i.filename())
     , m_animatedSource(i.animatedSource())
+    , m_framesCount(0)
+    , m_currentFrame(-1)
     , m_animationStyle(i.animationStyle())
     , m_xOffset(i.xOffset())
     , m_yOffset(i.yOffset())
@@ -100,7 +106,7 @@ void RGBImage::setImageData(int width, int height, const QByteArray &pixelData)
             i+=3;
         }
     }
-    m_image = newImg;
+    m_image = newImg.convertToFormat(QImage::Format_ARGB32);
 }
 
 bool RGBImage::animatedSource() const
@@ -120,6 +126,11 @@ void RGBImage::reloadImage()
 
     QMutexLocker locker(&m_mutex);
 
+    m_frames.clear();
+    m_framesCount = 0;
+    m_framesSize = QSize();
+    m_currentFrame = -1;
+
     if (m_filename.endsWith(".gif"))
     {
         m_animatedPlayer.setFileName(m_filename);
@@ -134,6 +145,40 @@ void RGBImage::reloadImage()
             qDebug() << "[RGBImage] Failed to load" << m_filename;
             return;
         }
+        // Let rgbMap() read the pixels straight from the scan lines
+        m_image = m_image.convertToFormat(QImage::Format_ARGB32);
+    }
+}
+
+void RGBImage::buildFrameCache(const QSize& size)
+{
+    m_frames.clear();
+    m_framesCount = m_animatedPlayer.frameCount();
+    m_framesSize = size;
+    m_currentFrame = -1;
+
+    int framePixels = size.width() * size.height();
+    qint64 bytes = qint64(m_framesCount) * framePixels * sizeof(uint);
+    if (m_framesCount <= 0 || framePixels <= 0 || bytes > RGBIMAGE_FRAME_CACHE_BYTES)
+    {
+        qDebug() << "[RGBImage] Not caching" << m_framesCount << "frames of" << m_filename << "at" << size;
+        return;
+    }
+
+    m_frames.resize(m_framesCount * framePixels);
+    uint *frame = m_frames.data();
+
+    for (int f = 0; f < m_framesCount; f++)
+    {
+        m_animatedPlayer.jumpToFrame(f);
+        QImage image = m_animatedPlayer.currentImage().scaled(size).convertToFormat(QImage::Format_ARGB32);
+
+        for (int y = 0; y < size.height(); y++)
+        {
+            const QRgb *src = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+            for (int x = 0; x < size.width(); x++)
+                *frame++ = qAlpha(src[x]) == 0 ? 0 : src[x];
+        }
     }
 }
 
@@ -265,22 +310,45 @@ void RGBImage::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 
     if (m_animatedSource)
     {
+        if (size != m_framesSize)
+            buildFrameCache(size);
+
+        if (m_frames.isEmpty() == false)
+        {
+            // Play the next frame straight from the cache
+            m_currentFrame = (m_currentFrame + 1) % m_framesCount;
+            const uint *frame = m_frames.constData() + m_currentFrame * size.width() * size.height();
+
+            map.resize(size);
+            for (int y = 0; y < size.height(); y++)
+            {
+                uint *line = map.scanLine(y);
+                const uint *src = frame + ((y + yOffs) % size.height()) * size.width();
+
+                for (int x = 0; x < size.width(); x++)
+                    line[x] = src[(x + xOffs) % size.width()];
+            }
+            return;
+        }
+
         m_animatedPlayer.jumpToNextFrame();
-        m_image = m_animatedPlayer.currentImage().scaled(size);
+        m_image = m_animatedPlayer.currentImage().scaled(size).convertToFormat(QImage::Format_ARGB32);
     }
 
-    map.resize(size.height());
+    map.resize(size);
     for (int y = 0; y < size.height(); y++)
     {
-        map[y].resize(size.width());
+        uint *line = map.scanLine(y);
+        int y1 = (y + yOffs) % m_image.height();
+        const QRgb *src = reinterpret_cast<const QRgb *>(m_image.constScanLine(y1));
+
         for (int x = 0; x < size.width(); x++)
         {
             int x1 = (x + xOffs) % m_image.width();
-            int y1 = (y + yOffs) % m_image.height();
 
-            map[y][x] = m_image.pixel(x1,y1);
-            if (qAlpha(map[y][x]) == 0)
-                map[y][x] = 0;
+            line[x] = src[x1];
+            if (qAlpha(line[x]) == 0)
+                line[x] = 0;
         }
     }
 }
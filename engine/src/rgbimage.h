@@ -64,6 +64,10 @@ private:
 
     void reloadImage();
 
+    /** Decode all the frames of m_animatedPlayer, scaled to $size,
+     *  into m_frames. Must be called with m_mutex locked */
+    void buildFrameCache(const QSize& size);
+
 private:
     QString m_filename;
     bool m_animatedSource;
@@ -71,6 +75,15 @@ private:
     QImage m_image;
     QMutex m_mutex;
 
+    /** The animation frames, packed one after the other, scaled
+     *  to m_framesSize. Empty when they don't fit in memory */
+    QVector<uint> m_frames;
+    int m_framesCount;
+    QSize m_framesSize;
+
+    /** The index of the last frame played from m_frames */
+    int m_currentFrame;
+
     /************************************************************************
      * Animation
      ************************************************************************/
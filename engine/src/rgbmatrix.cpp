@@ -22,6 +22,8 @@
 #include <QXmlStreamWriter>
 #include <QCoreApplication>
 #include <QElapsedTimer>
+#include <QThreadPool>
+#include <QRunnable>
 #include <QDebug>
 #include <cmath>
 #include <QDir>
@@ -53,6 +55,48 @@
 #define KXMLQLCRGBMatrixControlModeDimmer "Dimmer"
 #define KXMLQLCRGBMatrixControlModeShutter "Shutter"
 
+#define RGBMATRIX_STEP_CACHE_BYTES  (4 * 1024 * 1024)
+
+/**
+ * Job executed by the render pool of a RGBMatrix, rendering the
+ * algorithm map of a step ahead of the time it will be played.
+ */
+class RGBMatrixRenderJob : public QRunnable
+{
+public:
+    RGBMatrixRenderJob(RGBMatrix *matrix, const QSize& size,
+                       uint rgb, int step, int generation)
+        : m_matrix(matrix)
+        , m_size(size)
+        , m_rgb(rgb)
+        , m_step(step)
+        , m_generation(generation)
+    {
+    }
+
+    void run()
+    {
+        RGBMap map;
+        m_matrix->m_algorithm->rgbMap(m_size, m_rgb, m_step, map);
+
+        QMutexLocker renderLocker(&m_matrix->m_renderMutex);
+        RGBMatrix::RenderedStep &rendered = m_matrix->m_renderedStep;
+        rendered.m_ready = true;
+        rendered.m_size = m_size;
+        rendered.m_rgb = m_rgb;
+        rendered.m_step = m_step;
+        rendered.m_generation = m_generation;
+        rendered.m_map = map;
+    }
+
+private:
+    RGBMatrix *m_matrix;
+    QSize m_size;
+    uint m_rgb;
+    int m_step;
+    int m_generation;
+};
+
 /****************************************************************************
  * Initialization
  ****************************************************************************/
@@ -66,24 +110,42 @@ RGBMatrix::RGBMatrix(Doc* doc)
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
     , m_algorithmMutex(QMutex::Recursive)
 #endif
+    , m_stepCacheBytes(0)
+    , m_algorithmRevision(0)
+    , m_previewAlgorithm(NULL)
+    , m_previewRevision(-1)
     , m_startColor(Qt::red)
     , m_endColor(QColor())
     , m_stepHandler(new RGBMatrixStep())
     , m_roundTime(new QElapsedTimer())
     , m_stepsCount(0)
     , m_stepBeatDuration(0)
+    , m_stepStarted(true)
+    , m_headBindingsChanged(true)
+    , m_headBindingsRevision(0)
+    , m_headBindingsDirect(false)
+    , m_renderPool(NULL)
+    , m_renderGeneration(0)
     , m_controlMode(RGBMatrix::ControlModeRgb)
 {
     setName(tr("New RGB Matrix"));
     setDuration(500);
 
+    m_renderedStep.m_ready = false;
+
+    connect(doc, SIGNAL(fixtureGroupChanged(quint32)),
+            this, SLOT(slotFixtureGroupChanged(quint32)));
+
     RGBScript scr = doc->rgbScriptsCache()->script("Stripes");
     setAlgorithm(scr.clone());
 }
 
 RGBMatrix::~RGBMatrix()
 {
+    if (m_renderPool != NULL)
+        m_renderPool->waitForDone();
     delete m_algorithm;
+    delete m_previewAlgorithm;
     delete m_roundTime;
     delete m_stepHandler;
 }
@@ -125,7 +187,9 @@ quint32 RGBMatrix::totalDuration()
 
 void RGBMatrix::setDimmerControl(bool dimmerControl)
 {
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
     m_dimmerControl = dimmerControl;
+    invalidateHeadBindings();
 }
 
 bool RGBMatrix::dimmerControl() const
@@ -189,6 +253,7 @@ void RGBMatrix::setFixtureGroup(quint32 id)
     {
         QMutexLocker algoLocker(&m_algorithmMutex);
         m_group = doc()->fixtureGroup(m_fixtureGroupID);
+        invalidateHeadBindings();
     }
     m_stepsCount = stepsCount();
 }
@@ -209,8 +274,11 @@ void RGBMatrix::setAlgorithm(RGBAlgorithm* algo)
 {
     {
         QMutexLocker algorithmLocker(&m_algorithmMutex);
+        invalidateRenderedSteps();
         delete m_algorithm;
         m_algorithm = algo;
+        invalidateStepCache();
+        m_algorithmRevision++;
 
         /** If there's been a change of Script algorithm "on the fly",
          *  then re-apply the properties currently set in this RGBMatrix */
@@ -270,15 +338,131 @@ int RGBMatrix::stepsCount()
 
 void RGBMatrix::previewMap(int step, RGBMatrixStep *handler)
 {
-    QMutexLocker algorithmLocker(&m_algorithmMutex);
-    if (m_algorithm == NULL || handler == NULL)
+    if (handler == NULL)
         return;
 
-    if (m_group == NULL)
-        m_group = doc()->fixtureGroup(fixtureGroup());
+    QMutexLocker previewLocker(&m_previewMutex);
+    uint rgb = handler->stepColor().rgb();
 
-    if (m_group != NULL)
-        m_algorithm->rgbMap(m_group->size(), handler->stepColor().rgb(), step, handler->m_map);
+    /* A busy algorithm is being rendered for playback: keep previewing
+     * with the copy made so far instead of waiting */
+    if (m_previewAlgorithm == NULL || m_algorithmMutex.tryLock() == true)
+    {
+        if (m_previewAlgorithm == NULL)
+            m_algorithmMutex.lock();
+
+        if (m_algorithm == NULL)
+        {
+            m_algorithmMutex.unlock();
+            return;
+        }
+
+        if (m_group == NULL)
+            m_group = doc()->fixtureGroup(fixtureGroup());
+
+        if (m_group == NULL)
+        {
+            m_algorithmMutex.unlock();
+            return;
+        }
+
+        m_previewSize = m_group->size();
+
+        if (m_algorithm->type() != RGBAlgorithm::Script)
+        {
+            /* The other algorithms are cheap and may hold resources
+             * (audio input, media players) that shouldn't be duplicated */
+            algorithmMap(m_previewSize, rgb, step, handler->m_map);
+            m_algorithmMutex.unlock();
+
+            delete m_previewAlgorithm;
+            m_previewAlgorithm = NULL;
+            return;
+        }
+
+        /* Reuse the maps already rendered for playback */
+        if (m_algorithm->deterministic() && m_previewSize == m_stepCacheSize)
+        {
+            QHash<QPair<int, uint>, RGBMap>::const_iterator it =
+                    m_stepCache.constFind(QPair<int, uint>(step, rgb));
+            if (it != m_stepCache.constEnd())
+            {
+                handler->m_map = it.value();
+                m_algorithmMutex.unlock();
+                return;
+            }
+        }
+
+        if (m_previewAlgorithm == NULL || m_previewRevision != m_algorithmRevision)
+        {
+            delete m_previewAlgorithm;
+            m_previewAlgorithm = m_algorithm->clone();
+            m_previewRevision = m_algorithmRevision;
+        }
+
+        m_algorithmMutex.unlock();
+    }
+
+    m_previewAlgorithm->rgbMap(m_previewSize, rgb, step, handler->m_map);
+
+    /* Share the map with playback, unless the algorithm has changed
+     * in the meantime or the mutex is busy */
+    if (m_previewAlgorithm->deterministic() && m_algorithmMutex.tryLock() == true)
+    {
+        if (m_previewRevision == m_algorithmRevision)
+            cacheStepMap(m_previewSize, rgb, step, handler->m_map);
+        m_algorithmMutex.unlock();
+    }
+}
+
+void RGBMatrix::algorithmMap(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    if (m_algorithm->deterministic() == false)
+    {
+        m_algorithm->rgbMap(size, rgb, step, map);
+        return;
+    }
+
+    if (size != m_stepCacheSize)
+    {
+        invalidateStepCache();
+        m_stepCacheSize = size;
+    }
+
+    QPair<int, uint> key(step, rgb);
+    QHash<QPair<int, uint>, RGBMap>::const_iterator it = m_stepCache.constFind(key);
+    if (it != m_stepCache.constEnd())
+    {
+        map = it.value();
+        return;
+    }
+
+    m_algorithm->rgbMap(size, rgb, step, map);
+    cacheStepMap(size, rgb, step, map);
+}
+
+void RGBMatrix::cacheStepMap(const QSize& size, uint rgb, int step, const RGBMap &map)
+{
+    if (size != m_stepCacheSize)
+    {
+        invalidateStepCache();
+        m_stepCacheSize = size;
+    }
+
+    // Once the cache is full, the next maps are just rendered.
+    // Looping patterns fill it during their first cycle anyway.
+    int bytes = map.stride() * map.height() * int(sizeof(uint));
+    if (map.size() == size && m_stepCacheBytes + bytes <= RGBMATRIX_STEP_CACHE_BYTES)
+    {
+        m_stepCache.insert(QPair<int, uint>(step, rgb), map);
+        m_stepCacheBytes += bytes;
+    }
+}
+
+void RGBMatrix::invalidateStepCache()
+{
+    m_stepCache.clear();
+    m_stepCacheBytes = 0;
 }
 
 /****************************************************************************
@@ -292,8 +476,10 @@ void RGBMatrix::setStartColor(const QColor& c)
         QMutexLocker algorithmLocker(&m_algorithmMutex);
         if (m_algorithm != NULL)
         {
+            invalidateRenderedSteps();
             m_algorithm->setColors(m_startColor, m_endColor);
             updateColorDelta();
+            m_algorithmRevision++;
         }
     }
     emit changed(id());
@@ -311,8 +497,10 @@ void RGBMatrix::setEndColor(const QColor &c)
         QMutexLocker algorithmLocker(&m_algorithmMutex);
         if (m_algorithm != NULL)
         {
+            invalidateRenderedSteps();
             m_algorithm->setColors(m_startColor, m_endColor);
             updateColorDelta();
+            m_algorithmRevision++;
         }
     }
     emit changed(id());
@@ -339,7 +527,10 @@ void RGBMatrix::setProperty(QString propName, QString value)
     if (m_algorithm != NULL && m_algorithm->type() == RGBAlgorithm::Script)
     {
         RGBScript *script = static_cast<RGBScript*> (m_algorithm);
+        invalidateRenderedSteps();
         script->setProperty(propName, value);
+        invalidateStepCache();
+        m_algorithmRevision++;
     }
     m_stepsCount = stepsCount();
 }
@@ -517,6 +708,7 @@ void RGBMatrix::preRun(MasterTimer *timer)
         QMutexLocker algorithmLocker(&m_algorithmMutex);
 
         m_group = doc()->fixtureGroup(m_fixtureGroupID);
+        invalidateHeadBindings();
         if (m_group == NULL)
         {
             // No fixture group to control
@@ -532,6 +724,7 @@ void RGBMatrix::preRun(MasterTimer *timer)
             if (m_algorithm->type() == RGBAlgorithm::Script)
             {
                 RGBScript *script = static_cast<RGBScript*> (m_algorithm);
+                invalidateRenderedSteps();
                 QHashIterator<QString, QString> it(m_properties);
                 while(it.hasNext())
                 {
@@ -543,6 +736,7 @@ void RGBMatrix::preRun(MasterTimer *timer)
     }
 
     m_roundTime->restart();
+    m_stepStarted = true;
 
     Function::preRun(timer);
 }
@@ -570,15 +764,16 @@ void RGBMatrix::write(MasterTimer *timer, QList<Universe *> universes)
 
         if (isPaused() == false)
         {
-            // Get a new map every time elapsed is reset to zero
-            if (elapsed() < MasterTimer::tick())
+            // Get a new map every time a step starts
+            if (m_stepStarted)
             {
+                m_stepStarted = false;
+
                 if (tempoType() == Beats)
                     m_stepBeatDuration = beatsToTime(duration(), timer->beatTimeDuration());
 
                 //qDebug() << "RGBMatrix step" << m_stepHandler->currentStepIndex() << ", color:" << QString::number(m_stepHandler->stepColor().rgb(), 16);
-                m_algorithm->rgbMap(m_group->size(), m_stepHandler->stepColor().rgb(),
-                                    m_stepHandler->currentStepIndex(), m_stepHandler->m_map);
+                renderStep(m_group->size());
                 updateMapChannels(m_stepHandler->m_map, m_group, universes);
             }
         }
@@ -613,7 +808,8 @@ void RGBMatrix::write(MasterTimer *timer, QList<Universe *> universes)
                 if (elapsedBeats() % duration() == 0)
                 {
                     roundCheck();
-                    resetElapsed();
+                    // the step started when the beat actually happened
+                    resetElapsed(timer->beatPhase());
                 }
             }
             else if (elapsed() >= m_stepBeatDuration && (uint)timer->timeToNextBeat() > m_stepBeatDuration / 16)
@@ -652,6 +848,8 @@ void RGBMatrix::postRun(MasterTimer *timer, QList<Universe *> universes)
 
     {
         QMutexLocker algorithmLocker(&m_algorithmMutex);
+        invalidateHeadBindings();
+        invalidateRenderedSteps();
         if (m_algorithm != NULL)
             m_algorithm->postRun();
     }
@@ -669,6 +867,7 @@ void RGBMatrix::roundCheck()
         stop(FunctionParent::master());
 
     m_roundTime->restart();
+    m_stepStarted = true;
 
     if (tempoType() == Beats)
         roundElapsed(m_stepBeatDuration);
@@ -676,21 +875,37 @@ void RGBMatrix::roundCheck()
         roundElapsed(duration());
 }
 
-FadeChannel *RGBMatrix::getFader(QList<Universe *> universes, quint32 universeID, quint32 fixtureID, quint32 channel)
+GenericFader *RGBMatrix::universeFader(QList<Universe *> universes, quint32 universeID)
 {
-    // get the universe Fader first. If doesn't exist, create it
     QSharedPointer<GenericFader> fader = m_fadersMap.value(universeID, QSharedPointer<GenericFader>());
     if (fader.isNull())
     {
         fader = universes[universeID]->requestFader();
         fader->adjustIntensity(getAttributeValue(Intensity));
         fader->setBlendMode(blendMode());
+        fader->setFadeCurve(fadeCurve());
         fader->setName(name());
         fader->setParentFunctionID(id());
         m_fadersMap[universeID] = fader;
     }
 
-    return fader->getChannelFader(doc(), universes[universeID], fixtureID, channel);
+    return fader.data();
+}
+
+FadeChannel *RGBMatrix::getFader(QList<Universe *> universes, quint32 universeID, quint32 fixtureID, quint32 channel)
+{
+    return universeFader(universes, universeID)->getChannelFader(doc(), universes[universeID], fixtureID, channel);
+}
+
+quint32 RGBMatrix::addLayerChannel(GenericFader *fader, quint32 fixtureID, quint32 channel)
+{
+    // A FadeChannel detects the address and the type of the channel
+    FadeChannel fc(doc(), fixtureID, channel);
+    int flags = FadeChannel::Intensity | FadeChannel::CanFade;
+
+    fader->addLayerChannel(fc.addressInUniverse(), (fc.flags() & flags) == flags);
+
+    return fc.addressInUniverse();
 }
 
 void RGBMatrix::updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime)
@@ -709,143 +924,257 @@ void RGBMatrix::updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime)
 void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup *grp, QList<Universe *> universes)
 {
     uint fadeTime = (overrideFadeInSpeed() == defaultSpeed()) ? fadeInSpeed() : overrideFadeInSpeed();
+    uint fadeOut = (overrideFadeOutSpeed() == defaultSpeed()) ? fadeOutSpeed() : overrideFadeOutSpeed();
 
-    // Create/modify fade channels for ALL heads in the group
-    QMapIterator<QLCPoint, GroupHead> it(grp->headsMap());
-    while (it.hasNext())
+    /* Without fades, the channels just follow the map: skip the FadeChannels
+     * and write the map straight into the faders layer */
+    bool direct = (fadeTime == 0 && fadeOut == 0 && fadeOutSpeed() == 0);
+
+    if (direct != m_headBindingsDirect)
     {
-        it.next();
-        QLCPoint pt = it.key();
-        GroupHead grpHead = it.value();
-        Fixture *fxi = doc()->fixture(grpHead.fxi);
-        if (fxi == NULL)
-            continue;
+        // drop the channels of the other mode
+        foreach (QSharedPointer<GenericFader> fader, m_fadersMap.values())
+        {
+            if (!fader.isNull())
+                fader->removeAll();
+        }
+        m_headBindingsChanged = true;
+    }
 
-        QLCFixtureHead head = fxi->head(grpHead.head);
+    if (m_headBindingsChanged || m_headBindingsRevision != doc()->fixturesRevision())
+        buildHeadBindings(grp, universes, direct);
 
-        if (pt.y() >= map.count() || pt.x() >= map[pt.y()].count())
+    // Update fade channels for ALL heads in the group
+    foreach (const HeadBinding &binding, m_headBindings)
+    {
+        if (binding.m_y >= map.height() || binding.m_x >= map.width())
             continue;
 
-        uint col = map[pt.y()][pt.x()];
+        uint col = map[binding.m_y][binding.m_x];
+        int colorCount = direct ? binding.m_colorAddresses.size() : binding.m_colorChannels.size();
+        uchar colors[3] = { 0, 0, 0 };
 
-        if (m_controlMode == ControlModeRgb)
+        if (colorCount == 3)
         {
-            QVector <quint32> rgb = head.rgbChannels();
-            QVector <quint32> cmy = head.cmyChannels();
-
-            if (rgb.size() == 3)
+            if (binding.m_cmy)
+            {
+                // CMY color mixing
+                QColor cmyCol(col);
+                colors[0] = cmyCol.cyan();
+                colors[1] = cmyCol.magenta();
+                colors[2] = cmyCol.yellow();
+            }
+            else
             {
                 // RGB color mixing
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, rgb.at(0));
-                updateFaderValues(fc, qRed(col), fadeTime);
+                colors[0] = qRed(col);
+                colors[1] = qGreen(col);
+                colors[2] = qBlue(col);
+            }
+        }
+        else if (colorCount == 1)
+        {
+            colors[0] = rgbToGrey(col);
+        }
 
-                fc = getFader(universes, fxi->universe(), grpHead.fxi, rgb.at(1));
-                updateFaderValues(fc, qGreen(col), fadeTime);
+        // Dimmer to value of the color (e.g. for PARs)
+        // and the rest of the dimmer channels to full on
+        uchar grey = rgbToGrey(col);
+        uchar full = col == 0 ? 0 : 255;
 
-                fc = getFader(universes, fxi->universe(), grpHead.fxi, rgb.at(2));
-                updateFaderValues(fc, qBlue(col), fadeTime);
-            }
-            else if (cmy.size() == 3)
-            {
-                // CMY color mixing
-                QColor cmyCol(col);
+        if (direct)
+        {
+            GenericFader *layer = binding.m_layer;
 
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, cmy.at(0));
-                updateFaderValues(fc, cmyCol.cyan(), fadeTime);
+            for (int i = 0; i < colorCount; i++)
+                layer->setLayerValue(binding.m_colorAddresses.at(i), colors[i]);
 
-                fc = getFader(universes, fxi->universe(), grpHead.fxi, cmy.at(1));
-                updateFaderValues(fc, cmyCol.magenta(), fadeTime);
+            if (binding.m_greyDimmerAddress != QLCChannel::invalid())
+                layer->setLayerValue(binding.m_greyDimmerAddress, grey);
 
-                fc = getFader(universes, fxi->universe(), grpHead.fxi, cmy.at(2));
-                updateFaderValues(fc, cmyCol.yellow(), fadeTime);
-            }
-        }
-        else if (m_controlMode == ControlModeWhite)
-        {
-            quint32 white = head.channelNumber(QLCChannel::White, QLCChannel::MSB);
+            foreach (quint32 address, binding.m_fullDimmerAddresses)
+                layer->setLayerValue(address, full);
 
-            if (white != QLCChannel::invalid())
-            {
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, white);
-                updateFaderValues(fc, rgbToGrey(col), fadeTime);
-            }
+            continue;
         }
-        else if (m_controlMode == ControlModeAmber)
-        {
-            quint32 amber = head.channelNumber(QLCChannel::Amber, QLCChannel::MSB);
 
-            if (amber != QLCChannel::invalid())
-            {
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, amber);
-                updateFaderValues(fc, rgbToGrey(col), fadeTime);
-            }
+        for (int i = 0; i < colorCount; i++)
+            updateFaderValues(binding.m_colorChannels.at(i), colors[i], fadeTime);
+
+        if (binding.m_greyDimmer != NULL)
+            updateFaderValues(binding.m_greyDimmer, grey, fadeTime);
+
+        foreach (FadeChannel *fc, binding.m_fullDimmers)
+            updateFaderValues(fc, full, fadeTime);
+    }
+}
+
+void RGBMatrix::buildHeadBindings(const FixtureGroup *grp, QList<Universe *> universes, bool direct)
+{
+    /* A shallow copy, since the group might be edited while this runs */
+    QVector<GroupHead> heads = grp->headGrid();
+    int width = grp->size().width();
+
+    /* The layer channels of the old heads would keep their last value */
+    if (direct)
+    {
+        foreach (QSharedPointer<GenericFader> fader, m_fadersMap.values())
+        {
+            if (!fader.isNull())
+                fader->removeAll();
         }
-        else if (m_controlMode == ControlModeUV)
+    }
+
+    /* Resolve the heads twice: the first pass creates all the missing fader
+     * channels, so that the pointers collected by the second pass are not
+     * invalidated by further insertions into the faders channel hash.
+     * The direct layer has no such issue */
+    for (int pass = direct ? 1 : 0; pass < 2; pass++)
+    {
+        m_headBindings.clear();
+        m_headBindings.reserve(heads.count());
+
+        for (int i = 0; i < heads.count(); i++)
         {
-            quint32 uv = head.channelNumber(QLCChannel::UV, QLCChannel::MSB);
+            const GroupHead &grpHead = heads.at(i);
+            if (grpHead.isValid() == false)
+                continue;
+
+            Fixture *fxi = doc()->fixture(grpHead.fxi);
+            if (fxi == NULL)
+                continue;
+
+            int head = grpHead.head;
+            quint32 universe = fxi->universe();
+
+            HeadBinding binding;
+            binding.m_x = i % width;
+            binding.m_y = i / width;
+            binding.m_cmy = false;
+            binding.m_greyDimmer = NULL;
+            binding.m_layer = NULL;
+            binding.m_greyDimmerAddress = QLCChannel::invalid();
+
+            QVector <quint32> colors;
+            quint32 greyDimmer = QLCChannel::invalid();
+            QVector <quint32> fullDimmers;
+
+            if (m_controlMode == ControlModeRgb)
+            {
+                QVector <quint32> rgb = fxi->rgbChannels(head);
+                QVector <quint32> cmy = fxi->cmyChannels(head);
 
-            if (uv != QLCChannel::invalid())
+                if (rgb.size() == 3)
+                {
+                    colors = rgb;
+                }
+                else if (cmy.size() == 3)
+                {
+                    colors = cmy;
+                    binding.m_cmy = true;
+                }
+            }
+            else
             {
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, uv);
-                updateFaderValues(fc, rgbToGrey(col), fadeTime);
+                quint32 grey = QLCChannel::invalid();
+
+                if (m_controlMode == ControlModeWhite)
+                    grey = fxi->channelNumber(QLCChannel::White, QLCChannel::MSB, head);
+                else if (m_controlMode == ControlModeAmber)
+                    grey = fxi->channelNumber(QLCChannel::Amber, QLCChannel::MSB, head);
+                else if (m_controlMode == ControlModeUV)
+                    grey = fxi->channelNumber(QLCChannel::UV, QLCChannel::MSB, head);
+                else if (m_controlMode == ControlModeShutter)
+                    grey = fxi->channelNumber(QLCChannel::Shutter, QLCChannel::MSB, head);
+
+                if (grey != QLCChannel::invalid())
+                    colors.append(grey);
             }
-        }
-        else if (m_controlMode == ControlModeShutter)
-        {
-            QVector <quint32> shutters = head.shutterChannels();
 
-            if (shutters.size())
+            if (m_controlMode == ControlModeDimmer || m_dimmerControl)
             {
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, shutters.first());
-                updateFaderValues(fc, rgbToGrey(col), fadeTime);
+                quint32 masterDim = fxi->masterIntensityChannel();
+                quint32 headDim = fxi->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, head);
+                QVector <quint32> dimmers;
+
+                // Collect all dimmers that affect current head:
+                // They are the master dimmer (affects whole fixture)
+                // and per-head dimmer.
+                //
+                // If there are no RGB or CMY channels, the least important* dimmer channel
+                // is used to create grayscale image.
+                //
+                // The rest of the dimmer channels are set to full if dimmer control is
+                // enabled and target color is > 0 (see
+                // http://www.qlcplus.org/forum/viewtopic.php?f=29&t=11090)
+                //
+                // Note: If there is only one head, and only one dimmer channel,
+                // make it a master dimmer in fixture definition.
+                //
+                // *least important - per head dimmer if present,
+                // otherwise per fixture dimmer if present
+
+                if (masterDim != QLCChannel::invalid())
+                    dimmers << masterDim;
+
+                if (headDim != QLCChannel::invalid())
+                    dimmers << headDim;
+
+                if (dimmers.size())
+                {
+                    greyDimmer = dimmers.last();
+                    dimmers.pop_back();
+                }
+
+                fullDimmers = dimmers;
             }
-        }
 
-        if (m_controlMode == ControlModeDimmer || m_dimmerControl)
-        {
-            quint32 masterDim = fxi->masterIntensityChannel();
-            quint32 headDim = head.channelNumber(QLCChannel::Intensity, QLCChannel::MSB);
-            QVector <quint32> dimmers;
-
-            // Collect all dimmers that affect current head:
-            // They are the master dimmer (affects whole fixture)
-            // and per-head dimmer.
-            //
-            // If there are no RGB or CMY channels, the least important* dimmer channel
-            // is used to create grayscale image.
-            //
-            // The rest of the dimmer channels are set to full if dimmer control is
-            // enabled and target color is > 0 (see
-            // http://www.qlcplus.org/forum/viewtopic.php?f=29&t=11090)
-            //
-            // Note: If there is only one head, and only one dimmer channel,
-            // make it a master dimmer in fixture definition.
-            //
-            // *least important - per head dimmer if present,
-            // otherwise per fixture dimmer if present
-
-            if (masterDim != QLCChannel::invalid())
-                dimmers << masterDim;
-
-            if (headDim != QLCChannel::invalid())
-                dimmers << headDim;
-
-            if (dimmers.size())
+            if (direct)
             {
-                // Set dimmer to value of the color (e.g. for PARs)
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, dimmers.last());
-                updateFaderValues(fc, rgbToGrey(col), fadeTime);
-                dimmers.pop_back();
-            }
+                binding.m_layer = universeFader(universes, universe);
+
+                foreach (quint32 ch, colors)
+                    binding.m_colorAddresses.append(addLayerChannel(binding.m_layer, grpHead.fxi, ch));
+
+                if (greyDimmer != QLCChannel::invalid())
+                    binding.m_greyDimmerAddress = addLayerChannel(binding.m_layer, grpHead.fxi, greyDimmer);
 
-            // Set the rest of the dimmer channels to full on
-            foreach (quint32 ch, dimmers)
+                foreach (quint32 ch, fullDimmers)
+                    binding.m_fullDimmerAddresses.append(addLayerChannel(binding.m_layer, grpHead.fxi, ch));
+            }
+            else
             {
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, ch);
-                updateFaderValues(fc, col == 0 ? 0 : 255, fadeTime);
+                foreach (quint32 ch, colors)
+                    binding.m_colorChannels.append(getFader(universes, universe, grpHead.fxi, ch));
+
+                if (greyDimmer != QLCChannel::invalid())
+                    binding.m_greyDimmer = getFader(universes, universe, grpHead.fxi, greyDimmer);
+
+                foreach (quint32 ch, fullDimmers)
+                    binding.m_fullDimmers.append(getFader(universes, universe, grpHead.fxi, ch));
             }
+
+            m_headBindings.append(binding);
         }
     }
+
+    m_headBindingsChanged = false;
+    m_headBindingsRevision = doc()->fixturesRevision();
+    m_headBindingsDirect = direct;
+}
+
+void RGBMatrix::invalidateHeadBindings()
+{
+    m_headBindingsChanged = true;
+}
+
+void RGBMatrix::slotFixtureGroupChanged(quint32 id)
+{
+    if (id != m_fixtureGroupID)
+        return;
+
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
+    invalidateHeadBindings();
 }
 
 uchar RGBMatrix::rgbToGrey(uint col)
@@ -855,6 +1184,91 @@ uchar RGBMatrix::rgbToGrey(uint col)
     return (0.299 * qRed(col) + 0.587 * qGreen(col) + 0.114 * qBlue(col));
 }
 
+/*********************************************************************
+ * Ahead-of-time rendering
+ *********************************************************************/
+
+void RGBMatrix::renderStep(const QSize& size)
+{
+    uint rgb = m_stepHandler->stepColor().rgb();
+    int step = m_stepHandler->currentStepIndex();
+
+    /* Only scripts can render on another thread, each one
+     * running in its own engine. Deterministic scripts are
+     * served by the step cache once the first cycle is done */
+    if (m_algorithm->type() != RGBAlgorithm::Script || m_algorithm->deterministic())
+    {
+        algorithmMap(size, rgb, step, m_stepHandler->m_map);
+        return;
+    }
+
+    if (m_renderPool == NULL)
+    {
+        m_renderPool = new QThreadPool(this);
+        m_renderPool->setMaxThreadCount(1);
+        // Keep the same thread, and so the same script engine, for
+        // the whole life of the matrix, or stateful scripts would
+        // start over after a pause
+        m_renderPool->setExpiryTimeout(-1);
+    }
+
+    if (takeRenderedStep(size, rgb, step, m_stepHandler->m_map) == false)
+    {
+        /* The predicted step might still be rendering */
+        m_renderPool->waitForDone();
+    }
+
+    if (takeRenderedStep(size, rgb, step, m_stepHandler->m_map) == false)
+    {
+        /* Wrong prediction: render now, but still on the render
+         * thread, so that the script keeps its state in one engine */
+        invalidateRenderedSteps();
+        scheduleRender(size, rgb, step);
+        m_renderPool->waitForDone();
+        takeRenderedStep(size, rgb, step, m_stepHandler->m_map);
+    }
+
+    /* Render the next step while this one is playing */
+    RGBMatrixStep next(*m_stepHandler);
+    if (next.checkNextStep(runOrder(), m_startColor, m_endColor, m_stepsCount))
+        scheduleRender(size, next.stepColor().rgb(), next.currentStepIndex());
+}
+
+void RGBMatrix::scheduleRender(const QSize& size, uint rgb, int step)
+{
+    m_renderPool->start(new RGBMatrixRenderJob(this, size, rgb, step, m_renderGeneration));
+}
+
+bool RGBMatrix::takeRenderedStep(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    QMutexLocker renderLocker(&m_renderMutex);
+
+    if (m_renderedStep.m_ready == false ||
+        m_renderedStep.m_generation != m_renderGeneration ||
+        m_renderedStep.m_step != step ||
+        m_renderedStep.m_rgb != rgb ||
+        m_renderedStep.m_size != size)
+            return false;
+
+    map = m_renderedStep.m_map;
+    m_renderedStep.m_ready = false;
+    m_renderedStep.m_map = RGBMap();
+
+    return true;
+}
+
+void RGBMatrix::invalidateRenderedSteps()
+{
+    m_renderGeneration++;
+
+    if (m_renderPool != NULL)
+        m_renderPool->waitForDone();
+
+    QMutexLocker renderLocker(&m_renderMutex);
+    m_renderedStep.m_ready = false;
+    m_renderedStep.m_map = RGBMap();
+}
+
 /*********************************************************************
  * Attributes
  *********************************************************************/
@@ -905,7 +1319,11 @@ RGBMatrix::ControlMode RGBMatrix::controlMode() const
 
 void RGBMatrix::setControlMode(RGBMatrix::ControlMode mode)
 {
-    m_controlMode = mode;
+    {
+        QMutexLocker algorithmLocker(&m_algorithmMutex);
+        m_controlMode = mode;
+        invalidateHeadBindings();
+    }
     emit changed(id());
 }
 
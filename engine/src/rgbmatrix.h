@@ -38,6 +38,7 @@
 #include "function.h"
 
 class QElapsedTimer;
+class QThreadPool;
 class FixtureGroup;
 class GenericFader;
 class FadeChannel;
@@ -98,6 +99,8 @@ class RGBMatrix : public Function
     Q_OBJECT
     Q_DISABLE_COPY(RGBMatrix)
 
+    friend class RGBMatrixRenderJob;
+
    /*********************************************************************
      * Initialization
      *********************************************************************/
@@ -173,9 +176,31 @@ public:
     /** Get the number of steps of the current algorithm */
     int stepsCount();
 
-    /** Get the preview of the current algorithm at the given step */
+    /**
+     * Get the preview of the current algorithm at the given step.
+     *
+     * Script algorithms are previewed with a copy of their own, running in
+     * the script engine of the calling thread, so an editor preview never
+     * holds the algorithm mutex while a script runs. The maps already in
+     * the step cache are reused, but only when the mutex is free: the
+     * preview never waits for playback.
+     */
     void previewMap(int step, RGBMatrixStep *handler);
 
+private:
+    /** Render the algorithm map for $step and $rgb into $map, reusing
+     *  the maps already rendered by deterministic algorithms.
+     *  Must be called with m_algorithmMutex locked */
+    void algorithmMap(const QSize& size, uint rgb, int step, RGBMap &map);
+
+    /** Keep $map, rendered for $step and $rgb, in the step cache if there
+     *  is room for it. Must be called with m_algorithmMutex locked */
+    void cacheStepMap(const QSize& size, uint rgb, int step, const RGBMap &map);
+
+    /** Forget the cached algorithm maps. Must be called with
+     *  m_algorithmMutex locked */
+    void invalidateStepCache();
+
 private:
     RGBAlgorithm *m_algorithm;
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
@@ -184,6 +209,30 @@ private:
     QRecursiveMutex m_algorithmMutex;
 #endif
 
+    /** The maps rendered by a deterministic algorithm, by step and color */
+    QHash<QPair<int, uint>, RGBMap> m_stepCache;
+
+    /** The map size m_stepCache has been rendered with */
+    QSize m_stepCacheSize;
+
+    /** The amount of memory, in bytes, used by m_stepCache */
+    int m_stepCacheBytes;
+
+    /** Incremented when the algorithm or its settings change */
+    int m_algorithmRevision;
+
+    /** The copy of a script algorithm rendering the previews */
+    RGBAlgorithm *m_previewAlgorithm;
+
+    /** The m_algorithmRevision m_previewAlgorithm has been copied at */
+    int m_previewRevision;
+
+    /** The map size of the last preview */
+    QSize m_previewSize;
+
+    /** Protects the preview members above */
+    QMutex m_previewMutex;
+
     /************************************************************************
      * Color
      ************************************************************************/
@@ -245,12 +294,54 @@ private:
     /** Check what should be done when elapsed() >= duration() */
     void roundCheck();
 
+    /** Get the fader of the given universe. If it doesn't exist, create it */
+    GenericFader *universeFader(QList<Universe *> universes, quint32 universeID);
+
     FadeChannel *getFader(QList<Universe *> universes, quint32 universeID, quint32 fixtureID, quint32 channel);
     void updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime);
 
-    /** Update FadeChannels when $map has changed since last time */
+    /** Add a fixture channel to the direct layer of $fader and return its
+     *  address in the universe */
+    quint32 addLayerChannel(GenericFader *fader, quint32 fixtureID, quint32 channel);
+
+    /** Update FadeChannels when $map has changed since last time.
+     *  A matrix without fades writes $map directly to the faders layer */
     void updateMapChannels(const RGBMap& map, const FixtureGroup* grp, QList<Universe *> universes);
 
+    /** A fixture group head resolved to the fader channels it drives */
+    struct HeadBinding
+    {
+        /** Position of the head in the RGB map */
+        int m_x;
+        int m_y;
+        /** Color channels: R,G,B or C,M,Y, or one single channel
+         *  driven by the grey level (white, amber, UV, shutter) */
+        QVector<FadeChannel *> m_colorChannels;
+        bool m_cmy;
+        /** The dimmer driven by the grey level, if any */
+        FadeChannel *m_greyDimmer;
+        /** Additional dimmers set to full when the color is not black */
+        QVector<FadeChannel *> m_fullDimmers;
+
+        /** In direct mode, the fader whose layer holds the channels, and
+         *  the addresses of the same channels as above */
+        GenericFader *m_layer;
+        QVector<quint32> m_colorAddresses;
+        quint32 m_greyDimmerAddress;
+        QVector<quint32> m_fullDimmerAddresses;
+    };
+
+    /** Resolve every head of $grp into m_headBindings, requesting all the
+     *  needed fader channels, or the direct layer channels if $direct */
+    void buildHeadBindings(const FixtureGroup* grp, QList<Universe *> universes, bool direct);
+
+    /** Mark m_headBindings as outdated. Must be called with
+     *  m_algorithmMutex locked */
+    void invalidateHeadBindings();
+
+private slots:
+    void slotFixtureGroupChanged(quint32 id);
+
 public:
     /** Convert color values to fader value */
     uchar rgbToGrey(uint col);
@@ -265,6 +356,64 @@ private:
     /** The duration of a step based on the current BPM (Beats tempo only) */
     uint m_stepBeatDuration;
 
+    /** Flag raised when a new step starts, to render it at the next write.
+     *  The elapsed time of a step may start past zero, at its sub-tick phase */
+    bool m_stepStarted;
+
+    /** The heads of m_group, bound to the fader channels of m_fadersMap */
+    QVector<HeadBinding> m_headBindings;
+
+    /** Flag raised when m_headBindings must be rebuilt */
+    bool m_headBindingsChanged;
+
+    /** The Doc fixtures revision m_headBindings has been built with */
+    int m_headBindingsRevision;
+
+    /** True if m_headBindings drive the direct layer of the faders */
+    bool m_headBindingsDirect;
+
+    /*********************************************************************
+     * Ahead-of-time rendering
+     *********************************************************************/
+private:
+    /** Fill m_stepHandler->m_map with the current step map, taking it from
+     *  the render pool when it has been predicted, and schedule the
+     *  rendering of the next step. Must be called with m_algorithmMutex locked */
+    void renderStep(const QSize& size);
+
+    /** Schedule the rendering of the given step on m_renderPool */
+    void scheduleRender(const QSize& size, uint rgb, int step);
+
+    /** Take the map rendered for the given step, if available */
+    bool takeRenderedStep(const QSize& size, uint rgb, int step, RGBMap &map);
+
+    /** Wait for the pending renders and discard their results.
+     *  Must be called with m_algorithmMutex locked */
+    void invalidateRenderedSteps();
+
+private:
+    /** A step map rendered by m_renderPool */
+    struct RenderedStep
+    {
+        bool m_ready;
+        QSize m_size;
+        uint m_rgb;
+        int m_step;
+        int m_generation;
+        RGBMap m_map;
+    };
+
+    /** The single thread rendering the steps of script algorithms.
+     *  Created when first needed */
+    QThreadPool *m_renderPool;
+
+    /** The last step rendered by m_renderPool, protected by m_renderMutex */
+    RenderedStep m_renderedStep;
+    QMutex m_renderMutex;
+
+    /** Incremented every time the pending renders become outdated */
+    int m_renderGeneration;
+
     /*********************************************************************
      * Attributes
      *********************************************************************/
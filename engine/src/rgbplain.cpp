@@ -59,12 +59,8 @@ int RGBPlain::rgbMapStepCount(const QSize& size)
 void RGBPlain::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
     Q_UNUSED(step)
-    map.resize(size.height());
-    for (int y = 0; y < size.height(); y++)
-    {
-        map[y].resize(size.width());
-        map[y].fill(rgb);
-    }
+    map.resize(size);
+    map.fill(rgb);
 }
 
 QString RGBPlain::name() const
@@ -19,10 +19,10 @@
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
-#include <QCoreApplication>
 #include <QScriptEngine>
 #include <QScriptValue>
 #include <QStringList>
+#include <QThread>
 #include <QDebug>
 #include <QFile>
 #include <QSize>
@@ -39,12 +39,8 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
-QScriptEngine* RGBScript::s_engine = NULL;
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-  QMutex* RGBScript::s_engineMutex = NULL;
-#else
-  QRecursiveMutex* RGBScript::s_engineMutex = NULL;
-#endif
+QHash<QThread *, RGBScript::ScriptEngine *> RGBScript::s_engines;
+QMutex RGBScript::s_enginesMutex;
 
 /****************************************************************************
  * Initialization
@@ -52,7 +48,11 @@ QScriptEngine* RGBScript::s_engine = NULL;
 
 RGBScript::RGBScript(Doc * doc)
     : RGBAlgorithm(doc)
+    , m_contentsRevision(0)
     , m_apiVersion(0)
+    , m_deterministic(false)
+    , m_acceptColors(2)
+    , m_propertiesRevision(0)
 {
 }
 
@@ -60,17 +60,26 @@ RGBScript::RGBScript(const RGBScript& s)
     : RGBAlgorithm(s.doc())
     , m_fileName(s.m_fileName)
     , m_contents(s.m_contents)
+    , m_contentsRevision(0)
     , m_apiVersion(0)
+    , m_deterministic(false)
+    , m_acceptColors(2)
+    , m_propertiesRevision(0)
 {
-    evaluate();
-    foreach(RGBScriptProperty cap, s.m_properties)
-    {
-        setProperty(cap.m_name, s.property(cap.m_name));
-    }
+    // The copy is compiled only when an engine first uses it
+    applyMetadata(s.metadata());
+    copyPropertyValues(s);
 }
 
 RGBScript::~RGBScript()
 {
+    QHashIterator<ScriptEngine *, ScriptProgram *> it(m_programs);
+    while (it.hasNext())
+    {
+        it.next();
+        QMutexLocker engineLocker(&it.key()->m_mutex);
+        delete it.value();
+    }
 }
 
 RGBScript &RGBScript::operator=(const RGBScript &s)
@@ -79,12 +88,8 @@ RGBScript &RGBScript::operator=(const RGBScript &s)
     {
         m_fileName = s.m_fileName;
         m_contents = s.m_contents;
-        m_apiVersion = s.m_apiVersion;
-        evaluate();
-        foreach(RGBScriptProperty cap, s.m_properties)
-        {
-            setProperty(cap.m_name, s.property(cap.m_name));
-        }
+        applyMetadata(s.metadata());
+        copyPropertyValues(s);
     }
 
     return *this;
@@ -108,17 +113,9 @@ RGBAlgorithm* RGBScript::clone() const
  * Load & Evaluation
  ****************************************************************************/
 
-bool RGBScript::load(const QDir& dir, const QString& fileName)
+bool RGBScript::load(const QDir& dir, const QString& fileName, const QVariantMap& metadata)
 {
-    // Create the script engine when it's first needed
-    initEngine();
-
-    QMutexLocker engineLocker(s_engineMutex);
-
     m_contents.clear();
-    m_script = QScriptValue();
-    m_rgbMap = QScriptValue();
-    m_rgbMapStepCount = QScriptValue();
     m_apiVersion = 0;
 
     m_fileName = fileName;
@@ -133,6 +130,9 @@ bool RGBScript::load(const QDir& dir, const QString& fileName)
     m_contents = stream.readAll();
     file.close();
 
+    if (metadata.isEmpty() == false)
+        return applyMetadata(metadata);
+
     QScriptSyntaxCheckResult result = QScriptEngine::checkSyntax(m_contents);
     if (result.state() == QScriptSyntaxCheckResult::Valid)
         return evaluate();
@@ -152,65 +152,195 @@ QString RGBScript::fileName() const
 
 bool RGBScript::evaluate()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+
+    {
+        // Outdate the programs of all the engines and forget
+        // the properties set on the previous contents
+        QMutexLocker programsLocker(&m_programsMutex);
+        m_contentsRevision++;
+        m_propertyValues.clear();
+        m_propertiesRevision++;
+    }
 
-    m_rgbMap = QScriptValue();
-    m_rgbMapStepCount = QScriptValue();
     m_apiVersion = 0;
+    m_deterministic = false;
+    m_name.clear();
+    m_author.clear();
+    m_acceptColors = 2;
 
-    m_script = s_engine->evaluate(m_contents, m_fileName);
-    if (s_engine->hasUncaughtException() == true)
+    ScriptProgram *prog = program(engine);
+    if (prog->m_valid == false)
+        return false;
+
+    QScriptValue name = prog->m_script.property("name");
+    m_name = name.isValid() ? name.toString() : QString();
+    QScriptValue author = prog->m_script.property("author");
+    m_author = author.isValid() ? author.toString() : QString();
+    // if no property is provided, let's assume the script
+    // will accept both start and end colors
+    QScriptValue accColors = prog->m_script.property("acceptColors");
+    m_acceptColors = accColors.isValid() ? accColors.toInt32() : 2;
+
+    m_apiVersion = prog->m_script.property("apiVersion").toInteger();
+    if (m_apiVersion > 0)
+    {
+        m_deterministic = prog->m_script.property("deterministic").toBool();
+        if (m_apiVersion == 2)
+            return loadProperties(prog);
+        return true;
+    }
+    else
+    {
+        qWarning() << m_fileName << "has an invalid apiVersion:" << m_apiVersion;
+        return false;
+    }
+}
+
+QVariantMap RGBScript::metadata() const
+{
+    QVariantMap metadata;
+    metadata["name"] = m_name;
+    metadata["author"] = m_author;
+    metadata["apiVersion"] = m_apiVersion;
+    metadata["acceptColors"] = m_acceptColors;
+    metadata["deterministic"] = m_deterministic;
+
+    QMutexLocker programsLocker(&m_programsMutex);
+    metadata["properties"] = m_propertyDefinitions;
+
+    return metadata;
+}
+
+bool RGBScript::applyMetadata(const QVariantMap& metadata)
+{
+    {
+        // Outdate the programs of all the engines, like evaluate() does
+        QMutexLocker programsLocker(&m_programsMutex);
+        m_contentsRevision++;
+        m_propertyValues.clear();
+        m_propertiesRevision++;
+    }
+
+    m_name = metadata.value("name").toString();
+    m_author = metadata.value("author").toString();
+    m_apiVersion = metadata.value("apiVersion", 0).toInt();
+    m_acceptColors = metadata.value("acceptColors", 2).toInt();
+    m_deterministic = metadata.value("deterministic", false).toBool();
+    parseProperties(metadata.value("properties").toStringList());
+
+    return m_apiVersion > 0;
+}
+
+void RGBScript::copyPropertyValues(const RGBScript& s)
+{
+    QHash<QString, QString> values;
+    {
+        QMutexLocker locker(&s.m_programsMutex);
+        values = s.m_propertyValues;
+    }
+
+    QMutexLocker programsLocker(&m_programsMutex);
+    m_propertyValues = values;
+    m_propertiesRevision++;
+}
+
+bool RGBScript::evaluateProgram(ScriptEngine *engine, ScriptProgram *prog) const
+{
+    prog->m_script = QScriptValue();
+    prog->m_rgbMap = QScriptValue();
+    prog->m_rgbMapStepCount = QScriptValue();
+
+    if (m_contents.isEmpty())
+        return false;
+
+    QScriptEngine *scriptEngine = engine->m_engine;
+    prog->m_script = scriptEngine->evaluate(m_contents, m_fileName);
+    if (scriptEngine->hasUncaughtException() == true)
     {
         QString msg("%1: %2");
-        qWarning() << msg.arg(m_fileName).arg(s_engine->uncaughtException().toString());
-        foreach (QString s, s_engine->uncaughtExceptionBacktrace())
+        qWarning() << msg.arg(m_fileName).arg(scriptEngine->uncaughtException().toString());
+        foreach (QString s, scriptEngine->uncaughtExceptionBacktrace())
             qDebug() << s;
         return false;
     }
-    else
+
+    prog->m_rgbMap = prog->m_script.property("rgbMap");
+    if (prog->m_rgbMap.isFunction() == false)
     {
-        m_rgbMap = m_script.property("rgbMap");
-        if (m_rgbMap.isFunction() == false)
-        {
-            qWarning() << m_fileName << "is missing the rgbMap() function!";
-            return false;
-        }
+        qWarning() << m_fileName << "is missing the rgbMap() function!";
+        return false;
+    }
 
-        m_rgbMapStepCount = m_script.property("rgbMapStepCount");
-        if (m_rgbMapStepCount.isFunction() == false)
-        {
-            qWarning() << m_fileName << "is missing the rgbMapStepCount() function!";
-            return false;
-        }
+    prog->m_rgbMapStepCount = prog->m_script.property("rgbMapStepCount");
+    if (prog->m_rgbMapStepCount.isFunction() == false)
+    {
+        qWarning() << m_fileName << "is missing the rgbMapStepCount() function!";
+        return false;
+    }
 
-        m_apiVersion = m_script.property("apiVersion").toInteger();
-        if (m_apiVersion > 0)
-        {
-            if (m_apiVersion == 2)
-                return loadProperties();
-            return true;
-        }
-        else
-        {
-            qWarning() << m_fileName << "has an invalid apiVersion:" << m_apiVersion;
-            return false;
-        }
+    return true;
+}
+
+RGBScript::ScriptEngine *RGBScript::threadEngine()
+{
+    QMutexLocker locker(&s_enginesMutex);
+
+    // Engines are created when first needed by a thread and, like
+    // the scripts evaluated in them, live until the application quits
+    ScriptEngine *engine = s_engines.value(QThread::currentThread(), NULL);
+    if (engine == NULL)
+    {
+        engine = new ScriptEngine();
+        engine->m_engine = new QScriptEngine();
+        s_engines[QThread::currentThread()] = engine;
     }
+
+    return engine;
 }
 
-void RGBScript::initEngine()
+RGBScript::ScriptProgram *RGBScript::program(ScriptEngine *engine) const
 {
-    if (s_engineMutex == NULL)
+    QMutexLocker programsLocker(&m_programsMutex);
+
+    ScriptProgram *prog = m_programs.value(engine, NULL);
+    if (prog == NULL)
     {
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-        s_engineMutex = new QMutex(QMutex::Recursive);
-#else
-        s_engineMutex = new QRecursiveMutex();
-#endif
-        s_engine = new QScriptEngine(QCoreApplication::instance());
+        prog = new ScriptProgram();
+        prog->m_valid = false;
+        prog->m_contentsRevision = -1;
+        prog->m_propertiesRevision = -1;
+        m_programs[engine] = prog;
+    }
+
+    if (prog->m_contentsRevision != m_contentsRevision)
+    {
+        prog->m_valid = evaluateProgram(engine, prog);
+        prog->m_contentsRevision = m_contentsRevision;
+        prog->m_propertiesRevision = -1;
     }
-    Q_ASSERT(s_engineMutex != NULL);
-    Q_ASSERT(s_engine != NULL);
+
+    // Replay the properties set through another engine
+    if (prog->m_propertiesRevision != m_propertiesRevision)
+    {
+        foreach (RGBScriptProperty cap, m_properties)
+        {
+            if (m_propertyValues.contains(cap.m_name) == false)
+                continue;
+
+            QScriptValue writeMethod = prog->m_script.property(cap.m_writeMethod);
+            if (writeMethod.isFunction())
+            {
+                QScriptValueList args;
+                args << m_propertyValues.value(cap.m_name);
+                writeMethod.call(QScriptValue(), args);
+            }
+        }
+        prog->m_propertiesRevision = m_propertiesRevision;
+    }
+
+    return prog;
 }
 
 /****************************************************************************
@@ -219,41 +349,46 @@ void RGBScript::initEngine()
 
 int RGBScript::rgbMapStepCount(const QSize& size)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
-    if (m_rgbMapStepCount.isValid() == false)
+    if (prog->m_rgbMapStepCount.isValid() == false)
         return -1;
 
     QScriptValueList args;
     args << size.width() << size.height();
-    QScriptValue value = m_rgbMapStepCount.call(QScriptValue(), args);
+    QScriptValue value = prog->m_rgbMapStepCount.call(QScriptValue(), args);
     int ret = value.isNumber() ? value.toInteger() : -1;
     return ret;
 }
 
 void RGBScript::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
-    if (m_rgbMap.isValid() == false)
+    if (prog->m_rgbMap.isValid() == false)
         return;
 
     QScriptValueList args;
     args << size.width() << size.height() << rgb << step;
-    QScriptValue yarray = m_rgbMap.call(QScriptValue(), args);
+    QScriptValue yarray = prog->m_rgbMap.call(QScriptValue(), args);
     if (yarray.isArray() == true)
     {
         int ylen = yarray.property("length").toInteger();
-        map.resize(ylen);
+        map.resize(size);
+        map.fill(0);
         for (int y = 0; y < ylen && y < size.height(); y++)
         {
             QScriptValue xarray = yarray.property(QString::number(y));
             int xlen = xarray.property("length").toInteger();
-            map[y].resize(xlen);
+            uint *line = map.scanLine(y);
             for (int x = 0; x < xlen && x < size.width(); x++)
             {
                 QScriptValue yx = xarray.property(QString::number(x));
-                map[y][x] = yx.toInteger();
+                line[x] = yx.toInteger();
             }
         }
     }
@@ -265,20 +400,12 @@ void RGBScript::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 
 QString RGBScript::name() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
-
-    QScriptValue name = m_script.property("name");
-    QString ret = name.isValid() ? name.toString() : QString();
-    return ret;
+    return m_name;
 }
 
 QString RGBScript::author() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
-
-    QScriptValue author = m_script.property("author");
-    QString ret = author.isValid() ? author.toString() : QString();
-    return ret;
+    return m_author;
 }
 
 int RGBScript::apiVersion() const
@@ -293,14 +420,12 @@ RGBAlgorithm::Type RGBScript::type() const
 
 int RGBScript::acceptColors() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    return m_acceptColors;
+}
 
-    QScriptValue accColors = m_script.property("acceptColors");
-    if (accColors.isValid())
-        return accColors.toInt32();
-    // if no property is provided, let's assume the script
-    // will accept both start and end colors
-    return 2;
+bool RGBScript::deterministic() const
+{
+    return m_deterministic;
 }
 
 bool RGBScript::loadXML(QXmlStreamReader &root)
@@ -339,12 +464,14 @@ QList<RGBScriptProperty> RGBScript::properties()
 
 QHash<QString, QString> RGBScript::propertiesAsStrings()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
     QHash<QString, QString> properties;
     foreach(RGBScriptProperty cap, m_properties)
     {
-        QScriptValue readMethod = m_script.property(cap.m_readMethod);
+        QScriptValue readMethod = prog->m_script.property(cap.m_readMethod);
         if (readMethod.isFunction())
         {
             QScriptValueList args;
@@ -358,13 +485,15 @@ QHash<QString, QString> RGBScript::propertiesAsStrings()
 
 bool RGBScript::setProperty(QString propertyName, QString value)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
         if (cap.m_name == propertyName)
         {
-            QScriptValue writeMethod = m_script.property(cap.m_writeMethod);
+            QScriptValue writeMethod = prog->m_script.property(cap.m_writeMethod);
             if (writeMethod.isFunction() == false)
             {
                 qWarning() << name() << "doesn't have a write function for" << propertyName;
@@ -373,6 +502,13 @@ bool RGBScript::setProperty(QString propertyName, QString value)
             QScriptValueList args;
             args << value;
             writeMethod.call(QScriptValue(), args);
+
+            // Remember the value, so that the programs
+            // of the other engines can catch up
+            QMutexLocker programsLocker(&m_programsMutex);
+            m_propertyValues[propertyName] = value;
+            m_propertiesRevision++;
+            prog->m_propertiesRevision = m_propertiesRevision;
             return true;
         }
     }
@@ -381,13 +517,15 @@ bool RGBScript::setProperty(QString propertyName, QString value)
 
 QString RGBScript::property(QString propertyName) const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
         if (cap.m_name == propertyName)
         {
-            QScriptValue readMethod = m_script.property(cap.m_readMethod);
+            QScriptValue readMethod = prog->m_script.property(cap.m_readMethod);
             if (readMethod.isFunction() == false)
             {
                 qWarning() << name() << "doesn't have a read function for" << propertyName;
@@ -404,11 +542,9 @@ QString RGBScript::property(QString propertyName) const
     return QString();
 }
 
-bool RGBScript::loadProperties()
+bool RGBScript::loadProperties(ScriptProgram *prog)
 {
-    QMutexLocker engineLocker(s_engineMutex);
-
-    QScriptValue svCaps = m_script.property("properties");
+    QScriptValue svCaps = prog->m_script.property("properties");
     if (svCaps.isArray() == false)
     {
         qWarning() << m_fileName << "properties is not an array!";
@@ -421,10 +557,16 @@ bool RGBScript::loadProperties()
         return false;
     }
 
-    m_properties.clear();
+    parseProperties(varCaps.toStringList());
 
-    QStringList slCaps = varCaps.toStringList();
-    foreach (QString cap, slCaps)
+    return true;
+}
+
+void RGBScript::parseProperties(const QStringList& definitions)
+{
+    QList<RGBScriptProperty> properties;
+
+    foreach (QString cap, definitions)
     {
         RGBScriptProperty newCap;
 
@@ -496,8 +638,10 @@ bool RGBScript::loadProperties()
 
         if (newCap.m_name.isEmpty() == false &&
             newCap.m_type != RGBScriptProperty::None)
-                m_properties.append(newCap);
+                properties.append(newCap);
     }
 
-    return true;
+    QMutexLocker programsLocker(&m_programsMutex);
+    m_properties = properties;
+    m_propertyDefinitions = definitions;
 }
@@ -21,11 +21,13 @@
 #define RGBSCRIPT_H
 
 #include <QScriptValue>
+#include <QVariantMap>
 #include <QMutex>
 #include "rgbalgorithm.h"
 #include "rgbscriptproperty.h"
 
 class QScriptEngine;
+class QThread;
 class QSize;
 class QDir;
 
@@ -57,8 +59,11 @@ public:
      * Load & Evaluation
      ************************************************************************/
 public:
-    /** Load script contents from $file located in $dir */
-    bool load(const QDir& dir, const QString& fileName);
+    /** Load script contents from $file located in $dir. When $metadata is
+     *  given, as previously returned by metadata(), the script is not
+     *  evaluated: each engine compiles it when it is first used */
+    bool load(const QDir& dir, const QString& fileName,
+              const QVariantMap& metadata = QVariantMap());
 
     /** Get the filename for this script */
     QString fileName() const;
@@ -66,19 +71,67 @@ public:
     /** Evaluate the script's contents and see if it checks out */
     bool evaluate();
 
+    /** Get the name, author, API version, colors and properties declared
+     *  by the script, as read by the last evaluation */
+    QVariantMap metadata() const;
+
 private:
-    static QScriptEngine *s_engine; //! The engine that runs all scripts
+    /** Take the values declared by the script from $metadata instead of
+     *  evaluating it, and outdate the programs of all the engines */
+    bool applyMetadata(const QVariantMap& metadata);
+
+    /** Copy the property values set on $s, to be replayed on this script */
+    void copyPropertyValues(const RGBScript& s);
+
+    /** A script engine, used only by the thread that created it */
+    struct ScriptEngine
+    {
+        ScriptEngine()
+            : m_engine(NULL)
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-    static QMutex* s_engineMutex;   //! Protection
+            , m_mutex(QMutex::Recursive)
+#endif
+        { }
+
+        QScriptEngine *m_engine;
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+        QMutex m_mutex;             //! Protection against engine destruction
 #else
-    static QRecursiveMutex* s_engineMutex;
+        QRecursiveMutex m_mutex;
 #endif
+    };
+
+    /** This script evaluated in one ScriptEngine */
+    struct ScriptProgram
+    {
+        bool m_valid;                   //! The script evaluated without errors
+        QScriptValue m_script;          //! The script itself
+        QScriptValue m_rgbMap;          //! rgbMap() function
+        QScriptValue m_rgbMapStepCount; //! rgbMapStepCount() function
+        int m_contentsRevision;         //! The contents revision evaluated
+        int m_propertiesRevision;       //! The properties revision applied
+    };
+
+    /** Get the engine of the calling thread, creating it when first needed */
+    static ScriptEngine *threadEngine();
+
+    /** Get this script program for $engine, which must be locked.
+     *  The program is (re)evaluated and the properties set so far are
+     *  replayed on it as needed */
+    ScriptProgram *program(ScriptEngine *engine) const;
+
+    /** Evaluate the script contents in $engine, filling $prog */
+    bool evaluateProgram(ScriptEngine *engine, ScriptProgram *prog) const;
+
+private:
+    static QHash<QThread *, ScriptEngine *> s_engines; //! One engine per thread
+    static QMutex s_enginesMutex;
     QString m_fileName;             //! The file name that contains this script
     QString m_contents;             //! The file's contents
+    int m_contentsRevision;         //! Incremented every time m_contents is evaluated
 
-private:
-    /** Init engine, engine mutex, and scripts map */
-    static void initEngine();
+    mutable QHash<ScriptEngine *, ScriptProgram *> m_programs; //! The programs by engine
+    mutable QMutex m_programsMutex; //! Protects programs, properties and revisions
 
     /************************************************************************
      * RGBAlgorithm API
@@ -105,6 +158,9 @@ public:
     /** @reimp */
     int acceptColors() const;
 
+    /** @reimp */
+    bool deterministic() const;
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
@@ -113,9 +169,10 @@ public:
 
 private:
     int m_apiVersion;               //! The API version that the script uses
-    QScriptValue m_script;          //! The script itself
-    QScriptValue m_rgbMap;          //! rgbMap() function
-    QScriptValue m_rgbMapStepCount; //! rgbMapStepCount() function
+    bool m_deterministic;           //! The script declares rgbMap() deterministic
+    QString m_name;                 //! The name declared by the script
+    QString m_author;               //! The author declared by the script
+    int m_acceptColors;             //! The number of colors accepted by the script
 
     /************************************************************************
      * Properties
@@ -134,11 +191,17 @@ public:
     QString property(QString propertyName) const;
 
 private:
-    /** Load the script properties if any is available */
-    bool loadProperties();
+    /** Load the script properties of $prog if any is available */
+    bool loadProperties(ScriptProgram *prog);
+
+    /** Parse the properties declared by the script as $definitions */
+    void parseProperties(const QStringList& definitions);
 
 private:
     QList<RGBScriptProperty> m_properties; //! the script properties list
+    QHash<QString, QString> m_propertyValues; //! the values set with setProperty()
+    int m_propertiesRevision;                 //! incremented on every setProperty()
+    QStringList m_propertyDefinitions;        //! the properties as declared by the script
 };
 
 /** @} */
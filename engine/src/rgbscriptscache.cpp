@@ -17,6 +17,9 @@
   limitations under the License.
 */
 
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QSettings>
 #include <QDebug>
 #include <QDir>
 
@@ -29,6 +32,10 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
+#define SETTINGS_RGBSCRIPTS_INDEX "rgbscripts/index/"
+#define KMetadataModified "modified"
+#define KMetadataSize "size"
+
 RGBScriptsCache::RGBScriptsCache(Doc* doc)
     : m_doc(doc)
 {
@@ -67,15 +74,35 @@ bool RGBScriptsCache::load(const QDir& dir)
     if (dir.exists() == false || dir.isReadable() == false)
         return false;
 
+    QSettings settings;
+
     foreach (QString file, dir.entryList())
     {
         if (!m_scriptsMap.contains(file))
         {
+            QFileInfo info(dir.absoluteFilePath(file));
+            QString key = indexKey(info);
+
+            // The metadata indexed for an unchanged file spares
+            // the evaluation of the script until it is used
+            QVariantMap metadata = settings.value(key).toMap();
+            if (metadata.value(KMetadataModified).toLongLong() != info.lastModified().toMSecsSinceEpoch() ||
+                metadata.value(KMetadataSize).toLongLong() != info.size())
+                metadata.clear();
+
             RGBScript* script = new RGBScript(m_doc);
-            if (script->load(dir, file))
+            if (script->load(dir, file, metadata))
             {
-                qDebug() << "    " << file << " loaded";
+                qDebug() << "    " << file << (metadata.isEmpty() ? " loaded" : " loaded from index");
                 m_scriptsMap.insert(file, script);
+
+                if (metadata.isEmpty())
+                {
+                    metadata = script->metadata();
+                    metadata[KMetadataModified] = info.lastModified().toMSecsSinceEpoch();
+                    metadata[KMetadataSize] = info.size();
+                    settings.setValue(key, metadata);
+                }
             }
             else
             {
@@ -91,6 +118,13 @@ bool RGBScriptsCache::load(const QDir& dir)
     return true;
 }
 
+QString RGBScriptsCache::indexKey(const QFileInfo& info)
+{
+    QByteArray path = info.absoluteFilePath().toUtf8();
+    return QString(SETTINGS_RGBSCRIPTS_INDEX) +
+           QString(QCryptographicHash::hash(path, QCryptographicHash::Md5).toHex());
+}
+
 QDir RGBScriptsCache::systemScriptsDirectory()
 {
     return QLCFile::systemDirectory(QString(RGBSCRIPTDIR), QString(".js"));
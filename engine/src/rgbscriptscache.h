@@ -23,6 +23,7 @@
 #include <QMap>
 
 class RGBScript;
+class QFileInfo;
 class QDir;
 class Doc;
 
@@ -50,6 +51,10 @@ public:
      * Returns true even if $dir doesn't contain any script,
      * if it is still accessible (and exists).
      *
+     * The metadata of each script is kept in an index in the settings,
+     * along with the modification time and size of its file. Unchanged
+     * scripts are not evaluated: they are compiled when first used.
+     *
      * @param dir The directory to load scripts from.
      * @return true, if the path could be accessed, otherwise false.
      */
@@ -73,6 +78,10 @@ public:
      */
     static QDir userScriptsDirectory();
 
+private:
+    /** Get the settings key of the indexed metadata of the script $info */
+    static QString indexKey(const QFileInfo& info);
+
 private:
     Doc* m_doc;
     QMap<QString, RGBScript*> m_scriptsMap; //! One instance of each script, filename-based map
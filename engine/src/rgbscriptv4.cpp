@@ -20,6 +20,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QJSEngine>
+#include <QThread>
 #include <QDebug>
 #include <QFile>
 
@@ -29,12 +30,8 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
-QJSEngine* RGBScript::s_engine = NULL;
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-  QMutex* RGBScript::s_engineMutex = NULL;
-#else
-  QRecursiveMutex* RGBScript::s_engineMutex = NULL;
-#endif
+QHash<QThread *, RGBScript::ScriptEngine *> RGBScript::s_engines;
+QMutex RGBScript::s_enginesMutex;
 
 /****************************************************************************
  * Initialization
@@ -42,7 +39,11 @@ QJSEngine* RGBScript::s_engine = NULL;
 
 RGBScript::RGBScript(Doc * doc)
     : RGBAlgorithm(doc)
+    , m_contentsRevision(0)
     , m_apiVersion(0)
+    , m_deterministic(false)
+    , m_acceptColors(2)
+    , m_propertiesRevision(0)
 {
 }
 
@@ -50,17 +51,26 @@ RGBScript::RGBScript(const RGBScript& s)
     : RGBAlgorithm(s.doc())
     , m_fileName(s.m_fileName)
     , m_contents(s.m_contents)
+    , m_contentsRevision(0)
     , m_apiVersion(0)
+    , m_deterministic(false)
+    , m_acceptColors(2)
+    , m_propertiesRevision(0)
 {
-    evaluate();
-    foreach(RGBScriptProperty cap, s.m_properties)
-    {
-        setProperty(cap.m_name, s.property(cap.m_name));
-    }
+    // The copy is compiled only when an engine first uses it
+    applyMetadata(s.metadata());
+    copyPropertyValues(s);
 }
 
 RGBScript::~RGBScript()
 {
+    QHashIterator<ScriptEngine *, ScriptProgram *> it(m_programs);
+    while (it.hasNext())
+    {
+        it.next();
+        QMutexLocker engineLocker(&it.key()->m_mutex);
+        delete it.value();
+    }
 }
 
 RGBScript &RGBScript::operator=(const RGBScript &s)
@@ -69,12 +79,8 @@ RGBScript &RGBScript::operator=(const RGBScript &s)
     {
         m_fileName = s.m_fileName;
         m_contents = s.m_contents;
-        m_apiVersion = s.m_apiVersion;
-        evaluate();
-        foreach(RGBScriptProperty cap, s.m_properties)
-        {
-            setProperty(cap.m_name, s.property(cap.m_name));
-        }
+        applyMetadata(s.metadata());
+        copyPropertyValues(s);
     }
 
     return *this;
@@ -98,17 +104,9 @@ RGBAlgorithm* RGBScript::clone() const
  * Load & Evaluation
  ****************************************************************************/
 
-bool RGBScript::load(const QDir& dir, const QString& fileName)
+bool RGBScript::load(const QDir& dir, const QString& fileName, const QVariantMap& metadata)
 {
-    // Create the script engine when it's first needed
-    initEngine();
-
-    QMutexLocker engineLocker(s_engineMutex);
-
     m_contents.clear();
-    m_script = QJSValue();
-    m_rgbMap = QJSValue();
-    m_rgbMapStepCount = QJSValue();
     m_apiVersion = 0;
 
     m_fileName = fileName;
@@ -123,6 +121,9 @@ bool RGBScript::load(const QDir& dir, const QString& fileName)
     m_contents = stream.readAll();
     file.close();
 
+    if (metadata.isEmpty() == false)
+        return applyMetadata(metadata);
+
     return evaluate();
 }
 
@@ -133,11 +134,23 @@ QString RGBScript::fileName() const
 
 bool RGBScript::evaluate()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+
+    {
+        // Outdate the programs of all the engines and forget
+        // the properties set on the previous contents
+        QMutexLocker programsLocker(&m_programsMutex);
+        m_contentsRevision++;
+        m_propertyValues.clear();
+        m_propertiesRevision++;
+    }
 
-    m_rgbMap = QJSValue();
-    m_rgbMapStepCount = QJSValue();
     m_apiVersion = 0;
+    m_deterministic = false;
+    m_name.clear();
+    m_author.clear();
+    m_acceptColors = 2;
 
     if (m_fileName.isEmpty() || m_contents.isEmpty())
     {
@@ -145,58 +158,177 @@ bool RGBScript::evaluate()
         return false;
     }
 
-    m_script = s_engine->evaluate(m_contents, m_fileName);
-    if (m_script.isError())
+    ScriptProgram *prog = program(engine);
+    if (prog->m_valid == false)
+        return false;
+
+    QJSValue name = prog->m_script.property("name");
+    m_name = name.isUndefined() ? QString() : name.toString();
+    QJSValue author = prog->m_script.property("author");
+    m_author = author.isUndefined() ? QString() : author.toString();
+    // if no property is provided, let's assume the script
+    // will accept both start and end colors
+    QJSValue accColors = prog->m_script.property("acceptColors");
+    m_acceptColors = accColors.isUndefined() ? 2 : accColors.toInt();
+
+    m_apiVersion = prog->m_script.property("apiVersion").toInt();
+    if (m_apiVersion > 0)
+    {
+        m_deterministic = prog->m_script.property("deterministic").toBool();
+        if (m_apiVersion == 2)
+            return loadProperties(prog);
+        return true;
+    }
+    else
+    {
+        qWarning() << m_fileName << "has an invalid apiVersion:" << m_apiVersion;
+        return false;
+    }
+}
+
+QVariantMap RGBScript::metadata() const
+{
+    QVariantMap metadata;
+    metadata["name"] = m_name;
+    metadata["author"] = m_author;
+    metadata["apiVersion"] = m_apiVersion;
+    metadata["acceptColors"] = m_acceptColors;
+    metadata["deterministic"] = m_deterministic;
+
+    QMutexLocker programsLocker(&m_programsMutex);
+    metadata["properties"] = m_propertyDefinitions;
+
+    return metadata;
+}
+
+bool RGBScript::applyMetadata(const QVariantMap& metadata)
+{
+    {
+        // Outdate the programs of all the engines, like evaluate() does
+        QMutexLocker programsLocker(&m_programsMutex);
+        m_contentsRevision++;
+        m_propertyValues.clear();
+        m_propertiesRevision++;
+    }
+
+    m_name = metadata.value("name").toString();
+    m_author = metadata.value("author").toString();
+    m_apiVersion = metadata.value("apiVersion", 0).toInt();
+    m_acceptColors = metadata.value("acceptColors", 2).toInt();
+    m_deterministic = metadata.value("deterministic", false).toBool();
+    parseProperties(metadata.value("properties").toStringList());
+
+    return m_apiVersion > 0;
+}
+
+void RGBScript::copyPropertyValues(const RGBScript& s)
+{
+    QHash<QString, QString> values;
+    {
+        QMutexLocker locker(&s.m_programsMutex);
+        values = s.m_propertyValues;
+    }
+
+    QMutexLocker programsLocker(&m_programsMutex);
+    m_propertyValues = values;
+    m_propertiesRevision++;
+}
+
+bool RGBScript::evaluateProgram(ScriptEngine *engine, ScriptProgram *prog) const
+{
+    prog->m_script = QJSValue();
+    prog->m_rgbMap = QJSValue();
+    prog->m_rgbMapStepCount = QJSValue();
+
+    if (m_fileName.isEmpty() || m_contents.isEmpty())
+        return false;
+
+    prog->m_script = engine->m_engine->evaluate(m_contents, m_fileName);
+    if (prog->m_script.isError())
     {
         QString msg("%1: Uncaught exception at line %2. Error: %3");
         qWarning() << msg.arg(m_fileName)
-                         .arg(m_script.property("lineNumber").toInt())
-                         .arg(m_script.toString());
-        qDebug() << "Stack: " << m_script.property("stack").toString();
+                         .arg(prog->m_script.property("lineNumber").toInt())
+                         .arg(prog->m_script.toString());
+        qDebug() << "Stack: " << prog->m_script.property("stack").toString();
         return false;
     }
 
-    m_rgbMap = m_script.property("rgbMap");
-    if (m_rgbMap.isCallable() == false)
+    prog->m_rgbMap = prog->m_script.property("rgbMap");
+    if (prog->m_rgbMap.isCallable() == false)
     {
         qWarning() << m_fileName << "is missing the rgbMap() function!";
         return false;
     }
 
-    m_rgbMapStepCount = m_script.property("rgbMapStepCount");
-    if (m_rgbMapStepCount.isCallable() == false)
+    prog->m_rgbMapStepCount = prog->m_script.property("rgbMapStepCount");
+    if (prog->m_rgbMapStepCount.isCallable() == false)
     {
         qWarning() << m_fileName << "is missing the rgbMapStepCount() function!";
         return false;
     }
 
-    m_apiVersion = m_script.property("apiVersion").toInt();
-    if (m_apiVersion > 0)
-    {
-        if (m_apiVersion == 2)
-            return loadProperties();
-        return true;
-    }
-    else
+    return true;
+}
+
+RGBScript::ScriptEngine *RGBScript::threadEngine()
+{
+    QMutexLocker locker(&s_enginesMutex);
+
+    // Engines are created when first needed by a thread and, like
+    // the scripts evaluated in them, live until the application quits
+    ScriptEngine *engine = s_engines.value(QThread::currentThread(), NULL);
+    if (engine == NULL)
     {
-        qWarning() << m_fileName << "has an invalid apiVersion:" << m_apiVersion;
-        return false;
+        engine = new ScriptEngine();
+        engine->m_engine = new QJSEngine();
+        s_engines[QThread::currentThread()] = engine;
     }
+
+    return engine;
 }
 
-void RGBScript::initEngine()
+RGBScript::ScriptProgram *RGBScript::program(ScriptEngine *engine) const
 {
-    if (s_engineMutex == NULL)
+    QMutexLocker programsLocker(&m_programsMutex);
+
+    ScriptProgram *prog = m_programs.value(engine, NULL);
+    if (prog == NULL)
+    {
+        prog = new ScriptProgram();
+        prog->m_valid = false;
+        prog->m_contentsRevision = -1;
+        prog->m_propertiesRevision = -1;
+        m_programs[engine] = prog;
+    }
+
+    if (prog->m_contentsRevision != m_contentsRevision)
+    {
+        prog->m_valid = evaluateProgram(engine, prog);
+        prog->m_contentsRevision = m_contentsRevision;
+        prog->m_propertiesRevision = -1;
+    }
+
+    // Replay the properties set through another engine
+    if (prog->m_propertiesRevision != m_propertiesRevision)
     {
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-        s_engineMutex = new QMutex(QMutex::Recursive);
-#else
-        s_engineMutex = new QRecursiveMutex();
-#endif
-        s_engine = new QJSEngine();
+        foreach (RGBScriptProperty cap, m_properties)
+        {
+            if (m_propertyValues.contains(cap.m_name) == false)
+                continue;
+
+            QJSValue writeMethod = prog->m_script.property(cap.m_writeMethod);
+            if (writeMethod.isCallable())
+            {
+                QJSValueList args;
+                args << m_propertyValues.value(cap.m_name);
+                writeMethod.call(args);
+            }
+        }
+        prog->m_propertiesRevision = m_propertiesRevision;
     }
-    Q_ASSERT(s_engineMutex != NULL);
-    Q_ASSERT(s_engine != NULL);
+
+    return prog;
 }
 
 /****************************************************************************
@@ -205,43 +337,48 @@ void RGBScript::initEngine()
 
 int RGBScript::rgbMapStepCount(const QSize& size)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
-    if (m_rgbMapStepCount.isCallable() == false)
+    if (prog->m_rgbMapStepCount.isCallable() == false)
         return -1;
 
     QJSValueList args;
     args << size.width() << size.height();
-    QJSValue value = m_rgbMapStepCount.call(args);
+    QJSValue value = prog->m_rgbMapStepCount.call(args);
     int ret = value.isNumber() ? value.toInt() : -1;
     return ret;
 }
 
 void RGBScript::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
-    if (m_rgbMap.isUndefined() == true)
+    if (prog->m_rgbMap.isUndefined() == true)
         return;
 
     QJSValueList args;
     args << size.width() << size.height() << rgb << step;
-    QJSValue yarray(m_rgbMap.call(args));
+    QJSValue yarray(prog->m_rgbMap.call(args));
 
     if (yarray.isArray() == true)
     {
         QVariantList yvArray = yarray.toVariant().toList();
         int ylen = yvArray.length();
-        map.resize(ylen);
+        map.resize(size);
+        map.fill(0);
 
         for (int y = 0; y < ylen && y < size.height(); y++)
         {
             QVariantList xvArray = yvArray.at(y).toList();
             int xlen = xvArray.length();
-            map[y].resize(xlen);
+            uint *line = map.scanLine(y);
 
             for (int x = 0; x < xlen && x < size.width(); x++)
-                map[y][x] = xvArray.at(x).toUInt();
+                line[x] = xvArray.at(x).toUInt();
         }
     }
     else
@@ -252,20 +389,12 @@ void RGBScript::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 
 QString RGBScript::name() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
-
-    QJSValue name = m_script.property("name");
-    QString ret = name.isUndefined() ? QString() : name.toString();
-    return ret;
+    return m_name;
 }
 
 QString RGBScript::author() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
-
-    QJSValue author = m_script.property("author");
-    QString ret = author.isUndefined() ? QString() : author.toString();
-    return ret;
+    return m_author;
 }
 
 int RGBScript::apiVersion() const
@@ -280,14 +409,12 @@ RGBAlgorithm::Type RGBScript::type() const
 
 int RGBScript::acceptColors() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    return m_acceptColors;
+}
 
-    QJSValue accColors = m_script.property("acceptColors");
-    if (!accColors.isUndefined())
-        return accColors.toInt();
-    // if no property is provided, let's assume the script
-    // will accept both start and end colors
-    return 2;
+bool RGBScript::deterministic() const
+{
+    return m_deterministic;
 }
 
 bool RGBScript::loadXML(QXmlStreamReader &root)
@@ -326,12 +453,14 @@ QList<RGBScriptProperty> RGBScript::properties()
 
 QHash<QString, QString> RGBScript::propertiesAsStrings()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
     QHash<QString, QString> properties;
     foreach(RGBScriptProperty cap, m_properties)
     {
-        QJSValue readMethod = m_script.property(cap.m_readMethod);
+        QJSValue readMethod = prog->m_script.property(cap.m_readMethod);
         if (readMethod.isCallable())
         {
             QJSValueList args;
@@ -345,13 +474,15 @@ QHash<QString, QString> RGBScript::propertiesAsStrings()
 
 bool RGBScript::setProperty(QString propertyName, QString value)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
         if (cap.m_name == propertyName)
         {
-            QJSValue writeMethod = m_script.property(cap.m_writeMethod);
+            QJSValue writeMethod = prog->m_script.property(cap.m_writeMethod);
             if (writeMethod.isCallable() == false)
             {
                 qWarning() << name() << "doesn't have a write function for" << propertyName;
@@ -360,6 +491,13 @@ bool RGBScript::setProperty(QString propertyName, QString value)
             QJSValueList args;
             args << value;
             writeMethod.call(args);
+
+            // Remember the value, so that the programs
+            // of the other engines can catch up
+            QMutexLocker programsLocker(&m_programsMutex);
+            m_propertyValues[propertyName] = value;
+            m_propertiesRevision++;
+            prog->m_propertiesRevision = m_propertiesRevision;
             return true;
         }
     }
@@ -368,13 +506,15 @@ bool RGBScript::setProperty(QString propertyName, QString value)
 
 QString RGBScript::property(QString propertyName) const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    ScriptEngine *engine = threadEngine();
+    QMutexLocker engineLocker(&engine->m_mutex);
+    ScriptProgram *prog = program(engine);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
         if (cap.m_name == propertyName)
         {
-            QJSValue readMethod = m_script.property(cap.m_readMethod);
+            QJSValue readMethod = prog->m_script.property(cap.m_readMethod);
             if (readMethod.isCallable() == false)
             {
                 qWarning() << name() << "doesn't have a read function for" << propertyName;
@@ -391,11 +531,9 @@ QString RGBScript::property(QString propertyName) const
     return QString();
 }
 
-bool RGBScript::loadProperties()
+bool RGBScript::loadProperties(ScriptProgram *prog)
 {
-    QMutexLocker engineLocker(s_engineMutex);
-
-    QJSValue svCaps = m_script.property("properties");
+    QJSValue svCaps = prog->m_script.property("properties");
     if (svCaps.isArray() == false)
     {
         qWarning() << m_fileName << "properties is not an array!";
@@ -408,10 +546,16 @@ bool RGBScript::loadProperties()
         return false;
     }
 
-    m_properties.clear();
+    parseProperties(varCaps.toStringList());
 
-    QStringList slCaps = varCaps.toStringList();
-    foreach (QString cap, slCaps)
+    return true;
+}
+
+void RGBScript::parseProperties(const QStringList& definitions)
+{
+    QList<RGBScriptProperty> properties;
+
+    foreach (QString cap, definitions)
     {
         RGBScriptProperty newCap;
 
@@ -483,8 +627,10 @@ bool RGBScript::loadProperties()
 
         if (newCap.m_name.isEmpty() == false &&
             newCap.m_type != RGBScriptProperty::None)
-                m_properties.append(newCap);
+                properties.append(newCap);
     }
 
-    return true;
+    QMutexLocker programsLocker(&m_programsMutex);
+    m_properties = properties;
+    m_propertyDefinitions = definitions;
 }
@@ -20,6 +20,7 @@
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QImage>
 #include <QDebug>
@@ -39,6 +40,9 @@ RGBText::RGBText(Doc * doc)
     , m_animationStyle(Horizontal)
     , m_xOffset(0)
     , m_yOffset(0)
+    , m_stripWidth(0)
+    , m_stripHeight(0)
+    , m_stripStride(0)
 {
 }
 
@@ -49,6 +53,9 @@ RGBText::RGBText(const RGBText& t)
     , m_animationStyle(t.animationStyle())
     , m_xOffset(t.xOffset())
     , m_yOffset(t.yOffset())
+    , m_stripWidth(0)
+    , m_stripHeight(0)
+    , m_stripStride(0)
 {
 }
 
@@ -69,6 +76,7 @@ RGBAlgorithm* RGBText::clone() const
 void RGBText::setText(const QString& str)
 {
     m_text = str;
+    invalidateStrip();
 }
 
 QString RGBText::text() const
@@ -79,6 +87,7 @@ QString RGBText::text() const
 void RGBText::setFont(const QFont& font)
 {
     m_font = font;
+    invalidateStrip();
 }
 
 QFont RGBText::font() const
@@ -96,6 +105,7 @@ void RGBText::setAnimationStyle(RGBText::AnimationStyle ani)
         m_animationStyle = ani;
     else
         m_animationStyle = StaticLetters;
+    invalidateStrip();
 }
 
 RGBText::AnimationStyle RGBText::animationStyle() const
@@ -139,6 +149,7 @@ QStringList RGBText::animationStyles()
 void RGBText::setXOffset(int offset)
 {
     m_xOffset = offset;
+    invalidateStrip();
 }
 
 int RGBText::xOffset() const
@@ -149,6 +160,7 @@ int RGBText::xOffset() const
 void RGBText::setYOffset(int offset)
 {
     m_yOffset = offset;
+    invalidateStrip();
 }
 
 int RGBText::yOffset() const
@@ -170,22 +182,106 @@ int RGBText::scrollingTextStepCount() const
     }
 }
 
-void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map) const
+void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map)
 {
+    uint lit = QColor(rgb).rgb();
+    uint black = QColor(Qt::black).rgb();
+
+    QMutexLocker locker(&m_stripMutex);
+    updateStrip(size);
+
+    // Treat the RGBMap as a "window" on top of the fully-drawn text and pick the
+    // correct pixels according to $step.
+    map.resize(size);
+    for (int y = 0; y < size.height(); y++)
+    {
+        uint *line = map.scanLine(y);
+        for (int x = 0; x < size.width(); x++)
+        {
+            if (animationStyle() == Horizontal)
+            {
+                if (step + x >= 0 && step + x < m_stripWidth)
+                    line[x] = stripPixel(step + x, y) ? lit : black;
+            }
+            else
+            {
+                if (step + y >= 0 && step + y < m_stripHeight)
+                    line[x] = stripPixel(x, step + y) ? lit : black;
+            }
+        }
+    }
+}
+
+void RGBText::renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    uint lit = QColor(rgb).rgb();
+    uint black = QColor(Qt::black).rgb();
+
+    map.resize(size);
+    if (step < 0 || step >= m_text.length())
+    {
+        map.fill(black);
+        return;
+    }
+
+    QMutexLocker locker(&m_stripMutex);
+    updateStrip(size);
+
+    // each letter takes the width of the map in the strip
+    int offset = step * size.width();
+    for (int y = 0; y < size.height(); y++)
+    {
+        uint *line = map.scanLine(y);
+        for (int x = 0; x < size.width(); x++)
+            line[x] = stripPixel(offset + x, y) ? lit : black;
+    }
+}
+
+/****************************************************************************
+ * Text strip
+ ****************************************************************************/
+
+void RGBText::updateStrip(const QSize& size)
+{
+    if (m_stripSize.isValid() && m_stripSize == size)
+        return;
+
     QImage image;
-    if (animationStyle() == Horizontal)
+    if (animationStyle() == StaticLetters)
+        image = QImage(size.width() * m_text.length(), size.height(), QImage::Format_RGB32);
+    else if (animationStyle() == Horizontal)
         image = QImage(scrollingTextStepCount(), size.height(), QImage::Format_RGB32);
     else
         image = QImage(size.width(), scrollingTextStepCount(), QImage::Format_RGB32);
+
+    m_stripSize = size;
+    m_stripWidth = image.width();
+    m_stripHeight = image.height();
+    m_stripStride = (m_stripWidth + 31) / 32;
+    m_strip.fill(0, m_stripStride * m_stripHeight);
+
+    if (image.isNull())
+        return;
+
     image.fill(QRgb(0));
 
     QPainter p(&image);
     p.setRenderHint(QPainter::TextAntialiasing, false);
     p.setRenderHint(QPainter::Antialiasing, false);
     p.setFont(m_font);
-    p.setPen(QColor(rgb));
+    p.setPen(QColor(Qt::white));
 
-    if (animationStyle() == Vertical)
+    if (animationStyle() == StaticLetters)
+    {
+        // Draw one letter per map, clipped as if drawn on the map alone
+        for (int i = 0; i < m_text.length(); i++)
+        {
+            QRect cell(i * size.width(), 0, size.width(), size.height());
+            p.setClipRect(cell);
+            p.drawText(cell.translated(xOffset(), yOffset()), Qt::AlignCenter, m_text.mid(i, 1));
+        }
+    }
+    else if (animationStyle() == Vertical)
     {
         QFontMetrics fm(m_font);
         QRect rect(0, 0, image.width(), image.height());
@@ -200,57 +296,37 @@ void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap
     }
     else
     {
-        // Draw the whole text each time
+        // Draw the whole text once
         QRect rect(xOffset(), yOffset(), image.width(), image.height());
         p.drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, m_text);
     }
     p.end();
 
-    // Treat the RGBMap as a "window" on top of the fully-drawn text and pick the
-    // correct pixels according to $step.
-    map.resize(size.height());
-    for (int y = 0; y < size.height(); y++)
+    // the text is drawn without antialiasing, so any lit pixel is a dot
+    for (int y = 0; y < m_stripHeight; y++)
     {
-        map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        quint32 *bits = m_strip.data() + y * m_stripStride;
+        for (int x = 0; x < m_stripWidth; x++)
         {
-            if (animationStyle() == Horizontal)
-            {
-                if (step + x < image.width())
-                    map[y][x] = image.pixel(step + x, y);
-            }
-            else
-            {
-                if (step + y < image.height())
-                    map[y][x] = image.pixel(x, step + y);
-            }
+            if (line[x] & 0x00FFFFFF)
+                bits[x / 32] |= (1U << (x % 32));
         }
     }
 }
 
-void RGBText::renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map) const
+void RGBText::invalidateStrip()
 {
-    QImage image(size, QImage::Format_RGB32);
-    image.fill(QRgb(0));
-
-    QPainter p(&image);
-    p.setRenderHint(QPainter::TextAntialiasing, false);
-    p.setRenderHint(QPainter::Antialiasing, false);
-    p.setFont(m_font);
-    p.setPen(QColor(rgb));
+    QMutexLocker locker(&m_stripMutex);
+    m_stripSize = QSize();
+}
 
-    // Draw one letter at a time
-    QRect rect(xOffset(), yOffset(), size.width(), size.height());
-    p.drawText(rect, Qt::AlignCenter, m_text.mid(step, 1));
-    p.end();
+bool RGBText::stripPixel(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= m_stripWidth || y >= m_stripHeight)
+        return false;
 
-    map.resize(size.height());
-    for (int y = 0; y < size.height(); y++)
-    {
-        map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
-            map[y][x] = image.pixel(x, y);
-    }
+    return (m_strip.at(y * m_stripStride + x / 32) >> (x % 32)) & 1;
 }
 
 /****************************************************************************
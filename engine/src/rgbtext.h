@@ -21,7 +21,9 @@
 #ifndef RGBTEXT_H
 #define RGBTEXT_H
 
+#include <QVector>
 #include <QString>
+#include <QMutex>
 #include <QFont>
 
 #include "rgbalgorithm.h"
@@ -83,14 +85,44 @@ public:
 
 private:
     int scrollingTextStepCount() const;
-    void renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map) const;
-    void renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map) const;
+    void renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map);
+    void renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map);
 
 private:
     AnimationStyle m_animationStyle;
     int m_xOffset;
     int m_yOffset;
 
+    /************************************************************************
+     * Text strip
+     ************************************************************************/
+private:
+    /** Render the text into the strip for a map of $size, unless it is
+     *  there already. Must be called with m_stripMutex locked */
+    void updateStrip(const QSize& size);
+
+    /** Forget the rendered strip, when a setting has changed */
+    void invalidateStrip();
+
+    /** Return true if the pixel at $x, $y of the strip is lit */
+    bool stripPixel(int x, int y) const;
+
+private:
+    /**
+     * The text rendered once with the current settings, one bit per pixel,
+     * so that the font is not rasterized again on every step. Scrolling
+     * steps are windows on the strip, and static letters are laid side by
+     * side, one map width each. The color is applied when sampling.
+     */
+    QVector<quint32> m_strip;
+    int m_stripWidth;
+    int m_stripHeight;
+    /** The number of words of each strip row */
+    int m_stripStride;
+    /** The map size the strip has been rendered for, invalid if none */
+    QSize m_stripSize;
+    QMutex m_stripMutex;
+
     /************************************************************************
      * RGBAlgorithm
      ************************************************************************/
@@ -0,0 +1,416 @@
+/*
+  Q Light Controller Plus
+  rgbvideo.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QAbstractVideoSurface>
+#include <QCoreApplication>
+#include <QVideoSurfaceFormat>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QMediaPlayer>
+#include <QVideoFrame>
+#include <QDebug>
+#include <QUrl>
+#include <cstring>
+
+#include "rgbvideo.h"
+#include "doc.h"
+
+/**
+ * The surface the media player renders into. It only asks for RGB
+ * formats, so that the backend converts the frames before presenting them.
+ */
+class RGBVideoSurface : public QAbstractVideoSurface
+{
+public:
+    RGBVideoSurface(RGBVideo *video)
+        : QAbstractVideoSurface(video)
+        , m_video(video)
+    {
+    }
+
+    QList<QVideoFrame::PixelFormat> supportedPixelFormats(
+            QAbstractVideoBuffer::HandleType handleType = QAbstractVideoBuffer::NoHandle) const
+    {
+        QList<QVideoFrame::PixelFormat> formats;
+        if (handleType == QAbstractVideoBuffer::NoHandle)
+            formats << QVideoFrame::Format_RGB32
+                    << QVideoFrame::Format_ARGB32
+                    << QVideoFrame::Format_ARGB32_Premultiplied
+                    << QVideoFrame::Format_BGR32;
+        return formats;
+    }
+
+    bool present(const QVideoFrame& frame)
+    {
+        QVideoFrame mapped(frame);
+        if (mapped.map(QAbstractVideoBuffer::ReadOnly) == false)
+            return false;
+
+        m_video->presentFrame(mapped,
+                              surfaceFormat().scanLineDirection() == QVideoSurfaceFormat::BottomToTop);
+        mapped.unmap();
+
+        return true;
+    }
+
+private:
+    RGBVideo *m_video;
+};
+
+RGBVideo::RGBVideo(Doc * doc)
+    : RGBAlgorithm(doc)
+    , m_player(NULL)
+    , m_surface(NULL)
+    , m_playing(0)
+    , m_gridSize(0)
+    , m_latestFrame(NULL)
+    , m_freeFrame(NULL)
+    , m_currentFrame(NULL)
+{
+    /* The media player needs an event loop, and rgbMap() runs in the
+       MasterTimer thread, so playback is always driven from the main thread */
+    if (QCoreApplication::instance() != NULL)
+        moveToThread(QCoreApplication::instance()->thread());
+}
+
+RGBVideo::RGBVideo(const RGBVideo& v, QObject *parent)
+    : QObject(parent)
+    , RGBAlgorithm(v.doc())
+    , m_filename(v.m_filename)
+    , m_player(NULL)
+    , m_surface(NULL)
+    , m_playing(0)
+    , m_gridSize(0)
+    , m_latestFrame(NULL)
+    , m_freeFrame(NULL)
+    , m_currentFrame(NULL)
+{
+    if (QCoreApplication::instance() != NULL)
+        moveToThread(QCoreApplication::instance()->thread());
+}
+
+RGBVideo::~RGBVideo()
+{
+    if (m_player != NULL)
+    {
+        m_player->stop();
+        delete m_player;
+    }
+    delete m_surface;
+
+    delete m_latestFrame.fetchAndStoreOrdered(NULL);
+    delete m_freeFrame.fetchAndStoreOrdered(NULL);
+    delete m_currentFrame;
+}
+
+RGBAlgorithm* RGBVideo::clone() const
+{
+    RGBVideo* video = new RGBVideo(*this);
+    return static_cast<RGBAlgorithm*> (video);
+}
+
+/****************************************************************************
+ * Video file
+ ****************************************************************************/
+
+void RGBVideo::setFilename(const QString& fileName)
+{
+    m_filename = fileName;
+
+    /* Let the next rgbMap() restart the playback with the new file */
+    if (m_playing.testAndSetOrdered(1, 0))
+        QMetaObject::invokeMethod(this, "slotStop", Qt::QueuedConnection);
+}
+
+QString RGBVideo::filename() const
+{
+    return m_filename;
+}
+
+/****************************************************************************
+ * Playback
+ ****************************************************************************/
+
+void RGBVideo::presentFrame(const QVideoFrame& frame, bool bottomToTop)
+{
+    int packed = m_gridSize.loadAcquire();
+    QSize gridSize(packed >> 16, packed & 0xFFFF);
+    if (gridSize.isEmpty())
+        return;
+
+    RGBVideoFrame *sampled = m_freeFrame.fetchAndStoreAcquire(NULL);
+    if (sampled == NULL)
+        sampled = new RGBVideoFrame;
+
+    sampleFrame(frame, gridSize, bottomToTop, sampled);
+
+    /* A frame that rgbMap() didn't take in time is simply replaced */
+    RGBVideoFrame *old = m_latestFrame.fetchAndStoreOrdered(sampled);
+    if (old != NULL)
+        recycleFrame(old);
+}
+
+void RGBVideo::sampleFrame(const QVideoFrame& frame, const QSize& gridSize,
+                           bool bottomToTop, RGBVideoFrame *target)
+{
+    int gridWidth = gridSize.width();
+    int gridHeight = gridSize.height();
+
+    target->size = gridSize;
+    target->pixels.resize(gridWidth * gridHeight);
+
+    int width = frame.width();
+    int height = frame.height();
+    int bytesPerLine = frame.bytesPerLine();
+    const uchar *bits = frame.bits();
+    bool bgr = frame.pixelFormat() == QVideoFrame::Format_BGR32;
+
+    uint *out = target->pixels.data();
+
+    if (bits == NULL || width <= 0 || height <= 0)
+    {
+        target->pixels.fill(0);
+        return;
+    }
+
+    /* Each cell is averaged over a fixed grid of points, so the cost per
+       frame depends on the matrix size only, not on the video resolution */
+    int xSamples = qBound(1, width / gridWidth, RGBVIDEO_SAMPLES_PER_CELL);
+    int ySamples = qBound(1, height / gridHeight, RGBVIDEO_SAMPLES_PER_CELL);
+    int samples = xSamples * ySamples;
+
+    QVector<int> columns(gridWidth * xSamples);
+    for (int x = 0; x < gridWidth; x++)
+        for (int s = 0; s < xSamples; s++)
+            columns[x * xSamples + s] = ((x * xSamples + s) * 2 + 1) * width / (gridWidth * xSamples * 2);
+
+    for (int y = 0; y < gridHeight; y++)
+    {
+        const uint *lines[RGBVIDEO_SAMPLES_PER_CELL] = { };
+        for (int s = 0; s < ySamples; s++)
+        {
+            int line = ((y * ySamples + s) * 2 + 1) * height / (gridHeight * ySamples * 2);
+            if (bottomToTop)
+                line = height - 1 - line;
+            lines[s] = reinterpret_cast<const uint *>(bits + line * bytesPerLine);
+        }
+
+        for (int x = 0; x < gridWidth; x++)
+        {
+            uint r = 0, g = 0, b = 0;
+            const int *col = columns.constData() + x * xSamples;
+
+            for (int sy = 0; sy < ySamples; sy++)
+            {
+                for (int sx = 0; sx < xSamples; sx++)
+                {
+                    uint pixel = lines[sy][col[sx]];
+                    r += (pixel >> 16) & 0xFF;
+                    g += (pixel >> 8) & 0xFF;
+                    b += pixel & 0xFF;
+                }
+            }
+
+            r /= samples;
+            g /= samples;
+            b /= samples;
+            if (bgr)
+                qSwap(r, b);
+
+            out[y * gridWidth + x] = (r << 16) | (g << 8) | b;
+        }
+    }
+}
+
+void RGBVideo::recycleFrame(RGBVideoFrame *frame)
+{
+    if (m_freeFrame.testAndSetOrdered(NULL, frame) == false)
+        delete frame;
+}
+
+void RGBVideo::slotPlay()
+{
+    if (m_playing.loadAcquire() == 0)
+        return;
+
+    if (m_player == NULL)
+    {
+        m_surface = new RGBVideoSurface(this);
+        m_player = new QMediaPlayer(this, QMediaPlayer::VideoSurface);
+        m_player->setMuted(true);
+        m_player->setVideoOutput(m_surface);
+        connect(m_player, SIGNAL(mediaStatusChanged(QMediaPlayer::MediaStatus)),
+                this, SLOT(slotMediaStatusChanged()));
+    }
+
+    QUrl url = QUrl::fromLocalFile(m_filename);
+    if (m_player->media().canonicalUrl() != url)
+        m_player->setMedia(url);
+
+    qDebug() << "[RGBVideo] playing" << m_filename;
+    m_player->play();
+}
+
+void RGBVideo::slotStop()
+{
+    if (m_player != NULL && m_playing.loadAcquire() == 0)
+        m_player->stop();
+}
+
+void RGBVideo::slotMediaStatusChanged()
+{
+    /* Loop the video for as long as the matrix is running */
+    if (m_player->mediaStatus() == QMediaPlayer::EndOfMedia &&
+        m_playing.loadAcquire() == 1)
+    {
+        m_player->setPosition(0);
+        m_player->play();
+    }
+}
+
+/****************************************************************************
+ * RGBAlgorithm
+ ****************************************************************************/
+
+int RGBVideo::rgbMapStepCount(const QSize& size)
+{
+    Q_UNUSED(size);
+    return 1;
+}
+
+void RGBVideo::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    Q_UNUSED(rgb);
+    Q_UNUSED(step);
+
+    map.resize(size);
+
+    if (size.width() <= 0 || size.height() <= 0 ||
+        size.width() > 0xFFFF || size.height() > 0xFFFF)
+        return;
+
+    m_gridSize.storeRelease((size.width() << 16) | size.height());
+
+    if (m_filename.isEmpty() == false && m_playing.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "slotPlay", Qt::QueuedConnection);
+
+    RGBVideoFrame *frame = m_latestFrame.fetchAndStoreAcquire(NULL);
+    if (frame != NULL)
+    {
+        if (m_currentFrame != NULL)
+            recycleFrame(m_currentFrame);
+        m_currentFrame = frame;
+    }
+
+    /* Keep showing the last frame until a new one arrives */
+    if (m_currentFrame == NULL || m_currentFrame->size != size)
+    {
+        map.fill(0);
+        return;
+    }
+
+    memcpy(map.data(), m_currentFrame->pixels.constData(),
+           m_currentFrame->pixels.size() * sizeof(uint));
+}
+
+void RGBVideo::postRun()
+{
+    if (m_playing.testAndSetOrdered(1, 0))
+        QMetaObject::invokeMethod(this, "slotStop", Qt::QueuedConnection);
+
+    if (m_currentFrame != NULL)
+    {
+        recycleFrame(m_currentFrame);
+        m_currentFrame = NULL;
+    }
+}
+
+QString RGBVideo::name() const
+{
+    return QString("Video");
+}
+
+QString RGBVideo::author() const
+{
+    return QString("Massimo Callegari");
+}
+
+int RGBVideo::apiVersion() const
+{
+    return 1;
+}
+
+RGBAlgorithm::Type RGBVideo::type() const
+{
+    return RGBAlgorithm::Video;
+}
+
+int RGBVideo::acceptColors() const
+{
+    return 0;
+}
+
+/****************************************************************************
+ * Load & Save
+ ****************************************************************************/
+
+bool RGBVideo::loadXML(QXmlStreamReader &root)
+{
+    if (root.name() != KXMLQLCRGBAlgorithm)
+    {
+        qWarning() << Q_FUNC_INFO << "RGB Algorithm node not found";
+        return false;
+    }
+
+    if (root.attributes().value(KXMLQLCRGBAlgorithmType).toString() != KXMLQLCRGBVideo)
+    {
+        qWarning() << Q_FUNC_INFO << "RGB Algorithm is not Video";
+        return false;
+    }
+
+    while (root.readNextStartElement())
+    {
+        if (root.name() == KXMLQLCRGBVideoFilename)
+        {
+            setFilename(doc()->denormalizeComponentPath(root.readElementText()));
+        }
+        else
+        {
+            qWarning() << Q_FUNC_INFO << "Unknown RGBVideo tag:" << root.name();
+            root.skipCurrentElement();
+        }
+    }
+
+    return true;
+}
+
+bool RGBVideo::saveXML(QXmlStreamWriter *doc) const
+{
+    Q_ASSERT(doc != NULL);
+
+    doc->writeStartElement(KXMLQLCRGBAlgorithm);
+    doc->writeAttribute(KXMLQLCRGBAlgorithmType, KXMLQLCRGBVideo);
+
+    doc->writeTextElement(KXMLQLCRGBVideoFilename, this->doc()->normalizeComponentPath(m_filename));
+
+    /* End the <Algorithm> tag */
+    doc->writeEndElement();
+
+    return true;
+}
@@ -0,0 +1,174 @@
+/*
+  Q Light Controller Plus
+  rgbvideo.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef RGBVIDEO_H
+#define RGBVIDEO_H
+
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QSize>
+
+#include "rgbalgorithm.h"
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+#define KXMLQLCRGBVideo "Video"
+#define KXMLQLCRGBVideoFilename "Filename"
+
+/** Number of points sampled along each side of a grid cell */
+#define RGBVIDEO_SAMPLES_PER_CELL 4
+
+class QVideoFrame;
+class QMediaPlayer;
+class RGBVideoSurface;
+
+/** A video frame already sampled down to the size of a matrix grid */
+struct RGBVideoFrame
+{
+    QSize size;
+    QVector<uint> pixels;
+};
+
+/**
+ * RGBVideo plays a video file and maps its frames onto the grid of the
+ * matrix fixture group.
+ *
+ * The media player lives in the main thread and decodes the frames as
+ * RGB32, so the color conversion is done by the multimedia backend. Each
+ * frame is sampled down to the grid size as soon as it is presented, and
+ * only a few points of each cell are read, so the full frame is never
+ * copied. The sampled frame is handed to the MasterTimer thread through a
+ * lock-free latest-frame slot: a frame that is not consumed in time is
+ * replaced by the next one, and neither side ever waits for the other.
+ */
+class RGBVideo : public QObject, public RGBAlgorithm
+{
+    Q_OBJECT
+
+public:
+    RGBVideo(Doc * doc);
+    RGBVideo(const RGBVideo& v, QObject *parent = 0);
+    ~RGBVideo();
+
+    /** @reimp */
+    RGBAlgorithm* clone() const;
+
+    /************************************************************************
+     * Video file
+     ************************************************************************/
+public:
+    /** Set the file name of the video */
+    void setFilename(const QString& fileName);
+
+    /** Get the file name of the video */
+    QString filename() const;
+
+private:
+    QString m_filename;
+
+    /************************************************************************
+     * Playback
+     ************************************************************************/
+public:
+    /**
+     * Sample a mapped video frame down to the current grid size and make
+     * it the latest frame. Called in the thread that presents the frames.
+     * $bottomToTop tells if the frame lines are stored upside down.
+     */
+    void presentFrame(const QVideoFrame& frame, bool bottomToTop);
+
+private slots:
+    void slotPlay();
+    void slotStop();
+    void slotMediaStatusChanged();
+
+private:
+    /** Sample $frame into $target, which is resized to $gridSize */
+    static void sampleFrame(const QVideoFrame& frame, const QSize& gridSize,
+                            bool bottomToTop, RGBVideoFrame *target);
+
+    /** Keep $frame for the next producer, or delete it if one is kept already */
+    void recycleFrame(RGBVideoFrame *frame);
+
+private:
+    QMediaPlayer *m_player;
+    RGBVideoSurface *m_surface;
+
+    /** 1 when the video has been asked to play */
+    QAtomicInt m_playing;
+
+    /** The grid size requested by rgbMap(), as width << 16 | height */
+    QAtomicInt m_gridSize;
+
+    /** The latest sampled frame, not yet taken by rgbMap() */
+    QAtomicPointer<RGBVideoFrame> m_latestFrame;
+
+    /** A frame released by rgbMap(), to be reused by the producer */
+    QAtomicPointer<RGBVideoFrame> m_freeFrame;
+
+    /** The frame being rendered. Accessed only by rgbMap() */
+    RGBVideoFrame *m_currentFrame;
+
+    /************************************************************************
+     * RGBAlgorithm
+     ************************************************************************/
+public:
+    /** @reimp */
+    int rgbMapStepCount(const QSize& size);
+
+    /** @reimp */
+    void rgbMap(const QSize& size, uint rgb, int step, RGBMap &map);
+
+    /** @reimp */
+    void postRun();
+
+    /** @reimp */
+    QString name() const;
+
+    /** @reimp */
+    QString author() const;
+
+    /** @reimp */
+    int apiVersion() const;
+
+    /** @reimp */
+    RGBAlgorithm::Type type() const;
+
+    /** @reimp */
+    int acceptColors() const;
+
+    /************************************************************************
+     * Load & Save
+     ************************************************************************/
+public:
+    /** @reimp */
+    bool loadXML(QXmlStreamReader &root);
+
+    /** @reimp */
+    bool saveXML(QXmlStreamWriter *doc) const;
+};
+
+/** @} */
+
+#endif
@@ -24,6 +24,8 @@
 #include <QList>
 #include <QFile>
 
+#include <algorithm>
+
 #include "qlcfixturedef.h"
 #include "qlcmacros.h"
 #include "qlcfile.h"
@@ -43,6 +45,8 @@
 Scene::Scene(Doc* doc)
     : Function(doc, Function::SceneType)
     , m_legacyFadeBus(Bus::invalid())
+    , m_channelPlanChanged(true)
+    , m_channelPlanRevision(0)
     , m_blendFunctionID(Function::invalidId())
 {
     setName(tr("New Scene"));
@@ -92,8 +96,12 @@ bool Scene::copyFrom(const Function* function)
     if (scene == NULL)
         return false;
 
+    const_cast<Scene *>(scene)->loadDeferred();
+
     m_values.clear();
     m_values = scene->m_values;
+    m_deferredValues.clear();
+    invalidateChannelPlan();
     m_fixtures.clear();
     m_fixtures = scene->m_fixtures;
     m_channelGroups.clear();
@@ -116,6 +124,8 @@ void Scene::setValue(const SceneValue& scv, bool blind, bool checkHTP)
 {
     bool valChanged = false;
 
+    loadDeferred();
+
     if (!m_fixtures.contains(scv.fxi))
     {
         qWarning() << Q_FUNC_INFO << "Setting value for unknown fixture" << scv.fxi << ". Adding it.";
@@ -125,43 +135,35 @@ void Scene::setValue(const SceneValue& scv, bool blind, bool checkHTP)
     {
         QMutexLocker locker(&m_valueListMutex);
 
-        QMap<SceneValue, uchar>::iterator it = m_values.find(scv);
-        if (it == m_values.end())
+        QVector<SceneValue>::iterator it = findValue(scv.fxi, scv.channel);
+        if (it == m_values.end() || !(*it == scv))
         {
-            m_values.insert(scv, scv.value);
+            m_values.insert(it, scv);
+            m_channelPlanChanged = true;
             valChanged = true;
         }
-        else if (it.value() != scv.value)
+        else if (it->value != scv.value)
         {
-            const_cast<uchar&>(it.key().value) = scv.value;
-            it.value() = scv.value;
+            it->value = scv.value;
             valChanged = true;
-        }
 
-        // if the scene is running, we must
-        // update/add the changed channel
-        if (blind == false && m_fadersMap.isEmpty() == false)
-        {
-            Fixture *fixture = doc()->fixture(scv.fxi);
-            if (fixture != NULL)
+            // only the value has changed, so the plan entry can be
+            // updated in place instead of resolving the whole Scene again
+            if (m_channelPlanChanged == false)
             {
-                quint32 universe = fixture->universe();
-
-                FadeChannel fc(doc(), scv.fxi, scv.channel);
-                fc.setStart(scv.value);
-                fc.setTarget(scv.value);
-                fc.setCurrent(scv.value);
-                fc.setFadeTime(0);
-
-                if (m_fadersMap.contains(universe))
-                {
-                    if (checkHTP == false)
-                        m_fadersMap[universe]->replace(fc);
-                    else
-                        m_fadersMap[universe]->add(fc);
-                }
+                QVector<PlannedChannel>::iterator pit = std::lower_bound(
+                    m_channelPlan.begin(), m_channelPlan.end(), scv, plannedChannelLessThan);
+                if (pit != m_channelPlan.end() && pit->m_value == scv)
+                    pit->m_value.value = scv.value;
+                else
+                    m_channelPlanChanged = true;
             }
-         }
+        }
+
+        // if the scene is running, the changed channel
+        // is updated/added by the next write()
+        if (blind == false && isRunning())
+            queueLiveEdit(scv, false, checkHTP);
     }
 
     emit changed(this->id());
@@ -179,9 +181,19 @@ void Scene::unsetValue(quint32 fxi, quint32 ch)
     if (!m_fixtures.contains(fxi))
         qWarning() << Q_FUNC_INFO << "Unsetting value for unknown fixture" << fxi;
 
+    loadDeferred();
+
     {
         QMutexLocker locker(&m_valueListMutex);
-        m_values.remove(SceneValue(fxi, ch, 0));
+        QVector<SceneValue>::iterator it = findValue(fxi, ch);
+        if (it != m_values.end() && it->fxi == fxi && it->channel == ch)
+        {
+            m_values.erase(it);
+            m_channelPlanChanged = true;
+
+            if (isRunning())
+                queueLiveEdit(SceneValue(fxi, ch), true, false);
+        }
     }
 
     emit changed(this->id());
@@ -189,24 +201,44 @@ void Scene::unsetValue(quint32 fxi, quint32 ch)
 
 uchar Scene::value(quint32 fxi, quint32 ch)
 {
-    return m_values.value(SceneValue(fxi, ch, 0), 0);
+    loadDeferred();
+    QVector<SceneValue>::const_iterator it = findValue(fxi, ch);
+    if (it != m_values.constEnd() && it->fxi == fxi && it->channel == ch)
+        return it->value;
+
+    return 0;
 }
 
 bool Scene::checkValue(SceneValue val)
 {
-    return m_values.contains(val);
+    loadDeferred();
+    QVector<SceneValue>::const_iterator it = findValue(val.fxi, val.channel);
+    return (it != m_values.constEnd() && *it == val);
 }
 
 QList <SceneValue> Scene::values() const
 {
-    return m_values.keys();
+    const_cast<Scene *>(this)->loadDeferred();
+    return m_values.toList();
+}
+
+QVector<SceneValue>::iterator Scene::findValue(quint32 fxi, quint32 ch)
+{
+    return std::lower_bound(m_values.begin(), m_values.end(), SceneValue(fxi, ch));
+}
+
+QVector<SceneValue>::const_iterator Scene::findValue(quint32 fxi, quint32 ch) const
+{
+    return std::lower_bound(m_values.constBegin(), m_values.constEnd(), SceneValue(fxi, ch));
 }
 
 QList<quint32> Scene::components()
 {
     QList<quint32> ids;
 
-    foreach(SceneValue scv, m_values.keys())
+    loadDeferred();
+
+    foreach(const SceneValue &scv, m_values)
     {
         if (ids.contains(scv.fxi) == false)
             ids.append(scv.fxi);
@@ -222,7 +254,9 @@ QColor Scene::colorValue(quint32 fxi)
     bool found = false;
     QColor CMYcol;
 
-    foreach(SceneValue scv, m_values.keys())
+    loadDeferred();
+
+    foreach(const SceneValue &scv, m_values)
     {
         if (fxi != Fixture::invalidId() && fxi != scv.fxi)
             continue;
@@ -284,6 +318,8 @@ QColor Scene::colorValue(quint32 fxi)
 void Scene::clear()
 {
     m_values.clear();
+    m_deferredValues.clear();
+    invalidateChannelPlan();
     m_fixtures.clear();
     m_fixtureGroups.clear();
     m_palettes.clear();
@@ -337,17 +373,26 @@ void Scene::slotFixtureRemoved(quint32 fxi_id)
 {
     bool hasChanged = false;
 
-    QMutableMapIterator <SceneValue, uchar> it(m_values);
-    while (it.hasNext() == true)
+    loadDeferred();
+
+    // the fixture values are contiguous, since m_values is sorted
     {
-        SceneValue value(it.next().key());
-        if (value.fxi == fxi_id)
+        QMutexLocker locker(&m_valueListMutex);
+        QVector<SceneValue>::iterator first = findValue(fxi_id, 0);
+        QVector<SceneValue>::iterator last = first;
+        while (last != m_values.end() && last->fxi == fxi_id)
+            ++last;
+
+        if (first != last)
         {
-            it.remove();
+            m_values.erase(first, last);
             hasChanged = true;
         }
     }
 
+    if (hasChanged)
+        invalidateChannelPlan();
+
     if (removeFixture(fxi_id))
         hasChanged = true;
 
@@ -444,34 +489,21 @@ bool Scene::saveXML(QXmlStreamWriter *doc)
     }
 
     /* Scene contents */
-    // make a copy of the Scene values cause we need to empty it in the process
-    QList<SceneValue> values = m_values.keys();
+    loadDeferred();
 
     // loop through the Scene Fixtures in the order they've been added
     foreach (quint32 fxId, m_fixtures)
     {
         QStringList currFixValues;
-        bool found = false;
 
-        // look for the values that match the current Fixture ID
-        for (int j = 0; j < values.count(); j++)
+        // the values of the current Fixture ID are contiguous in m_values
+        QVector<SceneValue>::const_iterator it = findValue(fxId, 0);
+        for (; it != m_values.constEnd() && it->fxi == fxId; ++it)
         {
-            SceneValue scv = values.at(j);
-            if (scv.fxi != fxId)
-            {
-                if (found == true)
-                    break;
-                else
-                    continue;
-            }
-
-            found = true;
-            currFixValues.append(QString::number(scv.channel));
+            currFixValues.append(QString::number(it->channel));
             // IMPORTANT: if a Scene is hidden, so used as a container by some Sequences,
             // it must be saved with values set to zero
-            currFixValues.append(QString::number(isVisible() ? scv.value : 0));
-            values.removeAt(j);
-            j--;
+            currFixValues.append(QString::number(isVisible() ? it->value : 0));
         }
 
         saveXMLFixtureValues(doc, fxId, currFixValues);
@@ -573,18 +605,13 @@ bool Scene::loadXML(QXmlStreamReader &root)
         {
             quint32 fxi = root.attributes().value(KXMLQLCFixtureID).toString().toUInt();
             addFixture(fxi);
+            // splitting the values is left to loadDeferred(),
+            // which Doc runs concurrently for all the Scenes
             QString strvals = root.readElementText();
             if (strvals.isEmpty() == false)
             {
-                QStringList varray = strvals.split(",");
-                for (int i = 0; i + 1 < varray.count(); i+=2)
-                {
-                    SceneValue scv;
-                    scv.fxi = fxi;
-                    scv.channel = QString(varray.at(i)).toUInt();
-                    scv.value = uchar(QString(varray.at(i + 1)).toInt());
-                    setValue(scv);
-                }
+                QMutexLocker locker(&m_valueListMutex);
+                m_deferredValues.append(QPair<quint32, QString>(fxi, strvals));
             }
         }
         else if (root.name() == KXMLQLCFixtureGroup)
@@ -619,15 +646,177 @@ void Scene::postLoad()
         setFadeOutSpeed((value / MasterTimer::frequency()) * 1000);
     }
 
+    loadDeferred();
+
     // Remove such fixtures and channels that don't exist
-    QMutableMapIterator <SceneValue, uchar> it(m_values);
-    while (it.hasNext() == true)
+    int count = 0;
+    for (int i = 0; i < m_values.count(); i++)
     {
-        SceneValue value(it.next().key());
+        const SceneValue &value = m_values.at(i);
         Fixture* fxi = doc()->fixture(value.fxi);
         if (fxi == NULL || fxi->channel(value.channel) == NULL)
-            it.remove();
+            continue;
+
+        if (count != i)
+            m_values[count] = value;
+        count++;
     }
+    m_values.resize(count);
+
+    invalidateChannelPlan();
+}
+
+/****************************************************************************
+ * Channel plan
+ ****************************************************************************/
+
+void Scene::invalidateChannelPlan()
+{
+    QMutexLocker locker(&m_valueListMutex);
+    m_channelPlanChanged = true;
+}
+
+void Scene::buildChannelPlan()
+{
+    m_channelPlan.clear();
+    m_channelPlan.reserve(m_values.count());
+
+    foreach (const SceneValue &scv, m_values)
+    {
+        Fixture *fixture = doc()->fixture(scv.fxi);
+        if (fixture == NULL)
+            continue;
+
+        quint32 universe = fixture->universe();
+        if (universe == Universe::invalid())
+            continue;
+
+        PlannedChannel planned;
+        planned.m_universe = universe;
+        planned.m_channel = FadeChannel(doc(), scv.fxi, scv.channel);
+        planned.m_value = scv;
+        m_channelPlan.append(planned);
+    }
+
+    m_channelPlanChanged = false;
+    m_channelPlanRevision = doc()->fixturesRevision();
+}
+
+bool Scene::plannedChannelLessThan(const PlannedChannel &planned, const SceneValue &scv)
+{
+    return planned.m_value < scv;
+}
+
+void Scene::loadDeferred()
+{
+    QMutexLocker locker(&m_valueListMutex);
+    parseDeferredValues();
+}
+
+void Scene::parseDeferredValues()
+{
+    if (m_deferredValues.isEmpty())
+        return;
+
+    // append all the values and sort them once, instead of inserting
+    // them one by one in the middle of the vector
+    QListIterator <QPair<quint32, QString> > it(m_deferredValues);
+    while (it.hasNext() == true)
+    {
+        const QPair<quint32, QString> &fixtureValues = it.next();
+        QStringList varray = fixtureValues.second.split(",");
+        m_values.reserve(m_values.count() + varray.count() / 2);
+        for (int i = 0; i + 1 < varray.count(); i+=2)
+        {
+            m_values.append(SceneValue(fixtureValues.first,
+                                       QString(varray.at(i)).toUInt(),
+                                       uchar(QString(varray.at(i + 1)).toInt())));
+        }
+    }
+
+    // the sort is stable, so of the duplicated channels the last value is kept
+    std::stable_sort(m_values.begin(), m_values.end());
+    int count = 0;
+    for (int i = 0; i < m_values.count(); i++)
+    {
+        if (count > 0 && m_values.at(count - 1) == m_values.at(i))
+            m_values[count - 1] = m_values.at(i);
+        else
+            m_values[count++] = m_values.at(i);
+    }
+    m_values.resize(count);
+
+    m_deferredValues.clear();
+    m_channelPlanChanged = true;
+}
+
+void Scene::prepareRun()
+{
+    QMutexLocker locker(&m_valueListMutex);
+    parseDeferredValues();
+    if (m_channelPlanChanged || m_channelPlanRevision != doc()->fixturesRevision())
+        buildChannelPlan();
+}
+
+/****************************************************************************
+ * Live edits
+ ****************************************************************************/
+
+void Scene::queueLiveEdit(const SceneValue &scv, bool unset, bool checkHTP)
+{
+    LiveEdit edit;
+    edit.m_value = scv;
+    edit.m_unset = unset;
+    edit.m_checkHTP = checkHTP;
+    m_liveEdits.append(edit);
+}
+
+void Scene::applyLiveEdits(MasterTimer *timer, QList<Universe*> ua)
+{
+    foreach (const LiveEdit &edit, m_liveEdits)
+    {
+        const SceneValue &scv = edit.m_value;
+        Fixture *fixture = doc()->fixture(scv.fxi);
+        if (fixture == NULL)
+            continue;
+
+        quint32 universe = fixture->universe();
+        if (universe == Universe::invalid())
+            continue;
+
+        QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
+
+        if (edit.m_unset)
+        {
+            if (fader.isNull() == false)
+            {
+                FadeChannel fc(doc(), scv.fxi, scv.channel);
+                fader->remove(&fc);
+            }
+            continue;
+        }
+
+        // a channel on a universe the Scene doesn't write yet
+        // takes the same path as the channels of a starting Scene
+        if (fader.isNull())
+        {
+            processChannel(timer, ua, 0, universe, FadeChannel(doc(), scv.fxi, scv.channel), scv);
+            continue;
+        }
+
+        FadeChannel fc(doc(), scv.fxi, scv.channel);
+        fc.setStart(scv.value);
+        fc.setTarget(scv.value);
+        fc.setCurrent(scv.value);
+        fc.setFadeTime(0);
+
+        if (edit.m_checkHTP == false)
+            fader->replace(fc);
+        else
+            fader->add(fc);
+    }
+
+    m_liveEdits.clear();
 }
 
 /****************************************************************************
@@ -640,6 +829,7 @@ void Scene::flash(MasterTimer *timer)
         return;
 
     Q_ASSERT(timer != NULL);
+    loadDeferred();
     Function::flash(timer);
     timer->registerDMXSource(this);
 }
@@ -664,7 +854,7 @@ void Scene::writeDMX(MasterTimer *timer, QList<Universe *> ua)
         {
             // Keep HTP and LTP channels up. Flash is more or less a forceful intervention
             // so enforce all values that the user has chosen to flash.
-            foreach (const SceneValue& sv, m_values.keys())
+            foreach (const SceneValue& sv, m_values)
             {
                 FadeChannel fc(doc(), sv.fxi, sv.channel);
                 quint32 universe = fc.universe();
@@ -710,12 +900,19 @@ void Scene::processValue(MasterTimer *timer, QList<Universe*> ua, uint fadeIn, S
     if (universe == Universe::invalid())
         return;
 
+    processChannel(timer, ua, fadeIn, universe, FadeChannel(doc(), scv.fxi, scv.channel), scv);
+}
+
+void Scene::processChannel(MasterTimer *timer, QList<Universe*> ua, uint fadeIn,
+                           quint32 universe, const FadeChannel &channel, const SceneValue &scv)
+{
     QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
     if (fader.isNull())
     {
         fader = ua[universe]->requestFader();
         fader->adjustIntensity(getAttributeValue(Intensity));
         fader->setBlendMode(blendMode());
+        fader->setFadeCurve(fadeCurve());
         fader->setName(name());
         fader->setParentFunctionID(id());
         m_fadersMap[universe] = fader;
@@ -723,14 +920,15 @@ void Scene::processValue(MasterTimer *timer, QList<Universe*> ua, uint fadeIn, S
         fader->setParentIntensity(getAttributeValue(ParentIntensity));
     }
 
-    FadeChannel *fc = fader->getChannelFader(doc(), ua[universe], scv.fxi, scv.channel);
+    FadeChannel *fc = fader->getChannelFader(channel, ua[universe]);
+    Scene *blendScene = NULL;
 
     /** If a blend Function has been set, check if this channel needs to
      *  be blended from a previous value. If so, mark it for crossfade
      *  and set its current value */
     if (blendFunctionID() != Function::invalidId())
     {
-        Scene *blendScene = qobject_cast<Scene *>(doc()->function(blendFunctionID()));
+        blendScene = qobject_cast<Scene *>(doc()->function(blendFunctionID()));
         if (blendScene != NULL && blendScene->checkValue(scv))
         {
             fc->addFlag(FadeChannel::CrossFade);
@@ -768,6 +966,16 @@ void Scene::processValue(MasterTimer *timer, QList<Universe*> ua, uint fadeIn, S
             fc->setFadeTime(fadeIn);
         }
     }
+
+    /** A manual crossfade morphs the channel from the blend Scene value
+     *  in this fader, so the blend Scene doesn't need to write it too */
+    if (blendScene != NULL && fc->canFade() && fc->fadeTime() == 0 &&
+        (fc->flags() & FadeChannel::CrossFade))
+    {
+        QSharedPointer<GenericFader> blendFader = blendScene->m_fadersMap.value(universe);
+        if (!blendFader.isNull())
+            blendFader->handOverChannel(scv.fxi, scv.channel);
+    }
 }
 
 void Scene::write(MasterTimer *timer, QList<Universe*> ua)
@@ -798,12 +1006,20 @@ void Scene::write(MasterTimer *timer, QList<Universe*> ua)
         }
 
         QMutexLocker locker(&m_valueListMutex);
-        QMapIterator <SceneValue, uchar> it(m_values);
-        while (it.hasNext() == true)
-        {
-            SceneValue scv(it.next().key());
-            processValue(timer, ua, fadeIn, scv);
-        }
+        if (m_channelPlanChanged || m_channelPlanRevision != doc()->fixturesRevision())
+            buildChannelPlan();
+
+        foreach (const PlannedChannel &planned, m_channelPlan)
+            processChannel(timer, ua, fadeIn, planned.m_universe, planned.m_channel, planned.m_value);
+
+        // the plan already has the values edited before the start
+        m_liveEdits.clear();
+    }
+    else
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        if (m_liveEdits.isEmpty() == false)
+            applyLiveEdits(timer, ua);
     }
 
     if (isPaused() == false)
@@ -839,6 +1055,11 @@ void Scene::postRun(MasterTimer* timer, QList<Universe *> ua)
 
     m_fadersMap.clear();
 
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        m_liveEdits.clear();
+    }
+
     // autonomously reset a blend function if set
     setBlendFunctionID(Function::invalidId());
 
@@ -900,6 +1121,20 @@ quint32 Scene::blendFunctionID() const
 
 void Scene::setBlendFunctionID(quint32 fid)
 {
+    // the previous blend Scene writes the channels handed over again
+    Scene *blendScene = NULL;
+    if (fid != m_blendFunctionID && m_blendFunctionID != Function::invalidId())
+        blendScene = qobject_cast<Scene *>(doc()->function(m_blendFunctionID));
+
+    if (blendScene != NULL)
+    {
+        foreach (QSharedPointer<GenericFader> fader, blendScene->m_fadersMap.values())
+        {
+            if (!fader.isNull())
+                fader->resetHandover();
+        }
+    }
+
     m_blendFunctionID = fid;
     if (isRunning() && fid == Function::invalidId())
     {
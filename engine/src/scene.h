@@ -22,6 +22,7 @@
 #define SCENE_H
 
 #include <QMutex>
+#include <QVector>
 #include <QList>
 
 #include "genericfader.h"
@@ -152,9 +153,80 @@ signals:
     void valueChanged(SceneValue scv);
 
 protected:
-    QMap <SceneValue, uchar> m_values;
+    /** Return the position of the value of $fxi/$ch in m_values, or the
+     *  position where it should be inserted if it's not there */
+    QVector<SceneValue>::iterator findValue(quint32 fxi, quint32 ch);
+    QVector<SceneValue>::const_iterator findValue(quint32 fxi, quint32 ch) const;
+
+    /** The Scene values, sorted by fixture and channel */
+    QVector <SceneValue> m_values;
     QMutex m_valueListMutex;
 
+    /** Fixture IDs and raw value strings read by loadXML, which are
+     *  parsed into m_values by loadDeferred() before they are used */
+    QList <QPair<quint32, QString> > m_deferredValues;
+
+    /*********************************************************************
+     * Channel plan
+     *********************************************************************/
+protected:
+    /** A Scene value resolved to its universe and fader channel */
+    struct PlannedChannel
+    {
+        quint32 m_universe;
+        FadeChannel m_channel;
+        SceneValue m_value;
+    };
+
+    /** Mark the channel plan as outdated, so that it is rebuilt
+     *  the next time the Scene starts */
+    void invalidateChannelPlan();
+
+    /** Resolve every value of m_values into m_channelPlan.
+     *  Must be called with m_valueListMutex locked */
+    void buildChannelPlan();
+
+    /** Order the plan entries like m_values, to look them up */
+    static bool plannedChannelLessThan(const PlannedChannel &planned, const SceneValue &scv);
+
+public:
+    /** @reimp */
+    void prepareRun();
+
+protected:
+    /** m_values in playback order, with fixture lookups and channel
+     *  detection already done */
+    QVector<PlannedChannel> m_channelPlan;
+
+    /** Flag raised when m_values has changed since the plan was built */
+    bool m_channelPlanChanged;
+
+    /** The Doc fixtures revision the plan was built with */
+    int m_channelPlanRevision;
+
+    /*********************************************************************
+     * Live edits
+     *********************************************************************/
+protected:
+    /** A value set or unset while the Scene is running */
+    struct LiveEdit
+    {
+        SceneValue m_value;
+        bool m_unset;
+        bool m_checkHTP;
+    };
+
+    /** Queue an edit for the running faders.
+     *  Must be called with m_valueListMutex locked */
+    void queueLiveEdit(const SceneValue &scv, bool unset, bool checkHTP);
+
+    /** Apply the queued edits to the running faders, touching only the
+     *  edited channels. Must be called with m_valueListMutex locked */
+    void applyLiveEdits(MasterTimer *timer, QList<Universe*> ua);
+
+    /** Edits waiting to be applied by the next write() */
+    QVector<LiveEdit> m_liveEdits;
+
     /*********************************************************************
      * Channel Groups
      *********************************************************************/
@@ -237,7 +309,14 @@ public:
     /** @reimp */
     void postLoad();
 
+    /** @reimp */
+    void loadDeferred();
+
 private:
+    /** Parse m_deferredValues into m_values.
+     *  Must be called with m_valueListMutex locked */
+    void parseDeferredValues();
+
     static bool saveXMLFixtureValues(QXmlStreamWriter* doc, quint32 fixtureID, QStringList const& values);
 
     /*********************************************************************
@@ -267,6 +346,10 @@ private:
     /** Internal helper method to abtract Scene value processing */
     void processValue(MasterTimer *timer, QList<Universe*> ua, uint fadeIn, SceneValue &scv);
 
+    /** Set up the fader channel of a value already resolved to $universe */
+    void processChannel(MasterTimer *timer, QList<Universe*> ua, uint fadeIn,
+                        quint32 universe, const FadeChannel &channel, const SceneValue &scv);
+
     /*********************************************************************
      * Attributes
      *********************************************************************/
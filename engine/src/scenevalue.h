@@ -99,6 +99,7 @@ public:
 };
 
 Q_DECLARE_METATYPE(SceneValue)
+Q_DECLARE_TYPEINFO(SceneValue, Q_MOVABLE_TYPE);
 
 QDebug operator<<(QDebug debug, const SceneValue &sv);
 
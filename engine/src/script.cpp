@@ -62,6 +62,8 @@ const QStringList knownKeywords(QStringList() << "ch" << "val" << "arg");
  ****************************************************************************/
 
 Script::Script(Doc* doc) : Function(doc, Function::ScriptType)
+    , m_lastFader(NULL)
+    , m_lastFaderUniverse(Universe::invalid())
     , m_currentCommand(0)
     , m_waitCount(0)
 {
@@ -140,6 +142,7 @@ bool Script::setData(const QString& str)
 
     // Construct individual code lines from the data
     m_lines.clear();
+    m_compiledLines.clear();
     if (m_data.isEmpty() == false)
     {
         int i = 1;
@@ -329,6 +332,10 @@ void Script::preRun(MasterTimer *timer)
     m_waitCount = 0;
     m_currentCommand = 0;
     m_startedFunctions.clear();
+    m_lastFader = NULL;
+    m_lastFaderUniverse = Universe::invalid();
+
+    compileLines();
 
     Function::preRun(timer);
 }
@@ -370,6 +377,8 @@ void Script::postRun(MasterTimer *timer, QList<Universe *> universes)
     m_startedFunctions.clear();
 
     dismissAllFaders();
+    m_lastFader = NULL;
+    m_lastFaderUniverse = Universe::invalid();
 
     Function::postRun(timer, universes);
 }
@@ -422,6 +431,12 @@ bool Script::executeCommand(int index, MasterTimer* timer, QList<Universe *> uni
         return false;
     }
 
+    if (index < m_compiledLines.size() && m_compiledLines.at(index).m_valid)
+    {
+        writeSetFixture(m_compiledLines.at(index), universes);
+        return true;
+    }
+
     QList <QStringList> tokens = m_lines[index];
     if (tokens.isEmpty() == true)
         return true; // Empty line
@@ -618,39 +633,14 @@ QString Script::handleSetFixture(const QList<QStringList>& tokens, QList<Univers
 {
     qDebug() << Q_FUNC_INFO;
 
-    if (tokens.size() > 4)
-        return QString("Too many arguments");
-
-    bool ok = false;
     quint32 id = 0;
     quint32 ch = 0;
     uchar value = 0;
-    double time = 0;
+    uint time = 0;
 
-    id = getValueFromString(tokens[0][1], &ok);
-    if (ok == false)
-        return QString("Invalid fixture (ID: %1)").arg(tokens[0][1]);
-
-    for (int i = 1; i < tokens.size(); i++)
-    {
-        QStringList list = tokens[i];
-        list[0] = list[0].toLower().trimmed();
-        if (list.size() == 2)
-        {
-            ok = false;
-            if (list[0] == "val" || list[0] == "value")
-                value = uchar(getValueFromString(list[1], &ok));
-            else if (list[0] == "ch" || list[0] == "channel")
-                ch = getValueFromString(list[1], &ok);
-            else if (list[0] == "time")
-                time = getValueFromString(list[1], &ok);
-            else
-                return QString("Unrecognized keyword: %1").arg(list[0]);
-
-            if (ok == false)
-                return QString("Invalid value (%1) for keyword: %2").arg(list[1]).arg(list[0]);
-        }
-    }
+    QString error = parseSetFixture(tokens, id, ch, value, time);
+    if (error.isEmpty() == false)
+        return error;
 
     Doc *doc = qobject_cast<Doc*> (parent());
     Q_ASSERT(doc != NULL);
@@ -664,16 +654,7 @@ QString Script::handleSetFixture(const QList<QStringList>& tokens, QList<Univers
             if (address < 512)
             {
                 quint32 universe = fxi->universe();
-                QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
-                if (fader.isNull())
-                {
-                    fader = universes[universe]->requestFader();
-                    fader->adjustIntensity(getAttributeValue(Intensity));
-                    fader->setBlendMode(blendMode());
-                    fader->setParentFunctionID(this->id());
-                    fader->setName(name());
-                    m_fadersMap[universe] = fader;
-                }
+                GenericFader *fader = universeFader(universe, universes);
 
                 FadeChannel *fc = fader->getChannelFader(doc, universes[universe], fxi->id(), ch);
                 fc->setTarget(value);
@@ -697,6 +678,64 @@ QString Script::handleSetFixture(const QList<QStringList>& tokens, QList<Univers
     }
 }
 
+QString Script::parseSetFixture(const QList<QStringList>& tokens, quint32 &id,
+                                quint32 &ch, uchar &value, uint &time)
+{
+    if (tokens.size() > 4)
+        return QString("Too many arguments");
+
+    bool ok = false;
+
+    id = getValueFromString(tokens[0][1], &ok);
+    if (ok == false)
+        return QString("Invalid fixture (ID: %1)").arg(tokens[0][1]);
+
+    for (int i = 1; i < tokens.size(); i++)
+    {
+        QStringList list = tokens[i];
+        list[0] = list[0].toLower().trimmed();
+        if (list.size() == 2)
+        {
+            ok = false;
+            if (list[0] == "val" || list[0] == "value")
+                value = uchar(getValueFromString(list[1], &ok));
+            else if (list[0] == "ch" || list[0] == "channel")
+                ch = getValueFromString(list[1], &ok);
+            else if (list[0] == "time")
+                time = getValueFromString(list[1], &ok);
+            else
+                return QString("Unrecognized keyword: %1").arg(list[0]);
+
+            if (ok == false)
+                return QString("Invalid value (%1) for keyword: %2").arg(list[1]).arg(list[0]);
+        }
+    }
+
+    return QString();
+}
+
+GenericFader *Script::universeFader(quint32 universe, QList<Universe *> universes)
+{
+    if (m_lastFader != NULL && m_lastFaderUniverse == universe)
+        return m_lastFader;
+
+    QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
+    if (fader.isNull())
+    {
+        fader = universes[universe]->requestFader();
+        fader->adjustIntensity(getAttributeValue(Intensity));
+        fader->setBlendMode(blendMode());
+        fader->setParentFunctionID(this->id());
+        fader->setName(name());
+        m_fadersMap[universe] = fader;
+    }
+
+    m_lastFader = fader.data();
+    m_lastFaderUniverse = universe;
+
+    return m_lastFader;
+}
+
 QString Script::handleSystemCommand(const QList<QStringList> &tokens)
 {
     qDebug() << Q_FUNC_INFO;
@@ -743,6 +782,69 @@ QString Script::handleJump(const QList<QStringList>& tokens)
     }
 }
 
+/****************************************************************************
+ * Compiled commands
+ ****************************************************************************/
+
+void Script::compileLines()
+{
+    Doc *doc = qobject_cast<Doc*> (parent());
+    Q_ASSERT(doc != NULL);
+
+    m_compiledLines.resize(m_lines.size());
+
+    for (int i = 0; i < m_lines.size(); i++)
+    {
+        CompiledSetFixture &cmd = m_compiledLines[i];
+        cmd.m_valid = false;
+
+        const QList <QStringList> &tokens = m_lines.at(i);
+        if (tokens.isEmpty() || tokens[0].size() < 2 || tokens[0][0] != Script::setFixtureCmd)
+            continue;
+
+        // random values must be evaluated at every execution
+        bool isRandom = false;
+        foreach (QStringList token, tokens)
+        {
+            if (token.size() == 2 && token[1].startsWith("random"))
+                isRandom = true;
+        }
+        if (isRandom)
+            continue;
+
+        quint32 id = 0;
+        quint32 ch = 0;
+        uchar value = 0;
+        uint time = 0;
+
+        // lines with errors are left to handleSetFixture, to report them
+        if (parseSetFixture(tokens, id, ch, value, time).isEmpty() == false)
+            continue;
+
+        Fixture *fxi = doc->fixture(id);
+        if (fxi == NULL || ch >= fxi->channels() || fxi->address() + ch >= 512)
+            continue;
+
+        cmd.m_valid = true;
+        cmd.m_universe = fxi->universe();
+        cmd.m_channel = FadeChannel(doc, fxi->id(), ch);
+        cmd.m_value = value;
+        cmd.m_fadeTime = time;
+    }
+}
+
+void Script::writeSetFixture(const CompiledSetFixture &cmd, QList<Universe *> universes)
+{
+    if (cmd.m_universe >= (quint32)universes.count())
+        return;
+
+    GenericFader *fader = universeFader(cmd.m_universe, universes);
+
+    FadeChannel *fc = fader->getChannelFader(cmd.m_channel, universes[cmd.m_universe]);
+    fc->setTarget(cmd.m_value);
+    fc->setFadeTime(cmd.m_fadeTime);
+}
+
 QList <QStringList> Script::tokenizeLine(const QString& str, bool* ok)
 {
     QList<QStringList> tokens;
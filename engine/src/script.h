@@ -23,7 +23,10 @@
 
 #include <QStringList>
 #include <QObject>
+#include <QVector>
 #include <QMap>
+
+#include "fadechannel.h"
 #include "function.h"
 
 class GenericFader;
@@ -212,6 +215,18 @@ private:
      */
     QString handleSetFixture(const QList<QStringList>& tokens, QList<Universe*> universes);
 
+    /**
+     * Parse the arguments of a "setfixture" command
+     *
+     * @param tokens A list of keyword:value pairs
+     * @return An empty string if successful. Otherwise an error string.
+     */
+    static QString parseSetFixture(const QList<QStringList>& tokens, quint32 &id,
+                                   quint32 &ch, uchar &value, uint &time);
+
+    /** Get the fader of this Script for $universe, requesting it if needed */
+    GenericFader *universeFader(quint32 universe, QList<Universe*> universes);
+
     /**
      * Handle "systemcommand" command.
      *
@@ -246,6 +261,41 @@ private:
      */
     static QList <QStringList> tokenizeLine(const QString& line, bool* ok = NULL);
 
+    /************************************************************************
+     * Compiled commands
+     ************************************************************************/
+private:
+    /** A "setfixture" line resolved when the Script starts */
+    struct CompiledSetFixture
+    {
+        /** False if the line must be parsed when executed */
+        bool m_valid;
+        quint32 m_universe;
+        /** Template of the FadeChannel, with fixture and channel detected */
+        FadeChannel m_channel;
+        uchar m_value;
+        uint m_fadeTime;
+    };
+
+    /**
+     * Resolve the "setfixture" lines with constant arguments to their
+     * universe and channel, so that executing them doesn't parse their
+     * tokens or look up their fixture anymore
+     */
+    void compileLines();
+
+    /** Execute a "setfixture" line compiled by compileLines() */
+    void writeSetFixture(const CompiledSetFixture &cmd, QList<Universe*> universes);
+
+private:
+    /** The compiled "setfixture" commands, indexed as m_lines */
+    QVector <CompiledSetFixture> m_compiledLines;
+
+    /** The fader used by the last "setfixture" command, so that consecutive
+     *  commands on the same universe don't look it up again */
+    GenericFader *m_lastFader;
+    quint32 m_lastFaderUniverse;
+
 private:
     int m_currentCommand;        //! Current command line being handled
     quint32 m_waitCount;         //! Timer ticks to wait before executing the next line
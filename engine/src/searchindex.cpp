@@ -0,0 +1,136 @@
+/*
+  Q Light Controller Plus
+  searchindex.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "searchindex.h"
+
+#define TRIGRAM_LENGTH 3
+
+SearchIndex::SearchIndex()
+{
+}
+
+void SearchIndex::setText(quint32 id, const QString &text)
+{
+    QString lower = text.toLower();
+
+    QHash<quint32, QString>::iterator it = m_texts.find(id);
+    if (it != m_texts.end())
+    {
+        if (it.value() == lower)
+            return;
+
+        removeTrigrams(id, it.value());
+        it.value() = lower;
+    }
+    else
+    {
+        m_texts.insert(id, lower);
+    }
+
+    addTrigrams(id, lower);
+}
+
+void SearchIndex::remove(quint32 id)
+{
+    QHash<quint32, QString>::iterator it = m_texts.find(id);
+    if (it == m_texts.end())
+        return;
+
+    removeTrigrams(id, it.value());
+    m_texts.erase(it);
+}
+
+void SearchIndex::clear()
+{
+    m_texts.clear();
+    m_trigrams.clear();
+}
+
+int SearchIndex::count() const
+{
+    return m_texts.count();
+}
+
+QSet<quint32> SearchIndex::match(const QString &text) const
+{
+    QSet<quint32> result;
+    QString lower = text.toLower();
+
+    if (lower.isEmpty())
+    {
+        foreach (quint32 id, m_texts.keys())
+            result.insert(id);
+        return result;
+    }
+
+    if (lower.length() < TRIGRAM_LENGTH)
+    {
+        QHashIterator<quint32, QString> it(m_texts);
+        while (it.hasNext())
+        {
+            it.next();
+            if (it.value().contains(lower))
+                result.insert(it.key());
+        }
+        return result;
+    }
+
+    /* Look for the trigram matched by the fewest objects */
+    const QSet<quint32> *smallest = NULL;
+    for (int i = 0; i + TRIGRAM_LENGTH <= lower.length(); i++)
+    {
+        QHash<QString, QSet<quint32> >::const_iterator it =
+                m_trigrams.constFind(lower.mid(i, TRIGRAM_LENGTH));
+        if (it == m_trigrams.constEnd())
+            return result;
+
+        if (smallest == NULL || it.value().count() < smallest->count())
+            smallest = &it.value();
+    }
+
+    /* The candidates contain that trigram, check if they contain the
+     * whole string too */
+    foreach (quint32 id, *smallest)
+    {
+        if (m_texts.value(id).contains(lower))
+            result.insert(id);
+    }
+
+    return result;
+}
+
+void SearchIndex::addTrigrams(quint32 id, const QString &text)
+{
+    for (int i = 0; i + TRIGRAM_LENGTH <= text.length(); i++)
+        m_trigrams[text.mid(i, TRIGRAM_LENGTH)].insert(id);
+}
+
+void SearchIndex::removeTrigrams(quint32 id, const QString &text)
+{
+    for (int i = 0; i + TRIGRAM_LENGTH <= text.length(); i++)
+    {
+        QHash<QString, QSet<quint32> >::iterator it = m_trigrams.find(text.mid(i, TRIGRAM_LENGTH));
+        if (it == m_trigrams.end())
+            continue;
+
+        it.value().remove(id);
+        if (it.value().isEmpty())
+            m_trigrams.erase(it);
+    }
+}
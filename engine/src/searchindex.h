@@ -0,0 +1,79 @@
+/*
+  Q Light Controller Plus
+  searchindex.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * SearchIndex finds the objects whose text contains a given string,
+ * without comparing the string with the text of every object.
+ *
+ * Each object is identified by its ID and the index stores, for every
+ * sequence of three characters (trigram) of its lowercase text, the IDs of
+ * the objects containing it. A search intersects the sets of the trigrams
+ * of the string, starting from the smallest one, and checks only the few
+ * candidates left. Strings shorter than a trigram are checked against all
+ * the texts.
+ *
+ * The index is updated one object at a time, so the owner can keep it in
+ * sync with additions, removals and renames.
+ */
+class SearchIndex
+{
+public:
+    SearchIndex();
+
+    /** Set the text of the object with the given $id, replacing the old one */
+    void setText(quint32 id, const QString& text);
+
+    /** Remove the object with the given $id from the index */
+    void remove(quint32 id);
+
+    /** Remove all the objects from the index */
+    void clear();
+
+    /** Get the number of objects in the index */
+    int count() const;
+
+    /** Get the IDs of the objects whose text contains $text, ignoring case */
+    QSet<quint32> match(const QString& text) const;
+
+private:
+    void addTrigrams(quint32 id, const QString& text);
+    void removeTrigrams(quint32 id, const QString& text);
+
+private:
+    /** The lowercase text of each object */
+    QHash<quint32, QString> m_texts;
+
+    /** The IDs of the objects containing each trigram */
+    QHash<QString, QSet<quint32> > m_trigrams;
+};
+
+/** @} */
+
+#endif
@@ -139,6 +139,21 @@ bool Sequence::saveXML(QXmlStreamWriter *doc)
     return true;
 }
 
+/** Returns true when two step value lists set the same channels to the same values */
+static bool sameStepValues(const QList<SceneValue> &a, const QList<SceneValue> &b)
+{
+    if (a.count() != b.count())
+        return false;
+
+    for (int i = 0; i < a.count(); i++)
+    {
+        if (!(a.at(i) == b.at(i)) || a.at(i).value != b.at(i).value)
+            return false;
+    }
+
+    return true;
+}
+
 bool Sequence::loadXML(QXmlStreamReader &root)
 {
     if (root.name() != KXMLQLCFunction)
@@ -205,6 +220,10 @@ bool Sequence::loadXML(QXmlStreamReader &root)
             {
                 step.fid = boundSceneID();
 
+                // identical consecutive steps (e.g. copied ones) share their values
+                if (m_steps.isEmpty() == false && sameStepValues(step.values, m_steps.last().values))
+                    step.values = m_steps.last().values;
+
                 if (stepNumber >= m_steps.size())
                     m_steps.append(step);
                 else
@@ -270,10 +289,12 @@ void Sequence::postLoad()
         step.values = sceneValues;
         for (int i = 0; i < tmpList.count(); i++)
         {
-            int tmpIndex = step.values.indexOf(tmpList.at(i));
-            if (tmpIndex == -1)
+            // sceneValues is sorted, so a binary search is enough
+            QList <SceneValue>::iterator sIt =
+                std::lower_bound(step.values.begin(), step.values.end(), tmpList.at(i));
+            if (sIt == step.values.end() || !(*sIt == tmpList.at(i)))
                 continue;
-            step.values.replace(tmpIndex, tmpList.at(i));
+            *sIt = tmpList.at(i);
         }
 
         replaceStep(step, stepIndex);
@@ -27,8 +27,12 @@
 #include "qlcfile.h"
 #include "qlcmacros.h"
 
+#include "inputoutputmap.h"
+#include "genericfader.h"
+#include "fadechannel.h"
 #include "showrunner.h"
 #include "function.h"
+#include "fixture.h"
 #include "chaser.h"
 #include "show.h"
 #include "doc.h"
@@ -37,6 +41,14 @@
 #define KXMLQLCShowTimeType "Type"
 #define KXMLQLCShowTimeBPM "BPM"
 
+#define KXMLQLCShowTimecode "Timecode"
+#define KXMLQLCShowTimecodeChase "Chase"
+#define KXMLQLCShowTimecodeOffset "Offset"
+
+/** Show/timecode difference in milliseconds beyond which the show
+ *  is played again from the timecode position */
+#define SHOW_TIMECODE_RELOCATE_THRESHOLD 500
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -46,6 +58,9 @@ Show::Show(Doc* doc) : Function(doc, Function::ShowType)
   , m_timeDivBPM(120)
   , m_latestTrackId(0)
   , m_runner(NULL)
+  , m_timecodeChase(false)
+  , m_timecodeOffset(0)
+  , m_timecodeRelocations(0)
 {
     setName(tr("New Show"));
 
@@ -111,7 +126,10 @@ bool Show::copyFrom(const Function* function)
 
     m_timeDivType = show->m_timeDivType;
     m_timeDivBPM = show->m_timeDivBPM;
+    m_timecodeChase = show->m_timecodeChase;
+    m_timecodeOffset = show->m_timecodeOffset;
     m_latestTrackId = show->m_latestTrackId;
+    m_keyframes.clear();
 
     // create a copy of each track
     foreach(Track *track, show->tracks())
@@ -181,6 +199,7 @@ bool Show::addTrack(Track *track, quint32 id)
      track->setId(id);
      track->setShowId(this->id());
      m_tracks[id] = track;
+     m_keyframes.clear();
 
      registerAttribute(track->name());
 
@@ -193,6 +212,7 @@ bool Show::removeTrack(quint32 id)
     {
         Track* trk = m_tracks.take(id);
         Q_ASSERT(trk != NULL);
+        m_keyframes.clear();
 
         unregisterAttribute(trk->name());
 
@@ -300,6 +320,14 @@ bool Show::saveXML(QXmlStreamWriter *doc)
     doc->writeAttribute(KXMLQLCShowTimeBPM, QString::number(m_timeDivBPM));
     doc->writeEndElement();
 
+    if (m_timecodeChase || m_timecodeOffset != 0)
+    {
+        doc->writeStartElement(KXMLQLCShowTimecode);
+        doc->writeAttribute(KXMLQLCShowTimecodeChase, m_timecodeChase ? "1" : "0");
+        doc->writeAttribute(KXMLQLCShowTimecodeOffset, QString::number(m_timecodeOffset));
+        doc->writeEndElement();
+    }
+
     foreach(Track *track, m_tracks)
         track->saveXML(doc);
 
@@ -333,6 +361,13 @@ bool Show::loadXML(QXmlStreamReader &root)
             setTimeDivision(type, bpm);
             root.skipCurrentElement();
         }
+        else if (root.name() == KXMLQLCShowTimecode)
+        {
+            QXmlStreamAttributes attrs = root.attributes();
+            setTimecodeChase(attrs.value(KXMLQLCShowTimecodeChase).toString().toInt() != 0);
+            setTimecodeOffset(attrs.value(KXMLQLCShowTimecodeOffset).toString().toUInt());
+            root.skipCurrentElement();
+        }
         else if (root.name() == KXMLQLCTrack)
         {
             Track *trk = new Track();
@@ -393,19 +428,37 @@ void Show::preRun(MasterTimer* timer)
 {
     Function::preRun(timer);
     m_runningChildren.clear();
+
+    // a jump of the timecode before the show started is not a relocation
+    if (m_timecodeChase)
+        doc()->inputOutputMap()->timecodePosition(&m_timecodeRelocations);
+
+    createRunner(elapsed());
+}
+
+void Show::createRunner(quint32 startTime)
+{
     if (m_runner != NULL)
     {
         m_runner->stop();
         delete m_runner;
     }
 
-    m_runner = new ShowRunner(doc(), this->id(), elapsed());
+    m_runner = new ShowRunner(doc(), this->id(), startTime);
     int i = 0;
     foreach(Track *track, m_tracks.values())
         m_runner->adjustIntensity(getAttributeValue(i++), track);
 
     connect(m_runner, SIGNAL(timeChanged(quint32)), this, SIGNAL(timeChanged(quint32)));
     connect(m_runner, SIGNAL(showFinished()), this, SIGNAL(showFinished()));
+
+    // when not starting from the beginning, restore the output
+    // from the nearest keyframe recorded by a previous playback
+    m_keyframes.startRun(startTime);
+    m_seekValues.clear();
+    if (startTime > 0)
+        m_seekValues = m_keyframes.values(startTime);
+
     m_runner->start();
 }
 
@@ -418,17 +471,27 @@ void Show::setPause(bool enable)
 
 void Show::write(MasterTimer* timer, QList<Universe *> universes)
 {
-    Q_UNUSED(universes);
     Q_UNUSED(timer);
 
     if (isPaused())
         return;
 
+    if (m_timecodeChase && chaseTimecode(universes) == false)
+        return;
+
+    writeSeekValues(universes);
+
+    // universes hold the output of the previous tick at this point
+    m_keyframes.record(m_runner->elapsedTime(), universes);
+
     m_runner->write();
 }
 
 void Show::postRun(MasterTimer* timer, QList<Universe *> universes)
 {
+    m_seekValues.clear();
+    dismissSeekFaders(universes);
+
     if (m_runner != NULL)
     {
         m_runner->stop();
@@ -443,6 +506,120 @@ void Show::slotChildStopped(quint32 fid)
     Q_UNUSED(fid);
 }
 
+/*****************************************************************************
+ * Seek keyframes
+ *****************************************************************************/
+
+ShowKeyframes *Show::keyframes()
+{
+    return &m_keyframes;
+}
+
+void Show::writeSeekValues(QList<Universe *> universes)
+{
+    // the restored output lasts one tick only: from now on the
+    // Functions started by the runner fade from it
+    if (m_seekValues.isEmpty())
+    {
+        dismissSeekFaders(universes);
+        return;
+    }
+
+    QHashIterator<quint32, QByteArray> it(m_seekValues);
+    while (it.hasNext())
+    {
+        it.next();
+        quint32 universe = it.key();
+        if (universe >= (quint32)universes.count())
+            continue;
+
+        QSharedPointer<GenericFader> fader = universes[universe]->requestFader();
+        fader->setName(name());
+        fader->setParentFunctionID(id());
+        m_seekFaders[universe] = fader;
+
+        const QByteArray &values = it.value();
+        for (int i = 0; i < values.size(); i++)
+        {
+            uchar value = uchar(values.at(i));
+            if (value == 0)
+                continue;
+
+            FadeChannel *fc = fader->getChannelFader(doc(), universes[universe], Fixture::invalidId(),
+                                                     (universe << 9) + i);
+            fc->setStart(value);
+            fc->setCurrent(value);
+            fc->setTarget(value);
+        }
+    }
+
+    qDebug() << "Show" << name() << "restored" << m_seekValues.count() << "universes at" << elapsed();
+    m_seekValues.clear();
+}
+
+void Show::dismissSeekFaders(QList<Universe *> universes)
+{
+    QHashIterator<quint32, QSharedPointer<GenericFader> > it(m_seekFaders);
+    while (it.hasNext())
+    {
+        it.next();
+        if (it.key() < (quint32)universes.count())
+            universes[it.key()]->dismissFader(it.value());
+    }
+    m_seekFaders.clear();
+}
+
+/*****************************************************************************
+ * Timecode chase
+ *****************************************************************************/
+
+void Show::setTimecodeChase(bool enable)
+{
+    m_timecodeChase = enable;
+}
+
+bool Show::timecodeChase() const
+{
+    return m_timecodeChase;
+}
+
+void Show::setTimecodeOffset(quint32 offset)
+{
+    m_timecodeOffset = offset;
+}
+
+quint32 Show::timecodeOffset() const
+{
+    return m_timecodeOffset;
+}
+
+bool Show::chaseTimecode(QList<Universe *> universes)
+{
+    quint32 relocations = 0;
+    qint64 position = doc()->inputOutputMap()->timecodePosition(&relocations);
+
+    // without timecode, or before the show start, the show holds
+    if (position < qint64(m_timecodeOffset))
+        return false;
+
+    qint64 time = position - m_timecodeOffset;
+
+    if (relocations != m_timecodeRelocations ||
+        qAbs(time - qint64(m_runner->elapsedTime())) > SHOW_TIMECODE_RELOCATE_THRESHOLD)
+    {
+        // play the show again from the new position, restoring
+        // the output of the keyframe recorded there
+        qDebug() << "Show" << name() << "relocated to timecode" << time;
+        m_timecodeRelocations = relocations;
+        dismissSeekFaders(universes);
+        createRunner(quint32(time));
+    }
+
+    m_runner->setChaseTime(time);
+
+    return true;
+}
+
 /*****************************************************************************
  * Attributes
  *****************************************************************************/
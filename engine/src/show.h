@@ -20,14 +20,17 @@
 #ifndef SHOW_H
 #define SHOW_H
 
+#include <QSharedPointer>
 #include <QMutex>
 #include <QList>
 #include <QSet>
 
+#include "showkeyframes.h"
 #include "function.h"
 #include "track.h"
 
 class QXmlStreamReader;
+class GenericFader;
 class ShowRunner;
 
 /** @addtogroup engine_functions Functions
@@ -172,6 +175,58 @@ protected:
     /** Number of currently running children */
     QSet <quint32> m_runningChildren;
 
+    /*********************************************************************
+     * Seek keyframes
+     *********************************************************************/
+public:
+    /** Get the DMX keyframes recorded while this Show plays */
+    ShowKeyframes *keyframes();
+
+private:
+    /** Write the keyframe values restored by preRun, on the first
+     *  write after a seek, and dismiss them on the following one */
+    void writeSeekValues(QList<Universe*> universes);
+
+    /** Dismiss the faders used to restore a keyframe */
+    void dismissSeekFaders(QList<Universe*> universes);
+
+    /** Create a new runner playing the show from $startTime, and prepare
+     *  the keyframe values to be restored at that time */
+    void createRunner(quint32 startTime);
+
+private:
+    ShowKeyframes m_keyframes;
+
+    /** The keyframe values to be restored on the next write */
+    QHash<quint32, QByteArray> m_seekValues;
+
+    /** Faders holding the restored keyframe, for each universe */
+    QHash<quint32, QSharedPointer<GenericFader> > m_seekFaders;
+
+    /*********************************************************************
+     * Timecode chase
+     *********************************************************************/
+public:
+    /** Make the show time follow the external timecode received
+     *  by the InputOutputMap, instead of running on its own */
+    void setTimecodeChase(bool enable);
+    bool timecodeChase() const;
+
+    /** Set the timecode position in ms at which the show starts */
+    void setTimecodeOffset(quint32 offset);
+    quint32 timecodeOffset() const;
+
+private:
+    /** Move the show time to the timecode position. Returns false when
+     *  the show must hold, because there is no timecode to follow */
+    bool chaseTimecode(QList<Universe*> universes);
+
+private:
+    bool m_timecodeChase;
+    quint32 m_timecodeOffset;
+    /** The timecode relocations counted when the show time was last moved */
+    quint32 m_timecodeRelocations;
+
     /*************************************************************************
      * Attributes
      *************************************************************************/
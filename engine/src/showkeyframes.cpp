@@ -0,0 +1,215 @@
+/*
+  Q Light Controller Plus
+  showkeyframes.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QDebug>
+
+#include "showkeyframes.h"
+#include "universe.h"
+
+/** Size of a range header: a 16 bit offset and a 16 bit length */
+#define DELTA_HEADER_SIZE 4
+
+ShowKeyframes::ShowKeyframes(quint32 interval)
+    : m_interval(interval == 0 ? SHOW_KEYFRAME_INTERVAL : interval)
+    , m_nextIndex(0)
+    , m_lastIndex(-1)
+{
+}
+
+ShowKeyframes::~ShowKeyframes()
+{
+}
+
+quint32 ShowKeyframes::interval() const
+{
+    return m_interval;
+}
+
+int ShowKeyframes::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frames.count();
+}
+
+void ShowKeyframes::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_frames.clear();
+    m_lastValues.clear();
+    m_lastIndex = -1;
+    m_nextIndex = 0;
+}
+
+void ShowKeyframes::startRun(quint32 time)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // at time 0 nothing has been played yet, so the current
+    // output is exactly what the Show starts from
+    m_nextIndex = time == 0 ? 0 : int(time / m_interval) + 1;
+}
+
+bool ShowKeyframes::record(quint32 time, const QList<Universe *> &universes)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int index = int(time / m_interval);
+
+    if (index < m_nextIndex)
+        return false;
+
+    m_nextIndex = index + 1;
+
+    // keyframes must form a contiguous chain, since each one
+    // is encoded against the previous one
+    if (index > m_frames.count())
+        return false;
+
+    QHash<quint32, QByteArray> previous;
+    if (index > 0)
+        previous = (m_lastIndex == index - 1) ? m_lastValues : valuesAt(index - 1);
+
+    QHash<quint32, QByteArray> current;
+    QHash<quint32, QByteArray> frame;
+
+    foreach (Universe *universe, universes)
+    {
+        if (universe == NULL)
+            continue;
+
+        QByteArray data = universe->preGMValues();
+        QByteArray delta = encodeDelta(previous.value(universe->id()), data);
+        if (delta.isEmpty() == false)
+            frame[universe->id()] = delta;
+        current[universe->id()] = data;
+    }
+
+    // the keyframes after this one were encoded against
+    // the old content of this one, so they are dropped
+    m_frames.resize(index);
+    m_frames.append(frame);
+    m_lastValues = current;
+    m_lastIndex = index;
+
+    return true;
+}
+
+QHash<quint32, QByteArray> ShowKeyframes::values(quint32 time) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_frames.isEmpty())
+        return QHash<quint32, QByteArray>();
+
+    int index = qMin(int(time / m_interval), m_frames.count() - 1);
+
+    if (index == m_lastIndex)
+        return m_lastValues;
+
+    return valuesAt(index);
+}
+
+QHash<quint32, QByteArray> ShowKeyframes::valuesAt(int index) const
+{
+    QHash<quint32, QByteArray> values;
+
+    for (int i = 0; i <= index && i < m_frames.count(); i++)
+    {
+        QHashIterator<quint32, QByteArray> it(m_frames.at(i));
+        while (it.hasNext())
+        {
+            it.next();
+            applyDelta(values[it.key()], it.value());
+        }
+    }
+
+    return values;
+}
+
+QByteArray ShowKeyframes::encodeDelta(const QByteArray &from, const QByteArray &to)
+{
+    QByteArray delta;
+    int size = to.size();
+    int i = 0;
+
+    while (i < size)
+    {
+        // values missing in $from are considered to be zero
+        if (i < from.size() ? from.at(i) == to.at(i) : to.at(i) == 0)
+        {
+            i++;
+            continue;
+        }
+
+        int start = i;
+        int end = i + 1;
+        int gap = 0;
+
+        // merge ranges separated by less than a header
+        for (i = end; i < size && gap < DELTA_HEADER_SIZE; i++)
+        {
+            if (i < from.size() ? from.at(i) == to.at(i) : to.at(i) == 0)
+            {
+                gap++;
+            }
+            else
+            {
+                gap = 0;
+                end = i + 1;
+            }
+        }
+
+        int length = end - start;
+        delta.append(char((start >> 8) & 0xFF));
+        delta.append(char(start & 0xFF));
+        delta.append(char((length >> 8) & 0xFF));
+        delta.append(char(length & 0xFF));
+        delta.append(to.constData() + start, length);
+
+        i = end;
+    }
+
+    return delta;
+}
+
+void ShowKeyframes::applyDelta(QByteArray &values, const QByteArray &delta)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(delta.constData());
+    int pos = 0;
+
+    while (pos + DELTA_HEADER_SIZE <= delta.size())
+    {
+        int start = (data[pos] << 8) | data[pos + 1];
+        int length = (data[pos + 2] << 8) | data[pos + 3];
+        pos += DELTA_HEADER_SIZE;
+
+        if (pos + length > delta.size())
+        {
+            qWarning() << Q_FUNC_INFO << "Truncated keyframe data";
+            return;
+        }
+
+        if (values.size() < start + length)
+            values.append(QByteArray(start + length - values.size(), char(0)));
+
+        memcpy(values.data() + start, data + pos, length);
+        pos += length;
+    }
+}
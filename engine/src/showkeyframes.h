@@ -0,0 +1,117 @@
+/*
+  Q Light Controller Plus
+  showkeyframes.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SHOWKEYFRAMES_H
+#define SHOWKEYFRAMES_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+
+class Universe;
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+/** Time in milliseconds between two consecutive keyframes */
+#define SHOW_KEYFRAME_INTERVAL 2000
+
+/**
+ * ShowKeyframes records the DMX output of a Show at regular intervals while
+ * it plays, so that when the Show is started again from an arbitrary time,
+ * the output can be restored from the nearest keyframe instead of waiting
+ * for the restarted Functions to rebuild it.
+ *
+ * Each keyframe stores, for every universe, only the channel ranges that
+ * changed since the previous keyframe. Keyframes are recorded as a
+ * contiguous chain starting at time 0: playing a Show again overwrites the
+ * keyframes it passes through, so edits to the Show are picked up on the
+ * next playback.
+ */
+class ShowKeyframes
+{
+public:
+    ShowKeyframes(quint32 interval = SHOW_KEYFRAME_INTERVAL);
+    ~ShowKeyframes();
+
+    /** Get the time between two consecutive keyframes */
+    quint32 interval() const;
+
+    /** Get the number of keyframes recorded so far */
+    int count() const;
+
+    /** Discard all the recorded keyframes */
+    void clear();
+
+    /**
+     * Prepare for a playback starting at $time. The keyframe at $time and
+     * the previous ones are not recorded again, since the output at that
+     * moment is not yet the one of the Show.
+     */
+    void startRun(quint32 time);
+
+    /**
+     * Record the values of $universes as the keyframe of the interval
+     * $time belongs to, if it has not been recorded during this run yet.
+     *
+     * @return true if a keyframe has been recorded
+     */
+    bool record(quint32 time, const QList<Universe *> &universes);
+
+    /**
+     * Rebuild the universe values of the last keyframe at or before $time.
+     *
+     * @return a map of universe IDs and their values, empty if no keyframe
+     *         is available
+     */
+    QHash<quint32, QByteArray> values(quint32 time) const;
+
+private:
+    /** Return the values of the keyframe at $index.
+     *  Must be called with m_mutex locked */
+    QHash<quint32, QByteArray> valuesAt(int index) const;
+
+    /** Encode the ranges of $to which differ from $from */
+    static QByteArray encodeDelta(const QByteArray &from, const QByteArray &to);
+
+    /** Apply the ranges encoded in $delta to $values */
+    static void applyDelta(QByteArray &values, const QByteArray &delta);
+
+private:
+    quint32 m_interval;
+
+    /** For each keyframe, the encoded changes of every universe */
+    QVector<QHash<quint32, QByteArray> > m_frames;
+
+    /** Index of the first keyframe that can be recorded during this run */
+    int m_nextIndex;
+
+    /** Values of the last recorded keyframe, to encode the following one */
+    QHash<quint32, QByteArray> m_lastValues;
+    int m_lastIndex;
+
+    mutable QMutex m_mutex;
+};
+
+/** @} */
+
+#endif
@@ -34,6 +34,10 @@
 
 #define TIMER_INTERVAL 50
 
+/** Show/audio or show/timecode drift in milliseconds beyond which
+ *  the show time is moved at once, instead of being slowly corrected */
+#define AUDIO_SYNC_RESYNC_THRESHOLD 500
+
 static bool compareShowFunctions(const ShowFunction *sf1, const ShowFunction *sf2)
 {
     if (sf1->startTime() < sf2->startTime())
@@ -41,12 +45,20 @@ static bool compareShowFunctions(const ShowFunction *sf1, const ShowFunction *sf
     return false;
 }
 
+static bool compareStopTimes(const QPair<Function *, quint32> &f1, const QPair<Function *, quint32> &f2)
+{
+    return f1.second < f2.second;
+}
+
 ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
     : QObject(NULL)
     , m_doc(doc)
     , m_elapsedTime(startTime)
     , m_totalRunTime(0)
     , m_currentFunctionIndex(0)
+    , m_chaseTime(-1)
+    , m_syncAudio(NULL)
+    , m_syncStartTime(0)
 {
     Q_ASSERT(m_doc != NULL);
     Q_ASSERT(showID != Show::invalidId());
@@ -76,6 +88,7 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
                 continue;
 
             m_functions.append(sfunc);
+            m_functionTracks[sfunc] = track->id();
 
             if (sfunc->startTime() + sfunc->duration(m_doc) > m_totalRunTime)
                 m_totalRunTime = sfunc->startTime() + sfunc->duration(m_doc);
@@ -119,6 +132,7 @@ void ShowRunner::stop()
 {
     m_elapsedTime = 0;
     m_currentFunctionIndex = 0;
+    m_syncAudio = NULL;
     for (int i = 0; i < m_runningQueue.count(); i++)
     {
         Function *f = m_runningQueue.at(i).first;
@@ -129,6 +143,11 @@ void ShowRunner::stop()
     qDebug() << "ShowRunner stopped";
 }
 
+quint32 ShowRunner::elapsedTime() const
+{
+    return m_elapsedTime;
+}
+
 FunctionParent ShowRunner::functionParent() const
 {
     return FunctionParent(FunctionParent::Function, m_show->id());
@@ -161,19 +180,24 @@ void ShowRunner::write()
         }
         if (m_elapsedTime >= funcStartTime)
         {
-            foreach (Track *track, m_show->tracks())
-            {
-                if (track->showFunctions().contains(sf))
-                {
-                    int intOverrideId = f->requestAttributeOverride(Function::Intensity, m_intensityMap[track->id()]);
-                    //f->adjustAttribute(m_intensityMap[track->id()], Function::Intensity);
-                    sf->setIntensityOverrideId(intOverrideId);
-                    break;
-                }
-            }
+            quint32 trackID = m_functionTracks.value(sf);
+            int intOverrideId = f->requestAttributeOverride(Function::Intensity, m_intensityMap[trackID]);
+            //f->adjustAttribute(m_intensityMap[trackID], Function::Intensity);
+            sf->setIntensityOverrideId(intOverrideId);
 
             f->start(m_doc->masterTimer(), functionParent(), functionTimeOffset);
-            m_runningQueue.append(QPair<Function *, quint32>(f, sf->startTime() + sf->duration(m_doc)));
+
+            // keep the queue ordered by stop time
+            QPair<Function *, quint32> running(f, sf->startTime() + sf->duration(m_doc));
+            m_runningQueue.insert(std::upper_bound(m_runningQueue.begin(), m_runningQueue.end(),
+                                                   running, compareStopTimes), running);
+
+            // follow the first audio track being played
+            if (m_syncAudio == NULL && f->type() == Function::AudioType)
+            {
+                m_syncAudio = qobject_cast<Audio *>(f);
+                m_syncStartTime = sf->startTime();
+            }
             m_currentFunctionIndex++;
         }
         else
@@ -181,22 +205,18 @@ void ShowRunner::write()
     }
 
     // Phase 2. Check if we need to stop some running Functions
-    // It is done in reverse order for two reasons:
-    // 1- m_runningQueue is not ordered by stop time
-    // 2- to avoid messing up with indices when an entry is removed
-    for(int i = m_runningQueue.count() - 1; i >= 0; i--)
+    // m_runningQueue is ordered by stop time, so this phase is over
+    // at the first Function whose stop time has not been reached yet
+    while (m_runningQueue.isEmpty() == false &&
+           m_elapsedTime >= m_runningQueue.first().second)
     {
-        Function *func = m_runningQueue.at(i).first;
-        quint32 stopTime = m_runningQueue.at(i).second;
+        Function *func = m_runningQueue.takeFirst().first;
 
-        // if we passed the function stop time
-        if (m_elapsedTime >= stopTime)
-        {
-            // stop the function
-            func->stop(functionParent());
-            // remove it from the running queue
-            m_runningQueue.removeAt(i);
-        }
+        if (func == m_syncAudio)
+            m_syncAudio = NULL;
+
+        // stop the function
+        func->stop(functionParent());
     }
 
     // Phase 3. Check if this is the end of the Show
@@ -208,10 +228,51 @@ void ShowRunner::write()
         return;
     }
 
-    m_elapsedTime += MasterTimer::tick();
+    m_elapsedTime = nextElapsedTime();
     emit timeChanged(m_elapsedTime);
 }
 
+/************************************************************************
+ * Audio synchronization
+ ************************************************************************/
+
+void ShowRunner::setChaseTime(qint64 time)
+{
+    m_chaseTime = time;
+}
+
+quint32 ShowRunner::nextElapsedTime()
+{
+    qint64 tick = MasterTimer::tick();
+    qint64 next = qint64(m_elapsedTime) + tick;
+
+    // the show time matching what is heard or chased at this tick
+    qint64 syncTime = m_chaseTime;
+    m_chaseTime = -1;
+
+    if (syncTime < 0 && m_syncAudio != NULL)
+    {
+        qint64 audioTime = m_syncAudio->playbackTime();
+        if (audioTime >= 0)
+            syncTime = qint64(m_syncStartTime) + audioTime;
+    }
+
+    if (syncTime < 0)
+        return quint32(next);
+
+    // where the show should be at the next tick
+    qint64 drift = syncTime + tick - next;
+
+    if (drift > AUDIO_SYNC_RESYNC_THRESHOLD)
+        return quint32(next + drift);
+
+    // slew the show time by up to half a tick, never going backwards,
+    // so that functions ahead are neither skipped nor started twice
+    qint64 correction = qBound(-tick, drift / 2, tick / 2);
+
+    return quint32(next + correction);
+}
+
 /************************************************************************
  * Intensity
  ************************************************************************/
@@ -22,12 +22,14 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QHash>
 #include <QMap>
 
 #include <function.h>
 
 class ShowFunction;
 class Function;
+class Audio;
 class Track;
 class Show;
 class Doc;
@@ -55,6 +57,9 @@ public:
 
     void write();
 
+    /** Get the show time of the next write */
+    quint32 elapsedTime() const;
+
 private:
     const Doc* m_doc;
 
@@ -70,7 +75,12 @@ private:
     /** Total time the runner has to run */
     quint32 m_totalRunTime;
 
-    /** List of the currently running Functions and their stop time */
+    /** The ID of the Track of each item in m_functions */
+    QHash <ShowFunction *, quint32> m_functionTracks;
+
+    /** List of the currently running Functions and their stop time,
+     *  ordered by stop time, so that only the Functions due to stop
+     *  are visited on each tick */
     QList < QPair<Function *, quint32> > m_runningQueue;
 
     /** Index of the item in m_functions to be considered for playback */
@@ -79,6 +89,32 @@ private:
 private:
     FunctionParent functionParent() const;
 
+    /*************************************************************************
+     * Audio synchronization
+     *************************************************************************/
+public:
+    /** Make the next show time follow $time, the position of an external
+     *  timecode at the current tick. It takes the place of the audio track */
+    void setChaseTime(qint64 time);
+
+private:
+    /**
+     * Return the show time of the next tick, corrected to follow the
+     * chased timecode or the playback position of the audio track, which
+     * lags behind the master timer by the output latency and drifts with
+     * its clock
+     */
+    quint32 nextElapsedTime();
+
+private:
+    /** The timecode position set for the current tick, -1 if none */
+    qint64 m_chaseTime;
+    /** The audio function the show time follows, if any */
+    Audio *m_syncAudio;
+
+    /** The show time at which m_syncAudio starts */
+    quint32 m_syncStartTime;
+
 signals:
     void timeChanged(quint32 time);
     void showFinished();
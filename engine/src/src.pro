@@ -10,7 +10,7 @@ TARGET   = qlcplusengine
 
 QT      += core gui
 greaterThan(QT_MAJOR_VERSION, 4) {
-  QT += multimedia
+  QT += multimedia concurrent
   macx:QT_CONFIG -= no-pkg-config
   win32:QT += widgets
 }
@@ -52,20 +52,23 @@ HEADERS += avolitesd4parser.h \
            qlcfixturehead.h \
            qlcfixturemode.h \
            qlci18n.h \
+           qlcimagecache.h \
            qlcinputchannel.h \
            qlcinputprofile.h \
            qlcinputsource.h \
            qlcmodifierscache.h \
            qlcpalette.h \
            qlcphysical.h \
+           qlcstringpool.h \
            utils.h
 
 greaterThan(QT_MAJOR_VERSION, 4) {
-  HEADERS += video.h
+  HEADERS += rgbvideo.h video.h
 }
 
 # Engine
-HEADERS += bus.h \
+HEADERS += beattracker.h \
+           bus.h \
            channelsgroup.h \
            channelmodifier.h \
            chaser.h \
@@ -77,10 +80,16 @@ HEADERS += bus.h \
            cuestack.h \
            doc.h \
            dmxdumpfactoryproperties.h \
+           dmxrecorder.h \
+           dmxrecording.h \
+           dmxrecordingfile.h \
            dmxsource.h \
            efx.h \
            efxfixture.h \
+           enginelog.h \
            fadechannel.h \
+           fadecurve.h \
+           feedbackqueue.h \
            fixture.h \
            fixturegroup.h \
            function.h \
@@ -93,8 +102,11 @@ HEADERS += bus.h \
            inputpatch.h \
            ioplugincache.h \
            keypadparser.h \
+           latencytracer.h \
+           loadgovernor.h \
            mastertimer.h \
            monitorproperties.h \
+           offlinerenderer.h \
            outputpatch.h \
            qlcclipboard.h \
            qlcpoint.h \
@@ -109,12 +121,18 @@ HEADERS += bus.h \
            scene.h \
            scenevalue.h \
            scriptwrapper.h \
+           searchindex.h \
            sequence.h \
            show.h \
            showfunction.h \
+           showkeyframes.h \
            showrunner.h \
+           ticktrace.h \
+           timecodetracker.h \
            track.h \
-           universe.h
+           universe.h \
+           universepool.h \
+           workspacecache.h
 
 qmlui {
   HEADERS += rgbscriptv4.h scriptrunner.h scriptv4.h
@@ -135,19 +153,22 @@ SOURCES += avolitesd4parser.cpp \
            qlcfixturehead.cpp \
            qlcfixturemode.cpp \
            qlci18n.cpp \
+           qlcimagecache.cpp \
            qlcinputchannel.cpp \
            qlcinputprofile.cpp \
            qlcinputsource.cpp \
            qlcmodifierscache.cpp \
            qlcpalette.cpp \
-           qlcphysical.cpp
+           qlcphysical.cpp \
+           qlcstringpool.cpp
 
 greaterThan(QT_MAJOR_VERSION, 4) {
-  SOURCES += video.cpp
+  SOURCES += rgbvideo.cpp video.cpp
 }
 
 # Engine
-SOURCES += bus.cpp \
+SOURCES += beattracker.cpp \
+           bus.cpp \
            channelsgroup.cpp \
            channelmodifier.cpp \
            chaser.cpp \
@@ -158,9 +179,15 @@ SOURCES += bus.cpp \
            cuestack.cpp \
            doc.cpp \
            dmxdumpfactoryproperties.cpp \
+           dmxrecorder.cpp \
+           dmxrecording.cpp \
+           dmxrecordingfile.cpp \
            efx.cpp \
            efxfixture.cpp \
+           enginelog.cpp \
            fadechannel.cpp \
+           fadecurve.cpp \
+           feedbackqueue.cpp \
            fixture.cpp \
            fixturegroup.cpp \
            function.cpp \
@@ -173,8 +200,11 @@ SOURCES += bus.cpp \
            inputpatch.cpp \
            ioplugincache.cpp \
            keypadparser.cpp \
+           latencytracer.cpp \
+           loadgovernor.cpp \
            mastertimer.cpp \
            monitorproperties.cpp \
+           offlinerenderer.cpp \
            outputpatch.cpp \
            qlcclipboard.cpp \
            qlcpoint.cpp \
@@ -187,12 +217,18 @@ SOURCES += bus.cpp \
            rgbtext.cpp \
            scene.cpp \
            scenevalue.cpp \
+           searchindex.cpp \
            sequence.cpp \
            show.cpp \
            showfunction.cpp \
+           showkeyframes.cpp \
            showrunner.cpp \
+           ticktrace.cpp \
+           timecodetracker.cpp \
            track.cpp \
-           universe.cpp
+           universe.cpp \
+           universepool.cpp \
+           workspacecache.cpp
 
 qmlui {
   SOURCES += rgbscriptv4.cpp scriptrunner.cpp scriptv4.cpp
@@ -0,0 +1,204 @@
+/*
+  Q Light Controller Plus
+  ticktrace.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QThreadStorage>
+#include <QThread>
+#include <QDebug>
+#include <QFile>
+
+#include "ticktrace.h"
+
+struct TraceEvent
+{
+    const char *name;
+    quint32 arg;
+    qint64 start;
+    qint64 duration;
+};
+
+/** The events of a thread. Only that thread writes them */
+struct ThreadBuffer
+{
+    QString name;
+    TraceEvent events[TICKTRACE_BUFFER_SIZE];
+    /** Number of events written so far, wrapping around the buffer */
+    QAtomicInt count;
+};
+
+QAtomicInt TickTrace::s_enabled(0);
+
+/* The buffers live as long as the process, so the events of the threads
+   that have already finished can still be dumped */
+static QAtomicPointer<ThreadBuffer> s_buffers[TICKTRACE_MAX_THREADS];
+static QAtomicInt s_threadCount(0);
+
+/** Index of the buffer of each thread, -1 when there are too many threads */
+static QThreadStorage<int> s_threadIndex;
+
+static QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+qint64 TickTrace::now()
+{
+    static const QElapsedTimer clock = startedClock();
+
+    return clock.nsecsElapsed();
+}
+
+static ThreadBuffer *threadBuffer()
+{
+    if (s_threadIndex.hasLocalData())
+    {
+        int index = s_threadIndex.localData();
+        return index < 0 ? NULL : s_buffers[index].loadAcquire();
+    }
+
+    int index = s_threadCount.fetchAndAddOrdered(1);
+    if (index >= TICKTRACE_MAX_THREADS)
+    {
+        qWarning() << "[TickTrace] Too many threads, not tracing" << QThread::currentThread();
+        s_threadIndex.setLocalData(-1);
+        return NULL;
+    }
+
+    ThreadBuffer *buffer = new ThreadBuffer;
+    QThread *thread = QThread::currentThread();
+    buffer->name = thread->objectName();
+    if (buffer->name.isEmpty())
+        buffer->name = QString("%1 %2").arg(thread->metaObject()->className()).arg(index);
+
+    s_buffers[index].storeRelease(buffer);
+    s_threadIndex.setLocalData(index);
+
+    return buffer;
+}
+
+void TickTrace::record(const char *name, quint32 arg, qint64 start, qint64 end)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    if (buffer == NULL)
+        return;
+
+    uint count = uint(buffer->count.loadAcquire());
+    TraceEvent &event = buffer->events[count % TICKTRACE_BUFFER_SIZE];
+    event.name = name;
+    event.arg = arg;
+    event.start = start;
+    event.duration = end - start;
+
+    buffer->count.storeRelease(int(count + 1));
+}
+
+void TickTrace::setEnabled(bool enable)
+{
+    if (enable && isEnabled() == false)
+    {
+        for (int i = 0; i < TICKTRACE_MAX_THREADS; i++)
+        {
+            ThreadBuffer *buffer = s_buffers[i].loadAcquire();
+            if (buffer != NULL)
+                buffer->count.storeRelease(0);
+        }
+    }
+
+    s_enabled.storeRelease(enable ? 1 : 0);
+}
+
+static QByteArray escapeJSON(QString str)
+{
+    str.replace("\\", "\\\\");
+    str.replace("\"", "\\\"");
+    return str.toUtf8();
+}
+
+static QByteArray microseconds(qint64 ns)
+{
+    return QByteArray::number(double(ns) / 1000.0, 'f', 3);
+}
+
+QByteArray TickTrace::toJSON()
+{
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+
+    for (int i = 0; i < TICKTRACE_MAX_THREADS; i++)
+    {
+        ThreadBuffer *buffer = s_buffers[i].loadAcquire();
+        if (buffer == NULL)
+            continue;
+
+        uint count = uint(buffer->count.loadAcquire());
+        uint start = count > TICKTRACE_BUFFER_SIZE ? count - TICKTRACE_BUFFER_SIZE : 0;
+        QByteArray tid = QByteArray::number(i);
+
+        if (first == false)
+            json.append(",\n");
+        first = false;
+
+        json.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        json.append(tid);
+        json.append(",\"args\":{\"name\":\"");
+        json.append(escapeJSON(buffer->name));
+        json.append("\"}}");
+
+        for (uint e = start; e < count; e++)
+        {
+            const TraceEvent &event = buffer->events[e % TICKTRACE_BUFFER_SIZE];
+
+            json.append(",\n{\"name\":\"");
+            json.append(event.name);
+            json.append("\",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            json.append(tid);
+            json.append(",\"ts\":");
+            json.append(microseconds(event.start));
+            json.append(",\"dur\":");
+            json.append(microseconds(event.duration));
+            if (event.arg != UINT_MAX)
+            {
+                json.append(",\"args\":{\"id\":");
+                json.append(QByteArray::number(event.arg));
+                json.append("}");
+            }
+            json.append("}");
+        }
+    }
+
+    json.append("\n]}\n");
+
+    return json;
+}
+
+bool TickTrace::save(const QString &fileName)
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to write" << fileName;
+        return false;
+    }
+
+    QByteArray json = toJSON();
+    return file.write(json) == json.size();
+}
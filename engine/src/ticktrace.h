@@ -0,0 +1,105 @@
+/*
+  Q Light Controller Plus
+  ticktrace.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TICKTRACE_H
+#define TICKTRACE_H
+
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QString>
+#include <climits>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Number of events kept for each thread. Older events are overwritten */
+#define TICKTRACE_BUFFER_SIZE 65536
+
+/** Number of threads that can be traced */
+#define TICKTRACE_MAX_THREADS 64
+
+/**
+ * TickTrace records how long the engine spends in each step of a tick,
+ * to find out what makes a tick late, and exports the events in the
+ * Chrome trace event format, to be opened with chrome://tracing or
+ * Perfetto.
+ *
+ * Traced code is wrapped in a TICK_TRACE scope. Each thread writes its
+ * events into its own ring buffer, so recording takes no lock. When
+ * tracing is disabled, a scope costs a single atomic read.
+ */
+class TickTrace
+{
+public:
+    /** Start or stop recording the events. Starting clears the old ones */
+    static void setEnabled(bool enable);
+
+    /** Return true if the events are being recorded */
+    static inline bool isEnabled()
+    {
+        return s_enabled.loadAcquire() != 0;
+    }
+
+    /** Return the events recorded so far, as Chrome trace event JSON */
+    static QByteArray toJSON();
+
+    /** Write the events recorded so far to $fileName, as toJSON() */
+    static bool save(const QString& fileName);
+
+    /** Return the nanoseconds elapsed on the tracing clock */
+    static qint64 now();
+
+    /** Record an event of the calling thread */
+    static void record(const char *name, quint32 arg, qint64 start, qint64 end);
+
+    /** Records the lifetime of its instance, if tracing is enabled */
+    class Scope
+    {
+    public:
+        /** $name must be a string literal. $arg is an optional ID */
+        inline Scope(const char *name, quint32 arg = UINT_MAX)
+            : m_name(name)
+            , m_arg(arg)
+            , m_start(isEnabled() ? now() : -1)
+        {
+        }
+
+        inline ~Scope()
+        {
+            if (m_start >= 0)
+                record(m_name, m_arg, m_start, now());
+        }
+
+    private:
+        const char *m_name;
+        quint32 m_arg;
+        qint64 m_start;
+    };
+
+private:
+    static QAtomicInt s_enabled;
+};
+
+#define TICK_TRACE(name) TickTrace::Scope tickTraceScope(name)
+#define TICK_TRACE_ARG(name, arg) TickTrace::Scope tickTraceScope(name, arg)
+
+/** @} */
+
+#endif
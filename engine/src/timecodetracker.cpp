@@ -0,0 +1,122 @@
+/*
+  Q Light Controller Plus
+  timecodetracker.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <qmath.h>
+
+#include "timecodetracker.h"
+
+/** The error of a frame beyond which the timecode is relocated, in ms */
+#define TIMECODE_RELOCATE_THRESHOLD 200
+/** The time without frames after which the position freewheels, in ms */
+#define TIMECODE_DROPOUT_TIME 150
+/** The time without frames after which the timecode is stopped, in ms */
+#define TIMECODE_FREEWHEEL_TIME 2000
+/** The loop gain applied to the error of each frame */
+#define TIMECODE_JITTER_GAIN 0.25
+
+TimecodeTracker::TimecodeTracker()
+    : m_relocations(0)
+{
+    reset();
+}
+
+TimecodeTracker::~TimecodeTracker()
+{
+}
+
+void TimecodeTracker::reset()
+{
+    m_valid = false;
+    m_anchorPosition = 0;
+    m_anchorTime = 0;
+    m_lastFrame = 0;
+}
+
+bool TimecodeTracker::addTimecode(qint64 position, qint64 timestamp)
+{
+    // a stopped timecode is located again on its first frame
+    bool follow = state(timestamp) != Stopped;
+
+    if (follow)
+    {
+        double predicted = m_anchorPosition + double(timestamp - m_anchorTime);
+        double error = double(position) - predicted;
+        if (qAbs(error) > TIMECODE_RELOCATE_THRESHOLD)
+            follow = false;
+        else
+            m_anchorPosition = predicted + error * TIMECODE_JITTER_GAIN;
+    }
+
+    if (follow == false)
+    {
+        m_anchorPosition = position;
+        m_relocations++;
+    }
+
+    m_valid = true;
+    m_anchorTime = timestamp;
+    m_lastFrame = timestamp;
+
+    return follow;
+}
+
+TimecodeTracker::State TimecodeTracker::state(qint64 timestamp) const
+{
+    if (m_valid == false)
+        return Stopped;
+
+    qint64 silence = timestamp - m_lastFrame;
+    if (silence <= TIMECODE_DROPOUT_TIME)
+        return Locked;
+    if (silence <= TIMECODE_FREEWHEEL_TIME)
+        return Freewheeling;
+
+    return Stopped;
+}
+
+qint64 TimecodeTracker::position(qint64 timestamp) const
+{
+    if (state(timestamp) == Stopped)
+        return -1;
+
+    return qMax(qint64(0), qint64(qRound64(m_anchorPosition + double(timestamp - m_anchorTime))));
+}
+
+quint32 TimecodeTracker::relocations() const
+{
+    return m_relocations;
+}
+
+qint64 TimecodeTracker::timecodeToMsecs(int hours, int minutes, int seconds, int frames,
+                                        int fps, bool dropFrame)
+{
+    if (fps <= 0)
+        return 0;
+
+    qint64 totalSeconds = (qint64(hours) * 60 + minutes) * 60 + seconds;
+
+    if (dropFrame == false)
+        return totalSeconds * 1000 + (frames * 1000) / fps;
+
+    // two frame numbers are dropped every minute, except every tenth one
+    qint64 totalMinutes = qint64(hours) * 60 + minutes;
+    qint64 frameNumber = totalSeconds * 30 + frames - 2 * (totalMinutes - totalMinutes / 10);
+
+    return (frameNumber * 1001) / 30;
+}
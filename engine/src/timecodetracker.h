@@ -0,0 +1,93 @@
+/*
+  Q Light Controller Plus
+  timecodetracker.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TIMECODETRACKER_H
+#define TIMECODETRACKER_H
+
+#include <QtGlobal>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * TimecodeTracker follows the position of an external timecode, like
+ * MIDI Timecode or LTC, whose frames are received with some jitter.
+ *
+ * Between two frames the position runs on the local clock. A received
+ * frame close to the predicted position only nudges it, so the jitter of
+ * the delivery is filtered out. A frame far from the prediction means
+ * that the timecode has been relocated, and the position jumps to it.
+ * When the frames stop arriving, the position freewheels on the local
+ * clock for a while, so a short dropout is not noticed, then the
+ * timecode is considered stopped.
+ *
+ * Positions and timestamps are in milliseconds. Timestamps come from
+ * any monotonic clock.
+ */
+class TimecodeTracker
+{
+public:
+    TimecodeTracker();
+    ~TimecodeTracker();
+
+    enum State
+    {
+        Stopped,        //! No timecode is being received
+        Locked,         //! Timecode frames are being received
+        Freewheeling    //! The frames stopped recently, the position runs on
+    };
+
+    /** Forget every frame received so far */
+    void reset();
+
+    /** Process a frame at $position received at $timestamp. Return false
+     *  if the frame relocated the timecode instead of following it */
+    bool addTimecode(qint64 position, qint64 timestamp);
+
+    /** Return the state of the timecode at $timestamp */
+    State state(qint64 timestamp) const;
+
+    /** Return the estimated position at $timestamp, or -1 when stopped */
+    qint64 position(qint64 timestamp) const;
+
+    /** Return the number of times the timecode has been relocated,
+     *  the first lock included */
+    quint32 relocations() const;
+
+    /** Convert a timecode to milliseconds. $fps is the nominal frame rate
+     *  and $dropFrame tells if it is the 29.97 fps drop frame timecode,
+     *  counted at 30 fps with frame numbers skipped */
+    static qint64 timecodeToMsecs(int hours, int minutes, int seconds, int frames,
+                                  int fps, bool dropFrame);
+
+private:
+    /** True when a frame has been received since the last reset */
+    bool m_valid;
+    /** The estimated position at m_anchorTime */
+    double m_anchorPosition;
+    qint64 m_anchorTime;
+    /** The timestamp of the last received frame */
+    qint64 m_lastFrame;
+    quint32 m_relocations;
+};
+
+/** @} */
+
+#endif
@@ -19,39 +19,68 @@
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtAlgorithms>
 #include <QDebug>
 #include <math.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "channelmodifier.h"
 #include "inputoutputmap.h"
+#include "latencytracer.h"
 #include "genericfader.h"
+#include "enginelog.h"
+#include "fadechannel.h"
 #include "qlcioplugin.h"
 #include "outputpatch.h"
 #include "grandmaster.h"
 #include "mastertimer.h"
 #include "inputpatch.h"
 #include "qlcmacros.h"
+#include "ticktrace.h"
 #include "universe.h"
 #include "qlcfile.h"
 #include "utils.h"
 
 #define RELATIVE_ZERO 127
 
+/** The maximum number of idle faders kept for recycling */
+#define FADERS_POOL_SIZE 64
+
+/** The maximum number of times a universe processes chained inputs
+ *  between two ticks */
+#define UNIVERSE_MAX_INPUT_PASSES 4
+
 #define KXMLUniverseNormalBlend "Normal"
 #define KXMLUniverseMaskBlend "Mask"
 #define KXMLUniverseAdditiveBlend "Additive"
 #define KXMLUniverseSubtractiveBlend "Subtractive"
 
+#define KXMLUniverseHTPMerge "HTP"
+#define KXMLUniverseLTPMerge "LTP"
+#define KXMLUniverseInputMerge "Input"
+
 Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     : QThread(parent)
     , m_id(id)
     , m_grandMaster(gm)
     , m_passthrough(false)
     , m_monitor(false)
+    , m_rendered(true)
+    , m_passthroughMerge(HTPMerge)
     , m_inputPatch(NULL)
     , m_fbPatch(NULL)
     , m_channelsMask(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_modifiedZeroValues(new QByteArray(UNIVERSE_SIZE, char(0)))
+    , m_frameIndex(0)
+    , m_latencyTracer(NULL)
+    , m_idleFrame(false)
+    , m_frameDirty(0)
+    , m_faderCommands(NULL)
     , m_usedChannels(0)
     , m_totalChannels(0)
     , m_totalChannelsChanged(false)
@@ -59,10 +88,18 @@ Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     , m_preGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_postGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_lastPostGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
+    , m_changedStart(0)
+    , m_changedCount(0)
     , m_passthroughValues()
+    , m_passthroughOutput()
+    , m_passthroughReceived()
+    , m_passthroughOwned()
+    , m_passthroughEngineValues()
 {
-    m_relativeValues.fill(0, UNIVERSE_SIZE);
-    m_modifiers.fill(NULL, UNIVERSE_SIZE);
+    m_frames[0].reserve(UNIVERSE_SIZE);
+    m_frames[1].reserve(UNIVERSE_SIZE);
+    updateGMValues();
+    m_faderPool = QSharedPointer<GenericFaderPool>(new GenericFaderPool(FADERS_POOL_SIZE));
 
     m_name = QString("Universe %1").arg(id + 1);
 
@@ -91,6 +128,14 @@ Universe::~Universe()
         delete patch;
     }
     delete m_fbPatch;
+
+    FaderCommand *command = m_faderCommands.fetchAndStoreAcquire(NULL);
+    while (command != NULL)
+    {
+        FaderCommand *next = command->next;
+        delete command;
+        command = next;
+    }
 }
 
 void Universe::setName(QString name)
@@ -129,11 +174,38 @@ ushort Universe::totalChannels()
 
 bool Universe::hasChanged()
 {
-    bool changed =
-        memcmp(m_lastPostGMValues->constData(), m_postGMValues->constData(), m_usedChannels) != 0;
-    if (changed)
-        memcpy(m_lastPostGMValues->data(), m_postGMValues->constData(), m_usedChannels);
-    return changed;
+    const uchar *last = reinterpret_cast<const uchar *>(m_lastPostGMValues->constData());
+    const uchar *current = reinterpret_cast<const uchar *>(outputValues()->constData());
+
+    m_changedStart = 0;
+    m_changedCount = 0;
+
+    if (memcmp(last, current, m_usedChannels) == 0)
+        return false;
+
+    int first = 0;
+    while (last[first] == current[first])
+        first++;
+
+    int end = m_usedChannels;
+    while (last[end - 1] == current[end - 1])
+        end--;
+
+    m_changedStart = first;
+    m_changedCount = end - first;
+
+    memcpy(m_lastPostGMValues->data() + first, current + first, m_changedCount);
+    return true;
+}
+
+int Universe::changedStart() const
+{
+    return m_changedStart;
+}
+
+int Universe::changedCount() const
+{
+    return m_changedCount;
 }
 
 void Universe::setPassthrough(bool enable)
@@ -154,9 +226,20 @@ void Universe::setPassthrough(bool enable)
         // true. That way we only have to check for m_passthrough, and do not need to check
         // m_passthroughValues.isNull()
         m_passthroughValues.reset(new QByteArray(UNIVERSE_SIZE, char(0)));
+        m_passthroughOutput.reset(new QByteArray(UNIVERSE_SIZE, char(0)));
+        m_passthroughReceived.reset(new QByteArray(UNIVERSE_SIZE, char(0)));
+        m_passthroughOwned.reset(new QByteArray(UNIVERSE_SIZE, char(0)));
+        m_passthroughEngineValues.reset(new QByteArray(UNIVERSE_SIZE, char(0)));
+    }
+    else if (enable)
+    {
+        // nobody reads the merge state while passthrough is disabled
+        m_passthroughReceived->fill(0);
+        m_passthroughOwned->fill(0);
     }
 
     m_passthrough = enable;
+    m_frameDirty.storeRelease(1);
 
     connectInputPatch();
 
@@ -168,6 +251,45 @@ bool Universe::passthrough() const
     return m_passthrough;
 }
 
+void Universe::setPassthroughMerge(Universe::PassthroughMerge merge)
+{
+    if (merge == m_passthroughMerge)
+        return;
+
+    qDebug() << "Set universe" << id() << "passthrough merge to" << passthroughMergeToString(merge);
+
+    m_passthroughMerge = merge;
+}
+
+Universe::PassthroughMerge Universe::passthroughMerge() const
+{
+    return m_passthroughMerge;
+}
+
+Universe::PassthroughMerge Universe::stringToPassthroughMerge(const QString& str)
+{
+    if (str == KXMLUniverseLTPMerge)
+        return LTPMerge;
+    else if (str == KXMLUniverseInputMerge)
+        return InputMerge;
+
+    return HTPMerge;
+}
+
+QString Universe::passthroughMergeToString(Universe::PassthroughMerge merge)
+{
+    switch (merge)
+    {
+        default:
+        case HTPMerge:
+            return QString(KXMLUniverseHTPMerge);
+        case LTPMerge:
+            return QString(KXMLUniverseLTPMerge);
+        case InputMerge:
+            return QString(KXMLUniverseInputMerge);
+    }
+}
+
 void Universe::setMonitor(bool enable)
 {
     m_monitor = enable;
@@ -178,24 +300,26 @@ bool Universe::monitor() const
     return m_monitor;
 }
 
+void Universe::setRendered(bool enable)
+{
+    m_rendered = enable;
+    m_frameDirty.storeRelease(1);
+}
+
+bool Universe::rendered() const
+{
+    return m_rendered;
+}
+
 void Universe::slotGMValueChanged()
 {
-    {
-        for (int i = 0; i < m_intensityChannels.size(); ++i)
-        {
-            int channel = m_intensityChannels.at(i);
-            updatePostGMValue(channel);
-        }
-    }
+    updateGMValues();
+    m_frameDirty.storeRelease(1);
+
+    updatePostGMValues(m_intensityChannels);
 
     if (m_grandMaster->channelMode() == GrandMaster::AllChannels)
-    {
-        for (int i = 0; i < m_nonIntensityChannels.size(); ++i)
-        {
-            int channel = m_nonIntensityChannels.at(i);
-            updatePostGMValue(channel);
-        }
-    }
+        updatePostGMValues(m_nonIntensityChannels);
 }
 
 /************************************************************************
@@ -204,73 +328,132 @@ void Universe::slotGMValueChanged()
 
 QSharedPointer<GenericFader> Universe::requestFader(Universe::FaderPriority priority)
 {
-    int insertPos = 0;
-    QSharedPointer<GenericFader> fader = QSharedPointer<GenericFader>(new GenericFader());
+    QSharedPointer<GenericFader> fader = GenericFaderPool::acquire(m_faderPool);
     fader->setPriority(priority);
 
-    if (m_faders.isEmpty())
-    {
-        m_faders.append(fader);
-    }
-    else
-    {
-        for (int i = m_faders.count() - 1; i >= 0; i--)
-        {
-            QSharedPointer<GenericFader> f = m_faders.at(i);
-            if (!f.isNull() && f->priority() <= fader->priority())
-            {
-                insertPos = i + 1;
-                break;
-            }
-        }
-
-        m_faders.insert(insertPos, fader);
-    }
-
-    qDebug() << "Generic fader with priority" <<  fader->priority() << "registered at pos" << insertPos << ", count" << m_faders.count();
+    FaderCommand *command = new FaderCommand;
+    command->type = FaderCommand::Add;
+    command->priority = priority;
+    command->fader = fader;
+    queueFaderCommand(command);
 
     return fader;
 }
 
 void Universe::dismissFader(QSharedPointer<GenericFader> fader)
 {
-    int index = m_faders.indexOf(fader);
-    if (index >= 0)
+    if (fader.isNull())
+        return;
+
+    FaderCommand *command = new FaderCommand;
+    command->type = FaderCommand::Remove;
+    command->priority = Auto;
+    command->fader = fader;
+    queueFaderCommand(command);
+}
+
+void Universe::requestFaderPriority(QSharedPointer<GenericFader> fader, Universe::FaderPriority priority)
+{
+    if (fader.isNull())
+        return;
+
+    FaderCommand *command = new FaderCommand;
+    command->type = FaderCommand::Move;
+    command->priority = priority;
+    command->fader = fader;
+    queueFaderCommand(command);
+}
+
+QList<QSharedPointer<GenericFader> > Universe::faders()
+{
+    QMutexLocker locker(&m_fadersMutex);
+    QList<QSharedPointer<GenericFader> > list;
+    for (int p = Auto; p <= SimpleDesk; p++)
+        list.append(m_faders[p]);
+    return list;
+}
+
+void Universe::queueFaderCommand(FaderCommand *command)
+{
+    do
     {
-        m_faders.takeAt(index);
-        fader.clear();
+        command->next = m_faderCommands.loadAcquire();
     }
+    while (m_faderCommands.testAndSetOrdered(command->next, command) == false);
 }
 
-void Universe::requestFaderPriority(QSharedPointer<GenericFader> fader, Universe::FaderPriority priority)
+void Universe::applyFaderCommands()
 {
-    if (m_faders.contains(fader) == false)
+    // the whole stack is taken at once, so there is no ABA problem
+    FaderCommand *command = m_faderCommands.fetchAndStoreAcquire(NULL);
+    if (command == NULL)
         return;
 
-    int pos = m_faders.indexOf(fader);
-    int newPos = 0;
+    // restore the request order
+    FaderCommand *ordered = NULL;
+    while (command != NULL)
+    {
+        FaderCommand *next = command->next;
+        command->next = ordered;
+        ordered = command;
+        command = next;
+    }
 
-    for (int i = m_faders.count() - 1; i >= 0; i--)
+    // removals are collected and each bucket compacted once
+    QSet<GenericFader *> removed[SimpleDesk + 1];
+
+    while (ordered != NULL)
     {
-        QSharedPointer<GenericFader> f = m_faders.at(i);
-        if (!f.isNull() && f->priority() <= priority)
+        command = ordered;
+        ordered = command->next;
+
+        GenericFader *fader = command->fader.data();
+        int bucket = qBound(int(Auto), fader->priority(), int(SimpleDesk));
+
+        switch (command->type)
         {
-            newPos = i;
-            fader->setPriority(priority);
+            case FaderCommand::Add:
+                m_faders[bucket].append(command->fader);
+            break;
+            case FaderCommand::Remove:
+                removed[bucket].insert(fader);
+            break;
+            case FaderCommand::Move:
+            {
+                int newBucket = qBound(int(Auto), int(command->priority), int(SimpleDesk));
+                if (newBucket != bucket && removed[bucket].contains(fader) == false)
+                {
+                    // moving back to a bucket still holding the fader
+                    if (removed[newBucket].remove(fader))
+                        m_faders[newBucket].removeOne(command->fader);
+
+                    removed[bucket].insert(fader);
+                    m_faders[newBucket].append(command->fader);
+                    fader->setPriority(command->priority);
+                    qDebug() << "Generic fader moved from priority" << bucket << "to" << newBucket;
+                }
+            }
             break;
         }
+
+        delete command;
     }
 
-    if (newPos != pos)
+    for (int p = Auto; p <= SimpleDesk; p++)
     {
-        m_faders.move(pos, newPos);
-        qDebug() << "Generic fader moved from" << pos << "to" << m_faders.indexOf(fader) << ". Count:" << m_faders.count();
+        if (removed[p].isEmpty())
+            continue;
+
+        QMutableListIterator<QSharedPointer<GenericFader> > it(m_faders[p]);
+        while (it.hasNext())
+        {
+            if (removed[p].contains(it.next().data()))
+                it.remove();
+        }
     }
-}
 
-QList<QSharedPointer<GenericFader> > Universe::faders()
-{
-    return m_faders;
+    // a change of the faders always composes a new frame
+    m_frameDirty.storeRelease(1);
 }
 
 void Universe::tick()
@@ -280,39 +463,250 @@ void Universe::tick()
 
 void Universe::processFaders()
 {
+    TICK_TRACE_ARG("Universe::processFaders", m_id);
+    QElapsedTimer processTimer;
+    processTimer.start();
+    int fadersCount = 0;
+    int fadeChannelsCount = 0;
+
+    m_processMutex.lock();
+    m_inputPending.storeRelease(0);
+
+    m_fadersMutex.lock();
+    applyFaderCommands();
+    m_fadersMutex.unlock();
+
+    if (m_rendered == false)
+    {
+        m_processMutex.unlock();
+        emit frameDumped();
+        return;
+    }
+
     flushInput();
-    zeroIntensityChannels();
-    zeroRelativeValues();
 
-    QMutableListIterator<QSharedPointer<GenericFader> > it(m_faders);
-    while (it.hasNext())
+    /* A frame rendered by idle faders only stays the same until a fader
+       changes or something else is written to the universe: send it
+       again without composing it */
+    bool dirty = m_frameDirty.fetchAndStoreOrdered(0) != 0;
+    bool externalWrites = m_writesCount.loadAcquire() != 0;
+    if (m_idleFrame && dirty == false && externalWrites == false && m_passthrough == false)
     {
-        QSharedPointer<GenericFader> fader = it.next();
-        if (fader.isNull())
-            continue;
+        m_fadersMutex.lock();
+        bool idle = true;
+        for (int p = Auto; p <= SimpleDesk && idle; p++)
+        {
+            foreach (const QSharedPointer<GenericFader> &fader, m_faders[p])
+            {
+                if (!fader.isNull() && fader->isIdle() == false)
+                {
+                    idle = false;
+                    break;
+                }
+            }
+        }
+        m_fadersMutex.unlock();
 
-        // destroy a fader if it's been requested
-        // and it's not fading out
-        if (fader->deleteRequested() && !fader->isFadingOut())
+        if (idle)
         {
-            fader->removeAll();
-            it.remove();
-            fader.clear();
-            continue;
+            dumpOutput(m_frames[m_frameIndex], 0, 0);
+            emit frameDumped();
+
+            m_statWrites.storeRelease(0);
+            m_statHTPRejects.storeRelease(0);
+            m_statProcessTime.storeRelease(int(processTimer.nsecsElapsed() / 1000));
+
+            m_processMutex.unlock();
+            processPendingInput();
+            return;
         }
+    }
 
-        if (fader->isEnabled() == false)
-            continue;
+    zeroIntensityChannels();
+    zeroRelativeValues();
+
+    // a frame written from outside still has to have its intensity reset
+    bool idleFrame = externalWrites == false && m_passthrough == false;
+
+    m_fadersMutex.lock();
+    for (int p = Auto; p <= SimpleDesk; p++)
+    {
+        QMutableListIterator<QSharedPointer<GenericFader> > it(m_faders[p]);
+        while (it.hasNext())
+        {
+            QSharedPointer<GenericFader> fader = it.next();
+            if (fader.isNull())
+                continue;
+
+            // destroy a fader if it's been requested
+            // and it's not fading out
+            if (fader->deleteRequested() && !fader->isFadingOut())
+            {
+                fader->removeAll();
+                it.remove();
+                fader.clear();
+                idleFrame = false;
+                continue;
+            }
+
+            if (fader->isEnabled() == false)
+            {
+                idleFrame = false;
+                continue;
+            }
+
+            //qDebug() << "Processing fader" << fader->name() << fader->channelsCount();
+            fader->write(this);
+
+            if (fader->isIdle() == false)
+                idleFrame = false;
 
-        //qDebug() << "Processing fader" << fader->name() << fader->channelsCount();
-        fader->write(this);
+            fadersCount++;
+            fadeChannelsCount += fader->channelsCount();
+        }
     }
+    m_idleFrame = idleFrame;
+    m_fadersMutex.unlock();
+
+    if (m_passthrough)
+        mergePassthrough();
 
-    const QByteArray postGM = m_postGMValues->mid(0, m_usedChannels);
-    dumpOutput(postGM);
+    bool changed = hasChanged();
+    const QByteArray &postGM = publishFrame(changed);
+    dumpOutput(postGM, m_changedStart, m_changedCount);
 
-    if (hasChanged())
+    if (changed && m_latencyTracer != NULL && m_outputPatchList.isEmpty() == false)
+        m_latencyTracer->outputChanged(m_id);
+
+    if (changed)
         emit universeWritten(id(), postGM);
+
+    emit frameDumped();
+
+    int htpRejects = m_htpRejectsCount.fetchAndStoreRelaxed(0);
+    m_statWrites.storeRelease(m_writesCount.fetchAndStoreRelaxed(0));
+    m_statHTPRejects.storeRelease(htpRejects);
+
+    /* Universe::write() only counts the rejects, they are reported here
+     * once per frame at most, and by all the universes once per second */
+    static QLCLogLimiter rejectsLimiter(1);
+    int suppressed;
+    if (htpRejects > 0 && lcUniverse().isDebugEnabled() && rejectsLimiter.allow(&suppressed))
+        qCDebug(lcUniverse) << "Universe" << id() << "rejected" << htpRejects
+                            << "HTP writes in a frame, suppressed:" << suppressed;
+
+    m_statFaders.storeRelease(fadersCount);
+    m_statFadeChannels.storeRelease(fadeChannelsCount);
+    m_statProcessTime.storeRelease(int(processTimer.nsecsElapsed() / 1000));
+
+    m_processMutex.unlock();
+
+    // inputs chained from other universes while this one was busy
+    processPendingInput();
+}
+
+void Universe::processInput()
+{
+    flushInput();
+
+    if (m_passthrough)
+        mergePassthrough();
+
+    bool changed = hasChanged();
+    if (changed == false)
+        return;
+
+    const QByteArray &postGM = publishFrame(changed);
+    dumpOutput(postGM, m_changedStart, m_changedCount);
+
+    if (m_latencyTracer != NULL && m_outputPatchList.isEmpty() == false)
+        m_latencyTracer->outputChanged(m_id);
+
+    emit universeWritten(id(), postGM);
+}
+
+void Universe::processPendingInput()
+{
+    int passes = 0;
+
+    // the input is never waited for across threads: whoever holds the
+    // universe processes it. The passes are limited so that universes
+    // looped back onto each other can't bounce a change forever
+    while (m_inputPending.loadAcquire() != 0 && passes < UNIVERSE_MAX_INPUT_PASSES)
+    {
+        if (m_processMutex.tryLock() == false)
+            return;
+
+        while (passes < UNIVERSE_MAX_INPUT_PASSES && m_inputPending.fetchAndStoreOrdered(0) != 0)
+        {
+            processInput();
+            passes++;
+        }
+
+        m_processMutex.unlock();
+    }
+}
+
+void Universe::slotInputFrameReceived()
+{
+    m_inputPending.storeRelease(1);
+    processPendingInput();
+}
+
+/************************************************************************
+ * Frames
+ ************************************************************************/
+
+const QByteArray &Universe::publishFrame(bool changed)
+{
+    int next = m_frameIndex ^ 1;
+    QByteArray &frame = m_frames[next];
+
+    // if a consumer still holds the buffer, resize/data will detach it
+    // and the consumer keeps its own copy untouched
+    frame.resize(m_usedChannels);
+    if (m_usedChannels)
+        memcpy(frame.data(), outputValues()->constData(), m_usedChannels);
+
+    QMutexLocker locker(&m_frameMutex);
+    m_frameIndex = next;
+    if (changed)
+        m_frameGeneration.fetchAndAddRelease(1);
+
+    return frame;
+}
+
+QByteArray Universe::lastFrame(quint32 *generation) const
+{
+    QMutexLocker locker(&m_frameMutex);
+    if (generation != NULL)
+        *generation = quint32(m_frameGeneration.loadAcquire());
+    return m_frames[m_frameIndex];
+}
+
+quint32 Universe::frameGeneration() const
+{
+    return quint32(m_frameGeneration.loadAcquire());
+}
+
+/************************************************************************
+ * Statistics
+ ************************************************************************/
+
+Universe::Statistics Universe::statistics() const
+{
+    Statistics stats;
+    stats.writes = quint32(m_statWrites.loadAcquire());
+    stats.htpRejects = quint32(m_statHTPRejects.loadAcquire());
+    stats.faders = m_statFaders.loadAcquire();
+    stats.fadeChannels = m_statFadeChannels.loadAcquire();
+    stats.processTime = m_statProcessTime.loadAcquire();
+    return stats;
+}
+
+void Universe::setLatencyTracer(LatencyTracer *tracer)
+{
+    m_latencyTracer = tracer;
 }
 
 void Universe::run()
@@ -322,6 +716,9 @@ void Universe::run()
 
     qDebug() << "Universe thread started" << id();
 
+    /* Universes run right below the MasterTimer thread */
+    MasterTimer::setupRealTimeThread(1);
+
     while(m_running)
     {
         if (m_semaphore.tryAcquire(1, timeout) == false)
@@ -330,8 +727,8 @@ void Universe::run()
             continue;
         }
 #if 0
-        if (m_faders.count())
-            qDebug() << "<<<<<<<< UNIVERSE TICK - id" << id() << "faders:" << m_faders.count();
+        if (faders().count())
+            qDebug() << "<<<<<<<< UNIVERSE TICK - id" << id() << "faders:" << faders().count();
 #endif
         processFaders();
     }
@@ -345,17 +742,11 @@ void Universe::run()
 
 void Universe::reset()
 {
+    m_frameDirty.storeRelease(1);
     m_preGMValues->fill(0);
-    if (m_passthrough)
-    {
-        (*m_postGMValues) = (*m_passthroughValues);
-    }
-    else
-    {
-        m_postGMValues->fill(0);
-    }
+    m_postGMValues->fill(0);
     zeroRelativeValues();
-    m_modifiers.fill(NULL, UNIVERSE_SIZE);
+    m_modifiers.clear();
     m_passthrough = false; // not releasing m_passthroughValues, see comment in setPassthrough
 }
 
@@ -367,27 +758,91 @@ void Universe::reset(int address, int range)
     if (address + range > UNIVERSE_SIZE)
        range = UNIVERSE_SIZE - address;
 
+    m_frameDirty.storeRelease(1);
     memset(m_preGMValues->data() + address, 0, range * sizeof(*m_preGMValues->data()));
-    memset(m_relativeValues.data() + address, 0, range * sizeof(*m_relativeValues.data()));
+    if (m_relativeValues.isEmpty() == false)
+        memset(m_relativeValues.data() + address, 0, range * sizeof(*m_relativeValues.data()));
     memcpy(m_postGMValues->data() + address, m_modifiedZeroValues->data() + address, range * sizeof(*m_postGMValues->data()));
-
-    applyPassthroughValues(address, range);
 }
 
-void Universe::applyPassthroughValues(int address, int range)
+void Universe::mergePassthrough()
 {
-    if (!m_passthrough)
-        return;
+    const uchar *engine = reinterpret_cast<const uchar *>(m_postGMValues->constData());
+    const uchar *input = reinterpret_cast<const uchar *>(m_passthroughValues->constData());
+    uchar *output = reinterpret_cast<uchar *>(m_passthroughOutput->data());
+    int count = m_usedChannels;
+    int i = 0;
 
-    for (int i = address; i < address + range && i < UNIVERSE_SIZE; i++)
+    switch (m_passthroughMerge)
     {
-        if (static_cast<uchar>(m_postGMValues->at(i)) < static_cast<uchar>(m_passthroughValues->at(i))) // HTP merge
+        default:
+        case HTPMerge:
         {
-            (*m_postGMValues)[i] = (*m_passthroughValues)[i];
+#if defined(__SSE2__)
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i eng = _mm_loadu_si128(reinterpret_cast<const __m128i *>(engine + i));
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_max_epu8(eng, in));
+            }
+#endif
+            for (; i < count; i++)
+                output[i] = qMax(engine[i], input[i]);
         }
+        break;
+        case LTPMerge:
+        {
+            // a change of the engine value takes the channel back from the input
+            uchar *owned = reinterpret_cast<uchar *>(m_passthroughOwned->data());
+            uchar *last = reinterpret_cast<uchar *>(m_passthroughEngineValues->data());
+#if defined(__SSE2__)
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i eng = _mm_loadu_si128(reinterpret_cast<const __m128i *>(engine + i));
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+                __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(last + i));
+                __m128i own = _mm_loadu_si128(reinterpret_cast<const __m128i *>(owned + i));
+                own = _mm_and_si128(own, _mm_cmpeq_epi8(eng, prev));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(owned + i), own);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(last + i), eng);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+                                 _mm_or_si128(_mm_and_si128(own, in), _mm_andnot_si128(own, eng)));
+            }
+#endif
+            for (; i < count; i++)
+            {
+                if (engine[i] != last[i])
+                    owned[i] = 0;
+                last[i] = engine[i];
+                output[i] = owned[i] ? input[i] : engine[i];
+            }
+        }
+        break;
+        case InputMerge:
+        {
+            const uchar *received = reinterpret_cast<const uchar *>(m_passthroughReceived->constData());
+#if defined(__SSE2__)
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i eng = _mm_loadu_si128(reinterpret_cast<const __m128i *>(engine + i));
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+                __m128i rcv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(received + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+                                 _mm_or_si128(_mm_and_si128(rcv, in), _mm_andnot_si128(rcv, eng)));
+            }
+#endif
+            for (; i < count; i++)
+                output[i] = received[i] ? input[i] : engine[i];
+        }
+        break;
     }
 }
 
+const QByteArray *Universe::outputValues() const
+{
+    return m_passthrough ? m_passthroughOutput.data() : m_postGMValues.data();
+}
+
 void Universe::zeroIntensityChannels()
 {
     updateIntensityChannelsRanges();
@@ -401,15 +856,9 @@ void Universe::zeroIntensityChannels()
     }
 }
 
-QHash<int, uchar> Universe::intensityChannels()
+QVector<int> Universe::intensityChannels() const
 {
-    QHash <int, uchar> intensityList;
-    for (int i = 0; i < m_intensityChannels.size(); ++i)
-    {
-        int channel = m_intensityChannels.at(i);
-        intensityList[channel] = m_preGMValues->at(channel);
-    }
-    return intensityList;
+    return m_intensityChannels;
 }
 
 uchar Universe::postGMValue(int address) const
@@ -427,6 +876,9 @@ const QByteArray* Universe::postGMValues() const
 
 void Universe::zeroRelativeValues()
 {
+    if (m_relativeValues.isEmpty())
+        return;
+
     memset(m_relativeValues.data(), 0, UNIVERSE_SIZE * sizeof(*m_relativeValues.data()));
 }
 
@@ -477,9 +929,32 @@ uchar Universe::preGMValue(int address) const
     return static_cast<uchar>(m_preGMValues->at(address));
 }
 
+void Universe::updateMonitorValues(const QVector<FadeChannel *> &channels)
+{
+    const char *values = m_preGMValues->constData();
+
+    QMutexLocker locker(&m_monitorMutex);
+    if (m_monitorValues.isEmpty())
+        m_monitorValues.fill(0, UNIVERSE_SIZE);
+
+    char *monitor = m_monitorValues.data();
+    foreach (FadeChannel *fc, channels)
+    {
+        quint32 address = fc->addressInUniverse();
+        if (address < UNIVERSE_SIZE)
+            monitor[address] = values[address];
+    }
+}
+
+QByteArray Universe::monitorValues() const
+{
+    QMutexLocker locker(&m_monitorMutex);
+    return m_monitorValues;
+}
+
 uchar Universe::applyRelative(int channel, uchar value)
 {
-    if (m_relativeValues[channel] != 0)
+    if (m_relativeValues.isEmpty() == false && m_relativeValues[channel] != 0)
     {
         int val = m_relativeValues[channel] + value;
         return CLAMP(val, 0, (int)UCHAR_MAX);
@@ -490,21 +965,33 @@ uchar Universe::applyRelative(int channel, uchar value)
 
 uchar Universe::applyGM(int channel, uchar value)
 {
-    if ((m_grandMaster->channelMode() == GrandMaster::Intensity && m_channelsMask->at(channel) & Intensity) ||
-        (m_grandMaster->channelMode() == GrandMaster::AllChannels))
+    if (m_channelsMask->at(channel) & Intensity)
+        return m_gMIntensityValues[value];
+
+    return m_gMNonIntensityValues[value];
+}
+
+void Universe::updateGMValues()
+{
+    bool allChannels = m_grandMaster->channelMode() == GrandMaster::AllChannels;
+
+    for (int i = 0; i <= UCHAR_MAX; i++)
     {
+        uchar value = uchar(i);
+
         if (m_grandMaster->valueMode() == GrandMaster::Limit)
             value = MIN(value, m_grandMaster->value());
         else
-            value = char(floor((double(value) * m_grandMaster->fraction()) + 0.5));
-    }
+            value = uchar(floor((double(value) * m_grandMaster->fraction()) + 0.5));
 
-    return value;
+        m_gMIntensityValues[i] = value;
+        m_gMNonIntensityValues[i] = allChannels ? value : uchar(i);
+    }
 }
 
 uchar Universe::applyModifiers(int channel, uchar value)
 {
-    if (m_modifiers.at(channel) != NULL)
+    if (m_modifiers.isEmpty() == false && m_modifiers.at(channel) != NULL)
         return m_modifiers.at(channel)->getValue(value);
 
     return value;
@@ -512,16 +999,20 @@ uchar Universe::applyModifiers(int channel, uchar value)
 
 uchar Universe::applyPassthrough(int channel, uchar value)
 {
-    if (m_passthrough)
+    if (m_passthrough == false || channel < 0 || channel >= UNIVERSE_SIZE)
+        return value;
+
+    const uchar passthroughValue = static_cast<uchar>(m_passthroughValues->at(channel));
+
+    switch (m_passthroughMerge)
     {
-        const uchar passthroughValue = static_cast<uchar>(m_passthroughValues->at(channel));
-        if (value < passthroughValue) // HTP merge
-        {
-            return passthroughValue;
-        }
+        case LTPMerge:
+            return m_passthroughOwned->at(channel) ? passthroughValue : value;
+        case InputMerge:
+            return m_passthroughReceived->at(channel) ? passthroughValue : value;
+        default:
+            return qMax(value, passthroughValue);
     }
-
-    return value;
 }
 
 void Universe::updatePostGMValue(int channel)
@@ -540,11 +1031,41 @@ void Universe::updatePostGMValue(int channel)
         value = applyModifiers(channel, value);
     }
 
-    value = applyPassthrough(channel, value);
-
     (*m_postGMValues)[channel] = static_cast<char>(value);
 }
 
+void Universe::updatePostGMValues(const QVector<int> &channels)
+{
+    const int *indices = channels.constData();
+    const uchar *preGM = reinterpret_cast<const uchar *>(m_preGMValues->constData());
+    const uchar *zeroValues = reinterpret_cast<const uchar *>(m_modifiedZeroValues->constData());
+    const char *mask = m_channelsMask->constData();
+    uchar *postGM = reinterpret_cast<uchar *>(m_postGMValues->data());
+    const short *relative = m_relativeValues.isEmpty() ? NULL : m_relativeValues.constData();
+    ChannelModifier * const *modifiers = m_modifiers.isEmpty() ? NULL : m_modifiers.constData();
+
+    for (int i = 0; i < channels.size(); ++i)
+    {
+        int channel = indices[i];
+
+        // relative values and modifiers are rare, so they take the full path
+        if ((relative != NULL && relative[channel] != 0) ||
+            (modifiers != NULL && modifiers[channel] != NULL))
+        {
+            updatePostGMValue(channel);
+            continue;
+        }
+
+        uchar value = preGM[channel];
+        if (value == 0)
+            postGM[channel] = zeroValues[channel];
+        else if (mask[channel] & Intensity)
+            postGM[channel] = m_gMIntensityValues[value];
+        else
+            postGM[channel] = m_gMNonIntensityValues[value];
+    }
+}
+
 /************************************************************************
  * Patches
  ************************************************************************/
@@ -691,11 +1212,15 @@ OutputPatch *Universe::feedbackPatch() const
     return m_fbPatch;
 }
 
-void Universe::dumpOutput(const QByteArray &data)
+void Universe::dumpOutput(const QByteArray &data, int changedStart, int changedCount)
 {
     if (m_outputPatchList.count() == 0)
         return;
 
+    /* A change in the universe size invalidates what plugins have sent so far */
+    if (m_totalChannelsChanged == true)
+        changedCount = -1;
+
     foreach (OutputPatch *op, m_outputPatchList)
     {
         if (m_totalChannelsChanged == true)
@@ -704,7 +1229,7 @@ void Universe::dumpOutput(const QByteArray &data)
         if (op->blackout())
             op->dump(m_id, *m_modifiedZeroValues);
         else
-            op->dump(m_id, data);
+            op->dump(m_id, data, changedStart, changedCount);
     }
     m_totalChannelsChanged = false;
 }
@@ -725,6 +1250,9 @@ void Universe::flushInput()
         return;
 
     m_inputPatch->flush(m_id);
+
+    if (m_latencyTracer != NULL)
+        m_latencyTracer->inputFlushed(m_id, m_inputPatch->takeInputTime());
 }
 
 void Universe::slotInputValueChanged(quint32 universe, quint32 channel, uchar value, const QString &key)
@@ -733,7 +1261,7 @@ void Universe::slotInputValueChanged(quint32 universe, quint32 channel, uchar va
     {
         if (universe == m_id)
         {
-            qDebug() << "write" << channel << value;
+            //qDebug() << "write" << channel << value;
 
             if (channel >= UNIVERSE_SIZE)
                 return;
@@ -741,9 +1269,11 @@ void Universe::slotInputValueChanged(quint32 universe, quint32 channel, uchar va
             if (channel >= m_usedChannels)
                 m_usedChannels = channel + 1;
 
+            // the input takes an LTP channel only when it changes it
+            if ((*m_passthroughReceived)[channel] == 0 || uchar((*m_passthroughValues)[channel]) != value)
+                (*m_passthroughOwned)[channel] = char(0xFF);
+            (*m_passthroughReceived)[channel] = char(0xFF);
             (*m_passthroughValues)[channel] = value;
-
-            updatePostGMValue(channel);
         }
     }
     else
@@ -755,12 +1285,18 @@ void Universe::connectInputPatch()
     if (m_inputPatch == NULL)
         return;
 
+    // passthrough values are merged by the thread flushing the input,
+    // within the frame being composed
     if (!m_passthrough)
         connect(m_inputPatch, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                 this, SIGNAL(inputValueChanged(quint32,quint32,uchar,QString)));
     else
         connect(m_inputPatch, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
-                this, SLOT(slotInputValueChanged(quint32,quint32,uchar,const QString&)));
+                this, SLOT(slotInputValueChanged(quint32,quint32,uchar,const QString&)),
+                Qt::DirectConnection);
+
+    connect(m_inputPatch, SIGNAL(inputFrameReceived()),
+            this, SLOT(slotInputFrameReceived()), Qt::DirectConnection);
 }
 
 void Universe::disconnectInputPatch()
@@ -774,6 +1310,9 @@ void Universe::disconnectInputPatch()
     else
         disconnect(m_inputPatch, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                 this, SLOT(slotInputValueChanged(quint32,quint32,uchar,const QString&)));
+
+    disconnect(m_inputPatch, SIGNAL(inputFrameReceived()),
+               this, SLOT(slotInputFrameReceived()));
 }
 
 /************************************************************************
@@ -785,6 +1324,8 @@ void Universe::setChannelCapability(ushort channel, QLCChannel::Group group, Cha
     if (channel >= (ushort)m_channelsMask->count())
         return;
 
+    m_frameDirty.storeRelease(1);
+
     if (Utils::vectorRemove(m_intensityChannels, channel))
         m_intensityChannelsChanged = true;
     Utils::vectorRemove(m_nonIntensityChannels, channel);
@@ -855,13 +1396,22 @@ void Universe::setChannelDefaultValue(ushort channel, uchar value)
 
     (*m_preGMValues)[channel] = value;
     updatePostGMValue(channel);
+    m_frameDirty.storeRelease(1);
 }
 
 void Universe::setChannelModifier(ushort channel, ChannelModifier *modifier)
 {
-    if (channel >= (ushort)m_modifiers.count())
+    if (channel >= UNIVERSE_SIZE)
         return;
 
+    // modifiers are rare, so the table is allocated at the first one
+    if (m_modifiers.isEmpty())
+    {
+        if (modifier == NULL)
+            return;
+        m_modifiers.fill(NULL, UNIVERSE_SIZE);
+    }
+
     m_modifiers[channel] = modifier;
 
     if (modifier != NULL)
@@ -879,6 +1429,7 @@ void Universe::setChannelModifier(ushort channel, ChannelModifier *modifier)
     }
 
     updatePostGMValue(channel);
+    m_frameDirty.storeRelease(1);
 }
 
 ChannelModifier *Universe::channelModifier(ushort channel)
@@ -932,9 +1483,11 @@ bool Universe::write(int channel, uchar value, bool forceLTP)
     if (channel >= m_usedChannels)
         m_usedChannels = channel + 1;
 
+    m_writesCount.fetchAndAddRelaxed(1);
+
     if (forceLTP == false && (m_channelsMask->at(channel) & HTP) && value < (uchar)m_preGMValues->at(channel))
     {
-        qDebug() << "[Universe] HTP check not passed" << channel << value;
+        m_htpRejectsCount.fetchAndAddRelaxed(1);
         return false;
     }
 
@@ -954,9 +1507,15 @@ bool Universe::writeRelative(int channel, uchar value)
     if (channel >= m_usedChannels)
         m_usedChannels = channel + 1;
 
+    m_writesCount.fetchAndAddRelaxed(1);
+
     if (value == RELATIVE_ZERO)
         return true;
 
+    // only universes with relative channels need the offsets
+    if (m_relativeValues.isEmpty())
+        m_relativeValues.fill(0, UNIVERSE_SIZE);
+
     m_relativeValues[channel] += value - RELATIVE_ZERO;
 
     updatePostGMValue(channel);
@@ -976,6 +1535,7 @@ bool Universe::writeBlended(int channel, uchar value, Universe::BlendMode blend)
 
         case MaskBlend:
         {
+            m_writesCount.fetchAndAddRelaxed(1);
             if (value)
             {
                 float currValue = (float)uchar(m_preGMValues->at(channel));
@@ -989,6 +1549,7 @@ bool Universe::writeBlended(int channel, uchar value, Universe::BlendMode blend)
         break;
         case AdditiveBlend:
         {
+            m_writesCount.fetchAndAddRelaxed(1);
             uchar currVal = uchar(m_preGMValues->at(channel));
             //qDebug() << "Universe write additive channel" << channel << ", value:" << currVal << "+" << value;
             value = qMin(int(currVal) + value, 255);
@@ -997,6 +1558,7 @@ bool Universe::writeBlended(int channel, uchar value, Universe::BlendMode blend)
         break;
         case SubtractiveBlend:
         {
+            m_writesCount.fetchAndAddRelaxed(1);
             uchar currVal = uchar(m_preGMValues->at(channel));
             if (value >= currVal)
                 value = 0;
@@ -1015,6 +1577,151 @@ bool Universe::writeBlended(int channel, uchar value, Universe::BlendMode blend)
     return true;
 }
 
+bool Universe::writeBlendedRange(int address, const uchar *values, int count, Universe::BlendMode blend)
+{
+    if (address < 0 || count <= 0 || values == NULL)
+        return false;
+
+    if (address + count > UNIVERSE_SIZE)
+        count = UNIVERSE_SIZE - address;
+
+    if (address + count > m_usedChannels)
+        m_usedChannels = address + count;
+
+    uchar *preGM = reinterpret_cast<uchar *>(m_preGMValues->data()) + address;
+    const uchar *mask = reinterpret_cast<const uchar *>(m_channelsMask->constData()) + address;
+    int i = 0;
+
+    m_writesCount.fetchAndAddRelaxed(count);
+
+    switch (blend)
+    {
+        case NormalBlend:
+        {
+            int rejects = 0;
+#if defined(__SSE2__)
+            const __m128i htpBit = _mm_set1_epi8(char(HTP));
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+                __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(preGM + i));
+                __m128i msk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i));
+                __m128i htp = _mm_cmpeq_epi8(_mm_and_si128(msk, htpBit), htpBit);
+                __m128i highest = _mm_max_epu8(cur, val);
+                // HTP channels get the highest value, LTP ones the new value
+                __m128i res = _mm_or_si128(_mm_and_si128(htp, highest),
+                                           _mm_andnot_si128(htp, val));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(preGM + i), res);
+                // HTP channels where the new value is not the highest
+                rejects += qPopulationCount(quint32(_mm_movemask_epi8(
+                               _mm_andnot_si128(_mm_cmpeq_epi8(highest, val), htp))));
+            }
+#endif
+            for (; i < count; i++)
+            {
+                if ((mask[i] & HTP) && values[i] < preGM[i])
+                {
+                    rejects++;
+                    continue;
+                }
+                preGM[i] = values[i];
+            }
+
+            if (rejects)
+                m_htpRejectsCount.fetchAndAddRelaxed(rejects);
+        }
+        break;
+        case MaskBlend:
+        {
+            // keep the floating point calculation of writeBlended
+            // to produce the exact same results
+            for (; i < count; i++)
+            {
+                uchar value = values[i];
+                if (value)
+                {
+                    float currValue = (float)preGM[i];
+                    if (currValue)
+                        value = currValue * ((float)value / 255.0);
+                    else
+                        value = 0;
+                }
+                preGM[i] = value;
+            }
+        }
+        break;
+        case AdditiveBlend:
+        {
+#if defined(__SSE2__)
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+                __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(preGM + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(preGM + i), _mm_adds_epu8(cur, val));
+            }
+#endif
+            for (; i < count; i++)
+                preGM[i] = uchar(qMin(int(preGM[i]) + values[i], 255));
+        }
+        break;
+        case SubtractiveBlend:
+        {
+#if defined(__SSE2__)
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+                __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(preGM + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(preGM + i), _mm_subs_epu8(cur, val));
+            }
+#endif
+            for (; i < count; i++)
+                preGM[i] = values[i] >= preGM[i] ? 0 : preGM[i] - values[i];
+        }
+        break;
+        default:
+            qDebug() << "[Universe] Blend mode not handled. Implement me!" << blend;
+        break;
+    }
+
+    for (i = address; i < address + count; i++)
+        updatePostGMValue(i);
+
+    return true;
+}
+
+int Universe::writeMultiple(const int *channels, const uchar *values, int count, bool forceLTP)
+{
+    if (channels == NULL || values == NULL || count <= 0)
+        return 0;
+
+    uchar *preGM = reinterpret_cast<uchar *>(m_preGMValues->data());
+    const char *mask = m_channelsMask->constData();
+    int written = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        int channel = channels[i];
+        if (channel < 0 || channel >= UNIVERSE_SIZE)
+            continue;
+
+        if (channel >= m_usedChannels)
+            m_usedChannels = channel + 1;
+
+        if (forceLTP == false && (mask[channel] & HTP) && values[i] < preGM[channel])
+            continue;
+
+        preGM[channel] = values[i];
+        updatePostGMValue(channel);
+        written++;
+    }
+
+    m_writesCount.fetchAndAddRelaxed(count);
+    if (written < count)
+        m_htpRejectsCount.fetchAndAddRelaxed(count - written);
+
+    return written;
+}
+
 /*********************************************************************
  * Load & Save
  *********************************************************************/
@@ -1045,6 +1752,11 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
         setPassthrough(false);
     }
 
+    if (attrs.hasAttribute(KXMLQLCUniversePassthroughMerge))
+        setPassthroughMerge(stringToPassthroughMerge(attrs.value(KXMLQLCUniversePassthroughMerge).toString()));
+    else
+        setPassthroughMerge(HTPMerge);
+
     while (root.readNextStartElement())
     {
         qDebug() << "Universe tag:" << root.name();
@@ -1086,6 +1798,7 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
             if (pAttrs.hasAttribute(KXMLQLCUniverseLine))
                 output = pAttrs.value(KXMLQLCUniverseLine).toString().toUInt();
             ioMap->setOutputPatch(index, plugin, output, false);
+            loadXMLFrameRate(pAttrs, outputPatch());
 
             QXmlStreamReader::TokenType tType = root.readNext();
             if (tType == QXmlStreamReader::Characters)
@@ -1108,6 +1821,7 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
             if (pAttrs.hasAttribute(KXMLQLCUniverseLine))
                 output = pAttrs.value(KXMLQLCUniverseLine).toString().toUInt();
             ioMap->setOutputPatch(index, plugin, output, true);
+            loadXMLFrameRate(pAttrs, feedbackPatch());
 
             QXmlStreamReader::TokenType tType = root.readNext();
             if (tType == QXmlStreamReader::Characters)
@@ -1131,6 +1845,19 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
     return true;
 }
 
+void Universe::loadXMLFrameRate(const QXmlStreamAttributes &attrs, OutputPatch *patch)
+{
+    if (patch == NULL)
+        return;
+
+    if (attrs.hasAttribute(KXMLQLCUniverseRefreshRate))
+        patch->setRefreshRate(attrs.value(KXMLQLCUniverseRefreshRate).toString().toInt());
+    if (attrs.hasAttribute(KXMLQLCUniverseSkipDuplicates))
+        patch->setSkipDuplicates(attrs.value(KXMLQLCUniverseSkipDuplicates).toString() == KXMLQLCTrue);
+    if (attrs.hasAttribute(KXMLQLCUniverseKeepalive))
+        patch->setKeepaliveInterval(attrs.value(KXMLQLCUniverseKeepalive).toString().toInt());
+}
+
 bool Universe::loadXMLPluginParameters(QXmlStreamReader &root, PatchTagType currentTag)
 {
     if (root.name() != KXMLQLCUniversePluginParameters)
@@ -1177,6 +1904,8 @@ bool Universe::saveXML(QXmlStreamWriter *doc) const
 
     if (passthrough() == true)
         doc->writeAttribute(KXMLQLCUniversePassthrough, KXMLQLCTrue);
+    if (passthroughMerge() != HTPMerge)
+        doc->writeAttribute(KXMLQLCUniversePassthroughMerge, passthroughMergeToString(passthroughMerge()));
 
     if (inputPatch() != NULL)
     {
@@ -1186,12 +1915,12 @@ bool Universe::saveXML(QXmlStreamWriter *doc) const
     if (outputPatch() != NULL)
     {
         savePatchXML(doc, KXMLQLCUniverseOutputPatch, outputPatch()->pluginName(),
-            outputPatch()->output(), "", outputPatch()->getPluginParameters());
+            outputPatch()->output(), "", outputPatch()->getPluginParameters(), outputPatch());
     }
     if (feedbackPatch() != NULL)
     {
         savePatchXML(doc, KXMLQLCUniverseFeedbackPatch, feedbackPatch()->pluginName(),
-            feedbackPatch()->output(), "", feedbackPatch()->getPluginParameters());
+            feedbackPatch()->output(), "", feedbackPatch()->getPluginParameters(), feedbackPatch());
     }
 
     /* End the <Universe> tag */
@@ -1206,7 +1935,8 @@ void Universe::savePatchXML(
     const QString &pluginName,
     quint32 line,
     QString profileName,
-    QMap<QString, QVariant> parameters) const
+    QMap<QString, QVariant> parameters,
+    const OutputPatch *patch) const
 {
     // sanity check: don't save invalid data
     if (pluginName.isEmpty() || pluginName == KInputNone || line == QLCIOPlugin::invalidLine())
@@ -1218,6 +1948,16 @@ void Universe::savePatchXML(
     if (!profileName.isEmpty() && profileName != KInputNone)
         doc->writeAttribute(KXMLQLCUniverseProfileName, profileName);
 
+    if (patch != NULL)
+    {
+        if (patch->refreshRate() > 0)
+            doc->writeAttribute(KXMLQLCUniverseRefreshRate, QString::number(patch->refreshRate()));
+        if (patch->skipDuplicates())
+            doc->writeAttribute(KXMLQLCUniverseSkipDuplicates, KXMLQLCTrue);
+        if (patch->keepaliveInterval() > 0)
+            doc->writeAttribute(KXMLQLCUniverseKeepalive, QString::number(patch->keepaliveInterval()));
+    }
+
     savePluginParametersXML(doc, parameters);
     doc->writeEndElement();
 }
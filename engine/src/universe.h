@@ -22,18 +22,25 @@
 #define UNIVERSE_H
 
 #include <QScopedPointer>
+#include <QAtomicPointer>
+#include <QAtomicInt>
 #include <QSemaphore>
 #include <QByteArray>
+#include <QMutex>
 #include <QThread>
 #include <QSet>
 
 #include "qlcchannel.h"
 
+class QXmlStreamAttributes;
 class QXmlStreamReader;
 class QLCInputProfile;
 class ChannelModifier;
+class FadeChannel;
 class InputOutputMap;
+class GenericFaderPool;
 class GenericFader;
+class LatencyTracer;
 class QLCIOPlugin;
 class GrandMaster;
 class OutputPatch;
@@ -50,6 +57,7 @@ class Doc;
 #define KXMLQLCUniverseName "Name"
 #define KXMLQLCUniverseID "ID"
 #define KXMLQLCUniversePassthrough "Passthrough"
+#define KXMLQLCUniversePassthroughMerge "PassthroughMerge"
 
 #define KXMLQLCUniverseInputPatch "Input"
 #define KXMLQLCUniverseOutputPatch "Output"
@@ -59,6 +67,9 @@ class Doc;
 #define KXMLQLCUniverseLine "Line"
 #define KXMLQLCUniverseProfileName "Profile"
 #define KXMLQLCUniversePluginParameters "PluginParameters"
+#define KXMLQLCUniverseRefreshRate "RefreshRate"
+#define KXMLQLCUniverseSkipDuplicates "SkipDuplicates"
+#define KXMLQLCUniverseKeepalive "Keepalive"
 
 /** Universe class contains input/output data for one DMX universe
  */
@@ -67,6 +78,8 @@ class Universe: public QThread
     Q_OBJECT
     Q_DISABLE_COPY(Universe)
 
+    friend class UniversePool;
+
     Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
     Q_PROPERTY(quint32 id READ id CONSTANT)
     Q_PROPERTY(bool passthrough READ passthrough WRITE setPassthrough NOTIFY passthroughChanged)
@@ -126,10 +139,19 @@ public:
     ushort totalChannels();
 
     /**
-     * Returns if the universe has changed since the last MasterTimer tick
+     * Returns if the universe has changed since the last MasterTimer tick.
+     * The range of changed channels is stored and can be retrieved with
+     * changedStart() and changedCount()
      */
     bool hasChanged();
 
+    /** Returns the index of the first channel changed in the last hasChanged() call */
+    int changedStart() const;
+
+    /** Returns the number of channels changed in the last hasChanged() call,
+     *  starting from changedStart(). 0 means nothing changed */
+    int changedCount() const;
+
     /**
      * Enable or disable the passthrough mode for this universe
      */
@@ -140,6 +162,29 @@ public:
      */
     bool passthrough() const;
 
+    /** How the input values are merged with the engine output in passthrough mode */
+    enum PassthroughMerge
+    {
+        /** The highest of the input and the engine value */
+        HTPMerge = 0,
+        /** The value that changed last. The engine wins a tie */
+        LTPMerge,
+        /** The input value, on the channels received from the input so far */
+        InputMerge
+    };
+
+    /** Set how the input is merged with the engine output */
+    void setPassthroughMerge(PassthroughMerge merge);
+
+    /** Get how the input is merged with the engine output */
+    PassthroughMerge passthroughMerge() const;
+
+    /** Return a merge mode from a string */
+    static PassthroughMerge stringToPassthroughMerge(const QString& str);
+
+    /** Return a string from a merge mode, to be saved into a XML */
+    static QString passthroughMergeToString(PassthroughMerge merge);
+
     /**
      * Enable or disable the monitor mode for this universe
      */
@@ -150,6 +195,19 @@ public:
      */
     bool monitor() const;
 
+    /**
+     * Enable or disable the rendering of this universe. When disabled,
+     * processFaders() doesn't process the faders nor send anything to
+     * the output patches, since another host renders this universe
+     */
+    void setRendered(bool enable);
+
+    /**
+     * Returns if the universe is rendered by this host
+     */
+    bool rendered() const;
+
+    /** Merge the input value of $channel with $value, like the output frame */
     uchar applyPassthrough(int channel, uchar value);
 
 protected slots:
@@ -169,10 +227,16 @@ protected:
      */
     uchar applyGM(int channel, uchar value);
 
+    /** Rebuild the Grand Master lookup tables from its current settings */
+    void updateGMValues();
+
     uchar applyRelative(int channel, uchar value);
     uchar applyModifiers(int channel, uchar value);
     void updatePostGMValue(int channel);
 
+    /** Update the post GM values of the sorted $channels in a single pass */
+    void updatePostGMValues(const QVector<int> &channels);
+
 signals:
     void nameChanged();
     void passthroughChanged();
@@ -184,10 +248,18 @@ protected:
     QString m_name;
     /** Reference to the Grand Master to perform values scaling */
     GrandMaster *m_grandMaster;
+    /** The Grand Master result of every DMX value, for intensity channels
+     *  and for all the other channels, so that applyGM is a table lookup */
+    uchar m_gMIntensityValues[UCHAR_MAX + 1];
+    uchar m_gMNonIntensityValues[UCHAR_MAX + 1];
     /** Variable that determine if a universe is in passthrough mode */
     bool m_passthrough;
     /** Flag to monitor the universe changes */
     bool m_monitor;
+    /** Flag to render and output the universe on this host */
+    bool m_rendered;
+    /** The merge of the input values in passthrough mode */
+    PassthroughMerge m_passthroughMerge;
 
     /************************************************************************
      * Patches
@@ -232,9 +304,12 @@ public:
     OutputPatch *feedbackPatch() const;
 
     /**
-     * This is the actual function that writes data to an output patch
+     * This is the actual function that writes data to an output patch.
+     * $changedStart and $changedCount describe the range of channels
+     * changed since the last dump, passed to plugins supporting delta
+     * output. A count of -1 means the whole buffer must be considered changed
      */
-    void dumpOutput(const QByteArray& data);
+    void dumpOutput(const QByteArray& data, int changedStart = 0, int changedCount = -1);
 
     /**
      * @brief dumpBlackout
@@ -325,7 +400,8 @@ protected:
     QScopedPointer<QByteArray> m_channelsMask;
 
     /** Vector of pointer to ChannelModifier classes. If not NULL, they will modify
-     *  a DMX value right before HTP/LTP check and before being assigned to preGM */
+     *  a DMX value right before HTP/LTP check and before being assigned to preGM.
+     *  Empty until the first modifier is set */
     QVector<ChannelModifier*> m_modifiers;
 
     /** Modified channels with the non-modified value at 0.
@@ -347,16 +423,21 @@ public:
      *  this Universe. The caller is in charge of adding/removing
      *  FadeChannels and eventually dismiss a fader when no longer needed.
      *  If a fade out transition is needed, this Universe
-     *  is in charge of completing it and dismissing the fader. */
+     *  is in charge of completing it and dismissing the fader.
+     *  The fader is composed starting from the next processFaders() */
     QSharedPointer<GenericFader> requestFader(FaderPriority priority = Auto);
 
-    /** Dismiss a fader requested with requestFader, which is no longer needed */
+    /** Dismiss a fader requested with requestFader, which is no longer needed.
+     *  The fader is removed at the beginning of the next processFaders() */
     void dismissFader(QSharedPointer<GenericFader> fader);
 
-    /** Request a new priority for a fader with the provided intance */
+    /** Request a new priority for a fader with the provided intance.
+     *  The fader is moved on top of the faders of its new priority
+     *  at the beginning of the next processFaders() */
     void requestFaderPriority(QSharedPointer<GenericFader> fader, FaderPriority priority);
 
-    /** Retrieve a modifiable list of the currently active faders */
+    /** Retrieve a modifiable list of the currently active faders,
+     *  sorted by priority */
     QList<QSharedPointer<GenericFader> > faders();
 
 public slots:
@@ -365,21 +446,171 @@ public slots:
 protected:
     void processFaders();
 
+    /** Flush the input received since the last flush and dump the frame
+     *  if it has changed, without running the faders. This is how a
+     *  Synchronous input reaches the outputs within the same tick.
+     *  Must be called with m_processMutex locked */
+    void processInput();
+
+    /** Process the input flagged by m_inputPending, unless another
+     *  thread is processing this universe: in that case that thread
+     *  will do it before releasing m_processMutex */
+    void processPendingInput();
+
+protected slots:
+    /** Slot called, in the writer thread, when the input patch
+     *  receives a frame from a Synchronous plugin */
+    void slotInputFrameReceived();
+
+protected:
     /** DMX writer thread worker method */
     void run();
 
 signals:
     void universeWritten(quint32 universeID, const QByteArray& universeData);
 
+    /** Emitted from the universe thread at the end of every processFaders,
+     *  once the frame has been handed to the output patches */
+    void frameDumped();
+
+    /************************************************************************
+     * Frames
+     ************************************************************************/
+public:
+    /**
+     * Return the last frame composed by processFaders, that is the post
+     * Grand Master values up to usedChannels(). The frame is implicitly
+     * shared, so this doesn't copy any data and it is safe to call from
+     * any thread.
+     *
+     * @param generation If not NULL, filled with the frame generation
+     * @return The last composed frame
+     */
+    QByteArray lastFrame(quint32 *generation = NULL) const;
+
+    /**
+     * Return a counter increased every time a frame with changed values
+     * is composed. Consumers polling at their own rate can compare it
+     * with the last one they've seen to skip unchanged frames.
+     */
+    quint32 frameGeneration() const;
+
+protected:
+    /** Copy the current post GM values into the next frame buffer and publish it */
+    const QByteArray &publishFrame(bool changed);
+
+protected:
+    /** Double buffer of frames. Buffers are reused unless a consumer
+     *  still holds a reference to them, in which case they detach */
+    QByteArray m_frames[2];
+    /** Index in m_frames of the last published frame */
+    int m_frameIndex;
+    /** Generation of the last published frame */
+    QAtomicInt m_frameGeneration;
+    /** Mutex guarding m_frameIndex against concurrent lastFrame calls */
+    mutable QMutex m_frameMutex;
+
+    /************************************************************************
+     * Statistics
+     ************************************************************************/
+public:
+    /** A snapshot of the engine counters of a Universe,
+     *  referring to the last processed tick */
+    struct Statistics
+    {
+        /** Number of channel writes */
+        quint32 writes;
+        /** Number of writes rejected by the HTP check */
+        quint32 htpRejects;
+        /** Number of active GenericFaders */
+        int faders;
+        /** Number of active FadeChannels, across all faders */
+        int fadeChannels;
+        /** Time spent in processFaders, in microseconds */
+        int processTime;
+    };
+
+    /** Return the counters of the last processed tick.
+     *  This is thread safe and can be polled at any rate */
+    Statistics statistics() const;
+
+    /** Set the tracer recording the latency between the input
+     *  of this universe and the changes of the output ones */
+    void setLatencyTracer(LatencyTracer *tracer);
+
+protected:
+    /** Writes and HTP rejects accumulated during the current tick */
+    QAtomicInt m_writesCount;
+    QAtomicInt m_htpRejectsCount;
+
+    /** Counters published at the end of each processFaders call */
+    QAtomicInt m_statWrites;
+    QAtomicInt m_statHTPRejects;
+    QAtomicInt m_statFaders;
+    QAtomicInt m_statFadeChannels;
+    QAtomicInt m_statProcessTime;
+
+    /** Reference to the latency tracer, or NULL when not tracing */
+    LatencyTracer *m_latencyTracer;
+
 protected:
     QSemaphore m_semaphore;
 
+    /** Mutex held while the universe is processed, either by
+     *  processFaders or by processInput */
+    QMutex m_processMutex;
+
+    /** Flag raised when a Synchronous input has been received
+     *  and not flushed yet */
+    QAtomicInt m_inputPending;
+
+    /** Flag raised when the last frame has been rendered by idle faders
+     *  only, without passthrough and writes from outside the faders, so it
+     *  stays the same until a fader or the universe changes */
+    bool m_idleFrame;
+
+    /** Flag raised by the changes that affect the frame without writing
+     *  any channel, like a reset or a new Grand Master value */
+    QAtomicInt m_frameDirty;
+
     /** Indicated if the DMX writer worker thread is running */
     bool m_running;
 
-    /** IMPORTANT: this is the list of faders that will compose
-     *  the Universe values. The order is very important ! */
-    QList<QSharedPointer<GenericFader> > m_faders;
+    /** A change of the fader buckets, queued by requestFader(),
+     *  dismissFader() and requestFaderPriority() */
+    struct FaderCommand
+    {
+        enum Type { Add, Remove, Move };
+
+        Type type;
+        FaderPriority priority;
+        QSharedPointer<GenericFader> fader;
+        FaderCommand *next;
+    };
+
+    /** Queue $command to be applied by the next processFaders() */
+    void queueFaderCommand(FaderCommand *command);
+
+    /** Apply the queued fader commands, in the order they were queued.
+     *  Must be called with m_fadersMutex locked */
+    void applyFaderCommands();
+
+    /** IMPORTANT: these are the faders that will compose the Universe
+     *  values, one bucket per priority. The buckets are written in
+     *  priority order and each bucket in request order, so the order
+     *  is very important ! */
+    QList<QSharedPointer<GenericFader> > m_faders[SimpleDesk + 1];
+
+    /** Mutex guarding m_faders while they are composed, since
+     *  faders() can be called from any thread */
+    QMutex m_fadersMutex;
+
+    /** Lock-free stack of the fader commands not yet applied, the most
+     *  recent first. Pushed by any thread, taken whole by processFaders() */
+    QAtomicPointer<FaderCommand> m_faderCommands;
+
+    /** Faders no longer in use, recycled by requestFader() */
+    QSharedPointer<GenericFaderPool> m_faderPool;
 
     /************************************************************************
      * Values
@@ -434,17 +665,38 @@ public:
      */
     uchar preGMValue(int address) const;
 
+    /**
+     * Copy the current pre-Grand-Master values of $channels into the
+     * monitoring buffer. Called by the monitored faders before writing.
+     */
+    void updateMonitorValues(const QVector<FadeChannel *>& channels);
+
+    /**
+     * Return the pre-Grand-Master values the monitored faders found on
+     * their channels before writing them, to be sampled by the UI at
+     * display rate. Empty until a monitored fader has run.
+     */
+    QByteArray monitorValues() const;
+
     /** Set all intensity channel values to zero */
     void zeroIntensityChannels();
 
-    /** Return a list with intensity channels and their values */
-    QHash <int, uchar> intensityChannels();
+    /** Return the sorted indices of the intensity channels */
+    QVector<int> intensityChannels() const;
 
     /** Set all channel relative values to zero */
     void zeroRelativeValues();
 
 protected:
-    void applyPassthroughValues(int address, int range);
+    /**
+     * Merge the passthrough input with the engine output into
+     * m_passthroughOutput, over the whole frame in a single pass.
+     * Called right before looking for changes in the output.
+     */
+    void mergePassthrough();
+
+    /** Return the values sent to the outputs: the merged ones in passthrough mode */
+    const QByteArray *outputValues() const;
 
 protected:
     /**
@@ -485,10 +737,26 @@ protected:
     QScopedPointer<QByteArray> m_postGMValues;
     /** Array of the last preGM values written before the zeroIntensityChannels call  */
     QScopedPointer<QByteArray> m_lastPostGMValues;
+    /** The range of channels changed in the last hasChanged() call */
+    int m_changedStart;
+    int m_changedCount;
+
+    /** The values published by updateMonitorValues() */
+    QByteArray m_monitorValues;
+    mutable QMutex m_monitorMutex;
 
     /** Array of values from input line, when passtrhough is enabled */
     QScopedPointer<QByteArray> m_passthroughValues;
-
+    /** The engine output merged with m_passthroughValues */
+    QScopedPointer<QByteArray> m_passthroughOutput;
+    /** 0xFF on the channels received from the input so far */
+    QScopedPointer<QByteArray> m_passthroughReceived;
+    /** 0xFF on the channels changed last by the input, for LTPMerge */
+    QScopedPointer<QByteArray> m_passthroughOwned;
+    /** The engine values of the last merge, to tell which ones changed since */
+    QScopedPointer<QByteArray> m_passthroughEngineValues;
+
+    /** Offsets of the relative channels, empty until the first relative write */
     QVector<short> m_relativeValues;
 
     /* impl speedup */
@@ -550,6 +818,35 @@ public:
      */
     bool writeBlended(int channel, uchar value, BlendMode blend = NormalBlend);
 
+    /**
+     * Write a contiguous run of DMX values with the given blend mode.
+     * This is equivalent to calling writeBlended for each value, but
+     * the blend is performed on the whole run at once, using SIMD
+     * instructions where available.
+     *
+     * @param address The first channel of the run
+     * @param values The values to write
+     * @param count Number of values to write, starting from $address
+     * @param blend The blend mode to be used on $values
+     *
+     * @return true if successful, otherwise false
+     */
+    bool writeBlendedRange(int address, const uchar *values, int count, BlendMode blend = NormalBlend);
+
+    /**
+     * Write DMX values to a set of channels, not necessarily contiguous.
+     * This is equivalent to calling write for each value, but the
+     * statistics counters are updated once for the whole set.
+     *
+     * @param channels The channel numbers to write to
+     * @param values The values to write, one for each channel
+     * @param count Number of channels and values
+     * @param forceLTP Skip the HTP check on all the channels
+     *
+     * @return the number of values actually written
+     */
+    int writeMultiple(const int *channels, const uchar *values, int count, bool forceLTP = false);
+
     /*********************************************************************
      * Load & Save
      *********************************************************************/
@@ -597,7 +894,11 @@ public:
         QString const & pluginName,
         quint32 line,
         QString profileName,
-        QMap<QString, QVariant>parameters) const;
+        QMap<QString, QVariant>parameters,
+        const OutputPatch *patch = NULL) const;
+
+    /** Apply the frame rate attributes of an Output/Feedback patch tag */
+    static void loadXMLFrameRate(const QXmlStreamAttributes &attrs, OutputPatch *patch);
 
     /**
      * Save a plugin custom parameters (if available) into a tag nested
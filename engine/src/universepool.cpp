@@ -0,0 +1,207 @@
+/*
+  Q Light Controller Plus
+  universepool.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+
+#include "universepool.h"
+#include "mastertimer.h"
+#include "universe.h"
+
+/****************************************************************************
+ * UniversePoolWorker
+ ****************************************************************************/
+
+class UniversePoolWorker : public QThread
+{
+public:
+    UniversePoolWorker(UniversePool *pool)
+        : m_pool(pool)
+    {
+    }
+
+protected:
+    void run()
+    {
+        m_pool->work();
+    }
+
+private:
+    UniversePool *m_pool;
+};
+
+/****************************************************************************
+ * UniversePool
+ ****************************************************************************/
+
+UniversePool::UniversePool(int workers, QObject *parent)
+    : QObject(parent)
+    , m_workersCount(workers > 0 ? workers : qMax(1, QThread::idealThreadCount()))
+    , m_nextIndex(0)
+    , m_round(0)
+    , m_pendingTicks(0)
+    , m_activeWorkers(0)
+    , m_busy(false)
+    , m_running(false)
+{
+}
+
+UniversePool::~UniversePool()
+{
+    stop();
+}
+
+int UniversePool::workersCount() const
+{
+    return m_workersCount;
+}
+
+void UniversePool::setUniverses(const QList<Universe *> &universes)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (m_busy || m_activeWorkers > 0)
+        m_idleCondition.wait(&m_mutex);
+
+    m_universes = universes;
+}
+
+void UniversePool::start()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_running)
+        return;
+
+    m_running = true;
+
+    for (int i = 0; i < m_workersCount; i++)
+    {
+        QThread *worker = new UniversePoolWorker(this);
+        m_workers.append(worker);
+        worker->start();
+    }
+
+    qDebug() << "Universe pool started with" << m_workersCount << "workers";
+}
+
+void UniversePool::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_running == false)
+            return;
+
+        m_running = false;
+        m_roundCondition.wakeAll();
+    }
+
+    foreach (QThread *worker, m_workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+    m_workers.clear();
+
+    QMutexLocker locker(&m_mutex);
+    m_pendingTicks = 0;
+    m_busy = false;
+    m_idleCondition.wakeAll();
+
+    qDebug() << "Universe pool stopped";
+}
+
+bool UniversePool::isRunning() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_running;
+}
+
+void UniversePool::tick()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_running == false)
+        return;
+
+    // late workers still inside a round hold the previous universe
+    // list, so a new round waits for them to leave
+    if (m_busy || m_activeWorkers > 0)
+        m_pendingTicks++;
+    else
+        startRound();
+}
+
+void UniversePool::startRound()
+{
+    m_busy = true;
+    m_nextIndex.storeRelease(0);
+    m_round++;
+    m_roundCondition.wakeAll();
+}
+
+void UniversePool::finishRound()
+{
+    if (m_pendingTicks > 0)
+    {
+        m_pendingTicks--;
+        startRound();
+        return;
+    }
+
+    m_busy = false;
+    m_idleCondition.wakeAll();
+}
+
+void UniversePool::work()
+{
+    /* Workers run right below the MasterTimer thread, like Universe threads */
+    MasterTimer::setupRealTimeThread(1);
+
+    QMutexLocker locker(&m_mutex);
+    int round = m_round;
+
+    while (m_running)
+    {
+        if (round == m_round)
+        {
+            m_roundCondition.wait(&m_mutex);
+            continue;
+        }
+
+        // a worker woken up late may join a round already over:
+        // it won't find any universe left and just leaves it again
+        round = m_round;
+        QList<Universe *> universes = m_universes;
+        m_activeWorkers++;
+        locker.unlock();
+
+        int index;
+        while ((index = m_nextIndex.fetchAndAddOrdered(1)) < universes.count())
+            universes.at(index)->processFaders();
+
+        locker.relock();
+        if (--m_activeWorkers == 0 && (m_busy || m_pendingTicks > 0))
+            finishRound();
+        else if (m_activeWorkers == 0)
+            m_idleCondition.wakeAll();
+    }
+}
@@ -0,0 +1,130 @@
+/*
+  Q Light Controller Plus
+  universepool.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef UNIVERSEPOOL_H
+#define UNIVERSEPOOL_H
+
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QObject>
+#include <QMutex>
+#include <QList>
+
+class Universe;
+class QThread;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * UniversePool processes the universes with a fixed set of worker threads,
+ * instead of running a thread for each universe.
+ *
+ * At every MasterTimer tick a new round starts: the workers are woken up and
+ * each of them takes the next universe not processed yet, until the round
+ * is over. A worker done with a light universe simply takes another one, so
+ * the load spreads over the workers without any static assignment.
+ *
+ * Ticks received while a round is still running are counted and each one
+ * starts a new round as soon as the previous one is done, the same way a
+ * Universe thread catches up with the ticks it missed.
+ */
+class UniversePool : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(UniversePool)
+
+    friend class UniversePoolWorker;
+
+public:
+    /**
+     * Create a new pool with the given number of workers.
+     * When $workers is 0, the pool has a worker for each CPU core.
+     */
+    UniversePool(int workers = 0, QObject *parent = NULL);
+    ~UniversePool();
+
+    /** Get the number of worker threads of this pool */
+    int workersCount() const;
+
+    /**
+     * Set the universes processed by the pool. If a round is running,
+     * this waits for it to finish, so that the universes no longer in the
+     * list can be safely deleted as soon as this returns.
+     */
+    void setUniverses(const QList<Universe *> &universes);
+
+    /** Start the worker threads. Does nothing if they are already running */
+    void start();
+
+    /** Stop the worker threads, discarding the pending ticks */
+    void stop();
+
+    /** Return true if the worker threads are running */
+    bool isRunning() const;
+
+public slots:
+    /** Start a new round, or queue it if one is running */
+    void tick();
+
+private:
+    /** Worker threads loop */
+    void work();
+
+    /** Start processing the universes from the first one.
+     *  Must be called with m_mutex locked */
+    void startRound();
+
+    /** Called by the last worker leaving a round.
+     *  Must be called with m_mutex locked */
+    void finishRound();
+
+private:
+    int m_workersCount;
+    QList<QThread *> m_workers;
+
+    /** Universes processed at every round */
+    QList<Universe *> m_universes;
+
+    /** Index of the next universe to be taken by a worker */
+    QAtomicInt m_nextIndex;
+
+    /** Counter of the rounds started so far */
+    int m_round;
+
+    /** Number of ticks received while a round was running */
+    int m_pendingTicks;
+
+    /** Number of workers processing the current round */
+    int m_activeWorkers;
+
+    /** True from the start of a round to the end of its last universe */
+    bool m_busy;
+
+    bool m_running;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_roundCondition;
+    QWaitCondition m_idleCondition;
+};
+
+/** @} */
+
+#endif
@@ -32,6 +32,7 @@
 #define KXMLQLCVideoGeometry "Geometry"
 #define KXMLQLCVideoRotation "Rotation"
 #define KXMLQLCVideoZIndex "ZIndex"
+#define KXMLQLCVideoPreload "Preload"
 
 const QStringList Video::m_defaultVideoCaps =
         QStringList() << "*.avi" << "*.wmv" << "*.mkv" << "*.mp4" << "*.mov" << "*.mpg" << "*.mpeg" << "*.flv" << "*.webm";
@@ -54,6 +55,7 @@ Video::Video(Doc* doc)
   , m_zIndex(1)
   , m_screen(0)
   , m_fullscreen(false)
+  , m_preload(false)
 {
     setName(tr("New Video"));
     setRunOrder(Video::SingleShot);
@@ -111,6 +113,7 @@ bool Video::copyFrom(const Function* function)
 
     setSourceUrl(vid->m_sourceUrl);
     m_videoDuration = vid->m_videoDuration;
+    setPreload(vid->m_preload);
 
     return Function::copyFrom(function);
 }
@@ -321,6 +324,21 @@ bool Video::fullscreen()
     return m_fullscreen;
 }
 
+bool Video::preload() const
+{
+    return m_preload;
+}
+
+void Video::setPreload(bool enable)
+{
+    if (m_preload == enable)
+        return;
+
+    m_preload = enable;
+    emit preloadChanged(enable);
+    emit changed(id());
+}
+
 int Video::adjustAttribute(qreal fraction, int attributeId)
 {
     int attrIndex = Function::adjustAttribute(fraction, attributeId);
@@ -371,6 +389,8 @@ bool Video::saveXML(QXmlStreamWriter *doc)
         doc->writeAttribute(KXMLQLCVideoScreen, QString::number(m_screen));
     if (m_fullscreen == true)
         doc->writeAttribute(KXMLQLCVideoFullscreen, "1");
+    if (m_preload == true)
+        doc->writeAttribute(KXMLQLCVideoPreload, "1");
 #ifdef QMLUI
     if (m_customGeometry.isNull() == false)
     {
@@ -431,6 +451,9 @@ bool Video::loadXML(QXmlStreamReader &root)
                 else
                     setFullscreen(false);
             }
+
+            if (attrs.hasAttribute(KXMLQLCVideoPreload))
+                setPreload(attrs.value(KXMLQLCVideoPreload).toString() == "1");
 #ifdef QMLUI
             if (attrs.hasAttribute(KXMLQLCVideoGeometry))
             {
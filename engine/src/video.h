@@ -44,6 +44,7 @@ class Video : public Function
     Q_PROPERTY(QVector3D rotation READ rotation WRITE setRotation NOTIFY rotationChanged)
     Q_PROPERTY(int zIndex READ zIndex WRITE setZIndex NOTIFY zIndexChanged)
     Q_PROPERTY(bool fullscreen READ fullscreen WRITE setFullscreen)
+    Q_PROPERTY(bool preload READ preload WRITE setPreload NOTIFY preloadChanged)
 
     /*********************************************************************
      * Initialization
@@ -146,6 +147,14 @@ public:
     bool fullscreen();
     void setFullscreen(bool enable);
 
+    /**
+     * Get/Set if the video should be kept opened and paused on its first
+     * frame, with its output ready, so that it shows right away on start.
+     * The number of videos actually preloaded is bounded by the provider
+     */
+    bool preload() const;
+    void setPreload(bool enable);
+
     /** Get the current Video intensity */
     qreal intensity();
 
@@ -158,6 +167,7 @@ signals:
     void customGeometryChanged(QRect rect);
     void rotationChanged(QVector3D rotation);
     void zIndexChanged(int index);
+    void preloadChanged(bool enable);
     void totalTimeChanged(qint64);
     void metaDataChanged(QString key, QVariant data);
     void requestPlayback();
@@ -187,6 +197,8 @@ private:
     int m_screen;
     /** Flag that indicates if the video has to go fullscreen */
     bool m_fullscreen;
+    /** Flag that indicates if the video should be preloaded */
+    bool m_preload;
 
     /*********************************************************************
      * Save & Load
@@ -0,0 +1,169 @@
+/*
+  Q Light Controller Plus
+  workspacecache.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+
+#include "workspacecache.h"
+#include "fixture.h"
+#include "doc.h"
+
+/** "QLCW" */
+#define WORKSPACE_CACHE_MAGIC 0x514C4357
+
+/** Increase this every time the content of the cache changes,
+ *  including the data written by Fixture::saveBinary() */
+#define WORKSPACE_CACHE_VERSION 1
+
+WorkspaceCache::WorkspaceCache(const QString &workspaceFile)
+    : m_workspaceFile(workspaceFile)
+{
+}
+
+WorkspaceCache::~WorkspaceCache()
+{
+}
+
+QString WorkspaceCache::cacheFile(const QString &workspaceFile)
+{
+    return workspaceFile + QString(KExtWorkspaceCache);
+}
+
+QByteArray WorkspaceCache::workspaceHash()
+{
+    if (m_workspaceHash.isEmpty() == false)
+        return m_workspaceHash;
+
+    QFile file(m_workspaceFile);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    while (file.atEnd() == false)
+        hash.addData(file.read(65536));
+
+    m_workspaceHash = hash.result();
+    return m_workspaceHash;
+}
+
+bool WorkspaceCache::readHeader(QDataStream &stream)
+{
+    quint32 magic = 0, version = 0;
+    QByteArray hash;
+
+    stream >> magic >> version;
+    if (magic != WORKSPACE_CACHE_MAGIC || version != WORKSPACE_CACHE_VERSION)
+        return false;
+
+    stream >> hash;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    QByteArray current = workspaceHash();
+    return current.isEmpty() == false && hash == current;
+}
+
+bool WorkspaceCache::isValid()
+{
+    QFile file(cacheFile(m_workspaceFile));
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    return readHeader(stream);
+}
+
+bool WorkspaceCache::loadFixtures(Doc *doc)
+{
+    Q_ASSERT(doc != NULL);
+
+    QFile file(cacheFile(m_workspaceFile));
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    if (readHeader(stream) == false)
+        return false;
+
+    quint32 count = 0;
+    stream >> count;
+
+    // read everything before touching Doc, so that a damaged
+    // cache leaves it as it was and XML can be used instead
+    QList<Fixture *> fixtures;
+    for (quint32 i = 0; i < count; i++)
+    {
+        Fixture *fxi = new Fixture(doc);
+        fixtures.append(fxi);
+
+        if (fxi->loadBinary(stream, doc, doc->fixtureDefCache()) == false)
+        {
+            qWarning() << Q_FUNC_INFO << "Damaged workspace cache" << file.fileName();
+            qDeleteAll(fixtures);
+            return false;
+        }
+    }
+
+    foreach (Fixture *fxi, fixtures)
+    {
+        if (doc->addFixture(fxi, fxi->id()) == false)
+        {
+            qWarning() << Q_FUNC_INFO << "Fixture" << fxi->name() << "cannot be created.";
+            delete fxi;
+        }
+    }
+
+    return true;
+}
+
+bool WorkspaceCache::save(Doc *doc)
+{
+    Q_ASSERT(doc != NULL);
+
+    QByteArray hash = workspaceHash();
+    if (hash.isEmpty())
+        return false;
+
+    QFile file(cacheFile(m_workspaceFile));
+    if (file.open(QIODevice::WriteOnly) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to write" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    stream << quint32(WORKSPACE_CACHE_MAGIC) << quint32(WORKSPACE_CACHE_VERSION) << hash;
+
+    QList<Fixture *> fixtures = doc->fixtures();
+    stream << quint32(fixtures.count());
+    foreach (Fixture *fxi, fixtures)
+        fxi->saveBinary(stream);
+
+    // a cache left half written is refused when loaded,
+    // since its fixtures cannot be read completely
+    return stream.status() == QDataStream::Ok;
+}
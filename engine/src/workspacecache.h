@@ -0,0 +1,87 @@
+/*
+  Q Light Controller Plus
+  workspacecache.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WORKSPACECACHE_H
+#define WORKSPACECACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+class QDataStream;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Extension appended to a workspace file name to get its cache */
+#define KExtWorkspaceCache ".cache"
+
+/**
+ * WorkspaceCache is a binary snapshot of the fixtures of a workspace, stored
+ * next to the workspace file. It is bound to the exact content of the file
+ * it has been written for by a SHA-1 hash, so that any change to the
+ * workspace, made by QLC+ or not, invalidates it.
+ *
+ * When a valid cache is set to Doc with Doc::setWorkspaceCache(), the
+ * fixtures are restored from it instead of being parsed from XML.
+ */
+class WorkspaceCache
+{
+public:
+    WorkspaceCache(const QString &workspaceFile);
+    ~WorkspaceCache();
+
+    /** Get the path of the cache of $workspaceFile */
+    static QString cacheFile(const QString &workspaceFile);
+
+    /** Check if the cache exists and has been written for the
+     *  current content of the workspace file */
+    bool isValid();
+
+    /**
+     * Add the cached fixtures to $doc
+     *
+     * @return false if the cache is not valid or damaged
+     */
+    bool loadFixtures(Doc *doc);
+
+    /**
+     * Write the fixtures of $doc to the cache, bound to the current
+     * content of the workspace file
+     *
+     * @return true if successful, otherwise false
+     */
+    bool save(Doc *doc);
+
+private:
+    /** Get the hash of the workspace file content, computed once */
+    QByteArray workspaceHash();
+
+    /** Read and check the cache header at the beginning of $stream */
+    bool readHeader(QDataStream &stream);
+
+private:
+    QString m_workspaceFile;
+    QByteArray m_workspaceHash;
+};
+
+/** @} */
+
+#endif
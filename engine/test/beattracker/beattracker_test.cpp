@@ -0,0 +1,132 @@
+/*
+  Q Light Controller Plus - Unit test
+  beattracker_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "beattracker_test.h"
+#include "beattracker.h"
+#undef private
+
+static const int jitterPattern[] = { 0, 15, -10, 5, -20, 10, -5, 20, -15, 0 };
+
+void BeatTracker_Test::initial()
+{
+    BeatTracker tracker;
+    QCOMPARE(tracker.latency(), 0);
+    QVERIFY(tracker.isLocked() == false);
+    QCOMPARE(tracker.bpm(), 0.0);
+    QCOMPARE(tracker.beatDelay(1000), 0);
+
+    // a single beat doesn't tell the tempo
+    QVERIFY(tracker.addBeat(1000) == true);
+    QVERIFY(tracker.isLocked() == false);
+    QVERIFY(tracker.addBeat(1500) == true);
+    QVERIFY(tracker.isLocked() == true);
+    QCOMPARE(tracker.period(), 500.0);
+    QCOMPARE(tracker.bpm(), 120.0);
+}
+
+void BeatTracker_Test::jitter()
+{
+    BeatTracker tracker;
+    for (int i = 0; i < 40; i++)
+        QVERIFY(tracker.addBeat(1000 + 500 * i + jitterPattern[i % 10]) == true);
+
+    QVERIFY(tracker.isLocked() == true);
+    QVERIFY(qAbs(tracker.bpm() - 120.0) < 1.0);
+
+    // the estimated phase stays on the regular beats
+    QVERIFY(qAbs(tracker.beatDelay(1000 + 500 * 39)) <= 5);
+    QVERIFY(qAbs(tracker.beatDelay(1000 + 500 * 39 + 100) - 100) <= 5);
+}
+
+void BeatTracker_Test::duplicate()
+{
+    BeatTracker tracker;
+    QVERIFY(tracker.addBeat(1000) == true);
+    QVERIFY(tracker.addBeat(1020) == false);
+    QVERIFY(tracker.isLocked() == false);
+
+    for (int i = 1; i < 10; i++)
+        QVERIFY(tracker.addBeat(1000 + 500 * i) == true);
+
+    // a beat received twice is dropped and doesn't change the tempo
+    QVERIFY(tracker.addBeat(1000 + 500 * 9 + 20) == false);
+    QCOMPARE(tracker.bpm(), 120.0);
+    QVERIFY(tracker.addBeat(1000 + 500 * 10) == true);
+    QCOMPARE(tracker.bpm(), 120.0);
+}
+
+void BeatTracker_Test::latency()
+{
+    BeatTracker tracker;
+    tracker.setLatency(100);
+    QCOMPARE(tracker.latency(), 100);
+
+    for (int i = 0; i < 10; i++)
+        tracker.addBeat(500 * i + 100);
+
+    // the beat happened before being received
+    QCOMPARE(tracker.beatDelay(500 * 9 + 100), 100);
+    QCOMPARE(tracker.bpm(), 120.0);
+
+    // a latency longer than a beat refers to the latest predicted beat
+    tracker.reset();
+    tracker.setLatency(600);
+    QVERIFY(tracker.isLocked() == false);
+
+    for (int i = 0; i < 10; i++)
+        tracker.addBeat(500 * i + 600);
+
+    QCOMPARE(tracker.beatDelay(500 * 9 + 600), 100);
+}
+
+void BeatTracker_Test::tempoChange()
+{
+    BeatTracker tracker;
+    qint64 time = 1000;
+    for (int i = 0; i < 10; i++, time += 500)
+        tracker.addBeat(time);
+
+    QCOMPARE(tracker.bpm(), 120.0);
+
+    // every beat at the new tempo is out of the tolerance after a couple
+    // of them, then the tracker locks on the new tempo
+    for (int i = 0; i < 10; i++, time += 400)
+        tracker.addBeat(time);
+
+    QVERIFY(tracker.isLocked() == true);
+    QVERIFY(qAbs(tracker.bpm() - 150.0) < 1.0);
+}
+
+void BeatTracker_Test::pause()
+{
+    BeatTracker tracker;
+    for (int i = 0; i < 10; i++)
+        tracker.addBeat(500 * i);
+
+    // beats restarting after a pause are tracked from scratch
+    QVERIFY(tracker.addBeat(20000) == true);
+    QVERIFY(tracker.isLocked() == false);
+    QVERIFY(tracker.addBeat(20400) == true);
+    QCOMPARE(tracker.bpm(), 150.0);
+}
+
+QTEST_APPLESS_MAIN(BeatTracker_Test)
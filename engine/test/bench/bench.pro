@@ -0,0 +1,23 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = bench_test
+
+QT      += testlib
+qmlui {
+  QT += qml
+} else {
+  QT += script
+}
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+INCLUDEPATH  += ../workspacegen
+QMAKE_LIBDIR += ../../src
+LIBS         += -lqlcplusengine
+
+SOURCES += bench_test.cpp ../workspacegen/workspacegenerator.cpp
+HEADERS += bench_test.h ../workspacegen/workspacegenerator.h ../common/resource_paths.h
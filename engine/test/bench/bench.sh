@@ -0,0 +1,18 @@
+#!/bin/bash
+#
+# Run the engine benchmarks and write the results as QTestLib XML,
+# one BenchmarkResult element per benchmark row.
+#
+# Usage: ./bench.sh [output file] [QTestLib options]
+#
+
+export LD_LIBRARY_PATH=$LD_LIBRARY_PATH:../../src
+export DYLD_FALLBACK_LIBRARY_PATH=../../src
+
+OUTPUT=${1:-bench-results.xml}
+shift
+
+./bench_test -xml -o ${OUTPUT} "$@"
+RESULT=${?}
+echo "Benchmark results written to ${OUTPUT}"
+exit ${RESULT}
@@ -0,0 +1,451 @@
+/*
+  Q Light Controller Plus - Unit test
+  bench_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include "workspacegenerator.h"
+#include "rgbscriptscache.h"
+#include "qlcfixturemode.h"
+#include "qlcfixturedef.h"
+#include "inputoutputmap.h"
+#include "genericfader.h"
+#include "rgbalgorithm.h"
+#include "fadechannel.h"
+#include "mastertimer.h"
+#include "chaserstep.h"
+#include "efxfixture.h"
+#include "bench_test.h"
+#include "universe.h"
+#include "rgbaudio.h"
+#include "fixture.h"
+#include "qlcfile.h"
+#include "chaser.h"
+#include "scene.h"
+#include "efx.h"
+#include "doc.h"
+
+#include "../common/resource_paths.h"
+
+void Bench_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+
+    QDir dir(INTERNAL_FIXTUREDIR);
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QVERIFY(m_doc->fixtureDefCache()->loadMap(dir) == true);
+
+    QVERIFY(m_doc->rgbScriptsCache()->load(QDir(INTERNAL_SCRIPTDIR)));
+}
+
+void Bench_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void Bench_Test::cleanup()
+{
+    m_doc->clearContents();
+}
+
+void Bench_Test::addDimmers(int channels)
+{
+    for (int ch = 0; ch < channels; ch += UNIVERSE_SIZE)
+    {
+        Fixture* fxi = new Fixture(m_doc);
+        fxi->setChannels(qMin(channels - ch, UNIVERSE_SIZE));
+        fxi->setUniverse(ch / UNIVERSE_SIZE);
+        fxi->setAddress(0);
+        m_doc->addFixture(fxi);
+    }
+}
+
+/*****************************************************************************
+ * Fader
+ *****************************************************************************/
+
+void Bench_Test::faderWrite_data()
+{
+    QTest::addColumn<int>("channels");
+
+    QTest::newRow("64") << 64;
+    QTest::newRow("256") << 256;
+    QTest::newRow("512") << 512;
+}
+
+void Bench_Test::faderWrite()
+{
+    QFETCH(int, channels);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+    for (int i = 0; i < channels; i++)
+    {
+        FadeChannel fc(m_doc, Fixture::invalidId(), quint32(i));
+        fc.setStart(0);
+        fc.setTarget(255);
+        // long enough to keep interpolating for the whole benchmark
+        fc.setFadeTime(UINT_MAX / 2);
+        fader->add(fc);
+    }
+
+    QBENCHMARK
+    {
+        fader->write(ua[0]);
+    }
+
+    ua[0]->dismissFader(fader);
+    m_doc->inputOutputMap()->releaseUniverses(false);
+}
+
+/*****************************************************************************
+ * Universe
+ *****************************************************************************/
+
+void Bench_Test::universeBlend_data()
+{
+    QTest::addColumn<int>("blend");
+
+    QTest::newRow("Normal") << int(Universe::NormalBlend);
+    QTest::newRow("Mask") << int(Universe::MaskBlend);
+    QTest::newRow("Additive") << int(Universe::AdditiveBlend);
+    QTest::newRow("Subtractive") << int(Universe::SubtractiveBlend);
+}
+
+void Bench_Test::universeBlend()
+{
+    QFETCH(int, blend);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    for (int i = 0; i < UNIVERSE_SIZE; i++)
+        ua[0]->setChannelCapability(ushort(i), (i % 4) ? QLCChannel::Colour : QLCChannel::Intensity);
+
+    QByteArray values(UNIVERSE_SIZE, char(127));
+    const uchar *data = reinterpret_cast<const uchar *>(values.constData());
+
+    QBENCHMARK
+    {
+        ua[0]->writeBlendedRange(0, data, values.size(), Universe::BlendMode(blend));
+    }
+
+    m_doc->inputOutputMap()->releaseUniverses(false);
+}
+
+/*****************************************************************************
+ * Scene
+ *****************************************************************************/
+
+void Bench_Test::sceneStart_data()
+{
+    QTest::addColumn<int>("values");
+
+    QTest::newRow("64") << 64;
+    QTest::newRow("512") << 512;
+    QTest::newRow("2048") << 2048;
+}
+
+void Bench_Test::sceneStart()
+{
+    QFETCH(int, values);
+
+    addDimmers(values);
+
+    Scene* s = new Scene(m_doc);
+    foreach (Fixture *fxi, m_doc->fixtures())
+    {
+        for (quint32 ch = 0; ch < fxi->channels(); ch++)
+            s->setValue(fxi->id(), ch, uchar(ch));
+    }
+    m_doc->addFunction(s);
+    QCOMPARE(s->values().count(), values);
+
+    MasterTimer timer(m_doc);
+
+    // a start is the first write of the Scene, then its postRun
+    QBENCHMARK
+    {
+        s->start(&timer, FunctionParent::master());
+        timer.timerTick();
+        s->stop(FunctionParent::master());
+        timer.timerTick();
+    }
+
+    QVERIFY(s->isRunning() == false);
+}
+
+/*****************************************************************************
+ * RGB Matrix
+ *****************************************************************************/
+
+void Bench_Test::rgbMap_data()
+{
+    QTest::addColumn<QString>("algorithm");
+    QTest::addColumn<int>("size");
+
+    RGBAudio audio(m_doc);
+
+    foreach (QString name, RGBAlgorithm::algorithms(m_doc))
+    {
+        // audio needs a capture device, which is not there in a benchmark
+        if (name == audio.name())
+            continue;
+
+        foreach (int size, QList<int>() << 8 << 32 << 64)
+        {
+            QString row = QString("%1 %2x%2").arg(name).arg(size);
+            QTest::newRow(row.toUtf8().constData()) << name << size;
+        }
+    }
+}
+
+void Bench_Test::rgbMap()
+{
+    QFETCH(QString, algorithm);
+    QFETCH(int, size);
+
+    RGBAlgorithm *algo = RGBAlgorithm::algorithm(m_doc, algorithm);
+    QVERIFY(algo != NULL);
+
+    QSize mapSize(size, size);
+    int steps = qMax(1, algo->rgbMapStepCount(mapSize));
+    int step = 0;
+    RGBMap map;
+
+    QBENCHMARK
+    {
+        algo->rgbMap(mapSize, 0x00ff0000, step, map);
+        step = (step + 1) % steps;
+    }
+
+    algo->postRun();
+    delete algo;
+}
+
+/*****************************************************************************
+ * EFX
+ *****************************************************************************/
+
+void Bench_Test::efxWrite_data()
+{
+    QTest::addColumn<int>("fixtures");
+
+    QTest::newRow("8") << 8;
+    QTest::newRow("32") << 32;
+    QTest::newRow("128") << 128;
+}
+
+void Bench_Test::efxWrite()
+{
+    QFETCH(int, fixtures);
+
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("Martin", "MAC250+");
+    QVERIFY(def != NULL);
+    QLCFixtureMode* mode = def->mode("Mode 4");
+    QVERIFY(mode != NULL);
+
+    EFX* e = new EFX(m_doc);
+
+    quint32 address = 0;
+    for (int i = 0; i < fixtures; i++)
+    {
+        Fixture* fxi = new Fixture(m_doc);
+        fxi->setFixtureDefinition(def, mode);
+        if ((address % UNIVERSE_SIZE) + fxi->channels() > UNIVERSE_SIZE)
+            address += UNIVERSE_SIZE - (address % UNIVERSE_SIZE);
+        fxi->setUniverse(address / UNIVERSE_SIZE);
+        fxi->setAddress(address % UNIVERSE_SIZE);
+        address += fxi->channels();
+        m_doc->addFixture(fxi);
+
+        EFXFixture* ef = new EFXFixture(e);
+        ef->setHead(GroupHead(fxi->id(), 0));
+        e->addFixture(ef);
+    }
+    m_doc->addFunction(e);
+
+    MasterTimer timer(m_doc);
+    e->start(&timer, FunctionParent::master());
+    timer.timerTick();
+
+    QBENCHMARK
+    {
+        timer.timerTick();
+    }
+
+    e->stop(FunctionParent::master());
+    timer.timerTick();
+    QVERIFY(e->isRunning() == false);
+}
+
+/*****************************************************************************
+ * Chaser
+ *****************************************************************************/
+
+void Bench_Test::chaserStepFlip_data()
+{
+    QTest::addColumn<int>("values");
+
+    QTest::newRow("64") << 64;
+    QTest::newRow("512") << 512;
+    QTest::newRow("2048") << 2048;
+}
+
+void Bench_Test::chaserStepFlip()
+{
+    QFETCH(int, values);
+
+    addDimmers(values);
+
+    Chaser* c = new Chaser(m_doc);
+    for (int i = 0; i < 4; i++)
+    {
+        Scene* s = new Scene(m_doc);
+        foreach (Fixture *fxi, m_doc->fixtures())
+        {
+            for (quint32 ch = 0; ch < fxi->channels(); ch++)
+                s->setValue(fxi->id(), ch, uchar(i * 64));
+        }
+        m_doc->addFunction(s);
+        c->addStep(ChaserStep(s->id()));
+    }
+
+    // one step per tick, so that every tick flips a step
+    c->setFadeInSpeed(0);
+    c->setFadeOutSpeed(0);
+    c->setDuration(MasterTimer::tick());
+    m_doc->addFunction(c);
+
+    MasterTimer timer(m_doc);
+    c->start(&timer, FunctionParent::master());
+    timer.timerTick();
+
+    QBENCHMARK
+    {
+        timer.timerTick();
+    }
+
+    c->stop(FunctionParent::master());
+    timer.timerTick();
+    timer.timerTick();
+    QVERIFY(c->isRunning() == false);
+}
+
+/*****************************************************************************
+ * Workspace
+ *****************************************************************************/
+
+void Bench_Test::workspaceLoad_data()
+{
+    QTest::addColumn<int>("scenes");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+void Bench_Test::workspaceLoad()
+{
+    QFETCH(int, scenes);
+
+    addDimmers(UNIVERSE_SIZE * 2);
+    for (int i = 0; i < scenes; i++)
+    {
+        Scene* s = new Scene(m_doc);
+        s->setName(QString("Scene %1").arg(i));
+        foreach (Fixture *fxi, m_doc->fixtures())
+        {
+            for (quint32 ch = i % 8; ch < fxi->channels(); ch += 8)
+                s->setValue(fxi->id(), ch, uchar(i));
+        }
+        m_doc->addFunction(s);
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+    QVERIFY(m_doc->saveXML(&xmlWriter) == true);
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    Doc doc(this);
+
+    QBENCHMARK
+    {
+        doc.clearContents();
+        buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+        QXmlStreamReader xmlReader(&buffer);
+        xmlReader.readNextStartElement();
+        doc.loadXML(xmlReader);
+        buffer.close();
+    }
+
+    QCOMPARE(doc.functions().count(), scenes);
+}
+
+void Bench_Test::rigLoad_data()
+{
+    QTest::addColumn<int>("universes");
+    QTest::addColumn<int>("fixtures");
+    QTest::addColumn<int>("functions");
+
+    QTest::newRow("4 universes") << 4 << 100 << 200;
+    QTest::newRow("16 universes") << 16 << 800 << 1600;
+}
+
+void Bench_Test::rigLoad()
+{
+    QFETCH(int, universes);
+    QFETCH(int, fixtures);
+    QFETCH(int, functions);
+
+    WorkspaceGenerator generator(universes, fixtures, functions, 0);
+    QVERIFY(generator.generate(m_doc) == true);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+    QVERIFY(m_doc->saveXML(&xmlWriter) == true);
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    /* The generated fixtures and matrices need the definitions and scripts */
+    Doc doc(this);
+    QDir dir(INTERNAL_FIXTUREDIR);
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QVERIFY(doc.fixtureDefCache()->loadMap(dir) == true);
+    QVERIFY(doc.rgbScriptsCache()->load(QDir(INTERNAL_SCRIPTDIR)));
+
+    QBENCHMARK
+    {
+        doc.clearContents();
+        buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+        QXmlStreamReader xmlReader(&buffer);
+        xmlReader.readNextStartElement();
+        doc.loadXML(xmlReader);
+        buffer.close();
+    }
+
+    QCOMPARE(doc.fixtures().count(), fixtures);
+    QCOMPARE(doc.functions().count(), m_doc->functions().count());
+}
+
+QTEST_MAIN(Bench_Test)
@@ -0,0 +1,74 @@
+/*
+  Q Light Controller Plus - Unit test
+  bench_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BENCH_TEST_H
+#define BENCH_TEST_H
+
+#include <QObject>
+
+class Doc;
+
+/**
+ * Engine microbenchmarks. Every benchmark is data driven on the size of
+ * the work, so that the results of different releases can be compared
+ * row by row. bench.sh runs them and writes the results as XML.
+ */
+class Bench_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void faderWrite_data();
+    void faderWrite();
+
+    void universeBlend_data();
+    void universeBlend();
+
+    void sceneStart_data();
+    void sceneStart();
+
+    void rgbMap_data();
+    void rgbMap();
+
+    void efxWrite_data();
+    void efxWrite();
+
+    void chaserStepFlip_data();
+    void chaserStepFlip();
+
+    void workspaceLoad_data();
+    void workspaceLoad();
+
+    void rigLoad_data();
+    void rigLoad();
+
+private:
+    /** Add generic dimmer packs to m_doc covering $channels channels,
+     *  one universe after the other */
+    void addDimmers(int channels);
+
+private:
+    Doc* m_doc;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#!/bin/bash
+export LD_LIBRARY_PATH=$LD_LIBRARY_PATH:../../src
+export DYLD_FALLBACK_LIBRARY_PATH=../../src
+# a single iteration per benchmark, just to check that they all run.
+# Use bench.sh to measure
+./bench_test -iterations 1
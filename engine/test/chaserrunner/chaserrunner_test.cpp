@@ -1308,6 +1308,43 @@ void ChaserRunner_Test::writeNoAutoStep()
     }
 }
 
+void ChaserRunner_Test::prefetchNextStep()
+{
+    m_chaser->setDirection(Function::Forward);
+    m_chaser->setRunOrder(Function::PingPong);
+
+    uint dur = MasterTimer::tick() * 5;
+    m_chaser->setDuration(dur);
+
+    ChaserRunner cr(m_doc, m_chaser);
+    MasterTimer timer(m_doc);
+
+    QVERIFY(m_scene2->m_channelPlanChanged == true);
+    QVERIFY(m_scene3->m_channelPlanChanged == true);
+
+    // Step 1: the plan of step 2 is built before it starts
+    for (uint i = 0; i < dur; i += MasterTimer::tick())
+    {
+        QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+        timer.timerTick();
+        QCOMPARE(timer.m_functionList[0], m_scene1);
+    }
+
+    QVERIFY(m_scene2->m_channelPlanChanged == false);
+    QVERIFY(m_scene3->m_channelPlanChanged == true);
+
+    // Step 2, then the prediction must not change the runner state
+    for (uint i = 0; i < dur; i += MasterTimer::tick())
+    {
+        QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+        timer.timerTick();
+        QCOMPARE(timer.m_functionList[0], m_scene2);
+    }
+
+    QVERIFY(m_scene3->m_channelPlanChanged == false);
+    QCOMPARE(cr.m_direction, Function::Forward);
+}
+
 void ChaserRunner_Test::adjustIntensity()
 {
     m_chaser->setDirection(Function::Forward);
@@ -594,4 +594,68 @@ void Collection_Test::stopNotOwnChildren()
     QVERIFY(s2->stopped() == true);
 }
 
+void Collection_Test::nestedCollections()
+{
+    Doc* doc = new Doc(this);
+
+    Fixture* fxi = new Fixture(doc);
+    fxi->setAddress(0);
+    fxi->setUniverse(0);
+    fxi->setChannels(4);
+    doc->addFixture(fxi);
+
+    Scene* s1 = new Scene(doc);
+    s1->setValue(fxi->id(), 0, UCHAR_MAX);
+    doc->addFunction(s1);
+
+    Scene* s2 = new Scene(doc);
+    s2->setValue(fxi->id(), 1, UCHAR_MAX);
+    doc->addFunction(s2);
+
+    Collection* inner = new Collection(doc);
+    inner->addFunction(s1->id());
+    inner->addFunction(s2->id());
+    doc->addFunction(inner);
+
+    Collection* middle = new Collection(doc);
+    middle->addFunction(inner->id());
+    doc->addFunction(middle);
+
+    // s2 is both a direct and a nested member
+    Collection* c = new Collection(doc);
+    c->addFunction(middle->id());
+    c->addFunction(s2->id());
+    doc->addFunction(c);
+
+    QList<Universe*> ua;
+    ua.append(new Universe(0, new GrandMaster()));
+    MasterTimerStub* mts = new MasterTimerStub(m_doc, ua);
+
+    c->start(mts, FunctionParent::master());
+    QCOMPARE(c->m_leaves.count(), 2);
+    QVERIFY(c->m_leaves.at(0).m_function == s1);
+    QVERIFY(c->m_leaves.at(1).m_function == s2);
+
+    c->write(mts, ua);
+
+    // leaves are started directly, nested collections are not
+    QVERIFY(s1->stopped() == false);
+    QVERIFY(s2->stopped() == false);
+    QVERIFY(inner->stopped() == true);
+    QVERIFY(middle->stopped() == true);
+    QCOMPARE(c->m_runningChildren.count(), 2);
+    QVERIFY(c->m_runningChildren.contains(inner->id()) == false);
+
+    c->stop(FunctionParent::master());
+    c->write(mts, ua);
+    c->postRun(mts, ua);
+
+    QVERIFY(s1->stopped() == true);
+    QVERIFY(s2->stopped() == true);
+    QVERIFY(c->m_leaves.isEmpty());
+
+    delete mts;
+    delete doc;
+}
+
 QTEST_APPLESS_MAIN(Collection_Test)
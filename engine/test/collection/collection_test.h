@@ -50,6 +50,7 @@ private slots:
     void write();
 
     void stopNotOwnChildren();
+    void nestedCollections();
 
 private:
     Doc* m_doc;
@@ -410,6 +410,31 @@ void CueStack_Test::removeCues()
     QCOMPARE(cs.cues().size(), 0);
 }
 
+void CueStack_Test::snapshots()
+{
+    CueStack cs(m_doc);
+    cs.appendCue(Cue("One"));
+
+    const QList <Cue> &reading = cs.acquireCues();
+    QCOMPARE(reading.size(), 1);
+
+    // editing publishes a new list and keeps the one being read
+    cs.appendCue(Cue("Two"));
+    QCOMPARE(reading.size(), 1);
+    QCOMPARE(reading.at(0).name(), QString("One"));
+    QCOMPARE(cs.cues().size(), 2);
+    QCOMPARE(cs.m_retiredCues.size(), 1);
+
+    QCOMPARE(cs.acquireCues().size(), 2);
+    cs.setName("Uno", 0);
+    QCOMPARE(cs.name(0), QString("Uno"));
+    QCOMPARE(cs.acquireCues().at(0).name(), QString("Uno"));
+
+    // only the list read before the last edit is still retained
+    QCOMPARE(cs.m_retiredCues.size(), 1);
+    QCOMPARE(cs.m_retiredCues.first()->at(0).name(), QString("One"));
+}
+
 void CueStack_Test::loadEmpty()
 {
     QBuffer buffer;
@@ -41,6 +41,7 @@ private slots:
     void currentIndex();
     void removeCue();
     void removeCues();
+    void snapshots();
 
     void loadEmpty();
     void loadID();
@@ -0,0 +1,178 @@
+/*
+  Q Light Controller Plus - Unit test
+  dmxrecordingfile_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "dmxrecordingfile_test.h"
+#include "dmxrecordingfile.h"
+
+#define TEST_FILE "test.qxr"
+
+void DMXRecordingFile_Test::cleanup()
+{
+    QFile::remove(TEST_FILE);
+}
+
+void DMXRecordingFile_Test::writeRecording(bool truncate)
+{
+    QByteArray data = DMXRecordingFile::header();
+
+    QByteArray uni0(512, 0);
+    QByteArray uni1(512, 0);
+    DMXRecordingFile::appendKeyFrame(data, 0, 0, uni0);
+    DMXRecordingFile::appendKeyFrame(data, 0, 1, uni1);
+
+    /* channel 10 of universe 0 goes up every 100ms,
+       while universe 1 changes at once at 1s */
+    for (int i = 1; i <= 20; i++)
+    {
+        QByteArray prev = uni0;
+        uni0[10] = char(i * 10);
+        DMXRecordingFile::appendDelta(data, quint32(i * 100), 0, prev, uni0);
+
+        if (i == 10)
+        {
+            uni1.fill(char(255));
+            DMXRecordingFile::appendKeyFrame(data, 1000, 1, uni1);
+        }
+    }
+
+    if (truncate)
+        data.chop(5);
+
+    QFile file(TEST_FILE);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+    file.close();
+}
+
+void DMXRecordingFile_Test::appendDelta()
+{
+    QByteArray prev(512, 0);
+    QByteArray curr(prev);
+    QByteArray out;
+
+    /* no change, no record */
+    QVERIFY(DMXRecordingFile::appendDelta(out, 0, 0, prev, curr) == false);
+    QVERIFY(out.isEmpty());
+
+    /* a delta stores only the changed channel */
+    curr[5] = char(100);
+    QVERIFY(DMXRecordingFile::appendDelta(out, 0, 0, prev, curr) == true);
+    QCOMPARE(out.size(), 12 + 3);
+
+    /* changing everything makes a key frame */
+    out.clear();
+    curr.fill(char(1));
+    QVERIFY(DMXRecordingFile::appendDelta(out, 0, 0, prev, curr) == true);
+    QCOMPARE(out.size(), 12 + 512);
+}
+
+void DMXRecordingFile_Test::invalidFile()
+{
+    DMXRecordingFile rec;
+    QVERIFY(rec.open("nonexistent.qxr") == false);
+    QVERIFY(rec.isOpen() == false);
+
+    QFile file(TEST_FILE);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("<?xml version=\"1.0\"?>");
+    file.close();
+
+    QVERIFY(rec.open(TEST_FILE) == false);
+    QVERIFY(rec.isOpen() == false);
+}
+
+void DMXRecordingFile_Test::readNext()
+{
+    writeRecording();
+
+    DMXRecordingFile rec;
+    QVERIFY(rec.open(TEST_FILE) == true);
+    QVERIFY(rec.isOpen() == true);
+    QCOMPARE(rec.duration(), quint32(2000));
+    QCOMPARE(rec.universes().count(), 2);
+
+    QHash<quint32, QByteArray> frames;
+    rec.seek(0, frames);
+    QCOMPARE(frames.count(), 2);
+    QCOMPARE(frames[0].size(), 512);
+    QCOMPARE(uchar(frames[0].at(10)), uchar(0));
+
+    DMXRecordingFile::Record record;
+    /* nothing else is due before 100ms */
+    QVERIFY(rec.readNext(99, record) == false);
+
+    QVERIFY(rec.readNext(250, record) == true);
+    QCOMPARE(record.time, quint32(100));
+    QCOMPARE(record.universe, quint16(0));
+    QCOMPARE(record.type, quint16(DMXRecordingFile::Delta));
+    DMXRecordingFile::apply(record, frames[0]);
+    QCOMPARE(uchar(frames[0].at(10)), uchar(10));
+
+    QVERIFY(rec.readNext(250, record) == true);
+    QCOMPARE(record.time, quint32(200));
+    DMXRecordingFile::apply(record, frames[0]);
+    QCOMPARE(uchar(frames[0].at(10)), uchar(20));
+
+    QVERIFY(rec.readNext(250, record) == false);
+}
+
+void DMXRecordingFile_Test::seek()
+{
+    writeRecording();
+
+    DMXRecordingFile rec;
+    QVERIFY(rec.open(TEST_FILE) == true);
+
+    QHash<quint32, QByteArray> frames;
+    rec.seek(1550, frames);
+    QCOMPARE(frames.count(), 2);
+    QCOMPARE(uchar(frames[0].at(10)), uchar(150));
+    QCOMPARE(uchar(frames[0].at(11)), uchar(0));
+    QCOMPARE(uchar(frames[1].at(0)), uchar(255));
+    QCOMPARE(uchar(frames[1].at(511)), uchar(255));
+
+    /* the next record is the one after the seek time */
+    DMXRecordingFile::Record record;
+    QVERIFY(rec.readNext(5000, record) == true);
+    QCOMPARE(record.time, quint32(1600));
+
+    /* seeking back */
+    rec.seek(500, frames);
+    QCOMPARE(uchar(frames[0].at(10)), uchar(50));
+    QCOMPARE(uchar(frames[1].at(0)), uchar(0));
+}
+
+void DMXRecordingFile_Test::truncated()
+{
+    writeRecording(true);
+
+    /* an interrupted recording plays up to its last complete record */
+    DMXRecordingFile rec;
+    QVERIFY(rec.open(TEST_FILE) == true);
+    QCOMPARE(rec.duration(), quint32(1900));
+
+    QHash<quint32, QByteArray> frames;
+    rec.seek(5000, frames);
+    QCOMPARE(uchar(frames[0].at(10)), uchar(190));
+    QCOMPARE(uchar(frames[1].at(0)), uchar(255));
+}
+
+QTEST_APPLESS_MAIN(DMXRecordingFile_Test)
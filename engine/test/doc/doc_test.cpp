@@ -81,7 +81,8 @@ void Doc_Test::cleanup()
     QCOMPARE(m_doc->m_latestFunctionId, quint32(0));
     QCOMPARE(m_doc->m_latestFixtureId, quint32(0));
     QCOMPARE(m_doc->m_latestFixtureGroupId, quint32(0));
-    QCOMPARE(m_doc->m_addresses.size(), 0);
+    QCOMPARE(m_doc->m_addressIndex.size(), 0);
+    QCOMPARE(m_doc->m_fixtureAddresses.size(), 0);
 }
 
 void Doc_Test::normalizeComponentPath()
@@ -447,6 +448,56 @@ void Doc_Test::fixture()
     QVERIFY(f4->forcedLTPChannels().count() == 1);
 }
 
+void Doc_Test::addressIndex()
+{
+    Fixture* f1 = new Fixture(m_doc);
+    f1->setChannels(10);
+    f1->setAddress(10);
+    f1->setUniverse(0);
+    QVERIFY(m_doc->addFixture(f1) == true);
+
+    Fixture* f2 = new Fixture(m_doc);
+    f2->setChannels(4);
+    f2->setAddress(510);
+    f2->setUniverse(0);
+    QVERIFY(m_doc->addFixture(f2) == true);
+
+    Fixture* f3 = new Fixture(m_doc);
+    f3->setChannels(6);
+    f3->setAddress(0);
+    f3->setUniverse(1);
+    QVERIFY(m_doc->addFixture(f3) == false); // overlaps f2 in universe 1
+    f3->setAddress(20);
+    QVERIFY(m_doc->addFixture(f3) == true);
+
+    QCOMPARE(m_doc->fixtureForAddress(9), Fixture::invalidId());
+    QCOMPARE(m_doc->fixtureForAddress(10), f1->id());
+    QCOMPARE(m_doc->fixtureForAddress(19), f1->id());
+    QCOMPARE(m_doc->fixtureForAddress(20), Fixture::invalidId());
+    QCOMPARE(m_doc->fixtureForAddress(513), f2->id());
+    QCOMPARE(m_doc->fixtureForAddress(514), Fixture::invalidId());
+    QCOMPARE(m_doc->fixtureForAddress((1 << 9) + 25), f3->id());
+
+    QVERIFY(m_doc->isAddressRangeAvailable(0, 10) == true);
+    QVERIFY(m_doc->isAddressRangeAvailable(0, 11) == false);
+    QVERIFY(m_doc->isAddressRangeAvailable(15, 2) == false);
+    QVERIFY(m_doc->isAddressRangeAvailable(5, 100) == false);
+    QVERIFY(m_doc->isAddressRangeAvailable(20, 490) == true);
+    QVERIFY(m_doc->isAddressRangeAvailable(15, 2, f1->id()) == true);
+    QVERIFY(m_doc->isAddressRangeAvailable(512, 2) == false);
+
+    /* Moving a fixture updates the index */
+    f1->setAddress(100);
+    QCOMPARE(m_doc->fixtureForAddress(10), Fixture::invalidId());
+    QCOMPARE(m_doc->fixtureForAddress(105), f1->id());
+    QVERIFY(m_doc->isAddressRangeAvailable(0, 100) == true);
+
+    QVERIFY(m_doc->deleteFixture(f1->id()) == true);
+    QCOMPARE(m_doc->fixtureForAddress(105), Fixture::invalidId());
+    QCOMPARE(m_doc->m_addressIndex.size(), 2);
+    QCOMPARE(m_doc->m_fixtureAddresses.size(), 2);
+}
+
 void Doc_Test::totalPowerConsumption()
 {
     int fuzzy = 0;
@@ -798,6 +849,15 @@ void Doc_Test::deleteFunction()
     Scene *s3 = new Scene(m_doc);
     m_doc->addFunction(s3);
 
+    s1->setName("Red Wash");
+    s2->setName("Blue Wash");
+    s3->setName("Strobe");
+    QVERIFY(m_doc->functionsByName("wash").count() == 2);
+
+    /* A list taken before a deletion is not changed by it */
+    QList<Function *> before = m_doc->functions();
+    QVERIFY(before.count() == 3);
+
     m_doc->resetModified();
 
     QPointer <Scene> ptr(s2);
@@ -806,6 +866,19 @@ void Doc_Test::deleteFunction()
     QVERIFY(m_doc->deleteFunction(id) == true);
     QVERIFY(m_doc->isModified() == true);
 
+    QList<Function *> byType = m_doc->functionsByType(Function::SceneType);
+    QVERIFY(byType.count() == 2);
+    QVERIFY(byType.at(0) == s1);
+    QVERIFY(byType.at(1) == s3);
+    QVERIFY(m_doc->functionsByType(Function::ChaserType).isEmpty());
+    QVERIFY(before.count() == 3);
+    QVERIFY(m_doc->functions().count() == 2);
+
+    QSet<quint32> byName = m_doc->functionsByName("wash");
+    QVERIFY(byName.count() == 1);
+    QVERIFY(byName.contains(s1->id()));
+    QVERIFY(m_doc->functionsByName("blue").isEmpty());
+
     m_doc->resetModified();
 
     QVERIFY(m_doc->deleteFunction(id) == false);
@@ -825,6 +898,8 @@ void Doc_Test::deleteFunction()
     QVERIFY(m_doc->isModified() == true);
 
     QVERIFY(m_doc->functions().size() == 0);
+    QVERIFY(m_doc->functionsByType(Function::SceneType).isEmpty());
+    QVERIFY(m_doc->functionsByName("").isEmpty());
 }
 
 void Doc_Test::function()
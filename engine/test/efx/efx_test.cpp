@@ -2058,6 +2058,34 @@ void EFX_Test::previewLissajousBackwards()
     }
 }
 
+void EFX_Test::trajectoryCache()
+{
+    EFX e(m_doc);
+    QVERIFY(e.m_trajectory.isEmpty() == false);
+
+    // the piecewise linear patterns are not sampled
+    e.setAlgorithm(EFX::Square);
+    QVERIFY(e.m_trajectory.isEmpty() == true);
+
+    e.setAlgorithm(EFX::Lissajous);
+    QVERIFY(e.m_trajectory.isEmpty() == false);
+    e.setXFrequency(32);
+    e.setYFrequency(0);
+    e.setXPhase(45);
+
+    // the interpolated points must match the computed pattern
+    for (int i = 0; i < 1000; i++)
+    {
+        float iterator = (M_PI * 2.0) * i / 1000;
+        float x, y, px, py;
+        e.calculatePoint(iterator, &x, &y);
+        e.calculatePatternPoint(iterator, &px, &py);
+        e.rotateAndScale(&px, &py);
+        QVERIFY(qAbs(x - px) < 0.1);
+        QVERIFY(qAbs(y - py) < 0.1);
+    }
+}
+
 void EFX_Test::widthHeightOffset()
 {
     EFX e(m_doc);
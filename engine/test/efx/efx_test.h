@@ -67,6 +67,7 @@ private slots:
     void previewSquareChoppyBackwards();
     void previewLeafBackwards();
     void previewLissajousBackwards();
+    void trajectoryCache();
 
     void rotateAndScale();
     void widthHeightOffset();
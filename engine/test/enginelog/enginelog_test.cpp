@@ -0,0 +1,140 @@
+/*
+  Q Light Controller Plus - Unit test
+  enginelog_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QThread>
+#include <QMutex>
+
+#include "enginelog_test.h"
+#include "enginelog.h"
+
+static QMutex s_messagesMutex;
+static QStringList s_messages;
+static QList<QThread *> s_sinkThreads;
+
+static void testSink(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    Q_UNUSED(type)
+    Q_UNUSED(context)
+
+    QMutexLocker locker(&s_messagesMutex);
+    s_messages.append(msg);
+    s_sinkThreads.append(QThread::currentThread());
+}
+
+class LoggingThread : public QThread
+{
+public:
+    void run()
+    {
+        for (int i = 0; i < 100; i++)
+            qCDebug(lcMasterTimer) << "thread message" << i;
+    }
+};
+
+void EngineLog_Test::cleanup()
+{
+    EngineLog::stop();
+
+    QMutexLocker locker(&s_messagesMutex);
+    s_messages.clear();
+    s_sinkThreads.clear();
+}
+
+void EngineLog_Test::limiter()
+{
+    QLCLogLimiter limiter(2);
+    int suppressed = -1;
+
+    /* Don't start right before the end of a second */
+    while (QDateTime::currentMSecsSinceEpoch() % 1000 > 500)
+        QTest::qSleep(10);
+
+    QVERIFY(limiter.allow(&suppressed) == true);
+    QCOMPARE(suppressed, 0);
+    QVERIFY(limiter.allow(&suppressed) == true);
+    QCOMPARE(suppressed, 0);
+    QVERIFY(limiter.allow() == false);
+    QVERIFY(limiter.allow() == false);
+    QVERIFY(limiter.allow() == false);
+
+    /* The next second lets messages through again,
+     * telling how many have been suppressed */
+    QTest::qSleep(1000);
+    QVERIFY(limiter.allow(&suppressed) == true);
+    QCOMPARE(suppressed, 3);
+    QVERIFY(limiter.allow(&suppressed) == true);
+    QCOMPARE(suppressed, 0);
+}
+
+void EngineLog_Test::delivery()
+{
+    EngineLog::start(testSink);
+
+    qDebug() << "plain message";
+    qCDebug(lcUniverse) << "category message";
+    qWarning() << "warning message";
+
+    /* Stopping writes the pending messages */
+    EngineLog::stop();
+
+    QMutexLocker locker(&s_messagesMutex);
+    QCOMPARE(s_messages.count(), 3);
+    QCOMPARE(s_messages.at(0), QString("plain message"));
+    QCOMPARE(s_messages.at(1), QString("[qlcplus.engine.universe] category message"));
+    QCOMPARE(s_messages.at(2), QString("warning message"));
+
+    /* ..from the flush thread */
+    QVERIFY(s_sinkThreads.at(0) != QThread::currentThread());
+    QCOMPARE(EngineLog::droppedCount(), 0);
+}
+
+void EngineLog_Test::threads()
+{
+    EngineLog::start(testSink);
+
+    LoggingThread first, second;
+    first.start();
+    second.start();
+    first.wait();
+    second.wait();
+
+    EngineLog::stop();
+
+    /* The messages of each thread are delivered in order */
+    QMutexLocker locker(&s_messagesMutex);
+    QCOMPARE(s_messages.count(), 200);
+
+    int firstNext = 0, secondNext = 0;
+    foreach (QString msg, s_messages)
+    {
+        QVERIFY(msg.startsWith("[qlcplus.engine.mastertimer] thread message"));
+        int index = msg.section(' ', -1).toInt();
+        if (index == firstNext)
+            firstNext++;
+        else if (index == secondNext)
+            secondNext++;
+        else
+            QFAIL(qPrintable(QString("Unexpected message %1").arg(msg)));
+    }
+    QCOMPARE(firstNext, 100);
+    QCOMPARE(secondNext, 100);
+}
+
+QTEST_APPLESS_MAIN(EngineLog_Test)
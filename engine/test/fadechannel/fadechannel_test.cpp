@@ -392,4 +392,119 @@ void FadeChannel_Test::calculateCurrent()
     QCOMPARE(fch.calculateCurrent(200, 200), uchar(101));
 }
 
+void FadeChannel_Test::calculateCurrent16()
+{
+    Doc doc(this);
+
+    QDir dir(INTERNAL_FIXTUREDIR);
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QVERIFY(doc.fixtureDefCache()->loadMap(dir) == true);
+
+    QLCFixtureDef *def = doc.fixtureDefCache()->fixtureDef("Futurelight", "MH-440");
+    QVERIFY(def != NULL);
+
+    QLCFixtureMode *mode = def->modes().first();
+    QVERIFY(mode != NULL);
+
+    Fixture *fxi = new Fixture(&doc);
+    fxi->setAddress(0);
+    fxi->setFixtureDefinition(def, mode);
+    doc.addFixture(fxi);
+
+    // Pan and Pan Fine
+    FadeChannel coarse(&doc, fxi->id(), 0);
+    FadeChannel fine(&doc, fxi->id(), 2);
+    QVERIFY((coarse.flags() & FadeChannel::Fine) == 0);
+    QCOMPARE(coarse.primaryChannel(), QLCChannel::invalid());
+    QVERIFY(fine.flags() & FadeChannel::Fine);
+    QCOMPARE(fine.primaryChannel(), quint32(0));
+
+    // fade from 0x1000 to 0x1200: the coarse value steps only once,
+    // while the fine value moves smoothly
+    coarse.setStart(0x10);
+    coarse.setTarget(0x12);
+    fine.setStart(0x00);
+    fine.setTarget(0x00);
+
+    QCOMPARE(coarse.calculateCurrent16(fine, 512, 0), quint16(0x1000));
+    QCOMPARE(coarse.calculateCurrent16(fine, 512, 1), quint16(0x1001));
+    QCOMPARE(coarse.calculateCurrent16(fine, 512, 255), quint16(0x10FF));
+    QCOMPARE(coarse.current(), uchar(0x10));
+    QCOMPARE(fine.current(), uchar(0xFF));
+    QCOMPARE(coarse.calculateCurrent16(fine, 512, 256), quint16(0x1100));
+    QCOMPARE(coarse.current(), uchar(0x11));
+    QCOMPARE(fine.current(), uchar(0x00));
+    QVERIFY(coarse.isReady() == false);
+
+    QCOMPARE(coarse.calculateCurrent16(fine, 512, 512), quint16(0x1200));
+    QVERIFY(coarse.isReady() == true);
+    QVERIFY(fine.isReady() == true);
+
+    // nextStep16 keeps the elapsed time of both channels in sync
+    coarse.setReady(false);
+    fine.setReady(false);
+    coarse.setFadeTime(1000);
+    coarse.setElapsed(0);
+    QCOMPARE(coarse.nextStep16(fine, 500), quint16(0x1100));
+    QCOMPARE(fine.elapsed(), uint(500));
+}
+
+void FadeChannel_Test::calculateCurrentCurves()
+{
+    FadeChannel fch;
+    fch.setStart(0);
+    fch.setTarget(255);
+
+    // an S-curve is slow at both ends and symmetric
+    QCOMPARE(fch.calculateCurrent(1000, 0, FadeCurve::SCurve), uchar(0));
+    QCOMPARE(fch.calculateCurrent(1000, 250, FadeCurve::SCurve), uchar(39));
+    QCOMPARE(fch.calculateCurrent(1000, 500, FadeCurve::SCurve), uchar(127));
+    QCOMPARE(fch.calculateCurrent(1000, 750, FadeCurve::SCurve), uchar(215));
+
+    // gamma follows the perceived brightness of a LED
+    QCOMPARE(fch.calculateCurrent(1000, 250, FadeCurve::Gamma), uchar(12));
+    QCOMPARE(fch.calculateCurrent(1000, 500, FadeCurve::Gamma), uchar(55));
+    QCOMPARE(fch.calculateCurrent(1000, 750, FadeCurve::Gamma), uchar(135));
+    QCOMPARE(fch.calculateCurrent(1000, 500, FadeCurve::Exponential), uchar(7));
+    QCOMPARE(fch.calculateCurrent(1000, 1000, FadeCurve::Gamma), uchar(255));
+
+    // a falling fade follows the curve mirrored, slow near zero
+    fch.setStart(255);
+    fch.setTarget(0);
+    fch.setReady(false);
+    QCOMPARE(fch.calculateCurrent(1000, 250, FadeCurve::Gamma), uchar(136));
+    QCOMPARE(fch.calculateCurrent(1000, 500, FadeCurve::Gamma), uchar(56));
+    QCOMPARE(fch.calculateCurrent(1000, 750, FadeCurve::Gamma), uchar(13));
+    QCOMPARE(fch.calculateCurrent(1000, 500, FadeCurve::SCurve), uchar(128));
+
+    // every curve is monotonic
+    for (int curve = FadeCurve::Linear; curve <= FadeCurve::Gamma; curve++)
+    {
+        fch.setStart(0);
+        fch.setTarget(255);
+        fch.setReady(false);
+        uchar previous = 0;
+        for (uint time = 0; time < 1000; time++)
+        {
+            uchar value = fch.calculateCurrent(1000, time, FadeCurve::Type(curve));
+            QVERIFY(value >= previous);
+            previous = value;
+        }
+
+        fch.setStart(255);
+        fch.setTarget(0);
+        previous = 255;
+        for (uint time = 0; time < 1000; time++)
+        {
+            uchar value = fch.calculateCurrent(1000, time, FadeCurve::Type(curve));
+            QVERIFY(value <= previous);
+            previous = value;
+        }
+    }
+
+    QCOMPARE(FadeCurve::stringToType(FadeCurve::typeToString(FadeCurve::Gamma)), FadeCurve::Gamma);
+    QCOMPARE(FadeCurve::stringToType("Foo"), FadeCurve::Linear);
+}
+
 QTEST_APPLESS_MAIN(FadeChannel_Test)
@@ -38,6 +38,8 @@ private slots:
     void fadeTime();
     void nextStep();
     void calculateCurrent();
+    void calculateCurrent16();
+    void calculateCurrentCurves();
 };
 
 #endif
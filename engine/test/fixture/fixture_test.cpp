@@ -29,9 +29,11 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
+#define protected public
 #include "fixture_test.h"
 #include "fixture.h"
 #include "doc.h"
+#undef protected
 
 #include "../common/resource_paths.h"
 
@@ -498,6 +500,22 @@ void Fixture_Test::fixtureDef()
     QCOMPARE(fxi.masterIntensityChannel(), quint32(1));
     QCOMPARE(fxi.rgbChannels(), QVector <quint32> ());
     QCOMPARE(fxi.cmyChannels(), QVector <quint32> () << 2 << 3 << 4);
+
+    QCOMPARE(fxi.channelNumber(QLCChannel::Intensity, QLCChannel::MSB), quint32(1));
+    QCOMPARE(fxi.channelNumber(QLCChannel::Cyan, QLCChannel::MSB), quint32(2));
+    QCOMPARE(fxi.channelNumber(QLCChannel::Shutter, QLCChannel::MSB), quint32(0));
+    QCOMPARE(fxi.channelNumber(QLCChannel::Shutter, QLCChannel::LSB), QLCChannel::invalid());
+    QCOMPARE(fxi.channelNumber(QLCChannel::Gobo, QLCChannel::MSB), QLCChannel::invalid());
+    QCOMPARE(fxi.channelNumber(QLCChannel::Speed, QLCChannel::MSB), QLCChannel::invalid());
+    QCOMPARE(fxi.channelNumber(QLCChannel::Pan, QLCChannel::MSB, 1), QLCChannel::invalid());
+    QCOMPARE(fxi.channelNumber(QLCChannel::Pan, QLCChannel::MSB, -1), QLCChannel::invalid());
+
+    QCOMPARE(fxi.channel(QLCChannel::Colour), quint32(5));
+    QCOMPARE(fxi.channel(QLCChannel::Speed), quint32(11));
+    QCOMPARE(fxi.channel(QLCChannel::Intensity), quint32(1));
+    QCOMPARE(fxi.channel(QLCChannel::Intensity, QLCChannel::Magenta), quint32(3));
+    QCOMPARE(fxi.channel(QLCChannel::Intensity, QLCChannel::Red), QLCChannel::invalid());
+    QCOMPARE(fxi.channel(QLCChannel::Gobo), QLCChannel::invalid());
 }
 
 void Fixture_Test::channels()
@@ -524,6 +542,93 @@ void Fixture_Test::channels()
     QCOMPARE(chs, fxi.channels(QLCChannel::Colour, QLCChannel::Blue));
 }
 
+void Fixture_Test::channelValues()
+{
+    Fixture fxi(this);
+    fxi.setAddress(2);
+    fxi.setChannels(4);
+    QCOMPARE(fxi.channelValues(), QByteArray(4, char(0)));
+
+    QByteArray universe(8, char(0));
+    QVERIFY(fxi.setChannelValues(universe) == false);
+
+    universe[3] = char(127);
+    universe[5] = char(255);
+    QVERIFY(fxi.setChannelValues(universe) == true);
+    QCOMPARE(fxi.channelValueAt(0), uchar(0));
+    QCOMPARE(fxi.channelValueAt(1), uchar(127));
+    QCOMPARE(fxi.channelValueAt(3), uchar(255));
+    QCOMPARE(fxi.channelValueAt(4), uchar(0));
+    QCOMPARE(fxi.channelValueAt(-1), uchar(0));
+    QCOMPARE(fxi.channelValues(), universe.mid(2, 4));
+
+    // an universe too short for the fixture changes what it covers
+    QVERIFY(fxi.setChannelValues(QByteArray(4, char(10))) == true);
+    QCOMPARE(fxi.channelValues(), QByteArray("\x0a\x0a\x00\xff", 4));
+}
+
+void Fixture_Test::aliases()
+{
+    QLCFixtureDef def;
+    def.setManufacturer("Foo");
+    def.setModel("Bar");
+
+    QLCChannel *selector = new QLCChannel();
+    selector->setName("Selector");
+    QLCCapability *plain = new QLCCapability(0, 99, "Plain");
+    QLCCapability *alias = new QLCCapability(100, 199, "Alias");
+    alias->setPreset(QLCCapability::Alias);
+    selector->addCapability(plain);
+    selector->addCapability(alias);
+    def.addChannel(selector);
+
+    QLCChannel *source = new QLCChannel();
+    source->setName("Source");
+    def.addChannel(source);
+    QLCChannel *target = new QLCChannel();
+    target->setName("Target");
+    def.addChannel(target);
+
+    QLCFixtureMode *mode = new QLCFixtureMode(&def);
+    mode->setName("Mode");
+    mode->insertChannel(selector, 0);
+    mode->insertChannel(source, 1);
+    def.addMode(mode);
+
+    AliasInfo info;
+    info.targetMode = "Mode";
+    info.sourceChannel = "Source";
+    info.targetChannel = "Target";
+    alias->addAlias(info);
+
+    Fixture fxi(this);
+    fxi.setFixtureDefinition(&def, mode);
+    QCOMPARE(fxi.m_aliasInfo.count(), 2);
+    QCOMPARE(fxi.m_aliasInfo.at(0).m_capTable.count(), 256);
+    QVERIFY(fxi.m_aliasInfo.at(0).m_capTable.at(150) == alias);
+    QVERIFY(fxi.m_aliasInfo.at(0).m_capTable.at(250) == NULL);
+    QVERIFY(fxi.m_aliasInfo.at(1).m_capTable.isEmpty());
+
+    QSignalSpy spy(&fxi, SIGNAL(aliasChanged()));
+    QByteArray universe(2, char(0));
+
+    universe[0] = char(150);
+    fxi.setChannelValues(universe);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(mode->channel(1) == target);
+
+    // the same capability does not trigger any replacement
+    universe[0] = char(199);
+    fxi.setChannelValues(universe);
+    QCOMPARE(spy.count(), 1);
+
+    // a value without a capability reverts the aliases
+    universe[0] = char(250);
+    fxi.setChannelValues(universe);
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(mode->channel(1) == source);
+}
+
 void Fixture_Test::degrees()
 {
     Fixture fxi(this);
@@ -41,6 +41,8 @@ private slots:
     void rgbPanel();
     void fixtureDef();
     void channels();
+    void channelValues();
+    void aliases();
     void degrees();
     void heads();
     void loadWrongRoot();
@@ -595,6 +595,48 @@ void FixtureGroup_Test::swap()
     QCOMPARE(grp.headsMap()[pt1], GroupHead(6, 0));
 }
 
+void FixtureGroup_Test::headGrid()
+{
+    FixtureGroup grp(m_doc);
+    QCOMPARE(grp.headGrid().size(), 0);
+
+    grp.setSize(QSize(3, 2));
+    QCOMPARE(grp.headGrid().size(), 6);
+    foreach (GroupHead head, grp.headGrid())
+        QVERIFY(head.isValid() == false);
+
+    grp.assignHead(QLCPoint(2, 1), GroupHead(1, 0));
+    grp.assignHead(QLCPoint(0, 0), GroupHead(2, 0));
+    grp.assignHead(QLCPoint(5, 5), GroupHead(3, 0));
+    QCOMPARE(grp.headGrid().at(0), GroupHead(2, 0));
+    QCOMPARE(grp.headGrid().at(5), GroupHead(1, 0));
+    QVERIFY(grp.headGrid().at(1).isValid() == false);
+
+    // Moving a head updates both cells
+    grp.swap(QLCPoint(0, 0), QLCPoint(1, 0));
+    QVERIFY(grp.headGrid().at(0).isValid() == false);
+    QCOMPARE(grp.headGrid().at(1), GroupHead(2, 0));
+
+    // A head outside the grid comes in when the group grows
+    grp.setSize(QSize(6, 6));
+    QCOMPARE(grp.headGrid().size(), 36);
+    QCOMPARE(grp.headGrid().at(1), GroupHead(2, 0));
+    QCOMPARE(grp.headGrid().at(1 * 6 + 2), GroupHead(1, 0));
+    QCOMPARE(grp.headGrid().at(5 * 6 + 5), GroupHead(3, 0));
+
+    grp.resignHead(QLCPoint(5, 5));
+    QVERIFY(grp.headGrid().at(5 * 6 + 5).isValid() == false);
+
+    FixtureGroup copy(m_doc);
+    copy.copyFrom(&grp);
+    QCOMPARE(copy.headGrid(), grp.headGrid());
+
+    grp.reset();
+    QCOMPARE(grp.headGrid().size(), 36);
+    foreach (GroupHead head, grp.headGrid())
+        QVERIFY(head.isValid() == false);
+}
+
 void FixtureGroup_Test::copy()
 {
     FixtureGroup grp1(m_doc);
@@ -830,6 +872,7 @@ void FixtureGroup_Test::load()
     QCOMPARE(grp2->name(), QString("Pertti Pasanen"));
     QCOMPARE(grp2->id(), quint32(99));
     QCOMPARE(grp2->headsMap(), grp.headsMap());
+    QCOMPARE(grp2->headGrid(), grp.headGrid());
 }
 
 void FixtureGroup_Test::save()
@@ -43,6 +43,7 @@ private slots:
     void resignHead();
     void fixtureRemoved();
     void swap();
+    void headGrid();
     void copy();
     void loadWrongID();
     void loadWrongHeadAttributes();
@@ -21,6 +21,7 @@
 #include <QtTest>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <QThread>
 
 #include "function_test.h"
 
@@ -549,6 +550,57 @@ void Function_Test::attributes()
     QCOMPARE(stub->getAttributeValue(1), 0.3); /* Last wins */
 }
 
+class AttributeWriter : public QThread
+{
+public:
+    AttributeWriter(Function *function, int attributeId)
+        : m_function(function)
+        , m_attributeId(attributeId)
+    {
+    }
+
+    void run()
+    {
+        for (int i = 0; i < 100000; i++)
+            m_function->adjustAttribute(i % 2 ? 0.25 : 0.75, m_attributeId);
+    }
+
+    Function *m_function;
+    int m_attributeId;
+};
+
+void Function_Test::attributesConcurrent()
+{
+    Doc doc(this);
+
+    Function_Stub* stub = new Function_Stub(&doc);
+    int attr = stub->requestAttributeOverride(Function::Intensity, 0.75);
+    QCOMPARE(stub->m_attributeValues.loadAcquire()->count(), 1);
+
+    // A slider thread overrides the intensity while the tick reads it
+    AttributeWriter writer(stub, attr);
+    writer.start();
+    while (writer.isFinished() == false)
+    {
+        qreal value = stub->getAttributeValue(Function::Intensity);
+        QVERIFY(value == 0.25 || value == 0.75);
+    }
+    QVERIFY(writer.wait(5000));
+    QCOMPARE(stub->getAttributeValue(Function::Intensity), 0.25);
+
+    // Registering publishes a new list of values, keeping the old one
+    int idx = stub->registerAttribute("Foo", Function::LastWins, 0.0, 1.0, 0.6);
+    QCOMPARE(stub->m_attributeValues.loadAcquire()->count(), 2);
+    QCOMPARE(stub->m_retiredValueLists.count(), 2);
+    QCOMPARE(stub->getAttributeValue(idx), 0.6);
+    QCOMPARE(stub->getAttributeValue(Function::Intensity), 0.25);
+
+    QVERIFY(stub->unregisterAttribute("Foo"));
+    QCOMPARE(stub->m_attributeValues.loadAcquire()->count(), 1);
+    QCOMPARE(stub->m_retiredValues.count(), 1);
+    QCOMPARE(stub->getAttributeValue(idx), 0.0);
+}
+
 void Function_Test::blendMode()
 {
     Doc doc(this);
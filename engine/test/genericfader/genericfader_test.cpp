@@ -30,6 +30,7 @@
 
 #define private public
 #include "genericfader.h"
+#include "mastertimer.h"
 #undef private
 
 #include "../common/resource_paths.h"
@@ -215,4 +216,250 @@ void GenericFader_Test::adjustIntensity()
     }
 }
 
+void GenericFader_Test::packedChannels()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+    FadeChannel fc;
+    fc.setFixture(m_doc, 0);
+    fc.setStart(0);
+    fc.setTarget(255);
+    fc.setFadeTime(0);
+
+    // add channels in reverse order
+    for (int i = 5; i >= 0; i--)
+    {
+        fc.setChannel(m_doc, i);
+        fader->add(fc);
+    }
+
+    QVERIFY(fader->m_channelsChanged == true);
+    fader->write(ua[0]);
+    QVERIFY(fader->m_channelsChanged == false);
+    QCOMPARE(fader->m_packedChannels.count(), 6);
+
+    for (int i = 0; i < fader->m_packedChannels.count(); i++)
+        QCOMPARE(fader->m_packedChannels.at(i)->addressInUniverse(), quint32(10 + i));
+
+    // removing a channel invalidates the packed view
+    FadeChannel *fc1 = fader->getChannelFader(m_doc, ua[0], 0, 2);
+    fader->remove(fc1);
+    QVERIFY(fader->m_channelsChanged == true);
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_packedChannels.count(), 5);
+    QCOMPARE(fader->m_packedChannels.at(2)->addressInUniverse(), quint32(13));
+}
+
+void GenericFader_Test::handOver()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+    FadeChannel fc;
+    fc.setFixture(m_doc, 0);
+    fc.setStart(0);
+    fc.setTarget(255);
+    fc.setFadeTime(0);
+
+    for (int i = 0; i < 4; i++)
+    {
+        fc.setChannel(m_doc, i);
+        fader->add(fc);
+    }
+
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_packedChannels.count(), 4);
+
+    // handed over channels are left out of the writes
+    fader->handOverChannel(0, 1);
+    fader->handOverChannel(0, 1);
+    fader->handOverChannel(0, 9);
+    QVERIFY(fader->m_channelsChanged == true);
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_packedChannels.count(), 3);
+    QCOMPARE(fader->m_handedOverCount, 1);
+    QCOMPARE(fader->channelsCount(), 4);
+    QCOMPARE(fader->m_packedChannels.at(1)->addressInUniverse(), quint32(12));
+
+    // no rebuild is needed while nothing else changes
+    fader->write(ua[0]);
+    QVERIFY(fader->m_channelsChanged == false);
+
+    fader->resetHandover();
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_packedChannels.count(), 4);
+    QCOMPARE(fader->m_handedOverCount, 0);
+
+    // a fading out fader writes all of its channels again
+    fader->handOverChannel(0, 3);
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_packedChannels.count(), 3);
+    fader->setFadeOut(true, 1000);
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_packedChannels.count(), 4);
+}
+
+void GenericFader_Test::fineChannels()
+{
+    Fixture *fxi = new Fixture(m_doc);
+    QLCFixtureDef *def = m_doc->fixtureDefCache()->fixtureDef("Futurelight", "MH-440");
+    QVERIFY(def != NULL);
+
+    QLCFixtureMode *mode = def->mode("Mode 1");
+    QVERIFY(mode != NULL);
+
+    fxi->setFixtureDefinition(def, mode);
+    fxi->setAddress(100);
+    m_doc->addFixture(fxi);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+    // create both channels before holding any pointer
+    fader->getChannelFader(m_doc, ua[0], fxi->id(), 0);
+    fader->getChannelFader(m_doc, ua[0], fxi->id(), 2);
+
+    // Pan from 0x1080 to 0x1180 in two ticks
+    FadeChannel *pan = fader->getChannelFader(m_doc, ua[0], fxi->id(), 0);
+    pan->setStart(0x10);
+    pan->setTarget(0x11);
+    pan->setFadeTime(MasterTimer::tick() * 2);
+
+    FadeChannel *panFine = fader->getChannelFader(m_doc, ua[0], fxi->id(), 2);
+    panFine->setStart(0x80);
+    panFine->setTarget(0x80);
+    panFine->setFadeTime(MasterTimer::tick() * 2);
+
+    // half way the pair must be 0x1100
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_packedPairs.at(0), 1);
+    QCOMPARE(fader->m_packedPairs.at(1), -2);
+    QCOMPARE(uchar(ua[0]->preGMValues().at(100)), uchar(0x11));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(102)), uchar(0x00));
+
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues().at(100)), uchar(0x11));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(102)), uchar(0x80));
+}
+
+void GenericFader_Test::directLayer()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+    // LTP channels 0 and 1, HTP channel 5 of the fixture at address 10
+    fader->addLayerChannel(10, false);
+    fader->addLayerChannel(11, false);
+    fader->addLayerChannel(15, true);
+    fader->addLayerChannel(15, true);
+    QCOMPARE(fader->layerChannelsCount(), 3);
+    QCOMPARE(fader->channelsCount(), 0);
+
+    fader->setLayerValue(10, 100);
+    fader->setLayerValue(15, 200);
+
+    // contiguous channels are written as a single run
+    ua[0]->zeroIntensityChannels();
+    fader->write(ua[0]);
+    QCOMPARE(fader->m_layerRuns.count(), 4);
+    QCOMPARE(uchar(ua[0]->preGMValues().at(10)), uchar(100));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(11)), uchar(0));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(15)), uchar(200));
+
+    // intensity is applied only to intensity channels
+    fader->adjustIntensity(0.5);
+    ua[0]->zeroIntensityChannels();
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues().at(10)), uchar(100));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(15)), uchar(100));
+
+    fader->removeAll();
+    QCOMPARE(fader->layerChannelsCount(), 0);
+}
+
+void GenericFader_Test::idle()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+    QVERIFY(fader->isIdle() == false);
+
+    FadeChannel fc;
+    fc.setFixture(m_doc, 0);
+    fc.setChannel(m_doc, 5);
+    fc.setStart(0);
+    fc.setTarget(250);
+    fc.setFadeTime(MasterTimer::tick() * 2);
+    fader->add(fc);
+    QVERIFY(fader->isIdle() == false);
+
+    /* Fading */
+    fader->write(ua[0]);
+    QVERIFY(fader->isIdle() == false);
+
+    /* The channel reached its target */
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues()[15]), uchar(250));
+    QVERIFY(fader->isIdle() == true);
+
+    /* Changes through a FadeChannel pointer are seen by the fader */
+    FadeChannel *ch = fader->getChannelFader(m_doc, ua[0], 0, 5);
+    ch->setTarget(250);
+    QVERIFY(fader->isIdle() == true);
+    ch->setTarget(100);
+    QVERIFY(fader->isIdle() == false);
+
+    fader->write(ua[0]);
+    QVERIFY(fader->isIdle() == true);
+
+    /* A copy of the channel is not */
+    FadeChannel copy(*ch);
+    copy.setTarget(10);
+    QVERIFY(fader->isIdle() == true);
+
+    fader->adjustIntensity(0.5);
+    QVERIFY(fader->isIdle() == false);
+    fader->write(ua[0]);
+    QVERIFY(fader->isIdle() == true);
+
+    fader->setPaused(true);
+    QVERIFY(fader->isIdle() == false);
+    fader->write(ua[0]);
+    QVERIFY(fader->isIdle() == true);
+
+    ua[0]->dismissFader(fader);
+}
+
+void GenericFader_Test::monitoring()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+    QVERIFY(ua[0]->monitorValues().isEmpty());
+
+    FadeChannel fc;
+    fc.setFixture(m_doc, 0);
+    fc.setChannel(m_doc, 5);
+    fc.setTarget(200);
+    fader->add(fc);
+
+    // not monitored
+    fader->write(ua[0]);
+    QVERIFY(ua[0]->monitorValues().isEmpty());
+
+    // the values found before writing are published
+    fader->setMonitoring(true);
+    ua[0]->write(15, 77);
+    ua[0]->write(16, 20);
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues()[15]), uchar(200));
+
+    QByteArray values = ua[0]->monitorValues();
+    QCOMPARE(values.size(), 512);
+    QCOMPARE(uchar(values.at(15)), uchar(77));
+    // only for the channels of the fader
+    QCOMPARE(uchar(values.at(16)), uchar(0));
+
+    ua[0]->dismissFader(fader);
+}
+
 QTEST_APPLESS_MAIN(GenericFader_Test)
@@ -36,6 +36,12 @@ private slots:
     void writeZeroFade();
     void writeLoop();
     void adjustIntensity();
+    void packedChannels();
+    void handOver();
+    void fineChannels();
+    void directLayer();
+    void idle();
+    void monitoring();
 
 private:
     Doc* m_doc;
@@ -24,6 +24,7 @@
 #include "inputoutputmap_test.h"
 #include "inputoutputmap.h"
 #include "qlcinputsource.h"
+#include "feedbackqueue.h"
 #include "grandmaster.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
@@ -565,6 +566,24 @@ void InputOutputMap_Test::loadInputProfiles()
     // Shouldn't load duplicates
     im.loadProfiles(dir);
     QCOMPARE(names, im.profileNames());
+
+    // The profiles are only indexed until they are requested
+    QCOMPARE(im.m_profiles.size(), 0);
+    QCOMPARE(im.m_profileFiles.size(), names.size());
+    QCOMPARE(im.profileType("Generic MIDI"), QLCInputProfile::MIDI);
+    QCOMPARE(im.m_profiles.size(), 0);
+
+    QLCInputProfile *prof = im.profile("Generic MIDI");
+    QVERIFY(prof != NULL);
+    QCOMPARE(prof->name(), QString("Generic MIDI"));
+    QVERIFY(prof->channels().isEmpty() == false);
+    QCOMPARE(im.m_profiles.size(), 1);
+    QCOMPARE(im.m_profileFiles.size(), names.size() - 1);
+    QVERIFY(im.profile("Generic MIDI") == prof);
+    QCOMPARE(im.profileNames().size(), names.size());
+
+    QVERIFY(im.removeProfile("Generic MIDI") == true);
+    QCOMPARE(im.profileNames().size(), names.size() - 1);
 }
 
 void InputOutputMap_Test::inputSourceNames()
@@ -679,6 +698,29 @@ void InputOutputMap_Test::claimReleaseDumpReset()
     }
 }
 
+void InputOutputMap_Test::sharedClaim()
+{
+    InputOutputMap iom(m_doc, 4);
+
+    /* Claims are shared and can be nested */
+    QList<Universe*> unis = iom.claimUniverses();
+    QCOMPARE(unis.count(), 4);
+    QCOMPARE(iom.claimUniverses().count(), 4);
+    QVERIFY(iom.m_universeLock.tryLockForRead() == true);
+    iom.m_universeLock.unlock();
+
+    /* Adding or removing universes must wait for all the claims */
+    QVERIFY(iom.m_universeLock.tryLockForWrite() == false);
+    iom.releaseUniverses();
+    iom.releaseUniverses();
+
+    QVERIFY(iom.m_universeLock.tryLockForWrite() == true);
+    iom.m_universeLock.unlock();
+
+    QVERIFY(iom.addUniverse() == true);
+    QCOMPARE(iom.universesCount(), quint32(5));
+}
+
 void InputOutputMap_Test::blackout()
 {
     InputOutputMap iom(m_doc, 4);
@@ -800,4 +842,56 @@ void InputOutputMap_Test::grandMaster()
     QVERIFY(iom.grandMasterValueMode() == GrandMaster::Limit);
 }
 
+void InputOutputMap_Test::feedbackQueue()
+{
+    InputOutputMap iom(m_doc, 4);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+    stub->m_feedback.clear();
+
+    QVERIFY(iom.setOutputPatch(0, stub->name(), 0, true) == true);
+    FeedbackQueue *queue = iom.m_feedbackQueue;
+
+    /* Hold the queue, so that it's flushed by the test only */
+    iom.beginFeedbackBatch();
+
+    QVERIFY(iom.sendFeedBack(1, 0, 255) == false);
+    QVERIFY(iom.sendFeedBack(4, 0, 255) == false);
+    QCOMPARE(queue->pendingCount(), 0);
+
+    for (quint32 i = 0; i < 40; i++)
+        QVERIFY(iom.sendFeedBack(0, i, 1) == true);
+    for (quint32 i = 0; i < 40; i++)
+        QVERIFY(iom.sendFeedBack(0, i, 2) == true);
+    QCOMPARE(queue->pendingCount(), 40);
+    QCOMPARE(stub->m_feedback.count(), 0);
+
+    /* Only the latest value of each channel goes out, within the budget */
+    QCOMPARE(queue->flush(), FEEDBACK_MAX_PER_FLUSH);
+    QCOMPARE(stub->m_feedback.count(), FEEDBACK_MAX_PER_FLUSH);
+    for (int i = 0; i < FEEDBACK_MAX_PER_FLUSH; i++)
+        QCOMPARE(stub->m_feedback.at(i), quint32((i << 8) | 2));
+    QCOMPARE(queue->pendingCount(), 40 - FEEDBACK_MAX_PER_FLUSH);
+
+    QVERIFY(iom.sendFeedBack(0, 39, 3) == true);
+    QCOMPARE(queue->pendingCount(), 40 - FEEDBACK_MAX_PER_FLUSH);
+
+    QCOMPARE(queue->flush(), 40 - FEEDBACK_MAX_PER_FLUSH);
+    QCOMPARE(stub->m_feedback.count(), 40);
+    QCOMPARE(stub->m_feedback.last(), quint32((39 << 8) | 3));
+    QCOMPARE(queue->flush(), 0);
+
+    /* Unpatching the feedback line drops what's pending */
+    QVERIFY(iom.sendFeedBack(0, 0, 4) == true);
+    QVERIFY(iom.setOutputPatch(0, QString(), QLCIOPlugin::invalidLine(), true) == true);
+    QCOMPARE(queue->flush(), 0);
+    QCOMPARE(queue->pendingCount(), 0);
+    QCOMPARE(stub->m_feedback.count(), 40);
+
+    iom.endFeedbackBatch();
+    stub->m_feedback.clear();
+}
+
 QTEST_APPLESS_MAIN(InputOutputMap_Test)
@@ -52,8 +52,10 @@ private slots:
     void inputSourceNames();
     void profileDirectories();
     void claimReleaseDumpReset();
+    void sharedClaim();
     void blackout();
     void grandMaster();
+    void feedbackQueue();
 
 private:
     Doc* m_doc;
@@ -22,6 +22,7 @@
 #define private public
 #include "iopluginstub.h"
 #include "inputpatch_test.h"
+#include "qlcinputchannel.h"
 #include "qlcioplugin.h"
 #include "inputpatch.h"
 #include "qlcfile.h"
@@ -139,6 +140,47 @@ void InputPatch_Test::patch()
     QVERIFY(ip2->set(&prof1) == false);
 }
 
+void InputPatch_Test::profileChannels()
+{
+    IOPluginStub* stub = static_cast<IOPluginStub*> (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    QLCInputProfile prof;
+    QLCInputChannel *slider = new QLCInputChannel();
+    slider->setType(QLCInputChannel::Slider);
+    prof.insertChannel(3, slider);
+    QLCInputChannel *nextPage = new QLCInputChannel();
+    nextPage->setType(QLCInputChannel::NextPage);
+    prof.insertChannel(10, nextPage);
+    QLCInputChannel *far = new QLCInputChannel();
+    prof.insertChannel(PROFILE_TABLE_SIZE + 5, far);
+
+    InputPatch ip(0, this);
+    QVERIFY(ip.profileChannel(3) == NULL);
+
+    QVERIFY(ip.set(stub, 0, &prof) == true);
+    QCOMPARE(ip.m_profileChannels.size(), 11);
+    QVERIFY(ip.profileChannel(3) == slider);
+    QVERIFY(ip.profileChannel(10) == nextPage);
+    QVERIFY(ip.profileChannel(4) == NULL);
+    QVERIFY(ip.profileChannel(11) == NULL);
+    QVERIFY(ip.profileChannel(PROFILE_TABLE_SIZE + 5) == far);
+    QVERIFY(ip.m_nextPageCh == 10);
+    QVERIFY(ip.m_prevPageCh == USHRT_MAX);
+
+    /* Setting the profile again rebuilds the table */
+    prof.removeChannel(10);
+    QVERIFY(ip.set(&prof) == true);
+    QCOMPARE(ip.m_profileChannels.size(), 4);
+    QVERIFY(ip.profileChannel(10) == NULL);
+    QVERIFY(ip.m_nextPageCh == USHRT_MAX);
+
+    QVERIFY(ip.set(stub, 0, NULL) == true);
+    QCOMPARE(ip.m_profileChannels.size(), 0);
+    QVERIFY(ip.profileChannel(3) == NULL);
+    QVERIFY(ip.profileChannel(PROFILE_TABLE_SIZE + 5) == NULL);
+}
+
 void InputPatch_Test::parameters()
 {
     InputPatch* ip = new InputPatch(0, this);
@@ -158,4 +200,110 @@ void InputPatch_Test::parameters()
     delete ip;
 }
 
+void InputPatch_Test::flush()
+{
+    InputPatch ip(0, this);
+    ip.m_pluginLine = 0;
+
+    QSignalSpy spy(&ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)));
+
+    // only the latest value of a channel is flushed
+    ip.slotValueChanged(0, 0, 5, 10, QString());
+    ip.slotValueChanged(0, 0, 5, 20, QString());
+    ip.slotValueChanged(0, 0, 40, 30, QString());
+    // channels beyond the table and values with a key are buffered too
+    ip.slotValueChanged(0, 0, 1000, 40, QString());
+    ip.slotValueChanged(0, 0, 7, 50, "/foo");
+    // values of other lines and universes are ignored
+    ip.slotValueChanged(0, 1, 8, 60, QString());
+    ip.slotValueChanged(1, 0, 9, 70, QString());
+    QCOMPARE(spy.count(), 0);
+
+    ip.flush(0);
+    QCOMPARE(spy.count(), 4);
+    QCOMPARE(spy.at(0).at(1).toUInt(), quint32(5));
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(20));
+    QCOMPARE(spy.at(1).at(1).toUInt(), quint32(40));
+    QCOMPARE(spy.at(1).at(2).toUInt(), uint(30));
+
+    QHash<quint32, uint> buffered;
+    buffered[spy.at(2).at(1).toUInt()] = spy.at(2).at(2).toUInt();
+    buffered[spy.at(3).at(1).toUInt()] = spy.at(3).at(2).toUInt();
+    QCOMPARE(buffered.value(1000), uint(40));
+    QCOMPARE(buffered.value(7), uint(50));
+
+    // nothing is left to flush
+    ip.flush(0);
+    QCOMPARE(spy.count(), 4);
+
+    // ON/OFF changes are not coalesced
+    ip.slotValueChanged(0, 0, 5, 255, QString());
+    ip.slotValueChanged(0, 0, 5, 0, QString());
+    QCOMPARE(spy.count(), 5);
+    QCOMPARE(spy.at(4).at(2).toUInt(), uint(255));
+    ip.flush(0);
+    QCOMPARE(spy.count(), 6);
+    QCOMPARE(spy.at(5).at(2).toUInt(), uint(0));
+}
+
+void InputPatch_Test::universeChanged()
+{
+    InputPatch ip(0, this);
+    ip.m_pluginLine = 0;
+
+    QSignalSpy spy(&ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)));
+
+    QByteArray values(512, 0);
+    QByteArray data(512, 0);
+    QByteArray changed;
+
+    data[3] = 10;
+    data[9] = 20;
+    data[511] = 30;
+    QVERIFY(QLCIOPlugin::updateInputValues(values, data, changed) == true);
+    QCOMPARE(values, data);
+    QCOMPARE(changed.size(), 64);
+    QCOMPARE(int(uchar(changed.at(0))), 0x08);
+    QCOMPARE(int(uchar(changed.at(1))), 0x02);
+    QCOMPARE(int(uchar(changed.at(63))), 0x80);
+
+    // the same frame again has no changes
+    QVERIFY(QLCIOPlugin::updateInputValues(values, data, changed) == false);
+    QCOMPARE(changed, QByteArray(64, 0));
+
+    data[9] = 25;
+    changed.fill(0);
+    changed[0] = 0x08;
+    changed[1] = 0x02;
+
+    // frames of other lines and universes are ignored
+    ip.slotUniverseChanged(0, 1, data, changed);
+    ip.slotUniverseChanged(1, 0, data, changed);
+    ip.flush(0);
+    QCOMPARE(spy.count(), 0);
+
+    // only the channels in the mask are taken
+    ip.slotUniverseChanged(0, 0, data, changed);
+    QCOMPARE(spy.count(), 0);
+    ip.flush(0);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(1).toUInt(), quint32(3));
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(10));
+    QCOMPARE(spy.at(1).at(1).toUInt(), quint32(9));
+    QCOMPARE(spy.at(1).at(2).toUInt(), uint(25));
+
+    // ON/OFF changes are not coalesced
+    changed.fill(0);
+    changed[0] = 0x08;
+    data[3] = 0;
+    ip.slotUniverseChanged(0, 0, data, changed);
+    data[3] = char(255);
+    ip.slotUniverseChanged(0, 0, data, changed);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(2).toUInt(), uint(0));
+    ip.flush(0);
+    QCOMPARE(spy.count(), 4);
+    QCOMPARE(spy.at(3).at(2).toUInt(), uint(255));
+}
+
 QTEST_APPLESS_MAIN(InputPatch_Test)
@@ -33,7 +33,10 @@ private slots:
 
     void defaults();
     void patch();
+    void profileChannels();
     void parameters();
+    void flush();
+    void universeChanged();
 
 private:
     Doc* m_doc;
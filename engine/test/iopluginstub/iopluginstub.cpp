@@ -33,6 +33,8 @@ void IOPluginStub::init()
     m_configureCalled = 0;
     m_canConfigure = false;
     m_universe = QByteArray(int(4 * 512), char(0));
+    m_changedStart = 0;
+    m_changedCount = 0;
 }
 
 QString IOPluginStub::name()
@@ -93,6 +95,15 @@ void IOPluginStub::writeUniverse(quint32 universe, quint32 output, const QByteAr
     m_universe = m_universe.replace(output * 512, data.size(), data);
 }
 
+void IOPluginStub::writeUniverseDelta(quint32 universe, quint32 output, const QByteArray &data,
+                                      int changedStart, int changedCount)
+{
+    m_changedStart = changedStart;
+    m_changedCount = changedCount;
+
+    writeUniverse(universe, output, data);
+}
+
 /*****************************************************************************
  * Inputs
  *****************************************************************************/
@@ -129,6 +140,15 @@ QString IOPluginStub::inputInfo(quint32 input)
     return QString("This is a plugin stub for testing.");
 }
 
+void IOPluginStub::sendFeedBack(quint32 universe, quint32 inputLine,
+                                quint32 channel, uchar value, const QString &key)
+{
+    Q_UNUSED(universe)
+    Q_UNUSED(inputLine)
+    Q_UNUSED(key)
+    m_feedback.append((channel << 8) | value);
+}
+
 /*****************************************************************************
  * Configuration
  *****************************************************************************/
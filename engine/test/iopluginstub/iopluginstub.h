@@ -72,6 +72,10 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void writeUniverseDelta(quint32 universe, quint32 output, const QByteArray& data,
+                            int changedStart, int changedCount);
+
 public:
     /** List of outputs that have been opened */
     QList <quint32> m_openOutputs;
@@ -79,6 +83,10 @@ public:
     /** Fake universe buffer */
     QByteArray m_universe;
 
+    /** The changed range received with the last delta write */
+    int m_changedStart;
+    int m_changedCount;
+
     /*********************************************************************
      * Inputs
      *********************************************************************/
@@ -95,6 +103,10 @@ public:
     /** @reimp */
     QString inputInfo(quint32 input);
 
+    /** @reimp */
+    void sendFeedBack(quint32 universe, quint32 inputLine,
+                      quint32 channel, uchar value, const QString& key = 0);
+
     /** Tell the plugin to emit valueChanged signal */
     void emitValueChanged(quint32 universe, quint32 input, quint32 channel, uchar value)
     {
@@ -105,6 +117,9 @@ public:
     /** List of inputs that have been opened */
     QList <quint32> m_openInputs;
 
+    /** Feedback received so far, as channel << 8 | value */
+    QList <quint32> m_feedback;
+
     /*********************************************************************
      * Configuration
      *********************************************************************/
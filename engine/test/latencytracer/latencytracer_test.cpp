@@ -0,0 +1,135 @@
+/*
+  Q Light Controller Plus - Unit test
+  latencytracer_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "latencytracer_test.h"
+#include "latencytracer.h"
+#undef private
+
+void LatencyTracer_Test::now()
+{
+    int time = LatencyTracer::now();
+    QVERIFY(time > 0);
+    QTest::qSleep(20);
+    QVERIFY(LatencyTracer::now() >= time + 20);
+}
+
+void LatencyTracer_Test::initial()
+{
+    LatencyTracer tracer;
+    QVERIFY(tracer.statistics().isEmpty());
+
+    // outputs changing without any input produce no samples
+    tracer.outputChanged(0);
+    tracer.inputFlushed(1, 0);
+    tracer.outputChanged(0);
+    QVERIFY(tracer.statistics().isEmpty());
+}
+
+void LatencyTracer_Test::pairs()
+{
+    LatencyTracer tracer;
+
+    // make both outputs known
+    tracer.outputChanged(2);
+    tracer.outputChanged(3);
+
+    tracer.inputFlushed(0, LatencyTracer::now() - 30);
+    tracer.outputChanged(2);
+
+    QList<LatencyTracer::PairStatistics> stats = tracer.statistics();
+    QCOMPARE(stats.count(), 1);
+    QCOMPARE(stats.at(0).input, quint32(0));
+    QCOMPARE(stats.at(0).output, quint32(2));
+    QCOMPARE(stats.at(0).samples, quint32(1));
+    QVERIFY(stats.at(0).max >= 30);
+    QVERIFY(stats.at(0).max < 100);
+
+    // an input is counted once per output
+    tracer.outputChanged(2);
+    tracer.outputChanged(3);
+    stats = tracer.statistics();
+    QCOMPARE(stats.count(), 2);
+    QCOMPARE(stats.at(0).samples, quint32(1));
+    QCOMPARE(stats.at(1).samples, quint32(1));
+}
+
+void LatencyTracer_Test::earliest()
+{
+    LatencyTracer tracer;
+    tracer.outputChanged(0);
+
+    int time = LatencyTracer::now();
+    tracer.inputFlushed(0, time - 50);
+    tracer.inputFlushed(0, time - 10);
+    tracer.outputChanged(0);
+
+    QList<LatencyTracer::PairStatistics> stats = tracer.statistics();
+    QCOMPARE(stats.count(), 1);
+    QCOMPARE(stats.at(0).samples, quint32(1));
+    QVERIFY(stats.at(0).max >= 50);
+}
+
+void LatencyTracer_Test::percentiles()
+{
+    LatencyTracer tracer;
+    LatencyTracer::Pair pair;
+    pair.histogram.fill(0, LATENCY_HISTOGRAM_BINS);
+
+    // 1 to 100 milliseconds, one sample each
+    for (int i = 1; i <= 100; i++)
+    {
+        pair.histogram[i]++;
+        pair.samples++;
+        pair.max = i;
+    }
+
+    QCOMPARE(LatencyTracer::percentile(pair, 50), 50);
+    QCOMPARE(LatencyTracer::percentile(pair, 90), 90);
+    QCOMPARE(LatencyTracer::percentile(pair, 99), 99);
+    QCOMPARE(LatencyTracer::percentile(pair, 100), 100);
+
+    // latencies beyond the histogram are reported by max
+    pair.histogram[LATENCY_HISTOGRAM_BINS - 1] += 100;
+    pair.samples += 100;
+    pair.max = 5000;
+    QCOMPARE(LatencyTracer::percentile(pair, 50), 100);
+    QCOMPARE(LatencyTracer::percentile(pair, 99), LATENCY_HISTOGRAM_BINS - 1);
+}
+
+void LatencyTracer_Test::reset()
+{
+    LatencyTracer tracer;
+    tracer.outputChanged(0);
+    tracer.inputFlushed(0, LatencyTracer::now());
+    tracer.outputChanged(0);
+    QCOMPARE(tracer.statistics().count(), 1);
+
+    tracer.reset();
+    QVERIFY(tracer.statistics().isEmpty());
+
+    // outputs have to be seen again after a reset
+    tracer.inputFlushed(0, LatencyTracer::now());
+    tracer.outputChanged(0);
+    QVERIFY(tracer.statistics().isEmpty());
+}
+
+QTEST_APPLESS_MAIN(LatencyTracer_Test)
@@ -0,0 +1,167 @@
+/*
+  Q Light Controller Plus - Unit test
+  loadgovernor_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QSignalSpy>
+#include <QtTest>
+
+#define protected public
+#define private public
+#include "loadgovernor_test.h"
+#include "loadgovernor.h"
+#include "mastertimer.h"
+#include "doc.h"
+#undef private
+#undef protected
+
+void LoadGovernor_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void LoadGovernor_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void LoadGovernor_Test::init()
+{
+    m_doc->loadGovernor()->stop();
+    m_doc->loadGovernor()->m_headroomPolls = 0;
+}
+
+void LoadGovernor_Test::initial()
+{
+    LoadGovernor *gov = m_doc->loadGovernor();
+    QVERIFY(gov != NULL);
+    QCOMPARE(gov->level(), LoadGovernor::Normal);
+    QCOMPARE(gov->scaledInterval(20), 20);
+    QCOMPARE(gov->scaledRate(60), 60);
+}
+
+void LoadGovernor_Test::overload()
+{
+    LoadGovernor *gov = m_doc->loadGovernor();
+    QSignalSpy spy(gov, SIGNAL(levelChanged(int)));
+
+    /* Some load, but not an overload */
+    gov->update(GOVERNOR_OVERLOAD_PERCENT - 1, 0);
+    QCOMPARE(gov->level(), LoadGovernor::Normal);
+    QCOMPARE(spy.count(), 0);
+
+    gov->update(GOVERNOR_OVERLOAD_PERCENT, 0);
+    QCOMPARE(gov->level(), LoadGovernor::Reduced);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), int(LoadGovernor::Reduced));
+    QCOMPARE(gov->scaledInterval(20), 40);
+    QCOMPARE(gov->scaledRate(60), 30);
+
+    /* Late ticks are an overload too */
+    gov->update(10, GOVERNOR_LATE_PERCENT);
+    QCOMPARE(gov->level(), LoadGovernor::Minimal);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(gov->scaledInterval(20), 80);
+    QCOMPARE(gov->scaledRate(60), 15);
+    QCOMPARE(gov->scaledRate(2), 1);
+
+    gov->update(100, 100);
+    QCOMPARE(gov->level(), LoadGovernor::Minimal);
+    QCOMPARE(spy.count(), 2);
+
+    gov->stop();
+    QCOMPARE(gov->level(), LoadGovernor::Normal);
+    QCOMPARE(spy.count(), 3);
+}
+
+void LoadGovernor_Test::recovery()
+{
+    LoadGovernor *gov = m_doc->loadGovernor();
+    gov->update(100, 0);
+    gov->update(100, 0);
+    QCOMPARE(gov->level(), LoadGovernor::Minimal);
+
+    for (int i = 0; i < GOVERNOR_RECOVERY_POLLS - 1; i++)
+    {
+        gov->update(GOVERNOR_HEADROOM_PERCENT - 1, 0);
+        QCOMPARE(gov->level(), LoadGovernor::Minimal);
+    }
+    gov->update(GOVERNOR_HEADROOM_PERCENT - 1, 0);
+    QCOMPARE(gov->level(), LoadGovernor::Reduced);
+
+    /* A check without headroom starts counting again */
+    for (int i = 0; i < GOVERNOR_RECOVERY_POLLS - 1; i++)
+        gov->update(0, 0);
+    gov->update(GOVERNOR_HEADROOM_PERCENT, 0);
+    gov->update(0, 0);
+    QCOMPARE(gov->level(), LoadGovernor::Reduced);
+
+    /* Any late tick means there is no headroom */
+    for (int i = 0; i < GOVERNOR_RECOVERY_POLLS; i++)
+        gov->update(0, 1);
+    QCOMPARE(gov->level(), LoadGovernor::Reduced);
+
+    for (int i = 0; i < GOVERNOR_RECOVERY_POLLS; i++)
+        gov->update(0, 0);
+    QCOMPARE(gov->level(), LoadGovernor::Normal);
+}
+
+void LoadGovernor_Test::poll()
+{
+    LoadGovernor *gov = m_doc->loadGovernor();
+    MasterTimer *timer = m_doc->masterTimer();
+    timer->resetTimingStatistics();
+    timer->timingCounters(&gov->m_lastTicks, &gov->m_lastLateTicks, &gov->m_lastDuration);
+
+    quint64 tickUs = MasterTimer::tick() * 1000;
+
+    /* No tick recorded: nothing to measure */
+    gov->slotPoll();
+    QCOMPARE(gov->level(), LoadGovernor::Normal);
+
+    /* 100 ticks, each taking 90% of its time */
+    timer->m_timingStats.ticks += 100;
+    timer->m_timingStats.totalDuration += 100 * tickUs * 9 / 10;
+    gov->slotPoll();
+    QCOMPARE(gov->level(), LoadGovernor::Reduced);
+    QCOMPARE(gov->m_lastTicks, quint64(100));
+
+    /* 100 light ticks, 10 of which late */
+    timer->m_timingStats.ticks += 100;
+    timer->m_timingStats.lateTicks += 10;
+    timer->m_timingStats.totalDuration += 100 * tickUs / 10;
+    gov->slotPoll();
+    QCOMPARE(gov->level(), LoadGovernor::Minimal);
+
+    /* A reset of the statistics only moves the baseline */
+    timer->resetTimingStatistics();
+    timer->m_timingStats.ticks = 10;
+    gov->slotPoll();
+    QCOMPARE(gov->level(), LoadGovernor::Minimal);
+    QCOMPARE(gov->m_lastTicks, quint64(10));
+    QCOMPARE(gov->m_lastLateTicks, quint64(0));
+
+    for (int i = 0; i < GOVERNOR_RECOVERY_POLLS; i++)
+    {
+        timer->m_timingStats.ticks += 100;
+        timer->m_timingStats.totalDuration += 100 * tickUs / 10;
+        gov->slotPoll();
+    }
+    QCOMPARE(gov->level(), LoadGovernor::Reduced);
+}
+
+QTEST_APPLESS_MAIN(LoadGovernor_Test)
@@ -22,7 +22,8 @@
 #include "universe.h"
 
 DMXSource_Stub::DMXSource_Stub()
-        : m_writeCalls(0)
+        : m_writeOnChangeOnly(false)
+        , m_writeCalls(0)
 {
 }
 
@@ -37,3 +38,8 @@ void DMXSource_Stub::writeDMX(MasterTimer* timer, QList<Universe*> universes)
 
     m_writeCalls++;
 }
+
+bool DMXSource_Stub::writeOnChangeOnly() const
+{
+    return m_writeOnChangeOnly;
+}
@@ -31,6 +31,11 @@ public:
 
     void writeDMX(MasterTimer* timer, QList<Universe*> universes);
 
+    bool writeOnChangeOnly() const;
+
+    /** Returned by writeOnChangeOnly() */
+    bool m_writeOnChangeOnly;
+
     /** Number of calls to writeDMX() */
     int m_writeCalls;
 };
@@ -62,8 +62,7 @@ void MasterTimer_Test::initial()
 
     QVERIFY(mt->runningFunctions() == 0);
     QVERIFY(mt->m_functionList.size() == 0);
-    QVERIFY(mt->m_functionListMutex.tryLock() == true);
-    mt->m_functionListMutex.unlock();
+    QVERIFY(mt->m_startQueue.loadAcquire() == NULL);
 
     QVERIFY(mt->m_dmxSourceList.size() == 0);
     QVERIFY(mt->m_dmxSourceListMutex.tryLock() == true);
@@ -96,6 +95,23 @@ void MasterTimer_Test::startStop()
     QVERIFY(mt->m_stopAllFunctions == false);
 }
 
+void MasterTimer_Test::supportedFrequency()
+{
+    QCOMPARE(MasterTimer::supportedFrequency(50), uint(50));
+    QCOMPARE(MasterTimer::supportedFrequency(100), uint(100));
+    QCOMPARE(MasterTimer::supportedFrequency(200), uint(200));
+    QCOMPARE(MasterTimer::supportedFrequency(250), uint(250));
+
+    /* The tick is always a whole number of milliseconds */
+    QCOMPARE(MasterTimer::supportedFrequency(150), uint(125));
+    QCOMPARE(MasterTimer::supportedFrequency(60), uint(50));
+    QCOMPARE(MasterTimer::supportedFrequency(240), uint(250));
+
+    /* Out of range */
+    QCOMPARE(MasterTimer::supportedFrequency(0), uint(1));
+    QCOMPARE(MasterTimer::supportedFrequency(1000), uint(250));
+}
+
 void MasterTimer_Test::startStopFunction()
 {
     MasterTimer* mt = m_doc->masterTimer();
@@ -206,6 +222,37 @@ void MasterTimer_Test::interval()
     QVERIFY(mt->m_dmxSourceList.size() == 0);
 }
 
+void MasterTimer_Test::writeOnChangeOnly()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    QList<Universe*> universes;
+
+    DMXSource_Stub s1;
+    DMXSource_Stub s2;
+    s2.m_writeOnChangeOnly = true;
+    mt->registerDMXSource(&s1);
+    mt->registerDMXSource(&s2);
+
+    /* A source that writes on change only is skipped until it changes */
+    mt->timerTickDMXSources(universes);
+    QCOMPARE(s1.m_writeCalls, 1);
+    QCOMPARE(s2.m_writeCalls, 0);
+
+    s2.setChanged(true);
+    mt->timerTickDMXSources(universes);
+    QCOMPARE(s1.m_writeCalls, 2);
+    QCOMPARE(s2.m_writeCalls, 1);
+    QVERIFY(s2.hasChanged() == false);
+
+    /* The change is consumed by the tick that wrote it */
+    mt->timerTickDMXSources(universes);
+    QCOMPARE(s1.m_writeCalls, 3);
+    QCOMPARE(s2.m_writeCalls, 1);
+
+    mt->unregisterDMXSource(&s1);
+    mt->unregisterDMXSource(&s2);
+}
+
 void MasterTimer_Test::functionInitiatedStop()
 {
     MasterTimer* mt = m_doc->masterTimer();
@@ -345,16 +392,14 @@ void MasterTimer_Test::restart()
     QTest::qWait(60);
     QVERIFY(mt->runningFunctions() == 0);
     QVERIFY(mt->m_functionList.size() == 0);
-    QVERIFY(mt->m_functionListMutex.tryLock() == true);
-    mt->m_functionListMutex.unlock();
+    QVERIFY(mt->m_startQueue.loadAcquire() == NULL);
     // QVERIFY(mt->m_running == false);
     QVERIFY(mt->m_stopAllFunctions == false);
 
     mt->start();
     QVERIFY(mt->runningFunctions() == 0);
     QVERIFY(mt->m_functionList.size() == 0);
-    QVERIFY(mt->m_functionListMutex.tryLock() == true);
-    mt->m_functionListMutex.unlock();
+    QVERIFY(mt->m_startQueue.loadAcquire() == NULL);
     // QVERIFY(mt->m_running == true);
     QVERIFY(mt->m_stopAllFunctions == false);
 
@@ -367,4 +412,186 @@ void MasterTimer_Test::restart()
     mt->stopAllFunctions();
 }
 
+void MasterTimer_Test::parallelTick()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    QVERIFY(mt->parallelTickEnabled() == false);
+
+    mt->setParallelTickEnabled(true);
+    QVERIFY(mt->parallelTickEnabled() == true);
+
+    Function_Stub fs1(m_doc);
+    Function_Stub fs2(m_doc);
+
+    /* Functions without faders are always run serially */
+    QList<Function*> serial;
+    QList<QList<Function*> > groups =
+        mt->groupFunctionsByUniverse(QList<Function*>() << &fs1 << &fs2, serial);
+    QVERIFY(groups.isEmpty());
+    QCOMPARE(serial.count(), 2);
+    QVERIFY(serial.at(0) == &fs1);
+    QVERIFY(serial.at(1) == &fs2);
+
+    mt->start();
+    fs1.start(mt, FunctionParent::master());
+    fs2.start(mt, FunctionParent::master());
+    QTest::qWait(100);
+    QVERIFY(mt->runningFunctions() == 2);
+    QVERIFY(fs1.m_writeCalls > 0);
+    QVERIFY(fs2.m_writeCalls > 0);
+
+    fs1.stop(FunctionParent::master());
+    fs2.stop(FunctionParent::master());
+    QTest::qWait(100);
+    QVERIFY(mt->runningFunctions() == 0);
+    QVERIFY(fs1.m_postRunCalls == 1);
+    QVERIFY(fs2.m_postRunCalls == 1);
+
+    mt->setParallelTickEnabled(false);
+    mt->stop();
+}
+
+void MasterTimer_Test::timingStatistics()
+{
+    MasterTimer mt(m_doc);
+    qint64 tickNs = qint64(MasterTimer::tick()) * 1000000;
+
+    MasterTimer::TimingStatistics stats = mt.timingStatistics();
+    QCOMPARE(stats.ticks, quint64(0));
+    QCOMPARE(stats.intervalHistogram.count(), stats.durationHistogram.count());
+    QVERIFY(stats.worstIntervalPerMinute.isEmpty());
+
+    /* Three regular ticks, then one starting three periods later */
+    mt.recordTickTiming(10 * tickNs, 500000);
+    mt.recordTickTiming(11 * tickNs, 1000000);
+    mt.recordTickTiming(12 * tickNs, 250000);
+    mt.recordTickTiming(15 * tickNs, 250000);
+
+    stats = mt.timingStatistics();
+    QCOMPARE(stats.ticks, quint64(4));
+    QCOMPARE(stats.lateTicks, quint64(1));
+    QCOMPARE(stats.missedTicks, quint64(2));
+
+    int tickBin = int(tickNs / 1000) / stats.intervalBinSize;
+    QCOMPARE(stats.intervalHistogram.at(tickBin), quint32(2));
+    QCOMPARE(stats.durationHistogram.at(1000 / stats.durationBinSize), quint32(1));
+
+    QCOMPARE(stats.worstIntervalPerMinute.count(), 1);
+    QCOMPARE(stats.worstIntervalPerMinute.last(), int(3 * tickNs / 1000));
+    QCOMPARE(stats.worstDurationPerMinute.last(), 1000);
+
+    /* A tick after more than a minute opens a new history slot */
+    mt.recordTickTiming(15 * tickNs + Q_INT64_C(61000000000), 0);
+    stats = mt.timingStatistics();
+    QCOMPARE(stats.worstIntervalPerMinute.count(), 2);
+    QCOMPARE(stats.worstDurationPerMinute.last(), 0);
+
+    mt.resetTimingStatistics();
+    stats = mt.timingStatistics();
+    QCOMPARE(stats.ticks, quint64(0));
+    QCOMPARE(stats.lateTicks, quint64(0));
+    QVERIFY(stats.worstDurationPerMinute.isEmpty());
+}
+
+void MasterTimer_Test::functionTiming()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    QVERIFY(mt->functionTimingEnabled() == false);
+    QVERIFY(mt->functionTimings().isEmpty());
+
+    /* The first calls are plainly averaged */
+    mt->recordFunctionTiming(1, MasterTimer::WriteCall, 1000000);
+    mt->recordFunctionTiming(1, MasterTimer::WriteCall, 3000000);
+    mt->recordFunctionTiming(1, MasterTimer::PreRunCall, 500000);
+
+    QHash<quint32, MasterTimer::FunctionTiming> timings = mt->functionTimings();
+    QCOMPARE(timings.count(), 1);
+    QCOMPARE(timings[1].write.calls, quint64(2));
+    QCOMPARE(timings[1].write.average, 2000.0);
+    QCOMPARE(timings[1].write.maximum, 3000);
+    QCOMPARE(timings[1].preRun.calls, quint64(1));
+    QCOMPARE(timings[1].preRun.maximum, 500);
+    QCOMPARE(timings[1].postRun.calls, quint64(0));
+
+    mt->resetFunctionTimings();
+    QVERIFY(mt->functionTimings().isEmpty());
+
+    /* Running functions are measured only when enabled */
+    Function_Stub fs(m_doc);
+
+    mt->start();
+    fs.start(mt, FunctionParent::master());
+    QTest::qWait(100);
+    QVERIFY(mt->functionTimings().isEmpty());
+
+    mt->setFunctionTimingEnabled(true);
+    QVERIFY(mt->functionTimingEnabled() == true);
+    QTest::qWait(100);
+    fs.stop(FunctionParent::master());
+    QTest::qWait(100);
+    mt->stop();
+
+    timings = mt->functionTimings();
+    QVERIFY(timings.contains(fs.id()));
+    QVERIFY(timings[fs.id()].write.calls > 0);
+    QCOMPARE(timings[fs.id()].postRun.calls, quint64(1));
+
+    mt->setFunctionTimingEnabled(false);
+}
+
+void MasterTimer_Test::startQueue()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    Function_Stub fs1(m_doc);
+    Function_Stub fs2(m_doc);
+
+    mt->startFunction(&fs1);
+    mt->startFunction(&fs2);
+    mt->startFunction(&fs1);
+    QVERIFY(mt->m_startQueue.loadAcquire() != NULL);
+
+    /* Requests come out in order and without duplicates */
+    QList<Function*> queue = mt->takeStartQueue();
+    QCOMPARE(queue.count(), 2);
+    QVERIFY(queue.at(0) == &fs1);
+    QVERIFY(queue.at(1) == &fs2);
+    QVERIFY(mt->m_startQueue.loadAcquire() == NULL);
+    QVERIFY(mt->takeStartQueue().isEmpty());
+}
+
+void MasterTimer_Test::realTime()
+{
+    /* Disabled by default, so the thread setup is a no-op */
+    QVERIFY(MasterTimer::realTimeEnabled() == false);
+    QVERIFY(MasterTimer::setupRealTimeThread() == true);
+    QVERIFY(MasterTimer::setupRealTimeThread(1) == true);
+}
+
+void MasterTimer_Test::beatDrift()
+{
+    MasterTimer mt(m_doc);
+    mt.setVirtualTime(0);
+    mt.setBeatSourceType(MasterTimer::Internal);
+    mt.requestBpmNumber(128);
+
+    // 468.75ms, the fraction is carried from a beat to the next
+    QCOMPARE(mt.beatTimeDuration(), 468);
+
+    QSignalSpy spy(&mt, SIGNAL(beat()));
+
+    // ten minutes at 128 BPM are exactly 1280 beats
+    for (int time = 10; time <= 600100; time += 10)
+    {
+        mt.setVirtualTime(time);
+        mt.timerTick();
+    }
+    QCOMPARE(spy.count(), 1280);
+
+    // the phase of a beat is below a tick
+    QVERIFY(mt.beatPhase() >= 0);
+    QVERIFY(mt.beatPhase() < 10);
+
+    mt.setVirtualTime(-1);
+}
+
 QTEST_MAIN(MasterTimer_Test)
@@ -35,14 +35,22 @@ private slots:
 
     void initial();
     void startStop();
+    void supportedFrequency();
     void startStopFunction();
     void registerUnregisterDMXSource();
     void interval();
+    void writeOnChangeOnly();
     void functionInitiatedStop();
     void runMultipleFunctions();
     void stopAllFunctions();
     void stop();
     void restart();
+    void parallelTick();
+    void timingStatistics();
+    void functionTiming();
+    void startQueue();
+    void realTime();
+    void beatDrift();
 
 private:
     Doc* m_doc;
@@ -0,0 +1,221 @@
+/*
+  Q Light Controller Plus - Unit test
+  offlinerenderer_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QXmlStreamWriter>
+
+#include "offlinerenderer_test.h"
+#include "dmxrecordingfile.h"
+#include "offlinerenderer.h"
+#include "inputoutputmap.h"
+#include "mastertimer.h"
+#include "chaserstep.h"
+#include "fixture.h"
+#include "qlcfile.h"
+#include "chaser.h"
+#include "scene.h"
+#include "doc.h"
+
+#define TEST_RECORDING "test.qxr"
+#define TEST_WORKSPACE "test.qxw"
+#define TEST_CHECKSUMS "test.checksums"
+
+void OfflineRenderer_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void OfflineRenderer_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void OfflineRenderer_Test::init()
+{
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setChannels(4);
+    fxi->setUniverse(0);
+    fxi->setAddress(0);
+    m_doc->addFixture(fxi);
+
+    Scene* s = new Scene(m_doc);
+    s->setValue(fxi->id(), 0, 255);
+    s->setFadeInSpeed(500);
+    m_doc->addFunction(s);
+    m_sceneID = s->id();
+}
+
+void OfflineRenderer_Test::cleanup()
+{
+    m_doc->clearContents();
+    QFile::remove(TEST_RECORDING);
+    QFile::remove(TEST_WORKSPACE);
+    QFile::remove(TEST_CHECKSUMS);
+}
+
+void OfflineRenderer_Test::invalidFunction()
+{
+    OfflineRenderer renderer(m_doc);
+    QVERIFY(renderer.render(12345, 1000, TEST_RECORDING) == false);
+    QCOMPARE(renderer.ticks(), quint32(0));
+    QVERIFY(QFile::exists(TEST_RECORDING) == false);
+}
+
+void OfflineRenderer_Test::renderScene()
+{
+    OfflineRenderer renderer(m_doc);
+    QVERIFY(renderer.render(m_sceneID, 1000, TEST_RECORDING) == true);
+
+    quint32 ticks = (1000 + MasterTimer::tick() - 1) / MasterTimer::tick();
+    QCOMPARE(renderer.ticks(), ticks);
+    QCOMPARE(renderer.renderedTime(), ticks * MasterTimer::tick());
+    QVERIFY(renderer.frames() > 0);
+    QVERIFY(m_doc->function(m_sceneID)->isRunning() == false);
+
+    /* The frames are stamped with the virtual time, so the fade is
+       halfway at 250ms however fast the render ran */
+    DMXRecordingFile file;
+    QVERIFY(file.open(TEST_RECORDING) == true);
+    QVERIFY(file.duration() <= renderer.renderedTime());
+
+    QHash<quint32, QByteArray> frames;
+    file.seek(250, frames);
+    QVERIFY(uchar(frames[0].at(0)) > 64);
+    QVERIFY(uchar(frames[0].at(0)) < 192);
+
+    file.seek(1000, frames);
+    QCOMPARE(uchar(frames[0].at(0)), uchar(255));
+    QCOMPARE(uchar(frames[0].at(1)), uchar(0));
+}
+
+void OfflineRenderer_Test::renderUntilStopped()
+{
+    Chaser* c = new Chaser(m_doc);
+    c->setRunOrder(Function::SingleShot);
+    c->setDurationMode(Chaser::PerStep);
+    c->addStep(ChaserStep(m_sceneID, 0, 200, 0));
+    m_doc->addFunction(c);
+
+    /* Without a recording, the output is just counted */
+    OfflineRenderer renderer(m_doc);
+    QVERIFY(renderer.render(c->id(), 0) == true);
+    QVERIFY(renderer.renderedTime() >= 200);
+    QVERIFY(renderer.renderedTime() < 1000);
+    QVERIFY(renderer.frames() > 0);
+    QVERIFY(c->isRunning() == false);
+    QVERIFY(QFile::exists(TEST_RECORDING) == false);
+}
+
+void OfflineRenderer_Test::loadWorkspace()
+{
+    QFile file(TEST_WORKSPACE);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    QXmlStreamWriter xml(&file);
+    QLCFile::writeXMLHeader(&xml, "Workspace");
+    m_doc->saveXML(&xml);
+    xml.writeStartElement("VirtualConsole");
+    xml.writeTextElement("Frame", "ignored");
+    xml.writeEndElement();
+    xml.writeEndElement();
+    xml.writeEndDocument();
+    file.close();
+
+    quint32 sceneID = m_sceneID;
+    m_doc->clearContents();
+    QVERIFY(m_doc->function(sceneID) == NULL);
+
+    OfflineRenderer renderer(m_doc);
+    QVERIFY(renderer.loadWorkspace("nonexistent.qxw") == false);
+    QVERIFY(renderer.loadWorkspace(TEST_WORKSPACE) == true);
+    QVERIFY(m_doc->function(sceneID) != NULL);
+    QCOMPARE(m_doc->fixtures().count(), 1);
+
+    QVERIFY(renderer.render(sceneID, 100) == true);
+    QVERIFY(renderer.ticks() > 0);
+}
+
+void OfflineRenderer_Test::checksums()
+{
+    OfflineRenderer renderer(m_doc);
+    QVERIFY(renderer.checksumsEnabled() == false);
+    QVERIFY(renderer.render(m_sceneID, 1000) == true);
+    QVERIFY(renderer.checksums().isEmpty());
+
+    renderer.setChecksumsEnabled(true);
+    QVERIFY(renderer.render(m_sceneID, 1000) == true);
+    QList<QVector<quint32> > golden = renderer.checksums();
+    QCOMPARE(quint32(golden.count()), renderer.ticks());
+    QCOMPARE(quint32(golden.first().count()), m_doc->inputOutputMap()->universesCount());
+
+    /* The fade changes the first universe, the others stay blank */
+    QVERIFY(golden.first().at(0) != golden.last().at(0));
+    QVERIFY(golden.first().at(1) == golden.last().at(1));
+
+    QVERIFY(renderer.saveChecksums(TEST_CHECKSUMS) == true);
+    QCOMPARE(renderer.compareChecksums("nonexistent.checksums"), 0);
+
+    /* The same render gives the same frames */
+    QVERIFY(renderer.render(m_sceneID, 1000) == true);
+    QVERIFY(renderer.checksums() == golden);
+    QCOMPARE(renderer.compareChecksums(TEST_CHECKSUMS), -1);
+
+    /* A longer render does not match the golden stream */
+    QVERIFY(renderer.render(m_sceneID, 2000) == true);
+    QCOMPARE(renderer.compareChecksums(TEST_CHECKSUMS), golden.count());
+
+    /* A different fade does not match from the first tick */
+    Scene *s = qobject_cast<Scene*>(m_doc->function(m_sceneID));
+    s->setFadeInSpeed(250);
+    QVERIFY(renderer.render(m_sceneID, 1000) == true);
+    QCOMPARE(renderer.compareChecksums(TEST_CHECKSUMS), 0);
+}
+
+void OfflineRenderer_Test::beatChecksums()
+{
+    Scene* s = new Scene(m_doc);
+    s->setValue(m_doc->fixtures().first()->id(), 1, 128);
+    m_doc->addFunction(s);
+
+    /* One step per beat */
+    Chaser* c = new Chaser(m_doc);
+    c->setTempoType(Function::Beats);
+    c->setDurationMode(Chaser::Common);
+    c->setDuration(1000);
+    c->addStep(ChaserStep(m_sceneID));
+    c->addStep(ChaserStep(s->id()));
+    m_doc->addFunction(c);
+
+    MasterTimer *timer = m_doc->masterTimer();
+    timer->setBeatSourceType(MasterTimer::Internal);
+    timer->requestBpmNumber(120);
+
+    OfflineRenderer renderer(m_doc);
+    renderer.setChecksumsEnabled(true);
+    QVERIFY(renderer.render(c->id(), 3000) == true);
+    QList<QVector<quint32> > golden = renderer.checksums();
+
+    /* The steps change with the virtual beats, however long the render took */
+    QVERIFY(renderer.render(c->id(), 3000) == true);
+    QVERIFY(renderer.checksums() == golden);
+
+    timer->setBeatSourceType(MasterTimer::None);
+}
+
+QTEST_MAIN(OfflineRenderer_Test)
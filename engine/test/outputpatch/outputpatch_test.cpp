@@ -144,4 +144,201 @@ void OutputPatch_Test::dump()
     delete op;
 }
 
+void OutputPatch_Test::dumpDelta()
+{
+    QByteArray uni(512, char(0));
+
+    OutputPatch* op = new OutputPatch(0, this);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    op->set(stub, 0);
+
+    /* The first frame after patching is always sent as fully changed */
+    op->dump(0, uni, 10, 5);
+    QCOMPARE(stub->m_changedStart, 0);
+    QCOMPARE(stub->m_changedCount, 512);
+
+    op->dump(0, uni, 10, 5);
+    QCOMPARE(stub->m_changedStart, 10);
+    QCOMPARE(stub->m_changedCount, 5);
+
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_changedCount, 0);
+
+    /* No range information means the whole buffer */
+    op->dump(0, uni);
+    QCOMPARE(stub->m_changedStart, 0);
+    QCOMPARE(stub->m_changedCount, 512);
+
+    /* Leaving the pause state resends the whole frame */
+    op->setPaused(true);
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_changedCount, 512);
+    op->dump(0, uni, 3, 1);
+    QCOMPARE(stub->m_changedCount, 0);
+    op->setPaused(false);
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_changedCount, 512);
+
+    delete op;
+}
+
+void OutputPatch_Test::dumpAsync()
+{
+    QByteArray uni(512, char(0));
+
+    OutputPatch* op = new OutputPatch(0, this);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    op->set(stub, 0);
+    op->setAsync(true);
+    QVERIFY(op->async() == true);
+
+    for (int i = 1; i <= 50; i++)
+    {
+        uni[0] = char(i);
+        op->dump(0, uni, 0, 1);
+    }
+
+    /* Disabling the async mode sends the frame still pending */
+    op->setAsync(false);
+    QVERIFY(op->async() == false);
+    QVERIFY(op->m_mailboxPending == false);
+    QVERIFY(op->droppedFrames() < 50);
+    QCOMPARE(stub->m_universe[0], char(50));
+
+    /* Frames are written synchronously again */
+    uni[10] = char(60);
+    op->dump(0, uni, 10, 1);
+    QCOMPARE(stub->m_universe[10], char(60));
+    QCOMPARE(stub->m_changedStart, 10);
+    QCOMPARE(stub->m_changedCount, 1);
+
+    delete op;
+}
+
+void OutputPatch_Test::refreshRate()
+{
+    QByteArray uni(512, char(0));
+
+    OutputPatch* op = new OutputPatch(0, this);
+    QCOMPARE(op->refreshRate(), 0);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    op->set(stub, 0);
+    op->setRefreshRate(2);
+    QCOMPARE(op->refreshRate(), 2);
+
+    uni[0] = char(1);
+    op->dump(0, uni, 0, 1);
+    QCOMPARE(stub->m_universe[0], char(1));
+
+    /* Frames faster than the rate are skipped... */
+    uni[0] = char(2);
+    op->dump(0, uni, 0, 1);
+    uni[5] = char(3);
+    op->dump(0, uni, 5, 1);
+    QCOMPARE(stub->m_universe[0], char(1));
+    QCOMPARE(op->skippedFrames(), quint32(2));
+
+    /* ...but what they changed is sent with the next frame */
+    QTest::qSleep(550);
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_universe[0], char(2));
+    QCOMPARE(stub->m_universe[5], char(3));
+    QCOMPARE(stub->m_changedStart, 0);
+    QCOMPARE(stub->m_changedCount, 6);
+
+    op->setRefreshRate(-1);
+    QCOMPARE(op->refreshRate(), 0);
+
+    delete op;
+}
+
+void OutputPatch_Test::skipDuplicates()
+{
+    QByteArray uni(512, char(0));
+
+    OutputPatch* op = new OutputPatch(0, this);
+    QVERIFY(op->skipDuplicates() == false);
+    QCOMPARE(op->keepaliveInterval(), 0);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    op->set(stub, 0);
+    op->setSkipDuplicates(true);
+    QVERIFY(op->skipDuplicates() == true);
+
+    /* The first frame is always sent */
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_changedCount, 512);
+
+    stub->m_changedCount = -2;
+    op->dump(0, uni, 0, 0);
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_changedCount, -2);
+    QCOMPARE(op->skippedFrames(), quint32(2));
+
+    op->dump(0, uni, 3, 1);
+    QCOMPARE(stub->m_changedStart, 3);
+    QCOMPARE(stub->m_changedCount, 1);
+
+    /* Identical frames are sent again after the keepalive interval */
+    op->setKeepaliveInterval(100);
+    QCOMPARE(op->keepaliveInterval(), 100);
+    stub->m_changedCount = -2;
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_changedCount, -2);
+    QTest::qSleep(150);
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(stub->m_changedCount, 0);
+
+    delete op;
+}
+
+void OutputPatch_Test::statistics()
+{
+    QByteArray uni(512, char(0));
+
+    OutputPatch* op = new OutputPatch(0, this);
+    QCOMPARE(op->sentFrames(), quint32(0));
+    QCOMPARE(op->outputErrors(), quint32(0));
+
+    /* Nothing is sent without a plugin */
+    op->dump(0, uni);
+    QCOMPARE(op->sentFrames(), quint32(0));
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    op->set(stub, 0);
+    op->dump(0, uni);
+    op->dump(0, uni);
+    QCOMPARE(op->sentFrames(), quint32(2));
+
+    /* Skipped frames are not sent */
+    op->setSkipDuplicates(true);
+    op->dump(0, uni, 0, 1);
+    QCOMPARE(op->sentFrames(), quint32(3));
+    op->dump(0, uni, 0, 0);
+    QCOMPARE(op->sentFrames(), quint32(3));
+    QCOMPARE(op->skippedFrames(), quint32(1));
+
+    QCOMPARE(op->outputErrors(), quint32(0));
+
+    delete op;
+}
+
 QTEST_APPLESS_MAIN(OutputPatch_Test)
@@ -35,6 +35,11 @@ private slots:
     void defaults();
     void patch();
     void dump();
+    void dumpDelta();
+    void dumpAsync();
+    void refreshRate();
+    void skipDuplicates();
+    void statistics();
 
 private:
     Doc* m_doc;
@@ -22,8 +22,10 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+#define protected public
 #include "qlcchannel_test.h"
 #include "qlccapability.h"
+#include "qlcstringpool.h"
 #include "qlcchannel.h"
 
 void QLCChannel_Test::groupList()
@@ -212,6 +214,49 @@ void QLCChannel_Test::searchCapabilityByValue()
     delete channel;
 }
 
+void QLCChannel_Test::searchCapabilityAfterChanges()
+{
+    QLCChannel* channel = new QLCChannel();
+    QVERIFY(channel->searchCapability(0) == NULL);
+    QVERIFY(channel->m_capabilityTable.loadAcquire() != NULL);
+
+    QLCCapability* cap1 = new QLCCapability(0, 127, "Low");
+    QVERIFY(channel->addCapability(cap1) == true);
+    QVERIFY(channel->m_capabilityTable.loadAcquire() == NULL);
+    QVERIFY(channel->searchCapability(0) == cap1);
+    QVERIFY(channel->searchCapability(127) == cap1);
+    QVERIFY(channel->searchCapability(128) == NULL);
+
+    QLCCapability* cap2 = new QLCCapability(128, 255, "High");
+    QVERIFY(channel->addCapability(cap2) == true);
+    QVERIFY(channel->searchCapability(128) == cap2);
+    QVERIFY(channel->searchCapability(255) == cap2);
+
+    /* A refused range change keeps the table */
+    QVERIFY(channel->setCapabilityRange(cap1, 0, 200) == false);
+    QVERIFY(channel->searchCapability(127) == cap1);
+    QVERIFY(channel->searchCapability(200) == cap2);
+
+    QVERIFY(channel->setCapabilityRange(cap2, 200, 255) == true);
+    QVERIFY(channel->searchCapability(128) == NULL);
+    QVERIFY(channel->searchCapability(199) == NULL);
+    QVERIFY(channel->searchCapability(200) == cap2);
+
+    QVERIFY(channel->removeCapability(cap1) == true);
+    QVERIFY(channel->searchCapability(0) == NULL);
+    QVERIFY(channel->searchCapability(64) == NULL);
+    QVERIFY(channel->searchCapability(255) == cap2);
+
+    QLCChannel copy;
+    copy = *channel;
+    QVERIFY(copy.searchCapability(255) != NULL);
+    QVERIFY(copy.searchCapability(255) != cap2);
+    QVERIFY(copy.searchCapability(255)->name() == "High");
+    QVERIFY(copy.searchCapability(0) == NULL);
+
+    delete channel;
+}
+
 void QLCChannel_Test::searchCapabilityByName()
 {
     QLCChannel* channel = new QLCChannel();
@@ -576,6 +621,56 @@ void QLCChannel_Test::loadWrongRoot()
     QVERIFY(ch.capabilities().size() == 0);
 }
 
+void QLCChannel_Test::internedStrings()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+
+    xmlWriter.writeStartElement("Channels");
+    for (int i = 0; i < 2; i++)
+    {
+        xmlWriter.writeStartElement("Channel");
+        xmlWriter.writeAttribute("Name", "Shared name");
+
+        xmlWriter.writeStartElement("Capability");
+        xmlWriter.writeAttribute("Min", "0");
+        xmlWriter.writeAttribute("Max", "255");
+        xmlWriter.writeCharacters("Shared capability");
+        xmlWriter.writeEndElement();
+
+        xmlWriter.writeEndElement();
+    }
+    xmlWriter.writeEndElement();
+
+    xmlWriter.writeEndDocument();
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    QLCChannel ch1, ch2;
+    QVERIFY(xmlReader.readNextStartElement());
+    QVERIFY(ch1.loadXML(xmlReader) == true);
+    QVERIFY(xmlReader.readNextStartElement());
+    QVERIFY(ch2.loadXML(xmlReader) == true);
+
+    /* Equal strings read separately share the same data */
+    QCOMPARE(ch1.name(), QString("Shared name"));
+    QVERIFY(ch1.name().constData() == ch2.name().constData());
+
+    QCOMPARE(ch1.capabilities().count(), 1);
+    QCOMPARE(ch2.capabilities().count(), 1);
+    QCOMPARE(ch1.capabilities().first()->name(), QString("Shared capability"));
+    QVERIFY(ch1.capabilities().first()->name().constData() ==
+            ch2.capabilities().first()->name().constData());
+
+    QVERIFY(QLCStringPool::intern(QString()).isEmpty());
+    QVERIFY(QLCStringPool::count() >= 2);
+}
+
 void QLCChannel_Test::save()
 {
     QLCChannel* channel = new QLCChannel();
@@ -35,6 +35,7 @@ private slots:
     void colourList();
     void colour();
     void searchCapabilityByValue();
+    void searchCapabilityAfterChanges();
     void searchCapabilityByName();
     void addCapability();
     void removeCapability();
@@ -42,6 +43,7 @@ private slots:
     void copy();
     void load();
     void loadWrongRoot();
+    void internedStrings();
     void save();
 };
 
@@ -0,0 +1,152 @@
+/*
+  Q Light Controller Plus - Unit test
+  qlcclipboard_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define protected public
+#define private public
+#include "qlcclipboard_test.h"
+#include "qlcclipboard.h"
+#include "chaserstep.h"
+#include "sequence.h"
+#include "scene.h"
+#include "doc.h"
+#undef private
+#undef protected
+
+void QLCClipboard_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void QLCClipboard_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void QLCClipboard_Test::cleanup()
+{
+    m_doc->clipboard()->resetContents();
+    m_doc->clearContents();
+}
+
+void QLCClipboard_Test::chaserSteps()
+{
+    QLCClipboard *clipboard = m_doc->clipboard();
+    QVERIFY(clipboard->hasChaserSteps() == false);
+
+    QList <ChaserStep> steps;
+    steps << ChaserStep(1, 10, 20, 30) << ChaserStep(2, 40, 50, 60);
+
+    clipboard->copyContent(0, steps);
+    QVERIFY(clipboard->hasChaserSteps() == true);
+    QVERIFY(clipboard->getChaserSteps().isSharedWith(steps));
+
+    /* Modifying the source detaches it from the clipboard */
+    steps[0].hold = 99;
+    QVERIFY(clipboard->getChaserSteps().isSharedWith(steps) == false);
+    QCOMPARE(clipboard->getChaserSteps().at(0).hold, uint(20));
+
+    /* Modifying a pasted list doesn't touch the clipboard either */
+    QList <ChaserStep> pasted = clipboard->getChaserSteps();
+    pasted.removeFirst();
+    QCOMPARE(clipboard->getChaserSteps().count(), 2);
+}
+
+void QLCClipboard_Test::sceneValues()
+{
+    QLCClipboard *clipboard = m_doc->clipboard();
+    QVERIFY(clipboard->hasSceneValues() == false);
+
+    QList <SceneValue> values;
+    values << SceneValue(0, 1, 2) << SceneValue(3, 4, 5);
+
+    clipboard->copyContent(0, values);
+    QVERIFY(clipboard->hasSceneValues() == true);
+    QVERIFY(clipboard->getSceneValues().isSharedWith(values));
+
+    values[1].value = 200;
+    QCOMPARE(clipboard->getSceneValues().at(1).value, uchar(5));
+}
+
+void QLCClipboard_Test::sequence()
+{
+    QLCClipboard *clipboard = m_doc->clipboard();
+
+    Sequence *seq = new Sequence(m_doc);
+    seq->setName("Big");
+    for (int i = 0; i < 100; i++)
+    {
+        ChaserStep step(0, 0, 1000, 0);
+        for (quint32 ch = 0; ch < 64; ch++)
+            step.values.append(SceneValue(0, ch, uchar(i)));
+        seq->addStep(step);
+    }
+    QVERIFY(m_doc->addFunction(seq) == true);
+
+    clipboard->copyContent(seq->id(), seq);
+    QVERIFY(clipboard->hasFunction() == true);
+
+    /* The clipboard copy is out of Doc and shares the steps */
+    Sequence *copy = qobject_cast<Sequence *>(clipboard->getFunction());
+    QVERIFY(copy != NULL);
+    QVERIFY(copy != seq);
+    QVERIFY(m_doc->function(copy->id()) == NULL);
+    QCOMPARE(copy->name(), QString("Copy of Big"));
+    QVERIFY(copy->m_steps.isSharedWith(seq->m_steps));
+
+    /* So does a paste */
+    Sequence *pasted = qobject_cast<Sequence *>(copy->createCopy(m_doc, true));
+    QVERIFY(pasted != NULL);
+    QVERIFY(pasted->m_steps.isSharedWith(copy->m_steps));
+
+    /* Editing the pasted Sequence leaves the clipboard as it was */
+    ChaserStep step = pasted->steps().at(0);
+    step.hold = 5;
+    pasted->replaceStep(step, 0);
+    QVERIFY(pasted->m_steps.isSharedWith(copy->m_steps) == false);
+    QCOMPARE(copy->m_steps.at(0).hold, uint(1000));
+    QVERIFY(copy->m_steps.isSharedWith(seq->m_steps));
+
+    /* ..and so does editing the source */
+    seq->removeStep(99);
+    QCOMPARE(copy->m_steps.count(), 100);
+}
+
+void QLCClipboard_Test::scene()
+{
+    QLCClipboard *clipboard = m_doc->clipboard();
+
+    Scene *scene = new Scene(m_doc);
+    for (quint32 ch = 0; ch < 512; ch++)
+        scene->setValue(0, ch, uchar(ch));
+    QVERIFY(m_doc->addFunction(scene) == true);
+
+    clipboard->copyContent(scene->id(), scene);
+    Scene *copy = qobject_cast<Scene *>(clipboard->getFunction());
+    QVERIFY(copy != NULL);
+    QVERIFY(copy->m_values.isSharedWith(scene->m_values));
+
+    scene->setValue(0, 0, 255);
+    QVERIFY(copy->m_values.isSharedWith(scene->m_values) == false);
+    QCOMPARE(copy->value(0, 0), uchar(0));
+    QCOMPARE(copy->m_values.count(), 512);
+}
+
+QTEST_APPLESS_MAIN(QLCClipboard_Test)
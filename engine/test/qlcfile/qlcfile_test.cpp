@@ -51,6 +51,43 @@ void QLCFile_Test::XMLReader()
     QVERIFY(reader == NULL);
 }
 
+void QLCFile_Test::compressedXMLReader()
+{
+    QByteArray xml("<?xml version=\"1.0\"?><Workspace><Creator/></Workspace>");
+    QByteArray data = QLCFile::compressXML(xml);
+
+    QVERIFY(QLCFile::isCompressedXML(data) == true);
+    QVERIFY(QLCFile::isCompressedXML(xml) == false);
+    QVERIFY(QLCFile::isCompressedWorkspace("foo.qxwz") == true);
+    QVERIFY(QLCFile::isCompressedWorkspace("foo.qxw") == false);
+
+    /* compressed data in memory */
+    QXmlStreamReader *reader = QLCFile::getXMLReader(data);
+    QVERIFY(reader != NULL);
+    QVERIFY(reader->readNextStartElement() == true);
+    QCOMPARE(reader->name().toString(), QString("Workspace"));
+    QLCFile::releaseXMLReader(reader);
+
+    /* damaged compressed data */
+    QVERIFY(QLCFile::getXMLReader(data.left(data.size() / 2)) == NULL);
+
+    /* compressed file */
+    QFile file("compressed.qxwz");
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(data);
+    file.close();
+
+    reader = QLCFile::getXMLReader(file.fileName());
+    QVERIFY(reader != NULL);
+    QVERIFY(reader->readNextStartElement() == true);
+    QCOMPARE(reader->name().toString(), QString("Workspace"));
+    QVERIFY(reader->readNextStartElement() == true);
+    QCOMPARE(reader->name().toString(), QString("Creator"));
+    QLCFile::releaseXMLReader(reader);
+
+    file.remove();
+}
+
 void QLCFile_Test::getXMLHeader()
 {
     QBuffer buffer;
@@ -28,6 +28,7 @@ class QLCFile_Test : public QObject
 
 private slots:
     void XMLReader();
+    void compressedXMLReader();
     void getXMLHeader();
     void errorString();
     void version();
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QTemporaryDir>
 #include <QtTest>
 
 #define private public
@@ -128,6 +129,16 @@ void QLCFixtureDefCache_Test::add()
 
     QVERIFY(cache.models("Yoyodyne").count() == 1);
     QVERIFY(cache.models("Yoyodyne").contains("MAC250") == true);
+
+    /* Names are sorted, whatever the order they have been added */
+    QCOMPARE(cache.manufacturers(), QStringList() << "Futurelight" << "Martin" << "Yoyodyne");
+    QCOMPARE(cache.models("Martin"), QStringList() << "MAC250" << "MAC500");
+    QVERIFY(cache.fixtureDef("Yoyodyne", "MAC250") == def4);
+
+    cache.clear();
+    QVERIFY(cache.manufacturers().count() == 0);
+    QVERIFY(cache.models("Martin").count() == 0);
+    QVERIFY(cache.fixtureDef("Martin", "MAC250") == NULL);
 }
 
 void QLCFixtureDefCache_Test::fixtureDef()
@@ -212,4 +223,61 @@ void QLCFixtureDefCache_Test::defDirectories()
 
 }
 
+void QLCFixtureDefCache_Test::index()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    QString indexPath = tmp.path() + QString("/index.dat");
+
+    QDir userDir(tmp.path() + QString("/user"));
+    QVERIFY(userDir.mkpath("."));
+    QString userFile = userDir.absoluteFilePath("Futurelight-CY-200.qxf");
+    QVERIFY(QFile::copy(QString("%1/Futurelight/Futurelight-CY-200.qxf").arg(INTERNAL_FIXTUREDIR), userFile));
+    userDir.setFilter(QDir::Files);
+    userDir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+
+    QDir sysDir(INTERNAL_FIXTUREDIR);
+    sysDir.setFilter(QDir::Files);
+    sysDir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+
+    /* The first time, everything is read and indexed */
+    QLCFixtureDefCache first;
+    first.setIndexFile(indexPath);
+    QCOMPARE(first.indexFile(), indexPath);
+    QVERIFY(first.load(userDir) == true);
+    QVERIFY(first.loadMap(sysDir) == true);
+    QVERIFY(QFile::exists(indexPath));
+    QCOMPARE(first.m_fileIndex.count(), 2);
+
+    QLCFixtureDef *def = first.fixtureDef("Futurelight", "CY-200");
+    QVERIFY(def != NULL);
+    QVERIFY(def->isUser() == true);
+    QVERIFY(def->definitionSourceFile().isEmpty());
+
+    /* The next time, the definitions come from the index */
+    QLCFixtureDefCache second;
+    second.setIndexFile(indexPath);
+    QVERIFY(second.load(userDir) == true);
+    QVERIFY(second.loadMap(sysDir) == true);
+    QVERIFY(second.m_fileIndexChanged == false);
+    QCOMPARE(second.manufacturers(), first.manufacturers());
+    QCOMPARE(second.models("Martin"), first.models("Martin"));
+
+    /* User definitions are loaded lazily as well */
+    QCOMPARE(second.m_index["Futurelight"]["CY-200"]->definitionSourceFile(), userFile);
+    def = second.fixtureDef("Futurelight", "CY-200");
+    QVERIFY(def != NULL);
+    QVERIFY(def->isUser() == true);
+    QVERIFY(def->definitionSourceFile().isEmpty());
+    QVERIFY(def->channels().count() > 0);
+
+    /* A removed user file is dropped from the index */
+    QVERIFY(QFile::remove(userFile));
+    QLCFixtureDefCache third;
+    third.setIndexFile(indexPath);
+    QVERIFY(third.load(userDir) == true);
+    QCOMPARE(third.m_fileIndex.count(), 1);
+    QVERIFY(third.fixtureDef("Futurelight", "CY-200") == NULL);
+}
+
 QTEST_APPLESS_MAIN(QLCFixtureDefCache_Test)
@@ -36,6 +36,7 @@ private slots:
     void fixtureDef();
 	void load();
     void defDirectories();
+    void index();
 
 private:
     QLCFixtureDefCache cache;
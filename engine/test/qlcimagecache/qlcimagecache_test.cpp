@@ -0,0 +1,122 @@
+/*
+  Q Light Controller Plus - Unit test
+  qlcimagecache_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QImage>
+
+#include "qlcimagecache_test.h"
+#include "qlcimagecache.h"
+
+void QLCImageCache_Test::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+void QLCImageCache_Test::cleanup()
+{
+    QLCImageCache::clear();
+    QLCImageCache::setBudget(QLCIMAGECACHE_DEFAULT_BUDGET);
+}
+
+QString QLCImageCache_Test::writeImage(const QString& name, int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+
+    QString path = m_dir.filePath(name);
+    image.save(path, "PNG");
+    return path;
+}
+
+void QLCImageCache_Test::bucket()
+{
+    QCOMPARE(QLCImageCache::bucket(QSize()), 0);
+    QCOMPARE(QLCImageCache::bucket(QSize(0, 0)), 0);
+    QCOMPARE(QLCImageCache::bucket(QSize(4, 4)), QLCIMAGECACHE_MIN_EXTENT);
+    QCOMPARE(QLCImageCache::bucket(QSize(28, 28)), 32);
+    QCOMPARE(QLCImageCache::bucket(QSize(32, 32)), 32);
+    QCOMPARE(QLCImageCache::bucket(QSize(40, 20)), 64);
+    QCOMPARE(QLCImageCache::bucket(QSize(10000, 10)), QLCIMAGECACHE_MAX_EXTENT);
+}
+
+void QLCImageCache_Test::shared()
+{
+    QString path = writeImage("gobo.png", 100, 100);
+
+    QImage first = QLCImageCache::image(path, QSize(40, 40));
+    QImage second = QLCImageCache::image(path, QSize(50, 50));
+    QVERIFY(first.isNull() == false);
+
+    /* Same bucket, same decoded copy */
+    QCOMPARE(first.cacheKey(), second.cacheKey());
+    QCOMPARE(QLCImageCache::count(), 1);
+
+    /* Another bucket is another copy */
+    QImage small = QLCImageCache::image(path, QSize(16, 16));
+    QVERIFY(small.cacheKey() != first.cacheKey());
+    QCOMPARE(QLCImageCache::count(), 2);
+
+    QLCImageCache::clear();
+    QCOMPARE(QLCImageCache::count(), 0);
+    QCOMPARE(QLCImageCache::cost(), 0);
+}
+
+void QLCImageCache_Test::scaled()
+{
+    QString path = writeImage("wide.png", 200, 100);
+
+    QImage image = QLCImageCache::image(path, QSize(60, 60));
+    QCOMPARE(image.size(), QSize(64, 32));
+
+    /* Smaller images are never scaled up */
+    image = QLCImageCache::image(path, QSize(500, 500));
+    QCOMPARE(image.size(), QSize(200, 100));
+
+    image = QLCImageCache::image(path);
+    QCOMPARE(image.size(), QSize(200, 100));
+}
+
+void QLCImageCache_Test::missing()
+{
+    QImage image = QLCImageCache::image(m_dir.filePath("missing.png"), QSize(32, 32));
+    QVERIFY(image.isNull());
+    QCOMPARE(QLCImageCache::count(), 0);
+
+    QVERIFY(QLCImageCache::image(QString()).isNull());
+}
+
+void QLCImageCache_Test::budget()
+{
+    /* 256x256 ARGB32 images take 256 KB each */
+    QString first = writeImage("first.png", 256, 256);
+    QString second = writeImage("second.png", 256, 256);
+
+    QLCImageCache::setBudget(300);
+
+    QLCImageCache::image(first);
+    QCOMPARE(QLCImageCache::count(), 1);
+    QCOMPARE(QLCImageCache::cost(), 256);
+
+    /* The least recently used image makes room for the new one */
+    QLCImageCache::image(second);
+    QCOMPARE(QLCImageCache::count(), 1);
+    QCOMPARE(QLCImageCache::cost(), 256);
+}
+
+QTEST_APPLESS_MAIN(QLCImageCache_Test)
@@ -21,8 +21,13 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+#define private public
 #include "qlcpalette_test.h"
 #include "qlcpalette.h"
+#undef private
+#include "scenevalue.h"
+#include "fixture.h"
+#include "doc.h"
 
 void QLCPalette_Test::initialization()
 {
@@ -147,6 +152,59 @@ void QLCPalette_Test::fanning()
     QVERIFY(p.fanningAmount() == 75);
 }
 
+void QLCPalette_Test::valuesCache()
+{
+    Doc doc(this);
+
+    Fixture *fxi1 = new Fixture(&doc);
+    fxi1->setChannels(4);
+    doc.addFixture(fxi1);
+
+    Fixture *fxi2 = new Fixture(&doc);
+    fxi2->setChannels(4);
+    doc.addFixture(fxi2);
+
+    QLCPalette p(QLCPalette::Dimmer);
+    p.setValue(100);
+    QVERIFY(p.m_valuesCache.isEmpty());
+
+    QList<quint32> fixtures;
+    fixtures << fxi1->id() << fxi2->id();
+
+    /* The first request resolves and caches the fixture list */
+    QList<SceneValue> values = p.valuesFromFixtures(&doc, fixtures);
+    QCOMPARE(p.m_valuesCache.count(), 1);
+    QCOMPARE(p.m_valuesCacheRevision, doc.fixturesRevision());
+
+    /* Asking again for the same list is served from the cache */
+    QVERIFY(p.valuesFromFixtures(&doc, fixtures) == values);
+    QCOMPARE(p.m_valuesCache.count(), 1);
+
+    QList<quint32> single;
+    single << fxi2->id();
+    p.valuesFromFixtures(&doc, single);
+    QCOMPARE(p.m_valuesCache.count(), 2);
+
+    /* Editing the Palette drops the cache */
+    p.setValue(50);
+    QVERIFY(p.m_valuesCache.isEmpty());
+    p.valuesFromFixtures(&doc, fixtures);
+    QCOMPARE(p.m_valuesCache.count(), 1);
+
+    p.setFanningType(QLCPalette::Linear);
+    QVERIFY(p.m_valuesCache.isEmpty());
+    p.valuesFromFixtures(&doc, fixtures);
+    QCOMPARE(p.m_valuesCache.count(), 1);
+
+    /* Editing a fixture outdates the cache too */
+    int revision = doc.fixturesRevision();
+    fxi1->setAddress(10);
+    QVERIFY(doc.fixturesRevision() != revision);
+    p.valuesFromFixtures(&doc, single);
+    QCOMPARE(p.m_valuesCache.count(), 1);
+    QCOMPARE(p.m_valuesCacheRevision, doc.fixturesRevision());
+}
+
 void QLCPalette_Test::colorHelpers()
 {
     QColor rgb(0xAA, 0xBB, 0xCC);
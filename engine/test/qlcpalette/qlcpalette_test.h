@@ -33,6 +33,7 @@ private slots:
     void icon();
     void value();
     void fanning();
+    void valuesCache();
 
     void colorHelpers();
 
@@ -28,9 +28,13 @@
 #include "rgbmatrix_test.h"
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
+#include "genericfader.h"
 #include "fixturegroup.h"
+#include "fadechannel.h"
 #include "mastertimer.h"
+#include "universe.h"
 #include "rgbmatrix.h"
+#include "rgbtext.h"
 #include "fixture.h"
 #include "qlcfile.h"
 #include "doc.h"
@@ -39,6 +43,31 @@
 
 #include "../common/resource_paths.h"
 
+/** Holds the algorithm mutex of a matrix from another thread */
+class AlgorithmLocker : public QThread
+{
+public:
+    AlgorithmLocker(RGBMatrix *matrix)
+        : m_matrix(matrix)
+    {
+    }
+
+    QSemaphore m_locked;
+    QSemaphore m_release;
+
+protected:
+    void run()
+    {
+        m_matrix->algorithmMutex().lock();
+        m_locked.release();
+        m_release.acquire();
+        m_matrix->algorithmMutex().unlock();
+    }
+
+private:
+    RGBMatrix *m_matrix;
+};
+
 void RGBMatrix_Test::initTestCase()
 {
     m_doc = new Doc(this);
@@ -153,7 +182,7 @@ void RGBMatrix_Test::previewMaps()
     QCOMPARE(steps, 0);
 
     mtx.previewMap(0, &handler);
-    QCOMPARE(handler.m_map.size(), 0); // No fixture group
+    QCOMPARE(handler.m_map.height(), 0); // No fixture group
 
     mtx.setFixtureGroup(0);
     steps = mtx.stepsCount();
@@ -165,7 +194,7 @@ void RGBMatrix_Test::previewMaps()
     QCOMPARE(mtx.totalDuration(), uint(8000));
 
     mtx.previewMap(0, &handler);
-    QCOMPARE(handler.m_map.size(), 5);
+    QCOMPARE(handler.m_map.height(), 5);
 
     for (int z = 0; z < steps; z++)
     {
@@ -358,4 +387,303 @@ void RGBMatrix_Test::loadSave()
 
 }
 
+void RGBMatrix_Test::headBindings()
+{
+    Doc doc(this);
+
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("American DJ", "Dotz Bar 1.4");
+    QVERIFY(def != NULL);
+    QLCFixtureMode* mode = def->mode("12 Channel");
+    QVERIFY(mode != NULL);
+    QVERIFY(mode->heads().size() == 4);
+
+    Fixture* fxi = new Fixture(&doc);
+    fxi->setFixtureDefinition(def, mode);
+    fxi->setAddress(0);
+    doc.addFixture(fxi);
+
+    FixtureGroup* grp = new FixtureGroup(&doc);
+    grp->setSize(QSize(4, 1));
+    doc.addFixtureGroup(grp);
+    grp->assignFixture(fxi->id());
+
+    /* A fade makes the matrix use fader channels */
+    RGBMatrix mtx(&doc);
+    mtx.setFixtureGroup(grp->id());
+    mtx.setFadeInSpeed(100);
+    QVERIFY(mtx.m_headBindingsChanged == true);
+
+    RGBMap map(QSize(4, 1));
+    map[0][0] = qRgb(255, 0, 0);
+    map[0][1] = qRgb(0, 255, 0);
+    map[0][2] = qRgb(0, 0, 255);
+    map[0][3] = qRgb(10, 20, 30);
+
+    QList<Universe*> ua = doc.inputOutputMap()->claimUniverses();
+    mtx.updateMapChannels(map, grp, ua);
+    QVERIFY(mtx.m_headBindingsDirect == false);
+
+    /* Every head is bound to its RGB channels */
+    QVERIFY(mtx.m_headBindingsChanged == false);
+    QCOMPARE(mtx.m_headBindingsRevision, doc.fixturesRevision());
+    QCOMPARE(mtx.m_headBindings.count(), 4);
+    foreach (const RGBMatrix::HeadBinding &binding, mtx.m_headBindings)
+    {
+        QCOMPARE(binding.m_colorChannels.size(), 3);
+        QVERIFY(binding.m_cmy == false);
+        QVERIFY(binding.m_greyDimmer == NULL);
+    }
+    QCOMPARE(mtx.m_fadersMap[0]->channelsCount(), 12);
+
+    const RGBMatrix::HeadBinding &last = mtx.m_headBindings.at(3);
+    QCOMPARE(last.m_colorChannels.at(0)->channel(), quint32(9));
+    QCOMPARE(last.m_colorChannels.at(0)->target(), uchar(10));
+    QCOMPARE(last.m_colorChannels.at(1)->target(), uchar(20));
+    QCOMPARE(last.m_colorChannels.at(2)->target(), uchar(30));
+
+    /* A new step is applied through the same channels */
+    map[0][3] = qRgb(40, 50, 60);
+    mtx.updateMapChannels(map, grp, ua);
+    QCOMPARE(mtx.m_fadersMap[0]->channelsCount(), 12);
+    QCOMPARE(mtx.m_headBindings.at(3).m_colorChannels.at(2)->target(), uchar(60));
+
+    /* Changing control mode or the group rebuilds the bindings */
+    mtx.setControlMode(RGBMatrix::ControlModeWhite);
+    QVERIFY(mtx.m_headBindingsChanged == true);
+    mtx.updateMapChannels(map, grp, ua);
+    QCOMPARE(mtx.m_headBindings.count(), 4);
+    QVERIFY(mtx.m_headBindings.at(0).m_colorChannels.isEmpty());
+
+    grp->setSize(QSize(2, 2));
+    QVERIFY(mtx.m_headBindingsChanged == true);
+
+    doc.inputOutputMap()->releaseUniverses(false);
+}
+
+void RGBMatrix_Test::directLayer()
+{
+    Doc doc(this);
+
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("American DJ", "Dotz Bar 1.4");
+    QVERIFY(def != NULL);
+    QLCFixtureMode* mode = def->mode("12 Channel");
+    QVERIFY(mode != NULL);
+
+    Fixture* fxi = new Fixture(&doc);
+    fxi->setFixtureDefinition(def, mode);
+    fxi->setAddress(0);
+    doc.addFixture(fxi);
+
+    FixtureGroup* grp = new FixtureGroup(&doc);
+    grp->setSize(QSize(4, 1));
+    doc.addFixtureGroup(grp);
+    grp->assignFixture(fxi->id());
+
+    RGBMatrix mtx(&doc);
+    mtx.setFixtureGroup(grp->id());
+
+    RGBMap map(QSize(4, 1));
+    map[0][0] = qRgb(255, 0, 0);
+    map[0][3] = qRgb(10, 20, 30);
+
+    /* Without fades the map goes to the fader layer, with no fader channel */
+    QList<Universe*> ua = doc.inputOutputMap()->claimUniverses();
+    mtx.updateMapChannels(map, grp, ua);
+    QVERIFY(mtx.m_headBindingsDirect == true);
+    QCOMPARE(mtx.m_headBindings.count(), 4);
+    QVERIFY(mtx.m_headBindings.at(0).m_colorChannels.isEmpty());
+    QCOMPARE(mtx.m_headBindings.at(0).m_colorAddresses.size(), 3);
+
+    GenericFader *fader = mtx.m_fadersMap[0].data();
+    QCOMPARE(fader->channelsCount(), 0);
+    QCOMPARE(fader->layerChannelsCount(), 12);
+
+    ua[0]->zeroIntensityChannels();
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues().at(0)), uchar(255));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(1)), uchar(0));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(9)), uchar(10));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(10)), uchar(20));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(11)), uchar(30));
+
+    /* A new step just updates the layer */
+    map[0][3] = qRgb(40, 50, 60);
+    mtx.updateMapChannels(map, grp, ua);
+    ua[0]->zeroIntensityChannels();
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues().at(11)), uchar(60));
+
+    /* Setting a fade goes back to the fader channels */
+    mtx.setFadeOutSpeed(100);
+    mtx.updateMapChannels(map, grp, ua);
+    QVERIFY(mtx.m_headBindingsDirect == false);
+    QCOMPARE(fader->layerChannelsCount(), 0);
+    QCOMPARE(fader->channelsCount(), 12);
+
+    doc.inputOutputMap()->releaseUniverses(false);
+}
+
+void RGBMatrix_Test::stepCache()
+{
+    Doc doc(this);
+    QVERIFY(doc.rgbScriptsCache()->load(QDir(INTERNAL_SCRIPTDIR)));
+
+    FixtureGroup* grp = new FixtureGroup(&doc);
+    grp->setSize(QSize(5, 5));
+    doc.addFixtureGroup(grp);
+
+    RGBMatrix mtx(&doc);
+    mtx.setFixtureGroup(grp->id());
+
+    /* Stripes declares itself deterministic */
+    QVERIFY(mtx.algorithm() != NULL);
+    QVERIFY(mtx.algorithm()->deterministic() == true);
+    QCOMPARE(mtx.m_stepCache.count(), 0);
+
+    RGBMatrixStep handler;
+    handler.setStepColor(Qt::red);
+    mtx.previewMap(1, &handler);
+    QCOMPARE(mtx.m_stepCache.count(), 1);
+    QCOMPARE(mtx.m_stepCacheSize, QSize(5, 5));
+    QCOMPARE(handler.m_map[0][1], QColor(Qt::red).rgb());
+
+    /* The same step is served from the cache */
+    handler.m_map = RGBMap();
+    mtx.previewMap(1, &handler);
+    QCOMPARE(mtx.m_stepCache.count(), 1);
+    QCOMPARE(handler.m_map[0][1], QColor(Qt::red).rgb());
+
+    /* Changing a property forgets the rendered maps */
+    mtx.setProperty("orientation", "Vertical");
+    QCOMPARE(mtx.m_stepCache.count(), 0);
+    mtx.previewMap(1, &handler);
+    QCOMPARE(handler.m_map[1][0], QColor(Qt::red).rgb());
+    QCOMPARE(handler.m_map[0][1], uint(0));
+
+    /* So does resizing the group */
+    grp->setSize(QSize(3, 3));
+    mtx.previewMap(1, &handler);
+    QCOMPARE(mtx.m_stepCache.count(), 1);
+    QCOMPARE(mtx.m_stepCacheSize, QSize(3, 3));
+
+    /* Non deterministic algorithms are not cached */
+    mtx.setAlgorithm(new RGBText(&doc));
+    QVERIFY(mtx.algorithm()->deterministic() == false);
+    QCOMPARE(mtx.m_stepCache.count(), 0);
+}
+
+void RGBMatrix_Test::previewCopy()
+{
+    Doc doc(this);
+    QVERIFY(doc.rgbScriptsCache()->load(QDir(INTERNAL_SCRIPTDIR)));
+
+    FixtureGroup* grp = new FixtureGroup(&doc);
+    grp->setSize(QSize(5, 5));
+    doc.addFixtureGroup(grp);
+
+    RGBMatrix mtx(&doc);
+    mtx.setFixtureGroup(grp->id());
+    QVERIFY(mtx.m_previewAlgorithm == NULL);
+
+    /* Scripts are previewed with a copy of their own */
+    RGBMatrixStep handler;
+    handler.setStepColor(Qt::red);
+    mtx.previewMap(1, &handler);
+    QVERIFY(mtx.m_previewAlgorithm != NULL);
+    QVERIFY(mtx.m_previewAlgorithm != mtx.algorithm());
+    QCOMPARE(handler.m_map[0][1], QColor(Qt::red).rgb());
+
+    /* The copy follows the property changes */
+    RGBAlgorithm *copy = mtx.m_previewAlgorithm;
+    mtx.previewMap(2, &handler);
+    QVERIFY(mtx.m_previewAlgorithm == copy);
+    mtx.setProperty("orientation", "Vertical");
+    mtx.previewMap(2, &handler);
+    QVERIFY(mtx.m_previewAlgorithm != NULL);
+    QCOMPARE(mtx.m_previewRevision, mtx.m_algorithmRevision);
+    QCOMPARE(handler.m_map[2][0], QColor(Qt::red).rgb());
+    QCOMPARE(handler.m_map[0][2], uint(0));
+
+    /* A preview doesn't wait for a busy algorithm */
+    AlgorithmLocker locker(&mtx);
+    locker.start();
+    locker.m_locked.acquire();
+
+    mtx.invalidateStepCache();
+    handler.m_map = RGBMap();
+    mtx.previewMap(3, &handler);
+    QCOMPARE(handler.m_map[3][0], QColor(Qt::red).rgb());
+    QCOMPARE(mtx.m_stepCache.count(), 0);
+
+    locker.m_release.release();
+    QVERIFY(locker.wait(1000));
+
+    /* The other algorithms don't need a copy */
+    mtx.setAlgorithm(new RGBText(&doc));
+    mtx.previewMap(0, &handler);
+    QVERIFY(mtx.m_previewAlgorithm == NULL);
+}
+
+void RGBMatrix_Test::aheadOfTimeRender()
+{
+    Doc doc(this);
+    QVERIFY(doc.rgbScriptsCache()->load(QDir(INTERNAL_SCRIPTDIR)));
+
+    FixtureGroup* grp = new FixtureGroup(&doc);
+    grp->setSize(QSize(2, 1));
+    doc.addFixtureGroup(grp);
+
+    /* A script painting the step index in the first pixel */
+    RGBScript *script = new RGBScript(&doc);
+    script->m_fileName = "steps.js";
+    script->m_contents = "(function() { var algo = new Object; algo.apiVersion = 1;"
+                         "algo.name = \"Steps\"; algo.author = \"Test\";"
+                         "algo.rgbMap = function(width, height, rgb, step) {"
+                         "  var map = new Array(height);"
+                         "  for (var y = 0; y < height; y++) {"
+                         "    map[y] = new Array(width);"
+                         "    for (var x = 0; x < width; x++) map[y][x] = 0;"
+                         "  }"
+                         "  map[0][0] = step + 1; return map; };"
+                         "algo.rgbMapStepCount = function(width, height) { return 4; };"
+                         "return algo; })()";
+    QVERIFY(script->evaluate());
+    QVERIFY(script->deterministic() == false);
+
+    RGBMatrix mtx(&doc);
+    mtx.setFixtureGroup(grp->id());
+    mtx.setAlgorithm(script);
+    QCOMPARE(mtx.m_stepsCount, 4);
+
+    /* The first step is rendered on demand, the next one ahead of time */
+    mtx.m_stepHandler->initializeDirection(Function::Forward, mtx.startColor(), QColor(), 4);
+    QCOMPARE(mtx.m_stepHandler->currentStepIndex(), 0);
+    mtx.renderStep(grp->size());
+    QVERIFY(mtx.m_renderPool != NULL);
+    QCOMPARE(mtx.m_stepHandler->m_map[0][0], uint(1));
+
+    mtx.m_renderPool->waitForDone();
+    QVERIFY(mtx.m_renderedStep.m_ready == true);
+    QCOMPARE(mtx.m_renderedStep.m_step, 1);
+    QCOMPARE(mtx.m_renderedStep.m_map[0][0], uint(2));
+
+    /* The predicted step is taken as it is */
+    mtx.m_stepHandler->checkNextStep(Function::Loop, mtx.startColor(), QColor(), 4);
+    mtx.renderStep(grp->size());
+    QCOMPARE(mtx.m_stepHandler->m_map[0][0], uint(2));
+    mtx.m_renderPool->waitForDone();
+    QCOMPARE(mtx.m_renderedStep.m_step, 2);
+
+    /* A wrong prediction falls back to rendering the actual step */
+    mtx.m_stepHandler->setCurrentStepIndex(0);
+    mtx.renderStep(grp->size());
+    QCOMPARE(mtx.m_stepHandler->m_map[0][0], uint(1));
+
+    /* Changing the colors outdates the rendered steps */
+    mtx.m_renderPool->waitForDone();
+    QVERIFY(mtx.m_renderedStep.m_ready == true);
+    mtx.setStartColor(Qt::blue);
+    QVERIFY(mtx.m_renderedStep.m_ready == false);
+}
+
 QTEST_MAIN(RGBMatrix_Test)
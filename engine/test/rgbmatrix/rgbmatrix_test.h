@@ -44,6 +44,11 @@ private slots:
     void previewMaps();
     void property();
     void loadSave();
+    void headBindings();
+    void directLayer();
+    void stepCache();
+    void previewCopy();
+    void aheadOfTimeRender();
 
 private:
     Doc* m_doc;
@@ -46,7 +46,7 @@ void RGBScript_Test::cleanupTestCase()
 void RGBScript_Test::initial()
 {
     RGBScript script(m_doc);
-    QVERIFY(script.s_engine == NULL);
+    QVERIFY(script.m_programs.isEmpty());
     QCOMPARE(script.m_apiVersion, 0);
     QCOMPARE(script.m_fileName, QString());
     QCOMPARE(script.m_contents, QString());
@@ -101,13 +101,13 @@ void RGBScript_Test::script()
     QCOMPARE(s.author(), QString());
     QCOMPARE(s.name(), QString());
 #ifdef QT_QML_LIB
-    QVERIFY(s.m_script.isUndefined() == true);
-    QVERIFY(s.m_rgbMap.isUndefined() == true);
-    QVERIFY(s.m_rgbMapStepCount.isUndefined() == true);
+    QVERIFY(s.program(s.threadEngine())->m_script.isUndefined() == true);
+    QVERIFY(s.program(s.threadEngine())->m_rgbMap.isUndefined() == true);
+    QVERIFY(s.program(s.threadEngine())->m_rgbMapStepCount.isUndefined() == true);
 #else
-    // QVERIFY(s.m_script.isValid() == false); // TODO: to be fixed !!
-    QVERIFY(s.m_rgbMap.isValid() == false);
-    QVERIFY(s.m_rgbMapStepCount.isValid() == false);
+    // QVERIFY(s.program(s.threadEngine())->m_script.isValid() == false); // TODO: to be fixed !!
+    QVERIFY(s.program(s.threadEngine())->m_rgbMap.isValid() == false);
+    QVERIFY(s.program(s.threadEngine())->m_rgbMapStepCount.isValid() == false);
 #endif
     s = m_doc->rgbScriptsCache()->script("Stripes");
     QCOMPARE(s.fileName(), QString("stripes.js"));
@@ -116,13 +116,13 @@ void RGBScript_Test::script()
     QCOMPARE(s.author(), QString("Massimo Callegari"));
     QCOMPARE(s.name(), QString("Stripes"));
 #ifdef QT_QML_LIB
-    QVERIFY(s.m_script.isUndefined() == false);
-    QVERIFY(s.m_rgbMap.isUndefined() == false);
-    QVERIFY(s.m_rgbMapStepCount.isUndefined() == false);
+    QVERIFY(s.program(s.threadEngine())->m_script.isUndefined() == false);
+    QVERIFY(s.program(s.threadEngine())->m_rgbMap.isUndefined() == false);
+    QVERIFY(s.program(s.threadEngine())->m_rgbMapStepCount.isUndefined() == false);
 #else
-    QVERIFY(s.m_script.isValid() == true);
-    QVERIFY(s.m_rgbMap.isValid() == true);
-    QVERIFY(s.m_rgbMapStepCount.isValid() == true);
+    QVERIFY(s.program(s.threadEngine())->m_script.isValid() == true);
+    QVERIFY(s.program(s.threadEngine())->m_rgbMap.isValid() == true);
+    QVERIFY(s.program(s.threadEngine())->m_rgbMapStepCount.isValid() == true);
 #endif
 }
 
@@ -200,4 +200,88 @@ void RGBScript_Test::rgbMap()
     }
 }
 
+class PropertyReader : public QThread
+{
+public:
+    PropertyReader(RGBScript *script)
+        : m_script(script)
+    {
+    }
+
+    void run()
+    {
+        m_value = m_script->property("orientation");
+        m_script->rgbMap(QSize(5, 5), QColor(Qt::red).rgb(), 1, m_map);
+    }
+
+    RGBScript *m_script;
+    QString m_value;
+    RGBMap m_map;
+};
+
+void RGBScript_Test::threadEngines()
+{
+    RGBScript s = m_doc->rgbScriptsCache()->script("Stripes");
+    QCOMPARE(s.m_programs.count(), 0);
+
+    s.setProperty("orientation", "Vertical");
+    QCOMPARE(s.m_propertyValues.value("orientation"), QString("Vertical"));
+
+    // Another thread evaluates the script in its own engine,
+    // with the properties set so far
+    PropertyReader reader(&s);
+    reader.start();
+    QVERIFY(reader.wait(5000));
+
+    QCOMPARE(s.m_programs.count(), 2);
+    QCOMPARE(reader.m_value, QString("Vertical"));
+    QCOMPARE(reader.m_map.size(), QSize(5, 5));
+    for (int x = 0; x < 5; x++)
+    {
+        QCOMPARE(reader.m_map[0][x], uint(0));
+        QCOMPARE(reader.m_map[1][x], QColor(Qt::red).rgb());
+    }
+
+    // Evaluating again forgets the properties
+    QVERIFY(s.evaluate());
+    QVERIFY(s.m_propertyValues.isEmpty());
+    QCOMPARE(s.property("orientation"), QString("Horizontal"));
+}
+
+void RGBScript_Test::lazyLoad()
+{
+    RGBScript evaluated(m_doc);
+    QVERIFY(evaluated.load(QDir(INTERNAL_SCRIPTDIR), "stripes.js"));
+    QCOMPARE(evaluated.m_programs.count(), 1);
+
+    // Loading with the metadata doesn't evaluate the script
+    RGBScript s(m_doc);
+    QVERIFY(s.load(QDir(INTERNAL_SCRIPTDIR), "stripes.js", evaluated.metadata()));
+    QCOMPARE(s.m_programs.count(), 0);
+    QCOMPARE(s.name(), QString("Stripes"));
+    QCOMPARE(s.author(), QString("Massimo Callegari"));
+    QCOMPARE(s.apiVersion(), evaluated.apiVersion());
+    QCOMPARE(s.acceptColors(), evaluated.acceptColors());
+    QCOMPARE(s.properties().count(), evaluated.properties().count());
+    QCOMPARE(s.metadata(), evaluated.metadata());
+
+    // The copies are not evaluated either
+    s.setProperty("orientation", "Vertical");
+    RGBScript copy(s);
+    QCOMPARE(copy.m_programs.count(), 0);
+    QCOMPARE(copy.name(), QString("Stripes"));
+
+    // The first use compiles the script, with the properties set so far
+    QCOMPARE(copy.rgbMapStepCount(QSize(10, 15)), 15);
+    QCOMPARE(copy.m_programs.count(), 1);
+    QCOMPARE(copy.property("orientation"), QString("Vertical"));
+
+    // A second cache loads the unchanged scripts from the index
+    RGBScriptsCache cache(m_doc);
+    QVERIFY(cache.load(QDir(INTERNAL_SCRIPTDIR)));
+    QCOMPARE(cache.names().count(), m_doc->rgbScriptsCache()->names().count());
+    QCOMPARE(cache.script("Stripes").m_programs.count(), 0);
+    QCOMPARE(cache.script("Stripes").name(), QString("Stripes"));
+}
+
 QTEST_MAIN(RGBScript_Test)
@@ -41,6 +41,8 @@ private slots:
     void evaluateInvalidApiVersion();
     void rgbMapStepCount();
     void rgbMap();
+    void threadEngines();
+    void lazyLoad();
 
 private:
     Doc * m_doc;
@@ -330,26 +330,23 @@ void RGBText_Test::staticLetters()
     // more or less OS, platform, HW and SW dependent and testing individual pixels
     // would thus be rather pointless.
     text.rgbMap(QSize(10, 10), color, 0, map);
-    QCOMPARE(map.size(), 10);
-    for (int i = 0; i < 10; i++)
-        QCOMPARE(map[i].size(), 10);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
 
     text.rgbMap(QSize(10, 10), color, 1, map);
-    QCOMPARE(map.size(), 10);
-    for (int i = 0; i < 10; i++)
-        QCOMPARE(map[i].size(), 10);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
 
     text.rgbMap(QSize(10, 10), color, 2, map);
-    QCOMPARE(map.size(), 10);
-    for (int i = 0; i < 10; i++)
-        QCOMPARE(map[i].size(), 10);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
 
     // Invalid step
     text.rgbMap(QSize(10, 10), color, 3, map);
-    QCOMPARE(map.size(), 10);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
     for (int i = 0; i < 10; i++)
     {
-        QCOMPARE(map[i].size(), 10);
         for (int j = 0; j < 10; j++)
         {
             QCOMPARE(map[i][j], QColor(Qt::black).rgb());
@@ -382,9 +379,8 @@ void RGBText_Test::horizontalScroll()
     {
         RGBMap map;
         text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), i, map);
-        QCOMPARE(map.size(), 10);
-        for (int y = 0; y < 10; y++)
-            QCOMPARE(map[y].size(), 10);
+        QCOMPARE(map.height(), 10);
+        QCOMPARE(map.width(), 10);
     }
 
     RGBMap map;
@@ -394,10 +390,10 @@ void RGBText_Test::horizontalScroll()
 #else
     text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), fm.horizontalAdvance("QLC"), map);
 #endif
-    QCOMPARE(map.size(), 10);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
     for (int i = 0; i < 10; i++)
     {
-        QCOMPARE(map[i].size(), 10);
         for (int j = 0; j < 10; j++)
         {
             QCOMPARE(map[i][j], QRgb(0));
@@ -422,18 +418,17 @@ void RGBText_Test::verticalScroll()
     {
         RGBMap map;
         text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), i, map);
-        QCOMPARE(map.size(), 10);
-        for (int y = 0; y < 10; y++)
-            QCOMPARE(map[y].size(), 10);
+        QCOMPARE(map.height(), 10);
+        QCOMPARE(map.width(), 10);
     }
 
     // Invalid step
     RGBMap map;
     text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), fm.ascent() * 4, map);
-    QCOMPARE(map.size(), 10);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
     for (int i = 0; i < 10; i++)
     {
-        QCOMPARE(map[i].size(), 10);
         for (int j = 0; j < 10; j++)
         {
             QCOMPARE(map[i][j], QRgb(0));
@@ -441,4 +436,62 @@ void RGBText_Test::verticalScroll()
     }
 }
 
+void RGBText_Test::strip()
+{
+    RGBText text(m_doc);
+    text.setText("QLC");
+    text.setAnimationStyle(RGBText::Horizontal);
+    QVERIFY(text.m_stripSize.isValid() == false);
+
+    RGBMap white;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 2, white);
+    QCOMPARE(text.m_stripSize, QSize(10, 10));
+    QCOMPARE(text.m_stripWidth, text.rgbMapStepCount(QSize()));
+    QCOMPARE(text.m_stripHeight, 10);
+
+    // the strip is reused with another color, which only changes the lit pixels
+    QVector<quint32> strip = text.m_strip;
+    RGBMap red;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFF0000), 2, red);
+    QVERIFY(text.m_strip == strip);
+    for (int y = 0; y < 10; y++)
+    {
+        for (int x = 0; x < 10; x++)
+        {
+            if (white[y][x] == QRgb(0xFFFFFFFF))
+                QCOMPARE(red[y][x], QRgb(0xFFFF0000));
+            else
+                QCOMPARE(red[y][x], QColor(Qt::black).rgb());
+        }
+    }
+
+    // the following steps are windows on the same strip
+    RGBMap next;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 3, next);
+    for (int y = 0; y < 10; y++)
+    {
+        for (int x = 0; x < 9; x++)
+            QCOMPARE(next[y][x], white[y][x + 1]);
+    }
+
+    // any setting change renders the strip again
+    text.setText("Foo");
+    QVERIFY(text.m_stripSize.isValid() == false);
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 0, white);
+    QVERIFY(text.m_stripSize.isValid() == true);
+    text.setXOffset(1);
+    QVERIFY(text.m_stripSize.isValid() == false);
+
+    // and so does another map size
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 0, white);
+    text.rgbMap(QSize(10, 12), QRgb(0xFFFFFFFF), 0, white);
+    QCOMPARE(text.m_stripHeight, 12);
+
+    // static letters are laid side by side
+    text.setAnimationStyle(RGBText::StaticLetters);
+    text.rgbMap(QSize(8, 8), QRgb(0xFFFFFFFF), 1, white);
+    QCOMPARE(text.m_stripWidth, 8 * 3);
+    QCOMPARE(text.m_stripHeight, 8);
+}
+
 QTEST_MAIN(RGBText_Test)
@@ -0,0 +1,192 @@
+/*
+  Q Light Controller Plus - Unit test
+  rgbvideo_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QVideoFrame>
+#include <QtTest>
+#include <QImage>
+
+#define private public
+#include "rgbvideo_test.h"
+#include "rgbvideo.h"
+#undef private
+
+#include "doc.h"
+
+/** Build a frame with the $first color on the upper half and $second on
+ *  the lower one, or on the left and right halves if $vertical */
+static QImage splitImage(int width, int height, uint first, uint second, bool vertical)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            bool isFirst = vertical ? x < width / 2 : y < height / 2;
+            image.setPixel(x, y, 0xFF000000 | (isFirst ? first : second));
+        }
+    return image;
+}
+
+static void present(RGBVideo *video, const QImage& image, bool bottomToTop = false)
+{
+    QVideoFrame frame(image);
+    QVERIFY(frame.map(QAbstractVideoBuffer::ReadOnly));
+    video->presentFrame(frame, bottomToTop);
+    frame.unmap();
+}
+
+void RGBVideo_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void RGBVideo_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void RGBVideo_Test::initial()
+{
+    RGBVideo video(m_doc);
+    QCOMPARE(video.type(), RGBAlgorithm::Video);
+    QCOMPARE(video.name(), QString("Video"));
+    QCOMPARE(video.apiVersion(), 1);
+    QCOMPARE(video.acceptColors(), 0);
+    QCOMPARE(video.rgbMapStepCount(QSize(10, 10)), 1);
+    QCOMPARE(video.filename(), QString());
+
+    /* No frame yet: the map is black and nothing has been played */
+    RGBMap map;
+    video.rgbMap(QSize(3, 2), 0xFFFFFF, 0, map);
+    QCOMPARE(map.size(), QSize(3, 2));
+    for (int y = 0; y < 2; y++)
+        for (int x = 0; x < 3; x++)
+            QCOMPARE(map[y][x], uint(0));
+    QCOMPARE(video.m_playing.loadAcquire(), 0);
+    QVERIFY(video.m_player == NULL);
+}
+
+void RGBVideo_Test::saveLoad()
+{
+    RGBVideo video(m_doc);
+    video.setFilename("/tmp/movie.mp4");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+    QVERIFY(video.saveXML(&xmlWriter));
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+    QCOMPARE(xmlReader.name().toString(), QString(KXMLQLCRGBAlgorithm));
+    QCOMPARE(xmlReader.attributes().value(KXMLQLCRGBAlgorithmType).toString(), QString(KXMLQLCRGBVideo));
+
+    RGBAlgorithm *algo = RGBAlgorithm::loader(m_doc, xmlReader);
+    QVERIFY(algo != NULL);
+    QCOMPARE(algo->type(), RGBAlgorithm::Video);
+    QCOMPARE(static_cast<RGBVideo*>(algo)->filename(), QString("/tmp/movie.mp4"));
+
+    RGBAlgorithm *copy = algo->clone();
+    QCOMPARE(static_cast<RGBVideo*>(copy)->filename(), QString("/tmp/movie.mp4"));
+    delete copy;
+    delete algo;
+}
+
+void RGBVideo_Test::sampling()
+{
+    RGBVideo video(m_doc);
+    RGBMap map;
+
+    /* Frames are dropped until a grid size is known */
+    present(&video, splitImage(64, 32, 0xFF0000, 0x0000FF, true));
+    QVERIFY(video.m_latestFrame.loadAcquire() == NULL);
+
+    video.rgbMap(QSize(2, 1), 0, 0, map);
+    present(&video, splitImage(64, 32, 0xFF0000, 0x0000FF, true));
+    QVERIFY(video.m_latestFrame.loadAcquire() != NULL);
+
+    video.rgbMap(QSize(2, 1), 0, 0, map);
+    QVERIFY(video.m_latestFrame.loadAcquire() == NULL);
+    QCOMPARE(map[0][0], uint(0xFF0000));
+    QCOMPARE(map[0][1], uint(0x0000FF));
+
+    /* The last frame is kept until a new one arrives */
+    video.rgbMap(QSize(2, 1), 0, 0, map);
+    QCOMPARE(map[0][0], uint(0xFF0000));
+    QCOMPARE(map[0][1], uint(0x0000FF));
+
+    /* A frame of another size is not shown */
+    video.rgbMap(QSize(4, 1), 0, 0, map);
+    QCOMPARE(map[0][0], uint(0));
+
+    /* Cells are averaged: a 1x1 grid mixes both halves */
+    video.rgbMap(QSize(1, 1), 0, 0, map);
+    present(&video, splitImage(64, 32, 0xFF0000, 0x0000FF, true));
+    video.rgbMap(QSize(1, 1), 0, 0, map);
+    QCOMPARE(map[0][0], uint(0x7F007F));
+
+    video.postRun();
+    QVERIFY(video.m_currentFrame == NULL);
+}
+
+void RGBVideo_Test::bottomToTop()
+{
+    RGBVideo video(m_doc);
+    RGBMap map;
+
+    video.rgbMap(QSize(1, 2), 0, 0, map);
+    present(&video, splitImage(16, 16, 0x00FF00, 0x0000FF, false), true);
+    video.rgbMap(QSize(1, 2), 0, 0, map);
+    QCOMPARE(map[0][0], uint(0x0000FF));
+    QCOMPARE(map[1][0], uint(0x00FF00));
+}
+
+void RGBVideo_Test::latestFrame()
+{
+    RGBVideo video(m_doc);
+    RGBMap map;
+
+    video.rgbMap(QSize(1, 1), 0, 0, map);
+
+    /* Only the latest of the frames presented between two ticks is shown,
+       and the replaced one is kept for reuse */
+    present(&video, splitImage(8, 8, 0x111111, 0x111111, false));
+    RGBVideoFrame *first = video.m_latestFrame.loadAcquire();
+    present(&video, splitImage(8, 8, 0x222222, 0x222222, false));
+    QVERIFY(video.m_latestFrame.loadAcquire() != first);
+    QVERIFY(video.m_freeFrame.loadAcquire() == first);
+
+    video.rgbMap(QSize(1, 1), 0, 0, map);
+    QCOMPARE(map[0][0], uint(0x222222));
+
+    /* The next frame reuses the free one */
+    present(&video, splitImage(8, 8, 0x333333, 0x333333, false));
+    QVERIFY(video.m_latestFrame.loadAcquire() == first);
+    QVERIFY(video.m_freeFrame.loadAcquire() == NULL);
+
+    video.rgbMap(QSize(1, 1), 0, 0, map);
+    QCOMPARE(map[0][0], uint(0x333333));
+    QVERIFY(video.m_freeFrame.loadAcquire() != NULL);
+}
+
+QTEST_MAIN(RGBVideo_Test)
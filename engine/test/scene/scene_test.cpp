@@ -359,6 +359,118 @@ void Scene_Test::loadSuccess()
     QVERIFY(s.value(133, 4) == 59);
 }
 
+void Scene_Test::loadDeferredValues()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+
+    xmlWriter.writeStartElement("Function");
+    xmlWriter.writeAttribute("Type", "Scene");
+
+    xmlWriter.writeStartElement("FixtureVal");
+    xmlWriter.writeAttribute("ID", "5");
+    xmlWriter.writeCharacters("0,100,3,20");
+    xmlWriter.writeEndElement();
+
+    xmlWriter.writeStartElement("FixtureVal");
+    xmlWriter.writeAttribute("ID", "7");
+    xmlWriter.writeCharacters("1,255");
+    xmlWriter.writeEndElement();
+
+    xmlWriter.writeEndDocument();
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    Scene s(m_doc);
+    QVERIFY(s.loadXML(xmlReader) == true);
+    QCOMPARE(s.fixtures().count(), 2);
+
+    /* Values are kept raw until they are used */
+    QCOMPARE(s.m_deferredValues.count(), 2);
+    QCOMPARE(s.m_values.count(), 0);
+
+    QCOMPARE(s.values().count(), 3);
+    QCOMPARE(s.m_deferredValues.count(), 0);
+    QVERIFY(s.value(5, 0) == 100);
+    QVERIFY(s.value(5, 3) == 20);
+    QVERIFY(s.value(7, 1) == 255);
+
+    /* Expanding again does not change anything */
+    s.loadDeferred();
+    QCOMPARE(s.values().count(), 3);
+}
+
+void Scene_Test::loadUnsortedValues()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+
+    xmlWriter.writeStartElement("Function");
+    xmlWriter.writeAttribute("Type", "Scene");
+
+    xmlWriter.writeStartElement("FixtureVal");
+    xmlWriter.writeAttribute("ID", "7");
+    xmlWriter.writeCharacters("3,30,1,10");
+    xmlWriter.writeEndElement();
+
+    xmlWriter.writeStartElement("FixtureVal");
+    xmlWriter.writeAttribute("ID", "5");
+    xmlWriter.writeCharacters("2,20");
+    xmlWriter.writeEndElement();
+
+    /* A duplicated channel overrides the previous value */
+    xmlWriter.writeStartElement("FixtureVal");
+    xmlWriter.writeAttribute("ID", "7");
+    xmlWriter.writeCharacters("3,40");
+    xmlWriter.writeEndElement();
+
+    xmlWriter.writeEndDocument();
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    Scene s(m_doc);
+    QVERIFY(s.loadXML(xmlReader) == true);
+
+    /* Values are sorted by fixture and channel */
+    QList<SceneValue> values = s.values();
+    QCOMPARE(values.count(), 3);
+    QVERIFY(values.at(0) == SceneValue(5, 2));
+    QCOMPARE(values.at(0).value, uchar(20));
+    QVERIFY(values.at(1) == SceneValue(7, 1));
+    QCOMPARE(values.at(1).value, uchar(10));
+    QVERIFY(values.at(2) == SceneValue(7, 3));
+    QCOMPARE(values.at(2).value, uchar(40));
+
+    /* Inserting keeps the order */
+    s.setValue(6, 0, 60);
+    s.setValue(7, 2, 70);
+    values = s.values();
+    QCOMPARE(values.count(), 5);
+    for (int i = 1; i < values.count(); i++)
+        QVERIFY(values.at(i - 1) < values.at(i));
+    QVERIFY(s.value(6, 0) == 60);
+    QVERIFY(s.value(7, 2) == 70);
+    QVERIFY(s.checkValue(SceneValue(7, 2)) == true);
+    QVERIFY(s.checkValue(SceneValue(7, 4)) == false);
+
+    /* Fixture removal drops all of its values */
+    s.slotFixtureRemoved(7);
+    values = s.values();
+    QCOMPARE(values.count(), 2);
+    QVERIFY(values.at(0) == SceneValue(5, 2));
+    QVERIFY(values.at(1) == SceneValue(6, 0));
+}
+
 void Scene_Test::loadWrongType()
 {
     QBuffer buffer;
@@ -989,4 +1101,149 @@ void Scene_Test::writeLTPReady()
     QVERIFY(s1->isRunning() == true);
 }
 
+void Scene_Test::channelPlan()
+{
+    Doc* doc = new Doc(this);
+    MasterTimer timer(doc);
+    QList<Universe*> ua;
+
+    Fixture* fxi = new Fixture(doc);
+    fxi->setAddress(0);
+    fxi->setUniverse(0);
+    fxi->setChannels(10);
+    doc->addFixture(fxi);
+
+    Scene* s1 = new Scene(doc);
+    s1->setFadeInSpeed(0);
+    s1->setFadeOutSpeed(0);
+    s1->setValue(fxi->id(), 0, 255);
+    s1->setValue(fxi->id(), 1, 127);
+    s1->setValue(12345, 2, 50); // Unknown fixture
+    doc->addFunction(s1);
+    QVERIFY(s1->m_channelPlanChanged == true);
+    QVERIFY(s1->m_channelPlan.isEmpty());
+
+    /* The plan is built when the Scene starts, skipping unknown fixtures */
+    s1->start(&timer, FunctionParent::master());
+    timer.timerTick();
+    QVERIFY(s1->m_channelPlanChanged == false);
+    QCOMPARE(s1->m_channelPlanRevision, doc->fixturesRevision());
+    QCOMPARE(s1->m_channelPlan.count(), 2);
+    QCOMPARE(s1->m_channelPlan.at(0).m_universe, quint32(0));
+    QCOMPARE(s1->m_channelPlan.at(0).m_channel.address(), quint32(0));
+    QCOMPARE(s1->m_channelPlan.at(1).m_channel.address(), quint32(1));
+    QCOMPARE(s1->m_channelPlan.at(1).m_value.value, uchar(127));
+    ua = doc->inputOutputMap()->claimUniverses();
+    ua[0]->processFaders();
+    QVERIFY(ua[0]->preGMValues()[0] == (char) 255);
+    QVERIFY(ua[0]->preGMValues()[1] == (char) 127);
+    doc->inputOutputMap()->releaseUniverses(false);
+
+    s1->stop(FunctionParent::master());
+    timer.timerTick();
+    QVERIFY(s1->isRunning() == false);
+
+    /* Changing a value updates the plan in place */
+    s1->setValue(fxi->id(), 1, 100);
+    QVERIFY(s1->m_channelPlanChanged == false);
+    QCOMPARE(s1->m_channelPlan.at(1).m_value.value, uchar(100));
+
+    /* Adding a channel outdates the plan */
+    s1->setValue(fxi->id(), 3, 10);
+    QVERIFY(s1->m_channelPlanChanged == true);
+    s1->unsetValue(fxi->id(), 3);
+
+    s1->start(&timer, FunctionParent::master());
+    timer.timerTick();
+    QVERIFY(s1->m_channelPlanChanged == false);
+    QCOMPARE(s1->m_channelPlan.at(1).m_value.value, uchar(100));
+    s1->stop(FunctionParent::master());
+    timer.timerTick();
+
+    /* Moving the fixture outdates the plan as well */
+    int revision = doc->fixturesRevision();
+    fxi->setAddress(5);
+    QVERIFY(doc->fixturesRevision() != revision);
+
+    s1->start(&timer, FunctionParent::master());
+    timer.timerTick();
+    QCOMPARE(s1->m_channelPlanRevision, doc->fixturesRevision());
+    QCOMPARE(s1->m_channelPlan.at(0).m_channel.address(), quint32(5));
+    QCOMPARE(s1->m_channelPlan.at(1).m_channel.address(), quint32(6));
+    ua = doc->inputOutputMap()->claimUniverses();
+    ua[0]->processFaders();
+    QVERIFY(ua[0]->preGMValues()[5] == (char) 255);
+    QVERIFY(ua[0]->preGMValues()[6] == (char) 100);
+    doc->inputOutputMap()->releaseUniverses(false);
+    s1->stop(FunctionParent::master());
+    timer.timerTick();
+
+    /* Removing the fixture empties the plan */
+    doc->deleteFixture(fxi->id());
+    QVERIFY(s1->m_channelPlanChanged == true);
+}
+
+void Scene_Test::liveEdits()
+{
+    Doc* doc = new Doc(this);
+    MasterTimer timer(doc);
+    QList<Universe*> ua;
+
+    Fixture* fxi = new Fixture(doc);
+    fxi->setAddress(0);
+    fxi->setUniverse(0);
+    fxi->setChannels(10);
+    doc->addFixture(fxi);
+
+    Fixture* fxi2 = new Fixture(doc);
+    fxi2->setAddress(0);
+    fxi2->setUniverse(1);
+    fxi2->setChannels(10);
+    doc->addFixture(fxi2);
+
+    Scene* s1 = new Scene(doc);
+    s1->setFadeInSpeed(0);
+    s1->setFadeOutSpeed(0);
+    s1->setValue(fxi->id(), 0, 255);
+    s1->setValue(fxi->id(), 1, 127);
+    doc->addFunction(s1);
+
+    /* Edits of a stopped Scene are not queued */
+    s1->setValue(fxi->id(), 1, 120);
+    QVERIFY(s1->m_liveEdits.isEmpty());
+
+    s1->start(&timer, FunctionParent::master());
+    timer.timerTick();
+    QVERIFY(s1->m_liveEdits.isEmpty());
+
+    /* Edits of a running Scene are queued and applied by the next write */
+    s1->setValue(fxi->id(), 1, 50);
+    s1->setValue(fxi->id(), 2, 60);
+    s1->setValue(fxi2->id(), 3, 70);
+    s1->unsetValue(fxi->id(), 0);
+    QCOMPARE(s1->m_liveEdits.count(), 4);
+    QVERIFY(s1->m_liveEdits.at(3).m_unset == true);
+
+    timer.timerTick();
+    QVERIFY(s1->m_liveEdits.isEmpty());
+    QCOMPARE(s1->m_fadersMap.count(), 2);
+    ua = doc->inputOutputMap()->claimUniverses();
+    ua[0]->processFaders();
+    ua[1]->processFaders();
+    QVERIFY(ua[0]->preGMValues()[0] == (char) 0);
+    QVERIFY(ua[0]->preGMValues()[1] == (char) 50);
+    QVERIFY(ua[0]->preGMValues()[2] == (char) 60);
+    QVERIFY(ua[1]->preGMValues()[3] == (char) 70);
+    doc->inputOutputMap()->releaseUniverses(false);
+
+    /* Blind edits don't reach the faders */
+    s1->setValue(SceneValue(fxi->id(), 1, 80), true);
+    QVERIFY(s1->m_liveEdits.isEmpty());
+
+    s1->stop(FunctionParent::master());
+    timer.timerTick();
+    QVERIFY(s1->isRunning() == false);
+    QVERIFY(s1->m_liveEdits.isEmpty());
+}
+
 QTEST_APPLESS_MAIN(Scene_Test)
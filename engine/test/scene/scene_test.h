@@ -39,6 +39,8 @@ private slots:
     void channelGroup();
     void fixtureRemoval();
     void loadSuccess();
+    void loadDeferredValues();
+    void loadUnsortedValues();
     void loadWrongType();
     void loadWrongRoot();
     void save();
@@ -54,6 +56,9 @@ private slots:
     void writeHTPTwoTicksIntensity();
     void writeLTPReady();
 
+    void channelPlan();
+    void liveEdits();
+
 private:
     Doc* m_doc;
 };
@@ -20,15 +20,19 @@
 #include <QtTest>
 
 #define private public
+#define protected public
 
 #include "qlcfixturedefcache.h"
+#include "genericfader.h"
 #include "mastertimer.h"
 #include "script_test.h"
 #include "universe.h"
+#include "fixture.h"
 #include "script.h"
 #include "doc.h"
 
 #undef private
+#undef protected
 
 static QString script0(
 "// Comment over there\n"
@@ -68,4 +72,59 @@ void Script_Test::initial()
     }
 }
 
+void Script_Test::compiledSetFixture()
+{
+    Doc doc(this);
+    GrandMaster *gm = new GrandMaster();
+    QList<Universe*> ua;
+    ua.append(new Universe(0, gm));
+
+    Fixture *fxi = new Fixture(&doc);
+    fxi->setAddress(10);
+    fxi->setUniverse(0);
+    fxi->setChannels(4);
+    doc.addFixture(fxi);
+
+    Script scr(&doc);
+    scr.setData(QString("setfixture:%1 ch:1 val:200 time:0\n"
+                        "setfixture:%1 ch:2 val:random(10,20)\n"
+                        "setfixture:%1 ch:9 val:100\n"
+                        "wait:1\n"
+                        "setfixture:%1 ch:3 val:50\n").arg(fxi->id()));
+
+    scr.compileLines();
+    QCOMPARE(scr.m_compiledLines.size(), 5);
+
+    QVERIFY(scr.m_compiledLines.at(0).m_valid == true);
+    QCOMPARE(scr.m_compiledLines.at(0).m_universe, quint32(0));
+    QCOMPARE(scr.m_compiledLines.at(0).m_channel.address(), quint32(11));
+    QCOMPARE(scr.m_compiledLines.at(0).m_value, uchar(200));
+
+    // random values and invalid channels are not compiled
+    QVERIFY(scr.m_compiledLines.at(1).m_valid == false);
+    QVERIFY(scr.m_compiledLines.at(2).m_valid == false);
+    QVERIFY(scr.m_compiledLines.at(3).m_valid == false);
+    QVERIFY(scr.m_compiledLines.at(4).m_valid == true);
+
+    scr.executeCommand(0, doc.masterTimer(), ua);
+    scr.executeCommand(1, doc.masterTimer(), ua);
+    scr.executeCommand(4, doc.masterTimer(), ua);
+
+    // all the commands share the same fader
+    QCOMPARE(scr.m_fadersMap.count(), 1);
+    GenericFader *fader = scr.m_fadersMap[0].data();
+    QCOMPARE(fader->channels().count(), 3);
+    QCOMPARE(fader->channels()[GenericFader::channelHash(fxi->id(), 1)].target(), uchar(200));
+    QCOMPARE(fader->channels()[GenericFader::channelHash(fxi->id(), 3)].target(), uchar(50));
+
+    uchar random = fader->channels()[GenericFader::channelHash(fxi->id(), 2)].target();
+    QVERIFY(random >= 10 && random <= 20);
+
+    // changing the data drops the compiled commands
+    scr.setData(QString("wait:1\n"));
+    QVERIFY(scr.m_compiledLines.isEmpty());
+
+    scr.dismissAllFaders();
+}
+
 QTEST_APPLESS_MAIN(Script_Test)
@@ -29,6 +29,7 @@ class Script_Test : public QObject
 private slots:
     void initTestCase();
     void initial();
+    void compiledSetFixture();
 };
 
 #endif
@@ -0,0 +1,127 @@
+/*
+  Q Light Controller Plus - Unit test
+  searchindex_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "searchindex_test.h"
+#include "searchindex.h"
+#undef private
+
+void SearchIndex_Test::initial()
+{
+    SearchIndex index;
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.match("abc").isEmpty());
+    QVERIFY(index.match("").isEmpty());
+}
+
+void SearchIndex_Test::match()
+{
+    SearchIndex index;
+    index.setText(1, "Red Wash");
+    index.setText(2, "Blue Wash");
+    index.setText(3, "Strobe");
+
+    QCOMPARE(index.count(), 3);
+
+    QSet<quint32> result = index.match("wash");
+    QCOMPARE(result.count(), 2);
+    QVERIFY(result.contains(1));
+    QVERIFY(result.contains(2));
+
+    result = index.match("E WA");
+    QCOMPARE(result.count(), 1);
+    QVERIFY(result.contains(2));
+
+    /* All the trigrams are there, but not in this order */
+    QVERIFY(index.match("washred").isEmpty());
+    QVERIFY(index.match("green").isEmpty());
+
+    QCOMPARE(index.match("").count(), 3);
+}
+
+void SearchIndex_Test::shortText()
+{
+    SearchIndex index;
+    index.setText(1, "EFX 1");
+    index.setText(2, "Scene 2");
+    index.setText(3, "ab");
+
+    QSet<quint32> result = index.match("e");
+    QCOMPARE(result.count(), 2);
+    QVERIFY(result.contains(1));
+    QVERIFY(result.contains(2));
+
+    result = index.match("AB");
+    QCOMPARE(result.count(), 1);
+    QVERIFY(result.contains(3));
+}
+
+void SearchIndex_Test::setText()
+{
+    SearchIndex index;
+    index.setText(1, "Red Wash");
+    QCOMPARE(index.match("red").count(), 1);
+
+    index.setText(1, "Green Wash");
+    QCOMPARE(index.count(), 1);
+    QVERIFY(index.match("red").isEmpty());
+    QCOMPARE(index.match("green").count(), 1);
+    QCOMPARE(index.match("wash").count(), 1);
+
+    /* Trigrams of the old text are not left behind */
+    QVERIFY(index.m_trigrams.contains("red") == false);
+}
+
+void SearchIndex_Test::remove()
+{
+    SearchIndex index;
+    index.setText(1, "Red Wash");
+    index.setText(2, "Blue Wash");
+
+    index.remove(1);
+    QCOMPARE(index.count(), 1);
+    QSet<quint32> result = index.match("wash");
+    QCOMPARE(result.count(), 1);
+    QVERIFY(result.contains(2));
+    QVERIFY(index.m_trigrams.contains("red") == false);
+
+    /* Removing an unknown ID does nothing */
+    index.remove(42);
+    QCOMPARE(index.count(), 1);
+
+    index.remove(2);
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.m_trigrams.isEmpty());
+}
+
+void SearchIndex_Test::clear()
+{
+    SearchIndex index;
+    index.setText(1, "Red Wash");
+    index.setText(2, "Blue Wash");
+
+    index.clear();
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.match("wash").isEmpty());
+    QVERIFY(index.m_trigrams.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(SearchIndex_Test)
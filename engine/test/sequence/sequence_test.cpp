@@ -528,6 +528,78 @@ void Sequence_Test::loadWithoutScene()
     QVERIFY(cs->values.at(11).value == 90);
 }
 
+void Sequence_Test::loadSharedValues()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+
+    xmlWriter.writeStartElement("Function");
+    xmlWriter.writeAttribute("ID", "1");
+    xmlWriter.writeAttribute("Type", "Sequence");
+    xmlWriter.writeAttribute("Name", "Test Sequence");
+    xmlWriter.writeAttribute("BoundScene", "0");
+
+    QStringList stepValues;
+    stepValues << "" << "0:1,255,2,128" << "0:1,255,2,128" << "0:2,64";
+
+    for (int i = 0; i < stepValues.count(); i++)
+    {
+        xmlWriter.writeStartElement("Step");
+        xmlWriter.writeAttribute("Number", QString::number(i));
+        xmlWriter.writeAttribute("Hold", "1000");
+        xmlWriter.writeAttribute("Values", "3");
+        xmlWriter.writeCharacters(stepValues.at(i));
+        xmlWriter.writeEndElement();
+    }
+
+    xmlWriter.writeEndDocument();
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setAddress(0);
+    fxi->setUniverse(0);
+    fxi->setChannels(3);
+    m_doc->addFixture(fxi);
+
+    Scene *s = new Scene(m_doc);
+    s->addFixture(0);
+    s->setValue(0, 0, 0);
+    s->setValue(0, 1, 0);
+    s->setValue(0, 2, 0);
+    QVERIFY(m_doc->addFunction(s) == true);
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    Sequence *seq = new Sequence(m_doc);
+    QVERIFY(seq->loadXML(xmlReader) == true);
+    QCOMPARE(seq->stepsCount(), 4);
+
+    ChaserStep *cs = seq->stepAt(0);
+    QCOMPARE(cs->values.count(), 3);
+    QCOMPARE(cs->values.at(1).value, uchar(0));
+
+    cs = seq->stepAt(1);
+    QCOMPARE(cs->values.count(), 3);
+    QCOMPARE(cs->values.at(0).value, uchar(0));
+    QCOMPARE(cs->values.at(1).value, uchar(255));
+    QCOMPARE(cs->values.at(2).value, uchar(128));
+
+    /* identical steps share the same values */
+    QVERIFY(&seq->stepAt(1)->values.at(0) == &seq->stepAt(2)->values.at(0));
+    QVERIFY(&seq->stepAt(1)->values.at(0) != &seq->stepAt(0)->values.at(0));
+
+    cs = seq->stepAt(3);
+    QCOMPARE(cs->values.count(), 3);
+    QCOMPARE(cs->values.at(1).value, uchar(0));
+    QCOMPARE(cs->values.at(2).value, uchar(64));
+
+    delete seq;
+}
+
 void Sequence_Test::save()
 {
     Sequence* seq = new Sequence(m_doc);
@@ -40,6 +40,7 @@ private slots:
     void loadWrongType();
     void loadWithScene();
     void loadWithoutScene();
+    void loadSharedValues();
     void save();
 
 private:
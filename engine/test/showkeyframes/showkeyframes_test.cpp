@@ -0,0 +1,176 @@
+/*
+  Q Light Controller Plus - Unit test
+  showkeyframes_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "showkeyframes_test.h"
+
+#define private public
+#include "showkeyframes.h"
+#undef private
+
+#include "grandmaster.h"
+#include "universe.h"
+
+void ShowKeyframes_Test::init()
+{
+    m_gm = new GrandMaster(this);
+    m_universes.append(new Universe(0, m_gm, this));
+    m_universes.append(new Universe(1, m_gm, this));
+}
+
+void ShowKeyframes_Test::cleanup()
+{
+    qDeleteAll(m_universes);
+    m_universes.clear();
+    delete m_gm;
+    m_gm = NULL;
+}
+
+void ShowKeyframes_Test::initial()
+{
+    ShowKeyframes kf;
+    QCOMPARE(kf.interval(), quint32(SHOW_KEYFRAME_INTERVAL));
+    QCOMPARE(kf.count(), 0);
+    QVERIFY(kf.values(0).isEmpty());
+    QVERIFY(kf.values(10000).isEmpty());
+
+    ShowKeyframes kf2(0);
+    QCOMPARE(kf2.interval(), quint32(SHOW_KEYFRAME_INTERVAL));
+}
+
+void ShowKeyframes_Test::record()
+{
+    ShowKeyframes kf(1000);
+    kf.startRun(0);
+
+    QVERIFY(kf.record(0, m_universes) == true);
+    QCOMPARE(kf.count(), 1);
+
+    // same interval, already recorded
+    QVERIFY(kf.record(50, m_universes) == false);
+    QVERIFY(kf.record(999, m_universes) == false);
+    QCOMPARE(kf.count(), 1);
+
+    m_universes[0]->write(10, 100);
+    QVERIFY(kf.record(1000, m_universes) == true);
+    QCOMPARE(kf.count(), 2);
+
+    m_universes[1]->write(511, 200);
+    QVERIFY(kf.record(2050, m_universes) == true);
+    QCOMPARE(kf.count(), 3);
+
+    kf.clear();
+    QCOMPARE(kf.count(), 0);
+    QVERIFY(kf.values(2000).isEmpty());
+}
+
+void ShowKeyframes_Test::restore()
+{
+    ShowKeyframes kf(1000);
+    kf.startRun(0);
+    kf.record(0, m_universes);
+
+    m_universes[0]->write(10, 100);
+    kf.record(1000, m_universes);
+
+    m_universes[0]->write(10, 0, true);
+    m_universes[1]->write(20, 50);
+    kf.record(2000, m_universes);
+
+    QHash<quint32, QByteArray> values = kf.values(1500);
+    QCOMPARE(uchar(values[0].at(10)), uchar(100));
+    QCOMPARE(uchar(values.value(1).value(20)), uchar(0));
+
+    // beyond the last keyframe, the last one is used
+    values = kf.values(60000);
+    QCOMPARE(uchar(values[0].at(10)), uchar(0));
+    QCOMPARE(uchar(values[1].at(20)), uchar(50));
+
+    // rebuilt from the whole chain, without the cached last frame
+    kf.m_lastIndex = -1;
+    values = kf.values(2000);
+    QCOMPARE(uchar(values[0].at(10)), uchar(0));
+    QCOMPARE(uchar(values[1].at(20)), uchar(50));
+}
+
+void ShowKeyframes_Test::gap()
+{
+    ShowKeyframes kf(1000);
+
+    // a run started late can't extend an empty chain
+    kf.startRun(3500);
+    QVERIFY(kf.record(3550, m_universes) == false);
+    QVERIFY(kf.record(4000, m_universes) == false);
+    QCOMPARE(kf.count(), 0);
+
+    kf.startRun(0);
+    QVERIFY(kf.record(0, m_universes) == true);
+    // a time jump skipping an interval breaks the chain
+    QVERIFY(kf.record(2000, m_universes) == false);
+    QCOMPARE(kf.count(), 1);
+}
+
+void ShowKeyframes_Test::overwrite()
+{
+    ShowKeyframes kf(1000);
+    kf.startRun(0);
+    for (quint32 t = 0; t < 5000; t += 1000)
+        kf.record(t, m_universes);
+    QCOMPARE(kf.count(), 5);
+
+    // a run started at 1500 records again from the third keyframe
+    kf.startRun(1500);
+    QVERIFY(kf.record(1550, m_universes) == false);
+    m_universes[0]->write(0, 255);
+    QVERIFY(kf.record(2000, m_universes) == true);
+    QCOMPARE(kf.count(), 3);
+
+    QCOMPARE(uchar(kf.values(2000)[0].at(0)), uchar(255));
+    QCOMPARE(uchar(kf.values(1000).value(0).value(0)), uchar(0));
+}
+
+void ShowKeyframes_Test::delta()
+{
+    QByteArray from(512, 0);
+    QByteArray to(from);
+
+    QVERIFY(ShowKeyframes::encodeDelta(from, to).isEmpty());
+
+    to[0] = 1;
+    to[2] = 2;
+    to[100] = 3;
+    to[511] = 4;
+
+    // two close changes are merged into a single range
+    QByteArray delta = ShowKeyframes::encodeDelta(from, to);
+    QCOMPARE(delta.size(), 3 * 4 + 3 + 1 + 1);
+
+    QByteArray values(from);
+    ShowKeyframes::applyDelta(values, delta);
+    QVERIFY(values == to);
+
+    // missing values are zero
+    values.clear();
+    ShowKeyframes::applyDelta(values, ShowKeyframes::encodeDelta(QByteArray(), to));
+    QCOMPARE(values.size(), 512);
+    QVERIFY(values == to);
+}
+
+QTEST_APPLESS_MAIN(ShowKeyframes_Test)
@@ -1,4 +1,6 @@
 TEMPLATE = subdirs
+SUBDIRS += beattracker
+SUBDIRS += bench
 SUBDIRS += bus
 SUBDIRS += chaser
 SUBDIRS += chaserrunner
@@ -6,9 +8,11 @@ SUBDIRS += chaserstep
 SUBDIRS += collection
 SUBDIRS += cue
 SUBDIRS += cuestack
+SUBDIRS += dmxrecordingfile
 SUBDIRS += doc
 SUBDIRS += efx
 SUBDIRS += efxfixture
+SUBDIRS += enginelog
 SUBDIRS += fadechannel
 SUBDIRS += fixture
 SUBDIRS += fixturegroup
@@ -17,16 +21,21 @@ SUBDIRS += genericfader
 SUBDIRS += grandmaster
 SUBDIRS += inputoutputmap
 SUBDIRS += inputpatch
+SUBDIRS += latencytracer
+SUBDIRS += loadgovernor
 SUBDIRS += mastertimer
+SUBDIRS += offlinerenderer
 SUBDIRS += outputpatch
 SUBDIRS += qlccapability
 SUBDIRS += qlcchannel
+SUBDIRS += qlcclipboard
 SUBDIRS += qlcfile
 SUBDIRS += qlcfixturedef
 SUBDIRS += qlcfixturedefcache
 SUBDIRS += qlcfixturehead
 SUBDIRS += qlcfixturemode
 SUBDIRS += qlci18n
+SUBDIRS += qlcimagecache
 SUBDIRS += qlcinputchannel
 SUBDIRS += qlcinputprofile
 SUBDIRS += qlcmacros
@@ -37,11 +46,19 @@ SUBDIRS += rgbalgorithm
 SUBDIRS += rgbmatrix
 SUBDIRS += rgbscript
 SUBDIRS += rgbtext
+greaterThan(QT_MAJOR_VERSION, 4): SUBDIRS += rgbvideo
 SUBDIRS += scene
 SUBDIRS += scenevalue
 !qmlui: SUBDIRS += script
+SUBDIRS += searchindex
 SUBDIRS += sequence
+SUBDIRS += showkeyframes
+SUBDIRS += ticktrace
+SUBDIRS += timecodetracker
 SUBDIRS += universe
+SUBDIRS += universepool
+SUBDIRS += workspacecache
+SUBDIRS += workspacegen
 
 # Stubs
 SUBDIRS += iopluginstub
@@ -0,0 +1,129 @@
+/*
+  Q Light Controller Plus - Unit test
+  ticktrace_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QThread>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#endif
+
+#include "ticktrace_test.h"
+#include "ticktrace.h"
+
+class TracedThread : public QThread
+{
+public:
+    void run()
+    {
+        TICK_TRACE_ARG("TracedThread::run", 7);
+    }
+};
+
+void TickTrace_Test::cleanup()
+{
+    TickTrace::setEnabled(false);
+}
+
+void TickTrace_Test::disabled()
+{
+    /* Start and stop once, to have an empty buffer for this thread */
+    TickTrace::setEnabled(true);
+    TickTrace::setEnabled(false);
+    QVERIFY(TickTrace::isEnabled() == false);
+
+    {
+        TICK_TRACE("TickTrace_Test::disabled");
+    }
+
+    QVERIFY(TickTrace::toJSON().contains("TickTrace_Test::disabled") == false);
+}
+
+void TickTrace_Test::scope()
+{
+    TickTrace::setEnabled(true);
+    QVERIFY(TickTrace::isEnabled() == true);
+
+    {
+        TICK_TRACE_ARG("TickTrace_Test::scope", 42);
+        QTest::qSleep(2);
+    }
+
+    QByteArray json = TickTrace::toJSON();
+    QVERIFY(json.contains("\"name\":\"TickTrace_Test::scope\""));
+    QVERIFY(json.contains("\"args\":{\"id\":42}"));
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    bool found = false;
+    foreach (QJsonValue value, doc.object().value("traceEvents").toArray())
+    {
+        QJsonObject event = value.toObject();
+        if (event.value("name").toString() != "TickTrace_Test::scope")
+            continue;
+
+        found = true;
+        QCOMPARE(event.value("ph").toString(), QString("X"));
+        // at least the 2ms of sleep, in microseconds
+        QVERIFY(event.value("dur").toDouble() >= 2000.0);
+    }
+    QVERIFY(found == true);
+#endif
+
+    /* Enabling again starts a new trace */
+    TickTrace::setEnabled(false);
+    TickTrace::setEnabled(true);
+    QVERIFY(TickTrace::toJSON().contains("TickTrace_Test::scope") == false);
+}
+
+void TickTrace_Test::threads()
+{
+    TickTrace::setEnabled(true);
+
+    TracedThread thread;
+    thread.setObjectName("Traced");
+    thread.start();
+    QVERIFY(thread.wait(5000));
+
+    /* The events outlive the thread */
+    QByteArray json = TickTrace::toJSON();
+    QVERIFY(json.contains("\"name\":\"TracedThread::run\""));
+    QVERIFY(json.contains("\"args\":{\"name\":\"Traced\"}"));
+}
+
+void TickTrace_Test::ringBuffer()
+{
+    TickTrace::setEnabled(true);
+
+    TickTrace::record("TickTrace_Test::oldest", 0, 0, 1);
+    for (int i = 0; i < TICKTRACE_BUFFER_SIZE; i++)
+        TickTrace::record("TickTrace_Test::newer", 0, 0, 1);
+
+    /* The oldest event has been overwritten */
+    QByteArray json = TickTrace::toJSON();
+    QVERIFY(json.contains("TickTrace_Test::oldest") == false);
+    QCOMPARE(json.count("TickTrace_Test::newer"), TICKTRACE_BUFFER_SIZE);
+}
+
+QTEST_APPLESS_MAIN(TickTrace_Test)
@@ -0,0 +1,122 @@
+/*
+  Q Light Controller Plus - Unit test
+  timecodetracker_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "timecodetracker_test.h"
+#include "timecodetracker.h"
+#undef private
+
+static const int jitterPattern[] = { 0, 8, -5, 3, -10, 6, -2, 10, -8, 0 };
+
+void TimecodeTracker_Test::initial()
+{
+    TimecodeTracker tracker;
+    QCOMPARE(tracker.state(0), TimecodeTracker::Stopped);
+    QCOMPARE(tracker.position(0), qint64(-1));
+    QCOMPARE(tracker.relocations(), quint32(0));
+
+    // the first frame locks the timecode
+    QVERIFY(tracker.addTimecode(60000, 1000) == false);
+    QCOMPARE(tracker.relocations(), quint32(1));
+    QCOMPARE(tracker.state(1000), TimecodeTracker::Locked);
+    QCOMPARE(tracker.position(1000), qint64(60000));
+
+    // the position runs between the frames
+    QCOMPARE(tracker.position(1020), qint64(60020));
+}
+
+void TimecodeTracker_Test::jitter()
+{
+    TimecodeTracker tracker;
+
+    // 25 fps frames received with some jitter
+    for (int i = 0; i < 100; i++)
+        QVERIFY(tracker.addTimecode(40 * i, 5000 + 40 * i + jitterPattern[i % 10]) == (i > 0));
+
+    QCOMPARE(tracker.relocations(), quint32(1));
+
+    // the position stays closer to the timecode than the jitter
+    qint64 time = 5000 + 40 * 99 + jitterPattern[9];
+    QVERIFY(qAbs(tracker.position(time) - 40 * 99) <= 5);
+    QVERIFY(qAbs(tracker.position(time + 20) - (40 * 99 + 20)) <= 5);
+}
+
+void TimecodeTracker_Test::relocate()
+{
+    TimecodeTracker tracker;
+    for (int i = 0; i < 10; i++)
+        tracker.addTimecode(10000 + 40 * i, 40 * i);
+
+    // a jump of the timecode is followed right away
+    QVERIFY(tracker.addTimecode(90000, 400) == false);
+    QCOMPARE(tracker.relocations(), quint32(2));
+    QCOMPARE(tracker.position(400), qint64(90000));
+
+    // and so is going back in time
+    QVERIFY(tracker.addTimecode(1000, 440) == false);
+    QCOMPARE(tracker.relocations(), quint32(3));
+    QCOMPARE(tracker.position(440), qint64(1000));
+
+    tracker.reset();
+    QCOMPARE(tracker.state(440), TimecodeTracker::Stopped);
+    QCOMPARE(tracker.position(440), qint64(-1));
+}
+
+void TimecodeTracker_Test::dropout()
+{
+    TimecodeTracker tracker;
+    for (int i = 0; i < 10; i++)
+        tracker.addTimecode(40 * i, 40 * i);
+
+    // a short dropout runs on the local clock
+    QCOMPARE(tracker.state(360 + 100), TimecodeTracker::Locked);
+    QCOMPARE(tracker.state(360 + 500), TimecodeTracker::Freewheeling);
+    QCOMPARE(tracker.position(360 + 500), qint64(860));
+
+    // and the frames after it are followed without relocation
+    QVERIFY(tracker.addTimecode(900, 900) == true);
+    QCOMPARE(tracker.relocations(), quint32(1));
+
+    // a long one stops the timecode
+    QCOMPARE(tracker.state(900 + 3000), TimecodeTracker::Stopped);
+    QCOMPARE(tracker.position(900 + 3000), qint64(-1));
+
+    // and the next frame locks it again
+    QVERIFY(tracker.addTimecode(5000, 4000) == false);
+    QCOMPARE(tracker.relocations(), quint32(2));
+    QCOMPARE(tracker.state(4000), TimecodeTracker::Locked);
+}
+
+void TimecodeTracker_Test::conversion()
+{
+    QCOMPARE(TimecodeTracker::timecodeToMsecs(0, 0, 0, 0, 25, false), qint64(0));
+    QCOMPARE(TimecodeTracker::timecodeToMsecs(1, 2, 3, 10, 25, false), qint64(3723400));
+    QCOMPARE(TimecodeTracker::timecodeToMsecs(0, 0, 1, 12, 24, false), qint64(1500));
+    QCOMPARE(TimecodeTracker::timecodeToMsecs(0, 0, 0, 15, 30, false), qint64(500));
+    QCOMPARE(TimecodeTracker::timecodeToMsecs(0, 0, 0, 5, 0, false), qint64(0));
+
+    // 00:01:00;02 is the first frame of the second minute, the frame 1800
+    QCOMPARE(TimecodeTracker::timecodeToMsecs(0, 1, 0, 2, 30, true), qint64(1800 * 1001 / 30));
+    // 00:10:00;00 is not dropped, the frame 17982
+    QCOMPARE(TimecodeTracker::timecodeToMsecs(0, 10, 0, 0, 30, true), qint64(17982 * 1001 / 30));
+}
+
+QTEST_APPLESS_MAIN(TimecodeTracker_Test)
@@ -26,6 +26,8 @@
 #include "universe.h"
 #undef protected
 
+#include "channelmodifier.h"
+#include "genericfader.h"
 #include "grandmaster.h"
 
 void Universe_Test::init()
@@ -83,6 +85,10 @@ void Universe_Test::channelCapabilities()
     QVERIFY(m_uni->channelCapabilities(3) == Universe::HTP);
     QVERIFY(m_uni->channelCapabilities(4) == (Universe::Intensity|Universe::HTP));
     QCOMPARE(m_uni->totalChannels(), ushort(5));
+
+    QVector<int> intensity;
+    intensity << 0 << 1 << 3 << 4;
+    QCOMPARE(m_uni->intensityChannels(), intensity);
 }
 
 void Universe_Test::blendModes()
@@ -335,13 +341,37 @@ void Universe_Test::write()
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(127));
 }
 
+void Universe_Test::writeMultiple()
+{
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(4, QLCChannel::Pan);
+    m_uni->setChannelCapability(9, QLCChannel::Intensity);
+
+    m_uni->write(0, 100);
+    m_uni->write(4, 100);
+    m_uni->write(9, 100);
+
+    int channels[] = { 9, 0, 4, UNIVERSE_SIZE };
+    uchar values[] = { 50, 200, 50, 255 };
+
+    // the HTP channel 9 keeps its higher value
+    QCOMPARE(m_uni->writeMultiple(channels, values, 4), 2);
+    QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(200));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(50));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(100));
+    QCOMPARE(m_uni->usedChannels(), ushort(10));
+
+    QCOMPARE(m_uni->writeMultiple(channels, values, 3, true), 3);
+    QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(50));
+
+    QCOMPARE(m_uni->writeMultiple(NULL, values, 3), 0);
+}
+
 void Universe_Test::writeRelative()
 {
-    // 127 == 0
+    // 127 == 0, no relative offsets allocated yet
     QVERIFY(m_uni->writeRelative(9, 127) == true);
-    QCOMPARE(m_uni->m_relativeValues[9], short(0));
-    QCOMPARE(m_uni->m_relativeValues[4], short(0));
-    QCOMPARE(m_uni->m_relativeValues[0], short(0));
+    QVERIFY(m_uni->m_relativeValues.isEmpty());
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(0));
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(0));
@@ -392,6 +422,403 @@ void Universe_Test::writeRelative()
     QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(0));
 }
 
+void Universe_Test::channelModifiers()
+{
+    ChannelModifier modifier;
+    QList< QPair<uchar, uchar> > map;
+    map << QPair<uchar, uchar>(0, 255) << QPair<uchar, uchar>(255, 0);
+    modifier.setModifierMap(map);
+
+    // no table is allocated until a modifier is set
+    QVERIFY(m_uni->m_modifiers.isEmpty());
+    QVERIFY(m_uni->channelModifier(2) == NULL);
+    m_uni->setChannelModifier(2, NULL);
+    QVERIFY(m_uni->m_modifiers.isEmpty());
+
+    m_uni->setChannelModifier(2, &modifier);
+    QCOMPARE(m_uni->m_modifiers.count(), UNIVERSE_SIZE);
+    QVERIFY(m_uni->channelModifier(2) == &modifier);
+    QVERIFY(m_uni->channelModifier(3) == NULL);
+    QCOMPARE(quint8(m_uni->postGMValues()->at(2)), quint8(255));
+
+    QVERIFY(m_uni->write(2, 255) == true);
+    QCOMPARE(quint8(m_uni->postGMValues()->at(2)), quint8(0));
+
+    m_uni->reset();
+    QVERIFY(m_uni->m_modifiers.isEmpty());
+    QVERIFY(m_uni->channelModifier(2) == NULL);
+}
+
+void Universe_Test::writeBlendedRange()
+{
+    Universe ref(1, m_gm, this);
+    QByteArray values(40, 0);
+    int i;
+
+    // mix HTP and LTP channels and values above/below the current ones
+    for (i = 0; i < 40; i++)
+    {
+        QLCChannel::Group group = (i % 3) ? QLCChannel::Intensity : QLCChannel::Pan;
+        m_uni->setChannelCapability(i, group);
+        ref.setChannelCapability(i, group);
+        m_uni->write(i, uchar(i * 5));
+        ref.write(i, uchar(i * 5));
+        values[i] = char((i * 37) % 256);
+    }
+
+    QList<Universe::BlendMode> modes;
+    modes << Universe::NormalBlend << Universe::MaskBlend
+          << Universe::AdditiveBlend << Universe::SubtractiveBlend;
+
+    foreach (Universe::BlendMode mode, modes)
+    {
+        QVERIFY(m_uni->writeBlendedRange(0, reinterpret_cast<const uchar *>(values.constData()),
+                                         values.size(), mode) == true);
+        for (i = 0; i < values.size(); i++)
+            ref.writeBlended(i, uchar(values.at(i)), mode);
+
+        for (i = 0; i < values.size(); i++)
+        {
+            QCOMPARE(quint8(m_uni->preGMValues().at(i)), quint8(ref.preGMValues().at(i)));
+            QCOMPARE(quint8(m_uni->postGMValues()->at(i)), quint8(ref.postGMValues()->at(i)));
+        }
+    }
+
+    QCOMPARE(m_uni->usedChannels(), ushort(40));
+
+    // runs exceeding the universe size are truncated
+    QVERIFY(m_uni->writeBlendedRange(UNIVERSE_SIZE - 10, reinterpret_cast<const uchar *>(values.constData()),
+                                     values.size()) == true);
+    QCOMPARE(m_uni->usedChannels(), ushort(UNIVERSE_SIZE));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(UNIVERSE_SIZE - 1)), quint8(values.at(9)));
+
+    QVERIFY(m_uni->writeBlendedRange(-1, reinterpret_cast<const uchar *>(values.constData()), 1) == false);
+    QVERIFY(m_uni->writeBlendedRange(0, NULL, 1) == false);
+}
+
+void Universe_Test::statistics()
+{
+    Universe::Statistics stats = m_uni->statistics();
+    QCOMPARE(stats.writes, quint32(0));
+    QCOMPARE(stats.htpRejects, quint32(0));
+    QCOMPARE(stats.faders, 0);
+    QCOMPARE(stats.fadeChannels, 0);
+
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(1, QLCChannel::Pan);
+
+    QVERIFY(m_uni->write(0, 200) == true);
+    QVERIFY(m_uni->write(0, 100) == false);
+    QVERIFY(m_uni->write(1, 100) == true);
+    QVERIFY(m_uni->writeRelative(1, 130) == true);
+
+    // counters are published at the end of a tick
+    QCOMPARE(m_uni->statistics().writes, quint32(0));
+
+    m_uni->processFaders();
+    stats = m_uni->statistics();
+    QCOMPARE(stats.writes, quint32(4));
+    QCOMPARE(stats.htpRejects, quint32(1));
+    QCOMPARE(stats.faders, 0);
+    QVERIFY(stats.processTime >= 0);
+
+    // and reset at every tick
+    m_uni->processFaders();
+    stats = m_uni->statistics();
+    QCOMPARE(stats.writes, quint32(0));
+    QCOMPARE(stats.htpRejects, quint32(0));
+}
+
+void Universe_Test::frames()
+{
+    quint32 generation = 42;
+    QVERIFY(m_uni->lastFrame(&generation).isEmpty());
+    QCOMPARE(generation, quint32(0));
+
+    m_uni->setChannelCapability(0, QLCChannel::Pan);
+    m_uni->setChannelCapability(1, QLCChannel::Pan);
+    QVERIFY(m_uni->write(1, 100) == true);
+
+    m_uni->processFaders();
+    QByteArray frame = m_uni->lastFrame(&generation);
+    QCOMPARE(generation, quint32(1));
+    QCOMPARE(frame.size(), 2);
+    QCOMPARE(quint8(frame.at(1)), quint8(100));
+
+    // same values: the generation doesn't change
+    m_uni->processFaders();
+    QCOMPARE(m_uni->frameGeneration(), quint32(1));
+
+    // a frame held by a consumer is never modified
+    QVERIFY(m_uni->write(1, 150) == true);
+    m_uni->processFaders();
+    m_uni->processFaders();
+    QCOMPARE(quint8(frame.at(1)), quint8(100));
+    QCOMPARE(quint8(m_uni->lastFrame().at(1)), quint8(150));
+    QCOMPARE(m_uni->frameGeneration(), quint32(2));
+}
+
+void Universe_Test::rendered()
+{
+    QVERIFY(m_uni->rendered() == true);
+
+    m_uni->setChannelCapability(0, QLCChannel::Pan);
+    QVERIFY(m_uni->write(0, 100) == true);
+
+    // a universe rendered by another host publishes nothing
+    m_uni->setRendered(false);
+    QVERIFY(m_uni->rendered() == false);
+    m_uni->processFaders();
+    QCOMPARE(m_uni->frameGeneration(), quint32(0));
+    QVERIFY(m_uni->lastFrame().isEmpty());
+
+    m_uni->setRendered(true);
+    m_uni->processFaders();
+    QCOMPARE(m_uni->frameGeneration(), quint32(1));
+    QCOMPARE(quint8(m_uni->lastFrame().at(0)), quint8(100));
+}
+
+void Universe_Test::idleFrame()
+{
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(1, QLCChannel::Pan);
+    m_uni->setChannelCapability(2, QLCChannel::Intensity);
+    QVERIFY(m_uni->write(0, 200) == true);
+    QVERIFY(m_uni->write(1, 100) == true);
+
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(0)), quint8(200));
+    QVERIFY(m_uni->m_idleFrame == false);
+
+    // without writes, the intensity is reset once
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(0)), quint8(0));
+    QCOMPARE(quint8(m_uni->lastFrame().at(1)), quint8(100));
+    QCOMPARE(m_uni->frameGeneration(), quint32(2));
+    QVERIFY(m_uni->m_idleFrame == true);
+
+    // then the frame is not rendered again until something changes
+    (*m_uni->m_postGMValues)[1] = char(42);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(1)), quint8(100));
+    QCOMPARE(m_uni->frameGeneration(), quint32(2));
+
+    QVERIFY(m_uni->write(1, 150) == true);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(1)), quint8(150));
+    QCOMPARE(m_uni->frameGeneration(), quint32(3));
+    m_uni->processFaders();
+
+    m_uni->reset(1, 1);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(1)), quint8(0));
+    QCOMPARE(m_uni->frameGeneration(), quint32(4));
+
+    // a new fader composes the frame again
+    QSharedPointer<GenericFader> fader = m_uni->requestFader();
+    fader->addLayerChannel(2, false);
+    fader->setLayerValue(2, 80);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(2)), quint8(80));
+    QVERIFY(fader->isIdle() == true);
+    QVERIFY(m_uni->m_idleFrame == true);
+
+    // an idle fader doesn't
+    (*m_uni->m_postGMValues)[2] = char(42);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(2)), quint8(80));
+
+    // until it changes
+    fader->setLayerValue(2, 90);
+    QVERIFY(fader->isIdle() == false);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(2)), quint8(90));
+
+    // setting the same value is not a change
+    fader->setLayerValue(2, 90);
+    QVERIFY(fader->isIdle() == true);
+    (*m_uni->m_postGMValues)[2] = char(42);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(2)), quint8(90));
+
+    m_uni->dismissFader(fader);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(2)), quint8(0));
+}
+
+void Universe_Test::passthroughMerge()
+{
+    for (int i = 0; i < 40; i++)
+        m_uni->setChannelCapability(i, QLCChannel::Pan);
+    m_uni->setPassthrough(true);
+    QCOMPARE(m_uni->passthroughMerge(), Universe::HTPMerge);
+
+    // channels 1 and 33 cover both the vectorized pass and the remainder
+    QVERIFY(m_uni->write(1, 100) == true);
+    QVERIFY(m_uni->write(33, 100) == true);
+    m_uni->slotInputValueChanged(0, 1, 50);
+    m_uni->slotInputValueChanged(0, 2, 80);
+    m_uni->slotInputValueChanged(0, 33, 150);
+    m_uni->processFaders();
+    QByteArray frame = m_uni->lastFrame();
+    QCOMPARE(frame.size(), 34);
+    QCOMPARE(quint8(frame.at(1)), quint8(100));
+    QCOMPARE(quint8(frame.at(2)), quint8(80));
+    QCOMPARE(quint8(frame.at(33)), quint8(150));
+
+    // the merge doesn't touch the engine values
+    QCOMPARE(m_uni->postGMValue(33), uchar(100));
+    QCOMPARE(m_uni->applyPassthrough(33, 100), uchar(150));
+
+    // LTP: the engine changed channels 1 and 33 after the input did
+    m_uni->setPassthroughMerge(Universe::LTPMerge);
+    m_uni->processFaders();
+    frame = m_uni->lastFrame();
+    QCOMPARE(quint8(frame.at(1)), quint8(100));
+    QCOMPARE(quint8(frame.at(2)), quint8(80));
+    QCOMPARE(quint8(frame.at(33)), quint8(100));
+
+    m_uni->slotInputValueChanged(0, 33, 120);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(33)), quint8(120));
+    QCOMPARE(m_uni->applyPassthrough(33, 100), uchar(120));
+
+    QVERIFY(m_uni->write(33, 110) == true);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(33)), quint8(110));
+
+    // the same input value again doesn't take the channel back
+    m_uni->slotInputValueChanged(0, 33, 120);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(33)), quint8(110));
+
+    // Input priority: the received channels always follow the input
+    m_uni->setPassthroughMerge(Universe::InputMerge);
+    QVERIFY(m_uni->write(4, 90) == true);
+    m_uni->processFaders();
+    frame = m_uni->lastFrame();
+    QCOMPARE(quint8(frame.at(1)), quint8(50));
+    QCOMPARE(quint8(frame.at(2)), quint8(80));
+    QCOMPARE(quint8(frame.at(4)), quint8(90));
+    QCOMPARE(quint8(frame.at(33)), quint8(120));
+
+    QCOMPARE(Universe::stringToPassthroughMerge(Universe::passthroughMergeToString(Universe::LTPMerge)),
+             Universe::LTPMerge);
+    QCOMPARE(Universe::stringToPassthroughMerge(Universe::passthroughMergeToString(Universe::InputMerge)),
+             Universe::InputMerge);
+    QCOMPARE(Universe::stringToPassthroughMerge("Foo"), Universe::HTPMerge);
+
+    // without passthrough the engine values go out untouched
+    m_uni->setPassthrough(false);
+    m_uni->processFaders();
+    QCOMPARE(quint8(m_uni->lastFrame().at(1)), quint8(100));
+}
+
+void Universe_Test::changedRange()
+{
+    m_uni->setChannelCapability(20, QLCChannel::Pan);
+
+    QVERIFY(m_uni->hasChanged() == false);
+    QCOMPARE(m_uni->changedCount(), 0);
+
+    QVERIFY(m_uni->write(4, 10) == true);
+    QVERIFY(m_uni->write(12, 20) == true);
+    QVERIFY(m_uni->hasChanged() == true);
+    QCOMPARE(m_uni->changedStart(), 4);
+    QCOMPARE(m_uni->changedCount(), 9);
+
+    QVERIFY(m_uni->hasChanged() == false);
+    QCOMPARE(m_uni->changedCount(), 0);
+
+    QVERIFY(m_uni->write(20, 30) == true);
+    QVERIFY(m_uni->hasChanged() == true);
+    QCOMPARE(m_uni->changedStart(), 20);
+    QCOMPARE(m_uni->changedCount(), 1);
+}
+
+void Universe_Test::faderPool()
+{
+    QSharedPointer<GenericFader> fader = m_uni->requestFader();
+    GenericFader *recycled = fader.data();
+    fader->setName("Test");
+    fader->adjustIntensity(0.5);
+    fader->setPaused(true);
+
+    m_uni->dismissFader(fader);
+    QCOMPARE(m_uni->m_faderPool->count(), 0);
+
+    // the dismissal is queued until the next frame
+    m_uni->processFaders();
+    QCOMPARE(m_uni->m_faderPool->count(), 0);
+
+    // the fader is recycled only when its last reference is gone
+    fader.clear();
+    QCOMPARE(m_uni->m_faderPool->count(), 1);
+
+    fader = m_uni->requestFader(Universe::Override);
+    QVERIFY(fader.data() == recycled);
+    QCOMPARE(m_uni->m_faderPool->count(), 0);
+    QCOMPARE(fader->name(), QString());
+    QCOMPARE(fader->intensity(), qreal(1.0));
+    QVERIFY(fader->isPaused() == false);
+    QCOMPARE(fader->priority(), int(Universe::Override));
+    QCOMPARE(fader->channelsCount(), 0);
+
+    // a fader can outlive its universe
+    delete m_uni;
+    m_uni = new Universe(0, m_gm, this);
+    fader.clear();
+}
+
+void Universe_Test::faderBuckets()
+{
+    QSharedPointer<GenericFader> desk = m_uni->requestFader(Universe::SimpleDesk);
+    QSharedPointer<GenericFader> first = m_uni->requestFader();
+    QSharedPointer<GenericFader> over = m_uni->requestFader(Universe::Override);
+    QSharedPointer<GenericFader> second = m_uni->requestFader();
+
+    // requests are applied by the next frame
+    QCOMPARE(m_uni->faders().count(), 0);
+    m_uni->processFaders();
+
+    QList<QSharedPointer<GenericFader> > faders = m_uni->faders();
+    QCOMPARE(faders.count(), 4);
+    QVERIFY(faders.at(0) == first);
+    QVERIFY(faders.at(1) == second);
+    QVERIFY(faders.at(2) == over);
+    QVERIFY(faders.at(3) == desk);
+
+    // a new priority puts the fader on top of its bucket
+    m_uni->requestFaderPriority(first, Universe::Override);
+    m_uni->dismissFader(over);
+    m_uni->processFaders();
+
+    faders = m_uni->faders();
+    QCOMPARE(faders.count(), 3);
+    QVERIFY(faders.at(0) == second);
+    QVERIFY(faders.at(1) == first);
+    QVERIFY(faders.at(2) == desk);
+    QCOMPARE(first->priority(), int(Universe::Override));
+
+    // moving back and forth within a frame keeps a single instance
+    m_uni->requestFaderPriority(first, Universe::SimpleDesk);
+    m_uni->requestFaderPriority(first, Universe::Override);
+    m_uni->processFaders();
+
+    faders = m_uni->faders();
+    QCOMPARE(faders.count(), 3);
+    QVERIFY(faders.at(1) == first);
+
+    // a fader dismissed before being applied is never composed
+    QSharedPointer<GenericFader> shortLived = m_uni->requestFader();
+    m_uni->dismissFader(shortLived);
+    m_uni->dismissFader(second);
+    m_uni->dismissFader(first);
+    m_uni->dismissFader(desk);
+    m_uni->processFaders();
+    QCOMPARE(m_uni->faders().count(), 0);
+}
+
 void Universe_Test::reset()
 {
     int i;
@@ -586,6 +1013,28 @@ void Universe_Test::savePasthroughTrue()
     QCOMPARE(xmlReader.attributes().value("Name").toString(), QString("Universe 123"));
     QCOMPARE(xmlReader.attributes().value("ID").toString(), QString("1"));
     QCOMPARE(xmlReader.attributes().value("Passthrough").toString(), QString("True"));
+    QCOMPARE(xmlReader.attributes().hasAttribute("PassthroughMerge"), false);
+
+    buffer.close();
+    QBuffer buffer2;
+    buffer2.open(QIODevice::WriteOnly | QIODevice::Text);
+    xmlWriter.setDevice(&buffer2);
+
+    m_uni->setPassthroughMerge(Universe::LTPMerge);
+    QVERIFY(m_uni->saveXML(&xmlWriter) == true);
+
+    xmlWriter.setDevice(NULL);
+    buffer2.close();
+
+    buffer2.open(QIODevice::ReadOnly | QIODevice::Text);
+    xmlReader.setDevice(&buffer2);
+    xmlReader.readNextStartElement();
+    QCOMPARE(xmlReader.attributes().value("PassthroughMerge").toString(), QString("LTP"));
+
+    Universe other(1, m_gm, this);
+    QVERIFY(other.loadXML(xmlReader, 0, NULL) == true);
+    QCOMPARE(other.passthrough(), true);
+    QCOMPARE(other.passthroughMerge(), Universe::LTPMerge);
 }
 
 void Universe_Test::setGMValueEfficiency()
@@ -633,6 +1082,25 @@ void Universe_Test::writeEfficiency()
         QCOMPARE(int(m_uni->postGMValues()->at(i)), int(100));
 }
 
+void Universe_Test::writeBlendedRangeEfficiency()
+{
+    m_gm->setValue(127);
+
+    int i;
+    for (i = 0; i < 512; i++)
+        m_uni->setChannelCapability(i, QLCChannel::Intensity);
+
+    QByteArray values(512, char(200));
+
+    QBENCHMARK
+    {
+        m_uni->writeBlendedRange(0, reinterpret_cast<const uchar *>(values.constData()), values.size());
+    }
+
+    for (i = 0; i < 512; i++)
+        QCOMPARE(int(m_uni->postGMValues()->at(i)), int(100));
+}
+
 void Universe_Test::hasChangedEfficiency()
 {
     for (int i = 0; i < 512; i++)
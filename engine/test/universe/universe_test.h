@@ -43,7 +43,18 @@ private slots:
     void grandMasterAllChannelsLimit();
     void applyGM();
     void write();
+    void writeMultiple();
     void writeRelative();
+    void channelModifiers();
+    void writeBlendedRange();
+    void statistics();
+    void frames();
+    void rendered();
+    void idleFrame();
+    void passthroughMerge();
+    void changedRange();
+    void faderPool();
+    void faderBuckets();
     void reset();
 
     void loadEmpty();
@@ -56,6 +67,7 @@ private slots:
 
     void setGMValueEfficiency();
     void writeEfficiency();
+    void writeBlendedRangeEfficiency();
     void hasChangedEfficiency();
     void hasNotChangedEfficiency();
     void zeroIntensityChannelsEfficiency();
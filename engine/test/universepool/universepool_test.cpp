@@ -0,0 +1,172 @@
+/*
+  Q Light Controller Plus - Unit test
+  universepool_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "universepool_test.h"
+#include "universepool.h"
+#undef private
+
+#include "grandmaster.h"
+#include "universe.h"
+
+#define UNIVERSES 5
+
+void UniversePool_Test::init()
+{
+    m_gm = new GrandMaster(this);
+    for (int i = 0; i < UNIVERSES; i++)
+        m_universes.append(new Universe(i, m_gm, this));
+}
+
+void UniversePool_Test::cleanup()
+{
+    qDeleteAll(m_universes);
+    m_universes.clear();
+    delete m_gm; m_gm = 0;
+}
+
+bool UniversePool_Test::waitWrites(Universe *universe, quint32 writes)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        if (universe->statistics().writes == writes)
+            return true;
+        QTest::qSleep(10);
+    }
+    return false;
+}
+
+void UniversePool_Test::initial()
+{
+    UniversePool pool(3);
+    QCOMPARE(pool.workersCount(), 3);
+    QCOMPARE(pool.isRunning(), false);
+    QVERIFY(pool.m_universes.isEmpty());
+
+    // one worker for each core by default
+    UniversePool defPool;
+    QCOMPARE(defPool.workersCount(), qMax(1, QThread::idealThreadCount()));
+}
+
+void UniversePool_Test::startStop()
+{
+    UniversePool pool(2);
+
+    pool.start();
+    QCOMPARE(pool.isRunning(), true);
+    QCOMPARE(pool.m_workers.count(), 2);
+
+    // starting again doesn't add workers
+    pool.start();
+    QCOMPARE(pool.m_workers.count(), 2);
+
+    pool.stop();
+    QCOMPARE(pool.isRunning(), false);
+    QVERIFY(pool.m_workers.isEmpty());
+
+    // ticks are ignored when the pool is stopped
+    pool.tick();
+    QCOMPARE(pool.m_round, 0);
+    QCOMPARE(pool.m_busy, false);
+}
+
+void UniversePool_Test::tick()
+{
+    UniversePool pool(2);
+    pool.setUniverses(m_universes);
+    pool.start();
+
+    for (int i = 0; i < UNIVERSES; i++)
+        m_universes.at(i)->write(0, 100 + i);
+
+    // every universe is processed at each round, whatever worker takes it
+    pool.tick();
+    for (int i = 0; i < UNIVERSES; i++)
+        QVERIFY(waitWrites(m_universes.at(i), 1));
+
+    // the next round publishes the reset counters
+    pool.tick();
+    for (int i = 0; i < UNIVERSES; i++)
+        QVERIFY(waitWrites(m_universes.at(i), 0));
+
+    pool.setUniverses(QList<Universe *>());
+    QCOMPARE(pool.m_busy, false);
+    QCOMPARE(pool.m_activeWorkers, 0);
+}
+
+void UniversePool_Test::pendingTicks()
+{
+    UniversePool pool(2);
+    pool.setUniverses(m_universes);
+
+    // simulate a round still running
+    pool.m_running = true;
+    pool.m_busy = true;
+    pool.tick();
+    pool.tick();
+    QCOMPARE(pool.m_pendingTicks, 2);
+    QCOMPARE(pool.m_round, 0);
+
+    // each pending tick starts a round when the previous one is over
+    pool.finishRound();
+    QCOMPARE(pool.m_pendingTicks, 1);
+    QCOMPARE(pool.m_round, 1);
+    QCOMPARE(pool.m_busy, true);
+
+    pool.finishRound();
+    QCOMPARE(pool.m_pendingTicks, 0);
+    QCOMPARE(pool.m_round, 2);
+
+    pool.finishRound();
+    QCOMPARE(pool.m_round, 2);
+    QCOMPARE(pool.m_busy, false);
+
+    pool.m_running = false;
+}
+
+void UniversePool_Test::setUniverses()
+{
+    UniversePool pool(4);
+    pool.setUniverses(m_universes);
+    pool.start();
+
+    // universes can be removed between ticks
+    for (int i = 0; i < 20; i++)
+    {
+        pool.tick();
+        pool.setUniverses(m_universes.mid(0, UNIVERSES - 1 - (i % 2)));
+        QCOMPARE(pool.m_busy, false);
+    }
+
+    pool.setUniverses(m_universes.mid(0, 1));
+    m_universes.at(0)->write(0, 1);
+    m_universes.at(1)->write(0, 1);
+    pool.tick();
+    QVERIFY(waitWrites(m_universes.at(0), 1));
+    pool.setUniverses(QList<Universe *>());
+
+    // the universe out of the pool was not processed
+    QCOMPARE(m_universes.at(1)->statistics().writes, quint32(0));
+
+    pool.stop();
+}
+
+QTEST_APPLESS_MAIN(UniversePool_Test)
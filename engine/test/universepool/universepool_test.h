@@ -0,0 +1,51 @@
+/*
+  Q Light Controller Plus - Unit test
+  universepool_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef UNIVERSEPOOL_TEST_H
+#define UNIVERSEPOOL_TEST_H
+
+#include <QObject>
+
+class GrandMaster;
+class Universe;
+
+class UniversePool_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void initial();
+    void startStop();
+    void tick();
+    void pendingTicks();
+    void setUniverses();
+
+private:
+    /** Wait up to a second for $universe to publish $writes writes */
+    bool waitWrites(Universe *universe, quint32 writes);
+
+private:
+    GrandMaster *m_gm;
+    QList<Universe *> m_universes;
+};
+
+#endif
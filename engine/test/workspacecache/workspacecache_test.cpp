@@ -0,0 +1,174 @@
+/*
+  Q Light Controller Plus - Unit test
+  workspacecache_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QFile>
+
+#include "workspacecache_test.h"
+#include "workspacecache.h"
+#include "fixture.h"
+#include "doc.h"
+
+void WorkspaceCache_Test::init()
+{
+    m_doc = new Doc(this);
+    m_dir = new QTemporaryDir();
+    QVERIFY(m_dir->isValid());
+}
+
+void WorkspaceCache_Test::cleanup()
+{
+    delete m_dir;
+    m_dir = NULL;
+    delete m_doc;
+    m_doc = NULL;
+}
+
+QString WorkspaceCache_Test::writeWorkspace(const QByteArray &content)
+{
+    QString path = m_dir->path() + QString("/workspace.qxw");
+    QFile file(path);
+    file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    file.write(content);
+    file.close();
+
+    return path;
+}
+
+void WorkspaceCache_Test::invalid()
+{
+    // no workspace and no cache
+    WorkspaceCache noFile(m_dir->path() + QString("/missing.qxw"));
+    QVERIFY(noFile.isValid() == false);
+    QVERIFY(noFile.loadFixtures(m_doc) == false);
+    QVERIFY(noFile.save(m_doc) == false);
+
+    // a workspace without a cache
+    QString path = writeWorkspace("<Workspace/>");
+    QCOMPARE(WorkspaceCache::cacheFile(path), path + QString(".cache"));
+
+    WorkspaceCache cache(path);
+    QVERIFY(cache.isValid() == false);
+    QVERIFY(cache.loadFixtures(m_doc) == false);
+    QCOMPARE(m_doc->fixtures().count(), 0);
+}
+
+void WorkspaceCache_Test::saveLoad()
+{
+    Fixture *fxi = new Fixture(m_doc);
+    fxi->setName("Dimmers");
+    fxi->setUniverse(0);
+    fxi->setAddress(10);
+    fxi->setChannels(6);
+    fxi->setExcludeFadeChannels(QList<int>() << 1 << 3);
+    fxi->setForcedLTPChannels(QList<int>() << 2);
+    QVERIFY(m_doc->addFixture(fxi, 5) == true);
+
+    fxi = new Fixture(m_doc);
+    fxi->setName("More dimmers");
+    fxi->setUniverse(1);
+    fxi->setAddress(100);
+    fxi->setChannels(12);
+    fxi->setForcedHTPChannels(QList<int>() << 0 << 11);
+    QVERIFY(m_doc->addFixture(fxi, 42) == true);
+
+    QString path = writeWorkspace("<Workspace/>");
+    WorkspaceCache cache(path);
+    QVERIFY(cache.save(m_doc) == true);
+    QVERIFY(QFile::exists(WorkspaceCache::cacheFile(path)));
+    QVERIFY(cache.isValid() == true);
+
+    // a new instance checks the file again
+    WorkspaceCache cache2(path);
+    QVERIFY(cache2.isValid() == true);
+
+    Doc doc(this);
+    QVERIFY(cache2.loadFixtures(&doc) == true);
+    QCOMPARE(doc.fixtures().count(), 2);
+
+    Fixture *loaded = doc.fixture(5);
+    QVERIFY(loaded != NULL);
+    QCOMPARE(loaded->name(), QString("Dimmers"));
+    QCOMPARE(loaded->universe(), quint32(0));
+    QCOMPARE(loaded->address(), quint32(10));
+    QCOMPARE(loaded->channels(), quint32(6));
+    QCOMPARE(loaded->excludeFadeChannels(), QList<int>() << 1 << 3);
+    QCOMPARE(loaded->forcedLTPChannels(), QList<int>() << 2);
+    QVERIFY(loaded->forcedHTPChannels().isEmpty());
+
+    loaded = doc.fixture(42);
+    QVERIFY(loaded != NULL);
+    QCOMPARE(loaded->name(), QString("More dimmers"));
+    QCOMPARE(loaded->universe(), quint32(1));
+    QCOMPARE(loaded->address(), quint32(100));
+    QCOMPARE(loaded->channels(), quint32(12));
+    QCOMPARE(loaded->forcedHTPChannels(), QList<int>() << 0 << 11);
+}
+
+void WorkspaceCache_Test::changedWorkspace()
+{
+    Fixture *fxi = new Fixture(m_doc);
+    fxi->setChannels(4);
+    QVERIFY(m_doc->addFixture(fxi) == true);
+
+    QString path = writeWorkspace("<Workspace/>");
+    WorkspaceCache cache(path);
+    QVERIFY(cache.save(m_doc) == true);
+
+    // the same size, but a different content
+    writeWorkspace("<Workspacf/>");
+
+    WorkspaceCache cache2(path);
+    QVERIFY(cache2.isValid() == false);
+
+    Doc doc(this);
+    QVERIFY(cache2.loadFixtures(&doc) == false);
+    QCOMPARE(doc.fixtures().count(), 0);
+}
+
+void WorkspaceCache_Test::damaged()
+{
+    for (int i = 0; i < 3; i++)
+    {
+        Fixture *fxi = new Fixture(m_doc);
+        fxi->setName(QString("Fixture %1").arg(i));
+        fxi->setChannels(4);
+        QVERIFY(m_doc->addFixture(fxi) == true);
+    }
+
+    QString path = writeWorkspace("<Workspace/>");
+    WorkspaceCache cache(path);
+    QVERIFY(cache.save(m_doc) == true);
+
+    // cut the last fixture in half
+    QFile file(WorkspaceCache::cacheFile(path));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 8));
+    file.close();
+
+    // the header is still fine, but nothing is added to Doc
+    WorkspaceCache cache2(path);
+    QVERIFY(cache2.isValid() == true);
+
+    Doc doc(this);
+    QVERIFY(cache2.loadFixtures(&doc) == false);
+    QCOMPARE(doc.fixtures().count(), 0);
+}
+
+QTEST_APPLESS_MAIN(WorkspaceCache_Test)
@@ -0,0 +1,9 @@
+#!/bin/bash
+export LD_LIBRARY_PATH=$LD_LIBRARY_PATH:../../src
+export DYLD_FALLBACK_LIBRARY_PATH=../../src
+# a small rig, just to check that the generated workspaces load back.
+# Run ./workspacegen -h for the options of bigger rigs
+./workspacegen -u 4 -f 200 -n 400 -w 120 -o test.qxw --verify
+RESULT=${?}
+rm -f test.qxw
+exit ${RESULT}
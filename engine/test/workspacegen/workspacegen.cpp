@@ -0,0 +1,147 @@
+/*
+  Q Light Controller Plus - Unit test
+  workspacegen.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QDir>
+
+#include "workspacegenerator.h"
+#include "qlcfixturedefcache.h"
+#include "offlinerenderer.h"
+#include "rgbscriptscache.h"
+#include "qlcfile.h"
+#include "doc.h"
+
+#include "../common/resource_paths.h"
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+#define endl Qt::endl
+#endif
+
+void printUsage()
+{
+    QTextStream cout(stdout, QIODevice::WriteOnly);
+
+    cout << "Usage:";
+    cout << "  workspacegen [options]" << endl;
+    cout << "Options:" << endl;
+    cout << "  -u or --universes <count>\tNumber of universes (default: 4)" << endl;
+    cout << "  -f or --fixtures <count>\tNumber of fixtures (default: 100)" << endl;
+    cout << "  -n or --functions <count>\tNumber of functions (default: 200)" << endl;
+    cout << "  -w or --widgets <count>\tNumber of Virtual Console widgets (default: 50)" << endl;
+    cout << "  -d or --definition <def>\tUse a fixture definition, as Manufacturer/Model/Mode (repeatable)" << endl;
+    cout << "  --fixtures-dir <dir>\t\tLoad the fixture definitions from dir" << endl;
+    cout << "  --scripts-dir <dir>\t\tLoad the RGB scripts from dir" << endl;
+    cout << "  -o or --output <file>\t\tWorkspace file to write (default: generated.qxw)" << endl;
+    cout << "  -v or --verify\t\tLoad the written workspace back and check it" << endl;
+    cout << "  -h or --help\t\t\tPrint this help" << endl;
+    cout << endl;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QTextStream cout(stdout, QIODevice::WriteOnly);
+
+    int universes = 4, fixtures = 100, functions = 200, widgets = 50;
+    QStringList definitions;
+    QString fixturesDir(INTERNAL_FIXTUREDIR);
+    QString scriptsDir(INTERNAL_SCRIPTDIR);
+    QString output("generated.qxw");
+    bool verify = false;
+
+    QStringListIterator it(QCoreApplication::arguments());
+    it.next();
+    while (it.hasNext() == true)
+    {
+        QString arg(it.next());
+        bool hasValue = it.hasNext();
+
+        if ((arg == "-u" || arg == "--universes") && hasValue)
+            universes = it.next().toInt();
+        else if ((arg == "-f" || arg == "--fixtures") && hasValue)
+            fixtures = it.next().toInt();
+        else if ((arg == "-n" || arg == "--functions") && hasValue)
+            functions = it.next().toInt();
+        else if ((arg == "-w" || arg == "--widgets") && hasValue)
+            widgets = it.next().toInt();
+        else if ((arg == "-d" || arg == "--definition") && hasValue)
+            definitions.append(it.next());
+        else if (arg == "--fixtures-dir" && hasValue)
+            fixturesDir = it.next();
+        else if (arg == "--scripts-dir" && hasValue)
+            scriptsDir = it.next();
+        else if ((arg == "-o" || arg == "--output") && hasValue)
+            output = it.next();
+        else if (arg == "-v" || arg == "--verify")
+            verify = true;
+        else
+        {
+            printUsage();
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+
+    Doc doc(NULL, universes);
+
+    QDir dir(fixturesDir);
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    doc.fixtureDefCache()->loadMap(dir);
+    doc.rgbScriptsCache()->load(QDir(scriptsDir));
+
+    WorkspaceGenerator generator(universes, fixtures, functions, widgets);
+    if (definitions.isEmpty() == false)
+        generator.setDefinitions(definitions);
+
+    if (generator.generate(&doc) == false || generator.save(&doc, output) == false)
+    {
+        cout << generator.errorString() << endl;
+        return 1;
+    }
+
+    cout << "Written " << output << ": " << doc.fixtures().count() << " fixtures, ";
+    cout << doc.fixtureGroups().count() << " groups, " << doc.functions().count() << " functions, ";
+    cout << widgets << " widgets" << endl;
+
+    if (verify == false)
+        return 0;
+
+    Doc loaded(NULL, universes);
+    loaded.fixtureDefCache()->loadMap(dir);
+    loaded.rgbScriptsCache()->load(QDir(scriptsDir));
+
+    QElapsedTimer time;
+    time.start();
+
+    OfflineRenderer renderer(&loaded);
+    if (renderer.loadWorkspace(output) == false ||
+        loaded.fixtures().count() != doc.fixtures().count() ||
+        loaded.fixtureGroups().count() != doc.fixtureGroups().count() ||
+        loaded.functions().count() != doc.functions().count())
+    {
+        cout << "Verification of " << output << " failed" << endl;
+        return 1;
+    }
+
+    cout << "Verified in " << time.elapsed() << " ms" << endl;
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = workspacegen
+
+qmlui {
+  QT += qml
+} else {
+  QT += script
+}
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+QMAKE_LIBDIR += ../../src
+LIBS         += -lqlcplusengine
+
+SOURCES += workspacegen.cpp workspacegenerator.cpp
+HEADERS += workspacegenerator.h ../common/resource_paths.h
@@ -0,0 +1,399 @@
+/*
+  Q Light Controller Plus - Unit test
+  workspacegenerator.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamWriter>
+#include <QVector>
+#include <QFile>
+#include <QtMath>
+
+#include "workspacegenerator.h"
+#include "qlcfixturedefcache.h"
+#include "qlcfixturemode.h"
+#include "qlcfixturedef.h"
+#include "showfunction.h"
+#include "fixturegroup.h"
+#include "rgbalgorithm.h"
+#include "efxfixture.h"
+#include "chaserstep.h"
+#include "qlcchannel.h"
+#include "rgbmatrix.h"
+#include "rgbaudio.h"
+#include "fixture.h"
+#include "qlcfile.h"
+#include "chaser.h"
+#include "scene.h"
+#include "track.h"
+#include "show.h"
+#include "efx.h"
+#include "doc.h"
+
+/* Tags of the Virtual Console XML, as written by ui/src/virtualconsole */
+#define KXMLQLCWorkspace "Workspace"
+#define KXMLQLCVirtualConsole "VirtualConsole"
+
+/** Number of widgets in each Virtual Console frame */
+#define WIDGETS_PER_FRAME 50
+
+/** Maximum number of fixtures in each generated Scene */
+#define SCENE_FIXTURES 32
+
+/** Number of steps of the generated Chasers */
+#define CHASER_STEPS 8
+
+/** Number of functions on each track of the generated Shows */
+#define SHOW_FUNCTIONS 16
+
+WorkspaceGenerator::WorkspaceGenerator(int universes, int fixtures, int functions, int widgets)
+    : m_universes(qMax(1, universes))
+    , m_fixtures(qMax(0, fixtures))
+    , m_functions(qMax(0, functions))
+    , m_widgets(qMax(0, widgets))
+    , m_definitions(WORKSPACEGEN_DEFAULT_DEFINITIONS)
+{
+}
+
+void WorkspaceGenerator::setDefinitions(const QStringList &definitions)
+{
+    m_definitions = definitions;
+}
+
+QString WorkspaceGenerator::errorString() const
+{
+    return m_error;
+}
+
+bool WorkspaceGenerator::generate(Doc *doc)
+{
+    Q_ASSERT(doc != NULL);
+
+    QList<QPair<QLCFixtureDef*, QLCFixtureMode*> > defs;
+    foreach (QString definition, m_definitions)
+    {
+        QStringList parts = definition.split("/");
+        QLCFixtureDef *def = NULL;
+        QLCFixtureMode *mode = NULL;
+
+        if (parts.count() == 3)
+            def = doc->fixtureDefCache()->fixtureDef(parts.at(0), parts.at(1));
+        if (def != NULL)
+            mode = def->mode(parts.at(2));
+
+        if (mode == NULL)
+        {
+            m_error = QString("Fixture definition not found: %1").arg(definition);
+            return false;
+        }
+
+        defs.append(qMakePair(def, mode));
+    }
+
+    if (defs.isEmpty())
+    {
+        m_error = QString("No fixture definitions given");
+        return false;
+    }
+
+    addFixtures(doc, defs);
+    addGroups(doc);
+    addFunctions(doc);
+
+    return true;
+}
+
+void WorkspaceGenerator::addFixtures(Doc *doc, const QList<QPair<QLCFixtureDef*, QLCFixtureMode*> >& defs)
+{
+    QVector<quint32> addresses(m_universes, 0);
+
+    for (int i = 0; i < m_fixtures; i++)
+    {
+        QPair<QLCFixtureDef*, QLCFixtureMode*> def = defs.at(i % defs.count());
+
+        Fixture *fxi = new Fixture(doc);
+        fxi->setFixtureDefinition(def.first, def.second);
+        fxi->setName(QString("%1 %2").arg(def.first->model()).arg(i + 1));
+
+        /* Spread the fixtures evenly, moving on to the next universe
+           when one is full. The Doc adds the universes past the end */
+        int universe = int(qint64(i) * m_universes / m_fixtures);
+        while (universe < addresses.count() &&
+               addresses[universe] + fxi->channels() > UNIVERSE_SIZE)
+            universe++;
+        if (universe == addresses.count())
+            addresses.append(0);
+
+        fxi->setUniverse(quint32(universe));
+        fxi->setAddress(addresses[universe]);
+        addresses[universe] += fxi->channels();
+
+        doc->addFixture(fxi);
+    }
+}
+
+void WorkspaceGenerator::addGroups(Doc *doc)
+{
+    QMap<quint32, QList<Fixture*> > byUniverse;
+    foreach (Fixture *fxi, doc->fixtures())
+        byUniverse[fxi->universe()].append(fxi);
+
+    QMapIterator<quint32, QList<Fixture*> > it(byUniverse);
+    while (it.hasNext())
+    {
+        it.next();
+
+        int heads = 0;
+        foreach (Fixture *fxi, it.value())
+            heads += fxi->heads();
+
+        int width = qCeil(qSqrt(heads));
+        FixtureGroup *grp = new FixtureGroup(doc);
+        grp->setName(QString("Universe %1").arg(it.key() + 1));
+        grp->setSize(QSize(width, (heads + width - 1) / width));
+        doc->addFixtureGroup(grp);
+
+        int head = 0;
+        foreach (Fixture *fxi, it.value())
+        {
+            for (int h = 0; h < fxi->heads(); h++, head++)
+                grp->assignHead(QLCPoint(head % width, head / width), GroupHead(fxi->id(), h));
+        }
+    }
+}
+
+void WorkspaceGenerator::addFunctions(Doc *doc)
+{
+    QList<Fixture*> fixtures = doc->fixtures();
+    QList<FixtureGroup*> groups = doc->fixtureGroups();
+
+    QList<Fixture*> movers;
+    foreach (Fixture *fxi, fixtures)
+    {
+        if (fxi->channelNumber(QLCChannel::Pan, QLCChannel::MSB) != QLCChannel::invalid() &&
+            fxi->channelNumber(QLCChannel::Tilt, QLCChannel::MSB) != QLCChannel::invalid())
+            movers.append(fxi);
+    }
+
+    QStringList algorithms;
+    RGBAudio audio(doc);
+    foreach (QString name, RGBAlgorithm::algorithms(doc))
+    {
+        // audio needs a capture device to run
+        if (name != audio.name())
+            algorithms.append(name);
+    }
+
+    /* Half of the functions are Scenes, the others use them */
+    int scenes = m_functions / 2;
+    if (scenes == 0)
+        scenes = m_functions;
+
+    QList<quint32> sceneIDs;
+    for (int i = 0; i < scenes; i++)
+    {
+        Scene *s = new Scene(doc);
+        s->setName(QString("Scene %1").arg(i + 1));
+
+        /* Each Scene covers a slice of the rig */
+        int count = qBound(1, fixtures.count() / 8, SCENE_FIXTURES);
+        for (int f = 0; f < count && fixtures.isEmpty() == false; f++)
+        {
+            Fixture *fxi = fixtures.at((i * count + f) % fixtures.count());
+            for (quint32 ch = 0; ch < fxi->channels(); ch++)
+                s->setValue(fxi->id(), ch, uchar((i * 37 + ch * 11) % 256));
+        }
+
+        doc->addFunction(s);
+        sceneIDs.append(s->id());
+    }
+
+    QList<quint32> showable;
+    for (int i = scenes; i < m_functions; i++)
+    {
+        Function *function = NULL;
+        int kind = i % 5;
+
+        if (kind == 1 && groups.isEmpty() == false && algorithms.isEmpty() == false)
+        {
+            RGBMatrix *m = new RGBMatrix(doc);
+            m->setFixtureGroup(groups.at(i % groups.count())->id());
+            m->setAlgorithm(RGBAlgorithm::algorithm(doc, algorithms.at(i % algorithms.count())));
+            function = m;
+        }
+        else if (kind == 2 && movers.isEmpty() == false)
+        {
+            EFX *e = new EFX(doc);
+            e->setAlgorithm(EFX::Algorithm(i % (EFX::Lissajous + 1)));
+            int count = qMin(movers.count(), 16);
+            for (int f = 0; f < count; f++)
+            {
+                EFXFixture *ef = new EFXFixture(e);
+                ef->setHead(GroupHead(movers.at((i + f) % movers.count())->id(), 0));
+                e->addFixture(ef);
+            }
+            function = e;
+        }
+        else if (kind == 3 && showable.isEmpty() == false)
+        {
+            Show *show = new Show(doc);
+            show->setName(QString("Show %1").arg(i + 1));
+            doc->addFunction(show);
+
+            Track *track = new Track();
+            track->setName("Track 1");
+            show->addTrack(track);
+            for (int f = 0; f < SHOW_FUNCTIONS; f++)
+            {
+                ShowFunction *sf = track->createShowFunction(showable.at((i + f) % showable.count()));
+                sf->setStartTime(quint32(f) * 2000);
+                sf->setDuration(2000);
+            }
+            continue;
+        }
+        else
+        {
+            Chaser *c = new Chaser(doc);
+            for (int s = 0; s < CHASER_STEPS; s++)
+                c->addStep(ChaserStep(sceneIDs.at((i + s) % sceneIDs.count()), 200, 1000, 200));
+            function = c;
+        }
+
+        function->setName(QString("%1 %2").arg(function->typeString()).arg(i + 1));
+        doc->addFunction(function);
+        showable.append(function->id());
+    }
+}
+
+bool WorkspaceGenerator::save(Doc *doc, const QString &fileName)
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        m_error = QString("Unable to write %1").arg(fileName);
+        return false;
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(1);
+
+    QLCFile::writeXMLHeader(&xml, KXMLQLCWorkspace);
+    doc->saveXML(&xml);
+    writeVirtualConsole(doc, &xml);
+    xml.writeEndElement(); // close KXMLQLCWorkspace
+    xml.writeEndDocument();
+
+    if (file.error() != QFile::NoError)
+    {
+        m_error = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+static void writeWindowState(QXmlStreamWriter *xml, int x, int y, int w, int h)
+{
+    xml->writeStartElement("WindowState");
+    xml->writeAttribute("Visible", "False");
+    xml->writeAttribute("X", QString::number(x));
+    xml->writeAttribute("Y", QString::number(y));
+    xml->writeAttribute("Width", QString::number(w));
+    xml->writeAttribute("Height", QString::number(h));
+    xml->writeEndElement();
+}
+
+void WorkspaceGenerator::writeVirtualConsole(Doc *doc, QXmlStreamWriter *xml) const
+{
+    QList<Function*> functions = doc->functions();
+    quint32 widgetID = 0;
+
+    xml->writeStartElement(KXMLQLCVirtualConsole);
+
+    /* The contents frame */
+    xml->writeStartElement("Frame");
+    xml->writeAttribute("Caption", "");
+
+    int frames = (m_widgets + WIDGETS_PER_FRAME - 1) / WIDGETS_PER_FRAME;
+    for (int f = 0; f < frames; f++)
+    {
+        xml->writeStartElement("Frame");
+        xml->writeAttribute("Caption", QString("Frame %1").arg(f + 1));
+        xml->writeAttribute("ID", QString::number(widgetID++));
+        writeWindowState(xml, 10 + (f % 4) * 460, 10 + (f / 4) * 360, 450, 350);
+        xml->writeTextElement("AllowChildren", "True");
+        xml->writeTextElement("AllowResize", "True");
+
+        int count = qMin(WIDGETS_PER_FRAME, m_widgets - f * WIDGETS_PER_FRAME);
+        for (int w = 0; w < count; w++)
+        {
+            int index = f * WIDGETS_PER_FRAME + w;
+            quint32 fid = functions.isEmpty() ? Function::invalidId()
+                                              : functions.at(index % functions.count())->id();
+            int x = 10 + (w % 10) * 43;
+            int y = 10 + (w / 10) * 65;
+
+            /* One slider every five widgets */
+            if (w % 5 == 4)
+            {
+                xml->writeStartElement("Slider");
+                xml->writeAttribute("Caption", QString("Slider %1").arg(index + 1));
+                xml->writeAttribute("ID", QString::number(widgetID++));
+                writeWindowState(xml, x, y, 40, 60);
+                xml->writeStartElement("SliderMode");
+                xml->writeAttribute("ValueDisplayStyle", "Exact");
+                xml->writeCharacters("Playback");
+                xml->writeEndElement();
+                xml->writeStartElement("Level");
+                xml->writeAttribute("LowLimit", "0");
+                xml->writeAttribute("HighLimit", "255");
+                xml->writeAttribute("Value", "0");
+                xml->writeEndElement();
+                xml->writeStartElement("Playback");
+                xml->writeTextElement("Function", QString::number(fid));
+                xml->writeEndElement();
+                xml->writeEndElement();
+            }
+            else
+            {
+                xml->writeStartElement("Button");
+                xml->writeAttribute("Caption", QString("Button %1").arg(index + 1));
+                xml->writeAttribute("ID", QString::number(widgetID++));
+                xml->writeAttribute("Icon", "");
+                writeWindowState(xml, x, y, 40, 60);
+                xml->writeStartElement("Function");
+                xml->writeAttribute("ID", QString::number(fid));
+                xml->writeEndElement();
+                xml->writeTextElement("Action", "Toggle");
+                xml->writeEndElement();
+            }
+        }
+
+        xml->writeEndElement(); // close Frame
+    }
+
+    xml->writeEndElement(); // close the contents Frame
+
+    xml->writeStartElement("Properties");
+    xml->writeStartElement("Size");
+    xml->writeAttribute("Width", "1920");
+    xml->writeAttribute("Height", "1080");
+    xml->writeEndElement();
+    xml->writeEndElement();
+
+    xml->writeEndElement(); // close KXMLQLCVirtualConsole
+}
@@ -0,0 +1,88 @@
+/*
+  Q Light Controller Plus - Unit test
+  workspacegenerator.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WORKSPACEGENERATOR_H
+#define WORKSPACEGENERATOR_H
+
+#include <QStringList>
+#include <QString>
+#include <QList>
+#include <QPair>
+
+class QXmlStreamWriter;
+class QLCFixtureMode;
+class QLCFixtureDef;
+class Doc;
+
+/** The definitions used when none are given */
+#define WORKSPACEGEN_DEFAULT_DEFINITIONS \
+    (QStringList() << "Generic/Generic RGB/RGB" << "Martin/MAC250+/Mode 4")
+
+/**
+ * WorkspaceGenerator fills a Doc with a synthetic rig of the given size,
+ * to test the engine at the scale of the biggest real workspaces.
+ *
+ * Fixtures cycle through the given definitions and are spread evenly over
+ * the universes, with one fixture group per universe. The functions are a
+ * mix of Scenes, Chasers, RGB Matrices, EFX and Shows, always the same for
+ * the same settings. The Virtual Console is written as plain XML, with
+ * frames of buttons and sliders bound to the functions, since the engine
+ * has no Virtual Console classes.
+ */
+class WorkspaceGenerator
+{
+public:
+    WorkspaceGenerator(int universes, int fixtures, int functions, int widgets);
+
+    /**
+     * Set the fixture definitions to use, as "Manufacturer/Model/Mode".
+     * They must be in the fixture cache of the generated Doc.
+     */
+    void setDefinitions(const QStringList& definitions);
+
+    /**
+     * Generate the rig into $doc, which must have at least the requested
+     * universes.
+     *
+     * @return false if a definition is not found (see errorString())
+     */
+    bool generate(Doc *doc);
+
+    /** Write $doc as a workspace, with the Virtual Console, to $fileName */
+    bool save(Doc *doc, const QString& fileName);
+
+    /** Get the error of the last failed call */
+    QString errorString() const;
+
+private:
+    void addFixtures(Doc *doc, const QList<QPair<QLCFixtureDef*, QLCFixtureMode*> >& defs);
+    void addGroups(Doc *doc);
+    void addFunctions(Doc *doc);
+    void writeVirtualConsole(Doc *doc, QXmlStreamWriter *xml) const;
+
+private:
+    int m_universes;
+    int m_fixtures;
+    int m_functions;
+    int m_widgets;
+    QStringList m_definitions;
+    QString m_error;
+};
+
+#endif
@@ -35,6 +35,7 @@
 #include <QSize>
 #include <QAction>
 
+#include "qlcimagecache.h"
 #include "qlccapability.h"
 #include "qlcconfig.h"
 #include "qlcfile.h"
@@ -508,7 +509,7 @@ void EditChannel::slotPictureButtonPressed()
     if (filename.isEmpty() == true)
         return;
 
-    m_resourceButton->setIcon(QIcon(filename));
+    m_resourceButton->setIcon(QLCImageCache::icon(filename, m_resourceButton->iconSize().width()));
     m_currentCapability->setResource(0, filename);
 }
 
@@ -661,7 +662,8 @@ void EditChannel::updateCapabilityPresetGroup(bool show)
         switch (type)
         {
             case QLCCapability::Picture:
-                m_resourceButton->setIcon(QIcon(m_currentCapability->resource(0).toString()));
+                m_resourceButton->setIcon(QLCImageCache::icon(m_currentCapability->resource(0).toString(),
+                                                              m_resourceButton->iconSize().width()));
                 showPicture = true;
                 showPreview = true;
             break;
@@ -54,12 +54,22 @@ void HotPlugMonitor::connectListener(QObject* listener)
 {
     QByteArray added = QMetaObject::normalizedSignature("slotDeviceAdded(uint,uint)");
     QByteArray removed = QMetaObject::normalizedSignature("slotDeviceRemoved(uint,uint)");
-
-    if (listener->metaObject()->indexOfMethod(added.constData()) != -1)
+    QByteArray addedPath = QMetaObject::normalizedSignature("slotDeviceAdded(uint,uint,QString)");
+    QByteArray removedPath = QMetaObject::normalizedSignature("slotDeviceRemoved(uint,uint,QString)");
+
+    // prefer the slots taking the device path, so that a listener
+    // implementing both is not notified twice
+    if (listener->metaObject()->indexOfMethod(addedPath.constData()) != -1)
+        connect(instance(), SIGNAL(deviceAdded(uint,uint,QString)),
+                listener, SLOT(slotDeviceAdded(uint,uint,QString)));
+    else if (listener->metaObject()->indexOfMethod(added.constData()) != -1)
         connect(instance(), SIGNAL(deviceAdded(uint,uint)),
                 listener, SLOT(slotDeviceAdded(uint,uint)));
 
-    if (listener->metaObject()->indexOfMethod(removed.constData()) != -1)
+    if (listener->metaObject()->indexOfMethod(removedPath.constData()) != -1)
+        connect(instance(), SIGNAL(deviceRemoved(uint,uint,QString)),
+                listener, SLOT(slotDeviceRemoved(uint,uint,QString)));
+    else if (listener->metaObject()->indexOfMethod(removed.constData()) != -1)
         connect(instance(), SIGNAL(deviceRemoved(uint,uint)),
                 listener, SLOT(slotDeviceRemoved(uint,uint)));
 }
@@ -100,14 +110,16 @@ void HotPlugMonitor::stop()
     d_ptr->stop();
 }
 
-void HotPlugMonitor::emitDeviceAdded(uint vid, uint pid)
+void HotPlugMonitor::emitDeviceAdded(uint vid, uint pid, const QString& path)
 {
-    qDebug() << Q_FUNC_INFO << vid << pid;
+    qDebug() << Q_FUNC_INFO << vid << pid << path;
     emit deviceAdded(vid, pid);
+    emit deviceAdded(vid, pid, path);
 }
 
-void HotPlugMonitor::emitDeviceRemoved(uint vid, uint pid)
+void HotPlugMonitor::emitDeviceRemoved(uint vid, uint pid, const QString& path)
 {
-    qDebug() << Q_FUNC_INFO << vid << pid;
+    qDebug() << Q_FUNC_INFO << vid << pid << path;
     emit deviceRemoved(vid, pid);
+    emit deviceRemoved(vid, pid, path);
 }
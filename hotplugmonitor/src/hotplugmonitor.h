@@ -21,6 +21,7 @@
 #define HOTPLUGMONITOR_H
 
 #include <QObject>
+#include <QString>
 #if defined(WIN32) || defined(Q_OS_WIN)
 #  include <qwindowdefs.h>
 #endif
@@ -32,6 +33,11 @@ class HPMPrivate;
  * deviceAdded() or deviceRemoved() signal, depending on which event has occurred.
  * This info can then be used by plugins to see if they need to update their
  * own device lists.
+ *
+ * Listeners implementing slotDeviceAdded(uint,uint,QString) and
+ * slotDeviceRemoved(uint,uint,QString) also receive the system path of the
+ * device, so that they can add or remove only the affected device instead
+ * of enumerating all of them again. The other listeners get the VID/PID only.
  */
 class HotPlugMonitor : public QObject
 {
@@ -40,7 +46,8 @@ class HotPlugMonitor : public QObject
     friend class HPMPrivate;
 
 public:
-    /** Connect $listener to receive deviceAdded() and deviceRemoved() signals */
+    /** Connect $listener to receive deviceAdded() and deviceRemoved() signals,
+     *  with or without the device path depending on the slots it implements */
     static void connectListener(QObject* listener);
 
 #if defined(WIN32) || defined(Q_OS_WIN)
@@ -58,6 +65,17 @@ signals:
     /** Emitted when a device with a specific VID/PID has been removed from the system. */
     void deviceRemoved(uint vid, uint pid);
 
+    /**
+     * Emitted along with deviceAdded(uint,uint), with the path identifying
+     * the device on the system: the /dev/bus/usb node on Linux (matching the
+     * libusb bus and device numbers), the USB location ID on macOS and the
+     * device interface name on Windows. $path may be empty if unknown.
+     */
+    void deviceAdded(uint vid, uint pid, const QString& path);
+
+    /** Emitted along with deviceRemoved(uint,uint), with the device path */
+    void deviceRemoved(uint vid, uint pid, const QString& path);
+
 private slots:
     /** Start receiving notifications. */
     void start();
@@ -69,8 +87,8 @@ private:
     HotPlugMonitor(QObject* parent);
     static HotPlugMonitor* instance();
 
-    void emitDeviceAdded(uint vid, uint pid);
-    void emitDeviceRemoved(uint vid, uint pid);
+    void emitDeviceAdded(uint vid, uint pid, const QString& path = QString());
+    void emitDeviceRemoved(uint vid, uint pid, const QString& path = QString());
 
 private:
     HPMPrivate* d_ptr;
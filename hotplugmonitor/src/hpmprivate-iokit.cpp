@@ -83,6 +83,21 @@ void HPMPrivate::extractVidPid(io_service_t usbDevice, UInt16* vid, UInt16* pid)
     CFRelease(number);
 }
 
+QString HPMPrivate::extractLocation(io_service_t usbDevice)
+{
+    UInt32 location = 0;
+
+    CFNumberRef number = (CFNumberRef) IORegistryEntryCreateCFProperty(usbDevice, CFSTR(kUSBDevicePropertyLocationID),
+                                                                       kCFAllocatorDefault, 0);
+    if (number == NULL)
+        return QString();
+
+    CFNumberGetValue(number, kCFNumberSInt32Type, &location);
+    CFRelease(number);
+
+    return QString("0x%1").arg(location, 8, 16, QChar('0'));
+}
+
 void HPMPrivate::deviceAdded(io_iterator_t iterator)
 {
     io_service_t usbDevice;
@@ -92,7 +107,7 @@ void HPMPrivate::deviceAdded(io_iterator_t iterator)
         extractVidPid(usbDevice, &vid, &pid);
         HotPlugMonitor* hpm = qobject_cast<HotPlugMonitor*> (parent());
         Q_ASSERT(hpm != NULL);
-        hpm->emitDeviceAdded(vid, pid);
+        hpm->emitDeviceAdded(vid, pid, extractLocation(usbDevice));
         IOObjectRelease(usbDevice);
     }
 }
@@ -106,7 +121,7 @@ void HPMPrivate::deviceRemoved(io_iterator_t iterator)
         extractVidPid(usbDevice, &vid, &pid);
         HotPlugMonitor* hpm = qobject_cast<HotPlugMonitor*> (parent());
         Q_ASSERT(hpm != NULL);
-        hpm->emitDeviceRemoved(vid, pid);
+        hpm->emitDeviceRemoved(vid, pid, extractLocation(usbDevice));
         IOObjectRelease(usbDevice);
     }
 }
@@ -45,6 +45,7 @@ public slots:
 
 private:
     void extractVidPid(io_service_t usbDevice, UInt16* vid, UInt16* pid);
+    QString extractLocation(io_service_t usbDevice);
     void deviceAdded(io_iterator_t iterator);
     void deviceRemoved(io_iterator_t iterator);
     void run();
@@ -110,6 +110,10 @@ void HPMPrivate::run()
                 QString action = QString(udev_device_get_action(dev));
                 QString vendor = QString(udev_device_get_property_value(dev, PROPERTY_VID));
                 QString product = QString(udev_device_get_property_value(dev, PROPERTY_PID));
+                // the /dev/bus/usb/BBB/DDD node, or the sysfs path if there is none
+                QString path = QString(udev_device_get_devnode(dev));
+                if (path.isEmpty())
+                    path = QString(udev_device_get_syspath(dev));
 
                 // fallback to composite PRODUCT property VID/PID/REV
                 if (vendor.isEmpty() && product.isEmpty())
@@ -133,7 +137,7 @@ void HPMPrivate::run()
                     uint pid = product.toUInt(0, 16);
                     HotPlugMonitor* hpm = qobject_cast<HotPlugMonitor*> (parent());
                     Q_ASSERT(hpm != NULL);
-                    hpm->emitDeviceAdded(vid, pid);
+                    hpm->emitDeviceAdded(vid, pid, path);
                 }
                 else if (action == QString(DEVICE_ACTION_REMOVE))
                 {
@@ -141,7 +145,7 @@ void HPMPrivate::run()
                     uint pid = product.toUInt(0, 16);
                     HotPlugMonitor* hpm = qobject_cast<HotPlugMonitor*> (parent());
                     Q_ASSERT(hpm != NULL);
-                    hpm->emitDeviceRemoved(vid, pid);
+                    hpm->emitDeviceRemoved(vid, pid, path);
                 }
                 else
                 {
@@ -150,7 +150,7 @@ bool HPMPrivate::processWinEvent(MSG* message, long* RESULT)
                 // Emit only raw USB devices
                 uint vid = 0, pid = 0;
                 if (extractVidPid(dbcc_name, &vid, &pid) == true)
-                    m_hpm->emitDeviceAdded(vid, pid);
+                    m_hpm->emitDeviceAdded(vid, pid, dbcc_name);
             }
         }
     }
@@ -167,7 +167,7 @@ bool HPMPrivate::processWinEvent(MSG* message, long* RESULT)
                 // Emit only raw USB devices
                 uint vid = 0, pid = 0;
                 if (extractVidPid(dbccName, &vid, &pid) == true)
-                    m_hpm->emitDeviceRemoved(vid, pid);
+                    m_hpm->emitDeviceRemoved(vid, pid, dbccName);
             }
         }
     }
@@ -35,6 +35,12 @@
 #include "qlci18n.h"
 #include "qlcfile.h"
 
+#include "qlcfixturedefcache.h"
+#include "qlcmodifierscache.h"
+#include "rgbscriptscache.h"
+#include "offlinerenderer.h"
+#include "enginelog.h"
+
 #if defined(WIN32) || defined(__APPLE__)
   #include "debugbox.h"
 #endif
@@ -94,6 +100,21 @@ namespace QLCArgs
     /** If not null, defines the place for a close button that in virtual console */
     QRect closeButtonRect = QRect();
 
+    /** The name or ID of a function to render offline, without the GUI */
+    QString renderFunction;
+
+    /** The time to render in milliseconds, 0 to render until the function stops */
+    quint32 renderDuration = 0;
+
+    /** The DMX recording file to render into. If empty, the output is discarded */
+    QString renderOutput;
+
+    /** The file to write the frame checksums of the render to */
+    QString renderChecksums;
+
+    /** The golden checksums file to compare the render against */
+    QString renderGolden;
+
     /** Debug output level */
     QtMsgType debugLevel = QtSystemMsg;
 
@@ -193,6 +214,11 @@ void printUsage()
     cout << "  -n or --nogui\t\t\tStart the application with the GUI hidden (requires --nowm)" << endl;
     cout << "  -o or --open <file>\t\tOpen the specified workspace file" << endl;
     cout << "  -p or --operate\t\tStart in operate mode" << endl;
+    cout << "  --render <function>\t\tRender the function (name or ID) of the workspace opened with -o as fast as possible, then quit" << endl;
+    cout << "  --render-duration <ms>\tSet the time to render (default: until the function stops)" << endl;
+    cout << "  --render-output <file>\tWrite the rendered output to a DMX recording file" << endl;
+    cout << "  --render-checksums <file>\tWrite the checksums of the rendered frames to file" << endl;
+    cout << "  --render-golden <file>\tCompare the checksums of the rendered frames with a golden file" << endl;
     cout << "  -v or --version\t\tPrint version information" << endl;
     cout << "  -w or --web\t\t\tEnable remote web access" << endl;
     cout << "  -wp or --web-port <port>\t\tSet the port to use for web access" << endl;
@@ -283,6 +309,31 @@ bool parseArgs()
         {
             QLCArgs::operate = true;
         }
+        else if (arg == "--render")
+        {
+            if (it.hasNext() == true)
+                QLCArgs::renderFunction = it.next();
+        }
+        else if (arg == "--render-duration")
+        {
+            if (it.hasNext() == true)
+                QLCArgs::renderDuration = it.next().toUInt();
+        }
+        else if (arg == "--render-output")
+        {
+            if (it.hasNext() == true)
+                QLCArgs::renderOutput = it.next();
+        }
+        else if (arg == "--render-checksums")
+        {
+            if (it.hasNext() == true)
+                QLCArgs::renderChecksums = it.next();
+        }
+        else if (arg == "--render-golden")
+        {
+            if (it.hasNext() == true)
+                QLCArgs::renderGolden = it.next();
+        }
         else if (arg == "-w" || arg == "--web")
         {
             QLCArgs::enableWebAccess = true;
@@ -314,6 +365,103 @@ bool parseArgs()
     return true;
 }
 
+/**
+ * Check if an offline render is requested, before creating the application
+ * object, since a render doesn't need a display
+ */
+bool renderRequested(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (qstrcmp(argv[i], "--render") == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Render a function of the workspace in virtual time, without the GUI
+ * and the plugins
+ *
+ * @return the application exit code
+ */
+int renderWorkspace()
+{
+    QTextStream cout(stdout, QIODevice::WriteOnly);
+
+    if (QLCArgs::workspace.isEmpty() == true)
+    {
+        cout << "A workspace to render must be opened with -o" << endl;
+        return 1;
+    }
+
+    Doc doc(NULL);
+
+    doc.fixtureDefCache()->setIndexFile(QLCFixtureDefCache::defaultIndexFile());
+    doc.fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
+    doc.fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
+    doc.modifiersCache()->load(QLCModifiersCache::systemTemplateDirectory(), true);
+    doc.modifiersCache()->load(QLCModifiersCache::userTemplateDirectory());
+    doc.rgbScriptsCache()->load(RGBScriptsCache::systemScriptsDirectory());
+    doc.rgbScriptsCache()->load(RGBScriptsCache::userScriptsDirectory());
+
+    OfflineRenderer renderer(&doc);
+    if (renderer.loadWorkspace(QLCArgs::workspace) == false)
+    {
+        cout << "Unable to load " << QLCArgs::workspace << endl;
+        return 1;
+    }
+
+    bool isID = false;
+    quint32 functionID = QLCArgs::renderFunction.toUInt(&isID);
+    if (isID == false || doc.function(functionID) == NULL)
+    {
+        functionID = Function::invalidId();
+        foreach (Function *function, doc.functions())
+        {
+            if (function->name() == QLCArgs::renderFunction)
+            {
+                functionID = function->id();
+                break;
+            }
+        }
+    }
+
+    renderer.setChecksumsEnabled(QLCArgs::renderChecksums.isEmpty() == false ||
+                                 QLCArgs::renderGolden.isEmpty() == false);
+
+    if (renderer.render(functionID, QLCArgs::renderDuration, QLCArgs::renderOutput) == false)
+    {
+        cout << "Unable to render " << QLCArgs::renderFunction << endl;
+        return 1;
+    }
+
+    cout << "Rendered " << renderer.renderedTime() << " ms in " << renderer.elapsed() << " ms: ";
+    cout << renderer.ticks() << " ticks, " << renderer.frames() << " frames, ";
+    cout << qRound(renderer.ticksPerSecond()) << " ticks/s" << endl;
+
+    if (QLCArgs::renderChecksums.isEmpty() == false &&
+        renderer.saveChecksums(QLCArgs::renderChecksums) == false)
+    {
+        cout << "Unable to write " << QLCArgs::renderChecksums << endl;
+        return 1;
+    }
+
+    if (QLCArgs::renderGolden.isEmpty() == false)
+    {
+        int tick = renderer.compareChecksums(QLCArgs::renderGolden);
+        if (tick >= 0)
+        {
+            cout << "Output differs from " << QLCArgs::renderGolden << " at tick " << tick << endl;
+            return 1;
+        }
+        cout << "Output matches " << QLCArgs::renderGolden << endl;
+    }
+
+    return 0;
+}
+
 /**
  * THE entry point for the application
  *
@@ -322,6 +470,23 @@ bool parseArgs()
  */
 int main(int argc, char** argv)
 {
+    if (renderRequested(argc, argv) == true)
+    {
+        QCoreApplication qapp(argc, argv);
+
+        printVersion();
+
+        if (parseArgs() == false)
+            return 0;
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+        qInstallMsgHandler(qlcMessageHandler);
+#else
+        EngineLog::start(qlcMessageHandler);
+#endif
+        return renderWorkspace();
+    }
+
     /* Create the Qt core application object */
     QApplication qapp(argc, argv);
 
@@ -348,11 +513,12 @@ int main(int argc, char** argv)
     /* Load translation for main application */
     QLCi18n::loadTranslation("qlcplus");
 
-    /* Handle debug messages */
+    /* Handle debug messages. They are written by a background thread,
+     * so that the threads logging them never wait for the output */
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
     qInstallMsgHandler(qlcMessageHandler);
 #else
-    qInstallMessageHandler(qlcMessageHandler);
+    EngineLog::start(qlcMessageHandler);
 #endif
 
     /* Create and initialize the QLC application object */
@@ -369,6 +535,7 @@ int main(int argc, char** argv)
 
     app.startup();
     app.show();
+    app.enableTraceSignal();
 
     if (QLCArgs::workspace.isEmpty() == false)
     {
@@ -391,8 +558,8 @@ int main(int argc, char** argv)
 
         QObject::connect(webAccess, SIGNAL(toggleDocMode()),
                 &app, SLOT(slotModeToggle()));
-        QObject::connect(webAccess, SIGNAL(loadProject(QString)),
-                &app, SLOT(slotLoadDocFromMemory(QString)));
+        QObject::connect(webAccess, SIGNAL(loadProjectFile(QString)),
+                &app, SLOT(slotLoadDocFromFile(QString)), Qt::QueuedConnection);
         QObject::connect(webAccess, SIGNAL(storeAutostartProject(QString)),
                 &app, SLOT(slotSaveAutostart(QString)));
     }
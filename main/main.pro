@@ -6,6 +6,7 @@ TARGET   = qlcplus
 
 INCLUDEPATH  += ../ui/src ../ui/src/virtualconsole
 INCLUDEPATH  += ../engine/src
+INCLUDEPATH  += ../plugins/interfaces
 INCLUDEPATH  += ../webaccess/src
 
 QMAKE_LIBDIR += ../ui/src
@@ -102,6 +102,7 @@ desktop-file-validate %{buildroot}/%{_datadir}/applications/*.desktop
 %_libdir/qt5/plugins/qlcplus/libos2l.so
 %_libdir/qt5/plugins/qlcplus/libosc.so
 %_libdir/qt5/plugins/qlcplus/libpeperoni.so
+%_libdir/qt5/plugins/qlcplus/libsharedmemory.so
 %_libdir/qt5/plugins/qlcplus/libspi.so
 %_libdir/qt5/plugins/qlcplus/libudmx.so
 %_mandir/*/*
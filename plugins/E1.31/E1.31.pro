@@ -31,7 +31,10 @@ TRANSLATIONS += E131_pt_BR.ts
 TRANSLATIONS += E131_ca_ES.ts
 TRANSLATIONS += E131_ja_JP.ts
 
-HEADERS += ../interfaces/qlcioplugin.h
+HEADERS += ../interfaces/qlcioplugin.h \
+           ../interfaces/qlcinputthread.h \
+           ../interfaces/qlcloglimiter.h \
+           ../interfaces/qlcudpbatch.h
 HEADERS += e131packetizer.h \
            e131controller.h \
            e131plugin.h \
@@ -39,7 +42,9 @@ HEADERS += e131packetizer.h \
 
 FORMS += configuree131.ui
 
-SOURCES += ../interfaces/qlcioplugin.cpp
+SOURCES += ../interfaces/qlcioplugin.cpp \
+           ../interfaces/qlcinputthread.cpp \
+           ../interfaces/qlcudpbatch.cpp
 SOURCES += e131packetizer.cpp \
            e131controller.cpp \
            e131plugin.cpp \
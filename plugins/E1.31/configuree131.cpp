@@ -39,6 +39,7 @@
 #define KMapColumnE131Uni       5
 #define KMapColumnTransmitMode  6
 #define KMapColumnPriority      7
+#define KMapColumnSyncAddress   8
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -46,6 +47,7 @@
 
 #define E131_PRIORITY_MIN 0
 #define E131_PRIORITY_MAX 200
+#define E131_SYNC_ADDRESS_MAX 63999
 
 /*****************************************************************************
  * Initialization
@@ -60,6 +62,8 @@ ConfigureE131::ConfigureE131(E131Plugin* plugin, QWidget* parent)
     /* Setup UI controls */
     setupUi(this);
 
+    m_pacingSpin->setValue(m_plugin->transmitPacing());
+
     fillMappingTree();
 }
 
@@ -184,6 +188,13 @@ void ConfigureE131::fillMappingTree()
                 prioritySpin->setValue(info->outputPriority);
                 prioritySpin->setToolTip(tr("%1 - min, %2 - default, %3 - max").arg(E131_PRIORITY_MIN).arg(E131_PRIORITY_DEFAULT).arg(E131_PRIORITY_MAX));
                 m_uniMapTree->setItemWidget(item, KMapColumnPriority, prioritySpin);
+
+                QSpinBox *syncSpin = new QSpinBox(this);
+                syncSpin->setRange(0, E131_SYNC_ADDRESS_MAX);
+                syncSpin->setValue(info->outputSyncAddress);
+                syncSpin->setSpecialValueText(tr("None"));
+                syncSpin->setToolTip(tr("The E1.31 universe used to synchronize the output. %1 - disabled").arg(0));
+                m_uniMapTree->setItemWidget(item, KMapColumnSyncAddress, syncSpin);
             }
         }
     }
@@ -388,10 +399,17 @@ void ConfigureE131::accept()
                 QSpinBox* prioSpin = qobject_cast<QSpinBox*>(m_uniMapTree->itemWidget(item, KMapColumnPriority));
                 m_plugin->setParameter(universe, line, QLCIOPlugin::Output,
                         E131_PRIORITY, prioSpin->value());
+
+                QSpinBox* syncSpin = qobject_cast<QSpinBox*>(m_uniMapTree->itemWidget(item, KMapColumnSyncAddress));
+                m_plugin->setParameter(universe, line, QLCIOPlugin::Output,
+                        E131_SYNCADDRESS, syncSpin->value());
             }
         }
     }
 
+    if (m_pacingSpin->value() != m_plugin->transmitPacing())
+        m_plugin->setTransmitPacing(m_pacingSpin->value());
+
     QDialog::accept();
 }
 
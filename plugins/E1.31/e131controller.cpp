@@ -18,6 +18,7 @@
 */
 
 #include "e131controller.h"
+#include "qlcioplugin.h"
 
 #include <QMutexLocker>
 #include <QDebug>
@@ -37,6 +38,7 @@ E131Controller::E131Controller(QNetworkInterface const& interface, QNetworkAddre
     , m_packetizer(new E131Packetizer(interface.hardwareAddress()))
 {
     qDebug() << Q_FUNC_INFO;
+    m_sourceClock.start();
     m_UdpSocket->bind(m_ipAddr, 0);
     // Output multicast on the correct interface
     m_UdpSocket->setMulticastInterface(m_interface);
@@ -47,6 +49,17 @@ E131Controller::E131Controller(QNetworkInterface const& interface, QNetworkAddre
 E131Controller::~E131Controller()
 {
     qDebug() << Q_FUNC_INFO;
+
+    // release the input sockets and wait for
+    // the input thread to stop using them
+    {
+        QMutexLocker locker(&m_dataMutex);
+        for (QMap<quint32, UniverseInfo>::iterator it = m_universeMap.begin(); it != m_universeMap.end(); ++it)
+            it.value().inputSocket.clear();
+    }
+    m_inputThread.quit();
+    m_inputThread.wait();
+
     qDeleteAll(m_dmxValuesMap);
 }
 
@@ -58,6 +71,7 @@ QString E131Controller::getNetworkIP()
 void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
 {
     qDebug() << "[E1.31] addUniverse - universe" << universe << ", type" << type;
+    QMutexLocker locker(&m_dataMutex);
     if (m_universeMap.contains(universe))
     {
         m_universeMap[universe].type |= (int)type;
@@ -80,6 +94,7 @@ void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
         info.outputUniverse = universe + 1;
         info.outputTransmissionMode = Full;
         info.outputPriority = E131_PRIORITY_DEFAULT;
+        info.outputSyncAddress = 0;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -94,11 +109,17 @@ void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
 
 void E131Controller::removeUniverse(quint32 universe, E131Controller::Type type)
 {
+    QMutexLocker locker(&m_dataMutex);
     if (m_universeMap.contains(universe))
     {
         UniverseInfo& info = m_universeMap[universe];
         if (type == Input)
+        {
             info.inputSocket.clear();
+            m_inputSources.remove(universe);
+        }
+        if (type == Output)
+            m_dmxPackets.remove(universe);
 
         if (info.type == type)
             m_universeMap.take(universe);
@@ -139,7 +160,8 @@ QSharedPointer<QUdpSocket> E131Controller::getInputSocket(bool multicast, QHostA
         }
     }
 
-    QSharedPointer<QUdpSocket> inputSocket(new QUdpSocket(this));
+    // received packets are handled in the input thread
+    QSharedPointer<QUdpSocket> inputSocket = m_inputThread.adopt(new QUdpSocket());
 
     if (multicast)
     {
@@ -156,7 +178,7 @@ QSharedPointer<QUdpSocket> E131Controller::getInputSocket(bool multicast, QHostA
     }
 
     connect(inputSocket.data(), SIGNAL(readyRead()),
-            this, SLOT(processPendingPackets()));
+            this, SLOT(processPendingPackets()), Qt::DirectConnection);
 
     return inputSocket;
 }
@@ -267,6 +289,15 @@ void E131Controller::setOutputPriority(quint32 universe, quint32 e131Priority)
     m_universeMap[universe].outputPriority = e131Priority;
 }
 
+void E131Controller::setOutputSyncAddress(quint32 universe, quint16 syncAddress)
+{
+    if (m_universeMap.contains(universe) == false)
+        return;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputSyncAddress = syncAddress;
+}
+
 void E131Controller::setOutputTransmissionMode(quint32 universe, E131Controller::TransmissionMode mode)
 {
     if (m_universeMap.contains(universe) == false)
@@ -340,16 +371,19 @@ quint64 E131Controller::getPacketReceivedNumber()
 void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
 {
     QMutexLocker locker(&m_dataMutex);
-    QByteArray dmxPacket;
+    QByteArray &dmxPacket = m_dmxPackets[universe];
     QHostAddress outAddress = QHostAddress(QString("239.255.0.%1").arg(universe + 1));
     quint16 outPort = E131_DEFAULT_PORT;
     quint32 outUniverse = universe;
     quint32 outPriority = E131_PRIORITY_DEFAULT;
+    quint16 syncAddress = 0;
+    bool multicast = true;
     TransmissionMode transmitMode = Full;
 
     if (m_universeMap.contains(universe))
     {
         UniverseInfo const& info = m_universeMap[universe];
+        multicast = info.outputMulticast;
         if (info.outputMulticast)
         {
             outAddress = info.outputMcastAddress;
@@ -361,37 +395,81 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
         }
         outUniverse = info.outputUniverse;
         outPriority = info.outputPriority;
+        syncAddress = info.outputSyncAddress;
         transmitMode = TransmissionMode(info.outputTransmissionMode);
     }
     else
         qWarning() << Q_FUNC_INFO << "universe" << universe << "unknown";
 
-    if (transmitMode == Full)
+    m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, data,
+                               transmitMode == Full, syncAddress);
+
+    m_packetSent += m_batch.queue(m_UdpSocket.data(), dmxPacket, outAddress, outPort);
+
+    if (syncAddress != 0)
     {
-        QByteArray wholeuniverse(512, 0);
-        wholeuniverse.replace(0, data.length(), data);
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, wholeuniverse);
+        // multicast sync packets go to the group of the sync address,
+        // unicast ones to the receiver of the universe
+        E131SyncTarget target;
+        target.syncAddress = syncAddress;
+        target.address = multicast ? QHostAddress(quint32(0xEFFF0000) | syncAddress) : outAddress;
+        target.port = outPort;
+        if (m_syncTargets.contains(target) == false)
+            m_syncTargets.append(target);
     }
-    else
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, data);
+}
+
+void E131Controller::flushFrame()
+{
+    QMutexLocker locker(&m_dataMutex);
 
-    qint64 sent = m_UdpSocket->writeDatagram(dmxPacket.data(), dmxPacket.size(),
-                                             outAddress, outPort);
-    if (sent < 0)
+    if (m_syncTargets.isEmpty() == false)
     {
-        qDebug() << "sendDmx failed";
-        qDebug() << "Errno: " << m_UdpSocket->error();
-        qDebug() << "Errmsg: " << m_UdpSocket->errorString();
+        // sync packets follow the data in the same batch, so they are
+        // sent only once every universe of the frame has been sent
+        QList<quint16> prepared;
+        foreach (E131SyncTarget const& target, m_syncTargets)
+        {
+            // every receiver of a sync address gets the same sequence number
+            QByteArray &syncPacket = m_syncPackets[target.syncAddress];
+            if (prepared.contains(target.syncAddress) == false)
+            {
+                m_packetizer->setupE131Sync(syncPacket, target.syncAddress);
+                prepared.append(target.syncAddress);
+            }
+            m_packetSent += m_batch.queue(m_UdpSocket.data(), syncPacket, target.address, target.port, false);
+        }
+        m_syncTargets.clear();
     }
-    else
-        m_packetSent++;
+
+    m_packetSent += m_batch.flush();
+}
+
+void E131Controller::setTransmitPacing(int percent)
+{
+    QMutexLocker locker(&m_dataMutex);
+    m_batch.setPacing(percent);
 }
 
 void E131Controller::processPendingPackets()
 {
-    QUdpSocket* socket = qobject_cast<QUdpSocket*>(sender());
-    Q_ASSERT(socket != NULL);
+    // this runs in the input thread, where sender() cannot be used,
+    // so every input socket is checked for pending packets
+    QMutexLocker locker(&m_dataMutex);
+    QList<QUdpSocket*> sockets;
+
+    foreach (UniverseInfo const& info, m_universeMap)
+    {
+        if (info.inputSocket && sockets.contains(info.inputSocket.data()) == false)
+            sockets.append(info.inputSocket.data());
+    }
 
+    foreach (QUdpSocket *socket, sockets)
+        readPendingPackets(socket);
+}
+
+void E131Controller::readPendingPackets(QUdpSocket *socket)
+{
     while (socket->hasPendingDatagrams())
     {
         QByteArray datagram;
@@ -401,8 +479,12 @@ void E131Controller::processPendingPackets()
 
         QByteArray dmxData;
         quint32 e131universe;
+        QByteArray cid;
+        int priority;
+        bool terminated;
         if (m_packetizer->checkPacket(datagram)
-                && m_packetizer->fillDMXdata(datagram, dmxData, e131universe))
+                && m_packetizer->fillDMXdata(datagram, dmxData, e131universe)
+                && m_packetizer->fillSourceInfo(datagram, cid, priority, terminated))
         {
             qDebug() << "Received packet with size: " << datagram.size() << ", from: " << senderAddress.toString()
                 << ", for E1.31 universe: " << e131universe;
@@ -414,19 +496,18 @@ void E131Controller::processPendingPackets()
                 UniverseInfo const& info = it.value();
                 if (info.inputSocket == socket && info.inputUniverse == e131universe)
                 {
+                    QByteArray merged = mergeInputSources(universe, cid, priority, terminated, dmxData);
+                    if (merged.isEmpty())
+                        continue;
+
                     QByteArray *dmxValues;
                     if (m_dmxValuesMap.contains(universe) == false)
                         m_dmxValuesMap[universe] = new QByteArray(512, 0);
                     dmxValues = m_dmxValuesMap[universe];
 
-                    for (int i = 0; i < dmxData.length(); i++)
-                    {
-                        if (dmxValues->at(i) != dmxData.at(i))
-                        {
-                            dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
-                            emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
-                        }
-                    }
+                    QByteArray changed;
+                    if (QLCIOPlugin::updateInputValues(*dmxValues, merged, changed))
+                        emit universeChanged(universe, m_line, *dmxValues, changed);
                 }
             }
         }
@@ -437,3 +518,77 @@ void E131Controller::processPendingPackets()
         }
     }
 }
+
+QByteArray E131Controller::mergeInputSources(quint32 universe, QByteArray const& cid, int priority,
+                                             bool terminated, QByteArray const& dmxData)
+{
+    QHash<QByteArray, E131InputSource> &sources = m_inputSources[universe];
+    qint64 now = m_sourceClock.elapsed();
+
+    if (terminated)
+    {
+        sources.remove(cid);
+    }
+    else
+    {
+        E131InputSource &source = sources[cid];
+        source.values = dmxData;
+        source.priority = priority;
+        source.lastSeen = now;
+    }
+
+    // forget the sources which stopped sending
+    bool removed = terminated;
+    int maxPriority = -1;
+    QMutableHashIterator<QByteArray, E131InputSource> it(sources);
+    while (it.hasNext())
+    {
+        it.next();
+        if (now - it.value().lastSeen > E131_SOURCE_TIMEOUT)
+        {
+            it.remove();
+            removed = true;
+        }
+        else if (it.value().priority > maxPriority)
+            maxPriority = it.value().priority;
+    }
+
+    // a single source is output as it is, which is the common case
+    if (sources.count() == 1)
+        return sources.begin().value().values;
+
+    // when no source is left, the last values are held
+    if (sources.isEmpty())
+        return QByteArray();
+
+    // a source with a lower priority than the others
+    // cannot change the output, unless one has gone
+    if (removed == false && priority < maxPriority)
+        return QByteArray();
+
+    QByteArray merged;
+    foreach (E131InputSource const& source, sources)
+    {
+        if (source.priority != maxPriority)
+            continue;
+
+        if (merged.isEmpty())
+        {
+            merged = source.values;
+            continue;
+        }
+
+        if (merged.size() < source.values.size())
+            merged.append(QByteArray(source.values.size() - merged.size(), char(0)));
+
+        uchar *out = reinterpret_cast<uchar *>(merged.data());
+        const uchar *in = reinterpret_cast<const uchar *>(source.values.constData());
+        for (int i = 0; i < source.values.size(); i++)
+        {
+            if (in[i] > out[i])
+                out[i] = in[i];
+        }
+    }
+
+    return merged;
+}
@@ -22,6 +22,7 @@
 
 #if defined(ANDROID)
 #include <QNetworkInterface>
+#include <QElapsedTimer>
 #include <QScopedPointer>
 #include <QSharedPointer>
 #include <QHostAddress>
@@ -33,6 +34,8 @@
 #include <QTimer>
 
 #include "e131packetizer.h"
+#include "qlcinputthread.h"
+#include "qlcudpbatch.h"
 
 #define E131_DEFAULT_PORT     5568
 
@@ -51,10 +54,35 @@ typedef struct
     quint16 outputUniverse;
     int outputTransmissionMode;
     int outputPriority;
+    quint16 outputSyncAddress;
 
     int type;
 } UniverseInfo;
 
+/** A source sending an input universe */
+typedef struct
+{
+    QByteArray values;
+    int priority;
+    qint64 lastSeen;
+} E131InputSource;
+
+/** Time in milliseconds after which a silent source is forgotten */
+#define E131_SOURCE_TIMEOUT 2500
+
+/** A destination of the synchronization packets of a frame */
+typedef struct E131SyncTarget
+{
+    quint16 syncAddress;
+    QHostAddress address;
+    quint16 port;
+
+    bool operator==(const E131SyncTarget& other) const
+    {
+        return syncAddress == other.syncAddress && address == other.address && port == other.port;
+    }
+} E131SyncTarget;
+
 class E131Controller : public QObject
 {
     Q_OBJECT
@@ -73,9 +101,18 @@ public:
 
     ~E131Controller();
 
-    /** Send DMX data to a specific port/universe */
+    /** Queue DMX data for a specific port/universe. The data is sent
+     *  with the rest of the frame by flushFrame() */
     void sendDmx(const quint32 universe, const QByteArray& data);
 
+    /** Send the packets queued during the frame, followed by a
+     *  synchronization packet for each sync address used in the frame */
+    void flushFrame();
+
+    /** Spread the packets of a frame over $percent of the frame interval.
+     *  0 sends them all at once. See QLCUdpBatch::setPacing() */
+    void setTransmitPacing(int percent);
+
     /** Return the controller IP address */
     QString getNetworkIP();
 
@@ -115,6 +152,12 @@ public:
     /** Set a specific E1.31 output priority for the given QLC+ universe */
     void setOutputPriority(quint32 universe, quint32 e131Priority);
 
+    /** Set the E1.31 universe used to synchronize the output of the given
+     *  QLC+ universe. When not 0, the receivers hold the data until the
+     *  synchronization packet sent once the whole frame has been sent.
+     *  0 disables synchronization */
+    void setOutputSyncAddress(quint32 universe, quint16 syncAddress);
+
     /** Set the transmission mode of the ArtNet DMX packets over the network.
      *  It can be 'Full', which transmits always 512 channels, or
      *  'Partial', which transmits only the channels actually used in a
@@ -147,8 +190,27 @@ public:
     quint64 getPacketReceivedNumber();
 
 private:
+    /** Return an input socket for the given parameters, reusing the one
+     *  of another universe when possible. Must be called with m_dataMutex locked */
     QSharedPointer<QUdpSocket> getInputSocket(bool multicast, QHostAddress const& address, quint16 port);
 
+    /** Read and handle the packets received by $socket.
+     *  Must be called with m_dataMutex locked */
+    void readPendingPackets(QUdpSocket *socket);
+
+    /**
+     * Store the values of a packet received from the source $cid for
+     * $universe, forget the sources timed out and merge the values of the
+     * remaining ones: the sources with the highest priority are merged
+     * in HTP, the others are ignored.
+     * Must be called with m_dataMutex locked.
+     *
+     * @return The merged values, or an empty array when this packet
+     *         does not change them
+     */
+    QByteArray mergeInputSources(quint32 universe, QByteArray const& cid, int priority,
+                                 bool terminated, QByteArray const& dmxData);
+
 private:
     /** The network interface associated to this controller */
     QNetworkInterface m_interface;
@@ -167,10 +229,31 @@ private:
     /** Helper class used to create or parse E131 packets */
     QScopedPointer<E131Packetizer> m_packetizer;
 
+    /** The packets of the current frame, sent at once by flushFrame() */
+    QLCUdpBatch m_batch;
+
+    /** The DMX packet of each output universe, rewritten in place
+     *  at every transmission */
+    QHash<quint32, QByteArray> m_dmxPackets;
+
+    /** The synchronization packet of each sync address, and the
+     *  destinations they must be sent to at the end of the current frame */
+    QHash<quint16, QByteArray> m_syncPackets;
+    QList<E131SyncTarget> m_syncTargets;
+
     /** Keeps the current dmx values to send only the ones that changed */
     /** It holds values for all the handled universes */
     QMap<quint32, QByteArray*> m_dmxValuesMap;
 
+    /** The sources of each input universe, by CID, and the
+     *  clock used to detect the ones which stopped sending */
+    QHash<quint32, QHash<QByteArray, E131InputSource> > m_inputSources;
+    QElapsedTimer m_sourceClock;
+
+    /** The thread handling the input sockets. It must be destroyed
+     *  after m_universeMap, which holds the sockets */
+    QLCInputThread m_inputThread;
+
     /** Map of the QLC+ universes transmitted/received by this
      *  controller, with the related, specific parameters */
     QMap<quint32, UniverseInfo> m_universeMap;
@@ -180,11 +263,13 @@ private:
     QMutex m_dataMutex;
 
 private slots:
-    /** Async event raised when new packets have been received */
+    /** Async event raised in the input thread when new packets
+     *  have been received */
     void processPendingPackets();
 
 signals:
-    void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
+    void universeChanged(quint32 universe, quint32 input,
+                         const QByteArray& data, const QByteArray& changed);
 };
 
 #endif
@@ -22,6 +22,8 @@
 #include <QStringList>
 #include <QDebug>
 
+#include <string.h>
+
 E131Packetizer::E131Packetizer(QString MACaddr)
 {
     // Initialize a commond header.
@@ -150,36 +152,57 @@ E131Packetizer::~E131Packetizer()
  * Sender functions
  *********************************************************************/
 
-void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const int &priority, const QByteArray &values)
+void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const int &priority,
+                                  const QByteArray &values, bool fullUniverse, quint16 syncAddress)
 {
-    data.clear();
-    data.append(m_commonHeader);
+    int valuesLength = fullUniverse ? qMin(values.length(), E131_DMX_LENGTH) : values.length();
+    int len = fullUniverse ? E131_DMX_LENGTH : values.length();
+
+    // the header is written only when $data comes
+    // from a different universe or no packet at all
+    bool reuseHeader = data.size() >= E131_DMX_HEADER_SIZE &&
+                       data.at(113) == (char)(universe >> 8) &&
+                       data.at(114) == (char)(universe & 0x00FF);
+
+    // a resize keeps the allocated buffer, so a packet
+    // passed again is not reallocated
+    data.resize(E131_DMX_HEADER_SIZE + len);
+    char *packet = data.data();
 
-    data.append(values);
+    if (reuseHeader == false)
+    {
+        memcpy(packet, m_commonHeader.constData(), qMin(m_commonHeader.length(), E131_DMX_HEADER_SIZE));
+        packet[113] = (char)(universe >> 8);
+        packet[114] = (char)(universe & 0x00FF);
+    }
+
+    memcpy(packet + E131_DMX_HEADER_SIZE, values.constData(), valuesLength);
+    memset(packet + E131_DMX_HEADER_SIZE + valuesLength, 0, len - valuesLength);
 
     int rootLayerSize = data.count() - 16;
     int e131LayerSize = data.count() - 38;
     int dmpLayerSize = data.count() - 115;
-    int valCountPlusOne = values.count() + 1;
+    int valCountPlusOne = len + 1;
 
-    data[16] = 0x70 | (char)(rootLayerSize >> 8);
-    data[17] = (char)(rootLayerSize & 0x00FF);
+    packet[16] = 0x70 | (char)(rootLayerSize >> 8);
+    packet[17] = (char)(rootLayerSize & 0x00FF);
 
-    data[38] = 0x70 | (char)(e131LayerSize >> 8);
-    data[39] = (char)(e131LayerSize & 0x00FF);
+    packet[38] = 0x70 | (char)(e131LayerSize >> 8);
+    packet[39] = (char)(e131LayerSize & 0x00FF);
 
-    data[108] = (char) priority;
+    packet[108] = (char) priority;
 
-    data[111] = m_sequence[universe];
+    // Synchronization Address (bytes 109-110)
+    packet[109] = (char)(syncAddress >> 8);
+    packet[110] = (char)(syncAddress & 0x00FF);
 
-    data[113] = (char)(universe >> 8);
-    data[114] = (char)(universe & 0x00FF);
+    packet[111] = m_sequence[universe];
 
-    data[115] = 0x70 | (char)(dmpLayerSize >> 8);
-    data[116] = (char)(dmpLayerSize & 0x00FF);
+    packet[115] = 0x70 | (char)(dmpLayerSize >> 8);
+    packet[116] = (char)(dmpLayerSize & 0x00FF);
 
-    data[123] = (char)(valCountPlusOne >> 8);
-    data[124] = (char)(valCountPlusOne & 0x00FF);
+    packet[123] = (char)(valCountPlusOne >> 8);
+    packet[124] = (char)(valCountPlusOne & 0x00FF);
 
     if (m_sequence[universe] == 0xff)
         m_sequence[universe] = 1;
@@ -187,6 +210,65 @@ void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const i
         m_sequence[universe]++;
 }
 
+void E131Packetizer::setupE131Sync(QByteArray &data, quint16 syncAddress)
+{
+    bool reuseHeader = data.size() == E131_SYNC_SIZE &&
+                       data.at(45) == (char)(syncAddress >> 8) &&
+                       data.at(46) == (char)(syncAddress & 0x00FF);
+
+    if (m_syncSequence.contains(syncAddress) == false)
+        m_syncSequence[syncAddress] = 1;
+
+    if (reuseHeader)
+    {
+        data[44] = m_syncSequence[syncAddress];
+        incrementSyncSequence(syncAddress);
+        return;
+    }
+
+    // the root layer is the same of a DMX packet, up to the sender's CID
+    data = m_commonHeader.left(38);
+    data.resize(E131_SYNC_SIZE);
+    char *packet = data.data();
+
+    int rootLayerSize = E131_SYNC_SIZE - 16;
+    int syncLayerSize = E131_SYNC_SIZE - 38;
+
+    packet[16] = 0x70 | (char)(rootLayerSize >> 8);
+    packet[17] = (char)(rootLayerSize & 0x00FF);
+
+    // Identifies RLP Data as extended 1.31 Protocol PDU
+    packet[21] = (char)0x08;
+
+    packet[38] = 0x70 | (char)(syncLayerSize >> 8);
+    packet[39] = (char)(syncLayerSize & 0x00FF);
+
+    // Identifies the framing layer as a Synchronization Packet
+    packet[40] = (char)0x00;
+    packet[41] = (char)0x00;
+    packet[42] = (char)0x00;
+    packet[43] = (char)0x01;
+
+    packet[44] = m_syncSequence[syncAddress];
+
+    packet[45] = (char)(syncAddress >> 8);
+    packet[46] = (char)(syncAddress & 0x00FF);
+
+    // reserved
+    packet[47] = '\0';
+    packet[48] = '\0';
+
+    incrementSyncSequence(syncAddress);
+}
+
+void E131Packetizer::incrementSyncSequence(quint16 syncAddress)
+{
+    if (m_syncSequence[syncAddress] == 0xff)
+        m_syncSequence[syncAddress] = 1;
+    else
+        m_syncSequence[syncAddress]++;
+}
+
 bool E131Packetizer::checkPacket(QByteArray &data)
 {
     /* An E1.31 packet must be at least 125 bytes long */
@@ -225,3 +307,17 @@ bool E131Packetizer::fillDMXdata(QByteArray& data, QByteArray &dmx, quint32 &uni
     dmx.append(data.mid(126, length - 1));
     return true;
 }
+
+bool E131Packetizer::fillSourceInfo(QByteArray const& data, QByteArray &cid, int &priority, bool &terminated)
+{
+    if (data.length() < 125)
+        return false;
+
+    // Sender's CID (bytes 22-37)
+    cid = data.mid(22, 16);
+    priority = (uchar)data.at(108);
+    // Options Flags: Stream_Terminated is bit 6
+    terminated = (data.at(112) & 0x40) != 0;
+
+    return true;
+}
@@ -27,6 +27,13 @@
 
 #define E131_PRIORITY_DEFAULT 100
 
+/** Size of the header of a DMX packet, up to the START code included */
+#define E131_DMX_HEADER_SIZE 126
+#define E131_DMX_LENGTH 512
+
+/** Size of a synchronization packet */
+#define E131_SYNC_SIZE 49
+
 class E131Packetizer
 {
     /*********************************************************************
@@ -41,8 +48,26 @@ public:
      * Sender functions
      *********************************************************************/
 
-    /** Prepare an E1.31 DMX packet */
-    void setupE131Dmx(QByteArray& data, const int& universe, const int& priority, const QByteArray &values);
+    /**
+     * Prepare an E1.31 DMX packet.
+     * When $data already holds a packet of the same universe, only the
+     * values, lengths, priority, sequence and sync address are written,
+     * so the same buffer can be passed at every transmission.
+     *
+     * @param fullUniverse if true, $values are padded with zeros to
+     *                     E131_DMX_LENGTH channels
+     * @param syncAddress the universe the receivers must wait a sync
+     *                    packet from before outputting the data, or 0
+     *                    to output it immediately
+     */
+    void setupE131Dmx(QByteArray& data, const int& universe, const int& priority,
+                      const QByteArray &values, bool fullUniverse = false,
+                      quint16 syncAddress = 0);
+
+    /** Prepare an E1.31 synchronization packet, telling the receivers
+     *  to output the data of the universes synchronized on $syncAddress.
+     *  As for DMX packets, a packet of the same address is updated in place */
+    void setupE131Sync(QByteArray& data, quint16 syncAddress);
 
     /*********************************************************************
      * Receiver functions
@@ -53,9 +78,18 @@ public:
 
     bool fillDMXdata(QByteArray& data, QByteArray& dmx, quint32 &universe);
 
+    /** Retrieve the source information of a DMX packet: the CID of the
+     *  sender, the data priority and whether the sender is terminating
+     *  the transmission of the universe */
+    bool fillSourceInfo(QByteArray const& data, QByteArray& cid, int& priority, bool& terminated);
+
+private:
+    void incrementSyncSequence(quint16 syncAddress);
+
 private:
     QByteArray m_commonHeader;
     QHash<int, uchar> m_sequence;
+    QHash<int, uchar> m_syncSequence;
 };
 
 #endif
@@ -25,6 +25,8 @@
 
 #define MAX_INIT_RETRY  10
 
+#define SETTINGS_TRANSMIT_PACING "E131Plugin/transmitPacing"
+
 
 bool addressCompare(const E131IO &v1, const E131IO &v2)
 {
@@ -169,12 +171,15 @@ bool E131Plugin::openOutput(quint32 output, quint32 universe)
         E131Controller *controller = new E131Controller(m_IOmapping.at(output).interface,
                                                         m_IOmapping.at(output).address,
                                                         output, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        // the input data is handled in the input thread
+        connect(controller, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                this, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                Qt::DirectConnection);
         m_IOmapping[output].controller = controller;
     }
 
     m_IOmapping[output].controller->addUniverse(universe, E131Controller::Output);
+    m_IOmapping[output].controller->setTransmitPacing(transmitPacing());
     addToMap(universe, output, Output);
 
     return true;
@@ -208,6 +213,15 @@ void E131Plugin::writeUniverse(quint32 universe, quint32 output, const QByteArra
         controller->sendDmx(universe, data);
 }
 
+void E131Plugin::frameComplete()
+{
+    foreach (E131IO line, m_IOmapping)
+    {
+        if (line.controller != NULL)
+            line.controller->flushFrame();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -239,8 +253,10 @@ bool E131Plugin::openInput(quint32 input, quint32 universe)
         E131Controller *controller = new E131Controller(m_IOmapping.at(input).interface,
                                                         m_IOmapping.at(input).address,
                                                         input, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        // the input data is handled in the input thread
+        connect(controller, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                this, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                Qt::DirectConnection);
         m_IOmapping[input].controller = controller;
     }
 
@@ -352,6 +368,8 @@ void E131Plugin::setParameter(quint32 universe, quint32 line, Capability type,
             controller->setOutputTransmissionMode(universe, E131Controller::stringToTransmissionMode(value.toString()));
         else if (name == E131_PRIORITY)
             controller->setOutputPriority(universe, value.toUInt());
+        else if (name == E131_SYNCADDRESS)
+            controller->setOutputSyncAddress(universe, value.toUInt());
         else
             qWarning() << Q_FUNC_INFO << name << "is not a valid E1.31 output parameter";
     }
@@ -359,6 +377,24 @@ void E131Plugin::setParameter(quint32 universe, quint32 line, Capability type,
     QLCIOPlugin::setParameter(universe, line, type, name, value);
 }
 
+int E131Plugin::transmitPacing() const
+{
+    QSettings settings;
+    return settings.value(SETTINGS_TRANSMIT_PACING, 0).toInt();
+}
+
+void E131Plugin::setTransmitPacing(int percent)
+{
+    QSettings settings;
+    settings.setValue(SETTINGS_TRANSMIT_PACING, percent);
+
+    foreach (E131IO line, m_IOmapping)
+    {
+        if (line.controller != NULL)
+            line.controller->setTransmitPacing(percent);
+    }
+}
+
 QList<E131IO> E131Plugin::getIOMapping()
 {
     return m_IOmapping;
@@ -44,6 +44,7 @@ typedef struct
 #define E131_UNIVERSE "universe"
 #define E131_TRANSMITMODE "transmitMode"
 #define E131_PRIORITY "priority"
+#define E131_SYNCADDRESS "syncAddress"
 
 class E131Plugin : public QLCIOPlugin
 {
@@ -95,6 +96,9 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void frameComplete();
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
@@ -124,6 +128,13 @@ public:
     /** @reimp */
     void setParameter(quint32 universe, quint32 line, Capability type, QString name, QVariant value);
 
+    /** Get the percentage of the frame interval the output packets are
+     *  spread over, 0 when they are sent at once */
+    int transmitPacing() const;
+
+    /** Set the transmission pacing of every output line */
+    void setTransmitPacing(int percent);
+
     /** Get a list of the available Input/Output lines */
     QList<E131IO> getIOMapping();
 
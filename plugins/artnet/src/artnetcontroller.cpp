@@ -18,16 +18,25 @@
 */
 
 #include "artnetcontroller.h"
+#include "qlcioplugin.h"
 
+#include <QLoggingCategory>
 #include <QMutexLocker>
 #include <QStringList>
 #include <QDebug>
 
+#include "qlcloglimiter.h"
+
+Q_LOGGING_CATEGORY(lcArtNet, "qlcplus.plugins.artnet")
+
 #define TRANSMIT_FULL    "Full"
 #define TRANSMIT_PARTIAL "Partial"
 
 #define _DEBUG_RECEIVED_PACKETS 0
 
+/** Number of polls a node can miss before being forgotten */
+#define ARTNET_NODE_POLL_TIMEOUT 3
+
 ArtNetController::ArtNetController(QNetworkInterface const& interface, QNetworkAddressEntry const& address,
                                    QSharedPointer<QUdpSocket> const& udpSocket,
                                    quint32 line, QObject *parent)
@@ -40,6 +49,7 @@ ArtNetController::ArtNetController(QNetworkInterface const& interface, QNetworkA
     , m_line(line)
     , m_udpSocket(udpSocket)
     , m_packetizer(new ArtNetPacketizer())
+    , m_pollCount(0)
     , m_pollTimer(NULL)
 {
     if (m_ipAddr == QHostAddress::LocalHost)
@@ -100,6 +110,7 @@ QString ArtNetController::getNetworkIP()
 
 QHash<QHostAddress, ArtNetNodeInfo> ArtNetController::getNodesList()
 {
+    QMutexLocker locker(&m_dataMutex);
     return m_nodesList;
 }
 
@@ -117,6 +128,8 @@ void ArtNetController::addUniverse(quint32 universe, ArtNetController::Type type
         info.outputAddress = m_broadcastAddr;
         info.outputUniverse = universe;
         info.outputTransmissionMode = Full;
+        info.outputAutoUnicast = false;
+        info.outputSync = false;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -221,6 +234,28 @@ bool ArtNetController::setTransmissionMode(quint32 universe, ArtNetController::T
     return mode == ArtNetController::Full;
 }
 
+bool ArtNetController::setOutputAutoUnicast(quint32 universe, bool enable)
+{
+    if (!m_universeMap.contains(universe))
+        return false;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputAutoUnicast = enable;
+
+    return enable == false;
+}
+
+bool ArtNetController::setOutputSync(quint32 universe, bool enable)
+{
+    if (!m_universeMap.contains(universe))
+        return false;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputSync = enable;
+
+    return enable == false;
+}
+
 QString ArtNetController::transmissionModeToString(ArtNetController::TransmissionMode mode)
 {
     switch (mode)
@@ -259,10 +294,11 @@ UniverseInfo *ArtNetController::getUniverseInfo(quint32 universe)
 void ArtNetController::sendDmx(const quint32 universe, const QByteArray &data)
 {
     QMutexLocker locker(&m_dataMutex);
-    QByteArray dmxPacket;
     QHostAddress outAddress = m_broadcastAddr;
     quint32 outUniverse = universe;
     TransmissionMode transmitMode = Full;
+    bool autoUnicast = false;
+    bool sync = false;
 
     if (m_universeMap.contains(universe))
     {
@@ -270,26 +306,73 @@ void ArtNetController::sendDmx(const quint32 universe, const QByteArray &data)
         outAddress = info.outputAddress;
         outUniverse = info.outputUniverse;
         transmitMode = TransmissionMode(info.outputTransmissionMode);
+        autoUnicast = info.outputAutoUnicast;
+        sync = info.outputSync;
     }
 
-    if (transmitMode == Full)
+    // the packet of each universe is kept across calls, so
+    // it is prepared in place instead of being allocated again
+    QByteArray &dmxPacket = m_dmxPackets[universe];
+    m_packetizer->setupArtNetDmx(dmxPacket, outUniverse, data, transmitMode == Full);
+
+    QHash<ushort, QList<QHostAddress> >::const_iterator nodes = m_unicastMap.constFind(outUniverse);
+    if (autoUnicast && nodes != m_unicastMap.constEnd())
     {
-        QByteArray wholeuniverse(512, 0);
-        wholeuniverse.replace(0, data.length(), data);
-        m_packetizer->setupArtNetDmx(dmxPacket, outUniverse, wholeuniverse);
+        foreach (const QHostAddress &address, nodes.value())
+            queueDmx(dmxPacket, address, sync);
     }
     else
-        m_packetizer->setupArtNetDmx(dmxPacket, outUniverse, data);
+        queueDmx(dmxPacket, outAddress, sync);
+}
 
-    qint64 sent = m_udpSocket->writeDatagram(dmxPacket, outAddress, ARTNET_PORT);
-    if (sent < 0)
+void ArtNetController::queueDmx(const QByteArray &packet, const QHostAddress &address, bool sync)
+{
+    if (sync && m_syncAddresses.contains(address) == false)
+        m_syncAddresses.append(address);
+
+    m_packetSent += m_batch.queue(m_udpSocket.data(), packet, address, ARTNET_PORT);
+}
+
+void ArtNetController::updateUnicastMap()
+{
+    m_unicastMap.clear();
+
+    QHashIterator<QHostAddress, ArtNetNodeInfo> it(m_nodesList);
+    while (it.hasNext())
     {
-        qWarning() << "sendDmx failed";
-        qWarning() << "Errno: " << m_udpSocket->error();
-        qWarning() << "Errmgs: " << m_udpSocket->errorString();
+        it.next();
+
+        // this very controller replies to polls too
+        if (it.key() == m_ipAddr)
+            continue;
+
+        foreach (ushort universe, it.value().outputUniverses)
+            m_unicastMap[universe].append(it.key());
     }
-    else
-        m_packetSent++;
+}
+
+void ArtNetController::flushFrame()
+{
+    QMutexLocker locker(&m_dataMutex);
+
+    if (m_syncAddresses.isEmpty() == false)
+    {
+        if (m_syncPacket.isEmpty())
+            m_packetizer->setupArtNetSync(m_syncPacket);
+
+        foreach (QHostAddress address, m_syncAddresses)
+            m_packetSent += m_batch.queue(m_udpSocket.data(), m_syncPacket, address, ARTNET_PORT, false);
+
+        m_syncAddresses.clear();
+    }
+
+    m_packetSent += m_batch.flush();
+}
+
+void ArtNetController::setTransmitPacing(int percent)
+{
+    QMutexLocker locker(&m_dataMutex);
+    m_batch.setPacing(percent);
 }
 
 bool ArtNetController::handleArtNetPollReply(QByteArray const& datagram, QHostAddress const& senderAddress)
@@ -305,8 +388,25 @@ bool ArtNetController::handleArtNetPollReply(QByteArray const& datagram, QHostAd
     qDebug() << "[ArtNet] ArtPollReply received";
 #endif
 
-    if (m_nodesList.contains(senderAddress) == false)
-        m_nodesList[senderAddress] = newNode;
+    QMutexLocker locker(&m_dataMutex);
+
+    // nodes with more than 4 ports send a reply for each
+    // group of ports, so their universes are merged
+    newNode.lastPoll = m_pollCount;
+    if (m_nodesList.contains(senderAddress))
+    {
+        ArtNetNodeInfo &node = m_nodesList[senderAddress];
+        QList<ushort> universes = node.lastPoll == m_pollCount ? node.outputUniverses : QList<ushort>();
+        foreach (ushort universe, newNode.outputUniverses)
+        {
+            if (universes.contains(universe) == false)
+                universes.append(universe);
+        }
+        newNode.outputUniverses = universes;
+    }
+    m_nodesList[senderAddress] = newNode;
+    updateUnicastMap();
+
     ++m_packetReceived;
     return true;
 }
@@ -320,6 +420,8 @@ bool ArtNetController::handleArtNetPoll(QByteArray const& datagram, QHostAddress
 #endif
     QByteArray pollReplyPacket;
     m_packetizer->setupArtNetPollReply(pollReplyPacket, m_ipAddr, m_MACAddress);
+
+    QMutexLocker locker(&m_dataMutex);
     m_udpSocket->writeDatagram(pollReplyPacket, senderAddress, ARTNET_PORT);
     ++m_packetSent;
     ++m_packetReceived;
@@ -334,7 +436,10 @@ bool ArtNetController::handleArtNetDmx(QByteArray const& datagram, QHostAddress
     quint32 artnetUniverse;
     if (!m_packetizer->fillDMXdata(datagram, dmxData, artnetUniverse))
     {
-        qWarning() << "[ArtNet] Bad DMX packet received";
+        static QLCLogLimiter limiter(1);
+        int suppressed;
+        if (limiter.allow(&suppressed))
+            qCWarning(lcArtNet) << "Bad DMX packet received, suppressed:" << suppressed;
         return false;
     }
 
@@ -344,6 +449,8 @@ bool ArtNetController::handleArtNetDmx(QByteArray const& datagram, QHostAddress
         << ", from=" << senderAddress.toString();
 #endif
 
+    QMutexLocker locker(&m_dataMutex);
+
     for (QMap<quint32, UniverseInfo>::iterator it = m_universeMap.begin(); it != m_universeMap.end(); ++it)
     {
         quint32 universe = it.key();
@@ -360,17 +467,9 @@ bool ArtNetController::handleArtNetDmx(QByteArray const& datagram, QHostAddress
             qDebug() << "[ArtNet] -> universe" << (universe + 1);
 #endif
 
-            for (int i = 0; i < dmxData.length(); i++)
-            {
-                if (dmxValues->at(i) != dmxData.at(i))
-                {
-#if _DEBUG_RECEIVED_PACKETS
-                    qDebug() << "[ArtNet] a value differs";
-#endif
-                    dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
-                    emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
-                }
-            }
+            QByteArray changed;
+            if (QLCIOPlugin::updateInputValues(*dmxValues, dmxData, changed))
+                emit universeChanged(universe, m_line, *dmxValues, changed);
             ++m_packetReceived;
             return true;
         }
@@ -395,12 +494,22 @@ bool ArtNetController::handlePacket(QByteArray const& datagram, QHostAddress con
             case ARTNET_DMX:
                 return handleArtNetDmx(datagram, senderAddress);
             default:
-                qDebug() << "[ArtNet] opCode not supported yet (" << opCode << ")";
-                break;
+            {
+                static QLCLogLimiter limiter(1);
+                int suppressed;
+                if (lcArtNet().isDebugEnabled() && limiter.allow(&suppressed))
+                    qCDebug(lcArtNet) << "opCode not supported yet (" << opCode << "), suppressed:" << suppressed;
+            }
+            break;
         }
     }
     else
-        qWarning() << "[ArtNet] Malformed packet received";
+    {
+        static QLCLogLimiter limiter(1);
+        int suppressed;
+        if (limiter.allow(&suppressed))
+            qCWarning(lcArtNet) << "Malformed packet received, suppressed:" << suppressed;
+    }
 
     return true;
 }
@@ -430,6 +539,21 @@ void ArtNetController::slotSendPoll()
             m_packetSent++;
     }
 #else
+    {
+        QMutexLocker locker(&m_dataMutex);
+
+        // forget the nodes which stopped replying
+        m_pollCount++;
+        QMutableHashIterator<QHostAddress, ArtNetNodeInfo> it(m_nodesList);
+        while (it.hasNext())
+        {
+            it.next();
+            if (m_pollCount - it.value().lastPoll > ARTNET_NODE_POLL_TIMEOUT)
+                it.remove();
+        }
+        updateUnicastMap();
+    }
+
     QByteArray pollPacket;
     m_packetizer->setupArtNetPoll(pollPacket);
     qint64 sent = m_udpSocket->writeDatagram(pollPacket, m_broadcastAddr, ARTNET_PORT);
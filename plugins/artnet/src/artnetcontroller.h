@@ -33,6 +33,7 @@
 #include <QTimer>
 
 #include "artnetpacketizer.h"
+#include "qlcudpbatch.h"
 
 #define ARTNET_PORT      6454
 
@@ -43,6 +44,8 @@ typedef struct
     QHostAddress outputAddress;
     ushort outputUniverse;
     int outputTransmissionMode;
+    bool outputAutoUnicast;
+    bool outputSync;
 
     int type;
 } UniverseInfo;
@@ -66,9 +69,18 @@ public:
 
     ~ArtNetController();
 
-    /** Send DMX data to a specific port/universe */
+    /** Queue DMX data for a specific port/universe. The data is sent
+     *  with the rest of the frame by flushFrame() */
     void sendDmx(const quint32 universe, const QByteArray& data);
 
+    /** Send the packets queued during the frame, followed by an ArtSync
+     *  packet to the addresses which received a synchronized universe */
+    void flushFrame();
+
+    /** Spread the packets of a frame over $percent of the frame interval.
+     *  0 sends them all at once. See QLCUdpBatch::setPacing() */
+    void setTransmitPacing(int percent);
+
     /** Return the controller IP address */
     QString getNetworkIP();
 
@@ -100,6 +112,19 @@ public:
      *  Return true if this restores default transmission mode */
     bool setTransmissionMode(quint32 universe, TransmissionMode mode);
 
+    /** Enable or disable the automatic unicast of the given QLC+ universe.
+     *  When enabled, the universe is sent only to the nodes whose
+     *  ArtPollReply advertises its ArtNet universe, or to the output
+     *  address when no such node is known.
+     *  Return true if this restores the default (disabled) */
+    bool setOutputAutoUnicast(quint32 universe, bool enable);
+
+    /** Enable or disable ArtSync for the given QLC+ universe. When enabled,
+     *  the nodes receiving the universe are told to output it together with
+     *  the other synchronized universes, once the whole frame has been sent.
+     *  Return true if this restores the default (disabled) */
+    bool setOutputSync(quint32 universe, bool enable);
+
     /** Converts a TransmissionMode value into a human readable string */
     static QString transmissionModeToString(TransmissionMode mode);
 
@@ -159,10 +184,29 @@ private:
     /** Map of the ArtNet nodes discovered with ArtPoll */
     QHash<QHostAddress, ArtNetNodeInfo> m_nodesList;
 
+    /** Number of ArtPoll sent so far, used to forget
+     *  the nodes which stopped replying */
+    quint32 m_pollCount;
+
+    /** The nodes outputting each ArtNet universe, built from m_nodesList */
+    QHash<ushort, QList<QHostAddress> > m_unicastMap;
+
     /** Keeps the current dmx values to send only the ones that changed */
     /** It holds values for all the handled universes */
     QMap<int, QByteArray *> m_dmxValuesMap;
 
+    /** The last ArtDmx packet sent for each QLC+ universe, reused
+     *  to prepare the next one without allocating it again */
+    QHash<quint32, QByteArray> m_dmxPackets;
+
+    /** The ArtSync packet, and the addresses it must be sent to
+     *  at the end of the current frame */
+    QByteArray m_syncPacket;
+    QList<QHostAddress> m_syncAddresses;
+
+    /** The packets of the current frame, sent at once by flushFrame() */
+    QLCUdpBatch m_batch;
+
     /** Map of the QLC+ universes transmitted/received by this
      *  controller, with the related, specific parameters */
     QMap<quint32, UniverseInfo> m_universeMap;
@@ -174,6 +218,14 @@ private:
     QTimer* m_pollTimer;
 
 private:
+    /** Rebuild m_unicastMap from m_nodesList.
+     *  Must be called with m_dataMutex locked */
+    void updateUnicastMap();
+
+    /** Queue an ArtDmx packet to $address, remembering it for ArtSync
+     *  if $sync is true. Must be called with m_dataMutex locked */
+    void queueDmx(const QByteArray& packet, const QHostAddress& address, bool sync);
+
     bool handleArtNetPollReply(QByteArray const& datagram, QHostAddress const& senderAddress);
     bool handleArtNetPoll(QByteArray const& datagram, QHostAddress const& senderAddress);
     bool handleArtNetDmx(QByteArray const& datagram, QHostAddress const& senderAddress);
@@ -188,7 +240,8 @@ protected slots:
     void slotSendPoll();
 
 signals:
-    void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
+    void universeChanged(quint32 universe, quint32 input,
+                         const QByteArray& data, const QByteArray& changed);
 };
 
 #endif
@@ -120,22 +120,44 @@ void ArtNetPacketizer::setupArtNetPollReply(QByteArray &data, QHostAddress ipAdd
         data.append((char)0x00); // bindIp[4], BindIndex, Status2 and filler
 }
 
-void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, const QByteArray &values)
+void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, const QByteArray &values,
+                                      bool fullUniverse)
 {
-    data.clear();
-    data.append(m_commonHeader);
     const char opCodeMSB = (ARTNET_DMX >> 8);
-    data[9] = opCodeMSB;
-    data.append(m_sequence[universe]); // Sequence
-    data.append('\0'); // Physical
-    data.append((char)(universe & 0x00FF));
-    data.append((char)(universe >> 8));
-    int padLength = values.isEmpty() ? 2 : (values.length() % 2); // length must be even in the range 2-512
-    int len = values.length() + padLength;
-    data.append((char)(len >> 8));
-    data.append((char)(len & 0x00FF));
-    data.append(values);
-    data.append(QByteArray(padLength, 0));
+    int valuesLength = fullUniverse ? qMin(values.length(), ARTNET_DMX_LENGTH) : values.length();
+    int len = fullUniverse ? ARTNET_DMX_LENGTH : values.length();
+    // length must be even in the range 2-512
+    if (len < 2)
+        len = 2;
+    else if (len % 2)
+        len++;
+
+    // the header is written only when $data comes
+    // from a different universe or no packet at all
+    bool reuseHeader = data.size() >= ARTNET_DMX_HEADER_SIZE &&
+                       data.at(9) == opCodeMSB &&
+                       data.at(14) == (char)(universe & 0x00FF) &&
+                       data.at(15) == (char)(universe >> 8);
+
+    // a resize keeps the allocated buffer, so a packet
+    // passed again is not reallocated
+    data.resize(ARTNET_DMX_HEADER_SIZE + len);
+    char *packet = data.data();
+
+    if (reuseHeader == false)
+    {
+        memcpy(packet, m_commonHeader.constData(), m_commonHeader.length());
+        packet[9] = opCodeMSB;
+        packet[13] = '\0'; // Physical
+        packet[14] = (char)(universe & 0x00FF);
+        packet[15] = (char)(universe >> 8);
+    }
+
+    packet[12] = m_sequence[universe]; // Sequence
+    packet[16] = (char)(len >> 8);
+    packet[17] = (char)(len & 0x00FF);
+    memcpy(packet + ARTNET_DMX_HEADER_SIZE, values.constData(), valuesLength);
+    memset(packet + ARTNET_DMX_HEADER_SIZE + valuesLength, 0, len - valuesLength);
 
     if (m_sequence[universe] == 0xff)
         m_sequence[universe] = 1;
@@ -143,6 +165,16 @@ void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, con
         m_sequence[universe]++;
 }
 
+void ArtNetPacketizer::setupArtNetSync(QByteArray &data)
+{
+    data.clear();
+    data.append(m_commonHeader);
+    const char opCodeMSB = (ARTNET_SYNC >> 8);
+    data[9] = opCodeMSB;
+    data.append('\0'); // Aux1
+    data.append('\0'); // Aux2
+}
+
 /*********************************************************************
  * Receiver functions
  *********************************************************************/
@@ -175,6 +207,27 @@ bool ArtNetPacketizer::fillArtPollReplyInfo(QByteArray const& data, ArtNetNodeIn
     info.shortName = QString(shortName.data()).simplified();
     info.longName = QString(longName.data()).simplified();
 
+    // the port-address of an output is made of NetSwitch,
+    // SubSwitch and the SwOut nibble of that port
+    info.outputUniverses.clear();
+    if (data.size() >= 194)
+    {
+        int net = data.at(18) & 0x7F;
+        int sub = data.at(19) & 0x0F;
+        int ports = qMin(int(uchar(data.at(173))), 4);
+
+        for (int i = 0; i < ports; i++)
+        {
+            // bit 7 of the port type: the port can output DMX512 data
+            if ((uchar(data.at(174 + i)) & 0x80) == 0)
+                continue;
+
+            ushort universe = ushort((net << 8) | (sub << 4) | (data.at(190 + i) & 0x0F));
+            if (info.outputUniverses.contains(universe) == false)
+                info.outputUniverses.append(universe);
+        }
+    }
+
     qDebug() << "getArtPollReplyInfo shortName: " << info.shortName;
     qDebug() << "getArtPollReplyInfo longName: " << info.longName;
 
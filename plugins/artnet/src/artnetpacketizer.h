@@ -21,6 +21,7 @@
 #include <QByteArray>
 #include <QString>
 #include <QHash>
+#include <QList>
 
 #ifndef ARTNETPACKETIZER_H
 #define ARTNETPACKETIZER_H
@@ -30,6 +31,7 @@
 #define ARTNET_DIAGDATA       0x2300
 #define ARTNET_COMMAND        0x2400
 #define ARTNET_DMX            0x5000
+#define ARTNET_SYNC           0x5200
 #define ARTNET_NZS            0x5100
 #define ARTNET_ADDRESS        0x6000
 #define ARTNET_INPUT          0x7000
@@ -62,10 +64,20 @@
 
 #define ARTNET_CODE_STR "Art-Net"
 
+/** Size of an ArtDmx header, up to the data length */
+#define ARTNET_DMX_HEADER_SIZE 18
+
+/** Maximum number of channels of an ArtDmx packet */
+#define ARTNET_DMX_LENGTH 512
+
 typedef struct
 {
     QString shortName;
     QString longName;
+    /** The port-addresses (ArtNet universes) the node outputs as DMX */
+    QList<ushort> outputUniverses;
+    /** The controller poll counter when the node last replied */
+    quint32 lastPoll;
     // ... can be extended with more info to be added by fillArtPollReplyInfo
 } ArtNetNodeInfo;
 
@@ -88,8 +100,23 @@ public:
     /** Prepare an ArtNetPollReply packet */
     void setupArtNetPollReply(QByteArray &data, QHostAddress ipAddr, QString MACaddr);
 
-    /** Prepare an ArtNetDmx packet */
-    void setupArtNetDmx(QByteArray& data, const int& universe, const QByteArray &values);
+    /**
+     * Prepare an ArtNetDmx packet. $data can be kept by the caller and
+     * passed again for the same universe: its header is then reused and
+     * only the sequence, length and values are updated, without allocations.
+     *
+     * @param data The packet to prepare
+     * @param universe The ArtNet universe
+     * @param values The DMX values to send
+     * @param fullUniverse If true, $values are padded with zeroes
+     *                     to a full 512 channels universe
+     */
+    void setupArtNetDmx(QByteArray& data, const int& universe, const QByteArray &values,
+                        bool fullUniverse = false);
+
+    /** Prepare an ArtSync packet, telling the nodes to output
+     *  the ArtDmx data received so far */
+    void setupArtNetSync(QByteArray& data);
 
     /*********************************************************************
      * Receiver functions
@@ -20,10 +20,13 @@
 #include "artnetplugin.h"
 #include "configureartnet.h"
 
+#include <QSettings>
 #include <QDebug>
 
 #define MAX_INIT_RETRY  10
 
+#define SETTINGS_TRANSMIT_PACING "ArtNetPlugin/transmitPacing"
+
 
 bool addressCompare(const ArtNetIO &v1, const ArtNetIO &v2)
 {
@@ -33,10 +36,20 @@ bool addressCompare(const ArtNetIO &v1, const ArtNetIO &v2)
 
 ArtNetPlugin::~ArtNetPlugin()
 {
+    // the controllers release the socket, which must be
+    // deleted before the input thread stops
+    QMutexLocker locker(&m_ioMutex);
+    for (int i = 0; i < m_IOmapping.count(); i++)
+    {
+        delete m_IOmapping[i].controller;
+        m_IOmapping[i].controller = NULL;
+    }
 }
 
 void ArtNetPlugin::init()
 {
+    QMutexLocker locker(&m_ioMutex);
+
     foreach(QNetworkInterface interface, QNetworkInterface::allInterfaces())
     {
         foreach (QNetworkAddressEntry entry, interface.addressEntries())
@@ -175,6 +188,8 @@ bool ArtNetPlugin::openOutput(quint32 output, quint32 universe)
 
     qDebug() << "[ArtNet] Open output on address :" << m_IOmapping.at(output).address.ip().toString();
 
+    QMutexLocker locker(&m_ioMutex);
+
     // if the controller doesn't exist, create it
     if (m_IOmapping[output].controller == NULL)
     {
@@ -182,12 +197,15 @@ bool ArtNetPlugin::openOutput(quint32 output, quint32 universe)
                                                             m_IOmapping.at(output).address,
                                                             getUdpSocket(),
                                                             output, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        // the input data is handled in the input thread
+        connect(controller, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                this, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                Qt::DirectConnection);
         m_IOmapping[output].controller = controller;
     }
 
     m_IOmapping[output].controller->addUniverse(universe, ArtNetController::Output);
+    m_IOmapping[output].controller->setTransmitPacing(transmitPacing());
     addToMap(universe, output, Output);
 
     return true;
@@ -199,6 +217,8 @@ void ArtNetPlugin::closeOutput(quint32 output, quint32 universe)
         return;
 
     removeFromMap(output, universe, Output);
+
+    QMutexLocker locker(&m_ioMutex);
     ArtNetController *controller = m_IOmapping.at(output).controller;
     if (controller != NULL)
     {
@@ -221,6 +241,15 @@ void ArtNetPlugin::writeUniverse(quint32 universe, quint32 output, const QByteAr
         controller->sendDmx(universe, data);
 }
 
+void ArtNetPlugin::frameComplete()
+{
+    foreach (ArtNetIO line, m_IOmapping)
+    {
+        if (line.controller != NULL)
+            line.controller->flushFrame();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -244,6 +273,8 @@ bool ArtNetPlugin::openInput(quint32 input, quint32 universe)
     if (requestLine(input, MAX_INIT_RETRY) == false)
         return false;
 
+    QMutexLocker locker(&m_ioMutex);
+
     // if the controller doesn't exist, create it.
     // We need to have only one input controller.
     if (m_IOmapping[input].controller == NULL)
@@ -252,8 +283,10 @@ bool ArtNetPlugin::openInput(quint32 input, quint32 universe)
                                                             m_IOmapping.at(input).address,
                                                             getUdpSocket(),
                                                             input, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        // the input data is handled in the input thread
+        connect(controller, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                this, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                Qt::DirectConnection);
         m_IOmapping[input].controller = controller;
     }
 
@@ -269,6 +302,8 @@ void ArtNetPlugin::closeInput(quint32 input, quint32 universe)
         return;
 
     removeFromMap(input, universe, Input);
+
+    QMutexLocker locker(&m_ioMutex);
     ArtNetController *controller = m_IOmapping.at(input).controller;
     if (controller != NULL)
     {
@@ -359,6 +394,10 @@ void ArtNetPlugin::setParameter(quint32 universe, quint32 line, Capability type,
             unset = controller->setOutputUniverse(universe, value.toUInt());
         else if (name == ARTNET_TRANSMITMODE)
             unset = controller->setTransmissionMode(universe, ArtNetController::stringToTransmissionMode(value.toString()));
+        else if (name == ARTNET_AUTOUNICAST)
+            unset = controller->setOutputAutoUnicast(universe, value.toBool());
+        else if (name == ARTNET_SYNC)
+            unset = controller->setOutputSync(universe, value.toBool());
         else
         {
             qWarning() << Q_FUNC_INFO << name << "is not a valid ArtNet output parameter";
@@ -372,6 +411,25 @@ void ArtNetPlugin::setParameter(quint32 universe, quint32 line, Capability type,
         QLCIOPlugin::setParameter(universe, line, type, name, value);
 }
 
+int ArtNetPlugin::transmitPacing() const
+{
+    QSettings settings;
+    return settings.value(SETTINGS_TRANSMIT_PACING, 0).toInt();
+}
+
+void ArtNetPlugin::setTransmitPacing(int percent)
+{
+    QSettings settings;
+    settings.setValue(SETTINGS_TRANSMIT_PACING, percent);
+
+    QMutexLocker locker(&m_ioMutex);
+    foreach (ArtNetIO line, m_IOmapping)
+    {
+        if (line.controller != NULL)
+            line.controller->setTransmitPacing(percent);
+    }
+}
+
 QList<ArtNetIO> ArtNetPlugin::getIOMapping()
 {
     return m_IOmapping;
@@ -389,13 +447,17 @@ QSharedPointer<QUdpSocket> ArtNetPlugin::getUdpSocket()
         return udpSocket;
 
     // Create a new socket
-    udpSocket = QSharedPointer<QUdpSocket>(new QUdpSocket());
+    QUdpSocket *socket = new QUdpSocket();
+    bool bound = socket->bind(ARTNET_PORT, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
+
+    // received packets are handled in the input thread
+    udpSocket = m_inputThread.adopt(socket);
     m_udpSocket = udpSocket.toWeakRef();
 
-    if (udpSocket->bind(ARTNET_PORT, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint))
+    if (bound)
     {
         connect(udpSocket.data(), SIGNAL(readyRead()),
-                this, SLOT(slotReadyRead()));
+                this, SLOT(slotReadyRead()), Qt::DirectConnection);
     }
     else
     {
@@ -406,8 +468,12 @@ QSharedPointer<QUdpSocket> ArtNetPlugin::getUdpSocket()
 
 void ArtNetPlugin::slotReadyRead()
 {
-    QUdpSocket* udpSocket = qobject_cast<QUdpSocket*>(sender());
-    Q_ASSERT(udpSocket != NULL);
+    // this runs in the input thread, where sender() cannot be used
+    QSharedPointer<QUdpSocket> udpSocket(m_udpSocket);
+    if (udpSocket.isNull())
+        return;
+
+    QMutexLocker locker(&m_ioMutex);
 
     QByteArray datagram;
     QHostAddress senderAddress;
@@ -24,9 +24,11 @@
 #include <QNetworkInterface>
 #include <QHostAddress>
 #include <QString>
+#include <QMutex>
 #include <QHash>
 #include <QFile>
 
+#include "qlcinputthread.h"
 #include "qlcioplugin.h"
 #include "artnetcontroller.h"
 
@@ -41,6 +43,8 @@ typedef struct
 #define ARTNET_OUTPUTIP "outputIP"
 #define ARTNET_OUTPUTUNI "outputUni"
 #define ARTNET_TRANSMITMODE "transmitMode"
+#define ARTNET_AUTOUNICAST "autoUnicast"
+#define ARTNET_SYNC "sync"
 
 class ArtNetPlugin : public QLCIOPlugin
 {
@@ -91,6 +95,9 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void frameComplete();
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
@@ -120,6 +127,13 @@ public:
     /** @reimp */
     void setParameter(quint32 universe, quint32 line, Capability type, QString name, QVariant value);
 
+    /** Get the percentage of the frame interval the output packets are
+     *  spread over, 0 when they are sent at once */
+    int transmitPacing() const;
+
+    /** Set the transmission pacing of every output line */
+    void setTransmitPacing(int percent);
+
     /** Get a list of the available Input/Output lines */
     QList<ArtNetIO> getIOMapping();
 
@@ -127,16 +141,24 @@ private:
     /** Map of the ArtNet plugin Input/Output lines */
     QList<ArtNetIO> m_IOmapping;
 
+    /** Protects the lines and their controllers, used by
+     *  the input thread to handle the received packets */
+    QMutex m_ioMutex;
+
     /*********************************************************************
      * ArtNet socket
      *********************************************************************/
 private:
     QSharedPointer<QUdpSocket> getUdpSocket();
 private slots:
+    /** Read the received packets, in the input thread */
     void slotReadyRead();
 private:
+    /** Handle a received packet. Must be called with m_ioMutex locked */
     void handlePacket(QByteArray const& datagram, QHostAddress const& senderAddress);
 private:
+    /** The thread handling the received packets */
+    QLCInputThread m_inputThread;
     QWeakPointer<QUdpSocket> m_udpSocket;
 };
 
@@ -21,6 +21,7 @@
 #include <QMessageBox>
 #include <QSpacerItem>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QLineEdit>
 #include <QSpinBox>
 #include <QLabel>
@@ -38,6 +39,8 @@
 #define KMapColumnIPAddress     2
 #define KMapColumnArtNetUni     3
 #define KMapColumnTransmitMode  4
+#define KMapColumnAutoUnicast   5
+#define KMapColumnSync          6
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -59,6 +62,8 @@ ConfigureArtNet::ConfigureArtNet(ArtNetPlugin* plugin, QWidget* parent)
     /* Setup UI controls */
     setupUi(this);
 
+    m_pacingSpin->setValue(m_plugin->transmitPacing());
+
     fillNodesTree();
     fillMappingTree();
 }
@@ -177,6 +182,14 @@ void ConfigureArtNet::fillMappingTree()
                 if (info->outputTransmissionMode == ArtNetController::Partial)
                     combo->setCurrentIndex(1);
                 m_uniMapTree->setItemWidget(item, KMapColumnTransmitMode, combo);
+
+                QCheckBox *unicastCheck = new QCheckBox(this);
+                unicastCheck->setChecked(info->outputAutoUnicast);
+                m_uniMapTree->setItemWidget(item, KMapColumnAutoUnicast, unicastCheck);
+
+                QCheckBox *syncCheck = new QCheckBox(this);
+                syncCheck->setChecked(info->outputSync);
+                m_uniMapTree->setItemWidget(item, KMapColumnSync, syncCheck);
             }
         }
     }
@@ -247,9 +260,20 @@ void ConfigureArtNet::accept()
                 m_plugin->setParameter(universe, line, cap, ARTNET_TRANSMITMODE,
                         ArtNetController::transmissionModeToString(transmissionMode));
             }
+
+            QCheckBox *unicastCheck = qobject_cast<QCheckBox*>(m_uniMapTree->itemWidget(item, KMapColumnAutoUnicast));
+            if (unicastCheck != NULL)
+                m_plugin->setParameter(universe, line, cap, ARTNET_AUTOUNICAST, unicastCheck->isChecked());
+
+            QCheckBox *syncCheck = qobject_cast<QCheckBox*>(m_uniMapTree->itemWidget(item, KMapColumnSync));
+            if (syncCheck != NULL)
+                m_plugin->setParameter(universe, line, cap, ARTNET_SYNC, syncCheck->isChecked());
         }
     }
 
+    if (m_pacingSpin->value() != m_plugin->transmitPacing())
+        m_plugin->setTransmitPacing(m_pacingSpin->value());
+
     QDialog::accept();
 }
 
@@ -32,7 +32,10 @@ TRANSLATIONS += ArtNet_pt_BR.ts
 TRANSLATIONS += ArtNet_ca_ES.ts
 TRANSLATIONS += ArtNet_ja_JP.ts
 
-HEADERS += ../../interfaces/qlcioplugin.h
+HEADERS += ../../interfaces/qlcioplugin.h \
+           ../../interfaces/qlcinputthread.h \
+           ../../interfaces/qlcloglimiter.h \
+           ../../interfaces/qlcudpbatch.h
 HEADERS += artnetpacketizer.h \
            artnetcontroller.h \
            artnetplugin.h \
@@ -40,7 +43,9 @@ HEADERS += artnetpacketizer.h \
 
 FORMS += configureartnet.ui
 
-SOURCES += ../../interfaces/qlcioplugin.cpp
+SOURCES += ../../interfaces/qlcioplugin.cpp \
+           ../../interfaces/qlcinputthread.cpp \
+           ../../interfaces/qlcudpbatch.cpp
 SOURCES += artnetpacketizer.cpp \
            artnetcontroller.cpp \
            artnetplugin.cpp \
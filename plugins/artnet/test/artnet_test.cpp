@@ -17,11 +17,13 @@
   limitations under the License.
 */
 
+#include <QUdpSocket>
 #include <QTest>
 
 #define private public
 #include "artnet_test.h"
 #include "artnetpacketizer.h"
+#include "qlcudpbatch.h"
 #undef private
 
 /****************************************************************************
@@ -62,4 +64,182 @@ void ArtNet_Test::setupArtNetDmx()
     QCOMPARE(data.data(), "Art-Net");
 }
 
+void ArtNet_Test::setupArtNetDmxReuse()
+{
+    ArtNetPacketizer ap;
+
+    QByteArray data;
+    const QByteArray fifty(50, 10);
+    const QByteArray full(512, 20);
+
+    // a full universe is padded with zeroes
+    ap.setupArtNetDmx(data, 3, fifty, true);
+    QCOMPARE(data.size(), 18 + 512);
+    QCOMPARE(data.data(), "Art-Net");
+    QCOMPARE(data.at(9), char(ARTNET_DMX >> 8));
+    QCOMPARE(data.at(12), char(1));
+    QCOMPARE(data.at(14), char(3));
+    QCOMPARE(data.at(16), char(0x02));
+    QCOMPARE(data.at(17), char(0x00));
+    QCOMPARE(data.at(18 + 49), char(10));
+    QCOMPARE(data.at(18 + 50), char(0));
+
+    // the same packet is updated in place
+    const char *buffer = data.constData();
+    ap.setupArtNetDmx(data, 3, full, true);
+    QVERIFY(data.constData() == buffer);
+    QCOMPARE(data.at(12), char(2));
+    QCOMPARE(data.at(18 + 50), char(20));
+
+    ap.setupArtNetDmx(data, 3, fifty);
+    QCOMPARE(data.size(), 18 + 50);
+    QCOMPARE(data.data(), "Art-Net");
+    QCOMPARE(data.at(12), char(3));
+    QCOMPARE(data.at(16), char(0));
+    QCOMPARE(data.at(17), char(50));
+
+    // another universe rewrites the header
+    ap.setupArtNetDmx(data, 0x102, fifty);
+    QCOMPARE(data.data(), "Art-Net");
+    QCOMPARE(data.at(14), char(0x02));
+    QCOMPARE(data.at(15), char(0x01));
+}
+
+void ArtNet_Test::setupArtNetSync()
+{
+    ArtNetPacketizer ap;
+    QByteArray data;
+
+    ap.setupArtNetSync(data);
+
+    QCOMPARE(data.size(), 14);
+    QCOMPARE(data.data(), "Art-Net");
+    QCOMPARE(data.at(8), char(0x00));
+    QCOMPARE(data.at(9), char(ARTNET_SYNC >> 8));
+    QCOMPARE(data.at(11), char(0x0e));
+
+    int code;
+    QVERIFY(ap.checkPacketAndCode(data, code) == true);
+    QCOMPARE(code, ARTNET_SYNC);
+}
+
+void ArtNet_Test::pollReplyUniverses()
+{
+    ArtNetPacketizer ap;
+    QByteArray data;
+    ArtNetNodeInfo info;
+
+    // QLC+ advertises a single output port
+    ap.setupArtNetPollReply(data, QHostAddress("192.168.1.10"), "11:22:33:44:55:66");
+    QVERIFY(ap.fillArtPollReplyInfo(data, info) == true);
+    QCOMPARE(info.shortName, QString("QLC+"));
+    QCOMPARE(info.outputUniverses, QList<ushort>() << 0);
+
+    // Net 1, Sub 2, four ports
+    data[18] = 0x01;
+    data[19] = 0x02;
+    data[173] = 0x04;
+    data[190] = 0x00;
+    data[191] = 0x01;
+    data[192] = 0x05;
+    data[193] = 0x03;
+    QVERIFY(ap.fillArtPollReplyInfo(data, info) == true);
+    QCOMPARE(info.outputUniverses, QList<ushort>() << 0x120 << 0x121 << 0x125 << 0x123);
+
+    // ports which can't output DMX are skipped
+    data[175] = 0x40;
+    QVERIFY(ap.fillArtPollReplyInfo(data, info) == true);
+    QCOMPARE(info.outputUniverses, QList<ushort>() << 0x120 << 0x125 << 0x123);
+
+    // a short reply has no port information
+    QVERIFY(ap.fillArtPollReplyInfo(data.left(120), info) == true);
+    QVERIFY(info.outputUniverses.isEmpty());
+}
+
+void ArtNet_Test::udpBatch()
+{
+    QUdpSocket receiver;
+    QVERIFY(receiver.bind(QHostAddress::LocalHost, 0));
+    quint16 port = receiver.localPort();
+
+    // a bound socket can send in batch, an unbound
+    // one sends its first datagrams through Qt
+    QUdpSocket bound;
+    QVERIFY(bound.bind(QHostAddress::LocalHost, 0));
+    QUdpSocket unbound;
+
+    QLCUdpBatch batch;
+    QCOMPARE(batch.queue(&bound, QByteArray("one"), QHostAddress::LocalHost, port), 0);
+    QCOMPARE(batch.queue(&bound, QByteArray("two"), QHostAddress::LocalHost, port), 0);
+    QCOMPARE(batch.queue(&unbound, QByteArray("three"), QHostAddress::LocalHost, port), 0);
+    QCOMPARE(batch.queue(NULL, QByteArray("none"), QHostAddress::LocalHost, port), 0);
+    QCOMPARE(batch.count(), 3);
+
+    QCOMPARE(batch.flush(), 3);
+    QCOMPARE(batch.count(), 0);
+
+    QStringList received;
+    while (received.count() < 3 && (receiver.hasPendingDatagrams() || receiver.waitForReadyRead(1000)))
+    {
+        QByteArray datagram;
+        datagram.resize(int(receiver.pendingDatagramSize()));
+        receiver.readDatagram(datagram.data(), datagram.size());
+        received << QString(datagram);
+    }
+
+    QCOMPARE(received, QStringList() << "one" << "two" << "three");
+
+    // a full batch is sent before queueing more
+    for (int i = 0; i < QLCUDPBATCH_SIZE; i++)
+        batch.queue(&bound, QByteArray("x"), QHostAddress::LocalHost, port);
+    QCOMPARE(batch.queue(&bound, QByteArray("y"), QHostAddress::LocalHost, port), QLCUDPBATCH_SIZE);
+    QCOMPARE(batch.count(), 1);
+}
+
+void ArtNet_Test::udpBatchPacing()
+{
+    QUdpSocket receiver;
+    QVERIFY(receiver.bind(QHostAddress::LocalHost, 0));
+    quint16 port = receiver.localPort();
+
+    QUdpSocket sender;
+    QVERIFY(sender.bind(QHostAddress::LocalHost, 0));
+
+    QLCUdpBatch batch;
+    batch.setPacing(200);
+    QCOMPARE(batch.pacing(), QLCUDPBATCH_MAX_PACING);
+    QVERIFY(batch.m_pacer != NULL);
+
+    // the datagrams not paced are sent after the paced ones
+    batch.queue(&sender, QByteArray("sync"), QHostAddress::LocalHost, port, false);
+    batch.queue(&sender, QByteArray("one"), QHostAddress::LocalHost, port);
+    batch.queue(&sender, QByteArray("two"), QHostAddress::LocalHost, port);
+    QCOMPARE(batch.flush(), 3);
+    QCOMPARE(batch.count(), 0);
+
+    // a paced frame is never split by an automatic flush
+    for (int i = 0; i < QLCUDPBATCH_SIZE; i++)
+        batch.queue(&sender, QByteArray("x"), QHostAddress::LocalHost, port);
+    QCOMPARE(batch.queue(&sender, QByteArray("y"), QHostAddress::LocalHost, port), 0);
+    QCOMPARE(batch.count(), QLCUDPBATCH_SIZE + 1);
+    QCOMPARE(batch.flush(), QLCUDPBATCH_SIZE + 1);
+
+    QStringList received;
+    while (received.count() < QLCUDPBATCH_SIZE + 4 &&
+           (receiver.hasPendingDatagrams() || receiver.waitForReadyRead(1000)))
+    {
+        QByteArray datagram;
+        datagram.resize(int(receiver.pendingDatagramSize()));
+        receiver.readDatagram(datagram.data(), datagram.size());
+        received << QString(datagram);
+    }
+
+    QCOMPARE(received.count(), QLCUDPBATCH_SIZE + 4);
+    QCOMPARE(received.mid(0, 3), QStringList() << "one" << "two" << "sync");
+    QCOMPARE(received.last(), QString("y"));
+
+    batch.setPacing(0);
+    QVERIFY(batch.m_pacer == NULL);
+}
+
 QTEST_MAIN(ArtNet_Test)
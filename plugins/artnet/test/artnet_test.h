@@ -28,6 +28,11 @@ class ArtNet_Test : public QObject
 
 private slots:
     void setupArtNetDmx();
+    void setupArtNetDmxReuse();
+    void setupArtNetSync();
+    void pollReplyUniverses();
+    void udpBatch();
+    void udpBatchPacing();
 };
 
 #endif
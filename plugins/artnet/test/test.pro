@@ -14,5 +14,6 @@ INCLUDEPATH += ../src
 DEPENDPATH  += ../src
 
 # Test sources
-HEADERS += artnet_test.h ../../interfaces/qlcioplugin.h
-SOURCES += artnet_test.cpp  ../src/artnetpacketizer.cpp ../../interfaces/qlcioplugin.cpp
+HEADERS += artnet_test.h ../../interfaces/qlcioplugin.h ../../interfaces/qlcudpbatch.h
+SOURCES += artnet_test.cpp  ../src/artnetpacketizer.cpp ../../interfaces/qlcioplugin.cpp \
+           ../../interfaces/qlcudpbatch.cpp
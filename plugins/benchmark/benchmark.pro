@@ -0,0 +1,3 @@
+TEMPLATE = subdirs
+CONFIG  += ordered
+SUBDIRS += src
@@ -0,0 +1,273 @@
+/*
+  Q Light Controller Plus
+  benchmarkplugin.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QStringList>
+#include <QSettings>
+#include <QDebug>
+#include <qmath.h>
+
+#include "benchmarkplugin.h"
+
+#define BENCHMARK_LINES 4
+#define CAPTURE_MAGIC "QLCBENCH"
+#define CAPTURE_VERSION 1
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+BenchmarkPlugin::~BenchmarkPlugin()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.clear();
+    closeCapture();
+}
+
+void BenchmarkPlugin::init()
+{
+    m_timer.start();
+}
+
+QString BenchmarkPlugin::name()
+{
+    return QString("Benchmark");
+}
+
+int BenchmarkPlugin::capabilities() const
+{
+    return QLCIOPlugin::Output;
+}
+
+QString BenchmarkPlugin::pluginInfo()
+{
+    QString str;
+
+    str += QString("<HTML>");
+    str += QString("<HEAD>");
+    str += QString("<TITLE>%1</TITLE>").arg(name());
+    str += QString("</HEAD>");
+    str += QString("<BODY>");
+
+    str += QString("<P>");
+    str += QString("<H3>%1</H3>").arg(name());
+    str += tr("This plugin measures the frames written to its outputs, "
+              "without the need of any hardware.");
+    str += QString("</P>");
+
+    return str;
+}
+
+/*****************************************************************************
+ * Outputs
+ *****************************************************************************/
+
+bool BenchmarkPlugin::openOutput(quint32 output, quint32 universe)
+{
+    if (output >= BENCHMARK_LINES)
+        return false;
+
+    addToMap(universe, output, Output);
+
+    QMutexLocker locker(&m_mutex);
+
+    BenchmarkLineStats stats;
+    stats.m_universe = universe;
+    stats.m_frames = 0;
+    stats.m_lastFrameNs = 0;
+    stats.m_meanIntervalNs = 0;
+    stats.m_intervalM2 = 0;
+    stats.m_minIntervalNs = 0;
+    stats.m_maxIntervalNs = 0;
+    stats.m_lastChecksum = 0;
+    stats.m_lastChangedChannels = 0;
+    stats.m_totalChangedChannels = 0;
+    m_stats[output] = stats;
+
+    openCapture();
+
+    return true;
+}
+
+void BenchmarkPlugin::closeOutput(quint32 output, quint32 universe)
+{
+    if (output >= BENCHMARK_LINES)
+        return;
+
+    removeFromMap(output, universe, Output);
+
+    QMutexLocker locker(&m_mutex);
+    m_stats.remove(output);
+    if (m_stats.isEmpty())
+        closeCapture();
+}
+
+QStringList BenchmarkPlugin::outputs()
+{
+    QStringList list;
+    for (int i = 0; i < BENCHMARK_LINES; i++)
+        list << QString("%1: Benchmark %1").arg(i + 1);
+    return list;
+}
+
+QString BenchmarkPlugin::outputInfo(quint32 output)
+{
+    QString str;
+
+    if (output != QLCIOPlugin::invalidLine() && output < BENCHMARK_LINES)
+    {
+        str += QString("<H3>%1</H3>").arg(outputs()[output]);
+
+        QMutexLocker locker(&m_mutex);
+        if (m_stats.contains(output) == false)
+        {
+            str += QString("<P>%1</P>").arg(tr("Line not open"));
+        }
+        else
+        {
+            const BenchmarkLineStats &stats = m_stats[output];
+            double fps = stats.m_meanIntervalNs > 0 ? 1000000000.0 / stats.m_meanIntervalNs : 0;
+            double jitter = stats.m_frames > 2 ? qSqrt(stats.m_intervalM2 / (stats.m_frames - 2)) : 0;
+
+            str += QString("<P>");
+            str += tr("Frames: %1").arg(stats.m_frames);
+            str += QString("<BR>");
+            str += tr("Frame rate: %1 fps").arg(fps, 0, 'f', 2);
+            str += QString("<BR>");
+            str += tr("Frame interval: %1 ms (min %2 ms, max %3 ms)")
+                   .arg(stats.m_meanIntervalNs / 1000000.0, 0, 'f', 3)
+                   .arg(stats.m_minIntervalNs / 1000000.0, 0, 'f', 3)
+                   .arg(stats.m_maxIntervalNs / 1000000.0, 0, 'f', 3);
+            str += QString("<BR>");
+            str += tr("Jitter: %1 ms").arg(jitter / 1000000.0, 0, 'f', 3);
+            str += QString("<BR>");
+            str += tr("Last checksum: %1").arg(stats.m_lastChecksum, 4, 16, QChar('0'));
+            str += QString("<BR>");
+            str += tr("Changed channels: %1 (total %2)")
+                   .arg(stats.m_lastChangedChannels).arg(stats.m_totalChangedChannels);
+            if (m_captureFile.isOpen())
+            {
+                str += QString("<BR>");
+                str += tr("Capturing to: %1").arg(m_captureFile.fileName());
+            }
+            str += QString("</P>");
+        }
+    }
+
+    str += QString("</BODY>");
+    str += QString("</HTML>");
+
+    return str;
+}
+
+void BenchmarkPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+{
+    qint64 now = m_timer.nsecsElapsed();
+
+    QMutexLocker locker(&m_mutex);
+
+    QMap<quint32, BenchmarkLineStats>::iterator it = m_stats.find(output);
+    if (it == m_stats.end())
+        return;
+
+    BenchmarkLineStats &stats = it.value();
+
+    if (stats.m_frames > 0)
+    {
+        qint64 interval = now - stats.m_lastFrameNs;
+        quint64 intervals = stats.m_frames;
+        double delta = interval - stats.m_meanIntervalNs;
+
+        stats.m_meanIntervalNs += delta / intervals;
+        stats.m_intervalM2 += delta * (interval - stats.m_meanIntervalNs);
+
+        if (intervals == 1 || interval < stats.m_minIntervalNs)
+            stats.m_minIntervalNs = interval;
+        if (interval > stats.m_maxIntervalNs)
+            stats.m_maxIntervalNs = interval;
+    }
+
+    int changed = 0;
+    int previousSize = stats.m_lastData.size();
+    for (int i = 0; i < data.size(); i++)
+    {
+        if (i >= previousSize || data.at(i) != stats.m_lastData.at(i))
+            changed++;
+    }
+
+    stats.m_frames++;
+    stats.m_lastFrameNs = now;
+    stats.m_lastChecksum = qChecksum(data.constData(), data.size());
+    stats.m_lastChangedChannels = changed;
+    stats.m_totalChangedChannels += changed;
+    stats.m_lastData = data;
+
+    if (m_captureFile.isOpen())
+    {
+        m_captureStream << now << universe << output
+                        << stats.m_lastChecksum << quint16(changed) << quint16(data.size());
+        m_captureStream.writeRawData(data.constData(), data.size());
+    }
+}
+
+BenchmarkLineStats BenchmarkPlugin::statistics(quint32 output)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats.value(output);
+}
+
+void BenchmarkPlugin::openCapture()
+{
+    if (m_captureFile.isOpen())
+        return;
+
+    QSettings settings;
+    QString path = settings.value(SETTINGS_CAPTURE_FILE).toString();
+    if (path.isEmpty())
+        return;
+
+    m_captureFile.setFileName(path);
+    if (m_captureFile.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << "[Benchmark] Cannot open capture file" << path << ":" << m_captureFile.errorString();
+        return;
+    }
+
+    m_captureStream.setDevice(&m_captureFile);
+    m_captureStream.setByteOrder(QDataStream::BigEndian);
+    m_captureStream.writeRawData(CAPTURE_MAGIC, 8);
+    m_captureStream << quint32(CAPTURE_VERSION);
+
+    qDebug() << "[Benchmark] Capturing frames to" << path;
+}
+
+void BenchmarkPlugin::closeCapture()
+{
+    if (m_captureFile.isOpen() == false)
+        return;
+
+    m_captureStream.setDevice(NULL);
+    m_captureFile.close();
+}
+
+/*****************************************************************************
+ * Plugin export
+ ****************************************************************************/
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+Q_EXPORT_PLUGIN2(benchmarkplugin, BenchmarkPlugin)
+#endif
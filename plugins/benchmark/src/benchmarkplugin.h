@@ -0,0 +1,145 @@
+/*
+  Q Light Controller Plus
+  benchmarkplugin.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BENCHMARKPLUGIN_H
+#define BENCHMARKPLUGIN_H
+
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QMutex>
+#include <QFile>
+#include <QMap>
+
+#include "qlcioplugin.h"
+#include "qlcmacros.h"
+
+/** Settings key holding the path of the binary capture file.
+ *  When empty or unset, frames are only measured and not recorded */
+#define SETTINGS_CAPTURE_FILE "BenchmarkPlugin/captureFile"
+
+/**
+ * Frame statistics of a single benchmark output line
+ */
+typedef struct
+{
+    /** Universe patched to the line */
+    quint32 m_universe;
+    /** Number of frames received since the line was opened */
+    quint64 m_frames;
+    /** Timestamp of the last frame, in nanoseconds since the plugin timer start */
+    qint64 m_lastFrameNs;
+    /** Running mean and sum of squared deviations of the inter-frame
+     *  interval (Welford), used to compute the jitter */
+    double m_meanIntervalNs;
+    double m_intervalM2;
+    qint64 m_minIntervalNs;
+    qint64 m_maxIntervalNs;
+    /** CRC-16 of the last frame */
+    quint16 m_lastChecksum;
+    /** Number of channels changed by the last frame and since the line was opened */
+    int m_lastChangedChannels;
+    quint64 m_totalChangedChannels;
+    /** Channel data of the last frame, to count the changed channels */
+    QByteArray m_lastData;
+} BenchmarkLineStats;
+
+/**
+ * The Benchmark plugin is a hardware-free output derived from the Dummy
+ * plugin. Instead of sending data to a device, it measures the frames the
+ * engine writes to each line: frame rate, inter-frame jitter, a per-frame
+ * checksum and the number of changed channels.
+ *
+ * Optionally, every frame is appended to the capture file configured with
+ * SETTINGS_CAPTURE_FILE. The file starts with the "QLCBENCH" magic and a
+ * quint32 format version, followed by one record per frame, big endian:
+ * qint64 timestamp (ns), quint32 universe, quint32 line, quint16 checksum,
+ * quint16 changed channels, quint16 data length and the raw channel data.
+ */
+class QLC_DECLSPEC BenchmarkPlugin : public QLCIOPlugin
+{
+    Q_OBJECT
+    Q_INTERFACES(QLCIOPlugin)
+#if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+    Q_PLUGIN_METADATA(IID QLCIOPlugin_iid)
+#endif
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    /** @reimp */
+    virtual ~BenchmarkPlugin();
+
+    /** @reimp */
+    void init();
+
+    /** @reimp */
+    QString name();
+
+    /** @reimp */
+    int capabilities() const;
+
+    /** @reimp */
+    QString pluginInfo();
+
+    /*********************************************************************
+     * Outputs
+     *********************************************************************/
+public:
+    /** @reimp */
+    bool openOutput(quint32 output, quint32 universe);
+
+    /** @reimp */
+    void closeOutput(quint32 output, quint32 universe);
+
+    /** @reimp */
+    QStringList outputs();
+
+    /** @reimp */
+    QString outputInfo(quint32 output);
+
+    /** @reimp */
+    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+
+    /** Return a copy of the statistics of the given output line */
+    BenchmarkLineStats statistics(quint32 output);
+
+private:
+    /** Open the capture file, if one is configured and none is open yet */
+    void openCapture();
+
+    /** Close the capture file when no more lines are open */
+    void closeCapture();
+
+private:
+    /** Protects the statistics and the capture file, since frames are
+     *  written by the MasterTimer thread and read by the UI */
+    QMutex m_mutex;
+
+    /** Time base of the frame timestamps */
+    QElapsedTimer m_timer;
+
+    /** output line -> statistics */
+    QMap<quint32, BenchmarkLineStats> m_stats;
+
+    QFile m_captureFile;
+    QDataStream m_captureStream;
+};
+
+#endif
@@ -0,0 +1,23 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = lib
+LANGUAGE = C++
+TARGET   = benchmark
+CONFIG  += plugin
+win32:DEFINES += QLC_EXPORT
+
+INCLUDEPATH += ../../interfaces
+
+HEADERS += ../../interfaces/qlcioplugin.h
+HEADERS += benchmarkplugin.h
+
+SOURCES += ../../interfaces/qlcioplugin.cpp
+SOURCES += benchmarkplugin.cpp
+
+# This must be after "TARGET = " and before target installation so that
+# install_name_tool can be run before target installation
+macx:include(../../../platforms/macos/nametool.pri)
+
+target.path = $$INSTALLROOT/$$PLUGINDIR
+INSTALLS   += target
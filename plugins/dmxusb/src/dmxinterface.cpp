@@ -70,6 +70,16 @@ quint8 DMXInterface::busLocation()
     return 0;
 }
 
+bool DMXInterface::submitWrite(const QByteArray& data)
+{
+    return write(data);
+}
+
+bool DMXInterface::completeWrite()
+{
+    return true;
+}
+
 bool DMXInterface::validInterface(quint16 vendor, quint16 product)
 {
     if (vendor != DMXInterface::FTDIVID &&
@@ -182,6 +182,18 @@ public:
     /** Write data to a previously-opened line */
     virtual bool write(const QByteArray& data) = 0;
 
+    /**
+     * Start writing data to a previously-opened line, without waiting
+     * for the transfer to complete. Only one write can be pending:
+     * completeWrite() must be called before submitting another one.
+     * The default implementation performs a blocking write().
+     */
+    virtual bool submitWrite(const QByteArray& data);
+
+    /** Wait for the write started by submitWrite() to complete.
+     *  The default implementation has nothing to wait for. */
+    virtual bool completeWrite();
+
     /** Read data from a previously-opened line. Optionally provide own data buffer. */
     virtual QByteArray read(int size, uchar* buffer = NULL) = 0;
 
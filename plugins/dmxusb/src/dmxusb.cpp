@@ -66,6 +66,85 @@ bool DMXUSB::rescanWidgets()
 
     m_widgets = DMXUSBWidget::widgets();
 
+    updateLines();
+
+    if (m_inputs.count() + m_outputs.count() != linesCount)
+        emit configurationChanged();
+
+    return true;
+}
+
+bool DMXUSB::updateWidgets()
+{
+    QList<DMXInterface *> interfaces = DMXUSBWidget::interfaces();
+    QList<DMXUSBWidget *> removed;
+
+    foreach (DMXUSBWidget* widget, m_widgets)
+    {
+        DMXInterface *match = NULL;
+        foreach (DMXInterface *iface, interfaces)
+        {
+            if (widget->sameDevice(iface))
+            {
+                match = iface;
+                break;
+            }
+        }
+
+        if (match == NULL)
+        {
+            removed.append(widget);
+        }
+        else
+        {
+            // the widget keeps its own interface instance
+            interfaces.removeOne(match);
+            delete match;
+        }
+    }
+
+    if (removed.isEmpty() && interfaces.isEmpty())
+        return true;
+
+    foreach (DMXUSBWidget* widget, removed)
+    {
+        qDebug() << "[DMXUSB] widget removed:" << widget->uniqueName();
+        m_widgets.removeOne(widget);
+        delete widget;
+    }
+
+    // lines of the widgets after a removed one move down
+    if (removed.isEmpty() == false)
+    {
+        quint32 outputLine = 0, inputLine = 0;
+        foreach (DMXUSBWidget* widget, m_widgets)
+        {
+            widget->setBaseLines(outputLine, inputLine);
+            outputLine += widget->outputsNumber();
+            inputLine += widget->inputsNumber();
+        }
+    }
+
+    updateLines();
+
+    // new widgets are appended, so the existing lines stay the same
+    QList<DMXUSBWidget *> added = DMXUSBWidget::widgets(interfaces, m_outputs.count(), m_inputs.count());
+    foreach (DMXUSBWidget* widget, added)
+        qDebug() << "[DMXUSB] widget added:" << widget->uniqueName();
+    m_widgets.append(added);
+
+    updateLines();
+
+    emit configurationChanged();
+
+    return true;
+}
+
+void DMXUSB::updateLines()
+{
+    m_inputs.clear();
+    m_outputs.clear();
+
     foreach (DMXUSBWidget* widget, m_widgets)
     {
         for (int o = 0; o < widget->outputsNumber(); o++)
@@ -74,11 +153,6 @@ bool DMXUSB::rescanWidgets()
         for (int i = 0; i < widget->inputsNumber(); i++)
             m_inputs.append(widget);
     }
-
-    if (m_inputs.count() + m_outputs.count() != linesCount)
-        emit configurationChanged();
-
-    return true;
 }
 
 QList <DMXUSBWidget*> DMXUSB::widgets() const
@@ -172,6 +246,7 @@ QString DMXUSB::outputInfo(quint32 output)
         QString add = m_outputs[output]->additionalInfo();
         if (add.isEmpty() == false)
             str += add;
+        str += m_outputs[output]->statisticsInfo();
     }
 
     str += QString("</BODY>");
@@ -190,6 +265,14 @@ void DMXUSB::writeUniverse(quint32 universe, quint32 output, const QByteArray &d
     }
 }
 
+quint32 DMXUSB::outputErrors(quint32 output)
+{
+    if (output < quint32(m_outputs.size()))
+        return quint32(m_outputs.at(output)->statistics().m_writeErrors);
+
+    return 0;
+}
+
 /****************************************************************************
  * Inputs
  ****************************************************************************/
@@ -204,9 +287,14 @@ bool DMXUSB::openInput(quint32 input, quint32 universe)
             widget->type() == DMXUSBWidget::OpenRX ||
             widget->type() == DMXUSBWidget::UltraPro)
         {
-            EnttecDMXUSBPro *pro = static_cast<EnttecDMXUSBPro*>(widget);
-            connect(pro, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                    this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+            // the DMX frames are delivered from the receiving thread
+            QObject *receiver = dynamic_cast<QObject *>(widget);
+            connect(receiver, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                    this, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                    Qt::DirectConnection);
+            if (widget->type() != DMXUSBWidget::OpenRX)
+                connect(receiver, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
+                        this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
         }
         addToMap(universe, input, Input);
         return widget->open(input, true);
@@ -223,11 +311,15 @@ void DMXUSB::closeInput(quint32 input, quint32 universe)
         widget->close(input, true);
         if (widget->type() == DMXUSBWidget::ProRXTX ||
             widget->type() == DMXUSBWidget::ProMk2 ||
+            widget->type() == DMXUSBWidget::OpenRX ||
             widget->type() == DMXUSBWidget::UltraPro)
         {
-            EnttecDMXUSBPro* pro = (EnttecDMXUSBPro*) widget;
-            disconnect(pro, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                       this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+            QObject *receiver = dynamic_cast<QObject *>(widget);
+            disconnect(receiver, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)),
+                       this, SIGNAL(universeChanged(quint32,quint32,QByteArray,QByteArray)));
+            if (widget->type() != DMXUSBWidget::OpenRX)
+                disconnect(receiver, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
+                           this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
         }
     }
 }
@@ -315,7 +407,7 @@ void DMXUSB::slotDeviceAdded(uint vid, uint pid)
         return;
     }
 
-    rescanWidgets();
+    updateWidgets();
 }
 
 void DMXUSB::slotDeviceRemoved(uint vid, uint pid)
@@ -327,7 +419,7 @@ void DMXUSB::slotDeviceRemoved(uint vid, uint pid)
         return;
     }
 
-    rescanWidgets();
+    updateWidgets();
 }
 
 /****************************************************************************
@@ -55,9 +55,21 @@ public:
     /** Find out what kinds of widgets there are currently connected */
     bool rescanWidgets();
 
+    /**
+     * Add the widgets connected since the last scan and remove the ones
+     * no longer connected, leaving the others (and their open lines)
+     * untouched. Used on hotplug events, where the widget types did not
+     * change.
+     */
+    bool updateWidgets();
+
     /** Get currently connected widgets (input & output) */
     QList <DMXUSBWidget*> widgets() const;
 
+private:
+    /** Rebuild m_outputs and m_inputs from m_widgets */
+    void updateLines();
+
 private:
     /** List of references to the discovered USB widgets */
     QList <DMXUSBWidget*> m_widgets;
@@ -81,6 +93,9 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    quint32 outputErrors(quint32 output);
+
 private:
     /**
      *  List of references to USB widgets ordered by output lines.
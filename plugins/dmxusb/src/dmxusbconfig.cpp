@@ -37,22 +37,26 @@
 #define COL_SERIAL 1
 #define COL_TYPE   2
 #define COL_FREQ   3
+#define COL_STATS  4
 #define PROP_SERIAL "serial"
 #define PROP_WIDGET "widget"
 
+#define STATS_UPDATE_MS 1000
+
 DMXUSBConfig::DMXUSBConfig(DMXUSB* plugin, QWidget* parent)
     : QDialog(parent)
     , m_plugin(plugin)
     , m_tree(new QTreeWidget(this))
     , m_refreshButton(new QPushButton(tr("Refresh"), this))
     , m_closeButton(new QPushButton(tr("Close"), this))
+    , m_statsTimer(new QTimer(this))
 {
     Q_ASSERT(plugin != NULL);
 
     setWindowTitle(plugin->name());
 
     QStringList header;
-    header << tr("Name") << tr("Serial") << tr("Mode") << tr("Output frequency");
+    header << tr("Name") << tr("Serial") << tr("Mode") << tr("Output frequency") << tr("Statistics");
     m_tree->setHeaderLabels(header);
     m_tree->setSelectionMode(QAbstractItemView::NoSelection);
 
@@ -67,6 +71,7 @@ DMXUSBConfig::DMXUSBConfig(DMXUSB* plugin, QWidget* parent)
 
     connect(m_refreshButton, SIGNAL(clicked()), this, SLOT(slotRefresh()));
     connect(m_closeButton, SIGNAL(clicked()), this, SLOT(accept()));
+    connect(m_statsTimer, SIGNAL(timeout()), this, SLOT(slotUpdateStatistics()));
 
     QSettings settings;
     QVariant var = settings.value(SETTINGS_GEOMETRY);
@@ -74,6 +79,8 @@ DMXUSBConfig::DMXUSBConfig(DMXUSB* plugin, QWidget* parent)
         restoreGeometry(var.toByteArray());
 
     slotRefresh();
+
+    m_statsTimer->start(STATS_UPDATE_MS);
 }
 
 DMXUSBConfig::~DMXUSBConfig()
@@ -131,11 +138,45 @@ void DMXUSBConfig::slotRefresh()
         item->setText(COL_SERIAL, widget->serial());
         m_tree->setItemWidget(item, COL_TYPE, createTypeCombo(widget));
         m_tree->setItemWidget(item, COL_FREQ, createFrequencySpin(widget));
+        item->setData(COL_STATS, Qt::UserRole, QVariant::fromValue((void *)widget));
+        updateStatistics(item, widget);
     }
 
     m_tree->header()->resizeSections(QHeaderView::ResizeToContents);
 }
 
+void DMXUSBConfig::slotUpdateStatistics()
+{
+    // a hotplug rescan may have replaced the widgets in the meantime
+    QList<DMXUSBWidget *> widgets = m_plugin->widgets();
+
+    for (int i = 0; i < m_tree->topLevelItemCount(); i++)
+    {
+        QTreeWidgetItem *item = m_tree->topLevelItem(i);
+        DMXUSBWidget *widget = (DMXUSBWidget *) item->data(COL_STATS, Qt::UserRole).value<void *>();
+        if (widgets.contains(widget))
+            updateStatistics(item, widget);
+    }
+}
+
+void DMXUSBConfig::updateStatistics(QTreeWidgetItem *item, DMXUSBWidget *widget)
+{
+    DMXUSBStatistics stats = widget->statistics();
+
+    if (stats.m_framesSent == 0 && stats.m_writeErrors == 0)
+    {
+        item->setText(COL_STATS, QString());
+        item->setToolTip(COL_STATS, QString());
+        return;
+    }
+
+    item->setText(COL_STATS, tr("%1Hz, %2 ms latency, %3 errors")
+                             .arg(stats.m_achievedFrequency)
+                             .arg(stats.m_avgLatencyUs / 1000.0, 0, 'f', 2)
+                             .arg(stats.m_writeErrors));
+    item->setToolTip(COL_STATS, widget->statisticsInfo());
+}
+
 QComboBox *DMXUSBConfig::createTypeCombo(DMXUSBWidget *widget)
 {
     Q_ASSERT(widget != NULL);
@@ -29,6 +29,7 @@ class QPushButton;
 class QTreeWidget;
 class QComboBox;
 class QSpinBox;
+class QTimer;
 
 class DMXUSBConfig : public QDialog
 {
@@ -42,10 +43,12 @@ private slots:
     void slotTypeComboActivated(int index);
     void slotFrequencyValueChanged(int value);
     void slotRefresh();
+    void slotUpdateStatistics();
 
 private:
     QComboBox *createTypeCombo(DMXUSBWidget *widget);
     QSpinBox *createFrequencySpin(DMXUSBWidget *widget);
+    void updateStatistics(QTreeWidgetItem *item, DMXUSBWidget *widget);
 
 private:
     DMXUSB* m_plugin;
@@ -53,6 +56,7 @@ private:
     QTreeWidget* m_tree;
     QPushButton* m_refreshButton;
     QPushButton* m_closeButton;
+    QTimer* m_statsTimer;
 };
 
 #endif
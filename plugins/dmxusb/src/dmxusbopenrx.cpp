@@ -24,6 +24,7 @@
 #include <QTime>
 
 #include "dmxusbopenrx.h"
+#include "qlcioplugin.h"
 #include "qlcmacros.h"
 
 #define DEFAULT_OPEN_DMX_FREQUENCY    30  // crap
@@ -193,33 +194,20 @@ void DMXUSBOpenRx::stop()
 
 void DMXUSBOpenRx::compareAndEmit(const QByteArray& last_payload, const QByteArray& current_payload)
 {
-    int max_bound = qMax(last_payload.length(), current_payload.length());
-
     // bytes 0 and 1 are not in use
-    for (int i = 2; i < max_bound; i++)
-    {
-        if (i < last_payload.length() && i < current_payload.length())
-        {
-            // value exists in both, just compare
-            if (last_payload[i] != current_payload[i])
-            {
-                emit valueChanged(UINT_MAX, m_inputBaseLine, i - 2, current_payload[i]);
-                qDebug() << "Channel" << i - 2 << "changed to" << QString::number((uchar) current_payload[i], 10);
-            }
-        } 
-        else if (i < last_payload.length() && i >= current_payload.length())
-        {
-            // This frame is shorter. So put a 0 instead.
-            emit valueChanged(UINT_MAX, m_inputBaseLine, i - 2, 0);
-            qDebug() << "Channel" << i - 2 << "changed to \"0\"";
-        } 
-        else if (i < current_payload.length() && i >= last_payload.length())
-        {
-            // Last frame was shorter, just put the current value
-            emit valueChanged(UINT_MAX, m_inputBaseLine, i - 2, current_payload[i]);
-            qDebug() << "Channel" << i - 2 << "changed to" << QString::number((uchar) current_payload[i], 10);
-        }
-    }
+    if (current_payload.length() <= 2)
+        return;
+
+    QByteArray frame = QByteArray::fromRawData(current_payload.constData() + 2,
+                                               current_payload.length() - 2);
+
+    // a frame shorter than the last one puts the missing channels to 0
+    if (last_payload.length() > current_payload.length())
+        frame.append(QByteArray(last_payload.length() - current_payload.length(), char(0)));
+
+    QByteArray changed;
+    if (QLCIOPlugin::updateInputValues(m_inputValues, frame, changed))
+        emit universeChanged(UINT_MAX, m_inputBaseLine, m_inputValues, changed);
 }
 
 void DMXUSBOpenRx::run()
@@ -260,6 +248,7 @@ void DMXUSBOpenRx::run()
     quint32 erroneous_reads = 0;
 
     m_frameTimeUs = 0;
+    m_inputValues.clear();
 
     while (m_running == true)
     {
@@ -83,17 +83,22 @@ protected:
     /** DMX writer thread worker method */
     void run();
 
-    /** Compare frame and only emit differences */
+    /** Compare a received frame with the previous one and deliver the
+     *  changed channels at once */
     void compareAndEmit(const QByteArray& last_payload, const QByteArray& current_payload);
 
 protected:
     bool m_running;
+    /** The channel values received so far, without the two leading bytes */
+    QByteArray m_inputValues;
     TimerGranularity m_granularity;
     ReaderState m_reader_state;
 
 signals:
-    /** Tells that the value of a received DMX channel has changed */
-    void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
+    /** Tells that channels of a received DMX frame have changed.
+     *  See QLCIOPlugin::universeChanged */
+    void universeChanged(quint32 universe, quint32 input,
+                         const QByteArray& data, const QByteArray& changed);
 };
 
 #endif
@@ -39,6 +39,8 @@ DMXUSBWidget::DMXUSBWidget(DMXInterface *interface, quint32 outputLine, int freq
 {
     Q_ASSERT(interface != NULL);
 
+    resetStatistics();
+
     QMap <QString, QVariant> freqMap(DMXInterface::frequencyMap());
     if (freqMap.contains(m_interface->serial()))
         setOutputFrequency(freqMap[m_interface->serial()].toInt());
@@ -67,12 +69,9 @@ QString DMXUSBWidget::interfaceTypeString() const
     return m_interface->typeString();
 }
 
-QList<DMXUSBWidget *> DMXUSBWidget::widgets()
+QList<DMXInterface *> DMXUSBWidget::interfaces()
 {
-    QList<DMXUSBWidget *> widgetList;
     QList<DMXInterface *> interfacesList;
-    quint32 input_id = 0;
-    quint32 output_id = 0;
 
 #if defined(FTD2XX)
     interfacesList.append(FTD2XXInterface::interfaces(interfacesList));
@@ -84,6 +83,21 @@ QList<DMXUSBWidget *> DMXUSBWidget::widgets()
     interfacesList.append(LibFTDIInterface::interfaces(interfacesList));
 #endif
 
+    return interfacesList;
+}
+
+QList<DMXUSBWidget *> DMXUSBWidget::widgets()
+{
+    return widgets(interfaces());
+}
+
+QList<DMXUSBWidget *> DMXUSBWidget::widgets(const QList<DMXInterface *> &interfacesList,
+                                            quint32 outputLine, quint32 inputLine)
+{
+    QList<DMXUSBWidget *> widgetList;
+    quint32 input_id = inputLine;
+    quint32 output_id = outputLine;
+
     QMap <QString, QVariant> types(DMXInterface::typeMap());
 
     foreach (DMXInterface *iface, interfacesList)
@@ -221,6 +235,30 @@ QList<DMXUSBWidget *> DMXUSBWidget::widgets()
     return widgetList;
 }
 
+bool DMXUSBWidget::sameDevice(DMXInterface *iface) const
+{
+    if (iface == NULL || m_interface == NULL)
+        return false;
+
+    if (iface->serial() != m_interface->serial() ||
+        iface->name() != m_interface->name() ||
+        iface->vendorID() != m_interface->vendorID() ||
+        iface->productID() != m_interface->productID())
+            return false;
+
+    // FTD2XX opens devices by their enumeration index
+    if (m_interface->type() == DMXInterface::FTD2xx && iface->id() != m_interface->id())
+        return false;
+
+    return true;
+}
+
+void DMXUSBWidget::setBaseLines(quint32 outputLine, quint32 inputLine)
+{
+    m_outputBaseLine = outputLine;
+    m_inputBaseLine = inputLine;
+}
+
 bool DMXUSBWidget::forceInterfaceDriver(DMXInterface::Type type)
 {
     DMXInterface *forcedIface = NULL;
@@ -496,3 +534,115 @@ bool DMXUSBWidget::writeUniverse(quint32 universe, quint32 output, const QByteAr
 
     return false;
 }
+
+/****************************************************************************
+ * Statistics
+ ****************************************************************************/
+
+DMXUSBStatistics DMXUSBWidget::statistics() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    DMXUSBStatistics stats = m_stats;
+
+    // the frequency of a stalled output is shown as zero
+    if (m_statsRateTimer.isValid() && m_statsRateTimer.elapsed() > 2000)
+        stats.m_achievedFrequency = 0;
+
+    return stats;
+}
+
+QString DMXUSBWidget::statisticsInfo() const
+{
+    DMXUSBStatistics stats = statistics();
+    QString info;
+
+    if (stats.m_framesSent == 0 && stats.m_writeErrors == 0)
+        return info;
+
+    info += QString("<P>");
+    info += QString("<B>%1:</B> %2").arg(QObject::tr("Frames sent"))
+                                    .arg(stats.m_framesSent);
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2Hz").arg(QObject::tr("Achieved Frame Frequency"))
+                                      .arg(stats.m_achievedFrequency);
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2 / %3 / %4 ms").arg(QObject::tr("Frame interval (min/avg/max)"))
+                                                 .arg(stats.m_minIntervalUs / 1000.0, 0, 'f', 1)
+                                                 .arg(stats.m_avgIntervalUs / 1000.0, 0, 'f', 1)
+                                                 .arg(stats.m_maxIntervalUs / 1000.0, 0, 'f', 1);
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2 / %3 ms").arg(QObject::tr("USB latency (avg/max)"))
+                                            .arg(stats.m_avgLatencyUs / 1000.0, 0, 'f', 2)
+                                            .arg(stats.m_maxLatencyUs / 1000.0, 0, 'f', 2);
+    info += QString("<BR>");
+    if (stats.m_writeErrors > 0)
+        info += QString("<B>%1:</B> <FONT COLOR=\"#aa0000\">%2</FONT>").arg(QObject::tr("Write errors"))
+                                                                     .arg(stats.m_writeErrors);
+    else
+        info += QString("<B>%1:</B> 0").arg(QObject::tr("Write errors"));
+    info += QString("</P>");
+
+    return info;
+}
+
+void DMXUSBWidget::resetStatistics()
+{
+    QMutexLocker locker(&m_statsMutex);
+
+    m_stats.m_framesSent = 0;
+    m_stats.m_writeErrors = 0;
+    m_stats.m_achievedFrequency = 0;
+    m_stats.m_minIntervalUs = 0;
+    m_stats.m_maxIntervalUs = 0;
+    m_stats.m_avgIntervalUs = 0;
+    m_stats.m_avgLatencyUs = 0;
+    m_stats.m_maxLatencyUs = 0;
+
+    m_statsIntervalTimer.invalidate();
+    m_statsRateTimer.invalidate();
+    m_statsRateFrames = 0;
+    m_statsIntervalSumUs = 0;
+    m_statsLatencySumUs = 0;
+}
+
+void DMXUSBWidget::recordFrame(bool ok, qint64 latencyUs)
+{
+    QMutexLocker locker(&m_statsMutex);
+
+    if (ok == false)
+    {
+        m_stats.m_writeErrors++;
+        return;
+    }
+
+    if (m_statsIntervalTimer.isValid())
+    {
+        qint64 intervalUs = m_statsIntervalTimer.nsecsElapsed() / 1000;
+        m_statsIntervalSumUs += intervalUs;
+
+        if (m_stats.m_framesSent == 1 || intervalUs < m_stats.m_minIntervalUs)
+            m_stats.m_minIntervalUs = intervalUs;
+        if (intervalUs > m_stats.m_maxIntervalUs)
+            m_stats.m_maxIntervalUs = intervalUs;
+
+        // the first frame has no interval
+        m_stats.m_avgIntervalUs = m_statsIntervalSumUs / qint64(m_stats.m_framesSent);
+    }
+    m_statsIntervalTimer.restart();
+
+    m_stats.m_framesSent++;
+    m_statsLatencySumUs += latencyUs;
+    m_stats.m_avgLatencyUs = m_statsLatencySumUs / qint64(m_stats.m_framesSent);
+    if (latencyUs > m_stats.m_maxLatencyUs)
+        m_stats.m_maxLatencyUs = latencyUs;
+
+    if (m_statsRateTimer.isValid() == false)
+        m_statsRateTimer.start();
+
+    m_statsRateFrames++;
+    if (m_statsRateTimer.elapsed() >= 1000)
+    {
+        m_stats.m_achievedFrequency = qRound(qreal(m_statsRateFrames) * 1000.0 / qreal(m_statsRateTimer.restart()));
+        m_statsRateFrames = 0;
+    }
+}
@@ -22,6 +22,7 @@
 #define DMXUSBWIDGET_H
 
 #include <QElapsedTimer>
+#include <QMutex>
 
 #if defined(FTD2XX)
   #include "ftd2xx-interface.h"
@@ -47,6 +48,23 @@ typedef struct
     QByteArray m_compareData;
 } DMXUSBLineInfo;
 
+typedef struct
+{
+    /** Number of frames handed over to the device */
+    quint64 m_framesSent;
+    /** Number of frames the device refused */
+    quint64 m_writeErrors;
+    /** Frames sent during the last second */
+    int m_achievedFrequency;
+    /** Shortest, longest and average time between two frames, in microseconds */
+    qint64 m_minIntervalUs;
+    qint64 m_maxIntervalUs;
+    qint64 m_avgIntervalUs;
+    /** Average and longest time spent writing a frame, in microseconds */
+    qint64 m_avgLatencyUs;
+    qint64 m_maxLatencyUs;
+} DMXUSBStatistics;
+
 /**
  * This is the base interface class for all the USB DMX widgets.
  */
@@ -92,8 +110,24 @@ public:
     /** Get the DMXInterface driver in use as a string */
     QString interfaceTypeString() const;
 
+    /** Enumerate the interfaces currently connected, of every enabled backend */
+    static QList<DMXInterface *> interfaces();
+
+    /** Create the widgets of all the interfaces currently connected */
     static QList<DMXUSBWidget *> widgets();
 
+    /** Create the widgets of $interfaces, which they take ownership of,
+     *  numbering their lines from $outputLine and $inputLine */
+    static QList<DMXUSBWidget *> widgets(const QList<DMXInterface *> &interfaces,
+                                         quint32 outputLine = 0, quint32 inputLine = 0);
+
+    /** Check if $iface, freshly enumerated, is the device of this widget */
+    bool sameDevice(DMXInterface *iface) const;
+
+    /** Move the first output and input lines of this widget, when the
+     *  widgets before it are removed */
+    void setBaseLines(quint32 outputLine, quint32 inputLine);
+
     bool forceInterfaceDriver(DMXInterface::Type type);
 
 private:
@@ -244,6 +278,41 @@ public:
      * @return true if the values were sent successfully, otherwise false
      */
     virtual bool writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+
+    /********************************************************************
+     * Statistics
+     ********************************************************************/
+public:
+    /** Get a snapshot of the output timing statistics */
+    DMXUSBStatistics statistics() const;
+
+    /** Get the output timing statistics as HTML, empty if no frame has been sent */
+    QString statisticsInfo() const;
+
+    /** Clear the output timing statistics */
+    void resetStatistics();
+
+protected:
+    /**
+     * Account a frame written to the device. This is meant to be called
+     * by the output thread right after each write.
+     *
+     * @param ok true if the device accepted the frame
+     * @param latencyUs the time spent in the write, in microseconds
+     */
+    void recordFrame(bool ok, qint64 latencyUs);
+
+private:
+    mutable QMutex m_statsMutex;
+    DMXUSBStatistics m_stats;
+
+    /** Time since the last frame, for the frame interval */
+    QElapsedTimer m_statsIntervalTimer;
+    /** Time since the achieved frequency was last computed */
+    QElapsedTimer m_statsRateTimer;
+    int m_statsRateFrames;
+    qint64 m_statsIntervalSumUs;
+    qint64 m_statsLatencySumUs;
 };
 
 #endif
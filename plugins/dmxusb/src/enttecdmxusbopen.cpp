@@ -28,6 +28,7 @@
 
 #define DMX_MAB 16
 #define DMX_BREAK 110
+#define DMX_SLOT_US 44 // 11 bits at 250kbps
 #define DMX_CHANNELS 512
 #define DEFAULT_OPEN_DMX_FREQUENCY    30  // crap
 #define SETTINGS_CHANNELS "enttecdmxusbopen/channels"
@@ -42,6 +43,7 @@ EnttecDMXUSBOpen::EnttecDMXUSBOpen(DMXInterface *interface,
     , DMXUSBWidget(interface, outputLine, DEFAULT_OPEN_DMX_FREQUENCY)
     , m_running(false)
     , m_granularity(Unknown)
+    , m_sleepOvershootUs(0)
 {
     QSettings settings;
     QVariant var = settings.value(SETTINGS_CHANNELS);
@@ -168,6 +170,7 @@ void EnttecDMXUSBOpen::run()
     QElapsedTimer time;
     time.start();
     usleep(1000);
+    m_sleepOvershootUs = qMax(qint64(0), time.nsecsElapsed() / 1000 - 1000);
     if (time.elapsed() > 3)
         m_granularity = Bad;
     else
@@ -188,32 +191,65 @@ void EnttecDMXUSBOpen::run()
         }
     }
 
+    // a frame can't be shorter than the time to put it on the wire
+    qint64 frameTimeUs = qMax(qint64(m_frameTimeUs),
+                              qint64(DMX_BREAK + DMX_MAB + m_outputLines[0].m_universeData.size() * DMX_SLOT_US));
+
+    QElapsedTimer writeTimer;
+    qint64 latencyUs = 0;
+    resetStatistics();
+
     m_running = true;
     while (m_running == true)
     {
         // Measure how much time passes during these calls
         time.restart();
 
+        // the previous frame must be handed over before the next break
+        writeTimer.start();
+        if (interface()->completeWrite() == false)
+        {
+            recordFrame(false, 0);
+            goto framesleep;
+        }
+        latencyUs = writeTimer.nsecsElapsed() / 1000;
+
         if (interface()->setBreak(true) == false)
             goto framesleep;
 
-        if (m_granularity == Good)
-            usleep(DMX_BREAK);
+        waitUntil(time, time.nsecsElapsed() / 1000 + DMX_BREAK);
 
         if (interface()->setBreak(false) == false)
             goto framesleep;
 
-        if (m_granularity == Good)
-            usleep(DMX_MAB);
+        waitUntil(time, time.nsecsElapsed() / 1000 + DMX_MAB);
 
-        if (interface()->write(m_outputLines[0].m_universeData) == false)
+        // the transfer runs while this thread waits for the next frame
+        writeTimer.restart();
+        if (interface()->submitWrite(m_outputLines[0].m_universeData) == false)
+        {
+            recordFrame(false, 0);
             goto framesleep;
+        }
+        recordFrame(true, latencyUs + writeTimer.nsecsElapsed() / 1000);
 
 framesleep:
         // Sleep for the remainder of the DMX frame time
-        if (m_granularity == Good)
-            while (time.elapsed() < (m_frameTimeUs / 1000)) { usleep(1000); }
-        else
-            while (time.elapsed() < (m_frameTimeUs / 1000)) { /* Busy sleep */ }
+        waitUntil(time, frameTimeUs);
     }
+
+    interface()->completeWrite();
+}
+
+void EnttecDMXUSBOpen::waitUntil(const QElapsedTimer& timer, qint64 us) const
+{
+    // sleep while there's enough time left for a sleep to overshoot
+    qint64 left = us - timer.nsecsElapsed() / 1000;
+    while (left > m_sleepOvershootUs + 100)
+    {
+        usleep(left - m_sleepOvershootUs);
+        left = us - timer.nsecsElapsed() / 1000;
+    }
+
+    while (timer.nsecsElapsed() / 1000 < us) { /* Busy sleep */ }
 }
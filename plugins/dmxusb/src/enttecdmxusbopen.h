@@ -86,9 +86,16 @@ protected:
     /** DMX writer thread worker method */
     void run();
 
+    /** Wait until $timer reaches $us microseconds, sleeping as long
+     *  as the timer granularity allows and busy waiting the rest */
+    void waitUntil(const QElapsedTimer& timer, qint64 us) const;
+
 protected:
     bool m_running;
     TimerGranularity m_granularity;
+
+    /** How much longer than requested a short sleep lasts, in microseconds */
+    qint64 m_sleepOvershootUs;
 };
 
 #endif
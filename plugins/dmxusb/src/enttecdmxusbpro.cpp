@@ -20,6 +20,7 @@
 #include <QDebug>
 #include "enttecdmxusbpro.h"
 #include "midiprotocol.h"
+#include "qlcioplugin.h"
 
 /****************************************************************************
  * Initialization
@@ -194,7 +195,9 @@ bool EnttecDMXUSBPro::open(quint32 line, bool input)
     {
         // create (therefore start) the input thread
         m_inputThread = new EnttecDMXUSBProInput(interface());
-        connect(m_inputThread, SIGNAL(dataReady(QByteArray,bool)), this, SLOT(slotDataReceived(QByteArray,bool)));
+        // the frames are decoded in the input thread
+        connect(m_inputThread, SIGNAL(dataReady(QByteArray,bool)), this, SLOT(slotDataReceived(QByteArray,bool)),
+                Qt::DirectConnection);
     }
 
     return true;
@@ -300,6 +303,22 @@ bool EnttecDMXUSBPro::extractSerial()
 
 void EnttecDMXUSBPro::slotDataReceived(QByteArray data, bool isMidi)
 {
+    int devLine = isMidi ? m_inputLines.count() - 1 : 0;
+    int emitLine = m_inputBaseLine + devLine;
+
+    if (isMidi == false)
+    {
+        QByteArray &values = m_inputLines[devLine].m_universeData;
+        if (values.size() == 0)
+            values.fill(0, 512);
+
+        // the whole frame is compared and delivered at once
+        QByteArray changed;
+        if (QLCIOPlugin::updateInputValues(values, data.left(512), changed))
+            emit universeChanged(UINT_MAX, emitLine, values, changed);
+        return;
+    }
+
     // count the received MIDI packets.
     // When reaching 3 (cmd + data1 + data2) a complete MIDI packet is ready to be sent
     int midiCounter = 0;
@@ -307,59 +326,40 @@ void EnttecDMXUSBPro::slotDataReceived(QByteArray data, bool isMidi)
     uchar midiData1 = 0;
     uchar midiData2 = 0;
 
-    int devLine = isMidi ? m_inputLines.count() - 1 : 0;
-    int emitLine = m_inputBaseLine + devLine;
-
     for (int i = 0; i < data.length(); i++)
     {
         uchar byte = uchar(data.at(i));
 
-        if (isMidi == false)
+        //qDebug() << "MIDI byte:" << byte;
+        if (midiCounter == 0)
         {
-            if (m_inputLines[devLine].m_universeData.size() == 0)
-                m_inputLines[devLine].m_universeData.fill(0, 512);
-
-            if (i < 512 && byte != (uchar) m_inputLines[devLine].m_universeData[i])
+            if(MIDI_IS_CMD(byte))
             {
-                qDebug() << "Value at" << i << "changed to" << QString::number(byte);
-                // Store and emit changed values
-                m_inputLines[devLine].m_universeData[i] = byte;
-                emit valueChanged(UINT_MAX, emitLine, i, byte);
+                midiCmd = byte;
+                midiCounter++;
             }
         }
-        else // MIDI message parsing
+        else if (midiCounter == 1)
         {
-            //qDebug() << "MIDI byte:" << byte;
-            if (midiCounter == 0)
-            {
-                if(MIDI_IS_CMD(byte))
-                {
-                    midiCmd = byte;
-                    midiCounter++;
-                }
-            }
-            else if (midiCounter == 1)
-            {
-                midiData1 = byte;
-                midiCounter++;
-            }
-            else if (midiCounter == 2)
+            midiData1 = byte;
+            midiCounter++;
+        }
+        else if (midiCounter == 2)
+        {
+            midiData2 = byte;
+            uint channel = 0;
+            uchar value = 0;
+            if (QLCMIDIProtocol::midiToInput(midiCmd, midiData1, midiData2,
+                                             MAX_MIDI_CHANNELS, // always listen in OMNI mode
+                                             &channel, &value) == true)
             {
-                midiData2 = byte;
-                uint channel = 0;
-                uchar value = 0;
-                if (QLCMIDIProtocol::midiToInput(midiCmd, midiData1, midiData2,
-                                                 MAX_MIDI_CHANNELS, // always listen in OMNI mode
-                                                 &channel, &value) == true)
-                {
-                    emit valueChanged(UINT_MAX, emitLine, channel, value);
-                    // for MIDI beat clock signals,
-                    // generate a synthetic release event
-                    if (midiCmd >= MIDI_BEAT_CLOCK && midiCmd <= MIDI_BEAT_STOP)
-                        emit valueChanged(UINT_MAX, emitLine, channel, 0);
-                }
-                midiCounter = 0;
+                emit valueChanged(UINT_MAX, emitLine, channel, value);
+                // for MIDI beat clock signals,
+                // generate a synthetic release event
+                if (midiCmd >= MIDI_BEAT_CLOCK && midiCmd <= MIDI_BEAT_STOP)
+                    emit valueChanged(UINT_MAX, emitLine, channel, 0);
             }
+            midiCounter = 0;
         }
     }
 }
@@ -393,18 +393,125 @@ bool EnttecDMXUSBPro::writeUniverse(quint32 universe, quint32 output, const QByt
     if (devLine >= (quint32)outputsNumber())
         return false;
 
-    if (m_outputLines[devLine].m_universeData.size() == 0)
-        m_outputLines[devLine].m_universeData.append(data);
-    else
-        m_outputLines[devLine].m_universeData.replace(0, data.size(), data);
+    QMutexLocker locker(&m_outputMutex);
+
+    if (m_dmxPackets.count() < m_outputLines.count())
+    {
+        m_dmxPackets.resize(m_outputLines.count());
+        m_outputChanged.resize(m_outputLines.count());
+    }
+
+    if (m_outputLines[devLine].m_lineType == MIDI)
+    {
+        if (m_outputLines[devLine].m_universeData.size() == 0)
+            m_outputLines[devLine].m_universeData.append(data);
+        else
+            m_outputLines[devLine].m_universeData.replace(0, data.size(), data);
+        return true;
+    }
+
+    QByteArray &packet = m_dmxPackets[devLine];
+    int dataLen = packet.size() - ENTTEC_PRO_DMX_PACKET_EXTRA;
+
+    if (data.size() > dataLen)
+    {
+        setupDMXPacket(devLine, data.size());
+        m_outputChanged[devLine] = true;
+    }
+
+    // the values go straight into the prebuilt packet
+    char *values = packet.data() + ENTTEC_PRO_DMX_HEADER_SIZE;
+    if (memcmp(values, data.constData(), data.size()) != 0)
+    {
+        memcpy(values, data.constData(), data.size());
+        m_outputChanged[devLine] = true;
+    }
 
     return true;
 }
 
+void EnttecDMXUSBPro::setupDMXPacket(int line, int dataLen)
+{
+    QByteArray &packet = m_dmxPackets[line];
+    QByteArray values;
+
+    // keep the values of a smaller packet
+    if (packet.size() > ENTTEC_PRO_DMX_PACKET_EXTRA)
+        values = packet.mid(ENTTEC_PRO_DMX_HEADER_SIZE, packet.size() - ENTTEC_PRO_DMX_PACKET_EXTRA);
+    values.append(QByteArray(dataLen - values.size(), 0));
+
+    packet.clear();
+    packet.append(ENTTEC_PRO_START_OF_MSG); // Start byte
+
+    if (line == 1)
+    {
+        if (m_dmxKingMode)
+            packet.append(DMXKING_SEND_DMX_PORT2); // Command - second port
+        else
+            packet.append(ENTTEC_PRO_SEND_DMX_RQ2); // Command - second port
+    }
+    else
+    {
+        if (m_dmxKingMode)
+            packet.append(DMXKING_SEND_DMX_PORT1); // Command - first port
+        else
+            packet.append(ENTTEC_PRO_SEND_DMX_RQ); // Command - first port
+    }
+
+    packet.append((dataLen + 1) & 0xff); // Data length LSB
+    packet.append(((dataLen + 1) >> 8) & 0xff); // Data length MSB
+    packet.append(char(ENTTEC_PRO_DMX_ZERO)); // DMX start code (Which constitutes the + 1 below)
+    packet.append(values);
+    packet.append(ENTTEC_PRO_END_OF_MSG); // Stop byte
+}
+
+void EnttecDMXUSBPro::appendMidiChanges(int line, QByteArray& frame)
+{
+    DMXUSBLineInfo &info = m_outputLines[line];
+
+    if (info.m_compareData.size() == 0)
+        info.m_compareData.fill(0, 512);
+
+    // send only values that changed
+    for (int j = 0; j < info.m_universeData.length() && j < info.m_compareData.length(); j++)
+    {
+        uchar val = uchar(info.m_universeData.at(j));
+
+        if (val == uchar(info.m_compareData.at(j)))
+            continue;
+
+        info.m_compareData[j] = val;
+
+        uchar cmd = 0;
+        uchar data1 = 0, data2 = 0;
+
+        if (QLCMIDIProtocol::feedbackToMidi(j, val,
+                                            MAX_MIDI_CHANNELS, // MIDI output channel is always OMNI
+                                            true, // send Note OFF
+                                            &cmd, &data1, &data2) == true)
+        {
+            frame.append(ENTTEC_PRO_START_OF_MSG); // Start byte
+            frame.append(ENTTEC_PRO_MIDI_OUT_MSG);
+            frame.append(char(0x03)); // size LSB: 3 bytes
+            frame.append(char(0x00)); // size MSB
+            frame.append(cmd);
+            frame.append(data1);
+            frame.append(data2);
+            frame.append(ENTTEC_PRO_END_OF_MSG); // Stop byte
+        }
+    }
+}
+
 void EnttecDMXUSBPro::run()
 {
     qDebug() << "OUTPUT thread started";
     QElapsedTimer timer;
+    QElapsedTimer refreshTimer;
+    QElapsedTimer writeTimer;
+    QByteArray frame;
+    bool ok;
+
+    resetStatistics();
 
     m_outputRunning = true;
     while (m_outputRunning == true)
@@ -415,93 +522,46 @@ void EnttecDMXUSBPro::run()
         if (openOutputLines() == 0)
             goto framesleep;
 
-        for (int i = 0; i < m_outputLines.count(); i++)
-        {
-            int dataLen = m_outputLines[i].m_universeData.length();
-            if (dataLen == 0)
-                continue;
+        frame.clear();
 
-            if (m_outputLines[i].m_lineType == MIDI)
-            {
-                QByteArray request;
+        {
+            QMutexLocker locker(&m_outputMutex);
 
-                if (m_outputLines[i].m_compareData.size() == 0)
-                    m_outputLines[i].m_compareData.fill(0, 512);
+            bool refresh = refreshTimer.isValid() == false ||
+                           refreshTimer.elapsed() >= ENTTEC_PRO_MIN_REFRESH_MS;
+            if (refresh)
+                refreshTimer.restart();
 
-                // send only values that changed
-                for (int j = 0; j < m_outputLines[i].m_universeData.length(); j++)
-                {
-                    uchar val = uchar(m_outputLines[i].m_universeData[j]);
-
-                    if (val == m_outputLines[i].m_compareData[j])
-                        continue;
-
-                    m_outputLines[i].m_compareData[j] = val;
-
-                    request.clear();
-                    request.prepend(ENTTEC_PRO_START_OF_MSG); // Start byte
-                    request.append(ENTTEC_PRO_MIDI_OUT_MSG);
-                    request.append(char(0x03)); // size LSB: 3 bytes
-                    request.append(char(0x00)); // size MSB
-
-                    uchar cmd = 0;
-                    uchar data1 = 0, data2 = 0;
-
-                    if (QLCMIDIProtocol::feedbackToMidi(i + 1, val,
-                                                        MAX_MIDI_CHANNELS, // MIDI output channel is always OMNI
-                                                        true, // send Note OFF
-                                                        &cmd, &data1, &data2) == true)
-                    {
-                        qDebug() << Q_FUNC_INFO << "cmd:" << cmd << "data1:" << data1 << "data2:" << data2;
-                        request.append(cmd);
-                        request.append(data1);
-                        request.append(data2);
-                        request.append(ENTTEC_PRO_END_OF_MSG); // Stop byte
-                        if (interface()->write(request) == false)
-                        {
-                            qWarning() << Q_FUNC_INFO << name() << "will not accept MIDI data";
-                            continue;
-                        }
-                    }
-                }
-            }
-            else
+            // the messages of all the lines are packed in a single write,
+            // so on dual port widgets both universes take one USB transaction
+            for (int i = 0; i < m_outputLines.count() && i < m_dmxPackets.count(); i++)
             {
-                QByteArray request;
-                request.append(ENTTEC_PRO_START_OF_MSG); // Start byte
-
-                if (i == 1)
+                if (m_outputLines[i].m_lineType == MIDI)
                 {
-                    if (m_dmxKingMode)
-                        request.append(DMXKING_SEND_DMX_PORT2); // Command - second port
-                    else
-                        request.append(ENTTEC_PRO_SEND_DMX_RQ2); // Command - second port
+                    appendMidiChanges(i, frame);
                 }
-                else
+                else if (m_dmxPackets[i].isEmpty() == false &&
+                         (m_outputChanged[i] == true || refresh == true))
                 {
-                    if (m_dmxKingMode)
-                        request.append(DMXKING_SEND_DMX_PORT1); // Command - first port
-                    else
-                        request.append(ENTTEC_PRO_SEND_DMX_RQ); // Command - first port
+                    frame.append(m_dmxPackets[i]);
+                    m_outputChanged[i] = false;
                 }
+            }
+        }
 
-                request.append((dataLen + 1) & 0xff); // Data length LSB
-                request.append(((dataLen + 1) >> 8) & 0xff); // Data length MSB
-                request.append(char(ENTTEC_PRO_DMX_ZERO)); // DMX start code (Which constitutes the + 1 below)
-                request.append(m_outputLines[i].m_universeData);
-                request.append(ENTTEC_PRO_END_OF_MSG); // Stop byte
+        //qDebug() << "OUTPUT" << frame.length() << "bytes";
 
-                //qDebug() << "OUTPUT" << request.length() << "bytes on line" << i;
-                //qDebug() << "DATA" << QString::number(request.at(5)) << QString::number(request.at(6)) << QString::number(request.at(7));
+        if (frame.isEmpty())
+            goto framesleep;
+
+        /* Write the "Output Only Send DMX Packet Request" and MIDI messages */
+        writeTimer.start();
+        ok = interface()->write(frame);
+        recordFrame(ok, writeTimer.nsecsElapsed() / 1000);
+
+        if (ok == false)
+            qWarning() << Q_FUNC_INFO << name() << "will not accept DMX data";
 
-                /* Write "Output Only Send DMX Packet Request" message */
-                if (interface()->write(request) == false)
-                {
-                    qWarning() << Q_FUNC_INFO << name() << "will not accept DMX data";
-                    continue;
-                }
-            }
-        }
 framesleep:
         int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
         if (timetoSleep < 0)
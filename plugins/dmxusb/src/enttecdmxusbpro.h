@@ -21,7 +21,9 @@
 #define ENTTECDMXUSBPRO_H
 
 #include <QByteArray>
+#include <QVector>
 #include <QThread>
+#include <QMutex>
 
 #include "dmxusbwidget.h"
 
@@ -47,6 +49,15 @@
 #define DMXKING_SEND_DMX_PORT1          char(0x64)
 #define DMXKING_SEND_DMX_PORT2          char(0x65)
 
+/** Bytes of a Send DMX message around the channel values: start byte,
+ *  label, 2 bytes of length, DMX start code and end byte */
+#define ENTTEC_PRO_DMX_HEADER_SIZE  5
+#define ENTTEC_PRO_DMX_PACKET_EXTRA 6
+
+/** The widgets keep sending the last frame on their DMX ports, so an
+ *  unchanged frame is sent again only after this time, in milliseconds */
+#define ENTTEC_PRO_MIN_REFRESH_MS   1000
+
 class EnttecDMXUSBProInput : public QThread
 {
     Q_OBJECT
@@ -132,9 +143,14 @@ private:
      * Input
      ************************************************************************/
 signals:
-    /** Tells that the value of a received DMX channel has changed */
+    /** Tells that the value of a received MIDI channel has changed */
     void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
 
+    /** Tells that channels of a received DMX frame have changed.
+     *  See QLCIOPlugin::universeChanged */
+    void universeChanged(quint32 universe, quint32 input,
+                         const QByteArray& data, const QByteArray& changed);
+
 protected slots:
     void slotDataReceived(QByteArray data, bool isMidi);
 
@@ -152,11 +168,29 @@ private:
     /** Stop output thread */
     void stopOutputThread();
 
+    /** Prepare the Send DMX packet of $line for $dataLen channels.
+     *  Must be called with m_outputMutex locked */
+    void setupDMXPacket(int line, int dataLen);
+
+    /** Append the messages of the MIDI values of $line that changed
+     *  to $frame. Must be called with m_outputMutex locked */
+    void appendMidiChanges(int line, QByteArray& frame);
+
     /** Output thread worker method */
     void run();
 
 private:
     bool m_outputRunning;
+
+    /** The Send DMX packets of the output lines, updated in place by
+     *  writeUniverse() and sent as they are by the output thread */
+    QVector<QByteArray> m_dmxPackets;
+
+    /** Flags raised when the values of a line changed since last sent */
+    QVector<bool> m_outputChanged;
+
+    /** Protects the output data shared with the output thread */
+    QMutex m_outputMutex;
 };
 
 #endif
@@ -220,7 +220,11 @@ void EuroliteUSBDMXPro::run()
 {
     qDebug() << "OUTPUT thread started";
     QElapsedTimer timer;
+    QElapsedTimer writeTimer;
     QByteArray request;
+    bool ok;
+
+    resetStatistics();
 
     m_running = true;
     while (m_running == true)
@@ -240,11 +244,15 @@ void EuroliteUSBDMXPro::run()
         request.append(m_outputLines[0].m_universeData);
         request.append(EUROLITE_USB_DMX_PRO_END_OF_MSG); // Stop byte
 
+        writeTimer.start();
 #ifdef QTSERIAL
-        if (interface()->write(request) == false)
+        ok = interface()->write(request);
 #else
-        if (m_file.write(request) == false)
+        ok = m_file.write(request) > 0;
 #endif
+        recordFrame(ok, writeTimer.nsecsElapsed() / 1000);
+
+        if (ok == false)
         {
             qWarning() << Q_FUNC_INFO << name() << "will not accept DMX data";
 #ifdef QTSERIAL
@@ -34,6 +34,9 @@
 LibFTDIInterface::LibFTDIInterface(const QString& serial, const QString& name, const QString& vendor,
                                    quint16 VID, quint16 PID, quint32 id)
     : DMXInterface(serial, name, vendor, VID, PID , id)
+#if defined(LIBFTDI1)
+    , m_writeTransfer(NULL)
+#endif
 {
     bzero(&m_handle, sizeof(struct ftdi_context));
     ftdi_init(&m_handle);
@@ -268,6 +271,8 @@ bool LibFTDIInterface::openByPID(const int PID)
 
 bool LibFTDIInterface::close()
 {
+    completeWrite();
+
     if (ftdi_usb_close(&m_handle) < 0)
     {
         qWarning() << Q_FUNC_INFO << name() << ftdi_get_error_string(&m_handle);
@@ -423,6 +428,47 @@ bool LibFTDIInterface::write(const QByteArray& data)
     }
 }
 
+bool LibFTDIInterface::submitWrite(const QByteArray& data)
+{
+#if defined(LIBFTDI1)
+    if (m_writeTransfer != NULL && completeWrite() == false)
+        return false;
+
+    // the buffer must stay untouched until the transfer completes,
+    // so keep a private copy of the data
+    m_writeBuffer = data;
+    m_writeTransfer = ftdi_write_data_submit(&m_handle, (uchar*) m_writeBuffer.data(), m_writeBuffer.size());
+    if (m_writeTransfer == NULL)
+    {
+        qWarning() << Q_FUNC_INFO << name() << ftdi_get_error_string(&m_handle);
+        return false;
+    }
+
+    return true;
+#else
+    return write(data);
+#endif
+}
+
+bool LibFTDIInterface::completeWrite()
+{
+#if defined(LIBFTDI1)
+    if (m_writeTransfer == NULL)
+        return true;
+
+    // this also releases the transfer control
+    int ret = ftdi_transfer_data_done(m_writeTransfer);
+    m_writeTransfer = NULL;
+
+    if (ret < 0)
+    {
+        qWarning() << Q_FUNC_INFO << name() << ftdi_get_error_string(&m_handle);
+        return false;
+    }
+#endif
+    return true;
+}
+
 QByteArray LibFTDIInterface::read(int size, uchar* userBuffer)
 {
     uchar* buffer = NULL;
@@ -94,6 +94,12 @@ public:
     /** @reimpl */
     bool write(const QByteArray& data);
 
+    /** @reimpl */
+    bool submitWrite(const QByteArray& data);
+
+    /** @reimpl */
+    bool completeWrite();
+
     /** @reimpl */
     QByteArray read(int size, uchar* buffer = NULL);
 
@@ -103,6 +109,12 @@ public:
 private:
     struct ftdi_context m_handle;
     quint8 m_busLocation;
+
+#if defined(LIBFTDI1)
+    /** The transfer started by submitWrite(), and the data it sends */
+    struct ftdi_transfer_control *m_writeTransfer;
+    QByteArray m_writeBuffer;
+#endif
 };
 
 #endif
@@ -288,6 +288,11 @@ void NanoDMX::run()
     qDebug() << "OUTPUT thread started";
 
     QElapsedTimer timer;
+    QElapsedTimer writeTimer;
+    bool changed;
+    bool ok;
+
+    resetStatistics();
 
     m_running = true;
 
@@ -300,6 +305,8 @@ void NanoDMX::run()
     while (m_running == true)
     {
         timer.restart();
+        changed = false;
+        ok = true;
 
         for (int i = 0; i < m_outputLines[0].m_universeData.length(); i++)
         {
@@ -321,12 +328,20 @@ void NanoDMX::run()
                 fastTrans.append((char)(i - 256));
             }
             fastTrans.append(val);
+
+            // each changed channel is a transaction, a frame
+            // is the whole set of them in this cycle
+            if (changed == false)
+                writeTimer.start();
+            changed = true;
+
 #ifdef QTSERIAL
             if (interface()->write(fastTrans) == false)
 #else
             if (m_file.write(fastTrans) <= 0)
 #endif
             {
+                ok = false;
                 qWarning() << Q_FUNC_INFO << name() << "will not accept DMX data";
 #ifdef QTSERIAL
                 interface()->purgeBuffers();
@@ -343,6 +358,9 @@ void NanoDMX::run()
             }
         }
 
+        if (changed)
+            recordFrame(ok, ok ? writeTimer.nsecsElapsed() / 1000 : 0);
+
         int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
         if (timetoSleep < 0)
             qWarning() << "DMX output is running late !";
@@ -186,6 +186,11 @@ void Stageprofi::run()
     qDebug() << "OUTPUT thread started";
 
     QElapsedTimer timer;
+    QElapsedTimer writeTimer;
+    bool changed;
+    bool ok;
+
+    resetStatistics();
 
     m_running = true;
 
@@ -198,6 +203,8 @@ void Stageprofi::run()
     while (m_running == true)
     {
         timer.restart();
+        changed = false;
+        ok = true;
 
         for (int i = 0; i < m_outputLines[0].m_universeData.length(); i++)
         {
@@ -219,8 +226,15 @@ void Stageprofi::run()
             }
             fastTrans.append(val);
 
+            // each changed channel is a transaction, a frame
+            // is the whole set of them in this cycle
+            if (changed == false)
+                writeTimer.start();
+            changed = true;
+
             if (interface()->write(fastTrans) == false)
             {
+                ok = false;
                 qWarning() << Q_FUNC_INFO << name() << "will not accept DMX data";
                 interface()->purgeBuffers();
                 continue;
@@ -233,6 +247,9 @@ void Stageprofi::run()
             }
         }
 
+        if (changed)
+            recordFrame(ok, ok ? writeTimer.nsecsElapsed() / 1000 : 0);
+
         int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
         if (timetoSleep < 0)
             qWarning() << "DMX output is running late !";
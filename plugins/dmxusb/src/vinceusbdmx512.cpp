@@ -184,9 +184,13 @@ bool VinceUSBDMX512::writeUniverse(quint32 universe, quint32 output, const QByte
     if (data == m_universe)
         return true;
 
+    QElapsedTimer timer;
+    timer.start();
+
     if (writeData(VinceUSBDMX512::UpdateDMX, data) == false)
     {
         qWarning() << Q_FUNC_INFO << name() << "will not accept DMX data";
+        recordFrame(false, 0);
         return false;
     }
     else
@@ -198,9 +202,12 @@ bool VinceUSBDMX512::writeUniverse(quint32 universe, quint32 output, const QByte
         if (ok == false || resp.size() > 0)
         {
             qWarning() << Q_FUNC_INFO << name() << "doesn't respond properly";
+            recordFrame(false, 0);
             return false;
         }
 
+        // the widget replies once the frame is applied
+        recordFrame(true, timer.nsecsElapsed() / 1000);
         m_universe = data;
         return true;
     }
@@ -38,6 +38,8 @@ GPIOConfiguration::GPIOConfiguration(GPIOPlugin* plugin, QWidget* parent)
     /* Setup UI controls */
     setupUi(this);
 
+    m_debounceSpin->setValue(m_plugin->debounceTime());
+
     fillTree();
 }
 
@@ -104,6 +106,8 @@ void GPIOConfiguration::accept()
         }
     }
 
+    m_plugin->setDebounceTime(m_debounceSpin->value());
+
     QDialog::accept();
 }
 
@@ -18,6 +18,7 @@
 */
 
 #include <QStringList>
+#include <QSettings>
 #include <QDebug>
 
 #include "gpioplugin.h"
@@ -27,6 +28,8 @@
 #define MAX_GPIO_PINS       30
 #define MAX_FILE_ATTEMPTS   10
 
+#define SETTINGS_DEBOUNCE   "GPIOPlugin/debounce"
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -51,6 +54,7 @@ void GPIOPlugin::init()
         gpio->m_usage = NoUsage;
         gpio->m_value = 1;
         gpio->m_count = 0;
+        gpio->m_edge = false;
 
         QString pinPath = QString("/sys/class/gpio/gpio%1/value").arg(i);
         gpio->m_file = new QFile(pinPath);
@@ -164,6 +168,25 @@ QList<GPIOPinInfo *> GPIOPlugin::gpioList() const
     return m_gpioList;
 }
 
+int GPIOPlugin::debounceTime() const
+{
+    QSettings settings;
+    QVariant value = settings.value(SETTINGS_DEBOUNCE);
+    if (value.isValid() == true)
+        return value.toInt();
+
+    return GPIO_DEFAULT_DEBOUNCE;
+}
+
+void GPIOPlugin::setDebounceTime(int ms)
+{
+    QSettings settings;
+    settings.setValue(SETTINGS_DEBOUNCE, ms);
+
+    if (m_readerThread != NULL)
+        m_readerThread->setDebounceTime(ms);
+}
+
 QString GPIOPlugin::pinUsageToString(GPIOPlugin::PinUsage usage)
 {
     switch(usage)
@@ -269,6 +292,7 @@ void GPIOPlugin::setPinUsage(int gpioNumber, GPIOPlugin::PinUsage usage)
     file.close();
 
     m_gpioList[gpioNumber]->m_usage = usage;
+    m_gpioList[gpioNumber]->m_edge = (usage == InputUsage) ? setPinEdge(gpioNumber) : false;
 
     if (m_readerThread != NULL)
     {
@@ -286,6 +310,23 @@ void GPIOPlugin::setPinUsage(int gpioNumber, GPIOPlugin::PinUsage usage)
     }
 }
 
+bool GPIOPlugin::setPinEdge(int gpioNumber)
+{
+    QString pinPath = QString("/sys/class/gpio/gpio%1/edge").arg(gpioNumber);
+    QFile file(pinPath);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "[GPIO] PIN" << gpioNumber << "has no edge support, it will be polled";
+        return false;
+    }
+
+    bool ok = file.write("both") > 0;
+    file.close();
+
+    return ok;
+}
+
 void GPIOPlugin::setPinValue(int gpioNumber, uchar value)
 {
     if (gpioNumber < 0 || gpioNumber >= m_gpioList.count())
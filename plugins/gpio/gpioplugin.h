@@ -26,6 +26,9 @@
 
 #define GPIO_PARAM_USAGE "pinUsage"
 
+/** Default time in milliseconds an input PIN is ignored after a change */
+#define GPIO_DEFAULT_DEBOUNCE 20
+
 typedef struct
 {
     int m_number;
@@ -34,6 +37,8 @@ typedef struct
     QFile *m_file;
     uchar m_value;
     uchar m_count;
+    /** true if the kernel notifies the edges of this input PIN */
+    bool m_edge;
 } GPIOPinInfo;
 
 class ReadThread;
@@ -86,11 +91,18 @@ public:
     QString pinUsageToString(PinUsage usage);
     PinUsage stringToPinUsage(QString usage);
 
+    /** Get/Set the time in milliseconds an input PIN is ignored after a change */
+    int debounceTime() const;
+    void setDebounceTime(int ms);
+
 private:
     void setPinStatus(int gpioNumber, bool enable);
     void setPinUsage(int gpioNumber, PinUsage usage);
     void setPinValue(int gpioNumber, uchar value);
 
+    /** Ask the kernel to notify both edges of an input PIN */
+    bool setPinEdge(int gpioNumber);
+
     /*********************************************************************
      * Outputs
      *********************************************************************/
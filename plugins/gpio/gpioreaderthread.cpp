@@ -19,17 +19,35 @@
 
 #include <QDebug>
 
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
 #include "gpioreaderthread.h"
 #include "gpioplugin.h"
 
-#define HYSTERESIS_THRESHOLD  3
+/** Read interval in milliseconds of the PINs without edge support */
+#define GPIO_POLL_INTERVAL  50
 
 ReadThread::ReadThread(GPIOPlugin *plugin, QObject *parent)
     : QThread(parent)
     , m_plugin(plugin)
     , m_running(false)
     , m_paused(false)
+    , m_debounce(plugin->debounceTime())
 {
+    if (pipe(m_wakeupPipe) < 0)
+    {
+        qWarning() << "[GPIO] Cannot create the reader wake up pipe";
+        m_wakeupPipe[0] = m_wakeupPipe[1] = -1;
+    }
+    else
+    {
+        fcntl(m_wakeupPipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(m_wakeupPipe[1], F_SETFL, O_NONBLOCK);
+    }
+
+    m_timer.start();
     updateReadPINs();
     start();
 }
@@ -37,6 +55,12 @@ ReadThread::ReadThread(GPIOPlugin *plugin, QObject *parent)
 ReadThread::~ReadThread()
 {
     stop();
+
+    if (m_wakeupPipe[0] != -1)
+    {
+        close(m_wakeupPipe[0]);
+        close(m_wakeupPipe[1]);
+    }
 }
 
 void ReadThread::stop()
@@ -45,6 +69,7 @@ void ReadThread::stop()
     if (isRunning() == true)
     {
         m_running = false;
+        wakeUp();
         wait();
     }
 }
@@ -54,6 +79,7 @@ void ReadThread::pause(bool paused)
     qDebug() << Q_FUNC_INFO << paused;
     QMutexLocker locker(&m_mutex);
     m_paused = paused;
+    wakeUp();
 }
 
 void ReadThread::updateReadPINs()
@@ -72,7 +98,8 @@ void ReadThread::updateReadPINs()
             {
                 if (gpio->m_file->isOpen() == false)
                 {
-                    if (!gpio->m_file->open(QIODevice::ReadOnly))
+                    // reads go straight to the file descriptor polled for edges
+                    if (!gpio->m_file->open(QIODevice::ReadOnly | QIODevice::Unbuffered))
                     {
                         qDebug() << "[GPIO] Error opening GPIO for reading";
                         continue;
@@ -83,52 +110,157 @@ void ReadThread::updateReadPINs()
             }
         }
     }
+
+    m_lockout.fill(0, m_readList.count());
+    wakeUp();
+}
+
+void ReadThread::setDebounceTime(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_debounce = qMax(0, ms);
+}
+
+void ReadThread::wakeUp()
+{
+    if (m_wakeupPipe[1] == -1)
+        return;
+
+    char c = 0;
+    if (write(m_wakeupPipe[1], &c, 1) < 0)
+    {
+        // the pipe is full, so the thread is due to wake up anyway
+    }
+}
+
+bool ReadThread::readValue(GPIOPinInfo *gpio, uchar &value)
+{
+    int fd = gpio->m_file->handle();
+    char buf[8];
+
+    // the value file must be read again from the start to clear the edge
+    if (lseek(fd, 0, SEEK_SET) < 0)
+        return false;
+
+    ssize_t len = read(fd, buf, sizeof(buf));
+    if (len <= 0)
+        return false;
+
+    value = buf[0] == '0' ? 0 : 1;
+    return true;
+}
+
+void ReadThread::checkPin(int pin, qint64 now)
+{
+    GPIOPinInfo *gpio = m_readList.at(pin);
+    uchar newVal;
+
+    if (readValue(gpio, newVal) == false)
+        return;
+
+    // still bouncing: the PIN will be read again when the time is over
+    if (now < m_lockout[pin])
+        return;
+
+    if (newVal == gpio->m_value)
+        return;
+
+    qDebug() << "Value read: GPIO:" << gpio->m_number << "val:" <<  newVal;
+    gpio->m_value = newVal;
+    m_lockout[pin] = now + m_debounce;
+    emit valueChanged(gpio->m_number, gpio->m_value);
 }
 
 void ReadThread::run()
 {
     qDebug() << "[GPIO] Reader thread created";
+    QVector<struct pollfd> fds;
+    QVector<int> fdPins;
+    char drain[64];
+
     m_running = true;
     while (m_running == true)
     {
-        if (m_paused == true)
-        {
-            usleep(50000);
-            continue;
-        }
-
         QMutexLocker locker(&m_mutex);
 
-        foreach(GPIOPinInfo *gpio, m_readList)
-        {
-            if (gpio->m_file == NULL || gpio->m_file->isOpen() == false)
-                continue;
+        fds.resize(1);
+        fds[0].fd = m_wakeupPipe[0];
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fdPins.resize(1);
 
-            //qDebug() << "Reading file:" << gpio->m_file->fileName();
-            gpio->m_file->reset();
-            QByteArray dataRead = gpio->m_file->readAll().simplified();
-            if (dataRead.isEmpty())
-                continue;
-            uchar newVal = dataRead.toUInt();
-            if (newVal != gpio->m_value)
+        qint64 now = m_timer.elapsed();
+        int timeout = -1;
+
+        if (m_paused == false)
+        {
+            for (int i = 0; i < m_readList.count(); i++)
             {
-                gpio->m_count++;
-                if (gpio->m_count > HYSTERESIS_THRESHOLD)
+                GPIOPinInfo *gpio = m_readList.at(i);
+                if (gpio->m_file == NULL || gpio->m_file->isOpen() == false)
+                    continue;
+
+                if (gpio->m_edge)
                 {
-                    qDebug() << "Value read: GPIO:" << gpio->m_number << "val:" <<  newVal;
-                    gpio->m_value = newVal;
-                    gpio->m_count = 0;
-                    emit valueChanged(gpio->m_number, gpio->m_value);
+                    struct pollfd pfd;
+                    pfd.fd = gpio->m_file->handle();
+                    pfd.events = POLLPRI | POLLERR;
+                    pfd.revents = 0;
+                    fds.append(pfd);
+                    fdPins.append(i);
+                }
+                else
+                {
+                    timeout = timeout < 0 ? GPIO_POLL_INTERVAL : qMin(timeout, GPIO_POLL_INTERVAL);
+                }
+
+                // a PIN ignored for debouncing is read again at the end of it
+                if (m_lockout[i] > now)
+                {
+                    int left = int(m_lockout[i] - now);
+                    timeout = timeout < 0 ? left : qMin(timeout, left);
                 }
-            }
-            else
-            {
-                gpio->m_count = 0;
             }
         }
+
         locker.unlock();
 
-        usleep(50000);
+        int ret = poll(fds.data(), fds.count(), timeout);
+        if (ret < 0)
+        {
+            if (m_running)
+                usleep(GPIO_POLL_INTERVAL * 1000);
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            while (read(m_wakeupPipe[0], drain, sizeof(drain)) > 0) { }
+        }
+
+        locker.relock();
+
+        // the reader PINs might have changed meanwhile
+        if (m_paused == true || m_running == false || fds[0].revents & POLLIN)
+            continue;
+
+        now = m_timer.elapsed();
+
+        for (int i = 0; i < m_readList.count(); i++)
+        {
+            GPIOPinInfo *gpio = m_readList.at(i);
+            if (gpio->m_file == NULL || gpio->m_file->isOpen() == false)
+                continue;
+
+            int fdIndex = fdPins.indexOf(i);
+            bool edge = fdIndex > 0 && (fds[fdIndex].revents & (POLLPRI | POLLERR));
+            bool lockoutOver = m_lockout[i] != 0 && m_lockout[i] <= now;
+
+            if (lockoutOver)
+                m_lockout[i] = 0;
+
+            if (edge || lockoutOver || gpio->m_edge == false)
+                checkPin(i, now);
+        }
     }
 }
-
@@ -20,11 +20,22 @@
 #ifndef GPIOREADERTHREAD_H
 #define GPIOREADERTHREAD_H
 
+#include <QElapsedTimer>
 #include <QThread>
+#include <QVector>
 #include <QMutexLocker>
 
 #include "gpioplugin.h"
 
+/**
+ * The GPIO reader thread sleeps in poll() on the value files of the input
+ * PINs, and the kernel wakes it up on each edge. PINs whose edge file could
+ * not be set are read at a fixed interval instead.
+ *
+ * A change is reported as soon as its edge is received, then the PIN is
+ * ignored for the debounce time and read again at the end of it, so that
+ * bounces are filtered without delaying the first edge.
+ */
 class ReadThread : public QThread
 {
     Q_OBJECT
@@ -40,18 +51,42 @@ public:
 
     void updateReadPINs();
 
+    /** Set the time in milliseconds a PIN is ignored after a change */
+    void setDebounceTime(int ms);
+
 protected:
     void run();
 
 signals:
     void valueChanged(quint32 channel, uchar value);
 
+private:
+    /** Wake up the thread from poll() */
+    void wakeUp();
+
+    /** Read the current value of $gpio. Returns false on error */
+    bool readValue(GPIOPinInfo *gpio, uchar &value);
+
+    /** Report the value of $pin if changed. Must be called with m_mutex locked */
+    void checkPin(int pin, qint64 now);
+
 private:
     GPIOPlugin *m_plugin;
     bool m_running;
     bool m_paused;
     QMutex m_mutex;
     QList<GPIOPinInfo *> m_readList;
+
+    /** Time until each PIN of m_readList is ignored, against m_timer */
+    QVector<qint64> m_lockout;
+
+    /** The debounce time in milliseconds, 0 to disable */
+    int m_debounce;
+
+    QElapsedTimer m_timer;
+
+    /** Pipe to wake up the thread when stopping or when the PINs change */
+    int m_wakeupPipe[2];
 };
 
 #endif
@@ -18,10 +18,12 @@
 */
 
 #include <QApplication>
+#include <QSettings>
 #include <QObject>
 #include <QString>
 #include <QDebug>
 #include <QFile>
+#include <climits>
 
 #include "hidjsdevice.h"
 #include "hidplugin.h"
@@ -35,6 +37,9 @@ HIDJsDevice::HIDJsDevice(HIDPlugin* parent, quint32 line, struct hid_device_info
     m_dev_info = (struct hid_device_info*) malloc (sizeof(struct hid_device_info));
     memcpy(m_dev_info, info, sizeof(struct hid_device_info));
     m_capabilities = QLCIOPlugin::Input;
+
+    QSettings settings;
+    m_axisThreshold = settings.value(SETTINGS_AXIS_THRESHOLD, 1).toInt();
 }
 
 HIDJsDevice::~HIDJsDevice()
@@ -62,6 +67,8 @@ void HIDJsDevice::closeInput()
         m_running = false;
         wait();
     }
+    m_pendingAxes.clear();
+    m_emittedAxes.clear();
     if (m_file.isOpen())
         m_file.close();
 }
@@ -76,6 +83,41 @@ bool HIDJsDevice::readEvent()
     return false;
 }
 
+/*****************************************************************************
+ * Axes coalescing
+ *****************************************************************************/
+
+void HIDJsDevice::postAxisValue(quint32 axis, uchar value)
+{
+    m_pendingAxes[axis] = value;
+}
+
+void HIDJsDevice::flushAxes()
+{
+    QHashIterator<quint32, uchar> it(m_pendingAxes);
+    while (it.hasNext())
+    {
+        it.next();
+        uchar value = it.value();
+
+        QHash<quint32, uchar>::const_iterator last = m_emittedAxes.constFind(it.key());
+        if (last != m_emittedAxes.constEnd())
+        {
+            if (last.value() == value)
+                continue;
+
+            if (qAbs(int(value) - int(last.value())) < m_axisThreshold &&
+                value != 0 && value != UCHAR_MAX)
+                    continue;
+        }
+
+        m_emittedAxes[it.key()] = value;
+        emit valueChanged(UINT_MAX, m_line, it.key(), value);
+    }
+
+    m_pendingAxes.clear();
+}
+
 /*****************************************************************************
  * Device info
  *****************************************************************************/
@@ -31,6 +31,12 @@
 
 class HIDPlugin;
 
+/** Milliseconds between two consecutive deliveries of the axes values,
+ *  matching the engine tick */
+#define HID_AXIS_COALESCE_INTERVAL 20
+
+#define SETTINGS_AXIS_THRESHOLD "HIDPlugin/axisThreshold"
+
 /*****************************************************************************
  * HIDEventDevice
  *****************************************************************************/
@@ -73,6 +79,29 @@ public:
     /** @reimp */
     virtual bool readEvent() ;
 
+    /*********************************************************************
+     * Axes coalescing
+     *********************************************************************/
+protected:
+    /** Store the latest $value of $axis, to be emitted by flushAxes() */
+    void postAxisValue(quint32 axis, uchar value);
+
+    /** Emit the posted axes values which moved at least m_axisThreshold
+     *  away from the last value emitted. The ends of the axis range are
+     *  always emitted, so that a full deflection is never swallowed */
+    void flushAxes();
+
+protected:
+    /** Minimum change of an axis value to be emitted, to suppress jitter */
+    int m_axisThreshold;
+
+private:
+    /** The latest values posted since the last flush */
+    QHash<quint32, uchar> m_pendingAxes;
+
+    /** The last values emitted for each axis */
+    QHash<quint32, uchar> m_emittedAxes;
+
     /*********************************************************************
      * Device info
      *********************************************************************/
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QElapsedTimer>
 #include <QDebug>
 
 #include <linux/joystick.h>
@@ -125,8 +126,8 @@ bool HIDLinuxJoystick::readEvent()
                         double(0), double(UCHAR_MAX));
             ch = quint32(ev.number);
 
-            qDebug() << "HID JS" << m_line << ch << val;
-            emit valueChanged(UINT_MAX, m_line, ch, val);
+            /* Axes are delivered by run() once per interval */
+            postAxisValue(ch, val);
         }
         else
         {
@@ -155,10 +156,19 @@ void HIDLinuxJoystick::run()
     fds[0].fd = handle();
     fds[0].events = POLLIN;
 
+    /* Time since the axes were last delivered. A first move is
+       delivered at once, the following ones once per interval */
+    QElapsedTimer flushTimer;
+    flushTimer.start();
+    bool axesPending = false;
 
     while (m_running == true)
     {
-        int r = poll(fds, 1, KPollTimeout);
+        int timeout = KPollTimeout;
+        if (axesPending)
+            timeout = qMax(0, HID_AXIS_COALESCE_INTERVAL - int(flushTimer.elapsed()));
+
+        int r = poll(fds, 1, timeout);
 
         if (r < 0 && errno != EINTR)
         {
@@ -168,9 +178,21 @@ void HIDLinuxJoystick::run()
         else if (r != 0)
         {
             if (fds[0].revents != 0)
+            {
                 readEvent();
+                axesPending = true;
+            }
+        }
+
+        if (axesPending && flushTimer.elapsed() >= HID_AXIS_COALESCE_INTERVAL)
+        {
+            flushAxes();
+            flushTimer.restart();
+            axesPending = false;
         }
     }
+
+    delete [] fds;
 }
 
 
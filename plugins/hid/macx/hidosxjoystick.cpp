@@ -182,10 +182,11 @@ bool HIDOSXJoystick::readEvent()
 
         if (value != m_axesValues[a].value)
         {
-            emit valueChanged(UINT_MAX, m_line, a, uchar(value));
+            postAxisValue(a, uchar(value));
             m_axesValues[a].value = value;
         }
     }
+    flushAxes();
 
     return true;
 }
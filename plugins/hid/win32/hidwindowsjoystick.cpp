@@ -128,9 +128,10 @@ bool HIDWindowsJoystick::readEvent()
             uchar val = SCALE(double(cmpVals.at(i)), double(0), double(USHRT_MAX),
                         double(0), double(UCHAR_MAX));
             if (val != (uchar)m_axesValues.at(i))
-                emit valueChanged(UINT_MAX, m_line, i, val);
+                postAxisValue(i, val);
             m_axesValues[i] = val;
         }
+        flushAxes();
     }
     return true;
 }
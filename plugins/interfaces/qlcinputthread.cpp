@@ -0,0 +1,48 @@
+/*
+  Q Light Controller Plus
+  qlcinputthread.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QUdpSocket>
+#include <QDebug>
+
+#include "qlcinputthread.h"
+
+QLCInputThread::QLCInputThread()
+    : QThread()
+{
+}
+
+QLCInputThread::~QLCInputThread()
+{
+    // the sockets released with deleteLater() are deleted
+    // as soon as the event loop of the thread exits
+    quit();
+    wait();
+}
+
+QSharedPointer<QUdpSocket> QLCInputThread::adopt(QUdpSocket *socket)
+{
+    Q_ASSERT(socket->parent() == NULL);
+
+    if (isRunning() == false)
+        start();
+
+    socket->moveToThread(this);
+
+    return QSharedPointer<QUdpSocket>(socket, &QObject::deleteLater);
+}
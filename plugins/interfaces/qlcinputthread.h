@@ -0,0 +1,57 @@
+/*
+  Q Light Controller Plus
+  qlcinputthread.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef QLCINPUTTHREAD_H
+#define QLCINPUTTHREAD_H
+
+#include <QSharedPointer>
+#include <QThread>
+
+class QUdpSocket;
+
+/**
+ * QLCInputThread runs the event loop of the sockets a network plugin
+ * receives data from, so that incoming packets are processed as soon as
+ * they arrive, even when the main thread is busy with the UI.
+ *
+ * Sockets are created and bound by the plugin as usual, then handed to the
+ * thread with adopt(). Their readyRead() signal must be connected with a
+ * Qt::DirectConnection, so that the packets are read and handled in this
+ * thread. The handlers run concurrently with the main thread, so they must
+ * hold the locks protecting the plugin data and deliver the values with a
+ * Qt::DirectConnection as well, to the thread safe InputPatch buffers.
+ */
+class QLCInputThread : public QThread
+{
+public:
+    QLCInputThread();
+
+    /** Stop the thread, deleting the sockets released so far */
+    ~QLCInputThread();
+
+    /**
+     * Move $socket to this thread, starting it if needed, and return a
+     * shared pointer which deletes the socket in this thread when the
+     * last reference is released.
+     * $socket must not have a parent.
+     */
+    QSharedPointer<QUdpSocket> adopt(QUdpSocket *socket);
+};
+
+#endif
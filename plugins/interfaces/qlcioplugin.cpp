@@ -56,6 +56,25 @@ void QLCIOPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArr
     Q_UNUSED(data)
 }
 
+void QLCIOPlugin::writeUniverseDelta(quint32 universe, quint32 output, const QByteArray &data,
+                                     int changedStart, int changedCount)
+{
+    Q_UNUSED(changedStart)
+    Q_UNUSED(changedCount)
+
+    writeUniverse(universe, output, data);
+}
+
+void QLCIOPlugin::frameComplete()
+{
+}
+
+quint32 QLCIOPlugin::outputErrors(quint32 output)
+{
+    Q_UNUSED(output)
+    return 0;
+}
+
 /*************************************************************************
  * Inputs
  *************************************************************************/
@@ -94,6 +113,33 @@ void QLCIOPlugin::sendFeedBack(quint32 universe, quint32 inputLine,
     Q_UNUSED(key)
 }
 
+bool QLCIOPlugin::updateInputValues(QByteArray &values, const QByteArray &data,
+                                    QByteArray &changed)
+{
+    int count = data.size();
+    if (values.size() < count)
+        values.append(QByteArray(count - values.size(), char(0)));
+
+    changed.fill(0, (count + 7) / 8);
+
+    const char *in = data.constData();
+    char *out = values.data();
+    uchar *mask = reinterpret_cast<uchar *>(changed.data());
+    bool result = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (out[i] == in[i])
+            continue;
+
+        out[i] = in[i];
+        mask[i / 8] |= uchar(1 << (i % 8));
+        result = true;
+    }
+
+    return result;
+}
+
 /*************************************************************************
  * Configure
  *************************************************************************/
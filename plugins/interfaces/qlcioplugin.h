@@ -128,7 +128,11 @@ public:
         Output      = 1 << 0,
         Input       = 1 << 1,
         Feedback    = 1 << 2,
-        Infinite    = 1 << 3
+        Infinite    = 1 << 3,
+        /** Input data is emitted with universeChanged from within the
+         *  writeUniverse call of another universe (e.g. loopback), so it
+         *  can be processed by its universe within the same tick */
+        Synchronous = 1 << 4
     };
 
     /**
@@ -203,6 +207,46 @@ public:
      */
     virtual void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /**
+     * Write the contents of a DMX universe to the plugin, together with
+     * the range of channels that changed since the previous frame.
+     * The whole universe is always provided in $data, so plugins can
+     * skip unchanged frames (sending just a keepalive when their protocol
+     * needs one) or transmit only the changed part.
+     *
+     * The default implementation ignores the range information and calls
+     * writeUniverse() with the full frame.
+     *
+     * @param universe The QLC+ universe index
+     * @param output The output line to write to
+     * @param data The universe data to write
+     * @param changedStart The index of the first changed channel
+     * @param changedCount The number of changed channels starting from
+     *                     $changedStart. 0 means the frame didn't change.
+     */
+    virtual void writeUniverseDelta(quint32 universe, quint32 output, const QByteArray& data,
+                                    int changedStart, int changedCount);
+
+    /**
+     * Called once all the universes of a frame have been written, so that
+     * a plugin can transmit what it batched during the frame, or tell its
+     * devices to output the frame at once (e.g. ArtSync).
+     * This is called from the thread of the universe completing the frame.
+     *
+     * The default implementation does nothing.
+     */
+    virtual void frameComplete();
+
+    /**
+     * Return the number of frames that the specified output line failed
+     * to transmit since it was opened, for monitoring purposes.
+     *
+     * The default implementation returns 0, for plugins that can't tell.
+     *
+     * @param output The output line to get the errors of
+     */
+    virtual quint32 outputErrors(quint32 output);
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
@@ -264,6 +308,19 @@ public:
     virtual void sendFeedBack(quint32 universe, quint32 inputLine,
                               quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Copy the values of a received DMX frame into the values received
+     * so far for the same input and fill the changed channels mask,
+     * as needed by universeChanged.
+     *
+     * @param values the values received so far, updated with $data
+     * @param data the values of the frame just received
+     * @param changed filled with the bit mask of the changed channels
+     * @return true if at least one channel has changed
+     */
+    static bool updateInputValues(QByteArray& values, const QByteArray& data,
+                                  QByteArray& changed);
+
 signals:
     /**
      * Tells that the value of a channel in an input line has changed and needs
@@ -282,6 +339,22 @@ signals:
      */
     void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Tells that several channels of an input line have changed at once.
+     * Plugins receiving whole DMX frames (like the network ones) should
+     * use this instead of emitting valueChanged for each channel.
+     *
+     * @param universe The universe ID detected from the data received
+     *                 (see valueChanged)
+     * @param input The input line whose channels have changed value
+     * @param data The values of the channels, starting from channel 0
+     * @param changed A bit mask of the channels that have changed value.
+     *                Bit (i % 8) of byte (i / 8) is set when channel i
+     *                has changed
+     */
+    void universeChanged(quint32 universe, quint32 input,
+                         const QByteArray& data, const QByteArray& changed);
+
     /*************************************************************************
      * Configure
      *************************************************************************/
@@ -0,0 +1,92 @@
+/*
+  Q Light Controller Plus
+  qlcloglimiter.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef QLCLOGLIMITER_H
+#define QLCLOGLIMITER_H
+
+#include <QDateTime>
+#include <QAtomicInt>
+
+/**
+ * QLCLogLimiter lets a message through at most a given number of times
+ * per second, so that a message logged on every frame or every packet
+ * doesn't flood the log when something goes wrong.
+ *
+ * A limiter is meant to be a static variable next to the message it
+ * limits, and it can be used from any thread without locking:
+ *
+ * @code
+ * static QLCLogLimiter limiter(1);
+ * int suppressed;
+ * if (limiter.allow(&suppressed))
+ *     qCWarning(lcCategory) << "Something failed, suppressed:" << suppressed;
+ * @endcode
+ */
+class QLCLogLimiter
+{
+public:
+    explicit QLCLogLimiter(int perSecond)
+        : m_perSecond(perSecond)
+        , m_second(0)
+        , m_count(0)
+        , m_suppressed(0)
+    {
+    }
+
+    /**
+     * Return true if a message can be logged now. $suppressed, if not NULL,
+     * is set to the number of messages refused since the last allowed one.
+     */
+    bool allow(int *suppressed = NULL)
+    {
+        int second = int(QDateTime::currentMSecsSinceEpoch() / 1000);
+        int current = m_second.loadAcquire();
+
+        // the first message of a new second starts counting again
+        if (current != second && m_second.testAndSetOrdered(current, second))
+        {
+            m_count.storeRelease(1);
+            int refused = m_suppressed.fetchAndStoreOrdered(0);
+            if (suppressed != NULL)
+                *suppressed = refused;
+            return true;
+        }
+
+        if (m_count.fetchAndAddOrdered(1) < m_perSecond)
+        {
+            if (suppressed != NULL)
+                *suppressed = m_suppressed.fetchAndStoreOrdered(0);
+            return true;
+        }
+
+        m_suppressed.ref();
+        return false;
+    }
+
+private:
+    int m_perSecond;
+    /** The second the messages are being counted for */
+    QAtomicInt m_second;
+    /** The messages allowed in m_second */
+    QAtomicInt m_count;
+    /** The messages refused since the last allowed one */
+    QAtomicInt m_suppressed;
+};
+
+#endif
@@ -0,0 +1,406 @@
+/*
+  Q Light Controller Plus
+  qlcudpbatch.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QLoggingCategory>
+#include <QWaitCondition>
+#include <QUdpSocket>
+#include <QThread>
+#include <QMutex>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+#define QLCUDPBATCH_SENDMMSG
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <string.h>
+#endif
+
+#include "qlcloglimiter.h"
+#include "qlcudpbatch.h"
+
+Q_LOGGING_CATEGORY(lcUdpBatch, "qlcplus.plugins.udpbatch")
+
+/** The shortest time between two chunks of a paced frame, in microseconds */
+#define QLCUDPPACER_SLOT_US 1000
+
+/****************************************************************************
+ * QLCUdpPacer
+ ****************************************************************************/
+
+/**
+ * The thread sending the paced frames of a QLCUdpBatch. It writes to the
+ * sockets without the lock of the plugin, which is fine since sending a
+ * datagram doesn't change the state of a socket already bound, and it is
+ * stopped by the batch, which lives no longer than the sockets.
+ */
+class QLCUdpPacer : public QThread
+{
+public:
+    QLCUdpPacer()
+        : m_window(0)
+        , m_running(true)
+    {
+        setObjectName("QLCUdpPacer");
+    }
+
+    /** Send $datagrams over $window microseconds. $datagrams is emptied */
+    void post(QVector<QLCUdpBatch::Datagram> &datagrams, int window)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // a frame not taken yet is sent along with the new one
+        if (m_pending.isEmpty())
+            m_pending.swap(datagrams);
+        else
+            m_pending += datagrams;
+        datagrams.resize(0);
+
+        m_window = window;
+        m_condition.wakeAll();
+    }
+
+    /** Stop the thread, discarding what hasn't been sent yet */
+    void stop()
+    {
+        m_mutex.lock();
+        m_running = false;
+        m_condition.wakeAll();
+        m_mutex.unlock();
+
+        wait();
+    }
+
+protected:
+    void run()
+    {
+        QVector<QLCUdpBatch::Datagram> frame;
+        QMutexLocker locker(&m_mutex);
+
+        while (m_running)
+        {
+            if (m_pending.isEmpty())
+            {
+                m_condition.wait(&m_mutex);
+                continue;
+            }
+
+            // the datagrams not paced go after the last paced chunk
+            frame.resize(0);
+            for (int i = 0; i < m_pending.count(); i++)
+                if (m_pending.at(i).paced)
+                    frame.append(m_pending.at(i));
+            int paced = frame.count();
+            for (int i = 0; i < m_pending.count(); i++)
+                if (m_pending.at(i).paced == false)
+                    frame.append(m_pending.at(i));
+            m_pending.resize(0);
+
+            int window = m_window;
+            int chunks = qBound(1, window / QLCUDPPACER_SLOT_US, qMax(1, paced));
+            QElapsedTimer timer;
+            timer.start();
+
+            int sent = 0;
+            for (int chunk = 1; chunk <= chunks; chunk++)
+            {
+                int to = paced * chunk / chunks;
+                locker.unlock();
+                QLCUdpBatch::send(frame, sent, to);
+                locker.relock();
+                sent = to;
+
+                if (chunk == chunks)
+                    break;
+
+                // wait for the next chunk, unless the next frame is already here
+                qint64 due = qint64(window) * chunk / chunks;
+                while (m_running && m_pending.isEmpty())
+                {
+                    qint64 remaining = due - timer.nsecsElapsed() / 1000;
+                    if (remaining <= 0)
+                        break;
+                    m_condition.wait(&m_mutex, qMax(1UL, (unsigned long)(remaining / 1000)));
+                }
+
+                if (m_running == false || m_pending.isEmpty() == false)
+                    break;
+            }
+
+            if (m_running == false)
+                break;
+
+            // the rest of an interrupted frame, and the sync packets
+            locker.unlock();
+            QLCUdpBatch::send(frame, sent, frame.count());
+            locker.relock();
+        }
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    /** The datagrams posted and not taken yet by the thread */
+    QVector<QLCUdpBatch::Datagram> m_pending;
+    /** The time the pending datagrams are spread over, in microseconds */
+    int m_window;
+    bool m_running;
+};
+
+/****************************************************************************
+ * QLCUdpBatch
+ ****************************************************************************/
+
+QLCUdpBatch::QLCUdpBatch()
+    : m_pacing(0)
+    , m_pacer(NULL)
+{
+    m_datagrams.reserve(QLCUDPBATCH_SIZE);
+}
+
+QLCUdpBatch::~QLCUdpBatch()
+{
+    setPacing(0);
+}
+
+int QLCUdpBatch::queue(QUdpSocket *socket, const QByteArray &data,
+                       const QHostAddress &address, quint16 port, bool paced)
+{
+    if (socket == NULL)
+        return 0;
+
+    int sent = 0;
+    if (m_pacing == 0 && m_datagrams.count() >= QLCUDPBATCH_SIZE)
+        sent = flush();
+
+    Datagram datagram;
+    datagram.socket = socket;
+    datagram.data = data;
+    datagram.address = address;
+    datagram.port = port;
+    datagram.paced = paced;
+    m_datagrams.append(datagram);
+
+    return sent;
+}
+
+int QLCUdpBatch::count() const
+{
+    return m_datagrams.count();
+}
+
+int QLCUdpBatch::flush()
+{
+    if (m_pacing == 0)
+    {
+        int sent = send(m_datagrams, 0, m_datagrams.count());
+
+        // resize keeps the allocated memory, and releases
+        // the data, so that senders can reuse their buffers
+        m_datagrams.resize(0);
+
+        return sent;
+    }
+
+    // the first frame has no interval to be paced over
+    qint64 interval = m_frameTimer.isValid() ? m_frameTimer.nsecsElapsed() / 1000 : 0;
+    m_frameTimer.start();
+
+    if (m_datagrams.isEmpty())
+        return 0;
+
+    // a socket never used yet is bound by its first datagram,
+    // which must happen in the thread of the socket
+    for (int i = 0; i < m_datagrams.count(); i++)
+    {
+        if (m_datagrams.at(i).socket->socketDescriptor() < 0)
+        {
+            int sent = send(m_datagrams, 0, m_datagrams.count());
+            m_datagrams.resize(0);
+            return sent;
+        }
+    }
+
+    int count = m_datagrams.count();
+    int window = int(qMin(interval, qint64(QLCUDPBATCH_MAX_FRAME_US)) * m_pacing / 100);
+    m_pacer->post(m_datagrams, window);
+
+    return count;
+}
+
+void QLCUdpBatch::setPacing(int percent)
+{
+    percent = qBound(0, percent, QLCUDPBATCH_MAX_PACING);
+    if (percent == m_pacing)
+        return;
+
+    m_pacing = percent;
+
+    if (m_pacing == 0)
+    {
+        if (m_pacer != NULL)
+        {
+            m_pacer->stop();
+            delete m_pacer;
+            m_pacer = NULL;
+        }
+        m_frameTimer.invalidate();
+    }
+    else if (m_pacer == NULL)
+    {
+        m_pacer = new QLCUdpPacer();
+        m_pacer->start(QThread::HighPriority);
+    }
+}
+
+int QLCUdpBatch::pacing() const
+{
+    return m_pacing;
+}
+
+int QLCUdpBatch::send(const QVector<Datagram> &datagrams, int from, int to)
+{
+    int sent = 0;
+
+    while (from < to)
+    {
+        int end = from + 1;
+        while (end < to && end - from < QLCUDPBATCH_SIZE &&
+               datagrams.at(end).socket == datagrams.at(from).socket)
+            end++;
+
+        sent += sendSocket(datagrams, from, end);
+        from = end;
+    }
+
+    return sent;
+}
+
+#ifdef QLCUDPBATCH_SENDMMSG
+/** Fill $addr with $address:$port for a socket of the given $family */
+static socklen_t fillSockAddr(struct sockaddr_storage *addr, int family,
+                              const QHostAddress &address, quint16 port)
+{
+    memset(addr, 0, sizeof(*addr));
+
+    if (family == AF_INET && address.protocol() == QAbstractSocket::IPv4Protocol)
+    {
+        struct sockaddr_in *in4 = reinterpret_cast<struct sockaddr_in *>(addr);
+        in4->sin_family = AF_INET;
+        in4->sin_port = htons(port);
+        in4->sin_addr.s_addr = htonl(address.toIPv4Address());
+        return sizeof(struct sockaddr_in);
+    }
+
+    if (family == AF_INET6)
+    {
+        struct sockaddr_in6 *in6 = reinterpret_cast<struct sockaddr_in6 *>(addr);
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(port);
+
+        if (address.protocol() == QAbstractSocket::IPv4Protocol)
+        {
+            // IPv4 mapped address for dual stack sockets
+            quint32 ip4 = htonl(address.toIPv4Address());
+            in6->sin6_addr.s6_addr[10] = 0xff;
+            in6->sin6_addr.s6_addr[11] = 0xff;
+            memcpy(&in6->sin6_addr.s6_addr[12], &ip4, sizeof(ip4));
+            return sizeof(struct sockaddr_in6);
+        }
+
+        if (address.protocol() == QAbstractSocket::IPv6Protocol)
+        {
+            Q_IPV6ADDR ip6 = address.toIPv6Address();
+            memcpy(&in6->sin6_addr, &ip6, sizeof(ip6));
+            return sizeof(struct sockaddr_in6);
+        }
+    }
+
+    return 0;
+}
+#endif
+
+int QLCUdpBatch::sendSocket(const QVector<Datagram> &datagrams, int from, int to)
+{
+    QUdpSocket *socket = datagrams.at(from).socket;
+    int sent = 0;
+
+#ifdef QLCUDPBATCH_SENDMMSG
+    // a socket never used yet has no descriptor: the first
+    // datagrams go through Qt, which binds it
+    int fd = int(socket->socketDescriptor());
+    struct sockaddr_storage local;
+    socklen_t localLength = sizeof(local);
+
+    if (fd >= 0 && getsockname(fd, reinterpret_cast<struct sockaddr *>(&local), &localLength) == 0)
+    {
+        struct mmsghdr messages[QLCUDPBATCH_SIZE];
+        struct iovec vectors[QLCUDPBATCH_SIZE];
+        struct sockaddr_storage addresses[QLCUDPBATCH_SIZE];
+        unsigned int count = 0;
+
+        for (int i = from; i < to && count < QLCUDPBATCH_SIZE; i++, count++)
+        {
+            const Datagram &datagram = datagrams.at(i);
+            socklen_t length = fillSockAddr(&addresses[count], local.ss_family,
+                                            datagram.address, datagram.port);
+            if (length == 0)
+                break;
+
+            vectors[count].iov_base = const_cast<char *>(datagram.data.constData());
+            vectors[count].iov_len = datagram.data.size();
+
+            memset(&messages[count], 0, sizeof(messages[count]));
+            messages[count].msg_hdr.msg_name = &addresses[count];
+            messages[count].msg_hdr.msg_namelen = length;
+            messages[count].msg_hdr.msg_iov = &vectors[count];
+            messages[count].msg_hdr.msg_iovlen = 1;
+        }
+
+        if (count > 0)
+        {
+            int ret = sendmmsg(fd, messages, count, 0);
+            if (ret > 0)
+            {
+                sent += ret;
+                from += ret;
+            }
+        }
+    }
+#endif
+
+    // whatever couldn't be sent in a batch is sent one by one,
+    // so that errors are reported by the socket as usual
+    for (int i = from; i < to; i++)
+    {
+        const Datagram &datagram = datagrams.at(i);
+        if (socket->writeDatagram(datagram.data, datagram.address, datagram.port) < 0)
+        {
+            // a network failure hits every datagram of every frame
+            static QLCLogLimiter limiter(1);
+            int suppressed;
+            if (limiter.allow(&suppressed))
+                qCWarning(lcUdpBatch) << "Datagram not sent to" << datagram.address.toString()
+                                      << ":" << socket->errorString() << ", suppressed:" << suppressed;
+        }
+        else
+            sent++;
+    }
+
+    return sent;
+}
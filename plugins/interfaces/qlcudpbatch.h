@@ -0,0 +1,128 @@
+/*
+  Q Light Controller Plus
+  qlcudpbatch.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef QLCUDPBATCH_H
+#define QLCUDPBATCH_H
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QByteArray>
+#include <QVector>
+
+class QLCUdpPacer;
+class QUdpSocket;
+
+/** The maximum number of datagrams queued before they are sent anyway */
+#define QLCUDPBATCH_SIZE 64
+
+/** The highest percentage of the frame interval a frame can be paced over */
+#define QLCUDPBATCH_MAX_PACING 90
+
+/** The longest frame interval considered when pacing, in microseconds */
+#define QLCUDPBATCH_MAX_FRAME_US 100000
+
+/**
+ * QLCUdpBatch collects the datagrams a network plugin sends during a frame,
+ * and sends them all at once when flushed, typically from
+ * QLCIOPlugin::frameComplete().
+ *
+ * On Linux, consecutive datagrams of the same socket are sent with a single
+ * sendmmsg() call. Elsewhere, or when that fails, they are sent one by one
+ * with QUdpSocket::writeDatagram().
+ *
+ * When pacing is enabled, a flush doesn't send the frame at once. The
+ * datagrams are handed to a sender thread, which spreads them evenly over
+ * a percentage of the interval measured between two flushes, so that a
+ * large rig doesn't hit the network switches with a burst of packets at
+ * every frame. Datagrams queued as not paced, like the sync packets, are
+ * sent right after the last paced chunk, and a frame still being sent
+ * when the next one is flushed is completed at once, so the order of the
+ * frames is kept and the caller never waits.
+ *
+ * The class is not thread safe: plugins are expected to use it with the
+ * same lock protecting their sockets. Datagrams still queued when the
+ * batch is destroyed are discarded, since their sockets may be gone.
+ */
+class QLCUdpBatch
+{
+public:
+    QLCUdpBatch();
+    ~QLCUdpBatch();
+
+    /**
+     * Queue $data to be sent with $socket to $address:$port at the next
+     * flush. If the batch is full, the queued datagrams are sent first,
+     * unless pacing is enabled, in which case the whole frame is kept.
+     * A datagram not $paced is sent after all the paced ones of its frame.
+     *
+     * @return The number of datagrams sent by an automatic flush, or 0
+     */
+    int queue(QUdpSocket *socket, const QByteArray &data,
+              const QHostAddress &address, quint16 port, bool paced = true);
+
+    /** Return the number of datagrams waiting to be sent */
+    int count() const;
+
+    /**
+     * Send all the queued datagrams
+     *
+     * @return The number of datagrams successfully sent, or with pacing
+     *         enabled, the number of datagrams handed to the sender thread
+     */
+    int flush();
+
+    /**
+     * Set the percentage of the frame interval the datagrams of a frame
+     * are spread over, up to QLCUDPBATCH_MAX_PACING. 0 disables pacing.
+     */
+    void setPacing(int percent);
+
+    /** Return the pacing percentage, or 0 when pacing is disabled */
+    int pacing() const;
+
+private:
+    struct Datagram
+    {
+        QUdpSocket *socket;
+        QByteArray data;
+        QHostAddress address;
+        quint16 port;
+        bool paced;
+    };
+
+    /** Send the datagrams from $from to $to (excluded) of $datagrams,
+     *  grouping the consecutive ones of the same socket */
+    static int send(const QVector<Datagram> &datagrams, int from, int to);
+
+    /** Send the datagrams from $from to $to (excluded) of $datagrams,
+     *  which all belong to the same socket */
+    static int sendSocket(const QVector<Datagram> &datagrams, int from, int to);
+
+private:
+    QVector<Datagram> m_datagrams;
+
+    int m_pacing;
+    QLCUdpPacer *m_pacer;
+    /** Measures the interval between two flushes when pacing */
+    QElapsedTimer m_frameTimer;
+
+    friend class QLCUdpPacer;
+};
+
+#endif
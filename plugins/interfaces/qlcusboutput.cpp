@@ -0,0 +1,153 @@
+/*
+  Q Light Controller Plus
+  qlcusboutput.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QDebug>
+
+#include "qlcusboutput.h"
+
+QLCUsbOutput::QLCUsbOutput(Writer *writer, QObject *parent)
+    : QThread(parent)
+    , m_writer(writer)
+    , m_running(false)
+    , m_refreshInterval(0)
+    , m_framesWritten(0)
+    , m_framesReplaced(0)
+    , m_writeErrors(0)
+{
+    Q_ASSERT(writer != NULL);
+}
+
+QLCUsbOutput::~QLCUsbOutput()
+{
+    stopOutput();
+}
+
+void QLCUsbOutput::startOutput()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_running == true)
+        return;
+
+    m_running = true;
+    m_lastWrite.start();
+    start(QThread::TimeCriticalPriority);
+}
+
+void QLCUsbOutput::stopOutput()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = false;
+        m_queueCondition.wakeAll();
+    }
+
+    wait();
+
+    QMutexLocker locker(&m_mutex);
+    m_frames.clear();
+    m_pendingLines.clear();
+}
+
+void QLCUsbOutput::setRefreshInterval(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_refreshInterval = qMax(0, ms);
+    m_queueCondition.wakeAll();
+}
+
+int QLCUsbOutput::refreshInterval() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_refreshInterval;
+}
+
+void QLCUsbOutput::queueFrame(quint32 line, const QByteArray &data)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_pendingLines.contains(line))
+        m_framesReplaced++;
+    else
+        m_pendingLines.append(line);
+
+    m_frames[line] = data;
+    m_queueCondition.wakeOne();
+}
+
+quint64 QLCUsbOutput::framesWritten() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_framesWritten;
+}
+
+quint64 QLCUsbOutput::framesReplaced() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_framesReplaced;
+}
+
+quint64 QLCUsbOutput::writeErrors() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_writeErrors;
+}
+
+void QLCUsbOutput::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (m_running == true)
+    {
+        if (m_pendingLines.isEmpty())
+        {
+            if (m_refreshInterval == 0 || m_frames.isEmpty())
+            {
+                m_queueCondition.wait(&m_mutex);
+                continue;
+            }
+
+            qint64 remaining = m_refreshInterval - m_lastWrite.elapsed();
+            if (remaining > 0)
+            {
+                m_queueCondition.wait(&m_mutex, ulong(remaining));
+                continue;
+            }
+
+            // nothing new arrived in time: write every line again
+            m_pendingLines = m_frames.keys();
+        }
+
+        quint32 line = m_pendingLines.takeFirst();
+        // a shallow copy: a frame queued meanwhile replaces the map entry,
+        // not the data being written
+        QByteArray data = m_frames.value(line);
+        m_lastWrite.restart();
+
+        locker.unlock();
+        bool ok = m_writer->writeFrame(line, data);
+        locker.relock();
+
+        if (ok)
+            m_framesWritten++;
+        else
+            m_writeErrors++;
+    }
+}
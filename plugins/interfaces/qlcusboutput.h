@@ -0,0 +1,120 @@
+/*
+  Q Light Controller Plus
+  qlcusboutput.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef QLCUSBOUTPUT_H
+#define QLCUSBOUTPUT_H
+
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QThread>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+
+/**
+ * QLCUsbOutput moves the USB transfers of a DMX output plugin out of the
+ * universe thread. Frames are queued with queueFrame(), which never blocks
+ * on the device, and are written by a dedicated thread through the
+ * QLCUsbOutput::Writer interface the plugin implements.
+ *
+ * Only one transfer per output is in flight at any time. While it is being
+ * written, newer frames of the same line replace the queued one, so a slow
+ * device is always given the latest data instead of falling behind.
+ *
+ * When a refresh interval is set, the last frame of every line is written
+ * again if no new frame arrived in the meantime, for devices which need
+ * to be refreshed continuously.
+ */
+class QLCUsbOutput : public QThread
+{
+    Q_OBJECT
+
+public:
+    /** Interface to be implemented by the plugin performing the transfers */
+    class Writer
+    {
+    public:
+        virtual ~Writer() { }
+
+        /**
+         * Write $data to the device output $line. This is called from the
+         * output thread, which is stopped before the device is closed.
+         *
+         * @return true on success, false if the transfer failed
+         */
+        virtual bool writeFrame(quint32 line, const QByteArray &data) = 0;
+    };
+
+    QLCUsbOutput(Writer *writer, QObject *parent = 0);
+    ~QLCUsbOutput();
+
+    /** Start the output thread, if not already running */
+    void startOutput();
+
+    /** Stop the output thread, waiting for the transfer in flight.
+     *  The frames still queued are discarded */
+    void stopOutput();
+
+    /** Set the interval in milliseconds after which the last frame of every
+     *  line is written again. 0 (the default) disables refreshing */
+    void setRefreshInterval(int ms);
+    int refreshInterval() const;
+
+    /** Queue $data to be written to $line, replacing a frame of the same
+     *  line still waiting to be written */
+    void queueFrame(quint32 line, const QByteArray &data);
+
+    /** Return the number of frames written so far */
+    quint64 framesWritten() const;
+
+    /** Return the number of queued frames replaced by a newer one
+     *  before they could be written */
+    quint64 framesReplaced() const;
+
+    /** Return the number of failed transfers */
+    quint64 writeErrors() const;
+
+private:
+    /** @reimp */
+    void run();
+
+private:
+    Writer *m_writer;
+    bool m_running;
+    int m_refreshInterval;
+
+    /** The last frame queued for each line */
+    QMap<quint32, QByteArray> m_frames;
+
+    /** The lines with a frame waiting to be written, in queue order */
+    QList<quint32> m_pendingLines;
+
+    /** Time of the last write, to schedule the refresh */
+    QElapsedTimer m_lastWrite;
+
+    quint64 m_framesWritten;
+    quint64 m_framesReplaced;
+    quint64 m_writeErrors;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_queueCondition;
+};
+
+#endif
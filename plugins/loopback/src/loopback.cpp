@@ -58,7 +58,7 @@ QString Loopback::name()
 
 int Loopback::capabilities() const
 {
-    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Feedback;
+    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Feedback | QLCIOPlugin::Synchronous;
 }
 
 /*****************************************************************************
@@ -81,6 +81,7 @@ void Loopback::closeOutput(quint32 output, quint32 universe)
 {
     m_outputMap.remove(output);
     m_channelData.remove(output);
+    m_changedMask.remove(output);
     removeFromMap(output, universe, Output);
 }
 
@@ -192,16 +193,29 @@ void Loopback::writeUniverse(quint32 universe, quint32 output, const QByteArray
     if (m_inputMap.contains(output))
     {
         quint32 inputUniverse = m_inputMap[output];
+        int count = qMin(data.size(), chData.size());
+        const char *src = data.constData();
+        char *dst = chData.data();
+        bool changed = false;
 
-        for (int i = 0; i < data.size(); i++)
+        QByteArray &mask = m_changedMask[output];
+        mask.fill(0, (count + 7) / 8);
+        char *bits = mask.data();
+
+        for (int i = 0; i < count; i++)
         {
-            if (chData[i] != data[i])
+            if (dst[i] != src[i])
             {
-                chData[i] = data[i];
-                //qDebug() << "Data changed at" << i << QString::number(chData[i]) << QString::number(data[i]);
-                emit valueChanged(inputUniverse, output, i, chData[i]);
+                dst[i] = src[i];
+                bits[i / 8] |= char(1 << (i % 8));
+                changed = true;
             }
         }
+
+        // the whole frame is handed to the input patch at once, while
+        // the universe that wrote it is still being processed
+        if (changed)
+            emit universeChanged(inputUniverse, output, chData, mask);
     }
 }
 
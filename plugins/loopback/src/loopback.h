@@ -94,6 +94,9 @@ private:
     //! loopback line -> channel data
     QMap<quint32, QByteArray> m_channelData;
 
+    //! loopback line -> bit mask of the channels changed by the last write
+    QMap<quint32, QByteArray> m_changedMask;
+
     typedef QMap<quint32, quint32> TLineUniverseMap;
 
     //! output line -> universe
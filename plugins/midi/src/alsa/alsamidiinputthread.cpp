@@ -27,6 +27,11 @@
 
 #define POLL_TIMEOUT_MS 1000
 
+/** The minimum time between two emissions of the continuous controllers,
+ *  matching the default engine tick. Events received in the meantime
+ *  are coalesced to the latest value of each channel */
+#define ALSA_INPUT_COALESCE_MS 20
+
 AlsaMidiInputThread::AlsaMidiInputThread(snd_seq_t* alsa,
                                          const snd_seq_addr_t* destinationAddress,
                                          QObject* parent)
@@ -104,6 +109,7 @@ bool AlsaMidiInputThread::removeDevice(AlsaMidiInputDevice* device)
            unsubscribeDevice(device);
            m_changed = true;
         }
+        m_pendingValues.remove(device);
 
         empty = (m_devices.size() == 0);
     }
@@ -179,15 +185,21 @@ void AlsaMidiInputThread::run()
             m_changed = false;
         }
 
+        int timeout = pollTimeout();
+
         locker.unlock();
 
         // Poll for MIDI events from the polled descriptors outside of mutex lock
-        if (poll(pfd, npfd, POLL_TIMEOUT_MS) > 0)
+        if (poll(pfd, npfd, timeout) > 0)
             readEvent();
 
         locker.relock();
+
+        flushValues(false);
     }
 
+    m_pendingValues.clear();
+
     qDebug() << Q_FUNC_INFO << "end";
 }
 
@@ -267,6 +279,15 @@ void AlsaMidiInputThread::readEvent()
             data1 = ev->data.note.note;
             data2 = ev->data.note.velocity;
         }
+        else if (ev->type == SND_SEQ_EVENT_QFRAME)
+        {
+            uchar data = uchar(ev->data.control.value);
+            snd_seq_free_event(ev);
+            // timecode frames keep their order with the queued values
+            flushValues(true);
+            device->processMTCQuarterFrame(data);
+            continue;
+        }
         else if (snd_seq_ev_is_queue_type(ev))
         {
             if (device->processMBC(ev->type) == false)
@@ -297,12 +318,78 @@ void AlsaMidiInputThread::readEvent()
         if (QLCMIDIProtocol::midiToInput(cmd, data1, data2, uchar(device->midiChannel()),
                                          &channel, &value) == true)
         {
-            device->emitValueChanged(channel, value);
-            // for MIDI beat clock signals,
-            // generate a synthetic release event
-            if (cmd >= MIDI_BEAT_CLOCK && cmd <= MIDI_BEAT_STOP)
-                device->emitValueChanged(channel, 0);
+            device->process14BitControlChange(cmd, data1, data2, &channel, &value);
+
+            switch (MIDI_CMD(cmd))
+            {
+                case MIDI_CONTROL_CHANGE:
+                case MIDI_PITCH_WHEEL:
+                case MIDI_NOTE_AFTERTOUCH:
+                case MIDI_CHANNEL_AFTERTOUCH:
+                    // only the latest position of a continuous controller matters
+                    queueValue(device, channel, value);
+                break;
+
+                default:
+                    // notes, program changes and clock signals must not be
+                    // lost, and keep their order with the queued values
+                    flushValues(true);
+                    device->emitValueChanged(channel, value);
+                    // for MIDI beat clock signals,
+                    // generate a synthetic release event
+                    if (cmd >= MIDI_BEAT_CLOCK && cmd <= MIDI_BEAT_STOP)
+                        device->emitValueChanged(channel, 0);
+                break;
+            }
         }
     } while (snd_seq_event_input_pending(m_alsa, 0) > 0);
+
+    // a single event after a quiet period goes out immediately
+    flushValues(false);
+}
+
+/****************************************************************************
+ * Event coalescing
+ ****************************************************************************/
+
+void AlsaMidiInputThread::queueValue(AlsaMidiInputDevice* device, uint channel, uchar value)
+{
+    m_pendingValues[device][channel] = value;
+}
+
+void AlsaMidiInputThread::flushValues(bool force)
+{
+    if (m_pendingValues.isEmpty())
+        return;
+
+    if (force == false && m_flushTimer.isValid() &&
+        m_flushTimer.elapsed() < ALSA_INPUT_COALESCE_MS)
+        return;
+
+    QHashIterator <AlsaMidiInputDevice*, QMap<uint,uchar> > it(m_pendingValues);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        QMapIterator <uint,uchar> vit(it.value());
+        while (vit.hasNext() == true)
+        {
+            vit.next();
+            it.key()->emitValueChanged(vit.key(), vit.value());
+        }
+    }
+
+    m_pendingValues.clear();
+    m_flushTimer.start();
+}
+
+int AlsaMidiInputThread::pollTimeout() const
+{
+    if (m_pendingValues.isEmpty())
+        return POLL_TIMEOUT_MS;
+
+    if (m_flushTimer.isValid() == false)
+        return 0;
+
+    return int(qMax(qint64(0), ALSA_INPUT_COALESCE_MS - m_flushTimer.elapsed()));
 }
 
@@ -20,10 +20,12 @@
 #ifndef ALSAMIDIINPUTTHREAD_H
 #define ALSAMIDIINPUTTHREAD_H
 
+#include <QElapsedTimer>
 #include <QVariant>
 #include <QThread>
 #include <QMutex>
 #include <QHash>
+#include <QMap>
 
 struct _snd_seq;
 typedef _snd_seq snd_seq_t;
@@ -77,6 +79,29 @@ private:
 
     void readEvent();
 
+    /*************************************************************************
+     * Event coalescing
+     *************************************************************************/
+private:
+    /** Store the value of a continuous controller, replacing the one
+     *  of the same channel still waiting to be emitted */
+    void queueValue(AlsaMidiInputDevice* device, uint channel, uchar value);
+
+    /** Emit the values queued so far. Unless $force is true, this
+     *  happens at most once every ALSA_INPUT_COALESCE_MS.
+     *  Must be called with m_mutex locked */
+    void flushValues(bool force);
+
+    /** Return the poll timeout, shorter when values are waiting
+     *  to be emitted. Must be called with m_mutex locked */
+    int pollTimeout() const;
+
+private:
+    /** The latest values of the continuous controllers (CC, pitch bend,
+     *  aftertouch) received since the last flush, for each device */
+    QHash <AlsaMidiInputDevice*, QMap<uint,uchar> > m_pendingValues;
+    QElapsedTimer m_flushTimer;
+
 private:
     bool m_running;
     bool m_changed;
@@ -37,7 +37,6 @@ AlsaMidiOutputDevice::AlsaMidiOutputDevice(const QVariant& uid,
     , m_alsa(alsa)
     , m_receiver_address(new snd_seq_addr_t)
     , m_open(false)
-    , m_universe(MAX_MIDI_DMX_CHANNELS, char(0))
 {
     Q_ASSERT(alsa != NULL);
     Q_ASSERT(recv_address != NULL);
@@ -98,25 +97,17 @@ bool AlsaMidiOutputDevice::isOpen() const
 
 void AlsaMidiOutputDevice::writeChannel(ushort channel, uchar value)
 {
-    // m_universe contains scaled values (0-127), so we have to compare scaled value as well
-    // however, since writeUniverse scales the value again, we have to store unscaled value.
-    char scaled = DMX2MIDI(value);
-    if (channel < ushort(m_universe.size()) && m_universe[channel] != scaled)
-    {
-        QByteArray tmp(m_universe);
-
-        for (uchar ch = 0; ch < MAX_MIDI_DMX_CHANNELS && ch < tmp.size(); ++ch)
-        {
-           char midi = tmp[ch];
-           tmp[ch] = (char)MIDI2DMX(midi);
-        }
-
-        tmp[channel] = value;
-        writeUniverse(tmp);
-    }
+    storeChannel(channel, value);
+    writeChanges();
 }
 
 void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
+{
+    storeUniverse(universe);
+    writeChanges();
+}
+
+void AlsaMidiOutputDevice::writeChanges()
 {
     if (isOpen() == false)
         return;
@@ -128,42 +119,33 @@ void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
     //snd_seq_ev_set_subs(&ev);
     snd_seq_ev_set_direct(&ev);
 
-    // Since MIDI devices can have only 128 real channels, we don't
-    // attempt to write more than that.
-    for (uchar channel = 0; channel < MAX_MIDI_DMX_CHANNELS &&
-                            channel < universe.size(); channel++)
+    // The sequencer encodes consecutive events with running status,
+    // so a message costs two bytes after the first one
+    uchar channel;
+    int size = 3;
+    beginChanges();
+
+    while (nextChange(channel, size))
     {
-        // Scale 0-255 to 0-127
-        char scaled = DMX2MIDI(universe[channel]);
+        char scaled = midiValue(channel);
         bool invalidData = false;
-
-        // Since MIDI is so slow, we only send values that are actually changed
-        if (m_universe[channel] == scaled)
-            continue;
-
-        // Store the changed MIDI value
-        m_universe[channel] = scaled;
+        size = 2;
 
         if (mode() == Note)
         {
-            qDebug() << "Send out NOTE";
             // 0 is sent as a note off
             // 1-127 is sent as note on
             if (scaled == 0)
                 snd_seq_ev_set_noteoff(&ev, midiChannel(), channel, scaled);
             else
                 snd_seq_ev_set_noteon(&ev, midiChannel(), channel, scaled);
-            snd_seq_event_output(m_alsa, &ev);
         }
         else if (mode() == ProgramChange)
         {
-            qDebug() << "Send out Program Change";
             snd_seq_ev_set_pgmchange(&ev, midiChannel(), channel);
         }
         else if (mode() == ControlChange)
         {
-            qDebug() << "Send out CC. Channel: " << midiChannel() << ", CC: " << channel << ", val: " << scaled;
-
             // Control change
             snd_seq_ev_set_controller(&ev, midiChannel(), channel, scaled);
         }
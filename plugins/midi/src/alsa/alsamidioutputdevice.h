@@ -45,12 +45,15 @@ public:
     void writeFeedback(uchar cmd, uchar data1, uchar data2);
     void writeSysEx(QByteArray message);
 
+private:
+    /** Write the changed channels, as many as the bandwidth allows */
+    void writeChanges();
+
 private:
     snd_seq_t* m_alsa;
     snd_seq_addr_t* m_receiver_address;
     snd_seq_addr_t* m_sender_address;
     bool m_open;
-    QByteArray m_universe;
 };
 
 #endif
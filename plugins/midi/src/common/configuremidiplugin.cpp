@@ -19,6 +19,7 @@
 
 #include <QTreeWidgetItem>
 #include <QTreeWidget>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QSpinBox>
 #include <QDebug>
@@ -36,6 +37,8 @@
 #define COL_CHANNEL     1
 #define COL_MODE        2
 #define COL_INITMESSAGE 3
+#define COL_BANDWIDTH   4
+#define COL_14BITCC     5
 
 ConfigureMidiPlugin::ConfigureMidiPlugin(MidiPlugin* plugin, QWidget* parent)
     : QDialog(parent)
@@ -118,6 +121,32 @@ void ConfigureMidiPlugin::slotInitMessageChanged(QString midiTemplateName)
     dev->setMidiTemplateName(midiTemplateName);
 }
 
+void ConfigureMidiPlugin::slotBandwidthActivated(int index)
+{
+    QComboBox* combo = qobject_cast<QComboBox*> (QObject::sender());
+    Q_ASSERT(combo != NULL);
+
+    QVariant var = combo->property(PROP_DEV);
+    Q_ASSERT(var.isValid() == true);
+
+    MidiOutputDevice* dev = (MidiOutputDevice*) var.toULongLong();
+    Q_ASSERT(dev != NULL);
+    dev->setBandwidth(combo->itemData(index).toInt());
+}
+
+void ConfigureMidiPlugin::slot14BitControlChangeToggled(bool checked)
+{
+    QCheckBox* check = qobject_cast<QCheckBox*> (QObject::sender());
+    Q_ASSERT(check != NULL);
+
+    QVariant var = check->property(PROP_DEV);
+    Q_ASSERT(var.isValid() == true);
+
+    MidiInputDevice* dev = (MidiInputDevice*) var.toULongLong();
+    Q_ASSERT(dev != NULL);
+    dev->set14BitControlChange(checked);
+}
+
 
 void ConfigureMidiPlugin::slotUpdateTree()
 {
@@ -144,6 +173,10 @@ void ConfigureMidiPlugin::slotUpdateTree()
         widget = createInitMessageWidget(dev->midiTemplateName());
         widget->setProperty(PROP_DEV, (qulonglong) dev);
         m_tree->setItemWidget(item, COL_INITMESSAGE, widget);
+
+        widget = createBandwidthWidget(dev->bandwidth());
+        widget->setProperty(PROP_DEV, (qulonglong) dev);
+        m_tree->setItemWidget(item, COL_BANDWIDTH, widget);
     }
 
     QTreeWidgetItem* inputs = new QTreeWidgetItem(m_tree);
@@ -167,6 +200,12 @@ void ConfigureMidiPlugin::slotUpdateTree()
         widget = createInitMessageWidget(dev->midiTemplateName());
         widget->setProperty(PROP_DEV, (qulonglong) dev);
         m_tree->setItemWidget(item, COL_INITMESSAGE, widget);
+
+        QCheckBox* check = new QCheckBox;
+        check->setChecked(dev->is14BitControlChange());
+        check->setProperty(PROP_DEV, (qulonglong) dev);
+        connect(check, SIGNAL(toggled(bool)), this, SLOT(slot14BitControlChangeToggled(bool)));
+        m_tree->setItemWidget(item, COL_14BITCC, check);
     }
 
     outputs->setExpanded(true);
@@ -235,3 +274,23 @@ QWidget* ConfigureMidiPlugin::createInitMessageWidget(QString midiTemplateName)
 
     return combo;
 }
+
+QWidget* ConfigureMidiPlugin::createBandwidthWidget(int bandwidth)
+{
+    QComboBox* combo = new QComboBox;
+    combo->addItem(tr("Unlimited"), 0);
+    combo->addItem(tr("DIN (31.25 kbaud)"), MIDI_DIN_BANDWIDTH);
+
+    int index = combo->findData(bandwidth);
+    if (index == -1)
+    {
+        // a custom rate set through the plugin parameters
+        combo->addItem(tr("%1 bytes/s").arg(bandwidth), bandwidth);
+        index = combo->count() - 1;
+    }
+    combo->setCurrentIndex(index);
+
+    connect(combo, SIGNAL(activated(int)), this, SLOT(slotBandwidthActivated(int)));
+
+    return combo;
+}
@@ -17,21 +17,114 @@
   limitations under the License.
 */
 
+#include <QSettings>
 #include <QDebug>
+
 #include "midiinputdevice.h"
+#include "midiprotocol.h"
+
+#define SETTINGS_14BITCC "midiplugin/Input/%1/14bitcc"
+
+/** The number of Control Change MSB/LSB pairs of a MIDI channel */
+#define MIDI_CC_PAIRS 32
 
 MidiInputDevice::MidiInputDevice(const QVariant& uid, const QString& name, QObject* parent)
     : MidiDevice(uid, name, Input, parent)
+    , m_14BitControlChange(false)
+    , m_controlChangeMSB(MAX_MIDI_CHANNELS * MIDI_CC_PAIRS, char(0))
+    , m_mtcNextPiece(-1)
 {
     //qDebug() << Q_FUNC_INFO;
+    load14BitControlChange();
 }
 
 MidiInputDevice::~MidiInputDevice()
 {
     //qDebug() << Q_FUNC_INFO;
+    save14BitControlChange();
 }
 
 void MidiInputDevice::emitValueChanged(uint channel, uchar value)
 {
     emit valueChanged(uid(), channel, value);
 }
+
+/****************************************************************************
+ * 14-bit Control Change
+ ****************************************************************************/
+
+void MidiInputDevice::set14BitControlChange(bool enable)
+{
+    m_14BitControlChange = enable;
+}
+
+bool MidiInputDevice::is14BitControlChange() const
+{
+    return m_14BitControlChange;
+}
+
+void MidiInputDevice::process14BitControlChange(uchar cmd, uchar data1, uchar data2,
+                                                quint32* channel, uchar* value)
+{
+    if (m_14BitControlChange == false || MIDI_CMD(cmd) != MIDI_CONTROL_CHANGE ||
+        data1 >= MIDI_CC_PAIRS * 2)
+        return;
+
+    int index = MIDI_CH(cmd) * MIDI_CC_PAIRS + (data1 % MIDI_CC_PAIRS);
+
+    if (data1 < MIDI_CC_PAIRS)
+    {
+        // a new MSB resets the LSB to zero
+        m_controlChangeMSB[index] = char(data2);
+        return;
+    }
+
+    // the LSB refines the value of the MSB channel
+    ushort combined = (uchar(m_controlChangeMSB.at(index)) << 7) | (data2 & 0x7F);
+    *channel -= MIDI_CC_PAIRS;
+    *value = uchar(combined >> 6);
+}
+
+/****************************************************************************
+ * MIDI Timecode
+ ****************************************************************************/
+
+void MidiInputDevice::processMTCQuarterFrame(uchar data)
+{
+    int piece = (data >> 4) & 0x07;
+
+    // a piece out of order drops the frame being assembled
+    if (piece != m_mtcNextPiece && piece != 0)
+    {
+        m_mtcNextPiece = -1;
+        return;
+    }
+
+    m_mtcPieces[piece] = data & 0x0F;
+    m_mtcNextPiece = piece + 1;
+
+    if (piece < 7)
+        return;
+
+    m_mtcNextPiece = -1;
+
+    emitValueChanged(CHANNEL_OFFSET_MTC_FRAMES, (m_mtcPieces[1] & 0x01) << 4 | m_mtcPieces[0]);
+    emitValueChanged(CHANNEL_OFFSET_MTC_SECONDS, (m_mtcPieces[3] & 0x03) << 4 | m_mtcPieces[2]);
+    emitValueChanged(CHANNEL_OFFSET_MTC_MINUTES, (m_mtcPieces[5] & 0x03) << 4 | m_mtcPieces[4]);
+    // the last piece holds the frame rate and the high bit of the hours
+    emitValueChanged(CHANNEL_OFFSET_MTC_HOURS, (m_mtcPieces[7] & 0x07) << 4 | m_mtcPieces[6]);
+}
+
+void MidiInputDevice::load14BitControlChange()
+{
+    QSettings settings;
+    QVariant value = settings.value(QString(SETTINGS_14BITCC).arg(name()));
+    if (value.isValid() == true)
+        set14BitControlChange(value.toBool());
+}
+
+void MidiInputDevice::save14BitControlChange() const
+{
+    QSettings settings;
+    settings.setValue(QString(SETTINGS_14BITCC).arg(name()), is14BitControlChange());
+}
@@ -20,6 +20,8 @@
 #ifndef MIDIINPUTDEVICE_H
 #define MIDIINPUTDEVICE_H
 
+#include <QByteArray>
+
 #include "mididevice.h"
 
 class MidiInputDevice : public MidiDevice
@@ -34,6 +36,51 @@ public:
 
 signals:
     void valueChanged(const QVariant& uid, ushort channel, uchar value);
+
+    /************************************************************************
+     * 14-bit Control Change
+     ************************************************************************/
+public:
+    /** Enable the combination of the Control Change pairs 0-31 (MSB)
+     *  and 32-63 (LSB) into the high resolution input channels 0-31 */
+    void set14BitControlChange(bool enable);
+    bool is14BitControlChange() const;
+
+    /**
+     * When 14-bit Control Change is enabled, turn the input $channel and
+     * $value of a Control Change message, as returned by
+     * QLCMIDIProtocol::midiToInput(), into the ones of its MSB channel,
+     * using the LSB bits to refine the value.
+     */
+    void process14BitControlChange(uchar cmd, uchar data1, uchar data2,
+                                   quint32* channel, uchar* value);
+
+private:
+    void load14BitControlChange();
+    void save14BitControlChange() const;
+
+private:
+    bool m_14BitControlChange;
+
+    /** The last MSB received for each MIDI channel and controller */
+    QByteArray m_controlChangeMSB;
+
+    /************************************************************************
+     * MIDI Timecode
+     ************************************************************************/
+public:
+    /**
+     * Collect the data byte of a MIDI Timecode quarter frame message.
+     * When the eight pieces of a frame have been received in order, the
+     * frame is emitted on the CHANNEL_OFFSET_MTC_* channels.
+     */
+    void processMTCQuarterFrame(uchar data);
+
+private:
+    /** The frame being assembled, one nibble per piece */
+    uchar m_mtcPieces[8];
+    /** The index of the next expected piece, or -1 until piece 0 comes */
+    int m_mtcNextPiece;
 };
 
 #endif
@@ -17,16 +17,126 @@
   limitations under the License.
 */
 
+#include <QSettings>
 #include <QDebug>
+
 #include "midioutputdevice.h"
+#include "midiprotocol.h"
+
+#define SETTINGS_BANDWIDTH "midiplugin/Output/%1/bandwidth"
 
 MidiOutputDevice::MidiOutputDevice(const QVariant& uid, const QString& name, QObject* parent)
     : MidiDevice(uid, name, Output, parent)
+    , m_bandwidth(0)
+    , m_budget(0)
+    , m_values(MAX_MIDI_DMX_CHANNELS, char(0))
+    , m_sentValues(MAX_MIDI_DMX_CHANNELS, char(0))
+    , m_nextChannel(0)
 {
     //qDebug() << Q_FUNC_INFO;
+    loadBandwidth();
 }
 
 MidiOutputDevice::~MidiOutputDevice()
 {
     //qDebug() << Q_FUNC_INFO;
+    saveBandwidth();
+}
+
+/****************************************************************************
+ * Output rate
+ ****************************************************************************/
+
+void MidiOutputDevice::setBandwidth(int bytesPerSecond)
+{
+    m_bandwidth = qMax(0, bytesPerSecond);
+    m_budget = 0;
+    m_budgetTimer.invalidate();
+}
+
+int MidiOutputDevice::bandwidth() const
+{
+    return m_bandwidth;
+}
+
+void MidiOutputDevice::storeUniverse(const QByteArray& universe)
+{
+    // Since MIDI devices can have only 128 real channels, we don't
+    // attempt to store more than that.
+    int count = qMin(universe.size(), int(MAX_MIDI_DMX_CHANNELS));
+    for (int i = 0; i < count; i++)
+        m_values[i] = char(DMX2MIDI(uchar(universe.at(i))));
+}
+
+void MidiOutputDevice::storeChannel(ushort channel, uchar value)
+{
+    if (channel < MAX_MIDI_DMX_CHANNELS)
+        m_values[channel] = char(DMX2MIDI(value));
+}
+
+void MidiOutputDevice::beginChanges()
+{
+    if (m_bandwidth == 0)
+    {
+        m_nextChannel = 0;
+        return;
+    }
+
+    qreal burst = qMax(qreal(m_bandwidth * MIDI_BANDWIDTH_BURST_MS) / 1000.0, 3.0);
+
+    if (m_budgetTimer.isValid() == false)
+    {
+        m_budgetTimer.start();
+        m_budget = burst;
+        return;
+    }
+
+    m_budget = qMin(m_budget + qreal(m_budgetTimer.restart() * m_bandwidth) / 1000.0, burst);
+}
+
+bool MidiOutputDevice::nextChange(uchar& channel, int size)
+{
+    for (int i = 0; i < MAX_MIDI_DMX_CHANNELS; i++)
+    {
+        uchar ch = (m_nextChannel + i) % MAX_MIDI_DMX_CHANNELS;
+        if (m_values.at(ch) == m_sentValues.at(ch))
+            continue;
+
+        if (m_bandwidth > 0)
+        {
+            if (m_budget < size)
+            {
+                // resume from here on the next write
+                m_nextChannel = ch;
+                return false;
+            }
+            m_budget -= size;
+        }
+
+        m_sentValues[ch] = m_values.at(ch);
+        m_nextChannel = (ch + 1) % MAX_MIDI_DMX_CHANNELS;
+        channel = ch;
+        return true;
+    }
+
+    return false;
+}
+
+uchar MidiOutputDevice::midiValue(uchar channel) const
+{
+    return uchar(m_values.at(channel));
+}
+
+void MidiOutputDevice::loadBandwidth()
+{
+    QSettings settings;
+    QVariant value = settings.value(QString(SETTINGS_BANDWIDTH).arg(name()));
+    if (value.isValid() == true)
+        setBandwidth(value.toInt());
+}
+
+void MidiOutputDevice::saveBandwidth() const
+{
+    QSettings settings;
+    settings.setValue(QString(SETTINGS_BANDWIDTH).arg(name()), bandwidth());
 }
@@ -20,8 +20,17 @@
 #ifndef MIDIOUTPUTDEVICE_H
 #define MIDIOUTPUTDEVICE_H
 
+#include <QElapsedTimer>
+#include <QByteArray>
+
 #include "mididevice.h"
 
+/** Bytes per second of a 31.25 kbaud DIN MIDI link (10 bits per byte) */
+#define MIDI_DIN_BANDWIDTH      3125
+
+/** The longest time of unused bandwidth that can be spent in one write */
+#define MIDI_BANDWIDTH_BURST_MS 50
+
 class MidiOutputDevice : public MidiDevice
 {
     Q_OBJECT
@@ -35,6 +44,56 @@ public:
     virtual void writeUniverse(const QByteArray& universe) = 0;
     virtual void writeFeedback(uchar cmd, uchar data1, uchar data2) = 0;
     virtual void writeSysEx(QByteArray message) = 0;
+
+    /************************************************************************
+     * Output rate
+     ************************************************************************/
+public:
+    /** Set the maximum number of bytes per second written to the device.
+     *  0 (the default) means no limit, which is fine for USB devices */
+    void setBandwidth(int bytesPerSecond);
+    int bandwidth() const;
+
+protected:
+    /** Store the values of $universe, scaled to MIDI, as the ones
+     *  the device should have */
+    void storeUniverse(const QByteArray& universe);
+
+    /** Store the value of a single channel, scaled to MIDI */
+    void storeChannel(ushort channel, uchar value);
+
+    /** Start writing the changed channels, refilling the bandwidth
+     *  budget with the time elapsed since the last write */
+    void beginChanges();
+
+    /**
+     * Get the next channel whose value differs from the one last sent,
+     * if the bandwidth budget allows another message of $size bytes.
+     * The channel is then considered sent, with the value returned by
+     * midiValue(). The channels left over are sent by the next write,
+     * with their newest value, starting from where this one stopped.
+     */
+    bool nextChange(uchar& channel, int size);
+
+    /** Get the latest MIDI value stored for $channel */
+    uchar midiValue(uchar channel) const;
+
+private:
+    void loadBandwidth();
+    void saveBandwidth() const;
+
+private:
+    int m_bandwidth;
+    qreal m_budget;
+    QElapsedTimer m_budgetTimer;
+
+    /** The values the device should have and the ones last sent to it.
+     *  Since MIDI is so slow, only the values that changed are sent */
+    QByteArray m_values;
+    QByteArray m_sentValues;
+
+    /** The channel the next write starts from */
+    uchar m_nextChannel;
 };
 
 #endif
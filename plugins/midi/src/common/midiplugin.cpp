@@ -378,6 +378,12 @@ void MidiPlugin::configure()
                                               MIDI_INITMESSAGE, dev->midiTemplateName());
                 else
                     QLCIOPlugin::unSetParameter(universe, inLine, Input, MIDI_INITMESSAGE);
+
+                if (dev->is14BitControlChange())
+                    QLCIOPlugin::setParameter(universe, inLine, Input,
+                                              MIDI_14BITCC, true);
+                else
+                    QLCIOPlugin::unSetParameter(universe, inLine, Input, MIDI_14BITCC);
             }
             else
                 qDebug() << "[MIDI] coudln't find device for line:" << inLine;
@@ -401,6 +407,9 @@ void MidiPlugin::configure()
                 if (dev->midiTemplateName().isEmpty() == false)
                     QLCIOPlugin::setParameter(universe, outLine, Output,
                                               MIDI_INITMESSAGE, dev->midiTemplateName());
+                if (dev->bandwidth() != 0)
+                    QLCIOPlugin::setParameter(universe, outLine, Output,
+                                              MIDI_BANDWIDTH, dev->bandwidth());
             }
             else
                 qDebug() << "[MIDI] coudln't find device for line:" << outLine;
@@ -437,6 +446,18 @@ void MidiPlugin::setParameter(quint32 universe, quint32 line, Capability type,
             if (dev != NULL)
                 dev->setSendNoteOff(value.toBool());
         }
+        else if (name == MIDI_BANDWIDTH)
+        {
+            MidiOutputDevice *outDev = outputDevice(line);
+            if (outDev != NULL)
+                outDev->setBandwidth(value.toInt());
+        }
+        else if (name == MIDI_14BITCC)
+        {
+            MidiInputDevice *inDev = inputDevice(line);
+            if (inDev != NULL)
+                inDev->set14BitControlChange(value.toBool());
+        }
 
         QLCIOPlugin::setParameter(universe, line, type, name, value);
     }
@@ -39,6 +39,8 @@ class QString;
 #define MIDI_MIDICHANNEL "midichannel"
 #define MIDI_MODE "mode"
 #define MIDI_INITMESSAGE "initmessage"
+#define MIDI_BANDWIDTH "bandwidth"
+#define MIDI_14BITCC "14bitcc"
 
 class MidiPlugin : public QLCIOPlugin
 {
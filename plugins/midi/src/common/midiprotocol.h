@@ -147,4 +147,11 @@ namespace QLCMIDIProtocol
 #define CHANNEL_OFFSET_MBC_BEAT            530
 #define CHANNEL_OFFSET_MBC_STOP            531
 
+// MIDI Timecode: the fields of a complete frame, emitted in this order.
+// The hours channel comes last, as (frame rate << 5) | hours
+#define CHANNEL_OFFSET_MTC_FRAMES          532
+#define CHANNEL_OFFSET_MTC_SECONDS         533
+#define CHANNEL_OFFSET_MTC_MINUTES         534
+#define CHANNEL_OFFSET_MTC_HOURS           535
+
 #endif
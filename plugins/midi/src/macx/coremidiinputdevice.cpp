@@ -72,11 +72,17 @@ static void MidiInProc(const MIDIPacketList* pktList, void* readProcRefCon,
                 if (self->processMBC(cmd) == false)
                     continue;
             }
+            else if (cmd == MIDI_TIME_CODE)
+            {
+                self->processMTCQuarterFrame(data1);
+                continue;
+            }
 
             // Convert the data to QLC input channel & value
             if (QLCMIDIProtocol::midiToInput(cmd, data1, data2, self->midiChannel(),
                                              &channel, &value) == true)
             {
+                self->process14BitControlChange(cmd, data1, data2, &channel, &value);
                 self->emitValueChanged(channel, value);
                 // for MIDI beat clock signals,
                 // generate a synthetic release event
@@ -33,7 +33,6 @@ CoreMidiOutputDevice::CoreMidiOutputDevice(const QVariant& uid, const QString& n
     , m_client(client)
     , m_outPort(0)
     , m_destination(destination)
-    , m_universe(MAX_MIDI_DMX_CHANNELS, char(0))
 {
 }
 
@@ -85,84 +84,84 @@ bool CoreMidiOutputDevice::isOpen() const
 
 void CoreMidiOutputDevice::writeChannel(ushort channel, uchar value)
 {
-    // m_universe contains scaled values (0-127), so we have to compare scaled value as well
-    // however, since writeUniverse scales the value again, we have to store unscaled value.
-    char scaled = DMX2MIDI(value);
-    if (channel < ushort(m_universe.size()) && m_universe[channel] != scaled)
-    {
-        QByteArray tmp(m_universe);
-
-        for (uchar ch = 0; ch < MAX_MIDI_DMX_CHANNELS && ch < tmp.size(); ++ch)
-        {
-           char midi = tmp[ch];
-           tmp[ch] = (char)MIDI2DMX(midi);
-        }
-
-        tmp[channel] = value;
-        writeUniverse(tmp);
-    }
+    storeChannel(channel, value);
+    writeChanges();
 }
 
 void CoreMidiOutputDevice::writeUniverse(const QByteArray& universe)
+{
+    storeUniverse(universe);
+    writeChanges();
+}
+
+void CoreMidiOutputDevice::writeChanges()
 {
     if (isOpen() == false)
         return;
 
-    Byte buffer[512]; // Should be enough for 128 channels
-    MIDIPacketList* list = (MIDIPacketList*) buffer;
-    MIDIPacket* packet = MIDIPacketListInit(list);
-
-    /* Since MIDI devices can have only 128 real channels, we don't
-       attempt to write more than that */
-    for (Byte channel = 0; channel < MAX_MIDI_DMX_CHANNELS &&
-                           channel < universe.size(); channel++)
-    {
-        Byte cmd[3];
-        cmd[1] = channel;
-        cmd[2] = DMX2MIDI(uchar(universe[channel]));
+    /* All the changes go in a single packet, where running status
+       is allowed: the command byte is written only when it changes */
+    Byte data[MAX_MIDI_DMX_CHANNELS * 3];
+    int length = 0;
+    Byte status = 0;
+    uchar channel;
 
-        /* Since MIDI is so slow, we only send values that are
-           actually changed. */
-        if (uchar(m_universe[channel]) == cmd[2])
-            continue;
+    beginChanges();
 
-        /* Store the changed MIDI value. */
-        m_universe[channel] = cmd[2];
+    while (nextChange(channel, status == 0 ? 3 : 2))
+    {
+        Byte value = midiValue(channel);
+        Byte cmd;
 
         if (mode() == Note)
         {
-            if (cmd[2] == 0)
+            if (value == 0)
             {
                 /* Zero is sent as a note off command */
-                cmd[0] = MIDI_NOTE_OFF;
+                cmd = MIDI_NOTE_OFF;
             }
             else
             {
                 /* 1-127 is sent as note on command */
-                cmd[0] = MIDI_NOTE_ON;
+                cmd = MIDI_NOTE_ON;
             }
         }
         else if (mode() == ProgramChange)
         {
             /* Program change */
-            cmd[0] = MIDI_PROGRAM_CHANGE;
+            cmd = MIDI_PROGRAM_CHANGE;
         }
         else
         {
             /* Control change */
-            cmd[0] = MIDI_CONTROL_CHANGE;
+            cmd = MIDI_CONTROL_CHANGE;
         }
 
         /* Encode MIDI channel to the command */
-        cmd[0] |= (Byte) midiChannel();
+        cmd |= (Byte) midiChannel();
 
-        /* Add the MIDI command to the packet list */
-        packet = MIDIPacketListAdd(list, sizeof(buffer), packet, 0, sizeof(cmd), cmd);
-        if (packet == 0)
+        if (cmd != status)
         {
-            qWarning() << "MIDIOut buffer overflow";
-            break;
+            data[length++] = cmd;
+            status = cmd;
         }
+        data[length++] = channel;
+        data[length++] = value;
+    }
+
+    if (length == 0)
+        return;
+
+    Byte buffer[sizeof(data) + 64];
+    MIDIPacketList* list = (MIDIPacketList*) buffer;
+    MIDIPacket* packet = MIDIPacketListInit(list);
+
+    /* Add the MIDI commands to the packet list */
+    packet = MIDIPacketListAdd(list, sizeof(buffer), packet, 0, length, data);
+    if (packet == 0)
+    {
+        qWarning() << "MIDIOut buffer overflow";
+        return;
     }
 
     /* Send the MIDI packet list */
@@ -42,11 +42,14 @@ public:
     void writeFeedback(uchar cmd, uchar data1, uchar data2);
     void writeSysEx(QByteArray message);
 
+private:
+    /** Write the changed channels, as many as the bandwidth allows */
+    void writeChanges();
+
 private:
     MIDIClientRef m_client;
     MIDIPortRef m_outPort;
     MIDIEndpointRef m_destination;
-    QByteArray m_universe;
 };
 
 #endif
@@ -43,6 +43,11 @@ static void CALLBACK MidiInProc(HMIDIIN hMidiIn, UINT wMsg,
             if (self->processMBC(cmd) == false)
                 return;
         }
+        else if (cmd == MIDI_TIME_CODE)
+        {
+            self->processMTCQuarterFrame(data1);
+            return;
+        }
         if (MIDI_CMD(cmd) == MIDI_PROGRAM_CHANGE)
             data2 = 127;
 
@@ -52,6 +57,7 @@ static void CALLBACK MidiInProc(HMIDIIN hMidiIn, UINT wMsg,
         if (QLCMIDIProtocol::midiToInput(cmd, data1, data2,
             uchar(self->midiChannel()), &channel, &value) == true)
         {
+            self->process14BitControlChange(cmd, data1, data2, &channel, &value);
             self->emitValueChanged(channel, value);
             // for MIDI beat clock signals,
             // generate a synthetic release event
@@ -27,7 +27,7 @@ Win32MidiOutputDevice::Win32MidiOutputDevice(const QVariant& uid, const QString&
     : MidiOutputDevice(uid, name, parent)
     , m_id(id)
     , m_handle(NULL)
-    , m_universe(MAX_MIDI_DMX_CHANNELS, char(0))
+    , m_runningStatus(0)
 {
     qDebug() << Q_FUNC_INFO;
 }
@@ -52,6 +52,7 @@ bool Win32MidiOutputDevice::open()
         m_handle = NULL;
         return false;
     }
+    m_runningStatus = 0;
     return true;
 }
 
@@ -79,42 +80,27 @@ bool Win32MidiOutputDevice::isOpen() const
 
 void Win32MidiOutputDevice::writeChannel(ushort channel, uchar value)
 {
-    // m_universe contains scaled values (0-127), so we have to compare scaled value as well
-    // however, since writeUniverse scales the value again, we have to store unscaled value.
-    char scaled = DMX2MIDI(value);
-    if (channel < ushort(m_universe.size()) && m_universe[channel] != scaled)
-    {
-        QByteArray tmp(m_universe);
-
-        for (uchar ch = 0; ch < MAX_MIDI_DMX_CHANNELS && ch < tmp.size(); ++ch)
-        {
-           char midi = tmp[ch];
-           tmp[ch] = (char)MIDI2DMX(midi);
-        }
-
-        tmp[channel] = value;
-        writeUniverse(tmp);
-    }
+    storeChannel(channel, value);
+    writeChanges();
 }
 
 void Win32MidiOutputDevice::writeUniverse(const QByteArray& universe)
+{
+    storeUniverse(universe);
+    writeChanges();
+}
+
+void Win32MidiOutputDevice::writeChanges()
 {
     if (isOpen() == false)
         return;
 
-    for (BYTE channel = 0; channel < MAX_MIDI_DMX_CHANNELS &&
-                           channel < universe.size(); channel++)
-    {
-        /* Scale 0-255 to 0-127 */
-        char scaled = DMX2MIDI(uchar(universe[channel]));
+    BYTE channel;
+    beginChanges();
 
-        /* Since MIDI is so slow, we only send values that are
-           actually changed. */
-        if (m_universe[channel] == scaled)
-            continue;
-
-        /* Store the changed MIDI value */
-        m_universe[channel] = scaled;
+    while (nextChange(channel, m_runningStatus == 0 ? 3 : 2))
+    {
+        BYTE scaled = midiValue(channel);
 
         if (mode() == Note)
         {
@@ -132,13 +118,13 @@ void Win32MidiOutputDevice::writeUniverse(const QByteArray& universe)
         else if (mode() == ProgramChange)
         {
             /* Program change */
-            sendData(MIDI_PROGRAM_CHANGE | (BYTE) midiChannel(), channel, (BYTE)scaled);
+            sendData(MIDI_PROGRAM_CHANGE | (BYTE) midiChannel(), channel, scaled);
         }
         else
         {
             //qDebug() << "[writeUniverse] MIDI: " << midiChannel() << ", channel: " << channel << ", value: " << scaled;
             /* Control change */
-            sendData(MIDI_CONTROL_CHANGE | (BYTE) midiChannel(), channel, (BYTE)scaled);
+            sendData(MIDI_CONTROL_CHANGE | (BYTE) midiChannel(), channel, scaled);
         }
     }
 }
@@ -159,9 +145,23 @@ void Win32MidiOutputDevice::sendData(BYTE command, BYTE channel, BYTE value)
         BYTE bData[4];
     } msg;
 
-    msg.bData[0] = command;
-    msg.bData[1] = channel;
-    msg.bData[2] = value;
+    if (command == m_runningStatus)
+    {
+        /* Running status: the command byte is omitted */
+        msg.bData[0] = channel;
+        msg.bData[1] = value;
+        msg.bData[2] = 0;
+    }
+    else
+    {
+        msg.bData[0] = command;
+        msg.bData[1] = channel;
+        msg.bData[2] = value;
+
+        /* Only channel messages can be sent with running status,
+           system messages cancel it */
+        m_runningStatus = command < 0xF0 ? command : 0;
+    }
     msg.bData[3] = 0;
 
     /* Push the message out */
@@ -187,6 +187,9 @@ void Win32MidiOutputDevice::writeSysEx(QByteArray message)
     /* Flags must be set to 0 */
     midiHdr.dwFlags = 0;
 
+    /* A SysEx message cancels the running status */
+    m_runningStatus = 0;
+
     UINT err;
     /* Prepare the buffer and MIDIHDR */
     err = midiOutPrepareHeader(m_handle,  &midiHdr, sizeof(MIDIHDR));
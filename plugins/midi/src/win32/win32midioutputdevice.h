@@ -43,12 +43,19 @@ public:
     void writeSysEx(QByteArray message);
 
 private:
+    /** Write the changed channels, as many as the bandwidth allows */
+    void writeChanges();
+
+    /** Send a short message, using running status when $command
+     *  is the same as the previous one */
     void sendData(BYTE command, BYTE channel, BYTE value);
 
 private:
     UINT m_id;
     HMIDIOUT m_handle;
-    QByteArray m_universe;
+
+    /** The last command byte sent, or 0 when it is unknown */
+    BYTE m_runningStatus;
 };
 
 #endif
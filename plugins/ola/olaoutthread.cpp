@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QMutexLocker>
 #include <QDebug>
 #include <ola/Callback.h>
 #include "olaoutthread.h"
@@ -27,6 +28,7 @@ OlaOutThread::OlaOutThread()
     , m_ss(NULL)
     , m_pipe(NULL)
     , m_client(NULL)
+    , m_pending(false)
 {
 }
 
@@ -45,6 +47,8 @@ OlaOutThread::~OlaOutThread()
     if (m_pipe)
         delete m_pipe;
 
+    qDeleteAll(m_slots);
+
     cleanup();
 }
 
@@ -97,7 +101,8 @@ void OlaOutThread::run()
 
 
 /*
- * Send the new data over the socket so that the other thread picks it up.
+ * Store the new data in the universe slot so that the other thread picks it
+ * up, waking it up if needed.
  * @param universe the universe nmuber this data is for
  * @param data a pointer to the data
  * @param channels the number of channels
@@ -106,13 +111,32 @@ int OlaOutThread::write_dmx(unsigned int universe, const QByteArray& data)
 {
     if (m_pipe)
     {
-        Q_ASSERT(data.size() <= (int)sizeof(m_data.data));
+        QMutexLocker locker(&m_slotsMutex);
+
+        dmx_slot *slot = m_slots.value(universe, NULL);
+        if (slot == NULL)
+        {
+            slot = new dmx_slot;
+            slot->universe = universe;
+            slot->sequence = 0;
+            slot->sent_sequence = 0;
+            m_slots[universe] = slot;
+        }
+
+        int size = qMin(data.size(), (int)sizeof(slot->data));
+        memcpy(slot->data, data.constData(), size);
+        if (size < (int)sizeof(slot->data))
+            memset(slot->data + size, 0, sizeof(slot->data) - size);
+        slot->sequence++;
 
-        m_data.universe = universe;
-        memset(m_data.data, 0, sizeof(m_data.data));
-        memcpy(m_data.data, data.data(), data.size());
+        if (m_pending)
+            return 0;
 
-        m_pipe->Send((uint8_t*) &m_data, sizeof(m_data));
+        m_pending = true;
+        locker.unlock();
+
+        uint8_t wakeup = 0;
+        m_pipe->Send(&wakeup, sizeof(wakeup));
     }
     return 0;
 }
@@ -134,18 +158,36 @@ void OlaOutThread::pipe_closed()
  */
 void OlaOutThread::new_pipe_data()
 {
-    dmx_data data;
+    uint8_t wakeups[64];
     unsigned int data_read;
-    int ret = m_pipe->Receive((uint8_t*) &data, sizeof(data), data_read);
+    int ret = m_pipe->Receive(wakeups, sizeof(wakeups), data_read);
     if (ret < 0)
     {
         qCritical() << "olaout: socket receive failed";
         return;
     }
 
-    m_buffer.Set(data.data, data_read - sizeof(data.universe));
-    if (!m_client->SendDmx(data.universe, m_buffer))
-        qWarning() << "olaout:: SendDmx() failed";
+    QMutexLocker locker(&m_slotsMutex);
+    m_pending = false;
+
+    QHashIterator <unsigned int, dmx_slot*> it(m_slots);
+    while (it.hasNext())
+    {
+        it.next();
+        dmx_slot *slot = it.value();
+        if (slot->sequence == slot->sent_sequence)
+            continue;
+
+        slot->sent_sequence = slot->sequence;
+        m_buffer.Set(slot->data, sizeof(slot->data));
+
+        // the rpc doesn't touch the slots, so the plugin can go on
+        // writing them meanwhile
+        locker.unlock();
+        if (!m_client->SendDmx(slot->universe, m_buffer))
+            qWarning() << "olaout:: SendDmx() failed";
+        locker.relock();
+    }
 }
 
 
@@ -22,6 +22,8 @@
 #define OLAOUTTHREAD_H
 
 #include <QThread>
+#include <QMutex>
+#include <QHash>
 
 #include <ola/DmxBuffer.h>
 #include <ola/OlaCallbackClient.h>
@@ -33,32 +35,39 @@
 // This should really be in qlcmacros.h!
 enum { K_UNIVERSE_SIZE = 512 };
 
-// Used to pass data between the threads
+// Used to pass data between the threads: one slot per universe,
+// overwritten by the plugin and read by the OLA thread
 typedef struct
 {
     unsigned int universe;
+    /** Incremented on each write of the plugin */
+    quint32 sequence;
+    /** The sequence last sent to the OLA server */
+    quint32 sent_sequence;
     uchar data[K_UNIVERSE_SIZE];
-} dmx_data;
+} dmx_slot;
 
 /*
  * The OLA thread.
  *
  * Basic design: qlc plugins aren't allowed to block in calls, so we start a
- * new thread which runs a select server. Calls to write_dmx in the plugin send
- * data over a pipe which the OLA thread listens on. It then uses the
- * OlaCallbackClient api to send the data to the OLA Server.
+ * new thread which runs a select server. Calls to write_dmx in the plugin
+ * store the data in a slot shared with the OLA thread, and wake it up with a
+ * single byte over a pipe if it isn't already due to run. The OLA thread then
+ * sends every slot written since its last run using the OlaCallbackClient
+ * api. A burst of universes written in the same tick costs one wakeup, and a
+ * universe written twice before the thread runs is sent once.
  *
  * The thread can either run as a OLA Client or embed the OLA server. As a
  * client, we connect to the OLA server using a TCP socket.
  *
- *   OlaOut --pipe-> OlaOutThread --tcp socket-> olad (separate process)
+ *   OlaOut --slots-> OlaOutThread --tcp socket-> olad (separate process)
  *
  * When embedded the server, we still use the OlaCallbackClient class and setup
- * a pipe to send the rpcs over. Yes, this results in copying the data twice
- * over a pipe but we can't use a single pipe because the OlaClient needs to
- * respond to events.
+ * a pipe to send the rpcs over, because the OlaServer doesn't expose its
+ * universes to be written directly.
  *
- * OlaOut --pipe-> OlaOutThread --pipe-> OlaServer
+ * OlaOut --slots-> OlaOutThread --pipe-> OlaServer
  */
 class OlaOutThread : public QThread
 {
@@ -81,10 +90,16 @@ protected:
 private:
     virtual bool init() = 0;
     virtual void cleanup() {};
-    ola::io::LoopbackDescriptor *m_pipe; // the pipe to get new dmx data on
+    ola::io::LoopbackDescriptor *m_pipe; // the pipe to be notified of new dmx data on
     ola::OlaCallbackClient *m_client;
-    dmx_data m_data;
     ola::DmxBuffer m_buffer;
+
+    /** The universe slots, protected by m_slotsMutex */
+    QHash<unsigned int, dmx_slot*> m_slots;
+    QMutex m_slotsMutex;
+    /** Flag raised when the OLA thread has been woken up
+     *  and hasn't read the slots yet */
+    bool m_pending;
 };
 
 
@@ -17,6 +17,8 @@
   limitations under the License.
 */
 
+#include <QSettings>
+
 #include "os2lconfiguration.h"
 #include "os2lplugin.h"
 
@@ -37,6 +39,9 @@ OS2LConfiguration::OS2LConfiguration(OS2LPlugin* plugin, QWidget* parent)
         m_hostGroup->hide();
     else
         m_activateLabel->hide();
+
+    QSettings settings;
+    m_latencySpin->setValue(settings.value(OS2L_SETTINGS_BEAT_LATENCY, 0).toInt());
 }
 
 OS2LConfiguration::~OS2LConfiguration()
@@ -53,6 +58,9 @@ void OS2LConfiguration::accept()
     m_plugin->setParameter(m_plugin->universe(), 0, QLCIOPlugin::Input, OS2L_HOST_ADDRESS, m_ipAddrEdit->text());
     m_plugin->setParameter(m_plugin->universe(), 0, QLCIOPlugin::Input, OS2L_HOST_PORT, m_portSpin->value());
 
+    QSettings settings;
+    settings.setValue(OS2L_SETTINGS_BEAT_LATENCY, m_latencySpin->value());
+
     QDialog::accept();
 }
 
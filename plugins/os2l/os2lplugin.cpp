@@ -220,10 +220,44 @@ void OS2LPlugin::slotProcessTCPPackets()
         return;
 
     QHostAddress senderAddress = socket->peerAddress();
-    QByteArray message = socket->readAll();
-    QJsonDocument json = QJsonDocument::fromJson(message);
+    QByteArray data = socket->readAll();
+
+    qDebug() << "[TCP] Received" << data.length() << "bytes from" << senderAddress.toString();
+
+    // several messages can be received at once, especially
+    // beats queued by the network. Split the JSON objects.
+    int depth = 0, start = 0;
+    bool quoted = false;
+    for (int i = 0; i < data.length(); i++)
+    {
+        char c = data.at(i);
+        if (quoted)
+        {
+            if (c == '\\')
+                i++;
+            else if (c == '"')
+                quoted = false;
+        }
+        else if (c == '"')
+        {
+            quoted = true;
+        }
+        else if (c == '{')
+        {
+            if (depth++ == 0)
+                start = i;
+        }
+        else if (c == '}' && depth > 0)
+        {
+            if (--depth == 0)
+                processMessage(data.mid(start, i - start + 1));
+        }
+    }
+}
 
-    qDebug() << "[TCP] Received" << message.length() << "bytes from" << senderAddress.toString();
+void OS2LPlugin::processMessage(const QByteArray &message)
+{
+    QJsonDocument json = QJsonDocument::fromJson(message);
     QJsonObject jsonObj = json.object();
     QJsonValue jEvent = jsonObj.value("evt");
     if (jEvent.isUndefined())
@@ -251,7 +285,7 @@ void OS2LPlugin::slotProcessTCPPackets()
     else if (event == "beat")
     {
        qDebug() << "Got beat message" << message;
-       emit valueChanged(m_inputUniverse, 0, 8341, 255, "beat");
+       emit valueChanged(m_inputUniverse, 0, OS2L_BEAT_CHANNEL, 255, "beat");
     }
 }
 
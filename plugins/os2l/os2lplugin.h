@@ -27,6 +27,13 @@
 
 #define OS2L_DEFAULT_PORT 9996
 
+/** The input channel of the beat messages */
+#define OS2L_BEAT_CHANNEL 8341
+
+/** The latency compensation of the beats, in milliseconds. It applies
+ *  when OS2L is the beat generator of the engine */
+#define OS2L_SETTINGS_BEAT_LATENCY "OS2LPlugin/beatLatency"
+
 class QTcpServer;
 
 class OS2LPlugin : public QLCIOPlugin
@@ -81,6 +88,9 @@ protected:
     bool enableTCPServer(bool enable);
     quint16 getHash(QString channel);
 
+    /** Process a single OS2L JSON message */
+    void processMessage(const QByteArray& message);
+
 protected slots:
     /** Event raised when an incoming connection is requested on
      *  the TCP socket server side */
@@ -19,6 +19,7 @@
 
 #include <QTreeWidgetItem>
 #include <QMessageBox>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QLineEdit>
 #include <QSpinBox>
@@ -33,6 +34,7 @@
 #define KMapColumnInputPort     2
 #define KMapColumnOutputAddress 3
 #define KMapColumnOutputPort    4
+#define KMapColumnOutputBundle  5
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -159,6 +161,10 @@ void ConfigureOSC::fillMappingTree()
                 spin->setRange(1, 65535);
                 spin->setValue(info->outputPort);
                 m_uniMapTree->setItemWidget(item, KMapColumnOutputPort, spin);
+
+                QCheckBox *bundleCheck = new QCheckBox(this);
+                bundleCheck->setChecked(info->outputBundle);
+                m_uniMapTree->setItemWidget(item, KMapColumnOutputBundle, bundleCheck);
             }
         }
     }
@@ -221,6 +227,10 @@ void ConfigureOSC::accept()
                 else
                     m_plugin->setParameter(universe, line, cap, OSC_OUTPUTPORT, outSpin->value());
             }
+
+            QCheckBox *bundleCheck = qobject_cast<QCheckBox*>(m_uniMapTree->itemWidget(item, KMapColumnOutputBundle));
+            if (bundleCheck != NULL)
+                m_plugin->setParameter(universe, line, cap, OSC_OUTPUTBUNDLE, bundleCheck->isChecked());
         }
     }
 
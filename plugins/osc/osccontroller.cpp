@@ -19,10 +19,15 @@
 
 #include "osccontroller.h"
 
+#include <QLoggingCategory>
 #include <QMutexLocker>
 #include <QByteArray>
 #include <QDebug>
 
+#include "qlcloglimiter.h"
+
+Q_LOGGING_CATEGORY(lcOSC, "qlcplus.plugins.osc")
+
 OSCController::OSCController(QString ipaddr, Type type, quint32 line, QObject *parent)
     : QObject(parent)
     , m_ipAddr(ipaddr)
@@ -40,6 +45,16 @@ OSCController::OSCController(QString ipaddr, Type type, quint32 line, QObject *p
 OSCController::~OSCController()
 {
     qDebug() << Q_FUNC_INFO;
+
+    // release the input sockets and wait for
+    // the input thread to stop using them
+    {
+        QMutexLocker locker(&m_dataMutex);
+        for (QMap<quint32, UniverseInfo>::iterator it = m_universeMap.begin(); it != m_universeMap.end(); ++it)
+            it.value().inputSocket.clear();
+    }
+    m_inputThread.quit();
+    m_inputThread.wait();
     qDeleteAll(m_dmxValuesMap);
 }
 
@@ -51,6 +66,7 @@ QHostAddress OSCController::getNetworkIP() const
 void OSCController::addUniverse(quint32 universe, OSCController::Type type)
 {
     qDebug() << "[OSC] addUniverse - universe" << universe << ", type" << type;
+    QMutexLocker locker(&m_dataMutex);
     if (m_universeMap.contains(universe))
     {
         m_universeMap[universe].type |= (int)type;
@@ -72,6 +88,7 @@ void OSCController::addUniverse(quint32 universe, OSCController::Type type)
         }
         info.feedbackPort = 9000 + universe;
         info.outputPort = 9000 + universe;
+        info.outputBundle = false;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -87,6 +104,7 @@ void OSCController::addUniverse(quint32 universe, OSCController::Type type)
 void OSCController::removeUniverse(quint32 universe, OSCController::Type type)
 {
     qDebug() << "[OSC] removeUniverse - universe" << universe << ", type" << type;
+    QMutexLocker locker(&m_dataMutex);
     if (m_universeMap.contains(universe))
     {
         UniverseInfo& info = m_universeMap[universe];
@@ -126,10 +144,13 @@ QSharedPointer<QUdpSocket> OSCController::getInputSocket(quint16 port)
             return info.inputSocket;
     }
 
-    QSharedPointer<QUdpSocket> inputSocket(new QUdpSocket(this));
-    inputSocket->bind(m_ipAddr, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
+    QUdpSocket *socket = new QUdpSocket();
+    socket->bind(m_ipAddr, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
+
+    // received packets are handled in the input thread
+    QSharedPointer<QUdpSocket> inputSocket = m_inputThread.adopt(socket);
     connect(inputSocket.data(), SIGNAL(readyRead()),
-            this, SLOT(processPendingPackets()));
+            this, SLOT(processPendingPackets()), Qt::DirectConnection);
     return inputSocket;
 }
 
@@ -183,6 +204,17 @@ bool OSCController::setOutputPort(quint32 universe, quint16 port)
     return port == 9000 + universe;
 }
 
+bool OSCController::setOutputBundle(quint32 universe, bool enable)
+{
+    if (m_universeMap.contains(universe) == false)
+        return false;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputBundle = enable;
+
+    return enable == false;
+}
+
 QList<quint32> OSCController::universesList() const
 {
     return m_universeMap.keys();
@@ -222,32 +254,51 @@ quint64 OSCController::getPacketReceivedNumber() const
     return m_packetReceived;
 }
 
-quint16 OSCController::getHash(QString path)
+OSCChannel OSCController::getChannel(QString const& key)
 {
-    quint16 hash;
-    if (m_hashMap.contains(path))
-        hash = m_hashMap[path];
-    else
+    OSCChannel channel;
+    channel.key = key;
+    channel.hash = qChecksum(key.toUtf8().data(), key.length());
+
+    if (m_keyMap.contains(channel.hash) == false)
+        m_keyMap[channel.hash] = key;
+
+    return channel;
+}
+
+OSCAddress const& OSCController::getAddress(QByteArray const& path, int parts)
+{
+    QHash<QByteArray, OSCAddress>::iterator it = m_addressMap.find(path);
+    if (it == m_addressMap.end())
     {
-        /** No existing hash found. Add a new key to the table */
-        hash = qChecksum(path.toUtf8().data(), path.length());
-        m_hashMap[path] = hash;
+        /** No existing entry found. Compile the path once */
+        OSCAddress address;
+        address.path = QString::fromUtf8(path);
+        address.channel = getChannel(address.path);
+        it = m_addressMap.insert(path, address);
     }
 
-    return hash;
+    OSCAddress& address = it.value();
+    for (int i = address.parts.count(); i < parts; i++)
+        address.parts.append(getChannel(QString("%1_%2").arg(address.path).arg(i)));
+
+    return address;
 }
 
 void OSCController::sendDmx(const quint32 universe, const QByteArray &dmxData)
 {
     QMutexLocker locker(&m_dataMutex);
     QByteArray dmxPacket;
+    QByteArray bundle;
     QHostAddress outAddress = QHostAddress::Null;
     quint32 outPort = 7700 + universe;
+    bool outBundle = false;
 
     if (m_universeMap.contains(universe))
     {
         outAddress = m_universeMap[universe].outputAddress;
         outPort = m_universeMap[universe].outputPort;
+        outBundle = m_universeMap[universe].outputBundle;
     }
 
     for (int i = 0; i < dmxData.length(); i++)
@@ -261,17 +312,35 @@ void OSCController::sendDmx(const quint32 universe, const QByteArray &dmxData)
         {
             dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
             m_packetizer->setupOSCDmx(dmxPacket, universe, i, dmxData[i]);
-            qint64 sent = m_outputSocket->writeDatagram(dmxPacket.data(), dmxPacket.size(),
-                                                     outAddress, outPort);
-            if (sent < 0)
+
+            if (outBundle == false)
             {
-                qDebug() << "[OSC] sendDmx failed. Errno: " << m_outputSocket->error();
-                qDebug() << "Errmgs: " << m_outputSocket->errorString();
+                m_packetSent += m_batch.queue(m_outputSocket.data(), dmxPacket, outAddress, outPort);
+                continue;
             }
-            else
-                m_packetSent++;
+
+            // close the current bundle when the message doesn't fit
+            if (bundle.isEmpty() == false &&
+                bundle.size() + 4 + dmxPacket.size() > OSC_BUNDLE_MAX_SIZE)
+            {
+                m_packetSent += m_batch.queue(m_outputSocket.data(), bundle, outAddress, outPort);
+                bundle.clear();
+            }
+
+            if (bundle.isEmpty())
+                m_packetizer->setupOSCBundle(bundle);
+            m_packetizer->addOSCBundleMessage(bundle, dmxPacket);
         }
     }
+
+    if (bundle.isEmpty() == false)
+        m_packetSent += m_batch.queue(m_outputSocket.data(), bundle, outAddress, outPort);
+}
+
+void OSCController::flushFrame()
+{
+    QMutexLocker locker(&m_dataMutex);
+    m_packetSent += m_batch.flush();
 }
 
 void OSCController::sendFeedback(const quint32 universe, quint32 channel, uchar value, const QString &key)
@@ -290,7 +359,7 @@ void OSCController::sendFeedback(const quint32 universe, quint32 channel, uchar
     // on invalid key try to retrieve the OSC path from the hash table.
     // This works only if the OSC widget has been previously moved by the user
     if (key.isEmpty())
-        path = m_hashMap.key(channel);
+        path = m_keyMap.value(channel);
 
     qDebug() << "[OSC] sendFeedBack - Key:" << path << "value:" << value;
 
@@ -328,8 +397,11 @@ void OSCController::sendFeedback(const quint32 universe, quint32 channel, uchar
                                              outAddress, outPort);
     if (sent < 0)
     {
-        qDebug() << "[OSC] sendDmx failed. Errno: " << m_outputSocket->error();
-        qDebug() << "Errmgs: " << m_outputSocket->errorString();
+        static QLCLogLimiter limiter(1);
+        int suppressed;
+        if (limiter.allow(&suppressed))
+            qCWarning(lcOSC) << "sendDmx failed. Errno:" << m_outputSocket->error()
+                             << m_outputSocket->errorString() << ", suppressed:" << suppressed;
     }
     else
         m_packetSent++;
@@ -343,20 +415,21 @@ void OSCController::handlePacket(QUdpSocket* socket, QByteArray const& datagram,
     Q_UNUSED(senderAddress);
 #endif
 
-    QList< QPair<QString, QByteArray> > messages = m_packetizer->parsePacket(datagram);
+    QList< QPair<QByteArray, QByteArray> > messages = m_packetizer->parsePacket(datagram);
 
-    QListIterator <QPair<QString,QByteArray> > it(messages);
+    QListIterator <QPair<QByteArray,QByteArray> > it(messages);
     while (it.hasNext() == true)
     {
-        QPair <QString,QByteArray> msg(it.next());
+        QPair <QByteArray,QByteArray> const& msg(it.next());
 
-        QString path = msg.first;
-        QByteArray values = msg.second;
+        QByteArray const& values = msg.second;
 
-        qDebug() << "[OSC] message has path:" << path << "values:" << values.count();
         if (values.isEmpty())
             continue;
 
+        int parts = values.count() > 1 ? values.count() : 0;
+        OSCAddress const& address = getAddress(msg.first, parts);
+
         for (QMap<quint32, UniverseInfo>::iterator it = m_universeMap.begin(); it != m_universeMap.end(); ++it)
         {
             quint32 universe = it.key();
@@ -365,15 +438,15 @@ void OSCController::handlePacket(QUdpSocket* socket, QByteArray const& datagram,
             {
                 if (values.count() > 1)
                 {
-                    info.multipartCache[path] = values;
+                    info.multipartCache[address.path] = values;
                     for(int i = 0; i < values.count(); i++)
                     {
-                        QString modPath = QString("%1_%2").arg(path).arg(i);
-                        emit valueChanged(universe, m_line, getHash(modPath), (uchar)values.at(i), modPath);
+                        OSCChannel const& part = address.parts.at(i);
+                        emit valueChanged(universe, m_line, part.hash, (uchar)values.at(i), part.key);
                     }
                 }
                 else
-                    emit valueChanged(universe, m_line, getHash(path), (uchar)values.at(0), path);
+                    emit valueChanged(universe, m_line, address.channel.hash, (uchar)values.at(0), address.channel.key);
             }
         }
     }
@@ -382,13 +455,26 @@ void OSCController::handlePacket(QUdpSocket* socket, QByteArray const& datagram,
 
 void OSCController::processPendingPackets()
 {
-    QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
+    // this runs in the input thread, where sender() cannot be used,
+    // so every input socket is checked for pending packets
+    QMutexLocker locker(&m_dataMutex);
+    QList<QUdpSocket*> sockets;
+
+    foreach (UniverseInfo const& info, m_universeMap)
+    {
+        if (info.inputSocket && sockets.contains(info.inputSocket.data()) == false)
+            sockets.append(info.inputSocket.data());
+    }
+
     QByteArray datagram;
     QHostAddress senderAddress;
-    while (socket->hasPendingDatagrams())
+    foreach (QUdpSocket *socket, sockets)
     {
-        datagram.resize(socket->pendingDatagramSize());
-        socket->readDatagram(datagram.data(), datagram.size(), &senderAddress);
-        handlePacket(socket, datagram, senderAddress);
+        while (socket->hasPendingDatagrams())
+        {
+            datagram.resize(socket->pendingDatagramSize());
+            socket->readDatagram(datagram.data(), datagram.size(), &senderAddress);
+            handlePacket(socket, datagram, senderAddress);
+        }
     }
 }
@@ -30,11 +30,14 @@
 #include <QtNetwork>
 #endif
 #include <QMutex>
+#include <QVector>
 #include <QTimer>
 #include <QHash>
 #include <QMap>
 
 #include "oscpacketizer.h"
+#include "qlcinputthread.h"
+#include "qlcudpbatch.h"
 
 typedef struct
 {
@@ -48,12 +51,32 @@ typedef struct
     QHostAddress outputAddress;
     quint16 outputPort;
 
+    // when enabled, the changed channels of a frame are
+    // packed into OSC bundles instead of single messages
+    bool outputBundle;
+
     // cache of the OSC paths with multiple values, used to correctly
     // handle the flow of input and feedback values
     QHash<QString, QByteArray> multipartCache;
     int type;
 } UniverseInfo;
 
+/** A QLC+ input channel resolved from an OSC path */
+typedef struct
+{
+    quint16 hash;
+    QString key;
+} OSCChannel;
+
+/** The channels an OSC address is dispatched to. A message with
+ *  multiple values is dispatched to one part channel per value */
+typedef struct
+{
+    QString path;
+    OSCChannel channel;
+    QVector<OSCChannel> parts;
+} OSCAddress;
+
 class OSCController : public QObject
 {
     Q_OBJECT
@@ -101,6 +124,10 @@ public:
      *  Return true if this restores default output port */
     bool setOutputPort(quint32 universe, quint16 port);
 
+    /** Enable or disable the output of OSC bundles for the given universe.
+     *  Return true if this restores the default single messages output */
+    bool setOutputBundle(quint32 universe, bool enable);
+
     /** Return the list of the universes handled by
      *  this controller */
     QList<quint32> universesList() const;
@@ -120,25 +147,39 @@ public:
     /** Get the number of packets received by this controller */
     quint64 getPacketReceivedNumber() const;
 
-    /** Send DMX data to a specific universe */
+    /** Queue the changed channels of a specific universe. The packets
+     *  are sent with the rest of the frame by flushFrame() */
     void sendDmx(const quint32 universe, const QByteArray& dmxData);
 
+    /** Send the packets queued during the frame */
+    void flushFrame();
+
     /** Send a feedback using the specified path and value */
     void sendFeedback(const quint32 universe, quint32 channel, uchar value, const QString &key);
 
 private:
+    /** Return an input socket for $port, reusing the one of another
+     *  universe when possible. Must be called with m_dataMutex locked */
     QSharedPointer<QUdpSocket> getInputSocket(quint16 port);
 
 protected:
     /** Calculate a 16bit unsigned hash as a unique representation
-     *  of a OSC path. If new, the hash is added to the hash map (m_hashMap) */
-    quint16 getHash(QString path);
+     *  of a OSC path, and register it for the feedback lookup (m_keyMap) */
+    OSCChannel getChannel(QString const& key);
+
+    /** Return the dispatch entry of a received OSC path, compiling it
+     *  the first time the path is seen. $parts is the number of values
+     *  received, for which part channels are needed.
+     *  Must be called with m_dataMutex locked */
+    OSCAddress const& getAddress(QByteArray const& path, int parts);
 
 private:
+    /** Handle a packet received by $socket. Must be called with m_dataMutex locked */
     void handlePacket(QUdpSocket* socket, QByteArray const& datagram, QHostAddress const& senderAddress);
 
 private slots:
-    /** Async event raised when new packets have been received */
+    /** Async event raised in the input thread when new packets
+     *  have been received */
     void processPendingPackets();
 
 signals:
@@ -160,10 +201,17 @@ private:
     /** Helper class used to create or parse OSC packets */
     QScopedPointer<OSCPacketizer> m_packetizer;
 
+    /** The packets of the current frame, sent at once by flushFrame() */
+    QLCUdpBatch m_batch;
+
     /** Keeps the current dmx values to send only the ones that changed */
     /** It holds values for all the handled universes */
     QMap<quint32, QByteArray *> m_dmxValuesMap;
 
+    /** The thread handling the input sockets. It must be destroyed
+     *  after m_universeMap, which holds the sockets */
+    QLCInputThread m_inputThread;
+
     /** Map of the QLC+ universes transmitted/received by this
      *  controller, with the related, specific parameters */
     QMap<quint32, UniverseInfo> m_universeMap;
@@ -172,12 +220,15 @@ private:
      *  variables that could be used to transmit/receive data */
     QMutex m_dataMutex;
 
-    /** This is fundamental for the OSC controller. Every time a OSC signal is received,
-      * the controller will calculate a 16 bit checksum of the OSC path and add it to
-      * this hash table if new, otherwise the controller will use the hash table
-      * to quickly retrieve a unique channel number
+    /** This is fundamental for the OSC controller. The first time a OSC path is
+      * received, the controller calculates the 16 bit checksums of the path and of its
+      * parts and stores them in this table, keyed by the raw path, so that following
+      * messages are dispatched with a single lookup and no string conversion
       */
-    QHash<QString, quint16> m_hashMap;
+    QHash<QByteArray, OSCAddress> m_addressMap;
+
+    /** Reverse map of m_addressMap, to retrieve the OSC path of a channel on feedback */
+    QHash<quint16, QString> m_keyMap;
 };
 
 #endif
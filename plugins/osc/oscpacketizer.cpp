@@ -22,6 +22,8 @@
 #include <QStringList>
 #include <QDebug>
 
+#include <string.h>
+
 OSCPacketizer::OSCPacketizer()
 {
 }
@@ -37,11 +39,13 @@ OSCPacketizer::~OSCPacketizer()
 void OSCPacketizer::setupOSCDmx(QByteArray &data, quint32 universe, quint32 channel, uchar value)
 {
     data.clear();
-    QString path = QString("/%1/dmx/%2").arg(universe).arg(channel);
-    data.append(path.toUtf8());
+    data.append('/');
+    data.append(QByteArray::number(universe));
+    data.append("/dmx/");
+    data.append(QByteArray::number(channel));
 
     // add trailing zeros to reach a multiple of 4
-    int zeroNumber = 4 - (path.length() % 4);
+    int zeroNumber = 4 - (data.length() % 4);
     if (zeroNumber > 0)
         data.append(QByteArray(zeroNumber, 0x00));
 
@@ -92,123 +96,117 @@ void OSCPacketizer::setupOSCGeneric(QByteArray &data, QString &path, QString typ
     }
 }
 
+void OSCPacketizer::setupOSCBundle(QByteArray &data)
+{
+    data.clear();
+    data.append("#bundle");
+    data.append((char)0x00);
+
+    // time tag 1 means 'immediately'
+    data.append(QByteArray(7, 0x00));
+    data.append((char)0x01);
+}
+
+void OSCPacketizer::addOSCBundleMessage(QByteArray &data, const QByteArray &message)
+{
+    int size = message.size();
+    data.append((char)(size >> 24));
+    data.append((char)((size >> 16) & 0xFF));
+    data.append((char)((size >> 8) & 0xFF));
+    data.append((char)(size & 0xFF));
+    data.append(message);
+}
+
 /*********************************************************************
  * Receiver functions
  *********************************************************************/
-bool OSCPacketizer::parseMessage(QByteArray const& data, QString& path, QByteArray& values)
+bool OSCPacketizer::parseMessage(const char *data, int size, QByteArray& path, QByteArray& values)
 {
     path.clear();
     values.clear();
 
-    QList<TagType> typeArray;
-    bool tagsEnded = false;
-
-    //qDebug() << "[OSC] data:" << data;
-
     // first of all look for a comma
-    int commaPos = data.indexOf(0x2C);
-    if (commaPos == -1)
+    const char *comma = (const char *)memchr(data, 0x2C, size);
+    if (comma == NULL)
         return false;
 
-    path = QString(data.mid(0, commaPos));
-    qDebug() << " [OSC] path extracted:" << path;
+    int commaPos = comma - data;
 
-    int currPos = commaPos + 1;
-    while (tagsEnded == false)
-    {
-        switch (data.at(currPos))
-        {
-            case '\0': tagsEnded = true; break;
-            case 'b': typeArray.append(BlobTag); break;
-            case 'f': typeArray.append(FloatTag); break;
-            case 'd': typeArray.append(DoubleTag); break;
-            case 'i': typeArray.append(IntegerTag); break;
-            case 's': typeArray.append(StringTag); break;
-            case 't': typeArray.append(TimeTag); break;
-            default: break;
-        }
-        currPos++;
-    }
-    // round current position to 4
-    int left = (typeArray.count() + 1) % 4;
-    currPos += 3 - left;
+    // the path is null terminated and padded before the comma
+    const char *pathEnd = (const char *)memchr(data, 0x00, commaPos);
+    path = QByteArray(data, pathEnd == NULL ? commaPos : pathEnd - data);
+
+    // the type tags are read along with the values, skipping
+    // the tags string, null terminated and padded to 4
+    int tagsPos = commaPos + 1;
+    int tagsEnd = tagsPos;
+    while (tagsEnd < size && data[tagsEnd] != '\0')
+        tagsEnd++;
 
-    qDebug () << "[OSC] Tags found:" << typeArray.count() << "currpos at" << currPos;
+    int currPos = commaPos + ((tagsEnd - commaPos) / 4 + 1) * 4;
+    values.reserve(tagsEnd - tagsPos);
 
-    foreach (TagType tag, typeArray)
+    for (int t = tagsPos; t < tagsEnd; t++)
     {
-        switch (tag)
+        switch (data[t])
         {
-            case IntegerTag:
+            case 'i':
             {
-                if (currPos + 4 > data.size())
+                if (currPos + 4 > size)
                     break;
-                quint32 iVal;
 
-                *((uchar*)(&iVal) + 3) = data.at(currPos);
-                *((uchar*)(&iVal) + 2) = data.at(currPos + 1);
-                *((uchar*)(&iVal) + 1) = data.at(currPos + 2);
-                *((uchar*)(&iVal) + 0) = data.at(currPos + 3);
+                quint32 iVal = (uchar(data[currPos]) << 24) + (uchar(data[currPos + 1]) << 16) +
+                               (uchar(data[currPos + 2]) << 8) + uchar(data[currPos + 3]);
 
                 if (iVal < 256)
                     values.append((char)iVal);
                 else
                     values.append((char)(iVal / 0xFFFFFF));
 
-                qDebug() << "[OSC] iVal:" << iVal;
                 currPos += 4;
             }
             break;
-            case FloatTag:
+            case 'f':
             {
-                if (currPos + 4 > data.size())
+                if (currPos + 4 > size)
                     break;
                 float fVal;
 
-                *((uchar*)(&fVal) + 3) = data.at(currPos);
-                *((uchar*)(&fVal) + 2) = data.at(currPos + 1);
-                *((uchar*)(&fVal) + 1) = data.at(currPos + 2);
-                *((uchar*)(&fVal) + 0) = data.at(currPos + 3);
+                *((uchar*)(&fVal) + 3) = data[currPos];
+                *((uchar*)(&fVal) + 2) = data[currPos + 1];
+                *((uchar*)(&fVal) + 1) = data[currPos + 2];
+                *((uchar*)(&fVal) + 0) = data[currPos + 3];
 
                 values.append((char)(255.0 * fVal));
 
-                qDebug() << "[OSC] fVal:" << fVal;
-
                 currPos += 4;
             }
             break;
-            case DoubleTag:
+            case 'd':
             {
-                if (currPos + 8 > data.size())
+                if (currPos + 8 > size)
                     break;
 
                 double dVal;
-                *((uchar*)(&dVal) + 7) = data.at(currPos);
-                *((uchar*)(&dVal) + 6) = data.at(currPos + 1);
-                *((uchar*)(&dVal) + 5) = data.at(currPos + 2);
-                *((uchar*)(&dVal) + 4) = data.at(currPos + 3);
-                *((uchar*)(&dVal) + 3) = data.at(currPos + 4);
-                *((uchar*)(&dVal) + 2) = data.at(currPos + 5);
-                *((uchar*)(&dVal) + 1) = data.at(currPos + 6);
-                *((uchar*)(&dVal) + 0) = data.at(currPos + 7);
+                for (int i = 0; i < 8; i++)
+                    *((uchar*)(&dVal) + 7 - i) = data[currPos + i];
 
                 values.append((char)(255.0 * dVal));
 
-                qDebug() << "[OSC] dVal:" << dVal;
                 currPos += 8;
             }
             break;
-            case StringTag:
+            case 's':
             {
-                int firstZeroPos = data.indexOf('\0', currPos);
-                QString str = QString(data.mid(currPos, firstZeroPos - currPos));
-                qDebug() << "[OSC] string:" << str;
-                // align current position to a multiple of 4
-                int zeroNumber = 4 - (str.length() % 4);
-                currPos = firstZeroPos + zeroNumber;
+                // strings are skipped, aligning the
+                // current position to a multiple of 4
+                int strEnd = currPos;
+                while (strEnd < size && data[strEnd] != '\0')
+                    strEnd++;
+                currPos += ((strEnd - currPos) / 4 + 1) * 4;
             }
             break;
-            case TimeTag:
+            case 't':
             {
                 // A OSC timestamp would be helpful to defer
                 // value changes, but since QLC+ plugins don't support
@@ -223,14 +221,14 @@ bool OSCPacketizer::parseMessage(QByteArray const& data, QString& path, QByteArr
     return true;
 }
 
-QList<QPair<QString, QByteArray> > OSCPacketizer::parsePacket(QByteArray const& data)
+QList<QPair<QByteArray, QByteArray> > OSCPacketizer::parsePacket(QByteArray const& data)
 {
     int bufPos = 0;
-    QList<QPair<QString, QByteArray> > messages;
+    QList<QPair<QByteArray, QByteArray> > messages;
 
     while (bufPos < data.size())
     {
-        QString path;
+        QByteArray path;
         QByteArray values;
 
         // check wether we need to parse a bundle or a single message
@@ -246,17 +244,16 @@ QList<QPair<QString, QByteArray> > OSCPacketizer::parsePacket(QByteArray const&
 
             // now, a bundle can contain another bundle or a message, starting with the message size
             // Check where we are here
-            while (bufPos < data.size() && data.at(bufPos) != '#')
+            while (bufPos + 4 <= data.size() && data.at(bufPos) != '#')
             {
                 quint32 msgSize = (uchar(data.at(bufPos)) << 24) + (uchar(data.at(bufPos + 1)) << 16) + (uchar(data.at(bufPos + 2)) << 8) + uchar(data.at(bufPos + 3));
-                qDebug() << "[OSC] Bundle message size:" << msgSize;
                 bufPos += 4;
 
                 if (data.size() >= bufPos + (int)msgSize)
                 {
-                    QByteArray msgData = data.mid(bufPos, msgSize);
-                    if (parseMessage(msgData, path, values) == true)
-                        messages.append(QPair<QString, QByteArray>(path, values));
+                    // messages are parsed in place, without copying them
+                    if (parseMessage(data.constData() + bufPos, msgSize, path, values) == true)
+                        messages.append(QPair<QByteArray, QByteArray>(path, values));
                 }
                 bufPos += msgSize;
             }
@@ -264,8 +261,8 @@ QList<QPair<QString, QByteArray> > OSCPacketizer::parsePacket(QByteArray const&
         }
         else
         {
-            if (parseMessage(data, path, values) == true)
-                messages.append(QPair<QString, QByteArray>(path, values));
+            if (parseMessage(data.constData(), data.size(), path, values) == true)
+                messages.append(QPair<QByteArray, QByteArray>(path, values));
 
             bufPos += data.size();
         }
@@ -273,6 +270,3 @@ QList<QPair<QString, QByteArray> > OSCPacketizer::parsePacket(QByteArray const&
 
     return messages;
 }
-
-
-
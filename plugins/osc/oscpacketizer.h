@@ -26,6 +26,9 @@
 #ifndef OSCPACKETIZER_H
 #define OSCPACKETIZER_H
 
+/** The maximum size of an OSC bundle, to fit in a single Ethernet frame */
+#define OSC_BUNDLE_MAX_SIZE 1400
+
 class OSCPacketizer
 {
     /*********************************************************************
@@ -76,6 +79,22 @@ public:
      */
     void setupOSCGeneric(QByteArray& data, QString &path, QString types, QByteArray &values);
 
+    /**
+     * Prepare an empty OSC bundle, to be executed immediately, to which
+     * messages are appended with addOSCBundleMessage()
+     *
+     * @param data the bundle composed by this function
+     */
+    void setupOSCBundle(QByteArray& data);
+
+    /**
+     * Append a message to a bundle prepared with setupOSCBundle()
+     *
+     * @param data the bundle to append the message to
+     * @param message a message composed by setupOSCDmx or setupOSCGeneric
+     */
+    void addOSCBundleMessage(QByteArray& data, QByteArray const& message);
+
     /*********************************************************************
      * Receiver functions
      *********************************************************************/
@@ -86,19 +105,22 @@ private:
      * (empty if invalid)
      *
      * @param data the buffer containing the OSC message
+     * @param size the size of the OSC message in $data
      * @param path the OSC path extracted from the buffer
      * @param values the array of values extracted from the buffer
      * @return true on successful parsing, otherwise false
      */
-    bool parseMessage(QByteArray const& data, QString& path, QByteArray& values);
+    bool parseMessage(const char *data, int size, QByteArray& path, QByteArray& values);
 public:
     /**
      * Parse a OSC packet received from the network.
+     * The paths are returned as they are received, to be looked up
+     * without converting them to strings first.
      *
      * @param data the payload of a UDP packet received from the network
      * @return a list of couples of OSC path/values
      */
-    QList<QPair<QString, QByteArray> > parsePacket(QByteArray const& data);
+    QList<QPair<QByteArray, QByteArray> > parsePacket(QByteArray const& data);
 
 };
 
@@ -203,6 +203,15 @@ void OSCPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray
         controller->sendDmx(universe, data);
 }
 
+void OSCPlugin::frameComplete()
+{
+    foreach (OSCIO line, m_IOmapping)
+    {
+        if (line.controller != NULL)
+            line.controller->flushFrame();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -233,8 +242,10 @@ bool OSCPlugin::openInput(quint32 input, quint32 universe)
     {
         OSCController *controller = new OSCController(m_IOmapping.at(input).IPAddress,
                                                         OSCController::Input, input, this);
+        // the input data is handled in the input thread
         connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)));
+                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
+                Qt::DirectConnection);
         m_IOmapping[input].controller = controller;
     }
 
@@ -337,6 +348,8 @@ void OSCPlugin::setParameter(quint32 universe, quint32 line, Capability type,
         unset = controller->setOutputIPAddress(universe, value.toString());
     else if (name == OSC_OUTPUTPORT)
         unset = controller->setOutputPort(universe, value.toUInt());
+    else if (name == OSC_OUTPUTBUNDLE)
+        unset = controller->setOutputBundle(universe, value.toBool());
     else
     {
         qWarning() << Q_FUNC_INFO << name << "is not a valid OSC parameter";
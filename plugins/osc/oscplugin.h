@@ -41,6 +41,7 @@ typedef struct
 #define OSC_FEEDBACKPORT "feedbackPort"
 #define OSC_OUTPUTIP "outputIP"
 #define OSC_OUTPUTPORT "outputPort"
+#define OSC_OUTPUTBUNDLE "outputBundle"
 
 
 class OSCPlugin : public QLCIOPlugin
@@ -92,6 +93,9 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void frameComplete();
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
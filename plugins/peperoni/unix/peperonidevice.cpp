@@ -34,6 +34,8 @@ PeperoniDevice::PeperoniDevice(Peperoni* parent, struct usb_device* device, quin
     , m_baseLine(line)
     , m_device(device)
     , m_handle(NULL)
+    , m_running(false)
+    , m_output(new QLCUsbOutput(this, this))
 {
     Q_ASSERT(device != NULL);
 
@@ -280,6 +282,9 @@ bool PeperoniDevice::open(quint32 line, OperatingMode mode)
         }
     }
 
+    if (m_operatingModes[line] & OutputMode)
+        m_output->startOutput();
+
     if (m_operatingModes[line] & InputMode && m_running == false)
     {
         qDebug() << "[Peperoni] open input line:" << m_baseLine;
@@ -301,6 +306,10 @@ void PeperoniDevice::close(quint32 line, OperatingMode mode)
         wait();
     }
 
+    // the output thread must not outlive the device handle
+    if (mode == OutputMode && hasOpenOutput() == false)
+        m_output->stopOutput();
+
     if (m_operatingModes[line] != CloseMode)
         return;
 
@@ -328,6 +337,19 @@ void PeperoniDevice::closeAll()
     close(m_baseLine, OutputMode);
 }
 
+bool PeperoniDevice::hasOpenOutput() const
+{
+    QHashIterator<quint32, int> it(m_operatingModes);
+    while (it.hasNext())
+    {
+        it.next();
+        if (it.value() & OutputMode)
+            return true;
+    }
+
+    return false;
+}
+
 const struct usb_device* PeperoniDevice::device() const
 {
     return m_device;
@@ -463,12 +485,18 @@ void PeperoniDevice::run()
  ****************************************************************************/
 
 void PeperoniDevice::outputDMX(quint32 line, const QByteArray& universe)
+{
+    m_output->queueFrame(line, universe);
+}
+
+bool PeperoniDevice::writeFrame(quint32 line, const QByteArray& universe)
 {
     Q_UNUSED(line)
+    bool ok = true;
     int r = -1;
 
     if (m_handle == NULL)
-        return;
+        return false;
 
     {
     QMutexLocker lock(&m_ioMutex);
@@ -490,7 +518,10 @@ void PeperoniDevice::outputDMX(quint32 line, const QByteArray& universe)
                             50);                     // Timeout (ms)
 
         if (r < 0)
+        {
             qWarning() << "PeperoniDevice" << name(m_baseLine) << "failed control write:" << usb_strerror();
+            ok = false;
+        }
 #if !defined(__APPLE__) && !defined(Q_OS_MAC)
     }
     else if (m_firmwareVersion < PEPERONI_FW_NEW_BULK_SUPPORT)
@@ -519,6 +550,7 @@ void PeperoniDevice::outputDMX(quint32 line, const QByteArray& universe)
         if (r < 0)
         {
             qWarning() << "PeperoniDevice" << name(m_baseLine) << "failed 'old' bulk write:" << usb_strerror();
+            ok = false;
             qWarning() << "Resetting bulk endpoint.";
             r = usb_clear_halt(m_handle, PEPERONI_BULK_OUT_ENDPOINT);
             if (r < 0)
@@ -583,6 +615,7 @@ void PeperoniDevice::outputDMX(quint32 line, const QByteArray& universe)
 
         if (r < 0)
         {
+            ok = false;
             qWarning() << "Resetting bulk endpoints.";
             r = usb_clear_halt(m_handle, PEPERONI_BULK_OUT_ENDPOINT);
             if (r < 0)
@@ -598,4 +631,6 @@ void PeperoniDevice::outputDMX(quint32 line, const QByteArray& universe)
     }
 #endif
     }
+
+    return ok;
 }
@@ -25,13 +25,15 @@
 #include <QMutex>
 #include <QHash>
 
+#include "qlcusboutput.h"
+
 struct usb_dev_handle;
 struct usb_device;
 class QString;
 class QByteArray;
 class Peperoni;
 
-class PeperoniDevice : public QThread
+class PeperoniDevice : public QThread, public QLCUsbOutput::Writer
 {
     Q_OBJECT
 
@@ -130,7 +132,19 @@ signals:
      * Write
      ********************************************************************/
 public:
+    /** Queue $universe to be written to $line by the output thread */
     void outputDMX(quint32 line, const QByteArray& universe);
+
+    /** @reimp */
+    bool writeFrame(quint32 line, const QByteArray& universe);
+
+private:
+    /** Return true if any line of the device is open in output mode */
+    bool hasOpenOutput() const;
+
+private:
+    /** The output thread performing the USB transfers */
+    QLCUsbOutput* m_output;
 };
 
 #endif
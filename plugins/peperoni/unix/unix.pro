@@ -15,11 +15,13 @@ PKGCONFIG   += libusb
 INCLUDEPATH += ../../interfaces
 INCLUDEPATH += ../common
 
-HEADERS += ../../interfaces/qlcioplugin.h
+HEADERS += ../../interfaces/qlcioplugin.h \
+           ../../interfaces/qlcusboutput.h
 HEADERS += peperonidevice.h \
            peperoni.h
 
-SOURCES += ../../interfaces/qlcioplugin.cpp
+SOURCES += ../../interfaces/qlcioplugin.cpp \
+           ../../interfaces/qlcusboutput.cpp
 SOURCES += peperonidevice.cpp \
            peperoni.cpp
 
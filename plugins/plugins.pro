@@ -18,6 +18,7 @@ TEMPLATE = subdirs
  SUBDIRS              += enttecwing
  SUBDIRS              += hid
  !macx:!win32:SUBDIRS += spi
+ SUBDIRS              += sharedmemory
 
  greaterThan(QT_MAJOR_VERSION, 4) {
     SUBDIRS              += os2l
@@ -30,3 +31,6 @@ SUBDIRS              += artnet
 SUBDIRS              += E1.31
 SUBDIRS              += loopback
 SUBDIRS              += osc
+
+# Hardware-free output measuring the engine frames ('qmake CONFIG+=benchmark')
+benchmark:SUBDIRS    += benchmark
@@ -0,0 +1,87 @@
+/*
+  Q Light Controller Plus
+  qlcshmformat.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef QLCSHMFORMAT_H
+#define QLCSHMFORMAT_H
+
+/*
+ * Layout of the shared memory segment published by the Shared Memory
+ * output plugin. This header doesn't depend on Qt, so that local tools
+ * can include it to read the universes.
+ *
+ * The segment starts with a QLCShmHeader. The universeCount QLCShmUniverse
+ * slots follow at headerSize bytes from the start, universeSize bytes
+ * each, and the slot of a QLC+ universe is the one at its index.
+ *
+ * Every slot is protected by a sequence lock: the plugin makes sequence
+ * odd before writing the slot, and even again once done. A reader copies
+ * the slot while sequence is even and unchanged before and after the copy,
+ * otherwise it reads it again:
+ *
+ *  do {
+ *      seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+ *      memcpy(dmx, slot->data, slot->length);
+ *      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+ *  } while ((seq & 1) || seq != __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED));
+ *
+ * The frame counter of the header is incremented once all the universes
+ * of a frame have been written, so a reader can poll it to wait for the
+ * next frame.
+ */
+
+#include <stdint.h>
+
+#define QLCSHM_MAGIC "QLCSHMEM"
+#define QLCSHM_VERSION 1
+
+/** The number of universe slots of the segment */
+#define QLCSHM_UNIVERSES 64
+
+/** The number of channels of a universe slot */
+#define QLCSHM_UNIVERSE_SIZE 512
+
+typedef struct
+{
+    /** QLCSHM_MAGIC, without the terminating zero */
+    char magic[8];
+    uint32_t version;
+    uint32_t universeCount;
+    /** The offset of the first universe slot */
+    uint32_t headerSize;
+    /** The size of a universe slot */
+    uint32_t universeSize;
+    /** The number of frames completed since the segment was created */
+    uint32_t frame;
+    uint32_t reserved[3];
+} QLCShmHeader;
+
+typedef struct
+{
+    /** Odd while the slot is being written */
+    uint32_t sequence;
+    /** The number of valid channels in data. 0 when the universe
+     *  isn't patched to the plugin */
+    uint32_t length;
+    /** The header frame counter when the slot was written */
+    uint32_t frame;
+    uint32_t reserved;
+    uint8_t data[QLCSHM_UNIVERSE_SIZE];
+} QLCShmUniverse;
+
+#endif
@@ -0,0 +1,280 @@
+/*
+  Q Light Controller Plus
+  sharedmemoryplugin.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QStringList>
+#include <QAtomicInt>
+#include <QSettings>
+#include <QDebug>
+#include <string.h>
+
+#include "sharedmemoryplugin.h"
+
+#define SHM_HEADER_SIZE int(sizeof(QLCShmHeader))
+#define SHM_SEGMENT_SIZE (SHM_HEADER_SIZE + QLCSHM_UNIVERSES * int(sizeof(QLCShmUniverse)))
+
+/** The sequence lock and the frame counter are atomic words
+ *  of the segment, shared with the readers */
+static inline QBasicAtomicInt *atomicWord(uint32_t *word)
+{
+    return reinterpret_cast<QBasicAtomicInt *>(word);
+}
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+SharedMemoryPlugin::~SharedMemoryPlugin()
+{
+    QMutexLocker locker(&m_mutex);
+    closeSegment();
+}
+
+void SharedMemoryPlugin::init()
+{
+    m_segment = NULL;
+    m_semaphore = NULL;
+}
+
+QString SharedMemoryPlugin::name()
+{
+    return QString("Shared Memory");
+}
+
+int SharedMemoryPlugin::capabilities() const
+{
+    return QLCIOPlugin::Output;
+}
+
+QString SharedMemoryPlugin::pluginInfo()
+{
+    QString str;
+
+    str += QString("<HTML>");
+    str += QString("<HEAD>");
+    str += QString("<TITLE>%1</TITLE>").arg(name());
+    str += QString("</HEAD>");
+    str += QString("<BODY>");
+
+    str += QString("<P>");
+    str += QString("<H3>%1</H3>").arg(name());
+    str += tr("This plugin publishes the universes in a shared memory segment, "
+              "where applications running on this computer can read them directly.");
+    str += QString("</P>");
+
+    return str;
+}
+
+/*****************************************************************************
+ * Outputs
+ *****************************************************************************/
+
+bool SharedMemoryPlugin::openOutput(quint32 output, quint32 universe)
+{
+    if (output != 0)
+        return false;
+
+    if (universe >= QLCSHM_UNIVERSES)
+    {
+        qWarning() << "[SharedMemory] Universe" << universe + 1 << "can't be published, the segment has"
+                   << QLCSHM_UNIVERSES << "universes";
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_segment == NULL && openSegment() == false)
+        return false;
+
+    if (m_universes.contains(universe) == false)
+        m_universes.append(universe);
+
+    locker.unlock();
+    addToMap(universe, output, Output);
+
+    return true;
+}
+
+void SharedMemoryPlugin::closeOutput(quint32 output, quint32 universe)
+{
+    if (output != 0)
+        return;
+
+    removeFromMap(output, universe, Output);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_universes.removeAll(universe) == 0 || m_segment == NULL)
+        return;
+
+    // readers see the universe as unpatched
+    writeSlot(universe, NULL, 0);
+
+    if (m_universes.isEmpty())
+        closeSegment();
+}
+
+QStringList SharedMemoryPlugin::outputs()
+{
+    QStringList list;
+    list << QString("1: %1").arg(QSettings().value(SETTINGS_SHM_KEY, SHM_DEFAULT_KEY).toString());
+    return list;
+}
+
+QString SharedMemoryPlugin::outputInfo(quint32 output)
+{
+    QString str;
+
+    if (output == 0)
+    {
+        str += QString("<H3>%1</H3>").arg(outputs()[output]);
+
+        QMutexLocker locker(&m_mutex);
+        str += QString("<P>");
+        if (m_segment == NULL)
+        {
+            str += tr("Segment not open");
+        }
+        else
+        {
+            str += tr("Key: %1").arg(m_segment->key());
+            str += QString("<BR>");
+            str += tr("Native key: %1").arg(m_segment->nativeKey());
+            str += QString("<BR>");
+            str += tr("Universes: %1").arg(m_universes.count());
+            if (m_semaphore != NULL)
+            {
+                str += QString("<BR>");
+                str += tr("Frame semaphore: %1").arg(m_semaphore->key());
+            }
+        }
+        str += QString("</P>");
+    }
+
+    str += QString("</BODY>");
+    str += QString("</HTML>");
+
+    return str;
+}
+
+void SharedMemoryPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+{
+    if (output != 0 || universe >= QLCSHM_UNIVERSES)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_segment == NULL)
+        return;
+
+    writeSlot(universe, data.constData(), qMin(data.size(), QLCSHM_UNIVERSE_SIZE));
+}
+
+void SharedMemoryPlugin::frameComplete()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_segment == NULL)
+        return;
+
+    QLCShmHeader *header = static_cast<QLCShmHeader *>(m_segment->data());
+    atomicWord(&header->frame)->fetchAndAddOrdered(1);
+
+    if (m_semaphore != NULL)
+        m_semaphore->release();
+}
+
+/*****************************************************************************
+ * Segment
+ *****************************************************************************/
+
+bool SharedMemoryPlugin::openSegment()
+{
+    QSettings settings;
+    QString key = settings.value(SETTINGS_SHM_KEY, SHM_DEFAULT_KEY).toString();
+
+    m_segment = new QSharedMemory(key);
+
+    // a segment left by a previous instance is reused
+    if (m_segment->create(SHM_SEGMENT_SIZE) == false &&
+        (m_segment->error() != QSharedMemory::AlreadyExists || m_segment->attach() == false))
+    {
+        qWarning() << "[SharedMemory] Cannot open segment" << key << ":" << m_segment->errorString();
+        delete m_segment;
+        m_segment = NULL;
+        return false;
+    }
+
+    if (m_segment->size() < SHM_SEGMENT_SIZE)
+    {
+        qWarning() << "[SharedMemory] Segment" << key << "is too small";
+        delete m_segment;
+        m_segment = NULL;
+        return false;
+    }
+
+    // readers check the magic last, once the header is complete
+    QLCShmHeader *header = static_cast<QLCShmHeader *>(m_segment->data());
+    memset(m_segment->data(), 0, SHM_SEGMENT_SIZE);
+    header->version = QLCSHM_VERSION;
+    header->universeCount = QLCSHM_UNIVERSES;
+    header->headerSize = SHM_HEADER_SIZE;
+    header->universeSize = sizeof(QLCShmUniverse);
+    atomicWord(&header->frame)->storeRelease(0);
+    memcpy(header->magic, QLCSHM_MAGIC, sizeof(header->magic));
+
+    if (settings.value(SETTINGS_SHM_NOTIFY, false).toBool())
+        m_semaphore = new QSystemSemaphore(key + "-frame", 0, QSystemSemaphore::Create);
+
+    qDebug() << "[SharedMemory] Segment" << key << "open, native key:" << m_segment->nativeKey();
+
+    return true;
+}
+
+void SharedMemoryPlugin::closeSegment()
+{
+    delete m_semaphore;
+    m_semaphore = NULL;
+
+    // the segment is destroyed when the last reader detaches
+    delete m_segment;
+    m_segment = NULL;
+}
+
+QLCShmUniverse *SharedMemoryPlugin::universeSlot(quint32 universe) const
+{
+    char *base = static_cast<char *>(m_segment->data()) + SHM_HEADER_SIZE;
+    return reinterpret_cast<QLCShmUniverse *>(base) + universe;
+}
+
+void SharedMemoryPlugin::writeSlot(quint32 universe, const char *data, int length)
+{
+    QLCShmUniverse *slot = universeSlot(universe);
+    QLCShmHeader *header = static_cast<QLCShmHeader *>(m_segment->data());
+    QBasicAtomicInt *sequence = atomicWord(&slot->sequence);
+
+    // odd while writing, so that readers retry
+    sequence->fetchAndAddOrdered(1);
+
+    if (length > 0)
+        memcpy(slot->data, data, length);
+    slot->length = length;
+    slot->frame = atomicWord(&header->frame)->loadAcquire();
+
+    sequence->fetchAndAddOrdered(1);
+}
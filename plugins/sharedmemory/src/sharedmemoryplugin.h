@@ -0,0 +1,127 @@
+/*
+  Q Light Controller Plus
+  sharedmemoryplugin.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SHAREDMEMORYPLUGIN_H
+#define SHAREDMEMORYPLUGIN_H
+
+#include <QSystemSemaphore>
+#include <QSharedMemory>
+#include <QMutex>
+#include <QList>
+
+#include "qlcioplugin.h"
+#include "qlcshmformat.h"
+
+/** Settings key holding the key of the shared memory segment */
+#define SETTINGS_SHM_KEY "SharedMemoryPlugin/key"
+
+/** Settings key enabling the frame semaphore */
+#define SETTINGS_SHM_NOTIFY "SharedMemoryPlugin/notify"
+
+#define SHM_DEFAULT_KEY "qlcplus-universes"
+
+/**
+ * The Shared Memory plugin publishes the universes patched to its output
+ * into a shared memory segment, so that visualizers and other tools running
+ * on the same machine can read the DMX data directly, without the network
+ * stack and the packet loss of a loopback ArtNet or E1.31 connection.
+ *
+ * The segment layout is described in qlcshmformat.h. It is created with the
+ * key configured with SETTINGS_SHM_KEY, which Qt tools can attach to with
+ * QSharedMemory::setKey(), while the native key is shown in the output info.
+ *
+ * When SETTINGS_SHM_NOTIFY is enabled, the QSystemSemaphore with the same
+ * key followed by "-frame" is released once per frame, so that a consumer
+ * can wait for the frames instead of polling the frame counter.
+ */
+class QLC_DECLSPEC SharedMemoryPlugin : public QLCIOPlugin
+{
+    Q_OBJECT
+    Q_INTERFACES(QLCIOPlugin)
+#if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+    Q_PLUGIN_METADATA(IID QLCIOPlugin_iid)
+#endif
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    /** @reimp */
+    virtual ~SharedMemoryPlugin();
+
+    /** @reimp */
+    void init();
+
+    /** @reimp */
+    QString name();
+
+    /** @reimp */
+    int capabilities() const;
+
+    /** @reimp */
+    QString pluginInfo();
+
+    /*********************************************************************
+     * Outputs
+     *********************************************************************/
+public:
+    /** @reimp */
+    bool openOutput(quint32 output, quint32 universe);
+
+    /** @reimp */
+    void closeOutput(quint32 output, quint32 universe);
+
+    /** @reimp */
+    QStringList outputs();
+
+    /** @reimp */
+    QString outputInfo(quint32 output);
+
+    /** @reimp */
+    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+
+    /** @reimp */
+    void frameComplete();
+
+private:
+    /** Create or attach the segment and initialize its header */
+    bool openSegment();
+
+    /** Release the segment and the semaphore */
+    void closeSegment();
+
+    /** Return the slot of $universe in the segment */
+    QLCShmUniverse *universeSlot(quint32 universe) const;
+
+    /** Write $length channels of $data to the slot of $universe */
+    void writeSlot(quint32 universe, const char *data, int length);
+
+private:
+    /** Protects the segment, since frames are written by the
+     *  MasterTimer thread while the lines are opened by the UI */
+    QMutex m_mutex;
+
+    QSharedMemory *m_segment;
+    QSystemSemaphore *m_semaphore;
+
+    /** The universes patched to the output */
+    QList<quint32> m_universes;
+};
+
+#endif
@@ -0,0 +1,30 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = lib
+LANGUAGE = C++
+TARGET   = sharedmemory
+CONFIG  += plugin
+win32:DEFINES += QLC_EXPORT
+
+INCLUDEPATH += ../../interfaces
+
+HEADERS += ../../interfaces/qlcioplugin.h
+HEADERS += qlcshmformat.h
+HEADERS += sharedmemoryplugin.h
+
+SOURCES += ../../interfaces/qlcioplugin.cpp
+SOURCES += sharedmemoryplugin.cpp
+
+# This must be after "TARGET = " and before target installation so that
+# install_name_tool can be run before target installation
+macx:include(../../../platforms/macos/nametool.pri)
+
+target.path = $$INSTALLROOT/$$PLUGINDIR
+INSTALLS   += target
+
+unix:!macx {
+   metainfo.path   = $$METAINFODIR
+   metainfo.files += org.qlcplus.QLCPlus.sharedmemory.metainfo.xml
+   INSTALLS       += metainfo
+}
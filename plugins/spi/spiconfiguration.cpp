@@ -48,6 +48,10 @@ SPIConfiguration::SPIConfiguration(SPIPlugin* plugin, QWidget* parent)
             case 8000000: m_freqCombo->setCurrentIndex(3); break;
         }
     }
+
+    // combo indices follow the SPIOutThread enums
+    m_modeCombo->setCurrentIndex(settings.value("SPIPlugin/outputMode", 0).toInt());
+    m_orderCombo->setCurrentIndex(settings.value("SPIPlugin/colorOrder", 0).toInt());
 }
 
 SPIConfiguration::~SPIConfiguration()
@@ -76,6 +80,16 @@ quint32 SPIConfiguration::frequency()
     }
 }
 
+int SPIConfiguration::outputMode()
+{
+    return m_modeCombo->currentIndex();
+}
+
+int SPIConfiguration::colorOrder()
+{
+    return m_orderCombo->currentIndex();
+}
+
 int SPIConfiguration::exec()
 {
     return QDialog::exec();
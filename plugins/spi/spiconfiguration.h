@@ -40,6 +40,12 @@ public:
 
     quint32 frequency();
 
+    /** Get the selected SPIOutThread::OutputMode */
+    int outputMode();
+
+    /** Get the selected SPIOutThread::ColorOrder */
+    int colorOrder();
+
 public slots:
     int exec();
 
@@ -20,17 +20,36 @@
 #include <QMutexLocker>
 #include <QSettings>
 #include <QDebug>
+#include <QFile>
 
-#include <time.h>
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
 
 #include "spioutthread.h"
 
+#define SPIDEV_BUFSIZ_PATH  "/sys/module/spidev/parameters/bufsiz"
+
+/** Position of the R, G and B bytes within a pixel, for each ColorOrder */
+static const int s_colorOffsets[6][3] =
+{
+    { 0, 1, 2 }, // RGB
+    { 0, 2, 1 }, // RBG
+    { 1, 0, 2 }, // GRB
+    { 2, 0, 1 }, // GBR
+    { 1, 2, 0 }, // BRG
+    { 2, 1, 0 }  // BGR
+};
+
 SPIOutThread::SPIOutThread()
-    : m_isRunning(false)
-    , m_dataSize(0)
-    , m_estimatedWireTime(50000)
+    : m_spifd(-1)
+    , m_bitsPerWord(8)
+    , m_speed(1000000)
+    , m_maxTransferSize(SPI_DEFAULT_BUFSIZ)
+    , m_isRunning(false)
+    , m_outputMode(Raw)
+    , m_colorOrder(RGB)
+    , m_channels(0)
+    , m_changed(false)
 {
 
 }
@@ -59,13 +78,28 @@ void SPIOutThread::runThread(int fd, int speed)
     if(status < 0)
         qWarning() << "Could not set SPI speed (WR)...ioctl fail";
 
+    // spidev refuses messages larger than its bufsiz module parameter
+    QFile bufsiz(SPIDEV_BUFSIZ_PATH);
+    if (bufsiz.open(QIODevice::ReadOnly))
+    {
+        int size = bufsiz.readAll().trimmed().toInt();
+        if (size > 0)
+            m_maxTransferSize = size;
+        bufsiz.close();
+    }
+    qDebug() << "[SPI out thread] max transfer size:" << m_maxTransferSize;
+
     m_isRunning = true;
     start();
 }
 
 void SPIOutThread::stopThread()
 {
-    m_isRunning = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_isRunning = false;
+        m_dataChanged.wakeAll();
+    }
     wait();
 }
 
@@ -76,69 +110,150 @@ void SPIOutThread::setSpeed(int speed)
 
     if (isRunning())
     {
-        m_isRunning = false;
-        wait();
+        stopThread();
         runThread(m_spifd, speed);
     }
 }
 
-void SPIOutThread::run()
+void SPIOutThread::setOutputMode(OutputMode mode, ColorOrder order)
 {
-    while (m_isRunning)
+    QMutexLocker locker(&m_mutex);
+    if (mode == m_outputMode && order == m_colorOrder)
+        return;
+
+    m_outputMode = mode;
+    m_colorOrder = order;
+    setupBuffer();
+}
+
+void SPIOutThread::setChannels(int channels)
+{
+    QMutexLocker locker(&m_mutex);
+    if (channels == m_channels)
+        return;
+
+    m_channels = channels;
+    setupBuffer();
+}
+
+void SPIOutThread::setupBuffer()
+{
+    int pixels = (m_channels + 2) / 3;
+
+    m_channelMap.clear();
+
+    if (m_outputMode == Raw)
+    {
+        m_buffer.fill(0, m_channels);
+    }
+    else
     {
-        struct spi_ioc_transfer spi;
+        int header = 0;
+        int pixelSize = 3;
+        int trailer = 0;
+
+        if (m_outputMode == APA102)
+        {
+            // 32 zero bits of start frame, a 0xE0|brightness byte before
+            // each pixel, and half a clock per pixel of end frame to
+            // push the data through the whole strip
+            header = 4;
+            pixelSize = 4;
+            trailer = (pixels + 15) / 16;
+        }
 
-        struct timespec ts_start;
-        struct timespec ts_end;
-#ifdef CLOCK_MONOTONIC
-        clock_gettime(CLOCK_MONOTONIC, &ts_start);
-#else
-        clock_gettime(CLOCK_REALTIME, &ts_start);
-#endif
+        m_buffer.fill(0, header + pixels * pixelSize + trailer);
+        char *buf = m_buffer.data();
 
-        if (m_spifd != -1 && m_pluginData.size() > 0)
+        if (m_outputMode == APA102)
         {
-            QMutexLocker locker(&m_mutex);
-            memset(&spi, 0, sizeof(spi));
-            spi.tx_buf        = reinterpret_cast<__u64>(m_pluginData.data());
-            spi.len           = m_pluginData.size();
-            spi.delay_usecs   = 0;
-            spi.speed_hz      = m_speed;
-            spi.bits_per_word = m_bitsPerWord;
-            spi.cs_change = 0;
-
-            int retVal = ioctl(m_spifd, SPI_IOC_MESSAGE(1), &spi);
-            if (retVal < 0)
-                qWarning() << "Problem transmitting SPI data: ioctl failed";
+            for (int p = 0; p < pixels; p++)
+                buf[header + p * pixelSize] = char(0xFF);
         }
 
-#ifdef CLOCK_MONOTONIC
-        clock_gettime(CLOCK_MONOTONIC, &ts_end);
-#else
-        clock_gettime(CLOCK_REALTIME, &ts_end);
-#endif
-        int uSecDiff = (difftime(ts_end.tv_sec, ts_start.tv_sec) * 1000000) + ((ts_end.tv_nsec - ts_start.tv_nsec) / 1000);
-        //qDebug() << "[SPI] ioctl took" << microseconds << "uSecDiff";
-        usleep(m_estimatedWireTime - uSecDiff);
+        int offset = pixelSize - 3;
+        const int *color = s_colorOffsets[m_colorOrder];
+
+        m_channelMap.resize(m_channels);
+        for (int i = 0; i < m_channels; i++)
+            m_channelMap[i] = header + (i / 3) * pixelSize + offset + color[i % 3];
     }
+
+    m_changed = true;
+
+    qDebug() << "[SPI out thread] mode" << m_outputMode << "channels" << m_channels
+             << "buffer size" << m_buffer.size();
 }
 
-void SPIOutThread::writeData(const QByteArray &data)
+void SPIOutThread::run()
 {
     QMutexLocker locker(&m_mutex);
-    m_pluginData = data;
-    if (m_dataSize != data.size())
+
+    while (m_isRunning)
     {
-        // Data size has changed ! I need to estimate the
-        // time that the SPI writes will take on the wire.
-        // The estimation is very unprecise and it is based
-        // on Simon Newton's measurements on a Raspberry Pi
-        // where 512 bytes at 1Mhz takes about 70ms to be sent
-
-        double byteWriteTimeuS = (double)(70000.0 / ((double)m_speed / 1000000.0)) / 512.0; // time taken to write a byte
-        m_estimatedWireTime = byteWriteTimeuS * (double)data.size();
-        m_dataSize = data.size();
-        qDebug() << "[SPI out thread] estimated sleep time:" << m_estimatedWireTime;
+        // transfers follow the universe updates, and the strip
+        // is refreshed now and then when nothing changes
+        if (m_changed == false)
+            m_dataChanged.wait(&m_mutex, SPI_REFRESH_MS);
+
+        if (m_isRunning == false)
+            break;
+
+        m_changed = false;
+
+        if (m_spifd != -1 && m_buffer.size() > 0)
+            transmit();
     }
 }
 
+void SPIOutThread::transmit()
+{
+    struct spi_ioc_transfer spi;
+    const char *data = m_buffer.constData();
+    int size = m_buffer.size();
+
+    memset(&spi, 0, sizeof(spi));
+    spi.delay_usecs   = 0;
+    spi.speed_hz      = m_speed;
+    spi.bits_per_word = m_bitsPerWord;
+    spi.cs_change     = 0;
+
+    for (int sent = 0; sent < size; sent += m_maxTransferSize)
+    {
+        spi.tx_buf = reinterpret_cast<__u64>(data + sent);
+        spi.len    = qMin(size - sent, m_maxTransferSize);
+
+        int retVal = ioctl(m_spifd, SPI_IOC_MESSAGE(1), &spi);
+        if (retVal < 0)
+        {
+            qWarning() << "Problem transmitting SPI data: ioctl failed";
+            return;
+        }
+    }
+}
+
+void SPIOutThread::writeData(int address, const QByteArray &data, int count)
+{
+    QMutexLocker locker(&m_mutex);
+
+    count = qMin(count, qMin(data.size(), m_channels - address));
+    if (address < 0 || count <= 0)
+        return;
+
+    const char *src = data.constData();
+    char *dst = m_buffer.data();
+
+    if (m_channelMap.isEmpty())
+    {
+        memcpy(dst + address, src, count);
+    }
+    else
+    {
+        const int *map = m_channelMap.constData() + address;
+        for (int i = 0; i < count; i++)
+            dst[map[i]] = src[i];
+    }
+
+    m_changed = true;
+    m_dataChanged.wakeOne();
+}
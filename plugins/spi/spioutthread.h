@@ -20,20 +20,68 @@
 #ifndef SPIOUTTHREAD_H
 #define SPIOUTTHREAD_H
 
+#include <QWaitCondition>
+#include <QVector>
 #include <QThread>
+#include <QMutex>
+
+/** Time in milliseconds after which an unchanged buffer is sent again */
+#define SPI_REFRESH_MS      1000
+
+/** Default transfer size limit of the spidev driver */
+#define SPI_DEFAULT_BUFSIZ  4096
 
 class SPIOutThread : public QThread
 {
 public:
+    /** How universe channels are laid out on the bus */
+    enum OutputMode
+    {
+        Raw = 0,    //! universe bytes as they are
+        WS2801,     //! 3 bytes per pixel, in the configured color order
+        APA102      //! start frame, 4 bytes per pixel and end frame
+    };
+
+    /** The order in which a pixel's RGB channels are sent */
+    enum ColorOrder
+    {
+        RGB = 0,
+        RBG,
+        GRB,
+        GBR,
+        BRG,
+        BGR
+    };
+
     SPIOutThread();
 
     void runThread(int fd, int speed);
     void stopThread();
     void setSpeed(int speed);
 
+    /** Set the pixel format used to fill the transfer buffer */
+    void setOutputMode(OutputMode mode, ColorOrder order);
+
+    /** Set the total number of channels of all the universes
+     *  mapped on the bus */
+    void setChannels(int channels);
+
     void run();
 
-    void writeData(const QByteArray& data);
+    /**
+     * Convert up to $count channels of $data into the transfer buffer,
+     * starting from the absolute channel $address of the whole strip
+     */
+    void writeData(int address, const QByteArray& data, int count);
+
+private:
+    /** Resize the transfer buffer and rebuild the channel map
+     *  for the current mode. Must be called with m_mutex locked */
+    void setupBuffer();
+
+    /** Send the transfer buffer to the bus, in chunks the
+     *  spidev driver can accept. Must be called with m_mutex locked */
+    void transmit();
 
 protected:
     /** File handle for /dev/spidev0.0 */
@@ -41,20 +89,32 @@ protected:
     int m_bitsPerWord;
     int m_speed;
 
+    /** Largest message the spidev driver accepts */
+    int m_maxTransferSize;
+
     bool m_isRunning;
 
-    /** Copy of data received from the SPI plugin */
-    QByteArray m_pluginData;
+    OutputMode m_outputMode;
+    ColorOrder m_colorOrder;
+
+    /** Number of universe channels mapped on the bus */
+    int m_channels;
+
+    /** The bytes sent on the bus, allocated once per layout.
+     *  Universe data is converted straight into it */
+    QByteArray m_buffer;
 
-    /** Last size of data sent to the SPI bus */
-    int m_dataSize;
+    /** Position in m_buffer of every universe channel,
+     *  empty in Raw mode where positions are the same */
+    QVector<int> m_channelMap;
 
-    /** Roughly estimated time that SPI writes will take on the wire (in uS) */
-    quint32 m_estimatedWireTime;
+    /** Flag raised when m_buffer has changed since it was sent */
+    bool m_changed;
 
     /** Mutex used to synchronize data between the SPI plugin
      *  and the output thread */
     QMutex m_mutex;
+    QWaitCondition m_dataChanged;
 };
 
 #endif // SPIOUTTHREAD_H
@@ -32,6 +32,10 @@
 
 #define SPI_DEFAULT_DEVICE  "/dev/spidev0.0"
 
+#define SETTINGS_FREQUENCY      "SPIPlugin/frequency"
+#define SETTINGS_OUTPUT_MODE    "SPIPlugin/outputMode"
+#define SETTINGS_COLOR_ORDER    "SPIPlugin/colorOrder"
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -39,7 +43,10 @@
 SPIPlugin::~SPIPlugin()
 {
     if (m_outThread != NULL)
+    {
         m_outThread->stopThread();
+        delete m_outThread;
+    }
 
     if (m_spifd != -1)
         close(m_spifd);
@@ -49,6 +56,7 @@ void SPIPlugin::init()
 {
     m_spifd = -1;
     m_referenceCount = 0;
+    m_totalChannels = 0;
     m_outThread = NULL;
 }
 
@@ -87,11 +95,13 @@ bool SPIPlugin::openOutput(quint32 output, quint32 universe)
 
     QSettings settings;
     int speed = 1000000;
-    QVariant value = settings.value("SPIPlugin/frequency");
+    QVariant value = settings.value(SETTINGS_FREQUENCY);
     if (value.isValid() == true)
         speed = value.toUInt();
 
     m_outThread = new SPIOutThread();
+    loadOutputMode();
+    m_outThread->setChannels(m_totalChannels);
     m_outThread->runThread(m_spifd, speed);
 
     return true;
@@ -108,6 +118,13 @@ void SPIPlugin::closeOutput(quint32 output, quint32 universe)
 
     if (m_referenceCount == 0)
     {
+        if (m_outThread != NULL)
+        {
+            m_outThread->stopThread();
+            delete m_outThread;
+            m_outThread = NULL;
+        }
+
         if (m_spifd != -1)
             close(m_spifd);
         m_spifd = -1;
@@ -144,26 +161,39 @@ QString SPIPlugin::pluginInfo()
 void SPIPlugin::setAbsoluteAddress(quint32 uniID, SPIUniverse *uni)
 {
     quint32 totalChannels = 0;
-    quint32 absOffset = 0;
 
+    if (m_uniChannelsMap.value(uniID) != uni)
+        delete m_uniChannelsMap.value(uniID);
+    m_uniChannelsMap[uniID] = uni;
+
+    // universes are laid out on the bus in ID order, so a universe
+    // changing size moves all the ones that follow it
     QHashIterator <quint32, SPIUniverse*> it(m_uniChannelsMap);
     while (it.hasNext() == true)
     {
         it.next();
         if (it.value() == NULL)
             continue;
-        quint32 mapUniID = it.key();
-        if (mapUniID < uniID)
-            absOffset += it.value()->m_channels;
+
+        quint32 absOffset = 0;
+        QHashIterator <quint32, SPIUniverse*> prev(m_uniChannelsMap);
+        while (prev.hasNext() == true)
+        {
+            prev.next();
+            if (prev.value() != NULL && prev.key() < it.key())
+                absOffset += prev.value()->m_channels;
+        }
+        it.value()->m_absoluteAddress = absOffset;
 
         totalChannels += it.value()->m_channels;
     }
-    uni->m_absoluteAddress = absOffset;
-    totalChannels += uni->m_channels;
     qDebug() << "[SPI] universe" << uniID << "has" << uni->m_channels
              << "channels and starts at" << uni->m_absoluteAddress;
-    m_serializedData.resize(totalChannels);
-    qDebug() << "[SPI] total bytes to transmit:" << m_serializedData.size();
+    m_totalChannels = totalChannels;
+    qDebug() << "[SPI] total channels to transmit:" << m_totalChannels;
+
+    if (m_outThread != NULL)
+        m_outThread->setChannels(m_totalChannels);
 }
 
 QString SPIPlugin::outputInfo(quint32 output)
@@ -183,10 +213,10 @@ QString SPIPlugin::outputInfo(quint32 output)
 
 void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
 {
-    if (output != 0 || m_spifd == -1)
+    if (output != 0 || m_spifd == -1 || m_outThread == NULL)
         return;
 
-    qDebug() << "[SPI] write" << universe << "size" << data.size();
+    //qDebug() << "[SPI] write" << universe << "size" << data.size();
 
     SPIUniverse *uniInfo = m_uniChannelsMap[universe];
     if (uniInfo != NULL)
@@ -199,18 +229,17 @@ void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray
                 setAbsoluteAddress(universe, uniInfo);
             }
         }
-        m_serializedData.replace(uniInfo->m_absoluteAddress, data.size(), data);
     }
     else
     {
-        SPIUniverse *newUni = new SPIUniverse;
-        newUni->m_channels = data.size();
-        newUni->m_autoDetection = true;
-        setAbsoluteAddress(universe, newUni);
-        m_uniChannelsMap[universe] = newUni;
+        uniInfo = new SPIUniverse;
+        uniInfo->m_channels = data.size();
+        uniInfo->m_autoDetection = true;
+        setAbsoluteAddress(universe, uniInfo);
     }
 
-    m_outThread->writeData(m_serializedData);
+    // the thread converts the data straight into its transfer buffer
+    m_outThread->writeData(uniInfo->m_absoluteAddress, data, uniInfo->m_channels);
 }
 
 /*****************************************************************************
@@ -223,12 +252,26 @@ void SPIPlugin::configure()
     if (conf.exec() == QDialog::Accepted)
     {
         QSettings settings;
-        settings.setValue("SPIPlugin/frequency", QVariant(conf.frequency()));
+        settings.setValue(SETTINGS_FREQUENCY, QVariant(conf.frequency()));
+        settings.setValue(SETTINGS_OUTPUT_MODE, QVariant(conf.outputMode()));
+        settings.setValue(SETTINGS_COLOR_ORDER, QVariant(conf.colorOrder()));
         if (m_outThread != NULL)
+        {
             m_outThread->setSpeed(conf.frequency());
+            loadOutputMode();
+        }
     }
 }
 
+void SPIPlugin::loadOutputMode()
+{
+    QSettings settings;
+    int mode = settings.value(SETTINGS_OUTPUT_MODE, SPIOutThread::Raw).toInt();
+    int order = settings.value(SETTINGS_COLOR_ORDER, SPIOutThread::RGB).toInt();
+
+    m_outThread->setOutputMode(SPIOutThread::OutputMode(mode), SPIOutThread::ColorOrder(order));
+}
+
 bool SPIPlugin::canConfigure()
 {
     return true;
@@ -249,8 +292,6 @@ void SPIPlugin::setParameter(quint32 universe, quint32 line, Capability type,
         uniStruct->m_autoDetection = false;
 
         setAbsoluteAddress(universe, uniStruct);
-
-        m_uniChannelsMap[universe] = uniStruct;
     }
 }
 
@@ -99,10 +99,9 @@ protected:
     /** Map of <Universe ID/number of channels> */
     QHash<quint32, SPIUniverse*> m_uniChannelsMap;
 
-    /** Array holding all the universes data controlled
-     *  by the SPI plugin, ready to be sent as a serial
-     *  transfer */
-    QByteArray m_serializedData;
+    /** Number of channels of all the universes controlled
+     *  by the SPI plugin, sent as a single serial transfer */
+    int m_totalChannels;
 
     SPIOutThread *m_outThread;
 
@@ -118,6 +117,10 @@ public:
 
     /** @reimp */
     void setParameter(quint32 universe, quint32 line, Capability type, QString name, QVariant value);
+
+private:
+    /** Apply the output mode stored in the settings to the output thread */
+    void loadOutputMode();
 };
 
 #endif
@@ -17,24 +17,81 @@
   limitations under the License.
 */
 
+#include <QSettings>
 #include <QDebug>
-#include <QTime>
-#include <math.h>
 
 #include <sys/ioctl.h>
 #include <asm/termbits.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
 
 #include "uartwidget.h"
 
 #define DMX_MAB 16
 #define DMX_BREAK 110
+#define DMX_BAUDRATE 250000
+
+/** A 0x00 byte at this rate holds the line low for 9 bits (117us)
+ *  and its 2 stop bits give a 26us mark after break */
+#define DMX_BREAK_BAUDRATE 76800
+
+/** Maximum time between two identical frames when skipping is enabled */
+#define UART_KEEPALIVE_INTERVAL 500
+
+#define SETTINGS_FREQUENCY "UARTPlugin/frequency"
+#define SETTINGS_BREAK_MODE "UARTPlugin/breakMode"
+#define SETTINGS_SKIP_UNCHANGED "UARTPlugin/skipUnchanged"
+
+static void addMicroseconds(struct timespec &ts, long us)
+{
+    ts.tv_nsec += us * 1000L;
+    while (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_nsec -= 1000000000L;
+        ts.tv_sec++;
+    }
+}
+
+static qint64 timespecToMicroseconds(const struct timespec &ts)
+{
+    return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/** Sleep until the absolute CLOCK_MONOTONIC time $deadline */
+static void sleepUntil(const struct timespec &deadline)
+{
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) { }
+}
+
+static void sleepMicroseconds(long us)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    addMicroseconds(deadline, us);
+    sleepUntil(deadline);
+}
 
 UARTWidget::UARTWidget(QSerialPortInfo &info, QObject *parent)
     : QThread(parent)
+    , m_mode(Closed)
     , m_running(false)
-    , m_granularity(Unknown)
+    , m_frequency(30)
+    , m_breakMode(IoctlBreak)
+    , m_skipUnchanged(false)
+    , m_outputChanged(false)
+    , m_serialPort(NULL)
 {
     m_serialInfo = info;
+
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_FREQUENCY);
+    if (var.isValid() && var.toDouble() > 0)
+        m_frequency = var.toDouble();
+    if (settings.value(SETTINGS_BREAK_MODE).toInt() == BaudRateBreak)
+        m_breakMode = BaudRateBreak;
+    m_skipUnchanged = settings.value(SETTINGS_SKIP_UNCHANGED, false).toBool();
 }
 
 UARTWidget::~UARTWidget()
@@ -50,7 +107,11 @@ QString UARTWidget::name() const
 bool UARTWidget::open(UARTWidget::WidgetMode mode)
 {
     if (mode == Output)
+    {
+        QMutexLocker locker(&m_outputMutex);
         m_outputBuffer.fill(0, 513);
+        m_outputChanged = true;
+    }
     else if (mode == Input)
         m_inputBuffer.fill(0, 513);
 
@@ -78,7 +139,13 @@ void UARTWidget::updateMode()
 
 void UARTWidget::writeUniverse(const QByteArray &data)
 {
-    m_outputBuffer.replace(1, qMin(data.size(), m_outputBuffer.size()), data);
+    QMutexLocker locker(&m_outputMutex);
+    int size = qMin(data.size(), m_outputBuffer.size() - 1);
+    if (memcmp(m_outputBuffer.constData() + 1, data.constData(), size) == 0)
+        return;
+
+    m_outputBuffer.replace(1, size, data.constData(), size);
+    m_outputChanged = true;
 }
 
 void UARTWidget::stop()
@@ -90,12 +157,59 @@ void UARTWidget::stop()
     }
 }
 
+bool UARTWidget::setBaudRate(int fd, int rate)
+{
+#if defined(TCGETS2)
+    struct termios2 tio;  // linux-specific terminal stuff
+
+    if (ioctl(fd, TCGETS2, &tio) < 0)
+        return false;
+
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= BOTHER;
+    tio.c_ispeed = rate;
+    tio.c_ospeed = rate;  // set custom speed directly
+    if (ioctl(fd, TCSETS2, &tio) < 0)
+        return false;
+
+    return true;
+#else
+    Q_UNUSED(fd)
+    Q_UNUSED(rate)
+    return false;
+#endif
+}
+
+void UARTWidget::sendBreak(int fd)
+{
+    if (m_breakMode == BaudRateBreak)
+    {
+        static const char zero = 0;
+
+        if (setBaudRate(fd, DMX_BREAK_BAUDRATE))
+        {
+            if (::write(fd, &zero, 1) == 1)
+                ioctl(fd, TCSBRK, 1); // same as tcdrain(), which termbits.h lacks
+            setBaudRate(fd, DMX_BAUDRATE);
+            return;
+        }
+
+        qWarning() << "[UARTWidget] Baud rate break not available, falling back to ioctl";
+        m_breakMode = IoctlBreak;
+    }
+
+    ioctl(fd, TIOCSBRK, 0);
+    sleepMicroseconds(DMX_BREAK);
+    ioctl(fd, TIOCCBRK, 0);
+    sleepMicroseconds(DMX_MAB);
+}
+
 void UARTWidget::run()
 {
     qDebug() << "[UARTWidget] Thread created.";
     m_serialPort = new QSerialPort(m_serialInfo);
 
-    m_serialPort->setBaudRate(250000);
+    m_serialPort->setBaudRate(DMX_BAUDRATE);
     m_serialPort->setDataBits(QSerialPort::Data8);
     m_serialPort->setStopBits(QSerialPort::TwoStop);
     m_serialPort->setParity(QSerialPort::NoParity);
@@ -105,31 +219,22 @@ void UARTWidget::run()
     {
         qWarning() << QString("[UARTWidget] Failed to open port %1, error: %2")
                       .arg(m_serialInfo.portName()).arg(m_serialPort->errorString());
+        delete m_serialPort;
+        m_serialPort = NULL;
         return;
     }
 
+    int fd = m_serialPort->handle();
+
 // If the "new" custom baud rate method is available, then use it to
 // make sure the baud rate is properly set to 250Kbps
-
 #if defined(TCGETS2)
-    int fd = m_serialPort->handle();
-    static const int rate = 250000;
-
-    struct termios2 tio;  // linux-specific terminal stuff
-
-    if (ioctl(fd, TCGETS2, &tio) < 0)
-    {
-        qDebug() << "[UARTWidget] Error in getting termios2 data";
-        return;
-    }
-
-    tio.c_cflag &= ~CBAUD;
-    tio.c_cflag |= BOTHER;
-    tio.c_ispeed = rate;
-    tio.c_ospeed = rate;  // set custom speed directly
-    if (ioctl(fd, TCSETS2, &tio) < 0)
+    if (setBaudRate(fd, DMX_BAUDRATE) == false)
     {
         qDebug() << "[UARTWidget] Error in setting termios2 data";
+        m_serialPort->close();
+        delete m_serialPort;
+        m_serialPort = NULL;
         return;
     }
 #endif
@@ -138,38 +243,63 @@ void UARTWidget::run()
     m_serialPort->setRequestToSend(false);
 
     // One "official" DMX frame can take (1s/44Hz) = 23ms
-    int frameTime = (int) floor(((double)1000 / 30) + (double)0.5);
-    m_granularity = Bad;
+    long frameTime = long(1000000.0 / m_frequency + 0.5);
+
+    QByteArray frame;
+    qint64 lastSent = 0;
 
-    QTime time;
-    time.start();
-    usleep(1000);
-    if (time.elapsed() <= 3)
-        m_granularity = Good;
+    // frames start at absolute deadlines, so that the time spent
+    // sending does not accumulate into the frame period
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
 
     m_running = true;
     while (m_running == true)
     {
-        time.restart();
-
         if (m_mode & Output)
         {
-            m_serialPort->setBreakEnabled(true);
-            if(m_granularity == Good)
-                usleep(DMX_BREAK);
-            m_serialPort->setBreakEnabled(false);
-            if(m_granularity == Good)
-                usleep(DMX_MAB);
-
-            if (m_serialPort->write(m_outputBuffer) == 0)
-                qDebug() << "[UARTWidget] Error in writing output buffer";
-            m_serialPort->waitForBytesWritten(10);
-
-            // Sleep for the rest of the DMX frame time
-            if (m_granularity == Good)
-                while (time.elapsed() < frameTime) { usleep(1000); }
-            else
-                while (time.elapsed() < frameTime) { /* Busy sleep */ }
+            bool changed;
+            {
+                QMutexLocker locker(&m_outputMutex);
+                changed = m_outputChanged;
+                m_outputChanged = false;
+                if (changed || frame.isEmpty())
+                    frame = m_outputBuffer;
+            }
+
+            qint64 now = timespecToMicroseconds(deadline);
+
+            if (m_skipUnchanged == false || changed || lastSent == 0 ||
+                now - lastSent >= UART_KEEPALIVE_INTERVAL * 1000)
+            {
+                sendBreak(fd);
+
+                if (::write(fd, frame.constData(), frame.size()) != frame.size())
+                    qDebug() << "[UARTWidget] Error in writing output buffer";
+
+                // wait in the kernel for the frame to leave the UART,
+                // so that the next break cannot truncate it
+                ioctl(fd, TCSBRK, 1);
+                lastSent = now;
+            }
         }
+
+        addMicroseconds(deadline, frameTime);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (timespecToMicroseconds(now) - timespecToMicroseconds(deadline) > frameTime)
+        {
+            // we are more than a frame late: start over from now
+            // instead of sending a burst of frames to catch up
+            deadline = now;
+            continue;
+        }
+
+        sleepUntil(deadline);
     }
+
+    m_serialPort->close();
+    delete m_serialPort;
+    m_serialPort = NULL;
 }
@@ -24,6 +24,7 @@
 #include <QtSerialPort/QSerialPort>
 #include <QByteArray>
 #include <QThread>
+#include <QMutex>
 
 class UARTWidget : public QThread
 {
@@ -73,14 +74,28 @@ protected:
      * Thread methods
      ************************************************************************/
 public:
+    /** How the DMX break is generated */
+    enum BreakMode
+    {
+        /** Hold the line with the TIOCSBRK/TIOCCBRK ioctls */
+        IoctlBreak = 0,
+        /** Send a zero byte at a lower baud rate, whose start and data
+         *  bits make the break and whose stop bits make the MAB */
+        BaudRateBreak = 1
+    };
+
     void writeUniverse(const QByteArray& data);
 
 protected:
-    enum TimerGranularity { Unknown, Good, Bad };
-
     /** Stop the writer thread */
     void stop();
 
+    /** Set the port speed to $rate. Returns false on failure */
+    bool setBaudRate(int fd, int rate);
+
+    /** Generate a break and a mark after break on $fd */
+    void sendBreak(int fd);
+
     /** DMX writer thread worker method */
     void run();
 
@@ -89,7 +104,15 @@ protected:
     QByteArray m_outputBuffer;
     QByteArray m_inputBuffer;
     double m_frequency;
-    TimerGranularity m_granularity;
+    BreakMode m_breakMode;
+
+    /** When enabled, frames equal to the previous one are only sent
+     *  every UART_KEEPALIVE_INTERVAL milliseconds */
+    bool m_skipUnchanged;
+
+    /** Flag raised by writeUniverse when m_outputBuffer changes */
+    bool m_outputChanged;
+    QMutex m_outputMutex;
 
     QSerialPortInfo m_serialInfo;
     QSerialPort *m_serialPort;
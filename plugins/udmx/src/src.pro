@@ -16,11 +16,13 @@ unix:CONFIG      += link_pkgconfig
 unix:PKGCONFIG   += libusb
 win32:QMAKE_LFLAGS += -shared
 
-HEADERS += ../../interfaces/qlcioplugin.h
+HEADERS += ../../interfaces/qlcioplugin.h \
+           ../../interfaces/qlcusboutput.h
 HEADERS += udmxdevice.h \
            udmx.h
 
-SOURCES += ../../interfaces/qlcioplugin.cpp
+SOURCES += ../../interfaces/qlcioplugin.cpp \
+           ../../interfaces/qlcusboutput.cpp
 SOURCES += udmxdevice.cpp \
            udmx.cpp
 
@@ -25,7 +25,6 @@
 #   include <usb.h>
 #endif
 
-#include <QElapsedTimer>
 #include <QSettings>
 #include <QDebug>
 #include <cmath>
@@ -51,13 +50,12 @@
  ****************************************************************************/
 
 UDMXDevice::UDMXDevice(struct usb_device* device, QObject* parent)
-    : QThread(parent)
+    : QObject(parent)
     , m_device(device)
     , m_handle(NULL)
-    , m_running(false)
+    , m_output(new QLCUsbOutput(this, this))
     , m_universe(QByteArray(DMX_CHANNELS, 0))
     , m_frequency(30)
-    , m_granularity(Unknown)
 {
     Q_ASSERT(device != NULL);
 
@@ -75,6 +73,10 @@ UDMXDevice::UDMXDevice(struct usb_device* device, QObject* parent)
         m_universe = QByteArray(channels, 0);
     }
 
+    // One "official" DMX frame can take (1s/44Hz) = 23ms
+    if (m_frequency > 0)
+        m_output->setRefreshInterval(int(floor((1000.0 / m_frequency) + 0.5)));
+
     extractName();
 }
 
@@ -142,7 +144,6 @@ QString UDMXDevice::name() const
 QString UDMXDevice::infoText() const
 {
     QString info;
-    QString gran;
 
     if (m_device != NULL && m_handle != NULL)
     {
@@ -152,13 +153,9 @@ QString UDMXDevice::infoText() const
         info += QString("<BR>");
         info += QString("<B>%1:</B> %2Hz").arg(tr("DMX Frame Frequency")).arg(m_frequency);
         info += QString("<BR>");
-        if (m_granularity == Bad)
-            gran = QString("<FONT COLOR=\"#aa0000\">%1</FONT>").arg(tr("Bad"));
-        else if (m_granularity == Good)
-            gran = QString("<FONT COLOR=\"#00aa00\">%1</FONT>").arg(tr("Good"));
-        else
-            gran = tr("Patch this device to a universe to find out.");
-        info += QString("<B>%1:</B> %2").arg(tr("System Timer Accuracy")).arg(gran);
+        info += QString("<B>%1:</B> %2").arg(tr("Frames written")).arg(m_output->framesWritten());
+        info += QString("<BR>");
+        info += QString("<B>%1:</B> %2").arg(tr("Write errors")).arg(m_output->writeErrors());
         info += QString("</P>");
     }
     else
@@ -184,14 +181,16 @@ bool UDMXDevice::open()
     if (m_handle == NULL)
         return false;
 
-    start();
+    // the device keeps no state: start from the last known values
+    m_output->startOutput();
+    m_output->queueFrame(0, m_universe);
 
     return true;
 }
 
 void UDMXDevice::close()
 {
-    stop();
+    m_output->stopOutput();
 
     if (m_device != NULL && m_handle != NULL)
         usb_close(m_handle);
@@ -209,67 +208,38 @@ const usb_dev_handle* UDMXDevice::handle() const
 }
 
 /****************************************************************************
- * Thread
+ * Write
  ****************************************************************************/
 
 void UDMXDevice::outputDMX(const QByteArray& universe)
 {
-    m_universe.replace(0, MIN(universe.size(), m_universe.size()),
-                       universe.constData(), MIN(universe.size(), m_universe.size()));
-}
+    int size = MIN(universe.size(), m_universe.size());
+    m_universe.replace(0, size, universe.constData(), size);
 
-void UDMXDevice::stop()
-{
-    while (isRunning() == true)
-    {
-	// This may occur before the thread sets m_running,
-	// so timeout and try again if necessary
-        m_running = false;
-        wait(100);
-    }
+    m_output->queueFrame(0, m_universe);
 }
 
-void UDMXDevice::run()
+bool UDMXDevice::writeFrame(quint32 line, const QByteArray& data)
 {
-    // One "official" DMX frame can take (1s/44Hz) = 23ms
-    int frameTime = (int) floor(((double)1000 / m_frequency) + (double)0.5);
-    int r = 0;
-
-    // Wait for device to settle in case the device was opened just recently
-    // Also measure, whether timer granularity is OK
-    QElapsedTimer time;
-    time.start();
-    usleep(1000);
-    if (time.elapsed() > 3)
-        m_granularity = Bad;
-    else
-        m_granularity = Good;
+    Q_UNUSED(line)
 
-    m_running = true;
-    while (m_running == true)
-    {
-        if (m_handle == NULL)
-            goto framesleep;
-
-        time.restart();
+    if (m_handle == NULL)
+        return false;
 
-        /* Write all 512 channels */
-        r = usb_control_msg(m_handle,
+    /* Write all the channels */
+    int r = usb_control_msg(m_handle,
                             USB_TYPE_VENDOR | USB_RECIP_DEVICE | USB_ENDPOINT_OUT,
                             UDMX_SET_CHANNEL_RANGE,   /* Command */
-                            m_universe.size(),        /* Number of channels to set */
+                            data.size(),              /* Number of channels to set */
                             0,                        /* Starting index */
-                            (char*)m_universe.data(), /* Values to set */
-                            m_universe.size(),        /* Size of values */
+                            (char*)data.constData(),  /* Values to set */
+                            data.size(),              /* Size of values */
                             500);                     /* Timeout 0.5s */
-        if (r < 0)
-            qWarning() << "uDMX: unable to write universe:" << usb_strerror();
-
-framesleep:
-        // Sleep for the remainder of the DMX frame time
-        if (m_granularity == Good)
-            while (time.elapsed() < frameTime) { usleep(1000); }
-        else
-            while (time.elapsed() < frameTime) { /* Busy sleep */ }
+    if (r < 0)
+    {
+        qWarning() << "uDMX: unable to write universe:" << usb_strerror();
+        return false;
     }
+
+    return true;
 }
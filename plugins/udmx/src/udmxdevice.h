@@ -21,12 +21,14 @@
 #ifndef UDMXDEVICE_H
 #define UDMXDEVICE_H
 
-#include <QThread>
+#include <QObject>
+
+#include "qlcusboutput.h"
 
 struct usb_dev_handle;
 struct usb_device;
 
-class UDMXDevice : public QThread
+class UDMXDevice : public QObject, public QLCUsbOutput::Writer
 {
     Q_OBJECT
 
@@ -68,25 +70,20 @@ private:
     usb_dev_handle* m_handle;
 
     /********************************************************************
-     * Thread
+     * Write
      ********************************************************************/
 public:
+    /** Queue $universe to be written by the output thread */
     void outputDMX(const QByteArray& universe);
 
-private:
-    enum TimerGranularity { Unknown, Good, Bad };
-
-    /** Stop the writer thread */
-    void stop();
-
-    /** DMX writer thread worker method */
-    void run();
+    /** @reimp */
+    bool writeFrame(quint32 line, const QByteArray& data);
 
 private:
-    bool m_running;
+    /** The output thread, refreshing the device at m_frequency */
+    QLCUsbOutput* m_output;
     QByteArray m_universe;
     double m_frequency;
-    TimerGranularity m_granularity;
 };
 
 #endif
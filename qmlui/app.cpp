@@ -41,6 +41,7 @@
 #include "fixtureeditor.h"
 #include "modelselector.h"
 #include "videoprovider.h"
+#include "imageprovider.h"
 #include "importmanager.h"
 #include "contextmanager.h"
 #include "virtualconsole.h"
@@ -57,12 +58,15 @@
 #include "qlcfixturedefcache.h"
 #include "audioplugincache.h"
 #include "rgbscriptscache.h"
+#include "workspacecache.h"
+#include "loadgovernor.h"
 #include "qlcfixturedef.h"
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
 #define SETTINGS_WORKINGPATH "workspace/workingpath"
 #define SETTINGS_RECENTFILE "workspace/recent"
+#define SETTINGS_BINARYCACHE "workspace/binarycache"
 #define KXMLQLCWorkspaceWindow "CurrentWindow"
 
 #define MAX_RECENT_FILES    10
@@ -130,6 +134,7 @@ void App::startup()
         qWarning() << "Roboto mono cannot be loaded!";
 
     rootContext()->setContextProperty("qlcplus", this);
+    engine()->addImageProvider(IMAGE_PROVIDER_NAME, new ImageProvider());
 
     m_pixelDensity = qMax(screen()->physicalDotsPerInch() *  0.039370, (qreal)screen()->size().height() / 220.0);
     qDebug() << "Pixel density:" << m_pixelDensity << "size:" << screen()->physicalSize();
@@ -369,6 +374,9 @@ void App::initDoc()
 
     connect(m_doc, SIGNAL(modified(bool)), this, SIGNAL(docModifiedChanged()));
 
+    /* Keep an index of the definitions, to avoid reading them all at startup */
+    m_doc->fixtureDefCache()->setIndexFile(QLCFixtureDefCache::defaultIndexFile());
+
     /* Load user fixtures first so that they override system fixtures */
     m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
     m_doc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
@@ -406,6 +414,7 @@ void App::initDoc()
     m_doc->inputOutputMap()->setBeatGeneratorType(InputOutputMap::Internal);
     m_doc->inputOutputMap()->startUniverses();
     m_doc->masterTimer()->start();
+    m_doc->loadGovernor()->start();
 }
 
 void App::enableKioskMode()
@@ -640,7 +649,7 @@ bool App::saveWorkspace(const QString &fileName)
         localFilename = QUrl(fileName).toLocalFile();
 
     /* Always use the workspace suffix */
-    if (localFilename.right(4) != KExtWorkspace)
+    if (localFilename.right(4) != KExtWorkspace && QLCFile::isCompressedWorkspace(localFilename) == false)
         localFilename += KExtWorkspace;
 
     /* Set the workspace path before saving the new XML. In this way local files
@@ -686,6 +695,15 @@ QFileDevice::FileError App::loadXML(const QString &fileName)
        can be loaded even if the workspace file has been moved */
     m_doc->setWorkspacePath(QFileInfo(fileName).absolutePath());
 
+    /* Playback-only installations can keep a binary cache next to the
+       workspace, to restore it faster the next time it is opened */
+    QSettings settings;
+    bool useCache = settings.value(SETTINGS_BINARYCACHE, false).toBool();
+    WorkspaceCache cache(fileName);
+    bool cacheValid = useCache && cache.isValid();
+    if (cacheValid)
+        m_doc->setWorkspaceCache(&cache);
+
     if (doc->dtdName() == KXMLQLCWorkspace)
     {
         if (loadXML(*doc) == false)
@@ -697,6 +715,9 @@ QFileDevice::FileError App::loadXML(const QString &fileName)
             setFileName(fileName);
             m_doc->resetModified();
             retval = QFile::NoError;
+
+            if (useCache && cacheValid == false)
+                cache.save(m_doc);
         }
     }
     else
@@ -705,6 +726,7 @@ QFileDevice::FileError App::loadXML(const QString &fileName)
         qWarning() << Q_FUNC_INFO << fileName << "is not a workspace file";
     }
 
+    m_doc->setWorkspaceCache(NULL);
     QLCFile::releaseXMLReader(doc);
 
     return retval;
@@ -784,7 +806,13 @@ QFile::FileError App::saveXML(const QString& fileName)
     if (file.open(QIODevice::WriteOnly) == false)
         return file.error();
 
-    QXmlStreamWriter doc(&file);
+    /* Compressed workspaces are written in memory first */
+    QBuffer buffer;
+    bool compressed = QLCFile::isCompressedWorkspace(fileName);
+    if (compressed)
+        buffer.open(QIODevice::WriteOnly);
+
+    QXmlStreamWriter doc(compressed ? (QIODevice *)&buffer : (QIODevice *)&file);
     doc.setAutoFormatting(true);
     doc.setAutoFormattingIndent(1);
     doc.setCodec("UTF-8");
@@ -818,6 +846,11 @@ QFile::FileError App::saveXML(const QString& fileName)
 
     /* End the document and close all the open elements */
     doc.writeEndDocument();
+    if (compressed)
+    {
+        buffer.close();
+        file.write(QLCFile::compressXML(buffer.data()));
+    }
     file.close();
 
     // Save to actual requested file name
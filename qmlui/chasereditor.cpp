@@ -124,13 +124,7 @@ bool ChaserEditor::addStep(int insertIndex)
 
     if (m_chaser->stepsCount() == 0)
     {
-        QListIterator <SceneValue> it(currScene->values());
-        while (it.hasNext() == true)
-        {
-            SceneValue chan(it.next());
-            step.values.append(chan);
-            //qDebug() << "Value added: " << chan.value;
-        }
+        step.values = currScene->values();
     }
     else
     {
@@ -326,16 +320,16 @@ void ChaserEditor::updateStepsList(Doc *doc, Chaser *chaser, ListModel *stepsLis
     if (doc == nullptr || chaser == nullptr || stepsList == nullptr)
         return;
 
+    stepsList->beginUpdate();
     stepsList->clear();
 
-    if (chaser == nullptr)
-        return;
-
     for (int i = 0; i < chaser->stepsCount(); i++)
     {
         ChaserStep *step = chaser->stepAt(i);
         addStepToListModel(doc, chaser, stepsList, step);
     }
+
+    stepsList->endUpdate();
 }
 
 void ChaserEditor::setSelectedValue(Function::PropType type, QString param, uint value, bool selectedOnly)
@@ -33,6 +33,7 @@ CollectionEditor::CollectionEditor(QQuickView *view, Doc *doc, QObject *parent)
     QStringList listRoles;
     listRoles << "funcID" << "isSelected";
     m_functionsList->setRoleNames(listRoles);
+    m_functionsList->setKeyRole("funcID");
 }
 
 void CollectionEditor::setFunctionID(quint32 ID)
@@ -104,6 +105,7 @@ void CollectionEditor::updateFunctionsList()
 {
     if (m_collection != nullptr)
     {
+        m_functionsList->beginUpdate();
         m_functionsList->clear();
 
         for (quint32 fId : m_collection->functions())
@@ -114,6 +116,7 @@ void CollectionEditor::updateFunctionsList()
             funcMap.insert("isSelected", false);
             m_functionsList->addDataMap(funcMap);
         }
+        m_functionsList->endUpdate();
     }
     emit functionsListChanged();
 }
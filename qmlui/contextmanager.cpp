@@ -19,11 +19,15 @@
 
 #include <QQmlContext>
 #include <QQuickItem>
+#include <QSettings>
 #include <QDebug>
 #include <QtMath>
 
+#include <algorithm>
+
 #include "contextmanager.h"
 #include "monitorproperties.h"
+#include "loadgovernor.h"
 #include "genericdmxsource.h"
 #include "functionmanager.h"
 #include "fixturemanager.h"
@@ -36,6 +40,9 @@
 #include "tardis.h"
 #include "doc.h"
 
+#define SETTINGS_PREVIEW_MAX_FPS "preview/maxfps"
+#define DEFAULT_PREVIEW_MAX_FPS 60
+
 ContextManager::ContextManager(QQuickView *view, Doc *doc,
                                FixtureManager *fxMgr,
                                FunctionManager *funcMgr, SimpleDesk *sDesk,
@@ -50,7 +57,9 @@ ContextManager::ContextManager(QQuickView *view, Doc *doc,
     , m_multipleSelection(false)
     , m_positionPicking(false)
     , m_universeFilter(Universe::invalid())
+    , m_maxPreviewFPS(DEFAULT_PREVIEW_MAX_FPS)
     , m_editingEnabled(false)
+    , m_universeFixturesRevision(-1)
     , m_dumpChannelMask(0)
 {
     m_view->rootContext()->setContextProperty("contextManager", this);
@@ -96,6 +105,16 @@ ContextManager::ContextManager(QQuickView *view, Doc *doc,
 
     connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)), this, SLOT(slotUniverseWritten(quint32,QByteArray)));
     connect(m_functionManager, &FunctionManager::isEditingChanged, this, &ContextManager::slotFunctionEditingChanged);
+
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_PREVIEW_MAX_FPS);
+    if (var.isValid() && var.toInt() > 0)
+        m_maxPreviewFPS = var.toInt();
+
+    m_previewTimer.setSingleShot(true);
+    updatePreviewInterval();
+    connect(&m_previewTimer, SIGNAL(timeout()), this, SLOT(slotPreviewTimeout()));
+    connect(m_doc->loadGovernor(), &LoadGovernor::levelChanged, this, &ContextManager::updatePreviewInterval);
 }
 
 ContextManager::~ContextManager()
@@ -496,6 +515,54 @@ void ContextManager::setUniverseFilter(quint32 universeFilter)
     emit universeFilterChanged(universeFilter);
 }
 
+/*********************************************************************
+ * Preview refresh
+ *********************************************************************/
+
+int ContextManager::maxPreviewFPS() const
+{
+    return m_maxPreviewFPS;
+}
+
+void ContextManager::updatePreviewInterval()
+{
+    /* The previews give way to the engine when it's overloaded */
+    m_previewTimer.setInterval(1000 / m_doc->loadGovernor()->scaledRate(m_maxPreviewFPS));
+}
+
+void ContextManager::setMaxPreviewFPS(int maxPreviewFPS)
+{
+    maxPreviewFPS = qBound(1, maxPreviewFPS, 1000);
+
+    if (m_maxPreviewFPS == maxPreviewFPS)
+        return;
+
+    m_maxPreviewFPS = maxPreviewFPS;
+    updatePreviewInterval();
+
+    QSettings settings;
+    settings.setValue(SETTINGS_PREVIEW_MAX_FPS, m_maxPreviewFPS);
+
+    emit maxPreviewFPSChanged(m_maxPreviewFPS);
+}
+
+void ContextManager::slotPreviewTimeout()
+{
+    QHash<quint32, QByteArray> universes = m_pendingUniverses;
+    m_pendingUniverses.clear();
+
+    QHashIterator<quint32, QByteArray> it(universes);
+    while (it.hasNext())
+    {
+        it.next();
+        updateUniverseFixturesValues(it.key(), it.value());
+    }
+
+    // the grid reads the universe frames on its own
+    if (m_DMXView->isEnabled() && m_DMXView->gridMode())
+        m_DMXView->updateGrid();
+}
+
 /*********************************************************************
  * Common fixture helpers
  *********************************************************************/
@@ -1295,13 +1362,61 @@ void ContextManager::slotSimpleDeskValueChanged(quint32 fxID, quint32 channel, q
 
 void ContextManager::slotUniverseWritten(quint32 idx, const QByteArray &ua)
 {
-    for (Fixture *fixture : m_doc->fixtures())
+    // the frames written until the next update replace this one
+    m_pendingUniverses[idx] = ua;
+
+    if (m_previewTimer.isActive() == false)
+        m_previewTimer.start();
+}
+
+void ContextManager::updateUniverseFixturesValues(quint32 idx, const QByteArray &ua)
+{
+    if (m_universeFixturesRevision != m_doc->fixturesRevision())
+        updateUniverseFixtures();
+
+    QHash<quint32, QVector<Fixture *>>::const_iterator fxIt = m_universeFixtures.constFind(idx);
+    if (fxIt == m_universeFixtures.constEnd())
+        return;
+
+    QByteArray previous = m_universeValues.value(idx);
+    m_universeValues[idx] = ua;
+
+    /* Find the range of the changed channels. Without a previous
+     * frame of the same size, all the fixtures are checked */
+    bool hasPrevious = previous.size() == ua.size();
+    int first = 0;
+    int last = ua.size() - 1;
+
+    if (hasPrevious)
     {
-        if (fixture->universe() != idx)
+        while (first <= last && previous.at(first) == ua.at(first))
+            first++;
+
+        if (first > last)
+            return;
+
+        while (previous.at(last) == ua.at(last))
+            last--;
+    }
+
+    QByteArray prevValues;
+
+    for (Fixture *fixture : fxIt.value())
+    {
+        int address = int(fixture->address());
+        if (address > last)
+            break;
+
+        if (address + int(fixture->channels()) <= first)
             continue;
 
-        QByteArray prevValues;
-        prevValues.append(fixture->channelValues());
+        /* The fixture values are the ones of the previous frame,
+         * so they are read from it without copying them */
+        if (hasPrevious)
+            prevValues.setRawData(previous.constData() + address,
+                                  uint(qMin(int(fixture->channels()), previous.size() - address)));
+        else
+            prevValues = fixture->channelValues();
 
         if (fixture->setChannelValues(ua) == true)
         {
@@ -1315,6 +1430,24 @@ void ContextManager::slotUniverseWritten(quint32 idx, const QByteArray &ua)
     }
 }
 
+void ContextManager::updateUniverseFixtures()
+{
+    m_universeFixtures.clear();
+    // the fixture values may not match the last frames anymore
+    m_universeValues.clear();
+
+    for (Fixture *fixture : m_doc->fixtures())
+        m_universeFixtures[fixture->universe()].append(fixture);
+
+    for (QVector<Fixture *> &fixtures : m_universeFixtures)
+    {
+        std::sort(fixtures.begin(), fixtures.end(),
+                  [](const Fixture *a, const Fixture *b) { return a->address() < b->address(); });
+    }
+
+    m_universeFixturesRevision = m_doc->fixturesRevision();
+}
+
 void ContextManager::slotFunctionEditingChanged(bool status)
 {
     resetFixtureSelection();
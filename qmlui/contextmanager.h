@@ -23,11 +23,15 @@
 #include <QObject>
 #include <QQuickView>
 #include <QVector3D>
+#include <QTimer>
+#include <QVector>
+#include <QHash>
 
 #include "qlcchannel.h"
 #include "scenevalue.h"
 
 class Doc;
+class Fixture;
 class MainView2D;
 class MainView3D;
 class MainViewDMX;
@@ -52,6 +56,7 @@ class ContextManager : public QObject
     Q_PROPERTY(quint32 dumpChannelMask READ dumpChannelMask NOTIFY dumpChannelMaskChanged)
     Q_PROPERTY(bool multipleSelection READ multipleSelection WRITE setMultipleSelection NOTIFY multipleSelectionChanged)
     Q_PROPERTY(bool positionPicking READ positionPicking WRITE setPositionPicking NOTIFY positionPickingChanged)
+    Q_PROPERTY(int maxPreviewFPS READ maxPreviewFPS WRITE setMaxPreviewFPS NOTIFY maxPreviewFPSChanged)
 
 public:
     explicit ContextManager(QQuickView *view, Doc *doc,
@@ -156,6 +161,37 @@ private:
       * The value Universe::invalid() means "All universes" */
     quint32 m_universeFilter;
 
+    /*********************************************************************
+     * Preview refresh
+     *********************************************************************/
+public:
+    /** Get/Set the maximum number of preview updates per second.
+     *  The value is stored in the application settings */
+    int maxPreviewFPS() const;
+    void setMaxPreviewFPS(int maxPreviewFPS);
+
+signals:
+    void maxPreviewFPSChanged(int maxPreviewFPS);
+
+protected slots:
+    /** Apply the latest frame of the universes written since the last update */
+    void slotPreviewTimeout();
+
+    /** Apply the preview rate allowed by the LoadGovernor level */
+    void updatePreviewInterval();
+
+private:
+    /** Update the fixtures and the previews with the frame $ua of universe $idx */
+    void updateUniverseFixturesValues(quint32 idx, const QByteArray& ua);
+
+private:
+    /** The maximum number of preview updates per second */
+    int m_maxPreviewFPS;
+    /** Timer to coalesce the universe frames in one preview update */
+    QTimer m_previewTimer;
+    /** The latest frame of each universe, waiting for the next update */
+    QHash<quint32, QByteArray> m_pendingUniverses;
+
     /*********************************************************************
      * Common fixture helpers
      *********************************************************************/
@@ -239,6 +275,9 @@ protected slots:
      *  Universe at $idx has changed */
     void slotUniverseWritten(quint32 idx, const QByteArray& ua);
 
+    /** Rebuild the per universe lists of fixtures */
+    void updateUniverseFixtures();
+
     /** Invoked when Function editing begins or ends in the Function Manager.
      *  Context Manager doesn't care much about Functions, it just needs
      *  to know if it has to set channel values on the GenericDMXSource or
@@ -261,6 +300,15 @@ private:
     /** The hash is: int (channel type) , SceneValue (Fixture ID and channel) */
     QMultiHash<int, SceneValue> m_channelsMap;
 
+    /** The fixtures of each universe, sorted by address */
+    QHash<quint32, QVector<Fixture *>> m_universeFixtures;
+
+    /** The Doc fixtures revision m_universeFixtures was built with */
+    int m_universeFixturesRevision;
+
+    /** The last frame of each universe, to find the changed channels */
+    QHash<quint32, QByteArray> m_universeValues;
+
     /*********************************************************************
      * DMX channels dump
      *********************************************************************/
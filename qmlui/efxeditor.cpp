@@ -536,10 +536,14 @@ void EFXEditor::setFixtureOffset(quint32 fixtureID, int headIndex, int offset)
 
 void EFXEditor::updateFixtureList()
 {
-    m_fixtureList->clear();
-
     if (m_efx == nullptr)
+    {
+        m_fixtureList->clear();
         return;
+    }
+
+    m_fixtureList->beginUpdate();
+    m_fixtureList->clear();
 
     qreal oldPanDegrees = m_maxPanDegrees;
     qreal oldTiltDegrees = m_maxTiltDegrees;
@@ -574,6 +578,8 @@ void EFXEditor::updateFixtureList()
         m_fixtureList->addDataMap(fxMap);
     }
 
+    m_fixtureList->endUpdate();
+
     emit fixtureListChanged();
     if (oldPanDegrees != m_maxPanDegrees)
         emit maxPanDegreesChanged();
@@ -255,13 +255,10 @@ int FixtureBrowser::availableChannel(quint32 uniIdx, int channels, int quantity,
     quint32 absAddress = (requested & 0x01FF) | (uniFilter << 9);
     for (int n = 0; n < quantity; n++)
     {
-        for (int i = 0; i < channels; i++)
+        if (m_doc->isAddressRangeAvailable(absAddress, channels) == false)
         {
-            if(m_doc->fixtureForAddress(absAddress + i) != Fixture::invalidId())
-            {
-                isAvailable = false;
-                break;
-            }
+            isAvailable = false;
+            break;
         }
         absAddress += channels + gap;
     }
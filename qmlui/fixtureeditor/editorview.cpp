@@ -46,6 +46,7 @@ EditorView::EditorView(QQuickView *view, QLCFixtureDef *fixtureDef, QObject *par
     QStringList chRoles;
     chRoles << "cRef" << "isSelected";
     m_channelList->setRoleNames(chRoles);
+    m_channelList->setKeyRole("cRef");
 
     updateChannelList();
 
@@ -145,6 +146,7 @@ PhysicalEdit *EditorView::globalPhysical()
 
 void EditorView::updateChannelList()
 {
+    m_channelList->beginUpdate();
     m_channelList->clear();
 
     for (QLCChannel *channel : m_fixtureDef->channels())
@@ -155,6 +157,8 @@ void EditorView::updateChannelList()
         m_channelList->addDataMap(chanMap);
     }
 
+    m_channelList->endUpdate();
+
     emit channelsChanged();
 }
 
@@ -221,6 +225,7 @@ ModeEdit *EditorView::requestModeEditor(QString name)
 
 void EditorView::updateModeList()
 {
+    m_modeList->beginUpdate();
     m_modeList->clear();
 
     for (QLCFixtureMode *mode : m_fixtureDef->modes())
@@ -232,6 +237,8 @@ void EditorView::updateModeList()
         m_modeList->addDataMap(modeMap);
     }
 
+    m_modeList->endUpdate();
+
     emit modesChanged();
 }
 
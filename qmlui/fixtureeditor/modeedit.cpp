@@ -31,6 +31,7 @@ ModeEdit::ModeEdit(QLCFixtureMode *mode, QObject *parent)
     QStringList chRoles;
     chRoles << "cRef" << "isSelected";
     m_channelList->setRoleNames(chRoles);
+    m_channelList->setKeyRole("cRef");
 
     updateChannelList();
 
@@ -103,6 +104,7 @@ bool ModeEdit::deleteChannel(QLCChannel *channel)
 
 void ModeEdit::updateChannelList()
 {
+    m_channelList->beginUpdate();
     m_channelList->clear();
 
     for (QLCChannel *channel : m_mode->channels())
@@ -113,6 +115,8 @@ void ModeEdit::updateChannelList()
         m_channelList->addDataMap(chanMap);
     }
 
+    m_channelList->endUpdate();
+
     emit channelsChanged();
 }
 
@@ -151,6 +155,7 @@ void ModeEdit::deleteHeads(QVariantList headIndexList)
 
 void ModeEdit::updateHeadsList()
 {
+    m_headList->beginUpdate();
     m_headList->clear();
 
     for (QLCFixtureHead head : m_mode->heads())
@@ -161,6 +166,8 @@ void ModeEdit::updateHeadsList()
         m_headList->addDataMap(headMap);
     }
 
+    m_headList->endUpdate();
+
     emit headsChanged();
 }
 
@@ -341,14 +341,12 @@ bool FixtureManager::deleteFixtures(QVariantList IDList)
         Tardis::instance()->enqueueAction(Tardis::FixtureDelete, itemID,
                                           Tardis::instance()->actionToByteArray(Tardis::FixtureDelete, fxID),
                                           QVariant());
+        removeFixtureNode(m_doc->fixture(fxID));
         m_doc->deleteFixture(fxID);
         emit fixtureDeleted(itemID);
     }
 
     emit fixturesCountChanged();
-
-    updateGroupsTree(m_doc, m_fixtureTree, m_searchFilter);
-    emit groupsTreeModelChanged();
     emit fixturesMapChanged();
 
     return true;
@@ -812,6 +810,55 @@ int FixtureManager::fixtureLinkedIndex(quint32 itemID)
     return FixtureUtils::itemLinkedIndex(itemID);
 }
 
+void FixtureManager::removeFixtureNode(Fixture *fixture)
+{
+    if (m_fixtureTree == nullptr || fixture == nullptr)
+        return;
+
+    MonitorProperties *monProps = m_doc->monitorProperties();
+    QStringList uniNames = m_doc->inputOutputMap()->universeNames();
+    QStringList basePaths, fxNames;
+    QString universeName;
+
+    if (fixture->universe() < (quint32)uniNames.count())
+    {
+        universeName = uniNames.at(fixture->universe());
+        basePaths.append(universeName);
+    }
+
+    if (m_treeShowFlags & ShowGroups)
+    {
+        for (FixtureGroup *grp : m_doc->fixtureGroups()) // C++11
+        {
+            if (grp->fixtureList().contains(fixture->id()))
+                basePaths.append(grp->name());
+        }
+    }
+
+    fxNames.append(fixture->name());
+    for (quint32 subID : monProps->fixtureIDList(fixture->id()))
+    {
+        quint16 headIndex = monProps->fixtureHeadIndex(subID);
+        quint16 linkedIndex = monProps->fixtureLinkedIndex(subID);
+        if (linkedIndex)
+            fxNames.append(monProps->fixtureResource(fixture->id(), headIndex, linkedIndex));
+    }
+
+    for (QString &basePath : basePaths)
+    {
+        TreeModelItem *baseItem = m_fixtureTree->itemAtPath(basePath);
+        if (baseItem == nullptr || baseItem->children() == nullptr)
+            continue;
+
+        for (QString &fxName : fxNames)
+            baseItem->children()->removeItem(fxName);
+
+        // hide a universe without fixtures, as a full update would do
+        if (basePath == universeName && baseItem->children()->rowCount() == 0)
+            m_fixtureTree->removeItem(basePath);
+    }
+}
+
 void FixtureManager::updateLinkedFixtureNode(quint32 itemID, bool add)
 {
     quint32 fixtureID = FixtureUtils::itemFixtureID(itemID);
@@ -938,9 +985,8 @@ void FixtureManager::slotFixtureAdded(quint32 id, QVector3D pos)
         QString universeName = uniNames.at(fixture->universe());
         int matchMask = 0;
 
+        // the tree model notifies the inserted rows by itself
         addFixtureNode(m_doc, m_fixtureTree, fixture, universeName, -1, matchMask);
-
-        emit groupsTreeModelChanged();
     }
 }
 
@@ -205,6 +205,10 @@ public:
     /** Add/Remove a linked fixture node */
     void updateLinkedFixtureNode(quint32 itemID, bool add);
 
+    /** Remove the nodes of $fixture from the fixtures tree,
+     *  both under its universe and under its groups */
+    void removeFixtureNode(Fixture *fixture);
+
     /** Generic helper to retrieve a channel icon resource as string, from
      *  the provided Fixture ID $fxID and channel index $chIdx */
     Q_INVOKABLE QString channelIcon(quint32 fxID, quint32 chIdx);
@@ -20,6 +20,7 @@
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QDebug>
+#include <climits>
 
 #include "audioplugincache.h"
 #include "genericdmxsource.h"
@@ -59,6 +60,7 @@ FunctionManager::FunctionManager(QQuickView *view, Doc *doc, QObject *parent)
     , m_previewEnabled(false)
     , m_filter(0)
     , m_searchFilter(QString())
+    , m_countsUpdatePending(false)
 {
     m_sceneCount = m_chaserCount = m_sequenceCount = m_efxCount = 0;
     m_collectionCount = m_rgbMatrixCount = m_scriptCount = 0;
@@ -86,6 +88,7 @@ FunctionManager::FunctionManager(QQuickView *view, Doc *doc, QObject *parent)
 
     connect(m_doc, SIGNAL(loaded()), this, SLOT(slotDocLoaded()));
     connect(m_doc, SIGNAL(functionAdded(quint32)), this, SLOT(slotFunctionAdded(quint32)));
+    connect(m_doc, SIGNAL(functionRemoved(quint32)), this, SLOT(slotFunctionRemoved(quint32)));
 }
 
 
@@ -1201,35 +1204,72 @@ void FunctionManager::addFunctionTreeItem(Function *func)
         if (m_selectedIDList.contains(QVariant(func->id())))
             item->setFlag(TreeModel::Selected, true);
     }
+}
 
-    switch (func->type())
+void FunctionManager::updateFunctionsCount(quint32 types)
+{
+    for (quint32 type = Function::SceneType; type <= Function::VideoType; type <<= 1)
     {
-        case Function::SceneType: m_sceneCount++; break;
-        case Function::ChaserType: m_chaserCount++; break;
-        case Function::SequenceType: m_sequenceCount++; break;
-        case Function::EFXType: m_efxCount++; break;
-        case Function::CollectionType: m_collectionCount++; break;
-        case Function::RGBMatrixType: m_rgbMatrixCount++; break;
-        case Function::ScriptType: m_scriptCount++; break;
-        case Function::ShowType: m_showCount++; break;
-        case Function::AudioType: m_audioCount++; break;
-        case Function::VideoType: m_videoCount++; break;
-        default:
-        break;
+        if ((types & type) == 0)
+            continue;
+
+        int count = 0;
+        for (Function *func : m_doc->functionsByType(Function::Type(type))) // C++11
+        {
+            if (func->isVisible())
+                count++;
+        }
+
+        switch (type)
+        {
+            case Function::SceneType: m_sceneCount = count; emit sceneCountChanged(); break;
+            case Function::ChaserType: m_chaserCount = count; emit chaserCountChanged(); break;
+            case Function::SequenceType: m_sequenceCount = count; emit sequenceCountChanged(); break;
+            case Function::EFXType: m_efxCount = count; emit efxCountChanged(); break;
+            case Function::CollectionType: m_collectionCount = count; emit collectionCountChanged(); break;
+            case Function::RGBMatrixType: m_rgbMatrixCount = count; emit rgbMatrixCountChanged(); break;
+            case Function::ScriptType: m_scriptCount = count; emit scriptCountChanged(); break;
+            case Function::ShowType: m_showCount = count; emit showCountChanged(); break;
+            case Function::AudioType: m_audioCount = count; emit audioCountChanged(); break;
+            case Function::VideoType: m_videoCount = count; emit videoCountChanged(); break;
+            default:
+            break;
+        }
     }
 }
 
 void FunctionManager::updateFunctionsTree()
 {
     QStringList pathsList;
-
-    m_sceneCount = m_chaserCount = m_sequenceCount = m_efxCount = 0;
-    m_collectionCount = m_rgbMatrixCount = m_scriptCount = 0;
-    m_showCount = m_audioCount = m_videoCount = 0;
+    QList<Function *> functions;
 
     m_functionTree->clear();
 
-    for (Function *func : m_doc->functions()) // C++11
+    // with a search filter, walk only the functions matching it
+    if (m_searchFilter.length() >= SEARCH_MIN_CHARS)
+    {
+        for (quint32 fid : m_doc->functionsByName(m_searchFilter)) // C++11
+        {
+            Function *func = m_doc->function(fid);
+            if (func != nullptr && (m_filter == 0 || m_filter & func->type()))
+                functions.append(func);
+        }
+    }
+    // with a type filter, walk only the functions of the filtered types
+    else if (m_filter == 0)
+    {
+        functions = m_doc->functions();
+    }
+    else
+    {
+        for (quint32 type = Function::SceneType; type <= Function::VideoType; type <<= 1)
+        {
+            if (m_filter & type)
+                functions.append(m_doc->functionsByType(Function::Type(type)));
+        }
+    }
+
+    for (Function *func : functions) // C++11
     {
         QString fPath = func->path(true);
         if (pathsList.contains(fPath) == false)
@@ -1262,16 +1302,7 @@ void FunctionManager::updateFunctionsTree()
 
     //m_functionTree->printTree(); // enable for debug purposes
 
-    emit sceneCountChanged();
-    emit chaserCountChanged();
-    emit sequenceCountChanged();
-    emit efxCountChanged();
-    emit collectionCountChanged();
-    emit rgbMatrixCountChanged();
-    emit scriptCountChanged();
-    emit showCountChanged();
-    emit audioCountChanged();
-    emit videoCountChanged();
+    updateFunctionsCount(UINT_MAX);
 
     emit functionsListChanged();
 }
@@ -1288,7 +1319,30 @@ void FunctionManager::slotFunctionAdded(quint32 fid)
         return;
 
     Function *func = m_doc->function(fid);
+    if (func == nullptr)
+        return;
+
     addFunctionTreeItem(func);
+    updateFunctionsCount(func->type());
+}
+
+void FunctionManager::slotFunctionRemoved(quint32 fid)
+{
+    Q_UNUSED(fid)
+
+    if (m_doc->loadStatus() == Doc::Loading || m_countsUpdatePending)
+        return;
+
+    // the function is not in the Doc anymore, so its type is unknown.
+    // Recount once, after a batch of removals
+    m_countsUpdatePending = true;
+    QMetaObject::invokeMethod(this, "slotUpdateFunctionsCount", Qt::QueuedConnection);
+}
+
+void FunctionManager::slotUpdateFunctionsCount()
+{
+    m_countsUpdatePending = false;
+    updateFunctionsCount(UINT_MAX);
 }
 
 
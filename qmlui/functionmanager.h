@@ -204,6 +204,15 @@ signals:
 public slots:
     void slotDocLoaded();
     void slotFunctionAdded(quint32 fid);
+    void slotFunctionRemoved(quint32 fid);
+
+private slots:
+    void slotUpdateFunctionsCount();
+
+private:
+    /** Recount the visible functions of the given $types (bitmask)
+     *  and notify the changed counters */
+    void updateFunctionsCount(quint32 types);
 
 private:
     /** Reference of the QML view */
@@ -223,6 +232,8 @@ private:
 
     quint32 m_filter;
     QString m_searchFilter;
+    /** Flag set when a recount of the functions is queued */
+    bool m_countsUpdatePending;
 
     int m_sceneCount, m_chaserCount, m_sequenceCount, m_efxCount;
     int m_collectionCount, m_rgbMatrixCount, m_scriptCount;
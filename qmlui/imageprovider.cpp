@@ -0,0 +1,39 @@
+/*
+  Q Light Controller Plus
+  imageprovider.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "imageprovider.h"
+#include "qlcimagecache.h"
+
+ImageProvider::ImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image,
+                          QQuickImageProvider::ForceAsynchronousImageLoading)
+{
+}
+
+QImage ImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    /* the cache is thread safe, so the images are decoded
+     * in the QML loader threads */
+    QImage image = QLCImageCache::image(id, requestedSize);
+
+    if (size)
+        *size = image.size();
+
+    return image;
+}
@@ -0,0 +1,44 @@
+/*
+  Q Light Controller Plus
+  imageprovider.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef IMAGEPROVIDER_H
+#define IMAGEPROVIDER_H
+
+#include <QQuickImageProvider>
+
+#define IMAGE_PROVIDER_NAME "qlcimage"
+
+/**
+ * ImageProvider serves the gobo pictures and capability resources to QML
+ * from the process-wide QLCImageCache, so the 2D view, the presets and the
+ * editors share a single decoded copy of each picture.
+ *
+ * A resource is requested as "image://qlcimage/" + path, and the Image
+ * sourceSize selects the size bucket.
+ */
+class ImageProvider : public QQuickImageProvider
+{
+public:
+    ImageProvider();
+
+    /** @reimp */
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+};
+
+#endif // IMAGEPROVIDER_H
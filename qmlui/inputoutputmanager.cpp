@@ -462,20 +462,16 @@ QVariant InputOutputManager::universeInputProfiles(int universe)
 
     foreach(QString name, profileNames)
     {
-        QLCInputProfile *ip = m_ioMap->profile(name);
-        if (ip != nullptr)
-        {
-            QString type = ip->typeToString(ip->type());
-            if (name != currentProfile)
-            {
-                QVariantMap profileMap;
-                profileMap.insert("universe", universe);
-                profileMap.insert("name", name);
-                profileMap.insert("line", name);
-                profileMap.insert("plugin", type);
-                profilesList.append(profileMap);
-            }
-        }
+        if (name == currentProfile)
+            continue;
+
+        // the type is indexed, so the profile is not parsed to list it
+        QVariantMap profileMap;
+        profileMap.insert("universe", universe);
+        profileMap.insert("name", name);
+        profileMap.insert("line", name);
+        profileMap.insert("plugin", QLCInputProfile::typeToString(m_ioMap->profileType(name)));
+        profilesList.append(profileMap);
     }
 
     return QVariant::fromValue(profilesList);
@@ -624,6 +620,22 @@ QVariant InputOutputManager::beatGeneratorsList()
         genList.append(midiInMap);
     }
 
+    // add the currently open OS2L input
+    foreach(Universe *uni, m_ioMap->universes())
+    {
+        InputPatch *ip = uni->inputPatch();
+        if (ip == nullptr || ip->pluginName() != "OS2L")
+            continue;
+
+        QVariantMap os2lInMap;
+        os2lInMap.insert("type", "OS2L");
+        os2lInMap.insert("name", ip->inputName());
+        os2lInMap.insert("uni", uni->id());
+        os2lInMap.insert("line", ip->input());
+        os2lInMap.insert("privateName", "");
+        genList.append(os2lInMap);
+    }
+
     // add the currently selected audio input device
     QSettings settings;
     QString devName;
@@ -683,6 +695,8 @@ void InputOutputManager::setBeatType(QString beatType)
         m_ioMap->setBeatGeneratorType(InputOutputMap::MIDI);
     else if (m_beatType == "AUDIO")
         m_ioMap->setBeatGeneratorType(InputOutputMap::Audio);
+    else if (m_beatType == "OS2L")
+        m_ioMap->setBeatGeneratorType(InputOutputMap::OS2L);
     else
         m_ioMap->setBeatGeneratorType(InputOutputMap::Disabled);
 
@@ -698,6 +712,7 @@ void InputOutputManager::slotBeatTypeChanged()
         case InputOutputMap::Internal: m_beatType = "INTERNAL"; break;
         case InputOutputMap::MIDI: m_beatType = "MIDI"; break;
         case InputOutputMap::Audio: m_beatType = "AUDIO"; break;
+        case InputOutputMap::OS2L: m_beatType = "OS2L"; break;
         case InputOutputMap::Disabled:
         default:
             m_beatType = "OFF";
@@ -17,10 +17,13 @@
   limitations under the License.
 */
 
+#include <QSet>
+
 #include "listmodel.h"
 
 ListModel::ListModel(QObject *parent)
     : QAbstractListModel(parent)
+    , m_updateLevel(0)
 {
 
 }
@@ -32,6 +35,12 @@ ListModel::~ListModel()
 
 void ListModel::clear()
 {
+    if (m_updateLevel > 0)
+    {
+        m_pendingData.clear();
+        return;
+    }
+
     int itemsCount = m_data.count();
     if (itemsCount == 0)
         return;
@@ -120,6 +129,12 @@ bool ListModel::setDataWithRole(const QModelIndex &index, QString roleName, cons
 
 void ListModel::addDataMap(QVariantMap data)
 {
+    if (m_updateLevel > 0)
+    {
+        m_pendingData.append(data);
+        return;
+    }
+
     int addIndex = m_data.count();
     beginInsertRows(QModelIndex(), addIndex, addIndex);
     m_data.append(data);
@@ -140,3 +155,198 @@ void ListModel::setRoleNames(QStringList names)
 {
     m_roles = names;
 }
+
+void ListModel::setKeyRole(QString roleName)
+{
+    m_keyRole = roleName;
+}
+
+QString ListModel::itemKey(const QVariant &item) const
+{
+    QVariant key = item.toMap().value(m_keyRole);
+
+    /* object references have no string representation,
+     * so they are identified by their address */
+    QObject *obj = key.value<QObject *>();
+    if (obj != nullptr)
+        return QString::number(quintptr(obj), 16);
+
+    return key.toString();
+}
+
+void ListModel::updateRow(int row, const QVariantMap &newItem, int &changedFrom,
+                           int &changedTo, QVector<int> &changedRoles)
+{
+    QVariantMap oldItem = m_data.at(row).toMap();
+    QVector<int> roles;
+
+    for (int i = 0; i < m_roles.count(); i++)
+    {
+        const QString &roleName = m_roles.at(i);
+        if (oldItem.value(roleName) != newItem.value(roleName))
+            roles.append(Qt::UserRole + 1 + i);
+    }
+
+    if (roles.isEmpty() == false)
+        m_data[row] = newItem;
+
+    /* consecutive rows with the same changed roles are notified at once */
+    if (changedFrom >= 0 && (roles != changedRoles || row != changedTo + 1))
+    {
+        emit dataChanged(index(changedFrom), index(changedTo), changedRoles);
+        changedFrom = -1;
+    }
+
+    if (roles.isEmpty())
+        return;
+
+    if (changedFrom < 0)
+    {
+        changedFrom = row;
+        changedRoles = roles;
+    }
+    changedTo = row;
+}
+
+void ListModel::updateData(QVariantList newData)
+{
+    int changedFrom = -1, changedTo = -1;
+    QVector<int> changedRoles;
+
+    if (m_keyRole.isEmpty())
+    {
+        int common = qMin(m_data.count(), newData.count());
+
+        for (int i = 0; i < common; i++)
+            updateRow(i, newData.at(i).toMap(), changedFrom, changedTo, changedRoles);
+
+        if (changedFrom >= 0)
+            emit dataChanged(index(changedFrom), index(changedTo), changedRoles);
+
+        if (m_data.count() > common)
+        {
+            beginRemoveRows(QModelIndex(), common, m_data.count() - 1);
+            m_data.erase(m_data.begin() + common, m_data.end());
+            endRemoveRows();
+        }
+        else if (newData.count() > common)
+        {
+            beginInsertRows(QModelIndex(), common, newData.count() - 1);
+            for (int i = common; i < newData.count(); i++)
+                m_data.append(newData.at(i));
+            endInsertRows();
+        }
+        return;
+    }
+
+    QStringList newKeys;
+    QSet<QString> newKeySet;
+    for (const QVariant &item : newData)
+    {
+        newKeys.append(itemKey(item));
+        newKeySet.insert(newKeys.last());
+    }
+
+    /* remove the items that are gone, or duplicated,
+     * in contiguous ranges starting from the end */
+    QSet<QString> oldKeySet;
+    QVector<bool> keep(m_data.count(), false);
+    for (int i = 0; i < m_data.count(); i++)
+    {
+        QString key = itemKey(m_data.at(i));
+        if (newKeySet.contains(key) && oldKeySet.contains(key) == false)
+        {
+            oldKeySet.insert(key);
+            keep[i] = true;
+        }
+    }
+
+    for (int i = m_data.count() - 1; i >= 0; i--)
+    {
+        if (keep.at(i))
+            continue;
+
+        int last = i;
+        while (i > 0 && keep.at(i - 1) == false)
+            i--;
+
+        beginRemoveRows(QModelIndex(), i, last);
+        m_data.erase(m_data.begin() + i, m_data.begin() + last + 1);
+        endRemoveRows();
+    }
+
+    /* now every remaining item is in the new list:
+     * walk it, moving or inserting the rows out of place */
+    for (int i = 0; i < newData.count(); i++)
+    {
+        const QString &key = newKeys.at(i);
+        QVariantMap newItem = newData.at(i).toMap();
+
+        if (i < m_data.count() && itemKey(m_data.at(i)) == key)
+        {
+            updateRow(i, newItem, changedFrom, changedTo, changedRoles);
+            continue;
+        }
+
+        if (changedFrom >= 0)
+        {
+            emit dataChanged(index(changedFrom), index(changedTo), changedRoles);
+            changedFrom = -1;
+        }
+
+        int from = -1;
+        if (oldKeySet.contains(key))
+        {
+            for (int j = i + 1; j < m_data.count(); j++)
+            {
+                if (itemKey(m_data.at(j)) == key)
+                {
+                    from = j;
+                    break;
+                }
+            }
+        }
+
+        if (from < 0)
+        {
+            beginInsertRows(QModelIndex(), i, i);
+            m_data.insert(i, newItem);
+            endInsertRows();
+            continue;
+        }
+
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+        m_data.move(from, i);
+        endMoveRows();
+        /* a key is moved only once, duplicates are inserted */
+        oldKeySet.remove(key);
+
+        updateRow(i, newItem, changedFrom, changedTo, changedRoles);
+    }
+
+    if (changedFrom >= 0)
+        emit dataChanged(index(changedFrom), index(changedTo), changedRoles);
+
+    if (m_data.count() > newData.count())
+    {
+        beginRemoveRows(QModelIndex(), newData.count(), m_data.count() - 1);
+        m_data.erase(m_data.begin() + newData.count(), m_data.end());
+        endRemoveRows();
+    }
+}
+
+void ListModel::beginUpdate()
+{
+    if (m_updateLevel++ == 0)
+        m_pendingData = m_data;
+}
+
+void ListModel::endUpdate()
+{
+    if (m_updateLevel == 0 || --m_updateLevel > 0)
+        return;
+
+    QVariantList newData = m_pendingData;
+    m_pendingData.clear();
+    updateData(newData);
+}
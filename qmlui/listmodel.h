@@ -51,10 +51,44 @@ public:
 
     void addDataMap(QVariantMap data);
 
+    /**
+     * Set the role that identifies an item across updates. When set,
+     * updateData() moves the rows whose key changed position instead of
+     * rewriting them. Without a key role, rows are matched by position
+     */
+    void setKeyRole(QString roleName);
+
+    /**
+     * Replace the model items with $newData, notifying the views only
+     * with the rows that were inserted, removed or moved and with the
+     * roles whose value actually changed
+     */
+    void updateData(QVariantList newData);
+
+    /**
+     * Start a batched update. Until endUpdate() is called, clear() and
+     * addDataMap() only build the new item list, which endUpdate() applies
+     * at once with updateData(). Batches can be nested
+     */
+    void beginUpdate();
+    void endUpdate();
+
+private:
+    QString itemKey(const QVariant &item) const;
+    void updateRow(int row, const QVariantMap &newItem, int &changedFrom,
+                    int &changedTo, QVector<int> &changedRoles);
+
 protected:
     QStringList m_roles;
     QHash<int, QByteArray> roleNames() const;
     QVariantList m_data;
+
+    /** The role used by updateData() to match the items */
+    QString m_keyRole;
+
+    /** Nesting level of beginUpdate() and the items collected so far */
+    int m_updateLevel;
+    QVariantList m_pendingData;
 };
 
 #endif // LISTMODEL_H
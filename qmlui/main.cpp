@@ -25,6 +25,7 @@
 #include "app.h"
 #include "qlcfile.h"
 #include "qlcconfig.h"
+#include "enginelog.h"
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
 #define endl Qt::endl
@@ -102,7 +103,7 @@ int main(int argc, char *argv[])
     parser.process(app);
 
     if (parser.isSet(debugOption))
-        qInstallMessageHandler(debugMessageHandler);
+        EngineLog::start(debugMessageHandler);
 
     QString locale = parser.value(localeOption);
 
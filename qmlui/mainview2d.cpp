@@ -18,6 +18,7 @@
 */
 
 #include <QDebug>
+#include <QPainter>
 #include <QQuickItem>
 #include <QQmlContext>
 #include <QQmlComponent>
@@ -30,11 +31,84 @@
 #include "qlcfixturemode.h"
 #include "monitorproperties.h"
 
+/*********************************************************************
+ * PixelHeadsItem
+ *********************************************************************/
+
+PixelHeadsItem::PixelHeadsItem(QQuickItem *parent)
+    : QQuickPaintedItem(parent)
+    , m_columns(1)
+    , m_rows(1)
+{
+    setAntialiasing(false);
+    resizeImage();
+}
+
+int PixelHeadsItem::columns() const
+{
+    return m_columns;
+}
+
+void PixelHeadsItem::setColumns(int columns)
+{
+    if (columns < 1 || m_columns == columns)
+        return;
+
+    m_columns = columns;
+    resizeImage();
+    emit columnsChanged();
+}
+
+int PixelHeadsItem::rows() const
+{
+    return m_rows;
+}
+
+void PixelHeadsItem::setRows(int rows)
+{
+    if (rows < 1 || m_rows == rows)
+        return;
+
+    m_rows = rows;
+    resizeImage();
+    emit rowsChanged();
+}
+
+void PixelHeadsItem::setHeadColor(int index, const QColor &color, qreal intensity)
+{
+    if (index < 0 || index >= m_columns * m_rows)
+        return;
+
+    m_image.setPixel(index % m_columns, index / m_columns,
+                     qRgb(qRound(color.red() * intensity),
+                          qRound(color.green() * intensity),
+                          qRound(color.blue() * intensity)));
+}
+
+void PixelHeadsItem::paint(QPainter *painter)
+{
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter->drawImage(QRectF(0, 0, width(), height()), m_image);
+}
+
+void PixelHeadsItem::resizeImage()
+{
+    m_image = QImage(m_columns, m_rows, QImage::Format_RGB32);
+    m_image.fill(Qt::black);
+    update();
+}
+
+/*********************************************************************
+ * MainView2D
+ *********************************************************************/
+
 MainView2D::MainView2D(QQuickView *view, Doc *doc, QObject *parent)
     : PreviewContext(view, doc, "2D", parent)
     , m_gridItem(nullptr)
     , m_monProps(doc->monitorProperties())
 {
+    qmlRegisterType<PixelHeadsItem>("org.qlcplus.classes", 1, 0, "PixelHeadsItem");
+
     setGridSize(m_monProps->gridSize());
     setGridScale(1.0);
     setCellPixels(100);
@@ -95,6 +169,7 @@ void MainView2D::resetItems()
         delete it.value();
     }
     m_itemsMap.clear();
+    m_pixelItemsMap.clear();
 }
 
 bool MainView2D::initialize2DProperties()
@@ -167,6 +242,14 @@ void MainView2D::createFixtureItem(quint32 fxID, quint16 headIndex, quint16 link
         //qDebug() << "Current mode fixture heads:" << fxMode->heads().count();
         newFixtureItem->setProperty("headsNumber", fxMode->heads().count());
 
+        if (fxMode->heads().count() >= PIXEL_HEADS_THRESHOLD)
+        {
+            newFixtureItem->setProperty("pixelMode", true);
+            PixelHeadsItem *pixelItem = newFixtureItem->findChild<PixelHeadsItem *>("pixelHeads");
+            if (pixelItem != nullptr)
+                m_pixelItemsMap[itemID] = pixelItem;
+        }
+
         if (fixture->channelNumber(QLCChannel::Pan, QLCChannel::MSB) != QLCChannel::invalid())
         {
             int panDeg = phy.focusPanMax();
@@ -391,6 +474,7 @@ void MainView2D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
 
     quint32 masterDimmerChannel = fixture->masterIntensityChannel();
     qreal masterDimmerValue = qreal(fixture->channelValueAt(int(masterDimmerChannel))) / 255.0;
+    PixelHeadsItem *pixelItem = m_pixelItemsMap.value(itemID, nullptr);
 
     for (int headIdx = 0; headIdx < fixture->heads(); headIdx++)
     {
@@ -406,18 +490,28 @@ void MainView2D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
         if (headDimmerChannel != masterDimmerChannel)
             intensityValue *= masterDimmerValue;
 
+        color = FixtureUtils::headColor(fixture, headIdx);
+        colorSet = true;
+
+        // pixels are written in the image, without any QML call
+        if (pixelItem != nullptr)
+        {
+            pixelItem->setHeadColor(headIdx, color, intensityValue);
+            continue;
+        }
+
         QMetaObject::invokeMethod(fxItem, "setHeadIntensity",
                 Q_ARG(QVariant, headIdx),
                 Q_ARG(QVariant, intensityValue));
 
-        color = FixtureUtils::headColor(fixture, headIdx);
-
         QMetaObject::invokeMethod(fxItem, "setHeadRGBColor",
                                   Q_ARG(QVariant, headIdx),
                                   Q_ARG(QVariant, color));
-        colorSet = true;
     } // for heads
 
+    if (pixelItem != nullptr)
+        pixelItem->update();
+
     // now scan all the channels for "common" capabilities
     for (quint32 i = 0; i < fixture->channels(); i++)
     {
@@ -656,6 +750,7 @@ void MainView2D::removeFixtureItem(quint32 itemID)
         return;
 
     QQuickItem *fixtureItem = m_itemsMap.take(itemID);
+    m_pixelItemsMap.remove(itemID);
     delete fixtureItem;
 }
 
@@ -22,6 +22,8 @@
 
 #include <QObject>
 #include <QQuickView>
+#include <QQuickPaintedItem>
+#include <QImage>
 
 #include "previewcontext.h"
 
@@ -30,6 +32,48 @@ class Fixture;
 class QLCFixtureMode;
 class MonitorProperties;
 
+/** Fixtures with at least this number of heads are drawn
+ *  as a single image, with one pixel per head */
+#define PIXEL_HEADS_THRESHOLD 16
+
+class PixelHeadsItem : public QQuickPaintedItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int columns READ columns WRITE setColumns NOTIFY columnsChanged)
+    Q_PROPERTY(int rows READ rows WRITE setRows NOTIFY rowsChanged)
+
+public:
+    PixelHeadsItem(QQuickItem *parent = nullptr);
+
+    /** Get/Set the heads layout */
+    int columns() const;
+    void setColumns(int columns);
+
+    int rows() const;
+    void setRows(int rows);
+
+    /** Set the color of the head at $index, scaled by $intensity.
+     *  The item is repainted only on the next update() call */
+    void setHeadColor(int index, const QColor &color, qreal intensity);
+
+    /** @reimp */
+    void paint(QPainter *painter);
+
+signals:
+    void columnsChanged();
+    void rowsChanged();
+
+private:
+    void resizeImage();
+
+private:
+    int m_columns;
+    int m_rows;
+    /** The heads colors, one pixel per head */
+    QImage m_image;
+};
+
 class MainView2D : public PreviewContext
 {
     Q_OBJECT
@@ -153,6 +197,9 @@ private:
 
     /** Pre-cached QML component for quick item creation */
     QQmlComponent *fixtureComponent;
+
+    /** Map of the items drawing the heads of a fixture as pixels */
+    QMap<quint32, PixelHeadsItem *> m_pixelItemsMap;
 };
 
 #endif // MAINVIEW2D_H
@@ -24,7 +24,8 @@
 #include <QQuickItem>
 #include <QQmlContext>
 #include <QQmlComponent>
-#include <QSvgRenderer>
+#include <QFileInfo>
+#include <QSettings>
 
 #include <Qt3DCore/QTransform>
 #include <Qt3DCore/QNode>
@@ -33,10 +34,12 @@
 #include <Qt3DRender/QBuffer>
 #include <Qt3DRender/QParameter>
 #include <Qt3DExtras/QPhongMaterial>
+#include <Qt3DExtras/QCuboidMesh>
 
 #include "doc.h"
 #include "tardis.h"
 #include "qlcfile.h"
+#include "qlcimagecache.h"
 #include "qlcconfig.h"
 #include "mainview3d.h"
 #include "fixtureutils.h"
@@ -44,6 +47,8 @@
 #include "qlcfixturemode.h"
 #include "monitorproperties.h"
 
+#define SETTINGS_MESH_VOLUMES "3dview/meshvolumes"
+
 //#define SHOW_FRAMEGRAPH
 
 MainView3D::MainView3D(QQuickView *view, Doc *doc, QObject *parent)
@@ -64,6 +69,8 @@ MainView3D::MainView3D(QQuickView *view, Doc *doc, QObject *parent)
     , m_sceneRootEntity(nullptr)
     , m_quadEntity(nullptr)
     , m_gBuffer(nullptr)
+    , m_placeholderMesh(nullptr)
+    , m_placeholderMaterial(nullptr)
     , m_latestGenericID(0)
     , m_renderQuality(HighQuality)
     , m_stageEntity(nullptr)
@@ -80,6 +87,8 @@ MainView3D::MainView3D(QQuickView *view, Doc *doc, QObject *parent)
     // the order of StageType enum in MonitorProperties class
     m_stagesList << tr("Simple ground") << tr("Simple box") << tr("Rock stage") << tr("Theatre stage");
     m_stageResourceList << "qrc:/StageSimple.qml" << "qrc:/StageBox.qml" << "qrc:/StageRock.qml" << "qrc:/StageTheatre.qml";
+
+    loadBoundingVolumes();
 }
 
 MainView3D::~MainView3D()
@@ -167,6 +176,13 @@ void MainView3D::resetItems()
     //for (auto it = m_entitiesMap.begin(); it != end; ++it)
     //    delete it.value();
     m_entitiesMap.clear();
+    m_sharedMeshes.clear();
+    m_meshWaitingItems.clear();
+
+    qDeleteAll(m_fixturePlaceholders);
+    m_fixturePlaceholders.clear();
+    qDeleteAll(m_genericPlaceholders);
+    m_genericPlaceholders.clear();
 
     QMapIterator<int, SceneItem*> it2(m_genericMap);
     while(it2.hasNext())
@@ -176,6 +192,7 @@ void MainView3D::resetItems()
         delete e->m_rootItem;
     }
     m_genericMap.clear();
+    m_genericWaitingItems.clear();
     m_latestGenericID = 0;
     m_createItemCount = 0;
 
@@ -445,6 +462,27 @@ void MainView3D::createFixtureItems(quint32 fxID, QVector3D pos, bool mmCoords)
     }
 }
 
+/** Return the size in meters of $fixture, from its physical properties */
+static QVector3D physicalSize(Fixture *fixture)
+{
+    QVector3D fxSize(0.3, 0.3, 0.3);
+    QLCFixtureMode *fxMode = fixture->fixtureMode();
+
+    if (fxMode != nullptr)
+    {
+        QLCPhysical phy = fxMode->physical();
+
+        if (phy.width())
+            fxSize.setX(phy.width() / 1000.0);
+        if (phy.height())
+            fxSize.setY(phy.height() / 1000.0);
+        if (phy.depth())
+            fxSize.setZ(phy.depth() / 1000.0);
+    }
+
+    return fxSize;
+}
+
 void MainView3D::createFixtureItem(quint32 fxID, quint16 headIndex, quint16 linkedIndex,
                                    QVector3D pos, bool mmCoords)
 {
@@ -557,7 +595,32 @@ void MainView3D::createFixtureItem(quint32 fxID, quint16 headIndex, quint16 link
 
     newItem->setProperty("itemID", itemID);
     if (meshPath.isEmpty() == false)
-        newItem->setProperty("itemSource", meshPath);
+    {
+        QUrl source(meshPath);
+
+        // a model is loaded only once. The other items using it wait
+        // for it to be loaded, then share its meshes
+        if (m_sharedMeshes.contains(source))
+        {
+            setupFixtureItem(itemID, newItem, nullptr, source);
+            return;
+        }
+
+        if (m_meshWaitingItems.contains(source))
+        {
+            m_meshWaitingItems[source].append(qMakePair(itemID, newItem));
+        }
+        else
+        {
+            m_meshWaitingItems.insert(source, QList<QPair<quint32, QEntity *>>());
+            newItem->setProperty("itemSource", meshPath);
+        }
+
+        // show the fixtures of a loaded project right away, while their model loads
+        if (m_monProps->containsItem(fxID, headIndex, linkedIndex))
+            m_fixturePlaceholders[itemID] =
+                createPlaceholder(m_monProps->fixturePosition(fxID, headIndex, linkedIndex), physicalSize(fixture));
+    }
 }
 
 void MainView3D::setFixtureFlags(quint32 itemID, quint32 flags)
@@ -798,6 +861,159 @@ QEntity *MainView3D::inspectEntity(QEntity *entity, SceneItem *meshRef,
     return baseItem;
 }
 
+void MainView3D::storeMeshTree(QEntity *entity, int parentIndex, QVector<MeshNode> &tree)
+{
+    if (entity == nullptr)
+        return;
+
+    MeshNode node;
+    node.m_parent = parentIndex;
+    node.m_name = entity->objectName();
+    node.m_hasTransform = false;
+    node.m_scale = QVector3D(1.0, 1.0, 1.0);
+
+    for (QComponent *component : entity->components()) // C++11
+    {
+        Qt3DCore::QTransform *transform = qobject_cast<Qt3DCore::QTransform *>(component);
+
+        if (transform)
+        {
+            node.m_hasTransform = true;
+            node.m_translation = transform->translation();
+            node.m_rotation = transform->rotation();
+            node.m_scale = transform->scale3D();
+        }
+        else
+        {
+            component->setParent(m_sceneRootEntity);
+            node.m_components.append(component);
+        }
+    }
+
+    tree.append(node);
+    int index = tree.count() - 1;
+
+    for (QEntity *subEntity : entity->findChildren<QEntity *>(QString(), Qt::FindDirectChildrenOnly))
+        storeMeshTree(subEntity, index, tree);
+}
+
+QEntity *MainView3D::cloneMeshTree(const QVector<MeshNode> &tree, QEntity *fxEntity,
+                                   SceneItem *meshRef, QLayer *layer)
+{
+    QVector<QEntity *> entities;
+    QEntity *baseItem = nullptr;
+
+    entities.reserve(tree.count());
+
+    for (const MeshNode &node : tree)
+    {
+        QEntity *entity = new QEntity(node.m_parent < 0 ? fxEntity : entities.at(node.m_parent));
+        entity->setObjectName(node.m_name);
+
+        if (node.m_hasTransform)
+        {
+            Qt3DCore::QTransform *transform = new Qt3DCore::QTransform(entity);
+            transform->setTranslation(node.m_translation);
+            transform->setRotation(node.m_rotation);
+            transform->setScale3D(node.m_scale);
+            entity->addComponent(transform);
+        }
+
+        for (QComponent *component : node.m_components)
+            entity->addComponent(component);
+
+        entity->addComponent(layer);
+
+        if (node.m_name == "base")
+            baseItem = entity;
+        else if (node.m_name == "arm")
+            meshRef->m_armItem = entity;
+        else if (node.m_name == "head")
+            meshRef->m_headItem = entity;
+
+        entities.append(entity);
+    }
+
+    return baseItem;
+}
+
+QEntity *MainView3D::createPlaceholder(QVector3D pos, QVector3D size)
+{
+    QLayer *sceneDeferredLayer = m_sceneRootEntity->property("deferredLayer").value<QLayer *>();
+
+    if (m_placeholderMesh == nullptr)
+    {
+        QEffect *sceneEffect = m_sceneRootEntity->property("geometryPassEffect").value<QEffect *>();
+
+        m_placeholderMesh = new Qt3DExtras::QCuboidMesh(m_sceneRootEntity);
+        m_placeholderMaterial = new QMaterial(m_sceneRootEntity);
+        m_placeholderMaterial->setEffect(sceneEffect);
+        m_placeholderMaterial->addParameter(new QParameter("diffuse", QVector3D(0.3f, 0.3f, 0.3f)));
+        m_placeholderMaterial->addParameter(new QParameter("specular", QVector3D(0.1f, 0.1f, 0.1f)));
+        m_placeholderMaterial->addParameter(new QParameter("shininess", 1.0));
+        m_placeholderMaterial->addParameter(new QParameter("bloom", 0));
+    }
+
+    QEntity *placeholder = new QEntity(m_sceneRootEntity);
+
+    // same placement as updateFixturePosition, with the box as volume
+    Qt3DCore::QTransform *transform = new Qt3DCore::QTransform(placeholder);
+    transform->setTranslation(QVector3D((pos.x() / 1000.0) - (m_monProps->gridSize().x() / 2) + (size.x() / 2),
+                                        (pos.y() / 1000.0) + (size.y() / 2),
+                                        (pos.z() / 1000.0) - (m_monProps->gridSize().z() / 2) + (size.z() / 2)));
+    transform->setScale3D(size);
+
+    placeholder->addComponent(transform);
+    placeholder->addComponent(m_placeholderMesh);
+    placeholder->addComponent(m_placeholderMaterial);
+    placeholder->addComponent(sceneDeferredLayer);
+
+    return placeholder;
+}
+
+void MainView3D::loadBoundingVolumes()
+{
+    QSettings settings;
+    QVariantMap volumes = settings.value(SETTINGS_MESH_VOLUMES).toMap();
+
+    QMapIterator<QString, QVariant> it(volumes);
+    while (it.hasNext())
+    {
+        it.next();
+        QUrl source(it.key());
+        QVariantList values = it.value().toList();
+
+        // a model changed since it was measured must be measured again
+        QFileInfo fInfo(source.toLocalFile());
+        if (values.count() != 7 || fInfo.exists() == false ||
+            fInfo.lastModified().toMSecsSinceEpoch() != values.at(6).toLongLong())
+            continue;
+
+        BoundingVolume volume;
+        volume.m_extents = QVector3D(values.at(0).toFloat(), values.at(1).toFloat(), values.at(2).toFloat());
+        volume.m_center = QVector3D(values.at(3).toFloat(), values.at(4).toFloat(), values.at(5).toFloat());
+        m_boundingVolumesMap[source] = volume;
+    }
+}
+
+void MainView3D::saveBoundingVolume(const QUrl &source, const BoundingVolume &volume)
+{
+    QFileInfo fInfo(source.toLocalFile());
+    if (fInfo.exists() == false)
+        return;
+
+    QSettings settings;
+    QVariantMap volumes = settings.value(SETTINGS_MESH_VOLUMES).toMap();
+    QVariantList values;
+
+    values << volume.m_extents.x() << volume.m_extents.y() << volume.m_extents.z();
+    values << volume.m_center.x() << volume.m_center.y() << volume.m_center.z();
+    values << fInfo.lastModified().toMSecsSinceEpoch();
+
+    volumes[source.toString()] = values;
+    settings.setValue(SETTINGS_MESH_VOLUMES, volumes);
+}
+
 #ifdef SHOW_FRAMEGRAPH
 void MainView3D::walkNode(QNode *e, int depth)
 {
@@ -819,6 +1035,14 @@ void MainView3D::walkNode(QNode *e, int depth)
 
 void MainView3D::initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoader *loader)
 {
+    setupFixtureItem(itemID, fxEntity, loader, QUrl());
+}
+
+void MainView3D::setupFixtureItem(quint32 itemID, QEntity *fxEntity, QSceneLoader *loader,
+                                  const QUrl &sharedSource)
+{
+    QUrl source = loader ? loader->source() : sharedSource;
+
     if (m_entitiesMap.contains(itemID) == false)
         return;
 
@@ -830,9 +1054,11 @@ void MainView3D::initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoad
     if (fixture == nullptr)
         return;
 
+    delete m_fixturePlaceholders.take(itemID);
+
     quint32 itemFlags = m_monProps->fixtureFlags(fxID, headIndex, linkedIndex);
     QLCFixtureMode *fxMode = fixture->fixtureMode();
-    QVector3D fxSize(0.3, 0.3, 0.3);
+    QVector3D fxSize = physicalSize(fixture);
     int panDeg = 0;
     int tiltDeg = 0;
     qreal focusMax = 30;
@@ -845,13 +1071,6 @@ void MainView3D::initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoad
     {
         QLCPhysical phy = fxMode->physical();
 
-        if (phy.width())
-            fxSize.setX(phy.width() / 1000.0);
-        if (phy.height())
-            fxSize.setY(phy.height() / 1000.0);
-        if (phy.depth())
-            fxSize.setZ(phy.depth() / 1000.0);
-
         panDeg = phy.focusPanMax() ? phy.focusPanMax() : 360;
         tiltDeg = phy.focusTiltMax() ? phy.focusTiltMax() : 270;
         focusMin = phy.lensDegreesMin() ? phy.lensDegreesMin() : 10;
@@ -897,17 +1116,25 @@ void MainView3D::initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoad
     }
 
     // If this model has been already loaded, re-use the cached bounding volume
-    if (loader && m_boundingVolumesMap.contains(loader->source()))
-        meshRef->m_volume = m_boundingVolumesMap[loader->source()];
+    if (source.isEmpty() == false && m_boundingVolumesMap.contains(source))
+        meshRef->m_volume = m_boundingVolumesMap[source];
     else
         calculateVolume = true;
 
     if (loader)
     {
+        if (m_sharedMeshes.contains(source) == false)
+            storeMeshTree(root, -1, m_sharedMeshes[source]);
+
         // Walk through the scene tree and add each mesh to the deferred pipeline.
         // If needed, calculate also the bounding volume */
         baseItem = inspectEntity(root, meshRef, sceneDeferredLayer, sceneEffect, calculateVolume, translation);
     }
+    else if (source.isEmpty() == false)
+    {
+        // the shared meshes are already in the deferred pipeline
+        baseItem = cloneMeshTree(m_sharedMeshes.value(source), fxEntity, meshRef, sceneDeferredLayer);
+    }
     else
     {
         meshRef->m_headItem = fxEntity->findChild<QEntity *>("headEntity");
@@ -922,7 +1149,10 @@ void MainView3D::initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoad
     qDebug() << "Calculated volume" << meshRef->m_volume.m_extents << meshRef->m_volume.m_center;
 
     if (loader && calculateVolume)
-        m_boundingVolumesMap[loader->source()] = meshRef->m_volume;
+    {
+        m_boundingVolumesMap[source] = meshRef->m_volume;
+        saveBoundingVolume(source, meshRef->m_volume);
+    }
 
     if (meshRef->m_armItem)
     {
@@ -982,7 +1212,7 @@ void MainView3D::initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoad
     }
 
     // scaling is not needed for dynamic meshes
-    if (loader)
+    if (source.isEmpty() == false)
         updateFixtureScale(itemID, fxSize);
     updateFixturePosition(itemID, fxPos);
     updateFixtureRotation(itemID, m_monProps->fixtureRotation(fxID, headIndex, linkedIndex));
@@ -1027,6 +1257,13 @@ void MainView3D::initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoad
     // at last, preview the fixture channels
     QByteArray values;
     updateFixture(fixture, values);
+
+    // the items waiting for this model can now share its meshes
+    if (loader && m_meshWaitingItems.contains(source))
+    {
+        for (const QPair<quint32, QEntity *> &item : m_meshWaitingItems.take(source))
+            setupFixtureItem(item.first, item.second, nullptr, source);
+    }
 }
 
 void MainView3D::updateFixture(Fixture *fixture, QByteArray &previous)
@@ -1418,6 +1655,7 @@ void MainView3D::removeFixtureItem(quint32 itemID)
 
     SceneItem *mesh = m_entitiesMap.take(itemID);
 
+    delete m_fixturePlaceholders.take(itemID);
     delete mesh->m_rootItem;
     delete mesh->m_selectionBox;
 
@@ -1504,32 +1742,70 @@ void MainView3D::createGenericItem(QString filename, int itemID)
     newItem->setParent(m_sceneRootEntity);
 
     newItem->setProperty("itemID", m_latestGenericID);
-    newItem->setProperty("itemSource", filename);
 
-    // at last, add the new item to the generic map
-    m_genericMap[m_latestGenericID] = mesh;
+    // add the new item to the generic map
+    int newID = m_latestGenericID++;
+    m_genericMap[newID] = mesh;
+
+    // as for fixtures, a model is loaded once and shared with the
+    // items created while it loads
+    QUrl source(filename);
+    if (m_sharedMeshes.contains(source))
+    {
+        setupGenericItem(newID, newItem, nullptr, source);
+        return;
+    }
 
-    m_latestGenericID++;
+    if (m_genericWaitingItems.contains(source))
+    {
+        m_genericWaitingItems[source].append(qMakePair(newID, newItem));
+    }
+    else
+    {
+        m_genericWaitingItems.insert(source, QList<QPair<int, QEntity *>>());
+        newItem->setProperty("itemSource", filename);
+    }
+
+    // the size of a model is known only if it has been measured before
+    if (m_boundingVolumesMap.contains(source))
+    {
+        QVector3D size = m_boundingVolumesMap.value(source).m_extents * m_monProps->itemScale(newID);
+        m_genericPlaceholders[newID] = createPlaceholder(m_monProps->itemPosition(newID), size);
+    }
 }
 
 void MainView3D::initializeItem(int itemID, QEntity *itemEntity, QSceneLoader *loader)
 {
-    if (m_genericMap.contains(itemID) == false)
-        return;
+    setupGenericItem(itemID, itemEntity, loader, QUrl());
+}
 
-    // The QSceneLoader instance is a component of an entity. The loaded scene
-    // tree is added under this entity.
-    QVector<QEntity *> entities = loader->entities();
+void MainView3D::setupGenericItem(int itemID, QEntity *itemEntity, QSceneLoader *loader,
+                                  const QUrl &sharedSource)
+{
+    QUrl source = loader ? loader->source() : sharedSource;
 
-    if (entities.isEmpty())
+    if (m_genericMap.contains(itemID) == false)
         return;
 
-    // Technically there could be multiple entities referencing the scene loader
-    // but sharing is discouraged, and in our case there will be one anyhow.
-    QEntity *root = entities[0];
+    QEntity *root = itemEntity;
     bool calculateVolume = false;
 
-    qDebug() << "There are" << root->children().count() << "components in the loaded fixture";
+    if (loader)
+    {
+        // The QSceneLoader instance is a component of an entity. The loaded scene
+        // tree is added under this entity.
+        QVector<QEntity *> entities = loader->entities();
+
+        if (entities.isEmpty())
+            return;
+
+        // Technically there could be multiple entities referencing the scene loader
+        // but sharing is discouraged, and in our case there will be one anyhow.
+        root = entities[0];
+        qDebug() << "There are" << root->children().count() << "components in the loaded fixture";
+    }
+
+    delete m_genericPlaceholders.take(itemID);
 
     QLayer *sceneDeferredLayer = m_sceneRootEntity->property("deferredLayer").value<QLayer *>();
     QEffect *sceneEffect = m_sceneRootEntity->property("geometryPassEffect").value<QEffect *>();
@@ -1540,19 +1816,33 @@ void MainView3D::initializeItem(int itemID, QEntity *itemEntity, QSceneLoader *l
     meshRef->m_rootTransform = getTransform(meshRef->m_rootItem);
 
     // If this model has been already loaded, re-use the cached bounding volume
-    if (m_boundingVolumesMap.contains(loader->source()))
-        meshRef->m_volume = m_boundingVolumesMap[loader->source()];
+    if (m_boundingVolumesMap.contains(source))
+        meshRef->m_volume = m_boundingVolumesMap[source];
     else
-        calculateVolume = true;
+        calculateVolume = loader != nullptr;
 
-    // Walk through the scene tree and add each mesh to the deferred pipeline.
-    // If needed, calculate also the bounding volume */
-    /*QEntity *baseItem =*/ inspectEntity(root, meshRef, sceneDeferredLayer, sceneEffect, calculateVolume, translation);
+    if (loader)
+    {
+        if (m_sharedMeshes.contains(source) == false)
+            storeMeshTree(root, -1, m_sharedMeshes[source]);
+
+        // Walk through the scene tree and add each mesh to the deferred pipeline.
+        // If needed, calculate also the bounding volume */
+        inspectEntity(root, meshRef, sceneDeferredLayer, sceneEffect, calculateVolume, translation);
+    }
+    else
+    {
+        // the shared meshes are already in the deferred pipeline
+        cloneMeshTree(m_sharedMeshes.value(source), itemEntity, meshRef, sceneDeferredLayer);
+    }
 
     qDebug() << "Calculated volume" << meshRef->m_volume.m_extents << meshRef->m_volume.m_center;
 
     if (calculateVolume)
-        m_boundingVolumesMap[loader->source()] = meshRef->m_volume;
+    {
+        m_boundingVolumesMap[source] = meshRef->m_volume;
+        saveBoundingVolume(source, meshRef->m_volume);
+    }
 
     QLayer *selectionLayer = m_sceneRootEntity->property("selectionLayer").value<QLayer *>();
     QGeometryRenderer *selectionMesh = m_sceneRootEntity->property("selectionMesh").value<QGeometryRenderer *>();
@@ -1580,6 +1870,13 @@ void MainView3D::initializeItem(int itemID, QEntity *itemEntity, QSceneLoader *l
 
     itemEntity->setProperty("sceneLayer", QVariant::fromValue(sceneDeferredLayer));
     itemEntity->setProperty("effect", QVariant::fromValue(sceneEffect));
+
+    // the items waiting for this model can now share its meshes
+    if (loader && m_genericWaitingItems.contains(source))
+    {
+        for (const QPair<int, QEntity *> &item : m_genericWaitingItems.take(source))
+            setupGenericItem(item.first, item.second, nullptr, source);
+    }
 }
 
 void MainView3D::setItemSelection(int itemID, bool enable, int keyModifiers)
@@ -1627,6 +1924,7 @@ void MainView3D::removeSelectedGenericItems()
     for (int id : m_genericSelectedItems)
     {
         SceneItem *meshRef = m_genericMap.take(id);
+        delete m_genericPlaceholders.take(id);
         if (meshRef)
         {
             delete meshRef->m_rootItem;
@@ -1880,7 +2178,6 @@ void MainView3D::setSmokeAmount(float smokeAmount)
  *  ********************************************************************************* */
 
 GoboTextureImage::GoboTextureImage(int w, int h, QString filename)
-    : m_renderer(nullptr)
 {
     setSize(QSize(w, h));
     setSource(filename);
@@ -1897,21 +2194,6 @@ void GoboTextureImage::setSource(QString filename)
         return;
 
     m_source = filename;
-
-    if (filename.endsWith(".svg"))
-    {
-        if (m_renderer == nullptr)
-            m_renderer = new QSvgRenderer();
-
-        if (m_renderer->load(m_source) == false)
-            qWarning() << "Failed to load SVG gobo" << m_source;
-    }
-    else
-    {
-        if (m_renderer)
-            delete m_renderer;
-        m_renderer = nullptr;
-    }
     update();
 }
 
@@ -1923,13 +2205,9 @@ void GoboTextureImage::paint(QPainter *painter)
     painter->fillRect(0, 0, w, h, Qt::black);
     painter->setBrush(QBrush(Qt::white));
     painter->drawEllipse(2, 2, w - 4, h - 4);
-    if (m_renderer)
-    {
-        m_renderer->render(painter, QRect(1, 1, w - 2, h - 2));
-    }
-    else
-    {
-        QIcon goboFile(m_source);
-        painter->drawPixmap(1, 1, w - 2, h - 2, goboFile.pixmap(QSize(w - 2, h - 2)));
-    }
+
+    // every head showing the same gobo shares the decoded picture
+    QImage gobo = QLCImageCache::image(m_source, QSize(w - 2, h - 2));
+    if (gobo.isNull() == false)
+        painter->drawImage(QRect(1, 1, w - 2, h - 2), gobo);
 }
@@ -24,6 +24,8 @@
 #include <QObject>
 #include <QQuickView>
 #include <QElapsedTimer>
+#include <QQuaternion>
+#include <QVector>
 
 #include <Qt3DCore/QEntity>
 #include <Qt3DCore/QTransform>
@@ -40,7 +42,6 @@
 
 class Doc;
 class Fixture;
-class QSvgRenderer;
 class MonitorProperties;
 
 using namespace Qt3DCore;
@@ -60,7 +61,6 @@ protected:
     void paint(QPainter *painter);
 
 private:
-    QSvgRenderer *m_renderer;
     QString m_source;
 };
 
@@ -89,6 +89,21 @@ typedef struct
     GoboTextureImage *m_goboTexture;
 } SceneItem;
 
+typedef struct
+{
+    /** Index of the parent node in the tree, -1 for the root */
+    int m_parent;
+    /** The entity object name (base, arm, head...) */
+    QString m_name;
+    /** The entity transform, if any */
+    bool m_hasTransform;
+    QVector3D m_translation;
+    QQuaternion m_rotation;
+    QVector3D m_scale;
+    /** The mesh and material components, shared by every clone */
+    QVector<QComponent *> m_components;
+} MeshNode;
+
 class MainView3D : public PreviewContext
 {
     Q_OBJECT
@@ -193,6 +208,23 @@ public:
 
     Q_INVOKABLE void initializeFixture(quint32 itemID, QEntity *fxEntity, QSceneLoader *loader);
 
+protected:
+    /** Initialize a fixture item either from the model loaded by $loader,
+     *  or from the shared meshes of the model at $sharedSource */
+    void setupFixtureItem(quint32 itemID, QEntity *fxEntity, QSceneLoader *loader,
+                          const QUrl &sharedSource);
+
+    /** Store the pre-order tree of a loaded model, moving its mesh and material
+     *  components under the scene root, so they outlive the item that loaded them */
+    void storeMeshTree(QEntity *entity, int parentIndex, QVector<MeshNode> &tree);
+
+    /** Build a copy of a stored model tree under $fxEntity. Meshes and materials
+     *  are shared, while transforms are per item. Returns the base entity */
+    QEntity *cloneMeshTree(const QVector<MeshNode> &tree, QEntity *fxEntity,
+                           SceneItem *meshRef, QLayer *layer);
+
+public:
+
     Q_INVOKABLE QString makeShader(QString str);
 
     /** Update the fixture preview items when some channels have changed */
@@ -267,6 +299,37 @@ private:
     /** Cache of the loaded models against bounding volumes */
     QMap<QUrl, BoundingVolume> m_boundingVolumesMap;
 
+    /** Cache of the loaded models against their mesh trees. A model is
+     *  loaded once, the following items using it share its meshes */
+    QMap<QUrl, QVector<MeshNode>> m_sharedMeshes;
+
+    /** The items waiting for a model to be loaded, to share its meshes */
+    QMap<QUrl, QList<QPair<quint32, QEntity *>>> m_meshWaitingItems;
+
+    /*********************************************************************
+     * Placeholders
+     *********************************************************************/
+protected:
+    /** Create a box standing in for an item whose model is not loaded yet.
+     *  $pos is the item position in millimeters, $size its size in meters */
+    QEntity *createPlaceholder(QVector3D pos, QVector3D size);
+
+    /** Load the bounding volumes of the models measured in the previous
+     *  sessions, dropping those of the files changed since then */
+    void loadBoundingVolumes();
+
+    /** Store the bounding volume of the model at $source for the next sessions */
+    void saveBoundingVolume(const QUrl &source, const BoundingVolume &volume);
+
+private:
+    /** The mesh and material shared by every placeholder */
+    QGeometryRenderer *m_placeholderMesh;
+    QMaterial *m_placeholderMaterial;
+
+    /** The placeholders of the fixture and generic items, by item ID */
+    QMap<quint32, QEntity *> m_fixturePlaceholders;
+    QMap<int, QEntity *> m_genericPlaceholders;
+
     /*********************************************************************
      * Generic items
      *********************************************************************/
@@ -275,6 +338,14 @@ public:
 
     Q_INVOKABLE void initializeItem(int itemID, QEntity *fxEntity, QSceneLoader *loader);
 
+protected:
+    /** Initialize a generic item either from the model loaded by $loader,
+     *  or from the shared meshes of the model at $sharedSource */
+    void setupGenericItem(int itemID, QEntity *itemEntity, QSceneLoader *loader,
+                          const QUrl &sharedSource);
+
+public:
+
     Q_INVOKABLE void setItemSelection(int itemID, bool enable, int keyModifiers);
 
     int genericSelectedCount() const;
@@ -308,6 +379,9 @@ private:
     /** Map of the generic items in the scene */
     QMap<int, SceneItem*> m_genericMap;
 
+    /** The generic items waiting for a model to be loaded, to share its meshes */
+    QMap<QUrl, QList<QPair<int, QEntity *>>> m_genericWaitingItems;
+
     /*********************************************************************
      * Environment
      *********************************************************************/
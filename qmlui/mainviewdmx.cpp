@@ -18,6 +18,7 @@
 */
 
 #include <QDebug>
+#include <QPainter>
 #include <QByteArray>
 #include <QQuickItem>
 #include <QQmlContext>
@@ -27,13 +28,170 @@
 #include "fixtureutils.h"
 #include "qlcfixturemode.h"
 #include "monitorproperties.h"
+#include "inputoutputmap.h"
+#include "universe.h"
 #include "doc.h"
 
+#define DMX_GRID_TILE_ROWS (UNIVERSE_SIZE / DMX_GRID_TILE_COLUMNS)
+
+/*********************************************************************
+ * DMXGridItem
+ *********************************************************************/
+
+DMXGridItem::DMXGridItem(QQuickItem *parent)
+    : QQuickPaintedItem(parent)
+    , m_universesCount(0)
+    , m_universeColumns(1)
+{
+    setAntialiasing(false);
+    resizeImage();
+}
+
+int DMXGridItem::universesCount() const
+{
+    return m_universesCount;
+}
+
+void DMXGridItem::setUniversesCount(int count)
+{
+    m_fixtureLines.clear();
+
+    if (m_universesCount != count)
+    {
+        m_universesCount = count;
+        emit universesCountChanged();
+    }
+
+    resizeImage();
+}
+
+int DMXGridItem::universeColumns() const
+{
+    return m_universeColumns;
+}
+
+void DMXGridItem::setUniverseColumns(int columns)
+{
+    if (columns < 1 || m_universeColumns == columns)
+        return;
+
+    // the values and the boundaries are laid out again by the owner
+    m_universeColumns = columns;
+    m_fixtureLines.clear();
+    resizeImage();
+
+    emit universeColumnsChanged();
+}
+
+int DMXGridItem::tileColumns() const
+{
+    return DMX_GRID_TILE_COLUMNS;
+}
+
+int DMXGridItem::tileRows() const
+{
+    return DMX_GRID_TILE_ROWS;
+}
+
+void DMXGridItem::setUniverseValues(int index, const QByteArray &values)
+{
+    if (index < 0 || index >= m_universesCount)
+        return;
+
+    QPoint origin = tileOrigin(index);
+    const uchar *data = reinterpret_cast<const uchar *>(values.constData());
+    int size = qMin(values.size(), UNIVERSE_SIZE);
+
+    // the frame may hold only the used channels, the others are zero
+    for (int row = 0; row < DMX_GRID_TILE_ROWS; row++)
+    {
+        uchar *line = m_image.scanLine(origin.y() + row) + origin.x();
+        int offset = row * DMX_GRID_TILE_COLUMNS;
+        int count = qBound(0, size - offset, DMX_GRID_TILE_COLUMNS);
+
+        memcpy(line, data + offset, size_t(count));
+        memset(line + count, 0, size_t(DMX_GRID_TILE_COLUMNS - count));
+    }
+}
+
+void DMXGridItem::addFixtureRange(int index, int address, int channels)
+{
+    if (index < 0 || index >= m_universesCount || address >= UNIVERSE_SIZE || channels < 1)
+        return;
+
+    QPoint first = channelCell(index, address);
+    QPoint last = channelCell(index, qMin(address + channels, UNIVERSE_SIZE) - 1);
+
+    m_fixtureLines.append(QLineF(first.x(), first.y(), first.x(), first.y() + 1));
+    m_fixtureLines.append(QLineF(last.x() + 1, last.y(), last.x() + 1, last.y() + 1));
+    update();
+}
+
+void DMXGridItem::paint(QPainter *painter)
+{
+    if (m_image.isNull())
+        return;
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter->drawImage(QRectF(0, 0, width(), height()), m_image);
+
+    painter->scale(width() / m_image.width(), height() / m_image.height());
+
+    QPen pen(QColor(0x3F, 0xA9, 0xF5));
+    pen.setCosmetic(true);
+    painter->setPen(pen);
+    painter->drawLines(m_fixtureLines);
+
+    pen.setColor(Qt::darkGray);
+    painter->setPen(pen);
+    for (int i = 0; i < m_universesCount; i++)
+        painter->drawRect(QRect(tileOrigin(i), QSize(DMX_GRID_TILE_COLUMNS, DMX_GRID_TILE_ROWS)));
+}
+
+QPoint DMXGridItem::tileOrigin(int index) const
+{
+    return QPoint((index % m_universeColumns) * DMX_GRID_TILE_COLUMNS,
+                  (index / m_universeColumns) * DMX_GRID_TILE_ROWS);
+}
+
+QPoint DMXGridItem::channelCell(int index, int address) const
+{
+    return tileOrigin(index) + QPoint(address % DMX_GRID_TILE_COLUMNS,
+                                      address / DMX_GRID_TILE_COLUMNS);
+}
+
+void DMXGridItem::resizeImage()
+{
+    int columns = qMin(m_universesCount, m_universeColumns);
+    int rows = m_universesCount ? (m_universesCount + m_universeColumns - 1) / m_universeColumns : 0;
+
+    if (columns == 0)
+    {
+        m_image = QImage();
+    }
+    else
+    {
+        m_image = QImage(columns * DMX_GRID_TILE_COLUMNS, rows * DMX_GRID_TILE_ROWS,
+                         QImage::Format_Grayscale8);
+        m_image.fill(0);
+    }
+    update();
+}
+
+/*********************************************************************
+ * MainViewDMX
+ *********************************************************************/
+
 MainViewDMX::MainViewDMX(QQuickView *view, Doc *doc, QObject *parent)
     : PreviewContext(view, doc, "DMX", parent)
     , m_showAddresses(false)
     , m_relativeAddresses(false)
+    , m_gridMode(false)
+    , m_gridItem(nullptr)
+    , m_gridRevision(0)
 {
+    qmlRegisterType<DMXGridItem>("org.qlcplus.classes", 1, 0, "DMXGridItem");
+
     setContextResource("qrc:/DMXView.qml");
     setContextTitle(tr("DMX View"));
 
@@ -52,11 +210,19 @@ void MainViewDMX::enableContext(bool enable)
     PreviewContext::enableContext(enable);
     if (enable == true)
         slotRefreshView();
+    else
+        m_gridItem = nullptr;
 }
 
 void MainViewDMX::setUniverseFilter(quint32 universeFilter)
 {
     PreviewContext::setUniverseFilter(universeFilter);
+    if (m_gridMode)
+    {
+        updateGridLayout();
+        return;
+    }
+
     QMapIterator<quint32, QQuickItem*> it(m_itemsMap);
     while(it.hasNext())
     {
@@ -90,7 +256,7 @@ void MainViewDMX::reset()
 
 void MainViewDMX::createFixtureItem(quint32 fxID)
 {
-    if (isEnabled() == false)
+    if (isEnabled() == false || m_gridMode)
         return;
 
     qDebug() << "[MainViewDMX] Creating fixture with ID" << fxID;
@@ -126,6 +292,9 @@ void MainViewDMX::setFixtureFlags(quint32 itemID, quint32 flags)
         return;
 
     QQuickItem *fxItem = m_itemsMap.value(fixtureID, nullptr);
+    if (fxItem == nullptr)
+        return;
+
     fxItem->setProperty("visible", (flags & MonitorProperties::HiddenFlag) ? false : true);
 }
 
@@ -208,6 +377,91 @@ void MainViewDMX::setRelativeAddresses(bool relativeAddresses)
     emit relativeAddressesChanged(m_relativeAddresses);
 }
 
+bool MainViewDMX::gridMode() const
+{
+    return m_gridMode;
+}
+
+void MainViewDMX::setGridMode(bool gridMode)
+{
+    if (m_gridMode == gridMode)
+        return;
+
+    m_gridMode = gridMode;
+    slotRefreshView();
+    emit gridModeChanged(m_gridMode);
+}
+
+void MainViewDMX::updateGrid()
+{
+    if (isEnabled() == false || m_gridMode == false || m_gridItem == nullptr)
+        return;
+
+    if (m_gridRevision != m_doc->fixturesRevision())
+        updateGridLayout();
+    else
+        copyGridFrames(false);
+}
+
+void MainViewDMX::updateGridLayout()
+{
+    if (m_gridItem == nullptr)
+    {
+        m_gridItem = m_view->rootObject()->findChild<DMXGridItem *>("DMXGridView");
+        if (m_gridItem == nullptr)
+            return;
+
+        connect(m_gridItem, &DMXGridItem::universeColumnsChanged, this, &MainViewDMX::updateGridLayout);
+    }
+
+    m_gridUniverses.clear();
+    for (Universe *universe : m_doc->inputOutputMap()->universes())
+    {
+        if (universeFilter() == Universe::invalid() || universe->id() == universeFilter())
+            m_gridUniverses.append(universe->id());
+    }
+    m_gridGenerations.fill(0, m_gridUniverses.count());
+
+    m_gridItem->setUniversesCount(m_gridUniverses.count());
+
+    MonitorProperties *monProps = m_doc->monitorProperties();
+    for (Fixture *fixture : m_doc->fixtures())
+    {
+        int index = m_gridUniverses.indexOf(fixture->universe());
+        if (index < 0 || (monProps->fixtureFlags(fixture->id(), 0, 0) & MonitorProperties::HiddenFlag))
+            continue;
+
+        m_gridItem->addFixtureRange(index, int(fixture->address()), int(fixture->channels()));
+    }
+
+    m_gridRevision = m_doc->fixturesRevision();
+    copyGridFrames(true);
+}
+
+void MainViewDMX::copyGridFrames(bool force)
+{
+    bool changed = false;
+
+    for (int i = 0; i < m_gridUniverses.count(); i++)
+    {
+        Universe *universe = m_doc->inputOutputMap()->universe(m_gridUniverses.at(i));
+        if (universe == nullptr)
+            continue;
+
+        if (force == false && universe->frameGeneration() == m_gridGenerations.at(i))
+            continue;
+
+        quint32 generation;
+        QByteArray frame = universe->lastFrame(&generation);
+        m_gridGenerations[i] = generation;
+        m_gridItem->setUniverseValues(i, frame);
+        changed = true;
+    }
+
+    if (changed)
+        m_gridItem->update();
+}
+
 void MainViewDMX::slotRefreshView()
 {
     if (isEnabled() == false)
@@ -215,6 +469,12 @@ void MainViewDMX::slotRefreshView()
 
     reset();
 
+    if (m_gridMode)
+    {
+        updateGridLayout();
+        return;
+    }
+
     for (Fixture *fixture : m_doc->fixtures())
         createFixtureItem(fixture->id());
 }
@@ -22,18 +22,84 @@
 
 #include <QObject>
 #include <QQuickView>
+#include <QQuickPaintedItem>
+#include <QImage>
 
 #include "previewcontext.h"
 
 class Doc;
 class Fixture;
 
+/** Number of channels drawn on each row of a universe tile of the grid */
+#define DMX_GRID_TILE_COLUMNS 32
+
+class DMXGridItem : public QQuickPaintedItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int universesCount READ universesCount NOTIFY universesCountChanged)
+    Q_PROPERTY(int universeColumns READ universeColumns WRITE setUniverseColumns NOTIFY universeColumnsChanged)
+    Q_PROPERTY(int tileColumns READ tileColumns CONSTANT)
+    Q_PROPERTY(int tileRows READ tileRows CONSTANT)
+
+public:
+    DMXGridItem(QQuickItem *parent = nullptr);
+
+    /** Get the number of universes drawn by the grid */
+    int universesCount() const;
+
+    /** Set the number of universes drawn by the grid.
+     *  The values and the fixture boundaries are cleared */
+    void setUniversesCount(int count);
+
+    /** Get/Set the number of universe tiles on each row of the grid.
+     *  Like setUniversesCount(), this clears the values and the boundaries */
+    int universeColumns() const;
+    void setUniverseColumns(int columns);
+
+    /** Get the size of a universe tile, in channels */
+    int tileColumns() const;
+    int tileRows() const;
+
+    /** Copy the values of the universe at grid position $index.
+     *  The item is repainted only on the next update() call */
+    void setUniverseValues(int index, const QByteArray &values);
+
+    /** Mark the boundaries of a fixture of the universe at grid position $index */
+    void addFixtureRange(int index, int address, int channels);
+
+    /** @reimp */
+    void paint(QPainter *painter);
+
+signals:
+    void universesCountChanged();
+    void universeColumnsChanged();
+
+private:
+    /** Return the top left cell of the tile of the universe at $index */
+    QPoint tileOrigin(int index) const;
+
+    /** Return the cell of $address in the tile of the universe at $index */
+    QPoint channelCell(int index, int address) const;
+
+    void resizeImage();
+
+private:
+    int m_universesCount;
+    int m_universeColumns;
+    /** The channel values, one pixel per channel */
+    QImage m_image;
+    /** The fixture boundaries, in cells */
+    QVector<QLineF> m_fixtureLines;
+};
+
 class MainViewDMX : public PreviewContext
 {
     Q_OBJECT
 
     Q_PROPERTY(bool showAddresses READ showAddresses WRITE setShowAddresses NOTIFY showAddressesChanged)
     Q_PROPERTY(bool relativeAddresses READ relativeAddresses WRITE setRelativeAddresses NOTIFY relativeAddressesChanged)
+    Q_PROPERTY(bool gridMode READ gridMode WRITE setGridMode NOTIFY gridModeChanged)
 
 public:
     explicit MainViewDMX(QQuickView *view, Doc *doc, QObject *parent = 0);
@@ -68,9 +134,18 @@ public:
     bool relativeAddresses() const;
     void setRelativeAddresses(bool relativeAddresses);
 
+    /** Get/Set if the DMX View should draw whole universes as a
+     *  single grid, instead of a block for each fixture */
+    bool gridMode() const;
+    void setGridMode(bool gridMode);
+
+    /** Copy the frames written since the last call into the grid */
+    void updateGrid();
+
 signals:
     void showAddressesChanged(bool showAddresses);
     void relativeAddressesChanged(bool relativeAddresses);
+    void gridModeChanged(bool gridMode);
 
 public slots:
     /** @reimp */
@@ -79,11 +154,28 @@ public slots:
 protected slots:
     void slotAliasChanged();
 
+private:
+    /** Lay the shown universes and their fixtures out on the grid */
+    void updateGridLayout();
+
+    /** Copy the universe frames into the grid. If $force is false,
+     *  the frames already copied are skipped */
+    void copyGridFrames(bool force);
+
 private:
     /** Pre-cached QML component for quick item creation */
     QQmlComponent *fixtureComponent;
     bool m_showAddresses;
     bool m_relativeAddresses;
+
+    bool m_gridMode;
+    DMXGridItem *m_gridItem;
+    /** The IDs of the universes drawn by the grid, in grid order */
+    QVector<quint32> m_gridUniverses;
+    /** The generation of the last frame copied for each grid universe */
+    QVector<quint32> m_gridGenerations;
+    /** The Doc fixtures revision the grid layout was built with */
+    int m_gridRevision;
 };
 
 #endif // MAINVIEWDMX_H
@@ -40,6 +40,7 @@ PaletteManager::PaletteManager(QQuickView *view, Doc *doc,
     QStringList listRoles;
     listRoles << "paletteID" << "isSelected";
     m_paletteList->setRoleNames(listRoles);
+    m_paletteList->setKeyRole("paletteID");
 
     m_dimmerCount = m_colorCount = m_positionCount = 0;
 
@@ -176,6 +177,7 @@ QStringList PaletteManager::selectedItemNames(QVariantList list)
 
 void PaletteManager::updatePaletteList()
 {
+    m_paletteList->beginUpdate();
     m_paletteList->clear();
     m_dimmerCount = m_colorCount = m_positionCount = 0;
 
@@ -207,6 +209,8 @@ void PaletteManager::updatePaletteList()
         }
     }
 
+    m_paletteList->endUpdate();
+
     emit dimmerCountChanged();
     emit colorCountChanged();
     emit positionCountChanged();
@@ -52,7 +52,7 @@ Popup
         visible: false
         title: qsTr("Open a file")
         folder: "file://" + qlcplus.workingPath
-        nameFilters: [ qsTr("QLC+ files") + " (*.qxw *.qxf)", qsTr("All files") + " (*)" ]
+        nameFilters: [ qsTr("QLC+ files") + " (*.qxw *.qxwz *.qxf)", qsTr("All files") + " (*)" ]
 
         onAccepted:
         {
@@ -70,7 +70,7 @@ Popup
         visible: false
         title: qsTr("Import from project")
         folder: "file://" + qlcplus.workingPath
-        nameFilters: [ qsTr("Project files") + " (*.qxw)", qsTr("All files") + " (*)" ]
+        nameFilters: [ qsTr("Project files") + " (*.qxw *.qxwz)", qsTr("All files") + " (*)" ]
 
         onAccepted:
         {
@@ -85,7 +85,7 @@ Popup
         visible: false
         title: qsTr("Save project as...")
         selectExisting: false
-        nameFilters: [ qsTr("Project files") + " (*.qxw)", qsTr("All files") + " (*)" ]
+        nameFilters: [ qsTr("Project files") + " (*.qxw)", qsTr("Compressed project files") + " (*.qxwz)", qsTr("All files") + " (*)" ]
 
         onAccepted:
         {
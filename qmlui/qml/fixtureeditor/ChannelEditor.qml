@@ -182,7 +182,7 @@ GridLayout
                         colorPreview.secondary = editor.getCapabilityValueAt(index, 1)
                     break
                     case QLCCapability.Picture:
-                        goboPicture.source = "file://" + editor.getCapabilityValueAt(index, 0)
+                        goboPicture.source = "image://qlcimage/" + editor.getCapabilityValueAt(index, 0)
                     break
                     case QLCCapability.SingleValue:
                         pValueSpin.value = editor.getCapabilityValueAt(index, 0)
@@ -25,7 +25,9 @@ import QtQuick 2.0
 RenderSettings
 {
     pickingSettings.pickMethod: PickingSettings.TrianglePicking
-    //renderPolicy: RenderSettings.OnDemand
+    // redraw only when a node of the scene changes,
+    // including the running gobo and movement animations
+    renderPolicy: RenderSettings.OnDemand
 
     property alias camera: sceneCameraSelector.camera
     property alias myCameraSelector: sceneCameraSelector
@@ -263,6 +263,18 @@ Rectangle
                             onToggled: View3D.frameCountEnabled = checked
                         }
 
+                        // row 5
+                        RobotoText { height: UISettings.listItemHeight; label: qsTr("Max preview FPS") }
+                        CustomSpinBox
+                        {
+                            Layout.fillWidth: true
+                            height: UISettings.listItemHeight
+                            from: 1
+                            to: 240
+                            value: contextManager.maxPreviewFPS
+                            onValueModified: contextManager.maxPreviewFPS = value
+                        }
+
                     } // GridLayout
             } // SectionBox - Rendering
 
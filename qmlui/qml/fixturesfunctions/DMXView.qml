@@ -20,6 +20,7 @@
 import QtQuick 2.0
 import QtQuick.Controls 2.1
 
+import org.qlcplus.classes 1.0
 import "."
 
 Rectangle
@@ -60,6 +61,7 @@ Rectangle
         contentHeight: flowLayout.height
         contentWidth: flowLayout.width
         interactive: false
+        visible: !ViewDMX.gridMode
 
         boundsBehavior: Flickable.StopAtBounds
 
@@ -85,6 +87,48 @@ Rectangle
         ScrollBar.horizontal : CustomScrollBar { orientation: Qt.Horizontal }
     }
 
+    DMXGridItem
+    {
+        id: dmxGrid
+        objectName: "DMXGridView"
+        x: viewMargin
+        y: viewMargin
+        visible: ViewDMX.gridMode
+
+        property real availableWidth: dmxViewRoot.width - (viewMargin * 2)
+        property real availableHeight: dmxViewRoot.height - (viewMargin * 2)
+        property real cellSize: 1
+
+        width: universeColumns * tileColumns * cellSize
+        height: Math.ceil(universesCount / universeColumns) * tileRows * cellSize
+
+        /* Pick the number of tiles per row that gives the biggest cells */
+        function updateLayout()
+        {
+            var bestColumns = 1
+            var bestCell = 0
+
+            for (var cols = 1; cols <= Math.max(1, universesCount); cols++)
+            {
+                var rows = Math.ceil(universesCount / cols)
+                var cell = Math.min(availableWidth / (cols * tileColumns),
+                                    availableHeight / (rows * tileRows))
+                if (cell > bestCell)
+                {
+                    bestCell = cell
+                    bestColumns = cols
+                }
+            }
+
+            cellSize = Math.max(1, Math.floor(bestCell))
+            universeColumns = bestColumns
+        }
+
+        onUniversesCountChanged: updateLayout()
+        onAvailableWidthChanged: updateLayout()
+        onAvailableHeightChanged: updateLayout()
+    }
+
     SettingsViewDMX
     {
         id: dmxSettings
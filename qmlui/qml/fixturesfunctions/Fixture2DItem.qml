@@ -60,6 +60,9 @@ Rectangle
     property bool isSelected: false
     property bool showLabel: false
 
+    /* When true, the heads are drawn by pixelHeads, one pixel each */
+    property bool pixelMode: false
+
     onWidthChanged: calculateHeadSize();
     onHeightChanged: calculateHeadSize();
     //onHeadsNumberChanged: calculateHeadSize();
@@ -107,12 +110,16 @@ Rectangle
 
     function setHeadIntensity(headIndex, intensity)
     {
+        if (pixelMode)
+            return
         //console.log("headIdx: " + headIndex + ", int: " + intensity)
         headsRepeater.itemAt(headIndex).dimmerValue = intensity
     }
 
     function setHeadRGBColor(headIndex, color)
     {
+        if (pixelMode)
+            return
         var headItem = headsRepeater.itemAt(headIndex)
         headItem.isWheelColor = false
         headItem.headColor1 = color
@@ -120,6 +127,8 @@ Rectangle
 
     function setShutter(type, low, high)
     {
+        if (pixelMode)
+            pixelsShutter.setShutter(type, low, high)
         for (var i = 0; i < headsRepeater.count; i++)
             headsRepeater.itemAt(i).setShutter(type, low, high);
     }
@@ -137,6 +146,8 @@ Rectangle
 
     function setWheelColor(headIndex, col1, col2)
     {
+        if (pixelMode)
+            return
         var headItem = headsRepeater.itemAt(headIndex)
         headItem.headColor1 = col1
         if (col2 !== Qt.rgba(0,0,0,1))
@@ -148,10 +159,9 @@ Rectangle
 
     function setGoboPicture(headIndex, resource)
     {
-        if (Qt.platform.os === "android")
-            headsRepeater.itemAt(headIndex).goboSource = resource
-        else
-            headsRepeater.itemAt(headIndex).goboSource = "file:/" + resource
+        if (pixelMode)
+            return
+        headsRepeater.itemAt(headIndex).goboSource = "image://qlcimage/" + resource
     }
 
     Grid
@@ -164,7 +174,7 @@ Rectangle
         Repeater
         {
             id: headsRepeater
-            model: headsBox.columns * headsBox.rows // fixtureItem.headsNumber
+            model: pixelMode ? 0 : headsBox.columns * headsBox.rows // fixtureItem.headsNumber
             delegate:
                 Rectangle
                 {
@@ -214,6 +224,20 @@ Rectangle
         }
     }
 
+    PixelHeadsItem
+    {
+        objectName: "pixelHeads"
+        anchors.centerIn: parent
+        width: headsBox.width
+        height: headsBox.height
+        columns: headsBox.columns
+        rows: headsBox.rows
+        visible: pixelMode
+        opacity: pixelsShutter.shutterValue
+
+        ShutterAnimator { id: pixelsShutter }
+    }
+
     Canvas
     {
         id: positionLayer
@@ -60,10 +60,7 @@ Rectangle
         }
         else if (resArray[0].indexOf('.') !== -1)
         {
-            if (Qt.platform.os === "android")
-                pic.source = resArray[0]
-            else
-                pic.source = "file:/" + resArray[0]
+            pic.source = "image://qlcimage/" + resArray[0]
         }
     }
 
@@ -112,6 +109,7 @@ Rectangle
                 width: parent.width - 2
                 height: width
                 anchors.centerIn: parent
+                sourceSize: Qt.size(width, height)
                 source: ""
             }
         }
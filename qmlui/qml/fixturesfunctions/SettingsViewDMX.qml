@@ -35,6 +35,7 @@ Rectangle
 
     property bool showAddresses: ViewDMX.showAddresses
     property bool relativeAddresses: ViewDMX.relativeAddresses
+    property bool gridMode: ViewDMX.gridMode
 
     GridLayout
     {
@@ -78,5 +79,15 @@ Rectangle
             checked: relativeAddresses
             onToggled: ViewDMX.relativeAddresses = checked
         }
+
+        // row 4
+        RobotoText { label: qsTr("Universe grid") }
+        CustomCheckBox
+        {
+            implicitHeight: UISettings.listItemHeight
+            implicitWidth: implicitHeight
+            checked: gridMode
+            onToggled: ViewDMX.gridMode = checked
+        }
     }
 }
@@ -227,10 +227,7 @@ VCWidgetItem
                 }
 
                 presetPreviewBox.visible = true
-                if (Qt.platform.os === "android")
-                    presetImageBox.source = cngResource
-                else
-                    presetImageBox.source = "file:/" + cngResource
+                presetImageBox.source = "image://qlcimage/" + cngResource
             }
 
             onClicked: colorToolLoader.toggleVisibility()
@@ -263,6 +260,7 @@ VCWidgetItem
                 {
                     id: presetImageBox
                     anchors.fill: parent
+                    sourceSize: Qt.size(width, height)
                 }
             }
 
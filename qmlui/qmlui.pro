@@ -40,6 +40,7 @@ HEADERS += \
     fixtureutils.h \
     functioneditor.h \
     functionmanager.h \
+    imageprovider.h \
     importmanager.h \
     inputoutputmanager.h \
     listmodel.h \
@@ -73,6 +74,7 @@ SOURCES += main.cpp \
     fixtureutils.cpp \
     functioneditor.cpp \
     functionmanager.cpp \
+    imageprovider.cpp \
     importmanager.cpp \
     inputoutputmanager.cpp \
     listmodel.cpp \
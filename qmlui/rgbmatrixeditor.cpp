@@ -21,6 +21,7 @@
 #include <QDebug>
 
 #include "rgbmatrixeditor.h"
+#include "loadgovernor.h"
 
 #include "rgbmatrix.h"
 #include "rgbimage.h"
@@ -41,6 +42,7 @@ RGBMatrixEditor::RGBMatrixEditor(QQuickView *view, Doc *doc, QObject *parent)
     m_gotBeat = false;
     connect(m_previewTimer, SIGNAL(timeout()), this, SLOT(slotPreviewTimeout()));
     connect(m_doc->masterTimer(), SIGNAL(beat()), this, SLOT(slotBeatReceived()));
+    connect(m_doc->loadGovernor(), &LoadGovernor::levelChanged, this, &RGBMatrixEditor::slotLoadLevelChanged);
 }
 
 RGBMatrixEditor::~RGBMatrixEditor()
@@ -564,7 +566,7 @@ void RGBMatrixEditor::slotPreviewTimeout()
 
     if (m_matrix->tempoType() == Function::Time)
     {
-        m_previewElapsed += MasterTimer::tick();
+        m_previewElapsed += m_previewTimer->interval();
     }
     else if (m_matrix->tempoType() == Function::Beats && m_gotBeat)
     {
@@ -606,16 +608,15 @@ void RGBMatrixEditor::slotPreviewTimeout()
         if (m_previewData.isEmpty() || m_previewStepHandler->m_map.isEmpty())
             return;
 
-        QMapIterator<QLCPoint, GroupHead> it(m_group->headsMap());
-        while(it.hasNext())
-        {
-            it.next();
+        const QVector<GroupHead> &heads = m_group->headGrid();
+        int width = m_group->size().width();
+        const RGBMap &map = m_previewStepHandler->m_map;
 
-            QLCPoint pt(it.key());
-            //GroupHead head(it.value());
-            int ptIdx = pt.x() + (pt.y() * m_group->size().width());
-            if (ptIdx < m_previewData.size())
-                m_previewData[ptIdx] = QVariant(QColor(m_previewStepHandler->m_map[pt.y()][pt.x()]));
+        for (int ptIdx = 0; ptIdx < heads.count() && ptIdx < m_previewData.size(); ptIdx++)
+        {
+            int x = ptIdx % width, y = ptIdx / width;
+            if (heads.at(ptIdx).isValid() && y < map.height() && x < map.width())
+                m_previewData[ptIdx] = QVariant(QColor(map[y][x]));
         }
 
         //qDebug() << "Preview data changed!";
@@ -645,5 +646,12 @@ void RGBMatrixEditor::initPreviewData()
                                               m_matrix->endColor(), m_matrix->stepsCount());
     m_previewStepHandler->calculateColorDelta(m_matrix->startColor(), m_matrix->endColor());
 
-    m_previewTimer->start(MasterTimer::tick());
+    m_previewTimer->start(m_doc->loadGovernor()->scaledInterval(MasterTimer::tick()));
+}
+
+void RGBMatrixEditor::slotLoadLevelChanged()
+{
+    /* The preview gives way to the engine when it's overloaded */
+    if (m_previewTimer->isActive())
+        m_previewTimer->start(m_doc->loadGovernor()->scaledInterval(MasterTimer::tick()));
 }
@@ -171,6 +171,7 @@ public:
 private slots:
     void slotPreviewTimeout();
     void slotBeatReceived();
+    void slotLoadLevelChanged();
 
 private:
     void initPreviewData();
@@ -40,11 +40,13 @@ SceneEditor::SceneEditor(QQuickView *view, Doc *doc, QObject *parent)
     QStringList fRoles;
     fRoles << "cRef" << "isSelected";
     m_fixtureList->setRoleNames(fRoles);
+    m_fixtureList->setKeyRole("cRef");
 
     m_componentList = new ListModel(this);
     QStringList cRoles;
     cRoles << "type" << "cRef" << "isSelected";
     m_componentList->setRoleNames(cRoles);
+    m_componentList->setKeyRole("cRef");
 }
 
 SceneEditor::~SceneEditor()
@@ -371,7 +373,9 @@ void SceneEditor::updateLists()
     }
 
     m_fixtureIDs.clear();
+    m_fixtureList->beginUpdate();
     m_fixtureList->clear();
+    m_componentList->beginUpdate();
     m_componentList->clear();
 
     /** The component list order is:
@@ -437,6 +441,9 @@ void SceneEditor::updateLists()
     for (SceneValue sv : m_scene->values())
         addFixtureToList(sv.fxi);
 
+    m_componentList->endUpdate();
+    m_fixtureList->endUpdate();
+
     emit componentListChanged();
     emit fixtureListChanged();
 }
@@ -17,7 +17,9 @@
   limitations under the License.
 */
 
+#include <QGuiApplication>
 #include <QQmlContext>
+#include <QScreen>
 
 #include "simpledesk.h"
 #include "keypadparser.h"
@@ -64,6 +66,14 @@ SimpleDesk::SimpleDesk(QQuickView *view, Doc *doc, QObject *parent)
     connect(m_doc, SIGNAL(fixtureRemoved(quint32)), this, SLOT(updateChannelList()));
     connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
             this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+
+    int refreshRate = 60;
+    if (QGuiApplication::primaryScreen() != nullptr)
+        refreshRate = qMax(1, qRound(QGuiApplication::primaryScreen()->refreshRate()));
+
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(1000 / refreshRate);
+    connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(slotRefreshChannels()));
 }
 
 SimpleDesk::~SimpleDesk()
@@ -74,6 +84,7 @@ SimpleDesk::~SimpleDesk()
 void SimpleDesk::setUniverseFilter(quint32 universeFilter)
 {
     PreviewContext::setUniverseFilter(universeFilter);
+    m_pendingUniverseValues.clear();
     updateChannelList();
     emit fixtureListChanged();
 }
@@ -105,6 +116,7 @@ void SimpleDesk::updateChannelList()
     quint32 prevID = Fixture::invalidId();
     int status = None;
 
+    m_channelList->beginUpdate();
     m_channelList->clear();
 
     QByteArray currUni = m_prevUniverseValues.value(m_universeFilter);
@@ -153,6 +165,8 @@ void SimpleDesk::updateChannelList()
         m_channelList->addDataMap(chMap);
     }
 
+    m_channelList->endUpdate();
+
     emit channelListChanged();
 }
 
@@ -281,7 +295,24 @@ void SimpleDesk::slotUniverseWritten(quint32 idx, const QByteArray& ua)
     if (idx != m_universeFilter) // || isEnabled() == false)
         return;
 
+    // only the last frame is shown at the next refresh
+    m_pendingUniverseValues = ua;
+    if (m_refreshTimer.isActive() == false)
+        m_refreshTimer.start();
+}
+
+void SimpleDesk::slotRefreshChannels()
+{
+    quint32 idx = m_universeFilter;
+    const QByteArray ua = m_pendingUniverseValues;
+    m_pendingUniverseValues.clear();
+
+    if (ua.isEmpty())
+        return;
+
     QByteArray currUni = m_prevUniverseValues.value(idx);
+    if (currUni.length() < ua.length())
+        currUni.append(QByteArray(ua.length() - currUni.length(), char(0)));
 
     for (int i = 0; i < ua.length(); i++)
     {
@@ -298,7 +329,8 @@ void SimpleDesk::slotUniverseWritten(quint32 idx, const QByteArray& ua)
         }
     }
 
-    m_prevUniverseValues[idx].replace(0, ua.length(), ua);
+    currUni.replace(0, ua.length(), ua);
+    m_prevUniverseValues[idx] = currUni;
 }
 
 /************************************************************************
@@ -24,6 +24,7 @@
 #include "dmxsource.h"
 
 #include <QMutex>
+#include <QTimer>
 
 class GenericFader;
 class FadeChannel;
@@ -69,6 +70,13 @@ private:
     /** Values array for comparison */
     QMap<quint32, QByteArray> m_prevUniverseValues;
 
+    /** The last frame received for the filtered universe,
+     *  waiting for the next refresh */
+    QByteArray m_pendingUniverseValues;
+
+    /** Timer to cap the channels updates to the screen refresh rate */
+    QTimer m_refreshTimer;
+
     /************************************************************************
      * Universe Values
      ************************************************************************/
@@ -102,6 +110,9 @@ protected slots:
      *  Universe at $idx has changed */
     void slotUniverseWritten(quint32 idx, const QByteArray& ua);
 
+    /** Update the channels that changed in the last received frame */
+    void slotRefreshChannels();
+
 signals:
     /** Informed the listeners that a channel value has changed.
      *  This is connected to ContextManager for Scene dump */
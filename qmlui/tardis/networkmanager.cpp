@@ -24,7 +24,11 @@
 
 #include "networkmanager.h"
 #include "networkpacketizer.h"
+#include "inputoutputmap.h"
+#include "mastertimer.h"
 #include "simplecrypt.h"
+#include "universe.h"
+#include "function.h"
 #include "tardis.h"
 #include "doc.h"
 
@@ -33,6 +37,8 @@
 
 #define WORKSPACE_CHUNK_SIZE    8 * 1024
 
+#define CLUSTER_CLOCK_INTERVAL  1000
+
 static const quint64 defaultKey = 0x5131632B4E33744B; // this is "Q1c+N3tK"
 
 NetworkManager::NetworkManager(QObject *parent, Doc *doc)
@@ -44,11 +50,25 @@ NetworkManager::NetworkManager(QObject *parent, Doc *doc)
     , m_serverStarted(false)
     , m_tcpSocket(nullptr)
     , m_clientStatus(Disconnected)
+    , m_clusterClockOffset(0)
 {
     m_hostType = UnknownHostType;
     setHostName(defaultName());
     m_crypt = new SimpleCrypt(defaultKey);
     m_packetizer = new NetworkPacketizer();
+
+    // live actions are batched once per MasterTimer frame
+    m_liveActionsTimer.setSingleShot(true);
+    m_liveActionsTimer.setInterval(MasterTimer::tick());
+    connect(&m_liveActionsTimer, SIGNAL(timeout()), this, SLOT(slotFlushLiveActions()));
+
+    m_clusterClock.start();
+    m_clusterClockTimer.setInterval(CLUSTER_CLOCK_INTERVAL);
+    connect(&m_clusterClockTimer, SIGNAL(timeout()), this, SLOT(slotSendClusterClock()));
+
+    if (m_doc != nullptr)
+        connect(m_doc->masterTimer(), SIGNAL(functionStarted(quint32)),
+                this, SLOT(slotClusterFunctionStarted(quint32)));
 }
 
 NetworkManager::~NetworkManager()
@@ -94,6 +114,36 @@ int NetworkManager::connectionsCount()
 
 void NetworkManager::sendAction(int code, TardisAction action)
 {
+    /* VC live actions are sent in batches */
+    if (code >= Tardis::VCButtonSetPressed && code < Tardis::NetAnnounce)
+    {
+        bool replaced = false;
+
+        if (code == Tardis::VCSliderSetValue)
+        {
+            for (int i = m_liveActions.count() - 1; i >= 0; i--)
+            {
+                if (m_liveActions.at(i).m_action == code && m_liveActions.at(i).m_objID == action.m_objID)
+                {
+                    m_liveActions[i].m_newValue = action.m_newValue;
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+
+        if (replaced == false)
+        {
+            action.m_action = code;
+            m_liveActions.append(action);
+        }
+
+        if (m_liveActionsTimer.isActive() == false)
+            m_liveActionsTimer.start();
+
+        return;
+    }
+
     QByteArray packet;
     m_packetizer->initializePacket(packet, code);
     m_packetizer->addSection(packet, action.m_objID);
@@ -121,6 +171,25 @@ void NetworkManager::sendAction(int code, TardisAction action)
         break;
     }
 
+    sendPacketToHosts(packet);
+}
+
+void NetworkManager::slotFlushLiveActions()
+{
+    while (m_liveActions.isEmpty() == false)
+    {
+        QList<TardisAction> batch = m_liveActions.mid(0, MAX_LIVE_ACTIONS);
+        m_liveActions = m_liveActions.mid(batch.count());
+
+        QByteArray packet;
+        m_packetizer->initializePacket(packet, Tardis::NetLiveActionsBatch);
+        m_packetizer->addSection(packet, QVariant(m_packetizer->encodeLiveActions(batch)));
+        sendPacketToHosts(packet);
+    }
+}
+
+void NetworkManager::sendPacketToHosts(QByteArray &packet)
+{
     if (m_hostType == ServerHostType)
     {
         /* Send packet to all connected clients */
@@ -674,6 +743,52 @@ void NetworkManager::slotProcessTCPPackets()
                 }
             }
             break;
+            case Tardis::NetClusterAssign:
+            {
+                if (m_hostType != ClientHostType || paramsList.isEmpty())
+                    break;
+
+                m_clusterUniverses.clear();
+                for (QString id : paramsList.at(0).toString().split(","))
+                {
+                    if (id.isEmpty() == false)
+                        m_clusterUniverses.append(id.toUInt());
+                }
+
+                qDebug() << "Cluster universes assigned:" << m_clusterUniverses;
+                updateClusterRendering();
+            }
+            break;
+            case Tardis::NetClusterFunction:
+            {
+                if (m_hostType != ClientHostType || paramsList.count() < 4)
+                    break;
+
+                processClusterCommand(paramsList.at(0).toUInt(), paramsList.at(1).toInt(),
+                                      paramsList.at(2).toDouble(), paramsList.at(3).toDouble());
+            }
+            break;
+            case Tardis::NetClusterClock:
+            {
+                if (m_hostType != ClientHostType || paramsList.isEmpty())
+                    break;
+
+                m_clusterClockOffset = paramsList.at(0).toDouble() - double(m_clusterClock.elapsed());
+            }
+            break;
+            case Tardis::NetLiveActionsBatch:
+            {
+                QList<TardisAction> actions;
+                if (paramsList.isEmpty() ||
+                    m_packetizer->decodeLiveActions(paramsList.at(0).toByteArray(), actions) == false)
+                {
+                    qDebug() << "Malformed live actions batch";
+                }
+
+                foreach (TardisAction action, actions)
+                    emit actionReady(action.m_action, action.m_objID, action.m_newValue);
+            }
+            break;
 
             default:
             {
@@ -728,7 +843,232 @@ void NetworkManager::slotHostDisconnected()
     if (m_hostsMap.contains(senderAddress) == true)
     {
         NetworkHost *host = m_hostsMap.take(senderAddress);
+        bool rendering = host->universes.isEmpty() == false;
         delete host;
         emit connectionsCountChanged();
+
+        // take back the universes rendered by this host
+        if (rendering)
+            updateClusterRendering();
+    }
+    else if (m_hostType == ClientHostType && m_clusterUniverses.isEmpty() == false)
+    {
+        m_clusterUniverses.clear();
+        updateClusterRendering();
+    }
+}
+
+/*********************************************************************
+ * Cluster
+ *********************************************************************/
+
+bool NetworkManager::setClientUniverses(QString hostName, QVariantList universes)
+{
+    QHostAddress clientAddress = getHostFromName(hostName);
+    NetworkHost *host = m_hostsMap.value(clientAddress, nullptr);
+
+    if (host == nullptr || clientAddress.isNull() || host->isAuthenticated == false)
+        return false;
+
+    QStringList idList;
+    host->universes.clear();
+
+    for (QVariant uni : universes)
+    {
+        quint32 id = uni.toUInt();
+        if (host->universes.contains(id))
+            continue;
+
+        host->universes.append(id);
+        idList.append(QString::number(id));
+
+        // a universe is rendered by one client only
+        for (NetworkHost *other : m_hostsMap)
+        {
+            if (other != host)
+                other->universes.removeAll(id);
+        }
+    }
+
+    QByteArray packet;
+    m_packetizer->initializePacket(packet, Tardis::NetClusterAssign);
+    m_packetizer->addSection(packet, QVariant(idList.join(",")));
+    sendTCPPacket(host->tcpSocket, packet, m_encryptPackets);
+
+    updateClusterRendering();
+
+    if (clusterActive())
+    {
+        if (m_clusterClockTimer.isActive() == false)
+        {
+            m_clusterClockTimer.start();
+            slotSendClusterClock();
+        }
+    }
+    else
+    {
+        m_clusterClockTimer.stop();
+    }
+
+    return true;
+}
+
+QVariantList NetworkManager::clientUniverses(QString hostName)
+{
+    QVariantList list;
+    NetworkHost *host = m_hostsMap.value(getHostFromName(hostName), nullptr);
+
+    if (host != nullptr)
+    {
+        for (quint32 id : host->universes)
+            list.append(id);
+    }
+
+    return list;
+}
+
+bool NetworkManager::clusterActive() const
+{
+    for (NetworkHost *host : m_hostsMap)
+    {
+        if (host->universes.isEmpty() == false)
+            return true;
+    }
+
+    return false;
+}
+
+void NetworkManager::sendClusterCommand(quint32 id, int command, qreal intensity)
+{
+    QByteArray packet;
+    m_packetizer->initializePacket(packet, Tardis::NetClusterFunction);
+    m_packetizer->addSection(packet, id);
+    m_packetizer->addSection(packet, QVariant(command));
+    m_packetizer->addSection(packet, QVariant(double(intensity)));
+    m_packetizer->addSection(packet, QVariant(double(m_clusterClock.elapsed())));
+
+    for (NetworkHost *host : m_hostsMap)
+    {
+        if (host->universes.isEmpty() == false)
+            sendTCPPacket(host->tcpSocket, packet, m_encryptPackets);
+    }
+}
+
+void NetworkManager::updateClusterRendering()
+{
+    if (m_doc == nullptr)
+        return;
+
+    QList<quint32> remote;
+
+    if (m_hostType == ServerHostType)
+    {
+        for (NetworkHost *host : m_hostsMap)
+            remote.append(host->universes);
+    }
+
+    for (Universe *uni : m_doc->inputOutputMap()->universes())
+    {
+        bool rendered;
+
+        if (m_hostType == ServerHostType)
+            rendered = remote.contains(uni->id()) == false;
+        else
+            rendered = m_clusterUniverses.isEmpty() || m_clusterUniverses.contains(uni->id());
+
+        uni->setRendered(rendered);
+    }
+}
+
+void NetworkManager::processClusterCommand(quint32 id, int command, qreal intensity, double serverTime)
+{
+    Function *function = m_doc->function(id);
+    if (function == nullptr)
+        return;
+
+    switch (command)
+    {
+        case ClusterStart:
+        {
+            // start where the server is, to stay in sync with it
+            double late = qMax(0.0, clusterTime() - serverTime);
+            function->adjustAttribute(intensity, Function::Intensity);
+            function->start(m_doc->masterTimer(), FunctionParent::master(), quint32(late));
+        }
+        break;
+        case ClusterStop:
+            function->stop(FunctionParent::master());
+        break;
+        case ClusterIntensity:
+            function->adjustAttribute(intensity, Function::Intensity);
+        break;
+        default:
+        break;
+    }
+}
+
+double NetworkManager::clusterTime() const
+{
+    return double(m_clusterClock.elapsed()) + m_clusterClockOffset;
+}
+
+void NetworkManager::slotClusterFunctionStarted(quint32 id)
+{
+    if (m_hostType != ServerHostType || clusterActive() == false)
+        return;
+
+    Function *function = m_doc->function(id);
+
+    // children are started by their parent on the clients too
+    if (function == nullptr || function->startedAsChild())
+        return;
+
+    connect(function, SIGNAL(stopped(quint32)),
+            this, SLOT(slotClusterFunctionStopped(quint32)), Qt::UniqueConnection);
+    connect(function, SIGNAL(attributeChanged(int,qreal)),
+            this, SLOT(slotClusterAttributeChanged(int,qreal)), Qt::UniqueConnection);
+
+    sendClusterCommand(id, ClusterStart, function->getAttributeValue(Function::Intensity));
+}
+
+void NetworkManager::slotClusterFunctionStopped(quint32 id)
+{
+    Function *function = qobject_cast<Function *>(sender());
+    if (function != nullptr)
+    {
+        disconnect(function, SIGNAL(stopped(quint32)), this, SLOT(slotClusterFunctionStopped(quint32)));
+        disconnect(function, SIGNAL(attributeChanged(int,qreal)), this, SLOT(slotClusterAttributeChanged(int,qreal)));
+    }
+
+    if (m_hostType == ServerHostType && clusterActive())
+        sendClusterCommand(id, ClusterStop, 0);
+}
+
+void NetworkManager::slotClusterAttributeChanged(int index, qreal fraction)
+{
+    Function *function = qobject_cast<Function *>(sender());
+    if (function == nullptr || index != Function::Intensity)
+        return;
+
+    if (m_hostType == ServerHostType && clusterActive())
+        sendClusterCommand(function->id(), ClusterIntensity, fraction);
+}
+
+void NetworkManager::slotSendClusterClock()
+{
+    if (m_hostType != ServerHostType || clusterActive() == false)
+    {
+        m_clusterClockTimer.stop();
+        return;
+    }
+
+    QByteArray packet;
+    m_packetizer->initializePacket(packet, Tardis::NetClusterClock);
+    m_packetizer->addSection(packet, QVariant(double(m_clusterClock.elapsed())));
+
+    for (NetworkHost *host : m_hostsMap)
+    {
+        if (host->universes.isEmpty() == false)
+            sendTCPPacket(host->tcpSocket, packet, m_encryptPackets);
     }
 }
@@ -26,8 +26,10 @@
 
 #include <QTcpSocket>
 #include <QTcpServer>
+#include <QElapsedTimer>
 #include <QUdpSocket>
 #include <QThread>
+#include <QTimer>
 #include <QHash>
 
 #include "tardis.h"
@@ -44,6 +46,8 @@ typedef struct
     QString hostName;
     /** The TCP socket for unicast client/server communication */
     QTcpSocket *tcpSocket;
+    /** The universes this host renders in cluster mode */
+    QList<quint32> universes;
 } NetworkHost;
 
 class NetworkManager : public QObject
@@ -82,6 +86,10 @@ protected:
     /** Send the content of $packet using the provided $socket */
     bool sendTCPPacket(QTcpSocket *socket, QByteArray &packet, bool encrypt);
 
+    /** Send $packet to every connected client when this is a server,
+     *  or to the server when this is a client */
+    void sendPacketToHosts(QByteArray &packet);
+
 signals:
     void hostNameChanged(QString hostName);
     void connectionsCountChanged();
@@ -94,6 +102,9 @@ protected slots:
     /** Async event raised when unicast packets are received */
     void slotProcessTCPPackets();
 
+    /** Send the VC live actions queued during the last frame in one packet */
+    void slotFlushLiveActions();
+
 private:
     /** Reference to the QLC+ Doc */
     Doc *m_doc;
@@ -117,6 +128,11 @@ private:
      *  according to the QLC+ network protocol */
     NetworkPacketizer* m_packetizer;
 
+    /** VC live actions waiting for the next batch, in arrival order.
+     *  A slider value replaces the pending value of the same slider */
+    QList<TardisAction> m_liveActions;
+    QTimer m_liveActionsTimer;
+
     /*********************************************************************
      * Server
      *********************************************************************/
@@ -196,6 +212,63 @@ private:
     /** Project transfer variables */
     QByteArray m_projectData;
     int m_projectSize;
+
+    /*********************************************************************
+     * Cluster
+     *********************************************************************/
+public:
+    enum ClusterCommand
+    {
+        ClusterStart,
+        ClusterStop,
+        ClusterIntensity
+    };
+
+    /** Assign the $universes a client of this server renders and outputs.
+     *  The server stops rendering the universes assigned to a client,
+     *  and takes them back when the client disconnects */
+    Q_INVOKABLE bool setClientUniverses(QString hostName, QVariantList universes);
+
+    /** Get the universes assigned to the client with the given $hostName */
+    Q_INVOKABLE QVariantList clientUniverses(QString hostName);
+
+protected:
+    /** Return true if any client of this server renders some universes */
+    bool clusterActive() const;
+
+    /** Send a $command about the Function with the given $id to every client */
+    void sendClusterCommand(quint32 id, int command, qreal intensity);
+
+    /** Enable the rendering of the universes this host is in charge of */
+    void updateClusterRendering();
+
+    /** Execute a cluster $command received from the server */
+    void processClusterCommand(quint32 id, int command, qreal intensity, double serverTime);
+
+    /** Return the server cluster clock, estimated from the last clock packet */
+    double clusterTime() const;
+
+protected slots:
+    void slotClusterFunctionStarted(quint32 id);
+    void slotClusterFunctionStopped(quint32 id);
+    void slotClusterAttributeChanged(int index, qreal fraction);
+
+    /** Send the server cluster clock to every client */
+    void slotSendClusterClock();
+
+private:
+    /** The clock shared by the hosts of a cluster, started with this host */
+    QElapsedTimer m_clusterClock;
+
+    /** The difference between the server and the local cluster clocks, in ms */
+    double m_clusterClockOffset;
+
+    /** Timer to send the cluster clock periodically */
+    QTimer m_clusterClockTimer;
+
+    /** The universes assigned by the server to this client.
+     *  An empty list means that this client renders every universe */
+    QList<quint32> m_clusterUniverses;
 };
 
 #endif /* NETWORKMANAGER_H */
@@ -433,3 +433,83 @@ int NetworkPacketizer::decodePacket(QByteArray &packet, int &opCode, QVariantLis
 
     return HEADER_LENGTH + sections_length;
 }
+
+QByteArray NetworkPacketizer::encodeLiveActions(const QList<TardisAction> &actions)
+{
+    QByteArray data;
+    data.reserve(actions.count() * 9);
+
+    foreach (TardisAction action, actions)
+    {
+        data.append((char)(action.m_action - Tardis::VCButtonSetPressed));
+        data.append((char)(action.m_objID >> 24));    // MSB3
+        data.append((char)(action.m_objID >> 16));    // MSB2
+        data.append((char)(action.m_objID >> 8));     // MSB1
+        data.append((char)(action.m_objID & 0x00FF)); // LSB
+
+        switch (action.m_action)
+        {
+            case Tardis::VCButtonSetPressed:
+                data.append(action.m_newValue.toBool() ? (char)0x01 : (char)0x00);
+            break;
+            case Tardis::VCSliderSetValue:
+            {
+                int intVal = action.m_newValue.toInt();
+                data.append((char)(intVal >> 24));    // MSB3
+                data.append((char)(intVal >> 16));    // MSB2
+                data.append((char)(intVal >> 8));     // MSB1
+                data.append((char)(intVal & 0x00FF)); // LSB
+            }
+            break;
+            default:
+                qDebug() << "Unsupported live action" << action.m_action << "Implement me";
+                data.chop(5);
+            break;
+        }
+    }
+
+    return data;
+}
+
+bool NetworkPacketizer::decodeLiveActions(const QByteArray &data, QList<TardisAction> &actions)
+{
+    int bytes_read = 0;
+
+    while (bytes_read < data.length())
+    {
+        if (data.length() - bytes_read < 6)
+            return false;
+
+        TardisAction action;
+        action.m_action = Tardis::VCButtonSetPressed + (quint8)data.at(bytes_read++);
+        action.m_timestamp = 0;
+        action.m_objID = ((quint8)data.at(bytes_read) << 24) + ((quint8)data.at(bytes_read + 1) << 16) +
+                         ((quint8)data.at(bytes_read + 2) << 8) + (quint8)data.at(bytes_read + 3);
+        bytes_read += 4;
+
+        switch (action.m_action)
+        {
+            case Tardis::VCButtonSetPressed:
+                action.m_newValue = QVariant((bool)data.at(bytes_read++));
+            break;
+            case Tardis::VCSliderSetValue:
+            {
+                if (data.length() - bytes_read < 4)
+                    return false;
+
+                int intVal = ((quint8)data.at(bytes_read) << 24) + ((quint8)data.at(bytes_read + 1) << 16) +
+                             ((quint8)data.at(bytes_read + 2) << 8) + (quint8)data.at(bytes_read + 3);
+                bytes_read += 4;
+                action.m_newValue = QVariant(intVal);
+            }
+            break;
+            default:
+                qDebug() << "Unknown live action" << action.m_action;
+                return false;
+        }
+
+        actions.append(action);
+    }
+
+    return true;
+}
@@ -23,8 +23,13 @@
 #include <QByteArray>
 #include <QVariant>
 
+#include "tardis.h"
+
 #define HEADER_LENGTH   7
 
+/** The maximum number of live actions encoded in one packet */
+#define MAX_LIVE_ACTIONS    4096
+
 class SimpleCrypt;
 
 class NetworkPacketizer
@@ -56,6 +61,16 @@ public:
     QByteArray encryptPacket(QByteArray &packet, SimpleCrypt *crypter);
     int decodePacket(QByteArray &packet, int &opCode, QVariantList &sections, SimpleCrypt *decrypter);
 
+    /** Encode a list of VC live actions in a compact binary form. Each action
+     *  is the code offset from VCButtonSetPressed (1 byte), the widget ID
+     *  (4 bytes) and the value, which has a fixed size for each code:
+     *  1 byte for a button state, 4 bytes for a slider value */
+    QByteArray encodeLiveActions(const QList<TardisAction> &actions);
+
+    /** Decode the live actions encoded by encodeLiveActions.
+     *  Returns false if $data is malformed */
+    bool decodeLiveActions(const QByteArray &data, QList<TardisAction> &actions);
+
 private:
 
 };
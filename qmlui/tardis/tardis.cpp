@@ -52,6 +52,10 @@
 #define TARDIS_ACTION_INTERTIME     150
 /* The maximum number of action a Tardis can hold */
 #define TARDIS_MAX_ACTIONS_NUMBER   100
+/* The maximum memory in bytes the history can use */
+#define TARDIS_MAX_HISTORY_MEMORY   (64 * 1024 * 1024)
+/* The size in bytes above which a value is stored compressed */
+#define TARDIS_PACK_THRESHOLD       1024
 
 Tardis* Tardis::s_instance = nullptr;
 
@@ -71,12 +75,14 @@ Tardis::Tardis(QQuickView *view, Doc *doc, NetworkManager *netMgr,
     , m_virtualConsole(vc)
     , m_historyIndex(-1)
     , m_historyCount(0)
+    , m_historyMemory(0)
     , m_busy(false)
 {
     Q_ASSERT(s_instance == nullptr);
     s_instance = this;
 
     qRegisterMetaType<TardisAction>();
+    qRegisterMetaType<TardisPackedValue>();
 
     m_uptime.start();
 
@@ -143,6 +149,8 @@ void Tardis::undoAction()
         if (refTimestamp - action.m_timestamp > TARDIS_ACTION_INTERTIME)
             break;
 
+        unpackAction(action);
+
         qDebug() << "Undo action" << actionToString(action.m_action);
 
         m_historyIndex--;
@@ -177,6 +185,7 @@ void Tardis::redoAction()
         m_historyIndex++;
 
         TardisAction action = m_history.at(m_historyIndex);
+        unpackAction(action);
         qDebug() << "Redo action" << actionToString(action.m_action);
 
         int code = processAction(action, false);
@@ -200,6 +209,141 @@ void Tardis::redoAction()
 void Tardis::resetHistory()
 {
     m_history.clear();
+    m_historyIndex = -1;
+    m_historyCount = 0;
+    m_historyMemory = 0;
+}
+
+void Tardis::packAction(TardisAction &action)
+{
+    QVariant *values[2] = { &action.m_newValue, &action.m_oldValue };
+    QByteArray raw[2];
+
+    for (int i = 0; i < 2; i++)
+    {
+        int type = values[i]->userType();
+        if (type == QMetaType::QByteArray)
+            raw[i] = values[i]->toByteArray();
+        else if (type == QMetaType::QString)
+            raw[i] = values[i]->toString().toUtf8();
+        else
+            continue;
+
+        if (raw[i].size() < TARDIS_PACK_THRESHOLD)
+        {
+            raw[i].clear();
+            continue;
+        }
+
+        TardisPackedValue packed;
+        packed.m_type = type;
+        packed.m_size = raw[i].size();
+        packed.m_prefix = -1;
+        packed.m_suffix = -1;
+
+        /* Store an old value as the difference from the new one */
+        if (i == 1 && raw[0].isEmpty() == false)
+        {
+            const QByteArray &newData = raw[0];
+            const QByteArray &oldData = raw[1];
+            int maxCommon = qMin(newData.size(), oldData.size());
+            int prefix = 0, suffix = 0;
+
+            while (prefix < maxCommon && newData.at(prefix) == oldData.at(prefix))
+                prefix++;
+            while (suffix < maxCommon - prefix &&
+                   newData.at(newData.size() - 1 - suffix) == oldData.at(oldData.size() - 1 - suffix))
+                suffix++;
+
+            packed.m_prefix = prefix;
+            packed.m_suffix = suffix;
+            packed.m_data = qCompress(oldData.mid(prefix, oldData.size() - prefix - suffix));
+        }
+        else
+        {
+            packed.m_data = qCompress(raw[i]);
+        }
+
+        values[i]->setValue(packed);
+    }
+}
+
+void Tardis::unpackAction(TardisAction &action)
+{
+    QByteArray newData;
+    QVariant *values[2] = { &action.m_newValue, &action.m_oldValue };
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (values[i]->userType() != qMetaTypeId<TardisPackedValue>())
+            continue;
+
+        TardisPackedValue packed = values[i]->value<TardisPackedValue>();
+        QByteArray data = qUncompress(packed.m_data);
+
+        if (packed.m_prefix >= 0)
+            data = newData.left(packed.m_prefix) + data + newData.right(packed.m_suffix);
+        else if (i == 0)
+            newData = data;
+
+        if (packed.m_type == QMetaType::QString)
+            *values[i] = QVariant(QString::fromUtf8(data));
+        else
+            *values[i] = QVariant(data);
+    }
+}
+
+bool Tardis::valueMatches(const QVariant &value, const QVariant &stored)
+{
+    if (stored.userType() != qMetaTypeId<TardisPackedValue>())
+        return value == stored;
+
+    TardisPackedValue packed = stored.value<TardisPackedValue>();
+    QByteArray raw;
+
+    if (value.userType() != packed.m_type)
+        return false;
+
+    raw = packed.m_type == QMetaType::QString ? value.toString().toUtf8() : value.toByteArray();
+    if (raw.size() != packed.m_size)
+        return false;
+
+    // only new values are compared, and they are never stored as differences
+    return packed.m_prefix < 0 && raw == qUncompress(packed.m_data);
+}
+
+int Tardis::actionSize(const TardisAction &action) const
+{
+    int size = sizeof(TardisAction);
+    const QVariant *values[2] = { &action.m_newValue, &action.m_oldValue };
+
+    for (int i = 0; i < 2; i++)
+    {
+        int type = values[i]->userType();
+        if (type == qMetaTypeId<TardisPackedValue>())
+            size += sizeof(TardisPackedValue) + values[i]->value<TardisPackedValue>().m_data.size();
+        else if (type == QMetaType::QByteArray)
+            size += values[i]->toByteArray().size();
+        else if (type == QMetaType::QString)
+            size += values[i]->toString().size() * int(sizeof(QChar));
+    }
+
+    return size;
+}
+
+void Tardis::removeFirstBatch()
+{
+    if (m_history.isEmpty())
+        return;
+
+    quint64 refTimestamp = m_history.first().m_timestamp;
+    while (m_history.isEmpty() == false &&
+           m_history.first().m_timestamp - refTimestamp < TARDIS_ACTION_INTERTIME)
+    {
+        m_historyMemory -= actionSize(m_history.first());
+        m_history.removeFirst();
+    }
+    m_historyCount--;
 }
 
 void Tardis::forwardActionToNetwork(int code, TardisAction &action)
@@ -258,6 +402,7 @@ void Tardis::run()
                     refTimestamp = m_history.last().m_timestamp;
                     m_historyCount--;
                 }
+                m_historyMemory -= actionSize(m_history.last());
                 m_history.removeLast();
 
             }
@@ -273,11 +418,17 @@ void Tardis::run()
 
                 if (action.m_action == m_history.at(i).m_action &&
                     action.m_objID == m_history.at(i).m_objID &&
-                    action.m_oldValue == m_history.at(i).m_newValue)
+                    valueMatches(action.m_oldValue, m_history.at(i).m_newValue))
                 {
-                    qDebug() << "Found match at" << i << action.m_oldValue << m_history.at(i).m_newValue;
-                    action.m_oldValue = m_history.at(i).m_oldValue;
-                    m_history.replace(i, action);
+                    qDebug() << "Found match at" << i;
+                    /* Merge the actions, keeping the oldest value */
+                    TardisAction matched = m_history.at(i);
+                    unpackAction(matched);
+                    action.m_oldValue = matched.m_oldValue;
+                    TardisAction merged = action;
+                    packAction(merged);
+                    m_historyMemory += actionSize(merged) - actionSize(m_history.at(i));
+                    m_history.replace(i, merged);
                     match = true;
                     break;
                 }
@@ -288,17 +439,25 @@ void Tardis::run()
             m_historyCount++;
 
         if (match == false)
-            m_history.append(action);
+        {
+            /* The unpacked action is forwarded to the network */
+            TardisAction packedAction = action;
+            packAction(packedAction);
+            m_historyMemory += actionSize(packedAction);
+            m_history.append(packedAction);
+        }
 
         /* So long and thanks for all the fish */
         if (m_historyCount > TARDIS_MAX_ACTIONS_NUMBER)
         {
-            qint64 refTimestamp = m_history.first().m_timestamp;
-            while (m_history.first().m_timestamp - refTimestamp < TARDIS_ACTION_INTERTIME)
-                m_history.removeFirst();
+            removeFirstBatch();
             m_historyCount = TARDIS_MAX_ACTIONS_NUMBER;
         }
 
+        /* Keep at least the last batch, whatever its size */
+        while (m_historyMemory > TARDIS_MAX_HISTORY_MEMORY && m_historyCount > 1)
+            removeFirstBatch();
+
         m_historyIndex = m_history.count() - 1;
 
         qDebug("Got action: 0x%02X, history length: %d (%d)", action.m_action, m_historyCount, m_history.count());
@@ -48,6 +48,26 @@ typedef struct
 
 Q_DECLARE_METATYPE(TardisAction)
 
+/** A large QByteArray or QString value, stored compressed in the history.
+ *  An old value can also be stored as the difference from the new value
+ *  of the same action: only the part between the bytes they have in
+ *  common at the start and at the end is kept */
+typedef struct
+{
+    /** The original value type, QMetaType::QByteArray or QMetaType::QString */
+    int m_type;
+    /** The original value size, in bytes */
+    int m_size;
+    /** The bytes in common with the new value, at the start and at the end.
+     *  -1 when m_data holds the whole value */
+    int m_prefix;
+    int m_suffix;
+    /** The compressed value, or its differing part */
+    QByteArray m_data;
+} TardisPackedValue;
+
+Q_DECLARE_METATYPE(TardisPackedValue)
+
 typedef QPair<quint32, uint> UIntPair;
 Q_DECLARE_METATYPE(UIntPair)
 
@@ -187,7 +207,11 @@ public:
         NetAuthenticationReply,
         NetPoll,
         NetPollReply,
-        NetProjectTransfer
+        NetProjectTransfer,
+        NetLiveActionsBatch,
+        NetClusterAssign,
+        NetClusterFunction,
+        NetClusterClock
     };
 
     Q_ENUM(ActionCodes)
@@ -230,6 +254,21 @@ protected:
     QString actionToString(int action);
     bool processBufferedAction(int action, quint32 objID, QVariant &value);
 
+    /** Compress the large values of $action, to store it in the history */
+    void packAction(TardisAction &action);
+
+    /** Restore the original values of an $action taken from the history */
+    void unpackAction(TardisAction &action);
+
+    /** Check if a $value equals a $stored value of the history */
+    bool valueMatches(const QVariant &value, const QVariant &stored);
+
+    /** Return the estimated memory used by an action of the history */
+    int actionSize(const TardisAction &action) const;
+
+    /** Drop the oldest batch of actions from the history */
+    void removeFirstBatch();
+
 protected slots:
     void slotProcessNetworkAction(int code, quint32 id, QVariant value);
 
@@ -279,6 +318,9 @@ private:
     /** Count the actions (or batch of actions) recorded */
     int m_historyCount;
 
+    /** The estimated memory used by the history, in bytes */
+    qint64 m_historyMemory;
+
     /** Flag to prevent actions looping */
     bool m_busy;
 };
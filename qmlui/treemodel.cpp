@@ -158,24 +158,19 @@ TreeModelItem *TreeModel::addItem(QString label, QVariantList data, QString path
             m_itemsPathMap[pathList.at(0)] = item;
         }
 
-        if (pathList.count() == 1)
-        {
-            if (item->addChild(label, data, m_sorting, "", flags) == true)
-            {
-                connect(item->children(), SIGNAL(roleChanged(TreeModelItem*,int,const QVariant&)),
-                        this, SLOT(slotRoleChanged(TreeModelItem*,int,const QVariant&)));
-                qDebug() << "Tree" << this << "connected to tree" << item->children();
-            }
-        }
-        else
+        QString newPath;
+        if (pathList.count() > 1)
+            newPath = path.mid(path.indexOf(TreeModel::separator()) + 1);
+
+        if (item->addChild(label, data, m_sorting, newPath, flags) == true)
         {
-            QString newPath = path.mid(path.indexOf(TreeModel::separator()) + 1);
-            if (item->addChild(label, data, m_sorting, newPath, flags) == true)
-            {
-                connect(item->children(), SIGNAL(roleChanged(TreeModelItem*,int,const QVariant&)),
-                        this, SLOT(slotRoleChanged(TreeModelItem*,int,const QVariant&)));
-                qDebug() << "Tree" << this << "connected to tree" << item->children();
-            }
+            connect(item->children(), SIGNAL(roleChanged(TreeModelItem*,int,const QVariant&)),
+                    this, SLOT(slotRoleChanged(TreeModelItem*,int,const QVariant&)));
+            qDebug() << "Tree" << this << "connected to tree" << item->children();
+
+            // let the views know that the node has now children
+            QModelIndex index = createIndex(m_items.indexOf(item), 0);
+            emit dataChanged(index, index, QVector<int>() << HasChildrenRole << ChildrenModel);
         }
     }
 
@@ -306,6 +301,8 @@ void TreeModel::setPathData(QString path, QVariantList data)
         if (pathList.count() == 1)
         {
             item->setData(data);
+            QModelIndex index = createIndex(m_items.indexOf(item), 0);
+            emit dataChanged(index, index);
         }
         else if (item->hasChildren())
         {
@@ -93,16 +93,45 @@ void VCFrame::render(QQuickView *view, QQuickItem *parent)
     m_item->setParentItem(parent);
     m_item->setProperty("frameObj", QVariant::fromValue(this));
 
-    if (m_pagesMap.count() > 0)
-    {
-        QString chName = QString("frameDropArea%1").arg(id());
-        QQuickItem *childrenArea = qobject_cast<QQuickItem*>(m_item->findChild<QObject *>(chName));
+    m_renderedPages.clear();
 
-        foreach(VCWidget *child, m_pagesMap.keys())
-            child->render(view, childrenArea);
+    /* in multi page mode, the other pages are rendered when displayed */
+    if (m_multiPageMode)
+        renderPageChildren(view, m_currentPage);
+    else
+        renderAllChildren(view);
+}
+
+void VCFrame::renderPageChildren(QQuickView *view, int page)
+{
+    if (view == nullptr || m_item == nullptr || m_renderedPages.contains(page))
+        return;
+
+    m_renderedPages.insert(page);
+
+    if (m_pagesMap.isEmpty())
+        return;
+
+    QString chName = QString("frameDropArea%1").arg(id());
+    QQuickItem *childrenArea = qobject_cast<QQuickItem*>(m_item->findChild<QObject *>(chName));
+
+    QMapIterator <VCWidget*, int> it(m_pagesMap);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        if (it.value() == page)
+            it.key()->render(view, childrenArea);
     }
 }
 
+void VCFrame::renderAllChildren(QQuickView *view)
+{
+    renderPageChildren(view, m_currentPage);
+
+    foreach (int page, m_pagesMap.values())
+        renderPageChildren(view, page);
+}
+
 QString VCFrame::propertiesResource() const
 {
     /** If this frame is a top level frame, then it means
@@ -669,6 +698,21 @@ void VCFrame::setMultiPageMode(bool multiPageMode)
         return;
 
     m_multiPageMode = multiPageMode;
+
+    if (m_item != nullptr)
+    {
+        if (multiPageMode)
+        {
+            /* all the children are already rendered at this point */
+            foreach (int page, m_pagesMap.values())
+                m_renderedPages.insert(page);
+        }
+        else
+        {
+            renderAllChildren(m_vc->view());
+        }
+    }
+
     emit multiPageModeChanged(multiPageMode);
 }
 
@@ -700,6 +744,9 @@ void VCFrame::setCurrentPage(int pageNum)
 
     m_currentPage = pageNum;
 
+    /* The feedback of the whole page goes out as one batch */
+    m_doc->inputOutputMap()->beginFeedbackBatch();
+
     QMapIterator <VCWidget*, int> it(m_pagesMap);
     while (it.hasNext() == true)
     {
@@ -718,6 +765,12 @@ void VCFrame::setCurrentPage(int pageNum)
             widget->setVisible(false);
         }
     }
+
+    if (m_item != nullptr)
+        renderPageChildren(m_vc->view(), m_currentPage);
+
+    m_doc->inputOutputMap()->endFeedbackBatch();
+
     setDocModified();
     emit currentPageChanged(m_currentPage);
 }
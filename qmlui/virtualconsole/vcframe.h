@@ -20,6 +20,8 @@
 #ifndef VCFRAME_H
 #define VCFRAME_H
 
+#include <QSet>
+
 #include "vcwidget.h"
 
 #define KXMLQLCVCFrame "Frame"
@@ -80,9 +82,19 @@ protected:
     /** @reimp */
     bool copyFrom(const VCWidget* widget);
 
+    /** Render the children of @page into this frame item. Children of the
+     *  pages never displayed are not rendered, but they keep processing
+     *  their input and feedback like any other widget */
+    void renderPageChildren(QQuickView *view, int page);
+
+    /** Render the children of the pages not rendered yet */
+    void renderAllChildren(QQuickView *view);
+
 protected:
     /** Reference to the Virtual Console, used to add new widgets */
     VirtualConsole *m_vc;
+    /** The pages whose children have been rendered into the frame item */
+    QSet <int> m_renderedPages;
 
     /*********************************************************************
      * Children
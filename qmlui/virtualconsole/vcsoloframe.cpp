@@ -47,20 +47,19 @@ void VCSoloFrame::render(QQuickView *view, QQuickItem *parent)
         return;
     }
 
-    QQuickItem *item = qobject_cast<QQuickItem*>(component->create());
+    m_item = qobject_cast<QQuickItem*>(component->create());
 
-    item->setParentItem(parent);
-    item->setProperty("isSolo", true);
-    item->setProperty("frameObj", QVariant::fromValue(this));
+    m_item->setParentItem(parent);
+    m_item->setProperty("isSolo", true);
+    m_item->setProperty("frameObj", QVariant::fromValue(this));
 
-    if (m_pagesMap.count() > 0)
-    {
-        QString chName = QString("frameDropArea%1").arg(id());
-        QQuickItem *childrenArea = qobject_cast<QQuickItem*>(item->findChild<QObject *>(chName));
+    m_renderedPages.clear();
 
-        foreach(VCWidget *child, m_pagesMap.keys())
-            child->render(view, childrenArea);
-    }
+    /* in multi page mode, the other pages are rendered when displayed */
+    if (m_multiPageMode)
+        renderPageChildren(view, m_currentPage);
+    else
+        renderAllChildren(view);
 }
 
 VCWidget *VCSoloFrame::createCopy(VCWidget *parent)
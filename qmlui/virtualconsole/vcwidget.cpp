@@ -746,7 +746,7 @@ QVariantList VCWidget::inputSourcesList()
         InputPatch *ip = m_doc->inputOutputMap()->inputPatch(source->universe());
         if (ip != nullptr && ip->profile() != nullptr)
         {
-            QLCInputChannel *ich = ip->profile()->channel(source->channel());
+            QLCInputChannel *ich = ip->profileChannel(source->channel());
             if (ich != nullptr && ich->type() == QLCInputChannel::Button)
             {
                 min = ich->lowerValue();
@@ -840,13 +840,9 @@ void VCWidget::sendFeedback(int value, quint8 id, SourceValueType type)
         InputPatch *ip = m_doc->inputOutputMap()->inputPatch(source->universe());
         if (ip != nullptr)
         {
-            QLCInputProfile* profile = ip->profile();
-            if (profile != nullptr)
-            {
-                QLCInputChannel* ich = profile->channel(source->channel());
-                if (ich != nullptr)
-                    chName = ich->name();
-            }
+            QLCInputChannel* ich = ip->profileChannel(source->channel());
+            if (ich != nullptr)
+                chName = ich->name();
         }
         m_doc->inputOutputMap()->sendFeedBack(source->universe(), source->channel(), value, chName);
     }
@@ -27,6 +27,7 @@ var testAlgo;
     algo.apiVersion = 2;
     algo.name = "Fill Unfill";
     algo.author = "Massimo Callegari";
+    algo.deterministic = true;
 
     algo.orientation = 0;
     algo.properties = new Array();
@@ -28,6 +28,7 @@ var testAlgo;
     algo.name = "Gradient";
     algo.author = "Massimo Callegari";
     algo.acceptColors = 0;
+    algo.deterministic = true;
     algo.properties = new Array();
     algo.presetIndex = 0;
     algo.properties.push("name:presetIndex|type:list|display:Preset|values:Rainbow,Sunset,Abstract,Ocean|write:setPreset|read:getPreset");
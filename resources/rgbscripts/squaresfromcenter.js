@@ -28,6 +28,7 @@ var testAlgo;
         algo.name = "Squares From Center";
         algo.author = "David Garyga";
         algo.acceptColors = 2;
+        algo.deterministic = true;
         algo.properties = new Array();
         algo.fillSquares = 0;
         algo.properties.push("name:fillSquares|type:list|display:Fill squares|values:No,Yes|write:setFill|read:getFill");
@@ -433,13 +433,7 @@ void AddFixture::updateMaximumAmount()
 bool AddFixture::checkAddressAvailability(int value, int channels)
 {
     qDebug() << "Check availability for address: " << value;
-    for (int i = 0; i < channels; i++)
-    {
-        quint32 fid = m_doc->fixtureForAddress(value + i);
-        if (fid != Fixture::invalidId() && fid != m_fixtureID)
-            return false;
-    }
-    return true;
+    return m_doc->isAddressRangeAvailable(value, channels, m_fixtureID);
 }
 
 /*****************************************************************************
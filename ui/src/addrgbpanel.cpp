@@ -67,15 +67,11 @@ bool AddRGBPanel::checkAddressAvailability()
 
     qDebug() << "Check availability for address: " << startAddress;
 
-    for (int i = 0; i < channels; i++)
+    if (m_doc->isAddressRangeAvailable(startAddress, channels) == false)
     {
-        quint32 fid = m_doc->fixtureForAddress(startAddress + i);
-        if (fid != Fixture::invalidId())
-        {
-            m_addrErrorLabel->show();
-            okBtn->setEnabled(false);
-            return false;
-        }
+        m_addrErrorLabel->show();
+        okBtn->setEnabled(false);
+        return false;
     }
     m_addrErrorLabel->hide();
     okBtn->setEnabled(true);
@@ -31,6 +31,12 @@
   #include <windows.h>
 #endif
 
+#if defined(Q_OS_UNIX)
+  #include <sys/socket.h>
+  #include <signal.h>
+  #include <unistd.h>
+#endif
+
 #include "functionliveeditdialog.h"
 #include "inputoutputmanager.h"
 #include "functionselection.h"
@@ -39,13 +45,17 @@
 #include "virtualconsole.h"
 #include "fixturemanager.h"
 #include "dmxdumpfactory.h"
+#include "dmxrecording.h"
+#include "dmxrecorder.h"
 #include "showmanager.h"
+#include "ticktrace.h"
 #include "mastertimer.h"
 #include "addresstool.h"
 #include "simpledesk.h"
 #include "docbrowser.h"
 #include "aboutbox.h"
 #include "monitor.h"
+#include "workspacewriter.h"
 #include "vcframe.h"
 #include "app.h"
 #include "doc.h"
@@ -53,6 +63,8 @@
 #include "qlcfixturedefcache.h"
 #include "audioplugincache.h"
 #include "rgbscriptscache.h"
+#include "workspacecache.h"
+#include "loadgovernor.h"
 #include "qlcfixturedef.h"
 #include "qlcconfig.h"
 #include "qlcfile.h"
@@ -78,6 +90,8 @@ extern void qt_set_sequence_auto_mnemonic(bool b);
 #define SETTINGS_GEOMETRY "workspace/geometry"
 #define SETTINGS_WORKINGPATH "workspace/workingpath"
 #define SETTINGS_RECENTFILE "workspace/recent"
+#define SETTINGS_BINARYCACHE "workspace/binarycache"
+#define SETTINGS_AUTOSAVE "workspace/autosave"
 #define KXMLQLCWorkspaceWindow "CurrentWindow"
 
 #define MAX_RECENT_FILES    10
@@ -110,6 +124,8 @@ App::App()
     , m_controlBlackoutAction(NULL)
     , m_controlPanicAction(NULL)
     , m_dumpDmxAction(NULL)
+    , m_recordDmxAction(NULL)
+    , m_traceTicksAction(NULL)
     , m_liveEditAction(NULL)
     , m_liveEditVirtualConsoleAction(NULL)
 
@@ -125,6 +141,11 @@ App::App()
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     , m_videoProvider(NULL)
 #endif
+    , m_traceSignalNotifier(NULL)
+    , m_workspaceWriter(NULL)
+    , m_autosaveWriter(NULL)
+    , m_autosaveTimer(NULL)
+    , m_autosaveModified(false)
 {
     QCoreApplication::setOrganizationName("qlcplus");
     QCoreApplication::setOrganizationDomain("sf.net");
@@ -269,6 +290,21 @@ void App::init()
 
     // The engine object
     initDoc();
+
+    // The workspace is written to disk without blocking the UI
+    m_workspaceWriter = new WorkspaceWriter(this);
+    connect(m_workspaceWriter, SIGNAL(finished()), this, SLOT(slotWorkspaceWritten()));
+    m_autosaveWriter = new WorkspaceWriter(this);
+
+    /* Periodic autosave, in minutes. Disabled by default */
+    int autosave = settings.value(SETTINGS_AUTOSAVE, 0).toInt();
+    if (autosave > 0)
+    {
+        m_autosaveTimer = new QTimer(this);
+        m_autosaveTimer->setInterval(autosave * 60000);
+        connect(m_autosaveTimer, SIGNAL(timeout()), this, SLOT(slotAutosave()));
+        m_autosaveTimer->start();
+    }
     // Main view actions
     initActions();
     // Main tool bar
@@ -380,7 +416,14 @@ void App::closeEvent(QCloseEvent* e)
         if( saveModifiedDoc(tr("Close"), tr("Do you wish to save the current workspace " \
                                             "before closing the application?")) == true)
         {
-            e->accept();
+            /* Don't quit before the workspace is on disk. If the write
+               failed, slotWorkspaceWritten() reports it */
+            bool writing = m_workspaceWriter->isRunning();
+            m_workspaceWriter->wait();
+            if (writing && m_workspaceWriter->error() != QFile::NoError)
+                e->ignore();
+            else
+                e->accept();
         }
         else
         {
@@ -474,6 +517,9 @@ void App::initDoc()
 #ifdef DEBUG_SPEED
     speedTime.start();
 #endif
+    /* Keep an index of the definitions, to avoid reading them all at startup */
+    m_doc->fixtureDefCache()->setIndexFile(QLCFixtureDefCache::defaultIndexFile());
+
     /* Load user fixtures first so that they override system fixtures */
     m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
     m_doc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
@@ -511,6 +557,7 @@ void App::initDoc()
 
     m_doc->inputOutputMap()->startUniverses();
     m_doc->masterTimer()->start();
+    m_doc->loadGovernor()->start();
 }
 
 void App::slotDocModified(bool state)
@@ -523,9 +570,14 @@ void App::slotDocModified(bool state)
         caption += tr(" - New Workspace");
 
     if (state == true)
+    {
         setWindowTitle(caption + QString(" *"));
+        m_autosaveModified = true;
+    }
     else
+    {
         setWindowTitle(caption);
+    }
 }
 
 void App::slotUniverseWritten(quint32 idx, const QByteArray &ua)
@@ -694,6 +746,14 @@ void App::initActions()
     m_dumpDmxAction->setShortcut(QKeySequence(tr("CTRL+D", "Control|Dump DMX")));
     connect(m_dumpDmxAction, SIGNAL(triggered()), this, SLOT(slotDumpDmxIntoFunction()));
 
+    m_recordDmxAction = new QAction(QIcon(":/record.png"), tr("Record DMX into a function"), this);
+    m_recordDmxAction->setCheckable(true);
+    connect(m_recordDmxAction, SIGNAL(triggered(bool)), this, SLOT(slotRecordDmx(bool)));
+
+    m_traceTicksAction = new QAction(QIcon(":/speed.png"), tr("Trace the engine timing"), this);
+    m_traceTicksAction->setCheckable(true);
+    connect(m_traceTicksAction, SIGNAL(triggered(bool)), this, SLOT(slotTraceTicks(bool)));
+
     m_controlPanicAction = new QAction(QIcon(":/panic.png"), tr("Stop ALL functions!"), this);
     m_controlPanicAction->setShortcut(QKeySequence("CTRL+SHIFT+ESC"));
     connect(m_controlPanicAction, SIGNAL(triggered(bool)), this, SLOT(slotControlPanic()));
@@ -769,6 +829,8 @@ void App::initToolBar()
     widget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     m_toolbar->addWidget(widget);
     m_toolbar->addAction(m_dumpDmxAction);
+    m_toolbar->addAction(m_recordDmxAction);
+    m_toolbar->addAction(m_traceTicksAction);
     m_toolbar->addAction(m_liveEditAction);
     m_toolbar->addAction(m_liveEditVirtualConsoleAction);
     m_toolbar->addSeparator();
@@ -956,7 +1018,7 @@ QFile::FileError App::slotFileOpen()
 
     /* Append file filters to the dialog */
     QStringList filters;
-    filters << tr("Workspaces (*%1)").arg(KExtWorkspace);
+    filters << tr("Workspaces (*%1 *%2)").arg(KExtWorkspace).arg(KExtCompressedWorkspace);
 #if defined(WIN32) || defined(Q_OS_WIN)
     filters << tr("All Files (*.*)");
 #else
@@ -1019,9 +1081,14 @@ QFile::FileError App::slotFileSave()
 
     /* Attempt to save with the existing name. Fall back to Save As. */
     if (fileName().isEmpty() == true)
+    {
         error = slotFileSaveAs();
+    }
     else
-        error = saveXML(fileName());
+    {
+        saveXMLInBackground(fileName());
+        error = QFile::NoError;
+    }
 
     handleFileError(error);
     return error;
@@ -1040,12 +1107,15 @@ QFile::FileError App::slotFileSaveAs()
     /* Append file filters to the dialog */
     QStringList filters;
     filters << tr("Workspaces (*%1)").arg(KExtWorkspace);
+    filters << tr("Compressed Workspaces (*%1)").arg(KExtCompressedWorkspace);
 #if defined(WIN32) || defined(Q_OS_WIN)
     filters << tr("All Files (*.*)");
 #else
     filters << tr("All Files (*)");
 #endif
     dialog.setNameFilters(filters);
+    if (QLCFile::isCompressedWorkspace(fileName()))
+        dialog.selectNameFilter(filters.at(1));
 
     /* Append useful URLs to the dialog */
     QList <QUrl> sidebar;
@@ -1061,20 +1131,26 @@ QFile::FileError App::slotFileSaveAs()
     if (fn.isEmpty() == true)
         return QFile::NoError;
 
-    /* Always use the workspace suffix */
-    if (fn.right(4) != KExtWorkspace)
+    /* Always use a workspace suffix */
+    if (dialog.selectedNameFilter() == filters.at(1))
+    {
+        if (QLCFile::isCompressedWorkspace(fn) == false)
+            fn += KExtCompressedWorkspace;
+    }
+    else if (fn.right(4) != KExtWorkspace && QLCFile::isCompressedWorkspace(fn) == false)
+    {
         fn += KExtWorkspace;
+    }
 
     /* Set the workspace path before saving the new XML. In this way local files
        can be loaded even if the workspace file will be moved */
     m_doc->setWorkspacePath(QFileInfo(fn).absolutePath());
 
     /* Save the document and set workspace name */
-    QFile::FileError error = saveXML(fn);
-    handleFileError(error);
+    saveXMLInBackground(fn);
 
     updateFileOpenMenu(fn);
-    return error;
+    return QFile::NoError;
 }
 
 /*****************************************************************************
@@ -1130,6 +1206,124 @@ void App::slotDumpDmxIntoFunction()
         return;
 }
 
+void App::slotRecordDmx(bool record)
+{
+    DMXRecorder *recorder = m_doc->dmxRecorder();
+
+    if (record == false)
+    {
+        if (recorder->isRecording() == false)
+            return;
+
+        recorder->stop();
+
+        /* Make the recording available as a function */
+        DMXRecording *recording = new DMXRecording(m_doc);
+        if (m_doc->addFunction(recording) == false)
+        {
+            delete recording;
+            return;
+        }
+        recording->setSourceFileName(recorder->fileName());
+        recording->setName(QFileInfo(recorder->fileName()).completeBaseName());
+        return;
+    }
+
+    QString fn = QFileDialog::getSaveFileName(this, tr("Record DMX"), m_workingDirectory.absolutePath(),
+                                              tr("DMX Recordings (*%1)").arg(KExtDMXRecording));
+    if (fn.isEmpty() == false && fn.endsWith(KExtDMXRecording) == false)
+        fn += KExtDMXRecording;
+
+    QList<quint32> universes;
+    for (quint32 i = 0; i < m_doc->inputOutputMap()->universesCount(); i++)
+        universes.append(i);
+
+    if (fn.isEmpty() || recorder->start(fn, universes) == false)
+    {
+        m_recordDmxAction->setChecked(false);
+        if (fn.isEmpty() == false)
+            handleFileError(QFile::OpenError);
+    }
+}
+
+void App::slotTraceTicks(bool trace)
+{
+    if (trace == true)
+    {
+        TickTrace::setEnabled(true);
+        return;
+    }
+
+    TickTrace::setEnabled(false);
+
+    QString fn = QFileDialog::getSaveFileName(this, tr("Save the engine trace"), m_workingDirectory.absolutePath(),
+                                              tr("Chrome traces (*.json)"));
+    if (fn.isEmpty())
+        return;
+
+    if (fn.endsWith(".json") == false)
+        fn += ".json";
+
+    if (TickTrace::save(fn) == false)
+        handleFileError(QFile::WriteError);
+}
+
+#if defined(Q_OS_UNIX)
+/* The signal handler only wakes up the event loop, see slotTraceSignal() */
+static int s_traceSignalFd[2] = { -1, -1 };
+
+static void traceSignalHandler(int)
+{
+    char c = 1;
+    ssize_t ret = ::write(s_traceSignalFd[0], &c, sizeof(c));
+    Q_UNUSED(ret)
+}
+#endif
+
+void App::enableTraceSignal()
+{
+#if defined(Q_OS_UNIX)
+    if (m_traceSignalNotifier != NULL ||
+        ::socketpair(AF_UNIX, SOCK_STREAM, 0, s_traceSignalFd) != 0)
+        return;
+
+    m_traceSignalNotifier = new QSocketNotifier(s_traceSignalFd[1], QSocketNotifier::Read, this);
+    connect(m_traceSignalNotifier, SIGNAL(activated(int)), this, SLOT(slotTraceSignal()));
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = traceSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &action, NULL);
+#endif
+}
+
+void App::slotTraceSignal()
+{
+#if defined(Q_OS_UNIX)
+    char c;
+    ssize_t ret = ::read(s_traceSignalFd[1], &c, sizeof(c));
+    Q_UNUSED(ret)
+#endif
+
+    if (TickTrace::isEnabled() == false)
+    {
+        qDebug() << "[App] Engine trace started";
+        TickTrace::setEnabled(true);
+        m_traceTicksAction->setChecked(true);
+        return;
+    }
+
+    TickTrace::setEnabled(false);
+    m_traceTicksAction->setChecked(false);
+
+    QString fn = QDir::home().absoluteFilePath(QString("qlcplus-trace-%1.json")
+                    .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")));
+    if (TickTrace::save(fn) == true)
+        qDebug() << "[App] Engine trace saved to" << fn;
+}
+
 void App::slotFunctionLiveEdit()
 {
     FunctionSelection fs(this, m_doc);
@@ -1337,6 +1531,15 @@ QFile::FileError App::loadXML(const QString& fileName)
        can be loaded even if the workspace file has been moved */
     m_doc->setWorkspacePath(QFileInfo(fileName).absolutePath());
 
+    /* Playback-only installations can keep a binary cache next to the
+       workspace, to restore it faster the next time it is opened */
+    QSettings settings;
+    bool useCache = settings.value(SETTINGS_BINARYCACHE, false).toBool();
+    WorkspaceCache cache(fileName);
+    bool cacheValid = useCache && cache.isValid();
+    if (cacheValid)
+        m_doc->setWorkspaceCache(&cache);
+
     if (doc->dtdName() == KXMLQLCWorkspace)
     {
         if (loadXML(*doc) == false)
@@ -1348,6 +1551,9 @@ QFile::FileError App::loadXML(const QString& fileName)
             setFileName(fileName);
             m_doc->resetModified();
             retval = QFile::NoError;
+
+            if (useCache && cacheValid == false)
+                cache.save(m_doc);
         }
     }
     else
@@ -1357,6 +1563,7 @@ QFile::FileError App::loadXML(const QString& fileName)
                    << "is not a workspace file";
     }
 
+    m_doc->setWorkspaceCache(NULL);
     QLCFile::releaseXMLReader(doc);
 
     return retval;
@@ -1439,15 +1646,12 @@ bool App::loadXML(QXmlStreamReader& doc, bool goToConsole, bool fromMemory)
     return true;
 }
 
-QFile::FileError App::saveXML(const QString& fileName)
+QByteArray App::workspaceData()
 {
-    QString tempFileName(fileName);
-    tempFileName += ".temp";
-    QFile file(tempFileName);
-    if (file.open(QIODevice::WriteOnly) == false)
-        return file.error();
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
 
-    QXmlStreamWriter doc(&file);
+    QXmlStreamWriter doc(&buffer);
     doc.setAutoFormatting(true);
     doc.setAutoFormattingIndent(1);
     doc.setCodec("UTF-8");
@@ -1481,29 +1685,79 @@ QFile::FileError App::saveXML(const QString& fileName)
 
     /* End the document and close all the open elements */
     doc.writeEndDocument();
-    file.close();
+    buffer.close();
 
-    // Save to actual requested file name
-    QFile currFile(fileName);
-    if (currFile.exists() && !currFile.remove())
-    {
-        qWarning() << "Could not erase" << fileName;
-        return currFile.error();
-    }
-    if (!file.rename(fileName))
-    {
-        qWarning() << "Could not rename" << tempFileName << "to" << fileName;
-        return file.error();
-    }
+    return buffer.data();
+}
+
+QFile::FileError App::saveXML(const QString& fileName)
+{
+    QFile::FileError error = WorkspaceWriter::writeFile(fileName, workspaceData());
+    if (error != QFile::NoError)
+        return error;
 
     /* Set the file name for the current Doc instance and
        set it also in an unmodified state. */
     setFileName(fileName);
     m_doc->resetModified();
+    m_autosaveModified = false;
 
     return QFile::NoError;
 }
 
+void App::saveXMLInBackground(const QString& fileName)
+{
+    /* The workspace is serialized here, so what is written is the state
+       of this moment, whatever happens while the file is written */
+    QByteArray data = workspaceData();
+
+    setFileName(fileName);
+    m_doc->resetModified();
+    m_autosaveModified = false;
+
+    m_workspaceWriter->write(fileName, data);
+}
+
+QString App::autosaveFileName() const
+{
+    if (fileName().isEmpty())
+        return m_workingDirectory.absoluteFilePath(QString("autosave%1").arg(KExtWorkspace));
+
+    QFileInfo fi(fileName());
+    return fi.absoluteDir().absoluteFilePath(QString("%1.autosave%2").arg(fi.completeBaseName()).arg(KExtWorkspace));
+}
+
+void App::slotWorkspaceWritten()
+{
+    QFile::FileError error = m_workspaceWriter->error();
+    if (error != QFile::NoError)
+    {
+        qWarning() << "Could not save" << m_workspaceWriter->fileName();
+        /* The changes are not on disk, so they still need saving */
+        m_doc->setModified();
+        handleFileError(error);
+        return;
+    }
+
+    /* The project on disk is newer than the autosave now */
+    if (m_workspaceWriter->fileName() == fileName())
+        QFile::remove(autosaveFileName());
+}
+
+void App::slotAutosave()
+{
+    if (m_autosaveModified == false || m_doc->isModified() == false)
+        return;
+
+    /* Don't pile up autosaves when the disk is slower than the interval */
+    if (m_autosaveWriter->isRunning())
+        return;
+
+    qDebug() << "[App] Autosave to" << autosaveFileName();
+    m_autosaveWriter->write(autosaveFileName(), workspaceData());
+    m_autosaveModified = false;
+}
+
 void App::slotLoadDocFromMemory(QString xmlData)
 {
     if (xmlData.isEmpty())
@@ -1542,6 +1796,37 @@ void App::slotLoadDocFromMemory(QString xmlData)
         qDebug() << "XML doesn't have a Workspace tag";
 }
 
+void App::slotLoadDocFromFile(QString fileName)
+{
+    QXmlStreamReader *doc = QLCFile::getXMLReader(fileName);
+    if (doc == NULL || doc->device() == NULL || doc->hasError())
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to read from" << fileName;
+        QFile::remove(fileName);
+        return;
+    }
+
+    while (!doc->atEnd())
+    {
+        if (doc->readNext() == QXmlStreamReader::DTD)
+            break;
+    }
+
+    if (doc->hasError() == false && doc->dtdName() == KXMLQLCWorkspace)
+    {
+        /* Clear existing document data */
+        clearDocument();
+        loadXML(*doc, true, true);
+    }
+    else
+    {
+        qDebug() << "XML doesn't have a Workspace tag";
+    }
+
+    QLCFile::releaseXMLReader(doc);
+    QFile::remove(fileName);
+}
+
 void App::slotSaveAutostart(QString fileName)
 {
     /* Set the workspace path before saving the new XML. In this way local files
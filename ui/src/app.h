@@ -30,15 +30,18 @@
 #include "qlcfixturedefcache.h"
 #include "doc.h"
 
+class WorkspaceWriter;
 class QProgressDialog;
 class QMessageBox;
 class QToolButton;
 class QFileDialog;
 class QTabWidget;
 class WebAccess;
+class QSocketNotifier;
 class QToolBar;
 class QPixmap;
 class QAction;
+class QTimer;
 class QLabel;
 class App;
 
@@ -172,6 +175,8 @@ public slots:
     void slotFadeAndStopAll();
     void slotRunningFunctionsChanged();
     void slotDumpDmxIntoFunction();
+    void slotRecordDmx(bool record);
+    void slotTraceTicks(bool trace);
     void slotFunctionLiveEdit();
     void slotLiveEditVirtualConsole();
     void slotDetachContext(int index);
@@ -195,6 +200,8 @@ private:
     QAction* m_controlBlackoutAction;
     QAction* m_controlPanicAction;
     QAction* m_dumpDmxAction;
+    QAction* m_recordDmxAction;
+    QAction* m_traceTicksAction;
     QAction* m_liveEditAction;
     QAction* m_liveEditVirtualConsoleAction;
 
@@ -210,11 +217,20 @@ private:
     /*********************************************************************
      * Utilities
      *********************************************************************/
+public:
+    /** Toggle the engine timing trace on SIGUSR2 (Unix only): the first
+     *  signal starts it, the next one saves it in the home directory */
+    void enableTraceSignal();
+
+private slots:
+    void slotTraceSignal();
+
 private:
     DmxDumpFactoryProperties *m_dumpProperties;
 #if QT_VERSION >= 0x050000
     VideoProvider *m_videoProvider;
 #endif
+    QSocketNotifier *m_traceSignalNotifier;
 
     /*********************************************************************
      * Load & Save
@@ -259,13 +275,53 @@ public:
      */
     QFile::FileError saveXML(const QString& fileName);
 
+    /**
+     * Save workspace contents to a file with the given name, like saveXML(),
+     * but write the file on a background thread. The workspace is serialized
+     * before returning, so it can be changed or cleared right away.
+     * Write errors are reported when the background write is over.
+     *
+     * @param fileName The name of the file to save to.
+     */
+    void saveXMLInBackground(const QString& fileName);
+
+protected:
+    /** Serialize the whole workspace into an XML document in memory */
+    QByteArray workspaceData();
+
+    /** Get the name of the file used by the autosave */
+    QString autosaveFileName() const;
+
 public slots:
     void slotLoadDocFromMemory(QString xmlData);
 
+    /** Load the workspace in $fileName as if it came from memory,
+     *  then remove the file */
+    void slotLoadDocFromFile(QString fileName);
+
     void slotSaveAutostart(QString fileName);
 
+protected slots:
+    /** Handle the end of a background write started by saveXMLInBackground() */
+    void slotWorkspaceWritten();
+
+    /** Save a copy of the workspace if modified since the last autosave */
+    void slotAutosave();
+
 private:
     QString m_fileName;
+
+    /** The thread writing the saved workspace files */
+    WorkspaceWriter *m_workspaceWriter;
+
+    /** The thread writing the autosave file */
+    WorkspaceWriter *m_autosaveWriter;
+
+    /** Timer triggering the autosave, when enabled */
+    QTimer *m_autosaveTimer;
+
+    /** Whether the workspace changed since the last autosave */
+    bool m_autosaveModified;
 };
 
 /** @} */
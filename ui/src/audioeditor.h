@@ -54,6 +54,7 @@ private slots:
     void slotPreviewStopped(quint32 id);
     void slotSingleShotCheckClicked();
     void slotLoopCheckClicked();
+    void slotPreloadToggled(bool state);
 
 private:
     FunctionParent functionParent() const;
@@ -382,14 +382,7 @@ void ChaserEditor::slotAddClicked()
         updateItem(item, step);
         // if this is the first step we add, then copy all DMX channels non-zero values
         Scene *currScene = qobject_cast<Scene*> (m_doc->function(sequence->boundSceneID()));
-        QListIterator <SceneValue> it(currScene->values());
-        qDebug() << "First step added !!";
-        while (it.hasNext() == true)
-        {
-            SceneValue chan(it.next());
-            step.values.append(chan);
-            //qDebug() << "Value added: " << chan.value;
-        }
+        step.values = currScene->values();
         qDebug() << "Values added: " << step.values.count();
 
         m_tree->insertTopLevelItem(insertionPoint, item);
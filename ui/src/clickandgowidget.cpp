@@ -26,6 +26,7 @@
 #include <QImage>
 
 #include "clickandgowidget.h"
+#include "qlcimagecache.h"
 #include "qlccapability.h"
 #include "qlcmacros.h"
 #include "vcslider.h"
@@ -424,7 +425,8 @@ ClickAndGoWidget::PresetResource::PresetResource(QString path, QString text, uch
     m_descr = text;
     m_min = min;
     m_max = max;
-    QImage px(path);
+    // decoded once for all the sliders showing the same channel
+    QImage px = QLCImageCache::image(path, QSize(40, 40));
     m_thumbnail = QImage(40, 40, QImage::Format_RGB32);
     m_thumbnail.fill(Qt::white);
     QPainter painter(&m_thumbnail);
@@ -244,6 +244,7 @@ void DmxDumpFactory::accept()
             if (fxi != NULL)
             {
                 quint32 baseAddress = fxi->universeAddress();
+                m_fixturesTree->populateChannels(fixItem);
                 for (int c = 0; c < fixItem->childCount(); c++)
                 {
                     QTreeWidgetItem *chanItem = fixItem->child(c);
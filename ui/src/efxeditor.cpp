@@ -19,6 +19,7 @@
 
 #include <QTreeWidgetItem>
 #include <QTreeWidget>
+#include <QtConcurrent>
 #include <QMessageBox>
 #include <QPaintEvent>
 #include <QSettings>
@@ -70,6 +71,8 @@ EFXEditor::EFXEditor(QWidget* parent, EFX* efx, Doc* doc)
     , m_previewArea(NULL)
     , m_points(NULL)
     , m_speedDials(NULL)
+    , m_previewEfx(NULL)
+    , m_previewPending(false)
 {
     Q_ASSERT(doc != NULL);
     Q_ASSERT(efx != NULL);
@@ -78,6 +81,8 @@ EFXEditor::EFXEditor(QWidget* parent, EFX* efx, Doc* doc)
 
     connect(m_speedDial, SIGNAL(toggled(bool)),
             this, SLOT(slotSpeedDialToggle(bool)));
+    connect(&m_previewWatcher, SIGNAL(finished()),
+            this, SLOT(slotPreviewReady()));
 
     initGeneralPage();
     initMovementPage();
@@ -112,6 +117,9 @@ EFXEditor::~EFXEditor()
 {
     if (m_testButton->isChecked() == true)
         m_efx->stopAndWait();
+
+    m_previewWatcher.waitForFinished();
+    delete m_previewEfx;
 }
 
 void EFXEditor::stopTest()
@@ -1054,15 +1062,51 @@ void EFXEditor::redrawPreview()
     if (m_previewArea == NULL)
         return;
 
-    QPolygonF polygon;
-    m_efx->preview(polygon);
+    // a running computation is stale already: start again when it's over
+    if (m_previewWatcher.isRunning())
+    {
+        m_previewPending = true;
+        return;
+    }
+
+    startPreview();
+}
+
+EFXEditor::PreviewData EFXEditor::computePreview(const EFX *efx)
+{
+    PreviewData data;
+    efx->preview(data.m_polygon);
+    efx->previewFixtures(data.m_fixturePoints);
+    data.m_duration = efx->duration();
+
+    return data;
+}
+
+void EFXEditor::startPreview()
+{
+    if (m_previewEfx == NULL)
+        m_previewEfx = new EFX(m_doc);
+    m_previewEfx->copyFrom(m_efx);
+
+    m_previewPending = false;
+    m_previewWatcher.setFuture(QtConcurrent::run(computePreview, (const EFX *)m_previewEfx));
+}
+
+void EFXEditor::slotPreviewReady()
+{
+    if (m_previewPending)
+    {
+        startPreview();
+        return;
+    }
 
-    QVector <QPolygonF> fixturePoints;
-    m_efx->previewFixtures(fixturePoints);
+    PreviewData data = m_previewWatcher.result();
+    if (data.m_polygon.isEmpty())
+        return;
 
-    m_previewArea->setPolygon(polygon);
-    m_previewArea->setFixturePolygons(fixturePoints);
+    m_previewArea->setPolygon(data.m_polygon);
+    m_previewArea->setFixturePolygons(data.m_fixturePoints);
 
-    m_previewArea->draw(m_efx->duration() / polygon.size());
+    m_previewArea->draw(data.m_duration / data.m_polygon.size());
 }
 
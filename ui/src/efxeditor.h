@@ -20,6 +20,7 @@
 #ifndef EFXEDITOR_H
 #define EFXEDITOR_H
 
+#include <QFutureWatcher>
 #include <QPolygon>
 #include <QWidget>
 #include <QFrame>
@@ -157,7 +158,34 @@ private slots:
     void slotBackwardClicked();
 
 private:
+    /** Compute the preview polygons of the EFX in the background */
     void redrawPreview();
+
+    /** The polygons of a preview, computed by a worker thread */
+    struct PreviewData
+    {
+        QPolygonF m_polygon;
+        QVector <QPolygonF> m_fixturePoints;
+        uint m_duration;
+    };
+
+    /** Compute the preview of $efx. Runs in a worker thread */
+    static PreviewData computePreview(const EFX *efx);
+
+    /** Copy the EFX and start computing its preview */
+    void startPreview();
+
+private slots:
+    void slotPreviewReady();
+
+private:
+    /** A copy of the EFX taken when the preview is requested, so that the
+        worker never reads the EFX being edited */
+    EFX *m_previewEfx;
+    QFutureWatcher <PreviewData> m_previewWatcher;
+
+    /** The EFX changed while its preview was being computed */
+    bool m_previewPending;
 };
 
 /** @} */
@@ -396,6 +396,27 @@ void FixtureManager::updateView()
             openGroups << item->data(KColumnName, PROP_GROUP);
     }
 
+    m_fixtures_tree->updateTree();
+
+    // Reopen groups that were open before update
+    for (int i = 0; i < m_fixtures_tree->topLevelItemCount(); i++)
+    {
+        QTreeWidgetItem* item = m_fixtures_tree->topLevelItem(i);
+        QVariant var = item->data(KColumnName, PROP_GROUP);
+        if (openGroups.contains(var) == true)
+        {
+            item->setExpanded(true);
+            openGroups.removeAll(var);
+        }
+    }
+
+    updateActions();
+
+    m_fixtures_tree->header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+void FixtureManager::updateActions()
+{
     if (m_doc->fixtures().count() > 0)
     {
         m_exportAction->setEnabled(true);
@@ -412,24 +433,8 @@ void FixtureManager::updateView()
     m_moveUpAction->setEnabled(false);
     m_moveDownAction->setEnabled(false);
 
-    m_fixtures_tree->updateTree();
-
-    // Reopen groups that were open before update
-    for (int i = 0; i < m_fixtures_tree->topLevelItemCount(); i++)
-    {
-        QTreeWidgetItem* item = m_fixtures_tree->topLevelItem(i);
-        QVariant var = item->data(KColumnName, PROP_GROUP);
-        if (openGroups.contains(var) == true)
-        {
-            item->setExpanded(true);
-            openGroups.removeAll(var);
-        }
-    }
-
     updateGroupMenu();
     slotModeChanged(m_doc->mode());
-
-    m_fixtures_tree->header()->resizeSections(QHeaderView::ResizeToContents);
 }
 
 void FixtureManager::updateChannelsGroupView()
@@ -979,6 +984,7 @@ void FixtureManager::addFixture()
     }
 
     quint32 latestFxi = Fixture::invalidId();
+    QList<quint32> addedFixtures;
 
     QString name = af.name();
     quint32 address = af.address();
@@ -1054,15 +1060,25 @@ void FixtureManager::addFixture()
 
         m_doc->addFixture(fxi);
         latestFxi = fxi->id();
+        addedFixtures.append(latestFxi);
         if (addToGroup != NULL)
             addToGroup->assignFixture(latestFxi);
     }
 
+    /* Add only the new items, instead of rebuilding the whole tree */
+    m_fixtures_tree->addFixtures(addedFixtures);
+    if (addToGroup != NULL)
+    {
+        QTreeWidgetItem* grpItem = m_fixtures_tree->groupItem(addToGroup->id());
+        if (grpItem != NULL)
+            m_fixtures_tree->updateGroupItem(grpItem, addToGroup);
+    }
+
     QTreeWidgetItem* selectItem = m_fixtures_tree->fixtureItem(latestFxi);
     if (selectItem != NULL)
         m_fixtures_tree->setCurrentItem(selectItem);
 
-    updateView();
+    updateActions();
 }
 
 void FixtureManager::addChannelsGroup()
@@ -96,6 +96,9 @@ public:
     /** Update the list of fixtures */
     void updateView();
 
+    /** Update the actions state after a change of the fixtures list */
+    void updateActions();
+
     /** Update the list of channels group */
     void updateChannelsGroupView();
 
@@ -18,6 +18,8 @@
 */
 
 #include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QDebug>
@@ -79,6 +81,9 @@ FixtureRemap::FixtureRemap(Doc *doc, QWidget *parent)
     m_remapLayout->addWidget(remapWidget);
 
     m_targetDoc = new Doc(this);
+    /* Keep an index of the definitions, to avoid reading them all at startup */
+    m_targetDoc->fixtureDefCache()->setIndexFile(QLCFixtureDefCache::defaultIndexFile());
+
     /* Load user fixtures first so that they override system fixtures */
     m_targetDoc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
     m_targetDoc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
@@ -598,53 +603,51 @@ void FixtureRemap::slotSourceSelectionChanged()
         m_cloneButton->setEnabled(false);
 }
 
-QList<SceneValue> FixtureRemap::remapSceneValues(QList<SceneValue> funcList,
-                                    QList<SceneValue> &srcList,
-                                    QList<SceneValue> &tgtList)
+quint64 FixtureRemap::remapKey(quint32 fxi, quint32 channel)
+{
+    return (quint64(fxi) << 32) | channel;
+}
+
+QList<SceneValue> FixtureRemap::remapSceneValues(const QList<SceneValue>& funcList,
+                                                 const RemapTable& table)
 {
     QList <SceneValue> newValuesList;
     foreach(SceneValue val, funcList)
     {
-        for (int v = 0; v < srcList.count(); v++)
+        quint64 key = remapKey(val.fxi, val.channel);
+        RemapTable::const_iterator it = table.constFind(key);
+        for (; it != table.constEnd() && it.key() == key; ++it)
         {
-            if (val == srcList.at(v))
-            {
-                SceneValue tgtVal = tgtList.at(v);
-                //qDebug() << "[Scene] Remapping" << val.fxi << val.channel << " to " << tgtVal.fxi << tgtVal.channel;
-                newValuesList.append(SceneValue(tgtVal.fxi, tgtVal.channel, val.value));
-            }
+            //qDebug() << "[Scene] Remapping" << val.fxi << val.channel << " to " << it->fxi << it->channel;
+            newValuesList.append(SceneValue(it.value().fxi, it.value().channel, val.value));
         }
     }
     std::sort(newValuesList.begin(), newValuesList.end());
     return newValuesList;
 }
 
+void FixtureRemap::remapJob(RemapJob& job)
+{
+    job.values = remapSceneValues(job.values, *job.table);
+}
+
 QList<VCWidget *> FixtureRemap::getVCChildren(VCWidget *obj)
 {
-    QList<VCWidget *> list;
     if (obj == NULL)
-        return list;
-    QListIterator <VCWidget*> it(obj->findChildren<VCWidget*>());
-    while (it.hasNext() == true)
-    {
-        VCWidget* child = it.next();
-        if (list.contains(child) == false)
-        {
-            qDebug() << Q_FUNC_INFO << "append: " << child->caption();
-            list.append(child);
-        }
-        list.append(getVCChildren(child));
-    }
-    return list;
+        return QList<VCWidget *>();
+
+    // findChildren is already recursive
+    return obj->findChildren<VCWidget*>();
 }
 
 void FixtureRemap::accept()
 {
     /* **********************************************************************
-     * 1 - create a map of SceneValues from the fixtures channel associations
+     * 1 - create the tables of the fixtures channel associations
      * ********************************************************************** */
-    QList<SceneValue> sourceList;
-    QList<SceneValue> targetList;
+    RemapTable remapTable;
+    // the targets of each source fixture, in the order they were connected
+    QHash <quint32, QList<SceneValue> > fixtureTargets;
 
     foreach (RemapInfo info, m_remapList)
     {
@@ -654,18 +657,53 @@ void FixtureRemap::accept()
         quint32 tgtFxiID = info.target->text(KColumnID).toUInt();
         quint32 tgtChIdx = info.target->text(KColumnChIdx).toUInt();
 
-        sourceList.append(SceneValue(srcFxiID, srcChIdx));
-        targetList.append(SceneValue(tgtFxiID, tgtChIdx));
+        remapTable.insert(remapKey(srcFxiID, srcChIdx), SceneValue(tgtFxiID, tgtChIdx));
+        fixtureTargets[srcFxiID].append(SceneValue(tgtFxiID, tgtChIdx));
 
         // qDebug() << "Remapping fx" << srcFxiID << "ch" << srcChIdx << "to fx" << tgtFxiID << "ch" << tgtChIdx;
     }
 
     /* **********************************************************************
-     * 2 - Show a progress dialog, in case the operation takes a while
+     * 2 - remap the values of all the Scenes and Sequence steps in parallel,
+     *     showing a progress dialog, since the operation might take a while.
+     *     Nothing is changed in the project until this is done.
      * ********************************************************************** */
+    QList <Function *> functions = m_doc->functions();
+    QList <RemapJob> jobs;
+
+    foreach (Function *func, functions)
+    {
+        if (func->type() == Function::SceneType)
+        {
+            RemapJob job = { qobject_cast<Scene*>(func)->values(), &remapTable };
+            jobs.append(job);
+        }
+        else if (func->type() == Function::SequenceType)
+        {
+            Sequence *s = qobject_cast<Sequence*>(func);
+            for (int idx = 0; idx < s->stepsCount(); idx++)
+            {
+                RemapJob job = { s->stepAt(idx)->values, &remapTable };
+                jobs.append(job);
+            }
+        }
+    }
+
     QProgressDialog progress(tr("This might take a while..."), tr("Cancel"), 0, 100, this);
     progress.setWindowModality(Qt::WindowModal);
-    progress.show();
+
+    QFutureWatcher<void> watcher;
+    connect(&watcher, SIGNAL(finished()), &progress, SLOT(reset()));
+    connect(&progress, SIGNAL(canceled()), &watcher, SLOT(cancel()));
+    connect(&watcher, SIGNAL(progressRangeChanged(int,int)), &progress, SLOT(setRange(int,int)));
+    connect(&watcher, SIGNAL(progressValueChanged(int)), &progress, SLOT(setValue(int)));
+
+    watcher.setFuture(QtConcurrent::map(jobs, remapJob));
+    progress.exec();
+    watcher.waitForFinished();
+
+    if (watcher.isCanceled())
+        return;
 
     /* **********************************************************************
      * 3 - replace original project fixtures
@@ -689,19 +727,12 @@ void FixtureRemap::accept()
             QLCPoint pt(it.key());
             GroupHead head(it.value());
 
-            if (head.isValid() == false)
+            if (head.isValid() == false || fixtureTargets.contains(head.fxi) == false)
                 continue;
 
-            for (int i = 0; i < sourceList.count(); i++)
-            {
-                if (sourceList.at(i).fxi == head.fxi)
-                {
-                    head.fxi = targetList.at(i).fxi;
-                    group->resignHead(pt);
-                    group->assignHead(pt, head);
-                    break;
-                }
-            }
+            head.fxi = fixtureTargets[head.fxi].first().fxi;
+            group->resignHead(pt);
+            group->assignHead(pt, head);
         }
     }
 
@@ -710,25 +741,23 @@ void FixtureRemap::accept()
         QList<SceneValue> grpChannels = grp->getChannels();
         // this is crucial: here all the "unmapped" channels will be lost forever !
         grp->resetChannels();
-        QList <SceneValue> newList = remapSceneValues(grpChannels, sourceList, targetList);
+        QList <SceneValue> newList = remapSceneValues(grpChannels, remapTable);
         foreach (SceneValue val, newList)
             grp->addChannel(val.fxi, val.channel);
     }
 
     /* **********************************************************************
-     * 5 - scan project functions and perform remapping
+     * 5 - apply the remapped values and remap the other functions
      * ********************************************************************** */
-    int funcNum = m_doc->functions().count();
-    int f = 0;
-    foreach (Function *func, m_doc->functions())
+    QListIterator <RemapJob> job(jobs);
+    foreach (Function *func, functions)
     {
         switch (func->type())
         {
             case Function::SceneType:
             {
                 Scene *s = qobject_cast<Scene*>(func);
-                qDebug() << "Analyzing Scene #" << s->id();
-                QList <SceneValue> newList = remapSceneValues(s->values(), sourceList, targetList);
+                const QList <SceneValue> &newList = job.next().values;
                 // this is crucial: here all the "unmapped" channels will be lost forever !
                 s->clear();
 
@@ -745,12 +774,8 @@ void FixtureRemap::accept()
                 for (int idx = 0; idx < s->stepsCount(); idx++)
                 {
                     ChaserStep *cs = s->stepAt(idx);
-                    QList <SceneValue> newList = remapSceneValues(cs->values, sourceList, targetList);
-                    //qDebug() << "Step" << idx << "remapped" << cs.values.count() << "to" << newList.count();
                     // this is crucial: here all the "unmapped" channels will be lost forever !
-                    cs->values.clear();
-                    cs->values = newList;
-                    //s->replaceStep(cs, idx);
+                    cs->values = job.next().values;
                 }
             }
             break;
@@ -772,42 +797,34 @@ void FixtureRemap::accept()
                 foreach( EFXFixture *efxFix, fixListCopy)
                 {
                     quint32 fxID = efxFix->head().fxi;
-                    for (int i = 0; i < sourceList.count(); i++)
+                    foreach (SceneValue tgtVal, fixtureTargets.value(fxID))
                     {
-                        SceneValue srcVal = sourceList.at(i);
-                        SceneValue tgtVal = targetList.at(i);
-                        // check for fixture ID match. EFX remapping must be performed
-                        // just once for each target fixture
-                        if (srcVal.fxi == fxID && remappedFixtures.contains(tgtVal.fxi) == false)
+                        // EFX remapping must be performed just once for each target fixture
+                        if (remappedFixtures.contains(tgtVal.fxi) == true)
+                            continue;
+
+                        Fixture *docFix = m_doc->fixture(tgtVal.fxi);
+                        quint32 fxCh = tgtVal.channel;
+                        const QLCChannel *chan = docFix->channel(fxCh);
+                        if (chan->group() == QLCChannel::Pan ||
+                            chan->group() == QLCChannel::Tilt)
                         {
-                            Fixture *docFix = m_doc->fixture(tgtVal.fxi);
-                            quint32 fxCh = tgtVal.channel;
-                            const QLCChannel *chan = docFix->channel(fxCh);
-                            if (chan->group() == QLCChannel::Pan ||
-                                chan->group() == QLCChannel::Tilt)
-                            {
-                                EFXFixture* ef = new EFXFixture(e);
-                                ef->copyFrom(efxFix);
-                                ef->setHead(GroupHead(tgtVal.fxi, 0)); // TODO!!! head!!!
-                                if (e->addFixture(ef) == false)
-                                    delete ef;
-                                qDebug() << "EFX remap" << srcVal.fxi << "to" << tgtVal.fxi;
-                                remappedFixtures.append(tgtVal.fxi);
-                            }
+                            EFXFixture* ef = new EFXFixture(e);
+                            ef->copyFrom(efxFix);
+                            ef->setHead(GroupHead(tgtVal.fxi, 0)); // TODO!!! head!!!
+                            if (e->addFixture(ef) == false)
+                                delete ef;
+                            qDebug() << "EFX remap" << fxID << "to" << tgtVal.fxi;
+                            remappedFixtures.append(tgtVal.fxi);
                         }
                     }
                 }
-                fixListCopy.clear();
+                qDeleteAll(fixListCopy);
             }
             break;
             default:
             break;
         }
-        if(progress.wasCanceled())
-            break;
-        f++;
-        progress.setValue((f * 100) / funcNum);
-        QApplication::processEvents();
     }
 
     /* **********************************************************************
@@ -829,14 +846,12 @@ void FixtureRemap::accept()
 
                 foreach (VCSlider::LevelChannel chan, slider->levelChannels())
                 {
-                    for (int v = 0; v < sourceList.count(); v++)
+                    QList<SceneValue> targets = remapTable.values(remapKey(chan.fixture, chan.channel));
+                    // QMultiHash returns the most recently inserted values first
+                    for (int v = targets.count() - 1; v >= 0; v--)
                     {
-                        SceneValue val = sourceList.at(v);
-                        if (val.fxi == chan.fixture && val.channel == chan.channel)
-                        {
-                            qDebug() << "Matching channel:" << chan.fixture << chan.channel << "to target:" << targetList.at(v).fxi << targetList.at(v).channel;
-                            newChannels.append(SceneValue(targetList.at(v).fxi, targetList.at(v).channel));
-                        }
+                        qDebug() << "Matching channel:" << chan.fixture << chan.channel << "to target:" << targets.at(v).fxi << targets.at(v).channel;
+                        newChannels.append(SceneValue(targets.at(v).fxi, targets.at(v).channel));
                     }
                 }
                 // this is crucial: here all the "unmapped" channels will be lost forever !
@@ -852,7 +867,7 @@ void FixtureRemap::accept()
             {
                 if (bar->m_type == AudioBar::DMXBar)
                 {
-                    QList <SceneValue> newList = remapSceneValues(bar->m_dmxChannels, sourceList, targetList);
+                    QList <SceneValue> newList = remapSceneValues(bar->m_dmxChannels, remapTable);
                     // this is crucial: here all the "unmapped" channels will be lost forever !
                     bar->attachDmxChannels(m_doc, newList);
                 }
@@ -865,23 +880,18 @@ void FixtureRemap::accept()
             foreach (VCXYPadFixture fix, xypad->fixtures())
             {
                 quint32 srxFxID = fix.head().fxi; // TODO: heads !!
-                for (int i = 0; i < sourceList.count(); i++)
+                foreach (SceneValue tgtVal, fixtureTargets.value(srxFxID))
                 {
-                    SceneValue val = sourceList.at(i);
-                    if (val.fxi == srxFxID)
+                    Fixture *docFix = m_doc->fixture(tgtVal.fxi);
+                    quint32 fxCh = tgtVal.channel;
+                    const QLCChannel *chan = docFix->channel(fxCh);
+                    if (chan->group() == QLCChannel::Pan ||
+                        chan->group() == QLCChannel::Tilt)
                     {
-                        SceneValue tgtVal = targetList.at(i);
-                        Fixture *docFix = m_doc->fixture(tgtVal.fxi);
-                        quint32 fxCh = tgtVal.channel;
-                        const QLCChannel *chan = docFix->channel(fxCh);
-                        if (chan->group() == QLCChannel::Pan ||
-                            chan->group() == QLCChannel::Tilt)
-                        {
-                            VCXYPadFixture tgtFix(m_doc);
-                            GroupHead head(tgtVal.fxi, 0);
-                            tgtFix.setHead(head);
-                            copyFixtures.append(tgtFix);
-                        }
+                        VCXYPadFixture tgtFix(m_doc);
+                        GroupHead head(tgtVal.fxi, 0);
+                        tgtFix.setHead(head);
+                        copyFixtures.append(tgtFix);
                     }
                 }
             }
@@ -902,14 +912,10 @@ void FixtureRemap::accept()
 
         foreach (quint32 fxID, props->fixtureItemsID())
         {
-            for( int v = 0; v < sourceList.count(); v++)
+            if (fixtureTargets.contains(fxID))
             {
-                if (sourceList.at(v).fxi == fxID)
-                {
-                    FixturePreviewItem rmpProp = props->fixtureProperties(fxID);
-                    remappedFixtureItems[targetList.at(v).fxi] = rmpProp;
-                    break;
-                }
+                FixturePreviewItem rmpProp = props->fixtureProperties(fxID);
+                remappedFixtureItems[fixtureTargets[fxID].first().fxi] = rmpProp;
             }
 
             props->removeFixture(fxID);
@@ -932,8 +938,6 @@ void FixtureRemap::accept()
     mainApp->setFileName(m_targetProjectLabel->text());
     mainApp->slotFileSave();
 
-    progress.hide();
-
     /* Close dialog */
     QDialog::accept();
 }
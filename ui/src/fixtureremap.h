@@ -20,15 +20,17 @@
 #ifndef FIXTUREREMAP_H
 #define FIXTUREREMAP_H
 
+#include <QMultiHash>
 #include <QDialog>
 #include <QList>
+#include <QHash>
 
 #include "ui_fixtureremap.h"
+#include "scenevalue.h"
 
 class Doc;
 class VCWidget;
 class RemapWidget;
-class SceneValue;
 
 /** @addtogroup ui_fixtures
  * @{
@@ -40,6 +42,16 @@ struct RemapInfo
     QTreeWidgetItem *target;
 };
 
+/** The target channels of each (fixture, channel) source, see remapKey() */
+typedef QMultiHash<quint64, SceneValue> RemapTable;
+
+/** A list of channels to remap, without touching the function it belongs to */
+struct RemapJob
+{
+    QList<SceneValue> values;
+    const RemapTable *table;
+};
+
 class FixtureRemap : public QDialog, public Ui_FixtureRemap
 {
     Q_OBJECT
@@ -60,9 +72,16 @@ protected:
 
     void fillFixturesTree(Doc *doc, QTreeWidget *tree);
 
-    QList<SceneValue> remapSceneValues(QList<SceneValue> funcList,
-                                       QList<SceneValue> &srcList,
-                                       QList<SceneValue> &tgtList);
+    /** Return the key of the (fixture, channel) pair in a RemapTable */
+    static quint64 remapKey(quint32 fxi, quint32 channel);
+
+    /** Return the values of $funcList moved to their target channels,
+     *  dropping the ones that are not remapped */
+    static QList<SceneValue> remapSceneValues(const QList<SceneValue>& funcList,
+                                              const RemapTable& table);
+
+    /** Remap the values of $job in place. Run concurrently for all the jobs */
+    static void remapJob(RemapJob& job);
 
     QList<VCWidget *> getVCChildren(VCWidget *obj);
 
@@ -53,9 +53,9 @@ FixtureTreeWidget::FixtureTreeWidget(Doc *doc, quint32 flags, QWidget *parent)
     sortByColumn(KColumnName, Qt::AscendingOrder);
 
     connect(this, SIGNAL(itemExpanded(QTreeWidgetItem*)),
-            this, SLOT(slotItemExpanded()));
+            this, SLOT(slotItemExpanded(QTreeWidgetItem*)));
     connect(this, SIGNAL(itemCollapsed(QTreeWidgetItem*)),
-            this, SLOT(slotItemExpanded()));
+            this, SLOT(slotItemCollapsed()));
 }
 
 void FixtureTreeWidget::setFlags(quint32 flags)
@@ -177,7 +177,9 @@ void FixtureTreeWidget::updateFixtureItem(QTreeWidgetItem* item, Fixture* fixtur
     if (m_channelSelection)
     {
         item->setFlags(item->flags() | Qt::ItemIsUserCheckable | Qt::ItemIsTristate);
-        item->setCheckState(KColumnName, Qt::Unchecked);
+        item->setCheckState(KColumnName, channelsMaskState(fixture));
+        // channel items are created on expand
+        item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
     }
     if (m_disabledFixtures.contains(fixture->id()) == true)
     {
@@ -244,37 +246,79 @@ void FixtureTreeWidget::updateFixtureItem(QTreeWidgetItem* item, Fixture* fixtur
         if (disabled == fixture->heads())
             item->setFlags(Qt::NoItemFlags);
     }
+}
 
-    if (m_channelSelection == true)
+void FixtureTreeWidget::populateChannels(QTreeWidgetItem *item)
+{
+    if (m_channelSelection == false || item == NULL)
+        return;
+
+    QVariant var = item->data(KColumnName, PROP_ID);
+    if (var.isValid() == false)
+        return;
+
+    for (int i = 0; i < item->childCount(); i++)
     {
-        quint32 baseAddress = fixture->universeAddress();
-        for (quint32 c = 0; c < fixture->channels(); c++)
-        {
-            const QLCChannel* channel = fixture->channel(c);
-            QTreeWidgetItem *cItem = new QTreeWidgetItem(item);
-            cItem->setText(KColumnName, QString("%1:%2").arg(c + 1)
-                          .arg(channel->name()));
-            cItem->setIcon(KColumnName, channel->getIcon());
-            cItem->setData(KColumnName, PROP_CHANNEL, c);
-            if (m_typeColumn > 0)
-            {
-                if (channel->group() == QLCChannel::Intensity &&
-                    channel->colour() != QLCChannel::NoColour)
-                    cItem->setText(m_typeColumn, QLCChannel::colourToString(channel->colour()));
-                else
-                    cItem->setText(m_typeColumn, QLCChannel::groupToString(channel->group()));
-            }
+        if (item->child(i)->data(KColumnName, PROP_CHANNEL).isValid())
+            return;
+    }
+
+    Fixture *fixture = m_doc->fixture(var.toUInt());
+    if (fixture == NULL)
+        return;
 
-            cItem->setFlags(cItem->flags() | Qt::ItemIsUserCheckable);
-            if (m_channelsMask.length() > (int)(baseAddress + c) &&
-                m_channelsMask.at(baseAddress + c) == 1)
-                    cItem->setCheckState(KColumnName, Qt::Checked);
+    // a fully (un)checked fixture passes its state to all the channels
+    Qt::CheckState fxState = item->checkState(KColumnName);
+    quint32 baseAddress = fixture->universeAddress();
+
+    for (quint32 c = 0; c < fixture->channels(); c++)
+    {
+        const QLCChannel* channel = fixture->channel(c);
+        QTreeWidgetItem *cItem = new QTreeWidgetItem(item);
+        cItem->setText(KColumnName, QString("%1:%2").arg(c + 1)
+                      .arg(channel->name()));
+        cItem->setIcon(KColumnName, channel->getIcon());
+        cItem->setData(KColumnName, PROP_CHANNEL, c);
+        if (m_typeColumn > 0)
+        {
+            if (channel->group() == QLCChannel::Intensity &&
+                channel->colour() != QLCChannel::NoColour)
+                cItem->setText(m_typeColumn, QLCChannel::colourToString(channel->colour()));
             else
-                cItem->setCheckState(KColumnName, Qt::Unchecked);
+                cItem->setText(m_typeColumn, QLCChannel::groupToString(channel->group()));
         }
+
+        cItem->setFlags(cItem->flags() | Qt::ItemIsUserCheckable);
+        if (fxState != Qt::PartiallyChecked)
+            cItem->setCheckState(KColumnName, fxState);
+        else if (m_channelsMask.length() > (int)(baseAddress + c) &&
+                 m_channelsMask.at(baseAddress + c) == 1)
+            cItem->setCheckState(KColumnName, Qt::Checked);
+        else
+            cItem->setCheckState(KColumnName, Qt::Unchecked);
     }
 }
 
+Qt::CheckState FixtureTreeWidget::channelsMaskState(Fixture *fixture) const
+{
+    quint32 baseAddress = fixture->universeAddress();
+    quint32 checked = 0;
+
+    for (quint32 c = 0; c < fixture->channels(); c++)
+    {
+        if (m_channelsMask.length() > (int)(baseAddress + c) &&
+            m_channelsMask.at(baseAddress + c) == 1)
+                checked++;
+    }
+
+    if (checked == 0)
+        return Qt::Unchecked;
+    else if (checked == fixture->channels())
+        return Qt::Checked;
+
+    return Qt::PartiallyChecked;
+}
+
 void FixtureTreeWidget::updateGroupItem(QTreeWidgetItem* item, const FixtureGroup* grp)
 {
     Q_ASSERT(item != NULL);
@@ -414,13 +458,50 @@ void FixtureTreeWidget::updateSelections()
     }
 }
 
-void FixtureTreeWidget::slotItemExpanded()
+void FixtureTreeWidget::slotItemExpanded(QTreeWidgetItem *item)
 {
+    populateChannels(item);
     header()->resizeSections(QHeaderView::ResizeToContents);
 }
 
+void FixtureTreeWidget::slotItemCollapsed()
+{
+    header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+QTreeWidgetItem *FixtureTreeWidget::universeItem(quint32 uni)
+{
+    for (int i = 0; i < topLevelItemCount(); i++)
+    {
+        QTreeWidgetItem* tItem = topLevelItem(i);
+        QVariant tVar = tItem->data(KColumnName, PROP_UNIVERSE);
+        if (tVar.isValid() && tVar.toUInt() == uni)
+            return tItem;
+    }
+
+    // Haven't found this universe node ? Create it.
+    QTreeWidgetItem *topItem = new QTreeWidgetItem(this);
+    topItem->setText(KColumnName, m_doc->inputOutputMap()->getUniverseNameByID(uni));
+    topItem->setIcon(KColumnName, QIcon(":/group.png"));
+    topItem->setData(KColumnName, PROP_UNIVERSE, uni);
+    topItem->setExpanded(true);
+    if (m_channelSelection)
+    {
+        topItem->setFlags(topItem->flags() | Qt::ItemIsUserCheckable | Qt::ItemIsTristate);
+        topItem->setCheckState(KColumnName, Qt::Unchecked);
+    }
+    m_universesCount++;
+
+    return topItem;
+}
+
 void FixtureTreeWidget::updateTree()
 {
+    // sort once, when all the items have been created
+    bool sorting = isSortingEnabled();
+    setSortingEnabled(false);
+    setUpdatesEnabled(false);
+
     clear();
     m_universesCount = 0;
     m_fixturesCount = 0;
@@ -435,41 +516,15 @@ void FixtureTreeWidget::updateTree()
         }
     }
 
+    QTreeWidgetItem *topItem = NULL;
+
     foreach (Fixture* fixture, m_doc->fixtures())
     {
         Q_ASSERT(fixture != NULL);
 
-        QTreeWidgetItem *topItem = NULL;
         quint32 uni = fixture->universe();
-        for (int i = 0; i < topLevelItemCount(); i++)
-        {
-            QTreeWidgetItem* tItem = topLevelItem(i);
-            QVariant tVar = tItem->data(KColumnName, PROP_UNIVERSE);
-            if (tVar.isValid())
-            {
-                quint32 tUni = tVar.toUInt();
-                if (tUni == uni)
-                {
-                    topItem = tItem;
-                    break;
-                }
-            }
-        }
-        // Haven't found this universe node ? Create it.
-        if (topItem == NULL)
-        {
-            topItem = new QTreeWidgetItem(this);
-            topItem->setText(KColumnName, m_doc->inputOutputMap()->getUniverseNameByID(uni));
-            topItem->setIcon(KColumnName, QIcon(":/group.png"));
-            topItem->setData(KColumnName, PROP_UNIVERSE, uni);
-            topItem->setExpanded(true);
-            if (m_channelSelection)
-            {
-                topItem->setFlags(topItem->flags() | Qt::ItemIsUserCheckable | Qt::ItemIsTristate);
-                topItem->setCheckState(KColumnName, Qt::Unchecked);
-            }
-            m_universesCount++;
-        }
+        if (topItem == NULL || topItem->data(KColumnName, PROP_UNIVERSE).toUInt() != uni)
+            topItem = universeItem(uni);
 
         QTreeWidgetItem *fItem = new QTreeWidgetItem(topItem);
         updateFixtureItem(fItem, fixture);
@@ -477,6 +532,33 @@ void FixtureTreeWidget::updateTree()
         m_channelsCount += fixture->channels();
     }
 
+    setSortingEnabled(sorting);
+    setUpdatesEnabled(true);
+
+    header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+void FixtureTreeWidget::addFixtures(QList<quint32> fixtureIDs)
+{
+    bool sorting = isSortingEnabled();
+    setSortingEnabled(false);
+    setUpdatesEnabled(false);
+
+    foreach (quint32 id, fixtureIDs)
+    {
+        Fixture *fixture = m_doc->fixture(id);
+        if (fixture == NULL)
+            continue;
+
+        QTreeWidgetItem *fItem = new QTreeWidgetItem(universeItem(fixture->universe()));
+        updateFixtureItem(fItem, fixture);
+        m_fixturesCount++;
+        m_channelsCount += fixture->channels();
+    }
+
+    setSortingEnabled(sorting);
+    setUpdatesEnabled(true);
+
     header()->resizeSections(QHeaderView::ResizeToContents);
 }
 
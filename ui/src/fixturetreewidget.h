@@ -43,6 +43,10 @@ public:
 
     void updateTree();
 
+    /** Append the fixtures with the given IDs to the tree, without
+     *  rebuilding the existing items */
+    void addFixtures(QList<quint32> fixtureIDs);
+
     /** Get a QTreeWidgetItem whose fixture ID is $id */
     QTreeWidgetItem* fixtureItem(quint32 id) const;
 
@@ -55,6 +59,11 @@ public:
     /** Update a group's data to and under $item */
     void updateGroupItem(QTreeWidgetItem* item, const FixtureGroup* grp);
 
+    /** Create the channel items of a fixture $item, if not done yet.
+     *  With the ChannelSelection flag, channels are created only
+     *  when a fixture item is expanded */
+    void populateChannels(QTreeWidgetItem* item);
+
     /** Return the number of universes added to the tree during the last
      *  updateTree call */
     int universeCount();
@@ -68,7 +77,15 @@ public:
     int channelsCount();
 
 protected slots:
-    void slotItemExpanded();
+    void slotItemExpanded(QTreeWidgetItem *item);
+    void slotItemCollapsed();
+
+private:
+    /** Get the top level item of universe $uni, creating it if needed */
+    QTreeWidgetItem *universeItem(quint32 uni);
+
+    /** Get the check state of $fixture according to the channels mask */
+    Qt::CheckState channelsMaskState(Fixture *fixture) const;
 
 private:
     Doc *m_doc;
@@ -32,6 +32,7 @@
 #include <QToolBar>
 #include <QMenuBar>
 #include <QPixmap>
+#include <QTimer>
 #include <QDebug>
 #include <QMenu>
 #include <QList>
@@ -42,6 +43,7 @@
 #include "collectioneditor.h"
 #include "audioplugincache.h"
 #include "functionmanager.h"
+#include "mastertimer.h"
 #include "rgbmatrixeditor.h"
 #include "functionwizard.h"
 #include "chasereditor.h"
@@ -71,6 +73,10 @@
 
 #define COL_NAME 0
 #define COL_PATH 1
+#define COL_CPUTIME 2
+
+/** Refresh interval of the CPU time column in milliseconds */
+#define CPUTIME_REFRESH_INTERVAL 1000
 
 #define SETTINGS_SPLITTER "functionmanager/splitter"
 
@@ -101,6 +107,8 @@ FunctionManager::FunctionManager(QWidget* parent, Doc* doc)
     , m_cloneAction(NULL)
     , m_deleteAction(NULL)
     , m_selectAllAction(NULL)
+    , m_cpuTimeAction(NULL)
+    , m_cpuTimeTimer(NULL)
     , m_editor(NULL)
     , m_scene_editor(NULL)
 {
@@ -140,6 +148,8 @@ FunctionManager::~FunctionManager()
     QSettings settings;
     settings.setValue(SETTINGS_SPLITTER, m_hsplitter->saveState());
 
+    m_doc->masterTimer()->setFunctionTimingEnabled(false);
+
     FunctionManager::s_instance = NULL;
 }
 
@@ -292,6 +302,18 @@ void FunctionManager::initActions()
     m_selectAllAction->setShortcut(QKeySequence("CTRL+A"));
     connect(m_selectAllAction, SIGNAL(triggered(bool)),
             this, SLOT(slotSelectAll()));
+
+    /* Tools actions */
+    m_cpuTimeAction = new QAction(QIcon(":/clock.png"),
+                                  tr("Show CPU &time"), this);
+    m_cpuTimeAction->setCheckable(true);
+    connect(m_cpuTimeAction, SIGNAL(toggled(bool)),
+            this, SLOT(slotShowCPUTime(bool)));
+
+    m_cpuTimeTimer = new QTimer(this);
+    m_cpuTimeTimer->setInterval(CPUTIME_REFRESH_INTERVAL);
+    connect(m_cpuTimeTimer, SIGNAL(timeout()),
+            this, SLOT(slotUpdateCPUTime()));
 }
 
 void FunctionManager::initToolbar()
@@ -321,6 +343,8 @@ void FunctionManager::initToolbar()
     m_toolbar->addAction(m_cloneAction);
     m_toolbar->addSeparator();
     m_toolbar->addAction(m_deleteAction);
+    m_toolbar->addSeparator();
+    m_toolbar->addAction(m_cpuTimeAction);
 }
 
 void FunctionManager::slotAddScene()
@@ -640,6 +664,55 @@ void FunctionManager::slotSelectAll()
     m_tree->selectAll();
 }
 
+void FunctionManager::slotShowCPUTime(bool show)
+{
+    m_doc->masterTimer()->setFunctionTimingEnabled(show);
+    m_tree->setColumnHidden(COL_CPUTIME, !show);
+
+    if (show)
+    {
+        slotUpdateCPUTime();
+        m_cpuTimeTimer->start();
+    }
+    else
+    {
+        m_cpuTimeTimer->stop();
+    }
+}
+
+void FunctionManager::slotUpdateCPUTime()
+{
+    QHash<quint32, MasterTimer::FunctionTiming> timings =
+        m_doc->masterTimer()->functionTimings();
+
+    QTreeWidgetItemIterator it(m_tree);
+    while (*it != NULL)
+    {
+        QTreeWidgetItem *item = *it;
+        quint32 fid = m_tree->itemFunctionId(item);
+        ++it;
+
+        if (timings.contains(fid) == false)
+        {
+            item->setText(COL_CPUTIME, QString());
+            item->setToolTip(COL_CPUTIME, QString());
+            continue;
+        }
+
+        const MasterTimer::FunctionTiming &timing = timings[fid];
+
+        item->setText(COL_CPUTIME, tr("%1 ms (max %2 ms)")
+                      .arg(timing.write.average / 1000.0, 0, 'f', 2)
+                      .arg(timing.write.maximum / 1000.0, 0, 'f', 2));
+        item->setToolTip(COL_CPUTIME, tr("Write: %1 calls, max %2 ms\n"
+                                         "Start: %3 calls, max %4 ms\n"
+                                         "Stop: %5 calls, max %6 ms")
+                         .arg(timing.write.calls).arg(timing.write.maximum / 1000.0, 0, 'f', 2)
+                         .arg(timing.preRun.calls).arg(timing.preRun.maximum / 1000.0, 0, 'f', 2)
+                         .arg(timing.postRun.calls).arg(timing.postRun.maximum / 1000.0, 0, 'f', 2));
+    }
+}
+
 void FunctionManager::updateActionStatus()
 {
     bool validSelection = false;
@@ -722,8 +795,10 @@ void FunctionManager::initTree()
     m_hsplitter->addWidget(m_tree);
 
     QStringList labels;
-    labels << tr("Function"); // << "Path";
+    labels << tr("Function") << "Path" << tr("CPU time");
     m_tree->setHeaderLabels(labels);
+    m_tree->setColumnHidden(COL_PATH, true);
+    m_tree->setColumnHidden(COL_CPUTIME, true);
     m_tree->setRootIsDecorated(true);
     m_tree->setAllColumnsShowFocus(true);
     m_tree->setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -30,6 +30,7 @@ class FunctionsTreeWidget;
 class QTreeWidgetItem;
 class QSplitter;
 class QToolBar;
+class QTimer;
 class QAction;
 class Fixture;
 class QMenu;
@@ -133,6 +134,10 @@ protected slots:
     void slotDelete();
     void slotSelectAll();
 
+    /** Show/hide the CPU time spent by each function */
+    void slotShowCPUTime(bool show);
+    void slotUpdateCPUTime();
+
 protected:
     void updateActionStatus();
 
@@ -155,6 +160,10 @@ protected:
     QAction* m_cloneAction;
     QAction* m_deleteAction;
     QAction* m_selectAllAction;
+    QAction* m_cpuTimeAction;
+
+    /** Refreshes the CPU time column while it is shown */
+    QTimer* m_cpuTimeTimer;
 
     /*********************************************************************
      * Helpers
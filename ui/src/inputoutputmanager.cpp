@@ -26,6 +26,7 @@
 #include <QSettings>
 #include <QSplitter>
 #include <QLineEdit>
+#include <QComboBox>
 #include <QCheckBox>
 #include <QToolBar>
 #include <QAction>
@@ -39,6 +40,7 @@
 #include "inputoutputmanager.h"
 #include "inputoutputmap.h"
 #include "outputpatch.h"
+#include "universe.h"
 #include "inputpatch.h"
 #include "apputil.h"
 #include "doc.h"
@@ -63,6 +65,7 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     , m_deleteUniverseAction(NULL)
     , m_uniNameEdit(NULL)
     , m_uniPassthroughCheck(NULL)
+    , m_uniMergeCombo(NULL)
     , m_editor(NULL)
     , m_editorUniverse(UINT_MAX)
 {
@@ -122,6 +125,16 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     m_uniPassthroughCheck->setFont(font);
     m_toolbar->addWidget(m_uniPassthroughCheck);
 
+    /* Same order as Universe::PassthroughMerge */
+    m_uniMergeCombo = new QComboBox(this);
+    m_uniMergeCombo->addItem(tr("HTP merge"));
+    m_uniMergeCombo->addItem(tr("LTP merge"));
+    m_uniMergeCombo->addItem(tr("Input priority"));
+    m_uniMergeCombo->setToolTip(tr("How the input values are merged with the QLC+ output"));
+    m_uniMergeCombo->setFont(font);
+    m_uniMergeCombo->setEnabled(false);
+    m_toolbar->addWidget(m_uniMergeCombo);
+
     m_splitter->widget(0)->layout()->addWidget(m_toolbar);
 
     connect(m_uniNameEdit, SIGNAL(textChanged(QString)),
@@ -130,6 +143,9 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     connect(m_uniPassthroughCheck, SIGNAL(toggled(bool)),
             this, SLOT(slotPassthroughChanged(bool)));
 
+    connect(m_uniMergeCombo, SIGNAL(activated(int)),
+            this, SLOT(slotPassthroughMergeChanged(int)));
+
     /* Universes list */
     m_list = new QListWidget(this);
     m_list->setItemDelegate(new UniverseItemWidget(m_list));
@@ -212,6 +228,7 @@ void InputOutputManager::updateList()
         m_uniNameEdit->setEnabled(true);
         m_uniNameEdit->setText(m_ioMap->getUniverseNameByIndex(0));
         m_uniPassthroughCheck->setChecked(m_ioMap->getUniversePassthrough(0));
+        m_uniMergeCombo->setCurrentIndex(m_ioMap->getUniversePassthroughMerge(0));
     }
 }
 
@@ -323,6 +340,8 @@ void InputOutputManager::slotCurrentItemChanged()
     int uniIdx = m_list->currentRow();
     m_uniNameEdit->setText(m_ioMap->getUniverseNameByIndex(uniIdx));
     m_uniPassthroughCheck->setChecked(m_ioMap->getUniversePassthrough(uniIdx));
+    m_uniMergeCombo->setCurrentIndex(m_ioMap->getUniversePassthroughMerge(uniIdx));
+    m_uniMergeCombo->setEnabled(m_uniPassthroughCheck->isChecked());
 }
 
 void InputOutputManager::slotMappingChanged()
@@ -420,6 +439,18 @@ void InputOutputManager::slotPassthroughChanged(bool checked)
 
     int uniIdx = m_list->currentRow();
     m_ioMap->setUniversePassthrough(uniIdx, checked);
+    m_uniMergeCombo->setEnabled(checked);
+    m_doc->inputOutputMap()->saveDefaults();
+}
+
+void InputOutputManager::slotPassthroughMergeChanged(int index)
+{
+    QListWidgetItem *currItem = m_list->currentItem();
+    if (currItem == NULL)
+        return;
+
+    int uniIdx = m_list->currentRow();
+    m_ioMap->setUniversePassthroughMerge(uniIdx, index);
     m_doc->inputOutputMap()->saveDefaults();
 }
 
@@ -29,6 +29,7 @@ class QListWidget;
 class QSplitter;
 class QLineEdit;
 class QCheckBox;
+class QComboBox;
 class QToolBar;
 class QTimer;
 class QIcon;
@@ -94,6 +95,7 @@ private slots:
     void slotUniverseNameChanged(QString name);
     void slotUniverseAdded(quint32 universe);
     void slotPassthroughChanged(bool checked);
+    void slotPassthroughMergeChanged(int index);
 
 protected:
     /** @reimp */
@@ -107,6 +109,7 @@ private:
     QAction* m_deleteUniverseAction;
     QLineEdit *m_uniNameEdit;
     QCheckBox *m_uniPassthroughCheck;
+    QComboBox *m_uniMergeCombo;
     QListWidget *m_list;
     QIcon m_icon;
     QTimer* m_timer;
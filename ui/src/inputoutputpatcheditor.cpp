@@ -615,11 +615,8 @@ void InputOutputPatchEditor::updateProfileItem(const QString& name, QTreeWidgetI
     Q_ASSERT(item != NULL);
 
     item->setText(KProfileColumnName, name);
-    QLCInputProfile * prof = m_ioMap->profile(name);
-    if (prof)
-    {
-        item->setText(KProfileColumnType, QLCInputProfile::typeToString(prof->type()));
-    }
+    if (name != KInputNone)
+        item->setText(KProfileColumnType, QLCInputProfile::typeToString(m_ioMap->profileType(name)));
 
     item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
     if (m_currentProfileName == name)
@@ -825,6 +822,15 @@ edit:
        the actual object (with QLCInputProfile::operator=()). */
     *profile = *ite.profile();
 
+    /* The patches using the profile hold a table of its channels,
+       so set it again to build it from the new channels */
+    for (quint32 i = 0; i < m_ioMap->universesCount(); i++)
+    {
+        InputPatch *ip = m_ioMap->inputPatch(i);
+        if (ip != NULL && ip->profile() == profile)
+            ip->set(profile);
+    }
+
     /* Remove spaces from these */
     QString manufacturer = ite.profile()->manufacturer().remove(QChar(' '));
     QString model = ite.profile()->model().remove(QChar(' '));
@@ -28,6 +28,7 @@
 #include <QSplitter>
 #include <QSettings>
 #include <QToolBar>
+#include <QTimer>
 #include <QSpinBox>
 #include <QAction>
 #include <QScreen>
@@ -42,6 +43,7 @@
 #include "fixtureselection.h"
 #include "monitorfixture.h"
 #include "monitorlayout.h"
+#include "loadgovernor.h"
 #include "universe.h"
 #include "monitor.h"
 #include "apputil.h"
@@ -51,6 +53,7 @@
 
 #define SETTINGS_GEOMETRY "monitor/geometry"
 #define SETTINGS_VSPLITTER "monitor/vsplitter"
+#define SETTINGS_REFRESH_RATE "monitor/refreshrate"
 
 Monitor* Monitor::s_instance = NULL;
 
@@ -62,6 +65,7 @@ Monitor::Monitor(QWidget* parent, Doc* doc, Qt::WindowFlags f)
     : QWidget(parent, f)
     , m_doc(doc)
     , m_props(NULL)
+    , m_refreshTimer(NULL)
     , m_DMXToolBar(NULL)
     , m_scrollArea(NULL)
     , m_monitorWidget(NULL)
@@ -94,6 +98,54 @@ Monitor::Monitor(QWidget* parent, Doc* doc, Qt::WindowFlags f)
             this, SLOT(slotFixtureRemoved(quint32)));
     connect(m_doc->masterTimer(), SIGNAL(functionStarted(quint32)),
             this, SLOT(slotFunctionStarted(quint32)));
+
+    m_refreshTimer = new QTimer(this);
+    slotUpdateRefreshInterval();
+    connect(m_refreshTimer, SIGNAL(timeout()),
+            this, SLOT(slotRefreshTimeout()));
+    connect(m_doc->loadGovernor(), SIGNAL(levelChanged(int)),
+            this, SLOT(slotUpdateRefreshInterval()));
+    m_refreshTimer->start();
+}
+
+/*****************************************************************************
+ * Refresh
+ *****************************************************************************/
+
+int Monitor::refreshRate() const
+{
+    int screenRate = 60;
+    if (QGuiApplication::primaryScreen() != NULL)
+        screenRate = qMax(1, qRound(QGuiApplication::primaryScreen()->refreshRate()));
+
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_REFRESH_RATE);
+    if (var.isValid() && var.toInt() > 0)
+        return qMin(var.toInt(), screenRate);
+
+    return screenRate;
+}
+
+void Monitor::slotUpdateRefreshInterval()
+{
+    /* The monitor gives way to the engine when it's overloaded */
+    m_refreshTimer->setInterval(1000 / m_doc->loadGovernor()->scaledRate(refreshRate()));
+}
+
+void Monitor::slotRefreshTimeout()
+{
+    if (isVisible() == false)
+        return;
+
+    if (m_props->displayMode() == MonitorProperties::DMX)
+    {
+        foreach (MonitorFixture *mof, m_monitorFixtures)
+            mof->updateValues();
+    }
+    else if (m_graphicsView != NULL)
+    {
+        m_graphicsView->updateFixturesValues();
+    }
 }
 
 void Monitor::slotFunctionStarted(quint32 id)
@@ -99,6 +99,26 @@ protected:
     Doc* m_doc;
     MonitorProperties *m_props;
 
+    /*********************************************************************
+     * Refresh
+     *********************************************************************/
+protected:
+    /** Return the rate in Hz to refresh the fixtures values: the screen
+     *  refresh rate, or the lower rate set in the settings */
+    int refreshRate() const;
+
+protected slots:
+    /** Update the fixtures of the current view whose values changed */
+    void slotRefreshTimeout();
+
+    /** Apply the refresh rate allowed by the LoadGovernor level */
+    void slotUpdateRefreshInterval();
+
+protected:
+    /** Timer to refresh the fixtures values at a fixed rate,
+     *  regardless of how often the universes are written */
+    QTimer *m_refreshTimer;
+
     /*********************************************************************
      * Running functions
      *********************************************************************/
@@ -43,6 +43,7 @@ MonitorFixture::MonitorFixture(QWidget* parent, Doc* doc)
     m_fixture = Fixture::invalidId();
     m_channelStyle = MonitorProperties::DMXChannels;
     m_valueStyle = MonitorProperties::DMXValues;
+    m_valuesChanged = false;
 
     new QGridLayout(this);
     layout()->setMargin(3);
@@ -170,6 +171,8 @@ void MonitorFixture::setFixture(quint32 fxi_id)
             label->setText(str.asprintf("%.3d", uchar(fxValues.at(i))));
             m_valueLabels.append(label);
         }
+        m_lastValues = fxValues;
+        m_valuesChanged = false;
         connect(fxi, SIGNAL(valuesChanged()), this, SLOT(slotValuesChanged()));
     }
 }
@@ -246,6 +249,16 @@ void MonitorFixture::slotValueStyleChanged(MonitorProperties::ValueStyle style)
 
 void MonitorFixture::slotValuesChanged()
 {
+    m_valuesChanged = true;
+}
+
+void MonitorFixture::updateValues()
+{
+    if (m_valuesChanged == false)
+        return;
+
+    m_valuesChanged = false;
+
     /* Check that this MonitorFixture represents a fixture */
     if (m_fixture == Fixture::invalidId())
         return;
@@ -265,6 +278,13 @@ void MonitorFixture::slotValuesChanged()
         Q_ASSERT(label != NULL);
         QString str;
 
+        /* Skip the channels showing the same value already */
+        if (i < m_lastValues.size() && m_lastValues.at(i) == fxValues.at(i))
+        {
+            i++;
+            continue;
+        }
+
         /* Set the label's text to reflect the changed value */
         if (m_valueStyle == MonitorProperties::DMXValues)
         {
@@ -278,4 +298,6 @@ void MonitorFixture::slotValuesChanged()
         }
         i++;
     }
+
+    m_lastValues = fxValues;
 }
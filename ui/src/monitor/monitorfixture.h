@@ -73,13 +73,26 @@ protected:
     /********************************************************************
      * Values
      ********************************************************************/
+public:
+    /** Update the value labels of the channels that changed since
+     *  the last update. Does nothing if the values didn't change */
+    void updateValues();
+
 public slots:
     void slotValueStyleChanged(MonitorProperties::ValueStyle style);
+
+    /** Mark the fixture values as changed, for the next updateValues() */
     void slotValuesChanged();
 
 protected:
     QList <QLabel*> m_valueLabels;
     MonitorProperties::ValueStyle m_valueStyle;
+
+    /** Flag raised when the fixture values change */
+    bool m_valuesChanged;
+
+    /** The fixture values shown by the value labels */
+    QByteArray m_lastValues;
 };
 
 /** @} */
@@ -41,6 +41,7 @@ MonitorFixtureItem::MonitorFixtureItem(Doc *doc, quint32 fid)
     , m_fid(fid)
     , m_gelColor(QColor())
     , m_labelVisibility(false)
+    , m_valuesChanged(true)
 {
     Q_ASSERT(doc != NULL);
 
@@ -236,8 +237,8 @@ MonitorFixtureItem::MonitorFixtureItem(Doc *doc, quint32 fid)
 
         m_heads.append(fxiItem);
     }
-    slotUpdateValues();
-    connect(fxi, SIGNAL(valuesChanged()), this, SLOT(slotUpdateValues()));
+    updateValues();
+    connect(fxi, SIGNAL(valuesChanged()), this, SLOT(slotValuesChanged()));
 }
 
 MonitorFixtureItem::~MonitorFixtureItem()
@@ -246,7 +247,7 @@ MonitorFixtureItem::~MonitorFixtureItem()
     {
         Fixture* fxi = m_doc->fixture(m_fid);
         if (fxi != NULL)
-            disconnect(fxi, SIGNAL(valuesChanged()), this, SLOT(slotUpdateValues()));
+            disconnect(fxi, SIGNAL(valuesChanged()), this, SLOT(slotValuesChanged()));
     }
 
     foreach(FixtureHead *head, m_heads)
@@ -423,8 +424,18 @@ FixtureHead::ShutterState MonitorFixtureItem::computeShutter(const FixtureHead *
     return result;
 }
 
-void MonitorFixtureItem::slotUpdateValues()
+void MonitorFixtureItem::slotValuesChanged()
 {
+    m_valuesChanged = true;
+}
+
+void MonitorFixtureItem::updateValues()
+{
+    if (m_valuesChanged == false)
+        return;
+
+    m_valuesChanged = false;
+
     /* Check that this MonitorFixture represents a fixture */
     if (m_fid == Fixture::invalidId())
         return;
@@ -436,6 +447,12 @@ void MonitorFixtureItem::slotUpdateValues()
 
     QByteArray fxValues = fxi->channelValues();
 
+    /* Values may go back and forth between two updates */
+    if (fxValues == m_lastValues)
+        return;
+
+    m_lastValues = fxValues;
+
     bool needUpdate = false;
 
     foreach(FixtureHead *head, m_heads)
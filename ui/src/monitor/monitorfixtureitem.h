@@ -115,10 +115,13 @@ public:
     /** Show/hide this fixture item label */
     void showLabel(bool visible);
 
+    /** Update the heads rendering with the fixture values,
+     *  if they changed since the last update */
+    void updateValues();
+
 protected slots:
-    /** Update the fixture values for rendering, passing the
-     *  universe array of values */
-    void slotUpdateValues();
+    /** Mark the fixture values as changed, for the next updateValues() */
+    void slotValuesChanged();
     void slotStrobeTimer();
 
 protected:
@@ -170,6 +173,12 @@ private:
     QFont m_font;
 
     QRect m_labelRect;
+
+    /** Flag raised when the fixture values change */
+    bool m_valuesChanged;
+
+    /** The fixture values of the last update */
+    QByteArray m_lastValues;
 };
 
 /** @} */
@@ -56,6 +56,12 @@ void MonitorGraphicsView::setGridSize(QSize size)
     }
 }
 
+void MonitorGraphicsView::updateFixturesValues()
+{
+    foreach (MonitorFixtureItem *item, m_fixtures)
+        item->updateValues();
+}
+
 void MonitorGraphicsView::setGridMetrics(float value)
 {
     m_unitValue = value;
@@ -94,6 +94,10 @@ public:
      */
     void updateFixture(quint32 id);
 
+    /** Update the rendering of the fixtures whose values changed.
+     *  Their repaints are merged by the scene in a single update */
+    void updateFixturesValues();
+
     /** Set a background image for the view */
     void setBackgroundImage(QString filename);
 
@@ -37,12 +37,17 @@
 
 #include "fixtureselection.h"
 #include "speeddialwidget.h"
+#include "loadgovernor.h"
 #include "rgbmatrixeditor.h"
 #include "qlcmacros.h"
 #include "rgbimage.h"
 #include "sequence.h"
 #include "rgbitem.h"
 #include "rgbtext.h"
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+  #include "rgbvideo.h"
+  #include "video.h"
+#endif
 #include "apputil.h"
 #include "scene.h"
 
@@ -78,6 +83,7 @@ RGBMatrixEditor::RGBMatrixEditor(QWidget* parent, RGBMatrix* mtx, Doc* doc)
     m_scene->setBackgroundBrush(gradient);
 
     connect(m_previewTimer, SIGNAL(timeout()), this, SLOT(slotPreviewTimeout()));
+    connect(m_doc->loadGovernor(), SIGNAL(levelChanged(int)), this, SLOT(slotLoadLevelChanged()));
     connect(m_doc, SIGNAL(modeChanged(Doc::Mode)), this, SLOT(slotModeChanged(Doc::Mode)));
     connect(m_doc, SIGNAL(fixtureGroupAdded(quint32)), this, SLOT(slotFixtureGroupAdded()));
     connect(m_doc, SIGNAL(fixtureGroupRemoved(quint32)), this, SLOT(slotFixtureGroupRemoved()));
@@ -238,7 +244,7 @@ void RGBMatrixEditor::init()
 
     m_preview->setScene(m_scene);
     if (createPreviewItems() == true)
-        m_previewTimer->start(MasterTimer::tick());
+        m_previewTimer->start(previewInterval());
 }
 
 void RGBMatrixEditor::updateSpeedDials()
@@ -334,6 +340,7 @@ void RGBMatrixEditor::updateExtraOptions()
         m_textGroup->hide();
         m_imageGroup->show();
         m_offsetGroup->show();
+        m_imageAnimationCombo->setEnabled(true);
 
         RGBImage* image = static_cast<RGBImage*> (m_matrix->algorithm());
         Q_ASSERT(image != NULL);
@@ -347,6 +354,20 @@ void RGBMatrixEditor::updateExtraOptions()
         m_yOffsetSpin->setValue(image->yOffset());
 
     }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    else if (m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        /* A video fills the whole grid, so it has no animation nor offsets */
+        m_textGroup->hide();
+        m_imageGroup->show();
+        m_offsetGroup->hide();
+        m_imageAnimationCombo->setEnabled(false);
+
+        RGBVideo* video = static_cast<RGBVideo*> (m_matrix->algorithm());
+        Q_ASSERT(video != NULL);
+        m_imageEdit->setText(video->filename());
+    }
+#endif
     else if (m_matrix->algorithm()->type() == RGBAlgorithm::Text)
     {
         m_textGroup->show();
@@ -597,13 +618,15 @@ bool RGBMatrixEditor::createPreviewItems()
     if (m_previewHandler->m_map.isEmpty())
         return false;
 
+    const QVector<GroupHead> &heads = grp->headGrid();
+
     for (int x = 0; x < grp->size().width(); x++)
     {
         for (int y = 0; y < grp->size().height(); y++)
         {
             QLCPoint pt(x, y);
 
-            if (grp->headsMap().contains(pt) == true)
+            if (heads.at(y * grp->size().width() + x).isValid() == true)
             {
                 RGBItem *item;
                 if (m_shapeButton->isChecked() == false)
@@ -637,12 +660,24 @@ bool RGBMatrixEditor::createPreviewItems()
     return true;
 }
 
+int RGBMatrixEditor::previewInterval() const
+{
+    /* The preview gives way to the engine when it's overloaded */
+    return m_doc->loadGovernor()->scaledInterval(MasterTimer::tick());
+}
+
+void RGBMatrixEditor::slotLoadLevelChanged()
+{
+    if (m_previewTimer->isActive())
+        m_previewTimer->start(previewInterval());
+}
+
 void RGBMatrixEditor::slotPreviewTimeout()
 {
     if (m_matrix->duration() <= 0)
         return;
 
-    m_previewIterator += MasterTimer::tick();
+    m_previewIterator += m_previewTimer->interval();
     uint elapsed = 0;
     while (m_previewIterator >= MAX(m_matrix->duration(), MasterTimer::tick()))
     {
@@ -654,9 +689,9 @@ void RGBMatrixEditor::slotPreviewTimeout()
         m_previewIterator -= MAX(m_matrix->duration(), MasterTimer::tick());
         elapsed += MAX(m_matrix->duration(), MasterTimer::tick());
     }
-    for (int y = 0; y < m_previewHandler->m_map.size(); y++)
+    for (int y = 0; y < m_previewHandler->m_map.height(); y++)
     {
-        for (int x = 0; x < m_previewHandler->m_map[y].size(); x++)
+        for (int x = 0; x < m_previewHandler->m_map.width(); x++)
         {
             QLCPoint pt(x, y);
             if (m_previewHash.contains(pt) == true)
@@ -841,6 +876,18 @@ void RGBMatrixEditor::slotImageEdited()
         }
         slotRestartTest();
     }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    else if (m_matrix->algorithm() != NULL && m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        RGBVideo* algo = static_cast<RGBVideo*> (m_matrix->algorithm());
+        Q_ASSERT(algo != NULL);
+        {
+            QMutexLocker algorithmLocker(&m_matrix->algorithmMutex());
+            algo->setFilename(m_imageEdit->text());
+        }
+        slotRestartTest();
+    }
+#endif
 }
 
 void RGBMatrixEditor::slotImageButtonClicked()
@@ -865,6 +912,28 @@ void RGBMatrixEditor::slotImageButtonClicked()
             slotRestartTest();
         }
     }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    else if (m_matrix->algorithm() != NULL && m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        RGBVideo* algo = static_cast<RGBVideo*> (m_matrix->algorithm());
+        Q_ASSERT(algo != NULL);
+
+        QString path = algo->filename();
+        path = QFileDialog::getOpenFileName(this,
+                                            tr("Select video"),
+                                            path,
+                                            tr("Video Files (%1)").arg(Video::getVideoCapabilities().join(" ")));
+        if (path.isEmpty() == false)
+        {
+            {
+                QMutexLocker algorithmLocker(&m_matrix->algorithmMutex());
+                algo->setFilename(path);
+            }
+            m_imageEdit->setText(path);
+            slotRestartTest();
+        }
+    }
+#endif
 }
 
 void RGBMatrixEditor::slotImageAnimationActivated(const QString& text)
@@ -993,7 +1062,7 @@ void RGBMatrixEditor::slotRestartTest()
     }
 
     if (createPreviewItems() == true)
-        m_previewTimer->start(MasterTimer::tick());
+        m_previewTimer->start(previewInterval());
 
 }
 
@@ -1129,9 +1198,9 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
             step.fadeIn = m_matrix->fadeInSpeed();
             step.fadeOut = m_matrix->fadeOutSpeed();
 
-            for (int y = 0; y < m_previewHandler->m_map.size(); y++)
+            for (int y = 0; y < m_previewHandler->m_map.height(); y++)
             {
-                for (int x = 0; x < m_previewHandler->m_map[y].size(); x++)
+                for (int x = 0; x < m_previewHandler->m_map.width(); x++)
                 {
                     uint col = m_previewHandler->m_map[y][x];
                     QColor rgb = QColor(col);
@@ -1173,7 +1242,7 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
         if (testRunning == true)
             m_testButton->click();
         else if (createPreviewItems() == true)
-            m_previewTimer->start(MasterTimer::tick());
+            m_previewTimer->start(previewInterval());
     }
 }
 
@@ -69,8 +69,12 @@ private:
 
     bool createPreviewItems();
 
+    /** Return the preview refresh interval allowed by the LoadGovernor */
+    int previewInterval() const;
+
 private slots:
     void slotPreviewTimeout();
+    void slotLoadLevelChanged();
     void slotNameEdited(const QString& text);
     void slotSpeedDialToggle(bool state);
     void slotPatternActivated(const QString& text);
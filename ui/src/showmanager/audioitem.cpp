@@ -17,11 +17,21 @@
   limitations under the License.
 */
 
+#include <QStyleOptionGraphicsItem>
+#include <QCryptographicHash>
 #include <QApplication>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QPainter>
 #include <qmath.h>
 #include <QDebug>
 #include <QMenu>
+#include <QFile>
+#include <QDir>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QStandardPaths>
+#endif
 
 #include "audioitem.h"
 #include "trackitem.h"
@@ -35,7 +45,8 @@ AudioItem::AudioItem(Audio *aud, ShowFunction *func)
     , m_previewLeftAction(NULL)
     , m_previewRightAction(NULL)
     , m_previewStereoAction(NULL)
-    , m_preview(NULL)
+    , m_peakChannels(1)
+    , m_previewThread(NULL)
 {
     Q_ASSERT(aud != NULL);
 
@@ -66,6 +77,12 @@ AudioItem::AudioItem(Audio *aud, ShowFunction *func)
             this, SLOT(slotAudioPreviewStereo()));
 }
 
+AudioItem::~AudioItem()
+{
+    if (m_previewThread != NULL)
+        m_previewThread->wait();
+}
+
 void AudioItem::calculateWidth()
 {
     int newWidth = 0;
@@ -90,11 +107,12 @@ void AudioItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
 
     ShowItem::paint(painter, option, widget);
 
-    if (m_preview != NULL)
-    {
-        // show preview here
-        painter->drawPixmap(0, 0, m_preview->scaled(m_width, TRACK_HEIGHT - 4));
-    }
+    bool left = m_previewLeftAction->isChecked() || m_previewStereoAction->isChecked();
+    bool right = m_previewRightAction->isChecked() || m_previewStereoAction->isChecked();
+
+    // show preview here
+    if ((left || right) && m_peakLevels.isEmpty() == false)
+        drawWaveform(painter, option, left, right);
 
     if (m_audio->fadeInSpeed() != 0)
     {
@@ -144,36 +162,127 @@ void AudioItem::slotAudioChanged(quint32)
     calculateWidth();
     if (m_function)
         m_function->setDuration(m_audio->totalDuration());
+
+    // the source file might have changed. Peaks are reloaded from the cache
+    if (m_previewThread == NULL && m_peakLevels.isEmpty() == false)
+    {
+        m_peakLevels.clear();
+        startPreview();
+    }
 }
 
 void AudioItem::slotAudioPreviewLeft()
 {
     m_previewRightAction->setChecked(false);
     m_previewStereoAction->setChecked(false);
-    PreviewThread *waveformThread = new PreviewThread;
-    waveformThread->setAudioItem(this);
-    connect(waveformThread, SIGNAL(finished()), waveformThread, SLOT(deleteLater()));
-    waveformThread->start();
+    startPreview();
 }
 
 void AudioItem::slotAudioPreviewRight()
 {
     m_previewLeftAction->setChecked(false);
     m_previewStereoAction->setChecked(false);
-    PreviewThread *waveformThread = new PreviewThread;
-    waveformThread->setAudioItem(this);
-    connect(waveformThread, SIGNAL(finished()), waveformThread, SLOT(deleteLater()));
-    waveformThread->start();
+    startPreview();
 }
 
 void AudioItem::slotAudioPreviewStereo()
 {
     m_previewLeftAction->setChecked(false);
     m_previewRightAction->setChecked(false);
-    PreviewThread *waveformThread = new PreviewThread;
-    waveformThread->setAudioItem(this);
-    connect(waveformThread, SIGNAL(finished()), waveformThread, SLOT(deleteLater()));
-    waveformThread->start();
+    startPreview();
+}
+
+void AudioItem::slotPreviewReady()
+{
+    if (m_previewThread == NULL)
+        return;
+
+    m_peakLevels = m_previewThread->peakLevels();
+    m_peakChannels = m_previewThread->peakChannels();
+    m_previewThread = NULL;
+    update();
+}
+
+void AudioItem::startPreview()
+{
+    // the peaks contain all the channels, so a different
+    // channel selection just needs a repaint
+    if (m_peakLevels.isEmpty() == false || m_previewThread != NULL)
+    {
+        update();
+        return;
+    }
+
+    if (m_audio->getAudioDecoder() == NULL)
+        return;
+
+    m_previewThread = new PreviewThread;
+    m_previewThread->setAudioItem(this);
+    connect(m_previewThread, SIGNAL(finished()), this, SLOT(slotPreviewReady()));
+    connect(m_previewThread, SIGNAL(finished()), m_previewThread, SLOT(deleteLater()));
+    m_previewThread->start();
+}
+
+void AudioItem::drawWaveform(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                             bool left, bool right)
+{
+    // the item shows 50 / m_timeScale pixels per second, so pick the
+    // level with the closest resolution above it
+    int level = 0;
+    while (level < m_peakLevels.count() - 1 && (2 << level) <= m_timeScale)
+        level++;
+
+    const QByteArray &peaks = m_peakLevels.at(level);
+    int count = peaks.size() / m_peakChannels;
+    if (count == 0 || m_width <= 0)
+        return;
+
+    float ratio = float(count) / float(m_width);
+    int firstX = qMax(0, qFloor(option->exposedRect.left()));
+    int lastX = qMin(m_width - 1, qCeil(option->exposedRect.right()));
+    bool stereo = left && right && m_peakChannels == 2;
+    int rightOffset = m_peakChannels == 2 ? 1 : 0;
+
+    painter->setPen(QPen(Qt::black, 1));
+
+    for (int x = firstX; x <= lastX; x++)
+    {
+        int from = qMin(count - 1, int(float(x) * ratio));
+        int to = qMin(count, qMax(from + 1, int(float(x + 1) * ratio)));
+        uchar peakLeft = 0, peakRight = 0;
+
+        for (int i = from; i < to; i++)
+        {
+            peakLeft = qMax(peakLeft, uchar(peaks.at(i * m_peakChannels)));
+            peakRight = qMax(peakRight, uchar(peaks.at(i * m_peakChannels + rightOffset)));
+        }
+
+        if (stereo)
+        {
+            int heightLeft = qMin(38, (76 * peakLeft) / 255);
+            int heightRight = qMin(38, (76 * peakRight) / 255);
+
+            if (heightLeft > 1)
+                painter->drawLine(x, 19 - (heightLeft / 2), x, 19 + (heightLeft / 2));
+            else
+                painter->drawLine(x, 19, x + 1, 19);
+
+            if (heightRight > 1)
+                painter->drawLine(x, 51 - (heightRight / 2), x, 51 + (heightRight / 2));
+            else
+                painter->drawLine(x, 51, x + 1, 51);
+        }
+        else
+        {
+            // a single channel is drawn twice as high
+            int height = qMin(76, (152 * (left ? peakLeft : peakRight)) / 255);
+
+            if (height > 1)
+                painter->drawLine(x, 38 - (height / 2), x, 38 + (height / 2));
+            else
+                painter->drawLine(x, 38, x + 1, 38);
+        }
+    }
 }
 
 void AudioItem::contextMenuEvent(QGraphicsSceneContextMenuEvent *)
@@ -206,9 +315,26 @@ void AudioItem::contextMenuEvent(QGraphicsSceneContextMenuEvent *)
     menu.exec(QCursor::pos());
 }
 
+/*********************************************************************
+ * Preview thread
+ *********************************************************************/
+
 void PreviewThread::setAudioItem(AudioItem *item)
 {
     m_item = item;
+    m_fileName = item->m_audio->getSourceFileName();
+    m_doc = item->m_audio->doc();
+    m_peakChannels = 1;
+}
+
+QList<QByteArray> PreviewThread::peakLevels() const
+{
+    return m_peakLevels;
+}
+
+int PreviewThread::peakChannels() const
+{
+    return m_peakChannels;
 }
 
 qint32 PreviewThread::getSample(unsigned char *data, quint32 idx, int sampleSize)
@@ -232,171 +358,200 @@ qint32 PreviewThread::getSample(unsigned char *data, quint32 idx, int sampleSize
     return value;
 }
 
-void PreviewThread::run()
+QString PreviewThread::cacheFile() const
 {
-    bool left = m_item->m_previewLeftAction->isChecked() | m_item->m_previewStereoAction->isChecked();
-    bool right = m_item->m_previewRightAction->isChecked() | m_item->m_previewStereoAction->isChecked();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    QFileInfo info(m_fileName);
+    if (info.exists() == false)
+        return QString();
+
+    // hash the file identity rather than its whole content
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    if (dir.exists(AUDIO_PEAKS_DIR) == false)
+        dir.mkpath(AUDIO_PEAKS_DIR);
+    dir.cd(AUDIO_PEAKS_DIR);
+
+    return dir.absoluteFilePath(QString("%1.peaks").arg(QString(hash.result().toHex())));
+#else
+    return QString();
+#endif
+}
 
-    if ((left || right) && m_item->m_audio->getAudioDecoder() != NULL)
-    {
-        AudioDecoder *ad = m_item->m_audio->doc()->audioPluginCache()->getDecoderForFile(m_item->m_audio->getSourceFileName());
-        AudioParameters ap = ad->audioParameters();
-        ad->seek(0);
-        // 1- find out how many samples have to be represented on a single pixel on a 1:1 time scale
-        int sampleSize = ap.sampleSize();
-        int channels = ap.channels();
-        int oneSecondSamples = ap.sampleRate() * channels;
-        int onePixelSamples = oneSecondSamples / 50;
-
-        qint32 maxValue = 0;
-        // 24 and 32 bit samples would produce a RMS too high, so let's
-        // work on 16bit values
-        if (sampleSize > 2)
-            sampleSize = 2;
-
-        if (left && right)
-            maxValue = 0x7F << (8 * (sampleSize - 1));
-        else
-            maxValue = 0x3F << (8 * (sampleSize - 1));
-
-        quint32 onePixelReadLen = onePixelSamples * sampleSize;
-
-        // 2- decode the whole file and fill a QPixmap with a sample block RMS value for each pixel
-        qint64 dataRead = 1;
-        unsigned char audioData[onePixelReadLen * 4];
-        quint32 audioDataOffset = 0;
-        QPixmap *preview = new QPixmap((50 * m_item->m_audio->totalDuration()) / 1000, 76);
-        preview->fill(Qt::transparent);
-        QPainter p(preview);
-        int xpos = 0;
-
-        qDebug() << "Audio duration:" << m_item->m_audio->totalDuration() <<
-                    ", channels:" << channels << ", pixmap width:" << preview->width() <<
-                    ", maxValue:" << maxValue << ", samples:" << sampleSize;
-        qDebug() << "Samples per second:" << oneSecondSamples << ", for one pixel:" << onePixelSamples <<
-                    ", onePixelReadLen:" << onePixelReadLen;
-
-        delete m_item->m_preview;
-        m_item->m_preview = NULL;
-        m_item->update();
-
-        while (dataRead)
-        {
-            quint32 tmpExceedData = 0;
-            if (audioDataOffset < onePixelReadLen)
-            {
-                dataRead = ad->read((char *)audioData + audioDataOffset, onePixelReadLen * 2);
-                if (dataRead > 0)
-                {
-                    if((quint32)dataRead + audioDataOffset >= onePixelReadLen)
-                    {
-                        tmpExceedData = (dataRead + audioDataOffset) - onePixelReadLen;
-                        dataRead = onePixelReadLen;
-                    }
-                    else
-                    {
-                        qDebug() << "Not enough data. Requested:" << onePixelReadLen << "got:" << dataRead;
-                        audioDataOffset = dataRead;
-                        continue;
-                    }
-                }
-            }
-            else
-            {
-                dataRead = onePixelReadLen;
-                tmpExceedData = audioDataOffset - onePixelReadLen;
-            }
+bool PreviewThread::loadPeaks(const QString &path)
+{
+    QFile file(path);
+    if (path.isEmpty() || file.open(QIODevice::ReadOnly) == false)
+        return false;
 
-            if (dataRead == onePixelReadLen)
-            {
-                quint32 i = 0;
-                // calculate the RMS value (peak) for this data block
-                qint64 rmsLeft = 0;
-                qint64 rmsRight = 0;
-                bool done = false;
-                while (!done)
-                {
-                    if (left)
-                    {
-                        qint32 sampleVal = getSample(audioData, i, sampleSize);
-                        rmsLeft += (sampleVal * sampleVal);
-                    }
-                    i += sampleSize;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
 
-                    if (channels == 2)
-                    {
-                        if (right)
-                        {
-                            qint32 sampleVal = getSample(audioData, i, sampleSize);
-                            rmsRight += (sampleVal * sampleVal);
-                        }
-                        i += sampleSize;
-                    }
-
-                    if (i >= dataRead)
-                    {
-                        //qDebug() << "i:" << i << "xpos:" << xpos;
-                        done = true;
-                    }
-                }
+    quint32 magic = 0, version = 0;
+    qint32 channels = 0;
+    stream >> magic >> version;
+    if (magic != AUDIO_PEAKS_MAGIC || version != AUDIO_PEAKS_VERSION)
+        return false;
 
-                if (left)
-                    rmsLeft = sqrt(rmsLeft / onePixelSamples);
-                if (right)
-                    rmsRight = sqrt(rmsRight / onePixelSamples);
-                //qDebug() << "sample" << i << "RMS right:" << rmsRight << ", RMS left:" << rmsLeft;
+    stream >> channels >> m_peakLevels;
 
-                // 3- Draw the actual waveform
-                unsigned short lineHeightLeft = 0, lineHeightRight = 0;
+    if (stream.status() != QDataStream::Ok || channels < 1 || m_peakLevels.isEmpty())
+    {
+        qWarning() << Q_FUNC_INFO << "Damaged peaks file" << path;
+        m_peakLevels.clear();
+        return false;
+    }
 
-                if (left)
-                    lineHeightLeft = (76 * rmsLeft) / maxValue;
-                if (right)
-                    lineHeightRight = (76 * rmsRight) / maxValue;
+    m_peakChannels = channels;
+    return true;
+}
+
+void PreviewThread::savePeaks(const QString &path)
+{
+    QFile file(path);
+    if (path.isEmpty() || file.open(QIODevice::WriteOnly) == false)
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream << quint32(AUDIO_PEAKS_MAGIC) << quint32(AUDIO_PEAKS_VERSION)
+           << qint32(m_peakChannels) << m_peakLevels;
+}
 
-                if (left && right)
+void PreviewThread::run()
+{
+    QString cachePath = cacheFile();
+    if (loadPeaks(cachePath))
+        return;
+
+    AudioDecoder *ad = m_doc->audioPluginCache()->getDecoderForFile(m_fileName);
+    if (ad == NULL)
+        return;
+
+    AudioParameters ap = ad->audioParameters();
+    ad->seek(0);
+    // 1- find out how many samples have to be represented on a single pixel on a 1:1 time scale
+    int sampleSize = ap.sampleSize();
+    int channels = ap.channels();
+    int oneSecondSamples = ap.sampleRate() * channels;
+    int onePixelSamples = oneSecondSamples / AUDIO_PEAKS_RATE;
+
+    // 24 and 32 bit samples would produce a RMS too high, so let's
+    // work on 16bit values
+    if (sampleSize > 2)
+        sampleSize = 2;
+
+    qint32 maxValue = 0x7F << (8 * (sampleSize - 1));
+    quint32 onePixelReadLen = onePixelSamples * sampleSize;
+
+    m_peakChannels = channels == 2 ? 2 : 1;
+
+    // 2- decode the whole file and store a sample block RMS value for each pixel
+    qint64 dataRead = 1;
+    QByteArray audioBuffer(onePixelReadLen * 4, 0);
+    unsigned char *audioData = (unsigned char *)audioBuffer.data();
+    quint32 audioDataOffset = 0;
+    QByteArray peaks;
+
+    qDebug() << "Audio file:" << m_fileName << ", channels:" << channels
+             << ", maxValue:" << maxValue << ", samples:" << sampleSize;
+    qDebug() << "Samples per second:" << oneSecondSamples << ", for one pixel:" << onePixelSamples <<
+                ", onePixelReadLen:" << onePixelReadLen;
+
+    while (dataRead)
+    {
+        quint32 tmpExceedData = 0;
+        if (audioDataOffset < onePixelReadLen)
+        {
+            dataRead = ad->read((char *)audioData + audioDataOffset, onePixelReadLen * 2);
+            if (dataRead > 0)
+            {
+                if((quint32)dataRead + audioDataOffset >= onePixelReadLen)
                 {
-                    if (lineHeightLeft > 1)
-                        p.drawLine(xpos, 19 - (lineHeightLeft / 2), xpos, 19 + (lineHeightLeft / 2));
-                    else
-                        p.drawLine(xpos, 19, xpos + 1, 19);
-
-                    if (lineHeightRight > 1)
-                        p.drawLine(xpos, 51 - (lineHeightRight / 2), xpos, 51 + (lineHeightRight / 2));
-                    else
-                        p.drawLine(xpos, 51, xpos + 1, 51);
+                    tmpExceedData = (dataRead + audioDataOffset) - onePixelReadLen;
+                    dataRead = onePixelReadLen;
                 }
                 else
                 {
-                    unsigned short lineHeight = left ? lineHeightLeft : lineHeightRight;
-
-                    if (lineHeight > 1)
-                        p.drawLine(xpos, 38 - (lineHeight / 2), xpos, 38 + (lineHeight / 2));
-                    else
-                        p.drawLine(xpos, 38, xpos + 1, 38);
-                    //qDebug() << "Data read: " << dataRead << ", rms: " << rmsRight << ", line height: " << lineHeight << ", xpos = " << xpos;
+                    qDebug() << "Not enough data. Requested:" << onePixelReadLen << "got:" << dataRead;
+                    audioDataOffset = dataRead;
+                    continue;
                 }
-                xpos++;
+            }
+        }
+        else
+        {
+            dataRead = onePixelReadLen;
+            tmpExceedData = audioDataOffset - onePixelReadLen;
+        }
 
-                if (tmpExceedData > 0)
+        if (dataRead == onePixelReadLen)
+        {
+            quint32 i = 0;
+            // calculate the RMS value (peak) for this data block
+            qint64 rmsLeft = 0;
+            qint64 rmsRight = 0;
+            bool done = false;
+            while (!done)
+            {
+                qint32 sampleVal = getSample(audioData, i, sampleSize);
+                rmsLeft += (sampleVal * sampleVal);
+                i += sampleSize;
+
+                if (channels == 2)
                 {
-                    //qDebug() << "Exceed data found: " << tmpExceedData;
-                    memmove(audioData, audioData + onePixelReadLen, tmpExceedData);
-                    audioDataOffset = tmpExceedData;
+                    sampleVal = getSample(audioData, i, sampleSize);
+                    rmsRight += (sampleVal * sampleVal);
+                    i += sampleSize;
                 }
-                else
-                    audioDataOffset = 0;
+
+                if (i >= dataRead)
+                    done = true;
             }
+
+            rmsLeft = sqrt(rmsLeft / onePixelSamples);
+            peaks.append(char(qMin(qint64(255), (255 * rmsLeft) / maxValue)));
+            if (m_peakChannels == 2)
+            {
+                rmsRight = sqrt(rmsRight / onePixelSamples);
+                peaks.append(char(qMin(qint64(255), (255 * rmsRight) / maxValue)));
+            }
+
+            if (tmpExceedData > 0)
+            {
+                //qDebug() << "Exceed data found: " << tmpExceedData;
+                memmove(audioData, audioData + onePixelReadLen, tmpExceedData);
+                audioDataOffset = tmpExceedData;
+            }
+            else
+                audioDataOffset = 0;
         }
-        //qDebug() << "Iterations done: " << xpos;
-        delete ad;
-        m_item->m_preview = preview;
     }
-    else // no preview selected. Delete pixmap
+    delete ad;
+
+    // 3- build the lower resolution levels, keeping the highest value of each pair
+    m_peakLevels.append(peaks);
+    while (peaks.size() / m_peakChannels > 1)
     {
-        delete m_item->m_preview;
-        m_item->m_preview = NULL;
+        int count = peaks.size() / m_peakChannels;
+        QByteArray level((count + 1) / 2 * m_peakChannels, 0);
+
+        for (int i = 0; i < count; i++)
+        {
+            for (int c = 0; c < m_peakChannels; c++)
+            {
+                int idx = (i / 2) * m_peakChannels + c;
+                level[idx] = char(qMax(uchar(level.at(idx)), uchar(peaks.at(i * m_peakChannels + c))));
+            }
+        }
+
+        m_peakLevels.append(level);
+        peaks = level;
     }
 
-    m_item->update();
+    savePeaks(cachePath);
 }
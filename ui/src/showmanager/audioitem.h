@@ -23,11 +23,22 @@
 #include <QGraphicsItem>
 #include <QObject>
 #include <QAction>
+#include <QThread>
 #include <QFont>
 
 #include "showitem.h"
 #include "audio.h"
 
+class PreviewThread;
+
+/** Number of waveform values per second at the highest resolution level */
+#define AUDIO_PEAKS_RATE    50
+
+/** The waveform peaks are stored in this folder of the user cache directory */
+#define AUDIO_PEAKS_DIR     "waveforms"
+#define AUDIO_PEAKS_MAGIC   0x514C574D // "QLWM"
+#define AUDIO_PEAKS_VERSION 1
+
 /** @addtogroup ui_functions
  * @{
  */
@@ -44,6 +55,7 @@ class AudioItem : public ShowItem
 
 public:
     AudioItem(Audio *aud, ShowFunction *func);
+    ~AudioItem();
 
     /** @reimp */
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
@@ -71,10 +83,21 @@ protected slots:
     void slotAudioPreviewRight();
     void slotAudioPreviewStereo();
 
+    /** Called when the preview thread has the waveform peaks ready */
+    void slotPreviewReady();
+
 private:
     /** Calculate sequence width for paint() and boundingRect() */
     void calculateWidth();
 
+    /** Start the computation of the waveform peaks, if not available yet */
+    void startPreview();
+
+    /** Draw the exposed part of the waveform, from the peaks level
+     *  closest to the current time scale */
+    void drawWaveform(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                      bool left, bool right);
+
 public:
     /** Reference to the actual Audio Function */
     Audio *m_audio;
@@ -84,21 +107,46 @@ public:
     QAction *m_previewRightAction;
     QAction *m_previewStereoAction;
 
-    /** Pixmap holding the waveform (if enabled) */
-    QPixmap *m_preview;
+    /** Waveform peaks, one array per resolution level. Level 0 holds
+     *  AUDIO_PEAKS_RATE values per second for each channel, interleaved.
+     *  Each next level halves the resolution of the previous one */
+    QList<QByteArray> m_peakLevels;
+    int m_peakChannels;
+
+    /** The thread computing the peaks, if running */
+    PreviewThread *m_previewThread;
 };
 
+/**
+ * Thread computing the waveform peaks of an audio file. Peaks are loaded from
+ * the user cache directory when available, otherwise the whole file is
+ * decoded once and the result is stored there for the next times
+ */
 class PreviewThread : public QThread
 {
 public:
     void setAudioItem(AudioItem *item);
 
+    /** The computed peaks. To be read when the thread has finished */
+    QList<QByteArray> peakLevels() const;
+    int peakChannels() const;
+
 private:
     /** Retrieve a sample value from an audio buffer, given the sample size */
     qint32 getSample(unsigned char *data, quint32 idx, int sampleSize);
+
+    /** Path of the cache file of the current audio file */
+    QString cacheFile() const;
+    bool loadPeaks(const QString &path);
+    void savePeaks(const QString &path);
+
     void run();
 
     AudioItem *m_item;
+    QString m_fileName;
+    Doc *m_doc;
+    QList<QByteArray> m_peakLevels;
+    int m_peakChannels;
 };
 
 /** @} */
@@ -61,22 +61,13 @@ void EFXItem::calculateWidth()
 
 void EFXItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option);
-    Q_UNUSED(widget);
-
-    float xpos = 0;
     float timeScale = 50 / float(m_timeScale);
 
     ShowItem::paint(painter, option, widget);
 
     int loopCount = m_function->duration() ? qFloor(m_function->duration() / m_efx->duration()) : 0;
-    for (int i = 0; i < loopCount; i++)
-    {
-        xpos += ((timeScale * float(m_efx->duration())) / 1000);
-        // draw loop vertical delimiter
-        painter->setPen(QPen(Qt::white, 1));
-        painter->drawLine(int(xpos), 1, int(xpos), TRACK_HEIGHT - 5);
-    }
+    // draw loop vertical delimiters
+    drawLoopDelimiters(painter, option, (timeScale * float(m_efx->duration())) / 1000, loopCount);
 
     ShowItem::postPaint(painter);
 }
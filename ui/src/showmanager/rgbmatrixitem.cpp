@@ -60,9 +60,6 @@ void RGBMatrixItem::calculateWidth()
 
 void RGBMatrixItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option);
-    Q_UNUSED(widget);
-
     float timeScale = 50 / float(m_timeScale);
 
     ShowItem::paint(painter, option, widget);
@@ -71,16 +68,9 @@ void RGBMatrixItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
 
     if (matrixDuration)
     {
-        float xpos = 0;
         int loopCount = m_function->duration() ? qFloor(m_function->duration() / m_matrix->totalDuration()) : 0;
-
-        for (int i = 0; i < loopCount; i++)
-        {
-            xpos += ((timeScale * float(m_matrix->totalDuration())) / 1000);
-            // draw loop vertical delimiter
-            painter->setPen(QPen(Qt::white, 1));
-            painter->drawLine(int(xpos), 1, int(xpos), TRACK_HEIGHT - 5);
-        }
+        // draw loop vertical delimiters
+        drawLoopDelimiters(painter, option, (timeScale * float(m_matrix->totalDuration())) / 1000, loopCount);
     }
 
     ShowItem::postPaint(painter);
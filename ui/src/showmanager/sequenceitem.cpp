@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QStyleOptionGraphicsItem>
 #include <QApplication>
 #include <QPainter>
 #include <QMenu>
@@ -73,6 +74,10 @@ void SequenceItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opti
 
     foreach (ChaserStep step, m_chaser->steps())
     {
+        // the following steps are outside the exposed area
+        if (xpos > option->exposedRect.right())
+            break;
+
         uint stepFadeIn = step.fadeIn;
         uint stepFadeOut = step.fadeOut;
         uint stepDuration = step.duration;
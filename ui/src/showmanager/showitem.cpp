@@ -17,11 +17,13 @@
   limitations under the License.
 */
 
+#include <QStyleOptionGraphicsItem>
 #include <QGraphicsSceneEvent>
 #include <QApplication>
 #include <QPainter>
 #include <QDebug>
 #include <QMenu>
+#include <qmath.h>
 
 #include "headeritems.h"
 #include "trackitem.h"
@@ -43,6 +45,8 @@ ShowItem::ShowItem(ShowFunction *function, QObject *)
 
     setCursor(Qt::OpenHandCursor);
     setFlag(QGraphicsItem::ItemIsSelectable, true);
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
     m_font = qApp->font();
     m_font.setBold(true);
@@ -139,6 +143,8 @@ void ShowItem::setWidth(int w)
 {
     m_width = w;
     updateTooltip();
+    // the item contents might have changed even with the same width
+    update();
 }
 
 int ShowItem::getWidth()
@@ -232,12 +238,20 @@ void ShowItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
     this->setSelected(true);
 }
 
+void ShowItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
+{
+    QGraphicsItem::mouseMoveEvent(event);
+    if (m_pressed)
+        update();
+}
+
 void ShowItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
     QGraphicsItem::mouseReleaseEvent(event);
     qDebug() << Q_FUNC_INFO << "mouse RELEASE event - <" << event->pos().toPoint().x() << "> - <" << event->pos().toPoint().y() << ">";
     setCursor(Qt::OpenHandCursor);
     m_pressed = false;
+    update();
     emit itemDropped(event, this);
 }
 
@@ -288,6 +302,24 @@ void ShowItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     painter->setFont(m_font);
 }
 
+void ShowItem::drawLoopDelimiters(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                                  float loopWidth, int loopCount)
+{
+    // when zoomed out, the delimiters would just fill the item
+    if (loopWidth < MIN_DELIMITERS_SPACING)
+        return;
+
+    int first = qMax(1, qFloor(option->exposedRect.left() / loopWidth));
+    int last = qMin(loopCount, qCeil(option->exposedRect.right() / loopWidth));
+
+    painter->setPen(QPen(Qt::white, 1));
+    for (int i = first; i <= last; i++)
+    {
+        int xpos = int(loopWidth * float(i));
+        painter->drawLine(xpos, 1, xpos, TRACK_HEIGHT - 5);
+    }
+}
+
 void ShowItem::postPaint(QPainter *painter)
 {
     // draw the function name shadow
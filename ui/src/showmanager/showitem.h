@@ -46,8 +46,15 @@ class ShowFunction;
  * 2- Subclass::paint: paints the item's specific contents (e.g. preview, steps, etc..)
  * 3- ShowItem::postPaint: paints the "overlay" information such as the function name,
  *                         the lock icon and the dragging time
+ *
+ * Items are cached in device coordinates, so they are not repainted while
+ * the cursor moves over them. Every change of their contents needs an update() call.
  */
 
+/** Minimum distance in pixels between two loop/step delimiters.
+ *  Closer delimiters are not drawn */
+#define MIN_DELIMITERS_SPACING  5
+
 class ShowItem : public QObject, public QGraphicsItem
 {
     Q_OBJECT
@@ -229,6 +236,15 @@ public:
      */
     virtual void postPaint(QPainter *painter);
 
+protected:
+    /**
+     * @brief drawLoopDelimiters draws the vertical delimiters of $loopCount
+     * loops, each $loopWidth pixels large. Only the delimiters within the
+     * exposed area of $option are drawn
+     */
+    void drawLoopDelimiters(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                            float loopWidth, int loopCount);
+
 protected slots:
     /**
      * @brief slotAlignToCursorClicked slot called when the user requests to align the item
@@ -262,6 +278,12 @@ protected:
      */
     void mousePressEvent(QGraphicsSceneMouseEvent *event);
 
+    /**
+     * @brief mouseMoveEvent overridden method to repaint the dragging time
+     * while the item is moved
+     */
+    void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
+
     /**
      * @brief mouseReleaseEvent overridden method to handle the mouse release event over an item.
      * This method emits the itemDropped signal to be handled by the above layers
@@ -79,16 +79,9 @@ void VideoItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
 
     if (videoDuration > 0)
     {
-        float xpos = 0;
         int loopCount = qFloor(m_function->duration() / videoDuration);
-
-        for (int i = 0; i < loopCount; i++)
-        {
-            xpos += ((timeScale * (float)videoDuration) / 1000);
-            // draw loop vertical delimiter
-            painter->setPen(QPen(Qt::white, 1));
-            painter->drawLine(xpos, 1, xpos, TRACK_HEIGHT - 5);
-        }
+        // draw loop vertical delimiters
+        drawLoopDelimiters(painter, option, (timeScale * (float)videoDuration) / 1000, loopCount);
     }
 
     if (m_video->fadeInSpeed() != 0)
@@ -25,6 +25,7 @@
 #include <QHeaderView>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QGuiApplication>
 #include <QSettings>
 #include <QSplitter>
 #include <QGroupBox>
@@ -32,6 +33,8 @@
 #include <QComboBox>
 #include <QSpinBox>
 #include <QLayout>
+#include <QScreen>
+#include <QTimer>
 #include <QLabel>
 #include <QFrame>
 #include <QDebug>
@@ -133,6 +136,15 @@ SimpleDesk::SimpleDesk(QWidget* parent, Doc* doc)
     connect(m_doc->inputOutputMap(), SIGNAL(universeRemoved(quint32)),
             this, SLOT(slotDocChanged()));
 
+    int refreshRate = 60;
+    if (QGuiApplication::primaryScreen() != NULL)
+        refreshRate = qMax(1, qRound(QGuiApplication::primaryScreen()->refreshRate()));
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(1000 / refreshRate);
+    connect(m_refreshTimer, SIGNAL(timeout()), this, SLOT(slotRefreshUniverse()));
+
     connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32, const QByteArray&)),
             this, SLOT(slotUniverseWritten(quint32, const QByteArray&)));
 }
@@ -467,6 +479,7 @@ void SimpleDesk::initUniversePager()
 void SimpleDesk::resetUniverseSliders()
 {
     //qDebug() << Q_FUNC_INFO;
+    m_shownUniverseData.clear();
     foreach (ConsoleChannel *channel, m_universeSliders)
     {
         if (channel != NULL)
@@ -477,6 +490,7 @@ void SimpleDesk::resetUniverseSliders()
 void SimpleDesk::initSliderView(bool fullMode)
 {
     m_consoleList.clear();
+    m_shownUniverseData.clear();
 
     if (fullMode == true)
     {
@@ -564,6 +578,8 @@ void SimpleDesk::initChannelGroupsView()
 void SimpleDesk::slotUniversesComboChanged(int index)
 {
     m_currentUniverse = index;
+    m_universeData.clear();
+    m_shownUniverseData.clear();
     if (m_viewModeButton->isChecked() == true)
     {
         m_universeGroup->layout()->removeWidget(scrollArea);
@@ -638,6 +654,8 @@ void SimpleDesk::slotUniversePageChanged(int page)
     QList<quint32> fxAddList, fxRemoveList;
     quint32 start = (page - 1) * m_channelsPerPage;
 
+    m_shownUniverseData.clear();
+
     /* now, calculate the absolute address including current universe (0 - 2048) */
     quint32 absoluteAddr = start | (m_currentUniverse << 9);
 
@@ -911,6 +929,21 @@ void SimpleDesk::slotUniverseWritten(quint32 idx, const QByteArray& universeData
 
     //qDebug() << "SIMPLE DESK UNIVERSE WRITTEN" << idx;
 
+    // only the last frame is shown at the next refresh
+    m_universeData = universeData;
+    if (m_refreshTimer->isActive() == false)
+        m_refreshTimer->start();
+}
+
+void SimpleDesk::slotRefreshUniverse()
+{
+    if (isVisible() == false || m_universeData.isEmpty())
+        return;
+
+    const QByteArray universeData = m_universeData;
+    const QByteArray &shownData = m_shownUniverseData;
+    quint32 idx = quint32(m_currentUniverse);
+
     if (m_viewModeButton->isChecked() == false)
     {
         quint32 start = (m_universePageSpin->value() - 1) * m_channelsPerPage;
@@ -938,6 +971,10 @@ void SimpleDesk::slotUniverseWritten(quint32 idx, const QByteArray& universeData
                 continue;
             }
 
+            // the slider is showing this value already
+            if (shownData.length() > int(i) && shownData.at(i) == universeData.at(i))
+                continue;
+
             cc->blockSignals(true);
             cc->setValue(universeData.at(i), false);
             cc->blockSignals(false);
@@ -963,6 +1000,10 @@ void SimpleDesk::slotUniverseWritten(quint32 idx, const QByteArray& universeData
                     if (m_engine->hasChannel((startAddr + c) + (idx << 9)) == true)
                         continue;
 
+                    if (shownData.length() > int(startAddr + c) &&
+                        shownData.at(startAddr + c) == universeData.at(startAddr + c))
+                        continue;
+
                     fc->blockSignals(true);
                     fc->setValue(c, universeData.at(startAddr + c), false);
                     fc->blockSignals(false);
@@ -970,6 +1011,8 @@ void SimpleDesk::slotUniverseWritten(quint32 idx, const QByteArray& universeData
             }
         }
     }
+
+    m_shownUniverseData = universeData;
 }
 
 void SimpleDesk::slotUpdateUniverseSliders()
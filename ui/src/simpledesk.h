@@ -44,6 +44,7 @@ class QTreeView;
 class QSplitter;
 class QSpinBox;
 class CueStack;
+class QTimer;
 class Doc;
 class Cue;
 
@@ -134,6 +135,9 @@ private slots:
     void slotUpdateUniverseSliders();
     void slotUniverseWritten(quint32 idx, const QByteArray& universeData);
 
+    /** Show the last universe frame received on the sliders */
+    void slotRefreshUniverse();
+
 private:
     QFrame *m_universeGroup;
     QComboBox *m_universesCombo;
@@ -167,6 +171,14 @@ private:
     /** A list to remember the selected page of each universe */
     QList<int> m_universesPage;
 
+    /** The last frame received for the current universe, waiting
+     *  for the next refresh, and the frame shown by the sliders */
+    QByteArray m_universeData;
+    QByteArray m_shownUniverseData;
+
+    /** Timer to cap the sliders updates to the screen refresh rate */
+    QTimer *m_refreshTimer;
+
     /*********************************************************************
      * Playback sliders
      *********************************************************************/
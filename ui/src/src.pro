@@ -7,7 +7,7 @@ TARGET   = qlcplusui
 
 CONFIG += qt
 QT     += core gui script
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets multimedia multimediawidgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets multimedia multimediawidgets concurrent
 
 INCLUDEPATH     += monitor showmanager virtualconsole
 
@@ -97,7 +97,8 @@ HEADERS += aboutbox.h \
            simpledeskengine.h \
            speeddial.h \
            speeddialwidget.h \
-           universeitemwidget.h
+           universeitemwidget.h \
+           workspacewriter.h
 
 # Monitor headers
 HEADERS += monitor/monitor.h \
@@ -272,7 +273,8 @@ SOURCES += aboutbox.cpp \
            simpledeskengine.cpp \
            speeddial.cpp \
            speeddialwidget.cpp \
-           universeitemwidget.cpp
+           universeitemwidget.cpp \
+           workspacewriter.cpp
 
 # Monitor sources
 SOURCES += monitor/monitor.cpp \
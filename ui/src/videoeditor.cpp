@@ -94,6 +94,10 @@ VideoEditor::VideoEditor(QWidget* parent, Video *video, Doc* doc)
     connect(m_singleCheck, SIGNAL(clicked()),
             this, SLOT(slotSingleShotCheckClicked()));
 
+    m_preloadCheck->setChecked(m_video->preload());
+    connect(m_preloadCheck, SIGNAL(toggled(bool)),
+            this, SLOT(slotPreloadToggled(bool)));
+
     // Set focus to the editor
     m_nameEdit->setFocus();
 }
@@ -191,6 +195,11 @@ void VideoEditor::slotLoopCheckClicked()
     m_video->setRunOrder(Video::Loop);
 }
 
+void VideoEditor::slotPreloadToggled(bool state)
+{
+    m_video->setPreload(state);
+}
+
 void VideoEditor::slotPreviewToggled(bool state)
 {
     if (state == true)
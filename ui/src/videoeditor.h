@@ -52,6 +52,7 @@ private slots:
     void slotFullscreenCheckClicked();
     void slotSingleShotCheckClicked();
     void slotLoopCheckClicked();
+    void slotPreloadToggled(bool state);
     void slotPreviewToggled(bool state);
     void slotPreviewStopped(quint32 id);
     void slotDurationChanged(qint64 duration);
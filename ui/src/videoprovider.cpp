@@ -24,13 +24,20 @@
 #include <QApplication>
 #include <QMediaPlayer>
 #include <QVideoWidget>
+#include <QSettings>
 #include <QScreen>
 
 VideoProvider::VideoProvider(Doc *doc, QObject *parent)
     : QObject(parent)
     , m_doc(doc)
+    , m_preloadLimit(VIDEO_DEFAULT_PRELOAD_LIMIT)
 {
     Q_ASSERT(doc != NULL);
+
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_VIDEO_PRELOAD_LIMIT);
+    if (var.isValid() == true)
+        m_preloadLimit = qMax(0, var.toInt());
     connect(m_doc, SIGNAL(functionAdded(quint32)),
             this, SLOT(slotFunctionAdded(quint32)));
     connect(m_doc, SIGNAL(functionRemoved(quint32)),
@@ -39,6 +46,7 @@ VideoProvider::VideoProvider(Doc *doc, QObject *parent)
 
 VideoProvider::~VideoProvider()
 {
+    m_preloadPool.clear();
     m_videoMap.clear();
 }
 
@@ -52,6 +60,10 @@ void VideoProvider::slotFunctionAdded(quint32 id)
     {
         VideoWidget *vWidget = new VideoWidget(qobject_cast<Video *>(func));
         m_videoMap[id] = vWidget;
+
+        connect(func, SIGNAL(preloadChanged(bool)),
+                this, SLOT(slotPreloadChanged()));
+        updatePreloadPool();
     }
 }
 
@@ -60,8 +72,52 @@ void VideoProvider::slotFunctionRemoved(quint32 id)
     if (m_videoMap.contains(id))
     {
         VideoWidget *vw = m_videoMap.take(id);
+        bool pooled = m_preloadPool.removeOne(vw);
         delete vw;
+
+        if (pooled)
+            updatePreloadPool();
+    }
+}
+
+void VideoProvider::slotPreloadChanged()
+{
+    updatePreloadPool();
+}
+
+void VideoProvider::updatePreloadPool()
+{
+    // release the videos that don't want to be preloaded anymore
+    QMutableListIterator<VideoWidget *> it(m_preloadPool);
+    while (it.hasNext())
+    {
+        VideoWidget *vw = it.next();
+        if (vw->video()->preload() == false)
+        {
+            vw->setPreloaded(false);
+            it.remove();
+        }
+    }
+
+    int skipped = 0;
+
+    foreach (VideoWidget *vw, m_videoMap)
+    {
+        if (vw->video()->preload() == false || vw->isPreloaded())
+            continue;
+
+        if (m_preloadPool.count() >= m_preloadLimit)
+        {
+            skipped++;
+            continue;
+        }
+
+        vw->setPreloaded(true);
+        m_preloadPool.append(vw);
     }
+
+    if (skipped > 0)
+        qDebug() << "Video preload limit reached," << skipped << "videos will be opened on start";
 }
 
 /*********************************************************************
@@ -73,18 +129,15 @@ VideoWidget::VideoWidget(Video *video, QObject *parent)
     , m_video(video)
     , m_videoPlayer(NULL)
     , m_videoWidget(NULL)
+    , m_preloaded(false)
 {
     Q_ASSERT(video != NULL);
 
     m_videoPlayer = new QMediaPlayer(this, QMediaPlayer::VideoSurface);
     m_videoPlayer->moveToThread(QCoreApplication::instance()->thread());
 
-    if (QLCFile::getQtRuntimeVersion() >= 50700 && m_videoWidget == NULL)
-    {
-        m_videoWidget = new QVideoWidget;
-        m_videoWidget->setStyleSheet("background-color:black;");
-        m_videoPlayer->setVideoOutput(m_videoWidget);
-    }
+    if (QLCFile::getQtRuntimeVersion() >= 50700)
+        createVideoWidget();
 
     connect(m_videoPlayer, SIGNAL(mediaStatusChanged(QMediaPlayer::MediaStatus)),
             this, SLOT(slotStatusChanged(QMediaPlayer::MediaStatus)));
@@ -105,24 +158,84 @@ VideoWidget::VideoWidget(Video *video, QObject *parent)
             this, SLOT(slotBrightnessAdjust(int)));
 
     QString sourceURL = m_video->sourceUrl();
-    if (sourceURL.contains("://"))
-        m_videoPlayer->setMedia(QUrl(sourceURL));
-    else
-        m_videoPlayer->setMedia(QUrl::fromLocalFile(sourceURL));
+    setMedia(sourceURL);
 
     qDebug() << "Video source URL:" << sourceURL;
 }
 
-void VideoWidget::slotSourceUrlChanged(QString url)
+Video *VideoWidget::video() const
 {
-    qDebug() << "Video source URL changed:" << url;
+    return m_video;
+}
+
+void VideoWidget::setPreloaded(bool enable)
+{
+    if (m_preloaded == enable)
+        return;
+
+    m_preloaded = enable;
+
+    if (enable)
+    {
+        createVideoWidget();
+        // create the native window now, not when the video is first shown
+        m_videoWidget->winId();
+        prepare();
+    }
+    else if (m_videoPlayer->state() == QMediaPlayer::PausedState &&
+             m_video->isRunning() == false)
+    {
+        // release the decoder until the next start
+        m_videoPlayer->stop();
+    }
+
+    qDebug() << "Video" << m_video->name() << "preloaded:" << enable;
+}
+
+bool VideoWidget::isPreloaded() const
+{
+    return m_preloaded;
+}
 
+void VideoWidget::setMedia(QString url)
+{
     if (url.contains("://"))
         m_videoPlayer->setMedia(QUrl(url));
     else
         m_videoPlayer->setMedia(QUrl::fromLocalFile(url));
 }
 
+void VideoWidget::createVideoWidget()
+{
+    if (m_videoWidget != NULL)
+        return;
+
+    m_videoWidget = new QVideoWidget;
+    m_videoWidget->setStyleSheet("background-color:black;");
+    m_videoPlayer->setVideoOutput(m_videoWidget);
+}
+
+void VideoWidget::prepare()
+{
+    if (m_video->isRunning())
+        return;
+
+    // a paused player has the decoder opened and the first frame decoded
+    m_videoPlayer->pause();
+    if (m_videoPlayer->position() != 0)
+        m_videoPlayer->setPosition(0);
+}
+
+void VideoWidget::slotSourceUrlChanged(QString url)
+{
+    qDebug() << "Video source URL changed:" << url;
+
+    setMedia(url);
+
+    if (m_preloaded)
+        prepare();
+}
+
 void VideoWidget::slotTotalTimeChanged(qint64 duration)
 {
     qDebug() << "Video duration: " << duration;
@@ -191,12 +304,7 @@ void VideoWidget::slotPlaybackVideo()
     QScreen *scr = screens.count() > screen ? screens.at(screen) : screens.first();
     QRect rect = scr->availableGeometry();
 
-    if (QLCFile::getQtRuntimeVersion() < 50700 && m_videoWidget == NULL)
-    {
-        m_videoWidget = new QVideoWidget;
-        m_videoWidget->setStyleSheet("background-color:black;");
-        m_videoPlayer->setVideoOutput(m_videoWidget);
-    }
+    createVideoWidget();
 
     m_videoWidget->setWindowFlags(m_videoWidget->windowFlags() | Qt::WindowStaysOnTopHint);
 
@@ -221,10 +329,10 @@ void VideoWidget::slotPlaybackVideo()
 #endif
     }
 
-    if (m_videoPlayer->isSeekable())
-        m_videoPlayer->setPosition(m_video->elapsed());
-    else
-        m_videoPlayer->setPosition(0);
+    // a preloaded video is already paused on its first frame
+    qint64 position = m_videoPlayer->isSeekable() ? m_video->elapsed() : 0;
+    if (m_videoPlayer->position() != position)
+        m_videoPlayer->setPosition(position);
 
     m_videoWidget->show();
     m_videoPlayer->play();
@@ -241,7 +349,18 @@ void VideoWidget::slotSetPause(bool enable)
 void VideoWidget::slotStopVideo()
 {
     if (m_videoPlayer != NULL)
-        m_videoPlayer->stop();
+    {
+        // a preloaded video waits on its first frame for the next start
+        if (m_preloaded)
+        {
+            m_videoPlayer->pause();
+            m_videoPlayer->setPosition(0);
+        }
+        else
+        {
+            m_videoPlayer->stop();
+        }
+    }
 
     if (m_videoWidget != NULL)
     {
@@ -23,12 +23,16 @@
 #include <QMediaPlayer>
 #include <QObject>
 #include <QHash>
+#include <QList>
 
 #include "video.h"
 
 class Doc;
 class QVideoWidget;
 
+#define SETTINGS_VIDEO_PRELOAD_LIMIT "video/preloadlimit"
+#define VIDEO_DEFAULT_PRELOAD_LIMIT 4
+
 class VideoWidget: public QObject
 {
     Q_OBJECT
@@ -36,6 +40,19 @@ class VideoWidget: public QObject
 public:
     VideoWidget(Video *video, QObject *parent = NULL);
 
+    /** Return the Video function rendered by this widget */
+    Video *video() const;
+
+    /**
+     * Keep the media opened and paused on its first frame, with the
+     * output widget and its window created, so that a start only has
+     * to show the widget and resume the playback
+     */
+    void setPreloaded(bool enable);
+
+    /** Return true if the video is currently preloaded */
+    bool isPreloaded() const;
+
 protected slots:
     void slotSourceUrlChanged(QString url);
     void slotTotalTimeChanged(qint64 duration);
@@ -49,6 +66,15 @@ protected slots:
 private:
     int getScreenCount();
 
+    /** Set the source URL of the player */
+    void setMedia(QString url);
+
+    /** Create the widget where the video is displayed */
+    void createVideoWidget();
+
+    /** Pause the player on the start of the media, ready to be played */
+    void prepare();
+
 protected:
     /** reference to the actual Video Function */
     Video *m_video;
@@ -56,6 +82,8 @@ protected:
     QMediaPlayer *m_videoPlayer;
     /** Qt widget that actually displays the video */
     QVideoWidget *m_videoWidget;
+    /** Flag that indicates if the video is kept ready in the preload pool */
+    bool m_preloaded;
 
 private:
     FunctionParent functionParent() const;
@@ -71,10 +99,19 @@ public:
 protected slots:
     void slotFunctionAdded(quint32 id);
     void slotFunctionRemoved(quint32 id);
+    void slotPreloadChanged();
+
+private:
+    /** Fill the preload pool with the videos requesting it, up to the limit */
+    void updatePreloadPool();
 
 private:
     Doc *m_doc;
     QHash<quint32, VideoWidget *> m_videoMap;
+    /** The videos currently preloaded, in the order they were added */
+    QList<VideoWidget *> m_preloadPool;
+    /** The maximum number of videos kept preloaded */
+    int m_preloadLimit;
 };
 
 #endif // VIDEOPROVIDER_H
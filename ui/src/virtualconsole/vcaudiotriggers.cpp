@@ -189,7 +189,7 @@ void VCAudioTriggers::enableCapture(bool enable)
     {
         connect(m_inputCapture, SIGNAL(dataProcessed(double*,int,double,quint32)),
                 this, SLOT(slotDisplaySpectrum(double*,int,double,quint32)));
-        m_inputCapture->registerBandsNumber(m_spectrum->barsNumber());
+        m_audioSpectrum = m_inputCapture->registerBandsNumber(m_spectrum->barsNumber());
 
         m_button->blockSignals(true);
         m_button->setChecked(true);
@@ -208,6 +208,7 @@ void VCAudioTriggers::enableCapture(bool enable)
             disconnect(m_inputCapture, SIGNAL(dataProcessed(double*,int,double,quint32)),
                        this, SLOT(slotDisplaySpectrum(double*,int,double,quint32)));
         }
+        m_audioSpectrum.clear();
 
         m_button->blockSignals(true);
         m_button->setChecked(false);
@@ -237,11 +238,19 @@ void VCAudioTriggers::slotEnableButtonToggled(bool toggle)
 void VCAudioTriggers::slotDisplaySpectrum(double *spectrumBands, int size,
                                           double maxMagnitude, quint32 power)
 {
+    Q_UNUSED(spectrumBands)
+
     qDebug() << "Display spectrum ----- bars:" << size;
     if (size != m_spectrum->barsNumber())
         return;
 
-    m_spectrum->displaySpectrum(spectrumBands, maxMagnitude, power);
+    /* The signal is queued from the capture thread, which might be
+     * writing the next bands already: read the latest spectrum instead */
+    if (m_audioSpectrum.isNull() ||
+        m_audioSpectrum->read(m_spectrumValues, maxMagnitude, power) == false)
+            return;
+
+    m_spectrum->displaySpectrum(m_spectrumValues.data(), maxMagnitude, power);
     m_volumeBar->m_value = m_spectrum->getUcharVolume();
 
     if (mode() == Doc::Design)
@@ -568,7 +577,7 @@ void VCAudioTriggers::editProperties()
         {
             if (!captureIsNew)
                 m_inputCapture->unregisterBandsNumber(barsNumber);
-            m_inputCapture->registerBandsNumber(m_spectrumBars.count());
+            m_audioSpectrum = m_inputCapture->registerBandsNumber(m_spectrumBars.count());
             if (captureIsNew)
                 connect(m_inputCapture, SIGNAL(dataProcessed(double*,int,double,quint32)),
                         this, SLOT(slotDisplaySpectrum(double*,int,double,quint32)));
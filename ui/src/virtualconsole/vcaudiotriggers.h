@@ -20,6 +20,7 @@
 #ifndef VCAUDIOTRIGGERS_H
 #define VCAUDIOTRIGGERS_H
 
+#include <QSharedPointer>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QToolButton>
@@ -36,6 +37,7 @@
 class QXmlStreamReader;
 class QXmlStreamWriter;
 class AudioCapture;
+class AudioSpectrum;
 class AudioBar;
 
 /** @addtogroup ui_vc_widgets
@@ -97,6 +99,9 @@ protected:
     ClickAndGoSlider *m_volumeSlider;
 #endif
     AudioCapture *m_inputCapture;
+    /** The spectrum registered to m_inputCapture */
+    QSharedPointer<AudioSpectrum> m_audioSpectrum;
+    QVector<double> m_spectrumValues;
 
     AudioBar *m_volumeBar;
     QList <AudioBar *> m_spectrumBars;
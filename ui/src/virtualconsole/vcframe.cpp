@@ -589,6 +589,9 @@ void VCFrame::slotNextPage()
 
 void VCFrame::slotSetPage(int pageNum)
 {
+    /* The feedback of the whole page goes out as one batch */
+    m_doc->inputOutputMap()->beginFeedbackBatch();
+
     if (m_pageCombo)
     {
         if (pageNum >= 0 && pageNum < m_totalPagesNumber)
@@ -621,6 +624,8 @@ void VCFrame::slotSetPage(int pageNum)
         emit pageChanged(m_currentPage);
     }
     updateFeedback();
+
+    m_doc->inputOutputMap()->endFeedbackBatch();
 }
 
 void VCFrame::slotModeChanged(Doc::Mode mode)
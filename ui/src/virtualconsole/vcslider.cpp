@@ -27,6 +27,7 @@
 #include <QMessageBox>
 #include <QPaintEvent>
 #include <QSettings>
+#include <QSet>
 #include <QPainter>
 #include <QString>
 #include <QSlider>
@@ -43,6 +44,7 @@
 #include "qlcinputchannel.h"
 #include "virtualconsole.h"
 #include "qlcinputsource.h"
+#include "inputoutputmap.h"
 #include "mastertimer.h"
 #include "collection.h"
 #include "inputpatch.h"
@@ -64,6 +66,9 @@
  *  controllers with no feedback support */
 #define VALUE_CATCHING_THRESHOLD    4
 
+/** Interval in milliseconds to sample the monitored channels */
+#define MONITOR_SAMPLE_INTERVAL     50
+
 const quint8 VCSlider::sliderInputSourceId = 0;
 const quint8 VCSlider::overrideResetInputSourceId = 1;
 
@@ -98,6 +103,7 @@ VCSlider::VCSlider(QWidget *parent, Doc *doc)
     , m_levelValue(0)
     , m_monitorEnabled(false)
     , m_monitorValue(0)
+    , m_monitorTimer(NULL)
     , m_playbackFunction(Function::invalidId())
     , m_playbackValue(0)
     , m_playbackChangeCounter(0)
@@ -182,6 +188,11 @@ VCSlider::VCSlider(QWidget *parent, Doc *doc)
 
     m_resetButton = NULL;
 
+    m_monitorTimer = new QTimer(this);
+    m_monitorTimer->setInterval(MONITOR_SAMPLE_INTERVAL);
+    connect(m_monitorTimer, SIGNAL(timeout()),
+            this, SLOT(slotMonitorTimeout()));
+
     /* Bottom label */
     m_bottomLabel = new QLabel(this);
     layout()->addWidget(m_bottomLabel);
@@ -350,6 +361,7 @@ void VCSlider::slotModeChanged(Doc::Mode mode)
             m_doc->masterTimer()->registerDMXSource(this);
             if (m_sliderMode == Level)
                 m_levelValueChanged = true;
+            setChanged(true);
         }
     }
     else
@@ -506,7 +518,10 @@ void VCSlider::setSliderMode(SliderMode mode)
         }
 
         if (m_doc->mode() == Doc::Operate)
+        {
             m_doc->masterTimer()->registerDMXSource(this);
+            setChanged(true);
+        }
     }
     else if (mode == Playback)
     {
@@ -525,7 +540,10 @@ void VCSlider::setSliderMode(SliderMode mode)
         slotSliderMoved(level);
 
         if (m_doc->mode() == Doc::Operate)
+        {
             m_doc->masterTimer()->registerDMXSource(this);
+            setChanged(true);
+        }
         setPlaybackFunction(this->m_playbackFunction);
     }
     else if (mode == Submaster)
@@ -622,9 +640,11 @@ void VCSlider::setChannelsMonitorEnabled(bool enable)
                 this, SLOT(slotResetButtonClicked()));
         m_resetButton->show();
         setSliderShadowValue(m_monitorValue);
+        m_monitorTimer->start();
     }
     else
     {
+        m_monitorTimer->stop();
         setSliderShadowValue(-1);
     }
 }
@@ -641,7 +661,10 @@ void VCSlider::setLevelValue(uchar value, bool external)
     if (m_monitorEnabled == true)
         m_monitorValue = m_levelValue;
     if (m_slider->isSliderDown() || external)
+    {
         m_levelValueChanged = true;
+        setChanged(true);
+    }
 }
 
 uchar VCSlider::levelValue() const
@@ -741,6 +764,28 @@ void VCSlider::slotUniverseWritten(quint32 idx, const QByteArray &universeData)
     }
 }
 
+void VCSlider::slotMonitorTimeout()
+{
+    QSet<quint32> universes;
+    foreach (LevelChannel lch, m_levelChannels)
+    {
+        Fixture *fxi = m_doc->fixture(lch.fixture);
+        if (fxi != NULL)
+            universes.insert(fxi->universe());
+    }
+
+    QList<Universe*> universeList = m_doc->inputOutputMap()->universes();
+    foreach (quint32 universe, universes)
+    {
+        if (universe >= quint32(universeList.count()))
+            continue;
+
+        QByteArray values = universeList.at(universe)->monitorValues();
+        if (values.isEmpty() == false)
+            slotUniverseWritten(universe, values);
+    }
+}
+
 /*********************************************************************
  * Click & Go
  *********************************************************************/
@@ -818,6 +863,7 @@ void VCSlider::slotClickAndGoLevelChanged(uchar level)
     px.fill(col);
     m_cngButton->setIcon(px);
     m_levelValueChanged = true;
+    setChanged(true);
 }
 
 void VCSlider::slotClickAndGoColorChanged(QRgb color)
@@ -834,6 +880,7 @@ void VCSlider::slotClickAndGoColorChanged(QRgb color)
 
     // let's force a value change to cover all the HTP/LTP cases
     m_levelValueChanged = true;
+    setChanged(true);
 }
 
 void VCSlider::slotClickAndGoLevelAndPresetChanged(uchar level, QImage img)
@@ -844,6 +891,7 @@ void VCSlider::slotClickAndGoLevelAndPresetChanged(uchar level, QImage img)
     QPixmap px = QPixmap::fromImage(img);
     m_cngButton->setIcon(px);
     m_levelValueChanged = true;
+    setChanged(true);
 }
 
 /*********************************************************************
@@ -872,6 +920,7 @@ void VCSlider::slotResetButtonClicked()
         if (!fader.isNull())
             fader->removeAll();
     }
+    setChanged(true);
 
     emit monitorDMXValueChanged(m_monitorValue);
 }
@@ -946,6 +995,7 @@ void VCSlider::setPlaybackValue(uchar value)
     QMutexLocker locker(&m_playbackValueMutex);
     m_playbackValue = value;
     m_playbackChangeCounter = 5;
+    setChanged(true);
 }
 
 uchar VCSlider::playbackValue() const
@@ -1056,6 +1106,11 @@ void VCSlider::writeDMX(MasterTimer *timer, QList<Universe *> universes)
         writeDMXPlayback(timer, universes);
 }
 
+bool VCSlider::writeOnChangeOnly() const
+{
+    return true;
+}
+
 void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer);
@@ -1117,8 +1172,6 @@ void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
                 {
                     qDebug() << "VC slider monitor enabled";
                     fader->setMonitoring(true);
-                    connect(fader.data(), SIGNAL(preWriteData(quint32,QByteArray)),
-                            this, SLOT(slotUniverseWritten(quint32,QByteArray)));
                 }
             }
 
@@ -1219,6 +1272,9 @@ void VCSlider::writeDMXPlayback(MasterTimer* timer, QList<Universe *> ua)
         emit functionStarting(m_playbackFunction, pIntensity);
     }
     m_playbackChangeCounter--;
+    // keep ticking until the counter is exhausted
+    if (m_playbackChangeCounter > 0)
+        setChanged(true);
 }
 
 /*****************************************************************************
@@ -33,6 +33,7 @@
 class QXmlStreamReader;
 class QXmlStreamWriter;
 class QToolButton;
+class QTimer;
 class QHBoxLayout;
 class QLabel;
 
@@ -343,6 +344,9 @@ protected slots:
 
     void slotUniverseWritten(quint32 idx, const QByteArray& universeData);
 
+    /** Sample the monitored values of the universes of the level channels */
+    void slotMonitorTimeout();
+
 protected:
     QList <VCSlider::LevelChannel> m_levelChannels;
     uchar m_levelLowLimit;
@@ -354,6 +358,7 @@ protected:
 
     bool m_monitorEnabled;
     uchar m_monitorValue;
+    QTimer *m_monitorTimer;
 
     /*********************************************************************
      * Playback
@@ -426,6 +431,10 @@ public:
     /** @reimpl */
     void writeDMX(MasterTimer *timer, QList<Universe*> universes);
 
+    /** @reimpl
+     *  Both modes write only after a level or playback value change */
+    bool writeOnChangeOnly() const;
+
 protected:
     /** writeDMX for Level mode */
     void writeDMXLevel(MasterTimer *timer, QList<Universe*> universes);
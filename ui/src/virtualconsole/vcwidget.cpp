@@ -99,6 +99,12 @@ VCWidget::VCWidget(QWidget* parent, Doc* doc)
 
 VCWidget::~VCWidget()
 {
+    // the Virtual Console is gone when it deletes its children
+    if (VirtualConsole::instance() != NULL)
+    {
+        VirtualConsole::instance()->setWidgetInputSources(this, QList<QSharedPointer<QLCInputSource> >());
+        VirtualConsole::instance()->setWidgetUniverseChannels(this, QList<quint32>());
+    }
 }
 
 /*****************************************************************************
@@ -586,8 +592,6 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Connect when the first valid input source is set
     if (m_inputs.isEmpty() == true && !source.isNull() && source->isValid() == true)
     {
-        connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         connect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                 this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
@@ -612,7 +616,7 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
             if (ip->profile() != NULL)
             {
                 // Do not care about the page since input profiles don't do either
-                QLCInputChannel *ich = ip->profile()->channel(source->channel() & 0xFFFF);
+                QLCInputChannel *ich = ip->profileChannel(source->channel() & 0xFFFF);
                 if (ich != NULL)
                 {
                     if (ich->movementType() == QLCInputChannel::Relative)
@@ -650,11 +654,23 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Disconnect when there are no more input sources present
     if (m_inputs.isEmpty() == true)
     {
-        disconnect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                   this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         disconnect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                    this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
+
+    updateInputIndex();
+}
+
+void VCWidget::updateInputIndex()
+{
+    VirtualConsole *vc = VirtualConsole::instance();
+    if (vc != NULL)
+        vc->setWidgetInputSources(this, m_inputs.values());
+}
+
+void VCWidget::deliverInputValue(quint32 universe, quint32 channel, uchar value)
+{
+    slotInputValueChanged(universe, channel, value);
 }
 
 QSharedPointer<QLCInputSource> VCWidget::inputSource(quint8 id) const
@@ -698,13 +714,9 @@ void VCWidget::sendFeedback(int value, QSharedPointer<QLCInputSource> src)
     InputPatch* pat = m_doc->inputOutputMap()->inputPatch(src->universe());
     if (pat != NULL)
     {
-        QLCInputProfile* profile = pat->profile();
-        if (profile != NULL)
-        {
-            QLCInputChannel* ich = profile->channel(src->channel());
-            if (ich != NULL)
-                chName = ich->name();
-        }
+        QLCInputChannel* ich = pat->profileChannel(src->channel());
+        if (ich != NULL)
+            chName = ich->name();
     }
     m_doc->inputOutputMap()->sendFeedBack(src->universe(), src->channel(), value, chName);
 }
@@ -750,6 +762,24 @@ void VCWidget::slotInputProfileChanged(quint32 universe, const QString &profileN
     }
 }
 
+/*****************************************************************************
+ * Universe values
+ *****************************************************************************/
+
+void VCWidget::universeValuesChanged(quint32 universe, const QByteArray &universeData)
+{
+    /* Don't do anything by default */
+    Q_UNUSED(universe);
+    Q_UNUSED(universeData);
+}
+
+void VCWidget::setUniverseChannels(const QList<quint32> &addresses)
+{
+    VirtualConsole *vc = VirtualConsole::instance();
+    if (vc != NULL)
+        vc->setWidgetUniverseChannels(this, addresses);
+}
+
 /*****************************************************************************
  * Key sequence handler
  *****************************************************************************/
@@ -450,6 +450,16 @@ public:
      */
     virtual void updateFeedback() = 0;
 
+    /**
+     * Deliver an external input value to this widget. The Virtual Console
+     * calls this only for the widgets bound to the value universe and channel
+     */
+    void deliverInputValue(quint32 universe, quint32 channel, uchar value);
+
+protected:
+    /** Update the Virtual Console input index with the current input sources */
+    void updateInputIndex();
+
 protected slots:
     /**
      * Slot that receives external input data. Overwrite in subclasses to
@@ -473,6 +483,21 @@ protected slots:
 protected:
     QHash <quint8, QSharedPointer<QLCInputSource> > m_inputs;
 
+    /*********************************************************************
+     * Universe values
+     *********************************************************************/
+public:
+    /**
+     * Receive the values of $universe, when at least one of the channels
+     * set with setUniverseChannels() changed. Overwrite in subclasses to
+     * display the output values in your widget.
+     */
+    virtual void universeValuesChanged(quint32 universe, const QByteArray& universeData);
+
+protected:
+    /** Set the absolute DMX addresses this widget displays */
+    void setUniverseChannels(const QList<quint32>& addresses);
+
     /*********************************************************************
      * Key sequence handler
      *********************************************************************/
@@ -177,8 +177,6 @@ VCXYPad::VCXYPad(QWidget* parent, Doc* doc) : VCWidget(parent, doc)
     setLiveEdit(m_liveEdit);
 
     m_doc->masterTimer()->registerDMXSource(this);
-    connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
-            this, SLOT(slotUniverseWritten(quint32,QByteArray)));
 }
 
 VCXYPad::~VCXYPad()
@@ -209,6 +207,8 @@ void VCXYPad::enableWidgetUI(bool enable)
         it.setValue(fxi);
     }
 
+    updateUniverseChannels();
+
     foreach(QWidget *presetBtn, m_presets.keys())
         presetBtn->setEnabled(enable);
 
@@ -555,7 +555,7 @@ void VCXYPad::slotRangeValueChanged()
         sendFeedback(m_vRangeSlider->maximumValue(), widthInputSourceId);
 }
 
-void VCXYPad::slotUniverseWritten(quint32 idx, const QByteArray &universeData)
+void VCXYPad::universeValuesChanged(quint32 idx, const QByteArray &universeData)
 {
     QVariantList positions;
 
@@ -622,6 +622,27 @@ void VCXYPad::slotUniverseWritten(quint32 idx, const QByteArray &universeData)
     emit fixturePositions(positions);
 }
 
+void VCXYPad::updateUniverseChannels()
+{
+    QList<quint32> addresses;
+
+    if (m_scene)
+    {
+        foreach (SceneChannel sc, m_sceneChannels)
+            addresses.append((sc.m_universe << 9) + sc.m_channel);
+    }
+    else
+    {
+        foreach (VCXYPadFixture fixture, m_fixtures)
+        {
+            if (fixture.isEnabled())
+                addresses.append(fixture.universeChannels());
+        }
+    }
+
+    setUniverseChannels(addresses);
+}
+
 /*********************************************************************
  * Presets
  *********************************************************************/
@@ -715,6 +736,7 @@ void VCXYPad::slotPresetClicked(bool checked)
     {
         m_scene->stop(functionParent());
         m_scene = NULL;
+        updateUniverseChannels();
         foreach (QSharedPointer<GenericFader> fader, m_fadersMap.values())
         {
             if (!fader.isNull())
@@ -838,6 +860,7 @@ void VCXYPad::slotPresetClicked(bool checked)
             sChan.m_subType = ch->controlByte();
             m_sceneChannels.append(sChan);
         }
+        updateUniverseChannels();
 
         m_area->enableEFXPreview(false);
         // reset the area window as we're switching to relative
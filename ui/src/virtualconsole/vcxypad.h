@@ -190,7 +190,14 @@ public slots:
     void slotPositionChanged(const QPointF& pt);
     void slotSliderValueChanged();
     void slotRangeValueChanged();
-    void slotUniverseWritten(quint32 idx, const QByteArray& universeData);
+
+public:
+    /** @reimp */
+    void universeValuesChanged(quint32 idx, const QByteArray& universeData);
+
+protected:
+    /** Bind this pad to the channels of the fixtures it displays */
+    void updateUniverseChannels();
 
 signals:
     void fixturePositions(const QVariantList positions);
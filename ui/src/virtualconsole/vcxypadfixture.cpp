@@ -515,6 +515,22 @@ quint32 VCXYPadFixture::universe() const
     return m_universe;
 }
 
+QList<quint32> VCXYPadFixture::universeChannels() const
+{
+    QList<quint32> addresses;
+
+    if (m_xMSB == QLCChannel::invalid() || m_yMSB == QLCChannel::invalid())
+        return addresses;
+
+    quint32 base = (m_universe << 9) + m_fixtureAddress;
+
+    addresses << base + m_xMSB << base + m_yMSB;
+    if (m_xLSB != QLCChannel::invalid() && m_yLSB != QLCChannel::invalid())
+        addresses << base + m_xLSB << base + m_yLSB;
+
+    return addresses;
+}
+
 void VCXYPadFixture::updateChannel(FadeChannel *fc, uchar value)
 {
     fc->setStart(value);
@@ -196,6 +196,10 @@ public:
 
     quint32 universe() const;
 
+    /** Return the absolute DMX addresses read by readDMX(),
+     *  or an empty list when the fixture is not armed */
+    QList<quint32> universeChannels() const;
+
     /** Write the value using x & y multipliers for the actual range
      *
      *  \param xmul <0.0;1.0> - pan value scaled to range set by setX
@@ -158,6 +158,14 @@ VirtualConsole::VirtualConsole(QWidget* parent, Doc* doc)
     connect(m_doc, SIGNAL(modeChanged(Doc::Mode)),
             this, SLOT(slotModeChanged(Doc::Mode)));
 
+    // Dispatch external input to the widgets bound to it
+    connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
+            this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+
+    // Dispatch the universe values to the widgets displaying them
+    connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
+            this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+
     // Use the initial mode
     slotModeChanged(m_doc->mode());
 
@@ -1594,6 +1602,149 @@ void VirtualConsole::initContents()
     resetContents();
 }
 
+/*****************************************************************************
+ * External input
+ *****************************************************************************/
+
+void VirtualConsole::setWidgetInputSources(VCWidget *widget,
+                                           const QList<QSharedPointer<QLCInputSource> > &sources)
+{
+    foreach (quint64 key, m_widgetInputKeys.take(widget))
+    {
+        QHash <quint64, QList<VCWidget *> >::iterator it = m_inputWidgets.find(key);
+        if (it == m_inputWidgets.end())
+            continue;
+
+        it.value().removeAll(widget);
+        if (it.value().isEmpty())
+            m_inputWidgets.erase(it);
+    }
+
+    QList<quint64> keys;
+    foreach (QSharedPointer<QLCInputSource> const& source, sources)
+    {
+        if (source.isNull() || source->isValid() == false)
+            continue;
+
+        quint64 key = inputKey(source->universe(), source->channel());
+        if (keys.contains(key))
+            continue;
+
+        keys.append(key);
+        m_inputWidgets[key].append(widget);
+    }
+
+    if (keys.isEmpty() == false)
+        m_widgetInputKeys[widget] = keys;
+}
+
+quint64 VirtualConsole::inputKey(quint32 universe, quint32 channel)
+{
+    return (quint64(universe) << 32) | (channel & 0xFFFF);
+}
+
+void VirtualConsole::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
+{
+    // a widget may change its sources while handling the value
+    const QList<VCWidget *> widgets = m_inputWidgets.value(inputKey(universe, channel));
+
+    foreach (VCWidget *widget, widgets)
+        widget->deliverInputValue(universe, channel, value);
+}
+
+/*****************************************************************************
+ * Universe values
+ *****************************************************************************/
+
+void VirtualConsole::setWidgetUniverseChannels(VCWidget *widget, const QList<quint32> &addresses)
+{
+    foreach (quint32 address, m_widgetUniverseChannels.take(widget))
+    {
+        quint32 universe = address >> 9;
+        QHash <quint32, QMap<quint32, QList<VCWidget *> > >::iterator it = m_universeWidgets.find(universe);
+        if (it == m_universeWidgets.end())
+            continue;
+
+        QMap<quint32, QList<VCWidget *> >::iterator chIt = it.value().find(address & 0x01FF);
+        if (chIt != it.value().end())
+        {
+            chIt.value().removeAll(widget);
+            if (chIt.value().isEmpty())
+                it.value().erase(chIt);
+        }
+
+        if (it.value().isEmpty())
+        {
+            m_universeWidgets.erase(it);
+            m_universeValues.remove(universe);
+        }
+    }
+
+    QList<quint32> bound;
+    QList<quint32> universes;
+    foreach (quint32 address, addresses)
+    {
+        if (bound.contains(address))
+            continue;
+
+        bound.append(address);
+        m_universeWidgets[address >> 9][address & 0x01FF].append(widget);
+        if (universes.contains(address >> 9) == false)
+            universes.append(address >> 9);
+    }
+
+    if (bound.isEmpty())
+        return;
+
+    m_widgetUniverseChannels[widget] = bound;
+
+    // show the current values without waiting for them to change
+    foreach (quint32 universe, universes)
+    {
+        QHash <quint32, QByteArray>::const_iterator it = m_universeValues.constFind(universe);
+        if (it != m_universeValues.constEnd())
+            widget->universeValuesChanged(universe, it.value());
+    }
+}
+
+void VirtualConsole::slotUniverseWritten(quint32 universe, const QByteArray &universeData)
+{
+    QHash <quint32, QMap<quint32, QList<VCWidget *> > >::const_iterator it = m_universeWidgets.constFind(universe);
+    if (it == m_universeWidgets.constEnd())
+        return;
+
+    QByteArray &lastData = m_universeValues[universe];
+    if (lastData == universeData)
+        return;
+
+    QList<VCWidget *> changed;
+    QMapIterator<quint32, QList<VCWidget *> > chIt(it.value());
+    while (chIt.hasNext())
+    {
+        chIt.next();
+        int channel = int(chIt.key());
+
+        if (channel < lastData.size() && channel < universeData.size() &&
+            lastData.at(channel) == universeData.at(channel))
+                continue;
+
+        foreach (VCWidget *widget, chIt.value())
+        {
+            if (changed.contains(widget) == false)
+                changed.append(widget);
+        }
+    }
+
+    lastData = universeData;
+
+    // a widget may change its bindings while handling the values
+    foreach (VCWidget *widget, changed)
+    {
+        if (m_widgetUniverseChannels.contains(widget))
+            widget->universeValuesChanged(universe, universeData);
+    }
+}
+
 /*****************************************************************************
  * Key press handler
  *****************************************************************************/
@@ -22,15 +22,19 @@
 #define VIRTUALCONSOLE_H
 
 #include <QKeySequence>
+#include <QSharedPointer>
 #include <QWidget>
 #include <QFrame>
 #include <QList>
+#include <QHash>
+#include <QMap>
 
 #include "vcproperties.h"
 #include "doc.h"
 
 class QXmlStreamReader;
 class QXmlStreamWriter;
+class QLCInputSource;
 class VirtualConsole;
 class QActionGroup;
 class QVBoxLayout;
@@ -358,6 +362,56 @@ signals:
     /** Signal telling that the keySequence was released */
     void keyReleased(const QKeySequence& keySequence);
 
+    /*********************************************************************
+     * External input
+     *********************************************************************/
+public:
+    /** Bind $widget to the universe and channel of each of its input
+     *  $sources, replacing its previous bindings. An empty list
+     *  removes the widget from the input index */
+    void setWidgetInputSources(VCWidget *widget,
+                               const QList<QSharedPointer<QLCInputSource> > &sources);
+
+protected:
+    /** Return the input index key of a universe and channel.
+     *  The page bits of the channel are ignored */
+    static quint64 inputKey(quint32 universe, quint32 channel);
+
+protected slots:
+    /** Deliver an external input value only to the widgets
+     *  bound to its universe and channel */
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value);
+
+protected:
+    /** Map of the widgets bound to each input universe/channel */
+    QHash <quint64, QList<VCWidget *> > m_inputWidgets;
+
+    /** Map of the input keys each widget is bound to */
+    QHash <VCWidget *, QList<quint64> > m_widgetInputKeys;
+
+    /*********************************************************************
+     * Universe values
+     *********************************************************************/
+public:
+    /** Bind $widget to the absolute DMX $addresses it displays, replacing
+     *  its previous bindings. An empty list removes the widget */
+    void setWidgetUniverseChannels(VCWidget *widget, const QList<quint32> &addresses);
+
+protected slots:
+    /** Deliver a universe frame only to the widgets bound to
+     *  at least one of its changed channels */
+    void slotUniverseWritten(quint32 universe, const QByteArray& universeData);
+
+protected:
+    /** Map of the widgets bound to each channel, per universe */
+    QHash <quint32, QMap<quint32, QList<VCWidget *> > > m_universeWidgets;
+
+    /** Map of the absolute addresses each widget is bound to */
+    QHash <VCWidget *, QList<quint32> > m_widgetUniverseChannels;
+
+    /** The last values written to the universes with bound widgets */
+    QHash <quint32, QByteArray> m_universeValues;
+
     /*********************************************************************
      * Main application mode
      *********************************************************************/
@@ -0,0 +1,110 @@
+/*
+  Q Light Controller Plus
+  workspacewriter.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDebug>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+#include <QSaveFile>
+#endif
+
+#include "workspacewriter.h"
+#include "qlcfile.h"
+
+WorkspaceWriter::WorkspaceWriter(QObject *parent)
+    : QThread(parent)
+    , m_error(QFile::NoError)
+{
+}
+
+WorkspaceWriter::~WorkspaceWriter()
+{
+    wait();
+}
+
+void WorkspaceWriter::write(const QString &fileName, const QByteArray &data)
+{
+    wait();
+
+    m_fileName = fileName;
+    m_data = data;
+    m_error = QFile::NoError;
+
+    start(QThread::LowPriority);
+}
+
+QString WorkspaceWriter::fileName() const
+{
+    return m_fileName;
+}
+
+QFile::FileError WorkspaceWriter::error() const
+{
+    return m_error;
+}
+
+QFile::FileError WorkspaceWriter::writeFile(const QString &fileName, const QByteArray &xml)
+{
+    QByteArray data = QLCFile::isCompressedWorkspace(fileName) ? QLCFile::compressXML(xml) : xml;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+    QSaveFile file(fileName);
+    if (file.open(QIODevice::WriteOnly) == false)
+        return file.error();
+
+    if (file.write(data) != data.size() || file.commit() == false)
+    {
+        qWarning() << "Could not write" << fileName;
+        return file.error() != QFile::NoError ? file.error() : QFile::WriteError;
+    }
+#else
+    QString tempFileName(fileName);
+    tempFileName += ".temp";
+    QFile file(tempFileName);
+    if (file.open(QIODevice::WriteOnly) == false)
+        return file.error();
+
+    if (file.write(data) != data.size())
+    {
+        qWarning() << "Could not write" << tempFileName;
+        file.close();
+        file.remove();
+        return QFile::WriteError;
+    }
+    file.close();
+
+    QFile currFile(fileName);
+    if (currFile.exists() && !currFile.remove())
+    {
+        qWarning() << "Could not erase" << fileName;
+        return currFile.error();
+    }
+    if (!file.rename(fileName))
+    {
+        qWarning() << "Could not rename" << tempFileName << "to" << fileName;
+        return file.error();
+    }
+#endif
+
+    return QFile::NoError;
+}
+
+void WorkspaceWriter::run()
+{
+    m_error = writeFile(m_fileName, m_data);
+    m_data.clear();
+}
@@ -0,0 +1,83 @@
+/*
+  Q Light Controller Plus
+  workspacewriter.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WORKSPACEWRITER_H
+#define WORKSPACEWRITER_H
+
+#include <QByteArray>
+#include <QThread>
+#include <QString>
+#include <QFile>
+
+/** @addtogroup ui UI
+ * @{
+ */
+
+/**
+ * WorkspaceWriter writes an already serialized workspace to disk on a
+ * background thread, so that the UI doesn't wait for the disk while a
+ * large project is saved.
+ *
+ * The file is replaced atomically: the data goes to a temporary file that
+ * takes the place of the old one only when completely written, so a failed
+ * save never leaves a truncated workspace behind.
+ *
+ * The result of the write is available with error() once the thread has
+ * emitted finished().
+ */
+class WorkspaceWriter : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(WorkspaceWriter)
+
+public:
+    WorkspaceWriter(QObject *parent = NULL);
+    ~WorkspaceWriter();
+
+    /**
+     * Start writing $data to the file with the given name. If a previous
+     * write is still running, this waits for it to finish first.
+     */
+    void write(const QString& fileName, const QByteArray& data);
+
+    /** Get the name of the file of the last write */
+    QString fileName() const;
+
+    /** Get the result of the last write */
+    QFile::FileError error() const;
+
+    /**
+     * Write the XML data $xml to the file with the given name, replacing it
+     * atomically. Compressed workspace files are compressed before writing.
+     */
+    static QFile::FileError writeFile(const QString& fileName, const QByteArray& xml);
+
+protected:
+    /** @reimp */
+    void run();
+
+private:
+    QString m_fileName;
+    QByteArray m_data;
+    QFile::FileError m_error;
+};
+
+/** @} */
+
+#endif
@@ -667,6 +667,47 @@ void VCButton_Test::input()
     m_doc->masterTimer()->stop();
 }
 
+void VCButton_Test::inputDispatch()
+{
+    QWidget w;
+
+    Scene* sc = new Scene(m_doc);
+    sc->setValue(0, 0, 255);
+    m_doc->addFunction(sc);
+
+    VCButton btn1(&w, m_doc);
+    btn1.setFunction(sc->id());
+    btn1.setAction(VCButton::Flash);
+    btn1.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(0, 1)));
+
+    VCButton btn2(&w, m_doc);
+    btn2.setFunction(sc->id());
+    btn2.setAction(VCButton::Flash);
+    btn2.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(0, 2)));
+
+    m_doc->setMode(Doc::Operate);
+
+    // only the button bound to the channel receives the value
+    emit m_doc->inputOutputMap()->inputValueChanged(0, 2, 255);
+    QCOMPARE(btn1.state(), VCButton::Inactive);
+    QCOMPARE(btn2.state(), VCButton::Active);
+
+    emit m_doc->inputOutputMap()->inputValueChanged(0, 2, 0);
+    QCOMPARE(btn2.state(), VCButton::Inactive);
+
+    // the index follows the input source changes
+    btn1.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(0, 2)));
+    emit m_doc->inputOutputMap()->inputValueChanged(0, 2, 255);
+    QCOMPARE(btn1.state(), VCButton::Active);
+    QCOMPARE(btn2.state(), VCButton::Active);
+
+    emit m_doc->inputOutputMap()->inputValueChanged(0, 2, 0);
+    btn1.setInputSource(QSharedPointer<QLCInputSource>());
+    emit m_doc->inputOutputMap()->inputValueChanged(0, 2, 255);
+    QCOMPARE(btn1.state(), VCButton::Inactive);
+    QCOMPARE(btn2.state(), VCButton::Active);
+}
+
 void VCButton_Test::paint()
 {
     QWidget w;
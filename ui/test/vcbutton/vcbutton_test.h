@@ -50,6 +50,7 @@ private slots:
     void toggle();
     void flash();
     void input();
+    void inputDispatch();
     void paint();
 
     // https://github.com/mcallegari/qlcplus/issues/116
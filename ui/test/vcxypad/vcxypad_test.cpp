@@ -463,4 +463,57 @@ void VCXYPad_Test::modeChange()
     QCOMPARE(m_doc->masterTimer()->m_dmxSourceList.size(), 0);
 }
 
+void VCXYPad_Test::universeDispatch()
+{
+    QWidget w;
+
+    Fixture* fxi = new Fixture(m_doc);
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("Futurelight", "DJScan250");
+    QVERIFY(def != NULL);
+    QLCFixtureMode* mode = def->modes().first();
+    QVERIFY(mode != NULL);
+    fxi->setFixtureDefinition(def, mode);
+    m_doc->addFixture(fxi);
+
+    VCXYPad pad(&w, m_doc);
+    VCXYPadFixture xy(m_doc);
+    xy.setHead(GroupHead(fxi->id(), 0));
+    pad.appendFixture(xy);
+
+    VirtualConsole *vc = VirtualConsole::instance();
+    QVERIFY(vc->m_widgetUniverseChannels.contains(&pad) == false);
+
+    m_doc->setMode(Doc::Operate);
+    QVERIFY(vc->m_widgetUniverseChannels.contains(&pad) == true);
+    quint32 pan = pad.fixtures()[0].m_xMSB;
+
+    QSignalSpy spy(&pad, SIGNAL(fixturePositions(QVariantList)));
+    QByteArray data(512, 0);
+
+    // the first frame is always delivered
+    emit m_doc->inputOutputMap()->universeWritten(0, data);
+    QCOMPARE(spy.count(), 1);
+
+    // unchanged frame
+    emit m_doc->inputOutputMap()->universeWritten(0, data);
+    QCOMPARE(spy.count(), 1);
+
+    // a channel the pad doesn't display
+    data[400] = char(255);
+    emit m_doc->inputOutputMap()->universeWritten(0, data);
+    QCOMPARE(spy.count(), 1);
+
+    // another universe
+    emit m_doc->inputOutputMap()->universeWritten(1, QByteArray(512, char(127)));
+    QCOMPARE(spy.count(), 1);
+
+    data[pan] = char(127);
+    emit m_doc->inputOutputMap()->universeWritten(0, data);
+    QCOMPARE(spy.count(), 2);
+
+    m_doc->setMode(Doc::Design);
+    QVERIFY(vc->m_widgetUniverseChannels.contains(&pad) == false);
+    QVERIFY(vc->m_universeWidgets.isEmpty() == true);
+}
+
 QTEST_MAIN(VCXYPad_Test)
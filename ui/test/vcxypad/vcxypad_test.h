@@ -38,6 +38,7 @@ private slots:
     void loadXML();
     void saveXML();
     void modeChange();
+    void universeDispatch();
 
 private:
     Doc* m_doc;
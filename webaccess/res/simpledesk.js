@@ -18,6 +18,69 @@
 */
 
 var websocket;
+var subscribedUniverse = 0;
+
+// binary frames, see webaccessuniversemonitor.h
+var WS_BINARY_SNAPSHOT = 1;
+var WS_BINARY_DELTA = 2;
+var WS_BINARY_SET = 3;
+
+function subscribeUniverse(uni) {
+ if (subscribedUniverse === uni) {
+   return;
+ }
+ if (subscribedUniverse !== 0) {
+   websocket.send("QLC+API|unsubscribeUniverse|" + subscribedUniverse);
+ }
+ websocket.send("QLC+API|subscribeUniverse|" + uni);
+ subscribedUniverse = uni;
+}
+
+function setSliderValue(chNum, value) {
+ var slObj = document.getElementById(chNum);
+ if (slObj === null) {
+   return;
+ }
+ slObj.value = value;
+ document.getElementById("sdslv" + chNum).innerHTML = value;
+}
+
+function processUniverseFrame(buffer) {
+ var view = new DataView(buffer);
+ if (view.byteLength < 3) {
+   return;
+ }
+ var type = view.getUint8(0);
+ var uni = view.getUint16(1) + 1;
+ if (uni !== currentUniverse) {
+   return;
+ }
+ var firstCh = ((currentPage - 1) * channelsPerPage) + 1;
+ var pos = 3;
+ while (pos + 4 <= view.byteLength) {
+   var start = 0;
+   var count = 0;
+   if (type === WS_BINARY_SNAPSHOT) {
+     count = view.getUint16(pos);
+     pos += 2;
+   } else if (type === WS_BINARY_DELTA) {
+     start = view.getUint16(pos);
+     count = view.getUint16(pos + 2);
+     pos += 4;
+   } else {
+     return;
+   }
+   for (var i = 0; i < count && pos < view.byteLength; i++, pos++) {
+     var chNum = start + i + 1;
+     if (chNum >= firstCh && chNum < firstCh + channelsPerPage) {
+       setSliderValue(chNum, view.getUint8(pos));
+     }
+   }
+   if (type === WS_BINARY_SNAPSHOT) {
+     return;
+   }
+ }
+}
 
 function getPage(uni, page) {
  var address = ((page - 1) * channelsPerPage) + 1;
@@ -28,8 +91,10 @@ function getPage(uni, page) {
 window.onload = function() {
    var url = "ws://" + window.location.host + "/qlcplusWS";
    websocket = new WebSocket(url);
+   websocket.binaryType = "arraybuffer";
    websocket.onopen = function(ev) {
     getPage(1, 1);
+    subscribeUniverse(currentUniverse);
    };
    websocket.onclose = function(ev) {
     alert("QLC+ connection lost!");
@@ -39,6 +104,10 @@ window.onload = function() {
    };
    websocket.onmessage = function(ev) {
     //alert(ev.data);
+    if (ev.data instanceof ArrayBuffer) {
+      processUniverseFrame(ev.data);
+      return;
+    }
     var msgParams = ev.data.split("|");
     if (msgParams[0] === "QLC+API") {
       if (msgParams[1] === "getChannelsValues") {
@@ -129,6 +198,7 @@ function universeChanged(uniIdx) {
  var pgObj = document.getElementById("pageDiv");
  pgObj.innerHTML = currentPage;
  getPage(currentUniverse, currentPage);
+ subscribeUniverse(currentUniverse);
 }
 
 function resetChannel(pageCh) {
@@ -147,7 +217,12 @@ function sdSlVchange(id) {
  var slObj = document.getElementById(id);
  var labelObj = document.getElementById("sdslv" + id);
  labelObj.innerHTML = slObj.value;
- var chNum = ((currentUniverse - 1) * 512) + parseInt(id);
- var sldMsg = "CH|" + chNum + "|" + slObj.value;
- websocket.send(sldMsg);
+ // <SET>|<universe>|<start channel>|<values...>
+ var buffer = new ArrayBuffer(6);
+ var view = new DataView(buffer);
+ view.setUint8(0, WS_BINARY_SET);
+ view.setUint16(1, currentUniverse - 1);
+ view.setUint16(3, parseInt(id) - 1);
+ view.setUint8(5, parseInt(slObj.value));
+ websocket.send(buffer);
 }
@@ -39,7 +39,17 @@ window.onload = function() {
 
  websocket.onmessage = function(ev) {
   //console.log(ev.data);
-  var msgParams = ev.data.split("|");
+  // widget updates are batched, one per line
+  var messages = ev.data.split("\n");
+  for (var i = 0; i < messages.length; i++) {
+    processMessage(messages[i]);
+  }
+ };
+ initVirtualConsole();
+};
+
+function processMessage(message) {
+  var msgParams = message.split("|");
   if (msgParams[1] === "BUTTON") {
     wsSetButtonState(msgParams[0], msgParams[2]);
   }
@@ -62,6 +72,4 @@ window.onload = function() {
   else if (msgParams[0] === "ALERT") {
     alert(msgParams[1]);
   }
- };
- initVirtualConsole();
-};
+}
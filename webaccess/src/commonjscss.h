@@ -34,6 +34,9 @@
     " websocket.onmessage = function(ev) {\n" \
     "  var msgParams = ev.data.split('|');\n" \
     "  if (msgParams[0] == \"QLC+API\" && " \
+    "      msgParams[1] == \"loadProgress\")" \
+    "        document.getElementById(\"loadProgress\").innerHTML = msgParams[2] + \"%\";\n" \
+    "  else if (msgParams[0] == \"QLC+API\" && " \
     "      msgParams[1] == \"isProjectLoaded\" && " \
     "      msgParams[2] == \"true\")" \
     "        window.location = \"/\";\n" \
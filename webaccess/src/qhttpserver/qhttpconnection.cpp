@@ -24,6 +24,7 @@
 
 #include <QTcpSocket>
 #include <QHostAddress>
+#include <QThread>
 #include <QTimer>
 #include <QDebug>
 
@@ -42,7 +43,10 @@ QHttpConnection::QHttpConnection(QTcpSocket *socket, QObject *parent)
       m_transmitLen(0),
       m_transmitPos(0),
       m_postPending(false),
+      m_pendingResponses(0),
+      m_disconnected(false),
       m_isWebSocket(false),
+      m_closeNotified(false),
       m_pollTimer(NULL)
 {
     m_parser = (http_parser *)malloc(sizeof(http_parser));
@@ -77,7 +81,7 @@ QHttpConnection::~QHttpConnection()
     delete m_parserSettings;
     m_parserSettings = 0;
 
-    if (m_isWebSocket == true)
+    if (m_isWebSocket == true && m_closeNotified == false)
         Q_EMIT webSocketConnectionClose(this);
 
     qDebug() << "HTTP connection destroyed!";
@@ -85,8 +89,21 @@ QHttpConnection::~QHttpConnection()
 
 void QHttpConnection::socketDisconnected()
 {
-    deleteLater();
+    m_disconnected = true;
     invalidateRequest();
+    finishDisconnection();
+}
+
+void QHttpConnection::finishDisconnection()
+{
+    if (m_disconnected == false || m_pendingResponses > 0)
+        return;
+
+    // a WebSocket connection is deleted by the receiver of the close signal
+    if (m_isWebSocket)
+        notifyWebSocketClose();
+    else
+        deleteLater();
 }
 
 void QHttpConnection::invalidateRequest()
@@ -134,25 +151,63 @@ void QHttpConnection::parseRequest()
 
 void QHttpConnection::write(const QByteArray &data)
 {
+    if (QThread::currentThread() == thread())
+    {
+        writeSocket(data);
+        return;
+    }
+
+    QMutexLocker locker(&m_queueMutex);
+    bool wasEmpty = m_writeQueue.isEmpty();
+    m_writeQueue.append(data);
+
+    if (wasEmpty)
+        QMetaObject::invokeMethod(this, "slotWriteQueued", Qt::QueuedConnection);
+}
+
+void QHttpConnection::writeSocket(const QByteArray &data)
+{
+    if (m_socket == NULL)
+        return;
+
     m_socket->write(data);
     m_transmitLen += data.size();
 }
 
+void QHttpConnection::slotWriteQueued()
+{
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        data = m_writeQueue;
+        m_writeQueue.clear();
+    }
+
+    if (data.isEmpty() == false)
+        writeSocket(data);
+}
+
 void QHttpConnection::flush()
 {
-    m_socket->flush();
+    if (QThread::currentThread() == thread())
+        m_socket->flush();
 }
 
 void QHttpConnection::waitForBytesWritten()
 {
-    m_socket->waitForBytesWritten();
+    if (QThread::currentThread() == thread())
+        m_socket->waitForBytesWritten();
 }
 
 void QHttpConnection::responseDone()
 {
+    m_pendingResponses--;
+
     QHttpResponse *response = qobject_cast<QHttpResponse *>(QObject::sender());
-    if (response->m_last && m_isWebSocket == false)
+    if (response && response->m_last && m_isWebSocket == false)
         m_socket->disconnectFromHost();
+
+    finishDisconnection();
 }
 
 /* URL Utilities */
@@ -257,10 +312,15 @@ int QHttpConnection::HeadersComplete(http_parser *parser)
         // on a POST, do not emit the newRequest signal until the transfer has
         // been completed
         theConnection->m_postPending = true;
+
+        // keep large uploads out of memory
+        if (theConnection->m_request->header("content-length").toLongLong() > QHTTPREQUEST_SPOOL_SIZE)
+            theConnection->m_request->spoolBody();
     }
     else
     {
         // we are good to go!
+        theConnection->m_pendingResponses++;
         Q_EMIT theConnection->newRequest(theConnection->m_request, response);
     }
 
@@ -273,12 +333,16 @@ int QHttpConnection::MessageComplete(http_parser *parser)
     QHttpConnection *theConnection = static_cast<QHttpConnection *>(parser->data);
     Q_ASSERT(theConnection->m_request);
 
+    theConnection->m_request->finishBody();
     theConnection->m_request->setSuccessful(true);
     Q_EMIT theConnection->m_request->end();
     if (theConnection->m_postPending == true)
     {
         theConnection->m_postPending = false;
         QHttpResponse *response = new QHttpResponse(theConnection);
+        connect(theConnection, SIGNAL(destroyed()), response, SLOT(connectionClosed()));
+        connect(response, SIGNAL(done()), theConnection, SLOT(responseDone()));
+        theConnection->m_pendingResponses++;
         Q_EMIT theConnection->newRequest(theConnection->m_request, response);
     }
     return 0;
@@ -341,6 +405,17 @@ int QHttpConnection::Body(http_parser *parser, const char *at, size_t length)
  *************************************************************************/
 
 QHttpConnection *QHttpConnection::enableWebSocket(bool enable)
+{
+    // queued before the handshake reply, so it is processed first
+    if (QThread::currentThread() == thread())
+        slotEnableWebSocket(enable);
+    else
+        QMetaObject::invokeMethod(this, "slotEnableWebSocket", Qt::QueuedConnection,
+                                  Q_ARG(bool, enable));
+    return this;
+}
+
+void QHttpConnection::slotEnableWebSocket(bool enable)
 {
     m_isWebSocket = enable;
     m_pollTimer = new QTimer(this);
@@ -350,7 +425,18 @@ QHttpConnection *QHttpConnection::enableWebSocket(bool enable)
             this, SLOT(slotWebSocketPollTimeout()));
 
     m_pollTimer->start();
-    return this;
+}
+
+void QHttpConnection::notifyWebSocketClose()
+{
+    if (m_closeNotified)
+        return;
+
+    m_closeNotified = true;
+    if (m_pollTimer)
+        m_pollTimer->stop();
+
+    Q_EMIT webSocketConnectionClose(this);
 }
 
 void QHttpConnection::slotWebSocketPollTimeout()
@@ -372,8 +458,7 @@ void QHttpConnection::webSocketWrite(WebSocketOpCode opCode, QByteArray data)
 
     data.prepend(0x80 + quint8(opCode));
 
-    if (m_socket)
-        m_socket->write(data);
+    write(data);
 }
 
 /**
@@ -414,7 +499,7 @@ void QHttpConnection::webSocketRead(QByteArray data)
 
     qDebug() << "[webSocketRead] total data length:" << data.size();
 
-    while (dataPos < data.size())
+    while (dataPos < data.size() && m_closeNotified == false)
     {
         int opCode = data.at(dataPos) & 0x0F;
         dataPos++;
@@ -446,10 +531,10 @@ void QHttpConnection::webSocketRead(QByteArray data)
 
         qDebug() << "[webSocketRead] opCode:" << QString("0x%1").arg(opCode, 2, 16, QChar('0'));
 
-        if (opCode == TextFrame)
+        if (opCode == TextFrame || opCode == BinaryFrame)
         {
             int lengthCounter = dataLen;
-            qDebug() << "[webSocketRead] Text frame length:" << dataLen;
+            qDebug() << "[webSocketRead] Data frame length:" << dataLen;
             // if the payload is masked, then unmask
             if (masked == true)
             {
@@ -459,12 +544,15 @@ void QHttpConnection::webSocketRead(QByteArray data)
                     *cData++ ^= mask[i++ % 4];
             }
 
-            Q_EMIT webSocketDataReady(this, QString(data.mid(dataPos, dataLen)));
+            if (opCode == TextFrame)
+                Q_EMIT webSocketDataReady(this, QString(data.mid(dataPos, dataLen)));
+            else
+                Q_EMIT webSocketBinaryDataReady(this, data.mid(dataPos, dataLen));
         }
         else if (opCode == ConnectionClose)
         {
             qDebug() << "[webSocketRead] Connection closed by the client";
-            Q_EMIT webSocketConnectionClose(this);
+            notifyWebSocketClose();
         }
         dataPos += dataLen;
     }
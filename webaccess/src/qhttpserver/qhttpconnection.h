@@ -27,6 +27,7 @@
 #include "qhttpserverfwd.h"
 
 #include <QObject>
+#include <QMutex>
 
 /// @cond nodoc
 
@@ -40,7 +41,12 @@ public:
     QHttpConnection(QTcpSocket *socket, QObject *parent = 0);
     virtual ~QHttpConnection();
 
+    /// Write data to the client. It can be called from any thread: when
+    /// called from other threads than the connection one, the data is
+    /// queued and written by the connection thread in one go.
     void write(const QByteArray &data);
+
+    /// These have effect only from the connection thread
     void flush();
     void waitForBytesWritten();
 
@@ -55,6 +61,16 @@ private Q_SLOTS:
     void invalidateRequest();
     void updateWriteCount(qint64);
 
+    /// Write the data queued by the other threads
+    void slotWriteQueued();
+
+private:
+    void writeSocket(const QByteArray &data);
+
+    /// Delete the connection once the socket is disconnected
+    /// and the pending responses are done
+    void finishDisconnection();
+
 private:
     static int MessageBegin(http_parser *parser);
     static int Url(http_parser *parser, const char *at, size_t length);
@@ -84,6 +100,16 @@ private:
 
     bool m_postPending;
 
+    // Responses handed to the newRequest receivers and not done yet.
+    // They might be in use by another thread, so the connection
+    // is not deleted until they are done
+    int m_pendingResponses;
+    bool m_disconnected;
+
+    // Data written by the other threads, waiting for the connection thread
+    QMutex m_queueMutex;
+    QByteArray m_writeQueue;
+
     /*************************************************************************
      * WebSocket methods
      *************************************************************************/
@@ -98,21 +124,31 @@ public:
         Pong = 0x0A
     };
 
+    /// Both can be called from any thread
     QHttpConnection *enableWebSocket(bool enable);
     void webSocketWrite(WebSocketOpCode opCode, QByteArray data);
 
 Q_SIGNALS:
     void webSocketDataReady(QHttpConnection *conn, QString data);
+    void webSocketBinaryDataReady(QHttpConnection *conn, QByteArray data);
+
+    /// Emitted once, when the client closes a WebSocket connection.
+    /// The receiver owns the connection from then on, and must delete it
+    /// with deleteLater() when it doesn't refer to it anymore. This keeps
+    /// the connection valid for signals still queued to other threads
     void webSocketConnectionClose(QHttpConnection *conn);
 
 private Q_SLOTS:
+    void slotEnableWebSocket(bool enable);
     void slotWebSocketPollTimeout();
 
 private:
     void webSocketRead(QByteArray data);
+    void notifyWebSocketClose();
 
 private:
     bool m_isWebSocket;
+    bool m_closeNotified;
     QTimer *m_pollTimer;
 
 public:
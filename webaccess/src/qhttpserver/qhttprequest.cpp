@@ -24,8 +24,13 @@
 
 #include "qhttpconnection.h"
 
+#include <QTemporaryFile>
+#include <QDir>
+#include <QDebug>
+
 QHttpRequest::QHttpRequest(QHttpConnection *connection, QObject *parent)
-    : QObject(parent), m_connection(connection), m_url("http://localhost/"), m_success(false)
+    : QObject(parent), m_connection(connection), m_url("http://localhost/"),
+      m_bodyFile(NULL), m_success(false)
 {
     connect(this, SIGNAL(data(const QByteArray &)), this, SLOT(appendBody(const QByteArray &)),
             Qt::UniqueConnection);
@@ -33,6 +38,7 @@ QHttpRequest::QHttpRequest(QHttpConnection *connection, QObject *parent)
 
 QHttpRequest::~QHttpRequest()
 {
+    delete m_bodyFile;
 }
 
 QString QHttpRequest::header(const QString &field) const
@@ -80,6 +86,38 @@ quint16 QHttpRequest::remotePort() const
     return m_remotePort;
 }
 
+QString QHttpRequest::bodyFileName() const
+{
+    return m_bodyFile ? m_bodyFile->fileName() : QString();
+}
+
+void QHttpRequest::releaseBody()
+{
+    delete m_bodyFile;
+    m_bodyFile = NULL;
+    m_body.clear();
+}
+
+void QHttpRequest::spoolBody()
+{
+    if (m_bodyFile != NULL)
+        return;
+
+    m_bodyFile = new QTemporaryFile(QDir::temp().filePath("qhttpbody_XXXXXX"));
+    if (m_bodyFile->open() == false)
+    {
+        qWarning() << "[QHttpRequest] Unable to create a body file, keeping the body in memory";
+        delete m_bodyFile;
+        m_bodyFile = NULL;
+    }
+}
+
+void QHttpRequest::finishBody()
+{
+    if (m_bodyFile != NULL)
+        m_bodyFile->flush();
+}
+
 void QHttpRequest::storeBody()
 {
     connect(this, SIGNAL(data(const QByteArray &)), this, SLOT(appendBody(const QByteArray &)),
@@ -95,5 +133,8 @@ QString QHttpRequest::MethodToString(HttpMethod method)
 void QHttpRequest::appendBody(const QByteArray &body)
 {
     //qDebug() << "Appending body data:" << body.size();
-    m_body.append(body);
+    if (m_bodyFile != NULL)
+        m_bodyFile->write(body);
+    else
+        m_body.append(body);
 }
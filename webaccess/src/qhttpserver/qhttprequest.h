@@ -31,6 +31,11 @@
 #include <QMetaType>
 #include <QUrl>
 
+class QTemporaryFile;
+
+/// Bodies larger than this are spooled to a temporary file instead of memory.
+#define QHTTPREQUEST_SPOOL_SIZE (1024 * 1024)
+
 /// The QHttpRequest class represents the header and body data sent by the client.
 /** The requests header data is available immediately. Body data is streamed as
     it comes in via the data() signal. As a consequence the application's request
@@ -144,6 +149,16 @@ public:
         return m_body;
     }
 
+    /// Name of the file holding the body, empty if the body is in memory.
+    /** POST bodies larger than QHTTPREQUEST_SPOOL_SIZE are written to a
+        temporary file while they are received, and body() stays empty.
+        The file is complete once the request is successful.
+        @sa releaseBody() */
+    QString bodyFileName() const;
+
+    /// Remove the temporary file holding the body, once it has been read.
+    void releaseBody();
+
     /// If this request was successfully received.
     /** Set before end() has been emitted, stating whether
         the message was properly received. This is false
@@ -183,6 +198,12 @@ private:
 
     static QString MethodToString(HttpMethod method);
 
+    /// Write the body to a temporary file from now on.
+    void spoolBody();
+
+    /// Flush the spooled body, once the request is complete.
+    void finishBody();
+
     void setMethod(HttpMethod method) { m_method = method; }
     void setVersion(const QString &version) { m_version = version; }
     void setUrl(const QUrl &url) { m_url = url; }
@@ -197,6 +218,7 @@ private:
     QString m_remoteAddress;
     quint16 m_remotePort;
     QByteArray m_body;
+    QTemporaryFile *m_bodyFile;
     bool m_success;
 };
 
@@ -105,6 +105,8 @@ void QHttpServer::newConnection()
                 SIGNAL(newRequest(QHttpRequest *, QHttpResponse *)));
         connect(connection, SIGNAL(webSocketDataReady(QHttpConnection*,QString)),
                 this, SIGNAL(webSocketDataReady(QHttpConnection*,QString)));
+        connect(connection, SIGNAL(webSocketBinaryDataReady(QHttpConnection*,QByteArray)),
+                this, SIGNAL(webSocketBinaryDataReady(QHttpConnection*,QByteArray)));
         connect(connection, SIGNAL(webSocketConnectionClose(QHttpConnection*)),
                 this, SIGNAL(webSocketConnectionClose(QHttpConnection*)));
     }
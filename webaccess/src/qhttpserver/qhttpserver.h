@@ -77,7 +77,7 @@ public:
     /** @param port Port number on which the server should run.
         @return True if the server was started successfully, false otherwise.
         @sa listen(const QHostAddress&, quint16) */
-    bool listen(quint16 port);
+    Q_INVOKABLE bool listen(quint16 port);
 
     /// Stop the server and listening for new connections.
     void close();
@@ -90,6 +90,7 @@ Q_SIGNALS:
     void newRequest(QHttpRequest *request, QHttpResponse *response);
 
     void webSocketDataReady(QHttpConnection *conn, QString data);
+    void webSocketBinaryDataReady(QHttpConnection *conn, QByteArray data);
     void webSocketConnectionClose(QHttpConnection *conn);
 
 private Q_SLOTS:
@@ -50,6 +50,8 @@ HEADERS += commonjscss.h \
            webaccess.h \
            webaccessconfiguration.h \
            webaccesssimpledesk.h \
+           webaccessuniversemonitor.h \
+           webaccessmetrics.h \
            webaccessauth.h
 
 unix:!macx: HEADERS += webaccessnetwork.h
@@ -57,6 +59,8 @@ unix:!macx: HEADERS += webaccessnetwork.h
 SOURCES += webaccess.cpp \
            webaccessconfiguration.cpp \
            webaccesssimpledesk.cpp \
+           webaccessuniversemonitor.cpp \
+           webaccessmetrics.cpp \
            webaccessauth.cpp
 
 unix:!macx: SOURCES += webaccessnetwork.cpp
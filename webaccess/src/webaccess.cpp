@@ -17,14 +17,23 @@
   limitations under the License.
 */
 
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
+#include <QTimer>
+#include <QThread>
 #include <QProcess>
 #include <QSettings>
+#include <QTemporaryFile>
+#include <QBuffer>
+#include <QDir>
 
 #include "webaccess.h"
 
 #include "webaccessauth.h"
 #include "webaccessconfiguration.h"
+#include "webaccessuniversemonitor.h"
+#include "webaccessmetrics.h"
 #include "webaccesssimpledesk.h"
 #include "webaccessnetwork.h"
 #include "vcaudiotriggers.h"
@@ -33,7 +42,10 @@
 #include "vcsoloframe.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
+#include "loadgovernor.h"
+#include "mastertimer.h"
 #include "simpledesk.h"
+#include "ticktrace.h"
 #include "qlcconfig.h"
 #include "webaccess.h"
 #include "vccuelist.h"
@@ -65,6 +77,11 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, SimpleDesk *sdInstanc
   , m_vc(vcInstance)
   , m_sd(sdInstance)
   , m_auth(NULL)
+  , m_universeMonitor(new WebAccessUniverseMonitor(doc, this))
+  , m_metrics(new WebAccessMetrics(doc))
+  , m_updatesTimer(new QTimer(this))
+  , m_vcRevision(0)
+  , m_sessionID(QString::number(QDateTime::currentMSecsSinceEpoch(), 16))
   , m_pendingProjectLoaded(false)
 {
     Q_ASSERT(m_doc != NULL);
@@ -76,15 +93,32 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, SimpleDesk *sdInstanc
         m_auth->loadPasswordsFile(passwdFile);
     }
 
-    m_httpServer = new QHttpServer(this);
+    qRegisterMetaType<QHttpRequest*>("QHttpRequest*");
+    qRegisterMetaType<QHttpResponse*>("QHttpResponse*");
+    qRegisterMetaType<QHttpConnection*>("QHttpConnection*");
+
+    m_networkThread = new QThread(this);
+    m_httpServer = new QHttpServer();
+    m_httpServer->moveToThread(m_networkThread);
+    connect(m_networkThread, SIGNAL(finished()), m_httpServer, SLOT(deleteLater()));
+
     connect(m_httpServer, SIGNAL(newRequest(QHttpRequest*, QHttpResponse*)),
             this, SLOT(slotHandleRequest(QHttpRequest*, QHttpResponse*)));
     connect(m_httpServer, SIGNAL(webSocketDataReady(QHttpConnection*,QString)),
             this, SLOT(slotHandleWebSocketRequest(QHttpConnection*,QString)));
+    connect(m_httpServer, SIGNAL(webSocketBinaryDataReady(QHttpConnection*,QByteArray)),
+            this, SLOT(slotHandleWebSocketBinaryRequest(QHttpConnection*,QByteArray)));
     connect(m_httpServer, SIGNAL(webSocketConnectionClose(QHttpConnection*)),
             this, SLOT(slotHandleWebSocketClose(QHttpConnection*)));
 
-    m_httpServer->listen(QHostAddress::Any, portNumber ? portNumber : DEFAULT_PORT_NUMBER);
+    m_networkThread->start();
+    QMetaObject::invokeMethod(m_httpServer, "listen", Qt::QueuedConnection,
+                              Q_ARG(quint16, portNumber ? portNumber : DEFAULT_PORT_NUMBER));
+
+    // widget updates are batched once per MasterTimer frame
+    m_updatesTimer->setSingleShot(true);
+    m_updatesTimer->setInterval(MasterTimer::tick());
+    connect(m_updatesTimer, SIGNAL(timeout()), this, SLOT(slotFlushWidgetUpdates()));
 
 #if defined(Q_WS_X11) || defined(Q_OS_LINUX)
     m_netConfig = new WebAccessNetwork();
@@ -92,6 +126,11 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, SimpleDesk *sdInstanc
 
     connect(m_vc, SIGNAL(loaded()),
             this, SLOT(slotVCLoaded()));
+    connect(m_doc, SIGNAL(loadProgress(int)),
+            this, SLOT(slotProjectLoadProgress(int)));
+    // widgets edits mark the project as modified
+    connect(m_doc, SIGNAL(modified(bool)),
+            this, SLOT(slotInvalidateVCPage()));
 }
 
 WebAccess::~WebAccess()
@@ -99,11 +138,17 @@ WebAccess::~WebAccess()
 #if defined(Q_WS_X11) || defined(Q_OS_LINUX)
     delete m_netConfig;
 #endif
+    // the connections are deleted along with the server, in its thread
     foreach(QHttpConnection *conn, m_webSocketsList)
-        delete conn;
+        delete static_cast<WebAccessUser*>(conn->userData);
+
+    m_networkThread->quit();
+    m_networkThread->wait();
 
     if (m_auth)
         delete m_auth;
+
+    delete m_metrics;
 }
 
 void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
@@ -145,6 +190,15 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
         resp->writeHead(101);
         resp->end(QByteArray());
 
+        // the cached VC page might be older than the widgets state
+        if (conn != NULL && m_widgetStateKeys.isEmpty() == false)
+        {
+            QStringList states;
+            foreach (QString key, m_widgetStateKeys)
+                states.append(m_widgetStates.value(key));
+            conn->webSocketWrite(QHttpConnection::TextFrame, states.join("\n").toUtf8());
+        }
+
         return;
     }
     else if (reqUrl == "/loadProject")
@@ -154,13 +208,13 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
             m_auth->sendUnauthorizedResponse(resp);
             return;
         }
-        QByteArray projectXML = req->body();
-
-        projectXML.remove(0, projectXML.indexOf("\n\r\n") + 3);
-        projectXML.truncate(projectXML.lastIndexOf("\n\r\n"));
-
-        //qDebug() << "Project XML:\n\n" << QString(projectXML) << "\n\n";
-        qDebug() << "Workspace XML received. Content-Length:" << req->headers().value("content-length") << projectXML.size();
+        QString projectFile = storeUploadedProject(req);
+        if (projectFile.isEmpty())
+        {
+            resp->writeHead(500);
+            resp->end(QByteArray());
+            return;
+        }
 
         QByteArray postReply =
                 QString("<html><head>\n<meta http-equiv=\"content-type\" content=\"text/html; charset=utf-8\" />\n"
@@ -169,7 +223,7 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
                 "<div style=\"position: absolute; width: 100%; height: 30px; top: 50%; background-color: #888888;"
                 "text-align: center; font:bold 24px/1.2em sans-serif;\">"
                 + tr("Loading project...") +
-                "</div></body></html>").toUtf8();
+                " <span id=\"loadProgress\"></span></div></body></html>").toUtf8();
 
         resp->setHeader("Content-Type", "text/html");
         resp->setHeader("Content-Length", QString::number(postReply.size()));
@@ -178,7 +232,8 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
 
         m_pendingProjectLoaded = false;
 
-        emit loadProject(QString(projectXML).toUtf8());
+        // load once the reply has been sent, so the page can follow the progress
+        emit loadProjectFile(projectFile);
 
         return;
     }
@@ -233,6 +288,46 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
         }
         content = WebAccessSimpleDesk::getHTML(m_doc, m_sd);
     }
+    else if (reqUrl == "/metrics" || reqUrl == "/metrics.json")
+    {
+        QByteArray metrics;
+        if (reqUrl == "/metrics")
+        {
+            metrics = m_metrics->getPrometheusText().toUtf8();
+            resp->setHeader("Content-Type", "text/plain; version=0.0.4");
+        }
+        else
+        {
+            metrics = m_metrics->getJSON().toUtf8();
+            resp->setHeader("Content-Type", "application/json");
+        }
+        resp->setHeader("Content-Length", QString::number(metrics.size()));
+        resp->writeHead(200);
+        resp->end(metrics);
+        return;
+    }
+    else if (reqUrl == "/trace.json" || reqUrl == "/trace/start" || reqUrl == "/trace/stop")
+    {
+        if(m_auth && user.level < SUPER_ADMIN_LEVEL)
+        {
+            m_auth->sendUnauthorizedResponse(resp);
+            return;
+        }
+
+        /* The events recorded so far can be fetched while tracing */
+        QByteArray trace;
+        if (reqUrl == "/trace/start")
+            TickTrace::setEnabled(true);
+        else if (reqUrl == "/trace/stop")
+            TickTrace::setEnabled(false);
+        trace = TickTrace::toJSON();
+
+        resp->setHeader("Content-Type", "application/json");
+        resp->setHeader("Content-Length", QString::number(trace.size()));
+        resp->writeHead(200);
+        resp->end(trace);
+        return;
+    }
   #if defined(Q_WS_X11) || defined(Q_OS_LINUX)
     else if (reqUrl == "/system")
     {
@@ -246,27 +341,27 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
   #endif
     else if (reqUrl.endsWith(".png"))
     {
-        if (sendFile(resp, QString(":%1").arg(reqUrl), "image/png") == true)
+        if (sendFile(req, resp, QString(":%1").arg(reqUrl), "image/png") == true)
             return;
     }
     else if (reqUrl.endsWith(".css"))
     {
         QString clUri = reqUrl.mid(1);
-        if (sendFile(resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
+        if (sendFile(req, resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
                      .arg(QDir::separator()).arg(clUri), "text/css") == true)
             return;
     }
     else if (reqUrl.endsWith(".js"))
     {
         QString clUri = reqUrl.mid(1);
-        if (sendFile(resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
+        if (sendFile(req, resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
                      .arg(QDir::separator()).arg(clUri), "text/javascript") == true)
             return;
     }
     else if (reqUrl.endsWith(".html"))
     {
         QString clUri = reqUrl.mid(1);
-        if (sendFile(resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
+        if (sendFile(req, resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
                      .arg(QDir::separator()).arg(clUri), "text/html") == true)
             return;
     }
@@ -279,7 +374,10 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
         return;
     }
     else
-        content = getVCHTML();
+    {
+        sendCachedContent(req, resp, cachedVCPage(), "text/html");
+        return;
+    }
 
     // Prepare the message we're going to send
     QByteArray contentArray = content.toUtf8();
@@ -652,6 +750,55 @@ void WebAccess::slotHandleWebSocketRequest(QHttpConnection *conn, QString data)
 
             wsAPIMessage.append(WebAccessSimpleDesk::getChannelsMessage(m_doc, m_sd, universe, startAddr, count));
         }
+        else if (apiCmd == "getUniversesStats")
+        {
+            InputOutputMap *ioMap = m_doc->inputOutputMap();
+            for (quint32 i = 0; i < ioMap->universesCount(); i++)
+            {
+                QVariantMap stats = ioMap->universeStatistics(i);
+                wsAPIMessage.append(QString("%1|%2|%3|%4|%5|%6|").arg(i + 1)
+                                    .arg(stats.value("writes").toUInt())
+                                    .arg(stats.value("htpRejects").toUInt())
+                                    .arg(stats.value("faders").toInt())
+                                    .arg(stats.value("fadeChannels").toInt())
+                                    .arg(stats.value("processTime").toInt()));
+            }
+            // remove trailing separator
+            wsAPIMessage.truncate(wsAPIMessage.length() - 1);
+        }
+        else if (apiCmd == "getLatencyStats")
+        {
+            foreach (QVariant var, m_doc->inputOutputMap()->latencyStatistics())
+            {
+                QVariantMap stats = var.toMap();
+                wsAPIMessage.append(QString("%1|%2|%3|%4|%5|%6|%7|")
+                                    .arg(stats.value("input").toUInt() + 1)
+                                    .arg(stats.value("output").toUInt() + 1)
+                                    .arg(stats.value("samples").toUInt())
+                                    .arg(stats.value("p50").toInt())
+                                    .arg(stats.value("p90").toInt())
+                                    .arg(stats.value("p99").toInt())
+                                    .arg(stats.value("max").toInt()));
+            }
+            // remove trailing separator
+            wsAPIMessage.truncate(wsAPIMessage.length() - 1);
+        }
+        else if (apiCmd == "subscribeUniverse" || apiCmd == "unsubscribeUniverse")
+        {
+            if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
+                return;
+
+            if (cmdList.count() < 3)
+                return;
+
+            // the universe frames are sent as binary messages
+            quint32 universe = cmdList[2].toUInt() - 1;
+            if (apiCmd == "subscribeUniverse")
+                m_universeMonitor->subscribe(conn, universe);
+            else
+                m_universeMonitor->unsubscribe(conn, universe);
+            return;
+        }
         else if (apiCmd == "sdResetChannel")
         {
             if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
@@ -794,22 +941,58 @@ void WebAccess::slotHandleWebSocketClose(QHttpConnection *conn)
         conn->userData = 0;
     }
 
+    m_universeMonitor->removeConnection(conn);
     m_webSocketsList.removeOne(conn);
+
+    // the connection is ours since it is closed
+    conn->deleteLater();
 }
 
-bool WebAccess::sendFile(QHttpResponse *response, QString filename, QString contentType)
+void WebAccess::slotHandleWebSocketBinaryRequest(QHttpConnection *conn, QByteArray data)
 {
+    if (conn == NULL || data.isEmpty())
+        return;
+
+    WebAccessUser* user = static_cast<WebAccessUser*>(conn->userData);
+
+    if (uchar(data.at(0)) == WS_BINARY_SET)
+    {
+        if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
+            return;
+
+        if (WebAccessUniverseMonitor::handleSetMessage(m_sd, data) == false)
+            qDebug() << "[webaccess] Malformed binary Set message";
+    }
+    else
+        qDebug() << "[webaccess] Binary message" << uchar(data.at(0)) << "not supported!";
+}
+
+bool WebAccess::sendFile(QHttpRequest *request, QHttpResponse *response,
+                         QString filename, QString contentType)
+{
+    QHash<QString, WebAccessCachedContent>::const_iterator it = m_filesCache.constFind(filename);
+    if (it != m_filesCache.constEnd())
+    {
+        sendCachedContent(request, response, it.value(), contentType);
+        return true;
+    }
+
     QFile resFile(filename);
     if (resFile.open(QIODevice::ReadOnly))
     {
-        QByteArray resContent = resFile.readAll();
-        qDebug() << "Resource file length:" << resContent.length();
+        WebAccessCachedContent file;
+        file.m_data = resFile.readAll();
+        qDebug() << "Resource file length:" << file.m_data.length();
         resFile.close();
 
-        response->setHeader("Content-Type", contentType);
-        response->setHeader("Content-Length", QString::number(resContent.size()));
-        response->writeHead(200);
-        response->end(resContent);
+        // images are compressed already
+        if (contentType.startsWith("text/"))
+            file.m_gzipData = gzipCompress(file.m_data);
+        file.m_etag = QString("\"%1\"").arg(QString(
+                        QCryptographicHash::hash(file.m_data, QCryptographicHash::Md5).toHex()));
+
+        m_filesCache.insert(filename, file);
+        sendCachedContent(request, response, file, contentType);
 
         return true;
     }
@@ -819,12 +1002,175 @@ bool WebAccess::sendFile(QHttpResponse *response, QString filename, QString cont
     return false;
 }
 
+void WebAccess::sendCachedContent(QHttpRequest *request, QHttpResponse *response,
+                                  const WebAccessCachedContent &content, QString contentType)
+{
+    response->setHeader("ETag", content.m_etag);
+    response->setHeader("Cache-Control", "no-cache");
+
+    if (request->header("if-none-match") == content.m_etag)
+    {
+        response->setHeader("Content-Length", "0");
+        response->writeHead(304);
+        response->end(QByteArray());
+        return;
+    }
+
+    response->setHeader("Content-Type", contentType);
+
+    if (content.m_gzipData.isEmpty() == false)
+    {
+        response->setHeader("Vary", "Accept-Encoding");
+        if (request->header("accept-encoding").contains("gzip"))
+        {
+            response->setHeader("Content-Encoding", "gzip");
+            response->setHeader("Content-Length", QString::number(content.m_gzipData.size()));
+            response->writeHead(200);
+            response->end(content.m_gzipData);
+            return;
+        }
+    }
+
+    response->setHeader("Content-Length", QString::number(content.m_data.size()));
+    response->writeHead(200);
+    response->end(content.m_data);
+}
+
+QByteArray WebAccess::gzipCompress(const QByteArray &data)
+{
+    /* qCompress returns the zlib format, preceded by the 4 bytes of
+     * the uncompressed length. The raw deflate stream comes after the
+     * 2 bytes zlib header and before the 4 bytes of the Adler-32 checksum */
+    QByteArray zlibData = qCompress(data, 9);
+    if (zlibData.size() < 10)
+        return QByteArray();
+
+    quint32 crc = 0xFFFFFFFF;
+    for (int i = 0; i < data.size(); i++)
+    {
+        crc ^= uchar(data.at(i));
+        for (int b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    crc = ~crc;
+    quint32 size = data.size();
+
+    QByteArray gzipData;
+    gzipData.reserve(zlibData.size() + 12);
+    // magic, deflate method, no flags, no time, no extra flags, unknown OS
+    gzipData.append("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+    gzipData.append(zlibData.constData() + 6, zlibData.size() - 10);
+    for (int i = 0; i < 4; i++)
+        gzipData.append(char((crc >> (i * 8)) & 0xFF));
+    for (int i = 0; i < 4; i++)
+        gzipData.append(char((size >> (i * 8)) & 0xFF));
+
+    return gzipData;
+}
+
+QString WebAccess::storeUploadedProject(QHttpRequest *req)
+{
+    // large uploads have been spooled to a file by the HTTP server
+    QFile spooled(req->bodyFileName());
+    QBuffer buffer;
+    QIODevice *body = &buffer;
+
+    if (spooled.fileName().isEmpty())
+        buffer.setData(req->body());
+    else
+        body = &spooled;
+
+    if (body->open(QIODevice::ReadOnly) == false)
+    {
+        qWarning() << "Unable to read the uploaded workspace";
+        return QString();
+    }
+
+    qint64 size = body->size();
+
+    // the workspace is the only part of the form: skip the part headers
+    // at the beginning and the closing boundary at the end
+    QByteArray head = body->read(qMin(size, qint64(65536)));
+    qint64 start = head.indexOf("\n\r\n");
+    start = start < 0 ? 0 : start + 3;
+
+    qint64 tailOffset = qMax(start, size - 65536);
+    body->seek(tailOffset);
+    QByteArray tail = body->readAll();
+    qint64 end = tail.lastIndexOf("\n\r\n");
+    end = end < 0 ? size : tailOffset + end;
+
+    QTemporaryFile project(QDir::temp().filePath("webaccess_XXXXXX.qxw"));
+    project.setAutoRemove(false);
+    if (project.open() == false)
+    {
+        qWarning() << "Unable to create a file for the uploaded workspace";
+        return QString();
+    }
+
+    body->seek(start);
+    for (qint64 left = end - start; left > 0; )
+    {
+        QByteArray chunk = body->read(qMin(left, qint64(QHTTPREQUEST_SPOOL_SIZE)));
+        if (chunk.isEmpty() || project.write(chunk) != chunk.size())
+        {
+            qWarning() << "Unable to store the uploaded workspace";
+            project.remove();
+            return QString();
+        }
+        left -= chunk.size();
+    }
+
+    body->close();
+    req->releaseBody();
+
+    qDebug() << "Workspace XML received. Content-Length:" << req->headers().value("content-length") << end - start;
+
+    return project.fileName();
+}
+
 void WebAccess::sendWebSocketMessage(QByteArray message)
 {
     foreach(QHttpConnection *conn, m_webSocketsList)
         conn->webSocketWrite(QHttpConnection::TextFrame, message);
 }
 
+void WebAccess::queueWidgetUpdate(quint32 widgetID, const QString &type, const QString &value)
+{
+    QString key = QString("%1|%2").arg(widgetID).arg(type);
+
+    if (m_pendingUpdates.contains(key) == false)
+        m_pendingUpdateKeys.append(key);
+    m_pendingUpdates[key] = QString("%1|%2").arg(key).arg(value);
+
+    if (m_widgetStates.contains(key) == false)
+        m_widgetStateKeys.append(key);
+    m_widgetStates[key] = m_pendingUpdates[key];
+
+    if (m_updatesTimer->isActive() == false)
+    {
+        // the web clients give way to the engine when it's overloaded
+        m_updatesTimer->setInterval(m_doc->loadGovernor()->scaledInterval(MasterTimer::tick()));
+        m_updatesTimer->start();
+    }
+}
+
+void WebAccess::slotFlushWidgetUpdates()
+{
+    if (m_pendingUpdateKeys.isEmpty())
+        return;
+
+    QStringList updates;
+    foreach (QString key, m_pendingUpdateKeys)
+        updates.append(m_pendingUpdates.value(key));
+
+    m_pendingUpdateKeys.clear();
+    m_pendingUpdates.clear();
+
+    if (m_webSocketsList.isEmpty() == false)
+        sendWebSocketMessage(updates.join("\n").toUtf8());
+}
+
 QString WebAccess::getWidgetHTML(VCWidget *widget)
 {
     QString str = "<div class=\"vcwidget\" style=\""
@@ -845,10 +1191,7 @@ void WebAccess::slotFramePageChanged(int pageNum)
     if (frame == NULL)
         return;
 
-    QString wsMessage = QString("%1|FRAME|%2").arg(frame->id()).arg(pageNum);
-    QByteArray ba = wsMessage.toUtf8();
-
-    sendWebSocketMessage(ba);
+    queueWidgetUpdate(frame->id(), "FRAME", QString::number(pageNum));
 }
 
 QString WebAccess::getFrameHTML(VCFrame *frame)
@@ -894,7 +1237,7 @@ QString WebAccess::getFrameHTML(VCFrame *frame)
             m_JScode += "framesCurrentPage[" + QString::number(frame->id()) + "] = " + QString::number(frame->currentPage()) + ";\n";
             m_JScode += "framesTotalPages[" + QString::number(frame->id()) + "] = " + QString::number(frame->totalPagesNumber()) + ";\n\n";
             connect(frame, SIGNAL(pageChanged(int)),
-                    this, SLOT(slotFramePageChanged(int)));
+                    this, SLOT(slotFramePageChanged(int)), Qt::UniqueConnection);
         }
     }
 
@@ -946,7 +1289,7 @@ QString WebAccess::getSoloFrameHTML(VCSoloFrame *frame)
             m_JScode += "framesCurrentPage[" + QString::number(frame->id()) + "] = " + QString::number(frame->currentPage()) + ";\n";
             m_JScode += "framesTotalPages[" + QString::number(frame->id()) + "] = " + QString::number(frame->totalPagesNumber()) + ";\n\n";
             connect(frame, SIGNAL(pageChanged(int)),
-                    this, SLOT(slotFramePageChanged(int)));
+                    this, SLOT(slotFramePageChanged(int)), Qt::UniqueConnection);
         }
     }
 
@@ -963,15 +1306,12 @@ void WebAccess::slotButtonStateChanged(int state)
 
     qDebug() << "Button state changed" << state;
 
-    QString wsMessage = QString::number(btn->id());
     if (state == VCButton::Active)
-        wsMessage.append("|BUTTON|255");
+        queueWidgetUpdate(btn->id(), "BUTTON", "255");
     else if (state == VCButton::Monitoring)
-        wsMessage.append("|BUTTON|127");
+        queueWidgetUpdate(btn->id(), "BUTTON", "127");
     else
-        wsMessage.append("|BUTTON|0");
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+        queueWidgetUpdate(btn->id(), "BUTTON", "0");
 }
 
 QString WebAccess::getButtonHTML(VCButton *btn)
@@ -997,7 +1337,7 @@ QString WebAccess::getButtonHTML(VCButton *btn)
             btn->caption() + "</a>\n</div>\n";
 
     connect(btn, SIGNAL(stateChanged(int)),
-            this, SLOT(slotButtonStateChanged(int)));
+            this, SLOT(slotButtonStateChanged(int)), Qt::UniqueConnection);
 
     return str;
 }
@@ -1009,9 +1349,7 @@ void WebAccess::slotSliderValueChanged(QString val)
         return;
 
     // <ID>|SLIDER|<SLIDER VALUE>|<DISPLAY VALUE>
-    QString wsMessage = QString("%1|SLIDER|%2|%3").arg(slider->id()).arg(slider->sliderValue()).arg(val);
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWidgetUpdate(slider->id(), "SLIDER", QString("%1|%2").arg(slider->sliderValue()).arg(val));
 }
 
 QString WebAccess::getSliderHTML(VCSlider *slider)
@@ -1051,7 +1389,7 @@ QString WebAccess::getSliderHTML(VCSlider *slider)
             "</div>\n";
 
     connect(slider, SIGNAL(valueChanged(QString)),
-            this, SLOT(slotSliderValueChanged(QString)));
+            this, SLOT(slotSliderValueChanged(QString)), Qt::UniqueConnection);
     return str;
 }
 
@@ -1078,9 +1416,7 @@ void WebAccess::slotAudioTriggersToggled(bool toggle)
 
     qDebug() << "AudioTriggers state changed " << toggle;
 
-    QString wsMessage = QString("%1|AUDIOTRIGGERS|%2").arg(triggers->id()).arg(toggle ? 255 : 0);
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWidgetUpdate(triggers->id(), "AUDIOTRIGGERS", toggle ? "255" : "0");
 }
 
 QString WebAccess::getAudioTriggersHTML(VCAudioTriggers *triggers)
@@ -1105,7 +1441,7 @@ QString WebAccess::getAudioTriggersHTML(VCAudioTriggers *triggers)
     str += "</div></div>\n";
 
     connect(triggers, SIGNAL(captureEnabled(bool)),
-            this, SLOT(slotAudioTriggersToggled(bool)));
+            this, SLOT(slotAudioTriggersToggled(bool)), Qt::UniqueConnection);
 
     return str;
 }
@@ -1116,9 +1452,7 @@ void WebAccess::slotCueIndexChanged(int idx)
     if (cue == NULL)
         return;
 
-    QString wsMessage = QString("%1|CUE|%2").arg(cue->id()).arg(idx);
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWidgetUpdate(cue->id(), "CUE", QString::number(idx));
 }
 
 QString WebAccess::getCueListHTML(VCCueList *cue)
@@ -1255,7 +1589,7 @@ QString WebAccess::getCueListHTML(VCCueList *cue)
     str += "</div>\n";
 
     connect(cue, SIGNAL(stepChanged(int)),
-            this, SLOT(slotCueIndexChanged(int)));
+            this, SLOT(slotCueIndexChanged(int)), Qt::UniqueConnection);
 
     return str;
 }
@@ -1266,8 +1600,7 @@ void WebAccess::slotClockTimeChanged(quint32 time)
     if (clock == NULL)
         return;
 
-    QString wsMessage = QString("%1|CLOCK|%2").arg(clock->id()).arg(time);
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWidgetUpdate(clock->id(), "CLOCK", QString::number(time));
 }
 
 QString WebAccess::getClockHTML(VCClock *clock)
@@ -1285,7 +1618,7 @@ QString WebAccess::getClockHTML(VCClock *clock)
         str += "oncontextmenu=\"javascript:controlWatch(";
         str += QString::number(clock->id()) + ", 'R'); return false;\"";
         connect(clock, SIGNAL(timeChanged(quint32)),
-                this, SLOT(slotClockTimeChanged(quint32)));
+                this, SLOT(slotClockTimeChanged(quint32)), Qt::UniqueConnection);
     }
     else
     {
@@ -1458,7 +1791,37 @@ QString WebAccess::getSimpleDeskHTML()
     return str;
 }
 
+const WebAccessCachedContent &WebAccess::cachedVCPage()
+{
+    QString etag = QString("\"vc-%1-%2\"").arg(m_sessionID).arg(m_vcRevision);
+    if (m_vcPage.m_etag == etag)
+        return m_vcPage;
+
+    qDebug() << "[webaccess] Generating VC page, revision" << m_vcRevision;
+
+    // the new page holds the current state of every widget
+    m_widgetStateKeys.clear();
+    m_widgetStates.clear();
+
+    m_vcPage.m_data = getVCHTML().toUtf8();
+    m_vcPage.m_gzipData = gzipCompress(m_vcPage.m_data);
+    m_vcPage.m_etag = etag;
+
+    return m_vcPage;
+}
+
 void WebAccess::slotVCLoaded()
 {
     m_pendingProjectLoaded = true;
+    slotInvalidateVCPage();
+}
+
+void WebAccess::slotProjectLoadProgress(int percent)
+{
+    sendWebSocketMessage(QString("QLC+API|loadProgress|%1").arg(percent).toUtf8());
+}
+
+void WebAccess::slotInvalidateVCPage()
+{
+    m_vcRevision++;
 }
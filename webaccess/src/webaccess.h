@@ -20,12 +20,16 @@
 #ifndef WEBACCESS_H
 #define WEBACCESS_H
 
+#include <QStringList>
 #include <QObject>
+#include <QHash>
 
 #if defined(Q_WS_X11) || defined(Q_OS_LINUX)
 class WebAccessNetwork;
 #endif
 
+class WebAccessUniverseMonitor;
+class WebAccessMetrics;
 class WebAccessAuth;
 
 class VCAudioTriggers;
@@ -41,11 +45,22 @@ class VCFrame;
 class VCClock;
 class Doc;
 
+class QTimer;
+class QThread;
 class QHttpServer;
 class QHttpRequest;
 class QHttpResponse;
 class QHttpConnection;
 
+/** A HTTP reply content kept in memory, with its gzip compressed version
+ *  and the ETag that identifies it */
+typedef struct
+{
+    QByteArray m_data;
+    QByteArray m_gzipData;
+    QString m_etag;
+} WebAccessCachedContent;
+
 class WebAccess : public QObject
 {
     Q_OBJECT
@@ -57,9 +72,23 @@ public:
     ~WebAccess();
 
 private:
-    bool sendFile(QHttpResponse *response, QString filename, QString contentType);
+    bool sendFile(QHttpRequest *request, QHttpResponse *response,
+                  QString filename, QString contentType);
+
+    /** Send $content to $response, replying 304 when the client already
+     *  has it and sending the compressed data when the client accepts it */
+    void sendCachedContent(QHttpRequest *request, QHttpResponse *response,
+                           const WebAccessCachedContent& content, QString contentType);
+
+    /** Return $data compressed in the gzip format */
+    static QByteArray gzipCompress(const QByteArray& data);
     void sendWebSocketMessage(QByteArray message);
 
+    /** Queue the update of a widget to be sent to every client with the
+     *  next batch. A pending update of the same $widgetID and $type is
+     *  replaced, so that only the latest one is sent */
+    void queueWidgetUpdate(quint32 widgetID, const QString& type, const QString& value);
+
     QString getWidgetHTML(VCWidget *widget);
     QString getFrameHTML(VCFrame *frame);
     QString getSoloFrameHTML(VCSoloFrame *frame);
@@ -73,14 +102,30 @@ private:
     QString getChildrenHTML(VCWidget *frame, int pagesNum, int currentPageIdx);
     QString getVCHTML();
 
+    /** Return the Virtual Console page, generating it only when
+     *  the VC has changed since the last request */
+    const WebAccessCachedContent& cachedVCPage();
+
     QString getSimpleDeskHTML();
 
+    /** Copy the workspace uploaded with $req into a temporary file,
+     *  stripping the multipart headers. Return the file name, or an
+     *  empty string on failure */
+    QString storeUploadedProject(QHttpRequest *req);
+
 protected slots:
     void slotHandleRequest(QHttpRequest *req, QHttpResponse *resp);
     void slotHandleWebSocketRequest(QHttpConnection *conn, QString data);
+    void slotHandleWebSocketBinaryRequest(QHttpConnection *conn, QByteArray data);
     void slotHandleWebSocketClose(QHttpConnection *conn);
 
     void slotVCLoaded();
+
+    /** Report the progress of a project load to the WebSocket clients */
+    void slotProjectLoadProgress(int percent);
+
+    /** Mark the cached Virtual Console page as outdated */
+    void slotInvalidateVCPage();
     void slotButtonStateChanged(int state);
     void slotSliderValueChanged(QString val);
     void slotAudioTriggersToggled(bool toggle);
@@ -88,6 +133,10 @@ protected slots:
     void slotClockTimeChanged(quint32 time);
     void slotFramePageChanged(int pageNum);
 
+    /** Send the queued widget updates to every client, in one message
+     *  holding one update per line */
+    void slotFlushWidgetUpdates();
+
 protected:
     QString m_JScode;
     QString m_CSScode;
@@ -101,14 +150,44 @@ protected:
     WebAccessNetwork *m_netConfig;
 #endif
 
+    /** The HTTP server and its connections live in their own thread, so that
+     *  parsing requests and WebSocket frames doesn't wait for the UI, and
+     *  the UI doesn't wait for the clients. The requests and the messages
+     *  are queued to the WebAccess handlers, that run on the main thread
+     *  along with the VC and the Doc */
+    QThread *m_networkThread;
     QHttpServer *m_httpServer;
     QList<QHttpConnection *> m_webSocketsList;
+    WebAccessUniverseMonitor *m_universeMonitor;
+    WebAccessMetrics *m_metrics;
+
+    /** The widget updates waiting for the next batch, in arrival order */
+    QStringList m_pendingUpdateKeys;
+    QHash<QString, QString> m_pendingUpdates;
+    QTimer *m_updatesTimer;
+
+    /** The static files served so far, by file name. They don't
+     *  change while QLC+ is running */
+    QHash<QString, WebAccessCachedContent> m_filesCache;
+
+    /** The Virtual Console page and the VC revision it was generated for.
+     *  The revision changes every time the VC is loaded or edited */
+    WebAccessCachedContent m_vcPage;
+    quint32 m_vcRevision;
+    QString m_sessionID;
+
+    /** The latest state of the widgets that changed since the cached VC
+     *  page was generated, sent to every new WebSocket connection */
+    QStringList m_widgetStateKeys;
+    QHash<QString, QString> m_widgetStates;
 
     bool m_pendingProjectLoaded;
 
 signals:
     void toggleDocMode();
-    void loadProject(QString xmlData);
+    /** Emitted when a workspace has been uploaded into $fileName.
+     *  The receiver loads it and removes the file */
+    void loadProjectFile(QString fileName);
     void storeAutostartProject(QString filename);
 
 public slots:
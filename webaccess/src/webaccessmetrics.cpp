@@ -0,0 +1,248 @@
+/*
+  Q Light Controller Plus
+  webaccessmetrics.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QStringList>
+
+#include "webaccessmetrics.h"
+#include "inputoutputmap.h"
+#include "mastertimer.h"
+#include "outputpatch.h"
+#include "universe.h"
+#include "doc.h"
+
+WebAccessMetrics::WebAccessMetrics(Doc *doc)
+    : m_doc(doc)
+{
+    Q_ASSERT(m_doc != NULL);
+}
+
+void WebAccessMetrics::updateFrameRates()
+{
+    if (m_ratesTimer.isValid() && m_ratesTimer.elapsed() < 1000)
+        return;
+
+    qint64 elapsed = m_ratesTimer.isValid() ? m_ratesTimer.restart() : 0;
+    if (elapsed == 0)
+        m_ratesTimer.start();
+
+    QHash<quint32, quint32> frames;
+    foreach (Universe *uni, m_doc->inputOutputMap()->universes())
+    {
+        quint32 count = uni->frameGeneration();
+        frames[uni->id()] = count;
+
+        if (elapsed > 0 && m_lastFrames.contains(uni->id()))
+            m_frameRates[uni->id()] = double(count - m_lastFrames[uni->id()]) * 1000.0 / elapsed;
+        else
+            m_frameRates[uni->id()] = 0;
+    }
+    m_lastFrames = frames;
+}
+
+QString WebAccessMetrics::escapeLabel(QString value)
+{
+    return value.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+}
+
+QString WebAccessMetrics::sample(const QString &name, const QString &labels, const QString &value)
+{
+    return name + "{" + labels + "} " + value + "\n";
+}
+
+QString WebAccessMetrics::escapeJSON(QString value)
+{
+    value.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+    value.replace("\r", "\\r").replace("\t", "\\t");
+    return value;
+}
+
+QString WebAccessMetrics::getPrometheusText()
+{
+    QString str;
+    MasterTimer *timer = m_doc->masterTimer();
+    MasterTimer::TimingStatistics timing = timer->timingStatistics();
+
+    str += "# HELP qlcplus_mastertimer_ticks_total Engine ticks processed\n"
+           "# TYPE qlcplus_mastertimer_ticks_total counter\n";
+    str += QString("qlcplus_mastertimer_ticks_total %1\n").arg(timing.ticks);
+    str += "# HELP qlcplus_mastertimer_late_ticks_total Ticks started more than half a tick late\n"
+           "# TYPE qlcplus_mastertimer_late_ticks_total counter\n";
+    str += QString("qlcplus_mastertimer_late_ticks_total %1\n").arg(timing.lateTicks);
+    str += "# HELP qlcplus_mastertimer_missed_ticks_total Whole ticks skipped because of lateness\n"
+           "# TYPE qlcplus_mastertimer_missed_ticks_total counter\n";
+    str += QString("qlcplus_mastertimer_missed_ticks_total %1\n").arg(timing.missedTicks);
+
+    QStringList names, helps;
+    names << "qlcplus_mastertimer_tick_interval_seconds" << "qlcplus_mastertimer_tick_duration_seconds";
+    helps << "Time between the start of two consecutive ticks" << "Time spent processing a tick";
+    for (int h = 0; h < 2; h++)
+    {
+        const QVector<quint32> &histogram = h == 0 ? timing.intervalHistogram : timing.durationHistogram;
+        int binSize = h == 0 ? timing.intervalBinSize : timing.durationBinSize;
+        quint64 count = 0;
+
+        str += QString("# HELP %1 %2\n# TYPE %1 histogram\n").arg(names.at(h)).arg(helps.at(h));
+        for (int i = 0; i < histogram.count(); i++)
+        {
+            count += histogram.at(i);
+            // the last bin collects everything exceeding the histogram range
+            QString le = i == histogram.count() - 1 ? QString("+Inf")
+                                                    : QString::number(double((i + 1) * binSize) / 1000000.0);
+            str += QString("%1_bucket{le=\"%2\"} %3\n").arg(names.at(h)).arg(le).arg(count);
+        }
+        str += QString("%1_count %2\n").arg(names.at(h)).arg(count);
+    }
+
+    str += "# HELP qlcplus_mastertimer_worst_tick_interval_seconds Longest tick interval of the current minute\n"
+           "# TYPE qlcplus_mastertimer_worst_tick_interval_seconds gauge\n";
+    str += QString("qlcplus_mastertimer_worst_tick_interval_seconds %1\n")
+            .arg(timing.worstIntervalPerMinute.isEmpty() ? 0 : double(timing.worstIntervalPerMinute.last()) / 1000000.0);
+    str += "# HELP qlcplus_mastertimer_worst_tick_duration_seconds Longest tick duration of the current minute\n"
+           "# TYPE qlcplus_mastertimer_worst_tick_duration_seconds gauge\n";
+    str += QString("qlcplus_mastertimer_worst_tick_duration_seconds %1\n")
+            .arg(timing.worstDurationPerMinute.isEmpty() ? 0 : double(timing.worstDurationPerMinute.last()) / 1000000.0);
+
+    str += "# HELP qlcplus_running_functions Functions currently running\n"
+           "# TYPE qlcplus_running_functions gauge\n";
+    str += QString("qlcplus_running_functions %1\n").arg(timer->runningFunctions());
+
+    updateFrameRates();
+
+    QList<Universe *> universes = m_doc->inputOutputMap()->universes();
+    QString uniFrames, uniFps, uniTime, uniWrites, uniRejects, uniFaders, uniChannels;
+    QString outSent, outDropped, outSkipped, outErrors;
+
+    foreach (Universe *uni, universes)
+    {
+        // labels are concatenated, since names could contain arg() markers
+        QString label = "universe=\"" + QString::number(uni->id() + 1) +
+                        "\",name=\"" + escapeLabel(uni->name()) + "\"";
+        Universe::Statistics stats = uni->statistics();
+
+        uniFrames += sample("qlcplus_universe_frames_total", label, QString::number(uni->frameGeneration()));
+        uniFps += sample("qlcplus_universe_fps", label, QString::number(m_frameRates.value(uni->id())));
+        uniTime += sample("qlcplus_universe_process_seconds", label, QString::number(double(stats.processTime) / 1000000.0));
+        uniWrites += sample("qlcplus_universe_writes", label, QString::number(stats.writes));
+        uniRejects += sample("qlcplus_universe_htp_rejects", label, QString::number(stats.htpRejects));
+        uniFaders += sample("qlcplus_universe_faders", label, QString::number(stats.faders));
+        uniChannels += sample("qlcplus_universe_fade_channels", label, QString::number(stats.fadeChannels));
+
+        for (int i = 0; i < uni->outputPatchesCount(); i++)
+        {
+            OutputPatch *op = uni->outputPatch(i);
+            if (op == NULL || op->isPatched() == false)
+                continue;
+
+            QString opLabel = "universe=\"" + QString::number(uni->id() + 1) +
+                              "\",patch=\"" + QString::number(i) +
+                              "\",plugin=\"" + escapeLabel(op->pluginName()) +
+                              "\",output=\"" + escapeLabel(op->outputName()) + "\"";
+            outSent += sample("qlcplus_output_frames_sent_total", opLabel, QString::number(op->sentFrames()));
+            outDropped += sample("qlcplus_output_frames_dropped_total", opLabel, QString::number(op->droppedFrames()));
+            outSkipped += sample("qlcplus_output_frames_skipped_total", opLabel, QString::number(op->skippedFrames()));
+            outErrors += sample("qlcplus_output_errors_total", opLabel, QString::number(op->outputErrors()));
+        }
+    }
+
+    str += "# HELP qlcplus_universe_frames_total Frames published by the universe\n"
+           "# TYPE qlcplus_universe_frames_total counter\n" + uniFrames;
+    str += "# HELP qlcplus_universe_fps Frames published per second, since the previous scrape\n"
+           "# TYPE qlcplus_universe_fps gauge\n" + uniFps;
+    str += "# HELP qlcplus_universe_process_seconds Time spent composing the last frame\n"
+           "# TYPE qlcplus_universe_process_seconds gauge\n" + uniTime;
+    str += "# HELP qlcplus_universe_writes Channel writes of the last frame\n"
+           "# TYPE qlcplus_universe_writes gauge\n" + uniWrites;
+    str += "# HELP qlcplus_universe_htp_rejects Writes rejected by the HTP check in the last frame\n"
+           "# TYPE qlcplus_universe_htp_rejects gauge\n" + uniRejects;
+    str += "# HELP qlcplus_universe_faders Active faders\n"
+           "# TYPE qlcplus_universe_faders gauge\n" + uniFaders;
+    str += "# HELP qlcplus_universe_fade_channels Active fading channels\n"
+           "# TYPE qlcplus_universe_fade_channels gauge\n" + uniChannels;
+
+    str += "# HELP qlcplus_output_frames_sent_total Frames handed to the output plugin\n"
+           "# TYPE qlcplus_output_frames_sent_total counter\n" + outSent;
+    str += "# HELP qlcplus_output_frames_dropped_total Frames replaced before being sent in async mode\n"
+           "# TYPE qlcplus_output_frames_dropped_total counter\n" + outDropped;
+    str += "# HELP qlcplus_output_frames_skipped_total Frames not sent because of the refresh rate or duplicates\n"
+           "# TYPE qlcplus_output_frames_skipped_total counter\n" + outSkipped;
+    str += "# HELP qlcplus_output_errors_total Frames the plugin failed to transmit\n"
+           "# TYPE qlcplus_output_errors_total counter\n" + outErrors;
+
+    return str;
+}
+
+QString WebAccessMetrics::getJSON()
+{
+    MasterTimer *timer = m_doc->masterTimer();
+    MasterTimer::TimingStatistics timing = timer->timingStatistics();
+
+    QString str = "{\"masterTimer\":{";
+    str += QString("\"ticks\":%1,\"lateTicks\":%2,\"missedTicks\":%3,")
+            .arg(timing.ticks).arg(timing.lateTicks).arg(timing.missedTicks);
+    str += QString("\"worstIntervalUs\":%1,\"worstDurationUs\":%2")
+            .arg(timing.worstIntervalPerMinute.isEmpty() ? 0 : timing.worstIntervalPerMinute.last())
+            .arg(timing.worstDurationPerMinute.isEmpty() ? 0 : timing.worstDurationPerMinute.last());
+
+    QStringList bins;
+    foreach (quint32 bin, timing.intervalHistogram)
+        bins << QString::number(bin);
+    str += QString(",\"intervalBinUs\":%1,\"intervalHistogram\":[%2]")
+            .arg(timing.intervalBinSize).arg(bins.join(","));
+    bins.clear();
+    foreach (quint32 bin, timing.durationHistogram)
+        bins << QString::number(bin);
+    str += QString(",\"durationBinUs\":%1,\"durationHistogram\":[%2]")
+            .arg(timing.durationBinSize).arg(bins.join(","));
+
+    str += QString("},\"runningFunctions\":%1,\"universes\":[").arg(timer->runningFunctions());
+
+    updateFrameRates();
+
+    QStringList universes;
+    foreach (Universe *uni, m_doc->inputOutputMap()->universes())
+    {
+        Universe::Statistics stats = uni->statistics();
+        QString uniStr = "{\"universe\":" + QString::number(uni->id() + 1) +
+                         ",\"name\":\"" + escapeJSON(uni->name()) + "\",";
+        uniStr += QString("\"frames\":%1,\"fps\":%2,\"processTimeUs\":%3,")
+                .arg(uni->frameGeneration()).arg(m_frameRates.value(uni->id())).arg(stats.processTime);
+        uniStr += QString("\"writes\":%1,\"htpRejects\":%2,\"faders\":%3,\"fadeChannels\":%4,\"outputs\":[")
+                .arg(stats.writes).arg(stats.htpRejects).arg(stats.faders).arg(stats.fadeChannels);
+
+        QStringList outputs;
+        for (int i = 0; i < uni->outputPatchesCount(); i++)
+        {
+            OutputPatch *op = uni->outputPatch(i);
+            if (op == NULL || op->isPatched() == false)
+                continue;
+
+            outputs << "{\"patch\":" + QString::number(i) +
+                       ",\"plugin\":\"" + escapeJSON(op->pluginName()) +
+                       "\",\"output\":\"" + escapeJSON(op->outputName()) + "\"," +
+                       QString("\"sent\":%1,\"dropped\":%2,\"skipped\":%3,\"errors\":%4}")
+                       .arg(op->sentFrames()).arg(op->droppedFrames()).arg(op->skippedFrames())
+                       .arg(op->outputErrors());
+        }
+        uniStr += outputs.join(",") + "]}";
+        universes << uniStr;
+    }
+    str += universes.join(",") + "]}";
+
+    return str;
+}
@@ -0,0 +1,65 @@
+/*
+  Q Light Controller Plus
+  webaccessmetrics.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WEBACCESSMETRICS_H
+#define WEBACCESSMETRICS_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QHash>
+
+class Doc;
+
+/**
+ * Expose the engine statistics counters to monitoring systems, in the
+ * Prometheus text format and as JSON. The counters are only read when
+ * a client asks for them, so nothing is done when nobody is scraping.
+ */
+class WebAccessMetrics
+{
+public:
+    WebAccessMetrics(Doc *doc);
+
+    /** Return the metrics in the Prometheus text exposition format */
+    QString getPrometheusText();
+
+    /** Return the metrics as a JSON object */
+    QString getJSON();
+
+private:
+    /** Update the frame rate of each universe, measured from the frame
+     *  counters between two requests at least a second apart */
+    void updateFrameRates();
+
+    /** Return a line of the Prometheus format */
+    static QString sample(const QString& name, const QString& labels, const QString& value);
+
+    static QString escapeLabel(QString value);
+    static QString escapeJSON(QString value);
+
+private:
+    Doc *m_doc;
+
+    QElapsedTimer m_ratesTimer;
+    /** The frame counters when the rates were last updated, by universe ID */
+    QHash<quint32, quint32> m_lastFrames;
+    QHash<quint32, double> m_frameRates;
+};
+
+#endif // WEBACCESSMETRICS_H
@@ -0,0 +1,218 @@
+/*
+  Q Light Controller Plus
+  webaccessuniversemonitor.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDebug>
+
+#include "webaccessuniversemonitor.h"
+#include "qhttpconnection.h"
+#include "inputoutputmap.h"
+#include "loadgovernor.h"
+#include "simpledesk.h"
+#include "doc.h"
+
+/** Unchanged channels shorter than a range header are sent
+ *  along with the changed ones instead of starting a new range */
+#define DELTA_RANGE_HEADER 4
+
+static void appendShort(QByteArray &message, quint32 value)
+{
+    message.append(char((value >> 8) & 0xFF));
+    message.append(char(value & 0xFF));
+}
+
+static quint32 readShort(const QByteArray &message, int pos)
+{
+    return (quint32(uchar(message.at(pos))) << 8) | quint32(uchar(message.at(pos + 1)));
+}
+
+WebAccessUniverseMonitor::WebAccessUniverseMonitor(Doc *doc, QObject *parent)
+    : QObject(parent)
+    , m_doc(doc)
+    , m_connected(false)
+{
+    Q_ASSERT(m_doc != NULL);
+}
+
+WebAccessUniverseMonitor::~WebAccessUniverseMonitor()
+{
+}
+
+void WebAccessUniverseMonitor::subscribe(QHttpConnection *conn, quint32 universe)
+{
+    if (universe >= m_doc->inputOutputMap()->universesCount())
+        return;
+
+    m_subscribers[universe].insert(conn);
+    m_pendingSnapshots[universe].insert(conn);
+
+    // send the last frame right away, the next ones will be deltas
+    if (m_lastData.contains(universe))
+    {
+        conn->webSocketWrite(QHttpConnection::BinaryFrame, snapshotMessage(universe, m_lastData[universe]));
+        m_pendingSnapshots[universe].remove(conn);
+    }
+
+    updateConnection();
+}
+
+void WebAccessUniverseMonitor::unsubscribe(QHttpConnection *conn, quint32 universe)
+{
+    if (m_subscribers.contains(universe) == false)
+        return;
+
+    m_subscribers[universe].remove(conn);
+    m_pendingSnapshots[universe].remove(conn);
+
+    if (m_subscribers[universe].isEmpty())
+    {
+        m_subscribers.remove(universe);
+        m_pendingSnapshots.remove(universe);
+        m_lastData.remove(universe);
+        m_skippedFrames.remove(universe);
+    }
+
+    updateConnection();
+}
+
+void WebAccessUniverseMonitor::removeConnection(QHttpConnection *conn)
+{
+    foreach (quint32 universe, m_subscribers.keys())
+        unsubscribe(conn, universe);
+}
+
+void WebAccessUniverseMonitor::updateConnection()
+{
+    bool needed = m_subscribers.isEmpty() == false;
+    if (needed == m_connected)
+        return;
+
+    if (needed)
+        connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
+                this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+    else
+        disconnect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
+                   this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+
+    m_connected = needed;
+}
+
+void WebAccessUniverseMonitor::slotUniverseWritten(quint32 universe, const QByteArray &data)
+{
+    if (m_subscribers.contains(universe) == false)
+        return;
+
+    /* When the engine is overloaded only one frame out of 2 (or 4) is sent.
+     * The next delta is computed against the last frame sent, so it still
+     * carries the changes of the skipped ones */
+    int &skipped = m_skippedFrames[universe];
+    if (++skipped < (1 << m_doc->loadGovernor()->level()))
+        return;
+    skipped = 0;
+
+    QSet<QHttpConnection *> pending = m_pendingSnapshots.take(universe);
+    QByteArray delta;
+
+    if (m_lastData.contains(universe))
+        delta = deltaMessage(universe, m_lastData[universe], data);
+
+    // a snapshot is smaller than a large delta
+    bool full = m_lastData.contains(universe) == false || delta.size() > data.size();
+
+    QByteArray snapshot;
+    if (full || pending.isEmpty() == false)
+        snapshot = snapshotMessage(universe, data);
+
+    foreach (QHttpConnection *conn, m_subscribers[universe])
+    {
+        if (full || pending.contains(conn))
+            conn->webSocketWrite(QHttpConnection::BinaryFrame, snapshot);
+        else if (delta.isEmpty() == false)
+            conn->webSocketWrite(QHttpConnection::BinaryFrame, delta);
+    }
+
+    m_lastData[universe] = data;
+}
+
+bool WebAccessUniverseMonitor::handleSetMessage(SimpleDesk *sd, const QByteArray &message)
+{
+    if (message.size() < 6 || uchar(message.at(0)) != WS_BINARY_SET)
+        return false;
+
+    quint32 universe = readShort(message, 1);
+    quint32 address = (universe << 9) + readShort(message, 3);
+
+    for (int i = 5; i < message.size(); i++)
+        sd->setAbsoluteChannelValue(address++, uchar(message.at(i)));
+
+    return true;
+}
+
+QByteArray WebAccessUniverseMonitor::snapshotMessage(quint32 universe, const QByteArray &data)
+{
+    QByteArray message;
+    message.reserve(data.size() + 5);
+    message.append(char(WS_BINARY_SNAPSHOT));
+    appendShort(message, universe);
+    appendShort(message, data.size());
+    message.append(data);
+
+    return message;
+}
+
+QByteArray WebAccessUniverseMonitor::deltaMessage(quint32 universe, const QByteArray &previous,
+                                                  const QByteArray &data)
+{
+    QByteArray message;
+    int size = data.size();
+    int i = 0;
+
+    while (i < size)
+    {
+        if (i < previous.size() && previous.at(i) == data.at(i))
+        {
+            i++;
+            continue;
+        }
+
+        // extend the range until enough unchanged channels are found
+        int start = i;
+        int end = i + 1;
+        for (int j = end; j < size; j++)
+        {
+            if (j >= previous.size() || previous.at(j) != data.at(j))
+                end = j + 1;
+            else if (j - end + 1 >= DELTA_RANGE_HEADER)
+                break;
+        }
+
+        if (message.isEmpty())
+        {
+            message.append(char(WS_BINARY_DELTA));
+            appendShort(message, universe);
+        }
+
+        appendShort(message, start);
+        appendShort(message, end - start);
+        message.append(data.mid(start, end - start));
+
+        i = end;
+    }
+
+    return message;
+}
@@ -0,0 +1,99 @@
+/*
+  Q Light Controller Plus
+  webaccessuniversemonitor.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WEBACCESSUNIVERSEMONITOR_H
+#define WEBACCESSUNIVERSEMONITOR_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QHash>
+#include <QSet>
+
+class QHttpConnection;
+class SimpleDesk;
+class Doc;
+
+/**
+ * Binary WebSocket frames. Every frame starts with the message type (1 byte)
+ * and the universe index (2 bytes), all the numbers are big endian.
+ *
+ * - Snapshot (server to client): the data length (2 bytes) and the values
+ *   of the whole universe
+ * - Delta (server to client): a sequence of changed ranges, each made of the
+ *   start channel (2 bytes), the channels count (2 bytes) and the values
+ * - Set (client to server): the start channel (2 bytes) and the values
+ *   to set through the Simple Desk
+ */
+#define WS_BINARY_SNAPSHOT  0x01
+#define WS_BINARY_DELTA     0x02
+#define WS_BINARY_SET       0x03
+
+/**
+ * WebAccessUniverseMonitor pushes the output of the universes to the
+ * clients that subscribed to them. A client receives a snapshot of the
+ * universe first, then the ranges changed by every frame.
+ */
+class WebAccessUniverseMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WebAccessUniverseMonitor(Doc *doc, QObject *parent = 0);
+    ~WebAccessUniverseMonitor();
+
+    /** Start/stop sending the frames of $universe to $conn */
+    void subscribe(QHttpConnection *conn, quint32 universe);
+    void unsubscribe(QHttpConnection *conn, quint32 universe);
+
+    /** Forget every subscription of a closed connection */
+    void removeConnection(QHttpConnection *conn);
+
+    /** Process a Set frame received from a client.
+     *  Return false if the frame is malformed */
+    static bool handleSetMessage(SimpleDesk *sd, const QByteArray &message);
+
+    static QByteArray snapshotMessage(quint32 universe, const QByteArray &data);
+
+    /** Return the Delta frame between $previous and $data,
+     *  or an empty array if nothing has changed */
+    static QByteArray deltaMessage(quint32 universe, const QByteArray &previous, const QByteArray &data);
+
+protected slots:
+    void slotUniverseWritten(quint32 universe, const QByteArray &data);
+
+private:
+    void updateConnection();
+
+private:
+    Doc *m_doc;
+    bool m_connected;
+
+    /** universe -> subscribed connections */
+    QHash<quint32, QSet<QHttpConnection *> > m_subscribers;
+
+    /** universe -> connections still waiting for their snapshot */
+    QHash<quint32, QSet<QHttpConnection *> > m_pendingSnapshots;
+
+    /** universe -> the data last sent to the subscribers */
+    QHash<quint32, QByteArray> m_lastData;
+
+    /** universe -> frames skipped since the last one sent, see LoadGovernor */
+    QHash<quint32, int> m_skippedFrames;
+};
+
+#endif // WEBACCESSUNIVERSEMONITOR_H